@@ -0,0 +1,154 @@
+#include "../cockatrice/src/client/ui/picture_loader/picture_loader_local.h"
+#include "../cockatrice/src/game/cards/card_database_manager.h"
+#include "../cockatrice/src/game/cards/card_database_model.h"
+#include "../cockatrice/src/game/cards/card_search_model.h"
+#include "../cockatrice/src/game/filters/filter_string.h"
+#include "../common/decklist.h"
+#include "../tests/carddatabase/mocks.h"
+
+#include <QCoreApplication>
+#include <QTextStream>
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+const QStringList filterQueries = {"t:creature", "NOT t:creature", "t:bat OR t:creature", "cmc>1", "c:gw",
+                                   "pt:\"3/3\"", "not dead", "t:creature t:sorcery cmc=2", "c!g OR truth",
+                                   "t:\"creature\" c:g"};
+
+const QString plainDeck("Benchmark Deck\n"
+                        "\n"
+                        "4 Cat\n"
+                        "4 Dog (DOG) 1\n"
+                        "2 Not Dead\n"
+                        "1x Truth\n"
+                        "20 Forest\n"
+                        "SB: 2 Cat\n"
+                        "SB: 3 Dog\n");
+
+void loadCardDatabases(benchmark::State &state)
+{
+    for (auto _ : state) {
+        CardDatabase db;
+        if (db.loadCardDatabases() != Ok) {
+            state.SkipWithError("the card database fixtures could not be loaded");
+            return;
+        }
+        benchmark::DoNotOptimize(db.getCardList().size());
+    }
+}
+BENCHMARK(loadCardDatabases)->Unit(benchmark::kMillisecond);
+
+void filterStringParse(benchmark::State &state)
+{
+    for (auto _ : state) {
+        for (const QString &query : filterQueries) {
+            FilterString filter(query);
+            benchmark::DoNotOptimize(filter.valid());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * filterQueries.size());
+}
+BENCHMARK(filterStringParse);
+
+void filterStringEvaluate(benchmark::State &state)
+{
+    const QList<CardInfoPtr> cards = CardDatabaseManager::getInstance()->getCardList().values();
+    QList<FilterString> filters;
+    for (const QString &query : filterQueries) {
+        filters.append(FilterString(query));
+    }
+
+    for (auto _ : state) {
+        int matches = 0;
+        for (const FilterString &filter : filters) {
+            for (const CardInfoPtr &card : cards) {
+                matches += filter.check(card);
+            }
+        }
+        benchmark::DoNotOptimize(matches);
+    }
+    state.SetItemsProcessed(state.iterations() * filters.size() * cards.size());
+}
+BENCHMARK(filterStringEvaluate);
+
+void cardSearchModelSearch(benchmark::State &state)
+{
+    CardDatabaseModel databaseModel(CardDatabaseManager::getInstance(), false);
+    CardDatabaseDisplayModel displayModel;
+    displayModel.setSourceModel(&databaseModel);
+    CardSearchModel searchModel(&displayModel);
+
+    // the start of a name being typed into the search bar, several cards contain it
+    const QString query("d");
+    for (auto _ : state) {
+        searchModel.updateSearchResults(query);
+        // the display model filters on a timer in the client, the filtering is part of the search
+        displayModel.invalidate();
+        benchmark::DoNotOptimize(searchModel.rowCount());
+    }
+}
+BENCHMARK(cardSearchModelSearch);
+
+void deckListParsePlain(benchmark::State &state)
+{
+    for (auto _ : state) {
+        QString deck(plainDeck);
+        QTextStream stream(&deck);
+        DeckList deckList;
+        benchmark::DoNotOptimize(deckList.loadFromStream_Plain(stream, false));
+    }
+}
+BENCHMARK(deckListParsePlain);
+
+void deckListParseNative(benchmark::State &state)
+{
+    QString deck(plainDeck);
+    QTextStream stream(&deck);
+    DeckList plainDeckList;
+    plainDeckList.loadFromStream_Plain(stream, false);
+    const QString nativeDeck = plainDeckList.writeToString_Native();
+
+    for (auto _ : state) {
+        DeckList deckList;
+        benchmark::DoNotOptimize(deckList.loadFromString_Native(nativeDeck));
+    }
+}
+BENCHMARK(deckListParseNative);
+
+void pictureLoaderLocalTryLoad(benchmark::State &state)
+{
+    // Cat is in the set folder of the fixture images, Dog in the CUSTOM folder, Truth has no image
+    QList<ExactCard> cards;
+    for (const QString &name : {"Cat", "Dog", "Truth"}) {
+        const CardInfoPtr card = CardDatabaseManager::getInstance()->getCardInfo(name);
+        cards.append(ExactCard(card, CardDatabaseManager::getInstance()->getPreferredPrinting(card)));
+    }
+    PictureLoaderLocal loader(nullptr);
+
+    for (auto _ : state) {
+        for (const ExactCard &card : cards) {
+            benchmark::DoNotOptimize(loader.tryLoad(card));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * cards.size());
+}
+BENCHMARK(pictureLoaderLocalTryLoad);
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    settingsCache = new SettingsCache;
+    CardDatabaseManager::getInstance()->loadCardDatabases();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
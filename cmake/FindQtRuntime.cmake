@@ -1,5 +1,5 @@
 # Find a compatible Qt version
-# Inputs: WITH_SERVER, WITH_CLIENT, WITH_ORACLE, WITH_DBCONVERTER, FORCE_USE_QT5
+# Inputs: WITH_SERVER, WITH_CLIENT, WITH_ORACLE, WITH_DBCONVERTER, WITH_LOADGEN, TEST, BENCHMARK, FORCE_USE_QT5
 # Optional Input: QT6_DIR -- Hint as to where Qt6 lives on the system
 # Optional Input: QT5_DIR -- Hint as to where Qt5 lives on the system
 # Output: COCKATRICE_QT_VERSION_NAME -- Example values: Qt5, Qt6
@@ -7,7 +7,9 @@
 # Output: COCKATRICE_QT_MODULES
 # Output: ORACLE_QT_MODULES
 # Output: DBCONVERTER_QT_MODULES
+# Output: LOADGEN_QT_MODULES
 # Output: TEST_QT_MODULES
+# Output: BENCHMARK_QT_MODULES
 
 set(REQUIRED_QT_COMPONENTS Core)
 if(WITH_SERVER)
@@ -30,14 +32,20 @@ if(WITH_ORACLE)
   set(_ORACLE_NEEDED Concurrent Network Svg Widgets)
 endif()
 if(WITH_DBCONVERTER)
-  set(_DBCONVERTER_NEEDED Network Widgets)
+  set(_DBCONVERTER_NEEDED Concurrent Network Widgets)
+endif()
+if(WITH_LOADGEN)
+  set(_LOADGEN_NEEDED Network)
 endif()
 if(TEST)
   set(_TEST_NEEDED Widgets)
 endif()
+if(BENCHMARK)
+  set(_BENCHMARK_NEEDED Concurrent Network Svg Widgets)
+endif()
 
 set(REQUIRED_QT_COMPONENTS ${REQUIRED_QT_COMPONENTS} ${_SERVATRICE_NEEDED} ${_COCKATRICE_NEEDED} ${_ORACLE_NEEDED}
-                           ${_DBCONVERTER_NEEDED} ${_TEST_NEEDED}
+                           ${_DBCONVERTER_NEEDED} ${_LOADGEN_NEEDED} ${_TEST_NEEDED} ${_BENCHMARK_NEEDED}
 )
 list(REMOVE_DUPLICATES REQUIRED_QT_COMPONENTS)
 
@@ -113,6 +121,8 @@ string(REGEX REPLACE "([^;]+)" "${COCKATRICE_QT_VERSION_NAME}::\\1" SERVATRICE_Q
 string(REGEX REPLACE "([^;]+)" "${COCKATRICE_QT_VERSION_NAME}::\\1" COCKATRICE_QT_MODULES "${_COCKATRICE_NEEDED}")
 string(REGEX REPLACE "([^;]+)" "${COCKATRICE_QT_VERSION_NAME}::\\1" ORACLE_QT_MODULES "${_ORACLE_NEEDED}")
 string(REGEX REPLACE "([^;]+)" "${COCKATRICE_QT_VERSION_NAME}::\\1" DB_CONVERTER_QT_MODULES "${_DBCONVERTER_NEEDED}")
+string(REGEX REPLACE "([^;]+)" "${COCKATRICE_QT_VERSION_NAME}::\\1" LOADGEN_QT_MODULES "${_LOADGEN_NEEDED}")
 string(REGEX REPLACE "([^;]+)" "${COCKATRICE_QT_VERSION_NAME}::\\1" TEST_QT_MODULES "${_TEST_NEEDED}")
+string(REGEX REPLACE "([^;]+)" "${COCKATRICE_QT_VERSION_NAME}::\\1" BENCHMARK_QT_MODULES "${_BENCHMARK_NEEDED}")
 
 message(STATUS "Found Qt ${${COCKATRICE_QT_VERSION_NAME}_VERSION} at: ${${COCKATRICE_QT_VERSION_NAME}_DIR}")
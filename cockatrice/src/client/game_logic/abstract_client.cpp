@@ -17,8 +17,10 @@
 #include "pb/event_user_joined.pb.h"
 #include "pb/event_user_left.pb.h"
 #include "pb/event_user_message.pb.h"
+#include "pb/game_commands.pb.h"
 #include "pb/server_message.pb.h"
 
+#include <QTimer>
 #include <google/protobuf/descriptor.h>
 
 AbstractClient::AbstractClient(QObject *parent)
@@ -31,6 +33,7 @@ AbstractClient::AbstractClient(QObject *parent)
     qRegisterMetaType<ClientStatus>("ClientStatus");
     qRegisterMetaType<RoomEvent>("RoomEvent");
     qRegisterMetaType<GameEventContainer>("GameEventContainer");
+    qRegisterMetaType<ServerMessagePtr>("ServerMessagePtr");
     qRegisterMetaType<Event_ServerIdentification>("Event_ServerIdentification");
     qRegisterMetaType<Event_ConnectionClosed>("Event_ConnectionClosed");
     qRegisterMetaType<Event_ServerShutdown>("Event_ServerShutdown");
@@ -52,6 +55,11 @@ AbstractClient::AbstractClient(QObject *parent)
     FeatureSet features;
     features.initalizeFeatureList(clientFeatures);
 
+    batchTimer = new QTimer(this);
+    batchTimer->setSingleShot(true);
+    batchTimer->setInterval(0);
+    connect(batchTimer, &QTimer::timeout, this, &AbstractClient::flushBatchedCommands);
+
     connect(this, &AbstractClient::sigQueuePendingCommand, this, &AbstractClient::queuePendingCommand);
 }
 
@@ -59,8 +67,9 @@ AbstractClient::~AbstractClient()
 {
 }
 
-void AbstractClient::processProtocolItem(const ServerMessage &item)
+void AbstractClient::processProtocolItem(const ServerMessagePtr &message)
 {
+    const ServerMessage &item = *message;
     switch (item.message_type()) {
         case ServerMessage::RESPONSE: {
             const Response &response = item.response();
@@ -123,11 +132,11 @@ void AbstractClient::processProtocolItem(const ServerMessage &item)
             break;
         }
         case ServerMessage::GAME_EVENT_CONTAINER: {
-            emit gameEventContainerReceived(item.game_event_container());
+            emit gameEventContainerReceived(message);
             break;
         }
         case ServerMessage::ROOM_EVENT: {
-            emit roomEventReceived(item.room_event());
+            emit roomEventReceived(message);
             break;
         }
     }
@@ -156,6 +165,34 @@ void AbstractClient::sendCommand(PendingCommand *pend)
 void AbstractClient::queuePendingCommand(PendingCommand *pend)
 {
     // This function is always called from the client thread via signal/slot.
+    if (isBatchable(pend->getCommandContainer())) {
+        batchedCommands.append(pend);
+        batchTimer->start();
+        return;
+    }
+
+    // the commands that were queued before go out first
+    flushBatchedCommands();
+    sendPendingCommand(pend);
+}
+
+// Game commands can share a container when their response carries nothing but the response code.
+bool AbstractClient::isBatchable(const CommandContainer &cont)
+{
+    if (cont.game_command_size() == 0 || cont.session_command_size() != 0 || cont.room_command_size() != 0 ||
+        cont.moderator_command_size() != 0 || cont.admin_command_size() != 0)
+        return false;
+
+    for (const GameCommand &command : cont.game_command()) {
+        const int type = getPbExtension(command);
+        if (type == GameCommand::DECK_SELECT || type == GameCommand::DUMP_ZONE)
+            return false;
+    }
+    return true;
+}
+
+void AbstractClient::sendPendingCommand(PendingCommand *pend)
+{
     const int cmdId = getNewCmdId();
     pend->getCommandContainer().set_cmd_id(cmdId);
 
@@ -164,6 +201,48 @@ void AbstractClient::queuePendingCommand(PendingCommand *pend)
     sendCommandContainer(pend->getCommandContainer());
 }
 
+void AbstractClient::flushBatchedCommands()
+{
+    batchTimer->stop();
+
+    int first = 0;
+    while (first < batchedCommands.size()) {
+        PendingCommand *pend = batchedCommands[first];
+        const auto gameId = pend->getCommandContainer().game_id();
+        int end = first + 1;
+        while (end < batchedCommands.size() && batchedCommands[end]->getCommandContainer().game_id() == gameId)
+            ++end;
+
+        if (end - first == 1) {
+            sendPendingCommand(pend);
+            first = end;
+            continue;
+        }
+
+        // The server processes the commands of a container from the last one to the first, so the commands that were
+        // queued last go first, each keeping the order of its own container.
+        CommandContainer cont;
+        cont.set_game_id(gameId);
+        for (int i = end - 1; i >= first; --i) {
+            for (const GameCommand &command : batchedCommands[i]->getCommandContainer().game_command())
+                cont.add_game_command()->CopyFrom(command);
+        }
+
+        const int cmdId = getNewCmdId();
+        cont.set_cmd_id(cmdId);
+        pend->getCommandContainer().set_cmd_id(cmdId);
+        for (int i = first + 1; i < end; ++i) {
+            batchedCommands[i]->getCommandContainer().set_cmd_id(cmdId);
+            pend->addBatchedCommand(batchedCommands[i]);
+        }
+        pendingCommands.insert(cmdId, pend);
+
+        sendCommandContainer(cont);
+        first = end;
+    }
+    batchedCommands.clear();
+}
+
 PendingCommand *AbstractClient::prepareSessionCommand(const ::google::protobuf::Message &cmd)
 {
     CommandContainer cont;
@@ -4,8 +4,10 @@
 #include "pb/response.pb.h"
 #include "pb/serverinfo_user.pb.h"
 
+#include <QList>
 #include <QMutex>
 #include <QObject>
+#include <QSharedPointer>
 #include <QVariant>
 
 class PendingCommand;
@@ -27,6 +29,10 @@ class Event_ConnectionClosed;
 class Event_ServerShutdown;
 class Event_ReplayAdded;
 class FeatureSet;
+class QTimer;
+
+// a message as it was parsed on the network thread, shared by the receivers of the signals that pass it on
+typedef QSharedPointer<const ServerMessage> ServerMessagePtr;
 
 enum ClientStatus
 {
@@ -50,10 +56,10 @@ signals:
     void statusChanged(ClientStatus _status);
     void maxPingTime(int seconds, int maxSeconds);
 
-    // Room events
-    void roomEventReceived(const RoomEvent &event);
-    // Game events
-    void gameEventContainerReceived(const GameEventContainer &event);
+    // Room events, the message holds a room_event
+    void roomEventReceived(const ServerMessagePtr &message);
+    // Game events, the message holds a game_event_container
+    void gameEventContainerReceived(const ServerMessagePtr &message);
     // Session events
     void serverIdentificationEventReceived(const Event_ServerIdentification &event);
     void connectionClosedEventReceived(const Event_ConnectionClosed &event);
@@ -81,10 +87,17 @@ private:
     int nextCmdId;
     mutable QMutex clientMutex;
     ClientStatus status;
+    // game commands queued within the same event loop iteration, they are sent in as few containers as possible
+    QList<PendingCommand *> batchedCommands;
+    QTimer *batchTimer;
+
+    static bool isBatchable(const CommandContainer &cont);
+    void sendPendingCommand(PendingCommand *pend);
 private slots:
     void queuePendingCommand(PendingCommand *pend);
+    void flushBatchedCommands();
 protected slots:
-    void processProtocolItem(const ServerMessage &item);
+    void processProtocolItem(const ServerMessagePtr &message);
 
 protected:
     QMap<int, PendingCommand *> pendingCommands;
@@ -0,0 +1,119 @@
+#include "json_api_client.h"
+
+#include "../../settings/cache_settings.h"
+
+#include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QJsonDocument>
+#include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
+#include <QNetworkReply>
+#include <QtConcurrentRun>
+
+JsonApiClient *JsonApiClient::instance()
+{
+    // owned by the application, so that the network manager goes away before it
+    static JsonApiClient *client = new JsonApiClient(QCoreApplication::instance());
+    return client;
+}
+
+JsonApiClient::JsonApiClient(QObject *parent) : QObject(parent)
+{
+    networkManager = new QNetworkAccessManager(this);
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
+    networkManager->setTransferTimeout(); // Use Qt's default timeout
+#endif
+    networkManager->setRedirectPolicy(QNetworkRequest::ManualRedirectPolicy);
+
+    // not the picture cache directory, expiring one cache would delete the files of the other
+    cache = new QNetworkDiskCache(this);
+    cache->setCacheDirectory(SettingsCache::instance().getApiCachePath());
+    cache->setMaximumCacheSize(MAX_CACHE_SIZE);
+    networkManager->setCache(cache);
+}
+
+void JsonApiClient::getJson(const QUrl &url, QObject *receiver, const Callback &callback)
+{
+    auto it = waiting.find(url);
+    if (it != waiting.end()) {
+        it->append({receiver, callback});
+        return;
+    }
+    waiting.insert(url, {{receiver, callback}});
+
+    const QString host = url.host();
+    if (runningPerHost.value(host) >= MAX_REQUESTS_PER_HOST) {
+        queuedPerHost[host].enqueue(url);
+        return;
+    }
+    startRequest(url);
+}
+
+void JsonApiClient::startRequest(const QUrl &url)
+{
+    ++runningPerHost[url.host()];
+
+    // the cache sends If-None-Match and If-Modified-Since for stale entries and answers a 304 from disk
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferNetwork);
+    QNetworkReply *reply = networkManager->get(request);
+    connect(reply, &QNetworkReply::finished, this, [this, url, reply]() { requestFinished(url, reply); });
+}
+
+void JsonApiClient::startNextRequest(const QString &host)
+{
+    auto queue = queuedPerHost.find(host);
+    if (queue == queuedPerHost.end()) {
+        return;
+    }
+    const QUrl next = queue->dequeue();
+    if (queue->isEmpty()) {
+        queuedPerHost.erase(queue);
+    }
+    startRequest(next);
+}
+
+void JsonApiClient::requestFinished(const QUrl &url, QNetworkReply *reply)
+{
+    reply->deleteLater();
+
+    const QString host = url.host();
+    if (--runningPerHost[host] == 0) {
+        runningPerHost.remove(host);
+    }
+    startNextRequest(host);
+
+    if (reply->error() != QNetworkReply::NoError) {
+        qCWarning(JsonApiClientLog) << "Network error occurred:" << reply->errorString();
+        waiting.remove(url);
+        return;
+    }
+
+    const QByteArray data = reply->readAll();
+    qCDebug(JsonApiClientLog) << url.toString() << "from cache:"
+                              << reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+
+    // the pages are large, parsing them would stall the GUI thread
+    auto *watcher = new QFutureWatcher<QJsonDocument>(this);
+    connect(watcher, &QFutureWatcher<QJsonDocument>::finished, this, [this, url, watcher]() {
+        const QJsonDocument document = watcher->result();
+        watcher->deleteLater();
+        parsed(url, document.object(), document.isObject());
+    });
+    watcher->setFuture(QtConcurrent::run([data]() { return QJsonDocument::fromJson(data); }));
+}
+
+void JsonApiClient::parsed(const QUrl &url, const QJsonObject &json, bool isObject)
+{
+    const QVector<Waiting> callbacks = waiting.take(url);
+    if (!isObject) {
+        qCWarning(JsonApiClientLog) << "Invalid JSON response received from" << url.toString();
+        return;
+    }
+
+    for (const Waiting &entry : callbacks) {
+        if (entry.receiver) {
+            entry.callback(url, json);
+        }
+    }
+}
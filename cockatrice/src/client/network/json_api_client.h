@@ -0,0 +1,66 @@
+#ifndef JSON_API_CLIENT_H
+#define JSON_API_CLIENT_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QUrl>
+#include <QVector>
+#include <functional>
+
+inline Q_LOGGING_CATEGORY(JsonApiClientLog, "json_api_client");
+
+class QNetworkAccessManager;
+class QNetworkDiskCache;
+class QNetworkReply;
+
+/**
+ * The HTTP client of the web APIs that the client reads JSON pages from, shared by all of their tabs.
+ *
+ * The responses are kept in a disk cache and revalidated with their ETag or Last-Modified header, so going back to a
+ * page costs a "not modified" at most. A url that is already being fetched is not requested again, everyone asking
+ * for it gets the same response, and only a few requests run against one host at a time. The JSON is parsed on a
+ * worker thread, the callbacks are called on the GUI thread.
+ */
+class JsonApiClient : public QObject
+{
+    Q_OBJECT
+public:
+    using Callback = std::function<void(const QUrl &url, const QJsonObject &json)>;
+
+    static JsonApiClient *instance();
+
+    /**
+     * Fetches url and calls callback with the JSON object it returned, unless receiver was destroyed in the meantime.
+     * Failed requests and responses that are not a JSON object are logged, the callback is not called for them.
+     */
+    void getJson(const QUrl &url, QObject *receiver, const Callback &callback);
+
+private:
+    struct Waiting
+    {
+        QPointer<QObject> receiver;
+        Callback callback;
+    };
+
+    static const int MAX_REQUESTS_PER_HOST = 4;
+    static const qint64 MAX_CACHE_SIZE = 64LL * 1024 * 1024;
+
+    QNetworkAccessManager *networkManager;
+    QNetworkDiskCache *cache;
+    // everyone waiting for a url that is queued or being fetched
+    QHash<QUrl, QVector<Waiting>> waiting;
+    QHash<QString, int> runningPerHost;
+    QHash<QString, QQueue<QUrl>> queuedPerHost;
+
+    explicit JsonApiClient(QObject *parent);
+    void startRequest(const QUrl &url);
+    void startNextRequest(const QString &host);
+    void requestFinished(const QUrl &url, QNetworkReply *reply);
+    void parsed(const QUrl &url, const QJsonObject &json, bool isObject);
+};
+
+#endif // JSON_API_CLIENT_H
@@ -4,6 +4,7 @@
 #include <QPainterPath>
 #include <QPalette>
 #include <QTimer>
+#include <algorithm>
 
 ReplayTimelineWidget::ReplayTimelineWidget(QWidget *parent)
     : QWidget(parent), maxBinValue(1), maxTime(1), timeScaleFactor(1.0), currentVisualTime(0), currentProcessedTime(0),
@@ -92,7 +93,9 @@ void ReplayTimelineWidget::skipToTime(int newTime, bool doRewindBuffering)
     if (isBackwardsSkip) {
         handleBackwardsSkip(doRewindBuffering);
     } else {
+        emit skipStarted();
         processNewEvents(FORWARD_SKIP);
+        emit skipFinished();
     }
 
     update();
@@ -119,10 +122,14 @@ void ReplayTimelineWidget::processRewind()
     // stop any queued-up rewinds
     rewindBufferingTimer->stop();
 
-    // process the rewind
+    // process the rewind, the receivers of rewound() can restore the game at a later event than the first one and move
+    // currentEvent there
+    const auto targetEvent = std::lower_bound(replayTimeline.cbegin(), replayTimeline.cend(), currentVisualTime);
+    emit skipStarted();
     currentEvent = 0;
-    emit rewound();
+    emit rewound(static_cast<int>(targetEvent - replayTimeline.cbegin()));
     processNewEvents(BACKWARD_SKIP);
+    emit skipFinished();
 }
 
 QSize ReplayTimelineWidget::sizeHint() const
@@ -158,8 +165,8 @@ void ReplayTimelineWidget::processNewEvents(PlaybackMode playbackMode)
         if (playbackMode == BACKWARD_SKIP || currentProcessedTime - replayTimeline[currentEvent] > BIG_SKIP_MS)
             options |= Player::EventProcessingOption::SKIP_REVEAL_WINDOW;
 
-        // backwards skip => always skip tap animation
-        if (playbackMode == BACKWARD_SKIP)
+        // any skip => always skip tap animation
+        if (playbackMode != NORMAL_PLAYBACK)
             options |= Player::EventProcessingOption::SKIP_TAP_ANIMATION;
 
         emit processNextEvent(options);
@@ -16,7 +16,10 @@ class ReplayTimelineWidget : public QWidget
 signals:
     void processNextEvent(Player::EventProcessingOptions options);
     void replayFinished();
-    void rewound();
+    void rewound(int targetEvent);
+    // around the events applied at once by a skip
+    void skipStarted();
+    void skipFinished();
 
 private:
     enum PlaybackMode
@@ -61,6 +64,10 @@ public:
     {
         return currentEvent;
     }
+    void setCurrentEvent(int _currentEvent)
+    {
+        currentEvent = _currentEvent;
+    }
 public slots:
     void startReplay();
     void stopReplay();
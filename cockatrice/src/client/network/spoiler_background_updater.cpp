@@ -158,9 +158,9 @@ bool SpoilerBackgroundUpdater::saveDownloadedFile(QByteArray data)
 
     file.close();
 
-    // Data written, so reload the card database
+    // Data written, so apply what changed to the card database
     qCInfo(SpoilerBackgroundUpdaterLog) << "Spoiler Service Data Written";
-    const auto reloadOk = QtConcurrent::run([] { CardDatabaseManager::getInstance()->loadCardDatabases(); });
+    const auto reloadOk = QtConcurrent::run([] { CardDatabaseManager::getInstance()->reloadSpoilerDatabase(); });
 
     // If the user has notifications enabled, let them know
     // when the database was last updated
@@ -5,7 +5,7 @@
 #include <QHBoxLayout>
 #include <QToolButton>
 
-ReplayManager::ReplayManager(TabGame *parent, GameReplay *_replay)
+ReplayManager::ReplayManager(TabGame *parent, ReplayFile *_replay)
     : QWidget(parent), game(parent), replay(_replay), replayPlayButton(nullptr), replayFastForwardButton(nullptr),
       aReplaySkipForward(nullptr), aReplaySkipBackward(nullptr), aReplaySkipForwardBig(nullptr),
       aReplaySkipBackwardBig(nullptr)
@@ -13,24 +13,8 @@ ReplayManager::ReplayManager(TabGame *parent, GameReplay *_replay)
     if (replay) {
         game->loadReplay(replay);
 
-        // Create list: event number -> time [ms]
-        // Distribute simultaneous events evenly across 1 second.
-        unsigned int lastEventTimestamp = 0;
-        const int eventCount = replay->event_list_size();
-        for (int i = 0; i < eventCount; ++i) {
-            int j = i + 1;
-            while ((j < eventCount) && (replay->event_list(j).seconds_elapsed() == lastEventTimestamp))
-                ++j;
-
-            const int numberEventsThisSecond = j - i;
-            for (int k = 0; k < numberEventsThisSecond; ++k)
-                replayTimeline.append(replay->event_list(i + k).seconds_elapsed() * 1000 +
-                                      (int)((qreal)k / (qreal)numberEventsThisSecond * 1000));
-
-            if (j < eventCount)
-                lastEventTimestamp = replay->event_list(j).seconds_elapsed();
-            i += numberEventsThisSecond - 1;
-        }
+        // the timeline comes from the index of the replay, the events are only read as they are played
+        replayTimeline = replay->getTimeline();
     }
 
     // timeline widget
@@ -39,6 +23,9 @@ ReplayManager::ReplayManager(TabGame *parent, GameReplay *_replay)
     connect(timelineWidget, &ReplayTimelineWidget::processNextEvent, this, &ReplayManager::replayNextEvent);
     connect(timelineWidget, &ReplayTimelineWidget::replayFinished, this, &ReplayManager::replayFinished);
     connect(timelineWidget, &ReplayTimelineWidget::rewound, this, &ReplayManager::replayRewind);
+    connect(timelineWidget, &ReplayTimelineWidget::skipStarted, this, [this] { game->setPresentationSuspended(true); });
+    connect(timelineWidget, &ReplayTimelineWidget::skipFinished, this,
+            [this] { game->setPresentationSuspended(false); });
 
     // timeline skip shortcuts
     aReplaySkipForward = new QAction(timelineWidget);
@@ -95,7 +82,15 @@ ReplayManager::ReplayManager(TabGame *parent, GameReplay *_replay)
 
 void ReplayManager::replayNextEvent(Player::EventProcessingOptions options)
 {
-    game->processGameEventContainer(replay->event_list(timelineWidget->getCurrentEvent()), nullptr, options);
+    const int eventIndex = timelineWidget->getCurrentEvent();
+    if (eventIndex == (keyframes.size() + 1) * KEYFRAME_INTERVAL) {
+        ReplayKeyframe keyframe;
+        keyframe.eventIndex = eventIndex;
+        game->saveReplayKeyframe(keyframe);
+        keyframes.append(keyframe);
+    }
+
+    game->processGameEventContainer(replay->getEvent(eventIndex), nullptr, options);
 }
 
 void ReplayManager::replayFinished()
@@ -119,9 +114,18 @@ void ReplayManager::replayFastForwardButtonToggled(bool checked)
 
 /**
  * @brief Handles everything that needs to be reset when doing a replay rewind.
+ *
+ * The game goes back to the closest keyframe before targetEvent and the timeline replays the events from there. Only
+ * when no keyframe can be restored is everything reset to replay the events from the start.
  */
-void ReplayManager::replayRewind()
+void ReplayManager::replayRewind(int targetEvent)
 {
+    for (int i = qMin(targetEvent / KEYFRAME_INTERVAL, keyframes.size()) - 1; i >= 0; --i) {
+        if (game->restoreReplayKeyframe(keyframes.at(i))) {
+            timelineWidget->setCurrentEvent(keyframes.at(i).eventIndex);
+            return;
+        }
+    }
     emit requestChatAndPhaseReset();
 }
 
@@ -1,25 +1,43 @@
 #ifndef REPLAY_MANAGER_H
 #define REPLAY_MANAGER_H
 #include "network/replay_timeline_widget.h"
-#include "pb/game_replay.pb.h"
+#include "pb/event_game_state_changed.pb.h"
+#include "replay_file.h"
 
+#include <QVector>
 #include <QWidget>
 
+/**
+ * The state of a replay before one of its events, so that rewinding can start from there instead of replaying
+ * every event from the start.
+ */
+struct ReplayKeyframe
+{
+    int eventIndex;
+    // the players as the client shows them, in the form joining players get them from the server
+    Event_GameStateChanged gameState;
+    int messageLogLength;
+};
+
 class ReplayManager : public QWidget
 {
     Q_OBJECT
 
 public:
-    ReplayManager(TabGame *parent, GameReplay *replay);
+    ReplayManager(TabGame *parent, ReplayFile *replay);
     TabGame *game;
-    GameReplay *replay;
+    ReplayFile *replay;
 
 signals:
     void requestChatAndPhaseReset();
 
 private:
+    static constexpr int KEYFRAME_INTERVAL = 250;
+
     // Replay related members
     int currentReplayStep = 0;
+    // taken in order as the replay goes on, one every KEYFRAME_INTERVAL events
+    QVector<ReplayKeyframe> keyframes;
     QList<int> replayTimeline;
     ReplayTimelineWidget *timelineWidget;
     QToolButton *replayPlayButton, *replayFastForwardButton;
@@ -30,7 +48,7 @@ private slots:
     void replayFinished();
     void replayPlayButtonToggled(bool checked);
     void replayFastForwardButtonToggled(bool checked);
-    void replayRewind();
+    void replayRewind(int targetEvent);
     void refreshShortcuts();
 };
 
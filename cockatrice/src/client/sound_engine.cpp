@@ -4,6 +4,8 @@
 
 #include <QDir>
 #include <QMediaPlayer>
+#include <QSoundEffect>
+#include <QtConcurrentRun>
 
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
 #include <QAudioOutput>
@@ -11,19 +13,25 @@
 
 #define DEFAULT_THEME_NAME "Default"
 #define TEST_SOUND_FILENAME "player_join"
+#define VOICES_PER_SOUND 2
+// the events of a burst, like drawing a hand or untapping everything, arrive within a few milliseconds of each other
+#define COALESCE_INTERVAL_MS 60
 
-SoundEngine::SoundEngine(QObject *parent) : QObject(parent), audioOutput(nullptr), player(nullptr)
+SoundEngine::SoundEngine(QObject *parent)
+    : QObject(parent), audioOutput(nullptr), player(nullptr), themeLookup(nullptr)
 {
+    clock.start();
     ensureThemeDirectoryExists();
     connect(&SettingsCache::instance(), &SettingsCache::soundThemeChanged, this, &SoundEngine::themeChangedSlot);
     connect(&SettingsCache::instance(), &SettingsCache::soundEnabledChanged, this, &SoundEngine::soundEnabledChanged);
 
-    soundEnabledChanged();
+    // the media player and the sounds are set up once the files of the theme are found, after the startup
     themeChangedSlot();
 }
 
 SoundEngine::~SoundEngine()
 {
+    clearVoices();
     if (player) {
         player->deleteLater();
         player = nullptr;
@@ -45,8 +53,10 @@ void SoundEngine::soundEnabledChanged()
             player->setAudioOutput(audioOutput);
 #endif
         }
+        loadVoices();
     } else {
         qCInfo(SoundEngineLog) << "SoundEngine: disabling sound";
+        clearVoices();
         if (player) {
             player->stop();
             player->deleteLater();
@@ -69,8 +79,31 @@ void SoundEngine::playSound(const QString &fileName)
         return;
     }
 
-    player->stop();
+    const qint64 now = clock.elapsed();
+    const auto last = lastPlayed.constFind(fileName);
+    if (last != lastPlayed.constEnd() && now - *last < COALESCE_INTERVAL_MS) {
+        return;
+    }
+    lastPlayed.insert(fileName, now);
+
     int volumeSliderValue = SettingsCache::instance().getMasterVolume();
+
+    auto soundVoices = voices.find(fileName);
+    if (soundVoices != voices.end() && soundVoices->first()->status() != QSoundEffect::Error) {
+        // a voice that is done, or the one that started longest ago; it goes to the back of the list
+        int index = 0;
+        while (index < soundVoices->size() && soundVoices->at(index)->isPlaying()) {
+            ++index;
+        }
+        QSoundEffect *voice = soundVoices->takeAt(index < soundVoices->size() ? index : 0);
+        soundVoices->append(voice);
+
+        voice->setVolume(qreal(volumeSliderValue) / 100);
+        voice->play();
+        return;
+    }
+
+    player->stop();
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
     player->audioOutput()->setVolume(qreal(volumeSliderValue) / 100);
     player->setSource(QUrl::fromLocalFile(audioData[fileName]));
@@ -81,6 +114,32 @@ void SoundEngine::playSound(const QString &fileName)
     player->play();
 }
 
+void SoundEngine::loadVoices()
+{
+    clearVoices();
+    for (auto it = audioData.constBegin(); it != audioData.constEnd(); ++it) {
+        if (!it.value().endsWith(".wav", Qt::CaseInsensitive)) {
+            continue;
+        }
+        QList<QSoundEffect *> soundVoices;
+        for (int i = 0; i < VOICES_PER_SOUND; ++i) {
+            auto *voice = new QSoundEffect(this);
+            voice->setSource(QUrl::fromLocalFile(it.value()));
+            soundVoices.append(voice);
+        }
+        voices.insert(it.key(), soundVoices);
+    }
+}
+
+void SoundEngine::clearVoices()
+{
+    for (const QList<QSoundEffect *> &soundVoices : voices) {
+        qDeleteAll(soundVoices);
+    }
+    voices.clear();
+    lastPlayed.clear();
+}
+
 void SoundEngine::testSound()
 {
     playSound(TEST_SOUND_FILENAME);
@@ -133,9 +192,29 @@ void SoundEngine::themeChangedSlot()
     QString themeName = SettingsCache::instance().getSoundThemeName();
     qCInfo(SoundEngineLog) << "Sound theme changed:" << themeName;
 
-    QDir dir = getAvailableThemes().value(themeName);
+    const QString themePath = getAvailableThemes().value(themeName);
+
+    auto *watcher = new QFutureWatcher<QStringMap>(this);
+    connect(watcher, &QFutureWatcher<QStringMap>::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        if (watcher != themeLookup) {
+            return;
+        }
+        themeLookup = nullptr;
+        audioData = watcher->result();
+        soundEnabledChanged();
+    });
+    themeLookup = watcher;
+    watcher->setFuture(QtConcurrent::run([themePath]() { return findSoundFiles(themePath); }));
+}
 
-    audioData.clear();
+/**
+ * Looks up the sound files of the theme, by sound name. Only touches the file system, so it runs on a worker thread.
+ */
+QStringMap SoundEngine::findSoundFiles(const QString &themePath)
+{
+    const QDir dir(themePath);
+    QStringMap soundFiles;
 
     static const QStringList extensions = {".wav", ".mp3", ".ogg"};
     static const QStringList fileNames = {
@@ -157,10 +236,9 @@ void SoundEngine::themeChangedSlot()
         for (const QString &name : fileNames) {
             QFile file(dir.filePath(name + extension));
             if (file.exists()) {
-                audioData.insert(name, file.fileName());
+                soundFiles.insert(name, file.fileName());
             }
         }
     }
-
-    soundEnabledChanged();
+    return soundFiles;
 }
@@ -2,6 +2,9 @@
 #define SOUNDENGINE_H
 
 #include <QAudioOutput>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QList>
 #include <QLoggingCategory>
 #include <QMap>
 #include <QMediaPlayer>
@@ -11,6 +14,7 @@
 inline Q_LOGGING_CATEGORY(SoundEngineLog, "sound_engine");
 
 class QBuffer;
+class QSoundEffect;
 
 typedef QMap<QString, QString> QStringMap;
 
@@ -26,8 +30,20 @@ public:
 private:
     QStringMap availableThemes;
     QMap<QString, QString> audioData;
+    // the wav sounds, decoded into memory when the theme is loaded, with a few voices each so that a sound can start
+    // again while it is still playing; the other formats go through the media player
+    QMap<QString, QList<QSoundEffect *>> voices;
+    // when each sound last started, the events of a burst only play it once
+    QMap<QString, qint64> lastPlayed;
+    QElapsedTimer clock;
     QAudioOutput *audioOutput;
     QMediaPlayer *player;
+    // looks up the files of the current theme, a theme change replaces the lookup that is still running
+    QFutureWatcher<QStringMap> *themeLookup;
+
+    void loadVoices();
+    void clearVoices();
+    static QStringMap findSoundFiles(const QString &themePath);
 
 protected:
     void ensureThemeDirectoryExists();
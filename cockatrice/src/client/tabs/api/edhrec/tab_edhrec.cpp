@@ -1,5 +1,6 @@
 #include "tab_edhrec.h"
 
+#include "../../../network/json_api_client.h"
 #include "api_response/commander/edhrec_commander_api_response.h"
 #include "display/commander/edhrec_commander_api_response_display_widget.h"
 
@@ -8,20 +9,11 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
 #include <QRegularExpression>
 #include <QResizeEvent>
 
 TabEdhRec::TabEdhRec(TabSupervisor *_tabSupervisor) : Tab(_tabSupervisor)
 {
-    networkManager = new QNetworkAccessManager(this);
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
-    networkManager->setTransferTimeout(); // Use Qt's default timeout
-#endif
-
-    networkManager->setRedirectPolicy(QNetworkRequest::ManualRedirectPolicy);
-    connect(networkManager, &QNetworkAccessManager::finished, this, &TabEdhRec::processApiJson);
 }
 
 void TabEdhRec::retranslateUi()
@@ -47,40 +39,20 @@ void TabEdhRec::setCard(CardInfoPtr _cardToQuery, bool isCommander)
         url = QString("https://json.edhrec.com/pages/cards/%1.json").arg(formattedName);
     }
 
-    QNetworkRequest request{QUrl(url)};
-
-    networkManager->get(request);
+    JsonApiClient::instance()->getJson(QUrl(url), this, [this](const QUrl &responseUrl, const QJsonObject &jsonObj) {
+        processApiJson(responseUrl, jsonObj);
+    });
 }
 
-void TabEdhRec::processApiJson(QNetworkReply *reply)
+void TabEdhRec::processApiJson(const QUrl &url, const QJsonObject &jsonObj)
 {
-    if (reply->error() != QNetworkReply::NoError) {
-        qDebug() << "Network error occurred:" << reply->errorString();
-        reply->deleteLater();
-        return;
-    }
-
-    QByteArray responseData = reply->readAll();
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(responseData);
-
-    if (!jsonDoc.isObject()) {
-        qDebug() << "Invalid JSON response received.";
-        reply->deleteLater();
-        return;
-    }
-
-    QJsonObject jsonObj = jsonDoc.object();
-
-    // qDebug() << jsonObj;
-
     EdhrecCommanderApiResponse deckData;
     deckData.fromJson(jsonObj);
 
-    displayWidget = new EdhrecCommanderApiResponseDisplayWidget(this, deckData, reply->url().toString());
+    displayWidget = new EdhrecCommanderApiResponseDisplayWidget(this, deckData, url.toString());
     // flowWidget->addWidget(displayWidget);
     setCentralWidget(displayWidget);
 
-    reply->deleteLater();
     update();
 }
 
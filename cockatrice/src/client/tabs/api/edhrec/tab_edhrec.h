@@ -6,7 +6,8 @@
 #include "../../tab.h"
 #include "display/commander/edhrec_commander_api_response_display_widget.h"
 
-#include <QNetworkAccessManager>
+#include <QJsonObject>
+#include <QUrl>
 
 class TabEdhRec : public Tab
 {
@@ -21,10 +22,8 @@ public:
         return tr("EDHREC: ") + cardName;
     }
 
-    QNetworkAccessManager *networkManager;
-
 public slots:
-    void processApiJson(QNetworkReply *reply);
+    void processApiJson(const QUrl &url, const QJsonObject &jsonObj);
     void prettyPrintJson(const QJsonValue &value, int indentLevel);
     void setCard(CardInfoPtr _cardToQuery, bool isCommander = false);
 
@@ -3,6 +3,7 @@
 #include "../../../../game/cards/card_completer_proxy_model.h"
 #include "../../../../game/cards/card_database_manager.h"
 #include "../../../../game/cards/card_search_model.h"
+#include "../../../network/json_api_client.h"
 #include "../../tab_supervisor.h"
 #include "api_response/average_deck/edhrec_average_deck_api_response.h"
 #include "api_response/commander/edhrec_commander_api_response.h"
@@ -20,8 +21,6 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
 #include <QPushButton>
 #include <QRegularExpression>
 #include <QResizeEvent>
@@ -35,14 +34,6 @@ static bool canBeCommander(const CardInfoPtr &cardInfo)
 
 TabEdhRecMain::TabEdhRecMain(TabSupervisor *_tabSupervisor) : Tab(_tabSupervisor)
 {
-    networkManager = new QNetworkAccessManager(this);
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
-    networkManager->setTransferTimeout(); // Use Qt's default timeout
-#endif
-
-    networkManager->setRedirectPolicy(QNetworkRequest::ManualRedirectPolicy);
-    connect(networkManager, SIGNAL(finished(QNetworkReply *)), this, SLOT(processApiJson(QNetworkReply *)));
-
     container = new QWidget(this);
     mainLayout = new QVBoxLayout(container);
     container->setLayout(mainLayout);
@@ -163,60 +154,39 @@ void TabEdhRecMain::setCard(CardInfoPtr _cardToQuery, bool isCommander)
         url = QString("https://json.edhrec.com/pages/cards/%1.json").arg(formattedName);
     }
 
-    QNetworkRequest request{QUrl(url)};
-
-    networkManager->get(request);
+    requestJson(QUrl(url));
 }
 
 void TabEdhRecMain::actNavigatePage(QString url)
 {
-    QNetworkRequest request{QUrl("https://json.edhrec.com/pages" + url + ".json")};
-
-    networkManager->get(request);
+    requestJson(QUrl("https://json.edhrec.com/pages" + url + ".json"));
 }
 
 void TabEdhRecMain::getTopCards()
 {
-    QNetworkRequest request{QUrl("https://json.edhrec.com/pages/top/year.json")};
-
-    networkManager->get(request);
+    requestJson(QUrl("https://json.edhrec.com/pages/top/year.json"));
 }
 
 void TabEdhRecMain::getTopCommanders()
 {
-    QNetworkRequest request{QUrl("https://json.edhrec.com/pages/commanders/year.json")};
-
-    networkManager->get(request);
+    requestJson(QUrl("https://json.edhrec.com/pages/commanders/year.json"));
 }
 
 void TabEdhRecMain::getTopTags()
 {
-    QNetworkRequest request{QUrl("https://json.edhrec.com/pages/tags.json")};
-
-    networkManager->get(request);
+    requestJson(QUrl("https://json.edhrec.com/pages/tags.json"));
 }
 
-void TabEdhRecMain::processApiJson(QNetworkReply *reply)
+void TabEdhRecMain::requestJson(const QUrl &url)
 {
-    if (reply->error() != QNetworkReply::NoError) {
-        qDebug() << "Network error occurred:" << reply->errorString();
-        reply->deleteLater();
-        return;
-    }
-
-    QByteArray responseData = reply->readAll();
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(responseData);
-
-    if (!jsonDoc.isObject()) {
-        qDebug() << "Invalid JSON response received.";
-        reply->deleteLater();
-        return;
-    }
-
-    QJsonObject jsonObj = jsonDoc.object();
+    JsonApiClient::instance()->getJson(url, this, [this](const QUrl &responseUrl, const QJsonObject &jsonObj) {
+        processApiJson(responseUrl, jsonObj);
+    });
+}
 
-    // Get the actual URL from the reply
-    QString responseUrl = reply->url().toString();
+void TabEdhRecMain::processApiJson(const QUrl &url, const QJsonObject &jsonObj)
+{
+    QString responseUrl = url.toString();
 
     // Check if the response URL matches a commander request
     if (responseUrl.startsWith("https://json.edhrec.com/pages/commanders/year.json")) {
@@ -240,8 +210,6 @@ void TabEdhRecMain::processApiJson(QNetworkReply *reply)
     } else {
         prettyPrintJson(jsonObj, 4);
     }
-
-    reply->deleteLater();
 }
 
 void TabEdhRecMain::processTopCardsResponse(QJsonObject reply)
@@ -9,9 +9,10 @@
 #include "display/commander/edhrec_commander_api_response_display_widget.h"
 
 #include <QHBoxLayout>
+#include <QJsonObject>
 #include <QLineEdit>
-#include <QNetworkAccessManager>
 #include <QPushButton>
+#include <QUrl>
 
 class TabEdhRecMain : public Tab
 {
@@ -32,10 +33,8 @@ public:
         return cardSizeSlider;
     }
 
-    QNetworkAccessManager *networkManager;
-
 public slots:
-    void processApiJson(QNetworkReply *reply);
+    void processApiJson(const QUrl &url, const QJsonObject &jsonObj);
     void processCommanderResponse(QJsonObject reply, QString responseUrl = "");
     void processTopCardsResponse(QJsonObject reply);
     void processTopTagsResponse(QJsonObject reply);
@@ -64,6 +63,8 @@ private:
     CardSizeWidget *cardSizeSlider;
     CardInfoPtr cardToQuery;
     EdhrecCommanderApiResponseDisplayWidget *displayWidget;
+
+    void requestJson(const QUrl &url);
 };
 
 #endif // TAB_EDHREC_MAIN_H
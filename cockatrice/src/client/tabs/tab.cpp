@@ -7,13 +7,24 @@
 #include <QCloseEvent>
 #include <QDebug>
 #include <QScreen>
+#include <QShowEvent>
 
 Tab::Tab(TabSupervisor *_tabSupervisor)
-    : QMainWindow(_tabSupervisor), tabSupervisor(_tabSupervisor), contentsChanged(false), infoPopup(0)
+    : QMainWindow(_tabSupervisor), tabSupervisor(_tabSupervisor), contentsChanged(false), materialized(false),
+      infoPopup(0)
 {
     setAttribute(Qt::WA_DeleteOnClose);
 }
 
+void Tab::showEvent(QShowEvent *event)
+{
+    if (!materialized) {
+        materialized = true;
+        materializeContents();
+    }
+    QMainWindow::showEvent(event);
+}
+
 void Tab::showCardInfoPopup(const QPoint &pos, const CardRef &cardRef)
 {
     if (infoPopup) {
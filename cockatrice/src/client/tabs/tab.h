@@ -22,6 +22,18 @@ protected:
     {
         tabMenus.append(menu);
     }
+    /**
+     * Builds the parts of the tab that are only needed once it is looked at, like the lists that have to be requested
+     * from the server. Called once, the first time the tab is shown; tabs opened in the background never pay for it.
+     */
+    virtual void materializeContents()
+    {
+    }
+    bool getMaterialized() const
+    {
+        return materialized;
+    }
+    void showEvent(QShowEvent *event) override;
 protected slots:
     void showCardInfoPopup(const QPoint &pos, const CardRef &cardRef);
     void deleteCardInfoPopup(const QString &cardName);
@@ -29,6 +41,7 @@ protected slots:
 private:
     CardRef currentCard;
     bool contentsChanged;
+    bool materialized;
     CardInfoDisplayWidget *infoPopup;
     QList<QMenu *> tabMenus;
 
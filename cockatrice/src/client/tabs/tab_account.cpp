@@ -7,6 +7,7 @@
 #include "../../server/user/user_list_widget.h"
 #include "../game_logic/abstract_client.h"
 #include "../sound_engine.h"
+#include "pb/commands.pb.h"
 #include "pb/event_add_to_list.pb.h"
 #include "pb/event_remove_from_list.pb.h"
 #include "pb/event_user_joined.pb.h"
@@ -43,9 +44,7 @@ TabAccount::TabAccount(TabSupervisor *_tabSupervisor, AbstractClient *_client, c
     buddyListReceived(tabSupervisor->getUserListManager()->getBuddyList().values());
     ignoreListReceived(tabSupervisor->getUserListManager()->getIgnoreList().values());
 
-    PendingCommand *pend = AbstractClient::prepareSessionCommand(Command_ListUsers());
-    connect(pend, &PendingCommand::finished, this, &TabAccount::processListUsersResponse);
-    client->sendCommand(pend);
+    requestUsers(QString());
 
     auto *vbox = new QVBoxLayout;
     vbox->addWidget(userInfoBox);
@@ -132,20 +131,41 @@ void TabAccount::retranslateUi()
     userInfoBox->retranslateUi();
 }
 
-void TabAccount::processListUsersResponse(const Response &response)
+void TabAccount::requestUsers(const QString &afterName)
+{
+    Command_ListUsers cmd;
+    cmd.set_max_users(UserListManager::onlineUsersPageSize);
+    if (!afterName.isEmpty()) {
+        cmd.set_after_name(afterName.toStdString());
+        cmd.set_subscribe(false);
+    }
+
+    PendingCommand *pend = AbstractClient::prepareSessionCommand(cmd);
+    connect(pend, &PendingCommand::finished, this, &TabAccount::processListUsersResponse);
+    client->sendCommand(pend);
+}
+
+void TabAccount::processListUsersResponse(const Response &response, const CommandContainer &commandContainer)
 {
     const Response_ListUsers &resp = response.GetExtension(Response_ListUsers::ext);
-    for (int i = 0; i < resp.user_list_size(); ++i) {
-        const ServerInfo_User &info = resp.user_list(i);
+    const bool firstPage =
+        !commandContainer.session_command(0).GetExtension(Command_ListUsers::ext).has_after_name();
+    QList<ServerInfo_User> users;
+    for (const ServerInfo_User &info : resp.user_list()) {
         const QString &userName = QString::fromStdString(info.name());
-        allUsersList->processUserInfo(info, true);
+        if (firstPage)
+            users.append(info);
+        else
+            allUsersList->processUserInfo(info, true);
         ignoreList->setUserOnline(userName, true);
         buddyList->setUserOnline(userName, true);
     }
+    if (firstPage)
+        allUsersList->setUsers(users, true);
 
-    allUsersList->sortItems();
-    ignoreList->sortItems();
-    buddyList->sortItems();
+    // servers that don't know about pages send all users at once
+    if (resp.has_next_after_name())
+        requestUsers(QString::fromStdString(resp.next_after_name()));
 }
 
 void TabAccount::processUserJoinedEvent(const Event_UserJoined &event)
@@ -157,11 +177,7 @@ void TabAccount::processUserJoinedEvent(const Event_UserJoined &event)
     ignoreList->setUserOnline(userName, true);
     buddyList->setUserOnline(userName, true);
 
-    allUsersList->sortItems();
-    ignoreList->sortItems();
-    buddyList->sortItems();
-
-    if (buddyList->getUsers().keys().contains(userName)) {
+    if (buddyList->containsUser(userName)) {
         soundEngine->playSound("buddy_join");
     }
 
@@ -172,15 +188,13 @@ void TabAccount::processUserLeftEvent(const Event_UserLeft &event)
 {
     const QString &userName = QString::fromStdString(event.name());
 
-    if (buddyList->getUsers().keys().contains(userName)) {
+    if (buddyList->containsUser(userName)) {
         soundEngine->playSound("buddy_leave");
     }
 
     if (allUsersList->deleteUser(userName)) {
         ignoreList->setUserOnline(userName, false);
         buddyList->setUserOnline(userName, false);
-        ignoreList->sortItems();
-        buddyList->sortItems();
 
         emit userLeft(userName);
     }
@@ -191,7 +205,6 @@ void TabAccount::buddyListReceived(const QList<ServerInfo_User> &_buddyList)
     for (const auto &user : _buddyList) {
         buddyList->processUserInfo(user, false);
     }
-    buddyList->sortItems();
 }
 
 void TabAccount::ignoreListReceived(const QList<ServerInfo_User> &_ignoreList)
@@ -199,13 +212,12 @@ void TabAccount::ignoreListReceived(const QList<ServerInfo_User> &_ignoreList)
     for (const auto &user : _ignoreList) {
         ignoreList->processUserInfo(user, false);
     }
-    ignoreList->sortItems();
 }
 
 void TabAccount::processAddToListEvent(const Event_AddToList &event)
 {
     const ServerInfo_User &info = event.user_info();
-    const bool online = allUsersList->getUsers().contains(QString::fromStdString(info.name()));
+    const bool online = allUsersList->containsUser(QString::fromStdString(info.name()));
     const QString &list = QString::fromStdString(event.list_name());
 
     UserListWidget *userList;
@@ -218,7 +230,6 @@ void TabAccount::processAddToListEvent(const Event_AddToList &event)
     }
 
     userList->processUserInfo(info, online);
-    userList->sortItems();
 }
 
 void TabAccount::processRemoveFromListEvent(const Event_RemoveFromList &event)
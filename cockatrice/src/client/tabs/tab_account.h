@@ -5,6 +5,7 @@
 #include "tab.h"
 
 class AbstractClient;
+class CommandContainer;
 class Event_AddToList;
 class Event_ListRooms;
 class Event_RemoveFromList;
@@ -25,7 +26,7 @@ signals:
     void userJoined(const ServerInfo_User &userInfo);
 
 private slots:
-    void processListUsersResponse(const Response &response);
+    void processListUsersResponse(const Response &response, const CommandContainer &commandContainer);
     void processUserJoinedEvent(const Event_UserJoined &event);
     void processUserLeftEvent(const Event_UserLeft &event);
     void buddyListReceived(const QList<ServerInfo_User> &_buddyList);
@@ -44,6 +45,7 @@ private:
     LineEditUnfocusable *addBuddyEdit;
     LineEditUnfocusable *addIgnoreEdit;
     void addToList(const std::string &listName, const QString &userName);
+    void requestUsers(const QString &afterName);
 
 public:
     explicit TabAccount(TabSupervisor *_tabSupervisor, AbstractClient *_client, const ServerInfo_User &userInfo);
@@ -5,16 +5,46 @@
 #include "pb/admin_commands.pb.h"
 #include "pb/event_replay_added.pb.h"
 #include "pb/moderator_commands.pb.h"
+#include "pb/response_activity_top.pb.h"
 #include "trice_limits.h"
 
+#include <QCheckBox>
+#include <QComboBox>
 #include <QDialogButtonBox>
 #include <QGridLayout>
 #include <QGroupBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QSpinBox>
+#include <QTimer>
+#include <QTreeWidget>
+
+// how often the activity view asks for new figures while it is live
+static const int activityRefreshInterval = 2000;
+
+static QString formatBytes(quint64 bytes)
+{
+    if (bytes < 1024)
+        return QString::number(bytes) + " B";
+    if (bytes < 1024 * 1024)
+        return QString::number(bytes / 1024.0, 'f', 1) + " KiB";
+    return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MiB";
+}
+
+// fills the columns the games and sessions have in common, from the third one on, and aligns the figures
+static void fillActivityItem(QTreeWidgetItem *item, const Response_ActivityTop::Entry &entry)
+{
+    const double seconds = qMax(entry.window_msecs(), 1u) / 1000.0;
+    item->setText(2, QString::number(entry.commands() / seconds, 'f', 1));
+    item->setText(3, QString::number(entry.handler_microseconds() / 1000.0 / seconds, 'f', 1));
+    item->setText(4, formatBytes(static_cast<quint64>(entry.sent_bytes() / seconds)) + "/s");
+    for (int column = 2; column < 6; ++column)
+        item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+}
 
 ShutdownDialog::ShutdownDialog(QWidget *parent) : QDialog(parent)
 {
@@ -104,6 +134,46 @@ TabAdmin::TabAdmin(TabSupervisor *_tabSupervisor, AbstractClient *_client, bool
     moderatorGroupBox->setLayout(moderatorVBox);
     moderatorGroupBox->setEnabled(false);
 
+    activitySortBox = new QComboBox;
+    for (int i = 0; i < 5; ++i)
+        activitySortBox->addItem(QString());
+    activitySortBox->setItemData(0, Command_GetActivityTop::COMMANDS);
+    activitySortBox->setItemData(1, Command_GetActivityTop::HANDLER_TIME);
+    activitySortBox->setItemData(2, Command_GetActivityTop::SENT_BYTES);
+    activitySortBox->setItemData(3, Command_GetActivityTop::OUTPUT_QUEUE);
+    activitySortBox->setItemData(4, Command_GetActivityTop::REPLAY_SIZE);
+    connect(activitySortBox, qOverload<int>(&QComboBox::currentIndexChanged), this, &TabAdmin::actRefreshActivity);
+    activityLiveCheckBox = new QCheckBox;
+    connect(activityLiveCheckBox, &QCheckBox::toggled, this, &TabAdmin::actActivityLiveToggled);
+    activityRefreshButton = new QPushButton;
+    connect(activityRefreshButton, &QPushButton::clicked, this, &TabAdmin::actRefreshActivity);
+    activityTimer = new QTimer(this);
+    activityTimer->setInterval(activityRefreshInterval);
+    connect(activityTimer, &QTimer::timeout, this, &TabAdmin::actRefreshActivity);
+    activityRequestPending = false;
+
+    activityGamesTree = new QTreeWidget;
+    activityGamesTree->setColumnCount(6);
+    activityGamesTree->setRootIsDecorated(false);
+    activitySessionsTree = new QTreeWidget;
+    activitySessionsTree->setColumnCount(6);
+    activitySessionsTree->setRootIsDecorated(false);
+
+    auto *activityControlsLayout = new QHBoxLayout;
+    activityControlsLayout->addWidget(activitySortBox);
+    activityControlsLayout->addWidget(activityLiveCheckBox);
+    activityControlsLayout->addStretch();
+    activityControlsLayout->addWidget(activityRefreshButton);
+
+    auto *activityVBox = new QVBoxLayout;
+    activityVBox->addLayout(activityControlsLayout);
+    activityVBox->addWidget(activityGamesTree);
+    activityVBox->addWidget(activitySessionsTree);
+
+    activityGroupBox = new QGroupBox;
+    activityGroupBox->setLayout(activityVBox);
+    activityGroupBox->setEnabled(false);
+
     unlockButton = new QPushButton;
     connect(unlockButton, &QPushButton::clicked, this, &TabAdmin::actUnlock);
     lockButton = new QPushButton;
@@ -113,7 +183,7 @@ TabAdmin::TabAdmin(TabSupervisor *_tabSupervisor, AbstractClient *_client, bool
     QVBoxLayout *mainLayout = new QVBoxLayout;
     mainLayout->addWidget(adminGroupBox);
     mainLayout->addWidget(moderatorGroupBox);
-    mainLayout->addStretch();
+    mainLayout->addWidget(activityGroupBox, 1);
     mainLayout->addWidget(unlockButton);
     mainLayout->addWidget(lockButton);
 
@@ -140,6 +210,19 @@ void TabAdmin::retranslateUi()
     userToActivate->setPlaceholderText(tr("Username to Activate"));
     activateUserButton->setText(tr("Force Activate User"));
 
+    activityGroupBox->setTitle(tr("Server activity"));
+    activitySortBox->setItemText(0, tr("Sort by commands"));
+    activitySortBox->setItemText(1, tr("Sort by handler time"));
+    activitySortBox->setItemText(2, tr("Sort by bytes sent"));
+    activitySortBox->setItemText(3, tr("Sort by output queue"));
+    activitySortBox->setItemText(4, tr("Sort by replay size"));
+    activityLiveCheckBox->setText(tr("Refresh &live"));
+    activityRefreshButton->setText(tr("Re&fresh"));
+    activityGamesTree->setHeaderLabels(
+        {tr("Game"), tr("Description"), tr("Commands/s"), tr("Handler ms/s"), tr("Sent"), tr("Replay size")});
+    activitySessionsTree->setHeaderLabels(
+        {tr("Session"), tr("User"), tr("Commands/s"), tr("Handler ms/s"), tr("Sent"), tr("Output queue")});
+
     unlockButton->setText(tr("&Unlock functions"));
     lockButton->setText(tr("&Lock functions"));
 }
@@ -235,6 +318,61 @@ void TabAdmin::activateUserProcessResponse(const Response &response)
     }
 }
 
+void TabAdmin::actRefreshActivity()
+{
+    // a slow server doesn't get asked again before it answered
+    if (locked || activityRequestPending)
+        return;
+
+    Command_GetActivityTop cmd;
+    cmd.set_sort_by(static_cast<Command_GetActivityTop::SortKey>(activitySortBox->currentData().toInt()));
+
+    auto *pend = client->prepareModeratorCommand(cmd);
+    connect(pend,
+            QOverload<const Response &, const CommandContainer &, const QVariant &>::of(&PendingCommand::finished),
+            this, &TabAdmin::activityProcessResponse);
+    activityRequestPending = true;
+    client->sendCommand(pend);
+}
+
+void TabAdmin::actActivityLiveToggled(bool live)
+{
+    if (live) {
+        activityTimer->start();
+        actRefreshActivity();
+    } else {
+        activityTimer->stop();
+    }
+}
+
+void TabAdmin::activityProcessResponse(const Response &response)
+{
+    activityRequestPending = false;
+    if (response.response_code() != Response::RespOk) {
+        activityLiveCheckBox->setChecked(false);
+        QMessageBox::critical(this, tr("Error"), tr("The server didn't send its activity."));
+        return;
+    }
+
+    const Response_ActivityTop &resp = response.GetExtension(Response_ActivityTop::ext);
+    activityGamesTree->clear();
+    for (const Response_ActivityTop::Entry &entry : resp.game_list()) {
+        auto *item = new QTreeWidgetItem(activityGamesTree);
+        item->setText(0, QString::number(entry.id()));
+        item->setText(1, QString::fromStdString(entry.name()));
+        fillActivityItem(item, entry);
+        item->setText(5, formatBytes(entry.replay_bytes()));
+    }
+    activitySessionsTree->clear();
+    for (const Response_ActivityTop::Entry &entry : resp.session_list()) {
+        auto *item = new QTreeWidgetItem(activitySessionsTree);
+        item->setText(0, entry.id() < 0 ? QString() : QString::number(entry.id()));
+        item->setText(1, QString::fromStdString(entry.name()));
+        fillActivityItem(item, entry);
+        item->setText(5, formatBytes(entry.output_queue_bytes()));
+    }
+}
+
 void TabAdmin::actUnlock()
 {
     if (fullAdmin) {
@@ -242,6 +380,7 @@ void TabAdmin::actUnlock()
     }
 
     moderatorGroupBox->setEnabled(true);
+    activityGroupBox->setEnabled(true);
     lockButton->setEnabled(true);
     unlockButton->setEnabled(false);
     locked = false;
@@ -256,6 +395,8 @@ void TabAdmin::actLock()
     }
 
     moderatorGroupBox->setEnabled(false);
+    activityGroupBox->setEnabled(false);
+    activityLiveCheckBox->setChecked(false);
     lockButton->setEnabled(false);
     unlockButton->setEnabled(true);
     locked = true;
@@ -9,10 +9,14 @@
 
 class AbstractClient;
 
+class QCheckBox;
+class QComboBox;
 class QGroupBox;
 class QPushButton;
 class QSpinBox;
 class QLineEdit;
+class QTimer;
+class QTreeWidget;
 
 class ShutdownDialog : public QDialog
 {
@@ -36,9 +40,17 @@ private:
     bool fullAdmin;
     QPushButton *updateServerMessageButton, *shutdownServerButton, *reloadConfigButton, *grantReplayAccessButton,
         *activateUserButton;
-    QGroupBox *adminGroupBox, *moderatorGroupBox;
+    QGroupBox *adminGroupBox, *moderatorGroupBox, *activityGroupBox;
     QPushButton *unlockButton, *lockButton;
     QLineEdit *replayIdToGrant, *userToActivate;
+
+    // the busiest games and sessions of the server, see Command_GetActivityTop
+    QComboBox *activitySortBox;
+    QCheckBox *activityLiveCheckBox;
+    QPushButton *activityRefreshButton;
+    QTreeWidget *activityGamesTree, *activitySessionsTree;
+    QTimer *activityTimer;
+    bool activityRequestPending;
 signals:
     void adminLockChanged(bool lock);
 private slots:
@@ -49,6 +61,9 @@ private slots:
     void actForceActivateUser();
     void grantReplayAccessProcessResponse(const Response &response);
     void activateUserProcessResponse(const Response &response);
+    void actRefreshActivity();
+    void actActivityLiveToggled(bool live);
+    void activityProcessResponse(const Response &response);
 
     void actUnlock();
     void actLock();
@@ -220,10 +220,18 @@ void TabDeckStorage::setRemoteEnabled(bool enabled)
     aNewFolder->setEnabled(enabled);
     aDeleteRemoteDeck->setEnabled(enabled);
 
-    if (enabled) {
-        serverDirView->refreshTree();
-    } else {
+    // the server list is only requested once the tab is looked at
+    if (!enabled) {
         serverDirView->clearTree();
+    } else if (getMaterialized()) {
+        serverDirView->refreshTree();
+    }
+}
+
+void TabDeckStorage::materializeContents()
+{
+    if (aOpenRemoteDeck->isEnabled()) {
+        serverDirView->refreshTree();
     }
 }
 
@@ -34,6 +34,8 @@
 #include "pb/context_connection_state_changed.pb.h"
 #include "pb/context_deck_select.pb.h"
 #include "pb/context_ping_changed.pb.h"
+#include "pb/event_create_token.pb.h"
+#include "pb/event_draw_cards.pb.h"
 #include "pb/event_game_closed.pb.h"
 #include "pb/event_game_host_changed.pb.h"
 #include "pb/event_game_joined.pb.h"
@@ -42,7 +44,10 @@
 #include "pb/event_join.pb.h"
 #include "pb/event_kicked.pb.h"
 #include "pb/event_leave.pb.h"
+#include "pb/event_move_card.pb.h"
+#include "pb/event_player_pings.pb.h"
 #include "pb/event_player_properties_changed.pb.h"
+#include "pb/event_reveal_cards.pb.h"
 #include "pb/event_reverse_turn.pb.h"
 #include "pb/event_set_active_phase.pb.h"
 #include "pb/event_set_active_player.pb.h"
@@ -66,10 +71,11 @@
 #include <QToolButton>
 #include <QWidget>
 
-TabGame::TabGame(TabSupervisor *_tabSupervisor, GameReplay *_replay)
+TabGame::TabGame(TabSupervisor *_tabSupervisor, ReplayFile *_replay)
     : Tab(_tabSupervisor), secondsElapsed(0), hostId(-1), localPlayerId(-1),
       isLocalGame(_tabSupervisor->getIsLocalGame()), spectator(true), judge(false), gameStateKnown(false),
-      resuming(false), currentPhase(-1), activeCard(nullptr), gameClosed(false), sayLabel(nullptr), sayEdit(nullptr)
+      resuming(false), currentPhase(-1), activeCard(nullptr), gameClosed(false), presentationSuspended(false),
+      sayLabel(nullptr), sayEdit(nullptr)
 {
     // THIS CTOR IS USED ON REPLAY
 
@@ -109,7 +115,7 @@ TabGame::TabGame(TabSupervisor *_tabSupervisor,
       gameInfo(event.game_info()), roomGameTypes(_roomGameTypes), hostId(event.host_id()),
       localPlayerId(event.player_id()), isLocalGame(_tabSupervisor->getIsLocalGame()), spectator(event.spectator()),
       judge(event.judge()), gameStateKnown(false), resuming(event.resuming()), currentPhase(-1), activeCard(nullptr),
-      gameClosed(false)
+      gameClosed(false), presentationSuspended(false)
 {
     // THIS CTOR IS USED ON GAMES
     gameInfo.set_started(false);
@@ -146,9 +152,9 @@ TabGame::TabGame(TabSupervisor *_tabSupervisor,
     QTimer::singleShot(0, this, &TabGame::loadLayout);
 }
 
-void TabGame::loadReplay(GameReplay *replay)
+void TabGame::loadReplay(ReplayFile *replay)
 {
-    gameInfo.CopyFrom(replay->game_info());
+    gameInfo.CopyFrom(replay->getHeader().game_info());
     gameInfo.set_spectators_omniscient(true);
 }
 
@@ -175,6 +181,9 @@ void TabGame::resetChatAndPhase()
 
 void TabGame::emitUserEvent()
 {
+    if (presentationSuspended) {
+        return;
+    }
     bool globalEvent = !spectator || SettingsCache::instance().getSpectatorNotificationsEnabled();
     emit userEvent(globalEvent);
     updatePlayerListDockTitle();
@@ -537,13 +546,19 @@ void TabGame::actRemoveLocalArrows()
         Player *player = playerIterator.next().value();
         if (!player->getLocal())
             continue;
+        if (player->getArrows().isEmpty())
+            continue;
+
+        // one container for all arrows, the server applies it in one go and answers with a single event container
+        QList<const ::google::protobuf::Message *> commandList;
         QMapIterator<int, ArrowItem *> arrowIterator(player->getArrows());
         while (arrowIterator.hasNext()) {
             ArrowItem *a = arrowIterator.next().value();
-            Command_DeleteArrow cmd;
-            cmd.set_arrow_id(a->getId());
-            sendGameCommand(cmd);
+            auto *cmd = new Command_DeleteArrow;
+            cmd->set_arrow_id(a->getId());
+            commandList.append(cmd);
         }
+        player->sendGameCommand(player->prepareGameCommand(commandList));
     }
 }
 
@@ -630,6 +645,24 @@ void TabGame::processGameEventContainer(const GameEventContainer &cont,
                                         AbstractClient *client,
                                         Player::EventProcessingOptions options)
 {
+    // the server may send the card names of large events by id, replays always spell them out
+    if (client && CardNameDictionary::carriesCardNames(cont)) {
+        GameEventContainer decoded(cont);
+        cardNames[client].decode(decoded);
+        applyGameEventContainer(decoded, client, options);
+    } else {
+        applyGameEventContainer(cont, client, options);
+    }
+}
+
+void TabGame::applyGameEventContainer(const GameEventContainer &cont,
+                                      AbstractClient *client,
+                                      Player::EventProcessingOptions options)
+{
+    prefetchCardPictures(cont);
+    // the zones the events change are laid out once, after the whole container
+    setZoneLayoutsSuspended(true);
+
     const GameEventContext &context = cont.context();
     messageLog->containerProcessingStarted(context);
     const int eventListSize = cont.event_list_size();
@@ -672,6 +705,12 @@ void TabGame::processGameEventContainer(const GameEventContainer &cont,
                     eventPlayerPropertiesChanged(event.GetExtension(Event_PlayerPropertiesChanged::ext), playerId,
                                                  context);
                     break;
+                case GameEvent::PLAYER_PINGS:
+                    eventPlayerPings(event.GetExtension(Event_PlayerPings::ext), playerId, context);
+                    break;
+                case GameEvent::CARD_NAMES:
+                    // taken in by processGameEventContainer()
+                    break;
                 case GameEvent::JOIN:
                     eventJoin(event.GetExtension(Event_Join::ext), playerId, context);
                     break;
@@ -710,6 +749,86 @@ void TabGame::processGameEventContainer(const GameEventContainer &cont,
         }
     }
     messageLog->containerProcessingDone();
+    setZoneLayoutsSuspended(false);
+}
+
+void TabGame::saveReplayKeyframe(ReplayKeyframe &keyframe) const
+{
+    Event_GameStateChanged &gameState = keyframe.gameState;
+    for (const Player *player : players) {
+        player->writePlayerInfo(*gameState.add_player_list());
+    }
+    gameState.set_game_started(gameInfo.started());
+    gameState.set_active_player_id(activePlayer);
+    gameState.set_active_phase(currentPhase);
+    gameState.set_seconds_elapsed(secondsElapsed);
+    keyframe.messageLogLength = messageLog->getChatLength();
+}
+
+void TabGame::setZoneLayoutsSuspended(bool suspended)
+{
+    for (Player *player : players) {
+        for (CardZone *zone : player->getZones()) {
+            if (suspended) {
+                zone->suspendLayout();
+            } else {
+                zone->resumeLayout();
+            }
+        }
+    }
+}
+
+/**
+ * Used while the tab is in the background: the scene is neither painted nor animated and no pictures are prefetched
+ * for the events, the card items load what they show once they are painted again. Resuming repaints the whole view.
+ */
+void TabGame::setRenderingSuspended(bool suspended)
+{
+    gameView->setSuspended(suspended);
+    scene->setSuspended(suspended);
+}
+
+/**
+ * Used while many events are applied at once, as when skipping through a replay: the events only update the game,
+ * while the zones put off laying out their cards and the message log is neither painted nor played. Resuming lays out
+ * every zone that changed once.
+ */
+void TabGame::setPresentationSuspended(bool suspended)
+{
+    if (presentationSuspended == suspended) {
+        return;
+    }
+    presentationSuspended = suspended;
+
+    setZoneLayoutsSuspended(suspended);
+    messageLog->setPresentationSuspended(suspended);
+
+    if (!suspended) {
+        emitUserEvent();
+    }
+}
+
+/**
+ * Puts the game back in the state of the keyframe, through the same path as joining a game. Returns false if the
+ * keyframe can't be restored because players joined or left, or the game started or stopped, since it was taken.
+ */
+bool TabGame::restoreReplayKeyframe(const ReplayKeyframe &keyframe)
+{
+    const Event_GameStateChanged &gameState = keyframe.gameState;
+    if (gameState.game_started() != gameInfo.started() || gameState.player_list_size() != players.size()) {
+        return false;
+    }
+    for (const ServerInfo_Player &playerInfo : gameState.player_list()) {
+        if (!players.contains(playerInfo.properties().player_id())) {
+            return false;
+        }
+    }
+
+    messageLog->truncateChat(keyframe.messageLogLength);
+    eventGameStateChanged(gameState, -1, GameEventContext());
+    setActivePlayer(gameState.active_player_id());
+    setActivePhase(gameState.active_phase());
+    return true;
 }
 
 AbstractClient *TabGame::getClientForPlayer(int playerId) const
@@ -773,6 +892,54 @@ PendingCommand *TabGame::prepareGameCommand(const QList<const ::google::protobuf
     return new PendingCommand(cont);
 }
 
+/**
+ * Queues the pictures of the cards the events are about to show, so they are loading before the card items paint.
+ */
+void TabGame::prefetchCardPictures(const GameEventContainer &cont)
+{
+    if (gameView->getSuspended()) {
+        return;
+    }
+
+    QList<CardRef> cardRefs;
+    for (int i = 0; i < cont.event_list_size(); ++i) {
+        const GameEvent &event = cont.event_list(i);
+        switch (static_cast<GameEvent::GameEventType>(getPbExtension(event))) {
+            case GameEvent::MOVE_CARD: {
+                // the name is only set when the card is visible after the move
+                const Event_MoveCard &moveCard = event.GetExtension(Event_MoveCard::ext);
+                if (!moveCard.card_name().empty()) {
+                    cardRefs.append({QString::fromStdString(moveCard.card_name()),
+                                     QString::fromStdString(moveCard.new_card_provider_id())});
+                }
+                break;
+            }
+            case GameEvent::DRAW_CARDS:
+                for (const ServerInfo_Card &card : event.GetExtension(Event_DrawCards::ext).cards()) {
+                    cardRefs.append({QString::fromStdString(card.name()), QString::fromStdString(card.provider_id())});
+                }
+                break;
+            case GameEvent::REVEAL_CARDS:
+                for (const ServerInfo_Card &card : event.GetExtension(Event_RevealCards::ext).cards()) {
+                    cardRefs.append({QString::fromStdString(card.name()), QString::fromStdString(card.provider_id())});
+                }
+                break;
+            case GameEvent::CREATE_TOKEN: {
+                const Event_CreateToken &createToken = event.GetExtension(Event_CreateToken::ext);
+                cardRefs.append({QString::fromStdString(createToken.card_name()),
+                                 QString::fromStdString(createToken.card_provider_id())});
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    if (!cardRefs.isEmpty()) {
+        PictureLoader::cacheCardPixmaps(CardDatabaseManager::getInstance()->getCards(cardRefs));
+    }
+}
+
 void TabGame::startGame(bool _resuming)
 {
     currentPhase = -1;
@@ -793,6 +960,15 @@ void TabGame::startGame(bool _resuming)
             playerIterator.next().value()->setGameStarted();
     }
 
+    // the rest of the own deck is loaded while nothing more urgent is
+    for (Player *player : players) {
+        if (player->getLocal() && player->getDeck()) {
+            PictureLoader::cacheCardPixmaps(
+                CardDatabaseManager::getInstance()->getCards(player->getDeck()->getCardRefList()),
+                PictureLoadPriority::Background);
+        }
+    }
+
     playerListWidget->setGameStarted(true, resuming);
     gameInfo.set_started(true);
     static_cast<GameScene *>(gameView->scene())->rearrange();
@@ -973,6 +1149,22 @@ void TabGame::eventPlayerPropertiesChanged(const Event_PlayerPropertiesChanged &
     }
 }
 
+void TabGame::eventPlayerPings(const Event_PlayerPings &event,
+                               int /*eventPlayerId*/,
+                               const GameEventContext & /*context*/)
+{
+    const int count = qMin(event.player_id_size(), event.ping_seconds_size());
+    for (int i = 0; i < count; ++i) {
+        const int playerId = event.player_id(i);
+        if (!players.contains(playerId))
+            continue;
+
+        ServerInfo_PlayerProperties prop;
+        prop.set_ping_seconds(event.ping_seconds(i));
+        playerListWidget->updatePlayerProperties(prop, playerId);
+    }
+}
+
 void TabGame::eventJoin(const Event_Join &event, int /*eventPlayerId*/, const GameEventContext & /*context*/)
 {
     const ServerInfo_PlayerProperties &playerInfo = event.player_properties();
@@ -1482,6 +1674,8 @@ void TabGame::createPlayAreaWidget(bool bReplay)
                 qOverload<const ::google::protobuf::Message &, int>(&TabGame::sendGameCommand));
     scene = new GameScene(phasesToolbar, this);
     gameView = new GameView(scene);
+    // until the tab is first shown, it might have been opened in the background
+    setRenderingSuspended(true);
 
     auto gamePlayAreaVBox = new QVBoxLayout;
     gamePlayAreaVBox->setContentsMargins(0, 0, 0, 0);
@@ -1492,7 +1686,7 @@ void TabGame::createPlayAreaWidget(bool bReplay)
     gamePlayAreaWidget->setLayout(gamePlayAreaVBox);
 }
 
-void TabGame::createReplayDock(GameReplay *replay)
+void TabGame::createReplayDock(ReplayFile *replay)
 {
     replayManager = new ReplayManager(this, replay);
 
@@ -1655,8 +1849,16 @@ void TabGame::createMessageDock(bool bReplay)
     connect(messageLayoutDock, &QDockWidget::topLevelChanged, this, &TabGame::dockTopLevelChanged);
 }
 
+void TabGame::showEvent(QShowEvent *event)
+{
+    setRenderingSuspended(false);
+    Tab::showEvent(event);
+}
+
 void TabGame::hideEvent(QHideEvent *event)
 {
+    setRenderingSuspended(true);
+
     LayoutsSettings &layouts = SettingsCache::instance().layouts();
     if (replayManager->replay) {
         layouts.setReplayPlayAreaState(saveState());
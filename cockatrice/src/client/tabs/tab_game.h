@@ -3,8 +3,10 @@
 
 #include "../../client/tearoff_menu.h"
 #include "../../game/player/player.h"
+#include "../../settings/settings_manager.h"
 #include "../replay_manager.h"
 #include "../ui/widgets/visual_deck_storage/visual_deck_storage_widget.h"
+#include "card_name_dictionary.h"
 #include "pb/event_leave.pb.h"
 #include "pb/serverinfo_game.pb.h"
 #include "tab.h"
@@ -42,6 +44,7 @@ class CommandContainer;
 class Event_GameJoined;
 class Event_GameStateChanged;
 class Event_PlayerPropertiesChanged;
+class Event_PlayerPings;
 class Event_Join;
 class Event_Leave;
 class Event_GameHostChanged;
@@ -59,7 +62,6 @@ class CardItem;
 class DeckLoader;
 class QVBoxLayout;
 class QHBoxLayout;
-class GameReplay;
 class ServerInfo_User;
 class PendingCommand;
 class LineEditCompleter;
@@ -74,6 +76,8 @@ private:
     int secondsElapsed;
     const UserListProxy *userListProxy;
     QList<AbstractClient *> clients;
+    // the card names the server sent each client by id, see CardNameDictionary
+    QMap<AbstractClient *, CardNameDictionary> cardNames;
     ServerInfo_Game gameInfo;
     QMap<int, QString> roomGameTypes;
     int hostId;
@@ -90,6 +94,8 @@ private:
     int activePlayer;
     CardItem *activeCard;
     bool gameClosed;
+    bool presentationSuspended;
+    SettingsManager::ReadAudit settingsReadAudit;
     ReplayManager *replayManager;
     QStringList gameTypes;
     QCompleter *completer;
@@ -123,6 +129,10 @@ private:
 
     bool isMainPlayerConceded() const;
 
+    void prefetchCardPictures(const GameEventContainer &cont);
+    void applyGameEventContainer(const GameEventContainer &cont,
+                                 AbstractClient *client,
+                                 Player::EventProcessingOptions options);
     void startGame(bool resuming);
     void stopGame();
     void closeGame();
@@ -135,12 +145,15 @@ private:
     void eventPlayerPropertiesChanged(const Event_PlayerPropertiesChanged &event,
                                       int eventPlayerId,
                                       const GameEventContext &context);
+    void eventPlayerPings(const Event_PlayerPings &event, int eventPlayerId, const GameEventContext &context);
     void eventJoin(const Event_Join &event, int eventPlayerId, const GameEventContext &context);
     void eventLeave(const Event_Leave &event, int eventPlayerId, const GameEventContext &context);
     void eventKicked(const Event_Kicked &event, int eventPlayerId, const GameEventContext &context);
     void eventGameHostChanged(const Event_GameHostChanged &event, int eventPlayerId, const GameEventContext &context);
     void eventGameClosed(const Event_GameClosed &event, int eventPlayerId, const GameEventContext &context);
     Player *setActivePlayer(int id);
+    void setZoneLayoutsSuspended(bool suspended);
+    void setRenderingSuspended(bool suspended);
     void eventSetActivePlayer(const Event_SetActivePlayer &event, int eventPlayerId, const GameEventContext &context);
     void setActivePhase(int phase);
     void eventSetActivePhase(const Event_SetActivePhase &event, int eventPlayerId, const GameEventContext &context);
@@ -155,7 +168,7 @@ private:
     void createMessageDock(bool bReplay = false);
     void createPlayAreaWidget(bool bReplay = false);
     void createDeckViewContainerWidget(bool bReplay = false);
-    void createReplayDock(GameReplay *replay);
+    void createReplayDock(ReplayFile *replay);
     QString getLeaveReason(Event_Leave::LeaveReason reason);
 signals:
     void gameClosing(TabGame *tab);
@@ -196,6 +209,7 @@ private slots:
     void actResetLayout();
     void freeDocksSize();
 
+    void showEvent(QShowEvent *event) override;
     void hideEvent(QHideEvent *event) override;
     bool eventFilter(QObject *o, QEvent *e) override;
     void dockVisibleTriggered();
@@ -210,8 +224,8 @@ public:
             QList<AbstractClient *> &_clients,
             const Event_GameJoined &event,
             const QMap<int, QString> &_roomGameTypes);
-    void loadReplay(GameReplay *replay);
-    TabGame(TabSupervisor *_tabSupervisor, GameReplay *replay);
+    void loadReplay(ReplayFile *replay);
+    TabGame(TabSupervisor *_tabSupervisor, ReplayFile *replay);
     ~TabGame() override;
     void retranslateUi() override;
     void updatePlayerListDockTitle();
@@ -255,6 +269,9 @@ public:
     void processGameEventContainer(const GameEventContainer &cont,
                                    AbstractClient *client,
                                    Player::EventProcessingOptions options);
+    void saveReplayKeyframe(ReplayKeyframe &keyframe) const;
+    void setPresentationSuspended(bool suspended);
+    bool restoreReplayKeyframe(const ReplayKeyframe &keyframe);
     PendingCommand *prepareGameCommand(const ::google::protobuf::Message &cmd);
     PendingCommand *prepareGameCommand(const QList<const ::google::protobuf::Message *> &cmdList);
 public slots:
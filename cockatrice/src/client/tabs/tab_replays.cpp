@@ -8,14 +8,16 @@
 #include "pb/command_replay_download.pb.h"
 #include "pb/command_replay_modify_match.pb.h"
 #include "pb/event_replay_added.pb.h"
-#include "pb/game_replay.pb.h"
 #include "pb/response.pb.h"
 #include "pb/response_replay_download.pb.h"
+#include "replay_compression.h"
+#include "replay_file.h"
 #include "tab_game.h"
 
 #include <QAction>
 #include <QApplication>
 #include <QDesktopServices>
+#include <QDirIterator>
 #include <QFileSystemModel>
 #include <QGroupBox>
 #include <QHBoxLayout>
@@ -28,7 +30,7 @@
 #include <QVBoxLayout>
 
 TabReplays::TabReplays(TabSupervisor *_tabSupervisor, AbstractClient *_client, const ServerInfo_User *currentUserInfo)
-    : Tab(_tabSupervisor), client(_client)
+    : Tab(_tabSupervisor), client(_client), nextRemoteReplayDownloadId(0)
 {
     localDirModel = new QFileSystemModel(this);
     localDirModel->setRootPath(SettingsCache::instance().getReplaysPath());
@@ -107,6 +109,9 @@ TabReplays::TabReplays(TabSupervisor *_tabSupervisor, AbstractClient *_client, c
     aDeleteLocalReplay = new QAction(this);
     aDeleteLocalReplay->setIcon(QPixmap("theme:icons/remove_row"));
     connect(aDeleteLocalReplay, &QAction::triggered, this, &TabReplays::actDeleteLocalReplay);
+    aConvertLocal = new QAction(this);
+    aConvertLocal->setIcon(qApp->style()->standardIcon(QStyle::SP_BrowserReload));
+    connect(aConvertLocal, &QAction::triggered, this, &TabReplays::actConvertLocal);
 
     aOpenReplaysFolder = new QAction(this);
     aOpenReplaysFolder->setIcon(qApp->style()->standardIcon(QStyle::SP_DirOpenIcon));
@@ -132,6 +137,7 @@ TabReplays::TabReplays(TabSupervisor *_tabSupervisor, AbstractClient *_client, c
     leftToolBar->addAction(aRenameLocal);
     leftToolBar->addAction(aNewLocalFolder);
     leftToolBar->addAction(aDeleteLocalReplay);
+    leftToolBar->addAction(aConvertLocal);
 
     leftRightmostToolBar->addAction(aOpenReplaysFolder);
 
@@ -162,6 +168,7 @@ void TabReplays::retranslateUi()
     aRenameLocal->setText(tr("Rename"));
     aNewLocalFolder->setText(tr("New folder"));
     aDeleteLocalReplay->setText(tr("Delete"));
+    aConvertLocal->setText(tr("Convert to indexed format"));
     aOpenReplaysFolder->setText(tr("Open replays folder"));
     aOpenRemoteReplay->setText(tr("Watch replay"));
     aDownload->setText(tr("Download replay"));
@@ -191,10 +198,18 @@ void TabReplays::setRemoteEnabled(bool enabled)
     aKeep->setEnabled(enabled);
     aDeleteRemoteReplay->setEnabled(enabled);
 
-    if (enabled) {
-        serverDirView->refreshTree();
-    } else {
+    // the server list is only requested once the tab is looked at
+    if (!enabled) {
         serverDirView->clearTree();
+    } else if (getMaterialized()) {
+        serverDirView->refreshTree();
+    }
+}
+
+void TabReplays::materializeContents()
+{
+    if (aOpenRemoteReplay->isEnabled()) {
+        serverDirView->refreshTree();
     }
 }
 
@@ -219,10 +234,9 @@ void TabReplays::actOpenLocalReplay()
         QByteArray _data = f.readAll();
         f.close();
 
-        GameReplay *replay = new GameReplay;
-        replay->ParseFromArray(_data.data(), _data.size());
-
-        emit openReplay(replay);
+        ReplayFile *replay = ReplayFile::fromData(_data);
+        if (replay)
+            emit openReplay(replay);
     }
 }
 
@@ -296,6 +310,39 @@ void TabReplays::actDeleteLocalReplay()
     }
 }
 
+/**
+ * Rewrites the selected replays, and all replays in the selected folders, in the indexed format that opens without
+ * reading all of the events first.
+ */
+void TabReplays::actConvertLocal()
+{
+    QStringList filePaths;
+    for (const auto &curLeft : localDirView->selectionModel()->selectedRows()) {
+        const QString path = localDirModel->filePath(curLeft);
+        if (!localDirModel->isDir(curLeft)) {
+            filePaths.append(path);
+            continue;
+        }
+        QDirIterator it(path, {"*.cor"}, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            filePaths.append(it.next());
+        }
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    int failed = 0;
+    for (const QString &filePath : filePaths) {
+        if (!ReplayFile::convertFile(filePath)) {
+            ++failed;
+        }
+    }
+    QApplication::restoreOverrideCursor();
+
+    if (failed > 0) {
+        QMessageBox::critical(this, tr("Error"), tr("%n replay(s) could not be converted.", "", failed));
+    }
+}
+
 void TabReplays::actOpenReplaysFolder()
 {
     QString dir = localDirModel->rootPath();
@@ -318,27 +365,10 @@ void TabReplays::actOpenRemoteReplay()
             continue;
         }
 
-        Command_ReplayDownload cmd;
-        cmd.set_replay_id(curRight->replay_id());
-
-        PendingCommand *pend = client->prepareSessionCommand(cmd);
-        connect(pend, &PendingCommand::finished, this, &TabReplays::openRemoteReplayFinished);
-        client->sendCommand(pend);
+        startRemoteReplayDownload(curRight->replay_id(), QString());
     }
 }
 
-void TabReplays::openRemoteReplayFinished(const Response &r)
-{
-    if (r.response_code() != Response::RespOk)
-        return;
-
-    const Response_ReplayDownload &resp = r.GetExtension(Response_ReplayDownload::ext);
-    GameReplay *replay = new GameReplay;
-    replay->ParseFromString(resp.replay_data());
-
-    emit openReplay(replay);
-}
-
 void TabReplays::actDownload()
 {
     QModelIndex curLeft = localDirView->selectionModel()->currentIndex();
@@ -371,32 +401,79 @@ void TabReplays::downloadNodeAtIndex(const QModelIndex &curLeft, const QModelInd
         const QString dirPath = curLeft.isValid() ? localDirModel->filePath(curLeft) : localDirModel->rootPath();
         const QString filePath = dirPath + QString("/replay_%1.cor").arg(replay->replay_id());
 
-        Command_ReplayDownload cmd;
-        cmd.set_replay_id(replay->replay_id());
-
-        PendingCommand *pend = client->prepareSessionCommand(cmd);
-        pend->setExtraData(filePath);
-        connect(pend, &PendingCommand::finished, this, &TabReplays::downloadFinished);
-        client->sendCommand(pend);
+        startRemoteReplayDownload(replay->replay_id(), filePath);
     }
     // node at index was invalid
 }
 
-void TabReplays::downloadFinished(const Response &r,
-                                  const CommandContainer & /* commandContainer */,
-                                  const QVariant &extraData)
+void TabReplays::startRemoteReplayDownload(int replayId, const QString &filePath)
 {
-    if (r.response_code() != Response::RespOk)
+    const int downloadId = nextRemoteReplayDownloadId++;
+    remoteReplayDownloads.insert(downloadId, {replayId, filePath, QByteArray()});
+    requestRemoteReplayChunk(downloadId);
+}
+
+void TabReplays::requestRemoteReplayChunk(int downloadId)
+{
+    // Long replays are fetched a chunk at a time, the next one is only requested once the previous one arrived, so
+    // that game events don't have to wait for a download of several megabytes.
+    static const int replayChunkSize = 256 * 1024;
+
+    const RemoteReplayDownload &download = remoteReplayDownloads[downloadId];
+    Command_ReplayDownload cmd;
+    cmd.set_replay_id(download.replayId);
+    cmd.set_offset(download.data.size());
+    cmd.set_max_length(replayChunkSize);
+
+    PendingCommand *pend = client->prepareSessionCommand(cmd);
+    pend->setExtraData(downloadId);
+    connect(pend, &PendingCommand::finished, this, &TabReplays::remoteReplayChunkReceived);
+    client->sendCommand(pend);
+}
+
+void TabReplays::remoteReplayChunkReceived(const Response &r,
+                                           const CommandContainer & /* commandContainer */,
+                                           const QVariant &extraData)
+{
+    const int downloadId = extraData.toInt();
+    auto download = remoteReplayDownloads.find(downloadId);
+    if (download == remoteReplayDownloads.end())
         return;
+    if (r.response_code() != Response::RespOk) {
+        remoteReplayDownloads.erase(download);
+        return;
+    }
 
     const Response_ReplayDownload &resp = r.GetExtension(Response_ReplayDownload::ext);
-    QString filePath = extraData.toString();
+    const std::string &chunk = resp.replay_data();
+    download->data.append(chunk.data(), static_cast<int>(chunk.size()));
+    // servers that don't know about chunks send the whole replay without its size
+    if (resp.has_total_size() && !chunk.empty() && static_cast<quint32>(download->data.size()) < resp.total_size()) {
+        requestRemoteReplayChunk(downloadId);
+        return;
+    }
 
-    const std::string &_data = resp.replay_data();
-    QFile f(filePath);
-    f.open(QIODevice::WriteOnly);
-    f.write((const char *)_data.data(), _data.size());
-    f.close();
+    RemoteReplayDownload finished = *download;
+    remoteReplayDownloads.erase(download);
+    // the feature is advertised, so the replay comes as the server stored it
+    QByteArray replayData;
+    if (!ReplayCompression::uncompress(finished.data, replayData))
+        return;
+    finished.data = replayData;
+
+    if (finished.filePath.isEmpty()) {
+        ReplayFile *replay = ReplayFile::fromData(finished.data);
+        if (replay)
+            emit openReplay(replay);
+    } else {
+        // downloads are kept in the indexed format, so they open quickly later on
+        GameReplay replay;
+        replay.ParseFromArray(finished.data.constData(), finished.data.size());
+        QFile f(finished.filePath);
+        f.open(QIODevice::WriteOnly);
+        f.write(ReplayFile::toIndexed(replay));
+        f.close();
+    }
 }
 
 void TabReplays::actKeepRemoteReplay()
@@ -468,6 +545,10 @@ void TabReplays::deleteRemoteReplayFinished(const Response &r, const CommandCont
 
 void TabReplays::replayAddedEventReceived(const Event_ReplayAdded &event)
 {
+    // the replay is in the list that is requested when the tab is first shown
+    if (!getMaterialized()) {
+        return;
+    }
     if (event.has_match_info()) {
         // 99.9% of events will have match info (Normal Workflow)
         serverDirView->addMatchInfo(event.match_info());
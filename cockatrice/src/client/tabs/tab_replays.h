@@ -4,6 +4,9 @@
 #include "../game_logic/abstract_client.h"
 #include "tab.h"
 
+#include <QByteArray>
+#include <QMap>
+
 class ServerInfo_User;
 class Response;
 class AbstractClient;
@@ -12,7 +15,7 @@ class QFileSystemModel;
 class QToolBar;
 class QGroupBox;
 class RemoteReplayList_TreeWidget;
-class GameReplay;
+class ReplayFile;
 class Event_ReplayAdded;
 class CommandContainer;
 
@@ -27,13 +30,26 @@ private:
     RemoteReplayList_TreeWidget *serverDirView;
     QGroupBox *leftGroupBox, *rightGroupBox;
 
-    QAction *aOpenLocalReplay, *aRenameLocal, *aNewLocalFolder, *aDeleteLocalReplay;
+    QAction *aOpenLocalReplay, *aRenameLocal, *aNewLocalFolder, *aDeleteLocalReplay, *aConvertLocal;
     QAction *aOpenReplaysFolder;
     QAction *aOpenRemoteReplay, *aDownload, *aKeep, *aDeleteRemoteReplay;
 
+    struct RemoteReplayDownload
+    {
+        int replayId;
+        // where to save the replay, it is opened if there is none
+        QString filePath;
+        QByteArray data;
+    };
+    // by download id
+    QMap<int, RemoteReplayDownload> remoteReplayDownloads;
+    int nextRemoteReplayDownloadId;
+
     void setRemoteEnabled(bool enabled);
 
     void downloadNodeAtIndex(const QModelIndex &curLeft, const QModelIndex &curRight);
+    void startRemoteReplayDownload(int replayId, const QString &filePath);
+    void requestRemoteReplayChunk(int downloadId);
 
 private slots:
     void handleConnected(const ServerInfo_User &userInfo);
@@ -44,15 +60,17 @@ private slots:
     void actOpenLocalReplay();
     void actNewLocalFolder();
     void actDeleteLocalReplay();
+    void actConvertLocal();
 
     void actOpenReplaysFolder();
 
     void actRemoteDoubleClick(const QModelIndex &curLeft);
     void actOpenRemoteReplay();
-    void openRemoteReplayFinished(const Response &r);
 
     void actDownload();
-    void downloadFinished(const Response &r, const CommandContainer &commandContainer, const QVariant &extraData);
+    void remoteReplayChunkReceived(const Response &r,
+                                   const CommandContainer &commandContainer,
+                                   const QVariant &extraData);
 
     void actKeepRemoteReplay();
     void keepRemoteReplayFinished(const Response &r, const CommandContainer &commandContainer);
@@ -62,7 +80,10 @@ private slots:
 
     void replayAddedEventReceived(const Event_ReplayAdded &event);
 signals:
-    void openReplay(GameReplay *replay);
+    void openReplay(ReplayFile *replay);
+
+protected:
+    void materializeContents() override;
 
 public:
     TabReplays(TabSupervisor *_tabSupervisor, AbstractClient *_client, const ServerInfo_User *currentUserInfo);
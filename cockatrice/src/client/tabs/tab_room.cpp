@@ -15,6 +15,7 @@
 #include "pb/event_list_games.pb.h"
 #include "pb/event_remove_messages.pb.h"
 #include "pb/event_room_say.pb.h"
+#include "pb/response_room_interests.pb.h"
 #include "pb/room_commands.pb.h"
 #include "pb/serverinfo_room.pb.h"
 #include "tab_account.h"
@@ -27,6 +28,7 @@
 #include <QMenu>
 #include <QMessageBox>
 #include <QPushButton>
+#include <QSet>
 #include <QSplitter>
 #include <QSystemTrayIcon>
 #include <QToolButton>
@@ -38,7 +40,9 @@ TabRoom::TabRoom(TabSupervisor *_tabSupervisor,
                  ServerInfo_User *_ownUser,
                  const ServerInfo_Room &info)
     : Tab(_tabSupervisor), client(_client), roomId(info.room_id()), roomName(QString::fromStdString(info.name())),
-      ownUser(_ownUser), userListProxy(_tabSupervisor->getUserListManager())
+      ownUser(_ownUser), userListProxy(_tabSupervisor->getUserListManager()),
+      roomInterests(Command_SetRoomInterests::CHAT | Command_SetRoomInterests::GAME_LIST |
+                    Command_SetRoomInterests::USER_LIST)
 {
     const int gameTypeListSize = info.gametype_list_size();
     for (int i = 0; i < gameTypeListSize; ++i)
@@ -105,16 +109,30 @@ TabRoom::TabRoom(TabSupervisor *_tabSupervisor,
     aLeaveRoom = new QAction(this);
     connect(aLeaveRoom, &QAction::triggered, this, &TabRoom::closeRequest);
 
+    // hidden parts of the room aren't kept up to date by the server
+    aShowGameList = new QAction(this);
+    aShowChat = new QAction(this);
+    aShowUserList = new QAction(this);
+    for (QAction *action : {aShowGameList, aShowChat, aShowUserList}) {
+        action->setCheckable(true);
+        action->setChecked(true);
+        connect(action, &QAction::triggered, this, &TabRoom::actSetRoomInterests);
+    }
+
     roomMenu = new QMenu(this);
+    roomMenu->addAction(aShowGameList);
+    roomMenu->addAction(aShowChat);
+    roomMenu->addAction(aShowUserList);
+    roomMenu->addSeparator();
     roomMenu->addAction(aLeaveRoom);
     addTabMenu(roomMenu);
 
-    const int userListSize = info.user_list_size();
-    for (int i = 0; i < userListSize; ++i) {
-        userList->processUserInfo(info.user_list(i), true);
-        autocompleteUserList.append("@" + QString::fromStdString(info.user_list(i).name()));
+    QList<ServerInfo_User> users;
+    for (const ServerInfo_User &user : info.user_list()) {
+        users.append(user);
+        autocompleteUserList.append("@" + QString::fromStdString(user.name()));
     }
-    userList->sortItems();
+    userList->setUsers(users, true);
 
     const int gameListSize = info.game_list_size();
     for (int i = 0; i < gameListSize; ++i)
@@ -147,6 +165,9 @@ void TabRoom::retranslateUi()
     chatGroupBox->setTitle(tr("Chat"));
     roomMenu->setTitle(tr("&Room"));
     aLeaveRoom->setText(tr("&Leave room"));
+    aShowGameList->setText(tr("Show &games"));
+    aShowChat->setText(tr("Show &chat"));
+    aShowUserList->setText(tr("Show &users"));
     aClearChat->setText(tr("&Clear chat"));
     aOpenChatSettings->setText(tr("Chat Settings..."));
 }
@@ -233,6 +254,67 @@ void TabRoom::actCompleterChanged()
                                                         : completer->setCompletionRole(1);
 }
 
+void TabRoom::actSetRoomInterests()
+{
+    gameSelector->setVisible(aShowGameList->isChecked());
+    chatGroupBox->setVisible(aShowChat->isChecked());
+    userList->setVisible(aShowUserList->isChecked());
+
+    quint32 interests = 0;
+    if (aShowChat->isChecked())
+        interests |= Command_SetRoomInterests::CHAT;
+    if (aShowGameList->isChecked())
+        interests |= Command_SetRoomInterests::GAME_LIST;
+    if (aShowUserList->isChecked())
+        interests |= Command_SetRoomInterests::USER_LIST;
+    if (interests == roomInterests)
+        return;
+    const quint32 addedInterests = interests & ~roomInterests;
+    roomInterests = interests;
+
+    Command_SetRoomInterests cmd;
+    cmd.set_interests(interests);
+    PendingCommand *pend = prepareRoomCommand(cmd);
+    pend->setExtraData(addedInterests);
+    connect(pend, &PendingCommand::finished, this, &TabRoom::roomInterestsFinished);
+    sendRoomCommand(pend);
+}
+
+void TabRoom::roomInterestsFinished(const Response &response,
+                                    const CommandContainer & /* commandContainer */,
+                                    const QVariant &extraData)
+{
+    // servers that don't know about interests keep sending everything
+    if (response.response_code() != Response::RespOk)
+        return;
+
+    // the lists that were shown again missed their updates while they were hidden
+    const quint32 addedInterests = extraData.toUInt();
+    const ServerInfo_Room &info = response.GetExtension(Response_RoomInterests::ext).room_info();
+
+    if (addedInterests & Command_SetRoomInterests::GAME_LIST) {
+        QList<ServerInfo_Game> games;
+        for (const ServerInfo_Game &game : info.game_list())
+            games.append(game);
+        gameSelector->setGameList(games);
+    }
+
+    if (addedInterests & Command_SetRoomInterests::USER_LIST) {
+        QList<ServerInfo_User> users;
+        QSet<QString> userNames;
+        for (const ServerInfo_User &user : info.user_list()) {
+            users.append(user);
+            userNames.insert(QString::fromStdString(user.name()));
+        }
+        userList->setUsers(users, true);
+
+        autocompleteUserList.clear();
+        for (const QString &userName : userNames)
+            autocompleteUserList.append("@" + userName);
+        sayEdit->setCompletionList(autocompleteUserList);
+    }
+}
+
 void TabRoom::processRoomEvent(const RoomEvent &event)
 {
     switch (static_cast<RoomEvent::RoomEventType>(getPbExtension(event))) {
@@ -265,7 +347,6 @@ void TabRoom::processListGamesEvent(const Event_ListGames &event)
 void TabRoom::processJoinRoomEvent(const Event_JoinRoom &event)
 {
     userList->processUserInfo(event.user_info(), true);
-    userList->sortItems();
     if (!autocompleteUserList.contains("@" + QString::fromStdString(event.user_info().name()))) {
         autocompleteUserList << "@" + QString::fromStdString(event.user_info().name());
         sayEdit->setCompletionList(autocompleteUserList);
@@ -287,10 +368,10 @@ void TabRoom::processRoomSayEvent(const Event_RoomSay &event)
     if (userListProxy->isUserIgnored(senderName))
         return;
 
-    UserListTWI *twi = userList->getUsers().value(senderName);
+    const ServerInfo_User *senderInfo = userList->getUserInfo(senderName);
     ServerInfo_User userInfo = {};
-    if (twi) {
-        userInfo = twi->getUserInfo();
+    if (senderInfo) {
+        userInfo = *senderInfo;
         if (SettingsCache::instance().getIgnoreUnregisteredUsers() &&
             !UserLevelFlags(userInfo.user_level()).testFlag(ServerInfo_User::IsRegistered))
             return;
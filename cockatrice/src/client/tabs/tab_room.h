@@ -34,6 +34,7 @@ class Event_LeaveRoom;
 class Event_RoomSay;
 class Event_RemoveMessages;
 class GameSelector;
+class CommandContainer;
 class Response;
 class PendingCommand;
 class ServerInfo_User;
@@ -59,10 +60,14 @@ private:
 
     QMenu *roomMenu;
     QAction *aLeaveRoom;
+    QAction *aShowGameList, *aShowChat, *aShowUserList;
     QAction *aOpenChatSettings;
     QAction *aClearChat;
     QString sanitizeHtml(QString dirty) const;
 
+    // the Command_SetRoomInterests::Interest values the server was asked for
+    quint32 roomInterests;
+
     QStringList autocompleteUserList;
     QCompleter *completer;
 signals:
@@ -80,6 +85,8 @@ private slots:
     void actShowMentionPopup(const QString &sender);
     void actShowPopup(const QString &message);
     void actCompleterChanged();
+    void actSetRoomInterests();
+    void roomInterestsFinished(const Response &response, const CommandContainer &, const QVariant &extraData);
 
     void processListGamesEvent(const Event_ListGames &event);
     void processJoinRoomEvent(const Event_JoinRoom &event);
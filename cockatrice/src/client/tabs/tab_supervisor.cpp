@@ -11,9 +11,9 @@
 #include "pb/event_notify_user.pb.h"
 #include "pb/event_user_message.pb.h"
 #include "pb/game_event_container.pb.h"
-#include "pb/game_replay.pb.h"
 #include "pb/room_commands.pb.h"
 #include "pb/room_event.pb.h"
+#include "pb/server_message.pb.h"
 #include "pb/serverinfo_room.pb.h"
 #include "pb/serverinfo_user.pb.h"
 #include "tab_account.h"
@@ -32,9 +32,13 @@
 #include "visual_deck_storage/tab_deck_storage_visual.h"
 
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QMessageBox>
 #include <QPainter>
 #include <QSystemTrayIcon>
+#include <QTimer>
+
+static const qint64 eventBudgetNs = 8 * 1000 * 1000;
 
 QRect MacOSTabFixStyle::subElementRect(SubElement element, const QStyleOption *option, const QWidget *widget) const
 {
@@ -105,7 +109,7 @@ void CloseButton::paintEvent(QPaintEvent * /*event*/)
 TabSupervisor::TabSupervisor(AbstractClient *_client, QMenu *tabsMenu, QWidget *parent)
     : QTabWidget(parent), userInfo(nullptr), client(_client), tabsMenu(tabsMenu), tabVisualDeckStorage(nullptr),
       tabServer(nullptr), tabAccount(nullptr), tabDeckStorage(nullptr), tabReplays(nullptr), tabAdmin(nullptr),
-      tabLog(nullptr), isLocalGame(false)
+      tabLog(nullptr), isLocalGame(false), eventTimeSpent(0)
 {
     setElideMode(Qt::ElideRight);
     setMovable(true);
@@ -119,6 +123,11 @@ TabSupervisor::TabSupervisor(AbstractClient *_client, QMenu *tabsMenu, QWidget *
 
     userListManager = new UserListManager(client, this);
 
+    pendingEventsTimer = new QTimer(this);
+    pendingEventsTimer->setSingleShot(true);
+    pendingEventsTimer->setInterval(0);
+    connect(pendingEventsTimer, &QTimer::timeout, this, &TabSupervisor::processPendingEvents);
+
     // connect tab changes
     connect(this, &TabSupervisor::currentChanged, this, &TabSupervisor::updateCurrent);
 
@@ -448,6 +457,8 @@ void TabSupervisor::stop()
         return;
 
     resetTabsMenu();
+    pendingEvents.clear();
+    pendingEventsTimer->stop();
 
     if (!localClients.isEmpty()) {
         for (auto &localClient : localClients) {
@@ -735,7 +746,7 @@ void TabSupervisor::roomLeft(TabRoom *tab)
     removeTab(indexOf(tab));
 }
 
-void TabSupervisor::openReplay(GameReplay *replay)
+void TabSupervisor::openReplay(ReplayFile *replay)
 {
     auto *replayTab = new TabGame(this, replay);
     connect(replayTab, &TabGame::gameClosing, this, &TabSupervisor::replayLeft);
@@ -905,20 +916,61 @@ void TabSupervisor::updateTabText(Tab *tab, const QString &newTabText)
     setTabToolTip(idx, sanitizeHtml(newTabText));
 }
 
-void TabSupervisor::processRoomEvent(const RoomEvent &event)
+void TabSupervisor::processRoomEvent(const ServerMessagePtr &message)
 {
-    TabRoom *tab = roomTabs.value(event.room_id(), 0);
-    if (tab)
-        tab->processRoomEvent(event);
+    queueEvent(message);
 }
 
-void TabSupervisor::processGameEventContainer(const GameEventContainer &cont)
+void TabSupervisor::processGameEventContainer(const ServerMessagePtr &message)
 {
-    TabGame *tab = gameTabs.value(cont.game_id());
-    if (tab)
-        tab->processGameEventContainer(cont, qobject_cast<AbstractClient *>(sender()), {});
-    else
-        qCInfo(TabSupervisorLog) << "gameEvent: invalid gameId" << cont.game_id();
+    queueEvent(message);
+}
+
+void TabSupervisor::queueEvent(const ServerMessagePtr &message)
+{
+    const PendingEvent event{message, qobject_cast<AbstractClient *>(sender())};
+
+    // Events are applied as they come in until they took up the budget, then they wait for the next slice. Once there
+    // is a backlog, everything queues up behind it to keep the order.
+    if (pendingEvents.isEmpty() && eventTimeSpent < eventBudgetNs) {
+        applyEvent(event);
+        return;
+    }
+
+    pendingEvents.append(event);
+    pendingEventsTimer->start();
+}
+
+void TabSupervisor::processPendingEvents()
+{
+    eventTimeSpent = 0;
+    while (!pendingEvents.isEmpty() && eventTimeSpent < eventBudgetNs)
+        applyEvent(pendingEvents.takeFirst());
+
+    if (!pendingEvents.isEmpty())
+        pendingEventsTimer->start();
+}
+
+void TabSupervisor::applyEvent(const PendingEvent &event)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if (event.message->has_room_event()) {
+        const RoomEvent &roomEvent = event.message->room_event();
+        TabRoom *tab = roomTabs.value(roomEvent.room_id(), 0);
+        if (tab)
+            tab->processRoomEvent(roomEvent);
+    } else {
+        const GameEventContainer &cont = event.message->game_event_container();
+        TabGame *tab = gameTabs.value(cont.game_id());
+        if (tab)
+            tab->processGameEventContainer(cont, event.client, {});
+        else
+            qCInfo(TabSupervisorLog) << "gameEvent: invalid gameId" << cont.game_id();
+    }
+
+    eventTimeSpent += timer.nsecsElapsed();
 }
 
 void TabSupervisor::processUserMessageEvent(const Event_UserMessage &event)
@@ -1,6 +1,7 @@
 #ifndef TAB_SUPERVISOR_H
 #define TAB_SUPERVISOR_H
 
+#include "../../client/game_logic/abstract_client.h"
 #include "../../deck/deck_loader.h"
 #include "../../server/user/user_list_proxy.h"
 #include "abstract_tab_deck_editor.h"
@@ -15,6 +16,7 @@
 #include <QCommonStyle>
 #include <QLoggingCategory>
 #include <QMap>
+#include <QPointer>
 #include <QProxyStyle>
 #include <QTabWidget>
 
@@ -22,6 +24,7 @@ inline Q_LOGGING_CATEGORY(TabSupervisorLog, "tab_supervisor");
 
 class UserListManager;
 class QMenu;
+class QTimer;
 class AbstractClient;
 class Tab;
 class TabServer;
@@ -41,7 +44,7 @@ class Event_UserMessage;
 class Event_NotifyUser;
 class ServerInfo_Room;
 class ServerInfo_User;
-class GameReplay;
+class ReplayFile;
 class DeckList;
 
 class MacOSTabFixStyle : public QProxyStyle
@@ -103,6 +106,18 @@ private:
     QList<AbstractTabDeckEditor *> deckEditorTabs;
     bool isLocalGame;
 
+    struct PendingEvent
+    {
+        ServerMessagePtr message;
+        QPointer<AbstractClient> client;
+    };
+    // Room events and game event containers in the order they were received. A burst of them is applied in slices
+    // of a few milliseconds per event loop iteration, so that the window is still painted in between.
+    QList<PendingEvent> pendingEvents;
+    // the time spent applying events since the last slice started, in nanoseconds
+    qint64 eventTimeSpent;
+    QTimer *pendingEventsTimer;
+
     QAction *aTabDeckEditor, *aTabVisualDeckEditor, *aTabEdhRec, *aTabVisualDeckStorage, *aTabVisualDatabaseDisplay,
         *aTabServer, *aTabAccount, *aTabDeckStorage, *aTabReplays, *aTabAdmin, *aTabLog;
 
@@ -111,6 +126,8 @@ private:
     static QString sanitizeTabName(QString dirty);
     static QString sanitizeHtml(QString dirty);
     void resetTabsMenu();
+    void queueEvent(const ServerMessagePtr &message);
+    void applyEvent(const PendingEvent &event);
 
 public:
     explicit TabSupervisor(AbstractClient *_client, QMenu *tabsMenu, QWidget *parent = nullptr);
@@ -166,7 +183,7 @@ public slots:
     TabVisualDatabaseDisplay *addVisualDatabaseDisplayTab();
     TabEdhRecMain *addEdhrecMainTab();
     TabEdhRec *addEdhrecTab(const CardInfoPtr &cardToQuery, bool isCommander = false);
-    void openReplay(GameReplay *replay);
+    void openReplay(ReplayFile *replay);
     void maximizeMainWindow();
 private slots:
     void refreshShortcuts();
@@ -202,8 +219,9 @@ private slots:
     void deckEditorClosed(AbstractTabDeckEditor *tab);
     void tabUserEvent(bool globalEvent);
     void updateTabText(Tab *tab, const QString &newTabText);
-    void processRoomEvent(const RoomEvent &event);
-    void processGameEventContainer(const GameEventContainer &cont);
+    void processRoomEvent(const ServerMessagePtr &message);
+    void processGameEventContainer(const ServerMessagePtr &message);
+    void processPendingEvents();
     void processUserMessageEvent(const Event_UserMessage &event);
     void processNotifyUserEvent(const Event_NotifyUser &event);
 };
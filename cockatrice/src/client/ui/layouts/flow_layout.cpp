@@ -9,6 +9,7 @@
 #include "../widgets/general/layout_containers/flow_widget.h"
 
 #include <QDebug>
+#include <QHash>
 #include <QLayoutItem>
 #include <QScrollArea>
 #include <QStyle>
@@ -60,11 +61,25 @@ bool FlowLayout::hasHeightForWidth() const
 }
 
 /**
- * @brief Calculates the required height to display all items within the specified width.
+ * @brief Returns the required height to display all items within the specified width.
+ *        The result is kept until the layout is invalidated, as it is asked for several times per layout pass.
  * @param width The available width for arranging items.
  * @return The total height needed to fit all items in rows constrained by the specified width.
  */
 int FlowLayout::heightForWidth(const int width) const
+{
+    if (cachedHeightForWidth.first != width) {
+        cachedHeightForWidth = {width, calculateHeightForWidth(width)};
+    }
+    return cachedHeightForWidth.second;
+}
+
+/**
+ * @brief Calculates the required height to display all items within the specified width.
+ * @param width The available width for arranging items.
+ * @return The total height needed to fit all items in rows constrained by the specified width.
+ */
+int FlowLayout::calculateHeightForWidth(const int width) const
 {
     if (flowDirection == Qt::Vertical) {
         int height = 0;
@@ -559,6 +574,47 @@ void FlowLayout::insertWidgetAtIndex(QWidget *toInsert, int index)
     invalidate();
 }
 
+/**
+ * @brief Moves the given widgets after all other items of the layout, in the given order.
+ *        Unlike removing and adding them again, this changes the order of the items in a single pass.
+ * @param widgets The widgets to move, which have to be in the layout already.
+ */
+void FlowLayout::moveWidgetsToEnd(const QList<QWidget *> &widgets)
+{
+    QHash<QWidget *, QLayoutItem *> movedItems;
+    for (QWidget *widget : widgets) {
+        movedItems.insert(widget, nullptr);
+    }
+
+    QList<QLayoutItem *> reorderedItems;
+    reorderedItems.reserve(items.size());
+    for (QLayoutItem *item : items) {
+        auto movedItem = movedItems.find(item->widget());
+        if (movedItem == movedItems.end()) {
+            reorderedItems.append(item);
+        } else {
+            *movedItem = item;
+        }
+    }
+    for (QWidget *widget : widgets) {
+        if (QLayoutItem *item = movedItems.value(widget)) {
+            reorderedItems.append(item);
+        }
+    }
+
+    items = reorderedItems;
+    invalidate();
+}
+
+/**
+ * @brief Invalidates the layout, together with the cached height for width.
+ */
+void FlowLayout::invalidate()
+{
+    cachedHeightForWidth = {-1, 0};
+    QLayout::invalidate();
+}
+
 /**
  * @brief Retrieves the count of items in the layout.
  * @return The number of layout items.
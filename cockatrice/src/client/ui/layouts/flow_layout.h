@@ -4,6 +4,7 @@
 #include <QLayout>
 #include <QList>
 #include <QLoggingCategory>
+#include <QPair>
 #include <QWidget>
 #include <qstyle.h>
 
@@ -16,6 +17,7 @@ public:
     FlowLayout(QWidget *parent, Qt::Orientation _flowDirection, int margin = 0, int hSpacing = 0, int vSpacing = 0);
     ~FlowLayout() override;
     void insertWidgetAtIndex(QWidget *toInsert, int index);
+    void moveWidgetsToEnd(const QList<QWidget *> &widgets);
 
     QSize calculateMinimumSizeHorizontal() const;
     QSize calculateSizeHintVertical() const;
@@ -29,6 +31,7 @@ public:
     [[nodiscard]] Qt::Orientations expandingDirections() const override;
     [[nodiscard]] bool hasHeightForWidth() const override;
     [[nodiscard]] int heightForWidth(int width) const override;
+    void invalidate() override;
     [[nodiscard]] int verticalSpacing() const;
     [[nodiscard]] int doLayout(const QRect &rect, bool testOnly) const;
     [[nodiscard]] int smartSpacing(QStyle::PixelMetric pm) const;
@@ -49,6 +52,12 @@ protected:
     Qt::Orientation flowDirection;
     int horizontalMargin;
     int verticalMargin;
+
+private:
+    // the width heightForWidth() was last asked for, and the height it returned
+    mutable QPair<int, int> cachedHeightForWidth = {-1, 0};
+
+    [[nodiscard]] int calculateHeightForWidth(int width) const;
 };
 
 #endif // FLOW_LAYOUT_H
\ No newline at end of file
@@ -59,6 +59,7 @@ void OverlapLayout::insertWidgetAtIndex(QWidget *toInsert, int index)
     addChildWidget(toInsert);
     int clampedIndex = qBound(0, index, qMax(0, static_cast<int>(itemList.size())));
     itemList.insert(clampedIndex, new QWidgetItem(toInsert));
+    markDirtyFrom(clampedIndex);
 
     for (int i = clampedIndex; i < itemList.size(); ++i) {
         dynamic_cast<QWidgetItem *>(itemList.at(i))->widget()->raise();
@@ -79,6 +80,7 @@ void OverlapLayout::insertWidgetAtIndex(QWidget *toInsert, int index)
 void OverlapLayout::addItem(QLayoutItem *item)
 {
     if (item != nullptr) {
+        markDirtyFrom(static_cast<int>(itemList.size()));
         itemList.append(item);
     }
 }
@@ -121,7 +123,23 @@ QLayoutItem *OverlapLayout::itemAt(const int index) const
  */
 QLayoutItem *OverlapLayout::takeAt(const int index)
 {
-    return (index >= 0 && index < itemList.size()) ? itemList.takeAt(index) : nullptr;
+    if (index < 0 || index >= itemList.size()) {
+        return nullptr;
+    }
+    markDirtyFrom(index);
+    return itemList.takeAt(index);
+}
+
+/**
+ * @brief Marks the items from the given index on as needing to be placed again.
+ *
+ * The items before it keep the geometry they were given, as long as the grid they are placed on doesn't change.
+ *
+ * @param index The index of the first item that was added, removed or moved.
+ */
+void OverlapLayout::markDirtyFrom(const int index)
+{
+    firstDirtyIndex = qMin(firstDirtyIndex, index);
 }
 
 /**
@@ -135,6 +153,7 @@ void OverlapLayout::setGeometry(const QRect &rect)
 
     // If there are no items to layout, exit early.
     if (itemList.isEmpty()) {
+        firstDirtyIndex = 0;
         return;
     }
 
@@ -208,37 +227,37 @@ void OverlapLayout::setGeometry(const QRect &rect)
         rows = INT_MAX;
     }
 
-    // Initialize row and column indices.
-    int currentRow = 0;
-    int currentColumn = 0;
+    // TODO: Figure this out properly or maybe adjust size hint to account for this?
+    // Every line along the overlap direction holds the same number of items.
+    const int lineLength =
+        (overlapDirection == Qt::Horizontal) ? qCeil(itemList.size() / rows) : qCeil(itemList.size() / columns);
+    const Grid grid = {rect, QSize(maxItemWidth, maxItemHeight), maxItemWidth - overlapOffsetWidth,
+                       maxItemHeight - overlapOffsetHeight, lineLength + 1};
+
+    // Adding or removing a card only moves the cards after it, unless the grid changed with it.
+    if (!(grid == placedGrid)) {
+        placedGrid = grid;
+        firstDirtyIndex = 0;
+    }
 
-    // Loop through all items and position them based on the calculated offsets.
-    for (const auto item : itemList) {
+    // Position the items from the first changed one on.
+    for (int i = firstDirtyIndex; i < itemList.size(); ++i) {
+        QLayoutItem *item = itemList.at(i);
         if (item == nullptr) {
             continue;
         }
 
+        const int line = i / grid.itemsPerLine;
+        const int positionInLine = i % grid.itemsPerLine;
+        const int currentColumn = (overlapDirection == Qt::Horizontal) ? positionInLine : line;
+        const int currentRow = (overlapDirection == Qt::Horizontal) ? line : positionInLine;
+
         // Calculate the position of the current item.
-        const int xPos = rect.left() + currentColumn * (maxItemWidth - overlapOffsetWidth);
-        const int yPos = rect.top() + currentRow * (maxItemHeight - overlapOffsetHeight);
+        const int xPos = rect.left() + currentColumn * grid.stepWidth;
+        const int yPos = rect.top() + currentRow * grid.stepHeight;
         item->setGeometry(QRect(xPos, yPos, maxItemWidth, maxItemHeight));
-
-        // TODO: Figure this out properly or maybe adjust size hint to account for this?
-        // Update row and column indices based on the layout direction.
-        if (overlapDirection == Qt::Horizontal) {
-            currentColumn++;
-            if (currentColumn > qCeil(itemList.size() / rows)) {
-                currentColumn = 0;
-                currentRow++;
-            }
-        } else {
-            currentRow++;
-            if (currentRow > qCeil(itemList.size() / columns)) {
-                currentRow = 0;
-                currentColumn++;
-            }
-        }
     }
+    firstDirtyIndex = static_cast<int>(itemList.size());
 }
 
 /**
@@ -364,6 +383,7 @@ QSize OverlapLayout::minimumSize() const
 void OverlapLayout::setDirection(const Qt::Orientation _direction)
 {
     overlapDirection = _direction;
+    markDirtyFrom(0);
 }
 
 /**
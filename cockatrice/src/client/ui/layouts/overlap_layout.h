@@ -43,6 +43,26 @@ private:
     Qt::Orientation overlapDirection;
     Qt::Orientation flowDirection;
 
+    // What the positions of the items depend on, besides their index
+    struct Grid
+    {
+        QRect rect;
+        QSize itemSize;
+        int stepWidth;
+        int stepHeight;
+        int itemsPerLine;
+
+        bool operator==(const Grid &other) const
+        {
+            return rect == other.rect && itemSize == other.itemSize && stepWidth == other.stepWidth &&
+                   stepHeight == other.stepHeight && itemsPerLine == other.itemsPerLine;
+        }
+    };
+    // The grid the items were last placed on, the items before firstDirtyIndex are still placed on it
+    Grid placedGrid = {};
+    int firstDirtyIndex = 0;
+
+    void markDirtyFrom(int index);
     // Calculate the preferred size of the layout
     QSize calculatePreferredSize() const;
 };
@@ -21,10 +21,24 @@
 
 // never cache more than 300 cards at once for a single deck
 #define CACHED_CARD_PER_DECK_MAX 300
+// how many of the scaled down levels made by the worker are cached next to the full pixmap
+#define SCALED_LEVEL_COUNT 3
+// how many getPixmap() calls between two logs of the size cache hit rate
+#define PIXMAP_STATISTICS_INTERVAL 1000
 
-PictureLoader::PictureLoader() : QObject(nullptr)
+PictureLoader::PictureLoader() : QObject(nullptr), pixmapLookups(0)
 {
-    worker = new PictureLoaderWorker;
+    qRegisterMetaType<QList<QImage>>("QList<QImage>");
+
+    pixmapCache.setBudget(qint64(SettingsCache::instance().getPixmapCacheSize()) * 1024 * 1024);
+    connect(&SettingsCache::instance(), &SettingsCache::pixmapCacheSizeChanged, this,
+            [this](int newSizeInMBs) { pixmapCache.setBudget(qint64(newSizeInMBs) * 1024 * 1024); });
+
+    const QString cachePath = SettingsCache::instance().getCachePath();
+    thumbnailCache = QSharedPointer<PictureLoaderThumbnailCache>::create(
+        cachePath.isEmpty() ? QString() : cachePath + "/thumbnails", THUMBNAIL_CACHE_SIZE_MAX);
+
+    worker = new PictureLoaderWorker(thumbnailCache);
     connect(&SettingsCache::instance(), &SettingsCache::picsPathChanged, this, &PictureLoader::picsPathChanged);
     connect(&SettingsCache::instance(), &SettingsCache::picDownloadChanged, this, &PictureLoader::picDownloadChanged);
 
@@ -39,6 +53,7 @@ PictureLoader::PictureLoader() : QObject(nullptr)
     connect(worker, &PictureLoaderWorker::imageRequestQueued, statusBar, &PictureLoaderStatusBar::addQueuedImageLoad);
     connect(worker, &PictureLoaderWorker::imageRequestSucceeded, statusBar,
             &PictureLoaderStatusBar::addSuccessfulImageLoad);
+    connect(worker, &PictureLoaderWorker::requestQueueChanged, statusBar, &PictureLoaderStatusBar::setQueueDepths);
 }
 
 PictureLoader::~PictureLoader()
@@ -108,66 +123,149 @@ void PictureLoader::getCardBackLoadingFailedPixmap(QPixmap &pixmap, QSize size)
     }
 }
 
-void PictureLoader::getPixmap(QPixmap &pixmap, const ExactCard &card, QSize size)
+/**
+ * Finds the picture of the card at the size, or queues its load if it isn't in the pixmap cache yet. The card's
+ * pixmapUpdated() signal is emitted once it is loaded.
+ * @param priority How urgently the picture is wanted, see PictureLoadPriority
+ */
+void PictureLoader::getPixmap(QPixmap &pixmap, const ExactCard &card, QSize size, PictureLoadPriority priority)
 {
     if (!card) {
         qCWarning(PictureLoaderLog) << "getPixmap called with null card!";
         return;
     }
 
-    QString key = card.getPixmapCacheKey();
-    QString sizeKey = key + QLatin1Char('_') + QString::number(size.width()) + "x" + QString::number(size.height());
+    PictureLoader &instance = getInstance();
+    PictureLoaderPixmapCache &cache = instance.pixmapCache;
+    if (++instance.pixmapLookups >= PIXMAP_STATISTICS_INTERVAL) {
+        instance.pixmapLookups = 0;
+        instance.logPixmapCacheStatistics();
+    }
 
-    if (QPixmapCache::find(sizeKey, &pixmap)) {
+    const QString key = card.getPixmapCacheKey();
+    const int cardId = cache.cardId(key);
+    const quint64 sizeKey = PictureLoaderPixmapCache::sizeKey(cardId, size);
+    if (cache.find(PictureLoaderPixmapCache::DisplayTier, sizeKey, &pixmap)) {
         return; // Use cached version
     }
 
+    QScreen *screen = qApp->primaryScreen();
+    qreal dpr = screen ? screen->devicePixelRatio() : 1.0;
+    const QSize targetSize = size * dpr;
+
     // load the image and create a copy of the correct size
     QPixmap bigPixmap;
-    if (QPixmapCache::find(key, &bigPixmap)) {
+    if (cache.find(PictureLoaderPixmapCache::FullTier, PictureLoaderPixmapCache::levelKey(cardId, 0), &bigPixmap)) {
         if (bigPixmap.isNull()) {
             qCDebug(PictureLoaderLog) << "Cached pixmap for key" << key << "is NULL!";
             return;
         }
 
-        QScreen *screen = qApp->primaryScreen();
-        qreal dpr = screen ? screen->devicePixelRatio() : 1.0;
         qCDebug(PictureLoaderLog) << "Scaling cached image for" << card.getName();
 
-        pixmap = bigPixmap.scaled(size * dpr, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        // scale from the smallest level still covering the size, rather than from the full image
+        QPixmap level;
+        for (int i = SCALED_LEVEL_COUNT; i > 0; --i) {
+            if (cache.find(PictureLoaderPixmapCache::FullTier, PictureLoaderPixmapCache::levelKey(cardId, i), &level) &&
+                level.width() >= targetSize.width() && level.height() >= targetSize.height()) {
+                bigPixmap = level;
+                break;
+            }
+        }
+
+        pixmap = bigPixmap.scaled(targetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
         pixmap.setDevicePixelRatio(dpr);
-        QPixmapCache::insert(sizeKey, pixmap);
+        cache.insert(PictureLoaderPixmapCache::DisplayTier, sizeKey, pixmap);
         return;
     }
 
+    // small sizes can be shown from the thumbnails saved in earlier sessions, without loading the full image
+    const int bucketWidth = PictureLoaderThumbnailCache::bucketWidth(targetSize.width());
+    if (bucketWidth > 0) {
+        const quint64 thumbnailKey = PictureLoaderPixmapCache::thumbnailKey(cardId, bucketWidth);
+        QPixmap thumbnail;
+        if (!cache.find(PictureLoaderPixmapCache::DisplayTier, thumbnailKey, &thumbnail)) {
+            const QImage image = instance.thumbnailCache->load(key, bucketWidth);
+            if (!image.isNull()) {
+                thumbnail = toPixmap(image, card.getInfo().getUpsideDownArt());
+                cache.insert(PictureLoaderPixmapCache::DisplayTier, thumbnailKey, thumbnail);
+            }
+        }
+        if (!thumbnail.isNull()) {
+            pixmap = thumbnail.scaled(targetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            pixmap.setDevicePixelRatio(dpr);
+            cache.insert(PictureLoaderPixmapCache::DisplayTier, sizeKey, pixmap);
+            return;
+        }
+    }
+
     // add the card to the load queue
     qCDebug(PictureLoaderLog) << "Enqueuing " << card.getName() << " for " << card.getPixmapCacheKey();
-    getInstance().worker->enqueueImageLoad(card);
+    getInstance().worker->enqueueImageLoad(card, priority);
 }
 
-void PictureLoader::imageLoaded(const ExactCard &card, const QImage &image)
+/**
+ * Drops the queued load of a card that scrolled out of view or whose widget is gone, so it doesn't hold up the
+ * others. The views still showing the card queue it again.
+ */
+void PictureLoader::cancelPixmapLoad(const ExactCard &card)
 {
-    if (image.isNull()) {
-        qCDebug(PictureLoaderLog) << "Caching NULL pixmap for" << card.getName();
-        QPixmapCache::insert(card.getPixmapCacheKey(), QPixmap());
-    } else {
-        if (card.getInfo().getUpsideDownArt()) {
+    if (card) {
+        getInstance().worker->cancelImageLoad(card);
+    }
+}
+
+void PictureLoader::logPixmapCacheStatistics() const
+{
+    for (auto tier : {PictureLoaderPixmapCache::FullTier, PictureLoaderPixmapCache::DisplayTier}) {
+        const PictureLoaderPixmapCache::Statistics statistics = pixmapCache.statistics(tier);
+        qCDebug(PictureLoaderLog).nospace()
+            << (tier == PictureLoaderPixmapCache::FullTier ? "Full" : "Display") << " pixmap cache: "
+            << statistics.entries << " entries, " << statistics.bytes / 1024 << "/" << statistics.budget / 1024
+            << " KB, " << statistics.hits << " hits, " << statistics.misses << " misses, " << statistics.evictions
+            << " evictions";
+    }
+}
+
+PictureLoaderPixmapCache::Statistics PictureLoader::getPixmapCacheStatistics(PictureLoaderPixmapCache::Tier tier)
+{
+    return getInstance().pixmapCache.statistics(tier);
+}
+
+QPixmap PictureLoader::toPixmap(const QImage &image, bool upsideDown)
+{
+    if (upsideDown) {
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 9, 0))
-            QImage mirrorImage = image.flipped(Qt::Horizontal | Qt::Vertical);
+        return QPixmap::fromImage(image.flipped(Qt::Horizontal | Qt::Vertical));
 #else
-            QImage mirrorImage = image.mirrored(true, true);
+        return QPixmap::fromImage(image.mirrored(true, true));
 #endif
-            QPixmapCache::insert(card.getPixmapCacheKey(), QPixmap::fromImage(mirrorImage));
-        } else {
-            QPixmapCache::insert(card.getPixmapCacheKey(), QPixmap::fromImage(image));
+    }
+    return QPixmap::fromImage(image);
+}
+
+void PictureLoader::imageLoaded(const ExactCard &card, const QImage &image, const QList<QImage> &smallerImages)
+{
+    const int cardId = pixmapCache.cardId(card.getPixmapCacheKey());
+    if (image.isNull()) {
+        qCDebug(PictureLoaderLog) << "Caching NULL pixmap for" << card.getName();
+        pixmapCache.insert(PictureLoaderPixmapCache::FullTier, PictureLoaderPixmapCache::levelKey(cardId, 0),
+                           QPixmap());
+    } else {
+        const bool upsideDown = card.getInfo().getUpsideDownArt();
+        // the levels go first, so that the full pixmap is the last one evicted
+        for (int i = 0; i < smallerImages.size() && i < SCALED_LEVEL_COUNT; ++i) {
+            pixmapCache.insert(PictureLoaderPixmapCache::FullTier, PictureLoaderPixmapCache::levelKey(cardId, i + 1),
+                               toPixmap(smallerImages.at(i), upsideDown));
         }
+        pixmapCache.insert(PictureLoaderPixmapCache::FullTier, PictureLoaderPixmapCache::levelKey(cardId, 0),
+                           toPixmap(image, upsideDown));
     }
 
     // imageLoaded should only be reached if the exactCard isn't already in cache.
     // (plus there's a deduplication mechanism in PictureLoaderWorker)
     // It should be safe to connect the CardInfo here without worrying about redundant connections.
-    connect(card.getCardPtr().data(), &QObject::destroyed, this,
-            [cacheKey = card.getPixmapCacheKey()] { QPixmapCache::remove(cacheKey); });
+    connect(card.getCardPtr().data(), &QObject::destroyed, this, [this, cardId] { pixmapCache.removeCard(cardId); });
 
     card.emitPixmapUpdated();
 }
@@ -175,6 +273,7 @@ void PictureLoader::imageLoaded(const ExactCard &card, const QImage &image)
 void PictureLoader::clearPixmapCache()
 {
     QPixmapCache::clear();
+    getInstance().pixmapCache.clear();
 }
 
 void PictureLoader::clearNetworkCache()
@@ -182,9 +281,9 @@ void PictureLoader::clearNetworkCache()
     getInstance().worker->clearNetworkCache();
 }
 
-void PictureLoader::cacheCardPixmaps(const QList<ExactCard> &cards)
+void PictureLoader::cacheCardPixmaps(const QList<ExactCard> &cards, PictureLoadPriority priority)
 {
-    QPixmap tmp;
+    PictureLoaderPixmapCache &cache = getInstance().pixmapCache;
     int max = qMin(cards.size(), CACHED_CARD_PER_DECK_MAX);
     for (int i = 0; i < max; ++i) {
         const ExactCard &card = cards.at(i);
@@ -192,23 +291,24 @@ void PictureLoader::cacheCardPixmaps(const QList<ExactCard> &cards)
             continue;
         }
 
-        QString key = card.getPixmapCacheKey();
-        if (QPixmapCache::find(key, &tmp)) {
+        const int cardId = cache.cardId(card.getPixmapCacheKey());
+        if (cache.contains(PictureLoaderPixmapCache::FullTier, PictureLoaderPixmapCache::levelKey(cardId, 0))) {
             continue;
         }
 
-        getInstance().worker->enqueueImageLoad(card);
+        getInstance().worker->enqueueImageLoad(card, priority);
     }
 }
 
 void PictureLoader::picDownloadChanged()
 {
-    QPixmapCache::clear();
+    pixmapCache.clear();
 }
 
 void PictureLoader::picsPathChanged()
 {
-    QPixmapCache::clear();
+    pixmapCache.clear();
+    thumbnailCache->clear();
 }
 
 bool PictureLoader::hasCustomArt()
@@ -2,10 +2,13 @@
 #define PICTURELOADER_H
 
 #include "../../../game/cards/card_info.h"
+#include "picture_loader_pixmap_cache.h"
 #include "picture_loader_status_bar.h"
+#include "picture_loader_thumbnail_cache.h"
 #include "picture_loader_worker.h"
 
 #include <QLoggingCategory>
+#include <QSharedPointer>
 
 inline Q_LOGGING_CATEGORY(PictureLoaderLog, "picture_loader");
 inline Q_LOGGING_CATEGORY(PictureLoaderCardBackCacheFailLog, "picture_loader.card_back_cache_fail");
@@ -28,15 +31,29 @@ private:
     void operator=(PictureLoader const &);
 
     PictureLoaderWorker *worker;
+    QSharedPointer<PictureLoaderThumbnailCache> thumbnailCache;
     PictureLoaderStatusBar *statusBar;
 
+    PictureLoaderPixmapCache pixmapCache;
+    // getPixmap() calls since the pixmap cache statistics were last logged
+    int pixmapLookups;
+
+    void logPixmapCacheStatistics() const;
+    static QPixmap toPixmap(const QImage &image, bool upsideDown);
+
 public:
-    static void getPixmap(QPixmap &pixmap, const ExactCard &card, QSize size);
+    static void getPixmap(QPixmap &pixmap,
+                          const ExactCard &card,
+                          QSize size,
+                          PictureLoadPriority priority = PictureLoadPriority::Visible);
+    static void cancelPixmapLoad(const ExactCard &card);
     static void getCardBackPixmap(QPixmap &pixmap, QSize size);
     static void getCardBackLoadingInProgressPixmap(QPixmap &pixmap, QSize size);
     static void getCardBackLoadingFailedPixmap(QPixmap &pixmap, QSize size);
     static void clearPixmapCache();
-    static void cacheCardPixmaps(const QList<ExactCard> &cards);
+    static PictureLoaderPixmapCache::Statistics getPixmapCacheStatistics(PictureLoaderPixmapCache::Tier tier);
+    static void cacheCardPixmaps(const QList<ExactCard> &cards,
+                                 PictureLoadPriority priority = PictureLoadPriority::Prefetch);
     static bool hasCustomArt();
 
 public slots:
@@ -47,6 +64,6 @@ private slots:
     void picsPathChanged();
 
 public slots:
-    void imageLoaded(const ExactCard &card, const QImage &image);
+    void imageLoaded(const ExactCard &card, const QImage &image, const QList<QImage> &smallerImages);
 };
 #endif
@@ -5,10 +5,17 @@
 #include "picture_to_load.h"
 
 #include <QDirIterator>
+#include <QFileInfo>
 #include <QMovie>
+#include <algorithm>
 
 static constexpr int REFRESH_INTERVAL_MS = 10 * 1000;
 
+static bool fileNameLessThan(const QString &left, const QString &right)
+{
+    return left.compare(right, Qt::CaseInsensitive) < 0;
+}
+
 PictureLoaderLocal::PictureLoaderLocal(QObject *parent)
     : QObject(parent), picsPath(SettingsCache::instance().getPicsPath()),
       customPicsPath(SettingsCache::instance().getCustomPicsPath())
@@ -16,6 +23,9 @@ PictureLoaderLocal::PictureLoaderLocal(QObject *parent)
     // Hook up signals to settings
     connect(&SettingsCache::instance(), &SettingsCache::picsPathChanged, this, &PictureLoaderLocal::picsPathChanged);
 
+    directoryWatcher = new QFileSystemWatcher(this);
+    connect(directoryWatcher, &QFileSystemWatcher::directoryChanged, this, &PictureLoaderLocal::directoryChanged);
+
     refreshIndex();
 
     refreshTimer = new QTimer(this);
@@ -46,6 +56,46 @@ void PictureLoaderLocal::refreshIndex()
                                    << customFolderIndex.size() << "entries.";
 }
 
+/**
+ * Returns the files of the directory, listing it only the first time it is looked into after it changed.
+ * Missing directories are remembered as well, watching their closest existing parent so that their creation is noticed.
+ */
+const PictureLoaderLocal::DirectoryListing &PictureLoaderLocal::directoryListing(const QString &path) const
+{
+    auto listing = directoryListings.constFind(path);
+    if (listing != directoryListings.constEnd()) {
+        return *listing;
+    }
+
+    QDir dir(path);
+    DirectoryListing newListing{dir.exists(), {}};
+    QString watchedPath = path;
+    if (newListing.exists) {
+        newListing.files = dir.entryList(QDir::Files, QDir::Unsorted);
+        std::sort(newListing.files.begin(), newListing.files.end(), fileNameLessThan);
+    } else {
+        while (!QDir(watchedPath).exists() && QFileInfo(watchedPath).path() != watchedPath) {
+            watchedPath = QFileInfo(watchedPath).path();
+        }
+    }
+    if (QDir(watchedPath).exists() && !directoryWatcher->directories().contains(watchedPath)) {
+        directoryWatcher->addPath(watchedPath);
+    }
+    return *directoryListings.insert(path, newListing);
+}
+
+void PictureLoaderLocal::directoryChanged(const QString &path)
+{
+    // forget the directory itself and the missing directories inside of it, which might have been created
+    for (auto it = directoryListings.begin(); it != directoryListings.end();) {
+        if (it.key() == path || (!it->exists && it.key().startsWith(path + "/"))) {
+            it = directoryListings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 /**
  * Tries to load the card image from the local images.
  *
@@ -53,6 +103,17 @@ void PictureLoaderLocal::refreshIndex()
  * @return The loaded image, or an empty QImage if loading failed.
  */
 QImage PictureLoaderLocal::tryLoad(const ExactCard &toLoad) const
+{
+    return loadFirstImage(findImageFiles(toLoad), toLoad.getName());
+}
+
+/**
+ * Looks up the local image files that may hold the card image, without reading them.
+ *
+ * @param toLoad The card to load
+ * @return The candidate files, most-to-least specific.
+ */
+QStringList PictureLoaderLocal::findImageFiles(const ExactCard &toLoad) const
 {
     PrintingInfo setInstance = toLoad.getPrinting();
 
@@ -69,18 +130,41 @@ QImage PictureLoaderLocal::tryLoad(const ExactCard &toLoad) const
 
     qCDebug(PictureLoaderLocalLog).nospace()
         << "[card: " << cardName << " set: " << setName << "]: Attempting to load picture from local";
-    return tryLoadCardImageFromDisk(setName, correctedCardName, collectorNumber, providerId);
+    return findCardImageFiles(setName, correctedCardName, collectorNumber, providerId);
 }
 
-QImage PictureLoaderLocal::tryLoadCardImageFromDisk(const QString &setName,
-                                                    const QString &correctedCardName,
-                                                    const QString &collectorNumber,
-                                                    const QString &providerId) const
+/**
+ * Reads the first of the files that holds an image. Does not touch the indexes, so it can run on any thread.
+ *
+ * @param files The candidate files, as returned by findImageFiles()
+ * @param cardName The name of the card, for logging
+ * @return The loaded image, or an empty QImage if none of the files could be read.
+ */
+QImage PictureLoaderLocal::loadFirstImage(const QStringList &files, const QString &cardName)
 {
     QImage image;
     QImageReader imgReader;
     imgReader.setDecideFormatFromContent(true);
 
+    for (const QString &file : files) {
+        imgReader.setFileName(file);
+        if (imgReader.read(&image)) {
+            qCDebug(PictureLoaderLocalLog).nospace() << "[card: " << cardName << "] Found picture at: " << file;
+            return image;
+        }
+    }
+
+    qCDebug(PictureLoaderLocalLog).nospace() << "[card: " << cardName << "]: Picture NOT found on disk.";
+    return QImage();
+}
+
+QStringList PictureLoaderLocal::findCardImageFiles(const QString &setName,
+                                                   const QString &correctedCardName,
+                                                   const QString &collectorNumber,
+                                                   const QString &providerId) const
+{
+    QStringList files;
+
     // Most-to-least specific, these will fall through in order.
     QStringList nameVariants;
 
@@ -120,35 +204,34 @@ QImage PictureLoaderLocal::tryLoadCardImageFromDisk(const QString &setName,
             QDir dir = fileInfo.dir();
             QString baseName = fileInfo.fileName();
 
-            if (!dir.exists()) {
+            const DirectoryListing &listing = directoryListing(dir.path());
+            if (!listing.exists) {
                 continue;
             }
 
-            QStringList files = dir.entryList(QDir::Files);
-            for (const QString &file : files) {
-                if (!file.startsWith(baseName)) {
-                    continue;
-                }
-
-                QString fullPath = dir.filePath(file);
-                imgReader.setFileName(fullPath);
-
-                if (imgReader.read(&image)) {
-                    qCDebug(PictureLoaderLocalLog).nospace()
-                        << "[card: " << correctedCardName << " set: " << setName << "] Found picture at: " << fullPath;
-                    return image;
+            // the files starting with baseName are next to each other in the sorted listing
+            auto file =
+                std::lower_bound(listing.files.constBegin(), listing.files.constEnd(), baseName, fileNameLessThan);
+            for (; file != listing.files.constEnd() && file->startsWith(baseName, Qt::CaseInsensitive); ++file) {
+                const QString fullPath = dir.filePath(*file);
+                if (file->startsWith(baseName) && !files.contains(fullPath)) {
+                    files << fullPath;
                 }
             }
         }
     }
 
-    qCDebug(PictureLoaderLocalLog).nospace()
-        << "[card: " << correctedCardName << " set: " << setName << "]: Picture NOT found on disk.";
-    return QImage();
+    return files;
 }
 
 void PictureLoaderLocal::picsPathChanged()
 {
     picsPath = SettingsCache::instance().getPicsPath();
     customPicsPath = SettingsCache::instance().getCustomPicsPath();
+
+    directoryListings.clear();
+    const QStringList watched = directoryWatcher->directories();
+    if (!watched.isEmpty()) {
+        directoryWatcher->removePaths(watched);
+    }
 }
@@ -3,6 +3,8 @@
 
 #include "../../../game/cards/exact_card.h"
 
+#include <QFileSystemWatcher>
+#include <QHash>
 #include <QLoggingCategory>
 #include <QObject>
 #include <QTimer>
@@ -11,7 +13,8 @@ inline Q_LOGGING_CATEGORY(PictureLoaderLocalLog, "picture_loader.local");
 
 /**
  * Handles searching for and loading card images from the local pics and custom image folders.
- * This class maintains an index of the CUSTOM folder, to avoid repeatedly searching the entire directory.
+ * This class maintains an index of the CUSTOM folder, to avoid repeatedly searching the entire directory, and keeps
+ * the listings of the set folders it looked into, which a file system watcher drops whenever they change.
  */
 class PictureLoaderLocal : public QObject
 {
@@ -21,6 +24,8 @@ public:
     explicit PictureLoaderLocal(QObject *parent);
 
     QImage tryLoad(const ExactCard &toLoad) const;
+    QStringList findImageFiles(const ExactCard &toLoad) const;
+    static QImage loadFirstImage(const QStringList &files, const QString &cardName);
 
 private:
     QString picsPath, customPicsPath;
@@ -28,15 +33,27 @@ private:
     QMultiHash<QString, QString> customFolderIndex; // multimap of cardName to picPaths
     QTimer *refreshTimer;
 
+    struct DirectoryListing
+    {
+        bool exists;
+        // sorted by name, ignoring case
+        QStringList files;
+    };
+    // the directories looked into so far, by path
+    mutable QHash<QString, DirectoryListing> directoryListings;
+    QFileSystemWatcher *directoryWatcher;
+
     void refreshIndex();
+    const DirectoryListing &directoryListing(const QString &path) const;
 
-    QImage tryLoadCardImageFromDisk(const QString &setName,
-                                    const QString &correctedCardName,
-                                    const QString &collectorNumber,
-                                    const QString &providerId) const;
+    QStringList findCardImageFiles(const QString &setName,
+                                   const QString &correctedCardName,
+                                   const QString &collectorNumber,
+                                   const QString &providerId) const;
 
 private slots:
     void picsPathChanged();
+    void directoryChanged(const QString &path);
 };
 
 #endif // PICTURE_LOADER_LOCAL_H
@@ -0,0 +1,174 @@
+#include "picture_loader_pixmap_cache.h"
+
+#include <iterator>
+
+// how many of the least recently used entries are weighed against each other when evicting
+static constexpr int EVICTION_CANDIDATES = 4;
+// counted for every entry on top of its pixels, so that the null pixmaps of failed loads are bounded as well
+static constexpr qint64 ENTRY_OVERHEAD = 256;
+
+// the kinds of entries are kept in a single tier each, so a key is never in both tiers
+enum EntryKind
+{
+    LevelEntry,
+    ThumbnailEntry,
+    SizeEntry
+};
+
+// the key packs the card id in the upper 32 bits, then the entry kind and a width and height of 15 bits each
+static quint64 packKey(int cardId, EntryKind kind, int width, int height)
+{
+    return (quint64(quint32(cardId)) << 32) | (quint64(kind) << 30) | (quint64(width & 0x7fff) << 15) |
+           quint64(height & 0x7fff);
+}
+
+static int cardIdOfKey(quint64 key)
+{
+    return static_cast<int>(key >> 32);
+}
+
+/**
+ * @return The id of the pixmap cache key, the same for as long as the cache lives.
+ */
+int PictureLoaderPixmapCache::cardId(const QString &pixmapCacheKey)
+{
+    auto id = cardIds.constFind(pixmapCacheKey);
+    if (id != cardIds.constEnd()) {
+        return *id;
+    }
+    const int newId = cardIds.size();
+    cardIds.insert(pixmapCacheKey, newId);
+    return newId;
+}
+
+/**
+ * @param level 0 for the full picture, then its levels scaled down by 2, 4 and 8
+ */
+quint64 PictureLoaderPixmapCache::levelKey(int cardId, int level)
+{
+    return packKey(cardId, LevelEntry, level, 0);
+}
+
+quint64 PictureLoaderPixmapCache::thumbnailKey(int cardId, int bucketWidth)
+{
+    return packKey(cardId, ThumbnailEntry, bucketWidth, 0);
+}
+
+quint64 PictureLoaderPixmapCache::sizeKey(int cardId, const QSize &size)
+{
+    return packKey(cardId, SizeEntry, size.width(), size.height());
+}
+
+bool PictureLoaderPixmapCache::find(Tier tier, quint64 key, QPixmap *pixmap)
+{
+    TierData &data = tiers[tier];
+    auto entry = data.entries.find(key);
+    if (entry == data.entries.end()) {
+        ++data.statistics.misses;
+        return false;
+    }
+
+    ++data.statistics.hits;
+    data.lru.splice(data.lru.end(), data.lru, entry->lruPosition);
+    *pixmap = entry->pixmap;
+    return true;
+}
+
+bool PictureLoaderPixmapCache::contains(Tier tier, quint64 key) const
+{
+    return tiers[tier].entries.contains(key);
+}
+
+void PictureLoaderPixmapCache::insert(Tier tier, quint64 key, const QPixmap &pixmap)
+{
+    TierData &data = tiers[tier];
+    auto existing = data.entries.find(key);
+    if (existing != data.entries.end()) {
+        remove(data, existing);
+    }
+
+    const qint64 bytes = qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8 + ENTRY_OVERHEAD;
+    data.lru.push_back(key);
+    data.entries.insert(key, {pixmap, bytes, std::prev(data.lru.end())});
+    data.statistics.bytes += bytes;
+    keysByCard[cardIdOfKey(key)].insert(key);
+
+    evict(data);
+}
+
+void PictureLoaderPixmapCache::remove(TierData &tier, QHash<quint64, Entry>::iterator entry)
+{
+    const quint64 key = entry.key();
+    tier.statistics.bytes -= entry->bytes;
+    tier.lru.erase(entry->lruPosition);
+    tier.entries.erase(entry);
+
+    auto cardKeys = keysByCard.find(cardIdOfKey(key));
+    if (cardKeys != keysByCard.end()) {
+        cardKeys->remove(key);
+        if (cardKeys->isEmpty()) {
+            keysByCard.erase(cardKeys);
+        }
+    }
+}
+
+/**
+ * Removes entries until the tier fits its budget. Of the oldest entries, the largest one goes first, which keeps
+ * more of the pixmaps in the budget.
+ */
+void PictureLoaderPixmapCache::evict(TierData &tier)
+{
+    while (tier.statistics.bytes > tier.statistics.budget && !tier.lru.empty()) {
+        auto victim = tier.entries.end();
+        auto position = tier.lru.begin();
+        for (int i = 0; i < EVICTION_CANDIDATES && position != tier.lru.end(); ++i, ++position) {
+            auto candidate = tier.entries.find(*position);
+            if (victim == tier.entries.end() || candidate->bytes > victim->bytes) {
+                victim = candidate;
+            }
+        }
+        remove(tier, victim);
+        ++tier.statistics.evictions;
+    }
+}
+
+void PictureLoaderPixmapCache::removeCard(int cardId)
+{
+    const QSet<quint64> keys = keysByCard.take(cardId);
+    for (TierData &tier : tiers) {
+        for (quint64 key : keys) {
+            auto entry = tier.entries.find(key);
+            if (entry != tier.entries.end()) {
+                tier.statistics.bytes -= entry->bytes;
+                tier.lru.erase(entry->lruPosition);
+                tier.entries.erase(entry);
+            }
+        }
+    }
+}
+
+void PictureLoaderPixmapCache::clear()
+{
+    for (TierData &tier : tiers) {
+        tier.entries.clear();
+        tier.lru.clear();
+        tier.statistics.bytes = 0;
+    }
+    keysByCard.clear();
+}
+
+void PictureLoaderPixmapCache::setBudget(qint64 bytes)
+{
+    tiers[DisplayTier].statistics.budget = bytes / 4;
+    tiers[FullTier].statistics.budget = bytes - bytes / 4;
+    for (TierData &tier : tiers) {
+        evict(tier);
+    }
+}
+
+PictureLoaderPixmapCache::Statistics PictureLoaderPixmapCache::statistics(Tier tier) const
+{
+    Statistics statistics = tiers[tier].statistics;
+    statistics.entries = tiers[tier].entries.size();
+    return statistics;
+}
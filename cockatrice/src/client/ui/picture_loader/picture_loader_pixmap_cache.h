@@ -0,0 +1,85 @@
+#ifndef PICTURE_LOADER_PIXMAP_CACHE_H
+#define PICTURE_LOADER_PIXMAP_CACHE_H
+
+#include <QHash>
+#include <QPixmap>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <list>
+
+/**
+ * The pixmaps of the card pictures, apart from the QPixmapCache used by the rest of the client.
+ *
+ * The full pictures and their scaled down levels live in the full tier; the pixmaps scaled to the sizes the views
+ * show and the thumbnails they are scaled from live in the display tier. Each tier has its own byte budget, so loading
+ * large pictures never evicts the small pixmaps being drawn.
+ *
+ * Entries are keyed by integers: the card's pixmap cache key is interned once into a card id, which is packed with
+ * the kind of the entry and its size. Each tier evicts its least recently used entries, preferring the largest of the
+ * few oldest ones.
+ *
+ * Only used from the GUI thread.
+ */
+class PictureLoaderPixmapCache
+{
+public:
+    enum Tier
+    {
+        FullTier,
+        DisplayTier,
+        TierCount
+    };
+
+    struct Statistics
+    {
+        qint64 bytes = 0;
+        qint64 budget = 0;
+        int entries = 0;
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+    };
+
+    int cardId(const QString &pixmapCacheKey);
+
+    static quint64 levelKey(int cardId, int level);
+    static quint64 thumbnailKey(int cardId, int bucketWidth);
+    static quint64 sizeKey(int cardId, const QSize &size);
+
+    bool find(Tier tier, quint64 key, QPixmap *pixmap);
+    bool contains(Tier tier, quint64 key) const;
+    void insert(Tier tier, quint64 key, const QPixmap &pixmap);
+    void removeCard(int cardId);
+    void clear();
+
+    /**
+     * Splits the budget between the tiers, giving a quarter of it to the display tier.
+     */
+    void setBudget(qint64 bytes);
+    Statistics statistics(Tier tier) const;
+
+private:
+    struct Entry
+    {
+        QPixmap pixmap;
+        qint64 bytes;
+        std::list<quint64>::iterator lruPosition;
+    };
+
+    struct TierData
+    {
+        QHash<quint64, Entry> entries;
+        std::list<quint64> lru; // least recently used first
+        Statistics statistics;
+    };
+
+    QHash<QString, int> cardIds;
+    TierData tiers[TierCount];
+    QHash<int, QSet<quint64>> keysByCard;
+
+    void remove(TierData &tier, QHash<quint64, Entry>::iterator entry);
+    void evict(TierData &tier);
+};
+
+#endif // PICTURE_LOADER_PIXMAP_CACHE_H
@@ -0,0 +1,241 @@
+#include "picture_loader_redirect_store.h"
+
+#include <QDateTime>
+#include <QSaveFile>
+#include <cstring>
+
+static const QByteArray STORE_MAGIC = "CTRD";
+static constexpr quint32 STORE_VERSION = 1;
+static constexpr qint64 FILE_HEADER_SIZE = 8;    // magic, version
+static constexpr qint64 RECORD_HEADER_SIZE = 16; // key size, value size, timestamp
+// the file isn't rewritten for a few replaced records
+static constexpr qint64 MIN_COMPACTION_BYTES = 64 * 1024;
+
+struct RecordHeader
+{
+    quint32 keySize;
+    quint32 valueSize;
+    qint64 timestamp; // msecs since the epoch
+};
+
+PictureLoaderRedirectStore::PictureLoaderRedirectStore(const QString &_fileName, int ttlDays)
+    : fileName(_fileName), ttlMsecs(qint64(ttlDays) * 24 * 60 * 60 * 1000), mapped(nullptr), liveBytes(0),
+      deadBytes(0)
+{
+    open();
+    compactIfNeeded();
+}
+
+PictureLoaderRedirectStore::~PictureLoaderRedirectStore()
+{
+    close();
+}
+
+bool PictureLoaderRedirectStore::isExpired(qint64 timestamp) const
+{
+    return timestamp + ttlMsecs < QDateTime::currentMSecsSinceEpoch();
+}
+
+QByteArray PictureLoaderRedirectStore::encodeRecord(const QByteArray &key, const QByteArray &value, qint64 timestamp)
+{
+    const RecordHeader header = {static_cast<quint32>(key.size()), static_cast<quint32>(value.size()), timestamp};
+    QByteArray record;
+    record.reserve(RECORD_HEADER_SIZE + key.size() + value.size());
+    record.append(reinterpret_cast<const char *>(&header), RECORD_HEADER_SIZE);
+    record.append(key);
+    record.append(value);
+    return record;
+}
+
+/**
+ * Maps the file and indexes its records. A damaged or truncated end of the file, from a crash while appending, is
+ * dropped.
+ */
+void PictureLoaderRedirectStore::open()
+{
+    mappedFile.setFileName(fileName);
+    qint64 validSize = 0;
+    if (mappedFile.open(QIODevice::ReadOnly) && mappedFile.size() >= FILE_HEADER_SIZE) {
+        mapped = mappedFile.map(0, mappedFile.size());
+    }
+
+    quint32 version = 0;
+    if (mapped) {
+        std::memcpy(&version, mapped + STORE_MAGIC.size(), sizeof(version));
+    }
+    if (mapped && std::memcmp(mapped, STORE_MAGIC.constData(), STORE_MAGIC.size()) == 0 && version == STORE_VERSION) {
+        const qint64 size = mappedFile.size();
+        qint64 offset = FILE_HEADER_SIZE;
+        while (offset + RECORD_HEADER_SIZE <= size) {
+            RecordHeader header;
+            std::memcpy(&header, mapped + offset, RECORD_HEADER_SIZE);
+            const qint64 recordSize = RECORD_HEADER_SIZE + header.keySize + header.valueSize;
+            if (offset + recordSize > size) {
+                break;
+            }
+
+            const QByteArray key =
+                QByteArray::fromRawData(reinterpret_cast<const char *>(mapped + offset + RECORD_HEADER_SIZE),
+                                        static_cast<int>(header.keySize));
+            auto previous = mappedRecords.find(key);
+            if (previous != mappedRecords.end()) {
+                RecordHeader previousHeader;
+                std::memcpy(&previousHeader, mapped + *previous, RECORD_HEADER_SIZE);
+                const qint64 previousSize =
+                    RECORD_HEADER_SIZE + previousHeader.keySize + previousHeader.valueSize;
+                liveBytes -= previousSize;
+                deadBytes += previousSize;
+                mappedRecords.erase(previous);
+            }
+
+            if (isExpired(header.timestamp)) {
+                deadBytes += recordSize;
+            } else {
+                mappedRecords.insert(key, offset);
+                liveBytes += recordSize;
+            }
+            offset += recordSize;
+        }
+        validSize = offset;
+    } else {
+        if (mappedFile.exists() && mappedFile.size() > 0) {
+            qCWarning(PictureLoaderRedirectStoreLog) << "Discarding unreadable redirect store" << fileName;
+        }
+        mappedRecords.clear();
+        if (mapped) {
+            mappedFile.unmap(const_cast<uchar *>(mapped));
+            mapped = nullptr;
+        }
+        mappedFile.close();
+    }
+
+    appendFile.setFileName(fileName);
+    if (validSize == 0) {
+        if (appendFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            appendFile.write(STORE_MAGIC);
+            appendFile.write(reinterpret_cast<const char *>(&STORE_VERSION), sizeof(STORE_VERSION));
+            appendFile.flush();
+        }
+        liveBytes = deadBytes = 0;
+    } else if (appendFile.open(QIODevice::ReadWrite)) {
+        if (appendFile.size() > validSize) {
+            qCWarning(PictureLoaderRedirectStoreLog) << "Dropping the damaged end of" << fileName;
+            appendFile.resize(validSize);
+        }
+        appendFile.seek(validSize);
+    }
+    if (!appendFile.isOpen()) {
+        qCWarning(PictureLoaderRedirectStoreLog) << "Could not open" << fileName << "for writing";
+    }
+}
+
+void PictureLoaderRedirectStore::close()
+{
+    appendFile.close();
+    mappedRecords.clear();
+    appendedRecords.clear();
+    if (mapped) {
+        mappedFile.unmap(const_cast<uchar *>(mapped));
+        mapped = nullptr;
+    }
+    mappedFile.close();
+    liveBytes = deadBytes = 0;
+}
+
+QUrl PictureLoaderRedirectStore::find(const QUrl &originalUrl) const
+{
+    const QByteArray key = originalUrl.toEncoded();
+
+    auto appended = appendedRecords.constFind(key);
+    if (appended != appendedRecords.constEnd()) {
+        return isExpired(appended->timestamp) ? QUrl() : appended->url;
+    }
+
+    auto record = mappedRecords.constFind(key);
+    if (record == mappedRecords.constEnd()) {
+        return {};
+    }
+    RecordHeader header;
+    std::memcpy(&header, mapped + *record, RECORD_HEADER_SIZE);
+    if (isExpired(header.timestamp)) {
+        return {};
+    }
+    const char *value = reinterpret_cast<const char *>(mapped + *record + RECORD_HEADER_SIZE + header.keySize);
+    return QUrl::fromEncoded(QByteArray(value, static_cast<int>(header.valueSize)));
+}
+
+void PictureLoaderRedirectStore::insert(const QUrl &originalUrl, const QUrl &redirectUrl, const QDateTime &followedAt)
+{
+    const QByteArray key = originalUrl.toEncoded();
+    const QByteArray value = redirectUrl.toEncoded();
+    const qint64 timestamp = followedAt.toMSecsSinceEpoch();
+    const QByteArray record = encodeRecord(key, value, timestamp);
+
+    auto mappedRecord = mappedRecords.find(key);
+    if (mappedRecord != mappedRecords.end()) {
+        RecordHeader header;
+        std::memcpy(&header, mapped + *mappedRecord, RECORD_HEADER_SIZE);
+        const qint64 replacedSize = RECORD_HEADER_SIZE + header.keySize + header.valueSize;
+        liveBytes -= replacedSize;
+        deadBytes += replacedSize;
+        mappedRecords.erase(mappedRecord);
+    }
+    auto appendedRecord = appendedRecords.constFind(key);
+    if (appendedRecord != appendedRecords.constEnd()) {
+        liveBytes -= appendedRecord->recordSize;
+        deadBytes += appendedRecord->recordSize;
+    }
+
+    appendedRecords.insert(key, {redirectUrl, timestamp, record.size()});
+    liveBytes += record.size();
+    if (appendFile.isOpen()) {
+        appendFile.write(record);
+        appendFile.flush();
+    }
+
+    compactIfNeeded();
+}
+
+/**
+ * Rewrites the file with the live records alone, once the others take more space than them.
+ */
+void PictureLoaderRedirectStore::compactIfNeeded()
+{
+    if (deadBytes < MIN_COMPACTION_BYTES || deadBytes < liveBytes) {
+        return;
+    }
+
+    QSaveFile compacted(fileName);
+    if (!compacted.open(QIODevice::WriteOnly)) {
+        qCWarning(PictureLoaderRedirectStoreLog) << "Could not compact" << fileName;
+        return;
+    }
+    compacted.write(STORE_MAGIC);
+    compacted.write(reinterpret_cast<const char *>(&STORE_VERSION), sizeof(STORE_VERSION));
+    for (auto record = mappedRecords.cbegin(); record != mappedRecords.cend(); ++record) {
+        RecordHeader header;
+        std::memcpy(&header, mapped + record.value(), RECORD_HEADER_SIZE);
+        compacted.write(reinterpret_cast<const char *>(mapped + record.value()),
+                        RECORD_HEADER_SIZE + header.keySize + header.valueSize);
+    }
+    for (auto record = appendedRecords.cbegin(); record != appendedRecords.cend(); ++record) {
+        compacted.write(encodeRecord(record.key(), record->url.toEncoded(), record->timestamp));
+    }
+
+    qCDebug(PictureLoaderRedirectStoreLog) << "Compacting" << fileName << "from" << liveBytes + deadBytes << "to"
+                                           << liveBytes << "bytes";
+
+    // the file has to be closed and unmapped before it can be replaced
+    close();
+    if (!compacted.commit()) {
+        qCWarning(PictureLoaderRedirectStoreLog) << "Could not compact" << fileName;
+    }
+    open();
+}
+
+void PictureLoaderRedirectStore::clear()
+{
+    close();
+    QFile::remove(fileName);
+    open();
+}
@@ -0,0 +1,75 @@
+#ifndef PICTURE_LOADER_REDIRECT_STORE_H
+#define PICTURE_LOADER_REDIRECT_STORE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QPair>
+#include <QString>
+#include <QUrl>
+
+inline Q_LOGGING_CATEGORY(PictureLoaderRedirectStoreLog, "picture_loader.redirect_store");
+
+/**
+ * The redirects followed by the picture downloads, kept between sessions so the next download of a picture goes to
+ * the image directly.
+ *
+ * The file is a log of records: every redirect is appended as it is followed, and a later record of the same url
+ * replaces the earlier ones. The log is memory-mapped when opened and only the record headers are read, the urls are
+ * decoded when they are looked up. Records older than the ttl are ignored, and the file is rewritten with the live
+ * records alone once the replaced and expired ones take more space than them.
+ */
+class PictureLoaderRedirectStore
+{
+public:
+    PictureLoaderRedirectStore(const QString &_fileName, int ttlDays);
+    ~PictureLoaderRedirectStore();
+
+    QUrl find(const QUrl &originalUrl) const;
+    void insert(const QUrl &originalUrl,
+                const QUrl &redirectUrl,
+                const QDateTime &followedAt = QDateTime::currentDateTimeUtc());
+    void clear();
+
+    int size() const
+    {
+        return static_cast<int>(mappedRecords.size() + appendedRecords.size());
+    }
+    qint64 fileSize() const
+    {
+        return liveBytes + deadBytes;
+    }
+
+private:
+    struct Redirect
+    {
+        QUrl url;
+        qint64 timestamp;
+        qint64 recordSize;
+    };
+
+    QString fileName;
+    qint64 ttlMsecs;
+
+    QFile mappedFile;
+    const uchar *mapped;
+    QFile appendFile;
+
+    // the urls of the records in the mapped file, pointing into the mapping, to the offset of their record
+    QHash<QByteArray, qint64> mappedRecords;
+    // the records appended since the file was mapped
+    QHash<QByteArray, Redirect> appendedRecords;
+
+    qint64 liveBytes;
+    qint64 deadBytes; // taken by replaced and expired records
+
+    void open();
+    void close();
+    void compactIfNeeded();
+    bool isExpired(qint64 timestamp) const;
+    static QByteArray encodeRecord(const QByteArray &key, const QByteArray &value, qint64 timestamp);
+};
+
+#endif // PICTURE_LOADER_REDIRECT_STORE_H
@@ -0,0 +1,133 @@
+#include "picture_loader_scryfall_resolver.h"
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+#include <QSet>
+#include <QUrlQuery>
+
+static const QString SCRYFALL_API_HOST = "api.scryfall.com";
+static const QUrl COLLECTION_URL("https://api.scryfall.com/cards/collection");
+// the most identifiers the collection endpoint accepts in one request
+static constexpr int MAX_BATCH_SIZE = 75;
+// how long to wait for more urls before sending a batch
+static constexpr int BATCH_DELAY_MS = 100;
+// Scryfall asks for at most two requests to the collection endpoint per second
+static constexpr int MIN_BATCH_INTERVAL_MS = 500;
+
+PictureLoaderScryfallResolver::PictureLoaderScryfallResolver(QNetworkAccessManager *_networkManager, QObject *parent)
+    : QObject(parent), networkManager(_networkManager)
+{
+    batchTimer.setSingleShot(true);
+    connect(&batchTimer, &QTimer::timeout, this, &PictureLoaderScryfallResolver::sendBatch);
+}
+
+static QString cardIdOf(const QUrl &url)
+{
+    static const QRegularExpression rxCardPath("^/cards/([0-9a-fA-F-]{36})$");
+    const auto match = rxCardPath.match(url.path());
+    return match.hasMatch() ? match.captured(1).toLower() : QString();
+}
+
+/**
+ * @return If the url is the image of a Scryfall card by id, like the first of the default download templates.
+ */
+bool PictureLoaderScryfallResolver::isResolvable(const QUrl &url)
+{
+    return url.host() == SCRYFALL_API_HOST && QUrlQuery(url).queryItemValue("format") == "image" &&
+           !cardIdOf(url).isEmpty();
+}
+
+void PictureLoaderScryfallResolver::resolve(const QUrl &url, PictureLoaderWorkerWork *work)
+{
+    const QUrlQuery query(url);
+    const QString version = query.queryItemValue("version");
+    pending.append({url, work, cardIdOf(url), query.queryItemValue("face") == "back",
+                    version.isEmpty() ? QStringLiteral("large") : version});
+    scheduleBatch();
+}
+
+void PictureLoaderScryfallResolver::scheduleBatch()
+{
+    if (pending.isEmpty() || batchTimer.isActive()) {
+        return;
+    }
+
+    int delay = BATCH_DELAY_MS;
+    if (sinceLastBatch.isValid()) {
+        delay = qMax(delay, MIN_BATCH_INTERVAL_MS - static_cast<int>(sinceLastBatch.elapsed()));
+    }
+    batchTimer.start(delay);
+}
+
+void PictureLoaderScryfallResolver::sendBatch()
+{
+    QList<PendingUrl> batch;
+    QSet<QString> ids;
+    QJsonArray identifiers;
+    while (!pending.isEmpty() && (ids.size() < MAX_BATCH_SIZE || ids.contains(pending.first().id))) {
+        const PendingUrl pendingUrl = pending.takeFirst();
+        if (!ids.contains(pendingUrl.id)) {
+            ids.insert(pendingUrl.id);
+            identifiers.append(QJsonObject{{"id", pendingUrl.id}});
+        }
+        batch.append(pendingUrl);
+    }
+
+    qCDebug(PictureLoaderScryfallResolverLog) << "Resolving" << identifiers.size() << "cards";
+
+    QNetworkRequest request(COLLECTION_URL);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("Accept", "application/json");
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    QNetworkReply *reply =
+        networkManager->post(request, QJsonDocument(QJsonObject{{"identifiers", identifiers}}).toJson());
+    connect(reply, &QNetworkReply::finished, this, [this, reply, batch] { handleReply(reply, batch); });
+
+    sinceLastBatch.start();
+    scheduleBatch();
+}
+
+static QUrl imageUrlOf(const QJsonObject &card, bool backFace, const QString &version)
+{
+    const QJsonArray faces = card.value("card_faces").toArray();
+    QJsonObject imageUris;
+    if (backFace) {
+        if (faces.size() > 1) {
+            imageUris = faces.at(1).toObject().value("image_uris").toObject();
+        }
+    } else {
+        imageUris = card.value("image_uris").toObject();
+        if (imageUris.isEmpty() && !faces.isEmpty()) {
+            imageUris = faces.at(0).toObject().value("image_uris").toObject();
+        }
+    }
+    return QUrl(imageUris.value(version).toString());
+}
+
+void PictureLoaderScryfallResolver::handleReply(QNetworkReply *reply, const QList<PendingUrl> &batch)
+{
+    QHash<QString, QJsonObject> cards;
+    if (reply->error()) {
+        qCWarning(PictureLoaderScryfallResolverLog) << "Resolving the card images failed:" << reply->errorString();
+    } else {
+        const QJsonArray data = QJsonDocument::fromJson(reply->readAll()).object().value("data").toArray();
+        for (const QJsonValue &card : data) {
+            const QJsonObject cardObject = card.toObject();
+            cards.insert(cardObject.value("id").toString().toLower(), cardObject);
+        }
+    }
+    reply->deleteLater();
+
+    // the urls that couldn't be resolved are requested one by one instead
+    for (const PendingUrl &pendingUrl : batch) {
+        auto card = cards.constFind(pendingUrl.id);
+        const QUrl imageUrl =
+            card == cards.constEnd() ? QUrl() : imageUrlOf(*card, pendingUrl.backFace, pendingUrl.version);
+        emit urlResolved(pendingUrl.url, pendingUrl.work, imageUrl);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef PICTURE_LOADER_SCRYFALL_RESOLVER_H
+#define PICTURE_LOADER_SCRYFALL_RESOLVER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QLoggingCategory>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QTimer>
+#include <QUrl>
+
+inline Q_LOGGING_CATEGORY(PictureLoaderScryfallResolverLog, "picture_loader.scryfall_resolver");
+
+class PictureLoaderWorkerWork;
+class QNetworkReply;
+
+/**
+ * Looks up the image urls behind the Scryfall card urls of the default download templates, many cards at a time.
+ *
+ * A Scryfall url like https://api.scryfall.com/cards/<id>?format=image answers with a redirect to the image, one
+ * request per card. The urls asked for within a short delay are instead resolved together through the collection
+ * endpoint, which returns up to 75 cards per request, and the worker downloads the images directly.
+ */
+class PictureLoaderScryfallResolver : public QObject
+{
+    Q_OBJECT
+public:
+    PictureLoaderScryfallResolver(QNetworkAccessManager *_networkManager, QObject *parent);
+
+    static bool isResolvable(const QUrl &url);
+    void resolve(const QUrl &url, PictureLoaderWorkerWork *work);
+
+signals:
+    /**
+     * Emitted for every url passed to resolve(). The image url is empty if the card wasn't found.
+     */
+    void urlResolved(const QUrl &url, PictureLoaderWorkerWork *work, const QUrl &imageUrl);
+
+private:
+    struct PendingUrl
+    {
+        QUrl url;
+        PictureLoaderWorkerWork *work;
+        QString id;
+        bool backFace;
+        QString version;
+    };
+
+    QNetworkAccessManager *networkManager;
+    QList<PendingUrl> pending;
+    QTimer batchTimer;
+    QElapsedTimer sinceLastBatch;
+
+    void scheduleBatch();
+    void sendBatch();
+    void handleReply(QNetworkReply *reply, const QList<PendingUrl> &batch);
+};
+
+#endif // PICTURE_LOADER_SCRYFALL_RESOLVER_H
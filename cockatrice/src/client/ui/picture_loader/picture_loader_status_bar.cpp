@@ -10,6 +10,10 @@ PictureLoaderStatusBar::PictureLoaderStatusBar(QWidget *parent) : QWidget(parent
     progressBar->setFormat("%v/%m");
     layout->addWidget(progressBar);
 
+    queueDepths = new QLabel(this);
+    queueDepths->hide();
+    layout->addWidget(queueDepths);
+
     loadLog = new SettingsButtonWidget(this);
     layout->addWidget(loadLog);
 
@@ -54,4 +58,18 @@ void PictureLoaderStatusBar::addSuccessfulImageLoad(const QUrl &url)
             statusDisplayWidget->setFinished();
         }
     }
-}
\ No newline at end of file
+}
+
+/**
+ * Shows how many picture requests are waiting in every priority class, hidden while none is.
+ */
+void PictureLoaderStatusBar::setQueueDepths(int visible, int hovered, int prefetch, int background)
+{
+    queueDepths->setVisible(visible + hovered + prefetch + background > 0);
+    queueDepths->setText(QString("%1 / %2 / %3 / %4").arg(visible).arg(hovered).arg(prefetch).arg(background));
+    queueDepths->setToolTip(tr("Queued picture downloads: %1 visible, %2 hovered, %3 prefetched, %4 in the background")
+                                .arg(visible)
+                                .arg(hovered)
+                                .arg(prefetch)
+                                .arg(background));
+}
@@ -5,6 +5,7 @@
 #include "picture_loader_worker_work.h"
 
 #include <QHBoxLayout>
+#include <QLabel>
 #include <QProgressBar>
 #include <QWidget>
 
@@ -17,11 +18,13 @@ public:
 public slots:
     void addQueuedImageLoad(const QUrl &url, const ExactCard &card, const QString &setName);
     void addSuccessfulImageLoad(const QUrl &url);
+    void setQueueDepths(int visible, int hovered, int prefetch, int background);
     void cleanOldEntries();
 
 private:
     QHBoxLayout *layout;
     QProgressBar *progressBar;
+    QLabel *queueDepths;
     SettingsButtonWidget *loadLog;
     QTimer *cleaner;
 };
@@ -0,0 +1,142 @@
+#include "picture_loader_thumbnail_cache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <cstring>
+
+static const QList<int> BUCKET_WIDTHS = {128, 256};
+static const QByteArray THUMBNAIL_MAGIC = "CTH1";
+static constexpr int HEADER_SIZE = 16; // magic, width, height, bytes per line
+// check the total size of the thumbnails every this many saves
+static constexpr int SAVES_PER_TRIM = 50;
+
+PictureLoaderThumbnailCache::PictureLoaderThumbnailCache(const QString &_directory, qint64 _maximumSize)
+    : directory(_directory), maximumSize(_maximumSize), savesSinceTrim(SAVES_PER_TRIM)
+{
+    if (!directory.isEmpty()) {
+        QDir().mkpath(directory);
+    }
+}
+
+int PictureLoaderThumbnailCache::bucketWidth(int width)
+{
+    for (int bucket : BUCKET_WIDTHS) {
+        if (width <= bucket) {
+            return bucket;
+        }
+    }
+    return 0;
+}
+
+QString PictureLoaderThumbnailCache::filePath(const QString &cacheKey, int bucketWidth) const
+{
+    const QByteArray name = (cacheKey + QLatin1Char('_') + QString::number(bucketWidth)).toUtf8();
+    return directory + "/" + QCryptographicHash::hash(name, QCryptographicHash::Sha1).toHex() + ".thumb";
+}
+
+QImage PictureLoaderThumbnailCache::load(const QString &cacheKey, int bucketWidth) const
+{
+    if (directory.isEmpty()) {
+        return QImage();
+    }
+
+    QFile file(filePath(cacheKey, bucketWidth));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < HEADER_SIZE) {
+        return QImage();
+    }
+
+    const uchar *data = file.map(0, file.size());
+    if (!data || std::memcmp(data, THUMBNAIL_MAGIC.constData(), 4) != 0) {
+        return QImage();
+    }
+
+    quint32 header[3];
+    std::memcpy(header, data + 4, sizeof(header));
+    const quint32 width = header[0], height = header[1], bytesPerLine = header[2];
+    if (width == 0 || height == 0 || bytesPerLine < width * 4 ||
+        file.size() != HEADER_SIZE + qint64(bytesPerLine) * height) {
+        qCWarning(PictureLoaderThumbnailCacheLog) << "Ignoring damaged thumbnail" << file.fileName();
+        return QImage();
+    }
+
+    // the mapping goes away with the file, keep a copy of the pixels
+    const QImage image = QImage(data + HEADER_SIZE, static_cast<int>(width), static_cast<int>(height),
+                                static_cast<int>(bytesPerLine), QImage::Format_ARGB32_Premultiplied)
+                             .copy();
+
+    // the modification time tells the least recently used thumbnails apart
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return image;
+}
+
+/**
+ * Saves the thumbnails of the image for every bucket narrower than it, unless they are saved already.
+ */
+void PictureLoaderThumbnailCache::save(const QString &cacheKey, const QImage &image)
+{
+    if (directory.isEmpty() || image.isNull()) {
+        return;
+    }
+
+    for (int bucket : BUCKET_WIDTHS) {
+        if (image.width() <= bucket) {
+            break;
+        }
+        const QString path = filePath(cacheKey, bucket);
+        if (QFile::exists(path)) {
+            continue;
+        }
+
+        const QImage thumbnail = image.scaledToWidth(bucket, Qt::SmoothTransformation)
+                                     .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        const quint32 header[3] = {static_cast<quint32>(thumbnail.width()), static_cast<quint32>(thumbnail.height()),
+                                   static_cast<quint32>(thumbnail.bytesPerLine())};
+
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qCWarning(PictureLoaderThumbnailCacheLog) << "Could not write thumbnail" << file.fileName();
+            return;
+        }
+        file.write(THUMBNAIL_MAGIC);
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(thumbnail.constBits()),
+                   qint64(thumbnail.bytesPerLine()) * thumbnail.height());
+        file.commit();
+    }
+
+    if (++savesSinceTrim >= SAVES_PER_TRIM) {
+        trim();
+    }
+}
+
+/**
+ * Removes the least recently used thumbnails until the others fit in the maximum size.
+ */
+void PictureLoaderThumbnailCache::trim()
+{
+    savesSinceTrim = 0;
+
+    qint64 totalSize = 0;
+    const QFileInfoList files = QDir(directory).entryInfoList({"*.thumb"}, QDir::Files, QDir::Time);
+    for (const QFileInfo &fileInfo : files) {
+        totalSize += fileInfo.size();
+        if (totalSize > maximumSize) {
+            QFile::remove(fileInfo.absoluteFilePath());
+        }
+    }
+}
+
+void PictureLoaderThumbnailCache::clear()
+{
+    if (directory.isEmpty()) {
+        return;
+    }
+
+    const QFileInfoList files = QDir(directory).entryInfoList({"*.thumb"}, QDir::Files);
+    for (const QFileInfo &fileInfo : files) {
+        QFile::remove(fileInfo.absoluteFilePath());
+    }
+}
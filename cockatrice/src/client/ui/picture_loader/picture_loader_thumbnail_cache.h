@@ -0,0 +1,48 @@
+#ifndef PICTURE_LOADER_THUMBNAIL_CACHE_H
+#define PICTURE_LOADER_THUMBNAIL_CACHE_H
+
+#include <QImage>
+#include <QLoggingCategory>
+#include <QString>
+
+inline Q_LOGGING_CATEGORY(PictureLoaderThumbnailCacheLog, "picture_loader.thumbnail_cache");
+
+// the most disk space the thumbnails of the card pictures can take
+#define THUMBNAIL_CACHE_SIZE_MAX (256LL * 1024 * 1024)
+
+/**
+ * Small copies of the card pictures kept on disk between sessions, so that the views showing cards at thumbnail
+ * sizes don't have to load and decode the full pictures.
+ *
+ * Every picture is stored at a few bucket widths, in files named by a hash of the pixmap cache key of the card and the
+ * width. The pixels are stored raw, in the premultiplied ARGB format pixmaps are drawn from, so a thumbnail is loaded
+ * by copying it out of the memory-mapped file. The least recently used thumbnails are removed once the files take
+ * more than the maximum size.
+ *
+ * load() is used from the GUI thread and save() from the picture loader thread; files are replaced atomically, so a
+ * thumbnail being saved is never read half written.
+ */
+class PictureLoaderThumbnailCache
+{
+public:
+    PictureLoaderThumbnailCache(const QString &_directory, qint64 _maximumSize);
+
+    /**
+     * @return The width of the thumbnails to show a picture at width pixels from, or 0 if no thumbnail is that large.
+     */
+    static int bucketWidth(int width);
+
+    QImage load(const QString &cacheKey, int bucketWidth) const;
+    void save(const QString &cacheKey, const QImage &image);
+    void clear();
+
+private:
+    QString directory;
+    qint64 maximumSize;
+    int savesSinceTrim;
+
+    QString filePath(const QString &cacheKey, int bucketWidth) const;
+    void trim();
+};
+
+#endif // PICTURE_LOADER_THUMBNAIL_CACHE_H
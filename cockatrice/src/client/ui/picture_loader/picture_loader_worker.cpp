@@ -2,6 +2,7 @@
 
 #include "../../../game/cards/card_database_manager.h"
 #include "../../../settings/cache_settings.h"
+#include "../../../utility/startup_trace.h"
 #include "picture_loader_local.h"
 #include "picture_loader_worker_work.h"
 
@@ -9,13 +10,41 @@
 #include <QMovie>
 #include <QNetworkDiskCache>
 #include <QNetworkReply>
+#include <QSettings>
 #include <QThread>
 #include <utility>
 
 static constexpr int MAX_REQUESTS_PER_SEC = 10;
+static constexpr int MAX_DECODE_THREADS = 4;
+// the smallest image kept by scaleDown(), as a width in pixels
+static constexpr int MIN_SCALED_WIDTH = 64;
 
-PictureLoaderWorker::PictureLoaderWorker()
-    : QObject(nullptr), picDownload(SettingsCache::instance().getPicDownload()), requestQuota(MAX_REQUESTS_PER_SEC)
+namespace
+{
+class LocalImageDecode : public QRunnable
+{
+public:
+    LocalImageDecode(PictureLoaderWorker *_worker, const ExactCard &_card, const QStringList &_files)
+        : worker(_worker), card(_card), files(_files)
+    {
+    }
+
+    void run() override
+    {
+        emit worker->localImageDecoded(card, PictureLoaderLocal::loadFirstImage(files, card.getName()));
+    }
+
+private:
+    PictureLoaderWorker *worker;
+    ExactCard card;
+    QStringList files;
+};
+} // namespace
+
+PictureLoaderWorker::PictureLoaderWorker(QSharedPointer<PictureLoaderThumbnailCache> _thumbnailCache)
+    : QObject(nullptr), picDownload(SettingsCache::instance().getPicDownload()), requestQuota(MAX_REQUESTS_PER_SEC),
+      maxRequestsPerHost(SettingsCache::instance().downloads().getMaxRequestsPerHost()), decodePriority(0),
+      thumbnailCache(std::move(_thumbnailCache))
 {
     networkManager = new QNetworkAccessManager(this);
     // We need a timeout to ensure requests don't hang indefinitely in case of
@@ -36,20 +65,25 @@ PictureLoaderWorker::PictureLoaderWorker()
     // We can't use NoLessSafeRedirectPolicy because it is not applied with AlwaysCache
     networkManager->setRedirectPolicy(QNetworkRequest::ManualRedirectPolicy);
 
-    cacheFilePath = SettingsCache::instance().getRedirectCachePath() + REDIRECT_CACHE_FILENAME;
-    loadRedirectCache();
-    cleanStaleEntries();
-
-    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this,
-            &PictureLoaderWorker::saveRedirectCache);
+    // opened by openRedirectStore() on the picture loader thread
+    redirectStore = nullptr;
 
     localLoader = new PictureLoaderLocal(this);
+    scryfallResolver = new PictureLoaderScryfallResolver(networkManager, this);
+    connect(scryfallResolver, &PictureLoaderScryfallResolver::urlResolved, this,
+            &PictureLoaderWorker::handleUrlResolved);
+    decodePool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() - 1, MAX_DECODE_THREADS));
 
     pictureLoaderThread = new QThread;
     pictureLoaderThread->start(QThread::LowPriority);
     moveToThread(pictureLoaderThread);
+    // queued before anything else the thread is asked to do, so the store is open before the first lookup
+    QMetaObject::invokeMethod(this, "openRedirectStore", Qt::QueuedConnection);
 
+    qRegisterMetaType<PictureLoadPriority>("PictureLoadPriority");
     connect(this, &PictureLoaderWorker::imageLoadEnqueued, this, &PictureLoaderWorker::handleImageLoadEnqueued);
+    connect(this, &PictureLoaderWorker::imageLoadCancelled, this, &PictureLoaderWorker::handleImageLoadCancelled);
+    connect(this, &PictureLoaderWorker::localImageDecoded, this, &PictureLoaderWorker::handleLocalImageDecoded);
 
     connect(&requestTimer, &QTimer::timeout, this, &PictureLoaderWorker::resetRequestQuota);
     requestTimer.setInterval(1000);
@@ -58,7 +92,9 @@ PictureLoaderWorker::PictureLoaderWorker()
 
 PictureLoaderWorker::~PictureLoaderWorker()
 {
-    saveRedirectCache();
+    decodePool.clear();
+    decodePool.waitForDone();
+    delete redirectStore;
     pictureLoaderThread->deleteLater();
 }
 
@@ -70,10 +106,34 @@ void PictureLoaderWorker::queueRequest(const QUrl &url, PictureLoaderWorkerWork
     } else if (cache->metaData(url).isValid()) {
         // If we hit a cached url, we get to make the request for free, since it won't contribute towards the rate-limit
         makeRequest(url, worker);
+    } else if (picDownload && PictureLoaderScryfallResolver::isResolvable(url)) {
+        // look the image up together with the other cards asked for around the same time
+        scryfallResolver->resolve(url, worker);
     } else {
-        requestLoadQueue.append(qMakePair(url, worker));
-        emit imageRequestQueued(url, worker->cardToDownload.getCard(), worker->cardToDownload.getSetName());
-        processQueuedRequests();
+        enqueueRequest(url, worker);
+    }
+}
+
+void PictureLoaderWorker::enqueueRequest(const QUrl &url, PictureLoaderWorkerWork *worker)
+{
+    const PictureLoadPriority priority =
+        currentlyLoading.value(worker->cardToDownload.getCard().getPixmapCacheKey(), PictureLoadPriority::Background);
+    requestLoadQueues[static_cast<int>(priority)].append(qMakePair(url, worker));
+    emit imageRequestQueued(url, worker->cardToDownload.getCard(), worker->cardToDownload.getSetName());
+    processQueuedRequests();
+    emitRequestQueueChanged();
+}
+
+/**
+ * Downloads the image behind a Scryfall url directly once it is resolved, remembering it as the url's redirect.
+ */
+void PictureLoaderWorker::handleUrlResolved(const QUrl &url, PictureLoaderWorkerWork *worker, const QUrl &imageUrl)
+{
+    if (imageUrl.isValid()) {
+        cacheRedirect(url, imageUrl);
+        queueRequest(imageUrl, worker);
+    } else {
+        enqueueRequest(url, worker);
     }
 }
 
@@ -90,9 +150,21 @@ QNetworkReply *PictureLoaderWorker::makeRequest(const QUrl &url, PictureLoaderWo
     if (!picDownload) {
         req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysCache);
     }
+    // the image hosts serve all the downloads over a single multiplexed connection
+    req.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
 
     QNetworkReply *reply = networkManager->get(req);
 
+    const QString host = url.host();
+    ++requestsInFlight[host];
+    connect(reply, &QNetworkReply::finished, this, [this, host] {
+        if (--requestsInFlight[host] <= 0) {
+            requestsInFlight.remove(host);
+        }
+        processQueuedRequests();
+        emitRequestQueueChanged();
+    });
+
     // Connect reply handling
     connect(reply, &QNetworkReply::finished, worker, [reply, worker] { worker->handleNetworkReply(reply); });
 
@@ -103,6 +175,15 @@ void PictureLoaderWorker::resetRequestQuota()
 {
     requestQuota = MAX_REQUESTS_PER_SEC;
     processQueuedRequests();
+    emitRequestQueueChanged();
+}
+
+void PictureLoaderWorker::emitRequestQueueChanged()
+{
+    emit requestQueueChanged(requestLoadQueues[static_cast<int>(PictureLoadPriority::Visible)].size(),
+                             requestLoadQueues[static_cast<int>(PictureLoadPriority::Hovered)].size(),
+                             requestLoadQueues[static_cast<int>(PictureLoadPriority::Prefetch)].size(),
+                             requestLoadQueues[static_cast<int>(PictureLoadPriority::Background)].size());
 }
 
 /**
@@ -116,37 +197,115 @@ void PictureLoaderWorker::processQueuedRequests()
 }
 
 /**
- * Immediately processes a single queued request. No-ops if the load queue is empty
+ * Immediately processes the oldest queued request of the most urgent priority class, skipping the hosts already
+ * serving maxRequestsPerHost requests. No-ops if no queued request can be made
  * @return If a request was processed
  */
 bool PictureLoaderWorker::processSingleRequest()
 {
-    if (!requestLoadQueue.isEmpty()) {
-        auto request = requestLoadQueue.takeFirst();
-        makeRequest(request.first, request.second);
-        return true;
+    for (auto &requestLoadQueue : requestLoadQueues) {
+        for (int i = 0; i < requestLoadQueue.size(); ++i) {
+            if (requestsInFlight.value(requestLoadQueue.at(i).first.host()) < maxRequestsPerHost) {
+                auto request = requestLoadQueue.takeAt(i);
+                makeRequest(request.first, request.second);
+                return true;
+            }
+        }
     }
     return false;
 }
 
-void PictureLoaderWorker::enqueueImageLoad(const ExactCard &card)
+void PictureLoaderWorker::enqueueImageLoad(const ExactCard &card, PictureLoadPriority priority)
 {
     // Send call through a connection to ensure the handling is run on the pictureLoader thread
-    emit imageLoadEnqueued(card);
+    emit imageLoadEnqueued(card, priority);
+}
+
+/**
+ * Drops the load of a card that the caller doesn't show anymore, if its request is still waiting for the quota.
+ * Loads already downloading or decoding are finished.
+ */
+void PictureLoaderWorker::cancelImageLoad(const ExactCard &card)
+{
+    emit imageLoadCancelled(card);
 }
 
-void PictureLoaderWorker::handleImageLoadEnqueued(const ExactCard &card)
+/**
+ * Moves the waiting requests of a card being loaded to the queue of a more urgent priority class.
+ */
+void PictureLoaderWorker::raisePriority(const QString &cacheKey, PictureLoadPriority priority)
+{
+    auto loading = currentlyLoading.find(cacheKey);
+    if (loading == currentlyLoading.end() || *loading <= priority) {
+        return;
+    }
+    *loading = priority;
+
+    auto &target = requestLoadQueues[static_cast<int>(priority)];
+    for (auto &requestLoadQueue : requestLoadQueues) {
+        if (&requestLoadQueue == &target) {
+            continue;
+        }
+        for (int i = requestLoadQueue.size() - 1; i >= 0; --i) {
+            if (requestLoadQueue.at(i).second->cardToDownload.getCard().getPixmapCacheKey() == cacheKey) {
+                target.append(requestLoadQueue.takeAt(i));
+            }
+        }
+    }
+    emitRequestQueueChanged();
+}
+
+void PictureLoaderWorker::handleImageLoadEnqueued(const ExactCard &card, PictureLoadPriority priority)
 {
     // deduplicate loads for the same card
     if (currentlyLoading.contains(card.getPixmapCacheKey())) {
         qCDebug(PictureLoaderWorkerLog())
             << "Skipping enqueued" << card.getName() << "because it's already being loaded";
+        raisePriority(card.getPixmapCacheKey(), priority);
+        return;
+    }
+    currentlyLoading.insert(card.getPixmapCacheKey(), priority);
+
+    // try to load image from local first, decoding it on the pool
+    const QStringList files = localLoader->findImageFiles(card);
+    if (files.isEmpty()) {
+        new PictureLoaderWorkerWork(this, card);
+        return;
+    }
+    // the priority class comes first, then the latest requested cards
+    decodePriority = (decodePriority + 1) & 0xffffff;
+    const int classRank = static_cast<int>(PictureLoadPriority::Count) - static_cast<int>(priority);
+    decodePool.start(new LocalImageDecode(this, card, files), (classRank << 24) | decodePriority);
+}
+
+void PictureLoaderWorker::handleImageLoadCancelled(const ExactCard &card)
+{
+    const QString cacheKey = card.getPixmapCacheKey();
+    if (!currentlyLoading.contains(cacheKey)) {
         return;
     }
-    currentlyLoading.insert(card.getPixmapCacheKey());
 
-    // try to load image from local first
-    QImage image = localLoader->tryLoad(card);
+    for (auto &requestLoadQueue : requestLoadQueues) {
+        for (int i = 0; i < requestLoadQueue.size(); ++i) {
+            PictureLoaderWorkerWork *work = requestLoadQueue.at(i).second;
+            if (work->cardToDownload.getCard().getPixmapCacheKey() != cacheKey) {
+                continue;
+            }
+
+            requestLoadQueue.removeAt(i);
+            work->deleteLater();
+            currentlyLoading.remove(cacheKey);
+            emitRequestQueueChanged();
+
+            // the views still showing the card ask for it again when they are repainted
+            card.emitPixmapUpdated();
+            return;
+        }
+    }
+}
+
+void PictureLoaderWorker::handleLocalImageDecoded(const ExactCard &card, const QImage &image)
+{
     if (!image.isNull()) {
         handleImageLoaded(card, image);
     } else {
@@ -161,13 +320,31 @@ void PictureLoaderWorker::handleImageLoadEnqueued(const ExactCard &card)
 void PictureLoaderWorker::handleImageLoaded(const ExactCard &card, const QImage &image)
 {
     currentlyLoading.remove(card.getPixmapCacheKey());
-    emit imageLoaded(card, image);
+    if (!image.isNull()) {
+        thumbnailCache->save(card.getPixmapCacheKey(), image);
+    }
+    emit imageLoaded(card, image, scaleDown(image));
+}
+
+/**
+ * Scales the image down to a half, a quarter and an eighth of its size, so that the pixmaps of the sizes shown are
+ * scaled from a level at most twice as large, instead of from the full image on the GUI thread.
+ * @return The scaled images, largest first. Levels narrower than MIN_SCALED_WIDTH are left out.
+ */
+QList<QImage> PictureLoaderWorker::scaleDown(const QImage &image)
+{
+    QList<QImage> levels;
+    QImage level = image;
+    for (int i = 0; i < 3 && !level.isNull() && level.width() / 2 >= MIN_SCALED_WIDTH; ++i) {
+        level = level.scaled(level.size() / 2, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        levels.append(level);
+    }
+    return levels;
 }
 
 void PictureLoaderWorker::cacheRedirect(const QUrl &originalUrl, const QUrl &redirectUrl)
 {
-    redirectCache[originalUrl] = qMakePair(redirectUrl, QDateTime::currentDateTimeUtc());
-    // saveRedirectCache();
+    redirectStore->insert(originalUrl, redirectUrl);
 }
 
 void PictureLoaderWorker::removedCachedUrl(const QUrl &url)
@@ -177,62 +354,54 @@ void PictureLoaderWorker::removedCachedUrl(const QUrl &url)
 
 QUrl PictureLoaderWorker::getCachedRedirect(const QUrl &originalUrl) const
 {
-    if (redirectCache.contains(originalUrl)) {
-        return redirectCache[originalUrl].first;
-    }
-    return {};
+    return redirectStore->find(originalUrl);
 }
 
-void PictureLoaderWorker::loadRedirectCache()
+/**
+ * Opens the redirect store and imports the redirects of earlier versions, which reads their files. Runs on the picture
+ * loader thread, so that it doesn't hold up the startup.
+ */
+void PictureLoaderWorker::openRedirectStore()
 {
-    QSettings settings(cacheFilePath, QSettings::IniFormat);
-
-    redirectCache.clear();
-    int size = settings.beginReadArray(REDIRECT_HEADER_NAME);
-    for (int i = 0; i < size; ++i) {
-        settings.setArrayIndex(i);
-        QUrl originalUrl = settings.value(REDIRECT_ORIGINAL_URL).toUrl();
-        QUrl redirectUrl = settings.value(REDIRECT_URL).toUrl();
-        QDateTime timestamp = settings.value(REDIRECT_TIMESTAMP).toDateTime();
-
-        if (originalUrl.isValid() && redirectUrl.isValid()) {
-            redirectCache[originalUrl] = qMakePair(redirectUrl, timestamp);
-        }
-    }
-    settings.endArray();
+    StartupTrace::Scope phase("Picture redirect cache");
+    redirectStore = new PictureLoaderRedirectStore(SettingsCache::instance().getRedirectCachePath() +
+                                                       REDIRECT_STORE_FILENAME,
+                                                   SettingsCache::instance().getRedirectCacheTtl());
+    importRedirectCache();
 }
 
-void PictureLoaderWorker::saveRedirectCache() const
+/**
+ * Moves the redirects of the cache.ini file used by earlier versions into the redirect store, then removes the file.
+ */
+void PictureLoaderWorker::importRedirectCache()
 {
-    QSettings settings(cacheFilePath, QSettings::IniFormat);
-
-    settings.beginWriteArray(REDIRECT_HEADER_NAME, static_cast<int>(redirectCache.size()));
-    int index = 0;
-    for (auto it = redirectCache.cbegin(); it != redirectCache.cend(); ++it) {
-        settings.setArrayIndex(index++);
-        settings.setValue(REDIRECT_ORIGINAL_URL, it.key());
-        settings.setValue(REDIRECT_URL, it.value().first);
-        settings.setValue(REDIRECT_TIMESTAMP, it.value().second);
+    const QString iniFilePath = SettingsCache::instance().getRedirectCachePath() + REDIRECT_CACHE_FILENAME;
+    if (!QFile::exists(iniFilePath)) {
+        return;
     }
-    settings.endArray();
-}
-
-void PictureLoaderWorker::cleanStaleEntries()
-{
-    QDateTime now = QDateTime::currentDateTimeUtc();
 
-    auto it = redirectCache.begin();
-    while (it != redirectCache.end()) {
-        if (it.value().second.addDays(SettingsCache::instance().getRedirectCacheTtl()) < now) {
-            it = redirectCache.erase(it); // Remove stale entry
-        } else {
-            ++it;
+    {
+        QSettings settings(iniFilePath, QSettings::IniFormat);
+        int size = settings.beginReadArray(REDIRECT_HEADER_NAME);
+        for (int i = 0; i < size; ++i) {
+            settings.setArrayIndex(i);
+            QUrl originalUrl = settings.value(REDIRECT_ORIGINAL_URL).toUrl();
+            QUrl redirectUrl = settings.value(REDIRECT_URL).toUrl();
+            QDateTime timestamp = settings.value(REDIRECT_TIMESTAMP).toDateTime();
+
+            if (originalUrl.isValid() && redirectUrl.isValid() && timestamp.isValid()) {
+                redirectStore->insert(originalUrl, redirectUrl, timestamp);
+            }
         }
+        settings.endArray();
     }
+    QFile::remove(iniFilePath);
 }
 
 void PictureLoaderWorker::clearNetworkCache()
 {
     networkManager->cache()->clear();
-    redirectCache.clear();
+    if (redirectStore) {
+        redirectStore->clear();
+    }
 }
@@ -4,6 +4,9 @@
 #include "../../../game/cards/card_database.h"
 #include "../../../game/cards/card_info.h"
 #include "picture_loader_local.h"
+#include "picture_loader_redirect_store.h"
+#include "picture_loader_scryfall_resolver.h"
+#include "picture_loader_thumbnail_cache.h"
 #include "picture_loader_worker_work.h"
 #include "picture_to_load.h"
 
@@ -13,25 +16,44 @@
 #include <QNetworkDiskCache>
 #include <QObject>
 #include <QQueue>
+#include <QSharedPointer>
+#include <QThreadPool>
 #include <QTimer>
 
 #define REDIRECT_HEADER_NAME "redirects"
 #define REDIRECT_ORIGINAL_URL "original"
 #define REDIRECT_URL "redirect"
 #define REDIRECT_TIMESTAMP "timestamp"
+#define REDIRECT_STORE_FILENAME "redirects.dat"
 #define REDIRECT_CACHE_FILENAME "cache.ini"
 
 inline Q_LOGGING_CATEGORY(PictureLoaderWorkerLog, "picture_loader.worker");
 
+/**
+ * How urgently a card picture is wanted. The downloads of a class only start once no download of a more urgent class
+ * is waiting.
+ */
+enum class PictureLoadPriority
+{
+    Visible,    // shown right now
+    Hovered,    // the card under the mouse, shown large in the card info
+    Prefetch,   // likely to be shown soon, like the cards of a deck that was just opened
+    Background, // wanted at some point, loaded when nothing else is waiting
+    Count
+};
+Q_DECLARE_METATYPE(PictureLoadPriority)
+
 class PictureLoaderWorkerWork;
 class PictureLoaderWorker : public QObject
 {
     Q_OBJECT
 public:
-    explicit PictureLoaderWorker();
+    explicit PictureLoaderWorker(QSharedPointer<PictureLoaderThumbnailCache> _thumbnailCache);
     ~PictureLoaderWorker() override;
 
-    void enqueueImageLoad(const ExactCard &card);                        // Starts a thread for the image to be loaded
+    // Starts a thread for the image to be loaded
+    void enqueueImageLoad(const ExactCard &card, PictureLoadPriority priority = PictureLoadPriority::Visible);
+    void cancelImageLoad(const ExactCard &card);
     void queueRequest(const QUrl &url, PictureLoaderWorkerWork *worker); // Queues network requests for load threads
     void clearNetworkCache();
 
@@ -47,32 +69,49 @@ private:
     QThread *pictureLoaderThread;
     QNetworkAccessManager *networkManager;
     QNetworkDiskCache *cache;
-    QHash<QUrl, QPair<QUrl, QDateTime>> redirectCache; // Stores redirect and timestamp
-    QString cacheFilePath;                             // Path to persistent storage
-    static constexpr int CacheTTLInDays = 30;          // TODO: Make user configurable
+    PictureLoaderRedirectStore *redirectStore;
     bool picDownload;
-    QQueue<QPair<QUrl, PictureLoaderWorkerWork *>> requestLoadQueue;
+    // the requests waiting for the quota, by priority class
+    QQueue<QPair<QUrl, PictureLoaderWorkerWork *>> requestLoadQueues[static_cast<int>(PictureLoadPriority::Count)];
 
     int requestQuota;
     QTimer requestTimer; // Timer for refreshing request quota
 
     PictureLoaderLocal *localLoader;
-    QSet<QString> currentlyLoading; // for deduplication purposes. Contains pixmapCacheKey
+    PictureLoaderScryfallResolver *scryfallResolver;
+    int maxRequestsPerHost;
+    QHash<QString, int> requestsInFlight; // by host
+    // for deduplication purposes. Maps the pixmapCacheKey to the most urgent priority the card was asked for
+    QHash<QString, PictureLoadPriority> currentlyLoading;
+
+    QThreadPool decodePool; // decodes the local images off the pictureLoader thread
+    int decodePriority;     // raised for every decode, so the latest requested cards are decoded first
+    QSharedPointer<PictureLoaderThumbnailCache> thumbnailCache;
 
+    static QList<QImage> scaleDown(const QImage &image);
+    void enqueueRequest(const QUrl &url, PictureLoaderWorkerWork *worker);
+    void raisePriority(const QString &cacheKey, PictureLoadPriority priority);
+    void emitRequestQueueChanged();
     QUrl getCachedRedirect(const QUrl &originalUrl) const;
-    void loadRedirectCache();
-    void saveRedirectCache() const;
-    void cleanStaleEntries();
+    void importRedirectCache();
 
 private slots:
+    void openRedirectStore();
     void resetRequestQuota();
-    void handleImageLoadEnqueued(const ExactCard &card);
+    void handleImageLoadEnqueued(const ExactCard &card, PictureLoadPriority priority);
+    void handleImageLoadCancelled(const ExactCard &card);
+    void handleUrlResolved(const QUrl &url, PictureLoaderWorkerWork *worker, const QUrl &imageUrl);
+    void handleLocalImageDecoded(const ExactCard &card, const QImage &image);
 
 signals:
-    void imageLoadEnqueued(const ExactCard &card);
-    void imageLoaded(const ExactCard &card, const QImage &image);
+    void imageLoadEnqueued(const ExactCard &card, PictureLoadPriority priority);
+    void imageLoadCancelled(const ExactCard &card);
+    void localImageDecoded(const ExactCard &card, const QImage &image);
+    void imageLoaded(const ExactCard &card, const QImage &image, const QList<QImage> &smallerImages);
     void imageRequestQueued(const QUrl &url, const ExactCard &card, const QString &setName);
     void imageRequestSucceeded(const QUrl &url);
+    // the number of requests waiting in every priority class, most urgent first
+    void requestQueueChanged(int visible, int hovered, int prefetch, int background);
 };
 
 #endif // PICTURE_LOADER_WORKER_H
@@ -0,0 +1,207 @@
+#include "picture_prefetcher.h"
+
+#include "../../../settings/cache_settings.h"
+#include "picture_loader_local.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QImageReader>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+
+// how many cards between two progress logs
+#define PROGRESS_LOG_INTERVAL 100
+
+PicturePrefetcher::PicturePrefetcher(const QList<ExactCard> &cards,
+                                     int _maxParallel,
+                                     int _requestsPerSecond,
+                                     bool makeThumbnails,
+                                     QObject *parent)
+    : QObject(parent), totalCards(cards.size()), maxParallel(qMax(1, _maxParallel)),
+      requestsPerSecond(qMax(1, _requestsPerSecond)), requestsInFlight(0), requestQuota(requestsPerSecond),
+      downloaded(0), skipped(0), failed(0), thumbnailCache(nullptr),
+      downloadPath(SettingsCache::instance().getPicsPath() + "/downloadedPics/")
+{
+    for (const ExactCard &card : cards) {
+        waitingCards.enqueue(card);
+    }
+
+    networkManager = new QNetworkAccessManager(this);
+    localLoader = new PictureLoaderLocal(this);
+
+    const QString cachePath = SettingsCache::instance().getCachePath();
+    if (makeThumbnails && !cachePath.isEmpty()) {
+        thumbnailCache = new PictureLoaderThumbnailCache(cachePath + "/thumbnails", THUMBNAIL_CACHE_SIZE_MAX);
+    }
+
+    quotaTimer.setInterval(1000);
+    connect(&quotaTimer, &QTimer::timeout, this, [this] {
+        requestQuota = requestsPerSecond;
+        startDownloads();
+    });
+}
+
+PicturePrefetcher::~PicturePrefetcher()
+{
+    delete thumbnailCache;
+}
+
+void PicturePrefetcher::start()
+{
+    qCInfo(PicturePrefetcherLog) << "Prefetching the pictures of" << totalCards << "cards into" << downloadPath;
+    quotaTimer.start();
+    // finished() is only emitted once the event loop runs
+    QTimer::singleShot(0, this, &PicturePrefetcher::startDownloads);
+}
+
+/**
+ * Moves to the next url of the picture to load, if it has none left to try for the current set.
+ * @return False once every url of every set was tried
+ */
+static bool nextUrlToTry(PictureToLoad &toLoad)
+{
+    while (toLoad.getCurrentUrl().isEmpty()) {
+        if (!toLoad.nextUrl() && !toLoad.nextSet()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PicturePrefetcher::startDownloads()
+{
+    while (requestsInFlight < maxParallel && requestQuota > 0) {
+        if (!pendingAttempts.isEmpty()) {
+            download(pendingAttempts.dequeue());
+            continue;
+        }
+        if (waitingCards.isEmpty()) {
+            break;
+        }
+
+        const ExactCard card = waitingCards.dequeue();
+        const QStringList localFiles = localLoader->findImageFiles(card);
+        if (!localFiles.isEmpty()) {
+            if (thumbnailCache) {
+                const QImage image = PictureLoaderLocal::loadFirstImage(localFiles, card.getName());
+                if (!image.isNull()) {
+                    thumbnailCache->save(card.getPixmapCacheKey(), image);
+                }
+            }
+            ++skipped;
+            cardDone();
+            continue;
+        }
+        download(PictureToLoad(card));
+    }
+    finishIfDone();
+}
+
+void PicturePrefetcher::download(PictureToLoad toLoad)
+{
+    if (!nextUrlToTry(toLoad)) {
+        qCWarning(PicturePrefetcherLog).nospace()
+            << "[card: " << toLoad.getCard().getName() << "]: Picture NOT found, no more url combinations to try";
+        ++failed;
+        cardDone();
+        return;
+    }
+
+    QNetworkRequest request(QUrl(toLoad.getCurrentUrl()));
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    QNetworkReply *reply = networkManager->get(request);
+    --requestQuota;
+    ++requestsInFlight;
+    connect(reply, &QNetworkReply::finished, this, [this, reply, toLoad] { handleReply(reply, toLoad); });
+}
+
+void PicturePrefetcher::handleReply(QNetworkReply *reply, PictureToLoad toLoad)
+{
+    reply->deleteLater();
+    --requestsInFlight;
+
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 429) {
+        // the same url again, once the next second's requests are allowed
+        qCWarning(PicturePrefetcherLog) << "Too many requests, slowing down";
+        requestQuota = 0;
+        pendingAttempts.enqueue(toLoad);
+        return;
+    }
+
+    if (!reply->error() && savePicture(toLoad, reply->readAll())) {
+        ++downloaded;
+        cardDone();
+    } else {
+        qCDebug(PicturePrefetcherLog).nospace()
+            << "[card: " << toLoad.getCard().getName() << " set: " << toLoad.getSetName() << "]: Download failed for url "
+            << reply->url().toDisplayString() << " (" << reply->errorString() << ")";
+        toLoad.nextUrl();
+        pendingAttempts.enqueue(toLoad);
+    }
+    startDownloads();
+}
+
+/**
+ * Stores the picture where PictureLoaderLocal looks for the printing first, under the set of the printing and named
+ * after the card and the provider id.
+ * @return False if the data is no picture or can't be written
+ */
+bool PicturePrefetcher::savePicture(const PictureToLoad &toLoad, const QByteArray &picData)
+{
+    QBuffer buffer;
+    buffer.setData(picData);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    reader.setDecideFormatFromContent(true);
+    const QString format = QString::fromLatin1(reader.format());
+    if (format.isEmpty()) {
+        return false;
+    }
+
+    const ExactCard &card = toLoad.getCard();
+    const PrintingInfo printing = card.getPrinting();
+    const QString setName = printing.getSet() ? printing.getSet()->getCorrectedShortName() : toLoad.getSetName();
+    QString fileName = card.getInfo().getCorrectedName();
+    if (!printing.getUuid().isEmpty()) {
+        fileName += "-" + printing.getUuid();
+    }
+
+    const QString directory = downloadPath + setName;
+    if (!QDir().mkpath(directory)) {
+        qCWarning(PicturePrefetcherLog) << "Could not create" << directory;
+        return false;
+    }
+    QSaveFile file(directory + "/" + fileName + "." + format);
+    if (!file.open(QIODevice::WriteOnly) || file.write(picData) != picData.size() || !file.commit()) {
+        qCWarning(PicturePrefetcherLog) << "Could not write" << file.fileName();
+        return false;
+    }
+
+    if (thumbnailCache) {
+        const QImage image = reader.read();
+        if (!image.isNull()) {
+            thumbnailCache->save(card.getPixmapCacheKey(), image);
+        }
+    }
+    return true;
+}
+
+void PicturePrefetcher::cardDone()
+{
+    const int done = downloaded + skipped + failed;
+    if (done % PROGRESS_LOG_INTERVAL == 0) {
+        qCInfo(PicturePrefetcherLog) << done << "of" << totalCards << "cards done";
+    }
+}
+
+void PicturePrefetcher::finishIfDone()
+{
+    if (!quotaTimer.isActive() || requestsInFlight > 0 || !pendingAttempts.isEmpty() || !waitingCards.isEmpty()) {
+        return;
+    }
+    quotaTimer.stop();
+    qCInfo(PicturePrefetcherLog) << "Prefetching done:" << downloaded << "downloaded," << skipped
+                                 << "already there," << failed << "not found";
+    emit finished(downloaded, skipped, failed);
+}
@@ -0,0 +1,71 @@
+#ifndef PICTURE_PREFETCHER_H
+#define PICTURE_PREFETCHER_H
+
+#include "../../../game/cards/exact_card.h"
+#include "picture_loader_thumbnail_cache.h"
+#include "picture_to_load.h"
+
+#include <QLoggingCategory>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QQueue>
+#include <QTimer>
+
+inline Q_LOGGING_CATEGORY(PicturePrefetcherLog, "picture_loader.prefetcher");
+
+class PictureLoaderLocal;
+class QNetworkReply;
+
+/**
+ * Downloads the pictures of many cards ahead of time, for the --prefetch-pictures command line switch.
+ *
+ * The urls are the ones the picture loader would try, see PictureToLoad. The pictures are stored as they were
+ * downloaded, in the downloadedPics folder of the pics path. PictureLoaderLocal finds them there, so a machine works
+ * offline afterwards, and the folder can be copied to other machines. Cards that already have a local picture are
+ * skipped. The thumbnails can be made as well, for the local pictures too.
+ *
+ * At most maxParallel requests are in flight, and at most requestsPerSecond are started every second.
+ */
+class PicturePrefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    PicturePrefetcher(const QList<ExactCard> &cards,
+                      int _maxParallel,
+                      int _requestsPerSecond,
+                      bool makeThumbnails,
+                      QObject *parent = nullptr);
+    ~PicturePrefetcher() override;
+
+    void start();
+
+signals:
+    void finished(int downloaded, int skipped, int failed);
+
+private:
+    QQueue<ExactCard> waitingCards;
+    // the pictures to try again, at their next url or at the same one after too many requests
+    QQueue<PictureToLoad> pendingAttempts;
+    int totalCards;
+    const int maxParallel;
+    const int requestsPerSecond;
+    int requestsInFlight;
+    int requestQuota;
+    int downloaded, skipped, failed;
+
+    QNetworkAccessManager *networkManager;
+    PictureLoaderLocal *localLoader;
+    // only set if the thumbnails are made
+    PictureLoaderThumbnailCache *thumbnailCache;
+    QString downloadPath;
+    QTimer quotaTimer;
+
+    void startDownloads();
+    void download(PictureToLoad toLoad);
+    void handleReply(QNetworkReply *reply, PictureToLoad toLoad);
+    bool savePicture(const PictureToLoad &toLoad, const QByteArray &picData);
+    void cardDone();
+    void finishIfDone();
+};
+
+#endif // PICTURE_PREFETCHER_H
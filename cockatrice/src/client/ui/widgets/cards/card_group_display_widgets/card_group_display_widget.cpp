@@ -28,7 +28,7 @@ CardGroupDisplayWidget::CardGroupDisplayWidget(QWidget *parent,
 
     layout->addWidget(banner);
 
-    CardGroupDisplayWidget::updateCardDisplays();
+    // the subclasses call updateCardDisplays() once their layout for the cards exists
 
     connect(deckListModel, &QAbstractItemModel::rowsInserted, this, &CardGroupDisplayWidget::onCardAddition);
     connect(deckListModel, &QAbstractItemModel::rowsRemoved, this, &CardGroupDisplayWidget::onCardRemoval);
@@ -58,8 +58,9 @@ QWidget *CardGroupDisplayWidget::constructWidgetForIndex(int rowIndex)
 
 void CardGroupDisplayWidget::updateCardDisplays()
 {
-    for (int i = 0; i < deckListModel->rowCount(trackedIndex); ++i) {
+    for (int i = indexesInRowOrder.size(); i < deckListModel->rowCount(trackedIndex); ++i) {
         addToLayout(constructWidgetForIndex(i));
+        indexesInRowOrder.append(QPersistentModelIndex(deckListModel->index(i, 0, trackedIndex)));
     }
 }
 
@@ -72,20 +73,20 @@ void CardGroupDisplayWidget::onCardAddition(const QModelIndex &parent, int first
     if (parent == trackedIndex) {
         for (int i = first; i <= last; i++) {
             insertIntoLayout(constructWidgetForIndex(i), i);
+            indexesInRowOrder.insert(i, QPersistentModelIndex(deckListModel->index(i, 0, trackedIndex)));
         }
     }
 }
 
 void CardGroupDisplayWidget::onCardRemoval(const QModelIndex &parent, int first, int last)
 {
-    Q_UNUSED(first);
-    Q_UNUSED(last);
     if (parent == trackedIndex) {
-        for (const QPersistentModelIndex &idx : indexToWidgetMap.keys()) {
-            if (!idx.isValid()) {
-                removeFromLayout(indexToWidgetMap.value(idx));
-                indexToWidgetMap.value(idx)->deleteLater();
-                indexToWidgetMap.remove(idx);
+        // only the removed rows are touched, the keys stay usable for the lookup after they became invalid
+        for (int i = qMin(last, static_cast<int>(indexesInRowOrder.size()) - 1); i >= first; --i) {
+            QWidget *widget = indexToWidgetMap.take(indexesInRowOrder.takeAt(i));
+            if (widget) {
+                removeFromLayout(widget);
+                widget->deleteLater();
             }
         }
         if (!trackedIndex.isValid()) {
@@ -29,6 +29,8 @@ public:
     DeckListModel *deckListModel;
     QPersistentModelIndex trackedIndex;
     QHash<QPersistentModelIndex, QWidget *> indexToWidgetMap;
+    // the keys of indexToWidgetMap in row order, the position in the layout of each widget
+    QList<QPersistentModelIndex> indexesInRowOrder;
     QString zoneName;
     QString cardGroupCategory;
     QString activeGroupCriteria;
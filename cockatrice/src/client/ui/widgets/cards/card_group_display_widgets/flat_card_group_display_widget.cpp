@@ -32,49 +32,7 @@ FlatCardGroupDisplayWidget::FlatCardGroupDisplayWidget(QWidget *parent,
 
     layout->addWidget(flowWidget);
 
-    for (const QPersistentModelIndex &idx : indexToWidgetMap.keys()) {
-        FlatCardGroupDisplayWidget::removeFromLayout(indexToWidgetMap.value(idx));
-        indexToWidgetMap.value(idx)->deleteLater();
-        indexToWidgetMap.remove(idx);
-    }
-
     FlatCardGroupDisplayWidget::updateCardDisplays();
-    disconnect(deckListModel, &QAbstractItemModel::rowsInserted, this, &CardGroupDisplayWidget::onCardAddition);
-    disconnect(deckListModel, &QAbstractItemModel::rowsRemoved, this, &CardGroupDisplayWidget::onCardRemoval);
-
-    connect(deckListModel, &QAbstractItemModel::rowsInserted, this, &FlatCardGroupDisplayWidget::onCardAddition);
-    connect(deckListModel, &QAbstractItemModel::rowsRemoved, this, &FlatCardGroupDisplayWidget::onCardRemoval);
-}
-
-void FlatCardGroupDisplayWidget::onCardAddition(const QModelIndex &parent, int first, int last)
-{
-    if (!trackedIndex.isValid()) {
-        emit cleanupRequested(this);
-        return;
-    }
-    if (parent == trackedIndex) {
-        for (int i = first; i <= last; i++) {
-            insertIntoLayout(constructWidgetForIndex(i), i);
-        }
-    }
-}
-
-void FlatCardGroupDisplayWidget::onCardRemoval(const QModelIndex &parent, int first, int last)
-{
-    Q_UNUSED(first);
-    Q_UNUSED(last);
-    if (parent == trackedIndex) {
-        for (const QPersistentModelIndex &idx : indexToWidgetMap.keys()) {
-            if (!idx.isValid()) {
-                removeFromLayout(indexToWidgetMap.value(idx));
-                indexToWidgetMap.value(idx)->deleteLater();
-                indexToWidgetMap.remove(idx);
-            }
-        }
-        if (!trackedIndex.isValid()) {
-            emit cleanupRequested(this);
-        }
-    }
 }
 
 QWidget *FlatCardGroupDisplayWidget::constructWidgetForIndex(int row)
@@ -22,8 +22,6 @@ public:
 public slots:
     QWidget *constructWidgetForIndex(int row) override;
     void resizeEvent(QResizeEvent *event) override;
-    void onCardAddition(const QModelIndex &parent, int first, int last) override;
-    void onCardRemoval(const QModelIndex &parent, int first, int last) override;
 
 private:
     FlowWidget *flowWidget;
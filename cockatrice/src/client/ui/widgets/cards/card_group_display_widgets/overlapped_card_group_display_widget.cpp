@@ -31,53 +31,10 @@ OverlappedCardGroupDisplayWidget::OverlappedCardGroupDisplayWidget(QWidget *pare
 
     layout->addWidget(overlapWidget);
 
-    for (const QPersistentModelIndex &idx : indexToWidgetMap.keys()) {
-        OverlappedCardGroupDisplayWidget::removeFromLayout(indexToWidgetMap.value(idx));
-        indexToWidgetMap.value(idx)->deleteLater();
-        indexToWidgetMap.remove(idx);
-    }
-
     OverlappedCardGroupDisplayWidget::updateCardDisplays();
 
     connect(cardSizeWidget->getSlider(), &QSlider::valueChanged, this,
             [this]() { overlapWidget->adjustMaxColumnsAndRows(); });
-
-    disconnect(deckListModel, &QAbstractItemModel::rowsInserted, this, &CardGroupDisplayWidget::onCardAddition);
-    disconnect(deckListModel, &QAbstractItemModel::rowsRemoved, this, &CardGroupDisplayWidget::onCardRemoval);
-
-    connect(deckListModel, &QAbstractItemModel::rowsInserted, this, &OverlappedCardGroupDisplayWidget::onCardAddition);
-    connect(deckListModel, &QAbstractItemModel::rowsRemoved, this, &OverlappedCardGroupDisplayWidget::onCardRemoval);
-}
-
-void OverlappedCardGroupDisplayWidget::onCardAddition(const QModelIndex &parent, int first, int last)
-{
-    if (!trackedIndex.isValid()) {
-        emit cleanupRequested(this);
-        return;
-    }
-    if (parent == trackedIndex) {
-        for (int i = first; i <= last; i++) {
-            insertIntoLayout(constructWidgetForIndex(i), i);
-        }
-    }
-}
-
-void OverlappedCardGroupDisplayWidget::onCardRemoval(const QModelIndex &parent, int first, int last)
-{
-    Q_UNUSED(first);
-    Q_UNUSED(last);
-    if (parent == trackedIndex) {
-        for (const QPersistentModelIndex &idx : indexToWidgetMap.keys()) {
-            if (!idx.isValid()) {
-                removeFromLayout(indexToWidgetMap.value(idx));
-                indexToWidgetMap.value(idx)->deleteLater();
-                indexToWidgetMap.remove(idx);
-            }
-        }
-        if (!trackedIndex.isValid()) {
-            emit cleanupRequested(this);
-        }
-    }
 }
 
 void OverlappedCardGroupDisplayWidget::resizeEvent(QResizeEvent *event)
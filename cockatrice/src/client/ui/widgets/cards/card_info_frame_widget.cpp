@@ -17,6 +17,7 @@ CardInfoFrameWidget::CardInfoFrameWidget(QWidget *parent)
     setContentsMargins(3, 3, 3, 3);
     pic = new CardInfoPictureWidget();
     pic->setObjectName("pic");
+    pic->setPictureLoadPriority(PictureLoadPriority::Hovered);
     connect(pic, &CardInfoPictureWidget::cardChanged, this,
             qOverload<const ExactCard &>(&CardInfoFrameWidget::setCard));
 
@@ -36,6 +37,8 @@ CardInfoFrameWidget::CardInfoFrameWidget(QWidget *parent)
     insertTab(TextOnlyView, tab2, QString());
     insertTab(ImageAndTextView, tab3, QString());
     connect(this, &CardInfoFrameWidget::currentChanged, this, &CardInfoFrameWidget::setViewMode);
+    connect(CardDatabaseManager::getInstance(), &CardDatabase::cardListReplaced, this,
+            &CardInfoFrameWidget::refreshCard);
 
     tab1Layout = new QVBoxLayout();
     tab1Layout->setObjectName("tab1Layout");
@@ -142,6 +145,11 @@ static bool hasTransformation(const CardInfo &info)
 
 void CardInfoFrameWidget::setCard(const ExactCard &card)
 {
+    // hovering the card shown again sets it again
+    if (card == exactCard) {
+        return;
+    }
+
     if (exactCard) {
         disconnect(exactCard.getCardPtr().data(), nullptr, this, nullptr);
     }
@@ -188,6 +196,16 @@ void CardInfoFrameWidget::viewTransformation()
     }
 }
 
+/**
+ * Shows the same printing of the card again, looked up in the database that replaced the one it came from.
+ */
+void CardInfoFrameWidget::refreshCard()
+{
+    if (exactCard) {
+        setCard(CardRef{exactCard.getName(), exactCard.getPrinting().getUuid()});
+    }
+}
+
 void CardInfoFrameWidget::clearCard()
 {
     setCard(ExactCard());
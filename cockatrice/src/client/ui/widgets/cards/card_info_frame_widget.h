@@ -52,6 +52,9 @@ public slots:
     void viewTransformation();
     void clearCard();
     void setViewMode(int mode);
+
+private slots:
+    void refreshCard();
 };
 
 #endif
@@ -35,7 +35,7 @@ CardInfoPictureEnlargedWidget::CardInfoPictureEnlargedWidget(QWidget *parent) :
 void CardInfoPictureEnlargedWidget::loadPixmap(const QSize &size)
 {
     if (card) {
-        PictureLoader::getPixmap(enlargedPixmap, card, size);
+        PictureLoader::getPixmap(enlargedPixmap, card, size, PictureLoadPriority::Hovered);
     } else {
         PictureLoader::getCardBackPixmap(enlargedPixmap, size);
     }
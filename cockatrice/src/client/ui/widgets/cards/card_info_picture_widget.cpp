@@ -65,6 +65,7 @@ CardInfoPictureWidget::CardInfoPictureWidget(QWidget *parent, const bool _hoverT
 
 CardInfoPictureWidget::~CardInfoPictureWidget()
 {
+    PictureLoader::cancelPixmapLoad(exactCard);
     enlargedPixmapWidget->hide();
     enlargedPixmapWidget->deleteLater();
 }
@@ -81,6 +82,9 @@ void CardInfoPictureWidget::setCard(const ExactCard &card)
     if (exactCard.getCardPtr()) {
         disconnect(exactCard.getCardPtr().data(), nullptr, this, nullptr);
     }
+    if (exactCard && exactCard.getPixmapCacheKey() != card.getPixmapCacheKey()) {
+        PictureLoader::cancelPixmapLoad(exactCard);
+    }
 
     exactCard = card;
 
@@ -106,6 +110,15 @@ void CardInfoPictureWidget::setRaiseOnEnterEnabled(const bool enabled)
     raiseOnEnter = enabled;
 }
 
+/**
+ * @brief Sets how urgently the picture of the card is loaded, compared to the other cards shown.
+ * @param priority The class the load requests of this widget are queued in.
+ */
+void CardInfoPictureWidget::setPictureLoadPriority(PictureLoadPriority priority)
+{
+    pictureLoadPriority = priority;
+}
+
 /**
  * @brief Handles widget resizing by updating the pixmap size.
  * @param event The resize event (unused).
@@ -158,7 +171,7 @@ void CardInfoPictureWidget::loadPixmap()
 {
     PictureLoader::getCardBackLoadingInProgressPixmap(resizedPixmap, size());
     if (exactCard) {
-        PictureLoader::getPixmap(resizedPixmap, exactCard, size());
+        PictureLoader::getPixmap(resizedPixmap, exactCard, size(), pictureLoadPriority);
     } else {
         PictureLoader::getCardBackLoadingFailedPixmap(resizedPixmap, size());
     }
@@ -349,6 +362,7 @@ void CardInfoPictureWidget::mousePressEvent(QMouseEvent *event)
 void CardInfoPictureWidget::hideEvent(QHideEvent *event)
 {
     enlargedPixmapWidget->hide();
+    PictureLoader::cancelPixmapLoad(exactCard);
     QWidget::hideEvent(event);
 }
 
@@ -2,6 +2,7 @@
 #define CARD_INFO_PICTURE_H
 
 #include "../../../../game/cards/exact_card.h"
+#include "../../picture_loader/picture_loader_worker.h"
 #include "card_info_picture_enlarged_widget.h"
 
 #include <QPropertyAnimation>
@@ -33,6 +34,7 @@ public slots:
     void setScaleFactor(int scale); // New slot for scaling
     void setHoverToZoomEnabled(bool enabled);
     void setRaiseOnEnterEnabled(bool enabled);
+    void setPictureLoadPriority(PictureLoadPriority priority);
     void updatePixmap();
 
 signals:
@@ -59,6 +61,14 @@ protected:
     {
         return resizedPixmap;
     }
+    // the resized pixmap, loaded first if the card or the size changed since
+    const QPixmap &getLoadedPixmap()
+    {
+        if (pixmapDirty) {
+            loadPixmap();
+        }
+        return resizedPixmap;
+    }
     void showEnlargedPixmap() const;
 
 private:
@@ -73,6 +83,7 @@ private:
     bool pixmapDirty;
     bool hoverToZoomEnabled;
     bool raiseOnEnter;
+    PictureLoadPriority pictureLoadPriority = PictureLoadPriority::Visible;
     int hoverActivateThresholdInMs = 500;
     CardInfoPictureEnlargedWidget *enlargedPixmapWidget;
     int enlargedPixmapOffset = 10;
@@ -116,10 +116,23 @@ void CardInfoPictureWithTextOverlayWidget::paintEvent(QPaintEvent *event)
     const QPoint topLeft{(width() - scaledSize.width()) / 2, (height() - scaledSize.height()) / 2};
     const QRect pixmapRect(topLeft, scaledSize);
 
+    drawOverlayText(painter, pixmapRect, painter.font(), getOverlayStyle());
+}
+
+/**
+ * @brief Draws the overlay text, wrapped and centered within the picture.
+ * @param painter The painter to draw the text.
+ * @param pixmapRect The rectangle the picture is drawn in.
+ * @param font The font to start from, its size is replaced by the fitted one.
+ * @param style The text and how to draw it.
+ */
+void CardInfoPictureWithTextOverlayWidget::drawOverlayText(QPainter &painter,
+                                                           const QRect &pixmapRect,
+                                                           QFont font,
+                                                           const OverlayStyle &style)
+{
     // Calculate the optimal font size
-    QFont font = painter.font();
-    int optimalFontSize = fontSize; // Start with the user-defined font size
-    const QFontMetrics baseMetrics(font);
+    int optimalFontSize = style.fontSize; // Start with the user-defined font size
     int textWidth = pixmapRect.width();
 
     // Reduce the font size until the text fits within the pixmap's width
@@ -127,7 +140,7 @@ void CardInfoPictureWithTextOverlayWidget::paintEvent(QPaintEvent *event)
         font.setPointSize(optimalFontSize);
         QFontMetrics fm(font);
         int currentWidth = 0;
-        for (const QString &word : overlayText.split(' ')) {
+        for (const QString &word : style.text.split(' ')) {
             currentWidth = std::max(currentWidth, fm.horizontalAdvance(word));
         }
 
@@ -145,7 +158,7 @@ void CardInfoPictureWithTextOverlayWidget::paintEvent(QPaintEvent *event)
     const QFontMetrics fontMetrics(font);
     QString wrappedText;
     QString currentLine;
-    QStringList words = overlayText.split(' ');
+    QStringList words = style.text.split(' ');
     for (const QString &word : words) {
         if (fontMetrics.horizontalAdvance(currentLine + " " + word) > textWidth) {
             wrappedText += currentLine + '\n';
@@ -173,14 +186,14 @@ void CardInfoPictureWithTextOverlayWidget::paintEvent(QPaintEvent *event)
 
     // Set up the text layout options
     QTextOption textOption;
-    textOption.setAlignment(textAlignment);
+    textOption.setAlignment(style.alignment);
 
     // Create a text rectangle centered vertically within the pixmap rect
     auto textRect = QRect(pixmapRect.left(), pixmapRect.top(), pixmapRect.width(), totalTextHeight);
     textRect.moveTop((pixmapRect.height() - totalTextHeight) / 2 + pixmapRect.top());
 
     // Draw the outlined text
-    drawOutlinedText(painter, textRect, wrappedText, textOption);
+    drawOutlinedText(painter, textRect, wrappedText, textOption, style);
 }
 
 /**
@@ -189,15 +202,17 @@ void CardInfoPictureWithTextOverlayWidget::paintEvent(QPaintEvent *event)
  * @param textRect The rectangle area to draw the text in.
  * @param text The text to display.
  * @param textOption The text layout options, such as alignment.
+ * @param style The colors of the text and its outline.
  *
  * Draws an outline around the text to enhance readability before drawing the main text.
  */
 void CardInfoPictureWithTextOverlayWidget::drawOutlinedText(QPainter &painter,
                                                             const QRect &textRect,
                                                             const QString &text,
-                                                            const QTextOption &textOption) const
+                                                            const QTextOption &textOption,
+                                                            const OverlayStyle &style)
 {
-    painter.setPen(outlineColor);
+    painter.setPen(style.outlineColor);
     for (int dx = -1; dx <= 1; ++dx) {
         for (int dy = -1; dy <= 1; ++dy) {
             if (dx != 0 || dy != 0) {
@@ -208,7 +223,7 @@ void CardInfoPictureWithTextOverlayWidget::drawOutlinedText(QPainter &painter,
     }
 
     // Draw the main text
-    painter.setPen(textColor);
+    painter.setPen(style.textColor);
     painter.drawText(textRect, text, textOption);
 }
 
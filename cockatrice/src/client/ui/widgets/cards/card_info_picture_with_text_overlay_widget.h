@@ -4,6 +4,7 @@
 #include "card_info_picture_widget.h"
 
 #include <QColor>
+#include <QFont>
 #include <QSize>
 #include <QTextOption>
 
@@ -27,6 +28,15 @@ public:
     void setTextAlignment(Qt::Alignment alignment);
 
     [[nodiscard]] QSize sizeHint() const override;
+
+    struct OverlayStyle
+    {
+        QString text;
+        QColor textColor;
+        QColor outlineColor;
+        int fontSize;
+        Qt::Alignment alignment;
+    };
 signals:
     void imageClicked(QMouseEvent *event, CardInfoPictureWithTextOverlayWidget *instance);
 
@@ -35,11 +45,22 @@ protected:
     void mousePressEvent(QMouseEvent *event) override;
     [[nodiscard]] QSize minimumSizeHint() const override;
 
+    [[nodiscard]] OverlayStyle getOverlayStyle() const
+    {
+        return {overlayText, textColor, outlineColor, fontSize, textAlignment};
+    }
+    /**
+     * Draws the overlay text fitted into the rect of the picture. Only uses its arguments, so it can also draw into
+     * an image on a worker thread.
+     */
+    static void drawOverlayText(QPainter &painter, const QRect &pixmapRect, QFont font, const OverlayStyle &style);
+
 private:
-    void drawOutlinedText(QPainter &painter,
-                          const QRect &textRect,
-                          const QString &text,
-                          const QTextOption &textOption) const;
+    static void drawOutlinedText(QPainter &painter,
+                                 const QRect &textRect,
+                                 const QString &text,
+                                 const QTextOption &textOption,
+                                 const OverlayStyle &style);
 
     QString overlayText;
     QColor textColor;
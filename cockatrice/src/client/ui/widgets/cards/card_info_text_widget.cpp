@@ -5,6 +5,7 @@
 
 #include <QGridLayout>
 #include <QLabel>
+#include <QTextDocument>
 #include <QTextEdit>
 
 CardInfoTextWidget::CardInfoTextWidget(QWidget *parent) : QFrame(parent), info(nullptr)
@@ -16,6 +17,8 @@ CardInfoTextWidget::CardInfoTextWidget(QWidget *parent) : QFrame(parent), info(n
 
     textLabel = new QTextEdit();
     textLabel->setReadOnly(true);
+    emptyDocument = new QTextDocument(this);
+    textLabel->setDocument(emptyDocument);
 
     auto *grid = new QGridLayout(this);
     grid->addWidget(nameLabel, 0, 0);
@@ -29,11 +32,39 @@ CardInfoTextWidget::CardInfoTextWidget(QWidget *parent) : QFrame(parent), info(n
 void CardInfoTextWidget::setCard(CardInfoPtr card)
 {
     if (card == nullptr) {
+        info = nullptr;
         nameLabel->setText("");
-        textLabel->setText("");
+        textLabel->setDocument(emptyDocument);
         return;
     }
 
+    // hovering sets the same card again and again
+    if (card == info) {
+        return;
+    }
+    info = card;
+
+    const RenderedCard &rendered = renderCard(card);
+    nameLabel->setText(rendered.nameText);
+    textLabel->setDocument(rendered.document);
+}
+
+const CardInfoTextWidget::RenderedCard &CardInfoTextWidget::renderCard(const CardInfoPtr &card)
+{
+    for (int i = renderedCards.size() - 1; i >= 0; --i) {
+        if (renderedCards.at(i).card.isNull()) {
+            // the card database was replaced since
+            QTextDocument *document = renderedCards.takeAt(i).document;
+            if (textLabel->document() == document) {
+                textLabel->setDocument(emptyDocument);
+            }
+            delete document;
+        } else if (renderedCards.at(i).card == card) {
+            renderedCards.move(i, renderedCards.size() - 1);
+            return renderedCards.last();
+        }
+    }
+
     QString text = "<table width=\"100%\" border=0 cellspacing=0 cellpadding=0>";
     text += QString("<tr><td>%1</td><td width=\"5\"></td><td>%2</td></tr>")
                 .arg(tr("Name:"), card->getName().toHtmlEscaped());
@@ -60,21 +91,48 @@ void CardInfoTextWidget::setCard(CardInfoPtr card)
     }
 
     text += "</table>";
-    nameLabel->setText(text);
-    textLabel->setText(card->getText());
+
+    // the documents are owned by this widget, the text edit keeps using its own font for them
+    auto *document = new QTextDocument(this);
+    document->setDefaultFont(textLabel->font());
+    const QString cardText = card->getText();
+    if (Qt::mightBeRichText(cardText)) {
+        document->setHtml(cardText);
+    } else {
+        document->setPlainText(cardText);
+    }
+
+    // the document being shown is the most recent one, it is never the one dropped
+    if (renderedCards.size() >= maxRenderedCards) {
+        delete renderedCards.takeFirst().document;
+    }
+    renderedCards.append({card.toWeakRef(), text, document});
+    return renderedCards.last();
+}
+
+void CardInfoTextWidget::clearRenderedCards()
+{
+    textLabel->setDocument(emptyDocument);
+    for (const RenderedCard &rendered : renderedCards) {
+        delete rendered.document;
+    }
+    renderedCards.clear();
+    info = nullptr;
 }
 
 void CardInfoTextWidget::setInvalidCardName(const QString &cardName)
 {
+    info = nullptr;
     nameLabel->setText(tr("Unknown card:") + " " + cardName);
-    textLabel->setText("");
+    textLabel->setDocument(emptyDocument);
 }
 
 void CardInfoTextWidget::retranslateUi()
 {
     /*
      * There's no way we can really translate the text currently being rendered.
-     * The best we can do is invalidate the current text.
+     * The best we can do is invalidate the current text, and the texts kept for the cards shown before.
      */
+    clearRenderedCards();
     setInvalidCardName("");
 }
@@ -4,7 +4,10 @@
 #include "../../../../game/cards/card_info.h"
 
 #include <QFrame>
+#include <QList>
+#include <QWeakPointer>
 class QLabel;
+class QTextDocument;
 class QTextEdit;
 
 class CardInfoTextWidget : public QFrame
@@ -12,9 +15,25 @@ class CardInfoTextWidget : public QFrame
     Q_OBJECT
 
 private:
+    // the texts of the cards shown last, switching back to one of them only swaps the laid out document in
+    struct RenderedCard
+    {
+        QWeakPointer<CardInfo> card;
+        QString nameText;
+        QTextDocument *document;
+    };
+    static constexpr int maxRenderedCards = 32;
+
     QLabel *nameLabel;
     QTextEdit *textLabel;
     CardInfoPtr info;
+    // shown while there is no card, so the documents of the cards are never edited
+    QTextDocument *emptyDocument;
+    // least recently shown first
+    QList<RenderedCard> renderedCards;
+
+    const RenderedCard &renderCard(const CardInfoPtr &card);
+    void clearRenderedCards();
 
 public:
     explicit CardInfoTextWidget(QWidget *parent = nullptr);
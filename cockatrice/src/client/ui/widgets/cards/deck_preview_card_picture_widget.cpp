@@ -5,10 +5,13 @@
 #include <QApplication>
 #include <QFileInfo>
 #include <QFontMetrics>
+#include <QFutureWatcher>
 #include <QMouseEvent>
 #include <QPainterPath>
+#include <QPixmapCache>
 #include <QStylePainter>
 #include <QTextOption>
+#include <QtConcurrentRun>
 
 /**
  * @brief Constructs a CardPictureWithTextOverlay widget.
@@ -44,6 +47,136 @@ DeckPreviewCardPictureWidget::DeckPreviewCardPictureWidget(QWidget *parent,
             &CardInfoPictureWidget::setRaiseOnEnterEnabled);
 }
 
+/**
+ * Paints the picture and its overlay text as one tile, which is composed on a worker thread the first time and then
+ * only drawn from the pixmap cache. Every deck in the folder is painted when the visual deck storage opens or is
+ * filtered, and the overlay text has to be fitted and outlined each time.
+ *
+ * Until the tile is ready, the plain picture is drawn.
+ */
+void DeckPreviewCardPictureWidget::paintEvent(QPaintEvent * /* event */)
+{
+    if (width() == 0 || height() == 0) {
+        return;
+    }
+
+    const QPixmap &picture = getLoadedPixmap();
+    const bool rotate = SettingsCache::instance().getAutoRotateSidewaysLayoutCards() &&
+                        getCard().getInfo().getLandscapeOrientation();
+    const bool roundCorners = SettingsCache::instance().getRoundCardCorners();
+    const qreal dpr = devicePixelRatio();
+    const OverlayStyle style = getOverlayStyle();
+
+    // the cache key of the picture changes once it is loaded, the placeholder gets its own tile
+    const QString key = QStringList{"deckPreviewTile",
+                                    getCard().getPixmapCacheKey(),
+                                    QString::number(picture.cacheKey()),
+                                    QString::number(width()),
+                                    QString::number(height()),
+                                    QString::number(dpr),
+                                    QString::number(rotate),
+                                    QString::number(roundCorners),
+                                    QString::number(style.fontSize),
+                                    QString::number(style.textColor.rgba()),
+                                    QString::number(style.outlineColor.rgba()),
+                                    QString::number(static_cast<int>(style.alignment)),
+                                    style.text}
+                            .join('|');
+
+    QStylePainter painter(this);
+    QPixmap tile;
+    if (QPixmapCache::find(key, &tile)) {
+        painter.drawPixmap(0, 0, tile);
+        return;
+    }
+
+    if (pendingTileKey != key) {
+        renderTile(key, picture, rotate, roundCorners, dpr);
+    }
+    if (!picture.isNull()) {
+        const QSize scaledSize = picture.size().scaled(size(), Qt::KeepAspectRatio);
+        const QPoint topLeft{(width() - scaledSize.width()) / 2, (height() - scaledSize.height()) / 2};
+        painter.drawPixmap(QRect(topLeft, scaledSize), picture);
+    }
+}
+
+void DeckPreviewCardPictureWidget::renderTile(const QString &key,
+                                              const QPixmap &picture,
+                                              const bool rotate,
+                                              const bool roundCorners,
+                                              const qreal dpr)
+{
+    pendingTileKey = key;
+
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, key]() {
+        watcher->deleteLater();
+        QPixmapCache::insert(key, QPixmap::fromImage(watcher->result()));
+        if (pendingTileKey == key) {
+            pendingTileKey.clear();
+            update();
+        }
+    });
+    // pixmaps can only be used on the GUI thread, the worker gets an image of the picture
+    const QImage image = picture.toImage();
+    const QSize tileSize = size();
+    const QFont tileFont = font();
+    const OverlayStyle style = getOverlayStyle();
+    watcher->setFuture(QtConcurrent::run(
+        [image, rotate, roundCorners, tileSize, dpr, tileFont, style]() {
+            return composeTile(image, rotate, roundCorners, tileSize, dpr, tileFont, style);
+        }));
+}
+
+/**
+ * Draws the tile the way CardInfoPictureWithTextOverlayWidget::paintEvent() draws the widget, into an image of the
+ * widget's size in device pixels.
+ */
+QImage DeckPreviewCardPictureWidget::composeTile(const QImage &picture,
+                                                 const bool rotate,
+                                                 const bool roundCorners,
+                                                 const QSize &size,
+                                                 const qreal dpr,
+                                                 const QFont &font,
+                                                 const OverlayStyle &style)
+{
+    const QSize availableSize = size * dpr;
+    QImage tile(availableSize, QImage::Format_ARGB32_Premultiplied);
+    tile.fill(Qt::transparent);
+    if (picture.isNull()) {
+        tile.setDevicePixelRatio(dpr);
+        return tile;
+    }
+
+    const QImage transformedPicture =
+        rotate ? picture.transformed(QTransform().rotate(90), Qt::SmoothTransformation) : picture;
+    const QSize scaledSize = transformedPicture.size().scaled(availableSize, Qt::KeepAspectRatio);
+    const QRect targetRect{static_cast<int>((availableSize.width() - scaledSize.width()) / (2 * dpr)),
+                           static_cast<int>((availableSize.height() - scaledSize.height()) / (2 * dpr)),
+                           static_cast<int>(scaledSize.width() / dpr), static_cast<int>(scaledSize.height() / dpr)};
+    const qreal radius = roundCorners ? 0.05 * static_cast<qreal>(targetRect.width()) : 0.;
+
+    QImage scaledPicture = transformedPicture.scaled(scaledSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    scaledPicture.setDevicePixelRatio(dpr);
+    tile.setDevicePixelRatio(dpr);
+
+    QPainter painter(&tile);
+    QPainterPath shape;
+    shape.addRoundedRect(targetRect, radius, radius);
+    painter.setClipPath(shape);
+    painter.drawImage(targetRect, scaledPicture);
+    painter.setClipping(false);
+
+    if (!style.text.isEmpty()) {
+        // the text is fitted to the picture as loaded, before it is rotated
+        const QSize pictureSize = picture.size().scaled(size, Qt::KeepAspectRatio);
+        const QPoint topLeft{(size.width() - pictureSize.width()) / 2, (size.height() - pictureSize.height()) / 2};
+        const QRect pictureRect(topLeft, pictureSize);
+        drawOverlayText(painter, pictureRect, font, style);
+    }
+    return tile;
+}
+
 void DeckPreviewCardPictureWidget::mousePressEvent(QMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton) {
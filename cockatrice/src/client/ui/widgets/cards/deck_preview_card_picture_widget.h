@@ -27,8 +27,20 @@ signals:
 private:
     QTimer *singleClickTimer;
     QMouseEvent *lastMouseEvent = nullptr; // Store the last mouse event
+    // the key of the tile that is being rendered, empty if none is
+    QString pendingTileKey;
+
+    void renderTile(const QString &key, const QPixmap &picture, bool rotate, bool roundCorners, qreal dpr);
+    static QImage composeTile(const QImage &picture,
+                              bool rotate,
+                              bool roundCorners,
+                              const QSize &size,
+                              qreal dpr,
+                              const QFont &font,
+                              const OverlayStyle &style);
 
 protected:
+    void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void mouseDoubleClickEvent(QMouseEvent *event) override;
 };
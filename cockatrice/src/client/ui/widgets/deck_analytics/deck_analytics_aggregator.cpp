@@ -0,0 +1,161 @@
+#include "deck_analytics_aggregator.h"
+
+#include "../../../../deck/deck_loader.h"
+#include "../../../../game/cards/card_database.h"
+#include "../../../../game/cards/card_database_manager.h"
+
+#include <decklist.h>
+
+DeckAnalyticsAggregator::DeckAnalyticsAggregator(QObject *parent, DeckListModel *_deckListModel)
+    : QObject(parent), deckListModel(_deckListModel), knownCopies(0), manaDevotion(), manaBase()
+{
+    updateTimer.setSingleShot(true);
+    updateTimer.setInterval(0);
+    connect(&updateTimer, &QTimer::timeout, this, &DeckAnalyticsAggregator::update);
+
+    connectDeckModel();
+    update();
+}
+
+void DeckAnalyticsAggregator::setDeckModel(DeckListModel *deckModel)
+{
+    if (deckModel != deckListModel) {
+        disconnect(deckListModel, nullptr, this, nullptr);
+        deckListModel = deckModel;
+        connectDeckModel();
+    }
+    reset();
+}
+
+void DeckAnalyticsAggregator::connectDeckModel()
+{
+    connect(deckListModel, &DeckListModel::dataChanged, this, &DeckAnalyticsAggregator::scheduleUpdate);
+    connect(deckListModel, &DeckListModel::rowsInserted, this, &DeckAnalyticsAggregator::scheduleUpdate);
+    connect(deckListModel, &DeckListModel::rowsRemoved, this, &DeckAnalyticsAggregator::scheduleUpdate);
+    connect(deckListModel, &DeckListModel::modelReset, this, &DeckAnalyticsAggregator::reset);
+}
+
+void DeckAnalyticsAggregator::scheduleUpdate()
+{
+    // an editing action emits a signal for every level of the tree it touched
+    updateTimer.start();
+}
+
+void DeckAnalyticsAggregator::update()
+{
+    updateTimer.stop();
+
+    QHash<QString, int> newCopies;
+    InnerDecklistNode *listRoot = deckListModel->getDeckList()->getRoot();
+    for (int i = 0; i < listRoot->size(); i++) {
+        auto *currentZone = dynamic_cast<InnerDecklistNode *>(listRoot->at(i));
+        if (!currentZone)
+            continue;
+
+        for (int j = 0; j < currentZone->size(); j++) {
+            auto *currentCard = dynamic_cast<DecklistCardNode *>(currentZone->at(j));
+            if (currentCard)
+                newCopies[currentCard->getName()] += currentCard->getNumber();
+        }
+    }
+
+    bool changed = false;
+    for (auto it = copies.constBegin(); it != copies.constEnd(); ++it) {
+        const int delta = newCopies.value(it.key()) - it.value();
+        if (delta != 0) {
+            applyDelta(it.key(), delta);
+            changed = true;
+        }
+    }
+    for (auto it = newCopies.constBegin(); it != newCopies.constEnd(); ++it) {
+        if (!copies.contains(it.key()) && it.value() != 0) {
+            applyDelta(it.key(), it.value());
+            changed = true;
+        }
+    }
+    copies = newCopies;
+
+    if (changed) {
+        emit analyticsChanged();
+    }
+}
+
+void DeckAnalyticsAggregator::reset()
+{
+    // a new deck, or a reloaded card database: nothing that was computed before is kept
+    cardAnalytics.clear();
+    copies.clear();
+    knownCopies = 0;
+    manaCurve.clear();
+    manaDevotion.fill(0);
+    manaBase.fill(0);
+
+    update();
+    emit analyticsChanged();
+}
+
+const DeckAnalyticsAggregator::CardAnalytics &DeckAnalyticsAggregator::analyticsOf(const QString &cardName)
+{
+    auto entry = cardAnalytics.find(cardName);
+    if (entry != cardAnalytics.end()) {
+        return *entry;
+    }
+
+    CardAnalytics analytics;
+    CardInfoPtr info = CardDatabaseManager::getInstance()->getCardInfo(cardName);
+    if (info) {
+        analytics.known = true;
+        analytics.statistics = info->getManaStatistics();
+    }
+    return *cardAnalytics.insert(cardName, analytics);
+}
+
+void DeckAnalyticsAggregator::applyDelta(const QString &cardName, int delta)
+{
+    const CardAnalytics &analytics = analyticsOf(cardName);
+    if (!analytics.known) {
+        return;
+    }
+
+    const CardManaStatistics &statistics = analytics.statistics;
+    knownCopies += delta;
+
+    auto curveEntry = manaCurve.find(statistics.manaValue);
+    if (curveEntry == manaCurve.end()) {
+        manaCurve[statistics.manaValue] = delta;
+    } else if ((curveEntry->second += delta) == 0) {
+        manaCurve.erase(curveEntry);
+    }
+
+    for (int color = 0; color < CardManaStatistics::ColorCount; ++color) {
+        if (color < CardManaStatistics::Colorless) {
+            manaDevotion[color] += statistics.pips[color] * delta;
+        }
+        if (statistics.produces(static_cast<CardManaStatistics::Color>(color))) {
+            manaBase[color] += delta;
+        }
+    }
+}
+
+std::unordered_map<char, int> DeckAnalyticsAggregator::getManaDevotion() const
+{
+    // like a deck that was never analyzed, instead of a row of empty bars
+    std::unordered_map<char, int> devotion;
+    if (knownCopies != 0) {
+        for (int color = 0; color < CardManaStatistics::Colorless; ++color) {
+            devotion[CardManaStatistics::SYMBOLS[color]] = manaDevotion[color];
+        }
+    }
+    return devotion;
+}
+
+QHash<QString, int> DeckAnalyticsAggregator::getManaBase() const
+{
+    QHash<QString, int> base;
+    if (knownCopies != 0) {
+        for (int color = 0; color < CardManaStatistics::ColorCount; ++color) {
+            base.insert(QString(CardManaStatistics::SYMBOLS[color]), manaBase[color]);
+        }
+    }
+    return base;
+}
@@ -0,0 +1,71 @@
+#ifndef DECK_ANALYTICS_AGGREGATOR_H
+#define DECK_ANALYTICS_AGGREGATOR_H
+
+#include "../../../../deck/deck_list_model.h"
+#include "../../../../game/cards/card_info.h"
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <array>
+#include <unordered_map>
+
+/**
+ * The mana curve, devotion and base of the deck of a DeckListModel.
+ *
+ * The totals are sums of the CardManaStatistics of the cards, updated by the difference in copies of the cards whenever
+ * the model changes, so an edit of the deck doesn't look every card up again.
+ * The changes of a single editing action are applied together, and a reset of the model starts over from scratch.
+ */
+class DeckAnalyticsAggregator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DeckAnalyticsAggregator(QObject *parent, DeckListModel *deckListModel);
+    void setDeckModel(DeckListModel *deckModel);
+
+    const std::unordered_map<int, int> &getManaCurve() const
+    {
+        return manaCurve;
+    }
+    // the colored symbols in the mana costs of the cards, by color
+    std::unordered_map<char, int> getManaDevotion() const;
+    // the cards that can add mana of each color, colorless included
+    QHash<QString, int> getManaBase() const;
+
+signals:
+    void analyticsChanged();
+
+private slots:
+    void scheduleUpdate();
+    void update();
+    void reset();
+
+private:
+    struct CardAnalytics
+    {
+        // false for the cards that aren't in the database, they don't count
+        bool known = false;
+        CardManaStatistics statistics;
+    };
+
+    DeckListModel *deckListModel;
+    QHash<QString, CardAnalytics> cardAnalytics;
+    // the copies of each card the totals are made of
+    QHash<QString, int> copies;
+    int knownCopies;
+
+    std::unordered_map<int, int> manaCurve;
+    std::array<int, CardManaStatistics::Colorless> manaDevotion;
+    std::array<int, CardManaStatistics::ColorCount> manaBase;
+
+    QTimer updateTimer;
+
+    void connectDeckModel();
+    const CardAnalytics &analyticsOf(const QString &cardName);
+    void applyDelta(const QString &cardName, int delta);
+};
+
+#endif // DECK_ANALYTICS_AGGREGATOR_H
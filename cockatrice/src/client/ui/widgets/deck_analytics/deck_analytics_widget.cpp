@@ -17,20 +17,20 @@ DeckAnalyticsWidget::DeckAnalyticsWidget(QWidget *parent, DeckListModel *_deckLi
     container->setLayout(containerLayout);
     scrollArea->setWidget(container);
 
-    manaCurveWidget = new ManaCurveWidget(this, deckListModel);
+    analytics = new DeckAnalyticsAggregator(this, deckListModel);
+
+    manaCurveWidget = new ManaCurveWidget(this, analytics);
     containerLayout->addWidget(manaCurveWidget);
 
-    manaDevotionWidget = new ManaDevotionWidget(this, deckListModel);
+    manaDevotionWidget = new ManaDevotionWidget(this, analytics);
     containerLayout->addWidget(manaDevotionWidget);
 
-    manaBaseWidget = new ManaBaseWidget(this, deckListModel);
+    manaBaseWidget = new ManaBaseWidget(this, analytics);
     containerLayout->addWidget(manaBaseWidget);
 }
 
 void DeckAnalyticsWidget::refreshDisplays(DeckListModel *_deckModel)
 {
     deckListModel = _deckModel;
-    manaCurveWidget->setDeckModel(_deckModel);
-    manaDevotionWidget->setDeckModel(_deckModel);
-    manaBaseWidget->setDeckModel(_deckModel);
+    analytics->setDeckModel(_deckModel);
 }
@@ -3,6 +3,7 @@
 
 #include "../../../../deck/deck_list_model.h"
 #include "../../../ui/widgets/general/layout_containers/flow_widget.h"
+#include "deck_analytics_aggregator.h"
 #include "mana_base_widget.h"
 #include "mana_curve_widget.h"
 #include "mana_devotion_widget.h"
@@ -25,6 +26,7 @@ public:
 
 private:
     DeckListModel *deckListModel;
+    DeckAnalyticsAggregator *analytics;
     QVBoxLayout *mainLayout;
 
     QWidget *container;
@@ -1,17 +1,12 @@
 #include "mana_base_widget.h"
 
-#include "../../../../deck/deck_loader.h"
-#include "../../../../game/cards/card_database.h"
-#include "../../../../game/cards/card_database_manager.h"
 #include "../general/display/banner_widget.h"
 #include "../general/display/bar_widget.h"
 
 #include <QHash>
-#include <QRegularExpression>
-#include <decklist.h>
 
-ManaBaseWidget::ManaBaseWidget(QWidget *parent, DeckListModel *_deckListModel)
-    : QWidget(parent), deckListModel(_deckListModel)
+ManaBaseWidget::ManaBaseWidget(QWidget *parent, DeckAnalyticsAggregator *_analytics)
+    : QWidget(parent), analytics(_analytics)
 {
     layout = new QVBoxLayout(this);
     setLayout(layout);
@@ -24,9 +19,10 @@ ManaBaseWidget::ManaBaseWidget(QWidget *parent, DeckListModel *_deckListModel)
     barLayout = new QHBoxLayout(barContainer);
     layout->addWidget(barContainer);
 
-    connect(deckListModel, &DeckListModel::dataChanged, this, &ManaBaseWidget::analyzeManaBase);
+    connect(analytics, &DeckAnalyticsAggregator::analyticsChanged, this, &ManaBaseWidget::updateDisplay);
 
     retranslateUi();
+    updateDisplay();
 }
 
 void ManaBaseWidget::retranslateUi()
@@ -34,13 +30,6 @@ void ManaBaseWidget::retranslateUi()
     bannerWidget->setText(tr("Mana Base"));
 }
 
-void ManaBaseWidget::setDeckModel(DeckListModel *deckModel)
-{
-    deckListModel = deckModel;
-    connect(deckListModel, &DeckListModel::dataChanged, this, &ManaBaseWidget::analyzeManaBase);
-    analyzeManaBase();
-}
-
 void ManaBaseWidget::updateDisplay()
 {
     // Clear the layout first
@@ -50,6 +39,7 @@ void ManaBaseWidget::updateDisplay()
         delete item;
     }
 
+    const QHash<QString, int> manaBaseMap = analytics->getManaBase();
     int highestEntry = 0;
     for (auto entry : manaBaseMap) {
         if (entry > highestEntry) {
@@ -74,62 +64,3 @@ void ManaBaseWidget::updateDisplay()
 
     update();
 }
-
-QHash<QString, int> ManaBaseWidget::analyzeManaBase()
-{
-    manaBaseMap.clear();
-    InnerDecklistNode *listRoot = deckListModel->getDeckList()->getRoot();
-    for (int i = 0; i < listRoot->size(); i++) {
-        InnerDecklistNode *currentZone = dynamic_cast<InnerDecklistNode *>(listRoot->at(i));
-        for (int j = 0; j < currentZone->size(); j++) {
-            DecklistCardNode *currentCard = dynamic_cast<DecklistCardNode *>(currentZone->at(j));
-            if (!currentCard)
-                continue;
-
-            for (int k = 0; k < currentCard->getNumber(); ++k) {
-                CardInfoPtr info = CardDatabaseManager::getInstance()->getCardInfo(currentCard->getName());
-                if (info) {
-                    auto devotion = determineManaProduction(info->getText());
-                    mergeManaCounts(manaBaseMap, devotion);
-                }
-            }
-        }
-    }
-
-    updateDisplay();
-    return manaBaseMap;
-}
-
-QHash<QString, int> ManaBaseWidget::determineManaProduction(const QString &rulesText)
-{
-    QHash<QString, int> manaCounts = {{"W", 0}, {"U", 0}, {"B", 0}, {"R", 0}, {"G", 0}, {"C", 0}};
-
-    QString text = rulesText.toLower(); // Normalize case for matching
-
-    // Quick keyword-based checks for any color and colorless mana
-    if (text.contains("{t}: add one mana of any color") || text.contains("add one mana of any color")) {
-        for (const auto &color : {QStringLiteral("W"), QStringLiteral("U"), QStringLiteral("B"), QStringLiteral("R"),
-                                  QStringLiteral("G")}) {
-            manaCounts[color]++;
-        }
-    }
-    if (text.contains("{t}: add {c}") || text.contains("add one colorless mana")) {
-        manaCounts["C"]++;
-    }
-
-    // Optimized regex for specific mana symbols
-    static const QRegularExpression specificColorRegex(R"(\{T\}:\s*Add\s*\{([WUBRG])\})");
-    QRegularExpressionMatch match = specificColorRegex.match(rulesText);
-    if (match.hasMatch()) {
-        manaCounts[match.captured(1)]++;
-    }
-
-    return manaCounts;
-}
-
-void ManaBaseWidget::mergeManaCounts(QHash<QString, int> &manaCounts1, const QHash<QString, int> &manaCounts2)
-{
-    for (auto it = manaCounts2.constBegin(); it != manaCounts2.constEnd(); ++it) {
-        manaCounts1[it.key()] += it.value();
-    }
-}
@@ -1,34 +1,26 @@
 #ifndef MANA_BASE_WIDGET_H
 #define MANA_BASE_WIDGET_H
 
-#include "../../../../deck/deck_list_model.h"
 #include "../general/display/banner_widget.h"
+#include "deck_analytics_aggregator.h"
 
 #include <QHBoxLayout>
 #include <QWidget>
-#include <decklist.h>
-#include <utility>
 
 class ManaBaseWidget : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit ManaBaseWidget(QWidget *parent, DeckListModel *deckListModel);
-    QHash<QString, int> analyzeManaBase();
-    void updateDisplay();
-
-    QHash<QString, int> determineManaProduction(const QString &manaString);
-    void mergeManaCounts(QHash<QString, int> &manaCounts1, const QHash<QString, int> &manaCounts2);
+    explicit ManaBaseWidget(QWidget *parent, DeckAnalyticsAggregator *analytics);
 
 public slots:
-    void setDeckModel(DeckListModel *deckModel);
+    void updateDisplay();
     void retranslateUi();
 
 private:
-    DeckListModel *deckListModel;
+    DeckAnalyticsAggregator *analytics;
     BannerWidget *bannerWidget;
-    QHash<QString, int> manaBaseMap;
     QVBoxLayout *layout;
     QWidget *barContainer;
     QHBoxLayout *barLayout;
@@ -1,17 +1,12 @@
 #include "mana_curve_widget.h"
 
-#include "../../../../deck/deck_loader.h"
-#include "../../../../game/cards/card_database.h"
-#include "../../../../game/cards/card_database_manager.h"
-#include "../../../../main.h"
 #include "../general/display/banner_widget.h"
 #include "../general/display/bar_widget.h"
 
-#include <decklist.h>
-#include <unordered_map>
+#include <map>
 
-ManaCurveWidget::ManaCurveWidget(QWidget *parent, DeckListModel *_deckListModel)
-    : QWidget(parent), deckListModel(_deckListModel)
+ManaCurveWidget::ManaCurveWidget(QWidget *parent, DeckAnalyticsAggregator *_analytics)
+    : QWidget(parent), analytics(_analytics)
 {
     layout = new QVBoxLayout(this);
     setLayout(layout);
@@ -24,9 +19,10 @@ ManaCurveWidget::ManaCurveWidget(QWidget *parent, DeckListModel *_deckListModel)
     barLayout = new QHBoxLayout(barContainer);
     layout->addWidget(barContainer);
 
-    connect(deckListModel, &DeckListModel::dataChanged, this, &ManaCurveWidget::analyzeManaCurve);
+    connect(analytics, &DeckAnalyticsAggregator::analyticsChanged, this, &ManaCurveWidget::updateDisplay);
 
     retranslateUi();
+    updateDisplay();
 }
 
 void ManaCurveWidget::retranslateUi()
@@ -34,39 +30,6 @@ void ManaCurveWidget::retranslateUi()
     bannerWidget->setText(tr("Mana Curve"));
 }
 
-void ManaCurveWidget::setDeckModel(DeckListModel *deckModel)
-{
-    deckListModel = deckModel;
-    connect(deckListModel, &DeckListModel::dataChanged, this, &ManaCurveWidget::analyzeManaCurve);
-    analyzeManaCurve();
-}
-
-std::unordered_map<int, int> ManaCurveWidget::analyzeManaCurve()
-{
-    manaCurveMap.clear();
-    InnerDecklistNode *listRoot = deckListModel->getDeckList()->getRoot();
-    for (int i = 0; i < listRoot->size(); i++) {
-        InnerDecklistNode *currentZone = dynamic_cast<InnerDecklistNode *>(listRoot->at(i));
-        for (int j = 0; j < currentZone->size(); j++) {
-            DecklistCardNode *currentCard = dynamic_cast<DecklistCardNode *>(currentZone->at(j));
-            if (!currentCard)
-                continue;
-
-            for (int k = 0; k < currentCard->getNumber(); ++k) {
-                CardInfoPtr info = CardDatabaseManager::getInstance()->getCardInfo(currentCard->getName());
-                if (info) {
-                    int cmc = info->getCmc().toInt();
-                    manaCurveMap[cmc]++;
-                }
-            }
-        }
-    }
-
-    updateDisplay();
-
-    return manaCurveMap;
-}
-
 void ManaCurveWidget::updateDisplay()
 {
     // Clear the layout first
@@ -78,6 +41,7 @@ void ManaCurveWidget::updateDisplay()
         }
     }
 
+    const std::unordered_map<int, int> &manaCurveMap = analytics->getManaCurve();
     int highestEntry = 0;
     for (const auto &entry : manaCurveMap) {
         if (entry.second > highestEntry) {
@@ -1,29 +1,25 @@
 #ifndef MANA_CURVE_WIDGET_H
 #define MANA_CURVE_WIDGET_H
 
-#include "../../../../deck/deck_list_model.h"
 #include "../general/display/banner_widget.h"
+#include "deck_analytics_aggregator.h"
 
 #include <QHBoxLayout>
 #include <QWidget>
-#include <unordered_map>
 
 class ManaCurveWidget : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit ManaCurveWidget(QWidget *parent, DeckListModel *deckListModel);
-    void updateDisplay();
+    explicit ManaCurveWidget(QWidget *parent, DeckAnalyticsAggregator *analytics);
 
 public slots:
-    void setDeckModel(DeckListModel *deckModel);
-    std::unordered_map<int, int> analyzeManaCurve();
+    void updateDisplay();
     void retranslateUi();
 
 private:
-    DeckListModel *deckListModel;
-    std::unordered_map<int, int> manaCurveMap;
+    DeckAnalyticsAggregator *analytics;
     QVBoxLayout *layout;
     BannerWidget *bannerWidget;
     QWidget *barContainer;
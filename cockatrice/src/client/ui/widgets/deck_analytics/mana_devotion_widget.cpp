@@ -1,20 +1,12 @@
 #include "mana_devotion_widget.h"
 
-#include "../../../../deck/deck_loader.h"
-#include "../../../../game/cards/card_database.h"
-#include "../../../../game/cards/card_database_manager.h"
-#include "../../../../main.h"
 #include "../general/display/banner_widget.h"
 #include "../general/display/bar_widget.h"
 
-#include <decklist.h>
-#include <iostream>
-#include <regex>
-#include <string>
 #include <unordered_map>
 
-ManaDevotionWidget::ManaDevotionWidget(QWidget *parent, DeckListModel *_deckListModel)
-    : QWidget(parent), deckListModel(_deckListModel)
+ManaDevotionWidget::ManaDevotionWidget(QWidget *parent, DeckAnalyticsAggregator *_analytics)
+    : QWidget(parent), analytics(_analytics)
 {
     layout = new QVBoxLayout(this);
     setLayout(layout);
@@ -26,9 +18,10 @@ ManaDevotionWidget::ManaDevotionWidget(QWidget *parent, DeckListModel *_deckList
     barLayout = new QHBoxLayout();
     layout->addLayout(barLayout);
 
-    connect(deckListModel, &DeckListModel::dataChanged, this, &ManaDevotionWidget::analyzeManaDevotion);
+    connect(analytics, &DeckAnalyticsAggregator::analyticsChanged, this, &ManaDevotionWidget::updateDisplay);
 
     retranslateUi();
+    updateDisplay();
 }
 
 void ManaDevotionWidget::retranslateUi()
@@ -36,38 +29,6 @@ void ManaDevotionWidget::retranslateUi()
     bannerWidget->setText(tr("Mana Devotion"));
 }
 
-void ManaDevotionWidget::setDeckModel(DeckListModel *deckModel)
-{
-    deckListModel = deckModel;
-    connect(deckListModel, &DeckListModel::dataChanged, this, &ManaDevotionWidget::analyzeManaDevotion);
-    analyzeManaDevotion();
-}
-
-std::unordered_map<char, int> ManaDevotionWidget::analyzeManaDevotion()
-{
-    manaDevotionMap.clear();
-    InnerDecklistNode *listRoot = deckListModel->getDeckList()->getRoot();
-    for (int i = 0; i < listRoot->size(); i++) {
-        InnerDecklistNode *currentZone = dynamic_cast<InnerDecklistNode *>(listRoot->at(i));
-        for (int j = 0; j < currentZone->size(); j++) {
-            DecklistCardNode *currentCard = dynamic_cast<DecklistCardNode *>(currentZone->at(j));
-            if (!currentCard)
-                continue;
-
-            for (int k = 0; k < currentCard->getNumber(); ++k) {
-                CardInfoPtr info = CardDatabaseManager::getInstance()->getCardInfo(currentCard->getName());
-                if (info) {
-                    auto devotion = countManaSymbols(info->getManaCost());
-                    mergeManaCounts(manaDevotionMap, devotion);
-                }
-            }
-        }
-    }
-
-    updateDisplay();
-    return manaDevotionMap;
-}
-
 void ManaDevotionWidget::updateDisplay()
 {
     // Clear the layout first
@@ -77,6 +38,7 @@ void ManaDevotionWidget::updateDisplay()
         delete item;
     }
 
+    const std::unordered_map<char, int> manaDevotionMap = analytics->getManaDevotion();
     int highestEntry = 0;
     for (auto entry : manaDevotionMap) {
         if (highestEntry < entry.second) {
@@ -97,50 +59,3 @@ void ManaDevotionWidget::updateDisplay()
 
     update(); // Update the widget display
 }
-
-std::unordered_map<char, int> ManaDevotionWidget::countManaSymbols(const QString &manaString)
-{
-    std::unordered_map<char, int> manaCounts = {{'W', 0}, {'U', 0}, {'B', 0}, {'R', 0}, {'G', 0}};
-
-    int len = manaString.length();
-    for (int i = 0; i < len; ++i) {
-        if (manaString[i] == '{') {
-            ++i; // Move past '{'
-            if (i < len && manaCounts.find(manaString[i].toLatin1()) != manaCounts.end()) {
-                char mana1 = manaString[i].toLatin1();
-                ++i; // Move to next character
-                if (i < len && manaString[i] == '/') {
-                    ++i; // Move past '/'
-                    if (i < len && manaCounts.find(manaString[i].toLatin1()) != manaCounts.end()) {
-                        char mana2 = manaString[i].toLatin1();
-                        manaCounts[mana1]++;
-                        manaCounts[mana2]++;
-                    } else {
-                        // Handle cases like "{W/}" where second part is invalid
-                        manaCounts[mana1]++;
-                    }
-                } else {
-                    manaCounts[mana1]++;
-                }
-            }
-            // Ensure we always skip to the closing '}'
-            while (i < len && manaString[i] != '}') {
-                ++i;
-            }
-        }
-        // Check if the character is a standalone mana symbol (not inside {})
-        else if (manaCounts.find(manaString[i].toLatin1()) != manaCounts.end()) {
-            manaCounts[manaString[i].toLatin1()]++;
-        }
-    }
-
-    return manaCounts;
-}
-
-void ManaDevotionWidget::mergeManaCounts(std::unordered_map<char, int> &manaCounts1,
-                                         const std::unordered_map<char, int> &manaCounts2)
-{
-    for (const auto &pair : manaCounts2) {
-        manaCounts1[pair.first] += pair.second; // Add values for matching keys
-    }
-}
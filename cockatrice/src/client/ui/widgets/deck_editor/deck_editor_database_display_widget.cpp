@@ -65,6 +65,8 @@ DeckEditorDatabaseDisplayWidget::DeckEditorDatabaseDisplayWidget(AbstractTabDeck
     databaseDisplayModel->setObjectName("databaseDisplayModel");
     databaseDisplayModel->setSourceModel(databaseModel);
     databaseDisplayModel->setFilterKeyColumn(0);
+    connect(databaseDisplayModel, &CardDatabaseDisplayModel::searchFinished, this,
+            &DeckEditorDatabaseDisplayWidget::selectFirstSearchResult);
 
     databaseView = new QTreeView(this);
     databaseView->setObjectName("databaseView");
@@ -121,6 +123,10 @@ DeckEditorDatabaseDisplayWidget::DeckEditorDatabaseDisplayWidget(AbstractTabDeck
 void DeckEditorDatabaseDisplayWidget::updateSearch(const QString &search)
 {
     databaseDisplayModel->setStringFilter(search);
+}
+
+void DeckEditorDatabaseDisplayWidget::selectFirstSearchResult()
+{
     QModelIndexList sel = databaseView->selectionModel()->selectedRows();
     if (sel.isEmpty() && databaseDisplayModel->rowCount())
         databaseView->selectionModel()->setCurrentIndex(databaseDisplayModel->index(0, 0),
@@ -44,6 +44,7 @@ private:
 private slots:
     void retranslateUi();
     void updateSearch(const QString &search);
+    void selectFirstSearchResult();
     void updateCard(const QModelIndex &current, const QModelIndex &);
     void actAddCardToMainDeck();
     void actAddCardToSideboard();
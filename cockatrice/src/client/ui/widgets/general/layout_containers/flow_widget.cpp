@@ -99,6 +99,15 @@ void FlowWidget::removeWidget(QWidget *widgetToRemove) const
     flowLayout->removeWidget(widgetToRemove);
 }
 
+/**
+ * @brief Moves the given widgets after all other widgets, in the given order.
+ * @param widgets The widgets to move, which have to be in the flow widget already.
+ */
+void FlowWidget::moveWidgetsToEnd(const QList<QWidget *> &widgets) const
+{
+    flowLayout->moveWidgetsToEnd(widgets);
+}
+
 /**
  * @brief Clears all widgets from the flow layout.
  *
@@ -22,6 +22,7 @@ public:
     void addWidget(QWidget *widget_to_add) const;
     void insertWidgetAtIndex(QWidget *toInsert, int index);
     void removeWidget(QWidget *widgetToRemove) const;
+    void moveWidgetsToEnd(const QList<QWidget *> &widgets) const;
     void clearLayout();
     [[nodiscard]] int count() const;
     [[nodiscard]] QLayoutItem *itemAt(int index) const;
@@ -34,8 +34,15 @@ PrintingSelector::PrintingSelector(QWidget *parent, AbstractTabDeckEditor *_deck
     setLayout(layout);
 
     widgetLoadingBufferTimer = new QTimer(this);
+    widgetLoadingBufferTimer->setInterval(0); // Process as soon as possible
+    connect(widgetLoadingBufferTimer, &QTimer::timeout, this, &PrintingSelector::loadNextBatch);
 
     flowWidget = new FlowWidget(this, Qt::Horizontal, Qt::ScrollBarAlwaysOff, Qt::ScrollBarAsNeeded);
+    // the widgets of the printings further down are only created once they're scrolled close to
+    connect(flowWidget->scrollArea->verticalScrollBar(), &QScrollBar::valueChanged, this,
+            &PrintingSelector::resumeLoading);
+    connect(flowWidget->scrollArea->verticalScrollBar(), &QScrollBar::rangeChanged, this,
+            &PrintingSelector::resumeLoading);
 
     sortToolBar = new PrintingSelectorCardSortingWidget(this);
     sortToolBar->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
@@ -103,8 +110,7 @@ void PrintingSelector::printingsInDeckChanged()
 void PrintingSelector::updateDisplay()
 {
     widgetLoadingBufferTimer->stop();
-    widgetLoadingBufferTimer->deleteLater();
-    widgetLoadingBufferTimer = new QTimer(this);
+    printingsToDisplay.clear();
     flowWidget->clearLayout();
     if (selectedCard != nullptr) {
         setWindowTitle(selectedCard->getName());
@@ -200,8 +206,7 @@ void PrintingSelector::getAllSetsForCurrentCard()
         return;
     }
 
-    SetToPrintingsMap setMap = selectedCard->getSets();
-    const QList<PrintingInfo> sortedPrintings = sortToolBar->sortSets(setMap);
+    const QList<PrintingInfo> sortedPrintings = sortToolBar->getSortedPrintings(selectedCard);
     const QList<PrintingInfo> filteredPrintings =
         sortToolBar->filterSets(sortedPrintings, searchBar->getSearchText().trimmed().toLower());
     QList<PrintingInfo> printingsToUse;
@@ -211,29 +216,50 @@ void PrintingSelector::getAllSetsForCurrentCard()
     } else {
         printingsToUse = filteredPrintings;
     }
-    printingsToUse = sortToolBar->prependPinnedPrintings(printingsToUse, selectedCard->getName());
+    printingsToDisplay = sortToolBar->prependPinnedPrintings(printingsToUse, selectedCard->getName());
 
     // Defer widget creation
     currentIndex = 0;
+    widgetLoadingBufferTimer->start();
+}
 
-    connect(widgetLoadingBufferTimer, &QTimer::timeout, this, [=, this]() mutable {
-        for (int i = 0; i < BATCH_SIZE && currentIndex < printingsToUse.size(); ++i, ++currentIndex) {
-            ExactCard card = ExactCard(selectedCard, printingsToUse[currentIndex]);
-            auto *cardDisplayWidget = new PrintingSelectorCardDisplayWidget(
-                this, deckEditor, deckModel, deckView, cardSizeWidget->getSlider(), card, currentZone);
-            flowWidget->addWidget(cardDisplayWidget);
-            cardDisplayWidget->clampSetNameToPicture();
-            connect(cardDisplayWidget, &PrintingSelectorCardDisplayWidget::cardPreferenceChanged, this,
-                    &PrintingSelector::updateDisplay);
-        }
-
-        // Stop timer when done
-        if (currentIndex >= printingsToUse.size()) {
-            widgetLoadingBufferTimer->stop();
-        }
-    });
-    currentIndex = 0;
-    widgetLoadingBufferTimer->start(0); // Process as soon as possible
+/**
+ * @brief Creates the widgets of the next batch of printings, until the printings below the visible ones are ready.
+ *
+ * A card can have hundreds of printings, creating all of their widgets would request all of their pictures.
+ */
+void PrintingSelector::loadNextBatch()
+{
+    for (int i = 0; i < BATCH_SIZE && currentIndex < printingsToDisplay.size(); ++i, ++currentIndex) {
+        ExactCard card = ExactCard(selectedCard, printingsToDisplay[currentIndex]);
+        auto *cardDisplayWidget = new PrintingSelectorCardDisplayWidget(
+            this, deckEditor, deckModel, deckView, cardSizeWidget->getSlider(), card, currentZone);
+        flowWidget->addWidget(cardDisplayWidget);
+        cardDisplayWidget->clampSetNameToPicture();
+        connect(cardDisplayWidget, &PrintingSelectorCardDisplayWidget::cardPreferenceChanged, this,
+                &PrintingSelector::updateDisplay);
+    }
+
+    // Stop timer when done, scrolling down resumes it
+    if (currentIndex >= printingsToDisplay.size() || !needsMoreWidgets()) {
+        widgetLoadingBufferTimer->stop();
+    }
+}
+
+void PrintingSelector::resumeLoading()
+{
+    if (currentIndex < printingsToDisplay.size() && needsMoreWidgets()) {
+        widgetLoadingBufferTimer->start();
+    }
+}
+
+/**
+ * @brief Whether less than a screen of printings is ready below the visible ones.
+ */
+bool PrintingSelector::needsMoreWidgets() const
+{
+    const QScrollBar *scrollBar = flowWidget->scrollArea->verticalScrollBar();
+    return scrollBar->maximum() - scrollBar->value() < flowWidget->scrollArea->viewport()->height();
 }
 
 /**
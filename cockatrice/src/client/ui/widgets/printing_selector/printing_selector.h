@@ -44,6 +44,8 @@ public slots:
 
 private slots:
     void printingsInDeckChanged();
+    void loadNextBatch();
+    void resumeLoading();
 
 private:
     QVBoxLayout *layout;
@@ -62,8 +64,10 @@ private:
     CardInfoPtr selectedCard;
     QString currentZone;
     QTimer *widgetLoadingBufferTimer;
+    QList<PrintingInfo> printingsToDisplay;
     int currentIndex = 0;
     void selectCard(int changeBy);
+    bool needsMoreWidgets() const;
 };
 
 #endif // PRINTING_SELECTOR_H
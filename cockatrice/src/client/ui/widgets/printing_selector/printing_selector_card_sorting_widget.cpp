@@ -1,5 +1,6 @@
 #include "printing_selector_card_sorting_widget.h"
 
+#include "../../../../game/cards/card_database_manager.h"
 #include "../../../../settings/cache_settings.h"
 #include "../../../../utility/card_set_comparator.h"
 
@@ -27,6 +28,8 @@ PrintingSelectorCardSortingWidget::PrintingSelectorCardSortingWidget(PrintingSel
     sortOptionsSelector->setCurrentIndex(SettingsCache::instance().getPrintingSelectorSortOrder());
     connect(sortOptionsSelector, &QComboBox::currentTextChanged, this,
             &PrintingSelectorCardSortingWidget::updateSortSetting);
+    connect(sortOptionsSelector, &QComboBox::currentTextChanged, this,
+            &PrintingSelectorCardSortingWidget::clearSortedPrintings);
     connect(sortOptionsSelector, &QComboBox::currentTextChanged, parent, &PrintingSelector::updateDisplay);
     sortToolBar->addWidget(sortOptionsSelector);
 
@@ -35,6 +38,16 @@ PrintingSelectorCardSortingWidget::PrintingSelectorCardSortingWidget(PrintingSel
     descendingSort = true;
     connect(toggleSortOrder, &QPushButton::clicked, this, &PrintingSelectorCardSortingWidget::updateSortOrder);
     sortToolBar->addWidget(toggleSortOrder);
+
+    // the printings and the set priorities only change with the database
+    CardDatabase *db = CardDatabaseManager::getInstance();
+    connect(db, &CardDatabase::cardDatabaseLoadingFinished, this,
+            &PrintingSelectorCardSortingWidget::clearSortedPrintings);
+    connect(db, &CardDatabase::cardDatabaseEnabledSetsChanged, this,
+            &PrintingSelectorCardSortingWidget::clearSortedPrintings);
+    connect(db, &CardDatabase::cardsAdded, this, &PrintingSelectorCardSortingWidget::clearSortedPrintings);
+    connect(db, &CardDatabase::cardAdded, this, &PrintingSelectorCardSortingWidget::clearSortedPrintings);
+    connect(db, &CardDatabase::cardRemoved, this, &PrintingSelectorCardSortingWidget::clearSortedPrintings);
 }
 
 /**
@@ -50,6 +63,7 @@ void PrintingSelectorCardSortingWidget::updateSortOrder()
         toggleSortOrder->setText(tr("Descending"));
     }
     descendingSort = !descendingSort;
+    clearSortedPrintings();
     parent->updateDisplay();
 }
 
@@ -79,18 +93,21 @@ void PrintingSelectorCardSortingWidget::updateSortSetting()
 QList<PrintingInfo> PrintingSelectorCardSortingWidget::sortSets(const SetToPrintingsMap &setMap)
 {
     QList<CardSetPtr> sortedSets;
+    // the printings are grouped by set in one pass, so that the sorted sets don't have to be looked up in setMap
+    QHash<CardSet *, QList<PrintingInfo>> printingsBySet;
 
     for (const auto &printingInfos : setMap) {
-        for (const auto &set : printingInfos) {
-            sortedSets << set.getSet();
-            break;
+        for (const auto &printingInfo : printingInfos) {
+            QList<PrintingInfo> &printingsOfSet = printingsBySet[printingInfo.getSet().data()];
+            if (printingsOfSet.isEmpty()) {
+                sortedSets << printingInfo.getSet();
+            }
+            if (!printingsOfSet.contains(printingInfo)) {
+                printingsOfSet << printingInfo;
+            }
         }
     }
 
-    if (sortedSets.empty()) {
-        sortedSets << CardSet::newInstance("", "", "", QDate());
-    }
-
     if (sortOptionsSelector->currentText() == SORT_OPTIONS_PREFERENCE) {
         std::sort(sortedSets.begin(), sortedSets.end(), SetPriorityComparator());
         std::reverse(sortedSets.begin(), sortedSets.end());
@@ -101,15 +118,7 @@ QList<PrintingInfo> PrintingSelectorCardSortingWidget::sortSets(const SetToPrint
     QList<PrintingInfo> sortedPrintings;
     // Reconstruct sorted list of PrintingInfo
     for (const auto &set : sortedSets) {
-        for (auto it = setMap.begin(); it != setMap.end(); ++it) {
-            for (const auto &printingInfo : it.value()) {
-                if (printingInfo.getSet() == set) {
-                    if (!sortedPrintings.contains(printingInfo)) {
-                        sortedPrintings << printingInfo;
-                    }
-                }
-            }
-        }
+        sortedPrintings << printingsBySet.value(set.data());
     }
 
     if (descendingSort) {
@@ -119,6 +128,29 @@ QList<PrintingInfo> PrintingSelectorCardSortingWidget::sortSets(const SetToPrint
     return sortedPrintings;
 }
 
+/**
+ * @brief Returns the printings of a card, sorted by sortSets.
+ *
+ * The sorted printings of every card are kept until the sorting options or the card database change, so that
+ * showing a card again doesn't sort its printings again.
+ *
+ * @param card The card to return the printings of.
+ * @return A sorted list of printings.
+ */
+QList<PrintingInfo> PrintingSelectorCardSortingWidget::getSortedPrintings(const CardInfoPtr &card)
+{
+    auto cached = sortedPrintings.constFind(card->getName());
+    if (cached != sortedPrintings.constEnd()) {
+        return *cached;
+    }
+    return *sortedPrintings.insert(card->getName(), sortSets(card->getSets()));
+}
+
+void PrintingSelectorCardSortingWidget::clearSortedPrintings()
+{
+    sortedPrintings.clear();
+}
+
 /**
  * @brief Filters a list of card sets based on the search text.
  *
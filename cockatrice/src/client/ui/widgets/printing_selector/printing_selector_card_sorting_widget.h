@@ -4,6 +4,7 @@
 #include "printing_selector.h"
 
 #include <QComboBox>
+#include <QHash>
 #include <QPushButton>
 #include <QWidget>
 
@@ -13,6 +14,7 @@ class PrintingSelectorCardSortingWidget : public QWidget
 public:
     explicit PrintingSelectorCardSortingWidget(PrintingSelector *parent);
     QList<PrintingInfo> sortSets(const SetToPrintingsMap &setMap);
+    QList<PrintingInfo> getSortedPrintings(const CardInfoPtr &card);
     QList<PrintingInfo> filterSets(const QList<PrintingInfo> &printings, const QString &searchText);
     QList<PrintingInfo> prependPinnedPrintings(const QList<PrintingInfo> &printings, const QString &cardName);
     QList<PrintingInfo> prependPrintingsInDeck(const QList<PrintingInfo> &printings,
@@ -22,6 +24,7 @@ public:
 public slots:
     void updateSortOrder();
     void updateSortSetting();
+    void clearSortedPrintings();
 
 private:
     PrintingSelector *parent;
@@ -35,6 +38,8 @@ private:
     QComboBox *sortOptionsSelector;
     bool descendingSort;
     QPushButton *toggleSortOrder;
+    // the printings of the cards shown so far, in the current order
+    QHash<QString, QList<PrintingInfo>> sortedPrintings;
 };
 
 #endif // PRINTING_SELECTOR_CARD_SORTING_WIDGET_H
@@ -158,8 +158,7 @@ void VisualDatabaseDisplayColorFilterWidget::updateFilterMode()
             break;
     }
 
-    filterModel->blockSignals(true);
-    filterModel->filterTree()->blockSignals(true);
+    filterModel->beginBatch();
 
     filterModel->clearFiltersOfType(CardFilter::Attr::AttrColor);
 
@@ -169,11 +168,7 @@ void VisualDatabaseDisplayColorFilterWidget::updateFilterMode()
         handleColorToggled(manaSymbolWidget->getSymbolChar(), manaSymbolWidget->isColorActive());
     }
 
-    filterModel->blockSignals(false);
-    filterModel->filterTree()->blockSignals(false);
-
-    emit filterModel->filterTree()->changed();
-    emit filterModel->layoutChanged();
+    filterModel->endBatch();
 
     retranslateUi();                     // Update button text based on the mode
     emit filterModeChanged(currentMode); // Signal mode change
@@ -93,10 +93,8 @@ void VisualDatabaseDisplayFilterSaveLoadWidget::loadFilter(const QString &filena
 
     QJsonArray filtersArray = root["filters"].toArray();
 
+    filterModel->beginBatch();
     filterModel->clear();
-
-    filterModel->blockSignals(true);
-    filterModel->filterTree()->blockSignals(true);
     for (const QJsonValue &value : filtersArray) {
         if (value.isObject()) {
             QJsonObject filterObj = value.toObject();
@@ -106,11 +104,7 @@ void VisualDatabaseDisplayFilterSaveLoadWidget::loadFilter(const QString &filena
             }
         }
     }
-    filterModel->blockSignals(false);
-    filterModel->filterTree()->blockSignals(false);
-
-    emit filterModel->filterTree()->changed();
-    emit filterModel->layoutChanged();
+    filterModel->endBatch();
 }
 
 void VisualDatabaseDisplayFilterSaveLoadWidget::refreshFilterList()
@@ -111,8 +111,7 @@ void VisualDatabaseDisplayMainTypeFilterWidget::handleMainTypeToggled(const QStr
 void VisualDatabaseDisplayMainTypeFilterWidget::updateMainTypeFilter()
 {
     // Clear existing filters related to main type
-    filterModel->blockSignals(true);
-    filterModel->filterTree()->blockSignals(true);
+    filterModel->beginBatch();
     filterModel->clearFiltersOfType(CardFilter::Attr::AttrMainType);
 
     if (exactMatchMode) {
@@ -152,11 +151,7 @@ void VisualDatabaseDisplayMainTypeFilterWidget::updateMainTypeFilter()
         }
     }
 
-    filterModel->blockSignals(false);
-    filterModel->filterTree()->blockSignals(false);
-
-    emit filterModel->filterTree()->changed();
-    emit filterModel->layoutChanged();
+    filterModel->endBatch();
 }
 
 void VisualDatabaseDisplayMainTypeFilterWidget::updateFilterMode(bool checked)
@@ -130,25 +130,15 @@ void VisualDatabaseDisplayNameFilterWidget::removeNameFilter(const QString &name
 void VisualDatabaseDisplayNameFilterWidget::updateFilterModel()
 {
     // Clear existing name filters
-    emit filterModel->layoutAboutToBeChanged();
+    filterModel->beginBatch();
     filterModel->clearFiltersOfType(CardFilter::Attr::AttrName);
 
-    filterModel->blockSignals(true);
-    filterModel->filterTree()->blockSignals(true);
-
     for (const auto &name : activeFilters.keys()) {
         QString nameString = name;
         filterModel->addFilter(new CardFilter(nameString, CardFilter::Type::TypeOr, CardFilter::Attr::AttrName));
     }
 
-    filterModel->blockSignals(false);
-    filterModel->filterTree()->blockSignals(false);
-
-    filterModel->blockSignals(false);
-    filterModel->filterTree()->blockSignals(false);
-
-    emit filterModel->filterTree()->changed();
-    emit filterModel->layoutChanged();
+    filterModel->endBatch();
 }
 
 void VisualDatabaseDisplayNameFilterWidget::syncWithFilterModel()
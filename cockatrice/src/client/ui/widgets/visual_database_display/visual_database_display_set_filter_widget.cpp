@@ -180,8 +180,7 @@ void VisualDatabaseDisplaySetFilterWidget::handleSetToggled(const QString &setSh
 void VisualDatabaseDisplaySetFilterWidget::updateSetFilter()
 {
     // Clear existing filters related to sets
-    filterModel->blockSignals(true);
-    filterModel->filterTree()->blockSignals(true);
+    filterModel->beginBatch();
     filterModel->clearFiltersOfType(CardFilter::Attr::AttrSet);
 
     if (exactMatchMode) {
@@ -218,11 +217,7 @@ void VisualDatabaseDisplaySetFilterWidget::updateSetFilter()
             }
         }
     }
-    filterModel->blockSignals(false);
-    filterModel->filterTree()->blockSignals(false);
-
-    emit filterModel->filterTree()->changed();
-    emit filterModel->layoutChanged();
+    filterModel->endBatch();
 }
 
 void VisualDatabaseDisplaySetFilterWidget::syncWithFilterModel()
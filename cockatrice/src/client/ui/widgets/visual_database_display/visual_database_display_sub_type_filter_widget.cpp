@@ -119,7 +119,7 @@ void VisualDatabaseDisplaySubTypeFilterWidget::handleSubTypeToggled(const QStrin
 
 void VisualDatabaseDisplaySubTypeFilterWidget::updateSubTypeFilter()
 {
-    filterModel->blockSignals(true);
+    filterModel->beginBatch();
     // Clear existing filters related to sub types
     filterModel->clearFiltersOfType(CardFilter::Attr::AttrSubType);
 
@@ -159,11 +159,7 @@ void VisualDatabaseDisplaySubTypeFilterWidget::updateSubTypeFilter()
             }
         }
     }
-    filterModel->blockSignals(false);
-    filterModel->filterTree()->blockSignals(false);
-
-    emit filterModel->filterTree()->changed();
-    emit filterModel->layoutChanged();
+    filterModel->endBatch();
 }
 
 void VisualDatabaseDisplaySubTypeFilterWidget::updateFilterMode(bool checked)
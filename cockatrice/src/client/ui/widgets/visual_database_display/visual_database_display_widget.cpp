@@ -7,6 +7,7 @@
 #include "../../../../game/filters/syntax_help.h"
 #include "../../../../settings/cache_settings.h"
 #include "../../../../utility/card_info_comparator.h"
+#include "../../picture_loader/picture_loader.h"
 #include "../../pixel_map_generator.h"
 #include "../cards/card_info_picture_with_text_overlay_widget.h"
 #include "../quick_settings/settings_button_widget.h"
@@ -96,13 +97,7 @@ VisualDatabaseDisplayWidget::VisualDatabaseDisplayWidget(QWidget *parent,
     clearFilterWidget->setFixedSize(32, 32);
     clearFilterWidget->setIcon(QPixmap("theme:icons/delete"));
     connect(clearFilterWidget, &QToolButton::clicked, this, [this] {
-        filterModel->blockSignals(true);
-        filterModel->filterTree()->blockSignals(true);
         filterModel->clear();
-        filterModel->blockSignals(false);
-        filterModel->filterTree()->blockSignals(false);
-        emit filterModel->filterTree()->changed();
-        emit filterModel->layoutChanged();
     });
 
     quickFilterSaveLoadWidget = new SettingsButtonWidget(this);
@@ -191,59 +186,85 @@ void VisualDatabaseDisplayWidget::onHover(const ExactCard &hoveredCard)
 void VisualDatabaseDisplayWidget::addCard(const ExactCard &cardToAdd)
 {
     cards->append(cardToAdd);
-    auto *display = new CardInfoPictureWithTextOverlayWidget(flowWidget, false);
-    display->setScaleFactor(cardSizeWidget->getSlider()->value());
+    CardInfoPictureWithTextOverlayWidget *display;
+    if (!unusedDisplays.isEmpty()) {
+        display = unusedDisplays.takeLast();
+    } else {
+        display = new CardInfoPictureWithTextOverlayWidget(flowWidget, false);
+        display->setScaleFactor(cardSizeWidget->getSlider()->value());
+        connect(display, &CardInfoPictureWithTextOverlayWidget::imageClicked, this,
+                &VisualDatabaseDisplayWidget::onClick);
+        connect(display, &CardInfoPictureWithTextOverlayWidget::hoveredOnCard, this,
+                &VisualDatabaseDisplayWidget::onHover);
+        connect(cardSizeWidget->getSlider(), &QSlider::valueChanged, display, &CardInfoPictureWidget::setScaleFactor);
+    }
     display->setCard(cardToAdd);
     flowWidget->addWidget(display);
-    connect(display, &CardInfoPictureWithTextOverlayWidget::imageClicked, this, &VisualDatabaseDisplayWidget::onClick);
-    connect(display, &CardInfoPictureWithTextOverlayWidget::hoveredOnCard, this, &VisualDatabaseDisplayWidget::onHover);
-    connect(cardSizeWidget->getSlider(), &QSlider::valueChanged, display, &CardInfoPictureWidget::setScaleFactor);
+    display->show();
 }
 
-void VisualDatabaseDisplayWidget::populateCards()
+/**
+ * Takes the cards out of the flow widget, keeping up to two pages of their widgets for the next cards.
+ */
+void VisualDatabaseDisplayWidget::clearCards()
 {
-    int rowCount = databaseDisplayModel->rowCount();
-    cards->clear();
-
-    // Calculate the start and end indices for the current page
-    int start = currentPage * cardsPerPage;
-    int end = qMin(start + cardsPerPage, rowCount);
-
-    qCDebug(VisualDatabaseDisplayLog) << "Fetching from " << start << " to " << end << " cards";
-    // Load more cards if we are at the end of the current list and can fetch more
-    if (end >= rowCount && databaseDisplayModel->canFetchMore(QModelIndex())) {
-        qCDebug(VisualDatabaseDisplayLog) << "We gotta load more";
-        databaseDisplayModel->fetchMore(QModelIndex());
+    QList<QWidget *> widgets;
+    for (int i = 0; i < flowWidget->count(); ++i) {
+        widgets.append(flowWidget->itemAt(i)->widget());
+    }
+    for (QWidget *widget : widgets) {
+        flowWidget->removeWidget(widget);
+        auto *display = qobject_cast<CardInfoPictureWithTextOverlayWidget *>(widget);
+        if (display && unusedDisplays.size() < 2 * cardsPerPage) {
+            display->hide();
+            unusedDisplays.append(display);
+        } else {
+            widget->deleteLater();
+        }
     }
+    cards->clear();
+}
 
+/**
+ * The cards shown for the rows of the display model from start to end, all printings of the filtered set if there is
+ * a single set filter, the preferred printing otherwise.
+ */
+QList<ExactCard> VisualDatabaseDisplayWidget::cardsOfRows(int start, int end) const
+{
     QList<const CardFilter *> setFilters = filterModel->getFiltersOfType(CardFilter::AttrSet);
     const CardFilter *setFilter = nullptr;
     if (setFilters.length() == 1) {
         setFilter = setFilters.at(0);
     }
 
+    QList<ExactCard> rowCards;
     for (int row = start; row < end; ++row) {
-        qCDebug(VisualDatabaseDisplayLog) << "Adding " << row;
-        QModelIndex index = databaseDisplayModel->index(row, CardDatabaseModel::NameColumn);
-        QVariant name = databaseDisplayModel->data(index, Qt::DisplayRole);
-        qCDebug(VisualDatabaseDisplayLog) << name.toString();
-
-        if (CardInfoPtr info = CardDatabaseManager::getInstance()->getCardInfo(name.toString())) {
-            if (setFilter) {
-                SetToPrintingsMap setMap = info->getSets();
-                if (setMap.contains(setFilter->term())) {
-                    for (PrintingInfo printing : setMap[setFilter->term()]) {
-                        addCard(ExactCard(info, printing));
-                    }
+        const QModelIndex sourceIndex = databaseDisplayModel->mapToSource(databaseDisplayModel->index(row, 0));
+        CardInfoPtr info = sourceIndex.isValid() ? databaseModel->getCard(sourceIndex.row()) : CardInfoPtr();
+        if (!info) {
+            qCDebug(VisualDatabaseDisplayLog) << "Card of row" << row << "not found in database!";
+            continue;
+        }
+
+        if (setFilter) {
+            const SetToPrintingsMap &setMap = info->getSets();
+            const auto printings = setMap.constFind(setFilter->term());
+            if (printings != setMap.constEnd()) {
+                for (const PrintingInfo &printing : *printings) {
+                    rowCards.append(ExactCard(info, printing));
                 }
-            } else {
-                addCard(CardDatabaseManager::getInstance()->getPreferredCard(info));
             }
         } else {
-            qCDebug(VisualDatabaseDisplayLog) << "Card not found in database!";
+            rowCards.append(CardDatabaseManager::getInstance()->getPreferredCard(info));
         }
     }
-    currentPage++;
+    return rowCards;
+}
+
+void VisualDatabaseDisplayWidget::populateCards()
+{
+    clearCards();
+    loadNextPage();
 }
 
 void VisualDatabaseDisplayWidget::updateSearch(const QString &search) const
@@ -258,8 +279,7 @@ void VisualDatabaseDisplayWidget::updateSearch(const QString &search) const
 void VisualDatabaseDisplayWidget::searchModelChanged()
 {
     // Clear the current page and prepare for new data
-    flowWidget->clearLayout(); // Clear existing cards
-    cards->clear();            // Clear the card list
+    clearCards();
     // Reset scrollbar position to the top after loading new cards
     if (QScrollBar *scrollBar = flowWidget->scrollArea->verticalScrollBar()) {
         scrollBar->setValue(0); // Reset scrollbar to top
@@ -277,40 +297,25 @@ void VisualDatabaseDisplayWidget::loadNextPage()
     int start = currentPage * cardsPerPage;
     int end = qMin(start + cardsPerPage, rowCount);
 
+    qCDebug(VisualDatabaseDisplayLog) << "Fetching from " << start << " to " << end << " cards";
     // Load more cards if we are at the end of the current list and can fetch more
     if (end >= rowCount && databaseDisplayModel->canFetchMore(QModelIndex())) {
         databaseDisplayModel->fetchMore(QModelIndex());
+        rowCount = databaseDisplayModel->rowCount();
     }
 
-    // Load the next page of cards and add them to the flow widget
-
-    QList<const CardFilter *> setFilters = filterModel->getFiltersOfType(CardFilter::AttrSet);
-    const CardFilter *setFilter = nullptr;
-    if (setFilters.length() == 1) {
-        setFilter = setFilters.at(0);
-    }
-
-    for (int row = start; row < end; ++row) {
-        QModelIndex index = databaseDisplayModel->index(row, CardDatabaseModel::NameColumn);
-        QVariant name = databaseDisplayModel->data(index, Qt::DisplayRole);
-        if (CardInfoPtr info = CardDatabaseManager::getInstance()->getCardInfo(name.toString())) {
-            if (setFilter) {
-                SetToPrintingsMap setMap = info->getSets();
-                if (setMap.contains(setFilter->term())) {
-                    for (PrintingInfo printing : setMap[setFilter->term()]) {
-                        addCard(ExactCard(info, printing));
-                    }
-                }
-            } else {
-                addCard(CardDatabaseManager::getInstance()->getPreferredCard(info));
-            }
-        } else {
-            qCDebug(VisualDatabaseDisplayLog) << "Card " << name.toString() << " not found in database!";
-        }
+    for (const ExactCard &card : cardsOfRows(start, end)) {
+        addCard(card);
     }
 
     // Update the current page
     currentPage++;
+
+    // the images of the page after this one are loaded in the background, so scrolling to it doesn't wait for them
+    const int nextEnd = qMin(end + cardsPerPage, rowCount);
+    if (end < nextEnd) {
+        PictureLoader::cacheCardPixmaps(cardsOfRows(end, nextEnd));
+    }
 }
 
 void VisualDatabaseDisplayWidget::loadCurrentPage()
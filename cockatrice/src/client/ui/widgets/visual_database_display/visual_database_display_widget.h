@@ -88,6 +88,8 @@ private:
     CardDatabaseDisplayModel *databaseDisplayModel;
     QTreeView *databaseView;
     QList<ExactCard> *cards;
+    // the card widgets of the cleared pages, shown again for the next cards instead of creating new ones
+    QList<CardInfoPictureWithTextOverlayWidget *> unusedDisplays;
     QVBoxLayout *mainLayout;
     QScrollArea *scrollArea;
     FlowWidget *flowWidget;
@@ -102,6 +104,9 @@ private:
     int currentPage = 0;    // Current page index
     int cardsPerPage = 100; // Number of cards per page
 
+    void clearCards();
+    QList<ExactCard> cardsOfRows(int start, int end) const;
+
 protected:
     void resizeEvent(QResizeEvent *event) override;
 };
@@ -48,10 +48,15 @@ void DeckPreviewDeckTagsDisplayWidget::connectDeckList(DeckList *_deckList)
 }
 
 void DeckPreviewDeckTagsDisplayWidget::refreshTags()
+{
+    setTags(deckList->getTags());
+}
+
+void DeckPreviewDeckTagsDisplayWidget::setTags(const QStringList &tags)
 {
     flowWidget->clearLayout();
 
-    for (const QString &tag : deckList->getTags()) {
+    for (const QString &tag : tags) {
         flowWidget->addWidget(new DeckPreviewTagDisplayWidget(this, tag));
     }
 
@@ -97,6 +102,14 @@ void DeckPreviewDeckTagsDisplayWidget::openTagEditDlg()
 {
     if (qobject_cast<DeckPreviewWidget *>(parentWidget())) {
         auto *deckPreviewWidget = qobject_cast<DeckPreviewWidget *>(parentWidget());
+        DeckLoader *deckLoader = deckPreviewWidget->getDeckLoader();
+        if (!deckLoader) {
+            return;
+        }
+        if (deckList != deckLoader) {
+            connectDeckList(deckLoader);
+        }
+
         QStringList knownTags = deckPreviewWidget->visualDeckStorageWidget->tagFilterWidget->getAllKnownTags();
         QStringList activeTags = deckList->getTags();
 
@@ -111,8 +124,9 @@ void DeckPreviewDeckTagsDisplayWidget::openTagEditDlg()
                     if (!confirmOverwriteIfExists(this, deckPreviewWidget->filePath))
                         return;
 
-                    deckPreviewWidget->deckLoader->convertToCockatriceFormat(deckPreviewWidget->filePath);
-                    deckPreviewWidget->filePath = deckPreviewWidget->deckLoader->getLastFileName();
+                    deckLoader->convertToCockatriceFormat(deckPreviewWidget->filePath);
+                    deckPreviewWidget->filePath = deckLoader->getLastFileName();
+                    deckPreviewWidget->updateMetadata();
                     deckPreviewWidget->refreshBannerCardText();
                     canAddTags = true;
                 }
@@ -124,8 +138,9 @@ void DeckPreviewDeckTagsDisplayWidget::openTagEditDlg()
                     if (!confirmOverwriteIfExists(this, deckPreviewWidget->filePath))
                         return;
 
-                    deckPreviewWidget->deckLoader->convertToCockatriceFormat(deckPreviewWidget->filePath);
-                    deckPreviewWidget->filePath = deckPreviewWidget->deckLoader->getLastFileName();
+                    deckLoader->convertToCockatriceFormat(deckPreviewWidget->filePath);
+                    deckPreviewWidget->filePath = deckLoader->getLastFileName();
+                    deckPreviewWidget->updateMetadata();
                     deckPreviewWidget->refreshBannerCardText();
                     canAddTags = true;
 
@@ -150,7 +165,8 @@ void DeckPreviewDeckTagsDisplayWidget::openTagEditDlg()
             if (dialog.exec() == QDialog::Accepted) {
                 QStringList updatedTags = dialog.getActiveTags();
                 deckList->setTags(updatedTags);
-                deckPreviewWidget->deckLoader->saveToFile(deckPreviewWidget->filePath, DeckLoader::CockatriceFormat);
+                deckLoader->saveToFile(deckPreviewWidget->filePath, DeckLoader::CockatriceFormat);
+                deckPreviewWidget->updateMetadata();
             }
         }
     } else if (parentWidget()) {
@@ -169,9 +185,14 @@ void DeckPreviewDeckTagsDisplayWidget::openTagEditDlg()
             QStringList allFiles = getAllFiles(SettingsCache::instance().getDeckPath());
             DeckLoader loader;
             for (const QString &file : allFiles) {
-                loader.loadFromFile(file, DeckLoader::getFormatFromName(file), false);
-                QStringList tags = loader.getTags();
-                knownTags.append(tags);
+                DeckMetadata metadata;
+                if (!DeckMetadataIndex::instance().lookup(file, metadata)) {
+                    if (!loader.loadFromFile(file, DeckLoader::getFormatFromName(file), false)) {
+                        continue;
+                    }
+                    metadata = DeckMetadataIndex::instance().update(file, loader);
+                }
+                knownTags.append(metadata.tags);
                 knownTags.removeDuplicates();
             }
 
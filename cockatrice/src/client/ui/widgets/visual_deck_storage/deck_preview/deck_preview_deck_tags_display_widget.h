@@ -17,6 +17,7 @@ public:
     explicit DeckPreviewDeckTagsDisplayWidget(QWidget *_parent, DeckList *_deckList);
     void connectDeckList(DeckList *_deckList);
     void refreshTags();
+    void setTags(const QStringList &tags);
     DeckList *deckList;
     FlowWidget *flowWidget;
 
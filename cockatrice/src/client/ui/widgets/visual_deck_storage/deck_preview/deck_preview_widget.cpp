@@ -27,12 +27,6 @@ DeckPreviewWidget::DeckPreviewWidget(QWidget *_parent,
 
     deckLoader = new DeckLoader();
     deckLoader->setParent(this);
-    connect(deckLoader, &DeckLoader::loadFinished, this, &DeckPreviewWidget::initializeUi);
-    /* TODO: We shouldn't update the tags on *every* deck load, since it's kinda expensive. We should instead count how
-     many deck loads have finished already and if we've loaded all decks and THEN load all the tags at once. */
-    connect(deckLoader, &DeckLoader::loadFinished, visualDeckStorageWidget->tagFilterWidget,
-            &VisualDeckStorageTagFilterWidget::refreshTags);
-    deckLoader->loadFromFileAsync(filePath, DeckLoader::getFormatFromName(filePath), false);
 
     bannerCardDisplayWidget =
         new DeckPreviewCardPictureWidget(this, false, visualDeckStorageWidget->deckPreviewSelectionAnimationEnabled);
@@ -50,6 +44,43 @@ DeckPreviewWidget::DeckPreviewWidget(QWidget *_parent,
             &DeckPreviewWidget::refreshBannerCardToolTip);
 
     layout->addWidget(bannerCardDisplayWidget);
+
+    if (DeckMetadataIndex::instance().lookup(filePath, metadata)) {
+        initializeUi(true);
+        return;
+    }
+
+    connect(deckLoader, &DeckLoader::loadFinished, this, &DeckPreviewWidget::deckLoadFinished);
+    /* TODO: We shouldn't update the tags on *every* deck load, since it's kinda expensive. We should instead count how
+     many deck loads have finished already and if we've loaded all decks and THEN load all the tags at once. */
+    connect(deckLoader, &DeckLoader::loadFinished, visualDeckStorageWidget->tagFilterWidget,
+            &VisualDeckStorageTagFilterWidget::refreshTags);
+    deckLoading = true;
+    deckLoader->loadFromFileAsync(filePath, DeckLoader::getFormatFromName(filePath), false);
+}
+
+void DeckPreviewWidget::deckLoadFinished(const bool success)
+{
+    deckLoading = false;
+    if (success) {
+        deckLoaded = true;
+        setFilePath(deckLoader->getLastFileName());
+        updateMetadata();
+    }
+    initializeUi(success);
+}
+
+DeckLoader *DeckPreviewWidget::getDeckLoader()
+{
+    if (!deckLoaded && !deckLoading) {
+        deckLoaded = deckLoader->loadFromFile(filePath, DeckLoader::getFormatFromName(filePath), false);
+    }
+    return deckLoaded ? deckLoader : nullptr;
+}
+
+void DeckPreviewWidget::updateMetadata()
+{
+    metadata = DeckMetadataIndex::instance().update(filePath, *deckLoader);
 }
 
 void DeckPreviewWidget::retranslateUi()
@@ -74,23 +105,23 @@ void DeckPreviewWidget::initializeUi(const bool deckLoadSuccess)
     if (!deckLoadSuccess) {
         return;
     }
-    auto bannerCard = deckLoader->getBannerCard().name.isEmpty()
+    auto bannerCard = metadata.bannerCard.name.isEmpty()
                           ? ExactCard()
-                          : CardDatabaseManager::getInstance()->getCard(deckLoader->getBannerCard());
+                          : CardDatabaseManager::getInstance()->getCard(metadata.bannerCard);
 
     bannerCardDisplayWidget->setCard(bannerCard);
     bannerCardDisplayWidget->setFontSize(24);
-    setFilePath(deckLoader->getLastFileName());
 
     colorIdentityWidget = new ColorIdentityWidget(this, getColorIdentity());
-    deckTagsDisplayWidget = new DeckPreviewDeckTagsDisplayWidget(this, deckLoader);
+    deckTagsDisplayWidget = new DeckPreviewDeckTagsDisplayWidget(this, nullptr);
+    deckTagsDisplayWidget->setTags(metadata.tags);
 
     bannerCardLabel = new QLabel(this);
     bannerCardLabel->setObjectName("bannerCardLabel");
     bannerCardComboBox = new QComboBox(this);
     bannerCardComboBox->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Minimum);
     bannerCardComboBox->setObjectName("bannerCardComboBox");
-    bannerCardComboBox->setCurrentText(deckLoader->getBannerCard().name);
+    bannerCardComboBox->setCurrentText(metadata.bannerCard.name);
     bannerCardComboBox->installEventFilter(new NoScrollFilter());
     connect(bannerCardComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
             &DeckPreviewWidget::setBannerCard);
@@ -150,35 +181,9 @@ void DeckPreviewWidget::updateTagsVisibility(bool visible)
     }
 }
 
-QString DeckPreviewWidget::getColorIdentity()
+QString DeckPreviewWidget::getColorIdentity() const
 {
-    QStringList cardList = deckLoader->getCardList();
-    if (cardList.isEmpty()) {
-        return {};
-    }
-
-    QSet<QChar> colorSet; // A set to collect unique color symbols (e.g., W, U, B, R, G)
-
-    for (const QString &cardName : cardList) {
-        CardInfoPtr currentCard = CardDatabaseManager::getInstance()->getCardInfo(cardName);
-        if (currentCard) {
-            QString colors = currentCard->getColors(); // Assuming this returns something like "WUB"
-            for (const QChar &color : colors) {
-                colorSet.insert(color);
-            }
-        }
-    }
-
-    // Ensure the color identity is in WUBRG order
-    QString colorIdentity;
-    const QString wubrgOrder = "WUBRG";
-    for (const QChar &color : wubrgOrder) {
-        if (colorSet.contains(color)) {
-            colorIdentity.append(color);
-        }
-    }
-
-    return colorIdentity;
+    return metadata.colorIdentity;
 }
 
 /**
@@ -186,8 +191,7 @@ QString DeckPreviewWidget::getColorIdentity()
  */
 QString DeckPreviewWidget::getDisplayName() const
 {
-    return deckLoader->getName().isEmpty() ? QFileInfo(deckLoader->getLastFileName()).fileName()
-                                           : deckLoader->getName();
+    return metadata.name.isEmpty() ? QFileInfo(filePath).fileName() : metadata.name;
 }
 
 void DeckPreviewWidget::setFilePath(const QString &_filePath)
@@ -233,18 +237,8 @@ void DeckPreviewWidget::updateBannerCardComboBox()
 
     // Prepare the new items with deduplication
     QSet<QPair<QString, QString>> bannerCardSet;
-    InnerDecklistNode *listRoot = deckLoader->getRoot();
-    for (auto i : *listRoot) {
-        auto *currentZone = dynamic_cast<InnerDecklistNode *>(i);
-        for (auto j : *currentZone) {
-            auto *currentCard = dynamic_cast<DecklistCardNode *>(j);
-            if (!currentCard)
-                continue;
-
-            for (int k = 0; k < currentCard->getNumber(); ++k) {
-                bannerCardSet.insert(QPair<QString, QString>(currentCard->getName(), currentCard->getCardProviderId()));
-            }
-        }
+    for (const DeckMetadata::Card &card : metadata.cards) {
+        bannerCardSet.insert(QPair<QString, QString>(card.cardRef.name, card.cardRef.providerId));
     }
 
     QList<QPair<QString, QString>> pairList = bannerCardSet.values();
@@ -273,7 +267,7 @@ void DeckPreviewWidget::updateBannerCardComboBox()
         bannerCardComboBox->setCurrentIndex(restoredIndex);
     } else {
         // Add a placeholder "-" and set it as the current selection
-        int bannerIndex = bannerCardComboBox->findText(deckLoader->getBannerCard().name);
+        int bannerIndex = bannerCardComboBox->findText(metadata.bannerCard.name);
         if (bannerIndex != -1) {
             bannerCardComboBox->setCurrentIndex(bannerIndex);
         } else {
@@ -291,8 +285,13 @@ void DeckPreviewWidget::setBannerCard(int /* changedIndex */)
 {
     auto [name, id] = bannerCardComboBox->currentData().value<QPair<QString, QString>>();
     CardRef cardRef = {name, id};
-    deckLoader->setBannerCard(cardRef);
-    deckLoader->saveToFile(filePath, DeckLoader::getFormatFromName(filePath));
+    DeckLoader *deck = getDeckLoader();
+    if (!deck) {
+        return;
+    }
+    deck->setBannerCard(cardRef);
+    deck->saveToFile(filePath, DeckLoader::getFormatFromName(filePath));
+    updateMetadata();
     bannerCardDisplayWidget->setCard(CardDatabaseManager::getInstance()->getCard(cardRef));
 }
 
@@ -318,7 +317,11 @@ QMenu *DeckPreviewWidget::createRightClickMenu()
     menu->setAttribute(Qt::WA_DeleteOnClose);
 
     connect(menu->addAction(tr("Open in deck editor")), &QAction::triggered, this,
-            [this] { emit openDeckEditor(deckLoader); });
+            [this] {
+                if (DeckLoader *deck = getDeckLoader()) {
+                    emit openDeckEditor(deck);
+                }
+            });
 
     connect(menu->addAction(tr("Edit Tags")), &QAction::triggered, deckTagsDisplayWidget,
             &DeckPreviewDeckTagsDisplayWidget::openTagEditDlg);
@@ -332,13 +335,13 @@ QMenu *DeckPreviewWidget::createRightClickMenu()
     auto saveToClipboardMenu = menu->addMenu(tr("Save Deck to Clipboard"));
 
     connect(saveToClipboardMenu->addAction(tr("Annotated")), &QAction::triggered, this,
-            [this] { deckLoader->saveToClipboard(true, true); });
+            [this] { saveToClipboard(true, true); });
     connect(saveToClipboardMenu->addAction(tr("Annotated (No set info)")), &QAction::triggered, this,
-            [this] { deckLoader->saveToClipboard(true, false); });
+            [this] { saveToClipboard(true, false); });
     connect(saveToClipboardMenu->addAction(tr("Not Annotated")), &QAction::triggered, this,
-            [this] { deckLoader->saveToClipboard(false, true); });
+            [this] { saveToClipboard(false, true); });
     connect(saveToClipboardMenu->addAction(tr("Not Annotated (No set info)")), &QAction::triggered, this,
-            [this] { deckLoader->saveToClipboard(false, false); });
+            [this] { saveToClipboard(false, false); });
 
     menu->addSeparator();
 
@@ -371,10 +374,17 @@ void DeckPreviewWidget::addSetBannerCardMenu(QMenu *menu)
     }
 }
 
+void DeckPreviewWidget::saveToClipboard(bool addComments, bool addSetNameAndNumber)
+{
+    if (DeckLoader *deck = getDeckLoader()) {
+        deck->saveToClipboard(addComments, addSetNameAndNumber);
+    }
+}
+
 void DeckPreviewWidget::actRenameDeck()
 {
     // read input
-    const QString oldName = deckLoader->getName();
+    const QString oldName = metadata.name;
 
     bool ok;
     QString newName = QInputDialog::getText(this, "Rename deck", tr("New name:"), QLineEdit::Normal, oldName, &ok);
@@ -382,9 +392,15 @@ void DeckPreviewWidget::actRenameDeck()
         return;
     }
 
+    DeckLoader *deck = getDeckLoader();
+    if (!deck) {
+        return;
+    }
+
     // write change
-    deckLoader->setName(newName);
-    deckLoader->saveToFile(filePath, DeckLoader::getFormatFromName(filePath));
+    deck->setName(newName);
+    deck->saveToFile(filePath, DeckLoader::getFormatFromName(filePath));
+    updateMetadata();
 
     // update VDS
     refreshBannerCardText();
@@ -415,6 +431,7 @@ void DeckPreviewWidget::actRenameFile()
     }
 
     deckLoader->setLastFileName(newFilePath);
+    DeckMetadataIndex::instance().rename(filePath, newFilePath);
 
     // update VDS
     setFilePath(newFilePath);
@@ -435,6 +452,7 @@ void DeckPreviewWidget::actDeleteFile()
         QMessageBox::critical(this, tr("Error"), tr("Delete failed"));
         return;
     }
+    DeckMetadataIndex::instance().remove(filePath);
 
     // update VDS
     this->deleteLater();
@@ -2,6 +2,7 @@
 #define DECK_PREVIEW_WIDGET_H
 
 #include "../../../../../deck/deck_loader.h"
+#include "../../../../../deck/deck_metadata_index.h"
 #include "../../cards/additional_info/color_identity_widget.h"
 #include "../../cards/deck_preview_card_picture_widget.h"
 #include "../visual_deck_storage_widget.h"
@@ -26,13 +27,25 @@ public:
                                VisualDeckStorageWidget *_visualDeckStorageWidget,
                                const QString &_filePath);
     void retranslateUi();
-    QString getColorIdentity();
+    QString getColorIdentity() const;
     QString getDisplayName() const;
+    const DeckMetadata &getMetadata() const
+    {
+        return metadata;
+    }
+    /**
+     * The full deck, which is only parsed from the file the first time it is needed if the preview was shown from the
+     * deck metadata index. Returns nullptr if the deck couldn't be loaded, or is still loading.
+     */
+    DeckLoader *getDeckLoader();
+    /**
+     * Updates the metadata, and the index, after the deck was changed and saved.
+     */
+    void updateMetadata();
 
     VisualDeckStorageWidget *visualDeckStorageWidget;
     QVBoxLayout *layout;
     QString filePath;
-    DeckLoader *deckLoader;
     DeckPreviewCardPictureWidget *bannerCardDisplayWidget = nullptr;
     ColorIdentityWidget *colorIdentityWidget = nullptr;
     DeckPreviewDeckTagsDisplayWidget *deckTagsDisplayWidget = nullptr;
@@ -62,10 +75,18 @@ public slots:
     void resizeEvent(QResizeEvent *event) override;
 
 private:
+    DeckLoader *deckLoader;
+    // whether deckLoader holds the deck, or is loading it
+    bool deckLoaded = false;
+    bool deckLoading = false;
+    DeckMetadata metadata;
+
     QMenu *createRightClickMenu();
+    void saveToClipboard(bool addComments, bool addSetNameAndNumber);
     void addSetBannerCardMenu(QMenu *menu);
 
 private slots:
+    void deckLoadFinished(bool success);
     void actRenameDeck();
     void actRenameFile();
     void actDeleteFile();
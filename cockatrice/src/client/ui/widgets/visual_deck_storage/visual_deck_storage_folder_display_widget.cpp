@@ -210,7 +210,7 @@ QStringList VisualDeckStorageFolderDisplayWidget::gatherAllTagsFromFlowWidget()
         // Iterate through all DeckPreviewWidgets
         for (DeckPreviewWidget *display : flowWidget->findChildren<DeckPreviewWidget *>()) {
             // Get tags from each DeckPreviewWidget
-            QStringList tags = display->deckLoader->getTags();
+            QStringList tags = display->getMetadata().tags;
 
             // Add tags to the list while avoiding duplicates
             allTags.append(tags);
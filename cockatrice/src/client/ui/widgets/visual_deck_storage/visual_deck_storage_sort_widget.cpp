@@ -70,13 +70,11 @@ void VisualDeckStorageSortWidget::sortFolder(VisualDeckStorageFolderDisplayWidge
     for (auto widget : children) {
         auto deckPreviewWidgets =
             widget->findChildren<DeckPreviewWidget *>(QString(), Qt::FindChildOption::FindDirectChildrenOnly);
-        auto newOrder = filterFiles(deckPreviewWidgets);
-        for (DeckPreviewWidget *previewWidget : newOrder) {
-            folderWidget->getFlowWidget()->removeWidget(previewWidget);
-        }
-        for (DeckPreviewWidget *previewWidget : newOrder) {
-            folderWidget->getFlowWidget()->addWidget(previewWidget);
+        QList<QWidget *> newOrder;
+        for (DeckPreviewWidget *previewWidget : filterFiles(deckPreviewWidgets)) {
+            newOrder.append(previewWidget);
         }
+        folderWidget->getFlowWidget()->moveWidgetsToEnd(newOrder);
     }
 }
 
@@ -93,14 +91,14 @@ QList<DeckPreviewWidget *> VisualDeckStorageSortWidget::filterFiles(QList<DeckPr
 
         switch (sortOrder) {
             case ByName:
-                return widget1->deckLoader->getName() < widget2->deckLoader->getName();
+                return widget1->getMetadata().name < widget2->getMetadata().name;
             case Alphabetical:
                 return QString::localeAwareCompare(info1.fileName(), info2.fileName()) <= 0;
             case ByLastModified:
                 return info1.lastModified() > info2.lastModified();
             case ByLastLoaded: {
-                QDateTime time1 = QDateTime::fromString(widget1->deckLoader->getLastLoadedTimestamp());
-                QDateTime time2 = QDateTime::fromString(widget2->deckLoader->getLastLoadedTimestamp());
+                QDateTime time1 = QDateTime::fromString(widget1->getMetadata().lastLoadedTimestamp);
+                QDateTime time2 = QDateTime::fromString(widget2->getMetadata().lastLoadedTimestamp);
                 return time1 > time2;
             }
         }
@@ -135,10 +135,18 @@ const VisualDeckStorageQuickSettingsWidget *VisualDeckStorageWidget::settings()
  */
 void VisualDeckStorageWidget::reapplySortAndFilters()
 {
+    // the decks shown from the metadata index don't load, so their tags have to be gathered here
+    tagFilterWidget->refreshTags();
     updateSortOrder();
-    updateTagFilter();
-    updateColorFilter();
-    updateSearchFilter();
+
+    // each filter only sets the flags of the decks, the folders are laid out again once they all ran
+    if (folderWidget) {
+        const QList<DeckPreviewWidget *> deckPreviewWidgets = folderWidget->findChildren<DeckPreviewWidget *>();
+        tagFilterWidget->filterDecksBySelectedTags(deckPreviewWidgets);
+        deckPreviewColorIdentityFilterWidget->filterWidgets(deckPreviewWidgets);
+        searchWidget->filterWidgets(deckPreviewWidgets, searchWidget->getSearchText());
+        folderWidget->updateVisibility();
+    }
 }
 
 void VisualDeckStorageWidget::createRootFolderWidget()
@@ -40,6 +40,7 @@
 #include "../../server/remote/remote_client.h"
 #include "../../settings/cache_settings.h"
 #include "../../utility/logger.h"
+#include "../../utility/startup_trace.h"
 #include "../get_text_with_max.h"
 #include "../network/client_update_checker.h"
 #include "../network/release_channel.h"
@@ -47,8 +48,8 @@
 #include "../tabs/tab_supervisor.h"
 #include "pb/event_connection_closed.pb.h"
 #include "pb/event_server_shutdown.pb.h"
-#include "pb/game_replay.pb.h"
 #include "pb/room_commands.pb.h"
+#include "replay_file.h"
 #include "version_string.h"
 
 #include <QAction>
@@ -277,10 +278,9 @@ void MainWindow::actWatchReplay()
     QByteArray buf = file.readAll();
     file.close();
 
-    replay = new GameReplay;
-    replay->ParseFromArray(buf.data(), buf.size());
-
-    tabSupervisor->openReplay(replay);
+    replay = ReplayFile::fromData(buf);
+    if (replay)
+        tabSupervisor->openReplay(replay);
 }
 
 void MainWindow::localGameEnded()
@@ -904,6 +904,8 @@ MainWindow::MainWindow(QWidget *parent)
 
     connect(CardDatabaseManager::getInstance(), &CardDatabase::cardDatabaseLoadingFailed, this,
             &MainWindow::cardDatabaseLoadingFailed);
+    connect(CardDatabaseManager::getInstance(), &CardDatabase::cardDatabaseLoadingProgress, this,
+            &MainWindow::cardDatabaseLoadingProgress);
     connect(CardDatabaseManager::getInstance(), &CardDatabase::cardDatabaseNewSetsFound, this,
             &MainWindow::cardDatabaseNewSetsFound);
     connect(CardDatabaseManager::getInstance(), &CardDatabase::cardDatabaseAllNewSetsEnabled, this,
@@ -940,7 +942,10 @@ void MainWindow::startupConfigCheck()
         if (SettingsCache::instance().getNotifyAboutNewVersion()) {
             alertForcedOracleRun(VERSION_STRING, true);
         } else {
-            const auto reloadOk0 = QtConcurrent::run([] { CardDatabaseManager::getInstance()->loadCardDatabases(); });
+            const auto reloadOk0 = QtConcurrent::run([] {
+                StartupTrace::Scope phase("Card database");
+                CardDatabaseManager::getInstance()->loadCardDatabases();
+            });
         }
 
         qCInfo(WindowMainStartupShortcutsLog) << "[MainWindow] Migrating shortcuts after update detected.";
@@ -951,6 +956,12 @@ void MainWindow::startupConfigCheck()
         // previous config from this version found
         qCInfo(WindowMainStartupVersionLog) << "Startup: found config with current version";
 
+        // loads while the card update check asks, it only needs the settings
+        const auto reloadOk1 = QtConcurrent::run([] {
+            StartupTrace::Scope phase("Card database");
+            CardDatabaseManager::getInstance()->loadCardDatabases();
+        });
+
         if (SettingsCache::instance().getCardUpdateCheckRequired()) {
             if (SettingsCache::instance().getStartupCardUpdateCheckPromptForUpdate()) {
                 auto startupCardCheckDialog = new DlgStartupCardCheck(this);
@@ -981,8 +992,6 @@ void MainWindow::startupConfigCheck()
             }
         }
 
-        const auto reloadOk1 = QtConcurrent::run([] { CardDatabaseManager::getInstance()->loadCardDatabases(); });
-
         // Run the tips dialog only on subsequent startups.
         // On the first run after an install/update the startup is already crowded enough
         if (tip->successfulInit && SettingsCache::instance().getShowTipsOnStartup() && tip->newTipsAvailable) {
@@ -1121,6 +1130,15 @@ void MainWindow::showWindowIfHidden()
     show();
 }
 
+void MainWindow::cardDatabaseLoadingProgress(int parsedFiles, int totalFiles)
+{
+    if (parsedFiles < totalFiles) {
+        statusBar()->showMessage(tr("Loading card database (%1/%2 files)...").arg(parsedFiles).arg(totalFiles));
+    } else {
+        statusBar()->clearMessage();
+    }
+}
+
 void MainWindow::cardDatabaseLoadingFailed()
 {
     if (askedForDbUpdater) {
@@ -1168,7 +1186,7 @@ void MainWindow::cardDatabaseNewSetsFound(int numUnknownSets, QStringList unknow
 
     if (msgBox.clickedButton() == yesButton) {
         CardDatabaseManager::getInstance()->enableAllUnknownSets();
-        const auto reloadOk1 = QtConcurrent::run([] { CardDatabaseManager::getInstance()->loadCardDatabases(); });
+        CardDatabaseManager::getInstance()->reloadCardDatabasesInBackground();
     } else if (msgBox.clickedButton() == noButton) {
         CardDatabaseManager::getInstance()->markAllSetsAsKnown();
     } else if (msgBox.clickedButton() == settingsButton) {
@@ -1275,7 +1293,7 @@ void MainWindow::exitCardDatabaseUpdate()
     cardUpdateProcess = nullptr;
     statusBar()->clearMessage();
 
-    const auto reloadOk1 = QtConcurrent::run([] { CardDatabaseManager::getInstance()->loadCardDatabases(); });
+    CardDatabaseManager::getInstance()->reloadCardDatabasesInBackground();
 }
 
 void MainWindow::cardUpdateError(QProcess::ProcessError err)
@@ -1426,7 +1444,7 @@ void MainWindow::actAddCustomSet()
         QMessageBox::information(
             this, tr("Load sets/cards"),
             tr("The new sets/cards have been added successfully.\nCockatrice will now reload the card database."));
-        const auto reloadOk1 = QtConcurrent::run([] { CardDatabaseManager::getInstance()->loadCardDatabases(); });
+        CardDatabaseManager::getInstance()->reloadCardDatabasesInBackground();
     } else {
         QMessageBox::warning(this, tr("Load sets/cards"), tr("Sets/cards failed to import."));
     }
@@ -1449,10 +1467,8 @@ int MainWindow::getNextCustomSetPrefix(QDir dataDir)
 
 void MainWindow::actReloadCardDatabase()
 {
-    const auto reloadOk1 = QtConcurrent::run([] {
-        CardDatabaseManager::getInstance()->loadCardDatabases();
-        SettingsCache::instance().downloads().sync();
-    });
+    SettingsCache::instance().downloads().sync();
+    CardDatabaseManager::getInstance()->reloadCardDatabasesInBackground();
 }
 
 void MainWindow::actManageSets()
@@ -40,12 +40,12 @@ inline Q_LOGGING_CATEGORY(WindowMainStartupAutoconnectLog, "window_main.startup.
 class Release;
 class DlgConnect;
 class DlgViewLog;
-class GameReplay;
 class HandlePublicServers;
 class LocalClient;
 class LocalServer;
 class QThread;
 class RemoteClient;
+class ReplayFile;
 class ServerInfo_User;
 class TabSupervisor;
 class WndSets;
@@ -101,6 +101,7 @@ private slots:
     void cardUpdateError(QProcess::ProcessError err);
     void cardUpdateFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void refreshShortcuts();
+    void cardDatabaseLoadingProgress(int parsedFiles, int totalFiles);
     void cardDatabaseLoadingFailed();
     void cardDatabaseNewSetsFound(int numUnknownSets, QStringList unknownSetsNames);
     void cardDatabaseAllNewSetsEnabled();
@@ -156,7 +157,7 @@ private:
     QProcess *cardUpdateProcess;
     DlgViewLog *logviewDialog;
     DlgConnect *dlgConnect;
-    GameReplay *replay;
+    ReplayFile *replay;
     DlgTipOfTheDay *tip;
     QUrl connectTo;
 
@@ -281,8 +281,6 @@ bool DeckListModel::setData(const QModelIndex &index, const QVariant &value, con
 
     emitRecursiveUpdates(index);
     deckList->refreshDeckHash();
-
-    emit dataChanged(index, index);
     return true;
 }
 
@@ -390,13 +388,16 @@ QModelIndex DeckListModel::addCard(const ExactCard &card, const QString &zoneNam
         return {};
     }
 
+    const int zoneCount = root->size();
     InnerDecklistNode *zoneNode = createNodeIfNeeded(zoneName, root);
 
     CardInfoPtr cardInfo = card.getCardPtr();
     PrintingInfo printingInfo = card.getPrinting();
 
     QString groupCriteria = getGroupCriteriaForCard(cardInfo);
+    const int groupCount = zoneNode->size();
     InnerDecklistNode *groupNode = createNodeIfNeeded(groupCriteria, zoneNode);
+    const bool groupAdded = root->size() != zoneCount || zoneNode->size() != groupCount;
 
     const QModelIndex parentIndex = nodeToIndex(groupNode);
     auto *cardNode = dynamic_cast<DecklistModelCardNode *>(groupNode->findCardChildByNameProviderIdAndNumber(
@@ -413,6 +414,13 @@ QModelIndex DeckListModel::addCard(const ExactCard &card, const QString &zoneNam
         beginInsertRows(parentIndex, insertRow, insertRow);
         cardNode = new DecklistModelCardNode(decklistCard, groupNode, insertRow);
         endInsertRows();
+
+        // only the new rows can be out of place, the rest of the tree is sorted already
+        if (groupAdded) {
+            sort(lastKnownColumn, lastKnownOrder);
+        } else {
+            sortGroup(groupNode);
+        }
     } else {
         cardNode->setNumber(cardNode->getNumber() + 1);
         cardNode->setCardSetShortName(cardSetName);
@@ -420,7 +428,6 @@ QModelIndex DeckListModel::addCard(const ExactCard &card, const QString &zoneNam
         cardNode->setCardProviderId(printingInfo.getProperty("uuid"));
         deckList->refreshDeckHash();
     }
-    sort(lastKnownColumn, lastKnownOrder);
     emitRecursiveUpdates(parentIndex);
     return nodeToIndex(cardNode);
 }
@@ -495,25 +502,38 @@ void DeckListModel::sortHelper(InnerDecklistNode *node, Qt::SortOrder order)
     }
 }
 
-void DeckListModel::sort(int column, Qt::SortOrder order)
+/**
+ * Sorts the cards of a single group, announcing the layout change for that group only.
+ */
+void DeckListModel::sortGroup(InnerDecklistNode *groupNode)
 {
-    lastKnownColumn = column;
-    lastKnownOrder = order;
+    const QList<QPersistentModelIndex> parents = {nodeToIndex(groupNode)};
 
-    emit layoutAboutToBeChanged();
-    DeckSortMethod sortMethod;
+    emit layoutAboutToBeChanged(parents);
+    groupNode->setSortMethod(sortMethodForColumn(lastKnownColumn));
+    sortHelper(groupNode, lastKnownOrder);
+    emit layoutChanged(parents);
+}
+
+DeckSortMethod DeckListModel::sortMethodForColumn(int column)
+{
     switch (column) {
         case 0:
-            sortMethod = ByNumber;
-            break;
+            return ByNumber;
         case 1:
-            sortMethod = ByName;
-            break;
+            return ByName;
         default:
-            sortMethod = ByName;
+            return ByName;
     }
+}
+
+void DeckListModel::sort(int column, Qt::SortOrder order)
+{
+    lastKnownColumn = column;
+    lastKnownOrder = order;
 
-    root->setSortMethod(sortMethod);
+    emit layoutAboutToBeChanged();
+    root->setSortMethod(sortMethodForColumn(column));
     sortHelper(root, order);
     emit layoutChanged();
 }
@@ -542,16 +562,28 @@ void DeckListModel::setDeckList(DeckLoader *_deck)
     rebuildTree();
 }
 
+/**
+ * Looks up all the cards in a single batch, so every distinct card is only looked up once.
+ */
+QList<ExactCard> DeckListModel::resolveCards(const QList<CardRef> &cardRefs)
+{
+    QList<ExactCard> cards = CardDatabaseManager::getInstance()->getCards(cardRefs);
+    if (cards.size() != cardRefs.size()) {
+        qDebug() << cardRefs.size() - cards.size() << "cards not found in database!";
+    }
+    return cards;
+}
+
 QList<ExactCard> DeckListModel::getCards() const
 {
-    QList<ExactCard> cards;
+    QList<CardRef> cardRefs;
     DeckList *decklist = getDeckList();
     if (!decklist) {
-        return cards;
+        return {};
     }
     InnerDecklistNode *listRoot = decklist->getRoot();
     if (!listRoot)
-        return cards;
+        return {};
 
     for (int i = 0; i < listRoot->size(); i++) {
         InnerDecklistNode *currentZone = dynamic_cast<InnerDecklistNode *>(listRoot->at(i));
@@ -561,29 +593,25 @@ QList<ExactCard> DeckListModel::getCards() const
             DecklistCardNode *currentCard = dynamic_cast<DecklistCardNode *>(currentZone->at(j));
             if (!currentCard)
                 continue;
+            const CardRef cardRef = currentCard->toCardRef();
             for (int k = 0; k < currentCard->getNumber(); ++k) {
-                ExactCard card = CardDatabaseManager::getInstance()->getCard(currentCard->toCardRef());
-                if (card) {
-                    cards.append(card);
-                } else {
-                    qDebug() << "Card not found in database!";
-                }
+                cardRefs.append(cardRef);
             }
         }
     }
-    return cards;
+    return resolveCards(cardRefs);
 }
 
 QList<ExactCard> DeckListModel::getCardsForZone(const QString &zoneName) const
 {
-    QList<ExactCard> cards;
+    QList<CardRef> cardRefs;
     DeckList *decklist = getDeckList();
     if (!decklist) {
-        return cards;
+        return {};
     }
     InnerDecklistNode *listRoot = decklist->getRoot();
     if (!listRoot)
-        return cards;
+        return {};
 
     for (int i = 0; i < listRoot->size(); i++) {
         InnerDecklistNode *currentZone = dynamic_cast<InnerDecklistNode *>(listRoot->at(i));
@@ -594,18 +622,14 @@ QList<ExactCard> DeckListModel::getCardsForZone(const QString &zoneName) const
                 DecklistCardNode *currentCard = dynamic_cast<DecklistCardNode *>(currentZone->at(j));
                 if (!currentCard)
                     continue;
+                const CardRef cardRef = currentCard->toCardRef();
                 for (int k = 0; k < currentCard->getNumber(); ++k) {
-                    ExactCard card = CardDatabaseManager::getInstance()->getCard(currentCard->toCardRef());
-                    if (card) {
-                        cards.append(card);
-                    } else {
-                        qDebug() << "Card not found in database!";
-                    }
+                    cardRefs.append(cardRef);
                 }
             }
         }
     }
-    return cards;
+    return resolveCards(cardRefs);
 }
 
 QList<QString> *DeckListModel::getZones() const
@@ -139,8 +139,11 @@ private:
                                         const QString &cardNumber = "") const;
     void emitRecursiveUpdates(const QModelIndex &index);
     void sortHelper(InnerDecklistNode *node, Qt::SortOrder order);
+    void sortGroup(InnerDecklistNode *groupNode);
+    static DeckSortMethod sortMethodForColumn(int column);
 
     void printDeckListNode(QTextCursor *cursor, InnerDecklistNode *node);
+    static QList<ExactCard> resolveCards(const QList<CardRef> &cardRefs);
 
     template <typename T> T getNode(const QModelIndex &index) const
     {
@@ -0,0 +1,284 @@
+#include "deck_metadata_index.h"
+
+#include "../game/cards/card_database_manager.h"
+#include "../settings/cache_settings.h"
+#include "deck_loader.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+
+static const quint32 INDEX_MAGIC = 0x434b4d49; // "CKMI"
+static const quint32 INDEX_VERSION = 1;
+static const int SAVE_DELAY_MS = 1000;
+
+static QDataStream &operator<<(QDataStream &stream, const CardRef &cardRef)
+{
+    return stream << cardRef.name << cardRef.providerId;
+}
+
+static QDataStream &operator>>(QDataStream &stream, CardRef &cardRef)
+{
+    return stream >> cardRef.name >> cardRef.providerId;
+}
+
+static QDataStream &operator<<(QDataStream &stream, const DeckMetadata &metadata)
+{
+    stream << metadata.lastModified << metadata.fileSize << metadata.deckHash << metadata.name << metadata.tags
+           << metadata.colorIdentity << metadata.bannerCard << qint32(metadata.cardCount)
+           << metadata.lastLoadedTimestamp << qint32(metadata.cards.size());
+    for (const DeckMetadata::Card &card : metadata.cards) {
+        stream << card.cardRef << qint32(card.count);
+    }
+    return stream;
+}
+
+static QDataStream &operator>>(QDataStream &stream, DeckMetadata &metadata)
+{
+    qint32 cardCount = 0, distinctCards = 0;
+    stream >> metadata.lastModified >> metadata.fileSize >> metadata.deckHash >> metadata.name >> metadata.tags >>
+        metadata.colorIdentity >> metadata.bannerCard >> cardCount >> metadata.lastLoadedTimestamp >> distinctCards;
+    metadata.cardCount = cardCount;
+
+    metadata.cards.clear();
+    for (qint32 i = 0; i < distinctCards && stream.status() == QDataStream::Ok; ++i) {
+        DeckMetadata::Card card;
+        qint32 count = 0;
+        stream >> card.cardRef >> count;
+        card.count = count;
+        metadata.cards.append(card);
+    }
+    return stream;
+}
+
+DeckMetadataIndex &DeckMetadataIndex::instance()
+{
+    static DeckMetadataIndex *index = new DeckMetadataIndex(QCoreApplication::instance());
+    return *index;
+}
+
+DeckMetadataIndex::DeckMetadataIndex(QObject *parent) : QObject(parent)
+{
+    const QString cachePath = SettingsCache::instance().getCachePath();
+    if (!cachePath.isEmpty()) {
+        fileName = cachePath + "/deck_metadata.bin";
+    }
+
+    saveTimer.setSingleShot(true);
+    saveTimer.setInterval(SAVE_DELAY_MS);
+    connect(&saveTimer, &QTimer::timeout, this, &DeckMetadataIndex::save);
+    connect(&watcher, &QFileSystemWatcher::directoryChanged, this, &DeckMetadataIndex::directoryChanged);
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() {
+        if (saveTimer.isActive()) {
+            save();
+        }
+    });
+
+    load();
+}
+
+bool DeckMetadataIndex::lookup(const QString &filePath, DeckMetadata &metadata)
+{
+    auto entry = entries.find(filePath);
+    if (entry == entries.end()) {
+        return false;
+    }
+
+    const QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists() || fileInfo.size() != entry->fileSize || fileInfo.lastModified() != entry->lastModified) {
+        entries.erase(entry);
+        scheduleSave();
+        return false;
+    }
+
+    metadata = *entry;
+    watchDirectoryOf(filePath);
+    return true;
+}
+
+DeckMetadata DeckMetadataIndex::update(const QString &filePath, DeckLoader &deck)
+{
+    DeckMetadata metadata;
+
+    const QFileInfo fileInfo(filePath);
+    metadata.lastModified = fileInfo.lastModified();
+    metadata.fileSize = fileInfo.size();
+
+    metadata.deckHash = deck.getDeckHash();
+    metadata.name = deck.getName();
+    metadata.tags = deck.getTags();
+    metadata.bannerCard = deck.getBannerCard();
+    metadata.lastLoadedTimestamp = deck.getLastLoadedTimestamp();
+
+    QHash<QPair<QString, QString>, int> cardIndexes;
+    deck.forEachCard([&metadata, &cardIndexes](InnerDecklistNode *, DecklistCardNode *node) {
+        const QPair<QString, QString> key(node->getName(), node->getCardProviderId());
+        auto cardIndex = cardIndexes.constFind(key);
+        if (cardIndex == cardIndexes.constEnd()) {
+            cardIndexes.insert(key, metadata.cards.size());
+            metadata.cards.append({node->toCardRef(), node->getNumber()});
+        } else {
+            metadata.cards[*cardIndex].count += node->getNumber();
+        }
+        metadata.cardCount += node->getNumber();
+    });
+    metadata.colorIdentity = colorIdentity(metadata.cards);
+
+    if (fileInfo.exists()) {
+        entries.insert(filePath, metadata);
+        watchDirectoryOf(filePath);
+        scheduleSave();
+    }
+    return metadata;
+}
+
+void DeckMetadataIndex::rename(const QString &oldFilePath, const QString &newFilePath)
+{
+    auto entry = entries.find(oldFilePath);
+    if (entry == entries.end()) {
+        return;
+    }
+
+    const DeckMetadata metadata = *entry;
+    entries.erase(entry);
+    entries.insert(newFilePath, metadata);
+    watchDirectoryOf(newFilePath);
+    scheduleSave();
+}
+
+void DeckMetadataIndex::remove(const QString &filePath)
+{
+    if (entries.remove(filePath)) {
+        scheduleSave();
+    }
+}
+
+QString DeckMetadataIndex::colorIdentity(const QList<DeckMetadata::Card> &cards)
+{
+    QSet<QChar> colorSet; // A set to collect unique color symbols (e.g., W, U, B, R, G)
+
+    for (const DeckMetadata::Card &card : cards) {
+        CardInfoPtr currentCard = CardDatabaseManager::getInstance()->getCardInfo(card.cardRef.name);
+        if (currentCard) {
+            for (const QChar &color : currentCard->getColors()) {
+                colorSet.insert(color);
+            }
+        }
+    }
+
+    // Ensure the color identity is in WUBRG order
+    QString colorIdentity;
+    const QString wubrgOrder = "WUBRG";
+    for (const QChar &color : wubrgOrder) {
+        if (colorSet.contains(color)) {
+            colorIdentity.append(color);
+        }
+    }
+
+    return colorIdentity;
+}
+
+void DeckMetadataIndex::directoryChanged(const QString &path)
+{
+    // changed files are noticed on lookup, only the removed ones have to be dropped here
+    bool removed = false;
+    for (auto entry = entries.begin(); entry != entries.end();) {
+        const QFileInfo fileInfo(entry.key());
+        if (fileInfo.absolutePath() == path && !fileInfo.exists()) {
+            entry = entries.erase(entry);
+            removed = true;
+        } else {
+            ++entry;
+        }
+    }
+
+    if (removed) {
+        scheduleSave();
+    }
+    if (!QFileInfo::exists(path)) {
+        watcher.removePath(path);
+    }
+}
+
+void DeckMetadataIndex::scheduleSave()
+{
+    if (!fileName.isEmpty()) {
+        saveTimer.start();
+    }
+}
+
+void DeckMetadataIndex::watchDirectoryOf(const QString &filePath)
+{
+    const QString path = QFileInfo(filePath).absolutePath();
+    if (!watcher.directories().contains(path)) {
+        watcher.addPath(path);
+    }
+}
+
+void DeckMetadataIndex::load()
+{
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic = 0, version = 0;
+    stream >> magic >> version;
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION) {
+        qCInfo(DeckMetadataIndexLog) << "Ignoring deck metadata index of another version:" << fileName;
+        return;
+    }
+    stream.setVersion(QDataStream::Qt_5_8);
+
+    QHash<QString, DeckMetadata> loadedEntries;
+    quint32 count = 0;
+    stream >> count;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString filePath;
+        DeckMetadata metadata;
+        stream >> filePath >> metadata;
+        loadedEntries.insert(filePath, metadata);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(DeckMetadataIndexLog) << "Ignoring damaged deck metadata index:" << fileName;
+        return;
+    }
+    entries = loadedEntries;
+    qCInfo(DeckMetadataIndexLog) << "Loaded the metadata of" << entries.size() << "decks";
+}
+
+void DeckMetadataIndex::save()
+{
+    saveTimer.stop();
+    if (fileName.isEmpty() || !QDir().mkpath(QFileInfo(fileName).absolutePath())) {
+        return;
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(DeckMetadataIndexLog) << "Could not write the deck metadata index:" << fileName;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << INDEX_MAGIC << INDEX_VERSION;
+    stream.setVersion(QDataStream::Qt_5_8);
+    stream << quint32(entries.size());
+    for (auto entry = entries.constBegin(); entry != entries.constEnd(); ++entry) {
+        stream << entry.key() << entry.value();
+    }
+
+    if (!file.commit()) {
+        qCWarning(DeckMetadataIndexLog) << "Could not write the deck metadata index:" << fileName;
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef DECK_METADATA_INDEX_H
+#define DECK_METADATA_INDEX_H
+
+#include "card_ref.h"
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QList>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+inline Q_LOGGING_CATEGORY(DeckMetadataIndexLog, "deck_metadata_index");
+
+class DeckLoader;
+
+/**
+ * What the visual deck storage shows of a deck file, so that it doesn't have to parse the file.
+ */
+struct DeckMetadata
+{
+    struct Card
+    {
+        CardRef cardRef;
+        // the copies of the card in all zones of the deck
+        int count;
+    };
+
+    // the state of the file the metadata was read from
+    QDateTime lastModified;
+    qint64 fileSize = -1;
+
+    QString deckHash;
+    QString name;
+    QStringList tags;
+    QString colorIdentity;
+    CardRef bannerCard;
+    int cardCount = 0;
+    QString lastLoadedTimestamp;
+    // the distinct cards of the deck
+    QList<Card> cards;
+};
+
+/**
+ * The metadata of every deck file parsed so far, kept in a file in the cache directory so it survives restarts.
+ *
+ * An entry is only returned while the size and modification time of its file are unchanged, so a deck edited
+ * outside of the visual deck storage is parsed again the next time it's shown. The directories of the indexed decks
+ * are watched to drop the entries of the files that are removed.
+ */
+class DeckMetadataIndex : public QObject
+{
+    Q_OBJECT
+public:
+    static DeckMetadataIndex &instance();
+
+    /**
+     * Returns false if the deck isn't indexed, or if its file changed since.
+     */
+    bool lookup(const QString &filePath, DeckMetadata &metadata);
+    /**
+     * Indexes a deck that was fully loaded from filePath, or saved to it.
+     */
+    DeckMetadata update(const QString &filePath, DeckLoader &deck);
+    void rename(const QString &oldFilePath, const QString &newFilePath);
+    void remove(const QString &filePath);
+
+    /**
+     * The colors of the cards of the deck, in WUBRG order.
+     */
+    static QString colorIdentity(const QList<DeckMetadata::Card> &cards);
+
+private slots:
+    void directoryChanged(const QString &path);
+    void save();
+
+private:
+    explicit DeckMetadataIndex(QObject *parent);
+
+    QString fileName;
+    QHash<QString, DeckMetadata> entries;
+    QFileSystemWatcher watcher;
+    // the index is written once a burst of changes is over
+    QTimer saveTimer;
+
+    void load();
+    void scheduleSave();
+    void watchDirectoryOf(const QString &filePath);
+};
+
+#endif
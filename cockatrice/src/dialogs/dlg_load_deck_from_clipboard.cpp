@@ -8,23 +8,26 @@
 #include <QCheckBox>
 #include <QClipboard>
 #include <QDialogButtonBox>
+#include <QFutureWatcher>
 #include <QMessageBox>
 #include <QPlainTextEdit>
+#include <QProgressBar>
 #include <QPushButton>
 #include <QTextStream>
 #include <QVBoxLayout>
+#include <QtConcurrentRun>
 
 /**
  * Creates the main layout and connects the signals that are common to all versions of this window
  */
-AbstractDlgDeckTextEdit::AbstractDlgDeckTextEdit(QWidget *parent) : QDialog(parent)
+AbstractDlgDeckTextEdit::AbstractDlgDeckTextEdit(QWidget *parent) : QDialog(parent), loading(false)
 {
     contentsEdit = new QPlainTextEdit;
 
     refreshButton = new QPushButton(tr("&Refresh"));
     connect(refreshButton, &QPushButton::clicked, this, &AbstractDlgDeckTextEdit::actRefresh);
 
-    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
     buttonBox->addButton(refreshButton, QDialogButtonBox::ActionRole);
     connect(buttonBox, &QDialogButtonBox::accepted, this, &AbstractDlgDeckTextEdit::actOK);
     connect(buttonBox, &QDialogButtonBox::rejected, this, &AbstractDlgDeckTextEdit::reject);
@@ -32,8 +35,15 @@ AbstractDlgDeckTextEdit::AbstractDlgDeckTextEdit(QWidget *parent) : QDialog(pare
     loadSetNameAndNumberCheckBox = new QCheckBox(tr("Parse Set Name and Number (if available)"));
     loadSetNameAndNumberCheckBox->setChecked(true);
 
+    // a busy indicator, the deck is parsed in one go
+    loadingBar = new QProgressBar;
+    loadingBar->setRange(0, 0);
+    loadingBar->setTextVisible(false);
+    loadingBar->setVisible(false);
+
     auto *buttonLayout = new QHBoxLayout;
     buttonLayout->addWidget(loadSetNameAndNumberCheckBox);
+    buttonLayout->addWidget(loadingBar);
     buttonLayout->addWidget(buttonBox);
 
     auto *mainLayout = new QVBoxLayout;
@@ -65,14 +75,15 @@ void AbstractDlgDeckTextEdit::setText(const QString &text)
 }
 
 /**
- * Tries to load the current contents of the contentsEdit into the DeckLoader
+ * Tries to load the text into the DeckLoader
  *
  * @param deckLoader The DeckLoader to load the deck into
+ * @param buffer The text of the deck
+ * @param loadSetNameAndNumber Whether to look up the printings named by the set names and numbers of the cards
  * @return Whether the loading was successful
  */
-bool AbstractDlgDeckTextEdit::loadIntoDeck(DeckLoader *deckLoader) const
+bool AbstractDlgDeckTextEdit::loadIntoDeck(DeckLoader *deckLoader, QString buffer, bool loadSetNameAndNumber)
 {
-    QString buffer = contentsEdit->toPlainText();
 
     if (buffer.contains("<cockatrice_deck version=\"1\">")) {
         return deckLoader->loadFromString_Native(buffer);
@@ -81,7 +92,7 @@ bool AbstractDlgDeckTextEdit::loadIntoDeck(DeckLoader *deckLoader) const
     QTextStream stream(&buffer);
 
     if (deckLoader->loadFromStream_Plain(stream, true)) {
-        if (loadSetNameAndNumberCheckBox->isChecked()) {
+        if (loadSetNameAndNumber) {
             deckLoader->resolveSetNameAndNumberToProviderID();
         } else {
             deckLoader->clearSetNamesAndNumbers();
@@ -92,6 +103,54 @@ bool AbstractDlgDeckTextEdit::loadIntoDeck(DeckLoader *deckLoader) const
     return false;
 }
 
+/**
+ * Loads the current contents of the contentsEdit into the DeckLoader on another thread, so that long lists like cubes
+ * don't freeze the window, and calls deckLoadFinished once it's done. The dialog can't be used in the meantime.
+ *
+ * @param deckLoader The DeckLoader to load the deck into
+ */
+void AbstractDlgDeckTextEdit::loadIntoDeckAsync(DeckLoader *deckLoader)
+{
+    if (loading) {
+        return;
+    }
+    setLoading(true);
+
+    auto *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher]() {
+        const bool result = watcher->result();
+        watcher->deleteLater();
+
+        setLoading(false);
+        deckLoadFinished(result);
+    });
+
+    const QString buffer = contentsEdit->toPlainText();
+    const bool loadSetNameAndNumber = loadSetNameAndNumberCheckBox->isChecked();
+    watcher->setFuture(QtConcurrent::run([deckLoader, buffer, loadSetNameAndNumber]() {
+        return loadIntoDeck(deckLoader, buffer, loadSetNameAndNumber);
+    }));
+}
+
+void AbstractDlgDeckTextEdit::setLoading(bool _loading)
+{
+    loading = _loading;
+    contentsEdit->setReadOnly(loading);
+    loadSetNameAndNumberCheckBox->setEnabled(!loading);
+    buttonBox->setEnabled(!loading);
+    loadingBar->setVisible(loading);
+}
+
+/**
+ * The dialog can't be closed while a deck is loaded into its DeckLoader.
+ */
+void AbstractDlgDeckTextEdit::reject()
+{
+    if (!loading) {
+        QDialog::reject();
+    }
+}
+
 void AbstractDlgDeckTextEdit::keyPressEvent(QKeyEvent *event)
 {
     if (event->key() == Qt::Key_Return && event->modifiers() & Qt::ControlModifier) {
@@ -124,7 +183,12 @@ void DlgLoadDeckFromClipboard::actOK()
     deckList = new DeckLoader;
     deckList->setParent(this);
 
-    if (loadIntoDeck(deckList)) {
+    loadIntoDeckAsync(deckList);
+}
+
+void DlgLoadDeckFromClipboard::deckLoadFinished(bool success)
+{
+    if (success) {
         accept();
     } else {
         QMessageBox::critical(this, tr("Error"), tr("Invalid deck list."));
@@ -170,7 +234,12 @@ void DlgEditDeckInClipboard::actRefresh()
 
 void DlgEditDeckInClipboard::actOK()
 {
-    if (loadIntoDeck(deckLoader)) {
+    loadIntoDeckAsync(deckLoader);
+}
+
+void DlgEditDeckInClipboard::deckLoadFinished(bool success)
+{
+    if (success) {
         accept();
     } else {
         QMessageBox::critical(this, tr("Error"), tr("Invalid deck list."));
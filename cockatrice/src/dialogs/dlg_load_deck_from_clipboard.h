@@ -5,7 +5,9 @@
 #include <QDialog>
 
 class DeckLoader;
+class QDialogButtonBox;
 class QPlainTextEdit;
+class QProgressBar;
 class QPushButton;
 
 /**
@@ -18,6 +20,12 @@ private:
     QPlainTextEdit *contentsEdit;
     QPushButton *refreshButton;
     QCheckBox *loadSetNameAndNumberCheckBox;
+    QDialogButtonBox *buttonBox;
+    QProgressBar *loadingBar;
+    bool loading;
+
+    void setLoading(bool _loading);
+    static bool loadIntoDeck(DeckLoader *deckLoader, QString buffer, bool loadSetNameAndNumber);
 
 private slots:
     void refreshShortcuts();
@@ -34,9 +42,13 @@ public:
      */
     virtual DeckLoader *getDeckList() const = 0;
 
+public slots:
+    void reject() override;
+
 protected:
     void setText(const QString &text);
-    bool loadIntoDeck(DeckLoader *deckLoader) const;
+    void loadIntoDeckAsync(DeckLoader *deckLoader);
+    virtual void deckLoadFinished(bool success) = 0;
     void keyPressEvent(QKeyEvent *event) override;
 
 protected slots:
@@ -54,6 +66,9 @@ protected slots:
     void actOK() override;
     void actRefresh() override;
 
+protected:
+    void deckLoadFinished(bool success) override;
+
 private:
     DeckLoader *deckList;
 
@@ -76,6 +91,9 @@ protected slots:
     void actOK() override;
     void actRefresh() override;
 
+protected:
+    void deckLoadFinished(bool success) override;
+
 private:
     DeckLoader *deckLoader;
     bool annotated;
@@ -14,6 +14,7 @@
 #include <QPainter>
 #include <QPushButton>
 #include <QScrollBar>
+#include <QSet>
 #include <QSplitter>
 #include <QVBoxLayout>
 #include <algorithm>
@@ -94,7 +95,7 @@ DlgSelectSetForCards::DlgSelectSetForCards(QWidget *parent, DeckListModel *_mode
     splitter->addWidget(scrollArea);
     splitter->addWidget(bottomSplitter);
 
-    cardsForSets = getCardsForSets();
+    indexCardsBySet();
 
     sortSetsByCount();
     updateCardLists();
@@ -175,12 +176,10 @@ void DlgSelectSetForCards::actSetAllToPreferred()
 
 void DlgSelectSetForCards::sortSetsByCount()
 {
-    QMap<QString, int> setsForCards = getSetsForCards();
-
     // Convert map to a sortable list
     QVector<QPair<QString, int>> setList;
-    for (auto it = setsForCards.begin(); it != setsForCards.end(); ++it) {
-        setList.append(qMakePair(it.key(), it.value()));
+    for (auto it = cardsInSets.begin(); it != cardsInSets.end(); ++it) {
+        setList.append(qMakePair(it.key(), static_cast<int>(it.value().count(true))));
     }
 
     // Sort in descending order of count
@@ -188,6 +187,7 @@ void DlgSelectSetForCards::sortSetsByCount()
               [](const QPair<QString, int> &a, const QPair<QString, int> &b) { return a.second > b.second; });
 
     // Clear existing entries
+    entry_widgets.clear();
     qDeleteAll(setEntries);
     setEntries.clear();
 
@@ -196,23 +196,28 @@ void DlgSelectSetForCards::sortSetsByCount()
         SetEntryWidget *widget = new SetEntryWidget(this, entry.first, entry.second);
         listLayout->addWidget(widget);
         setEntries.insert(entry.first, widget);
+        entry_widgets.append(widget);
     }
 }
 
-QMap<QString, int> DlgSelectSetForCards::getSetsForCards()
+void DlgSelectSetForCards::indexCardsBySet()
 {
-    QMap<QString, int> setCounts;
+    deckCards.clear();
+    cardsInSets.clear();
+    shownPrintingSets.clear();
     if (!model)
-        return setCounts;
+        return;
 
     DeckList *decklist = model->getDeckList();
     if (!decklist)
-        return setCounts;
+        return;
 
     InnerDecklistNode *listRoot = decklist->getRoot();
     if (!listRoot)
-        return setCounts;
+        return;
 
+    // the same card in several zones takes the same printing, it is counted and shown once
+    QSet<QString> seenCards;
     for (auto *i : *listRoot) {
         auto *countCurrentZone = dynamic_cast<InnerDecklistNode *>(i);
         if (!countCurrentZone)
@@ -220,90 +225,90 @@ QMap<QString, int> DlgSelectSetForCards::getSetsForCards()
 
         for (auto *cardNode : *countCurrentZone) {
             auto *currentCard = dynamic_cast<DecklistCardNode *>(cardNode);
-            if (!currentCard)
+            if (!currentCard || seenCards.contains(currentCard->getName()))
                 continue;
+            seenCards.insert(currentCard->getName());
+            deckCards.append(currentCard->getName());
+        }
+    }
 
-            CardInfoPtr infoPtr = CardDatabaseManager::getInstance()->getCardInfo(currentCard->getName());
-            if (!infoPtr)
-                continue;
+    for (int card = 0; card < deckCards.size(); ++card) {
+        CardInfoPtr infoPtr = CardDatabaseManager::getInstance()->getCardInfo(deckCards.at(card));
+        if (!infoPtr)
+            continue;
 
-            SetToPrintingsMap setMap = infoPtr->getSets();
-            for (auto &setName : setMap.keys()) {
-                setCounts[setName]++;
+        const SetToPrintingsMap &setMap = infoPtr->getSets();
+        for (auto it = setMap.cbegin(); it != setMap.cend(); ++it) {
+            QBitArray &cards = cardsInSets[it.key()];
+            if (cards.isEmpty()) {
+                cards.resize(deckCards.size());
             }
+            cards.setBit(card);
         }
     }
-    return setCounts;
 }
 
-void DlgSelectSetForCards::updateCardLists()
+QStringList DlgSelectSetForCards::cardNames(const QBitArray &cards) const
 {
-    for (SetEntryWidget *entryWidget : entry_widgets) {
-        entryWidget->populateCardList();
-        if (entryWidget->expanded) {
-            entryWidget->updateCardDisplayWidgets();
+    QStringList names;
+    for (int card = 0; card < cards.size() && card < deckCards.size(); ++card) {
+        if (cards.testBit(card)) {
+            names.append(deckCards.at(card));
         }
-        entryWidget->checkVisibility();
     }
+    return names;
+}
 
-    uneditedCardsFlowWidget->clearLayout();
-    modifiedCardsFlowWidget->clearLayout();
+void DlgSelectSetForCards::updateCardLists()
+{
+    // the sets are walked by priority, a card takes its printing from the first checked set that has it
+    QBitArray takenCards(deckCards.size());
+    QStringList printingSets;
+    for (int card = 0; card < deckCards.size(); ++card) {
+        printingSets.append(QString());
+    }
 
-    // Map from set name to a set of selected cards in that set
-    QMap<QString, QSet<QString>> selectedCardsBySet;
     for (SetEntryWidget *entryWidget : entry_widgets) {
+        entryWidget->populateCardList(takenCards);
+        entryWidget->updateCardDisplayWidgets();
+
         if (entryWidget->isChecked()) {
-            QStringList cardsInSet = entryWidget->getAllCardsForSet();
-            QSet<QString> cardSet = QSet<QString>(cardsInSet.begin(), cardsInSet.end()); // Convert list to set
-            selectedCardsBySet.insert(entryWidget->setName, cardSet);
+            const QBitArray cardsInSet = getCardsInSet(entryWidget->setName);
+            for (int card = 0; card < deckCards.size(); ++card) {
+                if (cardsInSet.testBit(card) && !takenCards.testBit(card)) {
+                    printingSets[card] = entryWidget->setName;
+                }
+            }
+            takenCards |= cardsInSet;
         }
     }
 
-    DeckList *decklist = model->getDeckList();
-    if (!decklist)
-        return;
-
-    InnerDecklistNode *listRoot = decklist->getRoot();
-    if (!listRoot)
+    // expanding a set or a change that moves no card keeps the pictures at the bottom
+    if (printingSets == shownPrintingSets) {
         return;
+    }
+    shownPrintingSets = printingSets;
 
-    for (auto *i : *listRoot) {
-        auto *countCurrentZone = dynamic_cast<InnerDecklistNode *>(i);
-        if (!countCurrentZone)
-            continue;
-
-        for (auto *cardNode : *countCurrentZone) {
-            auto *currentCard = dynamic_cast<DecklistCardNode *>(cardNode);
-            if (!currentCard)
-                continue;
-
-            bool found = false;
-            QString foundSetName;
-
-            // Check across all sets if the card is present
-            for (auto it = selectedCardsBySet.begin(); it != selectedCardsBySet.end(); ++it) {
-                if (it.value().contains(currentCard->getName())) {
-                    found = true;
-                    foundSetName = it.key(); // Store the set name where it was found
-                    break;                   // Stop at the first match
-                }
-            }
+    uneditedCardsFlowWidget->clearLayout();
+    modifiedCardsFlowWidget->clearLayout();
 
-            if (!found) {
-                // The card was not in any selected set
-                ExactCard card = CardDatabaseManager::getInstance()->getCard({currentCard->getName()});
-                CardInfoPictureWidget *picture_widget = new CardInfoPictureWidget(uneditedCardsFlowWidget);
-                picture_widget->setCard(card);
-                uneditedCardsFlowWidget->addWidget(picture_widget);
-            } else {
-                ExactCard card = CardDatabaseManager::getInstance()->getCard(
-                    {currentCard->getName(), CardDatabaseManager::getInstance()
-                                                 ->getSpecificPrinting(currentCard->getName(), foundSetName, "")
-                                                 .getUuid()});
-                CardInfoPictureWidget *picture_widget = new CardInfoPictureWidget(modifiedCardsFlowWidget);
-                picture_widget->setCard(card);
-                modifiedCardsFlowWidget->addWidget(picture_widget);
-            }
+    for (int card = 0; card < deckCards.size(); ++card) {
+        const QString &cardName = deckCards.at(card);
+        const QString &foundSetName = printingSets.at(card);
+
+        if (foundSetName.isEmpty()) {
+            // The card was not in any selected set
+            ExactCard exactCard = CardDatabaseManager::getInstance()->getCard({cardName});
+            CardInfoPictureWidget *picture_widget = new CardInfoPictureWidget(uneditedCardsFlowWidget);
+            picture_widget->setCard(exactCard);
+            uneditedCardsFlowWidget->addWidget(picture_widget);
+        } else {
+            ExactCard exactCard = CardDatabaseManager::getInstance()->getCard(
+                {cardName,
+                 CardDatabaseManager::getInstance()->getSpecificPrinting(cardName, foundSetName, "").getUuid()});
+            CardInfoPictureWidget *picture_widget = new CardInfoPictureWidget(modifiedCardsFlowWidget);
+            picture_widget->setCard(exactCard);
+            modifiedCardsFlowWidget->addWidget(picture_widget);
         }
     }
 }
@@ -353,63 +358,20 @@ void DlgSelectSetForCards::dropEvent(QDropEvent *event)
     QTimer::singleShot(10, this, [this]() { emit orderChanged(); });
 }
 
-QMap<QString, QStringList> DlgSelectSetForCards::getCardsForSets()
-{
-    QMap<QString, QStringList> setCards;
-    if (!model)
-        return setCards;
-
-    DeckList *decklist = model->getDeckList();
-    if (!decklist)
-        return setCards;
-
-    InnerDecklistNode *listRoot = decklist->getRoot();
-    if (!listRoot)
-        return setCards;
-
-    for (auto *i : *listRoot) {
-        auto *countCurrentZone = dynamic_cast<InnerDecklistNode *>(i);
-        if (!countCurrentZone)
-            continue;
-
-        for (auto *cardNode : *countCurrentZone) {
-            auto *currentCard = dynamic_cast<DecklistCardNode *>(cardNode);
-            if (!currentCard)
-                continue;
-
-            CardInfoPtr infoPtr = CardDatabaseManager::getInstance()->getCardInfo(currentCard->getName());
-            if (!infoPtr)
-                continue;
-
-            SetToPrintingsMap setMap = infoPtr->getSets();
-            for (auto it = setMap.begin(); it != setMap.end(); ++it) {
-                setCards[it.key()].append(currentCard->getName());
-            }
-        }
-    }
-    return setCards;
-}
-
 QMap<QString, QStringList> DlgSelectSetForCards::getModifiedCards()
 {
     QMap<QString, QStringList> modifiedCards;
+    QBitArray takenCards(deckCards.size());
     for (int i = 0; i < listLayout->count(); ++i) {
         QWidget *widget = listLayout->itemAt(i)->widget();
         if (auto entry = qobject_cast<SetEntryWidget *>(widget)) {
             if (entry->isChecked()) {
-                QStringList cardsInSet = entry->getAllCardsForSet();
-
-                for (QString cardInSet : cardsInSet) {
-                    bool alreadyContained = false;
-                    for (QString key : modifiedCards.keys()) {
-                        if (modifiedCards[key].contains(cardInSet)) {
-                            alreadyContained = true;
-                        }
-                    }
-                    if (!alreadyContained) {
-                        modifiedCards[entry->setName].append(cardInSet);
-                    }
+                const QBitArray cardsInSet = getCardsInSet(entry->setName);
+                const QBitArray newCards = cardsInSet & ~takenCards;
+                if (newCards.count(true) > 0) {
+                    modifiedCards.insert(entry->setName, cardNames(newCards));
                 }
+                takenCards |= cardsInSet;
             }
         }
     }
@@ -569,63 +531,47 @@ void SetEntryWidget::toggleExpansion()
     alreadySelectedCardListContainer->setVisible(expanded);
     expandButton->setText(expanded ? "-" : "+");
 
-    populateCardList();
+    // the other entries and the cards at the bottom don't change, only this entry builds or drops its pictures
     updateCardDisplayWidgets();
-
-    parent->updateCardLists();
 }
 
 void SetEntryWidget::checkVisibility()
 {
-    if (possibleCards.empty()) {
+    if (possibleCards.count(true) == 0) {
         setHidden(true);
     } else {
         setVisible(true);
     }
 }
 
-QStringList SetEntryWidget::getAllCardsForSet()
+void SetEntryWidget::populateCardList(const QBitArray &takenCards)
 {
-    QStringList list;
-    QMap<QString, QStringList> setCards = parent->cardsForSets;
-    if (setCards.contains(setName)) {
-        for (const QString &cardName : setCards[setName]) {
-            list << cardName;
-        }
-    }
-    return list;
-}
+    const QBitArray cardsInSet = parent->getCardsInSet(setName);
+    possibleCards = cardsInSet & ~takenCards;
+    unusedCards = cardsInSet & takenCards;
 
-void SetEntryWidget::populateCardList()
-{
-    possibleCards = getAllCardsForSet();
-
-    for (SetEntryWidget *entryWidget : parent->entry_widgets) {
-        if (entryWidget == this) {
-            break;
-        }
-        if (entryWidget->isChecked()) {
-            for (const QString &cardName : entryWidget->possibleCards) {
-                possibleCards.removeAll(cardName);
-            }
-        }
-    }
-
-    unusedCards = getAllCardsForSet();
-    for (const QString &cardName : possibleCards) {
-        unusedCards.removeAll(cardName);
-    }
     checkVisibility();
-    countLabel->setText(QString::number(possibleCards.size()) + " (" +
-                        QString::number(possibleCards.size() + unusedCards.size()) + ")");
+    const int possibleCount = static_cast<int>(possibleCards.count(true));
+    countLabel->setText(QString::number(possibleCount) + " (" +
+                        QString::number(possibleCount + unusedCards.count(true)) + ")");
 }
 
 void SetEntryWidget::updateCardDisplayWidgets()
 {
+    // every reordering of the sets updates all entries, most of them show the same cards as before
+    const QBitArray shownPossibleCards = expanded ? possibleCards : QBitArray();
+    const QBitArray shownUnusedCards = expanded ? unusedCards : QBitArray();
+    if (shownPossibleCards == displayedPossibleCards && shownUnusedCards == displayedUnusedCards) {
+        return;
+    }
+    displayedPossibleCards = shownPossibleCards;
+    displayedUnusedCards = shownUnusedCards;
+
+    // a collapsed entry doesn't keep its pictures
     cardListContainer->clearLayout();
     alreadySelectedCardListContainer->clearLayout();
 
-    for (const QString &cardName : possibleCards) {
+    for (const QString &cardName : parent->cardNames(displayedPossibleCards)) {
         CardInfoPictureWidget *picture_widget = new CardInfoPictureWidget(cardListContainer);
         QString providerId =
             CardDatabaseManager::getInstance()->getSpecificPrinting(cardName, setName, nullptr).getUuid();
@@ -633,7 +579,7 @@ void SetEntryWidget::updateCardDisplayWidgets()
         cardListContainer->addWidget(picture_widget);
     }
 
-    for (const QString &cardName : unusedCards) {
+    for (const QString &cardName : parent->cardNames(displayedUnusedCards)) {
         CardInfoPictureWidget *picture_widget = new CardInfoPictureWidget(alreadySelectedCardListContainer);
         QString providerId =
             CardDatabaseManager::getInstance()->getSpecificPrinting(cardName, setName, nullptr).getUuid();
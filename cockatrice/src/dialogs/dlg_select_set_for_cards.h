@@ -4,6 +4,7 @@
 #include "../client/ui/widgets/general/layout_containers/flow_widget.h"
 #include "../deck/deck_list_model.h"
 
+#include <QBitArray>
 #include <QCheckBox>
 #include <QDialog>
 #include <QLabel>
@@ -22,11 +23,16 @@ public:
     explicit DlgSelectSetForCards(QWidget *parent, DeckListModel *_model);
     void retranslateUi();
     void sortSetsByCount();
-    QMap<QString, QStringList> getCardsForSets();
     QMap<QString, QStringList> getModifiedCards();
+    // one bit per card of the deck, set for the cards that have a printing in the set
+    QBitArray getCardsInSet(const QString &setName) const
+    {
+        return cardsInSets.value(setName, QBitArray(deckCards.size()));
+    }
+    // the names of the cards whose bits are set, in the order of the deck
+    QStringList cardNames(const QBitArray &cards) const;
     QVBoxLayout *listLayout;
     QList<SetEntryWidget *> entry_widgets;
-    QMap<QString, QStringList> cardsForSets;
 
 signals:
     void widgetOrderChanged();
@@ -58,7 +64,13 @@ private:
     QPushButton *clearButton;
     QPushButton *setAllToPreferredButton;
 
-    QMap<QString, int> getSetsForCards();
+    // the distinct card names of the deck, the index of a card here is its bit in the bit arrays
+    QStringList deckCards;
+    QMap<QString, QBitArray> cardsInSets;
+    // the set each card takes its printing from, empty for the unmodified ones, as last shown at the bottom
+    QStringList shownPrintingSets;
+
+    void indexCardsBySet();
 };
 
 class SetEntryWidget : public QWidget
@@ -69,8 +81,8 @@ public:
     explicit SetEntryWidget(DlgSelectSetForCards *parent, const QString &setName, int count);
     void toggleExpansion();
     void checkVisibility();
-    QStringList getAllCardsForSet();
-    void populateCardList();
+    // takenCards are the cards a checked set of higher priority gives its printing to
+    void populateCardList(const QBitArray &takenCards);
     void updateCardDisplayWidgets();
     bool isChecked() const;
     DlgSelectSetForCards *parent;
@@ -97,8 +109,11 @@ private:
     QLabel *alreadySelectedCardsLabel;
     FlowWidget *alreadySelectedCardListContainer;
     QVBoxLayout *cardListLayout;
-    QStringList possibleCards;
-    QStringList unusedCards;
+    QBitArray possibleCards;
+    QBitArray unusedCards;
+    // the cards the picture widgets were created for
+    QBitArray displayedPossibleCards;
+    QBitArray displayedUnusedCards;
 };
 
 #endif // DLG_SELECT_SET_FOR_CARDS_H
\ No newline at end of file
@@ -560,6 +560,12 @@ AppearanceSettingsPage::AppearanceSettingsPage()
     connect(&invertVerticalCoordinateCheckBox, &QCheckBox::QT_STATE_CHANGED, &settings,
             &SettingsCache::setInvertVerticalCoordinate);
 
+    openGLGameViewCheckBox.setChecked(settings.getOpenGLGameView());
+    connect(&openGLGameViewCheckBox, &QCheckBox::QT_STATE_CHANGED, &settings, &SettingsCache::setOpenGLGameView);
+#ifndef HAVE_QOPENGLWIDGET
+    openGLGameViewCheckBox.setEnabled(false);
+#endif
+
     minPlayersForMultiColumnLayoutEdit.setMinimum(2);
     minPlayersForMultiColumnLayoutEdit.setValue(settings.getMinPlayersForMultiColumnLayout());
     connect(&minPlayersForMultiColumnLayoutEdit, qOverload<int>(&QSpinBox::valueChanged), &settings,
@@ -579,6 +585,7 @@ AppearanceSettingsPage::AppearanceSettingsPage()
     tableGrid->addWidget(&minPlayersForMultiColumnLayoutEdit, 1, 1, 1, 1);
     tableGrid->addWidget(&maxFontSizeForCardsLabel, 2, 0, 1, 1);
     tableGrid->addWidget(&maxFontSizeForCardsEdit, 2, 1, 1, 1);
+    tableGrid->addWidget(&openGLGameViewCheckBox, 3, 0, 1, 2);
 
     tableGroupBox = new QGroupBox;
     tableGroupBox->setLayout(tableGrid);
@@ -692,6 +699,7 @@ void AppearanceSettingsPage::retranslateUi()
     invertVerticalCoordinateCheckBox.setText(tr("Invert vertical coordinate"));
     minPlayersForMultiColumnLayoutLabel.setText(tr("Minimum player count for multi-column layout:"));
     maxFontSizeForCardsLabel.setText(tr("Maximum font size for information displayed on cards:"));
+    openGLGameViewCheckBox.setText(tr("Draw the table with OpenGL"));
 }
 
 enum visualDeckStoragePromptForConversionIndex
@@ -125,6 +125,7 @@ private:
     QCheckBox horizontalHandCheckBox;
     QCheckBox leftJustifiedHandCheckBox;
     QCheckBox invertVerticalCoordinateCheckBox;
+    QCheckBox openGLGameViewCheckBox;
     QGroupBox *themeGroupBox;
     QGroupBox *menuGroupBox;
     QGroupBox *cardsGroupBox;
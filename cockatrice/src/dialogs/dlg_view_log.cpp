@@ -2,23 +2,35 @@
 
 #include "../settings/cache_settings.h"
 #include "../utility/logger.h"
+#include "../utility/startup_trace.h"
 
 #include <QClipboard>
 #include <QPlainTextEdit>
 #include <QPushButton>
 #include <QRegularExpression>
+#include <QTabWidget>
 #include <QVBoxLayout>
 
-DlgViewLog::DlgViewLog(QWidget *parent) : QDialog(parent)
+DlgViewLog::DlgViewLog(QWidget *parent) : QDialog(parent), nextLogEntry(0)
 {
     logArea = new QPlainTextEdit;
     logArea->setReadOnly(true);
 
+    startupArea = new QPlainTextEdit;
+    startupArea->setReadOnly(true);
+    startupArea->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+    tabs = new QTabWidget;
+    tabs->addTab(logArea, tr("Log"));
+    tabs->addTab(startupArea, tr("Startup"));
+    // the phases that run concurrently can finish after the dialog is opened
+    connect(tabs, &QTabWidget::currentChanged, this, &DlgViewLog::refreshStartupTrace);
+
     auto *mainLayout = new QVBoxLayout;
     mainLayout->setSpacing(3);
     mainLayout->setContentsMargins(20, 20, 20, 6);
 
-    mainLayout->addWidget(logArea);
+    mainLayout->addWidget(tabs);
 
     auto *bottomLayout = new QHBoxLayout;
 
@@ -43,8 +55,9 @@ DlgViewLog::DlgViewLog(QWidget *parent) : QDialog(parent)
     setWindowTitle(tr("Debug Log"));
     resize(800, 500);
 
+    logTimer.setInterval(250);
+    connect(&logTimer, &QTimer::timeout, this, &DlgViewLog::pullLogEntries);
     loadInitialLogBuffer();
-    connect(&Logger::getInstance(), &Logger::logEntryAdded, this, &DlgViewLog::appendLogEntry);
 }
 
 void DlgViewLog::actCheckBoxChanged(bool abNewValue)
@@ -54,13 +67,27 @@ void DlgViewLog::actCheckBoxChanged(bool abNewValue)
 
 void DlgViewLog::actCopyToClipboard()
 {
-    QApplication::clipboard()->setText(logArea->toPlainText());
+    const QPlainTextEdit *area = tabs->currentWidget() == startupArea ? startupArea : logArea;
+    QApplication::clipboard()->setText(area->toPlainText());
+}
+
+void DlgViewLog::refreshStartupTrace()
+{
+    if (tabs->currentWidget() == startupArea) {
+        startupArea->setPlainText(StartupTrace::instance().toText());
+    }
 }
 
 void DlgViewLog::loadInitialLogBuffer()
 {
-    QList<QString> logBuffer = Logger::getInstance().getLogBuffer();
-    for (const QString &message : logBuffer)
+    for (const QString &message : Logger::getInstance().getLogHeader())
+        appendLogEntry(message);
+    pullLogEntries();
+}
+
+void DlgViewLog::pullLogEntries()
+{
+    for (const QString &message : Logger::getInstance().getLogEntries(nextLogEntry))
         appendLogEntry(message);
 }
 
@@ -74,6 +101,19 @@ void DlgViewLog::appendLogEntry(const QString &message)
     logArea->appendPlainText(sanitizedMessage);
 }
 
+void DlgViewLog::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+    pullLogEntries();
+    logTimer.start();
+}
+
+void DlgViewLog::hideEvent(QHideEvent *event)
+{
+    logTimer.stop();
+    QDialog::hideEvent(event);
+}
+
 void DlgViewLog::closeEvent(QCloseEvent * /* event */)
 {
     if (coClearLog->isChecked()) {
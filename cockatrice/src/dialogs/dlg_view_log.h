@@ -3,9 +3,11 @@
 
 #include <QCheckBox>
 #include <QDialog>
+#include <QTimer>
 
 class QPlainTextEdit;
 class QCloseEvent;
+class QTabWidget;
 
 class DlgViewLog : public QDialog
 {
@@ -15,17 +17,27 @@ public:
 
 protected:
     void closeEvent(QCloseEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
 
 private:
+    QTabWidget *tabs;
     QPlainTextEdit *logArea;
+    // the phases of the startup, see StartupTrace
+    QPlainTextEdit *startupArea;
     QCheckBox *coClearLog;
     QPushButton *copyToClipboardButton;
+    // pulls the new log entries while the dialog is shown
+    QTimer logTimer;
+    quint64 nextLogEntry;
 
     void loadInitialLogBuffer();
-private slots:
     void appendLogEntry(const QString &message);
+private slots:
+    void pullLogEntries();
     void actCheckBoxChanged(bool abNewValue);
     void actCopyToClipboard();
+    void refreshStartupTrace();
 };
 
 #endif
\ No newline at end of file
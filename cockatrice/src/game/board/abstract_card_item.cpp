@@ -14,7 +14,7 @@
 
 AbstractCardItem::AbstractCardItem(QGraphicsItem *parent, const CardRef &cardRef, Player *_owner, int _id)
     : ArrowTarget(_owner, parent), id(_id), cardRef(cardRef), tapped(false), facedown(false), tapAngle(0),
-      bgColor(Qt::transparent), isHovered(false), realZValue(0)
+      bgColor(Qt::transparent), lowDetail(false), isHovered(false), realZValue(0)
 {
     setCursor(Qt::OpenHandCursor);
     setFlag(ItemIsSelectable);
@@ -92,6 +92,15 @@ QSizeF AbstractCardItem::getTranslatedSize(QPainter *painter) const
                   painter->combinedTransform().map(QLineF(0, 0, 0, boundingRect().height())).length());
 }
 
+void AbstractCardItem::updateLowDetail(const QSizeF &translatedSize)
+{
+    if (lowDetail) {
+        lowDetail = translatedSize.width() < LOW_DETAIL_WIDTH + LOW_DETAIL_HYSTERESIS;
+    } else {
+        lowDetail = translatedSize.width() < LOW_DETAIL_WIDTH;
+    }
+}
+
 void AbstractCardItem::transformPainter(QPainter *painter, const QSizeF &translatedSize, int angle)
 {
     const int MAX_FONT_SIZE = SettingsCache::instance().getMaxFontSize();
@@ -143,12 +152,9 @@ void AbstractCardItem::paintPicture(QPainter *painter, const QSizeF &translatedS
         painter->drawPath(shape());
     }
 
-    if (translatedPixmap.isNull() || SettingsCache::instance().getDisplayCardNames() || facedown) {
+    if (!lowDetail && (translatedPixmap.isNull() || SettingsCache::instance().getDisplayCardNames() || facedown)) {
         painter->save();
         transformPainter(painter, translatedSize, angle);
-        painter->setPen(Qt::white);
-        painter->setBackground(Qt::black);
-        painter->setBackgroundMode(Qt::OpaqueMode);
         QString nameStr;
         if (facedown)
             nameStr = "# " + QString::number(id);
@@ -159,9 +165,10 @@ void AbstractCardItem::paintPicture(QPainter *painter, const QSizeF &translatedS
             }
             nameStr = prefix + cardRef.name;
         }
-        painter->drawText(QRectF(3 * scaleFactor, 3 * scaleFactor, translatedSize.width() - 6 * scaleFactor,
-                                 translatedSize.height() - 6 * scaleFactor),
-                          Qt::AlignTop | Qt::AlignLeft | Qt::TextWrapAnywhere, nameStr);
+        paintOverlayText(painter,
+                         QRectF(3 * scaleFactor, 3 * scaleFactor, translatedSize.width() - 6 * scaleFactor,
+                                translatedSize.height() - 6 * scaleFactor),
+                         Qt::AlignTop | Qt::AlignLeft | Qt::TextWrapAnywhere, nameStr, Qt::white);
         painter->restore();
     }
 
@@ -173,6 +180,7 @@ void AbstractCardItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *
     painter->save();
 
     QSizeF translatedSize = getTranslatedSize(painter);
+    updateLowDetail(translatedSize);
     paintPicture(painter, translatedSize, tapAngle);
 
     painter->setRenderHint(QPainter::Antialiasing, false);
@@ -220,6 +228,19 @@ void AbstractCardItem::setHovered(bool _hovered)
     update();
 }
 
+void AbstractCardItem::resetItemState()
+{
+    setHovered(false);
+    setRealZValue(0);
+    tapped = false;
+    tapAngle = 0;
+    setTransform(QTransform());
+    facedown = false;
+    lowDetail = false;
+    setCursor(Qt::OpenHandCursor);
+    setColor(QString());
+}
+
 void AbstractCardItem::setColor(const QString &_color)
 {
     color = _color;
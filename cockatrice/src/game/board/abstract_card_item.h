@@ -22,6 +22,11 @@ protected:
     int tapAngle;
     QString color;
     QColor bgColor;
+    /**
+     * Whether the card was last painted too small for its text to be readable, in which case the text overlays are
+     * left out. See updateLowDetail().
+     */
+    bool lowDetail;
 
 private:
     bool isHovered;
@@ -112,11 +117,20 @@ public:
     }
 
 protected:
+    /**
+     * Cards narrower than this on screen are painted in low detail. A card only switches back to full detail once it
+     * is LOW_DETAIL_HYSTERESIS wider, so that a card right at the threshold doesn't flicker between the two.
+     */
+    static constexpr qreal LOW_DETAIL_WIDTH = 48;
+    static constexpr qreal LOW_DETAIL_HYSTERESIS = 8;
+    void updateLowDetail(const QSizeF &translatedSize);
     void transformPainter(QPainter *painter, const QSizeF &translatedSize, int angle);
     void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
     void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
     QVariant itemChange(QGraphicsItem::GraphicsItemChange change, const QVariant &value) override;
     void cacheBgColor();
+    // back to the state of a new item, apart from the card shown and the id
+    void resetItemState();
 };
 
 #endif
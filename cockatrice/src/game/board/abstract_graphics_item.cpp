@@ -1,6 +1,9 @@
 #include "abstract_graphics_item.h"
 
+#include <QHash>
 #include <QPainter>
+#include <QPixmapCache>
+#include <QStaticText>
 
 void AbstractGraphicsItem::paintNumberEllipse(int number,
                                               int fontSize,
@@ -11,19 +14,25 @@ void AbstractGraphicsItem::paintNumberEllipse(int number,
 {
     painter->save();
 
-    QString numStr = QString::number(number);
     QFont font("Serif");
     font.setPixelSize(fontSize);
     font.setWeight(QFont::Bold);
 
-    QFontMetrics fm(font);
-    double w = 1.3 *
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 11, 0))
-               fm.horizontalAdvance(numStr);
-#else
-               fm.width(numStr);
-#endif
-    double h = fm.height() * 1.3;
+    // a board full of counters shows the same few numbers over and over, each is laid out once per font size
+    static QHash<QPair<int, int>, QStaticText> numberTexts;
+    if (numberTexts.size() > 4096) {
+        numberTexts.clear();
+    }
+    QStaticText &numberText = numberTexts[qMakePair(fontSize, number)];
+    if (numberText.text().isEmpty()) {
+        numberText.setText(QString::number(number));
+        numberText.setTextFormat(Qt::PlainText);
+        numberText.setPerformanceHint(QStaticText::AggressiveCaching);
+        numberText.prepare(QTransform(), font);
+    }
+
+    double w = 1.3 * numberText.size().width();
+    double h = 1.3 * numberText.size().height();
     if (w < h)
         w = h;
 
@@ -51,11 +60,48 @@ void AbstractGraphicsItem::paintNumberEllipse(int number,
 
     painter->setPen(Qt::black);
     painter->setFont(font);
-    painter->drawText(textRect, Qt::AlignCenter, numStr);
+    painter->drawStaticText(textRect.center() - QPointF(numberText.size().width(), numberText.size().height()) / 2,
+                            numberText);
 
     painter->restore();
 }
 
+void AbstractGraphicsItem::paintOverlayText(QPainter *painter,
+                                            const QRectF &rect,
+                                            int flags,
+                                            const QString &text,
+                                            const QColor &color)
+{
+    const QSize size = rect.size().toSize();
+    if (text.isEmpty() || size.isEmpty()) {
+        return;
+    }
+
+    const QString cacheKey = QString("overlayText_%1_%2_%3_%4x%5_")
+                                 .arg(flags)
+                                 .arg(color.rgba())
+                                 .arg(painter->font().pixelSize())
+                                 .arg(size.width())
+                                 .arg(size.height()) +
+                             text;
+    QPixmap cachedPixmap;
+    if (!QPixmapCache::find(cacheKey, &cachedPixmap)) {
+        cachedPixmap = QPixmap(size);
+        cachedPixmap.fill(Qt::transparent);
+
+        QPainter tempPainter(&cachedPixmap);
+        tempPainter.setFont(painter->font());
+        tempPainter.setPen(color);
+        tempPainter.setBackground(Qt::black);
+        tempPainter.setBackgroundMode(Qt::OpaqueMode);
+        tempPainter.drawText(QRectF(QPointF(0, 0), size), flags, text);
+        tempPainter.end();
+
+        QPixmapCache::insert(cacheKey, cachedPixmap);
+    }
+    painter->drawPixmap(rect.topLeft(), cachedPixmap);
+}
+
 int resetPainterTransform(QPainter *painter)
 {
     painter->resetTransform();
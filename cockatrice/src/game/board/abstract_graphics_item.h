@@ -22,6 +22,12 @@ class AbstractGraphicsItem : public QObject, public QGraphicsItem
     Q_INTERFACES(QGraphicsItem)
 protected:
     void paintNumberEllipse(int number, int radius, const QColor &color, int position, int count, QPainter *painter);
+    /**
+     * Paints text like QPainter::drawText() on an opaque black background, from a pixmap cached for the text, flags,
+     * color, font size and size of rect. The painter has to be in device coordinates, see resetPainterTransform(), so
+     * the pixmap is drawn pixel for pixel; changing the text simply looks up another pixmap.
+     */
+    void paintOverlayText(QPainter *painter, const QRectF &rect, int flags, const QString &text, const QColor &color);
 
 public:
     explicit AbstractGraphicsItem(QGraphicsItem *parent = nullptr) : QGraphicsItem(parent)
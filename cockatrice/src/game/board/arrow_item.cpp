@@ -16,6 +16,7 @@
 #include <QGraphicsScene>
 #include <QGraphicsSceneMouseEvent>
 #include <QPainter>
+#include <QTimer>
 #include <QtMath>
 
 ArrowItem::ArrowItem(Player *_player, int _id, ArrowTarget *_startItem, ArrowTarget *_targetItem, const QColor &_color)
@@ -64,6 +65,17 @@ void ArrowItem::updatePath()
     updatePath(endPoint);
 }
 
+void ArrowItem::schedulePathUpdate()
+{
+    if (pathUpdatePending)
+        return;
+    pathUpdatePending = true;
+    QTimer::singleShot(0, this, [this] {
+        pathUpdatePending = false;
+        updatePath();
+    });
+}
+
 void ArrowItem::updatePath(const QPointF &endPoint)
 {
     const double arrowWidth = 15.0;
@@ -77,8 +89,20 @@ void ArrowItem::updatePath(const QPointF &endPoint)
 
     QPointF startPoint =
         startItem->mapToScene(QPointF(startItem->boundingRect().width() / 2, startItem->boundingRect().height() / 2));
+    if (pathLength >= 0 && startPoint == pathStart && endPoint == pathEnd)
+        return;
+    pathStart = startPoint;
+    pathEnd = endPoint;
+
     QLineF line(startPoint, endPoint);
     qreal lineLength = line.length();
+    setPos(startPoint);
+    setTransform(QTransform().rotate(-line.angle()));
+
+    // the shape only depends on the length, moving or turning the arrow is left to its transformation
+    if (lineLength == pathLength)
+        return;
+    pathLength = lineLength;
 
     prepareGeometryChange();
     if (lineLength < 30)
@@ -112,9 +136,6 @@ void ArrowItem::updatePath(const QPointF &endPoint)
         path.quadTo(c, arrowWidth / 2 * QPointF(qCos((phi - 90) * M_PI / 180), qSin((phi - 90) * M_PI / 180)));
         path.lineTo(-arrowWidth / 2 * QPointF(qCos((phi - 90) * M_PI / 180), qSin((phi - 90) * M_PI / 180)));
     }
-
-    setPos(startPoint);
-    setTransform(QTransform().rotate(-line.angle()));
 }
 
 void ArrowItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*option*/, QWidget * /*widget*/)
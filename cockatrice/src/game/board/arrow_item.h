@@ -16,6 +16,10 @@ class ArrowItem : public QObject, public QGraphicsItem
 private:
     QPainterPath path;
     QMenu *menu;
+    // the end points the path was last laid out for, and the length its shape was built for; -1 before the first one
+    QPointF pathStart, pathEnd;
+    qreal pathLength = -1;
+    bool pathUpdatePending = false;
 
 protected:
     Player *player;
@@ -40,6 +44,11 @@ public:
     }
     void updatePath();
     void updatePath(const QPointF &endPoint);
+    /**
+     * Updates the path once control returns to the event loop. A layout pass moves both ends of an arrow, and every
+     * card attached to them, so this runs updatePath() once instead of for every single move.
+     */
+    void schedulePathUpdate();
 
     int getId() const
     {
@@ -65,6 +74,10 @@ public:
     {
         return targetItem;
     }
+    const QColor &getColor() const
+    {
+        return color;
+    }
     void setTargetLocked(bool _targetLocked)
     {
         targetLocked = _targetLocked;
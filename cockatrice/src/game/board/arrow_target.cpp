@@ -10,6 +10,11 @@ ArrowTarget::ArrowTarget(Player *_owner, QGraphicsItem *parent)
 }
 
 ArrowTarget::~ArrowTarget()
+{
+    deleteArrows();
+}
+
+void ArrowTarget::deleteArrows()
 {
     for (int i = 0; i < arrowsFrom.size(); ++i) {
         arrowsFrom[i]->setStartItem(0);
@@ -19,6 +24,8 @@ ArrowTarget::~ArrowTarget()
         arrowsTo[i]->setTargetItem(0);
         arrowsTo[i]->delArrow();
     }
+    arrowsFrom.clear();
+    arrowsTo.clear();
 }
 
 void ArrowTarget::setBeingPointedAt(bool _beingPointedAt)
@@ -31,10 +38,10 @@ QVariant ArrowTarget::itemChange(QGraphicsItem::GraphicsItemChange change, const
 {
     if (change == ItemScenePositionHasChanged && scene()) {
         for (auto *arrow : arrowsFrom)
-            arrow->updatePath();
+            arrow->schedulePathUpdate();
 
         for (auto *arrow : arrowsTo)
-            arrow->updatePath();
+            arrow->schedulePathUpdate();
     }
 
     return QGraphicsItem::itemChange(change, value);
@@ -59,6 +59,8 @@ public:
     }
 
 protected:
+    // deletes the arrows from and to this item
+    void deleteArrows();
     QVariant itemChange(QGraphicsItem::GraphicsItemChange change, const QVariant &value) override;
 };
 #endif
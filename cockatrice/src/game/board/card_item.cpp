@@ -11,6 +11,7 @@
 #include "../zones/view_zone.h"
 #include "arrow_item.h"
 #include "card_drag_item.h"
+#include "card_item_pool.h"
 #include "pb/serverinfo_card.pb.h"
 
 #include <QApplication>
@@ -24,16 +25,10 @@ CardItem::CardItem(Player *_owner, QGraphicsItem *parent, const CardRef &cardRef
 {
     owner->addCard(this);
 
-    cardMenu = new QMenu;
-    ptMenu = new QMenu;
-    moveMenu = new QMenu;
-
     connect(&SettingsCache::instance().cardCounters(), &CardCounterSettings::colorChanged, this, [this](int counterId) {
         if (counters.contains(counterId))
             update();
     });
-
-    retranslateUi();
 }
 
 CardItem::~CardItem()
@@ -46,7 +41,7 @@ CardItem::~CardItem()
 void CardItem::prepareDelete()
 {
     if (owner != nullptr) {
-        if (owner->getCardMenu() == cardMenu) {
+        if (cardMenu != nullptr && owner->getCardMenu() == cardMenu) {
             owner->setCardMenu(nullptr);
             owner->getGame()->setActiveCard(nullptr);
         }
@@ -69,7 +64,52 @@ void CardItem::deleteLater()
     prepareDelete();
     if (scene())
         static_cast<GameScene *>(scene())->unregisterAnimationItem(this);
-    AbstractCardItem::deleteLater();
+    if (pool) {
+        pool->release(this);
+    } else {
+        AbstractCardItem::deleteLater();
+    }
+}
+
+void CardItem::recycle()
+{
+    emit deleteCardInfoPopup(cardRef.name);
+    // TabGame connects to these once the card is added again
+    disconnect(this, &AbstractCardItem::hovered, nullptr, nullptr);
+    disconnect(this, &AbstractCardItem::showCardInfoPopup, nullptr, nullptr);
+    disconnect(this, &AbstractCardItem::deleteCardInfoPopup, nullptr, nullptr);
+    disconnect(this, &AbstractCardItem::cardShiftClicked, nullptr, nullptr);
+
+    deleteArrows();
+    deleteDragItem();
+    setSelected(false);
+    setParentItem(nullptr);
+    if (scene()) {
+        scene()->removeItem(this);
+    }
+    setVisible(true);
+
+    resetState();
+    resetItemState();
+    zone = nullptr;
+    destroyOnZoneChange = false;
+    gridPoint = QPoint();
+    if (cardMenu != nullptr) {
+        cardMenu->clear();
+        ptMenu->clear();
+        moveMenu->clear();
+    }
+}
+
+void CardItem::reuse(Player *_owner, QGraphicsItem *parent, const CardRef &cardRef, int _cardid, CardZone *_zone)
+{
+    owner = _owner;
+    id = _cardid;
+    zone = _zone;
+    setCardRef(cardRef);
+    setParentItem(parent);
+
+    owner->addCard(this);
 }
 
 void CardItem::setZone(CardZone *_zone)
@@ -77,8 +117,22 @@ void CardItem::setZone(CardZone *_zone)
     zone = _zone;
 }
 
+void CardItem::createMenus()
+{
+    if (cardMenu != nullptr) {
+        return;
+    }
+    cardMenu = new QMenu;
+    ptMenu = new QMenu;
+    moveMenu = new QMenu;
+    retranslateUi();
+}
+
 void CardItem::retranslateUi()
 {
+    if (cardMenu == nullptr) {
+        return;
+    }
     moveMenu->setTitle(tr("&Move to"));
     ptMenu->setTitle(tr("&Power / toughness"));
 }
@@ -96,43 +150,47 @@ void CardItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
         counterIterator.next();
         QColor _color = cardCounterSettings.color(counterIterator.key());
 
-        paintNumberEllipse(counterIterator.value(), 14, _color, i, counters.size(), painter);
+        if (lowDetail) {
+            // the numbers wouldn't be readable, a dot per counter is enough to tell they are there
+            const qreal dotSize = 12;
+            painter->save();
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(_color);
+            painter->drawEllipse(QRectF(4 + i * (dotSize + 2), 4, dotSize, dotSize));
+            painter->restore();
+        } else {
+            paintNumberEllipse(counterIterator.value(), 14, _color, i, counters.size(), painter);
+        }
         ++i;
     }
 
     QSizeF translatedSize = getTranslatedSize(painter);
     qreal scaleFactor = translatedSize.width() / boundingRect().width();
 
-    if (!pt.isEmpty()) {
+    if (!pt.isEmpty() && !lowDetail) {
         painter->save();
         transformPainter(painter, translatedSize, tapAngle);
 
-        if (!getFaceDown() && pt == exactCard.getInfo().getPowTough()) {
-            painter->setPen(Qt::white);
-        } else {
-            painter->setPen(QColor(255, 150, 0)); // dark orange
+        QColor ptColor = Qt::white;
+        if (getFaceDown() || pt != exactCard.getInfo().getPowTough()) {
+            ptColor = QColor(255, 150, 0); // dark orange
         }
 
-        painter->setBackground(Qt::black);
-        painter->setBackgroundMode(Qt::OpaqueMode);
-
-        painter->drawText(QRectF(4 * scaleFactor, 4 * scaleFactor, translatedSize.width() - 10 * scaleFactor,
-                                 translatedSize.height() - 8 * scaleFactor),
-                          Qt::AlignRight | Qt::AlignBottom, pt);
+        paintOverlayText(painter,
+                         QRectF(4 * scaleFactor, 4 * scaleFactor, translatedSize.width() - 10 * scaleFactor,
+                                translatedSize.height() - 8 * scaleFactor),
+                         Qt::AlignRight | Qt::AlignBottom, pt, ptColor);
         painter->restore();
     }
 
-    if (!annotation.isEmpty()) {
+    if (!annotation.isEmpty() && !lowDetail) {
         painter->save();
 
         transformPainter(painter, translatedSize, tapAngle);
-        painter->setBackground(Qt::black);
-        painter->setBackgroundMode(Qt::OpaqueMode);
-        painter->setPen(Qt::white);
-
-        painter->drawText(QRectF(4 * scaleFactor, 4 * scaleFactor, translatedSize.width() - 8 * scaleFactor,
-                                 translatedSize.height() - 8 * scaleFactor),
-                          Qt::AlignCenter | Qt::TextWrapAnywhere, annotation);
+        paintOverlayText(painter,
+                         QRectF(4 * scaleFactor, 4 * scaleFactor, translatedSize.width() - 8 * scaleFactor,
+                                translatedSize.height() - 8 * scaleFactor),
+                         Qt::AlignCenter | Qt::TextWrapAnywhere, annotation, Qt::white);
         painter->restore();
     }
 
@@ -252,6 +310,31 @@ void CardItem::processCardInfo(const ServerInfo_Card &_info)
     setDoesntUntap(_info.doesnt_untap());
 }
 
+void CardItem::writeCardInfo(ServerInfo_Card &info) const
+{
+    info.set_id(getId());
+    info.set_name(getName().toStdString());
+    info.set_provider_id(getProviderId().toStdString());
+    info.set_attacking(attacking);
+    info.set_face_down(getFaceDown());
+    info.set_pt(pt.toStdString());
+    info.set_annotation(annotation.toStdString());
+    info.set_color(getColor().toStdString());
+    info.set_tapped(getTapped());
+    info.set_destroy_on_zone_change(destroyOnZoneChange);
+    info.set_doesnt_untap(doesntUntap);
+    for (auto counter = counters.cbegin(); counter != counters.cend(); ++counter) {
+        ServerInfo_CardCounter *counterInfo = info.add_counter_list();
+        counterInfo->set_id(counter.key());
+        counterInfo->set_value(counter.value());
+    }
+    if (attachedTo && attachedTo->getZone()) {
+        info.set_attach_player_id(attachedTo->getZone()->getPlayer()->getId());
+        info.set_attach_zone(attachedTo->getZone()->getName().toStdString());
+        info.set_attach_card_id(attachedTo->getId());
+    }
+}
+
 CardDragItem *CardItem::createDragItem(int _id, const QPointF &_pos, const QPointF &_scenePos, bool faceDown)
 {
     deleteDragItem();
@@ -477,9 +560,10 @@ QVariant CardItem::itemChange(GraphicsItemChange change, const QVariant &value)
 {
     if ((change == ItemSelectedHasChanged) && owner != nullptr) {
         if (value == true) {
+            createMenus();
             owner->setCardMenu(cardMenu);
             owner->getGame()->setActiveCard(this);
-        } else if (owner->getCardMenu() == cardMenu) {
+        } else if (cardMenu != nullptr && owner->getCardMenu() == cardMenu) {
             owner->setCardMenu(nullptr);
             owner->getGame()->setActiveCard(nullptr);
         }
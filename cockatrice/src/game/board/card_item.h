@@ -4,8 +4,11 @@
 #include "abstract_card_item.h"
 #include "server_card.h"
 
+#include <QPointer>
+
 class CardDatabase;
 class CardDragItem;
+class CardItemPool;
 class CardZone;
 class ServerInfo_Card;
 class Player;
@@ -20,7 +23,11 @@ const int ROTATION_DEGREES_PER_FRAME = 10;
 class CardItem : public AbstractCardItem
 {
     Q_OBJECT
+    friend class CardItemPool;
+
 private:
+    // where deleteLater() hands the card over to, if it came from a pool
+    QPointer<CardItemPool> pool;
     CardZone *zone;
     bool attacking;
     QMap<int, int> counters;
@@ -33,9 +40,14 @@ private:
     CardItem *attachedTo;
     QList<CardItem *> attachedCards;
 
-    QMenu *cardMenu, *ptMenu, *moveMenu;
+    // most cards are never selected, so their menus are only created once they are
+    QMenu *cardMenu = nullptr, *ptMenu = nullptr, *moveMenu = nullptr;
 
+    void createMenus();
     void prepareDelete();
+    // for the pool: leaves the scene and drops the state of the game, and is set up again for another card
+    void recycle();
+    void reuse(Player *_owner, QGraphicsItem *parent, const CardRef &cardRef, int _cardid, CardZone *_zone);
     void handleClickedToPlay(bool shiftHeld);
 public slots:
     void deleteLater();
@@ -134,6 +146,7 @@ public:
     }
     void resetState(bool keepAnnotations = false);
     void processCardInfo(const ServerInfo_Card &_info);
+    void writeCardInfo(ServerInfo_Card &info) const;
 
     QMenu *getCardMenu() const
     {
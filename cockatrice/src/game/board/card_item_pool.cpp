@@ -0,0 +1,64 @@
+#include "card_item_pool.h"
+
+#include "../game_scene.h"
+#include "../player/player.h"
+#include "card_item.h"
+
+#include <QTimer>
+
+CardItemPool::CardItemPool(QObject *parent) : QObject(parent)
+{
+}
+
+CardItemPool::~CardItemPool()
+{
+    qDeleteAll(idleCards);
+    for (const QPointer<CardItem> &card : releasedCards) {
+        delete card.data();
+    }
+}
+
+CardItem *CardItemPool::acquire(Player *owner, QGraphicsItem *parent, const CardRef &cardRef, int cardId, CardZone *zone)
+{
+    auto *gameScene = qobject_cast<GameScene *>(owner->scene());
+    CardItemPool *pool = gameScene ? gameScene->getCardPool() : nullptr;
+
+    CardItem *card;
+    if (pool && !pool->idleCards.isEmpty()) {
+        card = pool->idleCards.takeLast();
+        card->reuse(owner, parent, cardRef, cardId, zone);
+    } else {
+        card = new CardItem(owner, parent, cardRef, cardId, zone);
+    }
+    card->pool = pool;
+    return card;
+}
+
+void CardItemPool::release(CardItem *card)
+{
+    if (releasedCards.contains(card)) {
+        return;
+    }
+    if (releasedCards.isEmpty()) {
+        QTimer::singleShot(0, this, &CardItemPool::takeBackReleasedCards);
+    }
+    releasedCards.append(card);
+}
+
+void CardItemPool::takeBackReleasedCards()
+{
+    const QList<QPointer<CardItem>> cards = releasedCards;
+    releasedCards.clear();
+
+    for (const QPointer<CardItem> &card : cards) {
+        if (!card) {
+            continue;
+        }
+        if (idleCards.size() >= maxIdleCards) {
+            delete card.data();
+            continue;
+        }
+        card->recycle();
+        idleCards.append(card.data());
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef CARD_ITEM_POOL_H
+#define CARD_ITEM_POOL_H
+
+#include "card_ref.h"
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+
+class CardItem;
+class CardZone;
+class Player;
+class QGraphicsItem;
+
+/**
+ * Keeps the deleted CardItems of a GameScene around for reuse. Tokens, zone views and the cards of hidden zones come
+ * and go all game long; a card taken from the pool doesn't have to build its graphics item, connections and menus
+ * again.
+ *
+ * CardItem::deleteLater() hands a card over to the pool of its scene instead of deleting it. The card is taken back
+ * once control returns to the event loop, when it would have been deleted: it is removed from the scene and reset.
+ * Cards beyond maxIdleCards are deleted as before.
+ */
+class CardItemPool : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr int maxIdleCards = 256;
+
+    explicit CardItemPool(QObject *parent = nullptr);
+    ~CardItemPool() override;
+
+    /**
+     * A card like the one the CardItem constructor builds, taken from the pool of the scene owner is in. The card is
+     * new if that pool is empty or owner isn't in a GameScene yet.
+     */
+    static CardItem *acquire(Player *owner,
+                             QGraphicsItem *parent = nullptr,
+                             const CardRef &cardRef = {},
+                             int cardId = -1,
+                             CardZone *zone = nullptr);
+    void release(CardItem *card);
+
+private:
+    QList<CardItem *> idleCards;
+    // handed over since the last pass of the event loop; cards deleted with their zone meanwhile turn null
+    QList<QPointer<CardItem>> releasedCards;
+
+private slots:
+    void takeBackReleasedCards();
+};
+
+#endif
@@ -3,6 +3,7 @@
 #include "../../client/ui/picture_loader/picture_loader.h"
 #include "../../settings/cache_settings.h"
 #include "../../utility/card_set_comparator.h"
+#include "./card_database_cache.h"
 #include "./card_database_parser/cockatrice_xml_3.h"
 #include "./card_database_parser/cockatrice_xml_4.h"
 
@@ -13,6 +14,9 @@
 #include <QFile>
 #include <QMessageBox>
 #include <QRegularExpression>
+#include <QSet>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
 #include <algorithm>
 #include <utility>
 
@@ -20,22 +24,21 @@ CardDatabase::CardDatabase(QObject *parent) : QObject(parent), loadStatus(NotLoa
 {
     qRegisterMetaType<CardInfoPtr>("CardInfoPtr");
     qRegisterMetaType<CardInfoPtr>("CardSetPtr");
+    qRegisterMetaType<QList<CardInfoPtr>>("QList<CardInfoPtr>");
 
-    // add new parsers here
-    availableParsers << new CockatriceXml4Parser;
-    availableParsers << new CockatriceXml3Parser;
-
-    for (auto &parser : availableParsers) {
-        connect(parser, &ICardDatabaseParser::addCard, this, &CardDatabase::addCard, Qt::DirectConnection);
-        connect(parser, &ICardDatabaseParser::addSet, this, &CardDatabase::addSet, Qt::DirectConnection);
-    }
+    availableParsers = createParsers();
 
     connect(&SettingsCache::instance(), &SettingsCache::cardDatabasePathChanged, this,
-            &CardDatabase::loadCardDatabases);
+            &CardDatabase::reloadCardDatabasesInBackground);
 }
 
 CardDatabase::~CardDatabase()
 {
+    // the staging databases belong to their watchers, which are deleted along with this one
+    cancelBackgroundReload();
+    for (auto *watcher : findChildren<QFutureWatcher<LoadStatus> *>(QString(), Qt::FindDirectChildrenOnly)) {
+        watcher->waitForFinished();
+    }
     clear();
     qDeleteAll(availableParsers);
 }
@@ -52,9 +55,9 @@ void CardDatabase::clear()
 
     cards.clear();
     simpleNameCards.clear();
+    relationIndex.clear();
 
     sets.clear();
-    ICardDatabaseParser::clearSetlist();
 
     loadStatus = NotLoaded;
 
@@ -79,13 +82,48 @@ void CardDatabase::addCard(CardInfoPtr card)
         return;
     }
 
+    if (bulkLoadDepth > 0) {
+        // beginBulkLoad() holds the lock
+        cards.insert(card->getName(), card);
+        simpleNameCards.insert(card->getSimpleName(), card);
+        relationIndex.cardAdded(card);
+        bulkAddedCards.append(card);
+        return;
+    }
+
     addCardMutex->lock();
     cards.insert(card->getName(), card);
     simpleNameCards.insert(card->getSimpleName(), card);
+    relationIndex.cardAdded(card);
     addCardMutex->unlock();
     emit cardAdded(card);
 }
 
+void CardDatabase::beginBulkLoad(int expectedCards)
+{
+    if (bulkLoadDepth++ > 0) {
+        return;
+    }
+
+    addCardMutex->lock();
+    cards.reserve(cards.size() + expectedCards);
+    simpleNameCards.reserve(simpleNameCards.size() + expectedCards);
+    bulkAddedCards.reserve(expectedCards);
+}
+
+void CardDatabase::endBulkLoad()
+{
+    if (bulkLoadDepth == 0 || --bulkLoadDepth > 0) {
+        return;
+    }
+
+    addCardMutex->unlock();
+    const QList<CardInfoPtr> addedCards = std::exchange(bulkAddedCards, {});
+    if (!addedCards.isEmpty()) {
+        emit cardsAdded(addedCards);
+    }
+}
+
 void CardDatabase::removeCard(CardInfoPtr card)
 {
     if (card.isNull()) {
@@ -99,12 +137,10 @@ void CardDatabase::removeCard(CardInfoPtr card)
     for (auto *cardRelation : card->getReverseRelatedCards())
         cardRelation->deleteLater();
 
-    for (auto *cardRelation : card->getReverseRelatedCards2Me())
-        cardRelation->deleteLater();
-
     removeCardMutex->lock();
     cards.remove(card->getName());
     simpleNameCards.remove(card->getSimpleName());
+    relationIndex.cardRemoved(card);
     removeCardMutex->unlock();
     emit cardRemoved(card);
 }
@@ -143,15 +179,44 @@ QList<CardInfoPtr> CardDatabase::getCardInfos(const QStringList &cardNames) cons
  * If the providerId is empty, will default to the preferred printing.
  * If providerId is given but not found, the PrintingInfo will be empty.
  *
+ * Every distinct CardRef is only looked up once, so the copies of a card cost nothing, and the lookups of large lists
+ * like cubes are spread over the thread pool.
+ *
  * @param cardRefs The cards to look up. If providerId is empty for an entry, will default to the preferred printing for
  * that entry. If providerId is given but not found, the PrintingInfo will be empty for that entry.
  * @return A list of cards. Any failed lookups will be ignored and dropped from the resulting list.
  */
 QList<ExactCard> CardDatabase::getCards(const QList<CardRef> &cardRefs) const
 {
-    QList<ExactCard> cards;
+    QHash<QPair<QString, QString>, int> distinctIndexes;
+    QList<CardRef> distinctRefs;
+    QVector<int> refIndexes;
+    refIndexes.reserve(cardRefs.size());
     for (const auto &cardRef : cardRefs) {
-        ExactCard card = getCard(cardRef);
+        const QPair<QString, QString> key(cardRef.name, cardRef.providerId);
+        auto index = distinctIndexes.constFind(key);
+        if (index == distinctIndexes.constEnd()) {
+            index = distinctIndexes.insert(key, distinctRefs.size());
+            distinctRefs.append(cardRef);
+        }
+        refIndexes.append(*index);
+    }
+
+    QList<ExactCard> distinctCards;
+    if (distinctRefs.size() >= PARALLEL_LOOKUP_THRESHOLD) {
+        // the lookups only read the database, which isn't changed while a deck is resolved
+        distinctCards = QtConcurrent::blockingMapped<QList<ExactCard>>(
+            distinctRefs, [this](const CardRef &cardRef) { return getCard(cardRef); });
+    } else {
+        for (const auto &cardRef : distinctRefs) {
+            distinctCards.append(getCard(cardRef));
+        }
+    }
+
+    QList<ExactCard> cards;
+    cards.reserve(cardRefs.size());
+    for (int index : refIndexes) {
+        const ExactCard &card = distinctCards.at(index);
         if (card)
             cards.append(card);
     }
@@ -199,11 +264,8 @@ ExactCard CardDatabase::guessCard(const CardRef &cardRef) const
     CardInfoPtr temp = getCardInfo(cardRef.name);
 
     if (temp == nullptr) { // get card by simple name instead
+        // simplifying a simplified name changes nothing, so a single lookup is enough
         temp = getCardBySimpleName(cardRef.name);
-        if (temp == nullptr) { // still could not find the card, so simplify the cardName too
-            const auto &simpleCardName = CardInfo::simplifyName(cardRef.name);
-            temp = getCardBySimpleName(simpleCardName);
-        }
     }
 
     if (cardRef.providerId.isEmpty() || cardRef.providerId.isNull()) {
@@ -238,40 +300,120 @@ SetList CardDatabase::getSetList() const
     return result;
 }
 
-LoadStatus CardDatabase::loadFromFile(const QString &fileName)
+QVector<ICardDatabaseParser *> CardDatabase::createParsers()
 {
-    QFile file(fileName);
+    // add new parsers here
+    return {new CockatriceXml4Parser, new CockatriceXml3Parser};
+}
+
+/**
+ * Parses a card database file without touching the database, so that several files can be parsed at once.
+ * Every call uses parsers of its own, as they keep the sets they have seen.
+ */
+CardDatabase::StagedDatabase CardDatabase::stageCardDatabase(const QString &path)
+{
+    StagedDatabase staged;
+    staged.path = path;
+    if (path.isEmpty()) {
+        return staged;
+    }
+
+    auto startTime = QTime::currentTime();
+
+    QFile file(path);
     file.open(QIODevice::ReadOnly);
     if (!file.isOpen()) {
-        return FileError;
+        staged.status = FileError;
+        return staged;
     }
 
-    for (auto parser : availableParsers) {
+    const QVector<ICardDatabaseParser *> parsers = createParsers();
+    staged.status = Invalid;
+    for (auto parser : parsers) {
         file.reset();
-        if (parser->getCanParseFile(fileName, file)) {
+        if (parser->getCanParseFile(path, file)) {
+            connect(parser, &ICardDatabaseParser::addCard, [&staged](CardInfoPtr card) { staged.cards << card; });
+            connect(parser, &ICardDatabaseParser::addSet, [&staged](CardSetPtr set) { staged.sets << set; });
             file.reset();
             parser->parseFile(file);
-            return Ok;
+            staged.status = Ok;
+            break;
         }
     }
+    qDeleteAll(parsers);
 
-    return Invalid;
+    staged.msecs = startTime.msecsTo(QTime::currentTime());
+    return staged;
 }
 
-LoadStatus CardDatabase::loadCardDatabase(const QString &path)
+/**
+ * Adds what was parsed from a file to the database, with the same result as if the file had been parsed into the
+ * database directly after the ones merged before it.
+ */
+void CardDatabase::mergeStagedDatabase(const StagedDatabase &staged)
 {
-    auto startTime = QTime::currentTime();
-    LoadStatus tempLoadStatus = NotLoaded;
-    if (!path.isEmpty()) {
-        loadFromFileMutex->lock();
-        tempLoadStatus = loadFromFile(path);
-        loadFromFileMutex->unlock();
+    // a set belongs to the first file mentioning it, the parsers of later files created their own copy of it
+    QHash<QString, CardSetPtr> knownSets;
+    for (const CardSetPtr &set : staged.sets) {
+        const CardSetPtr knownSet = sets.value(set->getShortName());
+        if (knownSet) {
+            knownSets.insert(set->getShortName(), knownSet);
+        } else {
+            addSet(set);
+        }
     }
 
-    int msecs = startTime.msecsTo(QTime::currentTime());
-    qCInfo(CardDatabaseLoadingLog) << "Loaded card database: Path =" << path << "Status =" << tempLoadStatus
+    for (const CardInfoPtr &card : staged.cards) {
+        bool usesKnownSet = false;
+        for (auto it = card->getSets().cbegin(); it != card->getSets().cend() && !usesKnownSet; ++it) {
+            usesKnownSet = knownSets.contains(it.key());
+        }
+        if (!usesKnownSet) {
+            addCard(card);
+            continue;
+        }
+
+        // rebuild the card on the sets of the database
+        SetToPrintingsMap printings;
+        for (auto it = card->getSets().cbegin(); it != card->getSets().cend(); ++it) {
+            for (const PrintingInfo &printing : it.value()) {
+                PrintingInfo knownPrinting(knownSets.value(it.key(), printing.getSet()));
+                for (const QString &propertyName : printing.getProperties()) {
+                    knownPrinting.setProperty(propertyName, printing.getProperty(propertyName));
+                }
+                printings[it.key()].append(knownPrinting);
+            }
+        }
+        QVariantHash properties;
+        for (const QString &propertyName : card->getProperties()) {
+            properties.insert(propertyName, card->getProperty(propertyName));
+        }
+
+        addCard(CardInfo::newInstance(card->getName(), card->getText(), card->getIsToken(), properties,
+                                      card->getRelatedCards(), card->getReverseRelatedCards(), printings,
+                                      card->getCipt(), card->getLandscapeOrientation(), card->getTableRow(),
+                                      card->getUpsideDownArt()));
+    }
+
+    qCInfo(CardDatabaseLoadingLog) << "Loaded card database: Path =" << staged.path << "Status =" << staged.status
                                    << "Cards =" << cards.size() << "Sets =" << sets.size()
-                                   << QString("%1ms").arg(msecs);
+                                   << QString("%1ms").arg(staged.msecs);
+}
+
+LoadStatus CardDatabase::loadFromFile(const QString &fileName)
+{
+    const StagedDatabase staged = stageCardDatabase(fileName);
+    beginBulkLoad(staged.cards.size());
+    mergeStagedDatabase(staged);
+    endBulkLoad();
+    return staged.status;
+}
+
+LoadStatus CardDatabase::loadCardDatabase(const QString &path)
+{
+    loadFromFileMutex->lock();
+    LoadStatus tempLoadStatus = loadFromFile(path);
+    loadFromFileMutex->unlock();
 
     return tempLoadStatus;
 }
@@ -282,34 +424,81 @@ LoadStatus CardDatabase::loadCardDatabases()
 
     qCInfo(CardDatabaseLoadingLog) << "Card Database Loading Started";
 
+    readCardDatabases();
+    announceLoadStatus();
+
+    reloadDatabaseMutex->unlock();
+    return loadStatus;
+}
+
+/**
+ * Clears the database and loads all the card database files into it, from the cache if it is up to date.
+ * Stops early, with the status NotLoaded, once reloadCancelled is set.
+ */
+LoadStatus CardDatabase::readCardDatabases()
+{
     clear(); // remove old db
 
-    loadStatus = loadCardDatabase(SettingsCache::instance().getCardDatabasePath()); // load main card database
-    loadCardDatabase(SettingsCache::instance().getTokenDatabasePath());             // load tokens database
-    loadCardDatabase(SettingsCache::instance().getSpoilerCardDatabasePath());       // load spoilers database
+    const QStringList customDatabasePaths = findCustomDatabasePaths();
+    const QStringList sourcePaths = getSourcePaths(customDatabasePaths);
+    const QString cacheFilePath = getCacheFilePath();
+    const QByteArray sourceKey = CardDatabaseCache::sourceKey(sourcePaths);
+
+    emit cardDatabaseLoadingProgress(0, sourcePaths.size());
+    if (!cacheFilePath.isEmpty() && loadFromCache(cacheFilePath, sourceKey)) {
+        loadStatus = Ok;
+        // the spoilers are small, parsing them again lets an update of them be applied without a full reload
+        loadedSpoilers = SettingsCache::instance().getDownloadSpoilersStatus() ? stageCardDatabase(sourcePaths.at(2))
+                                                                             : StagedDatabase();
+    } else {
+        // parse the main, tokens, spoilers and custom databases all at once,
+        // then merge them in that order, as if they had been loaded one after another
+        std::atomic<int> parsedFiles(0);
+        const QList<StagedDatabase> stagedDatabases = QtConcurrent::blockingMapped<QList<StagedDatabase>>(
+            sourcePaths, [this, &parsedFiles, &sourcePaths](const QString &path) {
+                if (reloadCancelled) {
+                    return StagedDatabase();
+                }
+                StagedDatabase staged = stageCardDatabase(path);
+                emit cardDatabaseLoadingProgress(++parsedFiles, sourcePaths.size());
+                return staged;
+            });
+        if (reloadCancelled) {
+            loadStatus = NotLoaded;
+            return loadStatus;
+        }
 
-    // find all custom card databases, recursively & following symlinks
-    // then load them alphabetically
-    QDirIterator customDatabaseIterator(SettingsCache::instance().getCustomCardDatabasePath(), QStringList() << "*.xml",
-                                        QDir::Files, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
-    QStringList databasePaths;
-    while (customDatabaseIterator.hasNext()) {
-        customDatabaseIterator.next();
-        databasePaths.push_back(customDatabaseIterator.filePath());
-    }
-    databasePaths.sort();
+        int stagedCards = 0;
+        for (const StagedDatabase &staged : stagedDatabases) {
+            stagedCards += staged.cards.size();
+        }
 
-    for (auto i = 0; i < databasePaths.size(); ++i) {
-        const auto &databasePath = databasePaths.at(i);
-        qCInfo(CardDatabaseLoadingLog) << "Loading Custom Set" << i << "(" << databasePath << ")";
-        loadCardDatabase(databasePath);
-    }
+        const int firstCustomDatabase = sourcePaths.size() - customDatabasePaths.size();
+        loadFromFileMutex->lock();
+        beginBulkLoad(stagedCards);
+        for (auto i = 0; i < stagedDatabases.size(); ++i) {
+            if (i >= firstCustomDatabase) {
+                qCInfo(CardDatabaseLoadingLog) << "Loading Custom Set" << i - firstCustomDatabase << "("
+                                               << stagedDatabases.at(i).path << ")";
+            }
+            mergeStagedDatabase(stagedDatabases.at(i));
+        }
+        endBulkLoad();
+        loadFromFileMutex->unlock();
+        loadStatus = stagedDatabases.first().status;
+        loadedSpoilers = stagedDatabases.at(2);
 
-    // AFTER all the cards have been loaded
+        if (loadStatus == Ok && !cacheFilePath.isEmpty() && !reloadCancelled) {
+            CardDatabaseCache(cacheFilePath).save(sourceKey, sets, cards);
+        }
+    }
+    emit cardDatabaseLoadingProgress(sourcePaths.size(), sourcePaths.size());
 
-    // resolve the reverse-related tags
-    refreshCachedReverseRelatedCards();
+    return loadStatus;
+}
 
+void CardDatabase::announceLoadStatus()
+{
     if (loadStatus == Ok) {
         checkUnknownSets(); // update deck editors, etc
         qCInfo(CardDatabaseLoadingSuccessOrFailureLog) << "Card Database Loading Success";
@@ -318,11 +507,331 @@ LoadStatus CardDatabase::loadCardDatabases()
         qCInfo(CardDatabaseLoadingSuccessOrFailureLog) << "Card Database Loading Failed";
         emit cardDatabaseLoadingFailed(); // bring up the settings dialog
     }
+}
+
+void CardDatabase::reloadCardDatabasesInBackground()
+{
+    cancelBackgroundReload();
+
+    qCInfo(CardDatabaseLoadingLog) << "Card Database Background Reload Started";
+
+    auto *watcher = new QFutureWatcher<LoadStatus>(this);
+    auto *staging = new CardDatabase(watcher);
+    // the staging database loads once, what the settings change afterwards is up to the next reload
+    disconnect(&SettingsCache::instance(), nullptr, staging, nullptr);
+    stagingDatabase = staging;
+
+    // the progress is reported from the worker threads
+    connect(staging, &CardDatabase::cardDatabaseLoadingProgress, this,
+            [this, staging](int parsedFiles, int totalFiles) {
+                if (stagingDatabase == staging) {
+                    emit cardDatabaseLoadingProgress(parsedFiles, totalFiles);
+                }
+            });
+    connect(watcher, &QFutureWatcher<LoadStatus>::finished, this, [this, watcher, staging] {
+        // takes the staging database along, and with it the cards it replaced
+        watcher->deleteLater();
+        if (stagingDatabase != staging) {
+            return; // cancelled
+        }
+        stagingDatabase = nullptr;
+
+        if (watcher->result() != Ok) {
+            qCInfo(CardDatabaseLoadingSuccessOrFailureLog) << "Card Database Reload Failed, keeping the loaded cards";
+            emit cardDatabaseLoadingFailed(); // bring up the settings dialog
+            return;
+        }
+        adoptDatabase(*staging);
+        announceLoadStatus();
+    });
+    watcher->setFuture(QtConcurrent::run([staging] { return staging->readCardDatabases(); }));
+}
+
+void CardDatabase::cancelBackgroundReload()
+{
+    if (stagingDatabase == nullptr) {
+        return;
+    }
+
+    qCInfo(CardDatabaseLoadingLog) << "Card Database Background Reload Cancelled";
+    stagingDatabase->reloadCancelled = true;
+    stagingDatabase = nullptr;
+}
+
+/**
+ * Takes over the cards and sets of a database that was loaded in the background, in a single step on the GUI thread.
+ * The replaced cards end up in the staging database and go away with it.
+ */
+void CardDatabase::adoptDatabase(CardDatabase &staged)
+{
+    reloadDatabaseMutex->lock();
+    clearDatabaseMutex->lock();
+    std::swap(cards, staged.cards);
+    std::swap(simpleNameCards, staged.simpleNameCards);
+    std::swap(relationIndex, staged.relationIndex);
+    std::swap(sets, staged.sets);
+    std::swap(loadedSpoilers, staged.loadedSpoilers);
+    loadStatus = staged.loadStatus;
+    clearDatabaseMutex->unlock();
+    reloadDatabaseMutex->unlock();
+
+    qCInfo(CardDatabaseLoadingLog) << "Card Database Background Reload Finished: Cards =" << cards.size()
+                                   << "Sets =" << sets.size();
+    emit cardListReplaced();
+}
+
+/**
+ * Loads the spoiler database again after it was updated, changing only the cards that differ from the spoilers that
+ * were loaded last.
+ *
+ * Falls back to loadCardDatabases() when the update touches a card or set that another database file also contributes
+ * to, since only a full reload merges those the same way as before.
+ */
+LoadStatus CardDatabase::reloadSpoilerDatabase()
+{
+    reloadDatabaseMutex->lock();
+
+    const StagedDatabase spoilers = stageCardDatabase(SettingsCache::instance().getSpoilerCardDatabasePath());
+    if (loadStatus != Ok || loadedSpoilers.status != Ok || spoilers.status != Ok ||
+        spoilers.path != loadedSpoilers.path || !applySpoilerUpdate(spoilers)) {
+        reloadDatabaseMutex->unlock();
+        return loadCardDatabases();
+    }
+    loadedSpoilers = spoilers;
+
+    const QString cacheFilePath = getCacheFilePath();
+    if (!cacheFilePath.isEmpty()) {
+        const QByteArray sourceKey = CardDatabaseCache::sourceKey(getSourcePaths(findCustomDatabasePaths()));
+        CardDatabaseCache(cacheFilePath).save(sourceKey, sets, cards);
+    }
+
+    checkUnknownSets();
+    emit cardDatabaseLoadingFinished();
 
     reloadDatabaseMutex->unlock();
     return loadStatus;
 }
 
+/**
+ * Whether two parsed cards would end up the same in the database.
+ */
+static bool isSameCard(const CardInfoPtr &card, const CardInfoPtr &other)
+{
+    if (card->getText() != other->getText() || card->getIsToken() != other->getIsToken() ||
+        card->getCipt() != other->getCipt() || card->getLandscapeOrientation() != other->getLandscapeOrientation() ||
+        card->getTableRow() != other->getTableRow() || card->getUpsideDownArt() != other->getUpsideDownArt()) {
+        return false;
+    }
+
+    const QStringList propertyNames = card->getProperties();
+    if (propertyNames.size() != other->getProperties().size()) {
+        return false;
+    }
+    for (const QString &propertyName : propertyNames) {
+        if (card->getProperty(propertyName) != other->getProperty(propertyName)) {
+            return false;
+        }
+    }
+
+    if (card->getSets().keys() != other->getSets().keys()) {
+        return false;
+    }
+    for (auto it = card->getSets().cbegin(); it != card->getSets().cend(); ++it) {
+        const QList<PrintingInfo> &otherPrintings = other->getSets().value(it.key());
+        if (it.value().size() != otherPrintings.size()) {
+            return false;
+        }
+        for (int i = 0; i < otherPrintings.size(); ++i) {
+            const PrintingInfo &printing = it.value().at(i);
+            const QStringList printingPropertyNames = printing.getProperties();
+            if (printingPropertyNames.size() != otherPrintings.at(i).getProperties().size()) {
+                return false;
+            }
+            for (const QString &propertyName : printingPropertyNames) {
+                if (printing.getProperty(propertyName) != otherPrintings.at(i).getProperty(propertyName)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    const QList<CardRelation *> relations = card->getAllRelatedCards();
+    const QList<CardRelation *> otherRelations = other->getAllRelatedCards();
+    if (relations.size() != otherRelations.size()) {
+        return false;
+    }
+    for (int i = 0; i < relations.size(); ++i) {
+        const CardRelation *relation = relations.at(i), *otherRelation = otherRelations.at(i);
+        if (relation->getName() != otherRelation->getName() ||
+            relation->getAttachType() != otherRelation->getAttachType() ||
+            relation->getIsCreateAllExclusion() != otherRelation->getIsCreateAllExclusion() ||
+            relation->getIsVariable() != otherRelation->getIsVariable() ||
+            relation->getDefaultCount() != otherRelation->getDefaultCount() ||
+            relation->getIsPersistent() != otherRelation->getIsPersistent()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Replaces the cards of loadedSpoilers by the ones of spoilers, through removeCard() and addCard().
+ *
+ * @return false, with nothing changed, if the update can't be applied on its own.
+ */
+bool CardDatabase::applySpoilerUpdate(const StagedDatabase &spoilers)
+{
+    QHash<QString, CardInfoPtr> oldCards;
+    for (const CardInfoPtr &card : loadedSpoilers.cards) {
+        oldCards.insert(card->getName(), card);
+    }
+    QHash<QString, CardSetPtr> oldSets;
+    for (const CardSetPtr &set : loadedSpoilers.sets) {
+        oldSets.insert(set->getShortName(), set);
+    }
+
+    // the set of a spoiler card belongs to the first file mentioning it, its details only change with a full reload
+    for (const CardSetPtr &set : spoilers.sets) {
+        const CardSetPtr oldSet = oldSets.value(set->getShortName());
+        if (oldSet && (oldSet->getLongName() != set->getLongName() || oldSet->getSetType() != set->getSetType() ||
+                       oldSet->getReleaseDate() != set->getReleaseDate())) {
+            return false;
+        }
+    }
+
+    // a card can only be replaced here if all of its printings came from the spoilers
+    const auto isSpoilerCard = [this, &oldCards](const QString &name) {
+        const CardInfoPtr card = cards.value(name);
+        if (!card) {
+            return true;
+        }
+        const CardInfoPtr oldCard = oldCards.value(name);
+        if (!oldCard) {
+            return false;
+        }
+        for (auto it = card->getSets().cbegin(); it != card->getSets().cend(); ++it) {
+            if (!oldCard->getSets().contains(it.key())) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    QList<CardInfoPtr> removedCards;
+    StagedDatabase changes;
+    changes.path = spoilers.path;
+    changes.status = spoilers.status;
+    changes.sets = spoilers.sets;
+    QSet<QString> newNames;
+    int droppedCards = 0;
+    for (const CardInfoPtr &card : spoilers.cards) {
+        newNames.insert(card->getName());
+        const CardInfoPtr oldCard = oldCards.value(card->getName());
+        if (oldCard && isSameCard(oldCard, card)) {
+            continue;
+        }
+        if (!isSpoilerCard(card->getName())) {
+            return false;
+        }
+        if (cards.contains(card->getName())) {
+            removedCards.append(cards.value(card->getName()));
+        }
+        changes.cards.append(card);
+    }
+    for (const CardInfoPtr &oldCard : loadedSpoilers.cards) {
+        if (newNames.contains(oldCard->getName()) || !cards.contains(oldCard->getName())) {
+            continue;
+        }
+        if (!isSpoilerCard(oldCard->getName())) {
+            return false;
+        }
+        removedCards.append(cards.value(oldCard->getName()));
+        ++droppedCards;
+    }
+
+    for (const CardInfoPtr &card : removedCards) {
+        removeCard(card);
+    }
+    loadFromFileMutex->lock();
+    beginBulkLoad(changes.cards.size());
+    mergeStagedDatabase(changes);
+    endBulkLoad();
+    loadFromFileMutex->unlock();
+
+    qCInfo(CardDatabaseLoadingLog) << "Updated spoilers:" << changes.cards.size() << "cards added or changed,"
+                                   << droppedCards << "removed";
+    return true;
+}
+
+/**
+ * The custom card databases, found recursively and following symlinks, in the alphabetical order they are loaded in.
+ */
+QStringList CardDatabase::findCustomDatabasePaths()
+{
+    QDirIterator customDatabaseIterator(SettingsCache::instance().getCustomCardDatabasePath(), QStringList() << "*.xml",
+                                        QDir::Files, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+    QStringList customDatabasePaths;
+    while (customDatabaseIterator.hasNext()) {
+        customDatabaseIterator.next();
+        customDatabasePaths.push_back(customDatabaseIterator.filePath());
+    }
+    customDatabasePaths.sort();
+    return customDatabasePaths;
+}
+
+/**
+ * The main, tokens, spoilers and custom databases, in the order they are merged in.
+ */
+QStringList CardDatabase::getSourcePaths(const QStringList &customDatabasePaths)
+{
+    return QStringList() << SettingsCache::instance().getCardDatabasePath()
+                         << SettingsCache::instance().getTokenDatabasePath()
+                         << SettingsCache::instance().getSpoilerCardDatabasePath() << customDatabasePaths;
+}
+
+/**
+ * The binary cache of the loaded card databases, or an empty path if there is no place to keep it.
+ */
+QString CardDatabase::getCacheFilePath() const
+{
+    const QString cachePath = SettingsCache::instance().getCachePath();
+    if (cachePath.isEmpty()) {
+        return QString();
+    }
+    return cachePath + "/carddatabase.cache";
+}
+
+/**
+ * Loads the cards and sets from the binary cache instead of the xml files, if it was written from the same files.
+ *
+ * @return Whether the cache was loaded; nothing is added to the database otherwise.
+ */
+bool CardDatabase::loadFromCache(const QString &cacheFilePath, const QByteArray &sourceKey)
+{
+    auto startTime = QTime::currentTime();
+
+    QList<CardSetPtr> cachedSets;
+    QList<CardInfoPtr> cachedCards;
+    if (!CardDatabaseCache(cacheFilePath).load(sourceKey, cachedSets, cachedCards)) {
+        return false;
+    }
+
+    for (const CardSetPtr &set : cachedSets) {
+        addSet(set);
+    }
+    beginBulkLoad(cachedCards.size());
+    for (const CardInfoPtr &card : cachedCards) {
+        addCard(card);
+    }
+    endBulkLoad();
+
+    int msecs = startTime.msecsTo(QTime::currentTime());
+    qCInfo(CardDatabaseLoadingLog) << "Loaded card database cache: Path =" << cacheFilePath
+                                   << "Cards =" << cards.size() << "Sets =" << sets.size()
+                                   << QString("%1ms").arg(msecs);
+    return true;
+}
+
 /**
  * Gets the card representing the preferred printing of the cardInfo
  *
@@ -458,30 +967,6 @@ bool CardDatabase::isPreferredPrinting(const CardRef &cardRef) const
     return cardRef.providerId == getPreferredPrintingProviderId(cardRef.name);
 }
 
-void CardDatabase::refreshCachedReverseRelatedCards()
-{
-    for (const CardInfoPtr &card : cards)
-        card->resetReverseRelatedCards2Me();
-
-    for (const CardInfoPtr &card : cards) {
-        if (card->getReverseRelatedCards().isEmpty()) {
-            continue;
-        }
-
-        for (CardRelation *cardRelation : card->getReverseRelatedCards()) {
-            const QString &targetCard = cardRelation->getName();
-            if (!cards.contains(targetCard)) {
-                continue;
-            }
-
-            auto *newCardRelation = new CardRelation(
-                card->getName(), cardRelation->getAttachType(), cardRelation->getIsCreateAllExclusion(),
-                cardRelation->getIsVariable(), cardRelation->getDefaultCount(), cardRelation->getIsPersistent());
-            cards.value(targetCard)->addReverseRelatedCards2Me(newCardRelation);
-        }
-    }
-}
-
 QStringList CardDatabase::getAllMainCardTypes() const
 {
     QSet<QString> types;
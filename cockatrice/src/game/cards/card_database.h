@@ -2,15 +2,18 @@
 #define CARDDATABASE_H
 
 #include "../common/card_ref.h"
+#include "card_relation_index.h"
 #include "exact_card.h"
 
 #include <QBasicMutex>
 #include <QDate>
+#include <QFutureWatcher>
 #include <QHash>
 #include <QList>
 #include <QLoggingCategory>
 #include <QStringList>
 #include <QVector>
+#include <atomic>
 #include <utility>
 
 inline Q_LOGGING_CATEGORY(CardDatabaseLog, "card_database");
@@ -50,11 +53,52 @@ protected:
 
     LoadStatus loadStatus;
 
+    /**
+     * The reverse relations between the cards, updated as cards are added and removed.
+     */
+    CardRelationIndex relationIndex;
+
     QVector<ICardDatabaseParser *> availableParsers;
 
 private:
+    /**
+     * What parsing one card database file produced, kept apart from the database until it is merged.
+     */
+    struct StagedDatabase
+    {
+        QString path;
+        LoadStatus status = NotLoaded;
+        QList<CardSetPtr> sets;
+        QList<CardInfoPtr> cards;
+        int msecs = 0;
+    };
+
+    static QVector<ICardDatabaseParser *> createParsers();
+    static StagedDatabase stageCardDatabase(const QString &path);
+    void mergeStagedDatabase(const StagedDatabase &staged);
+
+    // what the spoiler database was parsed into when it was last loaded, to tell what an update of it changes
+    StagedDatabase loadedSpoilers;
+    bool applySpoilerUpdate(const StagedDatabase &spoilers);
+
+    LoadStatus readCardDatabases();
+    void announceLoadStatus();
+    void adoptDatabase(CardDatabase &staged);
+
+    // the database a background reload loads into, owned by the watcher of the reload
+    CardDatabase *stagingDatabase = nullptr;
+    // set on a staging database to make it stop loading
+    std::atomic<bool> reloadCancelled{false};
+
+    static QStringList findCustomDatabasePaths();
+    static QStringList getSourcePaths(const QStringList &customDatabasePaths);
     void checkUnknownSets();
-    void refreshCachedReverseRelatedCards();
+    QString getCacheFilePath() const;
+    bool loadFromCache(const QString &cacheFilePath, const QByteArray &sourceKey);
+
+    // cards added by addCard() since beginBulkLoad(), announced together by endBulkLoad()
+    int bulkLoadDepth = 0;
+    QList<CardInfoPtr> bulkAddedCards;
 
     QBasicMutex *reloadDatabaseMutex = new QBasicMutex(), *clearDatabaseMutex = new QBasicMutex(),
                 *loadFromFileMutex = new QBasicMutex(), *addCardMutex = new QBasicMutex(),
@@ -66,9 +110,22 @@ public:
     void clear();
     void removeCard(CardInfoPtr card);
 
+    /**
+     * Starts adding many cards at once: until the matching endBulkLoad(), addCard() neither locks nor emits
+     * cardAdded(), and endBulkLoad() emits a single cardsAdded() for all the new cards instead.
+     * Calls can be nested; only the outermost pair counts.
+     *
+     * @param expectedCards How many cards are about to be added, to reserve room for them up front
+     */
+    void beginBulkLoad(int expectedCards = 0);
+    void endBulkLoad();
+
     [[nodiscard]] CardInfoPtr getCardInfo(const QString &cardName) const;
     [[nodiscard]] QList<CardInfoPtr> getCardInfos(const QStringList &cardNames) const;
 
+    // the number of distinct cards from which getCards() looks them up in parallel
+    static constexpr int PARALLEL_LOOKUP_THRESHOLD = 256;
+
     QList<ExactCard> getCards(const QList<CardRef> &cardRefs) const;
     [[nodiscard]] ExactCard getCard(const CardRef &cardRef) const;
 
@@ -110,8 +167,24 @@ public:
     void markAllSetsAsKnown();
     void notifyEnabledSetsChanged();
 
+    /**
+     * Stops the background reload that is running, if any; the cards loaded so far are dropped.
+     */
+    void cancelBackgroundReload();
+    bool isReloadingInBackground() const
+    {
+        return stagingDatabase != nullptr;
+    }
+
 public slots:
     LoadStatus loadCardDatabases();
+    /**
+     * Loads the card databases into a new database on a worker thread and then replaces the cards and sets of this
+     * one with it all at once, so the database stays usable while the files are parsed. A reload that is still
+     * running is cancelled first. A reload that fails leaves the loaded cards in place.
+     */
+    void reloadCardDatabasesInBackground();
+    LoadStatus reloadSpoilerDatabase();
     void addCard(CardInfoPtr card);
     void addSet(CardSetPtr set);
 protected slots:
@@ -119,10 +192,16 @@ protected slots:
 signals:
     void cardDatabaseLoadingFinished();
     void cardDatabaseLoadingFailed();
+    void cardDatabaseLoadingProgress(int parsedFiles, int totalFiles);
+    /**
+     * A background reload replaced all the cards; whoever keeps cards has to look them up again by name.
+     */
+    void cardListReplaced();
     void cardDatabaseNewSetsFound(int numUnknownSets, QStringList unknownSetsNames);
     void cardDatabaseAllNewSetsEnabled();
     void cardDatabaseEnabledSetsChanged();
     void cardAdded(CardInfoPtr card);
+    void cardsAdded(const QList<CardInfoPtr> &cards);
     void cardRemoved(CardInfoPtr card);
 };
 
@@ -0,0 +1,466 @@
+#include "card_database_cache.h"
+
+#include "../../settings/cache_settings.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QVector>
+#include <QtEndian>
+#include <cstring>
+#include <version_string.h>
+
+namespace
+{
+const char cacheMagic[4] = {'C', 'D', 'B', 'C'};
+// bump this when the layout below changes
+const quint32 cacheFormatVersion = 1;
+const int sourceKeySize = 20; // sha1
+
+// the smallest possible records, to reject counts a damaged file cannot hold before allocating for them
+const int minimumPairSize = 8;
+const int minimumRelationSize = 10;
+const int minimumCardSize = 29;
+
+enum CardFlags
+{
+    TokenFlag = 0x1,
+    CiptFlag = 0x2,
+    LandscapeOrientationFlag = 0x4,
+    UpsideDownArtFlag = 0x8
+};
+
+enum RelationFlags
+{
+    CreateAllExclusionFlag = 0x1,
+    VariableCountFlag = 0x2,
+    PersistentFlag = 0x4
+};
+
+void appendU32(QByteArray &data, quint32 value)
+{
+    char bytes[4];
+    qToLittleEndian(value, bytes);
+    data.append(bytes, sizeof(bytes));
+}
+
+/**
+ * Writes the records and collects the strings they refer to; every distinct string is stored once.
+ */
+class CacheWriter
+{
+public:
+    void writeU8(quint8 value)
+    {
+        records.append(static_cast<char>(value));
+    }
+    void writeU32(quint32 value)
+    {
+        appendU32(records, value);
+    }
+    void writeI32(qint32 value)
+    {
+        writeU32(static_cast<quint32>(value));
+    }
+    void writeString(const QString &value)
+    {
+        auto id = stringIds.constFind(value);
+        if (id == stringIds.constEnd()) {
+            id = stringIds.insert(value, static_cast<quint32>(strings.size()));
+            strings.append(value);
+        }
+        writeU32(*id);
+    }
+
+    QByteArray finish(const QByteArray &sourceKey, int setCount, int cardCount) const
+    {
+        quint32 stringDataLength = 0;
+        for (const QString &string : strings)
+            stringDataLength += static_cast<quint32>(string.size());
+
+        QByteArray data;
+        data.append(cacheMagic, sizeof(cacheMagic));
+        appendU32(data, cacheFormatVersion);
+        data.append(sourceKey);
+        appendU32(data, static_cast<quint32>(strings.size()));
+        appendU32(data, stringDataLength);
+        appendU32(data, static_cast<quint32>(setCount));
+        appendU32(data, static_cast<quint32>(cardCount));
+
+        quint32 offset = 0;
+        for (const QString &string : strings) {
+            appendU32(data, offset);
+            appendU32(data, static_cast<quint32>(string.size()));
+            offset += static_cast<quint32>(string.size());
+        }
+        for (const QString &string : strings) {
+            const int start = data.size();
+            data.resize(start + string.size() * 2);
+            qToLittleEndian<quint16>(string.utf16(), string.size(), data.data() + start);
+        }
+
+        data.append(records);
+        return data;
+    }
+
+private:
+    QByteArray records;
+    QHash<QString, quint32> stringIds;
+    QStringList strings;
+};
+
+/**
+ * Reads from the mapped file. Reading past the end or referring to unknown strings marks the reader as failed, after
+ * which every read returns zero or an empty string.
+ */
+class CacheReader
+{
+public:
+    CacheReader(const uchar *_data, qint64 _size) : data(_data), size(_size)
+    {
+    }
+
+    bool atError() const
+    {
+        return failed;
+    }
+    void fail()
+    {
+        failed = true;
+    }
+
+    const uchar *readBytes(qint64 length)
+    {
+        if (failed || length < 0 || size - pos < length) {
+            failed = true;
+            return nullptr;
+        }
+        const uchar *result = data + pos;
+        pos += length;
+        return result;
+    }
+    quint8 readU8()
+    {
+        const uchar *bytes = readBytes(1);
+        return bytes ? *bytes : 0;
+    }
+    quint32 readU32()
+    {
+        const uchar *bytes = readBytes(4);
+        return bytes ? qFromLittleEndian<quint32>(bytes) : 0;
+    }
+    qint32 readI32()
+    {
+        return static_cast<qint32>(readU32());
+    }
+    quint32 readCount(int minimumItemSize)
+    {
+        const quint32 count = readU32();
+        if (count > (size - pos) / minimumItemSize) {
+            failed = true;
+            return 0;
+        }
+        return count;
+    }
+
+    void readStringTable(quint32 count, quint32 dataLength)
+    {
+        stringIndex = readBytes(qint64(count) * 8);
+        stringData = readBytes(qint64(dataLength) * 2);
+        stringDataLength = dataLength;
+        if (failed)
+            return;
+        strings.resize(static_cast<int>(count));
+        decoded.fill(false, static_cast<int>(count));
+    }
+
+    // decodes a string when it is first referred to
+    QString readString()
+    {
+        const quint32 id = readU32();
+        if (failed || id >= static_cast<quint32>(strings.size())) {
+            failed = true;
+            return QString();
+        }
+
+        if (!decoded[id]) {
+            const quint32 offset = qFromLittleEndian<quint32>(stringIndex + id * 8);
+            const quint32 length = qFromLittleEndian<quint32>(stringIndex + id * 8 + 4);
+            if (offset > stringDataLength || length > stringDataLength - offset) {
+                failed = true;
+                return QString();
+            }
+            QString string(static_cast<int>(length), Qt::Uninitialized);
+            qFromLittleEndian<quint16>(stringData + qint64(offset) * 2, length, string.data());
+            strings[id] = string;
+            decoded[id] = true;
+        }
+        return strings[id];
+    }
+
+private:
+    const uchar *data;
+    qint64 size;
+    qint64 pos = 0;
+    bool failed = false;
+
+    const uchar *stringIndex = nullptr;
+    const uchar *stringData = nullptr;
+    quint32 stringDataLength = 0;
+    QVector<QString> strings;
+    QVector<bool> decoded;
+};
+
+void writeRelations(CacheWriter &writer, const QList<CardRelation *> &relations)
+{
+    writer.writeU32(static_cast<quint32>(relations.size()));
+    for (const CardRelation *relation : relations) {
+        writer.writeString(relation->getName());
+        writer.writeU8(static_cast<quint8>(relation->getAttachType()));
+        writer.writeU8((relation->getIsCreateAllExclusion() ? CreateAllExclusionFlag : 0) |
+                       (relation->getIsVariable() ? VariableCountFlag : 0) |
+                       (relation->getIsPersistent() ? PersistentFlag : 0));
+        writer.writeI32(relation->getDefaultCount());
+    }
+}
+
+QList<CardRelation *> readRelations(CacheReader &reader)
+{
+    QList<CardRelation *> relations;
+    const quint32 count = reader.readCount(minimumRelationSize);
+    for (quint32 i = 0; i < count && !reader.atError(); ++i) {
+        const QString name = reader.readString();
+        const quint8 attachType = reader.readU8();
+        const quint8 flags = reader.readU8();
+        const int defaultCount = reader.readI32();
+        if (attachType > CardRelation::TransformInto)
+            reader.fail();
+        if (reader.atError())
+            break;
+        relations.append(new CardRelation(name, static_cast<CardRelation::AttachType>(attachType),
+                                          flags & CreateAllExclusionFlag, flags & VariableCountFlag, defaultCount,
+                                          flags & PersistentFlag));
+    }
+    return relations;
+}
+
+void deleteRelations(const CardInfoPtr &card)
+{
+    qDeleteAll(card->getRelatedCards());
+    qDeleteAll(card->getReverseRelatedCards());
+}
+} // namespace
+
+CardDatabaseCache::CardDatabaseCache(const QString &_fileName) : fileName(_fileName)
+{
+}
+
+QByteArray CardDatabaseCache::sourceKey(const QStringList &sourcePaths)
+{
+    QByteArray key;
+    key.append(QByteArray::number(cacheFormatVersion)).append('\n');
+    key.append(VERSION_STRING).append('\n');
+    key.append(SettingsCache::instance().getIncludeRebalancedCards() ? "1" : "0").append('\n');
+    for (const QString &path : sourcePaths) {
+        const QFileInfo info(path);
+        key.append(path.toUtf8()).append('\n');
+        if (info.exists()) {
+            key.append(QByteArray::number(info.size())).append('\n');
+            key.append(QByteArray::number(info.lastModified().toMSecsSinceEpoch())).append('\n');
+        } else {
+            key.append("missing\n");
+        }
+    }
+    return QCryptographicHash::hash(key, QCryptographicHash::Sha1);
+}
+
+bool CardDatabaseCache::load(const QByteArray &sourceKey, QList<CardSetPtr> &sets, QList<CardInfoPtr> &cards) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 size = file.size();
+    const uchar *data = file.map(0, size);
+    if (!data) {
+        qCInfo(CardDatabaseCacheLog) << "Cannot map card database cache" << fileName << file.errorString();
+        return false;
+    }
+
+    CacheReader reader(data, size);
+    const uchar *magic = reader.readBytes(sizeof(cacheMagic));
+    if (!magic || std::memcmp(magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+        reader.readU32() != cacheFormatVersion) {
+        qCInfo(CardDatabaseCacheLog) << "Ignoring card database cache of unknown format" << fileName;
+        return false;
+    }
+    const uchar *key = reader.readBytes(sourceKeySize);
+    if (!key || QByteArray::fromRawData(reinterpret_cast<const char *>(key), sourceKeySize) != sourceKey) {
+        qCInfo(CardDatabaseCacheLog) << "Card database cache is out of date" << fileName;
+        return false;
+    }
+
+    const quint32 stringCount = reader.readU32();
+    const quint32 stringDataLength = reader.readU32();
+    const quint32 setCount = reader.readU32();
+    const quint32 cardCount = reader.readU32();
+    reader.readStringTable(stringCount, stringDataLength);
+
+    QList<CardSetPtr> loadedSets;
+    for (quint32 i = 0; i < setCount && !reader.atError(); ++i) {
+        const QString shortName = reader.readString();
+        const QString longName = reader.readString();
+        const QString setType = reader.readString();
+        const QDate releaseDate = QDate::fromString(reader.readString(), Qt::ISODate);
+        const auto priority = static_cast<CardSet::Priority>(reader.readI32());
+        const bool enabled = reader.readU8() != 0;
+        if (reader.atError())
+            break;
+
+        // the parsers skip the printings of disabled sets, which the cache then doesn't have either
+        if (SettingsCache::instance().cardDatabase().isEnabled(shortName) != enabled) {
+            qCInfo(CardDatabaseCacheLog) << "Enabled sets changed since the card database cache was written";
+            return false;
+        }
+        loadedSets.append(CardSet::newInstance(shortName, longName, setType, releaseDate, priority));
+    }
+
+    QList<CardInfoPtr> loadedCards;
+    if (cardCount > size / minimumCardSize)
+        reader.fail();
+    else
+        loadedCards.reserve(static_cast<int>(cardCount));
+    for (quint32 i = 0; i < cardCount && !reader.atError(); ++i) {
+        const QString name = reader.readString();
+        const QString text = reader.readString();
+        const quint8 flags = reader.readU8();
+        const int tableRow = reader.readI32();
+
+        QVariantHash properties;
+        const quint32 propertyCount = reader.readCount(minimumPairSize);
+        properties.reserve(static_cast<int>(propertyCount));
+        for (quint32 j = 0; j < propertyCount; ++j) {
+            const QString propertyName = reader.readString();
+            properties.insert(propertyName, reader.readString());
+        }
+
+        SetToPrintingsMap printings;
+        const quint32 printingCount = reader.readCount(minimumPairSize);
+        for (quint32 j = 0; j < printingCount && !reader.atError(); ++j) {
+            const quint32 setIndex = reader.readU32();
+            if (setIndex >= static_cast<quint32>(loadedSets.size())) {
+                reader.fail();
+                break;
+            }
+            const CardSetPtr &set = loadedSets.at(static_cast<int>(setIndex));
+            PrintingInfo printing(set);
+            const quint32 printingPropertyCount = reader.readCount(minimumPairSize);
+            for (quint32 k = 0; k < printingPropertyCount; ++k) {
+                const QString propertyName = reader.readString();
+                printing.setProperty(propertyName, reader.readString());
+            }
+            printings[set->getShortName()].append(printing);
+        }
+
+        const QList<CardRelation *> relatedCards = readRelations(reader);
+        const QList<CardRelation *> reverseRelatedCards = readRelations(reader);
+        if (reader.atError()) {
+            qDeleteAll(relatedCards);
+            qDeleteAll(reverseRelatedCards);
+            break;
+        }
+
+        loadedCards.append(CardInfo::newInstance(name, text, flags & TokenFlag, std::move(properties), relatedCards,
+                                                 reverseRelatedCards, printings, flags & CiptFlag,
+                                                 flags & LandscapeOrientationFlag, tableRow,
+                                                 flags & UpsideDownArtFlag));
+    }
+
+    if (reader.atError()) {
+        qCWarning(CardDatabaseCacheLog) << "Ignoring damaged card database cache" << fileName;
+        for (const CardInfoPtr &card : loadedCards)
+            deleteRelations(card);
+        return false;
+    }
+
+    sets = loadedSets;
+    cards = loadedCards;
+    return true;
+}
+
+bool CardDatabaseCache::save(const QByteArray &sourceKey, const SetNameMap &sets, const CardNameMap &cards) const
+{
+    // every printing refers to its set by index, so the sets come first
+    QList<CardSetPtr> setList = sets.values();
+    QHash<QString, quint32> setIndexes;
+    for (const CardSetPtr &set : setList)
+        setIndexes.insert(set->getShortName(), static_cast<quint32>(setIndexes.size()));
+    for (const CardInfoPtr &card : cards)
+        for (const auto &printings : card->getSets())
+            for (const PrintingInfo &printing : printings)
+                if (!setIndexes.contains(printing.getSet()->getShortName())) {
+                    setIndexes.insert(printing.getSet()->getShortName(), static_cast<quint32>(setList.size()));
+                    setList.append(printing.getSet());
+                }
+
+    CacheWriter writer;
+    for (const CardSetPtr &set : setList) {
+        writer.writeString(set->getShortName());
+        writer.writeString(set->getLongName());
+        writer.writeString(set->getSetType());
+        writer.writeString(set->getReleaseDate().toString(Qt::ISODate));
+        writer.writeI32(set->getPriority());
+        writer.writeU8(set->getEnabled() ? 1 : 0);
+    }
+
+    for (const CardInfoPtr &card : cards) {
+        writer.writeString(card->getName());
+        writer.writeString(card->getText());
+        writer.writeU8((card->getIsToken() ? TokenFlag : 0) | (card->getCipt() ? CiptFlag : 0) |
+                       (card->getLandscapeOrientation() ? LandscapeOrientationFlag : 0) |
+                       (card->getUpsideDownArt() ? UpsideDownArtFlag : 0));
+        writer.writeI32(card->getTableRow());
+
+        const QStringList properties = card->getProperties();
+        writer.writeU32(static_cast<quint32>(properties.size()));
+        for (const QString &propertyName : properties) {
+            writer.writeString(propertyName);
+            writer.writeString(card->getProperty(propertyName));
+        }
+
+        quint32 printingCount = 0;
+        for (const auto &printings : card->getSets())
+            printingCount += static_cast<quint32>(printings.size());
+        writer.writeU32(printingCount);
+        for (const auto &printings : card->getSets()) {
+            for (const PrintingInfo &printing : printings) {
+                writer.writeU32(setIndexes.value(printing.getSet()->getShortName()));
+                const QStringList printingProperties = printing.getProperties();
+                writer.writeU32(static_cast<quint32>(printingProperties.size()));
+                for (const QString &propertyName : printingProperties) {
+                    writer.writeString(propertyName);
+                    writer.writeString(printing.getProperty(propertyName));
+                }
+            }
+        }
+
+        writeRelations(writer, card->getRelatedCards());
+        writeRelations(writer, card->getReverseRelatedCards());
+    }
+
+    const QByteArray data = writer.finish(sourceKey, setList.size(), cards.size());
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qCWarning(CardDatabaseCacheLog) << "Cannot write card database cache" << fileName << file.errorString();
+        return false;
+    }
+
+    qCInfo(CardDatabaseCacheLog) << "Saved card database cache" << fileName << "Bytes =" << data.size();
+    return true;
+}
@@ -0,0 +1,47 @@
+#ifndef CARD_DATABASE_CACHE_H
+#define CARD_DATABASE_CACHE_H
+
+#include "card_info.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QLoggingCategory>
+#include <QString>
+#include <QStringList>
+
+inline Q_LOGGING_CATEGORY(CardDatabaseCacheLog, "card_database.cache");
+
+/**
+ * A binary copy of the loaded card database, so that the next start can skip parsing the xml files.
+ *
+ * The file holds a string table followed by the sets and the cards, whose fields refer to the table by index. It is
+ * memory-mapped when loaded and every string is decoded only once, the first time a card refers to it, so equal
+ * property names and values are shared between all the cards.
+ *
+ * The cache is only valid for the source files and settings it was written from, see sourceKey(). A missing, stale
+ * or damaged cache loads nothing and the xml files are parsed instead.
+ */
+class CardDatabaseCache
+{
+public:
+    explicit CardDatabaseCache(const QString &_fileName);
+
+    /**
+     * Identifies the state of the card database files the cache is written from: their paths, sizes and modification
+     * times, plus the client version and the settings changing what the parsers load.
+     */
+    static QByteArray sourceKey(const QStringList &sourcePaths);
+
+    /**
+     * Loads the cached sets and cards, if the cache was written for sourceKey. The set of every printing is one of
+     * the returned sets; the enabled state of every set has to be the same as when the cache was written, as the
+     * parsers drop the printings of disabled sets.
+     */
+    bool load(const QByteArray &sourceKey, QList<CardSetPtr> &sets, QList<CardInfoPtr> &cards) const;
+    bool save(const QByteArray &sourceKey, const SetNameMap &sets, const CardNameMap &cards) const;
+
+private:
+    QString fileName;
+};
+
+#endif
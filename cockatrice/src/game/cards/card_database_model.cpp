@@ -2,15 +2,20 @@
 
 #include "../filters/filter_tree.h"
 
+#include <QFutureWatcher>
 #include <QMap>
+#include <QtConcurrentRun>
 
 #define CARDDBMODEL_COLUMNS 6
 
 CardDatabaseModel::CardDatabaseModel(CardDatabase *_db, bool _showOnlyCardsFromEnabledSets, QObject *parent)
-    : QAbstractListModel(parent), db(_db), showOnlyCardsFromEnabledSets(_showOnlyCardsFromEnabledSets)
+    : QAbstractListModel(parent), db(_db), showOnlyCardsFromEnabledSets(_showOnlyCardsFromEnabledSets),
+      searchIndexStale(false), rowsGeneration(0)
 {
     connect(db, &CardDatabase::cardAdded, this, &CardDatabaseModel::cardAdded);
+    connect(db, &CardDatabase::cardsAdded, this, &CardDatabaseModel::cardsAdded);
     connect(db, &CardDatabase::cardRemoved, this, &CardDatabaseModel::cardRemoved);
+    connect(db, &CardDatabase::cardListReplaced, this, &CardDatabaseModel::cardListReplaced);
     connect(db, &CardDatabase::cardDatabaseEnabledSetsChanged, this,
             &CardDatabaseModel::cardDatabaseEnabledSetsChanged);
 
@@ -90,9 +95,29 @@ void CardDatabaseModel::cardInfoChanged(CardInfoPtr card)
     if (row == -1)
         return;
 
+    ++rowsGeneration;
     emit dataChanged(index(row, 0), index(row, CARDDBMODEL_COLUMNS - 1));
 }
 
+const CardSearchIndex &CardDatabaseModel::getSearchIndex()
+{
+    if (searchIndexStale) {
+        searchIndex.reset(cardList);
+        searchIndexStale = false;
+    }
+    return searchIndex;
+}
+
+QBitArray CardDatabaseModel::rowsMatchingName(const QString &text)
+{
+    return getSearchIndex().rowsMatchingName(text);
+}
+
+QVector<int> CardDatabaseModel::rowsWithNamePrefix(const QString &text)
+{
+    return getSearchIndex().rowsWithNamePrefix(text);
+}
+
 bool CardDatabaseModel::checkCardHasAtLeastOneEnabledSet(CardInfoPtr card)
 {
     if (!showOnlyCardsFromEnabledSets)
@@ -118,11 +143,13 @@ void CardDatabaseModel::cardDatabaseEnabledSetsChanged()
     }
 
     // re-check all the card currently not shown, maybe their part of a newly-enabled set
+    QList<CardInfoPtr> hiddenCards;
     for (const CardInfoPtr &card : db->getCardList()) {
         if (!cardListSet.contains(card)) {
-            cardAdded(card);
+            hiddenCards.append(card);
         }
     }
+    cardsAdded(hiddenCards);
 }
 
 void CardDatabaseModel::cardAdded(CardInfoPtr card)
@@ -132,11 +159,41 @@ void CardDatabaseModel::cardAdded(CardInfoPtr card)
         beginInsertRows(QModelIndex(), cardList.size(), cardList.size());
         cardList.append(card);
         cardListSet.insert(card);
+        if (!searchIndexStale) {
+            searchIndex.cardAppended(card);
+        }
+        ++rowsGeneration;
         connect(card.data(), &CardInfo::cardInfoChanged, this, &CardDatabaseModel::cardInfoChanged);
         endInsertRows();
     }
 }
 
+void CardDatabaseModel::cardsAdded(const QList<CardInfoPtr> &cards)
+{
+    QList<CardInfoPtr> shownCards;
+    for (const CardInfoPtr &card : cards) {
+        if (checkCardHasAtLeastOneEnabledSet(card) && !cardListSet.contains(card)) {
+            shownCards.append(card);
+        }
+    }
+    if (shownCards.isEmpty()) {
+        return;
+    }
+
+    // one reset is much cheaper for the views and proxy models than thousands of single row inserts
+    beginResetModel();
+    for (const CardInfoPtr &card : shownCards) {
+        cardList.append(card);
+        cardListSet.insert(card);
+        if (!searchIndexStale) {
+            searchIndex.cardAppended(card);
+        }
+        connect(card.data(), &CardInfo::cardInfoChanged, this, &CardDatabaseModel::cardInfoChanged);
+    }
+    ++rowsGeneration;
+    endResetModel();
+}
+
 void CardDatabaseModel::cardRemoved(CardInfoPtr card)
 {
     const int row = cardList.indexOf(card);
@@ -149,11 +206,34 @@ void CardDatabaseModel::cardRemoved(CardInfoPtr card)
     cardListSet.remove(card);
     card.clear();
     cardList.removeAt(row);
+    searchIndexStale = true;
+    ++rowsGeneration;
     endRemoveRows();
 }
 
+void CardDatabaseModel::cardListReplaced()
+{
+    beginResetModel();
+    for (const CardInfoPtr &card : cardList) {
+        disconnect(card.data(), nullptr, this, nullptr);
+    }
+    cardList.clear();
+    cardListSet.clear();
+    for (const CardInfoPtr &card : db->getCardList()) {
+        if (checkCardHasAtLeastOneEnabledSet(card)) {
+            cardList.append(card);
+            cardListSet.insert(card);
+            connect(card.data(), &CardInfo::cardInfoChanged, this, &CardDatabaseModel::cardInfoChanged);
+        }
+    }
+    searchIndexStale = true;
+    ++rowsGeneration;
+    endResetModel();
+}
+
 CardDatabaseDisplayModel::CardDatabaseDisplayModel(QObject *parent)
-    : QSortFilterProxyModel(parent), isToken(ShowAll), filterString(nullptr)
+    : QSortFilterProxyModel(parent), isToken(ShowAll), filterString(nullptr), nameCandidatesGeneration(-1),
+      searchMatchesGeneration(-1)
 {
     filterTree = nullptr;
     setFilterCaseSensitivity(Qt::CaseInsensitive);
@@ -162,9 +242,74 @@ CardDatabaseDisplayModel::CardDatabaseDisplayModel(QObject *parent)
     dirtyTimer.setSingleShot(true);
     connect(&dirtyTimer, &QTimer::timeout, this, &CardDatabaseDisplayModel::invalidate);
 
+    searchTimer.setSingleShot(true);
+    connect(&searchTimer, &QTimer::timeout, this, &CardDatabaseDisplayModel::startSearch);
+
     loadedRowCount = 0;
 }
 
+CardDatabaseDisplayModel::~CardDatabaseDisplayModel()
+{
+    cancelSearch();
+    delete filterString;
+}
+
+void CardDatabaseDisplayModel::startSearch()
+{
+    auto *model = qobject_cast<CardDatabaseModel *>(sourceModel());
+    if (filterString == nullptr || model == nullptr) {
+        return;
+    }
+
+    // the worker gets its own copies, the cards are only read
+    QList<CardInfoPtr> cards;
+    cards.reserve(model->rowCount());
+    for (int row = 0; row < model->rowCount(); ++row) {
+        cards.append(model->getCard(row));
+    }
+    const FilterString query = *filterString;
+    const int generation = model->getRowsGeneration();
+    auto cancelled = QSharedPointer<std::atomic<bool>>::create(false);
+    searchCancelled = cancelled;
+
+    auto *watcher = new QFutureWatcher<QBitArray>(this);
+    connect(watcher, &QFutureWatcher<QBitArray>::finished, this, [this, watcher, cancelled, generation] {
+        watcher->deleteLater();
+        if (cancelled->load()) {
+            return;
+        }
+        searchCancelled.reset();
+        searchMatches = watcher->result();
+        searchMatchesGeneration = generation;
+        emit modelDirty();
+        invalidate();
+        emit searchFinished();
+    });
+    watcher->setFuture(QtConcurrent::run([cards, query, cancelled] {
+        QBitArray matches(cards.size());
+        for (int row = 0; row < cards.size(); ++row) {
+            if (row % 256 == 0 && cancelled->load()) {
+                return QBitArray();
+            }
+            if (query.check(cards.at(row))) {
+                matches.setBit(row);
+            }
+        }
+        return matches;
+    }));
+}
+
+void CardDatabaseDisplayModel::cancelSearch()
+{
+    searchTimer.stop();
+    if (searchCancelled) {
+        searchCancelled->store(true);
+        searchCancelled.reset();
+    }
+    searchMatches.clear();
+    searchMatchesGeneration = -1;
+}
+
 bool CardDatabaseDisplayModel::canFetchMore(const QModelIndex &index) const
 {
     return loadedRowCount < sourceModel()->rowCount(index);
@@ -191,11 +336,50 @@ int CardDatabaseDisplayModel::rowCount(const QModelIndex &parent) const
     return QSortFilterProxyModel::rowCount(parent);
 }
 
-bool CardDatabaseDisplayModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+const CardDatabaseDisplayModel::ColumnSortKeys &CardDatabaseDisplayModel::columnSortKeys(int column) const
 {
+    auto *model = static_cast<CardDatabaseModel *>(sourceModel());
+    if (sortKeys.column == column && sortKeys.generation == model->getRowsGeneration()) {
+        return sortKeys;
+    }
 
-    QString leftString = sourceModel()->data(left, CardDatabaseModel::SortRole).toString();
-    QString rightString = sourceModel()->data(right, CardDatabaseModel::SortRole).toString();
+    // the same ordering as QString::localeAwareCompare(), compared as precomputed keys
+    QCollator collator(QLocale::system());
+
+    sortKeys = ColumnSortKeys();
+    sortKeys.column = column;
+    sortKeys.generation = model->getRowsGeneration();
+    const int rows = model->rowCount();
+    sortKeys.texts.reserve(rows);
+    sortKeys.collated.reserve(rows);
+    for (int row = 0; row < rows; ++row) {
+        const QString text = model->data(model->index(row, column), CardDatabaseModel::SortRole).toString();
+        sortKeys.texts.append(text);
+        sortKeys.collated.push_back(collator.sortKey(text));
+    }
+
+    if (column == CardDatabaseModel::PTColumn) {
+        sortKeys.powerToughness.reserve(rows);
+        for (const QString &text : sortKeys.texts) {
+            QVector<NumericSortKey> parts;
+            const QStringList list = text.split("/");
+            if (list.size() == 2) {
+                parts = {numericSortKey(list.at(0)), numericSortKey(list.at(1))};
+            }
+            sortKeys.powerToughness.append(parts);
+        }
+    }
+
+    return sortKeys;
+}
+
+bool CardDatabaseDisplayModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    const ColumnSortKeys &keys = columnSortKeys(left.column());
+    const int leftRow = left.row();
+    const int rightRow = right.row();
+    const QString &leftString = keys.texts.at(leftRow);
+    const QString &rightString = keys.texts.at(rightRow);
 
     if (!cardName.isEmpty() && left.column() == CardDatabaseModel::NameColumn) {
         bool isLeftType = leftString.startsWith(cardName, Qt::CaseInsensitive);
@@ -210,75 +394,60 @@ bool CardDatabaseDisplayModel::lessThan(const QModelIndex &left, const QModelInd
         if (isRightType && (!isLeftType || rightString.size() == cardName.size()))
             return false;
     } else if (right.column() == CardDatabaseModel::PTColumn && left.column() == CardDatabaseModel::PTColumn) {
-        QStringList leftList = leftString.split("/");
-        QStringList rightList = rightString.split("/");
+        const QVector<NumericSortKey> &leftList = keys.powerToughness.at(leftRow);
+        const QVector<NumericSortKey> &rightList = keys.powerToughness.at(rightRow);
 
         if (leftList.size() == 2 && rightList.size() == 2) {
 
             // cool, have both P/T in list now
-            int lessThanNum = lessThanNumerically(leftList.at(0), rightList.at(0));
+            int lessThanNum = compareNumerically(leftList.at(0), rightList.at(0));
             if (lessThanNum != 0) {
                 return lessThanNum < 0;
             } else {
                 // power equal, check toughness
-                return lessThanNumerically(leftList.at(1), rightList.at(1)) < 0;
+                return compareNumerically(leftList.at(1), rightList.at(1)) < 0;
             }
         }
     }
-    return QString::localeAwareCompare(leftString, rightString) < 0;
+    return keys.collated.at(leftRow).compare(keys.collated.at(rightRow)) < 0;
 }
 
 int CardDatabaseDisplayModel::lessThanNumerically(const QString &left, const QString &right)
 {
-    if (left == right) {
-        return 0;
-    }
+    return compareNumerically(numericSortKey(left), numericSortKey(right));
+}
 
-    bool okLeft, okRight;
-    float leftNum = left.toFloat(&okLeft);
-    float rightNum = right.toFloat(&okRight);
+CardDatabaseDisplayModel::NumericSortKey CardDatabaseDisplayModel::numericSortKey(const QString &value)
+{
+    NumericSortKey key{value, false, 0, ""};
+    key.number = value.toFloat(&key.isNumber);
 
-    if (okLeft && okRight) {
-        if (leftNum < rightNum) {
-            return -1;
-        } else if (leftNum > rightNum) {
-            return 1;
-        } else {
-            return 0;
-        }
-    }
     // try and parsing again, for weird ones like "1+*"
-    QString leftAfterNum = "";
-    QString rightAfterNum = "";
-    if (!okLeft) {
-        int leftNumIndex = 0;
-        for (; leftNumIndex < left.length(); leftNumIndex++) {
-            if (!left.at(leftNumIndex).isDigit()) {
+    if (!key.isNumber) {
+        int numIndex = 0;
+        for (; numIndex < value.length(); numIndex++) {
+            if (!value.at(numIndex).isDigit()) {
                 break;
             }
         }
-        if (leftNumIndex != 0) {
-            leftNum = left.left(leftNumIndex).toFloat(&okLeft);
-            leftAfterNum = left.right(leftNumIndex);
+        if (numIndex != 0) {
+            key.number = value.left(numIndex).toFloat(&key.isNumber);
+            key.afterNumber = value.right(numIndex);
         }
     }
-    if (!okRight) {
-        int rightNumIndex = 0;
-        for (; rightNumIndex < right.length(); rightNumIndex++) {
-            if (!right.at(rightNumIndex).isDigit()) {
-                break;
-            }
-        }
-        if (rightNumIndex != 0) {
-            rightNum = right.left(rightNumIndex).toFloat(&okRight);
-            rightAfterNum = right.right(rightNumIndex);
-        }
+    return key;
+}
+
+int CardDatabaseDisplayModel::compareNumerically(const NumericSortKey &left, const NumericSortKey &right)
+{
+    if (left.text == right.text) {
+        return 0;
     }
-    if (okLeft && okRight) {
 
-        if (leftNum != rightNum) {
+    if (left.isNumber && right.isNumber) {
+        if (left.number != right.number) {
             // both parsed as numbers, but different number
-            if (leftNum < rightNum) {
+            if (left.number < right.number) {
                 return -1;
             } else {
                 return 1;
@@ -286,16 +455,17 @@ int CardDatabaseDisplayModel::lessThanNumerically(const QString &left, const QSt
         } else {
             // both parsed, same number, but at least one has something else
             // so compare the part after the number - prefer nothing
-            return QString::localeAwareCompare(leftAfterNum, rightAfterNum);
+            return QString::localeAwareCompare(left.afterNumber, right.afterNumber);
         }
-    } else if (okLeft) {
+    } else if (left.isNumber) {
         return -1;
-    } else if (okRight) {
+    } else if (right.isNumber) {
         return 1;
     }
     // couldn't parse it, just return String comparison
-    return QString::localeAwareCompare(left, right);
+    return QString::localeAwareCompare(left.text, right.text);
 }
+
 bool CardDatabaseDisplayModel::filterAcceptsRow(int sourceRow, const QModelIndex & /*sourceParent*/) const
 {
     CardInfoPtr info = static_cast<CardDatabaseModel *>(sourceModel())->getCard(sourceRow);
@@ -307,16 +477,32 @@ bool CardDatabaseDisplayModel::filterAcceptsRow(int sourceRow, const QModelIndex
         if (filterTree != nullptr && !filterTree->acceptsCard(info)) {
             return false;
         }
+        // until the search is done, or once the rows changed, the expression is checked here
+        auto *model = static_cast<CardDatabaseModel *>(sourceModel());
+        if (searchMatchesGeneration == model->getRowsGeneration() && sourceRow < searchMatches.size()) {
+            return searchMatches.testBit(sourceRow);
+        }
         return filterString->check(info);
     }
 
-    return rowMatchesCardName(info);
+    return rowMatchesCardName(sourceRow, info);
 }
 
-bool CardDatabaseDisplayModel::rowMatchesCardName(CardInfoPtr info) const
+bool CardDatabaseDisplayModel::rowMatchesCardName(int sourceRow, CardInfoPtr info) const
 {
-    if (!cardName.isEmpty() && !info->getName().contains(cardName, Qt::CaseInsensitive))
-        return false;
+    if (!cardName.isEmpty()) {
+        // look the candidates up once per search instead of comparing the name of every card
+        auto *model = static_cast<CardDatabaseModel *>(sourceModel());
+        if (nameCandidatesGeneration != model->getRowsGeneration() || nameCandidatesText != cardName) {
+            nameCandidates = model->rowsMatchingName(cardName);
+            nameCandidatesText = cardName;
+            nameCandidatesGeneration = model->getRowsGeneration();
+        }
+        if (sourceRow < nameCandidates.size() && !nameCandidates.testBit(sourceRow))
+            return false;
+        if (!info->getName().contains(cardName, Qt::CaseInsensitive))
+            return false;
+    }
 
     if (!cardNameSet.isEmpty() && !cardNameSet.contains(info->getName()))
         return false;
@@ -371,7 +557,7 @@ TokenDisplayModel::TokenDisplayModel(QObject *parent) : CardDatabaseDisplayModel
 bool TokenDisplayModel::filterAcceptsRow(int sourceRow, const QModelIndex & /*sourceParent*/) const
 {
     CardInfoPtr info = static_cast<CardDatabaseModel *>(sourceModel())->getCard(sourceRow);
-    return info->getIsToken() && rowMatchesCardName(info);
+    return info->getIsToken() && rowMatchesCardName(sourceRow, info);
 }
 
 int TokenDisplayModel::rowCount(const QModelIndex &parent) const
@@ -387,7 +573,8 @@ TokenEditModel::TokenEditModel(QObject *parent) : CardDatabaseDisplayModel(paren
 bool TokenEditModel::filterAcceptsRow(int sourceRow, const QModelIndex & /*sourceParent*/) const
 {
     CardInfoPtr info = static_cast<CardDatabaseModel *>(sourceModel())->getCard(sourceRow);
-    return info->getIsToken() && info->getSets().contains(CardSet::TOKENS_SETNAME) && rowMatchesCardName(info);
+    return info->getIsToken() && info->getSets().contains(CardSet::TOKENS_SETNAME) &&
+           rowMatchesCardName(sourceRow, info);
 }
 
 int TokenEditModel::rowCount(const QModelIndex &parent) const
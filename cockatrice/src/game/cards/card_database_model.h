@@ -3,12 +3,17 @@
 
 #include "../filters/filter_string.h"
 #include "card_database.h"
+#include "card_search_index.h"
 
 #include <QAbstractListModel>
+#include <QCollator>
 #include <QList>
 #include <QSet>
+#include <QSharedPointer>
 #include <QSortFilterProxyModel>
 #include <QTimer>
+#include <atomic>
+#include <vector>
 
 class FilterTree;
 
@@ -44,16 +49,36 @@ public:
         return cardList[index];
     }
 
+    /**
+     * Returns the rows whose card name may contain text, see CardSearchIndex::rowsMatchingName(). The result is
+     * valid until getRowsGeneration() changes.
+     */
+    QBitArray rowsMatchingName(const QString &text);
+    // the rows whose card name starts with text, see CardSearchIndex::rowsWithNamePrefix()
+    QVector<int> rowsWithNamePrefix(const QString &text);
+    /** Changes whenever rows are inserted, removed or changed. */
+    int getRowsGeneration() const
+    {
+        return rowsGeneration;
+    }
+
 private:
     QList<CardInfoPtr> cardList;
     QSet<CardInfoPtr> cardListSet; // Supports faster lookups in cardDatabaseEnabledSetsChanged()
     CardDatabase *db;
     bool showOnlyCardsFromEnabledSets;
+    CardSearchIndex searchIndex;
+    // removing a row shifts the others, the index is rebuilt the next time it is needed
+    bool searchIndexStale;
+    int rowsGeneration;
 
+    const CardSearchIndex &getSearchIndex();
     inline bool checkCardHasAtLeastOneEnabledSet(CardInfoPtr card);
 private slots:
     void cardAdded(CardInfoPtr card);
+    void cardsAdded(const QList<CardInfoPtr> &cards);
     void cardRemoved(CardInfoPtr card);
+    void cardListReplaced();
     void cardInfoChanged(CardInfoPtr card);
     void cardDatabaseEnabledSetsChanged();
 };
@@ -75,14 +100,30 @@ private:
     QSet<QString> cardNameSet, cardTypes, cardColors;
     FilterTree *filterTree;
     FilterString *filterString;
+    // the source rows that may match cardName, for the rows of the source model in nameCandidatesGeneration
+    mutable QBitArray nameCandidates;
+    mutable QString nameCandidatesText;
+    mutable int nameCandidatesGeneration;
     int loadedRowCount;
     QTimer dirtyTimer;
 
+    // the source rows filterString accepts, checked on a worker thread for the rows in searchMatchesGeneration
+    QBitArray searchMatches;
+    int searchMatchesGeneration;
+    // waits for the typing to pause before a search starts
+    QTimer searchTimer;
+    // tells the running search that its result is no longer wanted
+    QSharedPointer<std::atomic<bool>> searchCancelled;
+
+    void startSearch();
+    void cancelSearch();
+
     /** The translation table that will be used for sanitizeCardName. */
     static QMap<wchar_t, wchar_t> characterTranslation;
 
 public:
     explicit CardDatabaseDisplayModel(QObject *parent = nullptr);
+    ~CardDatabaseDisplayModel() override;
     void setFilterTree(FilterTree *_filterTree);
     void setIsToken(FilterBool _isToken)
     {
@@ -94,6 +135,7 @@ public:
     void setCardName(const QString &_cardName)
     {
         if (filterString != nullptr) {
+            cancelSearch();
             delete filterString;
             filterString = nullptr;
         }
@@ -101,12 +143,16 @@ public:
         emit modelDirty();
         dirty();
     }
+    /**
+     * The cards are checked against the expression on a worker thread once the typing pauses. The rows shown are
+     * replaced at once when the search is done, a search that is overtaken by a newer expression is dropped.
+     */
     void setStringFilter(const QString &_src)
     {
+        cancelSearch();
         delete filterString;
         filterString = new FilterString(_src);
-        emit modelDirty();
-        dirty();
+        searchTimer.start(100);
     }
     void setCardNameSet(const QSet<QString> &_cardNameSet)
     {
@@ -125,12 +171,38 @@ public:
     void fetchMore(const QModelIndex &parent) override;
 signals:
     void modelDirty();
+    // the rows shown follow the expression given to setStringFilter()
+    void searchFinished();
 
 protected:
+    // a value of the P/T column, parsed once for lessThanNumerically()
+    struct NumericSortKey
+    {
+        QString text;
+        bool isNumber;
+        float number;
+        QString afterNumber;
+    };
+    // the sort keys of one column, for every row of the source model in generation
+    struct ColumnSortKeys
+    {
+        int column = -1;
+        int generation = -1;
+        QStringList texts;
+        std::vector<QCollatorSortKey> collated;
+        // the power and toughness of the P/T values, if they have both
+        QVector<QVector<NumericSortKey>> powerToughness;
+    };
+    // the sorted column, so that the comparisons do not fetch and parse the values of the rows again
+    mutable ColumnSortKeys sortKeys;
+
+    const ColumnSortKeys &columnSortKeys(int column) const;
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
     static int lessThanNumerically(const QString &left, const QString &right);
+    static NumericSortKey numericSortKey(const QString &value);
+    static int compareNumerically(const NumericSortKey &left, const NumericSortKey &right);
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
-    bool rowMatchesCardName(CardInfoPtr info) const;
+    bool rowMatchesCardName(int sourceRow, CardInfoPtr info) const;
 
 private slots:
     void filterTreeChanged();
@@ -1,7 +1,5 @@
 #include "card_database_parser.h"
 
-SetNameMap ICardDatabaseParser::sets;
-
 void ICardDatabaseParser::clearSetlist()
 {
     sets.clear();
@@ -16,19 +16,19 @@ public:
 
     virtual bool getCanParseFile(const QString &name, QIODevice &device) = 0;
     virtual void parseFile(QIODevice &device) = 0;
-    virtual bool saveToFile(SetNameMap sets,
-                            CardNameMap cards,
+    virtual bool saveToFile(const SetNameMap &sets,
+                            const CardNameMap &cards,
                             const QString &fileName,
                             const QString &sourceUrl = "unknown",
                             const QString &sourceVersion = "unknown") = 0;
-    static void clearSetlist();
+    void clearSetlist();
 
 protected:
     /*
-     * A cached list of the available sets, needed to cross-reference sets from cards.
-     * Shared between all parsers
+     * A cached list of the sets found so far, needed to cross-reference sets from cards.
+     * Every parser has its own, so that files can be parsed in parallel; see CardDatabase::mergeStagedDatabase().
      */
-    static SetNameMap sets;
+    SetNameMap sets;
 
     CardSetPtr internalAddSet(const QString &setName,
                               const QString &longName = "",
@@ -430,8 +430,8 @@ static QXmlStreamWriter &operator<<(QXmlStreamWriter &xml, const CardInfoPtr &in
     return xml;
 }
 
-bool CockatriceXml3Parser::saveToFile(SetNameMap _sets,
-                                      CardNameMap cards,
+bool CockatriceXml3Parser::saveToFile(const SetNameMap &_sets,
+                                      const CardNameMap &cards,
                                       const QString &fileName,
                                       const QString &sourceUrl,
                                       const QString &sourceVersion)
@@ -459,7 +459,7 @@ bool CockatriceXml3Parser::saveToFile(SetNameMap _sets,
 
     if (_sets.count() > 0) {
         xml.writeStartElement("sets");
-        for (CardSetPtr set : _sets) {
+        for (const CardSetPtr &set : _sets) {
             xml << set;
         }
         xml.writeEndElement();
@@ -467,7 +467,7 @@ bool CockatriceXml3Parser::saveToFile(SetNameMap _sets,
 
     if (cards.count() > 0) {
         xml.writeStartElement("cards");
-        for (CardInfoPtr card : cards) {
+        for (const CardInfoPtr &card : cards) {
             xml << card;
         }
         xml.writeEndElement();
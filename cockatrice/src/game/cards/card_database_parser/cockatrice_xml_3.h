@@ -17,8 +17,8 @@ public:
     ~CockatriceXml3Parser() override = default;
     bool getCanParseFile(const QString &name, QIODevice &device) override;
     void parseFile(QIODevice &device) override;
-    bool saveToFile(SetNameMap _sets,
-                    CardNameMap cards,
+    bool saveToFile(const SetNameMap &_sets,
+                    const CardNameMap &cards,
                     const QString &fileName,
                     const QString &sourceUrl = "unknown",
                     const QString &sourceVersion = "unknown") override;
@@ -2,6 +2,7 @@
 
 #include "../../../settings/cache_settings.h"
 
+#include <QBuffer>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QFile>
@@ -13,6 +14,8 @@
 #define COCKATRICE_XML4_SCHEMALOCATION                                                                                 \
     "https://raw.githubusercontent.com/Cockatrice/Cockatrice/master/doc/carddatabase_v4/cards.xsd"
 
+static const qint64 WRITE_BLOCK_SIZE = 1 << 20;
+
 bool CockatriceXml4Parser::getCanParseFile(const QString &fileName, QIODevice &device)
 {
     qCInfo(CockatriceXml4Log) << "Trying to parse: " << fileName;
@@ -113,16 +116,32 @@ void CockatriceXml4Parser::loadSetsFromXml(QXmlStreamReader &xml)
     }
 }
 
-QVariantHash CockatriceXml4Parser::loadCardPropertiesFromXml(QXmlStreamReader &xml)
+/**
+ * The same few property and attribute names are on every card, so the parser reuses the names it has seen before
+ * instead of allocating a string for every element.
+ */
+template <typename Name> static QString internName(QStringList &names, const Name &name)
+{
+    for (const QString &knownName : names) {
+        if (knownName == name) {
+            return knownName;
+        }
+    }
+    names.append(name.toString());
+    return names.constLast();
+}
+
+QVariantHash CockatriceXml4Parser::loadCardPropertiesFromXml(QXmlStreamReader &xml, int sizeHint)
 {
-    QVariantHash properties = QVariantHash();
+    QVariantHash properties;
+    properties.reserve(sizeHint);
     while (!xml.atEnd()) {
         if (xml.readNext() == QXmlStreamReader::EndElement) {
             break;
         }
 
-        auto xmlName = xml.name().toString();
-        if (!xmlName.isEmpty()) {
+        if (!xml.name().isEmpty()) {
+            const QString xmlName = internName(internedNames, xml.name());
             properties.insert(xmlName, xml.readElementText(QXmlStreamReader::IncludeChildElements));
         }
     }
@@ -132,14 +151,14 @@ QVariantHash CockatriceXml4Parser::loadCardPropertiesFromXml(QXmlStreamReader &x
 void CockatriceXml4Parser::loadCardsFromXml(QXmlStreamReader &xml)
 {
     bool includeRebalancedCards = SettingsCache::instance().getIncludeRebalancedCards();
+    // the cards of a file mostly have the same properties as the card before them
+    int propertyCount = 0;
     while (!xml.atEnd()) {
         if (xml.readNext() == QXmlStreamReader::EndElement) {
             break;
         }
 
-        auto xmlName = xml.name().toString();
-
-        if (xmlName == "card") {
+        if (xml.name() == QLatin1String("card")) {
             QString name = QString("");
             QString text = QString("");
             QVariantHash properties = QVariantHash();
@@ -156,40 +175,44 @@ void CockatriceXml4Parser::loadCardsFromXml(QXmlStreamReader &xml)
                     break;
                 }
 
-                xmlName = xml.name().toString();
+                // only valid until the reader moves on
+                const auto xmlName = xml.name();
 
                 // variable - assigned properties
-                if (xmlName == "name") {
+                if (xmlName == QLatin1String("name")) {
                     name = xml.readElementText(QXmlStreamReader::IncludeChildElements);
-                } else if (xmlName == "text") {
+                } else if (xmlName == QLatin1String("text")) {
                     text = xml.readElementText(QXmlStreamReader::IncludeChildElements);
-                } else if (xmlName == "token") {
+                } else if (xmlName == QLatin1String("token")) {
                     isToken = static_cast<bool>(xml.readElementText(QXmlStreamReader::IncludeChildElements).toInt());
                     // generic properties
-                } else if (xmlName == "prop") {
-                    properties = loadCardPropertiesFromXml(xml);
+                } else if (xmlName == QLatin1String("prop")) {
+                    properties = loadCardPropertiesFromXml(xml, propertyCount);
+                    propertyCount = properties.size();
                     // positioning info
-                } else if (xmlName == "tablerow") {
+                } else if (xmlName == QLatin1String("tablerow")) {
                     tableRow = xml.readElementText(QXmlStreamReader::IncludeChildElements).toInt();
-                } else if (xmlName == "cipt") {
+                } else if (xmlName == QLatin1String("cipt")) {
                     cipt = (xml.readElementText(QXmlStreamReader::IncludeChildElements) == "1");
-                } else if (xmlName == "landscapeOrientation") {
+                } else if (xmlName == QLatin1String("landscapeOrientation")) {
                     landscapeOrientation = (xml.readElementText(QXmlStreamReader::IncludeChildElements) == "1");
-                } else if (xmlName == "upsidedown") {
+                } else if (xmlName == QLatin1String("upsidedown")) {
                     upsideDown = (xml.readElementText(QXmlStreamReader::IncludeChildElements) == "1");
                     // sets
-                } else if (xmlName == "set") {
+                } else if (xmlName == QLatin1String("set")) {
                     // NOTE: attributes but be read before readElementText()
                     QXmlStreamAttributes attrs = xml.attributes();
                     QString setName = xml.readElementText(QXmlStreamReader::IncludeChildElements);
                     auto set = internalAddSet(setName);
                     if (set->getEnabled()) {
                         PrintingInfo printingInfo(set);
-                        for (QXmlStreamAttribute attr : attrs) {
-                            QString attrName = attr.name().toString();
-                            if (attrName == "picURL")
-                                attrName = "picurl";
-                            printingInfo.setProperty(attrName, attr.value().toString());
+                        for (const QXmlStreamAttribute &attr : attrs) {
+                            if (attr.name() == QLatin1String("picURL")) {
+                                printingInfo.setProperty(QStringLiteral("picurl"), attr.value().toString());
+                            } else {
+                                printingInfo.setProperty(internName(internedNames, attr.name()),
+                                                         attr.value().toString());
+                            }
                         }
 
                         // This is very much a hack and not the right place to
@@ -204,7 +227,8 @@ void CockatriceXml4Parser::loadCardsFromXml(QXmlStreamReader &xml)
                         }
                     }
                     // related cards
-                } else if (xmlName == "related" || xmlName == "reverse-related") {
+                } else if (xmlName == QLatin1String("related") || xmlName == QLatin1String("reverse-related")) {
+                    const bool isReverseRelated = xmlName == QLatin1String("reverse-related");
                     CardRelation::AttachType attachType = CardRelation::DoesNotAttach;
                     bool exclude = false;
                     bool variable = false;
@@ -213,13 +237,14 @@ void CockatriceXml4Parser::loadCardsFromXml(QXmlStreamReader &xml)
                     QXmlStreamAttributes attrs = xml.attributes();
                     QString cardName = xml.readElementText(QXmlStreamReader::IncludeChildElements);
                     if (attrs.hasAttribute("count")) {
-                        if (attrs.value("count").toString().indexOf("x=") == 0) {
+                        const QString countValue = attrs.value("count").toString();
+                        if (countValue.startsWith("x=")) {
                             variable = true;
-                            count = attrs.value("count").toString().remove(0, 2).toInt();
-                        } else if (attrs.value("count").toString().indexOf("x") == 0) {
+                            count = countValue.mid(2).toInt();
+                        } else if (countValue.startsWith("x")) {
                             variable = true;
                         } else {
-                            count = attrs.value("count").toString().toInt();
+                            count = countValue.toInt();
                         }
 
                         if (count < 1) {
@@ -228,8 +253,8 @@ void CockatriceXml4Parser::loadCardsFromXml(QXmlStreamReader &xml)
                     }
 
                     if (attrs.hasAttribute("attach")) {
-                        attachType = attrs.value("attach").toString() == "transform" ? CardRelation::TransformInto
-                                                                                     : CardRelation::AttachTo;
+                        attachType = attrs.value("attach") == QLatin1String("transform") ? CardRelation::TransformInto
+                                                                                         : CardRelation::AttachTo;
                     }
 
                     if (attrs.hasAttribute("exclude")) {
@@ -241,7 +266,7 @@ void CockatriceXml4Parser::loadCardsFromXml(QXmlStreamReader &xml)
                     }
 
                     auto *relation = new CardRelation(cardName, attachType, exclude, variable, count, persistent);
-                    if (xmlName == "reverse-related") {
+                    if (isReverseRelated) {
                         reverseRelatedCards << relation;
                     } else {
                         relatedCards << relation;
@@ -390,8 +415,21 @@ static QXmlStreamWriter &operator<<(QXmlStreamWriter &xml, const CardInfoPtr &in
     return xml;
 }
 
-bool CockatriceXml4Parser::saveToFile(SetNameMap _sets,
-                                      CardNameMap cards,
+/**
+ * Writes what the buffer holds to the file and empties it.
+ */
+static bool flushBlock(QBuffer &buffer, QIODevice &file)
+{
+    if (file.write(buffer.data()) != buffer.size()) {
+        return false;
+    }
+    buffer.buffer().clear();
+    buffer.seek(0);
+    return true;
+}
+
+bool CockatriceXml4Parser::saveToFile(const SetNameMap &_sets,
+                                      const CardNameMap &cards,
                                       const QString &fileName,
                                       const QString &sourceUrl,
                                       const QString &sourceVersion)
@@ -401,9 +439,12 @@ bool CockatriceXml4Parser::saveToFile(SetNameMap _sets,
         return false;
     }
 
-    QXmlStreamWriter xml(&file);
+    // the xml is collected and written to the file in large blocks instead of a few bytes per element
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QXmlStreamWriter xml(&buffer);
 
-    xml.setAutoFormatting(true);
+    xml.setAutoFormatting(!compactOutput);
     xml.writeStartDocument();
     xml.writeStartElement(COCKATRICE_XML4_TAGNAME);
     xml.writeAttribute("version", QString::number(COCKATRICE_XML4_TAGVER));
@@ -419,7 +460,7 @@ bool CockatriceXml4Parser::saveToFile(SetNameMap _sets,
 
     if (_sets.count() > 0) {
         xml.writeStartElement("sets");
-        for (CardSetPtr set : _sets) {
+        for (const CardSetPtr &set : _sets) {
             xml << set;
         }
         xml.writeEndElement();
@@ -427,8 +468,11 @@ bool CockatriceXml4Parser::saveToFile(SetNameMap _sets,
 
     if (cards.count() > 0) {
         xml.writeStartElement("cards");
-        for (CardInfoPtr card : cards) {
+        for (const CardInfoPtr &card : cards) {
             xml << card;
+            if (buffer.size() >= WRITE_BLOCK_SIZE && !flushBlock(buffer, file)) {
+                return false;
+            }
         }
         xml.writeEndElement();
     }
@@ -436,5 +480,5 @@ bool CockatriceXml4Parser::saveToFile(SetNameMap _sets,
     xml.writeEndElement(); // cockatrice_carddatabase
     xml.writeEndDocument();
 
-    return true;
+    return !xml.hasError() && flushBlock(buffer, file);
 }
@@ -4,6 +4,7 @@
 #include "card_database_parser.h"
 
 #include <QLoggingCategory>
+#include <QStringList>
 #include <QXmlStreamReader>
 
 inline Q_LOGGING_CATEGORY(CockatriceXml4Log, "cockatrice_xml.xml_4_parser");
@@ -17,14 +18,26 @@ public:
     ~CockatriceXml4Parser() override = default;
     bool getCanParseFile(const QString &name, QIODevice &device) override;
     void parseFile(QIODevice &device) override;
-    bool saveToFile(SetNameMap _sets,
-                    CardNameMap cards,
+    bool saveToFile(const SetNameMap &_sets,
+                    const CardNameMap &cards,
                     const QString &fileName,
                     const QString &sourceUrl = "unknown",
                     const QString &sourceVersion = "unknown") override;
+    /**
+     * Writes the database without indentation and line breaks, which makes the file a good deal smaller to store and
+     * to parse. Off by default, for the files users edit by hand.
+     */
+    void setCompactOutput(bool compact)
+    {
+        compactOutput = compact;
+    }
 
 private:
-    QVariantHash loadCardPropertiesFromXml(QXmlStreamReader &xml);
+    bool compactOutput = false;
+    // the names of the card properties and printing attributes seen so far
+    QStringList internedNames;
+
+    QVariantHash loadCardPropertiesFromXml(QXmlStreamReader &xml, int sizeHint);
     void loadCardsFromXml(QXmlStreamReader &xml);
     void loadSetsFromXml(QXmlStreamReader &xml);
 };
@@ -7,7 +7,9 @@
 #include <QDebug>
 #include <QDir>
 #include <QMessageBox>
+#include <QMutex>
 #include <QRegularExpression>
+#include <QSet>
 #include <algorithm>
 #include <utility>
 
@@ -215,10 +217,50 @@ void SetList::defaultSort()
     });
 }
 
+QString CardPropertyPool::intern(const QString &value)
+{
+    // sharded so that the parser threads rarely wait for each other
+    static constexpr int shardCount = 16;
+    static QMutex mutexes[shardCount];
+    static QSet<QString> pools[shardCount];
+
+    if (value.isEmpty()) {
+        return value;
+    }
+
+    const auto shard = qHash(value) % shardCount;
+    QMutexLocker locker(&mutexes[shard]);
+    auto interned = pools[shard].constFind(value);
+    if (interned != pools[shard].constEnd()) {
+        return *interned;
+    }
+    pools[shard].insert(value);
+    return value;
+}
+
+QVariantHash CardPropertyPool::intern(const QVariantHash &properties)
+{
+    QVariantHash interned;
+    interned.reserve(properties.size());
+    for (auto it = properties.constBegin(); it != properties.constEnd(); ++it) {
+        interned.insert(intern(it.key()), intern(it.value().toString()));
+    }
+    return interned;
+}
+
 PrintingInfo::PrintingInfo(const CardSetPtr &_set) : set(_set)
 {
 }
 
+void PrintingInfo::setProperty(const QString &_name, const QString &_value)
+{
+    // these identify a single printing, sharing them would only grow the pool
+    static const QSet<QString> uniqueProperties = {"uuid", "muid", "picurl"};
+
+    const QString name = CardPropertyPool::intern(_name);
+    properties.insert(name, uniqueProperties.contains(name) ? _value : CardPropertyPool::intern(_value));
+}
+
 /**
  * Gets the uuid property of the printing, or an empty string if the property isn't present
  */
@@ -238,13 +280,20 @@ CardInfo::CardInfo(const QString &_name,
                    bool _landscapeOrientation,
                    int _tableRow,
                    bool _upsideDownArt)
-    : name(_name), text(_text), isToken(_isToken), properties(std::move(_properties)), relatedCards(_relatedCards),
-      reverseRelatedCards(_reverseRelatedCards), setsToPrintings(std::move(_sets)), cipt(_cipt),
+    : name(_name), text(_text), isToken(_isToken), properties(CardPropertyPool::intern(_properties)),
+      relatedCards(_relatedCards), reverseRelatedCards(_reverseRelatedCards), cipt(_cipt),
       landscapeOrientation(_landscapeOrientation), tableRow(_tableRow), upsideDownArt(_upsideDownArt)
 {
     simpleName = CardInfo::simplifyName(name);
 
+    // key the printings by the short name held by their set, instead of a copy per card
+    for (auto it = _sets.constBegin(); it != _sets.constEnd(); ++it) {
+        const CardSetPtr set = it.value().isEmpty() ? CardSetPtr() : it.value().first().getSet();
+        setsToPrintings.insert(set && set->getShortName() == it.key() ? set->getShortName() : it.key(), it.value());
+    }
+
     refreshCachedSetNames();
+    refreshManaStatistics();
 }
 
 CardInfoPtr CardInfo::newInstance(const QString &_name)
@@ -375,12 +424,94 @@ CardRelation::CardRelation(const QString &_name,
 {
 }
 
-void CardInfo::resetReverseRelatedCards2Me()
+void CardInfo::setProperty(const QString &_name, const QString &_value)
+{
+    properties.insert(CardPropertyPool::intern(_name), CardPropertyPool::intern(_value));
+    if (_name == Mtg::ManaCost || _name == Mtg::ConvertedManaCost) {
+        refreshManaStatistics();
+    }
+    emit cardInfoChanged(smartThis);
+}
+
+void CardInfo::refreshManaStatistics()
 {
-    for (CardRelation *cardRelation : this->getReverseRelatedCards2Me()) {
-        cardRelation->deleteLater();
+    manaStatistics = CardManaStatistics::parse(getManaCost(), getCmc(), text);
+}
+
+// the colored mana symbols, -1 for anything else
+static int manaColorOfSymbol(const QChar &symbol)
+{
+    switch (symbol.unicode()) {
+        case 'W':
+            return CardManaStatistics::White;
+        case 'U':
+            return CardManaStatistics::Blue;
+        case 'B':
+            return CardManaStatistics::Black;
+        case 'R':
+            return CardManaStatistics::Red;
+        case 'G':
+            return CardManaStatistics::Green;
+        default:
+            return -1;
+    }
+}
+
+CardManaStatistics CardManaStatistics::parse(const QString &manaCost,
+                                             const QString &manaValue,
+                                             const QString &rulesText)
+{
+    CardManaStatistics statistics;
+    statistics.manaValue = manaValue.toInt();
+
+    // the colored symbols of the mana cost, in braces or not
+    const int len = manaCost.length();
+    for (int i = 0; i < len; ++i) {
+        if (manaCost[i] == '{') {
+            ++i; // Move past '{'
+            const int color1 = i < len ? manaColorOfSymbol(manaCost[i]) : -1;
+            if (color1 != -1) {
+                ++statistics.pips[color1];
+                ++i; // Move to next character
+                if (i < len && manaCost[i] == '/') {
+                    ++i; // Move past '/'
+                    // a hybrid symbol like {W/U}, "{W/}" only counts once
+                    const int color2 = i < len ? manaColorOfSymbol(manaCost[i]) : -1;
+                    if (color2 != -1) {
+                        ++statistics.pips[color2];
+                    }
+                }
+            }
+            // Ensure we always skip to the closing '}'
+            while (i < len && manaCost[i] != '}') {
+                ++i;
+            }
+        } else {
+            const int color = manaColorOfSymbol(manaCost[i]);
+            if (color != -1) {
+                ++statistics.pips[color];
+            }
+        }
+    }
+
+    // the mana the card can add
+    if (rulesText.contains("add", Qt::CaseInsensitive)) {
+        if (rulesText.contains("add one mana of any color", Qt::CaseInsensitive)) {
+            statistics.producedMana |= (1 << White) | (1 << Blue) | (1 << Black) | (1 << Red) | (1 << Green);
+        }
+        if (rulesText.contains("{t}: add {c}", Qt::CaseInsensitive) ||
+            rulesText.contains("add one colorless mana", Qt::CaseInsensitive)) {
+            statistics.producedMana |= 1 << Colorless;
+        }
+
+        static const QRegularExpression specificColorRegex(R"(\{T\}:\s*Add\s*\{([WUBRG])\})");
+        const QRegularExpressionMatch match = specificColorRegex.match(rulesText);
+        if (match.hasMatch()) {
+            statistics.producedMana |= 1 << manaColorOfSymbol(match.captured(1).at(0));
+        }
     }
-    reverseRelatedCardsToMe = QList<CardRelation *>();
+
+    return statistics;
 }
 
 // Back-compatibility methods. Remove ASAP
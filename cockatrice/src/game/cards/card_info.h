@@ -10,6 +10,7 @@
 #include <QSharedPointer>
 #include <QStringList>
 #include <QVariant>
+#include <array>
 #include <utility>
 
 inline Q_LOGGING_CATEGORY(CardInfoLog, "card_info");
@@ -145,6 +146,20 @@ public:
 /**
  * Info relating to a specific printing for a card.
  */
+/**
+ * Shares the strings of the card properties between the cards and printings holding them.
+ *
+ * Most property names and values repeat throughout the database (types, mana costs, colors, legalities, rarities),
+ * but every card parsed from a file holds its own copy of them. Interned strings are implicitly shared with the pool
+ * instead, so each distinct string is kept once. The pool is safe to use from the threads parsing the databases.
+ */
+class CardPropertyPool
+{
+public:
+    static QString intern(const QString &value);
+    static QVariantHash intern(const QVariantHash &properties);
+};
+
 class PrintingInfo
 {
 public:
@@ -174,12 +189,43 @@ public:
     {
         return properties.value(propertyName).toString();
     }
-    void setProperty(const QString &_name, const QString &_value)
+    void setProperty(const QString &_name, const QString &_value);
+
+    QString getUuid() const;
+};
+
+/**
+ * The mana of a card as the deck analytics count it, worked out from its mana cost and rules text when the card is
+ * loaded so that the analytics of a deck are sums of small integers.
+ */
+struct CardManaStatistics
+{
+    // the colors in WUBRG order, then colorless
+    enum Color
+    {
+        White,
+        Blue,
+        Black,
+        Red,
+        Green,
+        Colorless,
+        ColorCount
+    };
+    // the mana symbol of each Color
+    static constexpr char SYMBOLS[ColorCount + 1] = "WUBRGC";
+
+    int manaValue = 0;
+    // the symbols of each color in the mana cost, a hybrid symbol counts for both of its colors
+    std::array<quint8, Colorless> pips = {};
+    // one bit per Color the card can add mana of
+    quint8 producedMana = 0;
+
+    bool produces(Color color) const
     {
-        properties.insert(_name, _value);
+        return producedMana & (1 << color);
     }
 
-    QString getUuid() const;
+    static CardManaStatistics parse(const QString &manaCost, const QString &manaValue, const QString &rulesText);
 };
 
 class CardInfo : public QObject
@@ -212,6 +258,9 @@ private:
     bool landscapeOrientation;
     int tableRow;
     bool upsideDownArt;
+    CardManaStatistics manaStatistics;
+
+    void refreshManaStatistics();
 
 public:
     explicit CardInfo(const QString &_name,
@@ -230,7 +279,8 @@ public:
           isToken(other.isToken), properties(other.properties), relatedCards(other.relatedCards),
           reverseRelatedCards(other.reverseRelatedCards), reverseRelatedCardsToMe(other.reverseRelatedCardsToMe),
           setsToPrintings(other.setsToPrintings), setsNames(other.setsNames), cipt(other.cipt),
-          landscapeOrientation(other.landscapeOrientation), tableRow(other.tableRow), upsideDownArt(other.upsideDownArt)
+          landscapeOrientation(other.landscapeOrientation), tableRow(other.tableRow),
+          upsideDownArt(other.upsideDownArt), manaStatistics(other.manaStatistics)
     {
     }
 
@@ -278,6 +328,7 @@ public:
     void setText(const QString &_text)
     {
         text = _text;
+        refreshManaStatistics();
         emit cardInfoChanged(smartThis);
     }
 
@@ -293,11 +344,7 @@ public:
     {
         return properties.value(propertyName).toString();
     }
-    void setProperty(const QString &_name, const QString &_value)
-    {
-        properties.insert(_name, _value);
-        emit cardInfoChanged(smartThis);
-    }
+    void setProperty(const QString &_name, const QString &_value);
     bool hasProperty(const QString &propertyName) const
     {
         return properties.contains(propertyName);
@@ -306,6 +353,10 @@ public:
     {
         return setsToPrintings;
     }
+    const CardManaStatistics &getManaStatistics() const
+    {
+        return manaStatistics;
+    }
     const QString &getSetsNames() const
     {
         return setsNames;
@@ -331,11 +382,19 @@ public:
         result.append(getReverseRelatedCards2Me());
         return result;
     }
-    void resetReverseRelatedCards2Me();
+    // the relations to me are owned by the CardRelationIndex of the database
+    void resetReverseRelatedCards2Me()
+    {
+        reverseRelatedCardsToMe.clear();
+    }
     void addReverseRelatedCards2Me(CardRelation *cardRelation)
     {
         reverseRelatedCardsToMe.append(cardRelation);
     }
+    void removeReverseRelatedCards2Me(CardRelation *cardRelation)
+    {
+        reverseRelatedCardsToMe.removeOne(cardRelation);
+    }
 
     // positioning
     bool getCipt() const
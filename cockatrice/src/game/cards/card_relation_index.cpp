@@ -0,0 +1,94 @@
+#include "card_relation_index.h"
+
+int CardRelationIndex::idOf(const QString &name)
+{
+    auto id = ids.constFind(name);
+    if (id != ids.constEnd()) {
+        return *id;
+    }
+
+    const int newId = nodes.size();
+    ids.insert(name, newId);
+    nodes.append(Node());
+    nodes.last().name = name;
+    return newId;
+}
+
+void CardRelationIndex::link(Node &target, IncomingRelation &relation)
+{
+    arena.emplace_back(nodes.at(relation.source).name, relation.attachType, relation.isCreateAllExclusion,
+                       relation.isVariableCount, relation.defaultCount, relation.isPersistent);
+    relation.linked = &arena.back();
+    target.card->addReverseRelatedCards2Me(relation.linked);
+}
+
+void CardRelationIndex::cardAdded(const CardInfoPtr &card)
+{
+    const int source = idOf(card->getName());
+    nodes[source].card = card;
+
+    // the cards this one is reverse-related to, if they are in the database already
+    QVector<int> targets;
+    for (const CardRelation *cardRelation : card->getReverseRelatedCards()) {
+        const int target = idOf(cardRelation->getName());
+        targets.append(target);
+
+        Node &targetNode = nodes[target];
+        targetNode.incoming.append({source, cardRelation->getAttachType(), cardRelation->getIsCreateAllExclusion(),
+                                    cardRelation->getIsVariable(), cardRelation->getDefaultCount(),
+                                    cardRelation->getIsPersistent(), nullptr});
+        if (targetNode.card) {
+            link(targetNode, targetNode.incoming.last());
+        }
+    }
+
+    Node &sourceNode = nodes[source];
+    sourceNode.targets = targets;
+
+    // the cards added before that are reverse-related to this one
+    for (IncomingRelation &relation : sourceNode.incoming) {
+        if (!relation.linked && nodes.at(relation.source).card) {
+            link(sourceNode, relation);
+        }
+    }
+}
+
+void CardRelationIndex::cardRemoved(const CardInfoPtr &card)
+{
+    auto id = ids.constFind(card->getName());
+    if (id == ids.constEnd()) {
+        card->resetReverseRelatedCards2Me();
+        return;
+    }
+    const int source = *id;
+
+    for (int target : nodes.at(source).targets) {
+        Node &targetNode = nodes[target];
+        for (int i = targetNode.incoming.size() - 1; i >= 0; --i) {
+            const IncomingRelation &relation = targetNode.incoming.at(i);
+            if (relation.source != source) {
+                continue;
+            }
+            if (relation.linked && targetNode.card) {
+                targetNode.card->removeReverseRelatedCards2Me(relation.linked);
+            }
+            targetNode.incoming.removeAt(i);
+        }
+    }
+
+    // the relations of other cards to this one are kept for when it is added again
+    Node &sourceNode = nodes[source];
+    sourceNode.targets.clear();
+    for (IncomingRelation &relation : sourceNode.incoming) {
+        relation.linked = nullptr;
+    }
+    sourceNode.card.clear();
+    card->resetReverseRelatedCards2Me();
+}
+
+void CardRelationIndex::clear()
+{
+    ids.clear();
+    nodes.clear();
+    arena.clear();
+}
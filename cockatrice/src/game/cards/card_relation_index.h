@@ -0,0 +1,58 @@
+#ifndef CARD_RELATION_INDEX_H
+#define CARD_RELATION_INDEX_H
+
+#include "card_info.h"
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <deque>
+
+/**
+ * Keeps the reverse relations of the cards in the database up to date: when a card says it is reverse-related to
+ * another one, the other card lists the first one in getReverseRelatedCards2Me().
+ *
+ * Cards are known by ids interned from their names, and every card id keeps the reverse relations pointing at it,
+ * whether the card is in the database or not, so adding or removing a card only touches the relations of that card.
+ * The CardRelation objects handed to the cards live in an arena owned by the index and stay valid until clear().
+ */
+class CardRelationIndex
+{
+public:
+    void cardAdded(const CardInfoPtr &card);
+    void cardRemoved(const CardInfoPtr &card);
+    void clear();
+
+private:
+    // one card's reverse relation to another card
+    struct IncomingRelation
+    {
+        int source;
+        CardRelation::AttachType attachType;
+        bool isCreateAllExclusion;
+        bool isVariableCount;
+        int defaultCount;
+        bool isPersistent;
+        // what the target card lists, if both cards are in the database
+        CardRelation *linked;
+    };
+
+    struct Node
+    {
+        QString name;
+        // set while the card is in the database
+        CardInfoPtr card;
+        QVector<IncomingRelation> incoming;
+        // the cards this card is reverse-related to
+        QVector<int> targets;
+    };
+
+    QHash<QString, int> ids;
+    QVector<Node> nodes;
+    std::deque<CardRelation> arena;
+
+    int idOf(const QString &name);
+    void link(Node &target, IncomingRelation &relation);
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include "card_search_index.h"
+
+#include <algorithm>
+#include <iterator>
+
+quint64 CardSearchIndex::trigramAt(const QString &foldedText, int position)
+{
+    return (quint64(foldedText.at(position).unicode()) << 32) |
+           (quint64(foldedText.at(position + 1).unicode()) << 16) | quint64(foldedText.at(position + 2).unicode());
+}
+
+void CardSearchIndex::cardAppended(const CardInfoPtr &card)
+{
+    const int row = rowCount++;
+    const QString name = card->getName().toCaseFolded();
+    for (int i = 0; i + 3 <= name.size(); ++i) {
+        QVector<int> &rows = nameTrigrams[trigramAt(name, i)];
+        // names repeating a trigram are listed once
+        if (rows.isEmpty() || rows.last() != row) {
+            rows.append(row);
+        }
+    }
+    sortedNames.append({name, row});
+    namesSorted = false;
+}
+
+void CardSearchIndex::reset(const QList<CardInfoPtr> &cards)
+{
+    rowCount = 0;
+    nameTrigrams.clear();
+    sortedNames.clear();
+    for (const CardInfoPtr &card : cards) {
+        cardAppended(card);
+    }
+}
+
+QBitArray CardSearchIndex::rowsMatchingName(const QString &text) const
+{
+    const QString folded = text.toCaseFolded();
+    if (folded.size() < 3) {
+        return QBitArray(rowCount, true);
+    }
+
+    QVector<const QVector<int> *> lists;
+    for (int i = 0; i + 3 <= folded.size(); ++i) {
+        auto rows = nameTrigrams.constFind(trigramAt(folded, i));
+        if (rows == nameTrigrams.constEnd()) {
+            return QBitArray(rowCount, false);
+        }
+        lists.append(&*rows);
+    }
+
+    // the lists are sorted by row, intersect them starting from the shortest one
+    std::sort(lists.begin(), lists.end(),
+              [](const QVector<int> *left, const QVector<int> *right) { return left->size() < right->size(); });
+    QVector<int> candidates = *lists.first();
+    for (int i = 1; i < lists.size() && !candidates.isEmpty(); ++i) {
+        QVector<int> intersection;
+        std::set_intersection(candidates.constBegin(), candidates.constEnd(), lists.at(i)->constBegin(),
+                              lists.at(i)->constEnd(), std::back_inserter(intersection));
+        candidates.swap(intersection);
+    }
+
+    QBitArray result(rowCount, false);
+    for (int row : candidates) {
+        result.setBit(row);
+    }
+    return result;
+}
+
+QVector<int> CardSearchIndex::rowsWithNamePrefix(const QString &prefix) const
+{
+    auto byName = [](const NameEntry &left, const NameEntry &right) { return left.foldedName < right.foldedName; };
+    if (!namesSorted) {
+        std::sort(sortedNames.begin(), sortedNames.end(), byName);
+        namesSorted = true;
+    }
+
+    // the names starting with the prefix follow each other, right after where the prefix itself would be
+    const QString folded = prefix.toCaseFolded();
+    QVector<int> rows;
+    for (auto it = std::lower_bound(sortedNames.constBegin(), sortedNames.constEnd(), NameEntry{folded, 0}, byName);
+         it != sortedNames.constEnd() && it->foldedName.startsWith(folded); ++it) {
+        rows.append(it->row);
+    }
+    return rows;
+}
@@ -0,0 +1,54 @@
+#ifndef CARD_SEARCH_INDEX_H
+#define CARD_SEARCH_INDEX_H
+
+#include "card_info.h"
+
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+/**
+ * An index of the card names shown by a CardDatabaseModel, so that searching by name does not have to compare the
+ * search text against every card.
+ *
+ * Every row is listed under the trigrams of its case folded card name. The rows whose name contains a text have all
+ * of its trigrams, so intersecting their lists narrows the search down to a few candidate rows. For completing a
+ * name being typed, the folded names are also kept sorted so the names starting with a text are found by binary search.
+ */
+class CardSearchIndex
+{
+public:
+    void cardAppended(const CardInfoPtr &card);
+    void reset(const QList<CardInfoPtr> &cards);
+
+    /**
+     * Returns the rows whose card name may contain text, case insensitively. Every row whose name does contain it is
+     * set, but the names of the rows set still have to be checked; texts shorter than a trigram set every row.
+     */
+    QBitArray rowsMatchingName(const QString &text) const;
+
+    /**
+     * Returns the rows whose card name starts with prefix, case insensitively, in the order of their names. Takes the
+     * length of the prefix times the log of the card count, plus the rows found.
+     */
+    QVector<int> rowsWithNamePrefix(const QString &prefix) const;
+
+private:
+    struct NameEntry
+    {
+        QString foldedName;
+        int row;
+    };
+
+    int rowCount = 0;
+    QHash<quint64, QVector<int>> nameTrigrams;
+    // sorted by foldedName the first time a prefix is looked up after the cards changed, not for every appended card
+    mutable QVector<NameEntry> sortedNames;
+    mutable bool namesSorted = true;
+
+    static quint64 trigramAt(const QString &foldedText, int position);
+};
+
+#endif
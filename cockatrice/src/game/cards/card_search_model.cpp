@@ -29,40 +29,66 @@ QVariant CardSearchModel::data(const QModelIndex &index, int role) const
 
 void CardSearchModel::updateSearchResults(const QString &query)
 {
+    static constexpr int maxResults = 10;
+
     beginResetModel();
     searchResults.clear();
 
-    if (query.isEmpty() || !sourceModel)
+    if (query.isEmpty() || !sourceModel) {
+        endResetModel();
         return;
+    }
 
     // Set the filter for the display model
     sourceModel->setCardName(query);
 
-    // Collect matching cards and compute Levenshtein distance
-    for (int i = 0; i < sourceModel->rowCount(); ++i) {
-        QModelIndex modelIndex = sourceModel->index(i, 0);
-        QModelIndex sourceIndex = sourceModel->mapToSource(modelIndex);
-        CardDatabaseModel *sourceDbModel = qobject_cast<CardDatabaseModel *>(sourceModel->sourceModel());
+    CardDatabaseModel *sourceDbModel = qobject_cast<CardDatabaseModel *>(sourceModel->sourceModel());
+    if (!sourceDbModel) {
+        endResetModel();
+        return;
+    }
 
-        if (!sourceDbModel || !sourceIndex.isValid())
+    // Keep the best results in a max-heap on the distance, a card has to beat the worst of them to get in
+    const LevenshteinMatcher matcher(query);
+    auto worseMatch = [](const SearchResult &a, const SearchResult &b) { return a.distance < b.distance; };
+    auto consider = [&](const CardInfoPtr &card) {
+        if (searchResults.size() < maxResults) {
+            searchResults.append({card, matcher.distance(card->getName())});
+            std::push_heap(searchResults.begin(), searchResults.end(), worseMatch);
             return;
+        }
+
+        const int distance = matcher.distance(card->getName(), searchResults.first().distance - 1);
+        if (distance < searchResults.first().distance) {
+            std::pop_heap(searchResults.begin(), searchResults.end(), worseMatch);
+            searchResults.last() = {card, distance};
+            std::push_heap(searchResults.begin(), searchResults.end(), worseMatch);
+        }
+    };
+
+    // The names starting with the query are what is being typed, they come from the sorted names without a scan
+    for (int row : sourceDbModel->rowsWithNamePrefix(query)) {
+        consider(sourceDbModel->getCard(row));
+    }
 
-        CardInfoPtr card = sourceDbModel->getCard(sourceIndex.row());
+    // Only look at the other cards if there are not enough of those
+    if (searchResults.size() < maxResults) {
+        const QString prefix = query.toCaseFolded();
+        for (int i = 0; i < sourceModel->rowCount(); ++i) {
+            QModelIndex sourceIndex = sourceModel->mapToSource(sourceModel->index(i, 0));
+            if (!sourceIndex.isValid())
+                break;
 
-        if (!card)
-            continue;
+            CardInfoPtr card = sourceDbModel->getCard(sourceIndex.row());
+            if (!card || card->getName().toCaseFolded().startsWith(prefix))
+                continue;
 
-        int distance = levenshteinDistance(query.toLower(), card->getName().toLower());
-        searchResults.append({card, distance});
+            consider(card);
+        }
     }
 
     // Sort by Levenshtein distance (lower distance = better match)
-    std::sort(searchResults.begin(), searchResults.end(),
-              [](const SearchResult &a, const SearchResult &b) { return a.distance < b.distance; });
-
-    // Keep only the top 5 results
-    if (searchResults.size() > 10)
-        searchResults = searchResults.mid(0, 10);
+    std::sort_heap(searchResults.begin(), searchResults.end(), worseMatch);
 
     emit dataChanged(index(0, 0), index(rowCount() - 1, 0));
     emit layoutChanged();
@@ -4,6 +4,8 @@
 #include "filter_string.h"
 #include "lib/peglib.h"
 
+#include <QHash>
+
 static peg::parser search(R"(
 Start <- QueryPartList
 ~ws <- [ ]+
@@ -40,6 +42,15 @@ NumericValue <- [0-9]+
 
 static std::once_flag init;
 
+// the filters of the latest queries, so that retyping or undoing a query does not parse it again
+struct ParsedDeckQuery
+{
+    DeckFilter filter;
+    QString error;
+};
+static QHash<QByteArray, ParsedDeckQuery> parsedQueries;
+static constexpr int maxParsedQueries = 64;
+
 static void setupParserRules()
 {
     // plumbing
@@ -117,12 +128,12 @@ static void setupParserRules()
 
         return [=](const DeckPreviewWidget *deck, const ExtraDeckSearchInfo &) -> bool {
             int count = 0;
-            deck->deckLoader->forEachCard([&](InnerDecklistNode *, const DecklistCardNode *node) {
-                auto cardInfoPtr = CardDatabaseManager::getInstance()->getCardInfo(node->getName());
+            for (const DeckMetadata::Card &card : deck->getMetadata().cards) {
+                auto cardInfoPtr = CardDatabaseManager::getInstance()->getCardInfo(card.cardRef.name);
                 if (!cardInfoPtr.isNull() && cardFilter.check(cardInfoPtr)) {
-                    count += node->getNumber();
+                    count += card.count;
                 }
-            });
+            }
             return numberMatcher(count);
         };
     };
@@ -136,7 +147,7 @@ static void setupParserRules()
     search["DeckNameQuery"] = [](const peg::SemanticValues &sv) -> DeckFilter {
         auto name = std::any_cast<QString>(sv[0]);
         return [=](const DeckPreviewWidget *deck, const ExtraDeckSearchInfo &) {
-            return deck->deckLoader->getName().contains(name, Qt::CaseInsensitive);
+            return deck->getMetadata().name.contains(name, Qt::CaseInsensitive);
         };
     };
 
@@ -182,6 +193,13 @@ DeckFilterString::DeckFilterString(const QString &expr)
         return;
     }
 
+    auto parsed = parsedQueries.constFind(ba);
+    if (parsed != parsedQueries.constEnd()) {
+        filter = parsed->filter;
+        _error = parsed->error;
+        return;
+    }
+
     search.set_logger([&](size_t /*ln*/, size_t col, const std::string &msg) {
         _error = QString("Error at position %1: %2").arg(col).arg(QString::fromStdString(msg));
     });
@@ -190,4 +208,9 @@ DeckFilterString::DeckFilterString(const QString &expr)
         qCInfo(DeckFilterStringLog).nospace() << "DeckFilterString error for " << expr << "; " << qPrintable(_error);
         filter = [](const DeckPreviewWidget *, const ExtraDeckSearchInfo &) { return false; };
     }
+
+    if (parsedQueries.size() >= maxParsedQueries) {
+        parsedQueries.clear();
+    }
+    parsedQueries.insert(ba, {filter, _error});
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include <QByteArray>
 #include <QDebug>
+#include <QHash>
 #include <QRegularExpression>
 #include <QString>
 #include <functional>
@@ -72,6 +73,31 @@ NumericValue <- [0-9]+
 
 static std::once_flag init;
 
+// the filters of the latest queries, so that retyping or undoing a query does not parse it again
+struct ParsedQuery
+{
+    Filter result;
+    QString error;
+};
+static QHash<QByteArray, ParsedQuery> parsedQueries;
+static constexpr int maxParsedQueries = 64;
+
+// whether target is one of the words of s, like s.split(" ").contains(target, Qt::CaseInsensitive) without splitting
+static bool containsWord(const QString &s, const QString &target)
+{
+    if (target.isEmpty() || target.contains(' ')) {
+        return s.split(" ").contains(target, Qt::CaseInsensitive);
+    }
+
+    for (int from = 0; (from = s.indexOf(target, from, Qt::CaseInsensitive)) != -1; ++from) {
+        const int end = from + target.size();
+        if ((from == 0 || s.at(from - 1) == ' ') && (end == s.size() || s.at(end) == ' ')) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static void setupParserRules()
 {
     auto passthru = [](const peg::SemanticValues &sv) -> Filter {
@@ -104,10 +130,8 @@ static void setupParserRules()
     search["SetQuery"] = [](const peg::SemanticValues &sv) -> Filter {
         auto matcher = std::any_cast<StringMatcher>(sv[0]);
         return [=](const CardData &x) -> bool {
-            QList<QString> sets = x->getSets().keys();
-
-            auto matchesSet = [&matcher](const QString &set) { return matcher(set); };
-            return std::any_of(sets.begin(), sets.end(), matchesSet);
+            const SetToPrintingsMap &sets = x->getSets();
+            return std::any_of(sets.keyBegin(), sets.keyEnd(), matcher);
         };
     };
     search["Rarity"] = [](const peg::SemanticValues &sv) -> QString {
@@ -129,15 +153,13 @@ static void setupParserRules()
     search["RarityQuery"] = [](const peg::SemanticValues &sv) -> Filter {
         const auto rarity = std::any_cast<QString>(sv[0]);
         return [=](const CardData &x) -> bool {
-            QList<PrintingInfo> infos;
+            auto matchesRarity = [&rarity](const PrintingInfo &info) { return rarity == info.getProperty("rarity"); };
             for (const auto &printings : x->getSets()) {
-                for (const auto &printing : printings) {
-                    infos.append(printing);
+                if (std::any_of(printings.begin(), printings.end(), matchesRarity)) {
+                    return true;
                 }
             }
-
-            auto matchesRarity = [&rarity](const PrintingInfo &info) { return rarity == info.getProperty("rarity"); };
-            return std::any_of(infos.begin(), infos.end(), matchesRarity);
+            return false;
         };
     };
 
@@ -190,12 +212,12 @@ static void setupParserRules()
     search["StringValue"] = [](const peg::SemanticValues &sv) -> StringMatcher {
         if (sv.choice() == 0) {
             const auto target = std::any_cast<QString>(sv[0]);
-            return [=](const QString &s) { return s.split(" ").contains(target, Qt::CaseInsensitive); };
+            return [=](const QString &s) { return containsWord(s, target); };
         }
 
         const auto target = std::any_cast<QStringList>(sv[0]);
         return [=](const QString &s) {
-            auto containsString = [&s](const QString &str) { return s.split(" ").contains(str, Qt::CaseInsensitive); };
+            auto containsString = [&s](const QString &str) { return containsWord(s, str); };
             return std::any_of(target.begin(), target.end(), containsString);
         };
     };
@@ -212,14 +234,14 @@ static void setupParserRules()
             const auto target = std::any_cast<QStringList>(sv[0]);
             return [=](const QString &s) {
                 auto containsString = [&s](const QString &str) {
-                    return s.split(" ").contains(str, Qt::CaseInsensitive);
+                    return containsWord(s, str);
                 };
                 return std::any_of(target.begin(), target.end(), containsString);
             };
         }
 
         const auto target = std::any_cast<QString>(sv[0]);
-        return [=](const QString &s) { return s.split(" ").contains(target, Qt::CaseInsensitive); };
+        return [=](const QString &s) { return containsWord(s, target); };
     };
     search["CompactStringSet"] = [](const peg::SemanticValues &sv) -> QStringList {
         QStringList result;
@@ -392,6 +414,13 @@ FilterString::FilterString(const QString &expr)
         return;
     }
 
+    auto parsed = parsedQueries.constFind(ba);
+    if (parsed != parsedQueries.constEnd()) {
+        result = parsed->result;
+        _error = parsed->error;
+        return;
+    }
+
     search.set_logger([&](size_t /*ln*/, size_t col, const std::string &msg) {
         _error = QString("Error at position %1: %2").arg(col).arg(QString::fromStdString(msg));
     });
@@ -400,4 +429,9 @@ FilterString::FilterString(const QString &expr)
         qCInfo(FilterStringLog).nospace() << "FilterString error for " << expr << "; " << qPrintable(_error);
         result = [](const CardData &) -> bool { return false; };
     }
+
+    if (parsedQueries.size() >= maxParsedQueries) {
+        parsedQueries.clear();
+    }
+    parsedQueries.insert(ba, {result, _error});
 }
@@ -3,6 +3,7 @@
 #include "filter_card.h"
 
 #include <QList>
+#include <algorithm>
 
 template <class T> FilterTreeNode *FilterTreeBranch<T>::nodeAt(int i) const
 {
@@ -148,6 +149,122 @@ bool FilterItemList::testTypeOrNot(const CardInfoPtr info, CardFilter::Attr attr
     return !testTypeAnd(info, attr);
 }
 
+FilterItem::FilterItem(QString trm, FilterItemList *parent)
+    : p(parent), relation(RelationNone), relationValue(0), term(std::move(trm))
+{
+    prepareTerm();
+}
+
+void FilterItem::prepareTerm()
+{
+    switch (attr()) {
+        case CardFilter::AttrColor: {
+            preparedTerm = term.trimmed();
+            preparedTerm.replace("green", "g", Qt::CaseInsensitive);
+            preparedTerm.replace("grn", "g", Qt::CaseInsensitive);
+            preparedTerm.replace("blue", "u", Qt::CaseInsensitive);
+            preparedTerm.replace("blu", "u", Qt::CaseInsensitive);
+            preparedTerm.replace("black", "b", Qt::CaseInsensitive);
+            preparedTerm.replace("blk", "b", Qt::CaseInsensitive);
+            preparedTerm.replace("red", "r", Qt::CaseInsensitive);
+            preparedTerm.replace("white", "w", Qt::CaseInsensitive);
+            preparedTerm.replace("wht", "w", Qt::CaseInsensitive);
+            preparedTerm.replace("colorless", "c", Qt::CaseInsensitive);
+            preparedTerm.replace("colourless", "c", Qt::CaseInsensitive);
+            preparedTerm.replace("none", "c", Qt::CaseInsensitive);
+            preparedTerm.replace(QString(" "), QString(""), Qt::CaseInsensitive);
+            break;
+        }
+        case CardFilter::AttrManaCost:
+            // sorted so it will be easy to find
+            preparedTerm = term.toUpper();
+            std::sort(preparedTerm.begin(), preparedTerm.end());
+            break;
+        case CardFilter::AttrRarity: {
+            preparedTerm = term.trimmed();
+
+            /*
+             * The purpose of this loop is to only apply one of the replacement
+             * policies and then escape. If we attempt to layer them on top of
+             * each other, we will get awkward results (i.e. comythic rare mythic rareon)
+             * Conditional statement will exit once a case is successful in
+             * replacement OR we go through all possible cases.
+             * Will also need to replace just "mythic"
+             */
+            for (int i = 0; preparedTerm.length() <= 3 && i <= 6; i++) {
+                switch (i) {
+                    case 0:
+                        preparedTerm.replace("mr", "mythic", Qt::CaseInsensitive);
+                        break;
+                    case 1:
+                        preparedTerm.replace("m r", "mythic", Qt::CaseInsensitive);
+                        break;
+                    case 2:
+                        preparedTerm.replace("m", "mythic", Qt::CaseInsensitive);
+                        break;
+                    case 3:
+                        preparedTerm.replace("c", "common", Qt::CaseInsensitive);
+                        break;
+                    case 4:
+                        preparedTerm.replace("u", "uncommon", Qt::CaseInsensitive);
+                        break;
+                    case 5:
+                        preparedTerm.replace("r", "rare", Qt::CaseInsensitive);
+                        break;
+                    case 6:
+                        preparedTerm.replace("s", "special", Qt::CaseInsensitive);
+                        break;
+                    default:
+                        break;
+                }
+            }
+            break;
+        }
+        case CardFilter::AttrFormat:
+            preparedTerm = QString("format-%1").arg(term.toLower());
+            break;
+        case CardFilter::AttrLoyalty:
+            preparedTerm = term.trimmed().toUpper();
+            break;
+        default:
+            break;
+    }
+
+    bool conversion;
+    relationValue = term.toInt(&conversion);
+    if (conversion) {
+        relation = RelationEqual;
+        return;
+    }
+
+    // if int conversion fails, there's probably an operator at the start
+    // leading whitespaces could cause indexing to fail
+    const QString trimmedTerm = term.trimmed();
+    // check whether it's a 2 char operator (<=, >=, or ==)
+    if (trimmedTerm.length() > 1 && trimmedTerm[1] == '=') {
+        relationValue = trimmedTerm.mid(2).toInt();
+        if (trimmedTerm.startsWith('<')) {
+            relation = RelationLessEqual;
+        } else if (trimmedTerm.startsWith('>')) {
+            relation = RelationGreaterEqual;
+        } else {
+            relation = RelationEqual;
+        }
+    } else {
+        relationValue = trimmedTerm.mid(1).toInt();
+        if (trimmedTerm.startsWith('<')) {
+            relation = RelationLess;
+        } else if (trimmedTerm.startsWith('>')) {
+            relation = RelationGreater;
+        } else if (trimmedTerm.startsWith("=")) {
+            relation = RelationEqual;
+        } else {
+            // the int conversion hasn't failed due to an operator at the start
+            relation = RelationNone;
+        }
+    }
+}
+
 bool FilterItem::acceptName(const CardInfoPtr info) const
 {
     return info->getName().contains(term, Qt::CaseInsensitive);
@@ -172,25 +289,8 @@ bool FilterItem::acceptSubType(const CardInfoPtr info) const
 
 bool FilterItem::acceptColor(const CardInfoPtr info) const
 {
-    QString converted_term = term.trimmed();
-
-    converted_term.replace("green", "g", Qt::CaseInsensitive);
-    converted_term.replace("grn", "g", Qt::CaseInsensitive);
-    converted_term.replace("blue", "u", Qt::CaseInsensitive);
-    converted_term.replace("blu", "u", Qt::CaseInsensitive);
-    converted_term.replace("black", "b", Qt::CaseInsensitive);
-    converted_term.replace("blk", "b", Qt::CaseInsensitive);
-    converted_term.replace("red", "r", Qt::CaseInsensitive);
-    converted_term.replace("white", "w", Qt::CaseInsensitive);
-    converted_term.replace("wht", "w", Qt::CaseInsensitive);
-    converted_term.replace("colorless", "c", Qt::CaseInsensitive);
-    converted_term.replace("colourless", "c", Qt::CaseInsensitive);
-    converted_term.replace("none", "c", Qt::CaseInsensitive);
-
-    converted_term.replace(QString(" "), QString(""), Qt::CaseInsensitive);
-
     // Colorless card filter
-    if (converted_term.toLower() == "c" && info->getColors().length() < 1) {
+    if (preparedTerm.toLower() == "c" && info->getColors().length() < 1) {
         return true;
     }
 
@@ -199,12 +299,12 @@ bool FilterItem::acceptColor(const CardInfoPtr info) const
      * then we should match all of them to the card's colors
      */
     int match_count = 0;
-    for (auto &it : converted_term) {
+    for (const auto &it : preparedTerm) {
         if (info->getColors().contains(it, Qt::CaseInsensitive))
             match_count++;
     }
 
-    return match_count == converted_term.length();
+    return match_count == preparedTerm.length();
 }
 
 bool FilterItem::acceptText(const CardInfoPtr info) const
@@ -230,18 +330,13 @@ bool FilterItem::acceptSet(const CardInfoPtr info) const
 
 bool FilterItem::acceptManaCost(const CardInfoPtr info) const
 {
-    QString partialCost = term.toUpper();
-
-    // Sort the mana cost so it will be easy to find
-    std::sort(partialCost.begin(), partialCost.end());
-
     // Try to seperate the mana cost in case it's a split card
     // if it's not a split card the loop will run only once
     for (QString fullManaCost : info->getManaCost().split("//")) {
         std::sort(fullManaCost.begin(), fullManaCost.end());
 
         // If the partial is found in the full, return true
-        if (fullManaCost.contains(partialCost)) {
+        if (fullManaCost.contains(preparedTerm)) {
             return true;
         }
     }
@@ -270,7 +365,7 @@ bool FilterItem::acceptCmc(const CardInfoPtr info) const
 
 bool FilterItem::acceptFormat(const CardInfoPtr info) const
 {
-    return info->getProperty(QString("format-%1").arg(term.toLower())) == "legal";
+    return info->getProperty(preparedTerm) == "legal";
 }
 
 bool FilterItem::acceptLoyalty(const CardInfoPtr info) const
@@ -284,7 +379,7 @@ bool FilterItem::acceptLoyalty(const CardInfoPtr info) const
         if (success) {
             return relationCheck(loyalty);
         } else {
-            return term.trimmed().toUpper() == info->getLoyalty();
+            return preparedTerm == info->getLoyalty();
         }
     }
 }
@@ -312,47 +407,9 @@ bool FilterItem::acceptPowerToughness(const CardInfoPtr info, CardFilter::Attr a
 
 bool FilterItem::acceptRarity(const CardInfoPtr info) const
 {
-    QString converted_term = term.trimmed();
-
-    /*
-     * The purpose of this loop is to only apply one of the replacement
-     * policies and then escape. If we attempt to layer them on top of
-     * each other, we will get awkward results (i.e. comythic rare mythic rareon)
-     * Conditional statement will exit once a case is successful in
-     * replacement OR we go through all possible cases.
-     * Will also need to replace just "mythic"
-     */
-    for (int i = 0; converted_term.length() <= 3 && i <= 6; i++) {
-        switch (i) {
-            case 0:
-                converted_term.replace("mr", "mythic", Qt::CaseInsensitive);
-                break;
-            case 1:
-                converted_term.replace("m r", "mythic", Qt::CaseInsensitive);
-                break;
-            case 2:
-                converted_term.replace("m", "mythic", Qt::CaseInsensitive);
-                break;
-            case 3:
-                converted_term.replace("c", "common", Qt::CaseInsensitive);
-                break;
-            case 4:
-                converted_term.replace("u", "uncommon", Qt::CaseInsensitive);
-                break;
-            case 5:
-                converted_term.replace("r", "rare", Qt::CaseInsensitive);
-                break;
-            case 6:
-                converted_term.replace("s", "special", Qt::CaseInsensitive);
-                break;
-            default:
-                break;
-        }
-    }
-
     for (const auto &printings : info->getSets()) {
         for (const auto &printing : printings) {
-            if (printing.getProperty("rarity").compare(converted_term, Qt::CaseInsensitive) == 0) {
+            if (printing.getProperty("rarity").compare(preparedTerm, Qt::CaseInsensitive) == 0) {
                 return true;
             }
         }
@@ -362,38 +419,20 @@ bool FilterItem::acceptRarity(const CardInfoPtr info) const
 
 bool FilterItem::relationCheck(int cardInfo) const
 {
-    bool result, conversion;
-
-    // if int conversion fails, there's probably an operator at the start
-    result = (cardInfo == term.toInt(&conversion));
-    if (!conversion) {
-        // leading whitespaces could cause indexing to fail
-        QString trimmedTerm = term.trimmed();
-        // check whether it's a 2 char operator (<=, >=, or ==)
-        if (trimmedTerm[1] == '=') {
-            int termInt = trimmedTerm.mid(2).toInt();
-            if (trimmedTerm.startsWith('<')) {
-                result = (cardInfo <= termInt);
-            } else if (trimmedTerm.startsWith('>')) {
-                result = (cardInfo >= termInt);
-            } else {
-                result = (cardInfo == termInt);
-            }
-        } else {
-            int termInt = trimmedTerm.mid(1).toInt();
-            if (trimmedTerm.startsWith('<')) {
-                result = (cardInfo < termInt);
-            } else if (trimmedTerm.startsWith('>')) {
-                result = (cardInfo > termInt);
-            } else if (trimmedTerm.startsWith("=")) {
-                result = (cardInfo == termInt);
-            } else {
-                // the int conversion hasn't failed due to an operator at the start
-                result = false;
-            }
-        }
+    switch (relation) {
+        case RelationLess:
+            return cardInfo < relationValue;
+        case RelationLessEqual:
+            return cardInfo <= relationValue;
+        case RelationEqual:
+            return cardInfo == relationValue;
+        case RelationGreaterEqual:
+            return cardInfo >= relationValue;
+        case RelationGreater:
+            return cardInfo > relationValue;
+        default:
+            return false;
     }
-    return result;
 }
 
 bool FilterItem::acceptCardAttr(const CardInfoPtr info, CardFilter::Attr attr) const
@@ -476,33 +515,81 @@ FilterTreeNode *FilterTree::termNode(const CardFilter *f)
     return termNode(f->attr(), f->type(), f->term());
 }
 
-bool FilterTree::testAttr(const CardInfoPtr info, const LogicMap *lm) const
+void FilterTree::compileProgram() const
+{
+    program.clear();
+    for (const LogicMap *lm : childNodes) {
+        if (!lm->isEnabled()) {
+            continue;
+        }
+
+        CompiledAttr compiled;
+        compiled.attr = lm->attr;
+        for (int type = 0; type < CardFilter::TypeEnd; ++type) {
+            const FilterItemList *fil = lm->findTypeList(static_cast<CardFilter::Type>(type));
+            compiled.hasType[type] = fil && fil->isEnabled();
+            if (!compiled.hasType[type]) {
+                continue;
+            }
+            for (int i = 0; i < fil->childCount(); ++i) {
+                const auto *item = static_cast<const FilterItem *>(fil->nodeAt(i));
+                if (item->isEnabled()) {
+                    compiled.items[type].append(item);
+                }
+            }
+        }
+        program.append(compiled);
+    }
+    programStale = false;
+}
+
+// whether any of the items accepts the card; true if there are none, like FilterItemList::testTypeOr()
+static bool anyAccepts(const QVector<const FilterItem *> &items, const CardInfoPtr &info, CardFilter::Attr attr)
+{
+    for (const FilterItem *item : items) {
+        if (item->acceptCardAttr(info, attr)) {
+            return true;
+        }
+    }
+    return items.isEmpty();
+}
+
+// whether all of the items accept the card, like FilterItemList::testTypeAnd()
+static bool allAccept(const QVector<const FilterItem *> &items, const CardInfoPtr &info, CardFilter::Attr attr)
+{
+    for (const FilterItem *item : items) {
+        if (!item->acceptCardAttr(info, attr)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FilterTree::testAttr(const CardInfoPtr &info, const CompiledAttr &compiled)
 {
-    const FilterItemList *fil;
+    const CardFilter::Attr attr = compiled.attr;
     bool status = true;
 
-    fil = lm->findTypeList(CardFilter::TypeAnd);
-    if (fil && fil->isEnabled() && !fil->testTypeAnd(info, lm->attr)) {
+    if (compiled.hasType[CardFilter::TypeAnd] && !allAccept(compiled.items[CardFilter::TypeAnd], info, attr)) {
         return false;
     }
 
-    fil = lm->findTypeList(CardFilter::TypeAndNot);
-    if (fil && fil->isEnabled() && !fil->testTypeAndNot(info, lm->attr)) {
+    // if any one in the list is true, return false
+    if (compiled.hasType[CardFilter::TypeAndNot] && anyAccepts(compiled.items[CardFilter::TypeAndNot], info, attr)) {
         return false;
     }
 
-    fil = lm->findTypeList(CardFilter::TypeOr);
-    if (fil && fil->isEnabled()) {
+    if (compiled.hasType[CardFilter::TypeOr]) {
         status = false;
 
         // if this is true we can return because it is OR'd with the OrNot list
-        if (fil->testTypeOr(info, lm->attr)) {
+        if (anyAccepts(compiled.items[CardFilter::TypeOr], info, attr)) {
             return true;
         }
     }
 
-    fil = lm->findTypeList(CardFilter::TypeOrNot);
-    if (fil && fil->isEnabled() && fil->testTypeOrNot(info, lm->attr)) {
+    // if any one in the list is false, return true
+    if (compiled.hasType[CardFilter::TypeOrNot] && !allAccept(compiled.items[CardFilter::TypeOrNot], info, attr)) {
         return true;
     }
 
@@ -511,8 +598,12 @@ bool FilterTree::testAttr(const CardInfoPtr info, const LogicMap *lm) const
 
 bool FilterTree::acceptsCard(const CardInfoPtr info) const
 {
-    for (auto i = childNodes.constBegin(); i != childNodes.constEnd(); i++) {
-        if ((*i)->isEnabled() && !testAttr(info, *i)) {
+    if (programStale) {
+        compileProgram();
+    }
+
+    for (const CompiledAttr &compiled : program) {
+        if (!testAttr(info, compiled)) {
             return false;
         }
     }
@@ -561,5 +652,21 @@ void FilterTree::clear()
     while (childCount() > 0) {
         deleteAt(0);
     }
-    emit changed();
+    nodeChanged();
+}
+
+void FilterTree::beginBatch()
+{
+    ++batchDepth;
+}
+
+void FilterTree::endBatch()
+{
+    if (batchDepth == 0 || --batchDepth > 0) {
+        return;
+    }
+    if (changedInBatch) {
+        changedInBatch = false;
+        emit changed();
+    }
 }
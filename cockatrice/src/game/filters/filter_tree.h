@@ -7,6 +7,7 @@
 #include <QList>
 #include <QMap>
 #include <QObject>
+#include <QVector>
 #include <utility>
 
 class FilterTreeNode
@@ -166,14 +167,29 @@ public:
 class FilterItem : public FilterTreeNode
 {
 private:
+    // how a numeric term compares the card's value
+    enum Relation
+    {
+        RelationNone,
+        RelationLess,
+        RelationLessEqual,
+        RelationEqual,
+        RelationGreaterEqual,
+        RelationGreater
+    };
+
     FilterItemList *const p;
+    // the term is parsed once for its attribute, instead of for every card it is tested against
+    QString preparedTerm;
+    Relation relation;
+    int relationValue;
+
+    void prepareTerm();
 
 public:
     const QString term;
 
-    FilterItem(QString trm, FilterItemList *parent) : p(parent), term(std::move(trm))
-    {
-    }
+    FilterItem(QString trm, FilterItemList *parent);
     virtual ~FilterItem() = default;
 
     CardFilter::Attr attr() const
@@ -226,14 +242,37 @@ signals:
     void changed() const;
 
 private:
+    // the enabled filters of one attribute, see testAttr()
+    struct CompiledAttr
+    {
+        CardFilter::Attr attr;
+        // whether the list of each type exists and is enabled, and its enabled items
+        bool hasType[CardFilter::TypeEnd];
+        QVector<const FilterItem *> items[CardFilter::TypeEnd];
+    };
+
+    // the enabled part of the tree flattened, rebuilt on the first card tested after a change
+    mutable QVector<CompiledAttr> program;
+    mutable bool programStale = true;
+
+    // while a batch is open, changed() is held back and sent once when the outermost batch ends
+    int batchDepth = 0;
+    mutable bool changedInBatch = false;
+
     LogicMap *attrLogicMap(CardFilter::Attr attr);
     FilterItemList *attrTypeList(CardFilter::Attr attr, CardFilter::Type type);
 
-    bool testAttr(CardInfoPtr info, const LogicMap *lm) const;
+    void compileProgram() const;
+    static bool testAttr(const CardInfoPtr &info, const CompiledAttr &compiled);
 
     void nodeChanged() const override
     {
-        emit changed();
+        programStale = true;
+        if (batchDepth > 0) {
+            changedInBatch = true;
+        } else {
+            emit changed();
+        }
     }
     void preInsertChild(const FilterTreeNode *p, int i) const override
     {
@@ -272,6 +311,13 @@ public:
     void removeFiltersByAttr(CardFilter::Attr filterType);
     void removeFilter(const CardFilter *toRemove);
     void clear();
+
+    /**
+     * Groups the changes made until the matching endBatch() so that changed(), and with it the filtering of the
+     * cards, happens only once. The row signals are still sent for every change. Batches may nest.
+     */
+    void beginBatch();
+    void endBatch();
 };
 
 #endif
@@ -73,26 +73,26 @@ FilterTreeNode *FilterTreeModel::indexToNode(const QModelIndex &idx) const
 
 void FilterTreeModel::addFilter(const CardFilter *f)
 {
-    emit layoutAboutToBeChanged();
+    beginBatch();
     fTree->termNode(f);
-    emit layoutChanged();
+    endBatch();
 }
 
 void FilterTreeModel::removeFilter(const CardFilter *f)
 {
-    emit layoutAboutToBeChanged();
+    beginBatch();
     fTree->removeFilter(f);
-    emit layoutChanged();
+    endBatch();
 }
 
 void FilterTreeModel::clearFiltersOfType(CardFilter::Attr filterType)
 {
-    emit layoutAboutToBeChanged();
+    beginBatch();
 
     // Recursively remove all nodes with the given filter type
     fTree->removeFiltersByAttr(filterType);
 
-    emit layoutChanged();
+    endBatch();
 }
 
 QList<const CardFilter *> FilterTreeModel::getFiltersOfType(CardFilter::Attr filterType) const
@@ -323,7 +323,26 @@ bool FilterTreeModel::removeRows(int row, int count, const QModelIndex &parent)
 
 void FilterTreeModel::clear()
 {
-    emit layoutAboutToBeChanged();
+    beginBatch();
     fTree->clear();
-    emit layoutChanged();
+    endBatch();
+}
+
+void FilterTreeModel::beginBatch()
+{
+    if (batchDepth++ == 0) {
+        emit layoutAboutToBeChanged();
+    }
+    fTree->beginBatch();
+}
+
+void FilterTreeModel::endBatch()
+{
+    if (batchDepth == 0) {
+        return;
+    }
+    fTree->endBatch();
+    if (--batchDepth == 0) {
+        emit layoutChanged();
+    }
 }
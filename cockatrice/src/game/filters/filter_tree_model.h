@@ -14,6 +14,7 @@ class FilterTreeModel : public QAbstractItemModel
     Q_OBJECT
 private:
     FilterTree *fTree;
+    int batchDepth = 0;
 
 public slots:
     void addFilter(const CardFilter *f);
@@ -48,6 +49,10 @@ public:
     QModelIndex index(int row, int column, const QModelIndex &parent) const override;
     bool removeRows(int row, int count, const QModelIndex &parent) override;
     void clear();
+
+    // groups the filter changes until the matching endBatch() into a single layout change and a single filtering
+    void beginBatch();
+    void endBatch();
 };
 
 #endif
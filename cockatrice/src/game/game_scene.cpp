@@ -3,6 +3,7 @@
 #include "../client/ui/phases_toolbar.h"
 #include "../settings/cache_settings.h"
 #include "board/card_item.h"
+#include "board/card_item_pool.h"
 #include "player/player.h"
 #include "zones/view_zone.h"
 #include "zones/view_zone_widget.h"
@@ -16,9 +17,10 @@
 #include <QtMath>
 
 GameScene::GameScene(PhasesToolbar *_phasesToolbar, QObject *parent)
-    : QGraphicsScene(parent), phasesToolbar(_phasesToolbar), viewSize(QSize()), playerRotation(0)
+    : QGraphicsScene(parent), phasesToolbar(_phasesToolbar), viewSize(QSize()), suspended(false), playerRotation(0)
 {
     animationTimer = new QBasicTimer;
+    cardPool = new CardItemPool(this);
     addItem(phasesToolbar);
     connect(&SettingsCache::instance(), &SettingsCache::minPlayersForMultiColumnLayoutChanged, this,
             &GameScene::rearrange);
@@ -313,7 +315,7 @@ void GameScene::timerEvent(QTimerEvent * /*event*/)
 void GameScene::registerAnimationItem(AbstractCardItem *card)
 {
     cardsToAnimate.insert(static_cast<CardItem *>(card));
-    if (!animationTimer->isActive())
+    if (!suspended && !animationTimer->isActive())
         animationTimer->start(10, this);
 }
 
@@ -324,6 +326,21 @@ void GameScene::unregisterAnimationItem(AbstractCardItem *card)
         animationTimer->stop();
 }
 
+void GameScene::setSuspended(bool _suspended)
+{
+    suspended = _suspended;
+    if (suspended) {
+        animationTimer->stop();
+        return;
+    }
+
+    for (CardItem *card : cardsToAnimate) {
+        while (card->animationEvent()) {
+        }
+    }
+    cardsToAnimate.clear();
+}
+
 void GameScene::startRubberBand(const QPointF &selectionOrigin)
 {
     emit sigStartRubberBand(selectionOrigin);
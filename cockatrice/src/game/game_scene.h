@@ -15,6 +15,7 @@ class ZoneViewWidget;
 class CardZone;
 class AbstractCardItem;
 class CardItem;
+class CardItemPool;
 class ServerInfo_Card;
 class PhasesToolbar;
 class QBasicTimer;
@@ -33,6 +34,8 @@ private:
     QPointer<CardItem> hoveredCard;
     QBasicTimer *animationTimer;
     QSet<CardItem *> cardsToAnimate;
+    CardItemPool *cardPool;
+    bool suspended;
     int playerRotation;
     void updateHover(const QPointF &scenePos);
 
@@ -48,8 +51,19 @@ public:
     void resizeRubberBand(const QPointF &cursorPoint);
     void stopRubberBand();
 
+    CardItemPool *getCardPool() const
+    {
+        return cardPool;
+    }
+
     void registerAnimationItem(AbstractCardItem *item);
     void unregisterAnimationItem(AbstractCardItem *card);
+
+    /**
+     * No animations run while the scene is suspended. Animations that were started while suspended jump to their end
+     * when it resumes, so the scene shows the current state of the game right away.
+     */
+    void setSuspended(bool _suspended);
 public slots:
     void toggleZoneView(Player *player, const QString &zoneName, int numberCards, bool isReversed = false);
     void addRevealedZoneView(Player *player,
@@ -12,6 +12,7 @@
 #include "../server/user/user_list_manager.h"
 #include "games_model.h"
 #include "pb/response.pb.h"
+#include "pb/response_filtered_games.pb.h"
 #include "pb/room_commands.pb.h"
 #include "pb/serverinfo_game.pb.h"
 
@@ -35,7 +36,8 @@ GameSelector::GameSelector(AbstractClient *_client,
                            const bool restoresettings,
                            const bool _showfilters,
                            QWidget *parent)
-    : QGroupBox(parent), client(_client), tabSupervisor(_tabSupervisor), room(_room), showFilters(_showfilters)
+    : QGroupBox(parent), client(_client), tabSupervisor(_tabSupervisor), room(_room), showFilters(_showfilters),
+      serverFilterSet(false)
 {
     gameListView = new QTreeView;
     gameListView->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -71,8 +73,10 @@ GameSelector::GameSelector(AbstractClient *_client,
     if (room)
         gameTypeMap = gameListModel->getGameTypes().value(room->getRoomId());
 
-    if (showFilters && restoresettings)
+    if (showFilters && restoresettings) {
         gameListProxyModel->loadFilterParameters(gameTypeMap);
+        sendGameFilter();
+    }
 
     gameListView->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
 
@@ -171,6 +175,7 @@ void GameSelector::actSetFilter()
     gameListProxyModel->setShowOnlyIfSpectatorsCanChat(dlg.getShowOnlyIfSpectatorsCanChat());
     gameListProxyModel->setShowOnlyIfSpectatorsCanSeeHands(dlg.getShowOnlyIfSpectatorsCanSeeHands());
     gameListProxyModel->saveFilterParameters(gameTypeMap);
+    sendGameFilter();
 
     clearFilterButton->setEnabled(!gameListProxyModel->areFilterParametersSetToDefaults());
 
@@ -183,10 +188,49 @@ void GameSelector::actClearFilter()
 
     gameListProxyModel->resetFilterParameters();
     gameListProxyModel->saveFilterParameters(gameTypeMap);
+    sendGameFilter();
 
     updateTitle();
 }
 
+void GameSelector::sendGameFilter()
+{
+    if (room == nullptr || !showFilters)
+        return;
+
+    const bool filtersSetToDefault = gameListProxyModel->areFilterParametersSetToDefaults();
+    if (filtersSetToDefault && !serverFilterSet)
+        return;
+
+    // Rooms can hold hundreds of games, so the server only sends those passing the filters, and only the newest
+    // ones at first. Without filters it sends all of them again.
+    static const int filteredGamesPageSize = 200;
+    Command_SetGameFilter cmd;
+    if (!filtersSetToDefault) {
+        cmd.mutable_filter()->CopyFrom(gameListProxyModel->getServerFilter());
+        cmd.set_max_games(filteredGamesPageSize);
+    }
+    serverFilterSet = !filtersSetToDefault;
+
+    PendingCommand *pend = room->prepareRoomCommand(cmd);
+    connect(pend, &PendingCommand::finished, this, &GameSelector::gameFilterFinished);
+    room->sendRoomCommand(pend);
+}
+
+void GameSelector::gameFilterFinished(const Response &response)
+{
+    // servers that can't filter games keep sending all of them, they are then only filtered here
+    if (response.response_code() != Response::RespOk)
+        return;
+
+    const Response_FilteredGames &resp = response.GetExtension(Response_FilteredGames::ext);
+    QList<ServerInfo_Game> games;
+    for (const ServerInfo_Game &game : resp.game_list())
+        games.append(game);
+    gameListModel->setGameList(games);
+    updateTitle();
+}
+
 void GameSelector::actCreate()
 {
     if (room == nullptr) {
@@ -375,6 +419,19 @@ void GameSelector::processGameInfo(const ServerInfo_Game &info)
     updateTitle();
 }
 
+void GameSelector::setGameList(const QList<ServerInfo_Game> &games)
+{
+    QList<ServerInfo_Game> openGames;
+    for (const ServerInfo_Game &game : games)
+        if (!game.closed())
+            openGames.append(game);
+    gameListModel->setGameList(openGames);
+    updateTitle();
+
+    serverFilterSet = false;
+    sendGameFilter();
+}
+
 void GameSelector::actSelectedGameChanged(const QModelIndex &current, const QModelIndex & /* previous */)
 {
     enableButtonsForIndex(current);
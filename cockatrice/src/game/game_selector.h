@@ -34,6 +34,7 @@ private slots:
 
     void actSelectedGameChanged(const QModelIndex &current, const QModelIndex &previous);
     void checkResponse(const Response &response);
+    void gameFilterFinished(const Response &response);
 
     void ignoreListReceived(const QList<ServerInfo_User> &_ignoreList);
     void processAddToListEvent(const Event_AddToList &event);
@@ -52,12 +53,15 @@ private:
     QPushButton *filterButton, *clearFilterButton, *createButton, *joinButton, *spectateButton;
     const bool showFilters;
     GameTypeMap gameTypeMap;
+    // whether the server was asked to filter the games of the room
+    bool serverFilterSet;
 
     void updateTitle();
     void disableButtons();
     void enableButtons();
     void enableButtonsForIndex(const QModelIndex &current);
     void joinGame(const bool isSpectator);
+    void sendGameFilter();
 
 public:
     GameSelector(AbstractClient *_client,
@@ -70,6 +74,8 @@ public:
                  QWidget *parent = nullptr);
     void retranslateUi();
     void processGameInfo(const ServerInfo_Game &info);
+    // replaces all games of the room, the server forgot the filter then so it is sent again
+    void setGameList(const QList<ServerInfo_Game> &games);
 };
 
 #endif
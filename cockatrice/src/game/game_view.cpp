@@ -4,15 +4,33 @@
 #include "game_scene.h"
 
 #include <QAction>
+#include <QLabel>
 #include <QResizeEvent>
 #include <QRubberBand>
+#include <QTimer>
 
-GameView::GameView(GameScene *scene, QWidget *parent) : QGraphicsView(scene, parent), rubberBand(0)
+#if defined(HAVE_QOPENGLWIDGET) && !defined(QT_NO_OPENGL)
+#include <QOpenGLWidget>
+#include <QSurfaceFormat>
+#endif
+
+GameView::GameView(GameScene *scene, QWidget *parent)
+    : QGraphicsView(scene, parent), rubberBand(0), fullViewportUpdates(false), suspended(false),
+      frameStatistics(nullptr), framesInInterval(0), dirtyRectsInInterval(0)
 {
     setBackgroundBrush(QBrush(QColor(0, 0, 0)));
     setRenderHints(QPainter::TextAntialiasing | QPainter::Antialiasing);
     setFocusPolicy(Qt::ClickFocus);
-    setViewportUpdateMode(BoundingRectViewportUpdate);
+
+    // the changes of the scene are painted by paintFrame()
+    setViewportUpdateMode(NoViewportUpdate);
+    frameTimer = new QTimer(this);
+    frameTimer->setSingleShot(true);
+    connect(frameTimer, &QTimer::timeout, this, &GameView::paintFrame);
+    connect(scene, &QGraphicsScene::changed, this, &GameView::sceneChanged);
+
+    setOpenGLViewport(SettingsCache::instance().getOpenGLGameView());
+    connect(&SettingsCache::instance(), &SettingsCache::openGLGameViewChanged, this, &GameView::setOpenGLViewport);
 
     connect(scene, &GameScene::sceneRectChanged, this, &GameView::updateSceneRect);
 
@@ -28,6 +46,36 @@ GameView::GameView(GameScene *scene, QWidget *parent) : QGraphicsView(scene, par
             &GameView::refreshShortcuts);
     refreshShortcuts();
     rubberBand = new QRubberBand(QRubberBand::Rectangle, this);
+
+    if (GameViewFramesLog().isDebugEnabled()) {
+        frameStatistics = new QLabel(this);
+        frameStatistics->setStyleSheet("QLabel { background-color: rgba(0, 0, 0, 160); color: white; padding: 2px; }");
+        frameStatistics->move(4, 4);
+        statisticsInterval.start();
+        auto *statisticsTimer = new QTimer(this);
+        connect(statisticsTimer, &QTimer::timeout, this, &GameView::updateFrameStatistics);
+        statisticsTimer->start(1000);
+        updateFrameStatistics();
+    }
+}
+
+void GameView::setSuspended(bool _suspended)
+{
+    if (suspended == _suspended) {
+        return;
+    }
+    suspended = _suspended;
+
+    // the scene only tracks its dirty regions while something is connected to changed()
+    if (suspended) {
+        disconnect(scene(), &QGraphicsScene::changed, this, &GameView::sceneChanged);
+        frameTimer->stop();
+        dirtyRect = QRect();
+    } else {
+        connect(scene(), &QGraphicsScene::changed, this, &GameView::sceneChanged);
+        viewport()->update();
+        lastFrame.start();
+    }
 }
 
 void GameView::resizeEvent(QResizeEvent *event)
@@ -41,9 +89,69 @@ void GameView::resizeEvent(QResizeEvent *event)
     updateSceneRect(scene()->sceneRect());
 }
 
+void GameView::paintEvent(QPaintEvent *event)
+{
+    QGraphicsView::paintEvent(event);
+    ++framesInInterval;
+}
+
+void GameView::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+    scheduleUpdate(viewport()->rect());
+}
+
 void GameView::updateSceneRect(const QRectF &rect)
 {
     fitInView(rect, Qt::KeepAspectRatio);
+    scheduleUpdate(viewport()->rect());
+}
+
+void GameView::sceneChanged(const QList<QRectF> &region)
+{
+    dirtyRectsInInterval += region.size();
+    for (const QRectF &rect : region) {
+        // the same margin QGraphicsView leaves around the changes for antialiasing
+        scheduleUpdate(mapFromScene(rect).boundingRect().adjusted(-2, -2, 2, 2));
+    }
+}
+
+void GameView::scheduleUpdate(const QRect &rect)
+{
+    if (suspended) {
+        return;
+    }
+    dirtyRect |= rect;
+    if (frameTimer->isActive()) {
+        return;
+    }
+    const qint64 sinceLastFrame = lastFrame.isValid() ? lastFrame.elapsed() : FRAME_INTERVAL_MS;
+    frameTimer->start(static_cast<int>(qMax<qint64>(0, FRAME_INTERVAL_MS - sinceLastFrame)));
+}
+
+void GameView::paintFrame()
+{
+    if (fullViewportUpdates) {
+        viewport()->update();
+    } else {
+        viewport()->update(dirtyRect);
+    }
+    dirtyRect = QRect();
+    lastFrame.start();
+}
+
+void GameView::updateFrameStatistics()
+{
+    const qreal seconds = qMax<qint64>(statisticsInterval.restart(), 1) / 1000.0;
+    const QString statistics = QString("%1 fps, %2 dirty rects/s")
+                                   .arg(framesInInterval / seconds, 0, 'f', 1)
+                                   .arg(dirtyRectsInInterval / seconds, 0, 'f', 1);
+    frameStatistics->setText(statistics);
+    frameStatistics->adjustSize();
+    frameStatistics->raise();
+    qCDebug(GameViewFramesLog) << statistics;
+    framesInInterval = 0;
+    dirtyRectsInInterval = 0;
 }
 
 void GameView::startRubberBand(const QPointF &_selectionOrigin)
@@ -64,6 +172,31 @@ void GameView::stopRubberBand()
     rubberBand->hide();
 }
 
+/**
+ * Draws the scene through a QOpenGLWidget when enabled. The GL paint engine uploads every pixmap it draws as a
+ * texture and keeps it for as long as the pixmap lives, so the cached card pictures are uploaded once and each frame
+ * is only textured quads. A GL viewport is cheaper to redraw whole than to clip, so its frames repaint all of it.
+ */
+void GameView::setOpenGLViewport(bool enabled)
+{
+#if defined(HAVE_QOPENGLWIDGET) && !defined(QT_NO_OPENGL)
+    if (enabled != static_cast<bool>(qobject_cast<QOpenGLWidget *>(viewport()))) {
+        if (enabled) {
+            auto *glViewport = new QOpenGLWidget;
+            QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+            format.setSamples(4);
+            glViewport->setFormat(format);
+            setViewport(glViewport);
+        } else {
+            setViewport(new QWidget);
+        }
+    }
+#else
+    enabled = false;
+#endif
+    fullViewportUpdates = enabled;
+}
+
 void GameView::refreshShortcuts()
 {
     aCloseMostRecentZoneView->setShortcuts(
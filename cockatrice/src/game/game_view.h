@@ -1,31 +1,74 @@
 #ifndef GAMEVIEW_H
 #define GAMEVIEW_H
 
+#include <QElapsedTimer>
 #include <QGraphicsView>
+#include <QLoggingCategory>
+
+inline Q_LOGGING_CATEGORY(GameViewFramesLog, "game_view.frames");
 
 class GameScene;
+class QLabel;
 class QRubberBand;
+class QTimer;
 
+/**
+ * Shows the game scene. The view does not repaint on its own whenever the scene changes: the changes are collected
+ * and painted at most once per display frame, so that many small changes, like pings and counters in a large game,
+ * don't each cost a repaint.
+ *
+ * Enabling the game_view.frames logging category shows the frames per second and dirty rects in the corner.
+ */
 class GameView : public QGraphicsView
 {
     Q_OBJECT
 private:
+    static constexpr int FRAME_INTERVAL_MS = 16;
+
     QAction *aCloseMostRecentZoneView;
     QRubberBand *rubberBand;
     QPointF selectionOrigin;
 
+    QTimer *frameTimer;
+    QElapsedTimer lastFrame;
+    QRect dirtyRect;
+    bool fullViewportUpdates;
+    bool suspended;
+
+    QLabel *frameStatistics;
+    QElapsedTimer statisticsInterval;
+    int framesInInterval, dirtyRectsInInterval;
+
+    void scheduleUpdate(const QRect &rect);
+
 protected:
     void resizeEvent(QResizeEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
 private slots:
     void startRubberBand(const QPointF &selectionOrigin);
     void resizeRubberBand(const QPointF &cursorPoint);
     void stopRubberBand();
     void refreshShortcuts();
+    void setOpenGLViewport(bool enabled);
+    void sceneChanged(const QList<QRectF> &region);
+    void paintFrame();
+    void updateFrameStatistics();
 public slots:
     void updateSceneRect(const QRectF &rect);
 
 public:
     explicit GameView(GameScene *scene, QWidget *parent = nullptr);
+
+    /**
+     * Stops following the changes of the scene while the view can't be seen, so the scene doesn't collect them
+     * either. Resuming repaints the whole view.
+     */
+    void setSuspended(bool _suspended);
+    bool getSuspended() const
+    {
+        return suspended;
+    }
 };
 
 #endif
@@ -250,7 +250,7 @@ QVariant GamesModel::headerData(int section, Qt::Orientation /*orientation*/, in
     }
 }
 
-const ServerInfo_Game &GamesModel::getGame(int row)
+const ServerInfo_Game &GamesModel::getGame(int row) const
 {
     Q_ASSERT(row < gameList.size());
     return gameList[row];
@@ -258,22 +258,42 @@ const ServerInfo_Game &GamesModel::getGame(int row)
 
 void GamesModel::updateGameList(const ServerInfo_Game &game)
 {
-    for (int i = 0; i < gameList.size(); i++) {
-        if (gameList[i].game_id() == game.game_id()) {
-            if (game.closed()) {
-                beginRemoveRows(QModelIndex(), i, i);
-                gameList.removeAt(i);
-                endRemoveRows();
-            } else {
-                gameList[i].MergeFrom(game);
-                emit dataChanged(index(i, 0), index(i, NUM_COLS - 1));
-            }
-            return;
+    auto row = gameRows.constFind(game.game_id());
+    if (row == gameRows.constEnd()) {
+        beginInsertRows(QModelIndex(), gameList.size(), gameList.size());
+        gameRows.insert(game.game_id(), gameList.size());
+        gameList.append(game);
+        endInsertRows();
+        return;
+    }
+
+    const int i = *row;
+    if (game.closed()) {
+        beginRemoveRows(QModelIndex(), i, i);
+        gameRows.erase(row);
+        gameList.removeAt(i);
+        for (int j = i; j < gameList.size(); ++j) {
+            gameRows[gameList[j].game_id()] = j;
+        }
+        endRemoveRows();
+    } else {
+        const std::string oldGame = gameList[i].SerializeAsString();
+        gameList[i].MergeFrom(game);
+        if (gameList[i].SerializeAsString() != oldGame) {
+            emit dataChanged(index(i, 0), index(i, NUM_COLS - 1));
         }
     }
-    beginInsertRows(QModelIndex(), gameList.size(), gameList.size());
-    gameList.append(game);
-    endInsertRows();
+}
+
+void GamesModel::setGameList(const QList<ServerInfo_Game> &games)
+{
+    beginResetModel();
+    gameList = games;
+    gameRows.clear();
+    for (int i = 0; i < gameList.size(); ++i) {
+        gameRows.insert(gameList[i].game_id(), i);
+    }
+    endResetModel();
 }
 
 GamesProxyModel::GamesProxyModel(QObject *parent, const UserListProxy *_userListProxy)
@@ -287,107 +307,100 @@ GamesProxyModel::GamesProxyModel(QObject *parent, const UserListProxy *_userList
 void GamesProxyModel::setHideBuddiesOnlyGames(bool _showBuddiesOnlyGames)
 {
     hideBuddiesOnlyGames = _showBuddiesOnlyGames;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setHideIgnoredUserGames(bool _hideIgnoredUserGames)
 {
     hideIgnoredUserGames = _hideIgnoredUserGames;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setHideFullGames(bool _showFullGames)
 {
     hideFullGames = _showFullGames;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setHideGamesThatStarted(bool _showGamesThatStarted)
 {
     hideGamesThatStarted = _showGamesThatStarted;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setHidePasswordProtectedGames(bool _showPasswordProtectedGames)
 {
     hidePasswordProtectedGames = _showPasswordProtectedGames;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setHideNotBuddyCreatedGames(bool value)
 {
     hideNotBuddyCreatedGames = value;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setGameNameFilter(const QString &_gameNameFilter)
 {
     gameNameFilter = _gameNameFilter;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setCreatorNameFilter(const QString &_creatorNameFilter)
 {
     creatorNameFilter = _creatorNameFilter;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setGameTypeFilter(const QSet<int> &_gameTypeFilter)
 {
     gameTypeFilter = _gameTypeFilter;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setMaxPlayersFilter(int _maxPlayersFilterMin, int _maxPlayersFilterMax)
 {
     maxPlayersFilterMin = _maxPlayersFilterMin;
     maxPlayersFilterMax = _maxPlayersFilterMax;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setMaxGameAge(const QTime &_maxGameAge)
 {
     maxGameAge = _maxGameAge;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setShowOnlyIfSpectatorsCanWatch(bool _showOnlyIfSpectatorsCanWatch)
 {
     showOnlyIfSpectatorsCanWatch = _showOnlyIfSpectatorsCanWatch;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setShowSpectatorPasswordProtected(bool _showSpectatorPasswordProtected)
 {
     showSpectatorPasswordProtected = _showSpectatorPasswordProtected;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setShowOnlyIfSpectatorsCanChat(bool _showOnlyIfSpectatorsCanChat)
 {
     showOnlyIfSpectatorsCanChat = _showOnlyIfSpectatorsCanChat;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::setShowOnlyIfSpectatorsCanSeeHands(bool _showOnlyIfSpectatorsCanSeeHands)
 {
     showOnlyIfSpectatorsCanSeeHands = _showOnlyIfSpectatorsCanSeeHands;
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 int GamesProxyModel::getNumFilteredGames() const
 {
-    GamesModel *model = qobject_cast<GamesModel *>(sourceModel());
-    if (!model)
+    if (!sourceModel())
         return 0;
 
-    int numFilteredGames = 0;
-    for (int row = 0; row < model->rowCount(); ++row) {
-        if (!filterAcceptsRow(row)) {
-            ++numFilteredGames;
-        }
-    }
-    return numFilteredGames;
+    return sourceModel()->rowCount() - rowCount();
 }
 
 void GamesProxyModel::resetFilterParameters()
@@ -409,7 +422,7 @@ void GamesProxyModel::resetFilterParameters()
     showOnlyIfSpectatorsCanChat = false;
     showOnlyIfSpectatorsCanSeeHands = false;
 
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 bool GamesProxyModel::areFilterParametersSetToDefaults() const
@@ -449,7 +462,7 @@ void GamesProxyModel::loadFilterParameters(const QMap<int, QString> &allGameType
         }
     }
 
-    invalidateFilter();
+    invalidateFilterVerdicts();
 }
 
 void GamesProxyModel::saveFilterParameters(const QMap<int, QString> &allGameTypes)
@@ -481,12 +494,51 @@ void GamesProxyModel::saveFilterParameters(const QMap<int, QString> &allGameType
     gameFilters.setShowOnlyIfSpectatorsCanSeeHands(showOnlyIfSpectatorsCanSeeHands);
 }
 
+ServerInfo_GameFilter GamesProxyModel::getServerFilter() const
+{
+    ServerInfo_GameFilter filter;
+    filter.set_hide_buddies_only_games(hideBuddiesOnlyGames);
+    filter.set_hide_full_games(hideFullGames);
+    filter.set_hide_games_that_started(hideGamesThatStarted);
+    filter.set_hide_password_protected_games(hidePasswordProtectedGames);
+    filter.set_game_name_filter(gameNameFilter.toStdString());
+    filter.set_creator_name_filter(creatorNameFilter.toStdString());
+    for (int gameType : gameTypeFilter)
+        filter.add_game_type_ids(gameType);
+    filter.set_max_players_min(maxPlayersFilterMin);
+    filter.set_max_players_max(maxPlayersFilterMax);
+    if (maxGameAge.isValid())
+        filter.set_max_game_age(QTime(0, 0).secsTo(maxGameAge));
+    filter.set_show_only_if_spectators_can_watch(showOnlyIfSpectatorsCanWatch);
+    filter.set_show_spectator_password_protected(showSpectatorPasswordProtected);
+    filter.set_show_only_if_spectators_can_chat(showOnlyIfSpectatorsCanChat);
+    filter.set_show_only_if_spectators_can_see_hands(showOnlyIfSpectatorsCanSeeHands);
+    return filter;
+}
+
 bool GamesProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex & /*sourceParent*/) const
 {
     return filterAcceptsRow(sourceRow);
 }
 
 bool GamesProxyModel::filterAcceptsRow(int sourceRow) const
+{
+    auto *model = qobject_cast<GamesModel *>(sourceModel());
+    if (!model)
+        return false;
+
+    const int gameId = model->getGame(sourceRow).game_id();
+    auto verdict = filterVerdicts.constFind(gameId);
+    if (verdict != filterVerdicts.constEnd()) {
+        return *verdict;
+    }
+
+    const bool accepted = filterAcceptsGame(model->getGame(sourceRow));
+    filterVerdicts.insert(gameId, accepted);
+    return accepted;
+}
+
+bool GamesProxyModel::filterAcceptsGame(const ServerInfo_Game &game) const
 {
 #if QT_VERSION >= QT_VERSION_CHECK(6, 7, 0)
     static const QDate epochDate = QDateTime::fromSecsSinceEpoch(0, QTimeZone::UTC).date();
@@ -495,12 +547,6 @@ bool GamesProxyModel::filterAcceptsRow(int sourceRow) const
 #else
     static const QDate epochDate = QDateTime::fromTime_t(0, Qt::UTC).date();
 #endif
-    auto *model = qobject_cast<GamesModel *>(sourceModel());
-    if (!model)
-        return false;
-
-    const ServerInfo_Game &game = model->getGame(sourceRow);
-
     if (hideBuddiesOnlyGames && game.only_buddies()) {
         return false;
     }
@@ -563,5 +609,43 @@ bool GamesProxyModel::filterAcceptsRow(int sourceRow) const
 
 void GamesProxyModel::refresh()
 {
+    invalidateFilterVerdicts();
+}
+
+void GamesProxyModel::setSourceModel(QAbstractItemModel *_sourceModel)
+{
+    if (sourceModel()) {
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    }
+    filterVerdicts.clear();
+
+    // connected before the base class connects, so the verdicts of the changed games are forgotten before the
+    // changed rows are filtered again
+    if (_sourceModel) {
+        connect(_sourceModel, &QAbstractItemModel::dataChanged, this,
+                [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+                    forgetFilterVerdicts(topLeft.row(), bottomRight.row());
+                });
+        connect(_sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+                [this](const QModelIndex &, int first, int last) { forgetFilterVerdicts(first, last); });
+        connect(_sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, [this]() { filterVerdicts.clear(); });
+    }
+    QSortFilterProxyModel::setSourceModel(_sourceModel);
+}
+
+void GamesProxyModel::invalidateFilterVerdicts()
+{
+    filterVerdicts.clear();
     invalidateFilter();
 }
+
+void GamesProxyModel::forgetFilterVerdicts(int first, int last)
+{
+    auto *model = qobject_cast<GamesModel *>(sourceModel());
+    if (!model)
+        return;
+
+    for (int row = first; row <= last; ++row) {
+        filterVerdicts.remove(model->getGame(row).game_id());
+    }
+}
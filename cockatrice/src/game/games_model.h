@@ -3,8 +3,10 @@
 
 #include "game_type_map.h"
 #include "pb/serverinfo_game.pb.h"
+#include "pb/serverinfo_game_filter.pb.h"
 
 #include <QAbstractTableModel>
+#include <QHash>
 #include <QList>
 #include <QSet>
 #include <QSortFilterProxyModel>
@@ -18,6 +20,8 @@ class GamesModel : public QAbstractTableModel
     Q_OBJECT
 private:
     QList<ServerInfo_Game> gameList;
+    // the row of every game in gameList, by game id
+    QHash<int, int> gameRows;
     QMap<int, QString> rooms;
     QMap<int, GameTypeMap> gameTypes;
 
@@ -38,12 +42,16 @@ public:
     QVariant data(const QModelIndex &index, int role) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     static const QString getGameCreatedString(const int secs);
-    const ServerInfo_Game &getGame(int row);
+    const ServerInfo_Game &getGame(int row) const;
 
     /**
-     * Update game list with a (possibly new) game.
+     * Update game list with a (possibly new) game. Only emits dataChanged() if the game info actually changed.
      */
     void updateGameList(const ServerInfo_Game &game);
+    /**
+     * Replace the game list, e.g. with the games the server filtered.
+     */
+    void setGameList(const QList<ServerInfo_Game> &games);
 
     int roomColIndex()
     {
@@ -88,6 +96,12 @@ private:
     bool showOnlyIfSpectatorsCanWatch, showSpectatorPasswordProtected, showOnlyIfSpectatorsCanChat,
         showOnlyIfSpectatorsCanSeeHands;
 
+    // whether filterAcceptsRow() accepted each game, by game id, until the game or the filter changes
+    mutable QHash<int, bool> filterVerdicts;
+
+    void invalidateFilterVerdicts();
+    void forgetFilterVerdicts(int first, int last);
+
 public:
     explicit GamesProxyModel(QObject *parent = nullptr, const UserListProxy *_userListProxy = nullptr);
 
@@ -176,11 +190,18 @@ public:
     bool areFilterParametersSetToDefaults() const;
     void loadFilterParameters(const QMap<int, QString> &allGameTypes);
     void saveFilterParameters(const QMap<int, QString> &allGameTypes);
+    /**
+     * The filter parameters the server can apply for us, see Command_SetGameFilter. The filters depending on the
+     * buddy and ignore lists are only applied here.
+     */
+    ServerInfo_GameFilter getServerFilter() const;
     void refresh();
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
 
 protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
     bool filterAcceptsRow(int sourceRow) const;
+    bool filterAcceptsGame(const ServerInfo_Game &game) const;
 };
 
 #endif
@@ -7,10 +7,12 @@
 #include "../../dialogs/dlg_move_top_cards_until.h"
 #include "../../dialogs/dlg_roll_dice.h"
 #include "../../main.h"
+#include "../../server/pending_command.h"
 #include "../../settings/cache_settings.h"
 #include "../../settings/card_counter_settings.h"
 #include "../board/arrow_item.h"
 #include "../board/card_item.h"
+#include "../board/card_item_pool.h"
 #include "../board/card_list.h"
 #include "../board/counter_general.h"
 #include "../cards/card_database.h"
@@ -25,6 +27,7 @@
 #include "../zones/view_zone.h"
 #include "../zones/view_zone_widget.h"
 #include "color.h"
+#include "get_pb_extension.h"
 #include "pb/command_attach_card.pb.h"
 #include "pb/command_change_zone_properties.pb.h"
 #include "pb/command_concede.pb.h"
@@ -33,6 +36,7 @@
 #include "pb/command_flip_card.pb.h"
 #include "pb/command_game_say.pb.h"
 #include "pb/command_move_card.pb.h"
+#include "pb/command_move_top_cards_until.pb.h"
 #include "pb/command_mulligan.pb.h"
 #include "pb/command_reveal_cards.pb.h"
 #include "pb/command_roll_die.pb.h"
@@ -109,9 +113,9 @@ void PlayerArea::setPlayerZoneId(int _playerZoneId)
 }
 
 Player::Player(const ServerInfo_User &info, int _id, bool _local, bool _judge, TabGame *_parent)
-    : QObject(_parent), game(_parent), movingCardsUntil(false), shortcutsActive(false), lastTokenTableRow(0), id(_id),
-      active(false), local(_local), judge(_judge), mirrored(false), handVisible(false), conceded(false), zoneId(0),
-      dialogSemaphore(false), deck(nullptr)
+    : QObject(_parent), game(_parent), movingCardsUntil(false), movingCardsUntilOnServer(false), shortcutsActive(false),
+      lastTokenTableRow(0), id(_id), active(false), local(_local), judge(_judge), mirrored(false), handVisible(false),
+      conceded(false), zoneId(0), dialogSemaphore(false), deck(nullptr)
 {
     userInfo = new ServerInfo_User;
     userInfo->CopyFrom(info);
@@ -474,96 +478,6 @@ Player::Player(const ServerInfo_User &info, int _id, bool _local, bool _judge, T
         mCardCounters = nullptr;
     }
 
-    aTap = new QAction(this);
-    aTap->setData(cmTap);
-    connect(aTap, &QAction::triggered, this, &Player::cardMenuAction);
-    aDoesntUntap = new QAction(this);
-    aDoesntUntap->setData(cmDoesntUntap);
-    connect(aDoesntUntap, &QAction::triggered, this, &Player::cardMenuAction);
-    aAttach = new QAction(this);
-    connect(aAttach, &QAction::triggered, this, &Player::actAttach);
-    aUnattach = new QAction(this);
-    connect(aUnattach, &QAction::triggered, this, &Player::actUnattach);
-    aDrawArrow = new QAction(this);
-    connect(aDrawArrow, &QAction::triggered, this, &Player::actDrawArrow);
-    aIncP = new QAction(this);
-    connect(aIncP, &QAction::triggered, this, &Player::actIncP);
-    aDecP = new QAction(this);
-    connect(aDecP, &QAction::triggered, this, &Player::actDecP);
-    aIncT = new QAction(this);
-    connect(aIncT, &QAction::triggered, this, &Player::actIncT);
-    aDecT = new QAction(this);
-    connect(aDecT, &QAction::triggered, this, &Player::actDecT);
-    aIncPT = new QAction(this);
-    connect(aIncPT, &QAction::triggered, this, [this] { actIncPT(); });
-    aDecPT = new QAction(this);
-    connect(aDecPT, &QAction::triggered, this, &Player::actDecPT);
-    aFlowP = new QAction(this);
-    connect(aFlowP, &QAction::triggered, this, &Player::actFlowP);
-    aFlowT = new QAction(this);
-    connect(aFlowT, &QAction::triggered, this, &Player::actFlowT);
-    aSetPT = new QAction(this);
-    connect(aSetPT, &QAction::triggered, this, &Player::actSetPT);
-    aResetPT = new QAction(this);
-    connect(aResetPT, &QAction::triggered, this, &Player::actResetPT);
-    aSetAnnotation = new QAction(this);
-    connect(aSetAnnotation, &QAction::triggered, this, &Player::actSetAnnotation);
-    aFlip = new QAction(this);
-    aFlip->setData(cmFlip);
-    connect(aFlip, &QAction::triggered, this, &Player::cardMenuAction);
-    aPeek = new QAction(this);
-    aPeek->setData(cmPeek);
-    connect(aPeek, &QAction::triggered, this, &Player::cardMenuAction);
-    aClone = new QAction(this);
-    aClone->setData(cmClone);
-    connect(aClone, &QAction::triggered, this, &Player::cardMenuAction);
-    aMoveToTopLibrary = new QAction(this);
-    aMoveToTopLibrary->setData(cmMoveToTopLibrary);
-    aMoveToBottomLibrary = new QAction(this);
-    aMoveToBottomLibrary->setData(cmMoveToBottomLibrary);
-    aMoveToXfromTopOfLibrary = new QAction(this);
-    aMoveToGraveyard = new QAction(this);
-    aMoveToHand = new QAction(this);
-    aMoveToHand->setData(cmMoveToHand);
-    aMoveToGraveyard->setData(cmMoveToGraveyard);
-    aMoveToExile = new QAction(this);
-    aMoveToExile->setData(cmMoveToExile);
-    connect(aMoveToTopLibrary, &QAction::triggered, this, &Player::cardMenuAction);
-    connect(aMoveToBottomLibrary, &QAction::triggered, this, &Player::cardMenuAction);
-    connect(aMoveToXfromTopOfLibrary, &QAction::triggered, this, &Player::actMoveCardXCardsFromTop);
-    connect(aMoveToHand, &QAction::triggered, this, &Player::cardMenuAction);
-    connect(aMoveToGraveyard, &QAction::triggered, this, &Player::cardMenuAction);
-    connect(aMoveToExile, &QAction::triggered, this, &Player::cardMenuAction);
-
-    aSelectAll = new QAction(this);
-    connect(aSelectAll, &QAction::triggered, this, &Player::actSelectAll);
-    aSelectRow = new QAction(this);
-    connect(aSelectRow, &QAction::triggered, this, &Player::actSelectRow);
-    aSelectColumn = new QAction(this);
-    connect(aSelectColumn, &QAction::triggered, this, &Player::actSelectColumn);
-
-    aPlay = new QAction(this);
-    connect(aPlay, &QAction::triggered, this, &Player::actPlay);
-    aHide = new QAction(this);
-    connect(aHide, &QAction::triggered, this, &Player::actHide);
-    aPlayFacedown = new QAction(this);
-    connect(aPlayFacedown, &QAction::triggered, this, &Player::actPlayFacedown);
-
-    for (int i = 0; i < 6; ++i) {
-        auto *tempAddCounter = new QAction(this);
-        tempAddCounter->setData(9 + i * 1000);
-        auto *tempRemoveCounter = new QAction(this);
-        tempRemoveCounter->setData(10 + i * 1000);
-        auto *tempSetCounter = new QAction(this);
-        tempSetCounter->setData(11 + i * 1000);
-        aAddCounter.append(tempAddCounter);
-        aRemoveCounter.append(tempRemoveCounter);
-        aSetCounter.append(tempSetCounter);
-        connect(tempAddCounter, &QAction::triggered, this, &Player::actCardCounterTrigger);
-        connect(tempRemoveCounter, &QAction::triggered, this, &Player::actCardCounterTrigger);
-        connect(tempSetCounter, &QAction::triggered, this, &Player::actCardCounterTrigger);
-    }
-
     const QList<Player *> &players = game->getPlayers().values();
     for (const auto player : players) {
         addPlayer(player);
@@ -876,6 +790,118 @@ void Player::retranslateUi()
         sayMenu->setTitle(tr("S&ay"));
     }
 
+    if (cardActionsCreated) {
+        retranslateCardActions();
+    }
+
+    QMapIterator<QString, CardZone *> zoneIterator(zones);
+    while (zoneIterator.hasNext()) {
+        zoneIterator.next().value()->retranslateUi();
+    }
+}
+
+void Player::createCardActions()
+{
+    if (cardActionsCreated) {
+        return;
+    }
+    cardActionsCreated = true;
+
+    aTap = new QAction(this);
+    aTap->setData(cmTap);
+    connect(aTap, &QAction::triggered, this, &Player::cardMenuAction);
+    aDoesntUntap = new QAction(this);
+    aDoesntUntap->setData(cmDoesntUntap);
+    connect(aDoesntUntap, &QAction::triggered, this, &Player::cardMenuAction);
+    aAttach = new QAction(this);
+    connect(aAttach, &QAction::triggered, this, &Player::actAttach);
+    aUnattach = new QAction(this);
+    connect(aUnattach, &QAction::triggered, this, &Player::actUnattach);
+    aDrawArrow = new QAction(this);
+    connect(aDrawArrow, &QAction::triggered, this, &Player::actDrawArrow);
+    aIncP = new QAction(this);
+    connect(aIncP, &QAction::triggered, this, &Player::actIncP);
+    aDecP = new QAction(this);
+    connect(aDecP, &QAction::triggered, this, &Player::actDecP);
+    aIncT = new QAction(this);
+    connect(aIncT, &QAction::triggered, this, &Player::actIncT);
+    aDecT = new QAction(this);
+    connect(aDecT, &QAction::triggered, this, &Player::actDecT);
+    aIncPT = new QAction(this);
+    connect(aIncPT, &QAction::triggered, this, [this] { actIncPT(); });
+    aDecPT = new QAction(this);
+    connect(aDecPT, &QAction::triggered, this, &Player::actDecPT);
+    aFlowP = new QAction(this);
+    connect(aFlowP, &QAction::triggered, this, &Player::actFlowP);
+    aFlowT = new QAction(this);
+    connect(aFlowT, &QAction::triggered, this, &Player::actFlowT);
+    aSetPT = new QAction(this);
+    connect(aSetPT, &QAction::triggered, this, &Player::actSetPT);
+    aResetPT = new QAction(this);
+    connect(aResetPT, &QAction::triggered, this, &Player::actResetPT);
+    aSetAnnotation = new QAction(this);
+    connect(aSetAnnotation, &QAction::triggered, this, &Player::actSetAnnotation);
+    aFlip = new QAction(this);
+    aFlip->setData(cmFlip);
+    connect(aFlip, &QAction::triggered, this, &Player::cardMenuAction);
+    aPeek = new QAction(this);
+    aPeek->setData(cmPeek);
+    connect(aPeek, &QAction::triggered, this, &Player::cardMenuAction);
+    aClone = new QAction(this);
+    aClone->setData(cmClone);
+    connect(aClone, &QAction::triggered, this, &Player::cardMenuAction);
+    aMoveToTopLibrary = new QAction(this);
+    aMoveToTopLibrary->setData(cmMoveToTopLibrary);
+    aMoveToBottomLibrary = new QAction(this);
+    aMoveToBottomLibrary->setData(cmMoveToBottomLibrary);
+    aMoveToXfromTopOfLibrary = new QAction(this);
+    aMoveToGraveyard = new QAction(this);
+    aMoveToHand = new QAction(this);
+    aMoveToHand->setData(cmMoveToHand);
+    aMoveToGraveyard->setData(cmMoveToGraveyard);
+    aMoveToExile = new QAction(this);
+    aMoveToExile->setData(cmMoveToExile);
+    connect(aMoveToTopLibrary, &QAction::triggered, this, &Player::cardMenuAction);
+    connect(aMoveToBottomLibrary, &QAction::triggered, this, &Player::cardMenuAction);
+    connect(aMoveToXfromTopOfLibrary, &QAction::triggered, this, &Player::actMoveCardXCardsFromTop);
+    connect(aMoveToHand, &QAction::triggered, this, &Player::cardMenuAction);
+    connect(aMoveToGraveyard, &QAction::triggered, this, &Player::cardMenuAction);
+    connect(aMoveToExile, &QAction::triggered, this, &Player::cardMenuAction);
+
+    aSelectAll = new QAction(this);
+    connect(aSelectAll, &QAction::triggered, this, &Player::actSelectAll);
+    aSelectRow = new QAction(this);
+    connect(aSelectRow, &QAction::triggered, this, &Player::actSelectRow);
+    aSelectColumn = new QAction(this);
+    connect(aSelectColumn, &QAction::triggered, this, &Player::actSelectColumn);
+
+    aPlay = new QAction(this);
+    connect(aPlay, &QAction::triggered, this, &Player::actPlay);
+    aHide = new QAction(this);
+    connect(aHide, &QAction::triggered, this, &Player::actHide);
+    aPlayFacedown = new QAction(this);
+    connect(aPlayFacedown, &QAction::triggered, this, &Player::actPlayFacedown);
+
+    for (int i = 0; i < 6; ++i) {
+        auto *tempAddCounter = new QAction(this);
+        tempAddCounter->setData(9 + i * 1000);
+        auto *tempRemoveCounter = new QAction(this);
+        tempRemoveCounter->setData(10 + i * 1000);
+        auto *tempSetCounter = new QAction(this);
+        tempSetCounter->setData(11 + i * 1000);
+        aAddCounter.append(tempAddCounter);
+        aRemoveCounter.append(tempRemoveCounter);
+        aSetCounter.append(tempSetCounter);
+        connect(tempAddCounter, &QAction::triggered, this, &Player::actCardCounterTrigger);
+        connect(tempRemoveCounter, &QAction::triggered, this, &Player::actCardCounterTrigger);
+        connect(tempSetCounter, &QAction::triggered, this, &Player::actCardCounterTrigger);
+    }
+
+    retranslateCardActions();
+}
+
+void Player::retranslateCardActions()
+{
     aSelectAll->setText(tr("&Select All"));
     aSelectRow->setText(tr("S&elect Row"));
     aSelectColumn->setText(tr("S&elect Column"));
@@ -925,15 +951,11 @@ void Player::retranslateUi()
     aMoveToHand->setText(tr("&Hand"));
     aMoveToGraveyard->setText(tr("&Graveyard"));
     aMoveToExile->setText(tr("&Exile"));
-
-    QMapIterator<QString, CardZone *> zoneIterator(zones);
-    while (zoneIterator.hasNext()) {
-        zoneIterator.next().value()->retranslateUi();
-    }
 }
 
 void Player::setShortcutsActive()
 {
+    createCardActions();
     shortcutsActive = true;
     ShortcutsSettings &shortcuts = SettingsCache::instance().shortcuts();
 
@@ -1471,8 +1493,50 @@ void Player::actMoveTopCardsUntil()
         movingCardsUntilFilter = FilterString(expr);
         movingCardsUntilCounter = movingCardsUntilNumberOfHits;
         movingCardsUntil = true;
-        actMoveTopCardToPlay();
+        moveTopCardsUntilOnServer();
+    }
+}
+
+/**
+ * @brief Has the server do the whole dig in one go, which saves a round trip per card. The server doesn't know the
+ * card database, so it gets the names of the cards that could be in the deck and match the filter. Falls back to
+ * moving the cards one by one on servers that don't know the command.
+ */
+void Player::moveTopCardsUntilOnServer()
+{
+    QSet<QString> candidateNames;
+    if (deck) {
+        for (const QString &cardName : deck->getCardList()) {
+            candidateNames.insert(cardName);
+        }
+    }
+    for (const CardZone *zone : zones) {
+        for (const CardItem *card : zone->getCards()) {
+            if (!card->getName().isEmpty()) {
+                candidateNames.insert(card->getName());
+            }
+        }
+    }
+
+    Command_MoveTopCardsUntil cmd;
+    for (const QString &cardName : candidateNames) {
+        if (movingCardsUntilFilter.check(CardDatabaseManager::getInstance()->getCardInfo(cardName))) {
+            cmd.add_card_name(cardName.toStdString());
+        }
     }
+    cmd.set_number_of_hits(movingCardsUntilNumberOfHits);
+
+    movingCardsUntilOnServer = true;
+    PendingCommand *pend = prepareGameCommand(cmd);
+    connect(pend, &PendingCommand::finished, this, [this](const Response &response) {
+        movingCardsUntilOnServer = false;
+        if (response.response_code() == Response::RespInvalidCommand && movingCardsUntil) {
+            actMoveTopCardToPlay();
+        } else {
+            stopMoveTopCardsUntil();
+        }
+    });
+    sendGameCommand(pend);
 }
 
 void Player::moveOneCardUntil(CardItem *card)
@@ -1487,6 +1551,11 @@ void Player::moveOneCardUntil(CardItem *card)
         QTimer::singleShot(0, this, [card, this] { playCard(card, false); });
     }
 
+    // the server moves the cards on its own, the response to the command ends the dig
+    if (movingCardsUntilOnServer) {
+        return;
+    }
+
     if (zones.value("deck")->getCards().empty() || !card) {
         stopMoveTopCardsUntil();
     } else if (isMatch) {
@@ -2245,7 +2314,7 @@ void Player::eventCreateToken(const Event_CreateToken &event)
     }
 
     CardRef cardRef = {QString::fromStdString(event.card_name()), QString::fromStdString(event.card_provider_id())};
-    CardItem *card = new CardItem(this, nullptr, cardRef, event.card_id());
+    CardItem *card = CardItemPool::acquire(this, nullptr, cardRef, event.card_id());
     // use db PT if not provided in event and not face-down
     if (!QString::fromStdString(event.pt()).isEmpty()) {
         card->setPT(QString::fromStdString(event.pt()));
@@ -2435,7 +2504,7 @@ void Player::eventMoveCard(const Event_MoveCard &event, const GameEventContext &
             ArrowItem *arrow = arrowIterator.next().value();
             if ((arrow->getStartItem() == card) || (arrow->getTargetItem() == card)) {
                 if (startZone == targetZone) {
-                    arrow->updatePath();
+                    arrow->schedulePathUpdate();
                 } else {
                     arrowsToDelete.append(arrow);
                 }
@@ -2815,12 +2884,12 @@ void Player::processPlayerInfo(const ServerInfo_Player &info)
         const int cardListSize = zoneInfo.card_list_size();
         if (!cardListSize) {
             for (int j = 0; j < zoneInfo.card_count(); ++j) {
-                zone->addCard(new CardItem(this), false, -1);
+                zone->addCard(CardItemPool::acquire(this), false, -1);
             }
         } else {
             for (int j = 0; j < cardListSize; ++j) {
                 const ServerInfo_Card &cardInfo = zoneInfo.card_list(j);
-                CardItem *card = new CardItem(this);
+                CardItem *card = CardItemPool::acquire(this);
                 card->processCardInfo(cardInfo);
                 zone->addCard(card, false, cardInfo.x(), cardInfo.y());
             }
@@ -2873,6 +2942,64 @@ void Player::processCardAttachment(const ServerInfo_Player &info)
     }
 }
 
+void Player::writePlayerInfo(ServerInfo_Player &info) const
+{
+    ServerInfo_PlayerProperties *properties = info.mutable_properties();
+    properties->set_player_id(id);
+    properties->mutable_user_info()->CopyFrom(*userInfo);
+    properties->set_conceded(conceded);
+
+    for (const CardZone *zone : zones) {
+        const bool withCoords = dynamic_cast<const TableZone *>(zone) != nullptr;
+        ServerInfo_Zone *zoneInfo = info.add_zone_list();
+        zoneInfo->set_name(zone->getName().toStdString());
+        zoneInfo->set_type(zone->contentsKnown() ? ServerInfo_Zone::PublicZone : ServerInfo_Zone::HiddenZone);
+        zoneInfo->set_with_coords(withCoords);
+        zoneInfo->set_card_count(zone->getCards().size());
+        zoneInfo->set_always_reveal_top_card(zone->getAlwaysRevealTopCard());
+        for (const CardItem *card : zone->getCards()) {
+            ServerInfo_Card *cardInfo = zoneInfo->add_card_list();
+            card->writeCardInfo(*cardInfo);
+            if (withCoords) {
+                cardInfo->set_x(card->getGridPoint().x());
+                cardInfo->set_y(card->getGridPoint().y());
+            }
+        }
+    }
+
+    for (const AbstractCounter *counter : counters) {
+        ServerInfo_Counter *counterInfo = info.add_counter_list();
+        counterInfo->set_id(counter->getId());
+        counterInfo->set_name(counter->getName().toStdString());
+        counterInfo->set_count(counter->getValue());
+        if (const auto *generalCounter = dynamic_cast<const GeneralCounter *>(counter)) {
+            counterInfo->mutable_counter_color()->CopyFrom(convertQColorToColor(generalCounter->getColor()));
+            counterInfo->set_radius(generalCounter->getRadius());
+        }
+    }
+
+    for (const ArrowItem *arrow : arrows) {
+        const auto *startCard = dynamic_cast<const CardItem *>(arrow->getStartItem());
+        if (arrow->getId() == -1 || !startCard || !startCard->getZone() || !arrow->getTargetItem()) {
+            continue;
+        }
+        ServerInfo_Arrow *arrowInfo = info.add_arrow_list();
+        arrowInfo->set_id(arrow->getId());
+        arrowInfo->set_start_player_id(startCard->getZone()->getPlayer()->getId());
+        arrowInfo->set_start_zone(startCard->getZone()->getName().toStdString());
+        arrowInfo->set_start_card_id(startCard->getId());
+        const auto *targetCard = dynamic_cast<const CardItem *>(arrow->getTargetItem());
+        if (targetCard && targetCard->getZone()) {
+            arrowInfo->set_target_player_id(targetCard->getZone()->getPlayer()->getId());
+            arrowInfo->set_target_zone(targetCard->getZone()->getName().toStdString());
+            arrowInfo->set_target_card_id(targetCard->getId());
+        } else {
+            arrowInfo->set_target_player_id(arrow->getTargetItem()->getOwner()->getId());
+        }
+        arrowInfo->mutable_arrow_color()->CopyFrom(convertQColorToColor(arrow->getColor()));
+    }
+}
+
 void Player::playCard(CardItem *card, bool faceDown)
 {
     if (card == nullptr) {
@@ -3169,7 +3296,7 @@ PendingCommand *Player::prepareGameCommand(const google::protobuf::Message &cmd)
         Command_Judge base;
         GameCommand *c = base.add_game_command();
         base.set_target_id(id);
-        c->GetReflection()->MutableMessage(c, cmd.GetDescriptor()->FindExtensionByName("ext"))->CopyFrom(cmd);
+        setPbExtension(c, cmd);
         return game->prepareGameCommand(base);
     } else {
         return game->prepareGameCommand(cmd);
@@ -3183,9 +3310,7 @@ PendingCommand *Player::prepareGameCommand(const QList<const ::google::protobuf:
         base.set_target_id(id);
         for (int i = 0; i < cmdList.size(); ++i) {
             GameCommand *c = base.add_game_command();
-            c->GetReflection()
-                ->MutableMessage(c, cmdList[i]->GetDescriptor()->FindExtensionByName("ext"))
-                ->CopyFrom(*cmdList[i]);
+            setPbExtension(c, *cmdList[i]);
             delete cmdList[i];
         }
         return game->prepareGameCommand(base);
@@ -3904,6 +4029,7 @@ void Player::updateCardMenu(const CardItem *card)
     if (card == nullptr || (game->isSpectator() && !judge) || game->getActiveCard() != card) {
         return;
     }
+    createCardActions();
 
     QMenu *cardMenu = card->getCardMenu();
     QMenu *ptMenu = card->getPTMenu();
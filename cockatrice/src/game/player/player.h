@@ -277,8 +277,14 @@ private:
         *aIncP, *aDecP, *aIncT, *aDecT, *aIncPT, *aDecPT, *aFlowP, *aFlowT, *aSetAnnotation, *aFlip, *aPeek, *aClone,
         *aMoveToTopLibrary, *aMoveToBottomLibrary, *aMoveToHand, *aMoveToGraveyard, *aMoveToExile,
         *aMoveToXfromTopOfLibrary, *aSelectAll, *aSelectRow, *aSelectColumn, *aSortHand, *aIncrementAllCardCounters;
+    // the actions of the card menus only exist once a card menu or the shortcuts of this player are needed, which they
+    // never are for a remote player
+    bool cardActionsCreated = false;
+    void createCardActions();
+    void retranslateCardActions();
 
     bool movingCardsUntil;
+    bool movingCardsUntilOnServer;
     QTimer *moveTopCardTimer;
     QStringList movingCardsUntilExprs = {};
     int movingCardsUntilNumberOfHits = 1;
@@ -334,6 +340,7 @@ private:
                     bool persistent = false);
     bool createRelatedFromRelation(const CardItem *sourceCard, const CardRelation *cardRelation);
     void moveOneCardUntil(CardItem *card);
+    void moveTopCardsUntilOnServer();
     void addPlayerToList(QMenu *playerList, Player *player);
     static void removePlayerFromList(QMenu *playerList, Player *player);
 
@@ -442,6 +449,10 @@ public:
         return game;
     }
     void setDeck(const DeckLoader &_deck);
+    const DeckLoader *getDeck() const
+    {
+        return deck;
+    }
     QMenu *getPlayerMenu() const
     {
         return playerMenu;
@@ -510,6 +521,8 @@ public:
 
     void processPlayerInfo(const ServerInfo_Player &info);
     void processCardAttachment(const ServerInfo_Player &info);
+    // the opposite of processPlayerInfo(), as far as the client knows the player
+    void writePlayerInfo(ServerInfo_Player &info) const;
 
     void processGameEvent(GameEvent::GameEventType type,
                           const GameEvent &event,
@@ -517,6 +530,11 @@ public:
                           EventProcessingOptions options);
 
     PendingCommand *prepareGameCommand(const ::google::protobuf::Message &cmd);
+    /**
+     * Packs the commands into a single container and takes ownership of them. The server processes a container
+     * in one go and sends a single event container for it, so mass actions should go through this instead of
+     * sending their commands one by one. Note that the server runs the commands of a container in reverse order.
+     */
     PendingCommand *prepareGameCommand(const QList<const ::google::protobuf::Message *> &cmdList);
     void sendGameCommand(PendingCommand *pend);
     void sendGameCommand(const google::protobuf::Message &command);
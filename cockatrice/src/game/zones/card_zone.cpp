@@ -1,6 +1,7 @@
 #include "card_zone.h"
 
 #include "../board/card_item.h"
+#include "../board/card_item_pool.h"
 #include "../cards/card_database_manager.h"
 #include "../player/player.h"
 #include "pb/command_move_card.pb.h"
@@ -27,7 +28,8 @@ CardZone::CardZone(Player *_p,
                    bool _contentsKnown,
                    QGraphicsItem *parent)
     : AbstractGraphicsItem(parent), player(_p), name(_name), cards(_contentsKnown), views{}, menu(nullptr),
-      doubleClickAction(0), hasCardAttr(_hasCardAttr), isShufflable(_isShufflable)
+      doubleClickAction(0), hasCardAttr(_hasCardAttr), isShufflable(_isShufflable), layoutSuspensions(0),
+      layoutPending(false)
 {
     // If we join a game before the card db finishes loading, the cards might have the wrong printings.
     // Force refresh all cards in the zone when db finishes loading to fix that.
@@ -141,7 +143,7 @@ void CardZone::addCard(CardItem *card, const bool reorganize, const int x, const
 
     for (auto *view : views) {
         if (view->prepareAddCard(x)) {
-            view->addCard(new CardItem(player, nullptr, card->getCardRef(), card->getId()), reorganize, x, y);
+            view->addCard(CardItemPool::acquire(player, nullptr, card->getCardRef(), card->getId()), reorganize, x, y);
         }
     }
 
@@ -199,6 +201,32 @@ CardItem *CardZone::takeCard(int position, int cardId, bool toNewZone)
     return c;
 }
 
+void CardZone::reorganizeCards()
+{
+    if (layoutSuspensions > 0) {
+        layoutPending = true;
+        return;
+    }
+    reorganizeCardsImpl();
+}
+
+void CardZone::suspendLayout()
+{
+    ++layoutSuspensions;
+}
+
+void CardZone::resumeLayout()
+{
+    // zones created while the layout was suspended were never suspended themselves
+    if (layoutSuspensions == 0) {
+        return;
+    }
+    if (--layoutSuspensions == 0 && layoutPending) {
+        layoutPending = false;
+        reorganizeCardsImpl();
+    }
+}
+
 void CardZone::removeCard(CardItem *card)
 {
     if (!card) {
@@ -36,9 +36,12 @@ protected:
     bool hasCardAttr;
     bool isShufflable;
     bool alwaysRevealTopCard;
+    int layoutSuspensions;
+    bool layoutPending;
     void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event) override;
     void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
     virtual void addCardImpl(CardItem *card, int x, int y) = 0;
+    virtual void reorganizeCardsImpl() = 0;
 signals:
     void cardCountChanged();
 public slots:
@@ -111,7 +114,10 @@ public:
     {
         return views;
     }
-    virtual void reorganizeCards() = 0;
+    void reorganizeCards();
+    // while the layout is suspended, reorganizeCards() is put off until every suspension is resumed
+    void suspendLayout();
+    void resumeLayout();
     virtual QPointF closestGridPoint(const QPointF &point);
     bool getAlwaysRevealTopCard() const
     {
@@ -82,7 +82,7 @@ void HandZone::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*optio
     painter->fillRect(boundingRect(), brush);
 }
 
-void HandZone::reorganizeCards()
+void HandZone::reorganizeCardsImpl()
 {
     if (!cards.isEmpty()) {
         const int cardCount = cards.size();
@@ -124,7 +124,6 @@ void HandZone::reorganizeCards()
             }
         }
     }
-    update();
 }
 
 void HandZone::sortHand()
@@ -18,7 +18,7 @@ public:
     void handleDropEvent(const QList<CardDragItem *> &dragItems, CardZone *startZone, const QPoint &dropPoint) override;
     QRectF boundingRect() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
-    void reorganizeCards() override;
+    void reorganizeCardsImpl() override;
     void sortHand();
     void setWidth(qreal _width);
 
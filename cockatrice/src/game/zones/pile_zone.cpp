@@ -95,7 +95,7 @@ void PileZone::handleDropEvent(const QList<CardDragItem *> &dragItems,
     player->sendGameCommand(cmd);
 }
 
-void PileZone::reorganizeCards()
+void PileZone::reorganizeCardsImpl()
 {
     update();
 }
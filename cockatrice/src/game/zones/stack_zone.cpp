@@ -100,7 +100,7 @@ void StackZone::handleDropEvent(const QList<CardDragItem *> &dragItems, CardZone
     player->sendGameCommand(cmd);
 }
 
-void StackZone::reorganizeCards()
+void StackZone::reorganizeCardsImpl()
 {
     if (!cards.isEmpty()) {
         const auto cardCount = static_cast<int>(cards.size());
@@ -119,5 +119,4 @@ void StackZone::reorganizeCards()
             card->setRealZValue(i);
         }
     }
-    update();
 }
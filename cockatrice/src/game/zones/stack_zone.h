@@ -16,7 +16,7 @@ public:
     void handleDropEvent(const QList<CardDragItem *> &dragItems, CardZone *startZone, const QPoint &dropPoint) override;
     QRectF boundingRect() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
-    void reorganizeCards() override;
+    void reorganizeCardsImpl() override;
 
 protected:
     void addCardImpl(CardItem *card, int x, int y) override;
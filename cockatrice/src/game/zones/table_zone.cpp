@@ -20,8 +20,10 @@ const QColor TableZone::GRADIENT_COLOR = QColor(255, 255, 255, 150);
 const QColor TableZone::GRADIENT_COLORLESS = QColor(255, 255, 255, 0);
 
 TableZone::TableZone(Player *_p, const QString &name, QGraphicsItem *parent)
-    : SelectZone(_p, name, true, false, true, parent), active(false)
+    : SelectZone(_p, name, true, false, true, parent), cardsByGridPointValid(false), active(false),
+      paintedInverted(false)
 {
+    connect(this, &CardZone::cardCountChanged, this, [this] { cardsByGridPointValid = false; });
     connect(themeManager, &ThemeManager::themeChanged, this, &TableZone::updateBg);
     connect(&SettingsCache::instance(), &SettingsCache::invertVerticalCoordinateChanged, this,
             &TableZone::reorganizeCards);
@@ -66,6 +68,7 @@ void TableZone::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*opti
     }
 
     paintLandDivider(painter);
+    paintedInverted = isInverted();
 }
 
 /**
@@ -150,7 +153,7 @@ void TableZone::handleDropEventByGrid(const QList<CardDragItem *> &dragItems,
     startZone->getPlayer()->sendGameCommand(cmd);
 }
 
-void TableZone::reorganizeCards()
+void TableZone::reorganizeCardsImpl()
 {
     // Calculate card stack widths so mapping functions work properly
     computeCardStackWidths();
@@ -186,7 +189,9 @@ void TableZone::reorganizeCards()
     }
 
     resizeToContents();
-    update();
+    // the cards are items of their own, only the land divider of the cached background depends on the layout
+    if (isInverted() != paintedInverted)
+        update();
 }
 
 void TableZone::toggleTapped()
@@ -254,10 +259,19 @@ void TableZone::resizeToContents()
 
 CardItem *TableZone::getCardFromGrid(const QPoint &gridPoint) const
 {
-    for (int i = 0; i < cards.size(); i++)
-        if (cards.at(i)->getGridPoint() == gridPoint)
-            return cards.at(i);
-    return 0;
+    if (!cardsByGridPointValid) {
+        cardsByGridPoint.clear();
+        for (CardItem *card : cards) {
+            const QPoint &cardGridPoint = card->getGridPoint();
+            const int key = getCardStackMapKey(cardGridPoint.x(), cardGridPoint.y());
+            if (cardGridPoint.x() != -1 && !cardsByGridPoint.contains(key))
+                cardsByGridPoint.insert(key, card);
+        }
+        cardsByGridPointValid = true;
+    }
+    if (gridPoint.x() == -1)
+        return nullptr;
+    return cardsByGridPoint.value(getCardStackMapKey(gridPoint.x(), gridPoint.y()), nullptr);
 }
 
 CardItem *TableZone::getCardFromCoords(const QPointF &point) const
@@ -270,7 +284,7 @@ void TableZone::computeCardStackWidths()
 {
     // Each card stack is three grid points worth of card locations.
     // First pass: compute the number of cards at each card stack.
-    QMap<int, int> cardStackCount;
+    QHash<int, int> cardStackCount;
     for (int i = 0; i < cards.size(); ++i) {
         const QPoint &gridPoint = cards[i]->getGridPos();
         if (gridPoint.x() == -1)
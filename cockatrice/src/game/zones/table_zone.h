@@ -4,6 +4,8 @@
 #include "../board/abstract_card_item.h"
 #include "select_zone.h"
 
+#include <QHash>
+
 /*
  * TableZone is the grid based rect where CardItems may be placed.
  * It is the main play zone and can be customized with background images.
@@ -65,7 +67,14 @@ private:
     /*
     Internal cache for widths of stacks of cards by row and column.
     */
-    QMap<int, int> cardStackWidth;
+    QHash<int, int> cardStackWidth;
+
+    /*
+    The cards by grid point, like the coordinate map of the zone on the server. Rebuilt by the first lookup after the
+    cards of the zone changed, so dragging over the table doesn't go through every card.
+    */
+    mutable QHash<int, CardItem *> cardsByGridPoint;
+    mutable bool cardsByGridPointValid;
 
     /*
        Holds any custom background image for the TableZone
@@ -77,6 +86,11 @@ private:
      */
     bool active;
 
+    /*
+       If the background was last painted for an inverted table
+     */
+    bool paintedInverted;
+
     bool isInverted() const;
 
 private slots:
@@ -89,7 +103,7 @@ public slots:
     /**
        Reorganizes CardItems in the TableZone
      */
-    void reorganizeCards() override;
+    void reorganizeCardsImpl() override;
 
 public:
     /**
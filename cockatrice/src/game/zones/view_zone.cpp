@@ -3,8 +3,10 @@
 #include "../../server/pending_command.h"
 #include "../board/card_drag_item.h"
 #include "../board/card_item.h"
+#include "../board/card_item_pool.h"
 #include "../cards/card_info.h"
 #include "../player/player.h"
+#include "card_name_dictionary.h"
 #include "pb/command_dump_zone.pb.h"
 #include "pb/command_move_card.pb.h"
 #include "pb/response_dump_zone.pb.h"
@@ -50,6 +52,10 @@ void ZoneViewZone::close()
     if (!(revealZone && !writeableRevealZone)) {
         origZone->getViews().removeOne(this);
     }
+    // the cards go back to the pool rather than down with the zone
+    for (CardItem *card : cards) {
+        card->deleteLater();
+    }
     deleteLater();
 }
 
@@ -68,12 +74,15 @@ void ZoneViewZone::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*o
 void ZoneViewZone::initializeCards(const QList<const ServerInfo_Card *> &cardList)
 {
     if (!cardList.isEmpty()) {
+        // addCardImpl() lays the view out again for every card, once is enough
+        suspendLayout();
         for (int i = 0; i < cardList.size(); ++i) {
             auto card = cardList[i];
             CardRef cardRef = {QString::fromStdString(card->name()), QString::fromStdString(card->provider_id())};
-            addCard(new CardItem(player, this, cardRef, card->id()), false, i);
+            addCard(CardItemPool::acquire(player, this, cardRef, card->id()), false, i);
         }
         reorganizeCards();
+        resumeLayout();
     } else if (!origZone->contentsKnown()) {
         Command_DumpZone cmd;
         cmd.set_player_id(player->getId());
@@ -87,23 +96,32 @@ void ZoneViewZone::initializeCards(const QList<const ServerInfo_Card *> &cardLis
     } else {
         const CardList &c = origZone->getCards();
         int number = numberCards == -1 ? c.size() : (numberCards < c.size() ? numberCards : c.size());
+        suspendLayout();
         for (int i = 0; i < number; i++) {
             CardItem *card = c.at(i);
-            addCard(new CardItem(player, this, card->getCardRef(), card->getId()), false, i);
+            addCard(CardItemPool::acquire(player, this, card->getCardRef(), card->getId()), false, i);
         }
         reorganizeCards();
+        resumeLayout();
     }
 }
 
 void ZoneViewZone::zoneDumpReceived(const Response &r)
 {
     const Response_DumpZone &resp = r.GetExtension(Response_DumpZone::ext);
-    const int respCardListSize = resp.zone_info().card_list_size();
+    ServerInfo_Zone zoneInfo(resp.zone_info());
+    if (resp.card_names_size() > 0) {
+        // the cards refer to the names listed with the response
+        CardNameDictionary cardNames;
+        cardNames.addNames(0, resp.card_names());
+        cardNames.decode(zoneInfo);
+    }
+    const int respCardListSize = zoneInfo.card_list_size();
     for (int i = 0; i < respCardListSize; ++i) {
-        const ServerInfo_Card &cardInfo = resp.zone_info().card_list(i);
+        const ServerInfo_Card &cardInfo = zoneInfo.card_list(i);
         auto cardName = QString::fromStdString(cardInfo.name());
         auto cardProviderId = QString::fromStdString(cardInfo.provider_id());
-        auto *card = new CardItem(player, this, {cardName, cardProviderId}, cardInfo.id(), this);
+        auto *card = CardItemPool::acquire(player, this, {cardName, cardProviderId}, cardInfo.id(), this);
         cards.insert(i, card);
     }
 
@@ -147,7 +165,7 @@ void ZoneViewZone::updateCardIds(CardAction action)
 }
 
 // Because of boundingRect(), this function must not be called before the zone was added to a scene.
-void ZoneViewZone::reorganizeCards()
+void ZoneViewZone::reorganizeCardsImpl()
 {
     // filter cards
     CardList cardsToDisplay = CardList(cards.getContentsKnown());
@@ -70,7 +70,7 @@ public:
                  bool _isReversed = false);
     QRectF boundingRect() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
-    void reorganizeCards() override;
+    void reorganizeCardsImpl() override;
     void initializeCards(const QList<const ServerInfo_Card *> &cardList = QList<const ServerInfo_Card *>());
     bool prepareAddCard(int x);
     void removeCard(int position, bool toNewZone);
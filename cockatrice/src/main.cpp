@@ -23,14 +23,18 @@
 #include "QtNetwork/QNetworkInterface"
 #include "client/network/spoiler_background_updater.h"
 #include "client/sound_engine.h"
+#include "client/ui/picture_loader/picture_prefetcher.h"
 #include "client/ui/pixel_map_generator.h"
 #include "client/ui/theme_manager.h"
 #include "client/ui/window_main.h"
+#include "deck/deck_loader.h"
 #include "dialogs/dlg_settings.h"
 #include "featureset.h"
+#include "game/cards/card_database_manager.h"
 #include "rng_sfmt.h"
 #include "settings/cache_settings.h"
 #include "utility/logger.h"
+#include "utility/startup_trace.h"
 #include "version_string.h"
 
 #include <QApplication>
@@ -39,11 +43,14 @@
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QFuture>
 #include <QLibraryInfo>
 #include <QLocale>
+#include <QSet>
 #include <QSystemTrayIcon>
 #include <QTextStream>
 #include <QTranslator>
+#include <QtConcurrentRun>
 #include <QtPlugin>
 
 QTranslator *translator, *qtTranslator;
@@ -127,7 +134,7 @@ LONG WINAPI CockatriceUnhandledExceptionFilter(EXCEPTION_POINTERS *exceptionPoin
 }
 #endif
 
-void installNewTranslator()
+static void loadTranslators()
 {
     QString lang = SettingsCache::instance().getLang();
 
@@ -144,7 +151,6 @@ void installNewTranslator()
     } else {
         qCInfo(QtTranslatorDebug) << "Loaded qt translation" << qtNameHint << "at" << qtTranslationPath;
     }
-    qApp->installTranslator(qtTranslator);
 
     QString appNameHint = translationPrefix + "_" + lang;
     bool appTranslationLoaded = qtTranslator->load(appNameHint, translationPath);
@@ -155,9 +161,20 @@ void installNewTranslator()
         qCInfo(QtTranslatorDebug) << "Loaded" << translationPrefix << "translation" << appNameHint << "at"
                                   << translationPath;
     }
+}
+
+static void installTranslators()
+{
+    qApp->installTranslator(qtTranslator);
     qApp->installTranslator(translator);
 }
 
+void installNewTranslator()
+{
+    loadTranslators();
+    installTranslators();
+}
+
 QString const generateClientID()
 {
     QString macList;
@@ -170,8 +187,69 @@ QString const generateClientID()
     return strClientID;
 }
 
+/**
+ * Downloads the pictures of the cards of the given decks, or of all cards, without opening a window.
+ * @return The exit code of the process
+ */
+static int prefetchPictures(QApplication &app,
+                            const QStringList &deckFiles,
+                            bool allPrintings,
+                            bool makeThumbnails,
+                            int requestsPerSecond)
+{
+    CardDatabase *db = CardDatabaseManager::getInstance();
+    if (db->loadCardDatabases() != Ok) {
+        qCCritical(MainLog) << "Could not load the card database";
+        return 1;
+    }
+
+    QList<ExactCard> cards;
+    if (deckFiles.isEmpty()) {
+        for (const CardInfoPtr &info : db->getCardList()) {
+            if (!allPrintings) {
+                cards.append(db->getPreferredCard(info));
+                continue;
+            }
+            for (const auto &printings : info->getSets()) {
+                for (const PrintingInfo &printing : printings) {
+                    cards.append(ExactCard(info, printing));
+                }
+            }
+        }
+    } else {
+        for (const QString &deckFile : deckFiles) {
+            DeckLoader deck;
+            if (!deck.loadFromFile(deckFile, DeckLoader::getFormatFromName(deckFile))) {
+                qCCritical(MainLog) << "Could not load the deck" << deckFile;
+                return 1;
+            }
+            cards.append(db->getCards(deck.getCardRefList()));
+        }
+    }
+
+    // the decks share many cards
+    QList<ExactCard> distinctCards;
+    QSet<QString> cacheKeys;
+    for (const ExactCard &card : cards) {
+        if (card && !cacheKeys.contains(card.getPixmapCacheKey())) {
+            cacheKeys.insert(card.getPixmapCacheKey());
+            distinctCards.append(card);
+        }
+    }
+
+    PicturePrefetcher prefetcher(distinctCards, SettingsCache::instance().downloads().getMaxRequestsPerHost(),
+                                 requestsPerSecond, makeThumbnails);
+    QObject::connect(&prefetcher, &PicturePrefetcher::finished, &app,
+                     [&app](int, int, int failed) { app.exit(failed > 0 ? 2 : 0); });
+    prefetcher.start();
+    return app.exec();
+}
+
 int main(int argc, char *argv[])
 {
+    // starts the clock of the startup phases
+    StartupTrace::instance();
+
 #ifdef Q_OS_WIN
     SetUnhandledExceptionFilter(CockatriceUnhandledExceptionFilter);
 #endif
@@ -232,7 +310,19 @@ int main(int argc, char *argv[])
 
     parser.addOptions(
         {{{"c", "connect"}, QCoreApplication::translate("main", "Connect on startup"), "user:pass@host:port"},
-         {{"d", "debug-output"}, QCoreApplication::translate("main", "Debug to file")}});
+         {{"d", "debug-output"}, QCoreApplication::translate("main", "Debug to file")},
+         {"prefetch-pictures",
+          QCoreApplication::translate("main", "Download the pictures of the cards of the given decks, or of all cards, "
+                                              "into the pics folder and quit. Use -platform offscreen without a "
+                                              "display.")},
+         {"prefetch-all-printings",
+          QCoreApplication::translate("main", "With --prefetch-pictures and no decks, every printing of every card")},
+         {"prefetch-thumbnails",
+          QCoreApplication::translate("main", "With --prefetch-pictures, also fill the thumbnail cache")},
+         {"prefetch-rate", QCoreApplication::translate("main", "With --prefetch-pictures, requests per second"),
+          "count", "10"}});
+    parser.addPositionalArgument("decks", QCoreApplication::translate("main", "Decks for --prefetch-pictures"),
+                                 "[decks...]");
 
     parser.process(app);
 
@@ -240,22 +330,50 @@ int main(int argc, char *argv[])
         Logger::getInstance().logToFile(true);
     }
 
+    {
+        StartupTrace::Scope phase("Settings");
+        SettingsCache::instance();
+    }
+
+    if (parser.isSet("prefetch-pictures")) {
+        return prefetchPictures(app, parser.positionalArguments(), parser.isSet("prefetch-all-printings"),
+                                parser.isSet("prefetch-thumbnails"), parser.value("prefetch-rate").toInt());
+    }
+
     rng = new RNG_SFMT;
-    themeManager = new ThemeManager;
-    soundEngine = new SoundEngine;
 
+    // reading the translation files only needs the settings, they are installed before the first window is built
     qtTranslator = new QTranslator;
     translator = new QTranslator;
-    installNewTranslator();
+    QFuture<void> translatorsLoaded = QtConcurrent::run([] {
+        StartupTrace::Scope phase("Translations");
+        loadTranslators();
+    });
+
+    {
+        StartupTrace::Scope phase("Theme");
+        themeManager = new ThemeManager;
+    }
+    {
+        // the sound files of the theme are looked up concurrently, see SoundEngine::themeChangedSlot()
+        StartupTrace::Scope phase("Sound engine");
+        soundEngine = new SoundEngine;
+    }
+
+    translatorsLoaded.waitForFinished();
+    installTranslators();
 
     QLocale::setDefault(QLocale::English);
 
     qCInfo(MainLog) << "Starting main program";
 
+    StartupTrace &startupTrace = StartupTrace::instance();
+    const qint64 mainWindowStart = startupTrace.elapsed();
     MainWindow ui;
     if (parser.isSet("connect")) {
         ui.setConnectTo(parser.value("connect"));
     }
+    startupTrace.record("Main window", mainWindowStart, startupTrace.elapsed() - mainWindowStart);
     qCInfo(MainLog) << "MainWindow constructor finished";
 
     ui.setWindowIcon(QPixmap("theme:cockatrice"));
@@ -271,6 +389,7 @@ int main(int argc, char *argv[])
     SpoilerBackgroundUpdater spoilerBackgroundUpdater;
 
     ui.show();
+    startupTrace.markFirstWindow();
     qCInfo(MainLog) << "ui.show() finished";
 
     // force shortcuts to be shown/hidden in right-click menus, regardless of system defaults
@@ -17,6 +17,35 @@
 
 const QColor DEFAULT_MENTION_COLOR = QColor(194, 31, 47);
 
+static bool hasTagAt(const QString &message, int pos, QLatin1String tag)
+{
+    if (message.size() - pos < tag.size())
+        return false;
+    for (int i = 0; i < tag.size(); ++i) {
+        if (message.at(pos + i) != QLatin1Char(tag.at(i)))
+            return false;
+    }
+    return true;
+}
+
+// returns the text between the tag opening at pos and closeTag, or up to the end, and moves pos past it
+static QString takeTagContent(const QString &message, int &pos, QLatin1String openTag, QLatin1String closeTag)
+{
+    const int start = pos + openTag.size();
+    const int closeTagIndex = message.indexOf(closeTag, start);
+    if (closeTagIndex == -1) {
+        pos = message.size();
+        return message.mid(start);
+    }
+    pos = closeTagIndex + closeTag.size();
+    return message.mid(start, closeTagIndex - start);
+}
+
+static bool isAsciiLetterOrNumber(QChar c)
+{
+    return c.unicode() < 128 && c.isLetterOrNumber();
+}
+
 UserMessagePosition::UserMessagePosition(QTextCursor &cursor)
 {
     block = cursor.block();
@@ -26,8 +55,16 @@ UserMessagePosition::UserMessagePosition(QTextCursor &cursor)
 ChatView::ChatView(TabSupervisor *_tabSupervisor, TabGame *_game, bool _showTimestamps, QWidget *parent)
     : QTextBrowser(parent), tabSupervisor(_tabSupervisor), game(_game),
       userListProxy(_tabSupervisor->getUserListManager()), evenNumber(true), showTimestamps(_showTimestamps),
-      hoveredItemType(HoveredNothing)
+      hoveredItemType(HoveredNothing), trimmedLength(0)
 {
+    // this also turns off the undo history of the document
+    document()->setMaximumBlockCount(MAX_BLOCK_COUNT);
+    connect(document(), &QTextDocument::contentsChange, this, [this](int position, int charsRemoved, int charsAdded) {
+        if (position == 0 && charsRemoved > charsAdded) {
+            trimmedLength += charsRemoved - charsAdded;
+        }
+    });
+
     if (palette().windowText().color().lightness() > 200) {
         document()->setDefaultStyleSheet(R"(
            a { text-decoration: none; color: rgb(71,158,252); }
@@ -56,6 +93,9 @@ ChatView::ChatView(TabSupervisor *_tabSupervisor, TabGame *_game, bool _showTime
     mentionFormatOtherUser.setForeground(linkColor);
     mentionFormatOtherUser.setAnchor(true);
 
+    updateHighlightedWords();
+    connect(&SettingsCache::instance(), &SettingsCache::highlightWordsChanged, this, &ChatView::updateHighlightedWords);
+
     viewport()->setCursor(Qt::IBeamCursor);
     setReadOnly(true);
     setTextInteractionFlags(Qt::TextSelectableByMouse | Qt::LinksAccessibleByMouse);
@@ -68,6 +108,19 @@ void ChatView::retranslateUi()
     userContextMenu->retranslateUi();
 }
 
+void ChatView::updateHighlightedWords()
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+    const QStringList words = SettingsCache::instance().getHighlightWords().split(' ', Qt::SkipEmptyParts);
+#else
+    const QStringList words = SettingsCache::instance().getHighlightWords().split(' ', QString::SkipEmptyParts);
+#endif
+    highlightedWords.clear();
+    for (const QString &word : words) {
+        highlightedWords.insert(word.toCaseFolded());
+    }
+}
+
 QTextCursor ChatView::prepareBlock(bool same)
 {
     lastSender.clear();
@@ -236,103 +289,94 @@ void ChatView::appendMessage(QString message,
     cursor.setCharFormat(defaultFormat);
 
     bool mentionEnabled = SettingsCache::instance().getChatMention();
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
-    highlightedWords = SettingsCache::instance().getHighlightWords().split(' ', Qt::SkipEmptyParts);
-#else
-    highlightedWords = SettingsCache::instance().getHighlightWords().split(' ', QString::SkipEmptyParts);
-#endif
 
-    // parse the message
-    while (message.size()) {
-        QChar c = message.at(0);
+    // parse the message in one pass, the plain text in between the formatted parts is inserted in one piece
+    int pos = 0;
+    while (pos < message.size()) {
+        QChar c = message.at(pos);
         switch (c.toLatin1()) {
             case '[':
-                checkTag(cursor, message);
+                checkTag(cursor, message, pos);
                 break;
             case '@':
                 if (mentionEnabled) {
-                    checkMention(cursor, message, userName, userLevel);
+                    checkMention(cursor, message, pos, userName, userLevel);
                 } else {
-                    cursor.insertText(c, defaultFormat);
-                    message = message.mid(1);
+                    pendingText += c;
+                    ++pos;
                 }
                 break;
             case ' ':
-                cursor.insertText(c, defaultFormat);
-                message = message.mid(1);
+                pendingText += c;
+                ++pos;
                 break;
             default:
                 if (c.isLetterOrNumber()) {
-                    checkWord(cursor, message);
+                    checkWord(cursor, message, pos);
                 } else {
-                    cursor.insertText(c, defaultFormat);
-                    message = message.mid(1);
+                    pendingText += c;
+                    ++pos;
                 }
                 break;
         }
     }
+    flushPendingText(cursor);
 
     if (atBottom)
         verticalScrollBar()->setValue(verticalScrollBar()->maximum());
 }
 
-void ChatView::checkTag(QTextCursor &cursor, QString &message)
+void ChatView::flushPendingText(QTextCursor &cursor)
 {
-    if (message.startsWith("[card]")) {
-        message = message.mid(6);
-        int closeTagIndex = message.indexOf("[/card]");
-        QString cardName = message.left(closeTagIndex);
-        if (closeTagIndex == -1)
-            message.clear();
-        else
-            message = message.mid(closeTagIndex + 7);
+    if (!pendingText.isEmpty()) {
+        cursor.insertText(pendingText, defaultFormat);
+        pendingText.clear();
+    }
+}
 
+void ChatView::checkTag(QTextCursor &cursor, const QString &message, int &pos)
+{
+    if (hasTagAt(message, pos, QLatin1String("[card]"))) {
+        const QString cardName = takeTagContent(message, pos, QLatin1String("[card]"), QLatin1String("[/card]"));
+        flushPendingText(cursor);
         appendCardTag(cursor, cardName);
         return;
     }
 
-    if (message.startsWith("[[")) {
-        message = message.mid(2);
-        int closeTagIndex = message.indexOf("]]");
-        QString cardName = message.left(closeTagIndex);
-        if (closeTagIndex == -1)
-            message.clear();
-        else
-            message = message.mid(closeTagIndex + 2);
-
+    if (hasTagAt(message, pos, QLatin1String("[["))) {
+        const QString cardName = takeTagContent(message, pos, QLatin1String("[["), QLatin1String("]]"));
+        flushPendingText(cursor);
         appendCardTag(cursor, cardName);
         return;
     }
 
-    if (message.startsWith("[url]")) {
-        message = message.mid(5);
-        int closeTagIndex = message.indexOf("[/url]");
-        QString url = message.left(closeTagIndex);
-        if (closeTagIndex == -1)
-            message.clear();
-        else
-            message = message.mid(closeTagIndex + 6);
-
+    if (hasTagAt(message, pos, QLatin1String("[url]"))) {
+        const QString url = takeTagContent(message, pos, QLatin1String("[url]"), QLatin1String("[/url]"));
+        flushPendingText(cursor);
         appendUrlTag(cursor, url);
         return;
     }
 
     // no valid tag found
-    checkWord(cursor, message);
+    checkWord(cursor, message, pos);
 }
 
-void ChatView::checkMention(QTextCursor &cursor, QString &message, const QString &userName, UserLevelFlags userLevel)
+void ChatView::checkMention(QTextCursor &cursor,
+                            const QString &message,
+                            int &pos,
+                            const QString &userName,
+                            UserLevelFlags userLevel)
 {
-    const static auto notALetterOrNumber = QRegularExpression("[^a-zA-Z0-9]");
-
-    int firstSpace = message.indexOf(' ');
-    QString fullMentionUpToSpaceOrEnd = (firstSpace == -1) ? message.mid(1) : message.mid(1, firstSpace - 1);
-    QString mentionIntact = fullMentionUpToSpaceOrEnd;
+    int firstSpace = message.indexOf(' ', pos);
+    const int mentionEnd = (firstSpace == -1) ? message.size() : firstSpace;
+    QString fullMentionUpToSpaceOrEnd = message.mid(pos + 1, mentionEnd - pos - 1);
+    const QString mentionIntact = fullMentionUpToSpaceOrEnd;
 
     while (fullMentionUpToSpaceOrEnd.size()) {
         const ServerInfo_User *onlineUser = userListProxy->getOnlineUser(fullMentionUpToSpaceOrEnd);
         if (onlineUser) // Is there a user online named this?
         {
+            flushPendingText(cursor);
             if (ownUserName.toLower() == fullMentionUpToSpaceOrEnd.toLower()) // Is this user you?
             {
                 // You have received a valid mention!!
@@ -341,7 +385,7 @@ void ChatView::checkMention(QTextCursor &cursor, QString &message, const QString
                 mentionFormat.setForeground(SettingsCache::instance().getChatMentionForeground() ? QBrush(Qt::white)
                                                                                                  : QBrush(Qt::black));
                 cursor.insertText(mention, mentionFormat);
-                message = message.mid(mention.size());
+                pos += mention.size();
                 showSystemPopup(userName);
             } else {
                 QString correctUserName = QString::fromStdString(onlineUser->name());
@@ -349,7 +393,7 @@ void ChatView::checkMention(QTextCursor &cursor, QString &message, const QString
                                                      correctUserName);
                 cursor.insertText("@" + correctUserName, mentionFormatOtherUser);
 
-                message = message.mid(correctUserName.size() + 1);
+                pos += correctUserName.size() + 1;
             }
 
             cursor.setCharFormat(defaultFormat);
@@ -362,19 +406,19 @@ void ChatView::checkMention(QTextCursor &cursor, QString &message, const QString
             mentionFormat.setBackground(QBrush(getCustomMentionColor()));
             mentionFormat.setForeground(SettingsCache::instance().getChatMentionForeground() ? QBrush(Qt::white)
                                                                                              : QBrush(Qt::black));
+            flushPendingText(cursor);
             cursor.insertText("@" + fullMentionUpToSpaceOrEnd, mentionFormat);
-            message = message.mid(fullMentionUpToSpaceOrEnd.size() + 1);
+            pos += fullMentionUpToSpaceOrEnd.size() + 1;
             showSystemPopup(userName);
 
             cursor.setCharFormat(defaultFormat);
             return;
         }
 
-        if (fullMentionUpToSpaceOrEnd.right(1).indexOf(notALetterOrNumber) == -1 ||
+        if (isAsciiLetterOrNumber(fullMentionUpToSpaceOrEnd.at(fullMentionUpToSpaceOrEnd.size() - 1)) ||
             fullMentionUpToSpaceOrEnd.size() < 2) {
-            cursor.insertText("@" + mentionIntact, defaultFormat);
-            message = message.mid(mentionIntact.size() + 1);
-            cursor.setCharFormat(defaultFormat);
+            pendingText += "@" + mentionIntact;
+            pos += mentionIntact.size() + 1;
             return;
         }
 
@@ -382,14 +426,14 @@ void ChatView::checkMention(QTextCursor &cursor, QString &message, const QString
     }
 
     // no valid mention found
-    checkWord(cursor, message);
+    checkWord(cursor, message, pos);
 }
 
-void ChatView::checkWord(QTextCursor &cursor, QString &message)
+void ChatView::checkWord(QTextCursor &cursor, const QString &message, int &pos)
 {
     // extract the first word
     QString rest;
-    QString fullWordUpToSpaceOrEnd = extractNextWord(message, rest);
+    QString fullWordUpToSpaceOrEnd = extractNextWord(message, pos, rest);
 
     // check urls
     if (fullWordUpToSpaceOrEnd.startsWith("http://", Qt::CaseInsensitive) ||
@@ -397,52 +441,47 @@ void ChatView::checkWord(QTextCursor &cursor, QString &message)
         fullWordUpToSpaceOrEnd.startsWith("www.", Qt::CaseInsensitive)) {
         QUrl qUrl(fullWordUpToSpaceOrEnd);
         if (qUrl.isValid()) {
+            flushPendingText(cursor);
             appendUrlTag(cursor, fullWordUpToSpaceOrEnd);
-            cursor.insertText(rest, defaultFormat);
+            pendingText += rest;
             return;
         }
     }
 
     // check word mentions
-    for (const QString &word : highlightedWords) {
-        if (fullWordUpToSpaceOrEnd.compare(word, Qt::CaseInsensitive) == 0) {
-            // You have received a valid mention of custom word!!
-            highlightFormat.setBackground(QBrush(getCustomHighlightColor()));
-            highlightFormat.setForeground(SettingsCache::instance().getChatHighlightForeground() ? QBrush(Qt::white)
-                                                                                                 : QBrush(Qt::black));
-            cursor.insertText(fullWordUpToSpaceOrEnd, highlightFormat);
-            cursor.insertText(rest, defaultFormat);
-            QApplication::alert(this);
-            return;
-        }
+    if (!highlightedWords.isEmpty() && highlightedWords.contains(fullWordUpToSpaceOrEnd.toCaseFolded())) {
+        // You have received a valid mention of custom word!!
+        highlightFormat.setBackground(QBrush(getCustomHighlightColor()));
+        highlightFormat.setForeground(SettingsCache::instance().getChatHighlightForeground() ? QBrush(Qt::white)
+                                                                                             : QBrush(Qt::black));
+        flushPendingText(cursor);
+        cursor.insertText(fullWordUpToSpaceOrEnd, highlightFormat);
+        pendingText += rest;
+        QApplication::alert(this);
+        return;
     }
 
     // not a special word; just print it
-    cursor.insertText(fullWordUpToSpaceOrEnd + rest, defaultFormat);
+    pendingText += fullWordUpToSpaceOrEnd;
+    pendingText += rest;
 }
 
-QString ChatView::extractNextWord(QString &message, QString &rest)
+QString ChatView::extractNextWord(const QString &message, int &pos, QString &rest)
 {
     // get the first next space and extract the word
-    QString word;
-    int firstSpace = message.indexOf(' ');
-    if (firstSpace == -1) {
-        word = message;
-        message.clear();
-    } else {
-        word = message.mid(0, firstSpace);
-        message = message.mid(firstSpace);
-    }
+    const int wordStart = pos;
+    int firstSpace = message.indexOf(' ', pos);
+    pos = (firstSpace == -1) ? message.size() : firstSpace;
 
     // remove any punctuation from the end and pass it separately
-    for (int len = word.size() - 1; len >= 0; --len) {
-        if (word.at(len).isLetterOrNumber()) {
-            rest = word.mid(len + 1);
-            return word.mid(0, len + 1);
+    for (int end = pos; end > wordStart; --end) {
+        if (message.at(end - 1).isLetterOrNumber()) {
+            rest = message.mid(end, pos - end);
+            return message.mid(wordStart, end - wordStart);
         }
     }
 
-    rest = word;
+    rest = message.mid(wordStart, pos - wordStart);
     return QString();
 }
 
@@ -495,17 +534,45 @@ QColor ChatView::getCustomHighlightColor()
 void ChatView::clearChat()
 {
     document()->clear();
+    trimmedLength = 0;
     lastSender = "";
     evenNumber = true;
 }
 
+int ChatView::getChatLength() const
+{
+    return trimmedLength + document()->characterCount();
+}
+
+/**
+ * Removes what was added to the chat since it was getChatLength() long.
+ */
+void ChatView::truncateChat(int length)
+{
+    QTextCursor cursor(document());
+    cursor.setPosition(qBound(0, length - trimmedLength - 1, document()->characterCount() - 1));
+    cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+    const int lengthBefore = trimmedLength;
+    cursor.removeSelectedText();
+    trimmedLength = lengthBefore;
+
+    lastSender.clear();
+    // the backgrounds of the blocks alternate, starting on the base color after the first block
+    const QTextBlockFormat lastFormat = document()->lastBlock().blockFormat();
+    evenNumber = !lastFormat.hasProperty(QTextFormat::BackgroundBrush) || lastFormat.background() == palette().window();
+}
+
 void ChatView::redactMessages(const QString &userName, int amount)
 {
     auto &messagePositions = userMessagePositions[userName];
     bool removedLastMessage = false;
     QTextCursor cursor(document());
     for (; !messagePositions.isEmpty() && amount != 0; --amount) {
-        auto position = messagePositions.takeLast();   // go backwards from last message
+        auto position = messagePositions.takeLast(); // go backwards from last message
+        if (!position.block.isValid()) {
+            // the message was among the oldest blocks dropped from the document
+            break;
+        }
         cursor.setPosition(position.block.position()); // move to start of block, then continue to start of message
         cursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, position.relativePosition);
         cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor); // select until end of block
@@ -8,6 +8,7 @@
 
 #include <QAction>
 #include <QColor>
+#include <QSet>
 #include <QTextBrowser>
 #include <QTextCursor>
 #include <QTextFragment>
@@ -53,13 +54,18 @@ private:
     QTextCharFormat highlightFormat;
     QTextCharFormat mentionFormatOtherUser;
     QTextCharFormat defaultFormat;
-    QStringList highlightedWords;
+    // case folded, so that every word of a message is looked up once
+    QSet<QString> highlightedWords;
+    // the plain text parsed since the last formatted part, inserted in one piece before the next one
+    QString pendingText;
     bool evenNumber;
     bool showTimestamps;
     HoveredItemType hoveredItemType;
     QString hoveredContent;
     QAction *messageClicked;
     QMap<QString, QVector<UserMessagePosition>> userMessagePositions;
+    // the length of the oldest blocks dropped from the document, so that getChatLength() keeps counting from the start
+    int trimmedLength;
 
     QTextFragment getFragmentUnderMouse(const QPoint &pos) const;
     QTextCursor prepareBlock(bool same = false);
@@ -69,17 +75,26 @@ private:
     static QColor getCustomHighlightColor();
     void showSystemPopup(const QString &userName);
     bool isModeratorSendingGlobal(QFlags<ServerInfo_User::UserLevelFlag> userLevelFlag, QString message);
-    void checkTag(QTextCursor &cursor, QString &message);
-    void checkMention(QTextCursor &cursor, QString &message, const QString &userName, UserLevelFlags userLevel);
-    void checkWord(QTextCursor &cursor, QString &message);
-    QString extractNextWord(QString &message, QString &rest);
+    void flushPendingText(QTextCursor &cursor);
+    void checkTag(QTextCursor &cursor, const QString &message, int &pos);
+    void checkMention(QTextCursor &cursor,
+                      const QString &message,
+                      int &pos,
+                      const QString &userName,
+                      UserLevelFlags userLevel);
+    void checkWord(QTextCursor &cursor, const QString &message, int &pos);
+    QString extractNextWord(const QString &message, int &pos, QString &rest);
 
     QColor otherUserColor = QColor(0, 65, 255); // dark blue
+    // the oldest blocks are dropped beyond this, appending to a document gets slower the larger it is
+    static constexpr int MAX_BLOCK_COUNT = 10000;
+
     QColor serverMessageColor = QColor(0x85, 0x15, 0x15);
     QColor linkColor;
 
 private slots:
     void openLink(const QUrl &link);
+    void updateHighlightedWords();
     void actMessageClicked();
 
 public:
@@ -94,6 +109,8 @@ public:
                        const ServerInfo_User &userInfo = {},
                        bool playerBold = false);
     void clearChat();
+    int getChatLength() const;
+    void truncateChat(int length);
     void redactMessages(const QString &userName, int amount);
 
 protected:
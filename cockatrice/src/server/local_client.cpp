@@ -35,9 +35,9 @@ void LocalClient::sendCommandContainer(const CommandContainer &cont)
     lsi->itemFromClient(cont);
 }
 
-void LocalClient::itemFromServer(const ServerMessage &item)
+void LocalClient::itemFromServer(const ServerMessagePtr &item)
 {
-    qCDebug(LocalClientLog).noquote() << userName << "IN" << getSafeDebugString(item);
+    qCDebug(LocalClientLog).noquote() << userName << "IN" << getSafeDebugString(*item);
 
     processProtocolItem(item);
 }
@@ -24,7 +24,7 @@ public:
 
     void sendCommandContainer(const CommandContainer &cont) override;
 private slots:
-    void itemFromServer(const ServerMessage &item);
+    void itemFromServer(const ServerMessagePtr &item);
 };
 
 #endif
@@ -14,6 +14,12 @@ public:
     ~LocalServer() override;
 
     LocalServerInterface *newConnection();
+
+    // the local clients take the messages as they are
+    bool getSendsSerializedMessages() const override
+    {
+        return false;
+    }
 };
 
 class LocalServer_DatabaseInterface : public Server_DatabaseInterface
@@ -15,7 +15,41 @@ LocalServerInterface::~LocalServerInterface()
 
 void LocalServerInterface::transmitProtocolItem(const ServerMessage &item)
 {
-    emit itemToClient(item);
+    emit itemToClient(QSharedPointer<ServerMessage>::create(item));
+}
+
+// The items are copied straight into the message that is shared with the client, instead of into one that
+// transmitProtocolItem() would have to copy again.
+void LocalServerInterface::sendProtocolItem(const Response &item)
+{
+    auto message = QSharedPointer<ServerMessage>::create();
+    message->mutable_response()->CopyFrom(item);
+    message->set_message_type(ServerMessage::RESPONSE);
+    emit itemToClient(message);
+}
+
+void LocalServerInterface::sendProtocolItem(const SessionEvent &item)
+{
+    auto message = QSharedPointer<ServerMessage>::create();
+    message->mutable_session_event()->CopyFrom(item);
+    message->set_message_type(ServerMessage::SESSION_EVENT);
+    emit itemToClient(message);
+}
+
+void LocalServerInterface::sendProtocolItem(const GameEventContainer &item)
+{
+    auto message = QSharedPointer<ServerMessage>::create();
+    message->mutable_game_event_container()->CopyFrom(item);
+    message->set_message_type(ServerMessage::GAME_EVENT_CONTAINER);
+    emit itemToClient(message);
+}
+
+void LocalServerInterface::sendProtocolItem(const RoomEvent &item)
+{
+    auto message = QSharedPointer<ServerMessage>::create();
+    message->mutable_room_event()->CopyFrom(item);
+    message->set_message_type(ServerMessage::ROOM_EVENT);
+    emit itemToClient(message);
 }
 
 void LocalServerInterface::itemFromClient(const CommandContainer &item)
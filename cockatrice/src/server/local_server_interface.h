@@ -3,8 +3,14 @@
 
 #include "server_protocolhandler.h"
 
+#include <QSharedPointer>
+
 class LocalServer;
 
+/**
+ * The server side of a connection to a client of a local game. The messages for the client are handed over as they
+ * are, shared with every slot they are passed on to, instead of being serialized.
+ */
 class LocalServerInterface : public Server_ProtocolHandler
 {
     Q_OBJECT
@@ -21,8 +27,12 @@ public:
         return "local";
     };
     void transmitProtocolItem(const ServerMessage &item) override;
+    void sendProtocolItem(const Response &item) override;
+    void sendProtocolItem(const SessionEvent &item) override;
+    void sendProtocolItem(const GameEventContainer &item) override;
+    void sendProtocolItem(const RoomEvent &item) override;
 signals:
-    void itemToClient(const ServerMessage &item);
+    void itemToClient(const QSharedPointer<const ServerMessage> &item);
 public slots:
     void itemFromClient(const CommandContainer &item);
 };
@@ -139,24 +139,24 @@ void MessageLogWidget::logAttachCard(Player *player, QString cardName, Player *t
 
 void MessageLogWidget::logConcede(Player *player)
 {
-    soundEngine->playSound("player_concede");
+    playSound("player_concede");
     appendHtmlServerMessage(tr("%1 has conceded the game.").arg(sanitizeHtml(player->getName())), true);
 }
 
 void MessageLogWidget::logUnconcede(Player *player)
 {
-    soundEngine->playSound("player_concede");
+    playSound("player_concede");
     appendHtmlServerMessage(tr("%1 has unconceded the game.").arg(sanitizeHtml(player->getName())), true);
 }
 
 void MessageLogWidget::logConnectionStateChanged(Player *player, bool connectionState)
 {
     if (connectionState) {
-        soundEngine->playSound("player_reconnect");
+        playSound("player_reconnect");
         appendHtmlServerMessage(tr("%1 has restored connection to the game.").arg(sanitizeHtml(player->getName())),
                                 true);
     } else {
-        soundEngine->playSound("player_disconnect");
+        playSound("player_disconnect");
         appendHtmlServerMessage(tr("%1 has lost connection to the game.").arg(sanitizeHtml(player->getName())), true);
     }
 }
@@ -295,7 +295,7 @@ void MessageLogWidget::logMoveCard(Player *player,
     QString finalStr;
     std::optional<QString> fourthArg;
     if (targetZoneName == TABLE_ZONE_NAME) {
-        soundEngine->playSound("play_card");
+        playSound("play_card");
         if (card->getFaceDown()) {
             finalStr = tr("%1 puts %2 into play%3 face down.");
         } else {
@@ -322,7 +322,7 @@ void MessageLogWidget::logMoveCard(Player *player,
     } else if (targetZoneName == SIDEBOARD_ZONE_NAME) {
         finalStr = tr("%1 moves %2%3 to sideboard.");
     } else if (targetZoneName == STACK_ZONE_NAME) {
-        soundEngine->playSound("play_card");
+        playSound("play_card");
         finalStr = tr("%1 plays %2%3.");
     } else {
         fourthArg = targetZoneName;
@@ -340,7 +340,7 @@ void MessageLogWidget::logMoveCard(Player *player,
 
 void MessageLogWidget::logDrawCards(Player *player, int number, bool deckIsEmpty)
 {
-    soundEngine->playSound("draw_card");
+    playSound("draw_card");
     if (currentContext == MessageContext_Mulligan) {
         logMulligan(player, number);
     } else {
@@ -393,13 +393,13 @@ void MessageLogWidget::logGameStart()
 
 void MessageLogWidget::logJoin(Player *player)
 {
-    soundEngine->playSound("player_join");
+    playSound("player_join");
     appendHtmlServerMessage(tr("%1 has joined the game.").arg(sanitizeHtml(player->getName())));
 }
 
 void MessageLogWidget::logJoinSpectator(QString name)
 {
-    soundEngine->playSound("spectator_join");
+    playSound("spectator_join");
     appendHtmlServerMessage(tr("%1 is now watching the game.").arg(sanitizeHtml(std::move(name))));
 }
 
@@ -410,14 +410,14 @@ void MessageLogWidget::logKicked()
 
 void MessageLogWidget::logLeave(Player *player, QString reason)
 {
-    soundEngine->playSound("player_leave");
+    playSound("player_leave");
     appendHtmlServerMessage(
         tr("%1 has left the game (%2).").arg(sanitizeHtml(player->getName()), sanitizeHtml(std::move(reason))), true);
 }
 
 void MessageLogWidget::logLeaveSpectator(QString name, QString reason)
 {
-    soundEngine->playSound("spectator_leave");
+    playSound("spectator_leave");
     appendHtmlServerMessage(tr("%1 is not watching the game any more (%2).")
                                 .arg(sanitizeHtml(std::move(name)), sanitizeHtml(std::move(reason))));
 }
@@ -577,7 +577,7 @@ void MessageLogWidget::logRollDie(Player *player, int sides, const QList<uint> &
                                         .arg("<font class=\"blue\">" + rollsStrings.join(", ") + "</font>"));
         }
     }
-    soundEngine->playSound("roll_dice");
+    playSound("roll_dice");
 }
 
 void MessageLogWidget::logSay(Player *player, QString message)
@@ -589,7 +589,7 @@ void MessageLogWidget::logSetActivePhase(int phaseNumber)
 {
     Phase phase = Phases::getPhase(phaseNumber);
 
-    soundEngine->playSound(phase.soundFileName);
+    playSound(phase.soundFileName);
 
     appendHtml("<font color=\"" + phase.color + "\"><b>" + QDateTime::currentDateTime().toString("[hh:mm:ss] ") +
                phase.getName() + "</b></font>");
@@ -631,7 +631,7 @@ void MessageLogWidget::logSetCardCounter(Player *player, QString cardName, int c
 void MessageLogWidget::logSetCounter(Player *player, QString counterName, int value, int oldValue)
 {
     if (counterName == "life") {
-        soundEngine->playSound("life_change");
+        playSound("life_change");
     }
 
     QString counterDisplayName = TranslateCounterName::getDisplayName(counterName);
@@ -697,9 +697,9 @@ void MessageLogWidget::logSetTapped(Player *player, CardItem *card, bool tapped)
     }
 
     if (tapped) {
-        soundEngine->playSound("tap_card");
+        playSound("tap_card");
     } else {
-        soundEngine->playSound("untap_card");
+        playSound("untap_card");
     }
 
     QString str;
@@ -719,7 +719,7 @@ void MessageLogWidget::logShuffle(Player *player, CardZone *zone, int start, int
         return;
     }
 
-    soundEngine->playSound("shuffle");
+    playSound("shuffle");
     // start and end are indexes into the portion of the deck that was shuffled
     // with negitive numbers counging from the bottom up.
     if (start == 0 && end == -1) {
@@ -808,6 +808,19 @@ void MessageLogWidget::connectToPlayer(Player *player)
 }
 
 MessageLogWidget::MessageLogWidget(TabSupervisor *_tabSupervisor, TabGame *_game, QWidget *parent)
-    : ChatView(_tabSupervisor, _game, true, parent), currentContext(MessageContext_None)
+    : ChatView(_tabSupervisor, _game, true, parent), currentContext(MessageContext_None), presentationSuspended(false)
 {
 }
+
+void MessageLogWidget::setPresentationSuspended(bool suspended)
+{
+    presentationSuspended = suspended;
+    viewport()->setUpdatesEnabled(!suspended);
+}
+
+void MessageLogWidget::playSound(const QString &fileName)
+{
+    if (!presentationSuspended) {
+        soundEngine->playSound(fileName);
+    }
+}
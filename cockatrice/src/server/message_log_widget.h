@@ -23,6 +23,9 @@ private:
 
     MessageContext currentContext;
     QString messagePrefix, messageSuffix;
+    bool presentationSuspended;
+
+    void playSound(const QString &fileName);
 
     static QPair<QString, QString> getFromStr(CardZone *zone, QString cardName, int position, bool ownerChange);
 
@@ -91,6 +94,8 @@ public slots:
 public:
     void connectToPlayer(Player *player);
     MessageLogWidget(TabSupervisor *_tabSupervisor, TabGame *_game, QWidget *parent = nullptr);
+    // while suspended, the messages are still logged but neither painted nor played as sounds
+    void setPresentationSuspended(bool suspended);
 };
 
 #endif
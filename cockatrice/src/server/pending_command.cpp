@@ -23,6 +23,14 @@ QVariant PendingCommand::getExtraData() const
 void PendingCommand::processResponse(const Response &response)
 {
     emit finished(response, commandContainer, extraData);
+    for (PendingCommand *pend : batchedCommands)
+        pend->processResponse(response);
+}
+
+void PendingCommand::addBatchedCommand(PendingCommand *pend)
+{
+    pend->setParent(this);
+    batchedCommands.append(pend);
 }
 
 int PendingCommand::tick()
@@ -4,6 +4,7 @@
 #include "pb/commands.pb.h"
 #include "pb/response.pb.h"
 
+#include <QList>
 #include <QVariant>
 
 class PendingCommand : public QObject
@@ -16,6 +17,8 @@ private:
     CommandContainer commandContainer;
     QVariant extraData;
     int ticks;
+    // sent in the same command container, they get the response of this one
+    QList<PendingCommand *> batchedCommands;
 
 public:
     explicit PendingCommand(const CommandContainer &_commandContainer, QVariant _extraData = QVariant());
@@ -23,6 +26,10 @@ public:
     void setExtraData(const QVariant &_extraData);
     QVariant getExtraData() const;
     void processResponse(const Response &response);
+    /**
+     * Takes ownership of a command that is sent together with this one.
+     */
+    void addBatchedCommand(PendingCommand *pend);
     int tick();
 };
 
@@ -4,6 +4,9 @@
 #include "../../settings/cache_settings.h"
 #include "../pending_command.h"
 #include "debug_pb_message.h"
+#include "message_batching.h"
+#include "message_compression.h"
+#include "message_framing.h"
 #include "passwordhasher.h"
 #include "pb/event_server_identification.pb.h"
 #include "pb/response_activate.pb.h"
@@ -27,8 +30,8 @@
 static const unsigned int protocolVersion = 14;
 
 RemoteClient::RemoteClient(QObject *parent)
-    : AbstractClient(parent), timeRunning(0), lastDataReceived(0), messageInProgress(false), handshakeStarted(false),
-      usingWebSocket(false), messageLength(0), hashedPassword()
+    : AbstractClient(parent), timeRunning(0), lastDataReceived(0), messageInProgress(false), messageCompressed(false),
+      handshakeStarted(false), usingVarintFrames(false), usingWebSocket(false), messageLength(0), hashedPassword()
 {
 
     clearNewClientFeatures();
@@ -379,13 +382,15 @@ void RemoteClient::readData()
                         messageInProgress = true;
                         messageLength = 60;
                     }
-                } else {
                     // end of hack
-                    messageLength = (((quint32)(unsigned char)inputBuffer[0]) << 24) +
-                                    (((quint32)(unsigned char)inputBuffer[1]) << 16) +
-                                    (((quint32)(unsigned char)inputBuffer[2]) << 8) +
-                                    ((quint32)(unsigned char)inputBuffer[3]);
-                    inputBuffer.remove(0, 4);
+                } else if (*inputBuffer.data() == MessageFraming::frameMarker) {
+                    if (!readFrame())
+                        return;
+                    continue;
+                } else {
+                    inputBuffer.takeLength(messageLength);
+                    messageCompressed = MessageCompression::isCompressedFrame(messageLength);
+                    messageLength = MessageCompression::payloadLength(messageLength);
                     messageInProgress = true;
                 }
             } else
@@ -394,30 +399,82 @@ void RemoteClient::readData()
         if (inputBuffer.size() < messageLength)
             return;
 
-        ServerMessage newServerMessage;
-        newServerMessage.ParseFromArray(inputBuffer.data(), messageLength);
-
-        qCDebug(RemoteClientLog).noquote() << "IN" << getSafeDebugString(newServerMessage);
+        auto newServerMessage = QSharedPointer<ServerMessage>::create();
+        bool validMessage = parseServerMessage(*newServerMessage, inputBuffer.data(), messageLength, messageCompressed);
 
-        inputBuffer.remove(0, messageLength);
+        inputBuffer.skip(messageLength);
         messageInProgress = false;
+        messageCompressed = false;
 
-        processProtocolItem(newServerMessage);
+        if (validMessage)
+            processProtocolItem(newServerMessage);
 
         if (getStatus() == StatusDisconnecting) // use thread-safe getter
             doDisconnectFromServer();
     } while (!inputBuffer.isEmpty());
 }
 
+// Handles the frame at the start of the input buffer; returns false if it isn't complete yet, or is malformed.
+bool RemoteClient::readFrame()
+{
+    QList<QByteArray> serverMessages;
+    const int frameSize = MessageFraming::unpack(inputBuffer.data(), inputBuffer.size(), serverMessages);
+    if (frameSize == 0)
+        return false;
+    if (frameSize < 0) {
+        // there is no telling where the next frame starts
+        qCWarning(RemoteClientLog) << "Disconnecting after a malformed frame";
+        inputBuffer.clear();
+        doDisconnectFromServer();
+        return false;
+    }
+
+    inputBuffer.skip(frameSize);
+    // the server knows the framing, so the commands are sent the same way from now on
+    usingVarintFrames = true;
+    for (const QByteArray &serverMessage : serverMessages) {
+        auto newServerMessage = QSharedPointer<ServerMessage>::create();
+        if (parseServerMessage(*newServerMessage, serverMessage.data(), serverMessage.size(), false))
+            processProtocolItem(newServerMessage);
+        if (getStatus() == StatusDisconnecting) {
+            doDisconnectFromServer();
+            return false;
+        }
+    }
+    return true;
+}
+
 void RemoteClient::websocketMessageReceived(const QByteArray &message)
 {
     lastDataReceived = timeRunning;
-    ServerMessage newServerMessage;
-    newServerMessage.ParseFromArray(message.data(), message.length());
+    QList<QByteArray> serverMessages;
+    if (!MessageBatching::unpack(message, serverMessages)) {
+        qCWarning(RemoteClientLog) << "Dropping invalid websocket message of size" << message.size();
+        return;
+    }
 
-    qCDebug(RemoteClientLog).noquote() << "IN" << getSafeDebugString(newServerMessage);
+    for (const QByteArray &serverMessage : serverMessages) {
+        auto newServerMessage = QSharedPointer<ServerMessage>::create();
+        if (parseServerMessage(*newServerMessage, serverMessage.data(), serverMessage.size(), false))
+            processProtocolItem(newServerMessage);
+    }
+}
 
-    processProtocolItem(newServerMessage);
+bool RemoteClient::parseServerMessage(ServerMessage &message, const char *data, int size, bool compressed)
+{
+    if (compressed) {
+        QByteArray uncompressed;
+        if (!MessageCompression::uncompress(data, size, uncompressed)) {
+            qCWarning(RemoteClientLog) << "Dropping invalid compressed message of size" << size;
+            return false;
+        }
+        message.ParseFromArray(uncompressed.constData(), uncompressed.size());
+    } else {
+        message.ParseFromArray(data, size);
+    }
+
+    qCDebug(RemoteClientLog).noquote() << "IN" << getSafeDebugString(message);
+    return true;
 }
 
 void RemoteClient::sendCommandContainer(const CommandContainer &cont)
@@ -435,6 +492,12 @@ void RemoteClient::sendCommandContainer(const CommandContainer &cont)
         buf.resize(size);
         cont.SerializeToArray(buf.data(), size);
         websocket->sendBinaryMessage(buf);
+    } else if (usingVarintFrames) {
+        buf.resize(size);
+        cont.SerializeToArray(buf.data(), size);
+        QByteArray frame;
+        MessageFraming::pack({buf}, 0, 0, frame);
+        socket->write(frame);
     } else {
         buf.resize(size + 4);
         cont.SerializeToArray(buf.data() + 4, size);
@@ -513,7 +576,9 @@ void RemoteClient::doDisconnectFromServer()
     timer->stop();
 
     messageInProgress = false;
+    messageCompressed = false;
     handshakeStarted = false;
+    usingVarintFrames = false;
     messageLength = 0;
 
     QList<PendingCommand *> pc = pendingCommands.values();
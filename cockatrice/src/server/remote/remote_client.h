@@ -2,6 +2,7 @@
 #define REMOTECLIENT_H
 
 #include "../../client/game_logic/abstract_client.h"
+#include "framed_input_buffer.h"
 #include "pb/commands.pb.h"
 
 #include <QLoggingCategory>
@@ -93,9 +94,12 @@ private slots:
 private:
     int maxTimeout;
     int timeRunning, lastDataReceived;
-    QByteArray inputBuffer;
+    FramedInputBuffer inputBuffer;
     bool messageInProgress;
+    bool messageCompressed;
     bool handshakeStarted;
+    // set once the server sent a frame of the varint framing, see MessageFraming
+    bool usingVarintFrames;
     bool usingWebSocket;
     int messageLength;
     QTimer *timer;
@@ -109,6 +113,8 @@ private:
     bool newMissingFeatureFound(const QString &_serversMissingFeatures);
     void clearNewClientFeatures();
     void connectToHost(const QString &hostname, unsigned int port);
+    bool parseServerMessage(ServerMessage &message, const char *data, int size, bool compressed);
+    bool readFrame();
 
 protected slots:
     void sendCommandContainer(const CommandContainer &cont) override;
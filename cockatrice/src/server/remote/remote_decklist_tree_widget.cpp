@@ -275,16 +275,39 @@ void RemoteDeckList_TreeModel::clearTree()
     endResetModel();
 }
 
+/**
+ * Adds the items of folder to node, without notifying the views.
+ */
+void RemoteDeckList_TreeModel::buildFolder(const ServerInfo_DeckStorage_Folder &folder, DirectoryNode *node)
+{
+    const int folderItemsSize = folder.items_size();
+    node->reserve(node->size() + folderItemsSize);
+    for (int i = 0; i < folderItemsSize; ++i) {
+        const ServerInfo_DeckStorage_TreeItem &item = folder.items(i);
+        const QString name = QString::fromStdString(item.name());
+        if (item.has_folder()) {
+            auto *subfolder = new DirectoryNode(name, node);
+            node->append(subfolder);
+            buildFolder(item.folder(), subfolder);
+        } else {
+            QDateTime time;
+            time.setSecsSinceEpoch(item.file().creation_time());
+            node->append(new FileNode(name, item.id(), time, node));
+        }
+    }
+}
+
 void RemoteDeckList_TreeModel::deckListFinished(const Response &r)
 {
     const Response_DeckList &resp = r.GetExtension(Response_DeckList::ext);
 
-    clearTree();
-
-    ServerInfo_DeckStorage_TreeItem tempRoot;
-    tempRoot.set_id(0);
-    tempRoot.mutable_folder()->CopyFrom(resp.root());
-    addFolderToTree(tempRoot, root);
+    // the views and the sorting proxy take the new tree in one reset, instead of one insertion per deck
+    beginResetModel();
+    root->clearTree();
+    DirectoryNode *newRoot = new DirectoryNode(QString(), root);
+    root->append(newRoot);
+    buildFolder(resp.root(), newRoot);
+    endResetModel();
 
     emit treeRefreshed();
 }
@@ -8,6 +8,7 @@
 class Response;
 class AbstractClient;
 class QSortFilterProxyModel;
+class ServerInfo_DeckStorage_Folder;
 class ServerInfo_DeckStorage_TreeItem;
 
 class RemoteDeckList_TreeModel : public QAbstractItemModel
@@ -81,6 +82,7 @@ private:
     QIcon fileIcon, dirIcon;
 
     QModelIndex nodeToIndex(Node *node) const;
+    static void buildFolder(const ServerInfo_DeckStorage_Folder &folder, DirectoryNode *node);
 signals:
     void treeRefreshed();
 private slots:
@@ -3,6 +3,7 @@
 #include "../../client/game_logic/abstract_client.h"
 #include "../pending_command.h"
 #include "pb/command_replay_list.pb.h"
+#include "pb/commands.pb.h"
 #include "pb/response_replay_list.pb.h"
 #include "pb/serverinfo_replay.pb.h"
 
@@ -11,6 +12,7 @@
 #include <QSortFilterProxyModel>
 
 const int RemoteReplayList_TreeModel::numberOfColumns = 6;
+const int RemoteReplayList_TreeModel::matchesPageSize = 100;
 
 RemoteReplayList_TreeModel::MatchNode::MatchNode(const ServerInfo_ReplayMatch &_matchInfo)
     : RemoteReplayList_TreeModel::Node(QString::fromStdString(_matchInfo.game_name())), matchInfo(_matchInfo)
@@ -31,7 +33,8 @@ void RemoteReplayList_TreeModel::MatchNode::updateMatchInfo(const ServerInfo_Rep
 }
 
 RemoteReplayList_TreeModel::RemoteReplayList_TreeModel(AbstractClient *_client, QObject *parent)
-    : QAbstractItemModel(parent), client(_client)
+    : QAbstractItemModel(parent), client(_client), moreMatches(false), fetchingMatches(false), nextBeforeTime(0),
+      nextBeforeGameId(0), generation(0)
 {
     QFileIconProvider fip;
     dirIcon = fip.icon(QFileIconProvider::Folder);
@@ -252,14 +255,47 @@ void RemoteReplayList_TreeModel::clearAll()
 
 void RemoteReplayList_TreeModel::refreshTree()
 {
-    PendingCommand *pend = client->prepareSessionCommand(Command_ReplayList());
+    Command_ReplayList cmd;
+    cmd.set_max_matches(matchesPageSize);
+
+    PendingCommand *pend = client->prepareSessionCommand(cmd);
+    pend->setExtraData(++generation);
     connect(pend, &PendingCommand::finished, this, &RemoteReplayList_TreeModel::replayListFinished);
+    fetchingMatches = true;
+
+    client->sendCommand(pend);
+}
+
+bool RemoteReplayList_TreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && moreMatches && !fetchingMatches;
+}
+
+void RemoteReplayList_TreeModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    Command_ReplayList cmd;
+    cmd.set_max_matches(matchesPageSize);
+    cmd.set_before_time(nextBeforeTime);
+    cmd.set_before_game_id(nextBeforeGameId);
+
+    PendingCommand *pend = client->prepareSessionCommand(cmd);
+    pend->setExtraData(generation);
+    connect(pend, &PendingCommand::finished, this, &RemoteReplayList_TreeModel::replayListFinished);
+    fetchingMatches = true;
 
     client->sendCommand(pend);
 }
 
 void RemoteReplayList_TreeModel::clearTree()
 {
+    // a page still on its way belongs to the list that is gone
+    ++generation;
+    moreMatches = false;
+    fetchingMatches = false;
+
     beginResetModel();
     clearAll();
     endResetModel();
@@ -296,9 +332,31 @@ void RemoteReplayList_TreeModel::removeMatchInfo(int gameId)
         }
 }
 
-void RemoteReplayList_TreeModel::replayListFinished(const Response &r)
+void RemoteReplayList_TreeModel::replayListFinished(const Response &r,
+                                                    const CommandContainer &commandContainer,
+                                                    const QVariant &extraData)
 {
+    if (extraData.toInt() != generation)
+        return;
+    fetchingMatches = false;
+
     const Response_ReplayList &resp = r.GetExtension(Response_ReplayList::ext);
+    // servers that don't know about pages send all matches at once
+    moreMatches = resp.has_next_before_game_id();
+    nextBeforeTime = resp.next_before_time();
+    nextBeforeGameId = resp.next_before_game_id();
+
+    const bool olderPage =
+        commandContainer.session_command(0).GetExtension(Command_ReplayList::ext).has_before_game_id();
+    if (olderPage) {
+        if (resp.match_list_size() == 0)
+            return;
+        beginInsertRows(QModelIndex(), replayMatches.size(), replayMatches.size() + resp.match_list_size() - 1);
+        for (int i = 0; i < resp.match_list_size(); ++i)
+            replayMatches.append(new MatchNode(resp.match_list(i)));
+        endInsertRows();
+        return;
+    }
 
     beginResetModel();
     clearAll();
@@ -323,8 +381,9 @@ RemoteReplayList_TreeWidget::RemoteReplayList_TreeWidget(AbstractClient *_client
     header()->setStretchLastSection(false);
     setUniformRowHeights(true);
     setSortingEnabled(true);
-    proxyModel->sort(0, Qt::AscendingOrder);
-    header()->setSortIndicator(0, Qt::AscendingOrder);
+    // the newest matches on top, the older ones are fetched when scrolling down
+    proxyModel->sort(0, Qt::DescendingOrder);
+    header()->setSortIndicator(0, Qt::DescendingOrder);
     setSelectionMode(QAbstractItemView::ExtendedSelection);
 }
 
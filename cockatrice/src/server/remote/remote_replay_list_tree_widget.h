@@ -8,8 +8,9 @@
 #include <QDateTime>
 #include <QTreeView>
 
-class Response;
 class AbstractClient;
+class CommandContainer;
+class Response;
 class QSortFilterProxyModel;
 
 class RemoteReplayList_TreeModel : public QAbstractItemModel
@@ -71,15 +72,20 @@ private:
 
     AbstractClient *client;
     QList<MatchNode *> replayMatches;
+    // where the next page of older matches starts; the pages of an earlier refresh are dropped by their generation
+    bool moreMatches, fetchingMatches;
+    quint32 nextBeforeTime, nextBeforeGameId;
+    int generation;
 
     QIcon dirIcon, fileIcon, lockIcon;
     void clearAll();
 
     static const int numberOfColumns;
+    static const int matchesPageSize;
 signals:
     void treeRefreshed();
 private slots:
-    void replayListFinished(const Response &r);
+    void replayListFinished(const Response &r, const CommandContainer &commandContainer, const QVariant &extraData);
 
 public:
     explicit RemoteReplayList_TreeModel(AbstractClient *_client, QObject *parent = nullptr);
@@ -94,6 +100,9 @@ public:
     QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
     QModelIndex parent(const QModelIndex &index) const override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
+    // the older matches are requested a page at a time once the view scrolls down to them
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
     void clearTree();
     void refreshTree();
     ServerInfo_Replay const *getReplay(const QModelIndex &index) const;
@@ -0,0 +1,41 @@
+#include "avatar_cache.h"
+
+#include "../../settings/cache_settings.h"
+#include "avatar_hash.h"
+
+#include <QDir>
+#include <QFile>
+
+namespace AvatarCache
+{
+
+static QString filePath(const QByteArray &hash)
+{
+    return SettingsCache::instance().getAvatarCachePath() + QString::fromLatin1(hash.toHex());
+}
+
+QByteArray find(const QByteArray &hash)
+{
+    if (hash.isEmpty())
+        return {};
+
+    QFile file(filePath(hash));
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    const QByteArray avatar = file.readAll();
+    // a broken file is downloaded again
+    return AvatarHash::hashOf(avatar) == hash ? avatar : QByteArray();
+}
+
+void insert(const QByteArray &avatar)
+{
+    if (avatar.isEmpty())
+        return;
+
+    QDir().mkpath(SettingsCache::instance().getAvatarCachePath());
+    QFile file(filePath(AvatarHash::hashOf(avatar)));
+    if (file.open(QIODevice::WriteOnly))
+        file.write(avatar);
+}
+
+} // namespace AvatarCache
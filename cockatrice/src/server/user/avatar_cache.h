@@ -0,0 +1,19 @@
+#ifndef COCKATRICE_AVATAR_CACHE_H
+#define COCKATRICE_AVATAR_CACHE_H
+
+#include <QByteArray>
+
+/**
+ * The avatars downloaded with Command_GetAvatar, kept on disk by their hash, see AvatarHash.
+ *
+ * A changed avatar has another hash, so the entries never go stale; they are only dropped along with the rest of
+ * the cache directory.
+ */
+namespace AvatarCache
+{
+// an empty array if the avatar isn't cached
+QByteArray find(const QByteArray &hash);
+void insert(const QByteArray &avatar);
+} // namespace AvatarCache
+
+#endif
@@ -7,7 +7,9 @@
 #include "../../dialogs/dlg_edit_password.h"
 #include "../../dialogs/dlg_edit_user.h"
 #include "../pending_command.h"
+#include "avatar_cache.h"
 #include "passwordhasher.h"
+#include "pb/response_get_avatar.pb.h"
 #include "pb/response_get_user_info.pb.h"
 #include "pb/serverinfo_user.pb.h"
 #include "pb/session_commands.pb.h"
@@ -100,8 +102,14 @@ void UserInfoBox::updateInfo(const ServerInfo_User &user)
 
     const UserLevelFlags userLevel(user.user_level());
 
-    const std::string &bmp = user.avatar_bmp();
-    if (!avatarPixmap.loadFromData((const uchar *)bmp.data(), static_cast<uint>(bmp.size()))) {
+    QByteArray bmp = QByteArray::fromStdString(user.avatar_bmp());
+    if (bmp.isEmpty() && user.has_avatar_hash()) {
+        // the server only sent the hash, the avatar is downloaded unless it already was
+        bmp = AvatarCache::find(QByteArray::fromStdString(user.avatar_hash()));
+        if (bmp.isEmpty())
+            requestAvatar(QString::fromStdString(user.name()));
+    }
+    if (!avatarPixmap.loadFromData(bmp)) {
         avatarPixmap = createDefaultAvatar(64, user);
         hasAvatar = false;
     } else {
@@ -190,6 +198,34 @@ void UserInfoBox::updateInfo(const QString &userName)
     client->sendCommand(pend);
 }
 
+void UserInfoBox::requestAvatar(const QString &userName)
+{
+    Command_GetAvatar cmd;
+    cmd.set_user_name(userName.toStdString());
+
+    PendingCommand *pend = client->prepareSessionCommand(cmd);
+    pend->setExtraData(userName);
+    connect(pend, &PendingCommand::finished, this, &UserInfoBox::processGetAvatarResponse);
+
+    client->sendCommand(pend);
+}
+
+void UserInfoBox::processGetAvatarResponse(const Response &r,
+                                           const CommandContainer & /* commandContainer */,
+                                           const QVariant &extraData)
+{
+    if (r.response_code() != Response::RespOk)
+        return;
+
+    const QByteArray avatar = QByteArray::fromStdString(r.GetExtension(Response_GetAvatar::ext).avatar_bmp());
+    AvatarCache::insert(avatar);
+    // the box might show another user by now
+    if (extraData.toString() != nameLabel.text() || !avatarPixmap.loadFromData(avatar))
+        return;
+    hasAvatar = true;
+    avatarPic.setPixmap(avatarPixmap.scaled(avatarPic.size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+}
+
 void UserInfoBox::processResponse(const Response &r)
 {
     const Response_GetUserInfo &response = r.GetExtension(Response_GetUserInfo::ext);
@@ -4,10 +4,12 @@
 #include <QDateTime>
 #include <QLabel>
 #include <QPushButton>
+#include <QVariant>
 #include <QWidget>
 
 class ServerInfo_User;
 class AbstractClient;
+class CommandContainer;
 class Response;
 
 class UserInfoBox : public QWidget
@@ -24,6 +26,7 @@ private:
     const ServerInfo_User *currentUserInfo;
 
     static QString getAgeString(int ageSeconds);
+    void requestAvatar(const QString &userName);
 
 public:
     UserInfoBox(AbstractClient *_client, bool editable, QWidget *parent = nullptr, Qt::WindowFlags flags = {});
@@ -40,6 +43,8 @@ private slots:
     void processEditResponse(const Response &r);
     void processPasswordResponse(const Response &r);
     void processAvatarResponse(const Response &r);
+    void
+    processGetAvatarResponse(const Response &r, const CommandContainer &commandContainer, const QVariant &extraData);
 
     void actEdit();
     void actEditInternal(const Response &r);
@@ -50,7 +50,20 @@ void UserListManager::setOwnUserInfo(const ServerInfo_User &userInfo)
 
 void UserListManager::populateInitialOnlineUsers()
 {
-    PendingCommand *pend = client->prepareSessionCommand(Command_ListUsers());
+    requestOnlineUsers(QString());
+}
+
+void UserListManager::requestOnlineUsers(const QString &afterName)
+{
+    Command_ListUsers cmd;
+    cmd.set_max_users(onlineUsersPageSize);
+    // the joins and leaves are subscribed to with the first page, later pages can't miss any
+    if (!afterName.isEmpty()) {
+        cmd.set_after_name(afterName.toStdString());
+        cmd.set_subscribe(false);
+    }
+
+    PendingCommand *pend = client->prepareSessionCommand(cmd);
     connect(pend, &PendingCommand::finished, this, &UserListManager::processListUsersResponse);
     client->sendCommand(pend);
 }
@@ -65,6 +78,9 @@ void UserListManager::processListUsersResponse(const Response &response)
         const QString &userName = QString::fromStdString(info.name());
         onlineUsers.insert(userName, info);
     }
+    // servers that don't know about pages send all users at once
+    if (resp.has_next_after_name())
+        requestOnlineUsers(QString::fromStdString(resp.next_after_name()));
 }
 
 void UserListManager::processUserJoinedEvent(const Event_UserJoined &event)
@@ -26,6 +26,8 @@ private:
     ServerInfo_User *ownUserInfo;
     QMap<QString, ServerInfo_User> onlineUsers, buddyUsers, ignoredUsers;
 
+    void requestOnlineUsers(const QString &afterName);
+
 private slots:
     void setOwnUserInfo(const ServerInfo_User &userInfo);
     void populateInitialOnlineUsers();
@@ -38,6 +40,9 @@ private slots:
     void processRemoveFromListEvent(const Event_RemoveFromList &event);
 
 public:
+    // the users are listed a page at a time, so that a busy server doesn't send thousands of them in one response
+    static constexpr int onlineUsersPageSize = 500;
+
     explicit UserListManager(AbstractClient *_client, QObject *parent = nullptr);
     ~UserListManager() override;
 
@@ -0,0 +1,232 @@
+#include "user_list_model.h"
+
+#include "../../client/ui/pixel_map_generator.h"
+#include "user_level.h"
+
+#include <QApplication>
+#include <QBrush>
+#include <QIcon>
+#include <QPalette>
+#include <algorithm>
+
+UserListModel::UserListModel(QObject *parent) : QAbstractTableModel(parent), onlineCount(0)
+{
+}
+
+/**
+ * Sort Users in the following order
+ * 1) Online Users > Offline Users
+ * 2) Admins, judge/vip/donator status ignored
+ * 3) Moderators, judge/vip/donator status ignored
+ * 4) Judges
+ * 5) VIPs
+ * 6) Donators
+ * 7) Everyone else
+ * @param lhs LHS to compare
+ * @param rhs RHS to compare to
+ * @return Left is less than the Right
+ */
+bool UserListModel::lessThan(const Entry &lhs, const Entry &rhs)
+{
+    // Sort by online/offline
+    if (lhs.online != rhs.online) {
+        return lhs.online;
+    }
+
+    const auto &lhsUserLevelFlags = UserLevelFlags(lhs.userInfo.user_level());
+    const auto &rhsUserLevelFlags = UserLevelFlags(rhs.userInfo.user_level());
+
+    // Admins & Mods need no additional comparison checks, just to see if they're an admin or a moderator
+    static const QList<ServerInfo_User_UserLevelFlag> userLevelWithNoOtherPrefOrder = {
+        ServerInfo_User_UserLevelFlag_IsAdmin, ServerInfo_User_UserLevelFlag_IsModerator};
+    for (const auto &userLevelEntry : userLevelWithNoOtherPrefOrder) {
+        if (lhsUserLevelFlags.testFlag(userLevelEntry) &&
+            lhsUserLevelFlags.testFlag(userLevelEntry) == rhsUserLevelFlags.testFlag(userLevelEntry)) {
+            return QString::localeAwareCompare(lhs.name, rhs.name) < 0;
+        } else if (lhsUserLevelFlags.testFlag(userLevelEntry) != rhsUserLevelFlags.testFlag(userLevelEntry)) {
+            return lhsUserLevelFlags.testFlag(userLevelEntry) > rhsUserLevelFlags.testFlag(userLevelEntry);
+        }
+    }
+
+    // Judges can be sorted by their additional ranks
+    static const QList<ServerInfo_User_UserLevelFlag> userLevelOrder = {ServerInfo_User_UserLevelFlag_IsJudge,
+                                                                        ServerInfo_User_UserLevelFlag_IsRegistered,
+                                                                        ServerInfo_User_UserLevelFlag_IsUser};
+    for (const auto &userLevelEntry : userLevelOrder) {
+        if (lhsUserLevelFlags.testFlag(userLevelEntry) != rhsUserLevelFlags.testFlag(userLevelEntry)) {
+            return lhsUserLevelFlags.testFlag(userLevelEntry) > rhsUserLevelFlags.testFlag(userLevelEntry);
+        }
+    }
+
+    // Sort by VIP > Donator > None
+    static const QMap<QString, int> privilegeOrder = {{"VIP", 3}, {"DONATOR", 2}, {"NONE", 1}, {"UNKNOWN", 0}};
+    const auto &lhsUserPrivLevel = privilegeOrder.value(QString::fromStdString(lhs.userInfo.privlevel()), 0);
+    const auto &rhsUserPrivLevel = privilegeOrder.value(QString::fromStdString(rhs.userInfo.privlevel()), 0);
+    if (lhsUserPrivLevel != rhsUserPrivLevel) {
+        return lhsUserPrivLevel > rhsUserPrivLevel;
+    }
+
+    // Sort by name
+    return QString::localeAwareCompare(lhs.name, rhs.name) < 0;
+}
+
+int UserListModel::insertPosition(const Entry &entry) const
+{
+    auto position = std::lower_bound(rows.constBegin(), rows.constEnd(), entry,
+                                     [this](const QString &name, const Entry &other) {
+                                         return lessThan(users.find(name).value(), other);
+                                     });
+    return static_cast<int>(position - rows.constBegin());
+}
+
+int UserListModel::rowOf(const QString &userName) const
+{
+    auto entry = users.constFind(userName);
+    if (entry == users.constEnd()) {
+        return -1;
+    }
+
+    // users comparing equal to this one, if any, are right next to it
+    for (int row = insertPosition(*entry); row < rows.size(); ++row) {
+        if (rows[row] == userName) {
+            return row;
+        }
+        if (lessThan(*entry, users.find(rows[row]).value())) {
+            break;
+        }
+    }
+    return -1;
+}
+
+void UserListModel::placeUser(int oldRow)
+{
+    // the user at oldRow has been changed, find where it goes among the others
+    const QString userName = rows.takeAt(oldRow);
+    const int newRow = insertPosition(users.find(userName).value());
+    rows.insert(oldRow, userName);
+
+    if (newRow != oldRow) {
+        beginMoveRows(QModelIndex(), oldRow, oldRow, QModelIndex(), newRow > oldRow ? newRow + 1 : newRow);
+        rows.move(oldRow, newRow);
+        endMoveRows();
+    }
+    emit dataChanged(index(newRow, 0), index(newRow, NUM_COLS - 1));
+}
+
+QVariant UserListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size() || index.column() >= NUM_COLS)
+        return QVariant();
+
+    const Entry &entry = users.find(rows[index.row()]).value();
+    switch (index.column()) {
+        case 0:
+            if (role == Qt::DecorationRole)
+                return UserLevelPixmapGenerator::generateIcon(18, UserLevelFlags(entry.userInfo.user_level()),
+                                                              entry.userInfo.pawn_colors(), false,
+                                                              QString::fromStdString(entry.userInfo.privlevel()));
+            break;
+        case 1:
+            if (role == Qt::DecorationRole)
+                return QIcon(
+                    CountryPixmapGenerator::generatePixmap(18, QString::fromStdString(entry.userInfo.country())));
+            break;
+        case 2:
+            if (role == Qt::DisplayRole)
+                return entry.name;
+            if (role == Qt::ForegroundRole)
+                return entry.online ? qApp->palette().brush(QPalette::WindowText) : QBrush(Qt::gray);
+            break;
+    }
+    return QVariant();
+}
+
+const ServerInfo_User *UserListModel::getUserInfo(const QString &userName) const
+{
+    auto entry = users.constFind(userName);
+    return entry == users.constEnd() ? nullptr : &entry->userInfo;
+}
+
+const ServerInfo_User &UserListModel::getUserInfo(int row) const
+{
+    Q_ASSERT(row < rows.size());
+    return users.find(rows[row])->userInfo;
+}
+
+bool UserListModel::isOnline(int row) const
+{
+    Q_ASSERT(row < rows.size());
+    return users.find(rows[row])->online;
+}
+
+void UserListModel::processUserInfo(const ServerInfo_User &user, bool online)
+{
+    const QString userName = QString::fromStdString(user.name());
+    const int row = rowOf(userName);
+    if (row != -1) {
+        Entry &entry = users[userName];
+        if (entry.online != online)
+            onlineCount += online ? 1 : -1;
+        entry.userInfo = user;
+        entry.online = online;
+        placeUser(row);
+        return;
+    }
+
+    const Entry entry{user, userName, online};
+    const int newRow = insertPosition(entry);
+    beginInsertRows(QModelIndex(), newRow, newRow);
+    users.insert(userName, entry);
+    rows.insert(newRow, userName);
+    endInsertRows();
+    if (online)
+        ++onlineCount;
+}
+
+void UserListModel::setUsers(const QList<ServerInfo_User> &userList, bool online)
+{
+    beginResetModel();
+    users.clear();
+    rows.clear();
+    for (const ServerInfo_User &user : userList) {
+        const QString userName = QString::fromStdString(user.name());
+        if (!users.contains(userName))
+            rows.append(userName);
+        users.insert(userName, {user, userName, online});
+    }
+    std::sort(rows.begin(), rows.end(), [this](const QString &lhs, const QString &rhs) {
+        return lessThan(users.find(lhs).value(), users.find(rhs).value());
+    });
+    onlineCount = online ? users.size() : 0;
+    endResetModel();
+}
+
+bool UserListModel::deleteUser(const QString &userName)
+{
+    const int row = rowOf(userName);
+    if (row == -1)
+        return false;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    if (users.find(userName)->online)
+        --onlineCount;
+    rows.removeAt(row);
+    users.remove(userName);
+    endRemoveRows();
+    return true;
+}
+
+void UserListModel::setUserOnline(const QString &userName, bool online)
+{
+    const int row = rowOf(userName);
+    if (row == -1)
+        return;
+
+    Entry &entry = users[userName];
+    if (entry.online == online)
+        return;
+
+    entry.online = online;
+    onlineCount += online ? 1 : -1;
+    placeUser(row);
+}
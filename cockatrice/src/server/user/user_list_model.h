@@ -0,0 +1,80 @@
+#ifndef USER_LIST_MODEL_H
+#define USER_LIST_MODEL_H
+
+#include "pb/serverinfo_user.pb.h"
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+/**
+ * The users of a UserListWidget, kept sorted at all times: a user joining or changing is moved to its place with a
+ * binary search instead of sorting the whole list again.
+ *
+ * The level and country icons are only generated when a view asks for them, i.e. for the rows it shows.
+ */
+class UserListModel : public QAbstractTableModel
+{
+    Q_OBJECT
+private:
+    struct Entry
+    {
+        ServerInfo_User userInfo;
+        QString name;
+        bool online;
+    };
+
+    QHash<QString, Entry> users;
+    // the names of the users, in the order they are shown
+    QVector<QString> rows;
+    int onlineCount;
+
+    static const int NUM_COLS = 3;
+
+    static bool lessThan(const Entry &lhs, const Entry &rhs);
+    int insertPosition(const Entry &entry) const;
+    int rowOf(const QString &userName) const;
+    void placeUser(int oldRow);
+
+public:
+    explicit UserListModel(QObject *parent = nullptr);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : rows.size();
+    }
+    int columnCount(const QModelIndex & /*parent*/ = QModelIndex()) const override
+    {
+        return NUM_COLS;
+    }
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    int getOnlineCount() const
+    {
+        return onlineCount;
+    }
+    bool contains(const QString &userName) const
+    {
+        return users.contains(userName);
+    }
+    /**
+     * Returns nullptr if the user isn't in the list.
+     */
+    const ServerInfo_User *getUserInfo(const QString &userName) const;
+    const ServerInfo_User &getUserInfo(int row) const;
+    bool isOnline(int row) const;
+
+    /**
+     * Adds the user, or updates it if it is in the list already.
+     */
+    void processUserInfo(const ServerInfo_User &user, bool online);
+    /**
+     * Replaces all the users with the given ones, sorting them once.
+     */
+    void setUsers(const QList<ServerInfo_User> &userList, bool online);
+    bool deleteUser(const QString &userName);
+    void setUserOnline(const QString &userName, bool online);
+};
+
+#endif
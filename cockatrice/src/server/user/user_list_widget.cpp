@@ -13,6 +13,7 @@
 #include "pb/session_commands.pb.h"
 #include "trice_limits.h"
 #include "user_context_menu.h"
+#include "user_list_model.h"
 
 #include <QApplication>
 #include <QCheckBox>
@@ -28,6 +29,7 @@
 #include <QPushButton>
 #include <QRadioButton>
 #include <QSpinBox>
+#include <QTreeView>
 #include <QVBoxLayout>
 #include <QWidget>
 
@@ -334,99 +336,21 @@ bool UserListItemDelegate::editorEvent(QEvent *event,
     return QStyledItemDelegate::editorEvent(event, model, option, index);
 }
 
-UserListTWI::UserListTWI(const ServerInfo_User &_userInfo) : QTreeWidgetItem(Type)
-{
-    setUserInfo(_userInfo);
-}
-
-void UserListTWI::setUserInfo(const ServerInfo_User &_userInfo)
-{
-    userInfo = _userInfo;
-
-    setData(0, Qt::UserRole, userInfo.user_level());
-    setIcon(0, UserLevelPixmapGenerator::generateIcon(18, UserLevelFlags(userInfo.user_level()), userInfo.pawn_colors(),
-                                                      false, QString::fromStdString(userInfo.privlevel())));
-    setIcon(1, QIcon(CountryPixmapGenerator::generatePixmap(18, QString::fromStdString(userInfo.country()))));
-    setData(2, Qt::UserRole, QString::fromStdString(userInfo.name()));
-    setData(2, Qt::DisplayRole, QString::fromStdString(userInfo.name()));
-    setData(3, Qt::InitialSortOrderRole, QString::fromStdString(userInfo.privlevel()));
-}
-
-void UserListTWI::setOnline(bool online)
-{
-    setData(0, Qt::UserRole + 1, online);
-    setData(2, Qt::ForegroundRole, online ? qApp->palette().brush(QPalette::WindowText) : QBrush(Qt::gray));
-}
-
-/**
- * Sort Users in the following order
- * 1) Online Users > Offline Users
- * 2) Admins, judge/vip/donator status ignored
- * 3) Moderators, judge/vip/donator status ignored
- * 4) Judges
- * 5) VIPs
- * 6) Donators
- * 7) Everyone else
- * @param other RHS to compare to
- * @return Left is less than the Right
- */
-bool UserListTWI::operator<(const QTreeWidgetItem &other) const
-{
-    // Sort by online/offline
-    if (data(0, Qt::UserRole + 1) != other.data(0, Qt::UserRole + 1)) {
-        return data(0, Qt::UserRole + 1).toBool();
-    }
-
-    const auto &lhsUserLevelFlags = UserLevelFlags(data(0, Qt::UserRole).toInt());
-    const auto &rhsUserLevelFlags = UserLevelFlags(other.data(0, Qt::UserRole).toInt());
-
-    // Admins & Mods need no additional comparison checks, just to see if they're an admin or a moderator
-    static const QList<ServerInfo_User_UserLevelFlag> userLevelWithNoOtherPrefOrder = {
-        ServerInfo_User_UserLevelFlag_IsAdmin, ServerInfo_User_UserLevelFlag_IsModerator};
-    for (const auto &userLevelEntry : userLevelWithNoOtherPrefOrder) {
-        if (lhsUserLevelFlags.testFlag(userLevelEntry) &&
-            lhsUserLevelFlags.testFlag(userLevelEntry) == rhsUserLevelFlags.testFlag(userLevelEntry)) {
-            return QString::localeAwareCompare(data(2, Qt::UserRole).toString(),
-                                               other.data(2, Qt::UserRole).toString()) < 0;
-        } else if (lhsUserLevelFlags.testFlag(userLevelEntry) != rhsUserLevelFlags.testFlag(userLevelEntry)) {
-            return lhsUserLevelFlags.testFlag(userLevelEntry) > rhsUserLevelFlags.testFlag(userLevelEntry);
-        }
-    }
-
-    // Judges can be sorted by their additional ranks
-    static const QList<ServerInfo_User_UserLevelFlag> userLevelOrder = {ServerInfo_User_UserLevelFlag_IsJudge,
-                                                                        ServerInfo_User_UserLevelFlag_IsRegistered,
-                                                                        ServerInfo_User_UserLevelFlag_IsUser};
-    for (const auto &userLevelEntry : userLevelOrder) {
-        if (lhsUserLevelFlags.testFlag(userLevelEntry) != rhsUserLevelFlags.testFlag(userLevelEntry)) {
-            return lhsUserLevelFlags.testFlag(userLevelEntry) > rhsUserLevelFlags.testFlag(userLevelEntry);
-        }
-    }
-
-    // Sort by VIP > Donator > None
-    static const QMap<QString, int> privilegeOrder = {{"VIP", 3}, {"DONATOR", 2}, {"NONE", 1}, {"UNKNOWN", 0}};
-    const auto &lhsUserPrivLevel = privilegeOrder.value(data(3, Qt::InitialSortOrderRole).toString(), 0);
-    const auto &rhsUserPrivLevel = privilegeOrder.value(other.data(3, Qt::InitialSortOrderRole).toString(), 0);
-    if (lhsUserPrivLevel != rhsUserPrivLevel) {
-        return lhsUserPrivLevel > rhsUserPrivLevel;
-    }
-
-    // Sort by name
-    return QString::localeAwareCompare(data(2, Qt::UserRole).toString(), other.data(2, Qt::UserRole).toString()) < 0;
-}
-
 UserListWidget::UserListWidget(TabSupervisor *_tabSupervisor,
                                AbstractClient *_client,
                                UserListType _type,
                                QWidget *parent)
-    : QGroupBox(parent), tabSupervisor(_tabSupervisor), client(_client), type(_type), onlineCount(0)
+    : QGroupBox(parent), tabSupervisor(_tabSupervisor), client(_client), type(_type)
 {
     itemDelegate = new UserListItemDelegate(this);
     userContextMenu = new UserContextMenu(tabSupervisor, this);
     connect(userContextMenu, &UserContextMenu::openMessageDialog, this, &UserListWidget::openMessageDialog);
 
-    userTree = new QTreeWidget;
-    userTree->setColumnCount(3);
+    userModel = new UserListModel(this);
+
+    userTree = new QTreeView;
+    userTree->setModel(userModel);
+    userTree->setUniformRowHeights(true);
     userTree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
     userTree->header()->setMinimumSectionSize(0);
     userTree->setHeaderHidden(true);
@@ -434,7 +358,7 @@ UserListWidget::UserListWidget(TabSupervisor *_tabSupervisor,
     userTree->setIconSize(QSize(20, 18));
     userTree->setItemDelegate(itemDelegate);
     userTree->setAlternatingRowColors(true);
-    connect(userTree, &QTreeWidget::itemActivated, this, &UserListWidget::userClicked);
+    connect(userTree, &QTreeView::activated, this, &UserListWidget::userClicked);
 
     QVBoxLayout *vbox = new QVBoxLayout;
     vbox->addWidget(userTree);
@@ -466,30 +390,19 @@ void UserListWidget::retranslateUi()
 
 void UserListWidget::processUserInfo(const ServerInfo_User &user, bool online)
 {
-    const QString userName = QString::fromStdString(user.name());
-    UserListTWI *item = users.value(userName);
-    if (item)
-        item->setUserInfo(user);
-    else {
-        item = new UserListTWI(user);
-        users.insert(userName, item);
-        userTree->addTopLevelItem(item);
-        if (online)
-            ++onlineCount;
-        updateCount();
-    }
-    item->setOnline(online);
+    userModel->processUserInfo(user, online);
+    updateCount();
+}
+
+void UserListWidget::setUsers(const QList<ServerInfo_User> &users, bool online)
+{
+    userModel->setUsers(users, online);
+    updateCount();
 }
 
 bool UserListWidget::deleteUser(const QString &userName)
 {
-    UserListTWI *twi = users.value(userName);
-    if (twi) {
-        users.remove(userName);
-        userTree->takeTopLevelItem(userTree->indexOfTopLevelItem(twi));
-        if (twi->data(0, Qt::UserRole + 1).toBool())
-            --onlineCount;
-        delete twi;
+    if (userModel->deleteUser(userName)) {
         updateCount();
         return true;
     }
@@ -499,41 +412,38 @@ bool UserListWidget::deleteUser(const QString &userName)
 
 void UserListWidget::setUserOnline(const QString &userName, bool online)
 {
-    UserListTWI *twi = users.value(userName);
-    if (!twi)
-        return;
-
-    twi->setOnline(online);
-    if (online)
-        ++onlineCount;
-    else
-        --onlineCount;
+    userModel->setUserOnline(userName, online);
     updateCount();
 }
 
+bool UserListWidget::containsUser(const QString &userName) const
+{
+    return userModel->contains(userName);
+}
+
+const ServerInfo_User *UserListWidget::getUserInfo(const QString &userName) const
+{
+    return userModel->getUserInfo(userName);
+}
+
 void UserListWidget::updateCount()
 {
     QString str = titleStr;
     if ((type == BuddyList) || (type == IgnoreList))
-        str = str.arg(onlineCount);
-    setTitle(str.arg(userTree->topLevelItemCount()));
+        str = str.arg(userModel->getOnlineCount());
+    setTitle(str.arg(userModel->rowCount()));
 }
 
-void UserListWidget::userClicked(QTreeWidgetItem *item, int /*column*/)
+void UserListWidget::userClicked(const QModelIndex &index)
 {
-    emit openMessageDialog(item->data(2, Qt::UserRole).toString(), true);
+    emit openMessageDialog(QString::fromStdString(userModel->getUserInfo(index.row()).name()), true);
 }
 
 void UserListWidget::showContextMenu(const QPoint &pos, const QModelIndex &index)
 {
-    const ServerInfo_User &userInfo = static_cast<UserListTWI *>(userTree->topLevelItem(index.row()))->getUserInfo();
-    bool online = index.sibling(index.row(), 0).data(Qt::UserRole + 1).toBool();
+    const ServerInfo_User &userInfo = userModel->getUserInfo(index.row());
+    bool online = userModel->isOnline(index.row());
 
     userContextMenu->showContextMenu(pos, QString::fromStdString(userInfo.name()),
                                      UserLevelFlags(userInfo.user_level()), online);
 }
-
-void UserListWidget::sortItems()
-{
-    userTree->sortItems(1, Qt::AscendingOrder);
-}
@@ -9,9 +9,8 @@
 #include <QGroupBox>
 #include <QStyledItemDelegate>
 #include <QTextEdit>
-#include <QTreeWidgetItem>
 
-class QTreeWidget;
+class QTreeView;
 class ServerInfo_User;
 class AbstractClient;
 class TabSupervisor;
@@ -23,6 +22,7 @@ class QPlainTextEdit;
 class Response;
 class CommandContainer;
 class UserContextMenu;
+class UserListModel;
 
 class BanDialog : public QDialog
 {
@@ -97,22 +97,6 @@ public:
                      const QModelIndex &index) override;
 };
 
-class UserListTWI : public QTreeWidgetItem
-{
-private:
-    ServerInfo_User userInfo;
-
-public:
-    explicit UserListTWI(const ServerInfo_User &_userInfo);
-    const ServerInfo_User &getUserInfo() const
-    {
-        return userInfo;
-    }
-    void setUserInfo(const ServerInfo_User &_userInfo);
-    void setOnline(bool online);
-    bool operator<(const QTreeWidgetItem &other) const override;
-};
-
 class UserListWidget : public QGroupBox
 {
     Q_OBJECT
@@ -126,18 +110,17 @@ public:
     };
 
 private:
-    QMap<QString, UserListTWI *> users;
     TabSupervisor *tabSupervisor;
     AbstractClient *client;
     UserListType type;
-    QTreeWidget *userTree;
+    UserListModel *userModel;
+    QTreeView *userTree;
     UserListItemDelegate *itemDelegate;
     UserContextMenu *userContextMenu;
-    int onlineCount;
     QString titleStr;
     void updateCount();
 private slots:
-    void userClicked(QTreeWidgetItem *item, int column);
+    void userClicked(const QModelIndex &index);
 signals:
     void openMessageDialog(const QString &userName, bool focus);
     void addBuddy(const QString &userName);
@@ -152,14 +135,18 @@ public:
                    QWidget *parent = nullptr);
     void retranslateUi();
     void processUserInfo(const ServerInfo_User &user, bool online);
+    /**
+     * Replaces all the users of the list, e.g. with the users of a room.
+     */
+    void setUsers(const QList<ServerInfo_User> &users, bool online);
     bool deleteUser(const QString &userName);
     void setUserOnline(const QString &userName, bool online);
-    const QMap<QString, UserListTWI *> &getUsers() const
-    {
-        return users;
-    }
+    bool containsUser(const QString &userName) const;
+    /**
+     * Returns nullptr if the user isn't in the list.
+     */
+    const ServerInfo_User *getUserInfo(const QString &userName) const;
     void showContextMenu(const QPoint &pos, const QModelIndex &index);
-    void sortItems();
 };
 
 #endif
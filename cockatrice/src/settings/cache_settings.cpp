@@ -3,6 +3,7 @@
 #include "../client/network/release_channel.h"
 #include "card_counter_settings.h"
 #include "card_override_settings.h"
+#include "coalescing_settings.h"
 
 #include <QAbstractListModel>
 #include <QApplication>
@@ -42,6 +43,16 @@ QString SettingsCache::getNetworkCachePath() const
     return getCachePath() + "/downloaded/";
 }
 
+QString SettingsCache::getApiCachePath() const
+{
+    return getCachePath() + "/api/";
+}
+
+QString SettingsCache::getAvatarCachePath() const
+{
+    return getCachePath() + "/avatars/";
+}
+
 void SettingsCache::translateLegacySettings()
 {
     if (isPortableBuild)
@@ -169,7 +180,7 @@ SettingsCache::SettingsCache()
     QString dummy = QT_TRANSLATE_NOOP("i18n", "English");
 
     QString settingsPath = getSettingsPath();
-    settings = new QSettings(settingsPath + "global.ini", QSettings::IniFormat, this);
+    settings = new CoalescingSettings(settingsPath + "global.ini", QSettings::IniFormat, this);
     shortcutsSettings = new ShortcutsSettings(settingsPath, this);
     cardDatabaseSettings = new CardDatabaseSettings(settingsPath, this);
     serversSettings = new ServersSettings(settingsPath, this);
@@ -307,6 +318,7 @@ SettingsCache::SettingsCache()
     visualDeckEditorSampleHandSize = settings->value("interface/visualdeckeditorsamplehandsize", 7).toInt();
     horizontalHand = settings->value("hand/horizontal", true).toBool();
     invertVerticalCoordinate = settings->value("table/invert_vertical", false).toBool();
+    openGLGameView = settings->value("table/opengl", false).toBool();
     minPlayersForMultiColumnLayout = settings->value("interface/min_players_multicolumn", 4).toInt();
     tapAnimation = settings->value("cards/tapanimation", true).toBool();
     autoRotateSidewaysLayoutCards = settings->value("cards/autorotatesidewayslayoutcards", true).toBool();
@@ -407,6 +419,7 @@ void SettingsCache::setHighlightWords(const QString &_highlightWords)
 {
     highlightWords = _highlightWords;
     settings->setValue("personal/highlightWords", highlightWords);
+    emit highlightWordsChanged();
 }
 
 void SettingsCache::setMasterVolume(int _masterVolume)
@@ -876,6 +889,13 @@ void SettingsCache::setInvertVerticalCoordinate(QT_STATE_CHANGED_T _invertVertic
     emit invertVerticalCoordinateChanged();
 }
 
+void SettingsCache::setOpenGLGameView(QT_STATE_CHANGED_T _openGLGameView)
+{
+    openGLGameView = static_cast<bool>(_openGLGameView);
+    settings->setValue("table/opengl", openGLGameView);
+    emit openGLGameViewChanged(openGLGameView);
+}
+
 void SettingsCache::setMinPlayersForMultiColumnLayout(int _minPlayersForMultiColumnLayout)
 {
     minPlayersForMultiColumnLayout = _minPlayersForMultiColumnLayout;
@@ -161,6 +161,7 @@ signals:
     void horizontalHandChanged();
     void handJustificationChanged();
     void invertVerticalCoordinateChanged();
+    void openGLGameViewChanged(bool enabled);
     void minPlayersForMultiColumnLayoutChanged();
     void soundEnabledChanged();
     void soundThemeChanged();
@@ -171,6 +172,7 @@ signals:
     void redirectCacheTtlChanged(int newTtl);
     void masterVolumeChanged(int value);
     void chatMentionCompleterChanged();
+    void highlightWordsChanged();
     void downloadSpoilerTimeIndexChanged();
     void downloadSpoilerStatusChanged();
     void useTearOffMenusChanged(bool state);
@@ -252,6 +254,7 @@ private:
     int visualDeckEditorSampleHandSize;
     bool horizontalHand;
     bool invertVerticalCoordinate;
+    bool openGLGameView;
     int minPlayersForMultiColumnLayout;
     bool tapAnimation;
     bool autoRotateSidewaysLayoutCards;
@@ -320,6 +323,8 @@ public:
     QString getSettingsPath();
     QString getCachePath() const;
     QString getNetworkCachePath() const;
+    QString getApiCachePath() const;
+    QString getAvatarCachePath() const;
     const QByteArray &getMainWindowGeometry() const
     {
         return mainWindowGeometry;
@@ -642,6 +647,10 @@ public:
     {
         return invertVerticalCoordinate;
     }
+    bool getOpenGLGameView() const
+    {
+        return openGLGameView;
+    }
     int getMinPlayersForMultiColumnLayout() const
     {
         return minPlayersForMultiColumnLayout;
@@ -993,6 +1002,7 @@ public slots:
     void setVisualDeckEditorSampleHandSize(int _amount);
     void setHorizontalHand(QT_STATE_CHANGED_T _horizontalHand);
     void setInvertVerticalCoordinate(QT_STATE_CHANGED_T _invertVerticalCoordinate);
+    void setOpenGLGameView(QT_STATE_CHANGED_T _openGLGameView);
     void setMinPlayersForMultiColumnLayout(int _minPlayersForMultiColumnLayout);
     void setTapAnimation(QT_STATE_CHANGED_T _tapAnimation);
     void setAutoRotateSidewaysLayoutCards(QT_STATE_CHANGED_T _autoRotateSidewaysLayoutCards);
@@ -11,17 +11,21 @@ CardCounterSettings::CardCounterSettings(const QString &settingsPath, QObject *p
 
 void CardCounterSettings::setColor(int counterId, const QColor &color)
 {
-    QString key = QString("cards/counters/%1/color").arg(counterId);
-
-    if (settings.value(key).value<QColor>() == color)
+    if (this->color(counterId) == color)
         return;
 
-    settings.setValue(key, color);
+    settings.setValue(QString("cards/counters/%1/color").arg(counterId), color);
+    colors.insert(counterId, color);
     emit colorChanged(counterId, color);
 }
 
 QColor CardCounterSettings::color(int counterId) const
 {
+    auto cachedColor = colors.constFind(counterId);
+    if (cachedColor != colors.constEnd()) {
+        return *cachedColor;
+    }
+
     QColor defaultColor;
 
     if (counterId < 6) {
@@ -36,7 +40,11 @@ QColor CardCounterSettings::color(int counterId) const
         defaultColor = QColor::fromHsv(h, s, v);
     }
 
-    return settings.value(QString("cards/counters/%1/color").arg(counterId), defaultColor).value<QColor>();
+    const QString key = QString("cards/counters/%1/color").arg(counterId);
+    auditRead(key);
+    const QColor color = settings.value(key, defaultColor).value<QColor>();
+    colors.insert(counterId, color);
+    return color;
 }
 
 QString CardCounterSettings::displayName(int counterId) const
@@ -3,10 +3,11 @@
 
 #include "settings_manager.h"
 
+#include <QColor>
+#include <QHash>
 #include <QObject>
 
 class QSettings;
-class QColor;
 
 class CardCounterSettings : public SettingsManager
 {
@@ -24,6 +25,10 @@ public slots:
 
 signals:
     void colorChanged(int counterId, const QColor &color);
+
+private:
+    // the colors read so far, since they are looked up for every counter each time a card is painted
+    mutable QHash<int, QColor> colors;
 };
 
 #endif // CARD_COUNTER_SETTINGS_H
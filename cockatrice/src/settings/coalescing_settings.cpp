@@ -0,0 +1,34 @@
+#include "coalescing_settings.h"
+
+#include <QCoreApplication>
+#include <QTimerEvent>
+
+static const int FLUSH_DELAY_MS = 300;
+
+CoalescingSettings::CoalescingSettings(const QString &fileName, QSettings::Format format, QObject *parent)
+    : QSettings(fileName, format, parent), flushTimerId(0)
+{
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &QSettings::sync);
+    }
+}
+
+bool CoalescingSettings::event(QEvent *event)
+{
+    // posted by QSettings after the first change since it was last written
+    if (event->type() == QEvent::UpdateRequest) {
+        if (flushTimerId == 0) {
+            flushTimerId = startTimer(FLUSH_DELAY_MS);
+        }
+        return true;
+    }
+
+    if (event->type() == QEvent::Timer && static_cast<QTimerEvent *>(event)->timerId() == flushTimerId) {
+        killTimer(flushTimerId);
+        flushTimerId = 0;
+        sync();
+        return true;
+    }
+
+    return QSettings::event(event);
+}
@@ -0,0 +1,25 @@
+#ifndef COALESCING_SETTINGS_H
+#define COALESCING_SETTINGS_H
+
+#include <QSettings>
+
+/**
+ * A QSettings that writes its changes to disk at most every few hundred milliseconds.
+ *
+ * QSettings keeps the changes in memory and writes the whole file on the next pass of the event loop, so a slider
+ * that is dragged or a dock that is resized rewrote the file many times a second. The values read back are always
+ * the latest ones, only the file lags behind; it's written one last time when the application quits.
+ */
+class CoalescingSettings : public QSettings
+{
+public:
+    explicit CoalescingSettings(const QString &fileName, QSettings::Format format, QObject *parent = nullptr);
+
+protected:
+    bool event(QEvent *event) override;
+
+private:
+    int flushTimerId;
+};
+
+#endif // COALESCING_SETTINGS_H
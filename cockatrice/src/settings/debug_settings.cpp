@@ -9,11 +9,12 @@ DebugSettings::DebugSettings(const QString &settingPath, QObject *parent)
     if (!QFile(settingPath + "debug.ini").exists()) {
         QFile::copy(":/resources/config/debug.ini", settingPath + "debug.ini");
     }
+    showCardId = getValue("showCardId", "debug").toBool();
 }
 
 bool DebugSettings::getShowCardId()
 {
-    return getValue("showCardId", "debug").toBool();
+    return showCardId;
 }
 
 bool DebugSettings::getLocalGameOnStartup()
@@ -10,6 +10,9 @@ class DebugSettings : public SettingsManager
     explicit DebugSettings(const QString &settingPath, QObject *parent = nullptr);
     DebugSettings(const DebugSettings & /*other*/);
 
+    // checked for every card that is painted with its name
+    bool showCardId;
+
 public:
     bool getShowCardId();
 
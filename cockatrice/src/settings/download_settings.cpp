@@ -9,21 +9,41 @@ const QStringList DownloadSettings::DEFAULT_DOWNLOAD_URLS = {
     "https://gatherer.wizards.com/Handlers/Image.ashx?name=!name!&type=card"};
 
 DownloadSettings::DownloadSettings(const QString &settingPath, QObject *parent = nullptr)
-    : SettingsManager(settingPath + "downloads.ini", parent)
+    : SettingsManager(settingPath + "downloads.ini", parent),
+      downloadUrls(getValue("urls", "downloads").toStringList())
 {
 }
 
 void DownloadSettings::setDownloadUrls(const QStringList &downloadURLs)
 {
     setValue(QVariant::fromValue(downloadURLs), "urls", "downloads");
+    QMutexLocker locker(&downloadUrlsMutex);
+    downloadUrls = downloadURLs;
 }
 
 QStringList DownloadSettings::getAllURLs()
 {
-    return getValue("urls", "downloads").toStringList();
+    QMutexLocker locker(&downloadUrlsMutex);
+    return downloadUrls;
 }
 
 void DownloadSettings::resetToDefaultURLs()
 {
-    setValue(QVariant::fromValue(DEFAULT_DOWNLOAD_URLS), "urls", "downloads");
+    setDownloadUrls(DEFAULT_DOWNLOAD_URLS);
+}
+
+/**
+ * The most picture downloads running at the same time from one host. Most image hosts serve HTTP/2, which multiplexes
+ * all of them over one connection.
+ */
+int DownloadSettings::getMaxRequestsPerHost()
+{
+    bool ok = false;
+    const int maxRequestsPerHost = getValue("requestsPerHost", "downloads").toInt(&ok);
+    return ok && maxRequestsPerHost > 0 ? maxRequestsPerHost : DEFAULT_MAX_REQUESTS_PER_HOST;
+}
+
+void DownloadSettings::setMaxRequestsPerHost(int maxRequestsPerHost)
+{
+    setValue(maxRequestsPerHost, "requestsPerHost", "downloads");
 }
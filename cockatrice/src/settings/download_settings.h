@@ -3,6 +3,7 @@
 
 #include "settings_manager.h"
 
+#include <QMutex>
 #include <QObject>
 
 class DownloadSettings : public SettingsManager
@@ -11,6 +12,7 @@ class DownloadSettings : public SettingsManager
     friend class SettingsCache;
 
     static const QStringList DEFAULT_DOWNLOAD_URLS;
+    static constexpr int DEFAULT_MAX_REQUESTS_PER_HOST = 6;
 
 public:
     explicit DownloadSettings(const QString &, QObject *);
@@ -18,6 +20,14 @@ public:
     QStringList getAllURLs();
     void setDownloadUrls(const QStringList &downloadURLs);
     void resetToDefaultURLs();
+
+    int getMaxRequestsPerHost();
+    void setMaxRequestsPerHost(int maxRequestsPerHost);
+
+private:
+    // read for every picture that is loaded, from the threads of the picture loader
+    mutable QMutex downloadUrlsMutex;
+    QStringList downloadUrls;
 };
 
 #endif // COCKATRICE_DOWNLOADSETTINGS_H
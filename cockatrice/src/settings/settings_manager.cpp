@@ -1,5 +1,21 @@
 #include "settings_manager.h"
 
+#include <QCoreApplication>
+#include <QThread>
+#include <atomic>
+
+static std::atomic<int> activeReadAudits(0);
+
+SettingsManager::ReadAudit::ReadAudit()
+{
+    ++activeReadAudits;
+}
+
+SettingsManager::ReadAudit::~ReadAudit()
+{
+    --activeReadAudits;
+}
+
 SettingsManager::SettingsManager(const QString &settingPath, QObject *parent)
     : QObject(parent), settings(settingPath, QSettings::IniFormat)
 {
@@ -50,6 +66,21 @@ void SettingsManager::deleteValue(const QString &name, const QString &group, con
     }
 }
 
+/**
+ * Logs the read of a key in the current group of the settings, if there is a ReadAudit and it's on the GUI thread
+ */
+void SettingsManager::auditRead(const QString &name) const
+{
+    if (activeReadAudits == 0 || !SettingsReadAuditLog().isDebugEnabled()) {
+        return;
+    }
+    const QCoreApplication *app = QCoreApplication::instance();
+    if (app && QThread::currentThread() == app->thread()) {
+        const QString key = settings.group().isEmpty() ? name : settings.group() + "/" + name;
+        qCDebug(SettingsReadAuditLog) << "Read" << key << "from" << settings.fileName() << "on the GUI thread";
+    }
+}
+
 QVariant SettingsManager::getValue(const QString &name, const QString &group, const QString &subGroup)
 {
     if (!group.isEmpty()) {
@@ -60,6 +91,7 @@ QVariant SettingsManager::getValue(const QString &name, const QString &group, co
         settings.beginGroup(subGroup);
     }
 
+    auditRead(name);
     QVariant value = settings.value(name);
 
     if (!subGroup.isEmpty()) {
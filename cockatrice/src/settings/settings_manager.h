@@ -1,21 +1,41 @@
 #ifndef SETTINGSMANAGER_H
 #define SETTINGSMANAGER_H
 
+#include "coalescing_settings.h"
+
+#include <QLoggingCategory>
 #include <QObject>
 #include <QSettings>
 #include <QStringList>
 #include <QVariant>
 
+inline Q_LOGGING_CATEGORY(SettingsReadAuditLog, "settings_manager.read_audit", QtInfoMsg);
+
 class SettingsManager : public QObject
 {
     Q_OBJECT
 public:
+    /**
+     * While one of these exists, every settings file read on the GUI thread is logged to SettingsReadAuditLog, which
+     * is only shown with the debug messages of that category enabled. A game keeps one, since its paint and event
+     * paths should be served from cached values only.
+     */
+    class ReadAudit
+    {
+    public:
+        ReadAudit();
+        ~ReadAudit();
+        ReadAudit(const ReadAudit &) = delete;
+        ReadAudit &operator=(const ReadAudit &) = delete;
+    };
+
     explicit SettingsManager(const QString &settingPath, QObject *parent = nullptr);
     QVariant getValue(const QString &name, const QString &group = "", const QString &subGroup = "");
     void sync();
 
 protected:
-    QSettings settings;
+    CoalescingSettings settings;
+    void auditRead(const QString &name) const;
     void setValue(const QVariant &value, const QString &name, const QString &group = "", const QString &subGroup = "");
     void deleteValue(const QString &name, const QString &group = "", const QString &subGroup = "");
 };
@@ -1,25 +1,93 @@
 #include "levenshtein.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <vector>
 
 int levenshteinDistance(const QString &s1, const QString &s2)
 {
     int len1 = s1.size();
     int len2 = s2.size();
-    std::vector<std::vector<int>> dp(len1 + 1, std::vector<int>(len2 + 1));
+    // only the previous row of the matrix is needed to compute the next one
+    std::vector<int> previous(len2 + 1);
+    std::vector<int> current(len2 + 1);
 
-    for (int i = 0; i <= len1; i++)
-        dp[i][0] = i;
     for (int j = 0; j <= len2; j++)
-        dp[0][j] = j;
+        previous[j] = j;
 
     for (int i = 1; i <= len1; i++) {
+        current[0] = i;
         for (int j = 1; j <= len2; j++) {
             int cost = (s1[i - 1] == s2[j - 1]) ? 0 : 1;
-            dp[i][j] = std::min({dp[i - 1][j] + 1, dp[i][j - 1] + 1, dp[i - 1][j - 1] + cost});
+            current[j] = std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost});
         }
+        std::swap(previous, current);
     }
 
-    return dp[len1][len2];
+    return previous[len2];
+}
+
+LevenshteinMatcher::LevenshteinMatcher(const QString &_pattern) : pattern(_pattern.toLower()), asciiMasks{}
+{
+    if (pattern.size() > 64) {
+        return;
+    }
+
+    for (int i = 0; i < pattern.size(); ++i) {
+        const quint64 bit = quint64(1) << i;
+        for (const QChar c : {pattern.at(i), pattern.at(i).toUpper(), pattern.at(i).toTitleCase()}) {
+            if (c.unicode() < 128) {
+                asciiMasks[c.unicode()] |= bit;
+            } else {
+                otherMasks[c.unicode()] |= bit;
+            }
+        }
+    }
+}
+
+int LevenshteinMatcher::distance(const QString &text, int maxDistance) const
+{
+    const int patternLength = pattern.size();
+    const int textLength = text.size();
+    if (std::abs(patternLength - textLength) > maxDistance) {
+        return std::abs(patternLength - textLength);
+    }
+    if (patternLength > 64) {
+        return levenshteinDistance(pattern, text.toLower());
+    }
+    if (patternLength == 0) {
+        return textLength;
+    }
+
+    // the vertical deltas of the current column of the distance matrix, as positive and negative bit vectors
+    quint64 positive = ~quint64(0);
+    quint64 negative = 0;
+    const quint64 last = quint64(1) << (patternLength - 1);
+    int score = patternLength;
+
+    for (int j = 0; j < textLength; ++j) {
+        const quint64 matches = maskOf(text.at(j));
+        const quint64 vertical = matches | negative;
+        const quint64 horizontal = (((matches & positive) + positive) ^ positive) | matches;
+        quint64 horizontalPositive = negative | ~(horizontal | positive);
+        quint64 horizontalNegative = positive & horizontal;
+
+        if (horizontalPositive & last) {
+            ++score;
+        } else if (horizontalNegative & last) {
+            --score;
+        }
+
+        // every remaining text character can lower the distance by one at most
+        if (score - (textLength - j - 1) > maxDistance) {
+            return score - (textLength - j - 1);
+        }
+
+        horizontalPositive = (horizontalPositive << 1) | 1;
+        horizontalNegative <<= 1;
+        positive = horizontalNegative | ~(vertical | horizontalPositive);
+        negative = horizontalPositive & vertical;
+    }
+
+    return score;
 }
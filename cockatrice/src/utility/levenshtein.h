@@ -1,8 +1,38 @@
 #ifndef LEVENSHTEIN_H
 #define LEVENSHTEIN_H
 
+#include <QHash>
 #include <QString>
+#include <climits>
 
 int levenshteinDistance(const QString &s1, const QString &s2);
 
+/**
+ * Computes the case-insensitive Levenshtein distance of many texts to the same pattern, using Myers' bit-parallel
+ * algorithm: every text character costs a few word operations instead of a row of the distance matrix. Patterns of
+ * more than 64 characters fall back to levenshteinDistance().
+ */
+class LevenshteinMatcher
+{
+public:
+    explicit LevenshteinMatcher(const QString &_pattern);
+
+    /**
+     * Returns the distance of text to the pattern, or some value above maxDistance as soon as the distance is known
+     * to be larger than it.
+     */
+    int distance(const QString &text, int maxDistance = INT_MAX) const;
+
+private:
+    QString pattern;
+    // for every character, the bits of the pattern positions it matches
+    quint64 asciiMasks[128];
+    QHash<ushort, quint64> otherMasks;
+
+    quint64 maskOf(QChar c) const
+    {
+        return c.unicode() < 128 ? asciiMasks[c.unicode()] : otherMasks.value(c.unicode());
+    }
+};
+
 #endif // LEVENSHTEIN_H
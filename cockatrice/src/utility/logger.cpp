@@ -6,28 +6,60 @@
 #include <QDateTime>
 #include <QLocale>
 #include <QSysInfo>
+#include <QThread>
 #include <iostream>
 
 #define LOGGER_MAX_ENTRIES 128
+// the messages that may wait for the writer, the oldest are dropped beyond that
+#define LOGGER_MAX_QUEUED 10000
 #define LOGGER_FILENAME "qdebug.txt"
 
-Logger::Logger() : logToFileEnabled(false)
+class LogWriterThread : public QThread
 {
-    logBuffer.append(getClientVersion());
-    logBuffer.append(getSystemArchitecture());
-    logBuffer.append(getSystemLocale());
-    logBuffer.append(getClientInstallInfo());
-    logBuffer.append(QString("-").repeated(75));
+public:
+    explicit LogWriterThread(Logger &_logger) : logger(_logger)
+    {
+    }
+
+protected:
+    void run() override
+    {
+        logger.writeMessages();
+    }
+
+private:
+    Logger &logger;
+};
+
+Logger::Logger()
+    : logToFileEnabled(false), droppedMessages(0), writing(false), stopping(false), writerThread(nullptr),
+      historyEnd(0)
+{
+    logHeader.append(getClientVersion());
+    logHeader.append(getSystemArchitecture());
+    logHeader.append(getSystemLocale());
+    logHeader.append(getClientInstallInfo());
+    logHeader.append(QString("-").repeated(75));
     std::cerr << getClientVersion().toStdString() << std::endl;
     std::cerr << getSystemArchitecture().toStdString() << std::endl;
     std::cerr << getSystemLocale().toStdString() << std::endl;
     std::cerr << getClientInstallInfo().toStdString() << std::endl;
+
+    writerThread = new LogWriterThread(*this);
+    writerThread->start();
 }
 
 Logger::~Logger()
 {
+    queueMutex.lock();
+    stopping = true;
+    messagesQueued.wakeAll();
+    queueMutex.unlock();
+    // the writer writes what is still queued before it returns
+    writerThread->wait();
+    delete writerThread;
+
     closeLogfileSession();
-    logBuffer.clear();
 }
 
 void Logger::logToFile(bool enabled)
@@ -46,6 +78,7 @@ QString Logger::getClientVersion()
 
 void Logger::openLogfileSession()
 {
+    QMutexLocker locker(&fileMutex);
     if (logToFileEnabled) {
         return;
     }
@@ -69,6 +102,7 @@ void Logger::openLogfileSession()
 
 void Logger::closeLogfileSession()
 {
+    QMutexLocker locker(&fileMutex);
     if (!logToFileEnabled)
         return;
 
@@ -81,30 +115,105 @@ void Logger::closeLogfileSession()
     fileHandle.close();
 }
 
-void Logger::log(QtMsgType /* type */, const QMessageLogContext & /* ctx */, const QString &message)
+void Logger::log(QtMsgType type, const QMessageLogContext & /* ctx */, const QString &message)
 {
-    QMetaObject::invokeMethod(this, "internalLog", Qt::QueuedConnection, Q_ARG(const QString &, message));
+    {
+        QMutexLocker locker(&queueMutex);
+        if (stopping) {
+            // logged while the application is torn down, after the writer is gone
+            std::cerr << message.toStdString() << std::endl;
+            return;
+        }
+        if (queuedMessages.size() >= LOGGER_MAX_QUEUED) {
+            queuedMessages.dequeue();
+            ++droppedMessages;
+        }
+        queuedMessages.enqueue(message);
+        if (!writing) {
+            messagesQueued.wakeOne();
+        }
+    }
+
+    // the application is aborted once the message handler returns
+    if (type == QtFatalMsg) {
+        waitForWriter();
+    }
 }
 
-void Logger::internalLog(const QString &message)
+void Logger::writeMessages()
 {
-    QMutexLocker locker(&mutex);
+    QMutexLocker locker(&queueMutex);
+    forever
+    {
+        while (queuedMessages.isEmpty() && !stopping) {
+            messagesQueued.wait(&queueMutex);
+        }
+        if (queuedMessages.isEmpty()) {
+            return;
+        }
+
+        QQueue<QString> messages;
+        messages.swap(queuedMessages);
+        const int dropped = droppedMessages;
+        droppedMessages = 0;
+        writing = true;
+        locker.unlock();
+
+        if (dropped > 0) {
+            messages.prepend(QString("%1 log messages dropped, the log writer fell behind").arg(dropped));
+        }
+
+        QString lines;
+        for (const QString &message : messages) {
+            lines += message + "\n";
+        }
+        std::cerr << lines.toStdString() << std::flush; // Print to stdout
+
+        {
+            QMutexLocker fileLocker(&fileMutex);
+            if (logToFileEnabled) {
+                fileStream << lines; // Print to fileStream
+                fileStream.flush();
+            }
+        }
+
+        {
+            QMutexLocker historyLocker(&historyMutex);
+            history.append(messages);
+            while (history.size() > LOGGER_MAX_ENTRIES) {
+                history.dequeue();
+            }
+            historyEnd += messages.size();
+        }
+
+        locker.relock();
+        writing = false;
+        messagesWritten.wakeAll();
+    }
+}
 
-    logBuffer.append(message);
-    if (logBuffer.size() > LOGGER_MAX_ENTRIES) {
-        logBuffer.removeAt(1);
+void Logger::waitForWriter()
+{
+    if (QThread::currentThread() == writerThread) {
+        return;
     }
 
-    emit logEntryAdded(message);
-    std::cerr << message.toStdString() << std::endl; // Print to stdout
+    QMutexLocker locker(&queueMutex);
+    while (!queuedMessages.isEmpty() || writing) {
+        messagesWritten.wait(&queueMutex);
+    }
+}
 
-    if (logToFileEnabled) {
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
-        fileStream << message << Qt::endl; // Print to fileStream
-#else
-        fileStream << message << endl; // Print to fileStream
-#endif
+QStringList Logger::getLogEntries(quint64 &nextEntry)
+{
+    QMutexLocker locker(&historyMutex);
+    const quint64 historyStart = historyEnd - history.size();
+    QStringList entries;
+    for (quint64 entry = qMax(nextEntry, historyStart); entry < historyEnd; ++entry) {
+        entries.append(history.at(static_cast<int>(entry - historyStart)));
     }
+    nextEntry = historyEnd;
+    return entries;
 }
 
 QString Logger::getSystemArchitecture()
@@ -3,9 +3,12 @@
 
 #include <QFile>
 #include <QMutex>
+#include <QQueue>
 #include <QString>
+#include <QStringList>
 #include <QTextStream>
 #include <QVector>
+#include <QWaitCondition>
 
 #if defined(Q_PROCESSOR_X86_32)
 #define BUILD_ARCHITECTURE "32-bit"
@@ -17,6 +20,16 @@
 #define BUILD_ARCHITECTURE "unknown"
 #endif
 
+class QThread;
+
+/**
+ * Takes the messages of the message handler installed in main(), from any thread.
+ *
+ * Logging only queues the message; a writer thread prints it, writes it to the log file and keeps it in the history
+ * shown by DlgViewLog. At most 10000 messages wait for the writer; when it falls further behind, the oldest ones are
+ * dropped and their number is logged instead. The history holds the last 128 messages, the dialog pulls the new ones with
+ * getLogEntries().
+ */
 class Logger : public QObject
 {
     Q_OBJECT
@@ -34,10 +47,16 @@ public:
     QString getSystemArchitecture();
     QString getSystemLocale();
     QString getClientInstallInfo();
-    QList<QString> getLogBuffer()
+    // the client and system info that opens the log
+    QStringList getLogHeader() const
     {
-        return logBuffer;
+        return logHeader;
     }
+    /**
+     * The messages of the history from nextEntry on; the ones that already left the history are skipped.
+     * @param nextEntry Set to the entry after the last one returned, for the next call. 0 for the whole history.
+     */
+    QStringList getLogEntries(quint64 &nextEntry);
 
 private:
     Logger();
@@ -46,21 +65,37 @@ private:
     Logger(Logger const &);
     void operator=(Logger const &);
 
+    friend class LogWriterThread;
+
     bool logToFileEnabled;
     QTextStream fileStream;
     QFile fileHandle;
-    QList<QString> logBuffer;
-    QMutex mutex;
+    // held by the writer while it writes, so that the log file isn't opened or closed meanwhile
+    QMutex fileMutex;
+    QStringList logHeader;
+
+    // the messages the writer didn't take yet, guarded by queueMutex
+    QQueue<QString> queuedMessages;
+    int droppedMessages;
+    bool writing;
+    bool stopping;
+    QMutex queueMutex;
+    QWaitCondition messagesQueued;
+    QWaitCondition messagesWritten;
+    QThread *writerThread;
+
+    // the last messages written, historyEnd counts all of them
+    QQueue<QString> history;
+    quint64 historyEnd;
+    QMutex historyMutex;
+
+    void writeMessages();
+    // blocks until the writer took and wrote every message queued so far
+    void waitForWriter();
 
 protected:
     void openLogfileSession();
     void closeLogfileSession();
-
-protected slots:
-    void internalLog(const QString &message);
-
-signals:
-    void logEntryAdded(const QString &message);
 };
 
 #endif
@@ -0,0 +1,79 @@
+#include "startup_trace.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <algorithm>
+
+StartupTrace::Scope::Scope(const QString &_name) : name(_name), startMs(StartupTrace::instance().elapsed())
+{
+}
+
+StartupTrace::Scope::~Scope()
+{
+    StartupTrace &trace = StartupTrace::instance();
+    trace.record(name, startMs, trace.elapsed() - startMs);
+}
+
+StartupTrace::StartupTrace() : firstWindowMs(-1)
+{
+    clock.start();
+}
+
+StartupTrace &StartupTrace::instance()
+{
+    static StartupTrace instance;
+    return instance;
+}
+
+void StartupTrace::record(const QString &name, qint64 startMs, qint64 durationMs)
+{
+    const QCoreApplication *app = QCoreApplication::instance();
+    const bool mainThread = !app || QThread::currentThread() == app->thread();
+    qCInfo(StartupTraceLog) << name << "took" << durationMs << "ms" << (mainThread ? "" : "(concurrent)");
+
+    QMutexLocker locker(&mutex);
+    phases.append({name, startMs, durationMs, mainThread});
+}
+
+void StartupTrace::markFirstWindow()
+{
+    QMutexLocker locker(&mutex);
+    if (firstWindowMs == -1) {
+        firstWindowMs = clock.elapsed();
+        qCInfo(StartupTraceLog) << "First window shown after" << firstWindowMs << "ms";
+    }
+}
+
+QVector<StartupTrace::Phase> StartupTrace::getPhases() const
+{
+    QMutexLocker locker(&mutex);
+    QVector<Phase> sortedPhases = phases;
+    std::stable_sort(sortedPhases.begin(), sortedPhases.end(),
+                     [](const Phase &a, const Phase &b) { return a.startMs < b.startMs; });
+    return sortedPhases;
+}
+
+QString StartupTrace::toText() const
+{
+    qint64 firstWindow;
+    {
+        QMutexLocker locker(&mutex);
+        firstWindow = firstWindowMs;
+    }
+
+    QString text;
+    if (firstWindow == -1) {
+        text = QCoreApplication::translate("StartupTrace", "The main window is not shown yet.");
+    } else {
+        text = QCoreApplication::translate("StartupTrace", "First window shown after %1 ms.").arg(firstWindow);
+    }
+    text += "\n\n";
+    for (const Phase &phase : getPhases()) {
+        text += QString("%1 ms\t+%2 ms\t%3%4\n")
+                    .arg(phase.startMs, 6)
+                    .arg(phase.durationMs, 5)
+                    .arg(phase.name)
+                    .arg(phase.mainThread ? QString() : QCoreApplication::translate("StartupTrace", " (concurrent)"));
+    }
+    return text;
+}
@@ -0,0 +1,66 @@
+#ifndef STARTUP_TRACE_H
+#define STARTUP_TRACE_H
+
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+inline Q_LOGGING_CATEGORY(StartupTraceLog, "startup_trace");
+
+/**
+ * The phases of the client's startup and how long each of them took, counted from the start of main(). Phases that
+ * run on other threads are recorded as well, so the trace shows which ones overlapped. The debug log dialog shows it,
+ * since the log buffer only keeps the latest messages.
+ */
+class StartupTrace
+{
+public:
+    struct Phase
+    {
+        QString name;
+        qint64 startMs;
+        qint64 durationMs;
+        bool mainThread;
+    };
+
+    /**
+     * Records a phase that lasts from the construction of the scope to its destruction.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(const QString &_name);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        QString name;
+        qint64 startMs;
+    };
+
+    static StartupTrace &instance();
+
+    qint64 elapsed() const
+    {
+        return clock.elapsed();
+    }
+    void record(const QString &name, qint64 startMs, qint64 durationMs);
+    // called once the main window is shown
+    void markFirstWindow();
+
+    QVector<Phase> getPhases() const;
+    QString toText() const;
+
+private:
+    StartupTrace();
+
+    QElapsedTimer clock;
+    mutable QMutex mutex;
+    QVector<Phase> phases;
+    qint64 firstWindowMs;
+};
+
+#endif
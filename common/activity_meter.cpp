@@ -0,0 +1,45 @@
+#include "activity_meter.h"
+
+#include <climits>
+
+ActivityMeter::ActivityMeter() : firstTick(-1), lastTick(-1)
+{
+    commandWindow.setLength(windowTicks);
+    handlerTimeWindow.setLength(windowTicks);
+    sentBytesWindow.setLength(windowTicks);
+}
+
+void ActivityMeter::advanceTo(int tick)
+{
+    if (firstTick < 0) {
+        firstTick = lastTick = tick;
+        return;
+    }
+    // the ticks of the threads recording may come in slightly out of order, those go to the newest bucket
+    if (tick <= lastTick)
+        return;
+    commandWindow.advance(tick - lastTick);
+    handlerTimeWindow.advance(tick - lastTick);
+    sentBytesWindow.advance(tick - lastTick);
+    lastTick = tick;
+}
+
+void ActivityMeter::record(int tick, int commands, qint64 handlerNanoseconds, qint64 sentBytes)
+{
+    QMutexLocker locker(&mutex);
+    advanceTo(tick);
+    if (commands)
+        commandWindow.add(commands);
+    if (handlerNanoseconds)
+        handlerTimeWindow.add(static_cast<int>(qMin<qint64>(handlerNanoseconds / 1000, INT_MAX)));
+    if (sentBytes)
+        sentBytesWindow.add(static_cast<int>(qMin<qint64>(sentBytes, INT_MAX)));
+}
+
+ActivityMeter::Sample ActivityMeter::sample(int tick)
+{
+    QMutexLocker locker(&mutex);
+    advanceTo(tick);
+    return {qMin(lastTick - firstTick + 1, windowTicks), commandWindow.total(),
+            handlerTimeWindow.total(), sentBytesWindow.total()};
+}
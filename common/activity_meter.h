@@ -0,0 +1,42 @@
+#ifndef ACTIVITY_METER_H
+#define ACTIVITY_METER_H
+
+#include "rate_window.h"
+
+#include <QMutex>
+#include <QtGlobal>
+
+/**
+ * What a game or a session did over the last few ping clock ticks: the commands it processed, the time spent in
+ * their handlers and the bytes it sent. Feeds the activity view of the moderators, see Command_GetActivityTop.
+ *
+ * Any thread may record and sample; a mutex guards the windows, it is only ever held for a few additions.
+ */
+class ActivityMeter
+{
+public:
+    // the length of the window, in ping clock ticks
+    static constexpr int windowTicks = 10;
+
+    struct Sample
+    {
+        // the ticks the window covers, fewer than windowTicks while the meter is younger than that
+        int ticks;
+        qint64 commands;
+        qint64 handlerMicroseconds;
+        qint64 sentBytes;
+    };
+
+    ActivityMeter();
+    void record(int tick, int commands, qint64 handlerNanoseconds, qint64 sentBytes);
+    Sample sample(int tick);
+
+private:
+    QMutex mutex;
+    int firstTick, lastTick;
+    RateWindow commandWindow, handlerTimeWindow, sentBytesWindow;
+
+    void advanceTo(int tick);
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "avatar_hash.h"
+
+#include "pb/serverinfo_user.pb.h"
+
+#include <QCryptographicHash>
+
+namespace AvatarHash
+{
+
+QByteArray hashOf(const QByteArray &avatar)
+{
+    return QCryptographicHash::hash(avatar, QCryptographicHash::Sha1);
+}
+
+void updateHash(ServerInfo_User &user)
+{
+    if (user.avatar_bmp().empty()) {
+        user.clear_avatar_hash();
+        return;
+    }
+    const QByteArray hash = hashOf(QByteArray::fromStdString(user.avatar_bmp()));
+    user.set_avatar_hash(hash.constData(), static_cast<size_t>(hash.size()));
+}
+
+void stripAvatar(ServerInfo_User &user)
+{
+    if (!user.has_avatar_bmp())
+        return;
+    // user info from servers of the network that don't set the hash yet
+    if (!user.has_avatar_hash())
+        updateHash(user);
+    user.clear_avatar_bmp();
+}
+
+} // namespace AvatarHash
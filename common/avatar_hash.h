@@ -0,0 +1,26 @@
+#ifndef AVATAR_HASH_H
+#define AVATAR_HASH_H
+
+#include <QByteArray>
+
+class ServerInfo_User;
+
+/**
+ * Avatars sent by their hash, enabled per connection when the client advertises the "avatar_hashes" feature on login.
+ *
+ * The user info for such clients carries avatar_hash instead of avatar_bmp, and the avatar itself is only sent when
+ * asked for with Command_GetAvatar. Clients keep the avatars they got by their hash, so the same avatar is
+ * downloaded once.
+ */
+namespace AvatarHash
+{
+inline constexpr const char *featureName = "avatar_hashes";
+
+QByteArray hashOf(const QByteArray &avatar);
+// sets avatar_hash to the hash of avatar_bmp, clears it if there is no avatar
+void updateHash(ServerInfo_User &user);
+// leaves only the hash of the avatar
+void stripAvatar(ServerInfo_User &user);
+} // namespace AvatarHash
+
+#endif
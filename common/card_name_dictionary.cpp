@@ -0,0 +1,167 @@
+#include "card_name_dictionary.h"
+
+#include "pb/event_card_names.pb.h"
+#include "pb/event_game_state_changed.pb.h"
+#include "pb/event_move_card.pb.h"
+#include "pb/event_reveal_cards.pb.h"
+#include "pb/game_event_container.pb.h"
+#include "pb/serverinfo_player.pb.h"
+
+#include <QDebug>
+
+bool CardNameDictionary::carriesCardNames(const GameEventContainer &cont)
+{
+    for (const GameEvent &event : cont.event_list())
+        if (event.HasExtension(Event_RevealCards::ext) || event.HasExtension(Event_GameStateChanged::ext) ||
+            event.HasExtension(Event_MoveCard::ext) || event.HasExtension(Event_CardNames::ext))
+            return true;
+    return false;
+}
+
+uint32_t CardNameDictionary::idOf(const std::string &name)
+{
+    auto entry = ids.find(name);
+    if (entry == ids.end()) {
+        entry = ids.emplace(name, static_cast<uint32_t>(names.size())).first;
+        names.push_back(name);
+    }
+    return entry->second;
+}
+
+bool CardNameDictionary::lookUp(uint32_t id, std::string *result) const
+{
+    if (id >= names.size()) {
+        qWarning() << "Card name" << id << "is not in the dictionary";
+        result->clear();
+        return false;
+    }
+    *result = names[id];
+    return true;
+}
+
+void CardNameDictionary::encodeCard(ServerInfo_Card &card)
+{
+    // face down cards have no name, an empty string costs less than a reference
+    if (!card.name().empty()) {
+        card.set_name_ref(idOf(card.name()));
+        card.clear_name();
+    }
+    if (!card.provider_id().empty()) {
+        card.set_provider_id_ref(idOf(card.provider_id()));
+        card.clear_provider_id();
+    }
+}
+
+void CardNameDictionary::decodeCard(ServerInfo_Card &card) const
+{
+    if (card.has_name_ref()) {
+        lookUp(card.name_ref(), card.mutable_name());
+        card.clear_name_ref();
+    }
+    if (card.has_provider_id_ref()) {
+        lookUp(card.provider_id_ref(), card.mutable_provider_id());
+        card.clear_provider_id_ref();
+    }
+}
+
+void CardNameDictionary::encode(ServerInfo_Zone &zone)
+{
+    for (ServerInfo_Card &card : *zone.mutable_card_list())
+        encodeCard(card);
+}
+
+void CardNameDictionary::decode(ServerInfo_Zone &zone) const
+{
+    for (ServerInfo_Card &card : *zone.mutable_card_list())
+        decodeCard(card);
+}
+
+void CardNameDictionary::encode(GameEventContainer &cont)
+{
+    for (GameEvent &event : *cont.mutable_event_list()) {
+        if (event.HasExtension(Event_RevealCards::ext)) {
+            for (ServerInfo_Card &card : *event.MutableExtension(Event_RevealCards::ext)->mutable_cards())
+                encodeCard(card);
+        } else if (event.HasExtension(Event_GameStateChanged::ext)) {
+            Event_GameStateChanged *gameState = event.MutableExtension(Event_GameStateChanged::ext);
+            for (ServerInfo_Player &player : *gameState->mutable_player_list())
+                for (ServerInfo_Zone &zone : *player.mutable_zone_list())
+                    encode(zone);
+        } else if (event.HasExtension(Event_MoveCard::ext)) {
+            Event_MoveCard *moveCard = event.MutableExtension(Event_MoveCard::ext);
+            if (!moveCard->card_name().empty()) {
+                moveCard->set_card_name_ref(idOf(moveCard->card_name()));
+                moveCard->clear_card_name();
+            }
+            if (!moveCard->new_card_provider_id().empty()) {
+                moveCard->set_new_card_provider_id_ref(idOf(moveCard->new_card_provider_id()));
+                moveCard->clear_new_card_provider_id();
+            }
+        }
+    }
+}
+
+void CardNameDictionary::decode(GameEventContainer &cont)
+{
+    for (GameEvent &event : *cont.mutable_event_list()) {
+        if (event.HasExtension(Event_CardNames::ext)) {
+            const Event_CardNames &cardNames = event.GetExtension(Event_CardNames::ext);
+            addNames(cardNames.first_id(), cardNames.names());
+        } else if (event.HasExtension(Event_RevealCards::ext)) {
+            for (ServerInfo_Card &card : *event.MutableExtension(Event_RevealCards::ext)->mutable_cards())
+                decodeCard(card);
+        } else if (event.HasExtension(Event_GameStateChanged::ext)) {
+            Event_GameStateChanged *gameState = event.MutableExtension(Event_GameStateChanged::ext);
+            for (ServerInfo_Player &player : *gameState->mutable_player_list())
+                for (ServerInfo_Zone &zone : *player.mutable_zone_list())
+                    decode(zone);
+        } else if (event.HasExtension(Event_MoveCard::ext)) {
+            Event_MoveCard *moveCard = event.MutableExtension(Event_MoveCard::ext);
+            if (moveCard->has_card_name_ref()) {
+                lookUp(moveCard->card_name_ref(), moveCard->mutable_card_name());
+                moveCard->clear_card_name_ref();
+            }
+            if (moveCard->has_new_card_provider_id_ref()) {
+                lookUp(moveCard->new_card_provider_id_ref(), moveCard->mutable_new_card_provider_id());
+                moveCard->clear_new_card_provider_id_ref();
+            }
+        }
+    }
+}
+
+bool CardNameDictionary::takeNewNames(Event_CardNames &event)
+{
+    if (sentCount == names.size())
+        return false;
+
+    event.set_first_id(static_cast<uint32_t>(sentCount));
+    for (; sentCount < names.size(); ++sentCount)
+        event.add_names(names[sentCount]);
+    return true;
+}
+
+void CardNameDictionary::getSentNames(google::protobuf::RepeatedPtrField<std::string> &result) const
+{
+    for (size_t i = 0; i < sentCount; ++i)
+        *result.Add() = names[i];
+}
+
+void CardNameDictionary::restoreSentNames(const google::protobuf::RepeatedPtrField<std::string> &sentNames)
+{
+    ids.clear();
+    names.clear();
+    for (const std::string &name : sentNames) {
+        ids.emplace(name, static_cast<uint32_t>(names.size()));
+        names.push_back(name);
+    }
+    sentCount = names.size();
+}
+
+void CardNameDictionary::addNames(uint32_t firstId, const google::protobuf::RepeatedPtrField<std::string> &newNames)
+{
+    const size_t end = static_cast<size_t>(firstId) + newNames.size();
+    if (names.size() < end)
+        names.resize(end);
+    for (int i = 0; i < newNames.size(); ++i)
+        names[firstId + i] = newNames.Get(i);
+}
@@ -0,0 +1,57 @@
+#ifndef CARD_NAME_DICTIONARY_H
+#define CARD_NAME_DICTIONARY_H
+
+#include <google/protobuf/repeated_field.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Event_CardNames;
+class GameEventContainer;
+class ServerInfo_Card;
+class ServerInfo_Zone;
+
+/**
+ * The card names and provider ids known to a client with the "card_name_dictionary" feature, by id, see
+ * Event_CardNames.
+ *
+ * The server keeps one for each client in a game and replaces the strings of the events listing many cards by their
+ * ids. The client keeps the same one to put the strings back before it processes the events, the rest of the client
+ * never sees the ids.
+ */
+class CardNameDictionary
+{
+public:
+    // whether the container has events that refer to a dictionary or define its names
+    static bool carriesCardNames(const GameEventContainer &cont);
+
+    // The names added while encoding are sent to the client with takeNewNames(), ahead of what was encoded.
+    void encode(GameEventContainer &cont);
+    void encode(ServerInfo_Zone &zone);
+    bool takeNewNames(Event_CardNames &event);
+    // the names the client was sent so far, for another server process to go on with, see restoreSentNames()
+    void getSentNames(google::protobuf::RepeatedPtrField<std::string> &result) const;
+    void restoreSentNames(const google::protobuf::RepeatedPtrField<std::string> &sentNames);
+
+    // adds the names of the Event_CardNames in the container before decoding the events after them
+    void decode(GameEventContainer &cont);
+    void decode(ServerInfo_Zone &zone) const;
+    void addNames(uint32_t firstId, const google::protobuf::RepeatedPtrField<std::string> &newNames);
+
+    int size() const
+    {
+        return static_cast<int>(names.size());
+    }
+
+private:
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<std::string> names;
+    size_t sentCount = 0;
+
+    uint32_t idOf(const std::string &name);
+    bool lookUp(uint32_t id, std::string *result) const;
+    void encodeCard(ServerInfo_Card &card);
+    void decodeCard(ServerInfo_Card &card) const;
+};
+
+#endif
@@ -0,0 +1,315 @@
+#include "command_trace.h"
+
+#include "pb/admin_commands.pb.h"
+#include "pb/game_commands.pb.h"
+#include "pb/moderator_commands.pb.h"
+#include "pb/room_commands.pb.h"
+#include "pb/session_commands.pb.h"
+#include "timeline_trace.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include <cmath>
+#include <google/protobuf/descriptor.h>
+
+LatencyHistogram::LatencyHistogram()
+{
+    for (auto &count : counts)
+        count.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketIndex(qint64 microseconds)
+{
+    const quint32 value = static_cast<quint32>(qBound(qint64(0), microseconds, qint64(0xffffffff)));
+    if (value < 2 * subBucketCount)
+        return static_cast<int>(value);
+
+    int highestBit = 31;
+    while (!(value & (1u << highestBit)))
+        --highestBit;
+    const int shift = highestBit - subBucketBits;
+    const int subBucket = static_cast<int>(value >> shift) - subBucketCount;
+    return 2 * subBucketCount + (shift - 1) * subBucketCount + subBucket;
+}
+
+qint64 LatencyHistogram::bucketValue(int index)
+{
+    if (index < 2 * subBucketCount)
+        return index;
+
+    const int shift = (index - 2 * subBucketCount) / subBucketCount + 1;
+    const qint64 subBucket = (index - 2 * subBucketCount) % subBucketCount + subBucketCount;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(qint64 microseconds)
+{
+    // there is a single writer, it doesn't need an atomic read-modify-write
+    std::atomic<quint32> &count = counts[bucketIndex(microseconds)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+QVector<quint64> LatencyHistogram::snapshot() const
+{
+    QVector<quint64> result(bucketCount);
+    for (int i = 0; i < bucketCount; ++i)
+        result[i] = counts[i].load(std::memory_order_relaxed);
+    return result;
+}
+
+qint64 LatencyHistogram::valueAtPercentile(const QVector<quint64> &counts, double percentile)
+{
+    quint64 total = 0;
+    for (quint64 count : counts)
+        total += count;
+    if (total == 0)
+        return 0;
+
+    const quint64 rank = qMax(quint64(1), static_cast<quint64>(std::ceil(percentile / 100.0 * total)));
+    quint64 seen = 0;
+    for (int i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank)
+            return bucketValue(i);
+    }
+    return bucketValue(counts.size() - 1);
+}
+
+namespace
+{
+
+struct CommandHistograms
+{
+    LatencyHistogram phases[CommandTrace::PhaseCount];
+};
+
+class ThreadHistograms
+{
+public:
+    // only called by the owning thread
+    CommandHistograms *get(int commandKey)
+    {
+        // the owning thread is the only one to insert, so it can look up without the lock
+        CommandHistograms *result = commands.value(commandKey);
+        if (!result) {
+            result = new CommandHistograms;
+            QMutexLocker locker(&mutex);
+            commands.insert(commandKey, result);
+        }
+        return result;
+    }
+
+    QMutex mutex;
+    QHash<int, CommandHistograms *> commands;
+};
+
+struct ReportedCounts
+{
+    QVector<quint64> phases[CommandTrace::PhaseCount];
+};
+
+class TraceRegistry
+{
+public:
+    static TraceRegistry &instance()
+    {
+        // never destroyed, pool threads might still be tracing during shutdown
+        static auto *registry = new TraceRegistry;
+        return *registry;
+    }
+
+    ThreadHistograms *histogramsOfThisThread()
+    {
+        // the histograms outlive their thread, the threads that process commands live as long as the server anyway
+        static thread_local ThreadHistograms *histograms = nullptr;
+        if (!histograms) {
+            histograms = new ThreadHistograms;
+            QMutexLocker locker(&mutex);
+            threads.append(histograms);
+        }
+        return histograms;
+    }
+
+    QList<CommandTrace::Summary> takeSummaries();
+
+private:
+    QMutex mutex;
+    QList<ThreadHistograms *> threads;
+    // what the last takeSummaries() saw, the histograms themselves are never reset
+    QHash<int, ReportedCounts> reported;
+};
+
+QList<CommandTrace::Summary> TraceRegistry::takeSummaries()
+{
+    QMutexLocker locker(&mutex);
+
+    QHash<int, ReportedCounts> current;
+    for (ThreadHistograms *thread : threads) {
+        QMutexLocker threadLocker(&thread->mutex);
+        for (auto it = thread->commands.constBegin(); it != thread->commands.constEnd(); ++it) {
+            ReportedCounts &merged = current[it.key()];
+            for (int phase = 0; phase < CommandTrace::PhaseCount; ++phase) {
+                const QVector<quint64> counts = it.value()->phases[phase].snapshot();
+                if (merged.phases[phase].isEmpty())
+                    merged.phases[phase] = counts;
+                else
+                    for (int i = 0; i < counts.size(); ++i)
+                        merged.phases[phase][i] += counts[i];
+            }
+        }
+    }
+
+    QList<CommandTrace::Summary> result;
+    for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+        const ReportedCounts &previous = reported.value(it.key());
+        CommandTrace::Summary summary;
+        summary.commandKey = it.key();
+        summary.count = 0;
+        for (int phase = 0; phase < CommandTrace::PhaseCount; ++phase) {
+            QVector<quint64> delta = it.value().phases[phase];
+            if (!previous.phases[phase].isEmpty())
+                for (int i = 0; i < delta.size(); ++i)
+                    delta[i] -= previous.phases[phase][i];
+
+            int highest = delta.size() - 1;
+            while (highest >= 0 && delta[highest] == 0)
+                --highest;
+            summary.median[phase] = LatencyHistogram::valueAtPercentile(delta, 50);
+            summary.p99[phase] = LatencyHistogram::valueAtPercentile(delta, 99);
+            summary.max[phase] = highest < 0 ? 0 : LatencyHistogram::bucketValue(highest);
+            if (phase == CommandTrace::Total)
+                for (quint64 count : delta)
+                    summary.count += count;
+        }
+        if (summary.count > 0)
+            result.append(summary);
+    }
+    reported = current;
+    return result;
+}
+
+const google::protobuf::EnumDescriptor *commandTypes(int kind)
+{
+    switch (kind) {
+        case CommandTrace::SessionCommandKind:
+            return SessionCommand::SessionCommandType_descriptor();
+        case CommandTrace::RoomCommandKind:
+            return RoomCommand::RoomCommandType_descriptor();
+        case CommandTrace::GameCommandKind:
+            return GameCommand::GameCommandType_descriptor();
+        case CommandTrace::ModeratorCommandKind:
+            return ModeratorCommand::ModeratorCommandType_descriptor();
+        case CommandTrace::AdminCommandKind:
+            return AdminCommand::AdminCommandType_descriptor();
+        default:
+            return nullptr;
+    }
+}
+
+const char *const kindNames[] = {"", "session", "room", "game", "moderator", "admin"};
+
+} // namespace
+
+QString CommandTrace::commandName(int commandKey)
+{
+    const int kind = commandKey >> 16;
+    const int commandType = commandKey & 0xffff;
+    const google::protobuf::EnumDescriptor *types = commandTypes(kind);
+    if (!types)
+        return "invalid";
+
+    const google::protobuf::EnumValueDescriptor *type = types->FindValueByNumber(commandType);
+    return QString(kindNames[kind]) + '.' +
+           (type ? QString::fromStdString(type->name()) : QString::number(commandType));
+}
+
+int CommandTrace::commandKeyFromName(const QString &name)
+{
+    const QString kindName = name.section('.', 0, 0);
+    const QString typeName = name.section('.', 1).toUpper();
+    for (int kind = SessionCommandKind; kind <= AdminCommandKind; ++kind) {
+        if (kindName.compare(kindNames[kind], Qt::CaseInsensitive) != 0)
+            continue;
+        const google::protobuf::EnumValueDescriptor *type = commandTypes(kind)->FindValueByName(typeName.toStdString());
+        return type ? commandKey(static_cast<CommandKind>(kind), type->number()) : -1;
+    }
+    return -1;
+}
+
+bool CommandTrace::start(int sampleRate, int _commandKey, qint64 _parseTime)
+{
+    static thread_local int containersSinceSample = 0;
+    sampled = sampleRate > 0 && ++containersSinceSample >= sampleRate;
+    if (sampled)
+        containersSinceSample = 0;
+    timelineStart = TimelineTrace::now();
+    if (!sampled && timelineStart == 0)
+        return false;
+
+    enabled = true;
+    commandKey = _commandKey;
+    parseTime = _parseTime;
+    timer.start();
+    return true;
+}
+
+void CommandTrace::recordTimeline(qint64 totalTime) const
+{
+    for (const Span &span : spans) {
+        const TimelineTrace::Category category =
+            span.phase == LockWait ? TimelineTrace::LockWait : TimelineTrace::Command;
+        TimelineTrace::record(category, span.label, timelineStart + span.startTime, timelineStart + span.endTime,
+                              span.commandKey == -1 ? QString() : commandName(span.commandKey));
+    }
+    TimelineTrace::record(TimelineTrace::Command, "container", timelineStart, timelineStart + totalTime,
+                          commandName(commandKey));
+}
+
+QString CommandTrace::finish(int slowThreshold)
+{
+    if (!enabled)
+        return QString();
+    const qint64 totalTime = timer.nsecsElapsed();
+    if (timelineStart != 0)
+        recordTimeline(totalTime);
+    if (!sampled)
+        return QString();
+
+    ThreadHistograms *histograms = TraceRegistry::instance().histogramsOfThisThread();
+    CommandHistograms *own = histograms->get(commandKey);
+    qint64 phaseTimes[PhaseCount] = {parseTime, 0, 0, 0, totalTime};
+    for (const Span &span : spans) {
+        const qint64 duration = span.endTime - span.startTime;
+        // the commands of a container each have a histogram of their own for their execution
+        if (span.phase == Execute && span.commandKey != -1 && span.commandKey != commandKey)
+            histograms->get(span.commandKey)->phases[Execute].record(duration / 1000);
+        else
+            phaseTimes[span.phase] += duration;
+    }
+    for (int phase = 0; phase < PhaseCount; ++phase)
+        own->phases[phase].record(phaseTimes[phase] / 1000);
+
+    if (slowThreshold <= 0 || totalTime < slowThreshold * qint64(1000000))
+        return QString();
+
+    QStringList description;
+    if (parseTime > 0)
+        description.append(QString("parse %1 us").arg(parseTime / 1000));
+    for (const Span &span : spans) {
+        const QString label = span.commandKey == -1 ? QString(span.label) : commandName(span.commandKey);
+        description.append(QString("%1 %2 us at %3 us")
+                               .arg(label)
+                               .arg((span.endTime - span.startTime) / 1000)
+                               .arg(span.startTime / 1000));
+    }
+    return QString("Slow command %1: %2 us total; %3")
+        .arg(commandName(commandKey))
+        .arg(totalTime / 1000)
+        .arg(description.join(", "));
+}
+
+QList<CommandTrace::Summary> CommandTrace::takeSummaries()
+{
+    return TraceRegistry::instance().takeSummaries();
+}
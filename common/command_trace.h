@@ -0,0 +1,143 @@
+#ifndef COMMAND_TRACE_H
+#define COMMAND_TRACE_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+#include <QVarLengthArray>
+#include <QVector>
+#include <atomic>
+
+/**
+ * A histogram of microsecond latencies in the style of HdrHistogram: every power of two is split into 16 buckets,
+ * so values are recorded with a precision of about 6% from one microsecond to over an hour, in constant space.
+ *
+ * Only one thread may record into a histogram; any thread may take a snapshot of it at any time.
+ */
+class LatencyHistogram
+{
+public:
+    static const int subBucketBits = 4;
+    static const int subBucketCount = 1 << subBucketBits;
+    // values below 2 * subBucketCount have a bucket each, every further power of two up to 2^32 has subBucketCount
+    static const int bucketCount = 2 * subBucketCount + (32 - subBucketBits - 1) * subBucketCount;
+
+    LatencyHistogram();
+    void record(qint64 microseconds);
+    QVector<quint64> snapshot() const;
+
+    static int bucketIndex(qint64 microseconds);
+    // the highest value recorded into the bucket
+    static qint64 bucketValue(int index);
+    // percentile in [0, 100]; 0 if there are no values
+    static qint64 valueAtPercentile(const QVector<quint64> &counts, double percentile);
+
+private:
+    std::atomic<quint32> counts[bucketCount];
+};
+
+/**
+ * Times the phases of processing one command container: parsing it, waiting for the server locks, executing each
+ * command and sending the response.
+ *
+ * The phases are recorded into histograms of the thread processing the container, per command type, so tracing
+ * takes no locks once a thread has seen a command type. takeSummaries() merges them for reporting. A trace that
+ * isn't enabled does nothing at all; see start().
+ */
+class CommandTrace
+{
+public:
+    enum Phase
+    {
+        Parse,
+        LockWait,
+        Execute,
+        Respond,
+        Total,
+        PhaseCount
+    };
+    // the kinds of commands a container can hold
+    enum CommandKind
+    {
+        SessionCommandKind = 1,
+        RoomCommandKind,
+        GameCommandKind,
+        ModeratorCommandKind,
+        AdminCommandKind
+    };
+
+    struct Summary
+    {
+        int commandKey;
+        quint64 count;
+        // in microseconds, by phase
+        qint64 median[PhaseCount], p99[PhaseCount], max[PhaseCount];
+    };
+
+    // identifies one command type across all kinds of commands
+    static int commandKey(CommandKind kind, int commandType)
+    {
+        return kind << 16 | commandType;
+    }
+    // e.g. "game.DUMP_ZONE"
+    static QString commandName(int commandKey);
+    // the inverse of commandName(), case insensitive; -1 for unknown names
+    static int commandKeyFromName(const QString &name);
+
+    CommandTrace() : enabled(false), sampled(false), commandKey(-1), parseTime(0), timelineStart(0)
+    {
+    }
+
+    /**
+     * Starts tracing every sampleRate-th container processed by this thread, none at all for 0. parseTime is the
+     * time in nanoseconds it took to parse the container. Returns whether this trace is enabled. While the
+     * TimelineTrace runs, every container is traced for the timeline, the histograms still only get the sampled ones.
+     */
+    bool start(int sampleRate, int _commandKey, qint64 _parseTime);
+    bool isEnabled() const
+    {
+        return enabled;
+    }
+
+    // nanoseconds since start(); pass the result to addSpan() once the phase is over
+    qint64 now() const
+    {
+        return enabled ? timer.nsecsElapsed() : 0;
+    }
+    // label has to be a string literal; commands without a key of their own belong to the command of the trace
+    void addSpan(Phase phase, const char *label, qint64 startTime, int spanCommandKey = -1)
+    {
+        if (enabled)
+            spans.append({phase, label, spanCommandKey, startTime, timer.nsecsElapsed()});
+    }
+
+    /**
+     * Records the trace into the histograms of this thread and the timeline. If it took at least slowThreshold
+     * milliseconds (and slowThreshold is not 0), a description of the trace is returned to be logged.
+     */
+    QString finish(int slowThreshold);
+
+    // what all threads recorded since the last call, merged per command type
+    static QList<Summary> takeSummaries();
+
+private:
+    struct Span
+    {
+        Phase phase;
+        const char *label;
+        int commandKey;
+        qint64 startTime, endTime;
+    };
+
+    bool enabled, sampled;
+    int commandKey;
+    qint64 parseTime;
+    QElapsedTimer timer;
+    // when the trace started on the clock of the timeline, 0 if it isn't running
+    qint64 timelineStart;
+    QVarLengthArray<Span, 8> spans;
+
+    void recordTimeline(qint64 totalTime) const;
+};
+
+#endif
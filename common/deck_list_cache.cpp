@@ -0,0 +1,46 @@
+#include "deck_list_cache.h"
+
+#include "decklist.h"
+#include "string_atom.h"
+
+#include <QCryptographicHash>
+
+DeckListCache::DeckListCache(int maxDecks) : decks(maxDecks), hits(0), misses(0)
+{
+}
+
+void DeckListCache::setMaxDecks(int maxDecks)
+{
+    QMutexLocker locker(&mutex);
+    decks.setMaxCost(maxDecks);
+}
+
+DeckList *DeckListCache::load(const QString &nativeString)
+{
+    // the text rather than the deck hash is the key, decks with the same cards can differ in name, comments or plans
+    const QByteArray key = QCryptographicHash::hash(nativeString.toUtf8(), QCryptographicHash::Sha256);
+    {
+        QMutexLocker locker(&mutex);
+        if (const DeckList *cachedDeck = decks.object(key)) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return new DeckList(*cachedDeck);
+        }
+    }
+    misses.fetch_add(1, std::memory_order_relaxed);
+
+    auto *deck = new DeckList(nativeString);
+    // Let the deck share the interned copies of the strings used by the cards of all running games
+    // instead of keeping its own copy of every card name.
+    deck->forEachCard([](InnerDecklistNode *, DecklistCardNode *card) {
+        card->setName(StringAtom(card->getName()).toString());
+        card->setCardProviderId(StringAtom(card->getCardProviderId()).toString());
+    });
+    // computed now, so the copies don't compute it again
+    deck->getDeckHash();
+
+    QMutexLocker locker(&mutex);
+    if (decks.maxCost() > 0) {
+        decks.insert(key, new DeckList(*deck));
+    }
+    return deck;
+}
@@ -0,0 +1,47 @@
+#ifndef DECK_LIST_CACHE_H
+#define DECK_LIST_CACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+
+class DeckList;
+
+/**
+ * Parsed copies of the decks selected recently, by the SHA-256 of their text.
+ *
+ * A deck that's selected again, by the same player in the next game or by anyone using the same list, is copied from
+ * the cache instead of being parsed again. The cards of the decks share the interned copies of their strings (see
+ * StringAtom), and so do the copies handed out. The cache is LRU bounded and thread safe; with a size of 0 every deck
+ * is parsed.
+ */
+class DeckListCache
+{
+public:
+    struct Counters
+    {
+        quint64 hits, misses;
+    };
+
+    explicit DeckListCache(int maxDecks = 0);
+
+    void setMaxDecks(int maxDecks);
+    /**
+     * Returns a new deck read from nativeString, owned by the caller.
+     */
+    DeckList *load(const QString &nativeString);
+
+    Counters getCounters() const
+    {
+        return {hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed)};
+    }
+
+private:
+    QMutex mutex;
+    QCache<QByteArray, DeckList> decks;
+    std::atomic<quint64> hits, misses;
+};
+
+#endif
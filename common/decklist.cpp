@@ -274,19 +274,21 @@ bool InnerDecklistNode::readElement(QXmlStreamReader *xml)
 {
     while (!xml->atEnd()) {
         xml->readNext();
-        const QString childName = xml->name().toString();
+        // the names are compared without copying them, this runs for every token of every deck that is loaded
+        const auto childName = xml->name();
         if (xml->isStartElement()) {
-            if (childName == "zone") {
-                InnerDecklistNode *newZone = new InnerDecklistNode(xml->attributes().value("name").toString(), this);
+            const QXmlStreamAttributes attributes = xml->attributes();
+            if (childName == QLatin1String("zone")) {
+                InnerDecklistNode *newZone = new InnerDecklistNode(attributes.value("name").toString(), this);
                 newZone->readElement(xml);
-            } else if (childName == "card") {
+            } else if (childName == QLatin1String("card")) {
                 DecklistCardNode *newCard = new DecklistCardNode(
-                    xml->attributes().value("name").toString(), xml->attributes().value("number").toString().toInt(),
-                    this, -1, xml->attributes().value("setShortName").toString(),
-                    xml->attributes().value("collectorNumber").toString(), xml->attributes().value("uuid").toString());
+                    attributes.value("name").toString(), attributes.value("number").toInt(), this, -1,
+                    attributes.value("setShortName").toString(), attributes.value("collectorNumber").toString(),
+                    attributes.value("uuid").toString());
                 newCard->readElement(xml);
             }
-        } else if (xml->isEndElement() && (childName == "zone"))
+        } else if (xml->isEndElement() && (childName == QLatin1String("zone")))
             return false;
     }
     return true;
@@ -305,7 +307,7 @@ bool AbstractDecklistCardNode::readElement(QXmlStreamReader *xml)
 {
     while (!xml->atEnd()) {
         xml->readNext();
-        if (xml->isEndElement() && xml->name().toString() == "card")
+        if (xml->isEndElement() && xml->name() == QLatin1String("card"))
             return false;
     }
     return true;
@@ -413,29 +415,29 @@ void DeckList::setCurrentSideboardPlan(const QList<MoveCard_ToZone> &plan)
 
 bool DeckList::readElement(QXmlStreamReader *xml)
 {
-    const QString childName = xml->name().toString();
+    const auto childName = xml->name();
     if (xml->isStartElement()) {
-        if (childName == "lastLoadedTimestamp") {
+        if (childName == QLatin1String("lastLoadedTimestamp")) {
             lastLoadedTimestamp = xml->readElementText();
-        } else if (childName == "deckname") {
+        } else if (childName == QLatin1String("deckname")) {
             name = xml->readElementText();
-        } else if (childName == "comments") {
+        } else if (childName == QLatin1String("comments")) {
             comments = xml->readElementText();
-        } else if (childName == "bannerCard") {
+        } else if (childName == QLatin1String("bannerCard")) {
             QString providerId = xml->attributes().value("providerId").toString();
             QString cardName = xml->readElementText();
             bannerCard = {cardName, providerId};
-        } else if (childName == "tags") {
+        } else if (childName == QLatin1String("tags")) {
             tags.clear(); // Clear existing tags
             while (xml->readNextStartElement()) {
-                if (xml->name().toString() == "tag") {
+                if (xml->name() == QLatin1String("tag")) {
                     tags.append(xml->readElementText());
                 }
             }
-        } else if (childName == "zone") {
+        } else if (childName == QLatin1String("zone")) {
             InnerDecklistNode *newZone = getZoneObjFromName(xml->attributes().value("name").toString());
             newZone->readElement(xml);
-        } else if (childName == "sideboard_plan") {
+        } else if (childName == QLatin1String("sideboard_plan")) {
             SideboardPlan *newSideboardPlan = new SideboardPlan;
             if (newSideboardPlan->readElement(xml)) {
                 sideboardPlans.insert(newSideboardPlan->getName(), newSideboardPlan);
@@ -443,7 +445,7 @@ bool DeckList::readElement(QXmlStreamReader *xml)
                 delete newSideboardPlan;
             }
         }
-    } else if (xml->isEndElement() && (childName == "cockatrice_deck")) {
+    } else if (xml->isEndElement() && (childName == QLatin1String("cockatrice_deck"))) {
         return false;
     }
     return true;
@@ -553,32 +555,33 @@ bool DeckList::saveToFile_Native(QIODevice *device)
  */
 bool DeckList::loadFromStream_Plain(QTextStream &in, bool preserveMetadata)
 {
-    const QRegularExpression reCardLine(R"(^\s*[\w\[\(\{].*$)", QRegularExpression::UseUnicodePropertiesOption);
-    const QRegularExpression reEmpty("^\\s*$");
-    const QRegularExpression reComment(R"([\w\[\(\{].*$)", QRegularExpression::UseUnicodePropertiesOption);
-    const QRegularExpression reSBMark("^\\s*sb:\\s*(.+)", QRegularExpression::CaseInsensitiveOption);
-    const QRegularExpression reSBComment("^sideboard\\b.*$", QRegularExpression::CaseInsensitiveOption);
-    const QRegularExpression reDeckComment("^((main)?deck(list)?|mainboard)\\b",
-                                           QRegularExpression::CaseInsensitiveOption);
+    // the expressions are compiled once, decks are often imported in bulk
+    static const QRegularExpression reCardLine(R"(^\s*[\w\[\(\{].*$)", QRegularExpression::UseUnicodePropertiesOption);
+    static const QRegularExpression reEmpty("^\\s*$");
+    static const QRegularExpression reComment(R"([\w\[\(\{].*$)", QRegularExpression::UseUnicodePropertiesOption);
+    static const QRegularExpression reSBMark("^\\s*sb:\\s*(.+)", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression reSBComment("^sideboard\\b.*$", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression reDeckComment("^((main)?deck(list)?|mainboard)\\b",
+                                                  QRegularExpression::CaseInsensitiveOption);
 
     // Regex for advanced card parsing
-    const QRegularExpression reMultiplier(R"(^[xX\(\[]*(\d+)[xX\*\)\]]* ?(.+))");
-    const QRegularExpression reSplitCard(R"( ?\/\/ ?)");
-    const QRegularExpression reBrace(R"( ?[\[\{][^\]\}]*[\]\}] ?)"); // not nested
-    const QRegularExpression reRoundBrace(R"(^\([^\)]*\) ?)");       // () are only matched at start of string
-    const QRegularExpression reDigitBrace(R"( ?\(\d*\) ?)");         // () are matched if containing digits
-    const QRegularExpression reBraceDigit(
+    static const QRegularExpression reMultiplier(R"(^[xX\(\[]*(\d+)[xX\*\)\]]* ?(.+))");
+    static const QRegularExpression reSplitCard(R"( ?\/\/ ?)");
+    static const QRegularExpression reBrace(R"( ?[\[\{][^\]\}]*[\]\}] ?)"); // not nested
+    static const QRegularExpression reRoundBrace(R"(^\([^\)]*\) ?)");       // () are only matched at start of string
+    static const QRegularExpression reDigitBrace(R"( ?\(\d*\) ?)");         // () are matched if containing digits
+    static const QRegularExpression reBraceDigit(
         R"( ?\([\dA-Z]+\) *\d+$)"); // () are matched if containing setcode then a number
-    const QRegularExpression reDoubleFacedMarker(R"( ?\(Transform\) ?)");
+    static const QRegularExpression reDoubleFacedMarker(R"( ?\(Transform\) ?)");
 
     // Regex for extracting set code and collector number with attached symbols
-    const QRegularExpression reHyphenFormat(R"(\((\w{3,})\)\s+(\w{3,})-(\d+[^\w\s]*))");
-    const QRegularExpression reRegularFormat(R"(\((\w{3,})\)\s+(\d+[^\w\s]*))");
+    static const QRegularExpression reHyphenFormat(R"(\((\w{3,})\)\s+(\w{3,})-(\d+[^\w\s]*))");
+    static const QRegularExpression reRegularFormat(R"(\((\w{3,})\)\s+(\d+[^\w\s]*))");
 
-    const QHash<QRegularExpression, QString> differences{{QRegularExpression("’"), QString("'")},
-                                                         {QRegularExpression("Æ"), QString("Ae")},
-                                                         {QRegularExpression("æ"), QString("ae")},
-                                                         {QRegularExpression(" ?[|/]+ ?"), QString(" // ")}};
+    static const QRegularExpression reSplitSeparator(" ?[|/]+ ?");
+    // plain characters don't need a regex to be replaced
+    static const QList<QPair<QString, QString>> differences{
+        {QString("’"), QString("'")}, {QString("Æ"), QString("Ae")}, {QString("æ"), QString("ae")}};
 
     cleanList(preserveMetadata);
 
@@ -722,9 +725,10 @@ bool DeckList::loadFromStream_Plain(QTextStream &in, bool preserveMetadata)
         cardName.remove(reBraceDigit); // very specific format with the set code in () and collectors number after
 
         // Normalize names
-        for (auto diff = differences.constBegin(); diff != differences.constEnd(); ++diff) {
-            cardName.replace(diff.key(), diff.value());
+        for (const auto &diff : differences) {
+            cardName.replace(diff.first, diff.second);
         }
+        cardName.replace(reSplitSeparator, " // ");
 
         // Resolve complete card name, this function does nothing if the name is not found
         cardName = getCompleteCardName(cardName);
@@ -26,6 +26,13 @@ void FeatureSet::initalizeFeatureList(QMap<QString, bool> &_featureList)
     _featureList.insert("idle_client", false);
     _featureList.insert("forgot_password", false);
     _featureList.insert("websocket", false);
+    _featureList.insert("compressed_messages", false);
+    _featureList.insert("ping_vector", false);
+    _featureList.insert("batched_messages", false);
+    _featureList.insert("varint_frames", false);
+    _featureList.insert("compressed_replays", false);
+    _featureList.insert("avatar_hashes", false);
+    _featureList.insert("card_name_dictionary", false);
     // featureList.insert("hashed_password_login", false);
     // These are temp to force users onto a newer client
     _featureList.insert("2.7.0_min_version", false);
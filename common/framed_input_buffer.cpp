@@ -0,0 +1,57 @@
+#include "framed_input_buffer.h"
+
+#include <cstring>
+
+FramedInputBuffer::FramedInputBuffer() : readPos(0)
+{
+}
+
+void FramedInputBuffer::append(const QByteArray &data)
+{
+    if (readPos > 0) {
+        if (readPos == buffer.size()) {
+            buffer.clear();
+            readPos = 0;
+        } else if (readPos >= buffer.size() / 2) {
+            buffer.remove(0, readPos);
+            readPos = 0;
+        }
+    }
+
+    if (buffer.isEmpty()) {
+        // avoids a copy, QByteArray is implicitly shared
+        buffer = data;
+    } else {
+        buffer.append(data);
+    }
+}
+
+void FramedInputBuffer::clear()
+{
+    buffer.clear();
+    readPos = 0;
+}
+
+bool FramedInputBuffer::startsWith(const char *prefix) const
+{
+    const auto prefixLength = static_cast<int>(strlen(prefix));
+    return size() >= prefixLength && memcmp(data(), prefix, prefixLength) == 0;
+}
+
+bool FramedInputBuffer::takeLength(int &length)
+{
+    if (size() < 4) {
+        return false;
+    }
+
+    const char *header = data();
+    length = (int)((((quint32)(unsigned char)header[0]) << 24) + (((quint32)(unsigned char)header[1]) << 16) +
+                   (((quint32)(unsigned char)header[2]) << 8) + ((quint32)(unsigned char)header[3]));
+    readPos += 4;
+    return true;
+}
+
+void FramedInputBuffer::skip(int length)
+{
+    readPos += qMin(length, size());
+}
@@ -0,0 +1,56 @@
+#ifndef FRAMED_INPUT_BUFFER_H
+#define FRAMED_INPUT_BUFFER_H
+
+#include <QByteArray>
+
+/**
+ * Input stage for length prefixed protocol streams.
+ *
+ * Received data is appended at the end and consumed through a read cursor, so that messages can be parsed in place
+ * (e.g. with ParseFromArray(data(), length)) without moving the remaining data after every message. The consumed part
+ * is only discarded once it makes up at least half of the buffer, which keeps the number of copied bytes linear in the
+ * amount of received data even when a peer pipelines many small messages into a single packet.
+ */
+class FramedInputBuffer
+{
+public:
+    FramedInputBuffer();
+
+    void append(const QByteArray &data);
+    void clear();
+
+    // number of unread bytes
+    int size() const
+    {
+        return buffer.size() - readPos;
+    }
+    bool isEmpty() const
+    {
+        return size() == 0;
+    }
+    // pointer to the first unread byte, valid until the next call to a non-const function
+    const char *data() const
+    {
+        return buffer.constData() + readPos;
+    }
+    bool startsWith(const char *prefix) const;
+
+    /**
+     * Reads a 32 bit big endian length prefix at the read cursor and consumes it.
+     * @return false if fewer than four bytes are available
+     */
+    bool takeLength(int &length);
+    void skip(int length);
+
+    // copy of the unread bytes, for debug output
+    QByteArray peekAll() const
+    {
+        return QByteArray(data(), size());
+    }
+
+private:
+    QByteArray buffer;
+    int readPos;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "game_executor.h"
+
+#include <chrono>
+
+static qint64 steadyMicroseconds()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+GameExecutor::GameExecutor(int threadCount)
+{
+    for (int i = 0; i < threadCount; ++i) {
+        auto *worker = new GameExecutorWorker;
+        auto *thread = new QThread;
+        thread->setObjectName("game executor " + QString::number(i));
+        worker->moveToThread(thread);
+        QObject::connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+        thread->start();
+
+        threads.append(thread);
+        workers.append(worker);
+    }
+}
+
+GameExecutor::~GameExecutor()
+{
+    // the tasks still in the mailboxes are dropped, their users are gone by now
+    for (QThread *thread : threads) {
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+}
+
+void GameExecutor::post(int gameId, Task task)
+{
+    workers.at(static_cast<int>(static_cast<unsigned int>(gameId) % static_cast<unsigned int>(workers.size())))
+        ->post(std::move(task));
+}
+
+int GameExecutor::getQueueDepth() const
+{
+    int depth = 0;
+    for (const GameExecutorWorker *worker : workers)
+        depth += worker->getQueueDepth();
+    return depth;
+}
+
+GameExecutorWorker::GameExecutorWorker() : scheduled(false), queueDepth(0)
+{
+}
+
+void GameExecutorWorker::post(GameExecutor::Task task)
+{
+    PostedTask postedTask;
+    postedTask.task = std::move(task);
+    postedTask.postedAt = steadyMicroseconds();
+    queueDepth.fetch_add(1, std::memory_order_relaxed);
+    mailbox.push(std::move(postedTask));
+
+    if (!scheduled.exchange(true))
+        QMetaObject::invokeMethod(this, "drain", Qt::QueuedConnection);
+}
+
+void GameExecutorWorker::drain()
+{
+    PostedTask postedTask;
+    for (;;) {
+        while (mailbox.pop(postedTask)) {
+            queueDepth.fetch_sub(1, std::memory_order_relaxed);
+            postedTask.task(steadyMicroseconds() - postedTask.postedAt);
+            postedTask.task = nullptr;
+        }
+
+        // A post that came in after the mailbox ran empty either sees this and wakes the worker up again, or
+        // happened before it and is popped by the next round. A post that is still linking its node is the first
+        // case, it only looks at the flag once its task can be popped.
+        scheduled.exchange(false);
+        if (mailbox.isEmpty() || scheduled.exchange(true))
+            return;
+    }
+}
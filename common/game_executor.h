@@ -0,0 +1,77 @@
+#ifndef GAME_EXECUTOR_H
+#define GAME_EXECUTOR_H
+
+#include "mpsc_queue.h"
+
+#include <QList>
+#include <QObject>
+#include <QThread>
+#include <atomic>
+#include <functional>
+
+class GameExecutorWorker;
+
+/**
+ * Runs the game commands of the users on threads of their own instead of the connection pool threads.
+ *
+ * Every game is pinned to one of a fixed number of workers by its id, so the commands of a game run one after the
+ * other in the order they were posted, and the commands of two games on different workers never wait for each other.
+ * The connection threads only post tasks to the mailbox of the worker, which is lock free; the worker is woken up
+ * through its event loop once per burst of tasks.
+ */
+class GameExecutor
+{
+public:
+    // mailboxMicroseconds is how long the task waited in the mailbox
+    using Task = std::function<void(qint64 mailboxMicroseconds)>;
+
+    explicit GameExecutor(int threadCount);
+    ~GameExecutor();
+    GameExecutor(const GameExecutor &) = delete;
+    GameExecutor &operator=(const GameExecutor &) = delete;
+
+    int getThreadCount() const
+    {
+        return threads.size();
+    }
+    QThread *getThread(int index) const
+    {
+        return threads.at(index);
+    }
+    // any thread
+    void post(int gameId, Task task);
+    int getQueueDepth() const;
+
+private:
+    QList<QThread *> threads;
+    QList<GameExecutorWorker *> workers;
+};
+
+class GameExecutorWorker : public QObject
+{
+    Q_OBJECT
+public:
+    GameExecutorWorker();
+    void post(GameExecutor::Task task);
+    int getQueueDepth() const
+    {
+        return queueDepth.load(std::memory_order_relaxed);
+    }
+
+private slots:
+    void drain();
+
+private:
+    struct PostedTask
+    {
+        GameExecutor::Task task;
+        qint64 postedAt = 0;
+    };
+
+    MpscQueue<PostedTask> mailbox;
+    // set by the first post after a drain, so that only that one wakes the worker up
+    std::atomic<bool> scheduled;
+    std::atomic<int> queueDepth;
+};
+
+#endif
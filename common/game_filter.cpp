@@ -0,0 +1,65 @@
+#include "game_filter.h"
+
+#include "pb/serverinfo_game.pb.h"
+
+GameFilter::GameFilter(const ServerInfo_GameFilter &_filter, bool _userIsRegistered)
+    : filter(_filter), userIsRegistered(_userIsRegistered),
+      gameNameFilter(QString::fromStdString(_filter.game_name_filter())),
+      creatorNameFilter(QString::fromStdString(_filter.creator_name_filter()))
+{
+    for (int gameType : _filter.game_type_ids())
+        gameTypeFilter.insert(gameType);
+}
+
+bool GameFilter::accepts(const ServerInfo_Game &game, qint64 now) const
+{
+    if (game.closed())
+        return false;
+    if (filter.hide_buddies_only_games() && game.only_buddies())
+        return false;
+    if (filter.hide_full_games() && game.player_count() == game.max_players())
+        return false;
+    if (filter.hide_games_that_started() && game.started())
+        return false;
+    if (!userIsRegistered && game.only_registered())
+        return false;
+    if (filter.hide_password_protected_games() && game.with_password())
+        return false;
+    if (!gameNameFilter.isEmpty() &&
+        !QString::fromStdString(game.description()).contains(gameNameFilter, Qt::CaseInsensitive))
+        return false;
+    if (!creatorNameFilter.isEmpty() &&
+        !QString::fromStdString(game.creator_info().name()).contains(creatorNameFilter, Qt::CaseInsensitive))
+        return false;
+
+    if (!gameTypeFilter.isEmpty()) {
+        bool hasGameType = false;
+        for (int gameType : game.game_types())
+            if (gameTypeFilter.contains(gameType)) {
+                hasGameType = true;
+                break;
+            }
+        if (!hasGameType)
+            return false;
+    }
+
+    if (filter.has_max_players_min() && game.max_players() < filter.max_players_min())
+        return false;
+    if (filter.has_max_players_max() && game.max_players() > filter.max_players_max())
+        return false;
+    // games shouldn't have negative ages but we'll not filter them
+    if (filter.max_game_age() > 0 && now - static_cast<qint64>(game.start_time()) > filter.max_game_age())
+        return false;
+
+    if (filter.show_only_if_spectators_can_watch()) {
+        if (!game.spectators_allowed())
+            return false;
+        if (!filter.show_spectator_password_protected() && game.spectators_need_password())
+            return false;
+        if (filter.show_only_if_spectators_can_chat() && !game.spectators_can_chat())
+            return false;
+        if (filter.show_only_if_spectators_can_see_hands() && !game.spectators_omniscient())
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,29 @@
+#ifndef GAME_FILTER_H
+#define GAME_FILTER_H
+
+#include "pb/serverinfo_game_filter.pb.h"
+
+#include <QSet>
+#include <QString>
+
+class ServerInfo_Game;
+
+/**
+ * Evaluates the game list filter a client set with Command_SetGameFilter, the same way the client's GamesProxyModel
+ * does.
+ */
+class GameFilter
+{
+private:
+    ServerInfo_GameFilter filter;
+    bool userIsRegistered;
+    QString gameNameFilter, creatorNameFilter;
+    QSet<int> gameTypeFilter;
+
+public:
+    GameFilter(const ServerInfo_GameFilter &_filter, bool _userIsRegistered);
+    // now is in seconds since the epoch, for the age of the game
+    bool accepts(const ServerInfo_Game &game, qint64 now) const;
+};
+
+#endif
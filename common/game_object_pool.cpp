@@ -0,0 +1,114 @@
+#include "game_object_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+GameObjectPool::GameObjectPool() : allocatedBytes(0), liveObjects(0), released(false)
+{
+}
+
+GameObjectPool::~GameObjectPool()
+{
+    for (void *slab : slabs)
+        std::free(slab);
+}
+
+void GameObjectPool::release()
+{
+    mutex.lock();
+    released = true;
+    const bool unused = liveObjects == 0;
+    mutex.unlock();
+
+    if (unused)
+        delete this;
+}
+
+void *GameObjectPool::allocate(std::size_t size)
+{
+    QMutexLocker locker(&mutex);
+
+    int sizeClass = 0;
+    while (sizeClass < sizeClasses.size() && sizeClasses[sizeClass].objectSize != size)
+        ++sizeClass;
+    if (sizeClass == sizeClasses.size())
+        sizeClasses.append({size, nullptr});
+    if (!sizeClasses[sizeClass].freeList)
+        addSlab(sizeClass);
+
+    // the free blocks are linked through the memory after their header
+    auto *header = static_cast<BlockHeader *>(sizeClasses[sizeClass].freeList);
+    void *object = reinterpret_cast<char *>(header) + headerSize;
+    sizeClasses[sizeClass].freeList = *static_cast<void **>(object);
+    header->pool = this;
+    header->sizeClass = sizeClass;
+    ++liveObjects;
+    return object;
+}
+
+void *GameObjectPool::allocateUnpooled(std::size_t size)
+{
+    void *block = std::malloc(headerSize + size);
+    if (!block)
+        throw std::bad_alloc();
+    auto *header = static_cast<BlockHeader *>(block);
+    header->pool = nullptr;
+    header->sizeClass = -1;
+    return static_cast<char *>(block) + headerSize;
+}
+
+void GameObjectPool::deallocate(void *object)
+{
+    if (!object)
+        return;
+    auto *header = reinterpret_cast<BlockHeader *>(static_cast<char *>(object) - headerSize);
+    if (header->pool)
+        header->pool->free(header);
+    else
+        std::free(header);
+}
+
+int GameObjectPool::getLiveObjectCount() const
+{
+    QMutexLocker locker(&mutex);
+    return liveObjects;
+}
+
+qint64 GameObjectPool::getAllocatedBytes() const
+{
+    QMutexLocker locker(&mutex);
+    return allocatedBytes;
+}
+
+void GameObjectPool::addSlab(int sizeClass)
+{
+    // the free list pointer has to fit into a free block
+    const std::size_t objectSize = std::max(sizeClasses[sizeClass].objectSize, sizeof(void *));
+    const std::size_t blockSize = (headerSize + objectSize + alignof(std::max_align_t) - 1) /
+                                  alignof(std::max_align_t) * alignof(std::max_align_t);
+    char *slab = static_cast<char *>(std::malloc(blockSize * blocksPerSlab));
+    if (!slab)
+        throw std::bad_alloc();
+    slabs.append(slab);
+    allocatedBytes += static_cast<qint64>(blockSize * blocksPerSlab);
+
+    for (int i = blocksPerSlab - 1; i >= 0; --i) {
+        char *block = slab + i * blockSize;
+        *reinterpret_cast<void **>(block + headerSize) = sizeClasses[sizeClass].freeList;
+        sizeClasses[sizeClass].freeList = block;
+    }
+}
+
+void GameObjectPool::free(BlockHeader *header)
+{
+    mutex.lock();
+    SizeClass &sizeClass = sizeClasses[header->sizeClass];
+    *reinterpret_cast<void **>(reinterpret_cast<char *>(header) + headerSize) = sizeClass.freeList;
+    sizeClass.freeList = header;
+    const bool unused = --liveObjects == 0 && released;
+    mutex.unlock();
+
+    if (unused)
+        delete this;
+}
@@ -0,0 +1,96 @@
+#ifndef GAME_OBJECT_POOL_H
+#define GAME_OBJECT_POOL_H
+
+#include <QList>
+#include <QMutex>
+#include <QVarLengthArray>
+#include <cstddef>
+
+/**
+ * The memory of the cards, arrows and counters of one game. Objects of the same size share fixed size blocks that are
+ * carved from larger slabs, and a deleted object's block is reused for the next one, so tokens being created and
+ * destroyed all game long don't go through malloc. The slabs are freed all at once, when the game ended and the last
+ * of its objects is gone.
+ *
+ * Every block starts with a header naming its pool, so objects can be deleted the usual way, even with
+ * deleteLater() after their game ended.
+ */
+class GameObjectPool
+{
+public:
+    GameObjectPool();
+    GameObjectPool(const GameObjectPool &) = delete;
+    GameObjectPool &operator=(const GameObjectPool &) = delete;
+
+    /**
+     * Called by the game when it ends, instead of deleting the pool; the pool goes away with its last object.
+     */
+    void release();
+
+    void *allocate(std::size_t size);
+    // frees what allocate() or allocateUnpooled() returned
+    static void deallocate(void *object);
+    // a block outside of any pool, for objects created without a game
+    static void *allocateUnpooled(std::size_t size);
+
+    int getLiveObjectCount() const;
+    // the size of the slabs, whether their blocks are in use or not
+    qint64 getAllocatedBytes() const;
+
+private:
+    ~GameObjectPool();
+
+    struct BlockHeader
+    {
+        GameObjectPool *pool;
+        int sizeClass;
+    };
+    struct SizeClass
+    {
+        std::size_t objectSize;
+        void *freeList;
+    };
+    static const int blocksPerSlab = 64;
+    // the header is padded so that the objects keep the strictest alignment
+    static const std::size_t headerSize =
+        (sizeof(BlockHeader) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    mutable QMutex mutex;
+    // a game only has cards, arrows and counters
+    QVarLengthArray<SizeClass, 4> sizeClasses;
+    QList<void *> slabs;
+    qint64 allocatedBytes;
+    int liveObjects;
+    bool released;
+
+    void addSlab(int sizeClass);
+    void free(BlockHeader *header);
+};
+
+/**
+ * Base of the objects that can be allocated from a GameObjectPool with new (pool) T(...). Plain new still works and
+ * allocates outside of any pool; delete works for both.
+ */
+class PooledGameObject
+{
+public:
+    static void *operator new(std::size_t size, GameObjectPool *pool)
+    {
+        return pool ? pool->allocate(size) : GameObjectPool::allocateUnpooled(size);
+    }
+    static void *operator new(std::size_t size)
+    {
+        return GameObjectPool::allocateUnpooled(size);
+    }
+    static void operator delete(void *object)
+    {
+        GameObjectPool::deallocate(object);
+    }
+    // only used if a constructor throws
+    static void operator delete(void *object, GameObjectPool * /* pool */)
+    {
+        GameObjectPool::deallocate(object);
+    }
+};
+
+#endif
@@ -0,0 +1,176 @@
+#include "game_replay_writer.h"
+
+#include "pb/game_event_container.pb.h"
+#include "pb/game_replay.pb.h"
+
+#include <QDebug>
+#include <QDir>
+
+static const QString spoolFilePrefix = "replay_";
+static const QString spoolFileSuffix = ".spool";
+
+// key of a length delimited GameReplay.event_list entry: field number 3, wire type 2
+static const char eventListKey = (GameReplay::kEventListFieldNumber << 3) | 2;
+
+static void appendVarint(QByteArray &data, quint64 value)
+{
+    while (value >= 0x80) {
+        data.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    data.append(static_cast<char>(value));
+}
+
+GameReplayWriter::GameReplayWriter(qint64 _replayId, const ServerInfo_Game &_gameInfo, const QString &spoolDirectory)
+    : replayId(_replayId), gameInfo(_gameInfo), durationSeconds(0), memoryReplay(nullptr), memoryBytes(0)
+{
+    GameReplay header;
+    header.set_replay_id(replayId);
+    header.mutable_game_info()->CopyFrom(gameInfo);
+
+    if (!openSpoolFile(spoolDirectory, header)) {
+        memoryReplay = new GameReplay;
+        memoryReplay->Swap(&header);
+    }
+}
+
+GameReplayWriter::GameReplayWriter(qint64 _replayId,
+                                   const ServerInfo_Game &_gameInfo,
+                                   int _durationSeconds,
+                                   const QString &spoolFileName,
+                                   const QByteArray &contents)
+    : replayId(_replayId), gameInfo(_gameInfo), durationSeconds(_durationSeconds), memoryReplay(nullptr),
+      memoryBytes(0)
+{
+    if (!spoolFileName.isEmpty()) {
+        spoolFile.setFileName(spoolFileName);
+        if (spoolFile.open(QIODevice::WriteOnly | QIODevice::Append))
+            return;
+        qWarning() << "GameReplayWriter: could not reopen" << spoolFile.fileName() << spoolFile.errorString();
+    }
+
+    memoryReplay = new GameReplay;
+    if (!memoryReplay->ParseFromArray(contents.constData(), contents.size()) || !memoryReplay->has_replay_id()) {
+        memoryReplay->Clear();
+        memoryReplay->set_replay_id(replayId);
+        memoryReplay->mutable_game_info()->CopyFrom(gameInfo);
+    }
+    memoryBytes = contents.size();
+}
+
+GameReplayWriter::~GameReplayWriter()
+{
+    delete memoryReplay;
+    if (spoolFile.isOpen()) {
+        spoolFile.close();
+        spoolFile.remove();
+    }
+}
+
+bool GameReplayWriter::openSpoolFile(const QString &spoolDirectory, const GameReplay &contents)
+{
+    // replays without a valid id can't be recovered later on, there is no point in spooling them
+    if (spoolDirectory.isEmpty() || replayId < 0)
+        return false;
+
+    spoolFile.setFileName(spoolFilePath(spoolDirectory, replayId));
+    if (!spoolFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "GameReplayWriter: could not create" << spoolFile.fileName() << spoolFile.errorString();
+        return false;
+    }
+    const std::string data = contents.SerializeAsString();
+    if (spoolFile.write(data.data(), static_cast<qint64>(data.size())) < 0 || !spoolFile.flush()) {
+        qWarning() << "GameReplayWriter: could not write" << spoolFile.fileName() << spoolFile.errorString();
+        spoolFile.close();
+        spoolFile.remove();
+        return false;
+    }
+    return true;
+}
+
+bool GameReplayWriter::spool(const QString &spoolDirectory)
+{
+    if (!memoryReplay)
+        return true;
+    if (!openSpoolFile(spoolDirectory, *memoryReplay))
+        return false;
+    delete memoryReplay;
+    memoryReplay = nullptr;
+    memoryBytes = 0;
+    return true;
+}
+
+QByteArray GameReplayWriter::detach()
+{
+    if (spoolFile.isOpen()) {
+        // closed without being removed, the events recorded from now on are lost
+        spoolFile.flush();
+        spoolFile.close();
+        return QByteArray();
+    }
+    const QByteArray contents = QByteArray::fromStdString(memoryReplay->SerializeAsString());
+    memoryReplay->clear_event_list();
+    memoryBytes = 0;
+    return contents;
+}
+
+QString GameReplayWriter::spoolFilePath(const QString &spoolDirectory, qint64 replayId)
+{
+    return QDir(spoolDirectory).filePath(spoolFilePrefix + QString::number(replayId) + spoolFileSuffix);
+}
+
+qint64 GameReplayWriter::replayIdFromSpoolFileName(const QString &fileName)
+{
+    if (!fileName.startsWith(spoolFilePrefix) || !fileName.endsWith(spoolFileSuffix))
+        return -1;
+
+    bool ok;
+    const qint64 id =
+        fileName.mid(spoolFilePrefix.size(), fileName.size() - spoolFilePrefix.size() - spoolFileSuffix.size())
+            .toLongLong(&ok);
+    return ok ? id : -1;
+}
+
+void GameReplayWriter::appendEvent(const GameEventContainer &cont)
+{
+#if GOOGLE_PROTOBUF_VERSION > 3001000
+    const auto size = static_cast<int>(cont.ByteSizeLong());
+#else
+    const auto size = cont.ByteSize();
+#endif
+    if (memoryReplay) {
+        memoryReplay->add_event_list()->CopyFrom(cont);
+        memoryBytes += size;
+        return;
+    }
+
+    QByteArray chunk;
+    chunk.reserve(size + 6);
+    chunk.append(eventListKey);
+    appendVarint(chunk, static_cast<quint64>(size));
+    const int headerSize = chunk.size();
+    chunk.resize(headerSize + size);
+    cont.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t *>(chunk.data() + headerSize));
+
+    // flushed right away so that the events make it to disk even if the server goes down with the game
+    if (spoolFile.write(chunk) != chunk.size() || !spoolFile.flush())
+        qWarning() << "GameReplayWriter: could not append to" << spoolFile.fileName() << spoolFile.errorString();
+}
+
+QByteArray GameReplayWriter::serialize()
+{
+    GameReplay trailer;
+    trailer.set_duration_seconds(static_cast<uint32_t>(durationSeconds));
+
+    if (memoryReplay) {
+        memoryReplay->set_duration_seconds(trailer.duration_seconds());
+        return QByteArray::fromStdString(memoryReplay->SerializeAsString());
+    }
+
+    QFile file(spoolFile.fileName());
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "GameReplayWriter: could not read" << file.fileName() << file.errorString();
+        return QByteArray();
+    }
+    return file.readAll() + QByteArray::fromStdString(trailer.SerializeAsString());
+}
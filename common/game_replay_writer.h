@@ -0,0 +1,106 @@
+#ifndef GAME_REPLAY_WRITER_H
+#define GAME_REPLAY_WRITER_H
+
+#include "pb/serverinfo_game.pb.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+class GameEventContainer;
+class GameReplay;
+
+/**
+ * Records the events of one replay while its game is running.
+ *
+ * With a spool directory, every event container is appended to a file as soon as it is recorded, encoded as
+ * one event_list entry of a GameReplay message. Serialized protobuf messages can be concatenated, so the spool
+ * file is a valid GameReplay at any point in time: the replay id and game info are written first, and
+ * serialize() only has to add the duration. A file left behind by a crash can be parsed as it is.
+ *
+ * Without a spool directory, or if the spool file can't be created, the events are kept in memory instead.
+ */
+class GameReplayWriter
+{
+public:
+    GameReplayWriter(qint64 _replayId, const ServerInfo_Game &_gameInfo, const QString &spoolDirectory = QString());
+    /**
+     * Goes on with a replay another server process detached, see detach(): appends to the spool file of that name,
+     * or keeps the serialized GameReplay contents in memory if there is none.
+     */
+    GameReplayWriter(qint64 _replayId,
+                     const ServerInfo_Game &_gameInfo,
+                     int _durationSeconds,
+                     const QString &spoolFileName,
+                     const QByteArray &contents);
+    ~GameReplayWriter();
+    GameReplayWriter(const GameReplayWriter &) = delete;
+    GameReplayWriter &operator=(const GameReplayWriter &) = delete;
+
+    static QString spoolFilePath(const QString &spoolDirectory, qint64 replayId);
+    /**
+     * Returns the replay id a spool file was written for, or -1 if fileName isn't the name of a spool file.
+     */
+    static qint64 replayIdFromSpoolFileName(const QString &fileName);
+
+    qint64 getReplayId() const
+    {
+        return replayId;
+    }
+    const ServerInfo_Game &getGameInfo() const
+    {
+        return gameInfo;
+    }
+    int getDurationSeconds() const
+    {
+        return durationSeconds;
+    }
+    void setDurationSeconds(int _durationSeconds)
+    {
+        durationSeconds = _durationSeconds;
+    }
+    bool isSpooled() const
+    {
+        return spoolFile.isOpen();
+    }
+
+    /**
+     * Moves a replay kept in memory so far to a spool file in spoolDirectory. Returns false if the replay is still
+     * in memory.
+     */
+    bool spool(const QString &spoolDirectory);
+    /**
+     * Stops recording and leaves the replay to another server process. A spooled replay stays in its file, see
+     * getSpoolFileName(); otherwise the replay so far is returned serialized.
+     */
+    QByteArray detach();
+    QString getSpoolFileName() const
+    {
+        return spoolFile.fileName();
+    }
+    // the serialized size of what is kept in memory, 0 for a spooled replay
+    qint64 getMemoryBytes() const
+    {
+        return memoryBytes;
+    }
+
+    void appendEvent(const GameEventContainer &cont);
+    /**
+     * Returns the complete replay as a serialized GameReplay message. For spooled replays this reads the spool
+     * file back, so the replay is only held in memory while it is being stored.
+     */
+    QByteArray serialize();
+
+private:
+    qint64 replayId;
+    ServerInfo_Game gameInfo;
+    int durationSeconds;
+    QFile spoolFile;
+    GameReplay *memoryReplay;
+    qint64 memoryBytes;
+
+    // writes contents as the start of the spool file
+    bool openSpoolFile(const QString &spoolDirectory, const GameReplay &contents);
+};
+
+#endif
@@ -2,13 +2,30 @@
 
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/message.h>
+#include <unordered_map>
 
 int getPbExtension(const ::google::protobuf::Message &message)
 {
-    std::vector<const ::google::protobuf::FieldDescriptor *> fieldList;
+    // called for every command and event, the list is only allocated once per thread
+    thread_local std::vector<const ::google::protobuf::FieldDescriptor *> fieldList;
+    fieldList.clear();
     message.GetReflection()->ListFields(message, &fieldList);
     for (unsigned int j = 0; j < fieldList.size(); ++j)
         if (fieldList[j]->is_extension())
             return fieldList[j]->number();
     return -1;
 }
+
+void setPbExtension(::google::protobuf::Message *container, const ::google::protobuf::Message &extension)
+{
+    // FindExtensionByName() builds the full name of the extension to look it up in the descriptor pool, the
+    // descriptors live as long as the program so the result can be kept
+    thread_local std::unordered_map<const ::google::protobuf::Descriptor *, const ::google::protobuf::FieldDescriptor *>
+        extensionFields;
+    const ::google::protobuf::Descriptor *descriptor = extension.GetDescriptor();
+    auto extensionField = extensionFields.find(descriptor);
+    if (extensionField == extensionFields.end())
+        extensionField = extensionFields.emplace(descriptor, descriptor->FindExtensionByName("ext")).first;
+
+    container->GetReflection()->MutableMessage(container, extensionField->second)->CopyFrom(extension);
+}
@@ -10,5 +10,9 @@ class Message;
 } // namespace google
 
 int getPbExtension(const ::google::protobuf::Message &message);
+/**
+ * Copies extension into the "ext" extension its type declares on container, e.g. an Event_Join into a GameEvent.
+ */
+void setPbExtension(::google::protobuf::Message *container, const ::google::protobuf::Message &extension);
 
 #endif
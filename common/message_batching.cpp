@@ -0,0 +1,88 @@
+#include "message_batching.h"
+
+#include "message_compression.h"
+
+namespace
+{
+
+void appendFrame(QByteArray &batch, const QByteArray &message)
+{
+    const quint32 size = static_cast<quint32>(message.size());
+    batch.append(static_cast<char>(size >> 24));
+    batch.append(static_cast<char>(size >> 16));
+    batch.append(static_cast<char>(size >> 8));
+    batch.append(static_cast<char>(size));
+    batch.append(message);
+}
+
+} // namespace
+
+namespace MessageBatching
+{
+
+QList<QByteArray> pack(const QList<QByteArray> &messages, int maxBatchSize, int compressionThreshold)
+{
+    QList<QByteArray> result;
+    int first = 0;
+    while (first < messages.size()) {
+        // the marker, then the frames
+        int batchSize = 1 + 4 + messages[first].size();
+        int end = first + 1;
+        while (end < messages.size() && batchSize + 4 + messages[end].size() <= maxBatchSize) {
+            batchSize += 4 + messages[end].size();
+            ++end;
+        }
+
+        QByteArray websocketMessage;
+        if (end - first == 1) {
+            websocketMessage = messages[first];
+        } else {
+            websocketMessage.reserve(batchSize);
+            websocketMessage.append(batchMarker);
+            for (int i = first; i < end; ++i)
+                appendFrame(websocketMessage, messages[i]);
+        }
+
+        QByteArray compressed;
+        if (compressionThreshold > 0 && websocketMessage.size() >= compressionThreshold &&
+            MessageCompression::compress(websocketMessage, compressed))
+            websocketMessage = compressed.prepend(MessageCompression::compressedMessageMarker);
+
+        result.append(websocketMessage);
+        first = end;
+    }
+    return result;
+}
+
+bool unpack(const QByteArray &websocketMessage, QList<QByteArray> &messages)
+{
+    QByteArray data = websocketMessage;
+    if (data.startsWith(MessageCompression::compressedMessageMarker)) {
+        QByteArray uncompressed;
+        if (!MessageCompression::uncompress(data.constData() + 1, data.size() - 1, uncompressed))
+            return false;
+        data = uncompressed;
+    }
+
+    if (!data.startsWith(batchMarker)) {
+        messages.append(data);
+        return true;
+    }
+
+    const auto *bytes = reinterpret_cast<const uchar *>(data.constData());
+    int pos = 1;
+    while (pos < data.size()) {
+        if (data.size() - pos < 4)
+            return false;
+        const quint32 size = (quint32(bytes[pos]) << 24) | (quint32(bytes[pos + 1]) << 16) |
+                             (quint32(bytes[pos + 2]) << 8) | quint32(bytes[pos + 3]);
+        pos += 4;
+        if (size > static_cast<quint32>(data.size() - pos))
+            return false;
+        messages.append(data.mid(pos, static_cast<int>(size)));
+        pos += static_cast<int>(size);
+    }
+    return true;
+}
+
+} // namespace MessageBatching
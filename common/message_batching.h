@@ -0,0 +1,31 @@
+#ifndef MESSAGE_BATCHING_H
+#define MESSAGE_BATCHING_H
+
+#include <QByteArray>
+#include <QList>
+
+/**
+ * Optional batching of server messages on websocket connections, enabled per connection when the client advertises
+ * the "batched_messages" feature on login.
+ *
+ * A batch starts with a marker byte that can't be the first byte of a serialized protobuf message, followed by the
+ * messages framed like on tcp connections: each is prefixed with its length as 4 byte big endian integer. The whole
+ * batch can then be compressed like a single message, see MessageCompression. A websocket message holding only one
+ * message is never batched.
+ */
+namespace MessageBatching
+{
+inline constexpr const char *featureName = "batched_messages";
+inline constexpr char batchMarker = '\xfe';
+
+/**
+ * Packs the messages into websocket messages of at most maxBatchSize bytes before compression; a message that is
+ * larger on its own is sent alone. With a maxBatchSize of 0, every message is sent alone. Websocket messages of at
+ * least compressionThreshold bytes are compressed, none for 0.
+ */
+QList<QByteArray> pack(const QList<QByteArray> &messages, int maxBatchSize, int compressionThreshold);
+// the messages of a websocket message, uncompressed; returns false if it is malformed
+bool unpack(const QByteArray &websocketMessage, QList<QByteArray> &messages);
+} // namespace MessageBatching
+
+#endif
@@ -0,0 +1,21 @@
+#include "message_compression.h"
+
+namespace MessageCompression
+{
+
+bool compress(const QByteArray &data, QByteArray &result)
+{
+    result = qCompress(data);
+    return !result.isEmpty() && result.size() < data.size();
+}
+
+bool uncompress(const char *data, int size, QByteArray &result)
+{
+    if (size <= 0) {
+        return false;
+    }
+    result = qUncompress(reinterpret_cast<const uchar *>(data), size);
+    return !result.isEmpty();
+}
+
+} // namespace MessageCompression
@@ -0,0 +1,34 @@
+#ifndef MESSAGE_COMPRESSION_H
+#define MESSAGE_COMPRESSION_H
+
+#include <QByteArray>
+
+/**
+ * Optional compression of server messages, enabled per connection when the client advertises the
+ * "compressed_messages" feature on login.
+ *
+ * Compressed tcp frames have the highest bit of their length prefix set, compressed websocket messages start with a
+ * marker byte that can't be the first byte of a serialized protobuf message. The payload is in qCompress format.
+ */
+namespace MessageCompression
+{
+inline constexpr const char *featureName = "compressed_messages";
+inline constexpr quint32 compressedFrameFlag = 0x80000000;
+inline constexpr char compressedMessageMarker = '\xff';
+
+inline bool isCompressedFrame(int frameLength)
+{
+    return ((quint32)frameLength & compressedFrameFlag) != 0;
+}
+inline int payloadLength(int frameLength)
+{
+    return (int)((quint32)frameLength & ~compressedFrameFlag);
+}
+
+// returns false if compressing doesn't make the data smaller
+bool compress(const QByteArray &data, QByteArray &result);
+// returns false if the data is not a valid compressed message
+bool uncompress(const char *data, int size, QByteArray &result);
+} // namespace MessageCompression
+
+#endif
@@ -0,0 +1,133 @@
+#include "message_framing.h"
+
+#include "message_compression.h"
+
+namespace
+{
+
+const int maxVarintSize = 5;
+
+int varintSize(quint32 value)
+{
+    int size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+void appendVarint(QByteArray &out, quint32 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+/**
+ * @return 1 if a varint was read at pos and pos was moved past it, 0 if more data is needed, or -1 if it is malformed
+ */
+int readVarint(const uchar *bytes, int size, int &pos, quint32 &value)
+{
+    value = 0;
+    for (int i = 0; i < maxVarintSize; ++i) {
+        if (pos + i >= size)
+            return 0;
+        const uchar byte = bytes[pos + i];
+        value |= quint32(byte & 0x7f) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            pos += i + 1;
+            return 1;
+        }
+    }
+    return -1;
+}
+
+void appendFrame(QByteArray &out, const QByteArray &payload, int compressionThreshold)
+{
+    QByteArray compressed;
+    const bool compress = compressionThreshold > 0 && payload.size() >= compressionThreshold &&
+                          MessageCompression::compress(payload, compressed);
+    const QByteArray &data = compress ? compressed : payload;
+
+    out.append(MessageFraming::frameMarker);
+    out.append(compress ? MessageFraming::compressedFlag : '\0');
+    appendVarint(out, static_cast<quint32>(data.size()));
+    out.append(data);
+}
+
+} // namespace
+
+namespace MessageFraming
+{
+
+void pack(const QList<QByteArray> &messages, int maxFrameSize, int compressionThreshold, QByteArray &out)
+{
+    QByteArray payload;
+    int first = 0;
+    while (first < messages.size()) {
+        int payloadSize = varintSize(messages[first].size()) + messages[first].size();
+        int end = first + 1;
+        while (end < messages.size()) {
+            const int messageSize = varintSize(messages[end].size()) + messages[end].size();
+            if (payloadSize + messageSize > maxFrameSize)
+                break;
+            payloadSize += messageSize;
+            ++end;
+        }
+
+        payload.clear();
+        payload.reserve(payloadSize);
+        for (int i = first; i < end; ++i) {
+            appendVarint(payload, static_cast<quint32>(messages[i].size()));
+            payload.append(messages[i]);
+        }
+        appendFrame(out, payload, compressionThreshold);
+        first = end;
+    }
+}
+
+int unpack(const char *data, int size, QList<QByteArray> &messages)
+{
+    const auto *bytes = reinterpret_cast<const uchar *>(data);
+    if (size < 2)
+        return 0;
+    if (data[0] != frameMarker || (bytes[1] & ~uchar(compressedFlag)) != 0)
+        return -1;
+
+    int pos = 2;
+    quint32 payloadSize = 0;
+    const int read = readVarint(bytes, size, pos, payloadSize);
+    if (read <= 0)
+        return read;
+    if (payloadSize == 0 || payloadSize > static_cast<quint32>(maxPayloadSize))
+        return -1;
+    if (payloadSize > static_cast<quint32>(size - pos))
+        return 0;
+    const int frameSize = pos + static_cast<int>(payloadSize);
+
+    QByteArray uncompressed;
+    const uchar *payload = bytes + pos;
+    int payloadEnd = static_cast<int>(payloadSize);
+    if (data[1] & compressedFlag) {
+        if (!MessageCompression::uncompress(data + pos, payloadEnd, uncompressed))
+            return -1;
+        payload = reinterpret_cast<const uchar *>(uncompressed.constData());
+        payloadEnd = uncompressed.size();
+    }
+
+    pos = 0;
+    while (pos < payloadEnd) {
+        quint32 messageSize = 0;
+        if (readVarint(payload, payloadEnd, pos, messageSize) <= 0 ||
+            messageSize > static_cast<quint32>(payloadEnd - pos))
+            return -1;
+        messages.append(QByteArray(reinterpret_cast<const char *>(payload) + pos, static_cast<int>(messageSize)));
+        pos += static_cast<int>(messageSize);
+    }
+    return frameSize;
+}
+
+} // namespace MessageFraming
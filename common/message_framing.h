@@ -0,0 +1,41 @@
+#ifndef MESSAGE_FRAMING_H
+#define MESSAGE_FRAMING_H
+
+#include <QByteArray>
+#include <QList>
+
+/**
+ * The second framing of tcp connections, used by the server when the client advertises the "varint_frames" feature
+ * on login, and by the client once it received such a frame from the server.
+ *
+ * A frame starts with a marker byte that can't be the first byte of a length prefix of the original framing, then a
+ * byte of flags and the length of the payload as varint. The payload holds one or more messages, each prefixed with
+ * its length as varint, and is in qCompress format if the compressed flag is set; compression is only used for
+ * clients that also advertise the "compressed_messages" feature, see MessageCompression.
+ *
+ * As every frame can be told apart from the original framing by its first byte, both sides can switch to the new
+ * framing at any time without having to agree on the exact message.
+ */
+namespace MessageFraming
+{
+inline constexpr const char *featureName = "varint_frames";
+inline constexpr char frameMarker = '\xfd';
+inline constexpr char compressedFlag = 0x01;
+// larger frames are taken for garbage
+inline constexpr int maxPayloadSize = 64 * 1024 * 1024;
+
+/**
+ * Packs the messages into frames with at most maxFrameSize bytes of payload before compression; a message that is
+ * larger on its own gets a frame of its own. With a maxFrameSize of 0, every message gets a frame of its own.
+ * Payloads of at least compressionThreshold bytes are compressed, none for 0.
+ * The frames are appended to out.
+ */
+void pack(const QList<QByteArray> &messages, int maxFrameSize, int compressionThreshold, QByteArray &out);
+/**
+ * Reads the frame at the start of data and appends its messages, uncompressed.
+ * @return the size of the frame, 0 if it isn't complete yet, or -1 if it is malformed
+ */
+int unpack(const char *data, int size, QList<QByteArray> &messages);
+} // namespace MessageFraming
+
+#endif
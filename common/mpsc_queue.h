@@ -0,0 +1,69 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+/**
+ * An unbounded queue that any number of threads push to and a single thread pops from, without a lock.
+ *
+ * Pushing swaps the new node in as the head and then links the previous head to it, so a push is two atomic
+ * operations and never waits. A push that has swapped the head but not linked it yet hides itself and the items
+ * after it from pop() until it is done; the consumer has to be woken up again by the producer afterwards, which is
+ * what GameExecutor does.
+ */
+template <typename T> class MpscQueue
+{
+public:
+    MpscQueue() : head(new Node), tail(head.load())
+    {
+    }
+    ~MpscQueue()
+    {
+        while (tail) {
+            Node *next = tail->next.load(std::memory_order_relaxed);
+            delete tail;
+            tail = next;
+        }
+    }
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    // any thread
+    void push(T value)
+    {
+        Node *node = new Node;
+        node->value = std::move(value);
+        Node *previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // the consumer thread only
+    bool pop(T &value)
+    {
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (!next)
+            return false;
+        value = std::move(next->value);
+        next->value = T();
+        delete tail;
+        tail = next;
+        return true;
+    }
+    bool isEmpty() const
+    {
+        return !tail->next.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node *> next{nullptr};
+        T value;
+    };
+
+    std::atomic<Node *> head;
+    Node *tail;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "rate_window.h"
+
+#include <algorithm>
+
+RateWindow::RateWindow() : buckets(1, 0), newest(0), sum(0)
+{
+}
+
+void RateWindow::setLength(int length)
+{
+    const int bucketCount = std::max(length, 1);
+    if (bucketCount == static_cast<int>(buckets.size()))
+        return;
+
+    buckets.assign(bucketCount, 0);
+    newest = 0;
+    sum = 0;
+}
+
+void RateWindow::advance(int ticks)
+{
+    const int bucketCount = static_cast<int>(buckets.size());
+    for (int i = 0; i < ticks && i < bucketCount; ++i) {
+        newest = (newest + 1) % bucketCount;
+        sum -= buckets[newest];
+        buckets[newest] = 0;
+    }
+}
+
+int RateWindow::add(int amount)
+{
+    buckets[newest] += amount;
+    sum += amount;
+    return sum;
+}
@@ -0,0 +1,41 @@
+#ifndef RATE_WINDOW_H
+#define RATE_WINDOW_H
+
+#include <vector>
+
+/**
+ * A sum over a sliding window of buckets, one bucket per ping clock tick, used for flood protection.
+ *
+ * The buckets are a ring with a running total, so adding to the newest bucket and reading the total take constant
+ * time, and moving the window on takes at most one step per bucket. The buckets are only allocated again when the
+ * length of the window changes, which starts it over from zero.
+ */
+class RateWindow
+{
+public:
+    RateWindow();
+
+    /**
+     * Sets the number of buckets in the window, the newest one included; at least one bucket is always kept.
+     */
+    void setLength(int length);
+    /**
+     * Moves the window on by ticks buckets, the oldest ones drop out of the total.
+     */
+    void advance(int ticks);
+    /**
+     * Adds amount to the newest bucket and returns the total over the window.
+     */
+    int add(int amount);
+    int total() const
+    {
+        return sum;
+    }
+
+private:
+    std::vector<int> buckets;
+    int newest;
+    int sum;
+};
+
+#endif
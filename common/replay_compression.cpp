@@ -0,0 +1,34 @@
+#include "replay_compression.h"
+
+namespace ReplayCompression
+{
+
+QByteArray compress(const QByteArray &replay)
+{
+    // replays are written once and mostly kept around unread, the best compression is worth its time
+    QByteArray result;
+    result.append(marker);
+    result.append(formatVersion);
+    result.append(qCompress(replay, 9));
+    return result;
+}
+
+bool isCompressed(const QByteArray &data)
+{
+    return !data.isEmpty() && data.at(0) == marker;
+}
+
+bool uncompress(const QByteArray &data, QByteArray &replay)
+{
+    if (!isCompressed(data)) {
+        replay = data;
+        return true;
+    }
+    if (data.size() < 2 || data.at(1) != formatVersion) {
+        return false;
+    }
+    replay = qUncompress(reinterpret_cast<const uchar *>(data.constData()) + 2, data.size() - 2);
+    return !replay.isEmpty();
+}
+
+} // namespace ReplayCompression
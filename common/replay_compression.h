@@ -0,0 +1,28 @@
+#ifndef REPLAY_COMPRESSION_H
+#define REPLAY_COMPRESSION_H
+
+#include <QByteArray>
+
+/**
+ * The compressed form of the replays stored in the database.
+ *
+ * A compressed replay starts with a marker byte that can't be the first byte of a serialized GameReplay, followed
+ * by the version of the format and the replay in qCompress format. Anything else is a plain serialized GameReplay,
+ * as all replays stored before were.
+ *
+ * Servers send the stored replays as they are to clients that advertise the "compressed_replays" feature on login,
+ * and uncompress them for the others.
+ */
+namespace ReplayCompression
+{
+inline constexpr const char *featureName = "compressed_replays";
+inline constexpr char marker = '\xff';
+inline constexpr char formatVersion = 1;
+
+QByteArray compress(const QByteArray &replay);
+bool isCompressed(const QByteArray &data);
+// plain replays are returned as they are, returns false if the data is compressed but broken or of a later version
+bool uncompress(const QByteArray &data, QByteArray &replay);
+} // namespace ReplayCompression
+
+#endif
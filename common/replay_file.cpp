@@ -0,0 +1,205 @@
+#include "replay_file.h"
+
+#include "pb/game_event_container.pb.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+
+// a zero byte is no valid protobuf key, so legacy replays can't start like this
+static const QByteArray indexedMagic("\0CORIDX\1", 8);
+// the magic and the size of the index
+static const int indexedPrefixSize = 12;
+
+ReplayFile::ReplayFile() : eventCount(0), eventsPerChunk(0), loadedChunk(-1)
+{
+}
+
+bool ReplayFile::isIndexed(const QByteArray &data)
+{
+    return data.startsWith(indexedMagic);
+}
+
+ReplayFile *ReplayFile::fromData(const QByteArray &data)
+{
+    auto *replayFile = new ReplayFile;
+
+    if (!isIndexed(data)) {
+        replayFile->header.ParseFromArray(data.data(), data.size());
+        replayFile->eventCount = replayFile->header.event_list_size();
+        for (int i = 0; i < replayFile->eventCount; ++i) {
+            const uint32_t seconds = replayFile->header.event_list(i).seconds_elapsed();
+            if (replayFile->timelineSeconds.isEmpty() || replayFile->timelineSeconds.last() != seconds) {
+                replayFile->timelineSeconds.append(seconds);
+                replayFile->timelineCounts.append(0);
+            }
+            ++replayFile->timelineCounts.last();
+        }
+        return replayFile;
+    }
+
+    ReplayIndex index;
+    const auto *prefix = reinterpret_cast<const unsigned char *>(data.constData());
+    const qint64 indexSize = data.size() < indexedPrefixSize
+                                 ? -1
+                                 : (static_cast<quint32>(prefix[8]) << 24) | (static_cast<quint32>(prefix[9]) << 16) |
+                                       (static_cast<quint32>(prefix[10]) << 8) | static_cast<quint32>(prefix[11]);
+    if (indexSize < 0 || indexSize > data.size() - indexedPrefixSize ||
+        !index.ParseFromArray(data.constData() + indexedPrefixSize, static_cast<int>(indexSize))) {
+        qWarning() << "ReplayFile: broken index";
+        delete replayFile;
+        return nullptr;
+    }
+
+    replayFile->header.Swap(index.mutable_header());
+    replayFile->eventCount = static_cast<int>(index.event_count());
+    replayFile->eventsPerChunk = static_cast<int>(index.events_per_chunk());
+    replayFile->chunkData = data.mid(indexedPrefixSize + static_cast<int>(indexSize));
+    // the timeline widget asks for as many events as the timeline has
+    qint64 timelineEvents = 0;
+    for (int i = 0; i < index.timeline_seconds_size() && i < index.timeline_counts_size(); ++i) {
+        replayFile->timelineSeconds.append(index.timeline_seconds(i));
+        replayFile->timelineCounts.append(index.timeline_counts(i));
+        timelineEvents += index.timeline_counts(i);
+    }
+    for (const quint64 offset : index.chunk_offsets()) {
+        replayFile->chunkOffsets.append(offset);
+    }
+
+    const int perChunk = replayFile->eventsPerChunk;
+    const int chunkCount = perChunk > 0 ? (replayFile->eventCount + perChunk - 1) / perChunk : 0;
+    if (replayFile->eventCount < 0 || timelineEvents != replayFile->eventCount ||
+        (replayFile->eventCount > 0 && perChunk <= 0) ||
+        replayFile->chunkOffsets.size() != chunkCount + 1 ||
+        replayFile->chunkOffsets.last() > static_cast<quint64>(replayFile->chunkData.size())) {
+        qWarning() << "ReplayFile: index doesn't match the chunks";
+        delete replayFile;
+        return nullptr;
+    }
+    return replayFile;
+}
+
+QByteArray ReplayFile::toIndexed(const GameReplay &replay, int eventsPerChunk)
+{
+    eventsPerChunk = qMax(eventsPerChunk, 1);
+
+    ReplayIndex index;
+    // the fields one by one, copying the whole replay would copy its events too
+    GameReplay *indexHeader = index.mutable_header();
+    if (replay.has_replay_id())
+        indexHeader->set_replay_id(replay.replay_id());
+    if (replay.has_game_info())
+        indexHeader->mutable_game_info()->CopyFrom(replay.game_info());
+    if (replay.has_duration_seconds())
+        indexHeader->set_duration_seconds(replay.duration_seconds());
+
+    const int count = replay.event_list_size();
+    index.set_event_count(static_cast<uint32_t>(count));
+    index.set_events_per_chunk(static_cast<uint32_t>(eventsPerChunk));
+    for (int i = 0; i < count; ++i) {
+        const uint32_t seconds = replay.event_list(i).seconds_elapsed();
+        const int runs = index.timeline_seconds_size();
+        if (runs == 0 || index.timeline_seconds(runs - 1) != seconds) {
+            index.add_timeline_seconds(seconds);
+            index.add_timeline_counts(1);
+        } else {
+            index.set_timeline_counts(runs - 1, index.timeline_counts(runs - 1) + 1);
+        }
+    }
+
+    QByteArray chunks;
+    for (int first = 0; first < count; first += eventsPerChunk) {
+        index.add_chunk_offsets(static_cast<quint64>(chunks.size()));
+        GameReplay chunk;
+        for (int i = first; i < qMin(first + eventsPerChunk, count); ++i) {
+            chunk.add_event_list()->CopyFrom(replay.event_list(i));
+        }
+        const std::string chunkData = chunk.SerializeAsString();
+        chunks.append(qCompress(reinterpret_cast<const uchar *>(chunkData.data()), static_cast<int>(chunkData.size())));
+    }
+    index.add_chunk_offsets(static_cast<quint64>(chunks.size()));
+
+    const std::string indexData = index.SerializeAsString();
+    const auto indexSize = static_cast<quint32>(indexData.size());
+    QByteArray result;
+    result.reserve(indexedPrefixSize + static_cast<int>(indexSize) + chunks.size());
+    result.append(indexedMagic);
+    result.append(static_cast<char>(indexSize >> 24));
+    result.append(static_cast<char>(indexSize >> 16));
+    result.append(static_cast<char>(indexSize >> 8));
+    result.append(static_cast<char>(indexSize));
+    result.append(indexData.data(), static_cast<int>(indexSize));
+    result.append(chunks);
+    return result;
+}
+
+bool ReplayFile::convertFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "ReplayFile: could not read" << filePath << file.errorString();
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+    if (isIndexed(data)) {
+        return true;
+    }
+
+    GameReplay replay;
+    if (!replay.ParseFromArray(data.data(), data.size())) {
+        qWarning() << "ReplayFile: not a replay" << filePath;
+        return false;
+    }
+
+    // written next to the old file and renamed over it, so a failure can't lose the replay
+    QSaveFile saveFile(filePath);
+    if (!saveFile.open(QIODevice::WriteOnly) || saveFile.write(toIndexed(replay)) < 0 || !saveFile.commit()) {
+        qWarning() << "ReplayFile: could not write" << filePath << saveFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+QList<int> ReplayFile::getTimeline() const
+{
+    QList<int> timeline;
+    timeline.reserve(eventCount);
+    for (int run = 0; run < timelineSeconds.size(); ++run) {
+        const auto numberEventsThisSecond = static_cast<int>(timelineCounts.at(run));
+        for (int k = 0; k < numberEventsThisSecond; ++k) {
+            timeline.append(static_cast<int>(timelineSeconds.at(run)) * 1000 +
+                            (int)((qreal)k / (qreal)numberEventsThisSecond * 1000));
+        }
+    }
+    return timeline;
+}
+
+const GameEventContainer &ReplayFile::getEvent(int index)
+{
+    if (chunkOffsets.isEmpty()) {
+        return header.event_list(index);
+    }
+
+    const int chunkIndex = index / eventsPerChunk;
+    if (chunkIndex != loadedChunk) {
+        loadedChunk = chunkIndex;
+        chunk.Clear();
+
+        const quint64 begin = chunkOffsets.at(chunkIndex);
+        const quint64 end = chunkOffsets.at(chunkIndex + 1);
+        const QByteArray chunkEvents =
+            begin < end ? qUncompress(reinterpret_cast<const uchar *>(chunkData.constData()) + begin,
+                                      static_cast<int>(end - begin))
+                        : QByteArray();
+        if (!chunk.ParseFromArray(chunkEvents.constData(), chunkEvents.size())) {
+            qWarning() << "ReplayFile: broken chunk" << chunkIndex;
+        }
+    }
+
+    const int chunkEventIndex = index - chunkIndex * eventsPerChunk;
+    if (chunkEventIndex >= chunk.event_list_size()) {
+        return GameEventContainer::default_instance();
+    }
+    return chunk.event_list(chunkEventIndex);
+}
@@ -0,0 +1,80 @@
+#ifndef REPLAY_FILE_H
+#define REPLAY_FILE_H
+
+#include "pb/game_replay.pb.h"
+#include "pb/replay_index.pb.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+/**
+ * A replay as the client watches it, read from either replay file format.
+ *
+ * The legacy format is a single serialized GameReplay, which has to be parsed as a whole before anything can be
+ * shown. The indexed format starts with a ReplayIndex, the replay without its events together with the timeline of the
+ * events and the offsets of their chunks, and is followed by the qCompress'ed chunks, each a GameReplay holding only
+ * events. Only the index is parsed when an indexed replay is opened, the chunks are decompressed once their events are
+ * asked for.
+ */
+class ReplayFile
+{
+public:
+    static constexpr int defaultEventsPerChunk = 256;
+
+    /**
+     * Reads a replay in either format, returns nullptr when the data is an indexed replay that is broken.
+     * Legacy replays are taken as far as they can be parsed, as they always were.
+     */
+    static ReplayFile *fromData(const QByteArray &data);
+    static bool isIndexed(const QByteArray &data);
+    /**
+     * Returns the replay in the indexed format.
+     */
+    static QByteArray toIndexed(const GameReplay &replay, int eventsPerChunk = defaultEventsPerChunk);
+    /**
+     * Rewrites a legacy replay file in the indexed format. Returns false when the file couldn't be read or written,
+     * files that already are indexed are left as they are.
+     */
+    static bool convertFile(const QString &filePath);
+
+    ReplayFile(const ReplayFile &) = delete;
+    ReplayFile &operator=(const ReplayFile &) = delete;
+
+    /**
+     * The replay id, game info and duration, the events only for legacy replays.
+     */
+    const GameReplay &getHeader() const
+    {
+        return header;
+    }
+    int getEventCount() const
+    {
+        return eventCount;
+    }
+    /**
+     * The time of every event [ms], the events of the same second spread evenly across it.
+     */
+    QList<int> getTimeline() const;
+    /**
+     * The event at index, an empty one if its chunk is broken.
+     */
+    const GameEventContainer &getEvent(int index);
+
+private:
+    ReplayFile();
+
+    GameReplay header;
+    int eventCount;
+    // the runs of events in the same second
+    QList<uint32_t> timelineSeconds, timelineCounts;
+
+    // the chunks of an indexed replay, empty for legacy ones
+    QByteArray chunkData;
+    QList<quint64> chunkOffsets;
+    int eventsPerChunk;
+    int loadedChunk;
+    GameReplay chunk;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#include "resume_log.h"
+
+#include "pb/server_message.pb.h"
+#include "serialized_message.h"
+
+void ResumeLog::setCapacity(int _capacity)
+{
+    capacity = qMax(_capacity, 0);
+    while (messages.size() > capacity)
+        bytes -= messages.dequeue().size();
+}
+
+QByteArray ResumeLog::append(const QByteArray &serializedMessage)
+{
+    // the fields of a submessage that comes twice are merged, so the number is added without parsing the message
+    GameEventContainer sequence;
+    sequence.set_resume_sequence(nextSequence++);
+    QByteArray result(serializedMessage);
+    SerializedMessage::appendField(result, ServerMessage::kGameEventContainerFieldNumber,
+                                   SerializedMessage::serialize(sequence));
+
+    if (capacity > 0) {
+        messages.enqueue(result);
+        bytes += result.size();
+        if (messages.size() > capacity)
+            bytes -= messages.dequeue().size();
+    }
+    return result;
+}
+
+void ResumeLog::restart(quint64 lastSequence)
+{
+    nextSequence = lastSequence + 1;
+    messages.clear();
+    bytes = 0;
+}
+
+bool ResumeLog::getMessagesAfter(quint64 sequence, QList<QByteArray> &result) const
+{
+    if (sequence > getLastSequence())
+        return false;
+    const quint64 firstSequence = nextSequence - static_cast<quint64>(messages.size());
+    if (sequence + 1 < firstSequence)
+        return false;
+
+    for (int i = static_cast<int>(sequence + 1 - firstSequence); i < messages.size(); ++i)
+        result.append(messages.at(i));
+    return true;
+}
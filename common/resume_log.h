@@ -0,0 +1,52 @@
+#ifndef RESUME_LOG_H
+#define RESUME_LOG_H
+
+#include <QByteArray>
+#include <QList>
+#include <QQueue>
+#include <atomic>
+
+/**
+ * The game events last sent to a player, numbered, so that a client that lost its connection can pick up where it
+ * left off instead of being sent the whole game again, see Command_Login::resume_game_ids.
+ *
+ * The messages are kept serialized, with their GameEventContainer::resume_sequence set. Only the last capacity
+ * messages are kept; a client that missed more than these joins the game again. Not thread safe, Server_Player keeps
+ * it under its playerMutex.
+ */
+class ResumeLog
+{
+public:
+    // a capacity of 0 turns the log off
+    void setCapacity(int _capacity);
+    bool isEnabled() const
+    {
+        return capacity > 0;
+    }
+
+    // Numbers the serialized ServerMessage of a game event container and keeps it. Returns the message with its
+    // number, which is what the client is to be sent.
+    QByteArray append(const QByteArray &serializedMessage);
+    // the number of the newest message, the numbers start at 1
+    quint64 getLastSequence() const
+    {
+        return nextSequence - 1;
+    }
+    // goes on numbering after lastSequence with no messages kept, for a log taken over from another server process
+    void restart(quint64 lastSequence);
+    // the messages after the one numbered sequence, false if some of them are no longer kept
+    bool getMessagesAfter(quint64 sequence, QList<QByteArray> &result) const;
+    // the size of the messages kept; unlike the rest, safe to call from any thread
+    qint64 getBytes() const
+    {
+        return bytes.load(std::memory_order_relaxed);
+    }
+
+private:
+    int capacity = 0;
+    quint64 nextSequence = 1;
+    QQueue<QByteArray> messages;
+    std::atomic<qint64> bytes{0};
+};
+
+#endif
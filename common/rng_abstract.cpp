@@ -1,6 +1,25 @@
 #include "rng_abstract.h"
 
 #include <QDebug>
+#include <utility>
+
+void RNG_Abstract::fillUniform(unsigned int *values, int count, int min, int max)
+{
+    for (int i = 0; i < count; ++i)
+        values[i] = rand(min, max);
+}
+
+QVector<int> RNG_Abstract::shuffleRange(int start, int end)
+{
+    QVector<int> result;
+    for (int i = start; i <= end; ++i)
+        result.append(i);
+
+    // Fisher-Yates
+    for (int i = result.size() - 1; i > 0; --i)
+        std::swap(result[i], result[rand(0, i)]);
+    return result;
+}
 
 QVector<int> RNG_Abstract::makeNumbersVector(int n, int min, int max)
 {
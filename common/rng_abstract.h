@@ -12,6 +12,10 @@ public:
     {
     }
     virtual unsigned int rand(int min, int max) = 0;
+    // Fills values with count independent draws of rand(min, max).
+    virtual void fillUniform(unsigned int *values, int count, int min, int max);
+    // Returns a uniformly distributed random permutation of the integers in [start, end].
+    virtual QVector<int> shuffleRange(int start, int end);
     QVector<int> makeNumbersVector(int n, int min, int max);
     double testRandom(const QVector<int> &numbers) const;
 };
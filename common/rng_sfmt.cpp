@@ -11,10 +11,45 @@
 #define UINT64_MAX (~(uint64_t)0)
 #endif
 
+struct RNG_SFMT::Stream
+{
+    // must be even and at least sfmt_get_min_array_size64()
+    static const int bufferSize = 1024;
+
+    sfmt_t sfmt;
+    uint64_t buffer[bufferSize];
+    int next = bufferSize;
+
+    uint64_t next64()
+    {
+        if (next == bufferSize) {
+            sfmt_fill_array64(&sfmt, buffer, bufferSize);
+            next = 0;
+        }
+        return buffer[next++];
+    }
+};
+
 RNG_SFMT::RNG_SFMT(QObject *parent) : RNG_Abstract(parent)
 {
-    // initialize the random number generator with a 32bit integer seed (timestamp)
-    sfmt_init_gen_rand(&sfmt, QDateTime::currentDateTime().toSecsSinceEpoch());
+    // initialize the master generator with a 32bit integer seed (timestamp)
+    sfmt_init_gen_rand(&master, QDateTime::currentDateTime().toSecsSinceEpoch());
+}
+
+RNG_SFMT::Stream &RNG_SFMT::localStream()
+{
+    if (!streams.hasLocalData()) {
+        uint32_t seed[4];
+        mutex.lock();
+        for (uint32_t &key : seed)
+            key = sfmt_genrand_uint32(&master);
+        mutex.unlock();
+
+        auto *stream = new Stream;
+        sfmt_init_by_array(&stream->sfmt, seed, 4);
+        streams.setLocalData(stream);
+    }
+    return *streams.localData();
 }
 
 /**
@@ -27,6 +62,35 @@ RNG_SFMT::RNG_SFMT(QObject *parent) : RNG_Abstract(parent)
  * that someone wants something like rand() % -foo.
  */
 unsigned int RNG_SFMT::rand(int min, int max)
+{
+    return draw(localStream(), min, max);
+}
+
+void RNG_SFMT::fillUniform(unsigned int *values, int count, int min, int max)
+{
+    Stream &stream = localStream();
+    for (int i = 0; i < count; ++i)
+        values[i] = draw(stream, min, max);
+}
+
+QVector<int> RNG_SFMT::shuffleRange(int start, int end)
+{
+    QVector<int> result;
+    if (end < start)
+        return result;
+
+    result.resize(end - start + 1);
+    for (int i = 0; i < result.size(); ++i)
+        result[i] = start + i;
+
+    // Fisher-Yates, drawing all swap partners from the local stream
+    Stream &stream = localStream();
+    for (int i = result.size() - 1; i > 0; --i)
+        std::swap(result[i], result[cdf(stream, 0, i)]);
+    return result;
+}
+
+unsigned int RNG_SFMT::draw(Stream &stream, int min, int max)
 {
     /* If min is negative, it would be possible to calculate
      * cdf(0, max - min) + min
@@ -50,11 +114,11 @@ unsigned int RNG_SFMT::rand(int min, int max)
     // This is the only time when min > max is (sort of) legal.
     // Not handling this will cause the application to crash.
     if (min == 0 && max < 0) {
-        return cdf(0, -max);
+        return cdf(stream, 0, -max);
     }
 
     // No special cases are left, except !(min > max) which is caught in the cdf itself.
-    return cdf(min, max);
+    return cdf(stream, min, max);
 }
 
 /**
@@ -99,7 +163,7 @@ unsigned int RNG_SFMT::rand(int min, int max)
  * Otherwise you will probably skew the outcome of the rand() method or worsen the
  * performance of the application.
  */
-unsigned int RNG_SFMT::cdf(unsigned int min, unsigned int max)
+unsigned int RNG_SFMT::cdf(Stream &stream, unsigned int min, unsigned int max)
 {
     // This all makes no sense if min > max, which should never happen.
     if (min > max) {
@@ -123,13 +187,10 @@ unsigned int RNG_SFMT::cdf(unsigned int min, unsigned int max)
     const uint64_t limit = diameter * buckets;
 
     uint64_t rand;
-    // To make the random number generation thread-safe, a mutex is created around
-    // the generation. Outside of the loop of course, to avoid lock/unlock overhead.
-    mutex.lock();
+    // The stream belongs to the calling thread, so no locking is needed here.
     do {
-        rand = sfmt_genrand_uint64(&sfmt);
+        rand = stream.next64();
     } while (rand >= limit);
-    mutex.unlock();
 
     // Now determine the bucket containing the SFMT() random number and after adding
     // the lower bound, a random number from [min, max] can be returned.
@@ -5,6 +5,7 @@
 #include "sfmt/SFMT.h"
 
 #include <QMutex>
+#include <QThreadStorage>
 #include <climits>
 
 /**
@@ -24,20 +25,31 @@
  * These are mapped to values from the interval [min, max] without bias by using Knuth's
  * "Algorithm S (Selection sampling technique)" from "The Art of Computer Programming 3rd
  * Edition Volume 2 / Seminumerical Algorithms".
+ *
+ * Every thread draws from its own SFMT stream, so no lock is taken per number. The streams are
+ * seeded from a master generator, which is only locked when a thread draws its first number.
+ * Each stream generates its numbers in blocks with sfmt_fill_array64.
  */
 
 class RNG_SFMT : public RNG_Abstract
 {
     Q_OBJECT
 private:
-    QMutex mutex;
-    sfmt_t sfmt;
+    struct Stream;
+
+    QMutex mutex; // guards master
+    sfmt_t master;
+    QThreadStorage<Stream *> streams;
+    Stream &localStream();
+    unsigned int draw(Stream &stream, int min, int max);
     // The discrete cumulative distribution function for the RNG
-    unsigned int cdf(unsigned int min, unsigned int max);
+    unsigned int cdf(Stream &stream, unsigned int min, unsigned int max);
 
 public:
     explicit RNG_SFMT(QObject *parent = nullptr);
     unsigned int rand(int min, int max) override;
+    void fillUniform(unsigned int *values, int count, int min, int max) override;
+    QVector<int> shuffleRange(int start, int end) override;
 };
 
 #endif
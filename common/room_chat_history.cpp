@@ -0,0 +1,84 @@
+#include "room_chat_history.h"
+
+#include "pb/event_room_say.pb.h"
+#include "pb/room_event.pb.h"
+#include "pb/server_message.pb.h"
+#include "serialized_message.h"
+
+#include <QDateTime>
+
+RoomChatHistory::RoomChatHistory(int _roomId, int _capacity)
+    : roomId(_roomId), capacity(qMax(_capacity, 0)), entries(capacity), nextSequence(0), count(0), bytes(0)
+{
+}
+
+void RoomChatHistory::append(const ServerInfo_ChatMessage &message)
+{
+    if (!isEnabled())
+        return;
+
+    Entry &entry = entries[nextSequence % capacity];
+    if (count == capacity) {
+        // the oldest message is overwritten, it is the oldest one of its sender as well
+        const QString oldSender = QString::fromStdString(entry.message.sender_name());
+        auto oldSenderMessages = messagesBySender.find(oldSender);
+        if (oldSenderMessages != messagesBySender.end()) {
+            oldSenderMessages->dequeue();
+            if (oldSenderMessages->isEmpty())
+                messagesBySender.erase(oldSenderMessages);
+        }
+        bytes -= entryBytes(entry);
+    } else {
+        ++count;
+    }
+
+    entry.message = message;
+    entry.serializedEvent = serializeEvent(message);
+    bytes += entryBytes(entry);
+    messagesBySender[QString::fromStdString(message.sender_name())].enqueue(nextSequence);
+    ++nextSequence;
+}
+
+void RoomChatHistory::redact(const QString &senderName, int amount)
+{
+    auto senderMessages = messagesBySender.find(senderName);
+    if (senderMessages == messagesBySender.end())
+        return;
+
+    for (int i = senderMessages->size() - 1; i >= 0 && amount > 0; --i, --amount) {
+        Entry &entry = entries[senderMessages->at(i) % capacity];
+        bytes -= entryBytes(entry);
+        entry.message.clear_message();
+        entry.serializedEvent = serializeEvent(entry.message);
+        bytes += entryBytes(entry);
+    }
+}
+
+QList<QByteArray> RoomChatHistory::getSerializedEvents() const
+{
+    QList<QByteArray> result;
+    result.reserve(count);
+    for (quint64 sequence = nextSequence - count; sequence != nextSequence; ++sequence)
+        result.append(entries[sequence % capacity].serializedEvent);
+    return result;
+}
+
+qint64 RoomChatHistory::entryBytes(const Entry &entry)
+{
+    return static_cast<qint64>(entry.message.time().size() + entry.message.sender_name().size() +
+                               entry.message.message().size()) +
+           entry.serializedEvent.size();
+}
+
+QByteArray RoomChatHistory::serializeEvent(const ServerInfo_ChatMessage &message) const
+{
+    ServerMessage serverMessage;
+    serverMessage.set_message_type(ServerMessage::ROOM_EVENT);
+    RoomEvent *roomEvent = serverMessage.mutable_room_event();
+    roomEvent->set_room_id(roomId);
+    Event_RoomSay *event = roomEvent->MutableExtension(Event_RoomSay::ext);
+    event->set_message(message.sender_name() + ": " + message.message());
+    event->set_message_type(Event_RoomSay::ChatHistory);
+    event->set_time_of(QDateTime::fromString(QString::fromStdString(message.time())).toMSecsSinceEpoch());
+    return SerializedMessage::serialize(serverMessage);
+}
@@ -0,0 +1,66 @@
+#ifndef ROOM_CHAT_HISTORY_H
+#define ROOM_CHAT_HISTORY_H
+
+#include "pb/serverinfo_chat_message.pb.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QString>
+#include <QVector>
+
+/**
+ * The last messages said in a room, in a circular buffer of fixed capacity.
+ *
+ * Every entry is kept as the serialized ServerMessage holding the Event_RoomSay that joining users get, so a join only
+ * copies implicitly shared buffers. The entries are indexed by sender, redacting the last messages of a user only
+ * looks at theirs.
+ */
+class RoomChatHistory
+{
+public:
+    // a capacity of 0 or less keeps no history
+    RoomChatHistory(int _roomId, int _capacity);
+
+    bool isEnabled() const
+    {
+        return capacity > 0;
+    }
+    int size() const
+    {
+        return count;
+    }
+    void append(const ServerInfo_ChatMessage &message);
+    // clears the text of the last amount messages of the sender
+    void redact(const QString &senderName, int amount);
+    // oldest first
+    QList<QByteArray> getSerializedEvents() const;
+    // the size of the texts and serialized events kept
+    qint64 getMemoryBytes() const
+    {
+        return bytes;
+    }
+
+private:
+    struct Entry
+    {
+        ServerInfo_ChatMessage message;
+        QByteArray serializedEvent;
+    };
+
+    int roomId;
+    int capacity;
+    QVector<Entry> entries;
+    // the sequence number of the next message, entry sequence % capacity holds the message of that number
+    quint64 nextSequence;
+    int count;
+    qint64 bytes;
+    // the sequence numbers of the messages in the buffer by sender, oldest first
+    QHash<QString, QQueue<quint64>> messagesBySender;
+
+    QByteArray serializeEvent(const ServerInfo_ChatMessage &message) const;
+    static qint64 entryBytes(const Entry &entry);
+};
+
+#endif
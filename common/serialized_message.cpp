@@ -0,0 +1,39 @@
+#include "serialized_message.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/wire_format_lite.h>
+
+namespace SerializedMessage
+{
+
+QByteArray serialize(const ::google::protobuf::Message &message)
+{
+    QByteArray result;
+#if GOOGLE_PROTOBUF_VERSION > 3001000
+    int size = static_cast<int>(message.ByteSizeLong());
+#else
+    int size = message.ByteSize();
+#endif
+    result.resize(size);
+    message.SerializeToArray(result.data(), size);
+    return result;
+}
+
+void appendField(QByteArray &message, int fieldNumber, const QByteArray &payload)
+{
+    using google::protobuf::internal::WireFormatLite;
+    using google::protobuf::io::CodedOutputStream;
+
+    const quint32 tag = WireFormatLite::MakeTag(fieldNumber, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+    const quint32 length = static_cast<quint32>(payload.size());
+
+    const int oldSize = message.size();
+    message.resize(oldSize + CodedOutputStream::VarintSize32(tag) + CodedOutputStream::VarintSize32(length));
+    auto *target = reinterpret_cast<google::protobuf::uint8 *>(message.data() + oldSize);
+    target = CodedOutputStream::WriteVarint32ToArray(tag, target);
+    CodedOutputStream::WriteVarint32ToArray(length, target);
+    message.append(payload);
+}
+
+} // namespace SerializedMessage
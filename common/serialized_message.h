@@ -0,0 +1,28 @@
+#ifndef SERIALIZED_MESSAGE_H
+#define SERIALIZED_MESSAGE_H
+
+#include <QByteArray>
+
+namespace google
+{
+namespace protobuf
+{
+class Message;
+}
+} // namespace google
+
+/**
+ * Helpers to assemble serialized protobuf messages from parts that were serialized before.
+ *
+ * Serialized messages can be concatenated on the wire: the fields of both parts are merged when parsing, and
+ * repeated fields are appended to each other. So a message whose parts rarely change can keep them serialized and
+ * put them together without building or serializing the whole message again.
+ */
+namespace SerializedMessage
+{
+QByteArray serialize(const ::google::protobuf::Message &message);
+// appends a length delimited field, i.e. a submessage, string or bytes field
+void appendField(QByteArray &message, int fieldNumber, const QByteArray &payload);
+} // namespace SerializedMessage
+
+#endif
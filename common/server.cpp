@@ -25,12 +25,15 @@
 #include "pb/event_list_rooms.pb.h"
 #include "pb/event_user_joined.pb.h"
 #include "pb/event_user_left.pb.h"
+#include "pb/isl_game_migration.pb.h"
 #include "pb/isl_message.pb.h"
+#include "pb/server_handoff.pb.h"
 #include "pb/session_event.pb.h"
 #include "server_counter.h"
 #include "server_database_interface.h"
 #include "server_game.h"
 #include "server_player.h"
+#include "server_presence.h"
 #include "server_protocolhandler.h"
 #include "server_remoteuserinterface.h"
 #include "server_room.h"
@@ -39,7 +42,9 @@
 #include <QDebug>
 #include <QThread>
 
-Server::Server(QObject *parent) : QObject(parent), nextLocalGameId(0), tcpUserCount(0), webSocketUserCount(0)
+Server::Server(QObject *parent)
+    : QObject(parent), pingClockInterval(0), nextLocalGameId(0), tcpUserCount(0), webSocketUserCount(0),
+      presence(new ServerPresence(this))
 {
     qRegisterMetaType<ServerInfo_Ban>("ServerInfo_Ban");
     qRegisterMetaType<ServerInfo_Game>("ServerInfo_Game");
@@ -49,6 +54,7 @@ Server::Server(QObject *parent) : QObject(parent), nextLocalGameId(0), tcpUserCo
     qRegisterMetaType<Response>("Response");
     qRegisterMetaType<GameEventContainer>("GameEventContainer");
     qRegisterMetaType<IslMessage>("IslMessage");
+    qRegisterMetaType<IslGameMigration>("IslGameMigration");
     qRegisterMetaType<Command_JoinGame>("Command_JoinGame");
 
     connect(this, &Server::sigSendIslMessage, this, &Server::doSendIslMessage, Qt::QueuedConnection);
@@ -75,6 +81,25 @@ Server_DatabaseInterface *Server::getDatabaseInterface() const
     return databaseInterfaces.value(QThread::currentThread());
 }
 
+void Server::startPingClock(int intervalMsecs)
+{
+    // Must be called before any client is created, the interval is read without locking.
+    pingClockInterval = intervalMsecs;
+    pingClock.start();
+}
+
+int Server::getPingClockTicks() const
+{
+    if (pingClockInterval <= 0)
+        return 0;
+    return static_cast<int>(pingClock.elapsed() / pingClockInterval);
+}
+
+qint64 Server::msecsUntilPingClockTick(int tick) const
+{
+    return qMax<qint64>(0, static_cast<qint64>(tick) * pingClockInterval - pingClock.elapsed());
+}
+
 AuthenticationResult Server::loginUser(Server_ProtocolHandler *session,
                                        QString &name,
                                        const QString &password,
@@ -110,24 +135,20 @@ AuthenticationResult Server::loginUser(Server_ProtocolHandler *session,
     name = QString::fromStdString(data.name()); // Compensate for case indifference
 
     if (authState == PasswordRight) {
-        if (users.contains(name) || databaseInterface->userSessionExists(name)) {
-            if (users.contains(name)) {
-                qDebug("Session already logged in, logging old session out");
-                Event_ConnectionClosed event;
-                event.set_reason(Event_ConnectionClosed::LOGGEDINELSEWERE);
-                event.set_reason_str("You have been logged out due to logging in at another location.");
-                event.set_end_time(QDateTime::currentDateTime().toSecsSinceEpoch());
-
-                SessionEvent *se = users.value(name)->prepareSessionEvent(event);
-                users.value(name)->sendProtocolItem(*se);
-                delete se;
-
-                users.value(name)->prepareDestroy();
-            } else {
-                qDebug() << "Active session and sessions table inconsistent, please validate session table information "
-                            "for user "
-                         << name;
-            }
+        // the users of this server are the active sessions, the sessions table is only written behind
+        Server_ProtocolHandler *oldSession = users.value(name);
+        if (oldSession) {
+            qDebug("Session already logged in, logging old session out");
+            Event_ConnectionClosed event;
+            event.set_reason(Event_ConnectionClosed::LOGGEDINELSEWERE);
+            event.set_reason_str("You have been logged out due to logging in at another location.");
+            event.set_end_time(QDateTime::currentDateTime().toSecsSinceEpoch());
+
+            SessionEvent *se = oldSession->prepareSessionEvent(event);
+            oldSession->sendProtocolItem(*se);
+            delete se;
+
+            oldSession->prepareDestroy();
         }
 
     } else if (authState == UnknownUser) {
@@ -135,50 +156,42 @@ AuthenticationResult Server::loginUser(Server_ProtocolHandler *session,
         // don't interfere with registered user names though.
         if (getRegOnlyServerEnabled()) {
             qDebug("Login denied: registration required");
-            databaseInterface->unlockSessionTables();
             return RegistrationRequired;
         }
 
         QString tempName = name;
         int i = 0;
-        while (users.contains(tempName) || databaseInterface->activeUserExists(tempName) ||
-               databaseInterface->userSessionExists(tempName))
+        while (users.contains(tempName) || databaseInterface->activeUserExists(tempName))
             tempName = name + "_" + QString::number(++i);
         name = tempName;
         data.set_name(name.toStdString());
     }
 
-    QWriteLocker locker(&clientsLock);
-    databaseInterface->lockSessionTables();
-    users.insert(name, session);
     qDebug() << "Server::loginUser:" << session << "name=" << name;
-
     data.set_session_id(static_cast<google::protobuf::uint64>(
         databaseInterface->startSession(name, session->getAddress(), clientid, session->getConnectionType())));
-    databaseInterface->unlockSessionTables();
+    qDebug() << "session id:" << data.session_id();
+
+    // Other threads read the user info of any client while holding clientsLock for reading, so it is only
+    // swapped in under the write lock. The session becomes visible through the user maps afterwards.
+    clientsLock.lockForWrite();
+    session->setUserInfo(data);
+    clientsLock.unlock();
 
+    users.insert(name, session);
     usersBySessionId.insert(data.session_id(), session);
 
-    qDebug() << "session id:" << data.session_id();
-    session->setUserInfo(data);
+    presence->userJoined(session->copyUserInfo(false));
 
     Event_UserJoined event;
-    event.mutable_user_info()->CopyFrom(session->copyUserInfo(false));
-    SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
-    for (auto &client : clients)
-        if (client->getAcceptsUserListChanges())
-            client->sendProtocolItem(*se);
-    delete se;
-
-    event.mutable_user_info()->CopyFrom(session->copyUserInfo(true, true, true));
-    locker.unlock();
+    session->copyUserInfo(*event.mutable_user_info(), true, true, true);
 
     if (hasClientId) {
         // update users database table with client id
         databaseInterface->updateUsersClientID(name, clientid);
     }
     databaseInterface->updateUsersLastLoginData(name, clientVersion);
-    se = Server_ProtocolHandler::prepareSessionEvent(event);
+    SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
     sendIsl_SessionEvent(*se);
     delete se;
 
@@ -205,7 +218,7 @@ QList<PlayerReference> Server::getPersistentPlayerReferences(const QString &user
 
 Server_AbstractUserInterface *Server::findUser(const QString &userName) const
 {
-    // Call this only with clientsLock set.
+    // Call this only with clientsLock set; it keeps the returned user alive, the lookup itself does not need it.
 
     Server_AbstractUserInterface *userHandler = users.value(userName);
     if (userHandler)
@@ -223,16 +236,17 @@ void Server::addClient(Server_ProtocolHandler *client)
         webSocketUserCount++;
 
     QWriteLocker locker(&clientsLock);
-    clients << client;
+    clients.insert(client);
 }
 
 void Server::removeClient(Server_ProtocolHandler *client)
 {
-    int clientIndex = clients.indexOf(client);
-    if (clientIndex == -1) {
+    QWriteLocker locker(&clientsLock);
+    if (!clients.remove(client)) {
         qWarning() << "tried to remove non existing client";
         return;
     }
+    presence->removeClient(client);
 
     if (client->getConnectionType() == "tcp")
         tcpUserCount--;
@@ -240,30 +254,34 @@ void Server::removeClient(Server_ProtocolHandler *client)
     if (client->getConnectionType() == "websocket")
         webSocketUserCount--;
 
-    QWriteLocker locker(&clientsLock);
-    clients.removeAt(clientIndex);
     ServerInfo_User *data = client->getUserInfo();
+    const QString userName = data ? QString::fromStdString(data->name()) : QString();
+    if (data) {
+        users.remove(userName, client);
+        if (data->has_session_id())
+            usersBySessionId.remove(data->session_id(), client);
+    }
+    const int remainingClients = clients.size();
+    locker.unlock();
+
     if (data) {
+        presence->userLeft(userName);
+
         Event_UserLeft event;
         event.set_name(data->name());
         SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
-        for (auto &_client : clients)
-            if (_client->getAcceptsUserListChanges())
-                _client->sendProtocolItem(*se);
         sendIsl_SessionEvent(*se);
         delete se;
 
-        users.remove(QString::fromStdString(data->name()));
-        qDebug() << "Server::removeClient: name=" << QString::fromStdString(data->name());
+        qDebug() << "Server::removeClient: name=" << userName;
 
         if (data->has_session_id()) {
             const qint64 sessionId = data->session_id();
-            usersBySessionId.remove(sessionId);
             emit endSession(sessionId);
             qDebug() << "closed session id:" << sessionId;
         }
     }
-    qDebug() << "Server::removeClient: removed" << (void *)client << ";" << clients.size() << "clients; "
+    qDebug() << "Server::removeClient: removed" << (void *)client << ";" << remainingClients << "clients; "
              << users.size() << "users left";
 }
 
@@ -290,17 +308,10 @@ void Server::externalUserJoined(const ServerInfo_User &userInfo)
     Server_RemoteUserInterface *newUser = new Server_RemoteUserInterface(this, ServerInfo_User_Container(userInfo));
     externalUsers.insert(QString::fromStdString(userInfo.name()), newUser);
     externalUsersBySessionId.insert(userInfo.session_id(), newUser);
-
-    Event_UserJoined event;
-    event.mutable_user_info()->CopyFrom(userInfo);
-
-    SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
-    for (auto &client : clients)
-        if (client->getAcceptsUserListChanges())
-            client->sendProtocolItem(*se);
-    delete se;
     clientsLock.unlock();
 
+    presence->userJoined(userInfo);
+
     ResponseContainer rc(-1);
     newUser->joinPersistentGames(rc);
     newUser->sendResponseContainer(rc, Response::RespNothing);
@@ -340,16 +351,7 @@ void Server::externalUserLeft(const QString &userName)
 
     delete user;
 
-    Event_UserLeft event;
-    event.set_name(userName.toStdString());
-
-    SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
-    clientsLock.lockForRead();
-    for (auto &client : clients)
-        if (client->getAcceptsUserListChanges())
-            client->sendProtocolItem(*se);
-    clientsLock.unlock();
-    delete se;
+    presence->userLeft(userName);
 }
 
 void Server::externalRoomUserJoined(int roomId, const ServerInfo_User &userInfo)
@@ -476,6 +478,12 @@ void Server::externalGameCommandContainerReceived(const CommandContainer &cont,
         QReadLocker roomGamesLocker(&room->gamesLock);
         Server_Game *game = room->getGames().value(cont.game_id());
         if (!game) {
+            // the game moved on to another server before the sender learned about it, see Server_Game::migrate()
+            const int hostServerId = room->getExternalGames().value(cont.game_id()).server_id();
+            if (room->getExternalGames().contains(cont.game_id()) && hostServerId != serverId) {
+                sendIsl_GameCommand(cont, hostServerId, sessionId, cont.room_id(), playerId);
+                return;
+            }
             qDebug() << "externalGameCommandContainerReceived: game id=" << cont.game_id() << "not found";
             throw Response::RespNotInRoom;
         }
@@ -513,6 +521,79 @@ void Server::externalGameCommandContainerReceived(const CommandContainer &cont,
     }
 }
 
+void Server::externalGameMigrationReceived(const IslGameMigration &migration, int serverId)
+{
+    // This function is always called from the main thread via signal/slot.
+
+    Server_Game *game = adoptGame(migration);
+    if (!game)
+        return;
+    qDebug() << "Game" << migration.game_info().game_id() << "migrated here from server" << serverId;
+    game->startGameIfReady(migration.force_start());
+}
+
+bool Server::adoptHandoffGame(const HandoffGame &info)
+{
+    if (!adoptGame(info.migration(), &info))
+        return false;
+
+    // without a database the game ids are counted here, the new ones must not come back to the adopted ones
+    QMutexLocker locker(&nextLocalGameIdMutex);
+    nextLocalGameId = qMax(nextLocalGameId, info.migration().game_info().game_id());
+    return true;
+}
+
+Server_Game *Server::adoptGame(const IslGameMigration &migration, const HandoffGame *handoff)
+{
+    const ServerInfo_Game &gameInfo = migration.game_info();
+    QReadLocker roomsLocker(&roomsLock);
+    Server_Room *room = rooms.value(gameInfo.room_id());
+    if (!room) {
+        qDebug() << "adoptGame: room id=" << gameInfo.room_id() << "not found";
+        return nullptr;
+    }
+    room->gamesLock.lockForRead();
+    const bool gameIdTaken = room->getGames().contains(gameInfo.game_id());
+    room->gamesLock.unlock();
+    if (gameIdTaken) {
+        qWarning() << "adoptGame: game id=" << gameInfo.game_id() << "already taken";
+        return nullptr;
+    }
+
+    QList<int> gameTypes;
+    for (int gameType : gameInfo.game_types())
+        gameTypes.append(gameType);
+    auto *game = new Server_Game(gameInfo.creator_info(), gameInfo.game_id(),
+                                 QString::fromStdString(gameInfo.description()),
+                                 QString::fromStdString(migration.password()), static_cast<int>(gameInfo.max_players()),
+                                 gameTypes, gameInfo.only_buddies(), gameInfo.only_registered(),
+                                 gameInfo.spectators_allowed(), gameInfo.spectators_need_password(),
+                                 gameInfo.spectators_can_chat(), gameInfo.spectators_omniscient(),
+                                 migration.starting_life_total(), room);
+
+    // the users looked up for the players stay around until the game is listed and their disconnects find it
+    clientsLock.lockForRead();
+    game->adoptMigration(migration);
+    if (handoff)
+        game->adoptHandoff(*handoff);
+    room->addGame(game);
+    clientsLock.unlock();
+    return game;
+}
+
+void Server::adoptSession(Server_ProtocolHandler *session, const ServerInfo_User &userInfo)
+{
+    // the session was started in the database and announced to everybody by the process that ran before; the user
+    // info is swapped in like loginUser() does
+    clientsLock.lockForWrite();
+    session->setUserInfo(userInfo);
+    clientsLock.unlock();
+
+    users.insert(QString::fromStdString(userInfo.name()), session);
+    if (userInfo.has_session_id())
+        usersBySessionId.insert(userInfo.session_id(), session);
+}
+
 void Server::externalGameEventContainerReceived(const GameEventContainer &cont, qint64 sessionId)
 {
     // This function is always called from the main thread via signal/slot.
@@ -574,7 +655,6 @@ void Server::addRoom(Server_Room *newRoom)
 
 int Server::getUsersCount() const
 {
-    QReadLocker locker(&clientsLock);
     return users.size();
 }
 
@@ -661,3 +741,12 @@ void Server::sendIsl_RoomCommand(const CommandContainer &item, int serverId, qin
 
     emit sigSendIslMessage(msg, serverId);
 }
+
+void Server::sendIsl_GameMigration(const IslGameMigration &migration, int serverId)
+{
+    IslMessage msg;
+    msg.set_message_type(IslMessage::GAME_MIGRATION);
+    msg.mutable_game_migration()->CopyFrom(migration);
+
+    emit sigSendIslMessage(msg, serverId);
+}
@@ -1,26 +1,36 @@
 #ifndef SERVER_H
 #define SERVER_H
 
+#include "deck_list_cache.h"
 #include "pb/commands.pb.h"
 #include "pb/serverinfo_ban.pb.h"
 #include "pb/serverinfo_chat_message.pb.h"
 #include "pb/serverinfo_user.pb.h"
 #include "pb/serverinfo_warning.pb.h"
 #include "server_player_reference.h"
+#include "sharded_map.h"
+#include "user_game_index.h"
 
+#include <QElapsedTimer>
 #include <QMap>
 #include <QMultiMap>
 #include <QMutex>
 #include <QObject>
 #include <QReadWriteLock>
+#include <QSet>
 #include <QStringList>
 
+class GameExecutor;
 class Server_DatabaseInterface;
 class Server_Game;
 class Server_Room;
 class Server_ProtocolHandler;
 class Server_AbstractUserInterface;
+class ServerPresence;
 class GameReplay;
+class GameReplayWriter;
+class HandoffGame;
+class IslGameMigration;
 class IslMessage;
 class SessionEvent;
 class RoomEvent;
@@ -49,13 +59,14 @@ class Server : public QObject
 {
     Q_OBJECT
 signals:
-    void pingClockTimeout();
     void sigSendIslMessage(const IslMessage &message, int serverId);
     void endSession(qint64 sessionId);
 private slots:
     void broadcastRoomUpdate(const ServerInfo_Room &roomInfo, bool sendToIsl = false);
 
 public:
+    // clientsLock guards the clients list and the external users. Local users are kept in sharded maps with
+    // their own leaf locks; clientsLock only needs to be held for reading while dereferencing a looked up user.
     mutable QReadWriteLock clientsLock, roomsLock; // locking order: roomsLock before clientsLock
     explicit Server(QObject *parent = nullptr);
     ~Server() override = default;
@@ -75,13 +86,22 @@ public:
     }
 
     Server_AbstractUserInterface *findUser(const QString &userName) const;
-    const QMap<QString, Server_ProtocolHandler *> &getUsers() const
+    Server_ProtocolHandler *findLocalUser(const QString &userName) const
     {
-        return users;
+        return users.value(userName);
     }
-    const QMap<qint64, Server_ProtocolHandler *> &getUsersBySessionId() const
+    Server_ProtocolHandler *findUserBySessionId(qint64 sessionId) const
     {
-        return usersBySessionId;
+        return usersBySessionId.value(sessionId);
+    }
+    QList<Server_ProtocolHandler *> getUserList() const
+    {
+        return users.values();
+    }
+    // returns up to count local users, in name order, whose names come after userName
+    QList<Server_ProtocolHandler *> getUsersAfter(const QString &userName, int count) const
+    {
+        return users.valuesAfter(userName, count);
     }
     virtual QMap<QString, bool> getServerRequiredFeatureList() const
     {
@@ -89,6 +109,20 @@ public:
     }
     void addClient(Server_ProtocolHandler *player);
     void removeClient(Server_ProtocolHandler *player);
+    /**
+     * Takes over what the process running the server before handed over on a hot restart: a game, and a session
+     * that logged in there, added to the users without telling anybody since for them nothing changed.
+     */
+    bool adoptHandoffGame(const HandoffGame &info);
+    void adoptSession(Server_ProtocolHandler *session, const ServerInfo_User &userInfo);
+    ServerPresence *getPresence() const
+    {
+        return presence;
+    }
+    UserGameIndex &getUserGameIndex()
+    {
+        return userGameIndex;
+    }
     QList<QString> getOnlineModeratorList() const;
     virtual QString getLoginMessage() const
     {
@@ -126,6 +160,26 @@ public:
     {
         return true;
     }
+    /**
+     * Directory running games spool their replays to. Replays are kept in memory if this is empty.
+     */
+    virtual QString getReplaySpoolDirectory() const
+    {
+        return QString();
+    }
+    /**
+     * Directory the games all players left are hibernated to, see Server_Game::hibernate(). Games stay in memory if
+     * this is empty.
+     */
+    virtual QString getGameHibernationDirectory() const
+    {
+        return QString();
+    }
+    // seconds all players of a game have to be gone before it is hibernated; 0 never hibernates games
+    virtual int getGameHibernationTime() const
+    {
+        return 0;
+    }
     virtual int getIdleClientTimeout() const
     {
         return 0;
@@ -138,6 +192,25 @@ public:
     {
         return 9999999;
     }
+    virtual int getPingVectorInterval() const
+    {
+        return 1;
+    }
+    // the spectators of a game share one stream of events sent every this many milliseconds; 0 sends them live
+    virtual int getSpectatorStreamInterval() const
+    {
+        return 0;
+    }
+    // how many seconds the spectator stream is behind the game
+    virtual int getSpectatorStreamDelay() const
+    {
+        return 0;
+    }
+    // how many of the game event containers last sent to a registered player are kept for them to resume, see ResumeLog
+    virtual int getResumeLogLength() const
+    {
+        return 0;
+    }
     virtual int getMaxPlayerInactivityTime() const
     {
         return 9999999;
@@ -166,6 +239,27 @@ public:
     {
         return 0;
     }
+    // every how many command containers are traced, 0 for none
+    virtual int getCommandTraceSampleRate() const
+    {
+        return 0;
+    }
+    // traced commands taking at least this many milliseconds are logged, 0 for none; see CommandTrace
+    virtual int getSlowCommandThreshold(int /* commandKey */) const
+    {
+        return 0;
+    }
+    // whether the clients only hear about their buddies joining and leaving the server, see ServerPresence
+    virtual bool getBuddyOnlyPresenceEnabled() const
+    {
+        return false;
+    }
+    // milliseconds the game list changes of a room are collected for before they are sent together, 0 sends every
+    // change right away
+    virtual int getGameListUpdateInterval() const
+    {
+        return 0;
+    }
     virtual int getMaxUserTotal() const
     {
         return 9999999;
@@ -174,12 +268,39 @@ public:
     {
         return 0;
     }
+    /**
+     * Whether a game whose players are mostly connected to another server of the network is handed over to that
+     * server when it starts for the first time, see Server_Game::migrate().
+     */
+    virtual bool getGameMigrationEnabled() const
+    {
+        return false;
+    }
+    virtual bool isIslPeerConnected(int /* serverId */)
+    {
+        return false;
+    }
     virtual bool permitCreateGameAsJudge() const
     {
         return false;
     }
+    // false if no client takes the serialized messages, see Server_AbstractUserInterface::sendSerializedProtocolItem()
+    virtual bool getSendsSerializedMessages() const
+    {
+        return true;
+    }
+    // when this returns an executor, the game commands of the users run on it instead of their connection threads
+    virtual GameExecutor *getGameExecutor() const
+    {
+        return nullptr;
+    }
 
     Server_DatabaseInterface *getDatabaseInterface() const;
+    // the decks players select are read through this, so that the same list isn't parsed for every game
+    DeckListCache &getDeckListCache()
+    {
+        return deckListCache;
+    }
     int getNextLocalGameId()
     {
         QMutexLocker locker(&nextLocalGameIdMutex);
@@ -192,6 +313,7 @@ public:
     void sendIsl_RoomEvent(const RoomEvent &item, int serverId = -1, qint64 sessionId = -1);
     void sendIsl_GameCommand(const CommandContainer &item, int serverId, qint64 sessionId, int roomId, int playerId);
     void sendIsl_RoomCommand(const CommandContainer &item, int serverId, qint64 sessionId, int roomId);
+    void sendIsl_GameMigration(const IslGameMigration &migration, int serverId);
 
     const QMap<QString, Server_AbstractUserInterface *> &getExternalUsers() const
     {
@@ -212,11 +334,28 @@ public:
         return webSocketUserCount;
     }
 
+    // The ping clock counts keepalive periods since it was started. Clients schedule their idle and
+    // inactivity deadlines against it; an interval of 0 means the clock is not running.
+    int getPingClockInterval() const
+    {
+        return pingClockInterval;
+    }
+    int getPingClockTicks() const;
+    qint64 msecsUntilPingClockTick(int tick) const;
+
 private:
+    QElapsedTimer pingClock;
+    int pingClockInterval;
     QMultiMap<QString, PlayerReference> persistentPlayers;
     mutable QReadWriteLock persistentPlayersLock;
     int nextLocalGameId, tcpUserCount, webSocketUserCount;
     QMutex nextLocalGameIdMutex;
+    DeckListCache deckListCache;
+    ServerPresence *presence;
+    UserGameIndex userGameIndex;
+
+    // creates a game that moved here with its players, and adds it to its room; needs the main thread
+    Server_Game *adoptGame(const IslGameMigration &migration, const HandoffGame *handoff = nullptr);
 
 protected slots:
     void externalUserJoined(const ServerInfo_User &userInfo);
@@ -230,6 +369,7 @@ protected slots:
     externalJoinGameCommandReceived(const Command_JoinGame &cmd, int cmdId, int roomId, int serverId, qint64 sessionId);
     void
     externalGameCommandContainerReceived(const CommandContainer &cont, int playerId, int serverId, qint64 sessionId);
+    void externalGameMigrationReceived(const IslGameMigration &migration, int serverId);
     void externalGameEventContainerReceived(const GameEventContainer &cont, qint64 sessionId);
     void externalResponseReceived(const Response &resp, qint64 sessionId);
 
@@ -240,9 +380,10 @@ protected slots:
 protected:
     void prepareDestroy();
     void setDatabaseInterface(Server_DatabaseInterface *_databaseInterface);
-    QList<Server_ProtocolHandler *> clients;
-    QMap<qint64, Server_ProtocolHandler *> usersBySessionId;
-    QMap<QString, Server_ProtocolHandler *> users;
+    void startPingClock(int intervalMsecs);
+    QSet<Server_ProtocolHandler *> clients;
+    ShardedMap<qint64, Server_ProtocolHandler *> usersBySessionId;
+    ShardedMap<QString, Server_ProtocolHandler *> users;
     QMap<qint64, Server_AbstractUserInterface *> externalUsersBySessionId;
     QMap<QString, Server_AbstractUserInterface *> externalUsers;
     QMap<int, Server_Room *> rooms;
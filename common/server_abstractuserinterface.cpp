@@ -1,7 +1,9 @@
 #include "server_abstractuserinterface.h"
 
+#include "get_pb_extension.h"
 #include "pb/event_game_joined.pb.h"
 #include "pb/event_game_state_changed.pb.h"
+#include "serialized_message.h"
 #include "server.h"
 #include "server_game.h"
 #include "server_player.h"
@@ -36,12 +38,76 @@ void Server_AbstractUserInterface::sendProtocolItemByType(ServerMessage::Message
 SessionEvent *Server_AbstractUserInterface::prepareSessionEvent(const ::google::protobuf::Message &sessionEvent)
 {
     SessionEvent *event = new SessionEvent;
-    event->GetReflection()
-        ->MutableMessage(event, sessionEvent.GetDescriptor()->FindExtensionByName("ext"))
-        ->CopyFrom(sessionEvent);
+    setPbExtension(event, sessionEvent);
     return event;
 }
 
+QByteArray Server_AbstractUserInterface::serializeServerMessage(const ServerMessage &message)
+{
+    return SerializedMessage::serialize(message);
+}
+
+QByteArray Server_AbstractUserInterface::serializeGameEventContainer(const GameEventContainer &item)
+{
+    ServerMessage msg;
+    msg.mutable_game_event_container()->CopyFrom(item);
+    msg.set_message_type(ServerMessage::GAME_EVENT_CONTAINER);
+
+    return serializeServerMessage(msg);
+}
+
+QByteArray Server_AbstractUserInterface::serializeRoomEvent(const RoomEvent &item)
+{
+    ServerMessage msg;
+    msg.mutable_room_event()->CopyFrom(item);
+    msg.set_message_type(ServerMessage::ROOM_EVENT);
+
+    return serializeServerMessage(msg);
+}
+
+QByteArray Server_AbstractUserInterface::serializeResponse(const Response &response,
+                                                           int extensionNumber,
+                                                           const QByteArray &serializedExtension)
+{
+    QByteArray serializedResponse = SerializedMessage::serialize(response);
+    SerializedMessage::appendField(serializedResponse, extensionNumber, serializedExtension);
+
+    ServerMessage msg;
+    msg.set_message_type(ServerMessage::RESPONSE);
+    QByteArray result = serializeServerMessage(msg);
+    SerializedMessage::appendField(result, ServerMessage::kResponseFieldNumber, serializedResponse);
+    return result;
+}
+
+void Server_AbstractUserInterface::sendSerializedResponse(const QByteArray &serializedMessage)
+{
+    ServerMessage msg;
+    if (msg.ParseFromArray(serializedMessage.constData(), serializedMessage.size()))
+        sendProtocolItem(msg.response());
+}
+
+void Server_AbstractUserInterface::sendSerializedServerMessage(const QByteArray &serializedMessage)
+{
+    ServerMessage msg;
+    if (!msg.ParseFromArray(serializedMessage.constData(), serializedMessage.size()))
+        return;
+
+    switch (msg.message_type()) {
+        case ServerMessage::RESPONSE:
+            sendProtocolItem(msg.response());
+            break;
+        case ServerMessage::SESSION_EVENT:
+            sendProtocolItem(msg.session_event());
+            break;
+        case ServerMessage::GAME_EVENT_CONTAINER:
+            sendProtocolItem(msg.game_event_container());
+            break;
+        case ServerMessage::ROOM_EVENT:
+            sendProtocolItem(msg.room_event());
+            break;
+    }
+}
+
 void Server_AbstractUserInterface::sendResponseContainer(const ResponseContainer &responseContainer,
                                                          Response::ResponseCode responseCode)
 {
@@ -56,16 +122,20 @@ void Server_AbstractUserInterface::sendResponseContainer(const ResponseContainer
         response.set_response_code(responseCode);
         ::google::protobuf::Message *responseExtension = responseContainer.getResponseExtension();
         if (responseExtension)
-            response.GetReflection()
-                ->MutableMessage(&response, responseExtension->GetDescriptor()->FindExtensionByName("ext"))
-                ->CopyFrom(*responseExtension);
-        sendProtocolItem(response);
+            setPbExtension(&response, *responseExtension);
+        if (!responseContainer.getSerializedResponseExtension().isEmpty())
+            sendSerializedResponse(serializeResponse(response, responseContainer.getSerializedExtensionNumber(),
+                                                     responseContainer.getSerializedResponseExtension()));
+        else
+            sendProtocolItem(response);
     }
 
     const QList<QPair<ServerMessage::MessageType, ::google::protobuf::Message *>> &postResponseQueue =
         responseContainer.getPostResponseQueue();
     for (int i = 0; i < postResponseQueue.size(); ++i)
         sendProtocolItemByType(postResponseQueue[i].first, *postResponseQueue[i].second);
+    for (const QByteArray &serializedMessage : responseContainer.getSerializedPostResponseQueue())
+        sendSerializedServerMessage(serializedMessage);
 }
 
 void Server_AbstractUserInterface::playerRemovedFromGame(Server_Game *game)
@@ -74,17 +144,39 @@ void Server_AbstractUserInterface::playerRemovedFromGame(Server_Game *game)
 
     QMutexLocker locker(&gameListMutex);
     games.remove(game->getGameId());
+    gameHandles.remove(game->getGameId());
 }
 
-void Server_AbstractUserInterface::playerAddedToGame(int gameId, int roomId, int playerId)
+void Server_AbstractUserInterface::playerAddedToGame(int gameId,
+                                                     int roomId,
+                                                     int playerId,
+                                                     const std::shared_ptr<Server_GameHandle> &gameHandle)
 {
     qDebug() << "Server_AbstractUserInterface::playerAddedToGame(): gameId =" << gameId;
 
     QMutexLocker locker(&gameListMutex);
     games.insert(gameId, QPair<int, int>(roomId, playerId));
+    if (gameHandle)
+        gameHandles.insert(gameId, gameHandle);
+    else
+        gameHandles.remove(gameId);
 }
 
-void Server_AbstractUserInterface::joinPersistentGames(ResponseContainer &rc)
+bool Server_AbstractUserInterface::findGame(int gameId,
+                                            QPair<int, int> &roomIdAndPlayerId,
+                                            std::shared_ptr<Server_GameHandle> &gameHandle) const
+{
+    QMutexLocker locker(&gameListMutex);
+    auto game = games.constFind(gameId);
+    if (game == games.constEnd())
+        return false;
+
+    roomIdAndPlayerId = *game;
+    gameHandle = gameHandles.value(gameId);
+    return true;
+}
+
+void Server_AbstractUserInterface::joinPersistentGames(ResponseContainer &rc, const QMap<int, quint64> &resumePoints)
 {
     QList<PlayerReference> gamesToJoin =
         server->getPersistentPlayerReferences(QString::fromStdString(userInfo->name()));
@@ -104,11 +196,18 @@ void Server_AbstractUserInterface::joinPersistentGames(ResponseContainer &rc)
         QMutexLocker gameLocker(&game->gameMutex);
 
         Server_Player *player = game->getPlayers().value(pr.getPlayerId());
-        if (!player)
+        if (!player || !game->wakeUp())
+            continue;
+
+        // the state of the game is only sent again when the client missed too much
+        auto resumePoint = resumePoints.constFind(game->getGameId());
+        if (resumePoint != resumePoints.constEnd() && player->resumeUserInterface(this, *resumePoint)) {
+            playerAddedToGame(game->getGameId(), room->getId(), player->getPlayerId(), game->getHandle());
             continue;
+        }
 
         player->setUserInterface(this);
-        playerAddedToGame(game->getGameId(), room->getId(), player->getPlayerId());
+        playerAddedToGame(game->getGameId(), room->getId(), player->getPlayerId(), game->getHandle());
 
         game->createGameJoinedEvent(player, rc, true);
     }
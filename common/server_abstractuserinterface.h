@@ -1,13 +1,18 @@
 #ifndef SERVER_ABSTRACTUSERINTERFACE
 #define SERVER_ABSTRACTUSERINTERFACE
 
+#include "activity_meter.h"
 #include "pb/response.pb.h"
 #include "pb/server_message.pb.h"
+#include "server_game_handle.h"
 #include "serverinfo_user_container.h"
 
+#include <QByteArray>
 #include <QMap>
 #include <QMutex>
 #include <QPair>
+#include <QString>
+#include <memory>
 
 class SessionEvent;
 class GameEventContainer;
@@ -22,8 +27,11 @@ class Server_AbstractUserInterface : public ServerInfo_User_Container
 private:
     mutable QMutex gameListMutex;
     QMap<int, QPair<int, int>> games; // gameId -> (roomId, playerId)
+    // of the games hosted by this server, by gameId
+    QMap<int, std::shared_ptr<Server_GameHandle>> gameHandles;
 protected:
     Server *server;
+    ActivityMeter activity;
 
 public:
     explicit Server_AbstractUserInterface(Server *_server) : server(_server)
@@ -38,25 +46,64 @@ public:
     }
 
     virtual int getLastCommandTime() const = 0;
+    // the commands of the user and what the user was sent, for the activity view of the moderators
+    ActivityMeter &getActivity()
+    {
+        return activity;
+    }
     virtual bool addSaidMessageSize(int size) = 0;
+    virtual bool clientSupportsFeature(const QString & /* featureName */) const
+    {
+        return false;
+    }
 
     void playerRemovedFromGame(Server_Game *game);
-    void playerAddedToGame(int gameId, int roomId, int playerId);
-    void joinPersistentGames(ResponseContainer &rc);
+    void playerAddedToGame(int gameId,
+                           int roomId,
+                           int playerId,
+                           const std::shared_ptr<Server_GameHandle> &gameHandle = nullptr);
+    // resumePoints has the last resume_sequence the client got for each game it kept, see Command_Login
+    void joinPersistentGames(ResponseContainer &rc, const QMap<int, quint64> &resumePoints = {});
 
     QMap<int, QPair<int, int>> getGames() const
     {
         QMutexLocker locker(&gameListMutex);
         return games;
     }
+    /**
+     * Looks up one of the games of the user, without copying the whole list. gameHandle stays empty for the games
+     * hosted by other servers.
+     */
+    bool findGame(int gameId, QPair<int, int> &roomIdAndPlayerId, std::shared_ptr<Server_GameHandle> &gameHandle) const;
 
     virtual void sendProtocolItem(const Response &item) = 0;
     virtual void sendProtocolItem(const SessionEvent &item) = 0;
     virtual void sendProtocolItem(const GameEventContainer &item) = 0;
     virtual void sendProtocolItem(const RoomEvent &item) = 0;
+    // Send a game event container or room event together with its already serialized ServerMessage, so that an event
+    // can be serialized once and the same buffer handed to every recipient. Interfaces that can't use the buffer send
+    // the item.
+    virtual void sendSerializedProtocolItem(const GameEventContainer &item, const QByteArray & /* serializedMessage */)
+    {
+        sendProtocolItem(item);
+    }
+    virtual void sendSerializedProtocolItem(const RoomEvent &item, const QByteArray & /* serializedMessage */)
+    {
+        sendProtocolItem(item);
+    }
+    // Sends a response assembled from serialized parts, see ResponseContainer::setSerializedResponseExtension().
+    // Interfaces that can't use the buffer send the parsed response.
+    virtual void sendSerializedResponse(const QByteArray &serializedMessage);
+    // Sends a serialized ServerMessage of any type, interfaces that can't use the buffer send the parsed item.
+    virtual void sendSerializedServerMessage(const QByteArray &serializedMessage);
     void sendProtocolItemByType(ServerMessage::MessageType type, const ::google::protobuf::Message &item);
 
     static SessionEvent *prepareSessionEvent(const ::google::protobuf::Message &sessionEvent);
+    static QByteArray serializeServerMessage(const ServerMessage &message);
+    static QByteArray serializeGameEventContainer(const GameEventContainer &item);
+    static QByteArray serializeRoomEvent(const RoomEvent &item);
+    static QByteArray
+    serializeResponse(const Response &response, int extensionNumber, const QByteArray &serializedExtension);
     void sendResponseContainer(const ResponseContainer &responseContainer, Response::ResponseCode responseCode);
 };
 
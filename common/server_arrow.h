@@ -1,13 +1,14 @@
 #ifndef SERVER_ARROW_H
 #define SERVER_ARROW_H
 
+#include "game_object_pool.h"
 #include "pb/color.pb.h"
 
 class Server_Card;
 class Server_ArrowTarget;
 class ServerInfo_Arrow;
 
-class Server_Arrow
+class Server_Arrow : public PooledGameObject
 {
 private:
     int id;
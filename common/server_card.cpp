@@ -28,8 +28,19 @@
 #include <QVariant>
 
 Server_Card::Server_Card(const CardRef &cardRef, int _id, int _coord_x, int _coord_y, Server_CardZone *_zone)
-    : zone(_zone), id(_id), coord_x(_coord_x), coord_y(_coord_y), cardRef(cardRef), tapped(false), attacking(false),
-      facedown(false), destroyOnZoneChange(false), doesntUntap(false), parentCard(0), stashedCard(nullptr)
+    : Server_Card(StringAtom(cardRef.name), StringAtom(cardRef.providerId), _id, _coord_x, _coord_y, _zone)
+{
+}
+
+Server_Card::Server_Card(const StringAtom &_name,
+                         const StringAtom &_providerId,
+                         int _id,
+                         int _coord_x,
+                         int _coord_y,
+                         Server_CardZone *_zone)
+    : zone(_zone), id(_id), coord_x(_coord_x), coord_y(_coord_y), name(_name), providerId(_providerId),
+      tapped(false), attacking(false), facedown(false), destroyOnZoneChange(false), doesntUntap(false), parentCard(0),
+      stashedCard(nullptr)
 {
 }
 
@@ -48,9 +59,35 @@ Server_Card::~Server_Card()
     }
 }
 
+void Server_Card::invalidateZoneSnapshot()
+{
+    if (zone)
+        zone->invalidateSnapshot();
+}
+
+void Server_Card::setZone(Server_CardZone *_zone)
+{
+    zone = _zone;
+    // the attach info of the attached cards names the zone of their parent
+    for (Server_Card *attachedCard : attachedCards)
+        attachedCard->invalidateZoneSnapshot();
+}
+
+void Server_Card::setId(int _id)
+{
+    const int oldId = id;
+    id = _id;
+    if (zone)
+        zone->updateCardId(this, oldId);
+    invalidateZoneSnapshot();
+    for (Server_Card *attachedCard : attachedCards)
+        attachedCard->invalidateZoneSnapshot();
+}
+
 void Server_Card::resetState(bool keepAnnotations)
 {
     counters.clear();
+    invalidateZoneSnapshot();
     setTapped(false);
     setAttacking(false);
     setPT(QString());
@@ -104,12 +141,28 @@ QString Server_Card::setAttribute(CardAttribute attribute, const QString &avalue
     return avalue;
 }
 
+int Server_Card::getCounter(int counter_id) const
+{
+    for (const auto &counter : counters)
+        if (counter.first == counter_id)
+            return counter.second;
+    return 0;
+}
+
 void Server_Card::setCounter(int _id, int value, Event_SetCardCounter *event)
 {
-    if (value)
-        counters.insert(_id, value);
+    int index = 0;
+    while (index < counters.size() && counters[index].first < _id)
+        ++index;
+    const bool exists = index < counters.size() && counters[index].first == _id;
+    if (!value) {
+        if (exists)
+            counters.remove(index);
+    } else if (exists)
+        counters[index].second = value;
     else
-        counters.remove(_id);
+        counters.insert(index, qMakePair(_id, value));
+    invalidateZoneSnapshot();
 
     if (event) {
         event->set_counter_id(_id);
@@ -124,15 +177,14 @@ void Server_Card::setParentCard(Server_Card *_parentCard)
     parentCard = _parentCard;
     if (parentCard)
         parentCard->addAttachedCard(this);
+    invalidateZoneSnapshot();
 }
 
 void Server_Card::getInfo(ServerInfo_Card *info)
 {
-    QString displayedName = facedown ? QString() : cardRef.name;
-
     info->set_id(id);
-    info->set_provider_id(cardRef.providerId.toStdString());
-    info->set_name(displayedName.toStdString());
+    info->set_provider_id(providerId.toStdString());
+    info->set_name(facedown ? std::string() : name.toStdString());
     info->set_x(coord_x);
     info->set_y(coord_y);
     if (facedown) {
@@ -158,17 +210,15 @@ void Server_Card::getInfo(ServerInfo_Card *info)
         info->set_doesnt_untap(true);
     }
 
-    QMapIterator<int, int> cardCounterIterator(counters);
-    while (cardCounterIterator.hasNext()) {
-        cardCounterIterator.next();
+    for (const auto &counter : counters) {
         ServerInfo_CardCounter *counterInfo = info->add_counter_list();
-        counterInfo->set_id(cardCounterIterator.key());
-        counterInfo->set_value(cardCounterIterator.value());
+        counterInfo->set_id(counter.first);
+        counterInfo->set_value(counter.second);
     }
 
     if (parentCard) {
         info->set_attach_player_id(parentCard->getZone()->getPlayer()->getPlayerId());
-        info->set_attach_zone(parentCard->getZone()->getName().toStdString());
+        info->set_attach_zone(parentCard->getZone()->getNameAtom().toStdString());
         info->set_attach_card_id(parentCard->getId());
     }
 }
@@ -21,26 +21,36 @@
 #define SERVER_CARD_H
 
 #include "card_ref.h"
+#include "game_object_pool.h"
 #include "pb/card_attributes.pb.h"
 #include "pb/serverinfo_card.pb.h"
 #include "server_arrowtarget.h"
+#include "string_atom.h"
 
-#include <QMap>
+#include <QPair>
 #include <QString>
+#include <QVarLengthArray>
 
 class Server_CardZone;
 class Event_SetCardCounter;
 class Event_SetCardAttr;
 
-class Server_Card : public Server_ArrowTarget
+class Server_Card : public Server_ArrowTarget, public PooledGameObject
 {
     Q_OBJECT
+public:
+    // (id, value) sorted by id, kept inside the card since few cards have more than a couple
+    using Counters = QVarLengthArray<QPair<int, int>, 3>;
+    using AttachedCards = QVarLengthArray<Server_Card *, 2>;
+
 private:
     Server_CardZone *zone;
     int id;
     int coord_x, coord_y;
-    CardRef cardRef;
-    QMap<int, int> counters;
+    // interned, every copy of a card across all games shares the same strings
+    StringAtom name;
+    StringAtom providerId;
+    Counters counters;
     bool tapped;
     bool attacking;
     bool facedown;
@@ -51,21 +61,27 @@ private:
     bool doesntUntap;
 
     Server_Card *parentCard;
-    QList<Server_Card *> attachedCards;
+    AttachedCards attachedCards;
     Server_Card *stashedCard;
 
+    // every change to what getInfo() reports has to go through here, the zone caches it
+    void invalidateZoneSnapshot();
+
 public:
     Server_Card(const CardRef &cardRef, int _id, int _coord_x, int _coord_y, Server_CardZone *_zone = nullptr);
+    Server_Card(const StringAtom &_name,
+                const StringAtom &_providerId,
+                int _id,
+                int _coord_x,
+                int _coord_y,
+                Server_CardZone *_zone = nullptr);
     ~Server_Card() override;
 
     Server_CardZone *getZone() const
     {
         return zone;
     }
-    void setZone(Server_CardZone *_zone)
-    {
-        zone = _zone;
-    }
+    void setZone(Server_CardZone *_zone);
 
     int getId() const
     {
@@ -73,11 +89,11 @@ public:
     }
     CardRef getCardRef() const
     {
-        return cardRef;
+        return {name.toString(), providerId.toString()};
     }
     QString getProviderId() const
     {
-        return cardRef.providerId;
+        return providerId.toString();
     }
     int getX() const
     {
@@ -89,16 +105,17 @@ public:
     }
     QString getName() const
     {
-        return cardRef.name;
+        return name.toString();
     }
-    const QMap<int, int> &getCounters() const
+    const StringAtom &getNameAtom() const
     {
-        return counters;
+        return name;
     }
-    int getCounter(int counter_id) const
+    const Counters &getCounters() const
     {
-        return counters.value(counter_id, 0);
+        return counters;
     }
+    int getCounter(int counter_id) const;
     bool getTapped() const
     {
         return tapped;
@@ -135,56 +152,64 @@ public:
     {
         return parentCard;
     }
-    const QList<Server_Card *> &getAttachedCards() const
+    const AttachedCards &getAttachedCards() const
     {
         return attachedCards;
     }
 
-    void setId(int _id)
-    {
-        id = _id;
-    }
+    void setId(int _id);
     void setCoords(int x, int y)
     {
         coord_x = x;
         coord_y = y;
+        invalidateZoneSnapshot();
     }
     void setCardRef(const CardRef &_cardRef)
     {
-        cardRef = _cardRef;
+        name = StringAtom(_cardRef.name);
+        providerId = StringAtom(_cardRef.providerId);
+        invalidateZoneSnapshot();
     }
     void setCounter(int _id, int value, Event_SetCardCounter *event = nullptr);
     void setTapped(bool _tapped)
     {
         tapped = _tapped;
+        invalidateZoneSnapshot();
     }
     void setAttacking(bool _attacking)
     {
         attacking = _attacking;
+        invalidateZoneSnapshot();
     }
     void setFaceDown(bool _facedown)
     {
         facedown = _facedown;
+        invalidateZoneSnapshot();
     }
     void setColor(const QString &_color)
     {
         color = _color;
+        invalidateZoneSnapshot();
     }
     void setPT(const QString &_pt)
     {
         ptString = _pt;
+        invalidateZoneSnapshot();
     }
     void setAnnotation(const QString &_annotation)
     {
         annotation = _annotation;
+        invalidateZoneSnapshot();
     }
     void setDestroyOnZoneChange(bool _destroy)
     {
         destroyOnZoneChange = _destroy;
+        invalidateZoneSnapshot();
     }
     void setDoesntUntap(bool _doesntUntap)
     {
         doesntUntap = _doesntUntap;
+        invalidateZoneSnapshot();
     }
     void setParentCard(Server_Card *_parentCard);
     void addAttachedCard(Server_Card *card)
@@ -193,7 +218,9 @@ public:
     }
     void removeAttachedCard(Server_Card *card)
     {
-        attachedCards.removeOne(card);
+        const int index = attachedCards.indexOf(card);
+        if (index != -1)
+            attachedCards.remove(index);
     }
     void setStashedCard(Server_Card *card)
     {
@@ -210,6 +237,10 @@ public:
             stashedCard = card;
         }
     }
+    Server_Card *getStashedCard() const
+    {
+        return stashedCard;
+    }
     Server_Card *takeStashedCard()
     {
         Server_Card *oldStashedCard = stashedCard;
@@ -26,19 +26,20 @@
 
 #include <QDebug>
 #include <QSet>
+#include <algorithm>
 
 Server_CardZone::Server_CardZone(Server_Player *_player,
                                  const QString &_name,
                                  bool _has_coords,
                                  ServerInfo_Zone::ZoneType _type)
     : player(_player), name(_name), has_coords(_has_coords), type(_type), cardsBeingLookedAt(0),
-      alwaysRevealTopCard(false), alwaysLookAtTopCard(false)
+      alwaysRevealTopCard(false), alwaysLookAtTopCard(false), snapshotValid(false)
 {
 }
 
 Server_CardZone::~Server_CardZone()
 {
-    qDebug() << "Server_CardZone destructor:" << name;
+    qDebug() << "Server_CardZone destructor:" << name.toString();
     clear();
 }
 
@@ -61,15 +62,84 @@ void Server_CardZone::shuffle(int start, int end)
     if (start < 0 || end < 0 || start >= cards.size() || end >= cards.size())
         return;
 
-    for (int i = end; i > start; i--) {
-        int j = rng->rand(start, i);
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 13, 0))
-        cards.swapItemsAt(j, i);
-#else
-        cards.swap(j, i);
-#endif
-    }
+    const QVector<int> permutation = rng->shuffleRange(start, end);
+    const QList<Server_Card *> unshuffled = cards.mid(start, end - start + 1);
+    for (int i = 0; i < permutation.size(); ++i)
+        cards[start + i] = unshuffled[permutation[i] - start];
     playersWithWritePermission.clear();
+    invalidateSnapshot();
+}
+
+Server_Card *Server_CardZone::GridRow::cardAt(int x) const
+{
+    auto it = std::lower_bound(cards.constBegin(), cards.constEnd(), x,
+                               [](const QPair<int, Server_Card *> &entry, int key) { return entry.first < key; });
+    if (it == cards.constEnd() || it->first != x)
+        return nullptr;
+    return it->second;
+}
+
+void Server_CardZone::GridRow::insertCard(int x, Server_Card *card)
+{
+    auto it = std::lower_bound(cards.begin(), cards.end(), x,
+                               [](const QPair<int, Server_Card *> &entry, int key) { return entry.first < key; });
+    if (it != cards.end() && it->first == x)
+        it->second = card;
+    else
+        cards.insert(it, qMakePair(x, card));
+}
+
+void Server_CardZone::GridRow::removeCard(int x)
+{
+    auto it = std::lower_bound(cards.begin(), cards.end(), x,
+                               [](const QPair<int, Server_Card *> &entry, int key) { return entry.first < key; });
+    if (it != cards.end() && it->first == x)
+        cards.erase(it);
+}
+
+bool Server_CardZone::GridRow::hasFreePile(const StringAtom &cardName) const
+{
+    for (const auto &pile : freePiles)
+        if (pile.first == cardName)
+            return true;
+    return false;
+}
+
+bool Server_CardZone::GridRow::hasFreePile(const StringAtom &cardName, int x) const
+{
+    for (const auto &pile : freePiles)
+        if (pile.first == cardName && pile.second == x)
+            return true;
+    return false;
+}
+
+int Server_CardZone::GridRow::lastFreePile(const StringAtom &cardName) const
+{
+    for (int i = freePiles.size() - 1; i >= 0; --i)
+        if (freePiles[i].first == cardName)
+            return freePiles[i].second;
+    return 0;
+}
+
+void Server_CardZone::GridRow::insertFreePile(const StringAtom &cardName, int x)
+{
+    freePiles.append(qMakePair(cardName, x));
+}
+
+void Server_CardZone::GridRow::removeFreePile(const StringAtom &cardName, int x)
+{
+    freePiles.erase(std::remove_if(freePiles.begin(), freePiles.end(),
+                                   [&](const QPair<StringAtom, int> &pile) {
+                                       return pile.first == cardName && pile.second == x;
+                                   }),
+                    freePiles.end());
+}
+
+const Server_CardZone::GridRow &Server_CardZone::rowAt(int y) const
+{
+    static const GridRow emptyRow;
+    auto it = grid.constFind(y);
+    return it == grid.constEnd() ? emptyRow : it.value();
 }
 
 void Server_CardZone::removeCardFromCoordMap(Server_Card *card, int oldX, int oldY)
@@ -78,24 +148,26 @@ void Server_CardZone::removeCardFromCoordMap(Server_Card *card, int oldX, int ol
         return;
 
     const int baseX = (oldX / 3) * 3;
-    QMap<int, Server_Card *> &coordMap = coordinateMap[oldY];
+    GridRow &row = grid[oldY];
+    const StringAtom &cardName = card->getNameAtom();
 
-    if (coordMap.contains(baseX) && coordMap.contains(baseX + 1) && coordMap.contains(baseX + 2))
+    Server_Card *first = row.cardAt(baseX);
+    if (first && row.contains(baseX + 1) && row.contains(baseX + 2))
         // If the removal of this card has opened up a previously full pile...
-        freePilesMap[oldY].insert(coordMap.value(baseX)->getName(), baseX);
+        row.insertFreePile(first->getNameAtom(), baseX);
 
-    coordMap.remove(oldX);
+    row.removeCard(oldX);
 
-    if (!(coordMap.contains(baseX) && coordMap.value(baseX)->getName() == card->getName()) &&
-        !(coordMap.contains(baseX + 1) && coordMap.value(baseX + 1)->getName() == card->getName()) &&
-        !(coordMap.contains(baseX + 2) && coordMap.value(baseX + 2)->getName() == card->getName()))
+    Server_Card *pile[3] = {row.cardAt(baseX), row.cardAt(baseX + 1), row.cardAt(baseX + 2)};
+    if (!(pile[0] && pile[0]->getNameAtom() == cardName) && !(pile[1] && pile[1]->getNameAtom() == cardName) &&
+        !(pile[2] && pile[2]->getNameAtom() == cardName))
         // If this card was the last one with this name...
-        freePilesMap[oldY].remove(card->getName(), baseX);
+        row.removeFreePile(cardName, baseX);
 
-    if (!coordMap.contains(baseX) && !coordMap.contains(baseX + 1) && !coordMap.contains(baseX + 2)) {
+    if (!pile[0] && !pile[1] && !pile[2]) {
         // If the removal of this card has freed a whole pile, i.e. it was the last card in it...
-        if (baseX < freeSpaceMap[oldY])
-            freeSpaceMap[oldY] = baseX;
+        if (baseX < row.freeSpace)
+            row.freeSpace = baseX;
     }
 }
 
@@ -104,21 +176,22 @@ void Server_CardZone::insertCardIntoCoordMap(Server_Card *card, int x, int y)
     if (x < 0)
         return;
 
-    coordinateMap[y].insert(x, card);
+    GridRow &row = grid[y];
+    row.insertCard(x, card);
     if (!(x % 3)) {
-        if (!card->getFaceDown() && !freePilesMap[y].contains(card->getName(), x) && card->getAttachedCards().isEmpty())
-            freePilesMap[y].insert(card->getName(), x);
-        if (freeSpaceMap[y] == x) {
+        if (!card->getFaceDown() && !row.hasFreePile(card->getNameAtom(), x) && card->getAttachedCards().isEmpty())
+            row.insertFreePile(card->getNameAtom(), x);
+        if (row.freeSpace == x) {
             int nextFreeX = x;
             do {
                 nextFreeX += 3;
-            } while (coordinateMap[y].contains(nextFreeX) || coordinateMap[y].contains(nextFreeX + 1) ||
-                     coordinateMap[y].contains(nextFreeX + 2));
-            freeSpaceMap[y] = nextFreeX;
+            } while (row.contains(nextFreeX) || row.contains(nextFreeX + 1) || row.contains(nextFreeX + 2));
+            row.freeSpace = nextFreeX;
         }
     } else if (!((x - 2) % 3)) {
         const int baseX = (x / 3) * 3;
-        freePilesMap[y].remove(coordinateMap[y].value(baseX)->getName(), baseX);
+        if (Server_Card *first = row.cardAt(baseX))
+            row.removeFreePile(first->getNameAtom(), baseX);
     }
 }
 
@@ -136,6 +209,8 @@ int Server_CardZone::removeCard(Server_Card *card, bool &wasLookedAt)
         cardsBeingLookedAt -= 1;
     }
     cards.removeAt(index);
+    cardsById.remove(card->getId());
+    invalidateSnapshot();
     if (has_coords) {
         removeCardFromCoordMap(card, card->getX(), card->getY());
     }
@@ -147,19 +222,22 @@ int Server_CardZone::removeCard(Server_Card *card, bool &wasLookedAt)
 Server_Card *Server_CardZone::getCard(int id, int *position, bool remove)
 {
     if (type != ServerInfo_Zone::HiddenZone) {
-        for (int i = 0; i < cards.size(); ++i) {
-            Server_Card *tmp = cards[i];
-            if (tmp->getId() == id) {
-                if (position)
-                    *position = i;
-                if (remove) {
-                    cards.removeAt(i);
-                    tmp->setZone(nullptr);
-                }
-                return tmp;
+        Server_Card *tmp = cardsById.value(id);
+        if (!tmp)
+            return nullptr;
+        // the position is only looked up when it is actually needed
+        if (position || remove) {
+            const int index = cards.indexOf(tmp);
+            if (position)
+                *position = index;
+            if (remove) {
+                cards.removeAt(index);
+                cardsById.remove(id);
+                invalidateSnapshot();
+                tmp->setZone(nullptr);
             }
         }
-        return nullptr;
+        return tmp;
     } else {
         if ((id >= cards.size()) || (id < 0))
             return nullptr;
@@ -168,29 +246,42 @@ Server_Card *Server_CardZone::getCard(int id, int *position, bool remove)
             *position = id;
         if (remove) {
             cards.removeAt(id);
+            cardsById.remove(tmp->getId());
+            invalidateSnapshot();
             tmp->setZone(nullptr);
         }
         return tmp;
     }
 }
 
+void Server_CardZone::updateCardId(Server_Card *card, int oldId)
+{
+    // cards can carry a zone before they are inserted, only reindex the ones actually in here
+    auto it = cardsById.find(oldId);
+    if (it == cardsById.end() || it.value() != card)
+        return;
+    cardsById.erase(it);
+    cardsById.insert(card->getId(), card);
+}
+
 bool Server_CardZone::isCardAtPosLookedAt(int pos) const
 {
     return type == ServerInfo_Zone::HiddenZone && (cardsBeingLookedAt == -1 || cardsBeingLookedAt > pos);
 }
 
-int Server_CardZone::getFreeGridColumn(int x, int y, const QString &cardName, bool dontStackSameName) const
+int Server_CardZone::getFreeGridColumn(int x, int y, const StringAtom &cardName, bool dontStackSameName) const
 {
-    const QMap<int, Server_Card *> &coordMap = coordinateMap.value(y);
+    const GridRow &row = rowAt(y);
     if (x == -1) {
-        if (!dontStackSameName && freePilesMap[y].contains(cardName)) {
-            x = (freePilesMap[y].value(cardName) / 3) * 3;
+        if (!dontStackSameName && !cardName.isNull() && row.hasFreePile(cardName)) {
+            x = (row.lastFreePile(cardName) / 3) * 3;
 
-            if (coordMap.contains(x) && (coordMap[x]->getFaceDown() || !coordMap[x]->getAttachedCards().isEmpty())) {
+            Server_Card *first = row.cardAt(x);
+            if (first && (first->getFaceDown() || !first->getAttachedCards().isEmpty())) {
                 // don't pile up on: 1. facedown cards 2. cards with attached cards
-            } else if (!coordMap.contains(x))
+            } else if (!first)
                 return x;
-            else if (!coordMap.contains(x + 1))
+            else if (!row.contains(x + 1))
                 return x + 1;
             else
                 return x + 2;
@@ -198,27 +289,28 @@ int Server_CardZone::getFreeGridColumn(int x, int y, const QString &cardName, bo
     } else if (x >= 0) {
         int resultX = 0;
         x = (x / 3) * 3;
-        if (!coordMap.contains(x))
+        Server_Card *first = row.cardAt(x);
+        if (!first)
             resultX = x;
-        else if (!coordMap.value(x)->getAttachedCards().isEmpty()) {
+        else if (!first->getAttachedCards().isEmpty()) {
             resultX = x;
             x = -1;
-        } else if (!coordMap.contains(x + 1))
+        } else if (!row.contains(x + 1))
             resultX = x + 1;
-        else if (!coordMap.contains(x + 2))
+        else if (!row.contains(x + 2))
             resultX = x + 2;
         else {
             resultX = x;
             x = -1;
         }
         if (x < 0)
-            while (coordMap.contains(resultX))
+            while (row.contains(resultX))
                 resultX += 3;
 
         return resultX;
     }
 
-    return freeSpaceMap[y];
+    return row.freeSpace;
 }
 
 bool Server_CardZone::isColumnStacked(int x, int y) const
@@ -226,7 +318,7 @@ bool Server_CardZone::isColumnStacked(int x, int y) const
     if (!has_coords)
         return false;
 
-    return coordinateMap[y].contains((x / 3) * 3 + 1);
+    return rowAt(y).contains((x / 3) * 3 + 1);
 }
 
 bool Server_CardZone::isColumnEmpty(int x, int y) const
@@ -234,7 +326,7 @@ bool Server_CardZone::isColumnEmpty(int x, int y) const
     if (!has_coords)
         return true;
 
-    return !coordinateMap[y].contains((x / 3) * 3);
+    return !rowAt(y).contains((x / 3) * 3);
 }
 
 void Server_CardZone::moveCardInRow(GameEventStorage &ges, Server_Card *card, int x, int y)
@@ -260,17 +352,21 @@ void Server_CardZone::fixFreeSpaces(GameEventStorage &ges)
         int baseX = foo.first;
         int y = foo.second;
 
-        if (!coordinateMap[y].contains(baseX)) {
-            if (coordinateMap[y].contains(baseX + 1))
-                moveCardInRow(ges, coordinateMap[y].value(baseX + 1), baseX, y);
-            else if (coordinateMap[y].contains(baseX + 2)) {
-                moveCardInRow(ges, coordinateMap[y].value(baseX + 2), baseX, y);
+        // moveCardInRow() updates the grid, so the row is looked up again after every move
+        const GridRow &row = rowAt(y);
+        if (!row.contains(baseX)) {
+            if (Server_Card *second = row.cardAt(baseX + 1))
+                moveCardInRow(ges, second, baseX, y);
+            else if (Server_Card *third = row.cardAt(baseX + 2)) {
+                moveCardInRow(ges, third, baseX, y);
                 continue;
             } else
                 continue;
         }
-        if (!coordinateMap[y].contains(baseX + 1) && coordinateMap[y].contains(baseX + 2))
-            moveCardInRow(ges, coordinateMap[y].value(baseX + 2), baseX + 1, y);
+        const GridRow &movedRow = rowAt(y);
+        if (!movedRow.contains(baseX + 1))
+            if (Server_Card *third = movedRow.cardAt(baseX + 2))
+                moveCardInRow(ges, third, baseX + 1, y);
     }
 }
 
@@ -298,7 +394,9 @@ void Server_CardZone::insertCard(Server_Card *card, int x, int y)
             cards.append(card);
         }
     }
+    cardsById.insert(card->getId(), card);
     card->setZone(this);
+    invalidateSnapshot();
 }
 
 void Server_CardZone::clear()
@@ -306,11 +404,11 @@ void Server_CardZone::clear()
     for (auto card : cards)
         delete card;
     cards.clear();
-    coordinateMap.clear();
-    freePilesMap.clear();
-    freeSpaceMap.clear();
+    cardsById.clear();
+    grid.clear();
     playersWithWritePermission.clear();
     cardsBeingLookedAt = 0;
+    invalidateSnapshot();
 }
 
 void Server_CardZone::addWritePermission(int playerId)
@@ -320,20 +418,33 @@ void Server_CardZone::addWritePermission(int playerId)
 
 void Server_CardZone::getInfo(ServerInfo_Zone *info, Server_Player *playerWhosAsking, bool omniscient)
 {
-    info->set_name(name.toStdString());
-    info->set_type(type);
-    info->set_with_coords(has_coords);
-    info->set_card_count(static_cast<int>(cards.size()));
-    info->set_always_reveal_top_card(alwaysRevealTopCard);
-    info->set_always_look_at_top_card(alwaysLookAtTopCard);
-
     const auto selfPlayerAsking = playerWhosAsking == player || omniscient;
     const auto zonesSelfCanSee = type != ServerInfo_Zone::HiddenZone;
     const auto otherPlayerAsking = playerWhosAsking != player;
     const auto zonesOthersCanSee = type == ServerInfo_Zone::PublicZone;
-    if ((selfPlayerAsking && zonesSelfCanSee) || (otherPlayerAsking && zonesOthersCanSee)) {
-        QListIterator<Server_Card *> cardIterator(cards);
-        while (cardIterator.hasNext())
-            cardIterator.next()->getInfo(info->add_card_list());
+    if (!((selfPlayerAsking && zonesSelfCanSee) || (otherPlayerAsking && zonesOthersCanSee))) {
+        info->set_name(name.toStdString());
+        info->set_type(type);
+        info->set_with_coords(has_coords);
+        info->set_card_count(static_cast<int>(cards.size()));
+        info->set_always_reveal_top_card(alwaysRevealTopCard);
+        info->set_always_look_at_top_card(alwaysLookAtTopCard);
+        return;
+    }
+
+    // Everybody allowed to see the cards sees the same thing, so the walk over the cards is only done once
+    // per change of the zone no matter how many players and spectators ask for it.
+    if (!snapshotValid) {
+        snapshot.Clear();
+        snapshot.set_name(name.toStdString());
+        snapshot.set_type(type);
+        snapshot.set_with_coords(has_coords);
+        snapshot.set_card_count(static_cast<int>(cards.size()));
+        snapshot.set_always_reveal_top_card(alwaysRevealTopCard);
+        snapshot.set_always_look_at_top_card(alwaysLookAtTopCard);
+        for (Server_Card *card : cards)
+            card->getInfo(snapshot.add_card_list());
+        snapshotValid = true;
     }
+    info->CopyFrom(snapshot);
 }
@@ -21,11 +21,14 @@
 #define SERVER_CARDZONE_H
 
 #include "pb/serverinfo_zone.pb.h"
+#include "string_atom.h"
 
+#include <QHash>
 #include <QList>
-#include <QMap>
+#include <QPair>
 #include <QSet>
 #include <QString>
+#include <QVector>
 
 class Server_Card;
 class Server_Player;
@@ -36,7 +39,8 @@ class Server_CardZone
 {
 private:
     Server_Player *player;
-    QString name;
+    // interned, the zones of every player in every game share the few names there are
+    StringAtom name;
     bool has_coords; // having coords means this zone has x and y coordinates
     ServerInfo_Zone::ZoneType type;
     int cardsBeingLookedAt;
@@ -44,9 +48,39 @@ private:
     bool alwaysRevealTopCard;
     bool alwaysLookAtTopCard;
     QList<Server_Card *> cards;
-    QMap<int, QMap<int, Server_Card *>> coordinateMap; // y -> (x -> card)
-    QMap<int, QMultiMap<QString, int>> freePilesMap;   // y -> (cardName -> x)
-    QMap<int, int> freeSpaceMap;                       // y -> x
+    QHash<int, Server_Card *> cardsById;
+
+    /**
+     * One row of a zone with coordinates. The cards are kept in a vector sorted by x, the piles that still
+     * have room for another card of the same name in the order they were opened up, so that the most
+     * recent one is found at the back.
+     */
+    struct GridRow
+    {
+        QVector<QPair<int, Server_Card *>> cards;  // (x, card), sorted by x
+        QVector<QPair<StringAtom, int>> freePiles; // (cardName, x)
+        int freeSpace = 0;                         // lowest x of a completely empty pile
+
+        Server_Card *cardAt(int x) const;
+        bool contains(int x) const
+        {
+            return cardAt(x) != nullptr;
+        }
+        void insertCard(int x, Server_Card *card);
+        void removeCard(int x);
+
+        bool hasFreePile(const StringAtom &cardName) const;
+        bool hasFreePile(const StringAtom &cardName, int x) const;
+        int lastFreePile(const StringAtom &cardName) const;
+        void insertFreePile(const StringAtom &cardName, int x);
+        void removeFreePile(const StringAtom &cardName, int x);
+    };
+    QHash<int, GridRow> grid; // y -> row
+    const GridRow &rowAt(int y) const;
+
+    // The zone as seen by someone allowed to see its cards, rebuilt on the next getInfo() after a change.
+    ServerInfo_Zone snapshot;
+    bool snapshotValid;
     void removeCardFromCoordMap(Server_Card *card, int oldX, int oldY);
     void insertCardIntoCoordMap(Server_Card *card, int x, int y);
 
@@ -61,6 +95,7 @@ public:
     int removeCard(Server_Card *card);
     int removeCard(Server_Card *card, bool &wasLookedAt);
     Server_Card *getCard(int id, int *position = nullptr, bool remove = false);
+    void updateCardId(Server_Card *card, int oldId);
 
     int getCardsBeingLookedAt() const
     {
@@ -80,6 +115,10 @@ public:
         return type;
     }
     QString getName() const
+    {
+        return name.toString();
+    }
+    const StringAtom &getNameAtom() const
     {
         return name;
     }
@@ -88,8 +127,16 @@ public:
         return player;
     }
     void getInfo(ServerInfo_Zone *info, Server_Player *playerWhosAsking, bool omniscient);
+    /**
+     * Marks the cached zone info as outdated. Needs to be called whenever anything reported by getInfo()
+     * changes, Server_Card takes care of this for changes to the cards in the zone.
+     */
+    void invalidateSnapshot()
+    {
+        snapshotValid = false;
+    }
 
-    int getFreeGridColumn(int x, int y, const QString &cardName, bool dontStackSameName) const;
+    int getFreeGridColumn(int x, int y, const StringAtom &cardName, bool dontStackSameName) const;
     bool isColumnEmpty(int x, int y) const;
     bool isColumnStacked(int x, int y) const;
     void fixFreeSpaces(GameEventStorage &ges);
@@ -110,6 +157,7 @@ public:
     void setAlwaysRevealTopCard(bool _alwaysRevealTopCard)
     {
         alwaysRevealTopCard = _alwaysRevealTopCard;
+        invalidateSnapshot();
     }
     bool getAlwaysLookAtTopCard() const
     {
@@ -118,6 +166,7 @@ public:
     void setAlwaysLookAtTopCard(bool _alwaysLookAtTopCard)
     {
         alwaysLookAtTopCard = _alwaysLookAtTopCard;
+        invalidateSnapshot();
     }
 };
 
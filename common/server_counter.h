@@ -20,13 +20,14 @@
 #ifndef SERVER_COUNTER_H
 #define SERVER_COUNTER_H
 
+#include "game_object_pool.h"
 #include "pb/color.pb.h"
 
 #include <QString>
 
 class ServerInfo_Counter;
 
-class Server_Counter
+class Server_Counter : public PooledGameObject
 {
 protected:
     int id;
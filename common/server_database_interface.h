@@ -48,6 +48,17 @@ public:
     {
         return QMap<QString, ServerInfo_User>();
     }
+    /**
+     * Fetches both lists of a user at once; implementations can override this to save a database round trip
+     * during login.
+     */
+    virtual void getBuddyAndIgnoreLists(const QString &name,
+                                        QMap<QString, ServerInfo_User> &buddyList,
+                                        QMap<QString, ServerInfo_User> &ignoreList)
+    {
+        buddyList = getBuddyList(name);
+        ignoreList = getIgnoreList(name);
+    }
     virtual bool isInBuddyList(const QString & /* whoseList */, const QString & /* who */)
     {
         return false;
@@ -62,7 +73,7 @@ public:
                                       const ServerInfo_Game & /* gameInfo */,
                                       const QSet<QString> & /* allPlayersEver */,
                                       const QSet<QString> & /* allSpectatorsEver */,
-                                      const QList<GameReplay *> & /* replayList */)
+                                      const QList<GameReplayWriter *> & /* replayList */)
     {
     }
     virtual DeckList *getDeckFromDatabase(int /* deckId */, int /* userId */)
@@ -97,16 +108,6 @@ public:
     virtual void clearSessionTables()
     {
     }
-    virtual void lockSessionTables()
-    {
-    }
-    virtual void unlockSessionTables()
-    {
-    }
-    virtual bool userSessionExists(const QString & /* userName */)
-    {
-        return false;
-    }
 
     virtual bool getRequireRegistration()
     {
@@ -20,6 +20,9 @@
 #include "server_game.h"
 
 #include "decklist.h"
+#include "game_object_pool.h"
+#include "game_replay_writer.h"
+#include "get_pb_extension.h"
 #include "pb/context_connection_state_changed.pb.h"
 #include "pb/context_ping_changed.pb.h"
 #include "pb/event_delete_arrow.pb.h"
@@ -30,11 +33,14 @@
 #include "pb/event_join.pb.h"
 #include "pb/event_kicked.pb.h"
 #include "pb/event_leave.pb.h"
+#include "pb/event_player_pings.pb.h"
 #include "pb/event_player_properties_changed.pb.h"
 #include "pb/event_replay_added.pb.h"
 #include "pb/event_set_active_phase.pb.h"
 #include "pb/event_set_active_player.pb.h"
-#include "pb/game_replay.pb.h"
+#include "pb/game_hibernation.pb.h"
+#include "pb/isl_game_migration.pb.h"
+#include "pb/server_handoff.pb.h"
 #include "pb/serverinfo_playerping.pb.h"
 #include "server.h"
 #include "server_arrow.h"
@@ -46,9 +52,13 @@
 #include "server_room.h"
 
 #include <QDebug>
+#include <QDir>
+#include <QFile>
 #include <QTimer>
 #include <google/protobuf/descriptor.h>
 
+static const QString pingVectorFeature = "ping_vector";
+
 Server_Game::Server_Game(const ServerInfo_User &_creatorInfo,
                          int _gameId,
                          const QString &_description,
@@ -63,56 +73,91 @@ Server_Game::Server_Game(const ServerInfo_User &_creatorInfo,
                          bool _spectatorsSeeEverything,
                          int _startingLifeTotal,
                          Server_Room *_room)
-    : QObject(), room(_room), nextPlayerId(0), hostId(0), creatorInfo(new ServerInfo_User(_creatorInfo)),
-      gameStarted(false), gameClosed(false), gameId(_gameId), password(_password), maxPlayers(_maxPlayers),
-      gameTypes(_gameTypes), activePlayer(-1), activePhase(-1), onlyBuddies(_onlyBuddies),
-      onlyRegistered(_onlyRegistered), spectatorsAllowed(_spectatorsAllowed),
+    : QObject(), room(_room), handle(std::make_shared<Server_GameHandle>(this)), nextPlayerId(0), hostId(0),
+      creatorInfo(new ServerInfo_User(_creatorInfo)), gameStarted(false), gameClosed(false), gameId(_gameId),
+      password(_password), maxPlayers(_maxPlayers), gameTypes(_gameTypes), activePlayer(-1), activePhase(-1),
+      onlyBuddies(_onlyBuddies), onlyRegistered(_onlyRegistered), spectatorsAllowed(_spectatorsAllowed),
       spectatorsNeedPassword(_spectatorsNeedPassword), spectatorsCanTalk(_spectatorsCanTalk),
       spectatorsSeeEverything(_spectatorsSeeEverything), startingLifeTotal(_startingLifeTotal), inactivityCounter(0),
       startTimeOfThisGame(0), secondsElapsed(0), firstGameStarted(false), turnOrderReversed(false),
-      startTime(QDateTime::currentDateTime()), pingClock(nullptr),
+      startTime(QDateTime::currentDateTime()), pingClock(nullptr), objectPool(new GameObjectPool),
+      migrationConsidered(false), migratedTo(-1), spectatorStream(nullptr), spectatorStreamClock(nullptr),
+      lastMailboxLatency(0), peakMailboxLatency(0),
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
-      gameMutex()
+      gameMutex(),
 #else
-      gameMutex(QMutex::Recursive)
+      gameMutex(QMutex::Recursive),
 #endif
+      playersLock(QReadWriteLock::Recursive)
 {
-    currentReplay = new GameReplay;
-    currentReplay->set_replay_id(room->getServer()->getDatabaseInterface()->getNextReplayId());
     description = _description.simplified();
 
     connect(this, &Server_Game::sigStartGameIfReady, this, &Server_Game::doStartGameIfReady, Qt::QueuedConnection);
+    connect(this, &Server_Game::sigMigrate, this, &Server_Game::migrate, Qt::QueuedConnection);
 
-    getInfo(*currentReplay->mutable_game_info());
+    publishInfo();
+    ServerInfo_Game replayGameInfo;
+    buildInfo(replayGameInfo);
+    currentReplay = new GameReplayWriter(room->getServer()->getDatabaseInterface()->getNextReplayId(), replayGameInfo,
+                                         room->getServer()->getReplaySpoolDirectory());
 
     if (room->getServer()->getGameShouldPing()) {
         pingClock = new QTimer(this);
         connect(pingClock, &QTimer::timeout, this, &Server_Game::pingClockTimeout);
         pingClock->start(1000);
     }
+
+    const int spectatorStreamInterval = room->getServer()->getSpectatorStreamInterval();
+    if (spectatorStreamInterval > 0 && spectatorsAllowed) {
+        spectatorStreamTime.start();
+        // the spectators joining before anything happened start from the empty game
+        gameMutex.lock();
+        spectatorStream = new SpectatorStream(qMax(room->getServer()->getSpectatorStreamDelay(), 0) * 1000LL,
+                                              buildSpectatorSnapshot());
+        gameMutex.unlock();
+
+        spectatorStreamClock = new QTimer(this);
+        connect(spectatorStreamClock, &QTimer::timeout, this, [this] { flushSpectatorStream(); });
+        spectatorStreamClock->start(spectatorStreamInterval);
+    }
 }
 
 Server_Game::~Server_Game()
 {
+    handle->lock.lockForWrite();
+    handle->game = nullptr;
+    handle->lock.unlock();
+
     room->gamesLock.lockForWrite();
     gameMutex.lock();
 
     gameClosed = true;
-    sendGameEventContainer(prepareGameEvent(Event_GameClosed(), -1));
+    // the game goes on on the server it migrated to
+    const bool migrated = migratedTo != -1;
+    if (!migrated)
+        sendGameEventContainer(prepareGameEvent(Event_GameClosed(), -1));
+    if (spectatorStream)
+        flushSpectatorStream(true);
     for (auto *player : players.values()) {
         player->prepareDestroy();
     }
+    playersLock.lockForWrite();
     players.clear();
+    playersLock.unlock();
+    publishInfo();
+    room->getServer()->getUserGameIndex().removeGame(gameId);
 
-    room->removeGame(this);
+    if (!migrated)
+        room->removeGame(this);
     delete creatorInfo;
     creatorInfo = 0;
 
     gameMutex.unlock();
     room->gamesLock.unlock();
-    currentReplay->set_duration_seconds(secondsElapsed - startTimeOfThisGame);
+    currentReplay->setDurationSeconds(secondsElapsed - startTimeOfThisGame);
     replayList.append(currentReplay);
-    storeGameInformation();
+    if (!migrated)
+        storeGameInformation();
 
     for (auto *replay : replayList) {
         delete replay;
@@ -127,6 +172,15 @@ Server_Game::~Server_Game()
         delete pingClock;
         pingClock = nullptr;
     }
+    delete spectatorStreamClock;
+    spectatorStreamClock = nullptr;
+    delete spectatorStream;
+    spectatorStream = nullptr;
+    if (isHibernated())
+        QFile::remove(hibernationFile);
+    // the players are deleted later, their cards return their memory then
+    objectPool->release();
+    objectPool = nullptr;
 
     qDebug() << "Server_Game destructor: gameId=" << gameId;
     deleteLater();
@@ -134,7 +188,7 @@ Server_Game::~Server_Game()
 
 void Server_Game::storeGameInformation()
 {
-    const ServerInfo_Game &gameInfo = replayList.first()->game_info();
+    const ServerInfo_Game &gameInfo = replayList.first()->getGameInfo();
 
     Event_ReplayAdded replayEvent;
     ServerInfo_ReplayMatch *replayMatchInfo = replayEvent.mutable_match_info();
@@ -155,9 +209,9 @@ void Server_Game::storeGameInformation()
 
     for (int i = 0; i < replayList.size(); ++i) {
         ServerInfo_Replay *replayInfo = replayMatchInfo->add_replay_list();
-        replayInfo->set_replay_id(replayList[i]->replay_id());
+        replayInfo->set_replay_id(replayList[i]->getReplayId());
         replayInfo->set_replay_name(gameInfo.description());
-        replayInfo->set_duration(replayList[i]->duration_seconds());
+        replayInfo->set_duration(replayList[i]->getDurationSeconds());
     }
 
     SessionEvent *sessionEvent = Server_ProtocolHandler::prepareSessionEvent(replayEvent);
@@ -179,13 +233,32 @@ void Server_Game::storeGameInformation()
 
 void Server_Game::pingClockTimeout()
 {
-    QMutexLocker locker(&gameMutex);
     ++secondsElapsed;
 
-    GameEventStorage ges;
-    ges.setGameEventContext(Context_PingChanged());
+    // The timers of all games of a room run in the same thread, one game busy with a long command shouldn't hold
+    // up the others. Its pings are updated on the next tick instead.
+    if (!gameMutex.tryLock())
+        return;
+    updatePings();
+    gameMutex.unlock();
+}
+
+void Server_Game::updatePings()
+{
+
+    // Clients advertising the ping vector feature get all ping changes batched into one event at a lower
+    // cadence; everybody else keeps getting one player properties event per changed ping every second.
+    const int pingVectorInterval = room->getServer()->getPingVectorInterval();
+    const bool pingVectorDue = (pingVectorInterval <= 1) || (secondsElapsed % pingVectorInterval == 0);
+    Event_PlayerPings pingVector;
+    QMap<int, int> newPingVectorState;
+
+    auto *cont = new GameEventContainer;
+    cont->mutable_context()->MutableExtension(Context_PingChanged::ext);
 
     bool allPlayersInactive = true;
+    // judges and other spectators act on the board without counting as active
+    bool anybodyConnected = false;
     int playerCount = 0;
     for (auto *player : players) {
         if (player == nullptr)
@@ -209,6 +282,9 @@ void Server_Game::pingClockTimeout()
         if ((newPingTime != -1) && (!player->getSpectator() || player->getPlayerId() == hostId)) {
             allPlayersInactive = false;
         }
+        if (newPingTime != -1) {
+            anybodyConnected = true;
+        }
 
         if ((abs(oldPingTime - newPingTime) > 1) || ((newPingTime == -1) && (oldPingTime != -1)) ||
             ((newPingTime != -1) && (oldPingTime == -1))) {
@@ -216,21 +292,144 @@ void Server_Game::pingClockTimeout()
 
             Event_PlayerPropertiesChanged event;
             event.mutable_player_properties()->set_ping_seconds(newPingTime);
-            ges.enqueueGameEvent(event, player->getPlayerId());
+            GameEvent *gameEvent = cont->add_event_list();
+            gameEvent->set_player_id(player->getPlayerId());
+            gameEvent->MutableExtension(Event_PlayerPropertiesChanged::ext)->CopyFrom(event);
+        }
+
+        if (pingVectorDue) {
+            auto lastSent = pingVectorState.constFind(player->getPlayerId());
+            if (lastSent == pingVectorState.constEnd() || lastSent.value() != newPingTime) {
+                pingVector.add_player_id(player->getPlayerId());
+                pingVector.add_ping_seconds(newPingTime);
+            }
+            newPingVectorState.insert(player->getPlayerId(), newPingTime);
         }
     }
-    ges.sendToGame(this);
+
+    if (cont->event_list_size() > 0)
+        sendGameEventContainer(cont, GameEventStorageItem::SendToPrivate | GameEventStorageItem::SendToOthers, -1,
+                               pingVectorFeature);
+    else
+        delete cont;
+
+    if (pingVectorDue) {
+        pingVectorState = newPingVectorState;
+        if (pingVector.player_id_size() > 0)
+            sendPingVector(pingVector);
+    }
 
     const int maxTime = room->getServer()->getMaxGameInactivityTime();
     if (allPlayersInactive) {
         if (((maxTime > 0) && (++inactivityCounter >= maxTime)) || (playerCount < maxPlayers)) {
             deleteLater();
+        } else if (!anybodyConnected && !isHibernated()) {
+            const int hibernationTime = room->getServer()->getGameHibernationTime();
+            if (hibernationTime > 0 && inactivityCounter >= hibernationTime)
+                hibernate();
         }
     } else {
         inactivityCounter = 0;
     }
 }
 
+void Server_Game::hibernate()
+{
+    const QString directory = room->getServer()->getGameHibernationDirectory();
+    if (directory.isEmpty())
+        return;
+    if (!QDir(directory).mkpath(".")) {
+        qWarning() << "Could not create game hibernation directory" << directory;
+        return;
+    }
+
+    // all players are written first, arrows and attachments point at the cards of the others
+    GameHibernation hibernation;
+    hibernation.set_game_id(gameId);
+    for (Server_Player *player : players)
+        player->getHibernationInfo(*hibernation.add_player_list());
+
+    const QByteArray data = qCompress(QByteArray::fromStdString(hibernation.SerializeAsString()));
+    QFile file(QDir(directory).filePath(QString("game_%1.hibernated").arg(gameId)));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(data) != data.size() || !file.flush()) {
+        qWarning() << "Could not hibernate game" << gameId << "to" << file.fileName() << file.errorString();
+        file.close();
+        file.remove();
+        return;
+    }
+    file.close();
+
+    {
+        QMutexLocker replayLocker(&replayMutex);
+        if (!currentReplay->spool(directory))
+            qWarning() << "Replay of hibernated game" << gameId << "is kept in memory";
+    }
+    for (Server_Player *player : players)
+        player->clearZones();
+    hibernationFile = file.fileName();
+    qDebug() << "Hibernated game" << gameId << "in" << data.size() << "bytes";
+}
+
+bool Server_Game::wakeUp()
+{
+    if (!isHibernated())
+        return true;
+
+    GameHibernation hibernation;
+    QFile file(hibernationFile);
+    bool ok = file.open(QIODevice::ReadOnly);
+    if (ok) {
+        const QByteArray data = qUncompress(file.readAll());
+        ok = !data.isEmpty() && hibernation.ParseFromArray(data.constData(), data.size());
+        file.close();
+    }
+    file.remove();
+    hibernationFile.clear();
+
+    if (!ok) {
+        qWarning() << "Could not wake up game" << gameId << "from" << file.fileName() << "- closing it";
+        gameClosed = true;
+        publishInfo();
+        deleteLater();
+        return false;
+    }
+
+    restoreBoard(hibernation);
+    qDebug() << "Woke up game" << gameId;
+    return true;
+}
+
+void Server_Game::restoreBoard(const GameHibernation &hibernation)
+{
+    for (const GameHibernation_Player &info : hibernation.player_list())
+        if (Server_Player *player = players.value(info.player_id()))
+            player->wakeUp(info);
+    for (const GameHibernation_Player &info : hibernation.player_list())
+        if (Server_Player *player = players.value(info.player_id()))
+            player->wakeUpAttachmentsAndArrows(info);
+}
+
+void Server_Game::sendPingVector(const Event_PlayerPings &event)
+{
+    // Only sent to the clients that asked for it, and not part of the replay, which keeps the
+    // per player events instead.
+    GameEventContext context;
+    context.MutableExtension(Context_PingChanged::ext);
+    GameEventContainer *cont = prepareGameEvent(event, -1, &context);
+
+    QByteArray serializedEvent;
+    const bool serialize = room->getServer()->getSendsSerializedMessages();
+    for (Server_Player *player : players.values()) {
+        if (!player->clientSupportsFeature(pingVectorFeature))
+            continue;
+        if (serialize && serializedEvent.isEmpty())
+            serializedEvent = Server_AbstractUserInterface::serializeGameEventContainer(*cont);
+        player->sendGameEvent(*cont, serializedEvent);
+    }
+
+    delete cont;
+}
+
 int Server_Game::getPlayerCount() const
 {
     QMutexLocker locker(&gameMutex);
@@ -280,9 +479,12 @@ void Server_Game::sendGameStateToPlayers()
     createGameStateChangedEvent(&omniscientEvent, nullptr, true, false);
 
     GameEventContainer *replayCont = prepareGameEvent(omniscientEvent, -1);
-    replayCont->set_seconds_elapsed(secondsElapsed - startTimeOfThisGame);
     replayCont->clear_game_id();
-    currentReplay->add_event_list()->CopyFrom(*replayCont);
+    {
+        QMutexLocker replayLocker(&replayMutex);
+        replayCont->set_seconds_elapsed(secondsElapsed - startTimeOfThisGame);
+        currentReplay->appendEvent(*replayCont);
+    }
     delete replayCont;
 
     // If spectators are not omniscient, we need an additional createGameStateChangedEvent call, otherwise we can use
@@ -291,24 +493,51 @@ void Server_Game::sendGameStateToPlayers()
     Event_GameStateChanged spectatorNormalEvent;
     createGameStateChangedEvent(&spectatorNormalEvent, nullptr, false, false);
 
+    // The spectator containers are the same for every spectator, so they are only built and serialized once.
+    GameEventContainer *omniscientCont = nullptr;
+    GameEventContainer *spectatorNormalCont = nullptr;
+    QByteArray omniscientSerialized, spectatorNormalSerialized;
+    const bool serialize = room->getServer()->getSendsSerializedMessages();
+
     // send game state info to clients according to their role in the game
     for (Server_Player *player : players.values()) {
-        GameEventContainer *gec;
+        if (isStreamSpectator(player))
+            continue;
         if (player->getSpectator()) {
             if (spectatorsSeeEverything || player->getJudge()) {
-                gec = prepareGameEvent(omniscientEvent, -1);
+                if (!omniscientCont) {
+                    omniscientCont = prepareGameEvent(omniscientEvent, -1);
+                    if (serialize)
+                        omniscientSerialized =
+                            Server_AbstractUserInterface::serializeGameEventContainer(*omniscientCont);
+                }
+                player->sendGameEvent(*omniscientCont, omniscientSerialized);
             } else {
-                gec = prepareGameEvent(spectatorNormalEvent, -1);
+                if (!spectatorNormalCont) {
+                    spectatorNormalCont = prepareGameEvent(spectatorNormalEvent, -1);
+                    if (serialize)
+                        spectatorNormalSerialized =
+                            Server_AbstractUserInterface::serializeGameEventContainer(*spectatorNormalCont);
+                }
+                player->sendGameEvent(*spectatorNormalCont, spectatorNormalSerialized);
             }
         } else {
             Event_GameStateChanged event;
             createGameStateChangedEvent(&event, player, false, false);
 
-            gec = prepareGameEvent(event, -1);
+            GameEventContainer *gec = prepareGameEvent(event, -1);
+            player->sendGameEvent(*gec);
+            delete gec;
         }
-        player->sendGameEvent(*gec);
-        delete gec;
     }
+    if (spectatorStream) {
+        GameEventContainer *streamCont =
+            prepareGameEvent(spectatorsSeeEverything ? omniscientEvent : spectatorNormalEvent, -1);
+        appendToSpectatorStream(*streamCont, QByteArray());
+        delete streamCont;
+    }
+    delete omniscientCont;
+    delete spectatorNormalCont;
 }
 
 void Server_Game::doStartGameIfReady(bool forceStartGame)
@@ -316,6 +545,10 @@ void Server_Game::doStartGameIfReady(bool forceStartGame)
     Server_DatabaseInterface *databaseInterface = room->getServer()->getDatabaseInterface();
     QMutexLocker locker(&gameMutex);
 
+    // a request from before the game moved on to another server
+    if (migratedTo != -1)
+        return;
+
     if (getPlayerCount() < maxPlayers && !forceStartGame) {
         return;
     }
@@ -332,6 +565,17 @@ void Server_Game::doStartGameIfReady(bool forceStartGame)
         }
     }
 
+    // everybody is in now, the game may run better somewhere else
+    if (!firstGameStarted && !migrationConsidered) {
+        migrationConsidered = true;
+        const int migrationTarget = findMigrationTarget();
+        if (migrationTarget != -1) {
+            // migrate() needs the game handle and the games of the room, which are locked before gameMutex
+            emit sigMigrate(migrationTarget, forceStartGame);
+            return;
+        }
+    }
+
     for (Server_Player *player : players.values()) {
         if (!player->getSpectator()) {
             player->setupZones();
@@ -343,15 +587,14 @@ void Server_Game::doStartGameIfReady(bool forceStartGame)
         player->setConceded(false);
         player->setReadyStart(false);
     }
+    publishInfo();
 
     if (firstGameStarted) {
-        currentReplay->set_duration_seconds(secondsElapsed - startTimeOfThisGame);
-        replayList.append(currentReplay);
-        currentReplay = new GameReplay;
-        currentReplay->set_replay_id(databaseInterface->getNextReplayId());
-        ServerInfo_Game *gameInfo = currentReplay->mutable_game_info();
-        getInfo(*gameInfo);
-        gameInfo->set_started(false);
+        ServerInfo_Game replayGameInfo;
+        buildInfo(replayGameInfo);
+        replayGameInfo.set_started(false);
+        auto *nextReplay = new GameReplayWriter(databaseInterface->getNextReplayId(), replayGameInfo,
+                                                room->getServer()->getReplaySpoolDirectory());
 
         Event_GameStateChanged omniscientEvent;
         createGameStateChangedEvent(&omniscientEvent, nullptr, true, true);
@@ -359,9 +602,14 @@ void Server_Game::doStartGameIfReady(bool forceStartGame)
         GameEventContainer *replayCont = prepareGameEvent(omniscientEvent, -1);
         replayCont->set_seconds_elapsed(0);
         replayCont->clear_game_id();
-        currentReplay->add_event_list()->CopyFrom(*replayCont);
+        nextReplay->appendEvent(*replayCont);
         delete replayCont;
 
+        // chat can be recorded concurrently, see sendGameEventContainer()
+        QMutexLocker replayLocker(&replayMutex);
+        currentReplay->setDurationSeconds(secondsElapsed - startTimeOfThisGame);
+        replayList.append(currentReplay);
+        currentReplay = nextReplay;
         startTimeOfThisGame = secondsElapsed;
     } else
         firstGameStarted = true;
@@ -380,6 +628,226 @@ void Server_Game::doStartGameIfReady(bool forceStartGame)
     emit gameInfoChanged(gameInfo);
 }
 
+int Server_Game::findMigrationTarget() const
+{
+    Server *server = room->getServer();
+    if (!server->getGameMigrationEnabled())
+        return -1;
+
+    // the players connected here have no server id
+    QMap<int, int> playersByServer;
+    for (Server_Player *player : players.values())
+        if (!player->getSpectator())
+            ++playersByServer[player->getUserInfo()->server_id()];
+
+    int target = -1;
+    int targetPlayers = playersByServer.value(-1);
+    for (auto it = playersByServer.constBegin(); it != playersByServer.constEnd(); ++it) {
+        if (it.key() != -1 && it.value() > targetPlayers && server->isIslPeerConnected(it.key())) {
+            target = it.key();
+            targetPlayers = it.value();
+        }
+    }
+    return target;
+}
+
+void Server_Game::migrate(int serverId, bool forceStartGame)
+{
+    Server *server = room->getServer();
+    handle->lock.lockForWrite();
+    room->gamesLock.lockForWrite();
+    gameMutex.lock();
+
+    // players may have left or the other server may be gone since the start was requested
+    if (gameStarted || gameClosed || isHibernated() || findMigrationTarget() != serverId) {
+        gameMutex.unlock();
+        room->gamesLock.unlock();
+        handle->lock.unlock();
+        doStartGameIfReady(forceStartGame);
+        return;
+    }
+
+    // the spectators following the delayed stream get what they are owed before they are let go
+    if (spectatorStream)
+        flushSpectatorStream(true);
+
+    IslGameMigration migration;
+    getMigrationInfo(migration);
+    migration.set_force_start(forceStartGame);
+    // sent before anything else can be forwarded to the new server for the game
+    server->sendIsl_GameMigration(migration, serverId);
+
+    for (Server_Player *player : players.values()) {
+        if ((player->getUserInfo()->user_level() & ServerInfo_User::IsRegistered) && !player->getSpectator())
+            server->removePersistentPlayer(QString::fromStdString(player->getUserInfo()->name()), room->getId(),
+                                           gameId, player->getPlayerId());
+        player->handOver();
+    }
+    migratedTo = serverId;
+    handle->game = nullptr;
+    server->getUserGameIndex().removeGame(gameId);
+
+    ServerInfo_Game listedInfo;
+    getInfo(listedInfo);
+    listedInfo.set_server_id(serverId);
+    room->handOverGame(this, listedInfo);
+
+    gameMutex.unlock();
+    room->gamesLock.unlock();
+    handle->lock.unlock();
+
+    qDebug() << "Game" << gameId << "migrated to server" << serverId;
+    deleteLater();
+}
+
+void Server_Game::getMigrationInfo(IslGameMigration &migration) const
+{
+    buildInfo(*migration.mutable_game_info());
+    migration.set_password(password.toStdString());
+    migration.set_starting_life_total(startingLifeTotal);
+    migration.set_host_id(hostId);
+    migration.set_next_player_id(nextPlayerId);
+    migration.set_seconds_elapsed(static_cast<google::protobuf::uint32>(secondsElapsed));
+    for (const QString &playerName : allPlayersEver)
+        migration.add_all_players_ever(playerName.toStdString());
+    for (const QString &spectatorName : allSpectatorsEver)
+        migration.add_all_spectators_ever(spectatorName.toStdString());
+    for (Server_Player *player : players.values())
+        player->getMigrationInfo(*migration.add_player_list());
+}
+
+void Server_Game::adoptMigration(const IslGameMigration &migration)
+{
+    Server *server = room->getServer();
+    QMutexLocker locker(&gameMutex);
+
+    hostId = migration.host_id();
+    nextPlayerId = migration.next_player_id();
+    secondsElapsed = static_cast<int>(migration.seconds_elapsed());
+    startTime = QDateTime::fromSecsSinceEpoch(migration.game_info().start_time());
+    for (const std::string &playerName : migration.all_players_ever())
+        allPlayersEver.insert(QString::fromStdString(playerName));
+    for (const std::string &spectatorName : migration.all_spectators_ever())
+        allSpectatorsEver.insert(QString::fromStdString(spectatorName));
+
+    for (const IslGameMigration_Player &info : migration.player_list()) {
+        const ServerInfo_PlayerProperties &properties = info.properties();
+        ServerInfo_User userInfo(properties.user_info());
+        // the users connected here are kept without a server id
+        if (userInfo.server_id() == server->getServerID())
+            userInfo.clear_server_id();
+        const QString playerName = QString::fromStdString(userInfo.name());
+        // a user that left meanwhile stays in the game like any disconnected player
+        Server_AbstractUserInterface *userInterface = server->findUser(playerName);
+
+        auto *player = new Server_Player(this, properties.player_id(), userInfo, properties.spectator(),
+                                         properties.judge(), userInterface);
+        player->moveToThread(thread());
+        player->restoreMigrationInfo(info);
+
+        playersLock.lockForWrite();
+        players.insert(player->getPlayerId(), player);
+        playersLock.unlock();
+        // the spectators following the stream had their join point on the old server already
+        if (isStreamSpectator(player)) {
+            QMutexLocker streamLocker(&spectatorStreamMutex);
+            streamSpectatorIds.insert(player->getPlayerId());
+        }
+
+        if ((userInfo.user_level() & ServerInfo_User::IsRegistered) && !player->getSpectator())
+            server->addPersistentPlayer(playerName, room->getId(), gameId, player->getPlayerId());
+        if (userInterface)
+            userInterface->playerAddedToGame(gameId, room->getId(), player->getPlayerId(), handle);
+    }
+    publishInfo();
+}
+
+void Server_Game::prepareHandoff()
+{
+    if (spectatorStream)
+        flushSpectatorStream(true);
+}
+
+void Server_Game::getHandoffInfo(HandoffGame &info)
+{
+    getMigrationInfo(*info.mutable_migration());
+    if (isHibernated()) {
+        info.set_hibernation_file(hibernationFile.toStdString());
+    } else {
+        GameHibernation *board = info.mutable_board();
+        board->set_game_id(gameId);
+        for (Server_Player *player : players)
+            player->getHibernationInfo(*board->add_player_list());
+    }
+    info.set_game_started(gameStarted);
+    info.set_first_game_started(firstGameStarted);
+    info.set_active_player(activePlayer);
+    info.set_active_phase(activePhase);
+    info.set_turn_order_reversed(turnOrderReversed);
+    info.set_inactivity_counter(inactivityCounter);
+    for (Server_Player *player : players)
+        player->getHandoffInfo(*info.add_player_list());
+
+    QMutexLocker replayLocker(&replayMutex);
+    info.set_start_time_of_this_game(startTimeOfThisGame);
+    for (GameReplayWriter *replay : replayList + QList<GameReplayWriter *>{currentReplay}) {
+        HandoffGame_Replay *replayInfo = info.add_replay_list();
+        replayInfo->set_replay_id(replay->getReplayId());
+        replayInfo->mutable_game_info()->CopyFrom(replay->getGameInfo());
+        replayInfo->set_duration_seconds(static_cast<google::protobuf::uint32>(replay->getDurationSeconds()));
+        const QByteArray contents = replay->detach();
+        if (contents.isEmpty())
+            replayInfo->set_spool_file(replay->getSpoolFileName().toStdString());
+        else
+            replayInfo->set_contents(contents.constData(), static_cast<size_t>(contents.size()));
+    }
+}
+
+void Server_Game::adoptHandoff(const HandoffGame &info)
+{
+    QMutexLocker locker(&gameMutex);
+
+    gameStarted = info.game_started();
+    firstGameStarted = info.first_game_started();
+    activePlayer = info.active_player();
+    activePhase = info.active_phase();
+    turnOrderReversed = info.turn_order_reversed();
+    inactivityCounter = info.inactivity_counter();
+    if (info.has_hibernation_file())
+        hibernationFile = QString::fromStdString(info.hibernation_file());
+    else
+        restoreBoard(info.board());
+    for (const HandoffGame_Player &playerInfo : info.player_list())
+        if (Server_Player *player = players.value(playerInfo.player_id()))
+            player->restoreHandoffInfo(playerInfo);
+
+    replayMutex.lock();
+    startTimeOfThisGame = info.start_time_of_this_game();
+    // the replay started by the constructor never got an event
+    delete currentReplay;
+    currentReplay = nullptr;
+    for (const HandoffGame_Replay &replayInfo : info.replay_list()) {
+        if (currentReplay)
+            replayList.append(currentReplay);
+        currentReplay = new GameReplayWriter(replayInfo.replay_id(), replayInfo.game_info(),
+                                             static_cast<int>(replayInfo.duration_seconds()),
+                                             QString::fromStdString(replayInfo.spool_file()),
+                                             QByteArray::fromStdString(replayInfo.contents()));
+    }
+    if (!currentReplay) {
+        ServerInfo_Game replayGameInfo;
+        buildInfo(replayGameInfo);
+        currentReplay = new GameReplayWriter(room->getServer()->getDatabaseInterface()->getNextReplayId(),
+                                             replayGameInfo, room->getServer()->getReplaySpoolDirectory());
+    }
+    replayMutex.unlock();
+
+    // spectators joining from now on start from the board as it is
+    if (spectatorStream && !isHibernated())
+        takeSpectatorSnapshot();
+    publishInfo();
+}
+
 void Server_Game::startGameIfReady(bool forceStartGame)
 {
     emit sigStartGameIfReady(forceStartGame);
@@ -398,6 +866,7 @@ void Server_Game::stopGameIfFinished()
         return;
 
     gameStarted = false;
+    publishInfo();
 
     for (Server_Player *player : players.values()) {
         player->clearZones();
@@ -450,18 +919,11 @@ Response::ResponseCode Server_Game::checkJoin(ServerInfo_User *user,
     if (!spectator && (gameStarted || (getPlayerCount() >= getMaxPlayers())))
         return Response::RespGameFull;
 
-    return Response::RespOk;
-}
+    // only woken up for those that get in
+    if (!wakeUp())
+        return Response::RespNameNotFound;
 
-bool Server_Game::containsUser(const QString &userName) const
-{
-    QMutexLocker locker(&gameMutex);
-
-    for (Server_Player *player : players.values()) {
-        if (player->getUserInfo()->name() == userName.toStdString())
-            return true;
-    }
-    return false;
+    return Response::RespOk;
 }
 
 void Server_Game::addPlayer(Server_AbstractUserInterface *userInterface,
@@ -482,7 +944,9 @@ void Server_Game::addPlayer(Server_AbstractUserInterface *userInterface,
     sendGameEventContainer(prepareGameEvent(joinEvent, -1));
 
     const QString playerName = QString::fromStdString(newPlayer->getUserInfo()->name());
+    playersLock.lockForWrite();
     players.insert(newPlayer->getPlayerId(), newPlayer);
+    playersLock.unlock();
     if (spectator) {
         allSpectatorsEver.insert(playerName);
     } else {
@@ -495,6 +959,7 @@ void Server_Game::addPlayer(Server_AbstractUserInterface *userInterface,
             sendGameEventContainer(prepareGameEvent(Event_GameHostChanged(), hostId));
         }
     }
+    publishInfo();
 
     if (broadcastUpdate) {
         ServerInfo_Game gameInfo;
@@ -508,16 +973,25 @@ void Server_Game::addPlayer(Server_AbstractUserInterface *userInterface,
     if ((newPlayer->getUserInfo()->user_level() & ServerInfo_User::IsRegistered) && !spectator)
         room->getServer()->addPersistentPlayer(playerName, room->getId(), gameId, newPlayer->getPlayerId());
 
-    userInterface->playerAddedToGame(gameId, room->getId(), newPlayer->getPlayerId());
+    userInterface->playerAddedToGame(gameId, room->getId(), newPlayer->getPlayerId(), handle);
 
     createGameJoinedEvent(newPlayer, rc, false);
 }
 
 void Server_Game::removePlayer(Server_Player *player, Event_Leave::LeaveReason reason)
 {
+    // the arrows and attachments of the player are taken off the board below
+    wakeUp();
     room->getServer()->removePersistentPlayer(QString::fromStdString(player->getUserInfo()->name()), room->getId(),
                                               gameId, player->getPlayerId());
+    playersLock.lockForWrite();
     players.remove(player->getPlayerId());
+    playersLock.unlock();
+    if (spectatorStream) {
+        QMutexLocker streamLocker(&spectatorStreamMutex);
+        streamSpectatorIds.remove(player->getPlayerId());
+    }
+    publishInfo();
 
     GameEventStorage ges;
     removeArrowsRelatedToPlayer(ges, player);
@@ -546,6 +1020,7 @@ void Server_Game::removePlayer(Server_Player *player, Event_Leave::LeaveReason r
             sendGameEventContainer(prepareGameEvent(Event_GameHostChanged(), hostId));
         } else {
             gameClosed = true;
+            publishInfo();
             deleteLater();
             return;
         }
@@ -571,29 +1046,45 @@ void Server_Game::removeArrowsRelatedToPlayer(GameEventStorage &ges, Server_Play
     // Remove all arrows of other players pointing to the player being removed or to one of his cards.
     // Also remove all arrows starting at one of his cards. This is necessary since players can create
     // arrows that start at another person's cards.
-    for (Server_Player *otherPlayer : players.values()) {
-        QList<Server_Arrow *> arrows = otherPlayer->getArrows().values();
-        QList<Server_Arrow *> toDelete;
-        for (int i = 0; i < arrows.size(); ++i) {
-            Server_Arrow *a = arrows[i];
-            Server_Card *targetCard = qobject_cast<Server_Card *>(a->getTargetItem());
-            if (targetCard) {
-                if (targetCard->getZone() != nullptr && targetCard->getZone()->getPlayer() == player)
-                    toDelete.append(a);
-            } else if (static_cast<Server_Player *>(a->getTargetItem()) == player)
-                toDelete.append(a);
-
-            // Don't use else here! It has to happen regardless of whether targetCard == 0.
-            if (a->getStartCard()->getZone() != nullptr && a->getStartCard()->getZone()->getPlayer() == player)
-                toDelete.append(a);
+    QList<QPair<Server_Player *, Server_Arrow *>> toDelete = getArrowsTouching(player);
+    for (Server_CardZone *zone : player->getZones()) {
+        for (Server_Card *card : zone->getCards()) {
+            for (const auto &arrow : getArrowsTouching(card)) {
+                // an arrow between two of his cards is found at both of them
+                if (!toDelete.contains(arrow))
+                    toDelete.append(arrow);
+            }
         }
-        for (int i = 0; i < toDelete.size(); ++i) {
-            Event_DeleteArrow event;
-            event.set_arrow_id(toDelete[i]->getId());
-            ges.enqueueGameEvent(event, otherPlayer->getPlayerId());
+    }
+    for (const auto &arrow : toDelete) {
+        Event_DeleteArrow event;
+        event.set_arrow_id(arrow.second->getId());
+        ges.enqueueGameEvent(event, arrow.first->getPlayerId());
 
-            otherPlayer->deleteArrow(toDelete[i]->getId());
-        }
+        arrow.first->deleteArrow(arrow.second->getId());
+    }
+}
+
+void Server_Game::indexArrow(Server_Player *owner, Server_Arrow *arrow)
+{
+    const QPair<Server_Player *, Server_Arrow *> entry(owner, arrow);
+    arrowsByEndpoint.insert(arrow->getStartCard(), entry);
+    if (arrow->getTargetItem() != arrow->getStartCard())
+        arrowsByEndpoint.insert(arrow->getTargetItem(), entry);
+}
+
+void Server_Game::unindexArrow(Server_Player *owner, Server_Arrow *arrow)
+{
+    const QPair<Server_Player *, Server_Arrow *> entry(owner, arrow);
+    arrowsByEndpoint.remove(arrow->getStartCard(), entry);
+    arrowsByEndpoint.remove(arrow->getTargetItem(), entry);
+}
+
+void Server_Game::recordMailboxLatency(qint64 microseconds)
+{
+    lastMailboxLatency.store(microseconds, std::memory_order_relaxed);
+    qint64 peak = peakMailboxLatency.load(std::memory_order_relaxed);
+    while (microseconds > peak && !peakMailboxLatency.compare_exchange_weak(peak, microseconds)) {
     }
 }
 
@@ -604,7 +1095,7 @@ void Server_Game::unattachCards(GameEventStorage &ges, Server_Player *player)
     for (auto zone : player->getZones()) {
         for (auto card : zone->getCards()) {
             // Make a copy of the list because the original one gets modified during the loop
-            QList<Server_Card *> attachedCards = card->getAttachedCards();
+            const Server_Card::AttachedCards attachedCards = card->getAttachedCards();
             for (Server_Card *attachedCard : attachedCards) {
                 auto otherPlayer = attachedCard->getZone()->getPlayer();
                 // do not modify the current player's zone!
@@ -706,7 +1197,7 @@ void Server_Game::nextTurn()
 void Server_Game::createGameJoinedEvent(Server_Player *player, ResponseContainer &rc, bool resuming)
 {
     Event_GameJoined event1;
-    getInfo(*event1.mutable_game_info());
+    buildInfo(*event1.mutable_game_info());
     event1.set_host_id(hostId);
     event1.set_player_id(player->getPlayerId());
     event1.set_spectator(player->getSpectator());
@@ -722,6 +1213,27 @@ void Server_Game::createGameJoinedEvent(Server_Player *player, ResponseContainer
     }
     rc.enqueuePostResponseItem(ServerMessage::SESSION_EVENT, Server_AbstractUserInterface::prepareSessionEvent(event1));
 
+    if (isStreamSpectator(player)) {
+        // the cached snapshot and the events released after it, the rest of the stream follows with the others
+        SpectatorStream::Item snapshot;
+        QList<SpectatorStream::Item> catchUp;
+        QMutexLocker streamLocker(&spectatorStreamMutex);
+        spectatorStream->getJoinPoint(snapshot, catchUp);
+        streamSpectatorIds.insert(player->getPlayerId());
+
+        catchUp.prepend(snapshot);
+        for (const SpectatorStream::Item &item : catchUp) {
+            if (!item.skippedClientFeature.isEmpty() && player->clientSupportsFeature(item.skippedClientFeature))
+                continue;
+            if (item.serializedMessage.isEmpty())
+                rc.enqueuePostResponseItem(ServerMessage::GAME_EVENT_CONTAINER,
+                                           new GameEventContainer(*item.container));
+            else
+                rc.enqueuePostResponseSerializedItem(item.serializedMessage);
+        }
+        return;
+    }
+
     Event_GameStateChanged event2;
     event2.set_seconds_elapsed(secondsElapsed);
     event2.set_game_started(gameStarted);
@@ -733,30 +1245,151 @@ void Server_Game::createGameJoinedEvent(Server_Player *player, ResponseContainer
                          (_player->getSpectator() && (spectatorsSeeEverything || _player->getJudge())), true);
     }
 
-    rc.enqueuePostResponseItem(ServerMessage::GAME_EVENT_CONTAINER, prepareGameEvent(event2, -1));
+    GameEventContainer *stateCont = prepareGameEvent(event2, -1);
+    if (GameEventContainer *cardNames = player->encodeCardNames(*stateCont))
+        rc.enqueuePostResponseItem(ServerMessage::GAME_EVENT_CONTAINER, cardNames);
+    rc.enqueuePostResponseItem(ServerMessage::GAME_EVENT_CONTAINER, stateCont);
 }
 
 void Server_Game::sendGameEventContainer(GameEventContainer *cont,
                                          GameEventStorageItem::EventRecipients recipients,
-                                         int privatePlayerId)
+                                         int privatePlayerId,
+                                         const QString &skippedClientFeature)
 {
-    QMutexLocker locker(&gameMutex);
+    QReadLocker locker(&playersLock);
 
     cont->set_game_id(gameId);
+
+    // every recipient gets the same container, so serialize it only once, when the first recipient is found
+    QByteArray serializedEvent;
+    const bool serialize = room->getServer()->getSendsSerializedMessages();
     for (Server_Player *player : players.values()) {
+        if (isStreamSpectator(player))
+            continue;
         const bool playerPrivate = (player->getPlayerId() == privatePlayerId) ||
                                    (player->getSpectator() && (spectatorsSeeEverything || player->getJudge()));
         if ((recipients.testFlag(GameEventStorageItem::SendToPrivate) && playerPrivate) ||
-            (recipients.testFlag(GameEventStorageItem::SendToOthers) && !playerPrivate))
-            player->sendGameEvent(*cont);
+            (recipients.testFlag(GameEventStorageItem::SendToOthers) && !playerPrivate)) {
+            if (!skippedClientFeature.isEmpty() && player->clientSupportsFeature(skippedClientFeature))
+                continue;
+            if (serialize && serializedEvent.isEmpty()) {
+                serializedEvent = Server_AbstractUserInterface::serializeGameEventContainer(*cont);
+            }
+            player->sendGameEvent(*cont, serializedEvent);
+        }
     }
+    // the spectators of the stream are told what the spectators that aren't judges would be told
+    if (spectatorStream && ((recipients.testFlag(GameEventStorageItem::SendToPrivate) && spectatorsSeeEverything) ||
+                            (recipients.testFlag(GameEventStorageItem::SendToOthers) && !spectatorsSeeEverything)))
+        appendToSpectatorStream(*cont, serializedEvent, skippedClientFeature);
     if (recipients.testFlag(GameEventStorageItem::SendToPrivate)) {
+        QMutexLocker replayLocker(&replayMutex);
         cont->set_seconds_elapsed(secondsElapsed - startTimeOfThisGame);
         cont->clear_game_id();
-        currentReplay->add_event_list()->CopyFrom(*cont);
+        currentReplay->appendEvent(*cont);
     }
 
-    delete cont;
+    // containers built by a GameEventStorage belong to its arena
+    if (cont->GetArena() == nullptr)
+        delete cont;
+}
+
+bool Server_Game::isStreamSpectator(Server_Player *player) const
+{
+    return spectatorStream && player->getSpectator() && !player->getJudge();
+}
+
+void Server_Game::appendToSpectatorStream(const GameEventContainer &cont,
+                                          const QByteArray &serializedEvent,
+                                          const QString &skippedClientFeature)
+{
+    SpectatorStream::Item item;
+    item.container = std::make_shared<GameEventContainer>(cont);
+    item.serializedMessage = serializedEvent;
+    if (item.serializedMessage.isEmpty() && room->getServer()->getSendsSerializedMessages())
+        item.serializedMessage = Server_AbstractUserInterface::serializeGameEventContainer(cont);
+    item.skippedClientFeature = skippedClientFeature;
+    item.appendedAt = spectatorStreamTime.elapsed();
+
+    QMutexLocker locker(&spectatorStreamMutex);
+    spectatorStream->append(item);
+}
+
+SpectatorStream::Item Server_Game::buildSpectatorSnapshot()
+{
+    Event_GameStateChanged event;
+    event.set_seconds_elapsed(secondsElapsed);
+    event.set_game_started(gameStarted);
+    event.set_active_player_id(activePlayer);
+    event.set_active_phase(activePhase);
+    for (Server_Player *player : players.values())
+        player->getInfo(event.add_player_list(), nullptr, spectatorsSeeEverything, true);
+
+    SpectatorStream::Item snapshot;
+    GameEventContainer *cont = prepareGameEvent(event, -1);
+    snapshot.container.reset(cont);
+    if (room->getServer()->getSendsSerializedMessages())
+        snapshot.serializedMessage = Server_AbstractUserInterface::serializeGameEventContainer(*cont);
+    snapshot.appendedAt = spectatorStreamTime.elapsed();
+    return snapshot;
+}
+
+void Server_Game::takeSpectatorSnapshot()
+{
+    // Chat is appended without gameMutex, but it isn't part of the game state, so the snapshot can be taken as of
+    // the head before building it.
+    spectatorStreamMutex.lock();
+    const qint64 position = spectatorStream->getHead();
+    spectatorStreamMutex.unlock();
+
+    const SpectatorStream::Item snapshot = buildSpectatorSnapshot();
+    QMutexLocker locker(&spectatorStreamMutex);
+    spectatorStream->addSnapshot(position, snapshot);
+}
+
+void Server_Game::flushSpectatorStream(bool all)
+{
+    // Spectators join with at most this many events or this much time [ms] of the stream to catch up with. Snapshots
+    // cost a full game state, so they are only taken when there was something new.
+    static const qint64 maxCatchUpEvents = 256;
+    static const qint64 snapshotInterval = 10000;
+
+    const qint64 now = spectatorStreamTime.elapsed();
+    spectatorStreamMutex.lock();
+    const qint64 head = spectatorStream->getHead();
+    const qint64 snapshotPosition = spectatorStream->getNewestSnapshotPosition();
+    const bool snapshotDue = !all && head > snapshotPosition &&
+                             (head - snapshotPosition >= maxCatchUpEvents ||
+                              now - spectatorStream->getNewestSnapshotTime() >= snapshotInterval);
+    spectatorStreamMutex.unlock();
+    // when gameMutex is busy, the snapshot is taken on another tick
+    if (snapshotDue && gameMutex.tryLock()) {
+        // nothing changes while the game is hibernated, the board is gone meanwhile
+        if (!isHibernated())
+            takeSpectatorSnapshot();
+        gameMutex.unlock();
+    }
+
+    QReadLocker playersLocker(&playersLock);
+    QMutexLocker streamLocker(&spectatorStreamMutex);
+    sendSpectatorStreamItems(spectatorStream->release(now, all));
+}
+
+void Server_Game::sendSpectatorStreamItems(const QList<SpectatorStream::Item> &items)
+{
+    if (items.isEmpty())
+        return;
+
+    for (const int playerId : streamSpectatorIds) {
+        Server_Player *player = players.value(playerId);
+        if (!player)
+            continue;
+        for (const SpectatorStream::Item &item : items) {
+            if (!item.skippedClientFeature.isEmpty() && player->clientSupportsFeature(item.skippedClientFeature))
+                continue;
+            player->sendGameEvent(*item.container, item.serializedMessage);
+        }
+    }
 }
 
 GameEventContainer *
@@ -769,13 +1402,55 @@ Server_Game::prepareGameEvent(const ::google::protobuf::Message &gameEvent, int
     GameEvent *event = cont->add_event_list();
     if (playerId != -1)
         event->set_player_id(playerId);
-    event->GetReflection()
-        ->MutableMessage(event, gameEvent.GetDescriptor()->FindExtensionByName("ext"))
-        ->CopyFrom(gameEvent);
+    setPbExtension(event, gameEvent);
     return cont;
 }
 
 void Server_Game::getInfo(ServerInfo_Game &result) const
+{
+    infoMutex.lock();
+    std::shared_ptr<const ServerInfo_Game> info = publishedInfo;
+    infoMutex.unlock();
+
+    result.CopyFrom(*info);
+}
+
+Server_Game::MemoryUsage Server_Game::getMemoryUsage()
+{
+    MemoryUsage usage = {objectPool ? objectPool->getAllocatedBytes() : 0, 0, 0};
+
+    replayMutex.lock();
+    for (const GameReplayWriter *replay : replayList)
+        usage.replays += replay->getMemoryBytes();
+    if (currentReplay)
+        usage.replays += currentReplay->getMemoryBytes();
+    replayMutex.unlock();
+
+    QReadLocker locker(&playersLock);
+    for (const Server_Player *player : players)
+        usage.resumeLogs += player->getResumeLogBytes();
+    return usage;
+}
+
+void Server_Game::publishInfo()
+{
+    auto info = std::make_shared<ServerInfo_Game>();
+    buildInfo(*info);
+
+    QSet<QString> names;
+    for (Server_Player *player : players.values())
+        names.insert(QString::fromStdString(player->getUserInfo()->name()));
+
+    // a migrated game is looked up on the server it went to
+    if (migratedTo == -1)
+        room->getServer()->getUserGameIndex().setMembers(room->getId(), gameId,
+                                                         QString::fromStdString(creatorInfo->name()), names);
+
+    QMutexLocker locker(&infoMutex);
+    publishedInfo = std::move(info);
+}
+
+void Server_Game::buildInfo(ServerInfo_Game &result) const
 {
     QMutexLocker locker(&gameMutex);
 
@@ -20,21 +20,36 @@
 #ifndef SERVERGAME_H
 #define SERVERGAME_H
 
+#include "activity_meter.h"
 #include "pb/event_leave.pb.h"
 #include "pb/response.pb.h"
 #include "pb/serverinfo_game.pb.h"
+#include "server_game_handle.h"
 #include "server_response_containers.h"
+#include "spectator_stream.h"
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QMap>
+#include <QMultiHash>
 #include <QMutex>
 #include <QObject>
+#include <QPair>
+#include <QReadWriteLock>
 #include <QSet>
 #include <QStringList>
+#include <atomic>
+#include <memory>
 
 class QTimer;
 class GameEventContainer;
-class GameReplay;
+class GameObjectPool;
+class GameHibernation;
+class GameReplayWriter;
+class HandoffGame;
+class IslGameMigration;
+class Server_Arrow;
+class Server_ArrowTarget;
 class Server_Room;
 class Server_Player;
 class ServerInfo_User;
@@ -42,12 +57,14 @@ class ServerInfo_Player;
 class ServerInfo_Game;
 class Server_AbstractUserInterface;
 class Event_GameStateChanged;
+class Event_PlayerPings;
 
 class Server_Game : public QObject
 {
     Q_OBJECT
 private:
     Server_Room *room;
+    std::shared_ptr<Server_GameHandle> handle;
     int nextPlayerId;
     int hostId;
     ServerInfo_User *creatorInfo;
@@ -68,25 +85,91 @@ private:
     bool spectatorsSeeEverything;
     int startingLifeTotal;
     int inactivityCounter;
-    int startTimeOfThisGame, secondsElapsed;
+    int startTimeOfThisGame;
+    std::atomic<int> secondsElapsed;
     bool firstGameStarted;
     bool turnOrderReversed;
     QDateTime startTime;
     QTimer *pingClock;
-    QList<GameReplay *> replayList;
-    GameReplay *currentReplay;
+    QMap<int, int> pingVectorState; // playerId -> ping seconds last sent in a ping vector
+    QMutex replayMutex; // guards replayList, currentReplay and startTimeOfThisGame
+    QList<GameReplayWriter *> replayList;
+    GameReplayWriter *currentReplay;
+    // the arrows of all players, with the player they belong to, by the cards and players they start at or point to
+    QMultiHash<const Server_ArrowTarget *, QPair<Server_Player *, Server_Arrow *>> arrowsByEndpoint;
+    // the memory of the cards, arrows and counters of the players, outlives the game until the last of them is deleted
+    GameObjectPool *objectPool;
+    // the file the board is kept in while the game is hibernated, empty while it is in memory
+    QString hibernationFile;
+    // whether the game was checked for a better server to run on, and that server once it moved there, see migrate()
+    bool migrationConsidered;
+    int migratedTo;
+    // The events of the spectators other than judges when they share a stream, see
+    // Server::getSpectatorStreamInterval(). Locking order: playersLock before spectatorStreamMutex.
+    SpectatorStream *spectatorStream;
+    QMutex spectatorStreamMutex;
+    // the spectators that got their join point and follow the stream, guarded by spectatorStreamMutex
+    QSet<int> streamSpectatorIds;
+    QTimer *spectatorStreamClock;
+    QElapsedTimer spectatorStreamTime;
+    // how long the commands of the game waited for a game executor [us]
+    std::atomic<qint64> lastMailboxLatency, peakMailboxLatency;
+    ActivityMeter activity;
+
+    // The game list summary, republished under infoMutex whenever it changes, so that rooms can list their games
+    // without waiting for gameMutex. The names of the members go to the UserGameIndex of the server at the same time.
+    mutable QMutex infoMutex;
+    std::shared_ptr<const ServerInfo_Game> publishedInfo;
+
+    void buildInfo(ServerInfo_Game &result) const;
+    void publishInfo();
 
     void createGameStateChangedEvent(Event_GameStateChanged *event,
                                      Server_Player *playerWhosAsking,
                                      bool omniscient,
                                      bool withUserInfo);
     void storeGameInformation();
+    void sendPingVector(const Event_PlayerPings &event);
+    void updatePings();
+    /**
+     * Writes the zones, counters and arrows of all players to a file in the hibernation directory and deletes them,
+     * along with moving a replay kept in memory to a spool file there. Only done once nobody is connected to the
+     * game any more, everything that lets somebody in again wakes the game up first. Needs gameMutex.
+     */
+    void hibernate();
+    /**
+     * The server of the network most non-spectating players are connected to, if they are more than those connected
+     * here, or -1. Needs gameMutex.
+     */
+    int findMigrationTarget() const;
+    // what another server needs to take the game over, see migrate() and getHandoffInfo(); needs gameMutex
+    void getMigrationInfo(IslGameMigration &migration) const;
+    // recreates the board written by hibernate() or getHandoffInfo(), needs gameMutex
+    void restoreBoard(const GameHibernation &hibernation);
+    bool isStreamSpectator(Server_Player *player) const;
+    void appendToSpectatorStream(const GameEventContainer &cont,
+                                 const QByteArray &serializedEvent,
+                                 const QString &skippedClientFeature = QString());
+    // both need gameMutex
+    SpectatorStream::Item buildSpectatorSnapshot();
+    void takeSpectatorSnapshot();
+    // needs spectatorStreamMutex and playersLock or gameMutex
+    void sendSpectatorStreamItems(const QList<SpectatorStream::Item> &items);
 signals:
     void sigStartGameIfReady(bool override);
+    void sigMigrate(int serverId, bool forceStartGame);
     void gameInfoChanged(ServerInfo_Game gameInfo);
 private slots:
     void pingClockTimeout();
+    void flushSpectatorStream(bool all = false);
     void doStartGameIfReady(bool forceStartGame = false);
+    /**
+     * Hands the game over to another server instead of starting it here, when it starts for the first time and
+     * most of its players are connected to that server, so that their commands don't take the detour through this
+     * one. The users connected here send their commands on to the new server from then on. The game is deleted
+     * without closing it.
+     */
+    void migrate(int serverId, bool forceStartGame);
 
 public:
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
@@ -94,6 +177,13 @@ public:
 #else
     mutable QMutex gameMutex;
 #endif
+    /**
+     * Write locked, with gameMutex held, whenever players are added or removed. Holding it for reading keeps the
+     * players map and the players in it alive, which is all sending game events needs; chat is processed under
+     * this lock alone so that it doesn't have to wait for the board commands holding gameMutex.
+     * Locking order: gameMutex before playersLock.
+     */
+    mutable QReadWriteLock playersLock;
     Server_Game(const ServerInfo_User &_creatorInfo,
                 int _gameId,
                 const QString &_description,
@@ -113,6 +203,13 @@ public:
     {
         return room;
     }
+    const std::shared_ptr<Server_GameHandle> &getHandle() const
+    {
+        return handle;
+    }
+    /**
+     * Copies the last published game info, doesn't need gameMutex.
+     */
     void getInfo(ServerInfo_Game &result) const;
     int getHostId() const
     {
@@ -170,7 +267,6 @@ public:
     }
     Response::ResponseCode
     checkJoin(ServerInfo_User *user, const QString &_password, bool spectator, bool overrideRestrictions, bool asJudge);
-    bool containsUser(const QString &userName) const;
     void addPlayer(Server_AbstractUserInterface *userInterface,
                    ResponseContainer &rc,
                    bool spectator,
@@ -178,6 +274,76 @@ public:
                    bool broadcastUpdate = true);
     void removePlayer(Server_Player *player, Event_Leave::LeaveReason reason);
     void removeArrowsRelatedToPlayer(GameEventStorage &ges, Server_Player *player);
+    /**
+     * The arrows are indexed by their start card and target while they exist, the players add and remove their
+     * arrows here, before an arrow gets another start or target and again after.
+     */
+    void indexArrow(Server_Player *owner, Server_Arrow *arrow);
+    void unindexArrow(Server_Player *owner, Server_Arrow *arrow);
+    // the arrows starting at or pointing to item, each one once
+    QList<QPair<Server_Player *, Server_Arrow *>> getArrowsTouching(const Server_ArrowTarget *item) const
+    {
+        return arrowsByEndpoint.values(item);
+    }
+    /**
+     * Records how long a container of commands waited in the mailbox of the game executor running the game.
+     */
+    void recordMailboxLatency(qint64 microseconds);
+    qint64 getLastMailboxLatency() const
+    {
+        return lastMailboxLatency.load(std::memory_order_relaxed);
+    }
+    // the game commands run and the events sent to the players, for the activity view of the moderators
+    ActivityMeter &getActivity()
+    {
+        return activity;
+    }
+    // returns the largest latency since the last call
+    qint64 takePeakMailboxLatency()
+    {
+        return peakMailboxLatency.exchange(0, std::memory_order_relaxed);
+    }
+    bool isHibernated() const
+    {
+        return !hibernationFile.isEmpty();
+    }
+    /**
+     * Brings back the board of a hibernated game, returns false if that failed and the game is closed. Needs
+     * gameMutex.
+     */
+    bool wakeUp();
+    /**
+     * Takes over the players of a game another server migrated here, before the game is added to its room. Needs
+     * Server::clientsLock.
+     */
+    void adoptMigration(const IslGameMigration &migration);
+    /**
+     * Writes everything the process replacing the server on a hot restart needs to go on with the game, see
+     * Servatrice::handOver(), and leaves the replays to that process. Needs gameMutex.
+     */
+    void getHandoffInfo(HandoffGame &info);
+    // sends the spectators what the delayed stream holds back, as the stream isn't carried over; needs gameMutex
+    void prepareHandoff();
+    /**
+     * Goes on with a game written by getHandoffInfo(), after adoptMigration() took over its players.
+     */
+    void adoptHandoff(const HandoffGame &info);
+    // the cards, arrows and counters of the game are created with new (game->getObjectPool()) ...
+    GameObjectPool *getObjectPool() const
+    {
+        return objectPool;
+    }
+    struct MemoryUsage
+    {
+        // the slabs of the object pool
+        qint64 board;
+        // the serialized replays kept in memory, the current one included
+        qint64 replays;
+        // the resume logs of the players
+        qint64 resumeLogs;
+    };
+    // an estimate for the memory accounting of the server, doesn't need gameMutex
+    MemoryUsage getMemoryUsage();
     void unattachCards(GameEventStorage &ges, Server_Player *player);
     bool kickPlayer(int playerId);
     void startGameIfReady(bool forceStartGame);
@@ -212,7 +378,8 @@ public:
     void sendGameEventContainer(GameEventContainer *cont,
                                 GameEventStorageItem::EventRecipients recipients = GameEventStorageItem::SendToPrivate |
                                                                                    GameEventStorageItem::SendToOthers,
-                                int privatePlayerId = -1);
+                                int privatePlayerId = -1,
+                                const QString &skippedClientFeature = QString());
 };
 
 #endif
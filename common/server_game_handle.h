@@ -0,0 +1,25 @@
+#ifndef SERVER_GAME_HANDLE_H
+#define SERVER_GAME_HANDLE_H
+
+#include <QReadWriteLock>
+
+class Server_Game;
+
+/**
+ * Lets the sessions of the players reach their game directly, without the locks of the server and the room.
+ *
+ * Holding the lock for reading keeps the game alive. The game clears the pointer, write locked, as the first thing
+ * its destructor does, so afterwards a session that still holds the handle finds nothing.
+ */
+class Server_GameHandle
+{
+public:
+    explicit Server_GameHandle(Server_Game *_game) : game(_game)
+    {
+    }
+
+    mutable QReadWriteLock lock;
+    Server_Game *game;
+};
+
+#endif
@@ -21,6 +21,7 @@
 #include "pb/command_kick_from_game.pb.h"
 #include "pb/command_leave_game.pb.h"
 #include "pb/command_move_card.pb.h"
+#include "pb/command_move_top_cards_until.pb.h"
 #include "pb/command_mulligan.pb.h"
 #include "pb/command_next_turn.pb.h"
 #include "pb/command_ready_start.pb.h"
@@ -44,6 +45,7 @@
 #include "pb/context_set_sideboard_lock.pb.h"
 #include "pb/context_undo_draw.pb.h"
 #include "pb/event_attach_card.pb.h"
+#include "pb/event_card_names.pb.h"
 #include "pb/event_change_zone_properties.pb.h"
 #include "pb/event_create_arrow.pb.h"
 #include "pb/event_create_counter.pb.h"
@@ -64,9 +66,12 @@
 #include "pb/event_set_card_counter.pb.h"
 #include "pb/event_set_counter.pb.h"
 #include "pb/event_shuffle.pb.h"
+#include "pb/game_hibernation.pb.h"
+#include "pb/isl_game_migration.pb.h"
 #include "pb/response.pb.h"
 #include "pb/response_deck_download.pb.h"
 #include "pb/response_dump_zone.pb.h"
+#include "pb/server_handoff.pb.h"
 #include "pb/serverinfo_player.pb.h"
 #include "pb/serverinfo_user.pb.h"
 #include "rng_abstract.h"
@@ -85,6 +90,8 @@
 #include <QRegularExpression>
 #include <algorithm>
 
+static const QString cardNameDictionaryFeature = "card_name_dictionary";
+
 struct MoveCardStruct
 {
     Server_Card *card;
@@ -111,9 +118,14 @@ Server_Player::Server_Player(Server_Game *_game,
                              bool _judge,
                              Server_AbstractUserInterface *_userInterface)
     : ServerInfo_User_Container(_userInfo), game(_game), userInterface(_userInterface), deck(nullptr), pingTime(0),
-      playerId(_playerId), spectator(_spectator), judge(_judge), nextCardId(0), readyStart(false), conceded(false),
-      sideboardLocked(true)
+      playerId(_playerId), spectator(_spectator), judge(_judge), nextCardId(0), nextCounterId(0), nextArrowId(1),
+      readyStart(false), conceded(false), sideboardLocked(true),
+      cardNamesEnabled(_userInterface && _userInterface->clientSupportsFeature(cardNameDictionaryFeature))
 {
+    standardZones.fill(nullptr);
+    // the others leave the game when they disconnect, see disconnectClient()
+    if ((userInfo->user_level() & ServerInfo_User::IsRegistered) && !spectator)
+        resumeLog.setCapacity(game->getRoom()->getServer()->getResumeLogLength());
 }
 
 Server_Player::~Server_Player() = default;
@@ -134,33 +146,41 @@ void Server_Player::prepareDestroy()
     deleteLater();
 }
 
+Server_Player::StandardZone Server_Player::standardZone(const std::string &zoneName)
+{
+    // the names setupZones gives the zones
+    static const std::array<const char *, NoStandardZone> names = {"deck",  "sb",    "table", "hand",
+                                                                   "stack", "grave", "rfg"};
+    for (int zone = 0; zone < NoStandardZone; ++zone) {
+        if (zoneName == names[zone]) {
+            return static_cast<StandardZone>(zone);
+        }
+    }
+    return NoStandardZone;
+}
+
+Server_CardZone *Server_Player::getZone(const std::string &zoneName) const
+{
+    const StandardZone zone = standardZone(zoneName);
+    if (zone != NoStandardZone) {
+        return standardZones[zone];
+    }
+    return zones.value(nameFromStdString(zoneName));
+}
+
 int Server_Player::newCardId()
 {
     return nextCardId++;
 }
 
-int Server_Player::newCounterId() const
+int Server_Player::newCounterId()
 {
-    int id = 0;
-    QMapIterator<int, Server_Counter *> i(counters);
-    while (i.hasNext()) {
-        Server_Counter *c = i.next().value();
-        if (c->getId() > id) {
-            id = c->getId();
-        }
-    }
-    return id + 1;
+    return nextCounterId++;
 }
 
-int Server_Player::newArrowId() const
+int Server_Player::newArrowId()
 {
-    int id = 0;
-    for (Server_Arrow *a : arrows) {
-        if (a->getId() > id) {
-            id = a->getId();
-        }
-    }
-    return id + 1;
+    return nextArrowId++;
 }
 
 void Server_Player::setupZones()
@@ -168,6 +188,8 @@ void Server_Player::setupZones()
     // This may need to be customized according to the game rules.
     // ------------------------------------------------------------------
 
+    GameObjectPool *pool = game->getObjectPool();
+
     // Create zones
     auto *deckZone = new Server_CardZone(this, "deck", false, ServerInfo_Zone::HiddenZone);
     addZone(deckZone);
@@ -179,14 +201,14 @@ void Server_Player::setupZones()
     addZone(new Server_CardZone(this, "grave", false, ServerInfo_Zone::PublicZone));
     addZone(new Server_CardZone(this, "rfg", false, ServerInfo_Zone::PublicZone));
 
-    addCounter(new Server_Counter(0, "life", makeColor(255, 255, 255), 25, game->getStartingLifeTotal()));
-    addCounter(new Server_Counter(1, "w", makeColor(255, 255, 150), 20, 0));
-    addCounter(new Server_Counter(2, "u", makeColor(150, 150, 255), 20, 0));
-    addCounter(new Server_Counter(3, "b", makeColor(150, 150, 150), 20, 0));
-    addCounter(new Server_Counter(4, "r", makeColor(250, 150, 150), 20, 0));
-    addCounter(new Server_Counter(5, "g", makeColor(150, 255, 150), 20, 0));
-    addCounter(new Server_Counter(6, "x", makeColor(255, 255, 255), 20, 0));
-    addCounter(new Server_Counter(7, "storm", makeColor(255, 150, 30), 20, 0));
+    addCounter(new (pool) Server_Counter(0, "life", makeColor(255, 255, 255), 25, game->getStartingLifeTotal()));
+    addCounter(new (pool) Server_Counter(1, "w", makeColor(255, 255, 150), 20, 0));
+    addCounter(new (pool) Server_Counter(2, "u", makeColor(150, 150, 255), 20, 0));
+    addCounter(new (pool) Server_Counter(3, "b", makeColor(150, 150, 150), 20, 0));
+    addCounter(new (pool) Server_Counter(4, "r", makeColor(250, 150, 150), 20, 0));
+    addCounter(new (pool) Server_Counter(5, "g", makeColor(150, 255, 150), 20, 0));
+    addCounter(new (pool) Server_Counter(6, "x", makeColor(255, 255, 255), 20, 0));
+    addCounter(new (pool) Server_Counter(7, "storm", makeColor(255, 150, 30), 20, 0));
 
     // ------------------------------------------------------------------
 
@@ -209,8 +231,10 @@ void Server_Player::setupZones()
             if (!currentCard) {
                 continue;
             }
+            const StringAtom cardName(currentCard->getName());
+            const StringAtom cardProviderId(currentCard->getCardProviderId());
             for (int k = 0; k < currentCard->getNumber(); ++k) {
-                z->insertCard(new Server_Card(currentCard->toCardRef(), nextCardId++, 0, 0, z), -1, 0);
+                z->insertCard(new (pool) Server_Card(cardName, cardProviderId, nextCardId++, 0, 0, z), -1, 0);
             }
         }
     }
@@ -236,8 +260,14 @@ void Server_Player::setupZones()
             continue;
         }
 
+        const QString cardName = nameFromStdString(m.card_name());
+        const StringAtom cardNameAtom = StringAtom::find(cardName);
+        if (cardNameAtom.isNull() && !cardName.isEmpty()) {
+            // no card by that name exists anywhere, let alone in this deck
+            continue;
+        }
         for (int j = 0; j < start->getCards().size(); ++j) {
-            if (start->getCards()[j]->getName() == nameFromStdString(m.card_name())) {
+            if (start->getCards()[j]->getNameAtom() == cardNameAtom) {
                 Server_Card *card = start->getCard(j, nullptr, true);
                 target->insertCard(card, -1, 0);
                 break;
@@ -254,16 +284,20 @@ void Server_Player::clearZones()
         delete zone;
     }
     zones.clear();
+    standardZones.fill(nullptr);
 
     for (Server_Counter *counter : counters) {
         delete counter;
     }
     counters.clear();
+    nextCounterId = 0;
 
     for (Server_Arrow *arrow : arrows) {
+        game->unindexArrow(this, arrow);
         delete arrow;
     }
     arrows.clear();
+    nextArrowId = 1;
 
     lastDrawList.clear();
 }
@@ -290,11 +324,17 @@ void Server_Player::getProperties(ServerInfo_PlayerProperties &result, bool with
 void Server_Player::addZone(Server_CardZone *zone)
 {
     zones.insert(zone->getName(), zone);
+    const StandardZone standard = standardZone(zone->getNameAtom().toStdString());
+    if (standard != NoStandardZone) {
+        standardZones[standard] = zone;
+    }
 }
 
 void Server_Player::addArrow(Server_Arrow *arrow)
 {
     arrows.insert(arrow->getId(), arrow);
+    nextArrowId = qMax(nextArrowId, arrow->getId() + 1);
+    game->indexArrow(this, arrow);
 }
 
 void Server_Player::updateArrowId(int id)
@@ -310,6 +350,7 @@ bool Server_Player::deleteArrow(int arrowId)
         return false;
     }
     arrows.remove(arrowId);
+    game->unindexArrow(this, arrow);
     delete arrow;
     return true;
 }
@@ -317,12 +358,13 @@ bool Server_Player::deleteArrow(int arrowId)
 void Server_Player::addCounter(Server_Counter *counter)
 {
     counters.insert(counter->getId(), counter);
+    nextCounterId = qMax(nextCounterId, counter->getId() + 1);
 }
 
 Response::ResponseCode Server_Player::drawCards(GameEventStorage &ges, int number)
 {
-    Server_CardZone *deckZone = zones.value("deck");
-    Server_CardZone *handZone = zones.value("hand");
+    Server_CardZone *deckZone = getZone(DeckZone);
+    Server_CardZone *handZone = getZone(HandZone);
     if (deckZone->getCards().size() < number) {
         number = deckZone->getCards().size();
     }
@@ -338,7 +380,7 @@ Response::ResponseCode Server_Player::drawCards(GameEventStorage &ges, int numbe
 
         ServerInfo_Card *cardInfo = eventPrivate.add_cards();
         cardInfo->set_id(card->getId());
-        cardInfo->set_name(card->getName().toStdString());
+        cardInfo->set_name(card->getNameAtom().toStdString());
         cardInfo->set_provider_id(card->getProviderId().toStdString());
     }
 
@@ -361,7 +403,7 @@ void Server_Player::revealTopCardIfNeeded(Server_CardZone *zone, GameEventStorag
     }
     if (zone->getAlwaysRevealTopCard()) {
         Event_RevealCards revealEvent;
-        revealEvent.set_zone_name(zone->getName().toStdString());
+        revealEvent.set_zone_name(zone->getNameAtom().toStdString());
         revealEvent.add_card_id(0);
         zone->getCards().first()->getInfo(revealEvent.add_cards());
 
@@ -371,12 +413,12 @@ void Server_Player::revealTopCardIfNeeded(Server_CardZone *zone, GameEventStorag
     if (zone->getAlwaysLookAtTopCard()) {
         Event_DumpZone dumpEvent;
         dumpEvent.set_zone_owner_id(playerId);
-        dumpEvent.set_zone_name(zone->getName().toStdString());
+        dumpEvent.set_zone_name(zone->getNameAtom().toStdString());
         dumpEvent.set_number_cards(1);
         ges.enqueueGameEvent(dumpEvent, playerId, GameEventStorageItem::SendToOthers);
 
         Event_RevealCards revealEvent;
-        revealEvent.set_zone_name(zone->getName().toStdString());
+        revealEvent.set_zone_name(zone->getNameAtom().toStdString());
         revealEvent.set_number_of_cards(1);
         revealEvent.add_card_id(0);
         zone->getCards().first()->getInfo(revealEvent.add_cards());
@@ -392,12 +434,12 @@ static Event_CreateToken
 makeCreateTokenEvent(Server_CardZone *zone, Server_Card *card, int xCoord, int yCoord, bool revealFacedownInfo = false)
 {
     Event_CreateToken event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getNameAtom().toStdString());
     event.set_card_id(card->getId());
     event.set_face_down(card->getFaceDown());
 
     if (!card->getFaceDown() || revealFacedownInfo) {
-        event.set_card_name(card->getName().toStdString());
+        event.set_card_name(card->getNameAtom().toStdString());
         event.set_card_provider_id(card->getProviderId().toStdString());
     }
 
@@ -412,12 +454,12 @@ makeCreateTokenEvent(Server_CardZone *zone, Server_Card *card, int xCoord, int y
 static Event_AttachCard makeAttachCardEvent(Server_Card *attachedCard, Server_Card *parentCard = nullptr)
 {
     Event_AttachCard event;
-    event.set_start_zone(attachedCard->getZone()->getName().toStdString());
+    event.set_start_zone(attachedCard->getZone()->getNameAtom().toStdString());
     event.set_card_id(attachedCard->getId());
 
     if (parentCard) {
         event.set_target_player_id(parentCard->getZone()->getPlayer()->getPlayerId());
-        event.set_target_zone(parentCard->getZone()->getName().toStdString());
+        event.set_target_zone(parentCard->getZone()->getNameAtom().toStdString());
         event.set_target_card_id(parentCard->getId());
     }
 
@@ -532,7 +574,7 @@ Response::ResponseCode Server_Player::moveCard(GameEventStorage &ges,
             }
 
             // Make a copy of the list because the original one gets modified during the loop
-            QList<Server_Card *> attachedCards = card->getAttachedCards();
+            const Server_Card::AttachedCards attachedCards = card->getAttachedCards();
             for (auto &attachedCard : attachedCards) {
                 attachedCard->getZone()->getPlayer()->unattachCard(ges, attachedCard);
             }
@@ -540,22 +582,14 @@ Response::ResponseCode Server_Player::moveCard(GameEventStorage &ges,
 
         if (startzone != targetzone) {
             // Delete all arrows from and to the card
-            const QList<Server_Player *> &players = game->getPlayers().values();
-            for (auto player : players) {
-                QList<int> arrowsToDelete;
-                for (Server_Arrow *arrow : player->getArrows()) {
-                    if ((arrow->getStartCard() == card) || (arrow->getTargetItem() == card))
-                        arrowsToDelete.append(arrow->getId());
-                }
-                for (int j : arrowsToDelete) {
-                    player->deleteArrow(j);
-                }
+            for (const auto &arrow : game->getArrowsTouching(card)) {
+                arrow.first->deleteArrow(arrow.second->getId());
             }
         }
 
         if (shouldDestroyOnMove(card, startzone, targetzone)) {
             Event_DestroyCard event;
-            event.set_zone_name(startzone->getName().toStdString());
+            event.set_zone_name(startzone->getNameAtom().toStdString());
             event.set_card_id(static_cast<google::protobuf::uint32>(card->getId()));
             ges.enqueueGameEvent(event, playerId);
 
@@ -576,7 +610,7 @@ Response::ResponseCode Server_Player::moveCard(GameEventStorage &ges,
             int newX = isReversed ? targetzone->getCards().size() - xCoord + xIndex : xCoord + xIndex;
 
             if (targetzone->hasCoords()) {
-                newX = targetzone->getFreeGridColumn(newX, yCoord, card->getName(), faceDown);
+                newX = targetzone->getFreeGridColumn(newX, yCoord, card->getNameAtom(), faceDown);
             } else {
                 yCoord = 0;
                 card->resetState(targetzone->getName() == "stack");
@@ -605,10 +639,10 @@ Response::ResponseCode Server_Player::moveCard(GameEventStorage &ges,
 
             Event_MoveCard eventOthers;
             eventOthers.set_start_player_id(startzone->getPlayer()->getPlayerId());
-            eventOthers.set_start_zone(startzone->getName().toStdString());
+            eventOthers.set_start_zone(startzone->getNameAtom().toStdString());
             eventOthers.set_target_player_id(targetzone->getPlayer()->getPlayerId());
             if (startzone != targetzone) {
-                eventOthers.set_target_zone(targetzone->getName().toStdString());
+                eventOthers.set_target_zone(targetzone->getNameAtom().toStdString());
             }
             eventOthers.set_y(yCoord);
             eventOthers.set_face_down(faceDown);
@@ -769,7 +803,7 @@ Response::ResponseCode Server_Player::setCardAttrHelper(GameEventStorage &ges,
     }
 
     Event_SetCardAttr event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getNameAtom().toStdString());
     if (cardId != -1) {
         event.set_card_id(cardId);
     }
@@ -817,7 +851,7 @@ Server_Player::cmdDeckSelect(const Command_DeckSelect &cmd, ResponseContainer &r
             return r;
         }
     } else {
-        newDeck = new DeckList(fileFromStdString(cmd.deck()));
+        newDeck = game->getRoom()->getServer()->getDeckListCache().load(fileFromStdString(cmd.deck()));
     }
 
     if (!newDeck) {
@@ -922,7 +956,7 @@ Server_Player::cmdConcede(const Command_Concede & /*cmd*/, ResponseContainer & /
 
     // Return cards to their rightful owners before conceding the game
     static const QRegularExpression ownerRegex{"Owner: ?([^\n]+)"};
-    for (const auto &card : zones.value("table")->getCards()) {
+    for (const auto &card : getZone(TableZone)->getCards()) {
         if (card == nullptr) {
             continue;
         }
@@ -947,8 +981,8 @@ Server_Player::cmdConcede(const Command_Concede & /*cmd*/, ResponseContainer & /
                 continue;
             }
 
-            const auto &startZone = zones.value("table");
-            const auto &targetZone = player->getZones().value("table");
+            const auto &startZone = getZone(TableZone);
+            const auto &targetZone = player->getZone(TableZone);
 
             if (startZone == nullptr || targetZone == nullptr) {
                 continue;
@@ -1105,7 +1139,7 @@ Server_Player::cmdShuffle(const Command_Shuffle &cmd, ResponseContainer & /*rc*/
         return Response::RespFunctionNotAllowed;
     }
 
-    Server_CardZone *zone = zones.value("deck");
+    Server_CardZone *zone = getZone(DeckZone);
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -1113,7 +1147,7 @@ Server_Player::cmdShuffle(const Command_Shuffle &cmd, ResponseContainer & /*rc*/
     zone->shuffle(cmd.start(), cmd.end());
 
     Event_Shuffle event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getNameAtom().toStdString());
     event.set_start(cmd.start());
     event.set_end(cmd.end());
     ges.enqueueGameEvent(event, playerId);
@@ -1136,8 +1170,8 @@ Server_Player::cmdMulligan(const Command_Mulligan &cmd, ResponseContainer & /*rc
         return Response::RespContextError;
     }
 
-    Server_CardZone *hand = zones.value("hand");
-    Server_CardZone *_deck = zones.value("deck");
+    Server_CardZone *hand = getZone(HandZone);
+    Server_CardZone *_deck = getZone(DeckZone);
     int number = cmd.number();
 
     if (!hand->getCards().isEmpty()) {
@@ -1230,7 +1264,7 @@ Server_Player::cmdUndoDraw(const Command_UndoDraw & /*cmd*/, ResponseContainer &
     Response::ResponseCode retVal;
     auto *cardToMove = new CardToMove;
     cardToMove->set_card_id(lastDrawList.takeLast());
-    retVal = moveCard(ges, zones.value("hand"), QList<const CardToMove *>() << cardToMove, zones.value("deck"), 0, 0,
+    retVal = moveCard(ges, getZone(HandZone), QList<const CardToMove *>() << cardToMove, getZone(DeckZone), 0, 0,
                       false, true);
     delete cardToMove;
 
@@ -1255,7 +1289,7 @@ Server_Player::cmdMoveCard(const Command_MoveCard &cmd, ResponseContainer & /*rc
     if (!startPlayer) {
         return Response::RespNameNotFound;
     }
-    Server_CardZone *startZone = startPlayer->getZones().value(nameFromStdString(cmd.start_zone()));
+    Server_CardZone *startZone = startPlayer->getZone(cmd.start_zone());
     if (!startZone) {
         return Response::RespNameNotFound;
     }
@@ -1268,7 +1302,7 @@ Server_Player::cmdMoveCard(const Command_MoveCard &cmd, ResponseContainer & /*rc
     if (!targetPlayer) {
         return Response::RespNameNotFound;
     }
-    Server_CardZone *targetZone = targetPlayer->getZones().value(nameFromStdString(cmd.target_zone()));
+    Server_CardZone *targetZone = targetPlayer->getZone(cmd.target_zone());
     if (!targetZone) {
         return Response::RespNameNotFound;
     }
@@ -1285,6 +1319,55 @@ Server_Player::cmdMoveCard(const Command_MoveCard &cmd, ResponseContainer & /*rc
     return moveCard(ges, startZone, cardsToMove, targetZone, cmd.x(), cmd.y(), true, false, cmd.is_reversed());
 }
 
+Response::ResponseCode Server_Player::cmdMoveTopCardsUntil(const Command_MoveTopCardsUntil &cmd,
+                                                           ResponseContainer & /*rc*/,
+                                                           GameEventStorage &ges)
+{
+    if (spectator) {
+        return Response::RespFunctionNotAllowed;
+    }
+
+    if (!game->getGameStarted()) {
+        return Response::RespGameNotStarted;
+    }
+    if (conceded) {
+        return Response::RespContextError;
+    }
+    if (cmd.number_of_hits() < 1) {
+        return Response::RespContextError;
+    }
+
+    Server_CardZone *deckZone = getZone(DeckZone);
+    Server_CardZone *stackZone = getZone(StackZone);
+    if (!deckZone || !stackZone) {
+        return Response::RespNameNotFound;
+    }
+
+    QSet<QString> matchingNames;
+    for (const auto &cardName : cmd.card_name()) {
+        matchingNames.insert(nameFromStdString(cardName));
+    }
+
+    // The whole dig ends up in the same event container, the client sees every revealed card arrive on the stack at
+    // once instead of asking for them one by one.
+    CardToMove topCard;
+    topCard.set_card_id(0);
+    const QList<const CardToMove *> cardsToMove = {&topCard};
+    int hitsLeft = cmd.number_of_hits();
+    for (auto cardsLeft = deckZone->getCards().size(); hitsLeft > 0 && cardsLeft > 0; --cardsLeft) {
+        const bool hit = matchingNames.contains(deckZone->getCards().first()->getName());
+        Response::ResponseCode resp = moveCard(ges, deckZone, cardsToMove, stackZone, -1, 0);
+        if (resp != Response::RespOk) {
+            return resp;
+        }
+        if (hit) {
+            --hitsLeft;
+        }
+    }
+
+    return Response::RespOk;
+}
+
 Response::ResponseCode
 Server_Player::cmdFlipCard(const Command_FlipCard &cmd, ResponseContainer & /*rc*/, GameEventStorage &ges)
 {
@@ -1299,7 +1382,7 @@ Server_Player::cmdFlipCard(const Command_FlipCard &cmd, ResponseContainer & /*rc
         return Response::RespContextError;
     }
 
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone()));
+    Server_CardZone *zone = getZone(cmd.zone());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -1320,10 +1403,10 @@ Server_Player::cmdFlipCard(const Command_FlipCard &cmd, ResponseContainer & /*rc
     card->setFaceDown(faceDown);
 
     Event_FlipCard event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getNameAtom().toStdString());
     event.set_card_id(card->getId());
     if (!faceDown) {
-        event.set_card_name(card->getName().toStdString());
+        event.set_card_name(card->getNameAtom().toStdString());
         event.set_card_provider_id(card->getProviderId().toStdString());
     }
     event.set_face_down(faceDown);
@@ -1351,7 +1434,7 @@ Server_Player::cmdAttachCard(const Command_AttachCard &cmd, ResponseContainer &
         return Response::RespContextError;
     }
 
-    Server_CardZone *startzone = zones.value(nameFromStdString(cmd.start_zone()));
+    Server_CardZone *startzone = getZone(cmd.start_zone());
     if (!startzone) {
         return Response::RespNameNotFound;
     }
@@ -1374,7 +1457,7 @@ Server_Player::cmdAttachCard(const Command_AttachCard &cmd, ResponseContainer &
         return Response::RespContextError;
     }
     if (targetPlayer) {
-        targetzone = targetPlayer->getZones().value(nameFromStdString(cmd.target_zone()));
+        targetzone = targetPlayer->getZone(cmd.target_zone());
     }
     if (targetzone) {
         // This is currently enough to make sure cards don't get attached to a card that is not on the table.
@@ -1400,29 +1483,17 @@ Server_Player::cmdAttachCard(const Command_AttachCard &cmd, ResponseContainer &
         return Response::RespContextError;
     }
 
-    QMapIterator<int, Server_Player *> playerIterator(game->getPlayers());
-    while (playerIterator.hasNext()) {
-        Server_Player *p = playerIterator.next().value();
-        QList<Server_Arrow *> _arrows = p->getArrows().values();
-        QList<Server_Arrow *> toDelete;
-        for (auto a : _arrows) {
-            auto *tCard = qobject_cast<Server_Card *>(a->getTargetItem());
-            if ((tCard == card) || (a->getStartCard() == card)) {
-                toDelete.append(a);
-            }
-        }
-        for (auto &i : toDelete) {
-            Event_DeleteArrow event;
-            event.set_arrow_id(i->getId());
-            ges.enqueueGameEvent(event, p->getPlayerId());
-            p->deleteArrow(i->getId());
-        }
+    for (const auto &arrow : game->getArrowsTouching(card)) {
+        Event_DeleteArrow event;
+        event.set_arrow_id(arrow.second->getId());
+        ges.enqueueGameEvent(event, arrow.first->getPlayerId());
+        arrow.first->deleteArrow(arrow.second->getId());
     }
 
     if (targetCard) {
         // Unattach all cards attached to the card being attached.
         // Make a copy of the list because its contents change during the loop otherwise.
-        QList<Server_Card *> attachedList = card->getAttachedCards();
+        const Server_Card::AttachedCards attachedList = card->getAttachedCards();
         for (const auto &i : attachedList) {
             i->getZone()->getPlayer()->unattachCard(ges, i);
         }
@@ -1435,9 +1506,10 @@ Server_Player::cmdAttachCard(const Command_AttachCard &cmd, ResponseContainer &
         if (targetzone->isColumnStacked(targetCard->getX(), targetCard->getY())) {
             auto *cardToMove = new CardToMove;
             cardToMove->set_card_id(targetCard->getId());
-            targetPlayer->moveCard(ges, targetzone, QList<const CardToMove *>() << cardToMove, targetzone,
-                                   targetzone->getFreeGridColumn(-2, targetCard->getY(), targetCard->getName(), false),
-                                   targetCard->getY(), targetCard->getFaceDown());
+            targetPlayer->moveCard(
+                ges, targetzone, QList<const CardToMove *>() << cardToMove, targetzone,
+                targetzone->getFreeGridColumn(-2, targetCard->getY(), targetCard->getNameAtom(), false),
+                targetCard->getY(), targetCard->getFaceDown());
             delete cardToMove;
         }
 
@@ -1465,7 +1537,7 @@ Server_Player::cmdCreateToken(const Command_CreateToken &cmd, ResponseContainer
         return Response::RespContextError;
     }
 
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone()));
+    Server_CardZone *zone = getZone(cmd.zone());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -1475,7 +1547,7 @@ Server_Player::cmdCreateToken(const Command_CreateToken &cmd, ResponseContainer
 
     Server_Card *targetCard = nullptr;
     if (cmd.has_target_card_id()) {
-        Server_CardZone *targetZone = zones.value(nameFromStdString(cmd.target_zone()));
+        Server_CardZone *targetZone = getZone(cmd.target_zone());
         if (targetZone) {
             targetCard = targetZone->getCard(cmd.target_card_id());
             if (targetCard && cmd.target_mode() == Command_CreateToken::TRANSFORM_INTO) {
@@ -1507,7 +1579,7 @@ Server_Player::cmdCreateToken(const Command_CreateToken &cmd, ResponseContainer
     const QString cardProviderId = nameFromStdString(cmd.card_provider_id());
     if (zone->hasCoords()) {
         bool dontStackSameName = cmd.face_down();
-        xCoord = zone->getFreeGridColumn(xCoord, yCoord, cardName, dontStackSameName);
+        xCoord = zone->getFreeGridColumn(xCoord, yCoord, StringAtom::find(cardName), dontStackSameName);
     }
     if (xCoord < 0) {
         xCoord = 0;
@@ -1516,7 +1588,7 @@ Server_Player::cmdCreateToken(const Command_CreateToken &cmd, ResponseContainer
         yCoord = 0;
     }
 
-    auto *card = new Server_Card({cardName, cardProviderId}, newCardId(), xCoord, yCoord);
+    auto *card = new (game->getObjectPool()) Server_Card({cardName, cardProviderId}, newCardId(), xCoord, yCoord);
     card->moveToThread(thread());
     // Client should already prevent face-down tokens from having attributes; this just an extra server-side check
     if (!cmd.face_down()) {
@@ -1551,7 +1623,7 @@ Server_Player::cmdCreateToken(const Command_CreateToken &cmd, ResponseContainer
         case Command_CreateToken::TRANSFORM_INTO: {
             // Copy attributes that are not present in the CreateToken event
             Event_SetCardAttr event;
-            event.set_zone_name(card->getZone()->getName().toStdString());
+            event.set_zone_name(card->getZone()->getNameAtom().toStdString());
             event.set_card_id(card->getId());
 
             if (card->getTapped() != targetCard->getTapped()) {
@@ -1575,15 +1647,12 @@ Server_Player::cmdCreateToken(const Command_CreateToken &cmd, ResponseContainer
             }
 
             // Copy counters
-            QMapIterator<int, int> i(targetCard->getCounters());
-            while (i.hasNext()) {
-                i.next();
-
+            for (const auto &counter : targetCard->getCounters()) {
                 Event_SetCardCounter _event;
-                _event.set_zone_name(card->getZone()->getName().toStdString());
+                _event.set_zone_name(card->getZone()->getNameAtom().toStdString());
                 _event.set_card_id(card->getId());
 
-                card->setCounter(i.key(), i.value(), &_event);
+                card->setCounter(counter.first, counter.second, &_event);
                 ges.enqueueGameEvent(_event, playerId);
             }
 
@@ -1605,49 +1674,42 @@ Server_Player::cmdCreateToken(const Command_CreateToken &cmd, ResponseContainer
             }
 
             // Copy Arrows
-            const QList<Server_Player *> &players = game->getPlayers().values();
-            for (auto player : players) {
-                QList<int> changedArrowIds;
-                for (Server_Arrow *arrow : player->getArrows()) {
-                    bool sendGameEvent = false;
-                    const auto *startCard = arrow->getStartCard();
-                    if (startCard == targetCard) {
-                        sendGameEvent = true;
-                        arrow->setStartCard(card);
-                        startCard = card;
-                    }
-                    const auto *targetItem = arrow->getTargetItem();
-                    if (targetItem == targetCard) {
-                        sendGameEvent = true;
-                        arrow->setTargetItem(card);
-                        targetItem = card;
-                    }
-                    if (sendGameEvent) {
-                        Event_CreateArrow _event;
-                        ServerInfo_Arrow *arrowInfo = _event.mutable_arrow_info();
-                        changedArrowIds.append(arrow->getId());
-                        int id = player->newArrowId();
-                        arrow->setId(id);
-                        arrowInfo->set_id(id);
-                        arrowInfo->set_start_player_id(player->getPlayerId());
-                        arrowInfo->set_start_zone(startCard->getZone()->getName().toStdString());
-                        arrowInfo->set_start_card_id(startCard->getId());
-                        const Server_Player *arrowTargetPlayer = qobject_cast<const Server_Player *>(targetItem);
-                        if (arrowTargetPlayer != nullptr) {
-                            arrowInfo->set_target_player_id(arrowTargetPlayer->getPlayerId());
-                        } else {
-                            const Server_Card *arrowTargetCard = qobject_cast<const Server_Card *>(targetItem);
-                            arrowInfo->set_target_player_id(arrowTargetCard->getZone()->getPlayer()->getPlayerId());
-                            arrowInfo->set_target_zone(arrowTargetCard->getZone()->getName().toStdString());
-                            arrowInfo->set_target_card_id(arrowTargetCard->getId());
-                        }
-                        arrowInfo->mutable_arrow_color()->CopyFrom(arrow->getColor());
-                        ges.enqueueGameEvent(_event, player->getPlayerId());
-                    }
+            for (const auto &entry : game->getArrowsTouching(targetCard)) {
+                Server_Player *player = entry.first;
+                Server_Arrow *arrow = entry.second;
+
+                game->unindexArrow(player, arrow);
+                if (arrow->getStartCard() == targetCard) {
+                    arrow->setStartCard(card);
                 }
-                for (int id : changedArrowIds) {
-                    player->updateArrowId(id);
+                if (arrow->getTargetItem() == targetCard) {
+                    arrow->setTargetItem(card);
                 }
+                game->indexArrow(player, arrow);
+                const auto *startCard = arrow->getStartCard();
+                const auto *targetItem = arrow->getTargetItem();
+
+                Event_CreateArrow _event;
+                ServerInfo_Arrow *arrowInfo = _event.mutable_arrow_info();
+                const int oldId = arrow->getId();
+                int id = player->newArrowId();
+                arrow->setId(id);
+                player->updateArrowId(oldId);
+                arrowInfo->set_id(id);
+                arrowInfo->set_start_player_id(player->getPlayerId());
+                arrowInfo->set_start_zone(startCard->getZone()->getNameAtom().toStdString());
+                arrowInfo->set_start_card_id(startCard->getId());
+                const Server_Player *arrowTargetPlayer = qobject_cast<const Server_Player *>(targetItem);
+                if (arrowTargetPlayer != nullptr) {
+                    arrowInfo->set_target_player_id(arrowTargetPlayer->getPlayerId());
+                } else {
+                    const Server_Card *arrowTargetCard = qobject_cast<const Server_Card *>(targetItem);
+                    arrowInfo->set_target_player_id(arrowTargetCard->getZone()->getPlayer()->getPlayerId());
+                    arrowInfo->set_target_zone(arrowTargetCard->getZone()->getNameAtom().toStdString());
+                    arrowInfo->set_target_card_id(arrowTargetCard->getId());
+                }
+                arrowInfo->mutable_arrow_color()->CopyFrom(arrow->getColor());
+                ges.enqueueGameEvent(_event, player->getPlayerId());
             }
 
             targetCard->resetState();
@@ -1684,7 +1746,7 @@ void Server_Player::sendCreateTokenEvents(Server_CardZone *zone,
 
     // Event_CreateToken didn't use to have face_down field; send attribute event afterward for backwards compatibility
     Event_SetCardAttr event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getNameAtom().toStdString());
     event.set_card_id(card->getId());
     event.set_attribute(AttrFaceDown);
     event.set_attr_value("1");
@@ -1711,11 +1773,11 @@ Server_Player::cmdCreateArrow(const Command_CreateArrow &cmd, ResponseContainer
         return Response::RespNameNotFound;
     }
     QString startZoneName = nameFromStdString(cmd.start_zone());
-    Server_CardZone *startZone = startPlayer->getZones().value(startZoneName);
+    Server_CardZone *startZone = startPlayer->getZone(cmd.start_zone());
     bool playerTarget = !cmd.has_target_zone();
     Server_CardZone *targetZone = nullptr;
     if (!playerTarget) {
-        targetZone = targetPlayer->getZones().value(nameFromStdString(cmd.target_zone()));
+        targetZone = targetPlayer->getZone(cmd.target_zone());
     }
     if (!startZone || (!targetZone && !playerTarget)) {
         return Response::RespNameNotFound;
@@ -1745,13 +1807,14 @@ Server_Player::cmdCreateArrow(const Command_CreateArrow &cmd, ResponseContainer
         return Response::RespNameNotFound;
     }
 
-    for (Server_Arrow *temp : arrows) {
-        if ((temp->getStartCard() == startCard) && (temp->getTargetItem() == targetItem)) {
+    for (const auto &temp : game->getArrowsTouching(startCard)) {
+        if ((temp.first == this) && (temp.second->getStartCard() == startCard) &&
+            (temp.second->getTargetItem() == targetItem)) {
             return Response::RespContextError;
         }
     }
 
-    auto arrow = new Server_Arrow(newArrowId(), startCard, targetItem, cmd.arrow_color());
+    auto arrow = new (game->getObjectPool()) Server_Arrow(newArrowId(), startCard, targetItem, cmd.arrow_color());
     addArrow(arrow);
 
     Event_CreateArrow event;
@@ -1828,7 +1891,7 @@ Server_Player::cmdSetCardCounter(const Command_SetCardCounter &cmd, ResponseCont
         return Response::RespContextError;
     }
 
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone()));
+    Server_CardZone *zone = getZone(cmd.zone());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -1842,7 +1905,7 @@ Server_Player::cmdSetCardCounter(const Command_SetCardCounter &cmd, ResponseCont
     }
 
     Event_SetCardCounter event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getNameAtom().toStdString());
     event.set_card_id(card->getId());
     card->setCounter(cmd.counter_id(), cmd.counter_value(), &event);
     ges.enqueueGameEvent(event, playerId);
@@ -1864,7 +1927,7 @@ Server_Player::cmdIncCardCounter(const Command_IncCardCounter &cmd, ResponseCont
         return Response::RespContextError;
     }
 
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone()));
+    Server_CardZone *zone = getZone(cmd.zone());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -1881,7 +1944,7 @@ Server_Player::cmdIncCardCounter(const Command_IncCardCounter &cmd, ResponseCont
     card->setCounter(cmd.counter_id(), newValue);
 
     Event_SetCardCounter event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getNameAtom().toStdString());
     event.set_card_id(card->getId());
     event.set_counter_id(cmd.counter_id());
     event.set_counter_value(newValue);
@@ -1933,8 +1996,8 @@ Server_Player::cmdCreateCounter(const Command_CreateCounter &cmd, ResponseContai
         return Response::RespContextError;
     }
 
-    auto *c = new Server_Counter(newCounterId(), nameFromStdString(cmd.counter_name()), cmd.counter_color(),
-                                 cmd.radius(), cmd.value());
+    auto *c = new (game->getObjectPool()) Server_Counter(newCounterId(), nameFromStdString(cmd.counter_name()),
+                                                         cmd.counter_color(), cmd.radius(), cmd.value());
     addCounter(c);
 
     Event_CreateCounter event;
@@ -2065,7 +2128,7 @@ Server_Player::cmdDumpZone(const Command_DumpZone &cmd, ResponseContainer &rc, G
     if (!otherPlayer) {
         return Response::RespNameNotFound;
     }
-    Server_CardZone *zone = otherPlayer->getZones().value(nameFromStdString(cmd.zone_name()));
+    Server_CardZone *zone = otherPlayer->getZone(cmd.zone_name());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -2078,7 +2141,7 @@ Server_Player::cmdDumpZone(const Command_DumpZone &cmd, ResponseContainer &rc, G
 
     auto *re = new Response_DumpZone;
     ServerInfo_Zone *zoneInfo = re->mutable_zone_info();
-    zoneInfo->set_name(zone->getName().toStdString());
+    zoneInfo->set_name(zone->getNameAtom().toStdString());
     zoneInfo->set_type(zone->getType());
     zoneInfo->set_with_coords(zone->hasCoords());
     zoneInfo->set_card_count(numberCards < cards.size() ? cards.size() : numberCards);
@@ -2105,17 +2168,15 @@ Server_Player::cmdDumpZone(const Command_DumpZone &cmd, ResponseContainer &rc, G
             cardInfo->set_destroy_on_zone_change(card->getDestroyOnZoneChange());
             cardInfo->set_doesnt_untap(card->getDoesntUntap());
 
-            QMapIterator<int, int> cardCounterIterator(card->getCounters());
-            while (cardCounterIterator.hasNext()) {
-                cardCounterIterator.next();
+            for (const auto &counter : card->getCounters()) {
                 ServerInfo_CardCounter *counterInfo = cardInfo->add_counter_list();
-                counterInfo->set_id(cardCounterIterator.key());
-                counterInfo->set_value(cardCounterIterator.value());
+                counterInfo->set_id(counter.first);
+                counterInfo->set_value(counter.second);
             }
 
             if (card->getParentCard()) {
                 cardInfo->set_attach_player_id(card->getParentCard()->getZone()->getPlayer()->getPlayerId());
-                cardInfo->set_attach_zone(card->getParentCard()->getZone()->getName().toStdString());
+                cardInfo->set_attach_zone(card->getParentCard()->getZone()->getNameAtom().toStdString());
                 cardInfo->set_attach_card_id(card->getParentCard()->getId());
             }
         }
@@ -2125,11 +2186,19 @@ Server_Player::cmdDumpZone(const Command_DumpZone &cmd, ResponseContainer &rc, G
 
         Event_DumpZone event;
         event.set_zone_owner_id(otherPlayer->getPlayerId());
-        event.set_zone_name(zone->getName().toStdString());
+        event.set_zone_name(zone->getNameAtom().toStdString());
         event.set_number_cards(numberCards);
         event.set_is_reversed(cmd.is_reversed());
         ges.enqueueGameEvent(event, playerId);
     }
+    if (clientSupportsFeature(cardNameDictionaryFeature)) {
+        // a library repeats the same few names many times over
+        CardNameDictionary responseNames;
+        responseNames.encode(*zoneInfo);
+        Event_CardNames names;
+        if (responseNames.takeNewNames(names))
+            re->mutable_card_names()->Swap(names.mutable_names());
+    }
     rc.setResponseExtension(re);
     return Response::RespOk;
 }
@@ -2153,7 +2222,7 @@ Server_Player::cmdRevealCards(const Command_RevealCards &cmd, ResponseContainer
         if (!otherPlayer)
             return Response::RespNameNotFound;
     }
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone_name()));
+    Server_CardZone *zone = getZone(cmd.zone_name());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -2192,7 +2261,7 @@ Server_Player::cmdRevealCards(const Command_RevealCards &cmd, ResponseContainer
 
     Event_RevealCards eventOthers;
     eventOthers.set_grant_write_access(cmd.grant_write_access());
-    eventOthers.set_zone_name(zone->getName().toStdString());
+    eventOthers.set_zone_name(zone->getNameAtom().toStdString());
     eventOthers.set_number_of_cards(cardsToReveal.size());
     for (auto cardId : cmd.card_id()) {
         eventOthers.add_card_id(cardId);
@@ -2208,7 +2277,7 @@ Server_Player::cmdRevealCards(const Command_RevealCards &cmd, ResponseContainer
 
         cardInfo->set_id(card->getId());
         cardInfo->set_provider_id(card->getProviderId().toStdString());
-        cardInfo->set_name(card->getName().toStdString());
+        cardInfo->set_name(card->getNameAtom().toStdString());
         cardInfo->set_x(card->getX());
         cardInfo->set_y(card->getY());
         cardInfo->set_face_down(card->getFaceDown());
@@ -2220,17 +2289,15 @@ Server_Player::cmdRevealCards(const Command_RevealCards &cmd, ResponseContainer
         cardInfo->set_destroy_on_zone_change(card->getDestroyOnZoneChange());
         cardInfo->set_doesnt_untap(card->getDoesntUntap());
 
-        QMapIterator<int, int> cardCounterIterator(card->getCounters());
-        while (cardCounterIterator.hasNext()) {
-            cardCounterIterator.next();
+        for (const auto &counter : card->getCounters()) {
             ServerInfo_CardCounter *counterInfo = cardInfo->add_counter_list();
-            counterInfo->set_id(cardCounterIterator.key());
-            counterInfo->set_value(cardCounterIterator.value());
+            counterInfo->set_id(counter.first);
+            counterInfo->set_value(counter.second);
         }
 
         if (card->getParentCard()) {
             cardInfo->set_attach_player_id(card->getParentCard()->getZone()->getPlayer()->getPlayerId());
-            cardInfo->set_attach_zone(card->getParentCard()->getZone()->getName().toStdString());
+            cardInfo->set_attach_zone(card->getParentCard()->getZone()->getNameAtom().toStdString());
             cardInfo->set_attach_card_id(card->getParentCard()->getId());
         }
     }
@@ -2264,7 +2331,7 @@ Response::ResponseCode Server_Player::cmdChangeZoneProperties(const Command_Chan
                                                               ResponseContainer & /* rc */,
                                                               GameEventStorage &ges)
 {
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone_name()));
+    Server_CardZone *zone = getZone(cmd.zone_name());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -2408,6 +2475,9 @@ Server_Player::processGameCommand(const GameCommand &command, ResponseContainer
         case GameCommand::MOVE_CARD:
             return cmdMoveCard(command.GetExtension(Command_MoveCard::ext), rc, ges);
             break;
+        case GameCommand::MOVE_TOP_CARDS_UNTIL:
+            return cmdMoveTopCardsUntil(command.GetExtension(Command_MoveTopCardsUntil::ext), rc, ges);
+            break;
         case GameCommand::SET_SIDEBOARD_PLAN:
             return cmdSetSideboardPlan(command.GetExtension(Command_SetSideboardPlan::ext), rc, ges);
             break;
@@ -2435,21 +2505,123 @@ Server_Player::processGameCommand(const GameCommand &command, ResponseContainer
 }
 
 void Server_Player::sendGameEvent(const GameEventContainer &cont)
+{
+    sendGameEvent(cont, QByteArray());
+}
+
+void Server_Player::sendGameEvent(const GameEventContainer &cont, const QByteArray &serializedEvent)
 {
     QMutexLocker locker(&playerMutex);
 
-    if (userInterface) {
-        userInterface->sendProtocolItem(cont);
+    if (cardNamesEnabled && CardNameDictionary::carriesCardNames(cont)) {
+        // the shared serialization has the names spelled out, this client gets its own copy
+        GameEventContainer encoded(cont);
+        cardNames.encode(encoded);
+        sendNewCardNames(cont.game_id());
+        deliverGameEvent(encoded, QByteArray());
+    } else {
+        deliverGameEvent(cont, serializedEvent);
+    }
+}
+
+void Server_Player::deliverGameEvent(const GameEventContainer &cont, QByteArray serializedEvent)
+{
+    // logged while disconnected too, that's what the client is sent when it resumes
+    if (resumeLog.isEnabled()) {
+        if (serializedEvent.isEmpty())
+            serializedEvent = Server_AbstractUserInterface::serializeGameEventContainer(cont);
+        serializedEvent = resumeLog.append(serializedEvent);
     }
+
+    if (!userInterface)
+        return;
+    game->getActivity().record(game->getRoom()->getServer()->getPingClockTicks(), 0, 0, serializedEvent.size());
+    if (serializedEvent.isEmpty())
+        userInterface->sendProtocolItem(cont);
+    else
+        userInterface->sendSerializedProtocolItem(cont, serializedEvent);
+}
+
+void Server_Player::sendNewCardNames(int gameId)
+{
+    Event_CardNames event;
+    if (!cardNames.takeNewNames(event))
+        return;
+
+    GameEventContainer cont;
+    cont.set_game_id(gameId);
+    cont.add_event_list()->MutableExtension(Event_CardNames::ext)->Swap(&event);
+    deliverGameEvent(cont, QByteArray());
+}
+
+GameEventContainer *Server_Player::encodeCardNames(GameEventContainer &cont)
+{
+    QMutexLocker locker(&playerMutex);
+
+    if (!cardNamesEnabled)
+        return nullptr;
+    cardNames.encode(cont);
+    Event_CardNames event;
+    if (!cardNames.takeNewNames(event))
+        return nullptr;
+    return game->prepareGameEvent(event, -1);
+}
+
+bool Server_Player::clientSupportsFeature(const QString &featureName)
+{
+    QMutexLocker locker(&playerMutex);
+
+    return userInterface && userInterface->clientSupportsFeature(featureName);
 }
 
 void Server_Player::setUserInterface(Server_AbstractUserInterface *_userInterface)
 {
     playerMutex.lock();
     userInterface = _userInterface;
+    // the client starts over with the game state it is sent on joining
+    cardNamesEnabled = _userInterface && _userInterface->clientSupportsFeature(cardNameDictionaryFeature);
+    // a disconnected client may still resume with what it knows, see resumeUserInterface()
+    if (_userInterface)
+        cardNames = CardNameDictionary();
     playerMutex.unlock();
 
-    pingTime = _userInterface ? 0 : -1;
+    announceConnectionState(_userInterface != nullptr);
+}
+
+bool Server_Player::resumeUserInterface(Server_AbstractUserInterface *_userInterface, quint64 lastSequence)
+{
+    QMutexLocker locker(&playerMutex);
+
+    QList<QByteArray> missedMessages;
+    if (!resumeLog.getMessagesAfter(lastSequence, missedMessages))
+        return false;
+    // the containers sent before may refer to the card names of the previous connection
+    const bool cardNamesSupported = _userInterface->clientSupportsFeature(cardNameDictionaryFeature);
+    if (cardNames.size() > 0 && !cardNamesSupported)
+        return false;
+
+    userInterface = _userInterface;
+    cardNamesEnabled = cardNamesSupported;
+    // sent right away, so that they come before anything else of the game
+    for (const QByteArray &message : missedMessages)
+        userInterface->sendSerializedServerMessage(message);
+    locker.unlock();
+
+    announceConnectionState(true);
+    return true;
+}
+
+bool Server_Player::takeOverUserInterface(Server_AbstractUserInterface *_userInterface)
+{
+    playerMutex.lock();
+    const quint64 lastSequence = resumeLog.getLastSequence();
+    playerMutex.unlock();
+    return resumeUserInterface(_userInterface, lastSequence);
+}
+
+void Server_Player::announceConnectionState(bool connected)
+{
+    pingTime = connected ? 0 : -1;
 
     Event_PlayerPropertiesChanged event;
     event.mutable_player_properties()->set_ping_seconds(pingTime);
@@ -2493,3 +2665,188 @@ void Server_Player::getInfo(ServerInfo_Player *info,
         zone->getInfo(info->add_zone_list(), playerWhosAsking, omniscient);
     }
 }
+
+void Server_Player::getHibernationInfo(GameHibernation_Player &info) const
+{
+    info.set_player_id(playerId);
+    for (Server_CardZone *zone : zones) {
+        GameHibernation_Zone *zoneInfo = info.add_zone_list();
+        ServerInfo_Zone *properties = zoneInfo->mutable_info();
+        properties->set_name(zone->getNameAtom().toStdString());
+        properties->set_type(zone->getType());
+        properties->set_with_coords(zone->hasCoords());
+        properties->set_always_reveal_top_card(zone->getAlwaysRevealTopCard());
+        properties->set_always_look_at_top_card(zone->getAlwaysLookAtTopCard());
+        zoneInfo->set_cards_being_looked_at(zone->getCardsBeingLookedAt());
+        for (const int writer : zone->getPlayersWithWritePermission())
+            zoneInfo->add_players_with_write_permission(writer);
+
+        for (Server_Card *card : zone->getCards()) {
+            GameHibernation_Card *cardInfo = zoneInfo->add_card_list();
+            card->getInfo(cardInfo->mutable_info());
+            cardInfo->mutable_info()->set_name(card->getNameAtom().toStdString());
+            if (Server_Card *stashedCard = card->getStashedCard()) {
+                stashedCard->getInfo(cardInfo->mutable_stashed_card());
+                cardInfo->mutable_stashed_card()->set_name(stashedCard->getNameAtom().toStdString());
+            }
+        }
+    }
+    for (Server_Counter *counter : counters)
+        counter->getInfo(info.add_counter_list());
+    for (Server_Arrow *arrow : arrows)
+        arrow->getInfo(info.add_arrow_list());
+    for (const int cardId : lastDrawList)
+        info.add_last_draw_list(cardId);
+    info.set_next_card_id(nextCardId);
+    info.set_next_counter_id(nextCounterId);
+    info.set_next_arrow_id(nextArrowId);
+}
+
+static Server_Card *wakeUpCard(GameObjectPool *pool, const ServerInfo_Card &info, Server_CardZone *zone)
+{
+    auto *card = new (pool) Server_Card(StringAtom(QString::fromStdString(info.name())),
+                                        StringAtom(QString::fromStdString(info.provider_id())), info.id(), info.x(),
+                                        info.y(), zone);
+    card->setFaceDown(info.face_down());
+    card->setTapped(info.tapped());
+    card->setAttacking(info.attacking());
+    card->setColor(QString::fromStdString(info.color()));
+    card->setPT(QString::fromStdString(info.pt()));
+    card->setAnnotation(QString::fromStdString(info.annotation()));
+    card->setDestroyOnZoneChange(info.destroy_on_zone_change());
+    card->setDoesntUntap(info.doesnt_untap());
+    for (const ServerInfo_CardCounter &counter : info.counter_list())
+        card->setCounter(counter.id(), counter.value());
+    return card;
+}
+
+// hidden zones look their cards up by position, the ids of hibernated cards are the real ones
+static Server_Card *findCard(Server_Game *game, int playerId, const std::string &zoneName, int cardId)
+{
+    Server_Player *player = game->getPlayers().value(playerId);
+    Server_CardZone *zone = player ? player->getZone(zoneName) : nullptr;
+    if (!zone)
+        return nullptr;
+    for (Server_Card *card : zone->getCards())
+        if (card->getId() == cardId)
+            return card;
+    return nullptr;
+}
+
+void Server_Player::wakeUp(const GameHibernation_Player &info)
+{
+    GameObjectPool *pool = game->getObjectPool();
+    for (const GameHibernation_Zone &zoneInfo : info.zone_list()) {
+        const ServerInfo_Zone &properties = zoneInfo.info();
+        auto *zone = new Server_CardZone(this, QString::fromStdString(properties.name()), properties.with_coords(),
+                                         properties.type());
+        zone->setAlwaysRevealTopCard(properties.always_reveal_top_card());
+        zone->setAlwaysLookAtTopCard(properties.always_look_at_top_card());
+        addZone(zone);
+
+        for (const GameHibernation_Card &cardInfo : zoneInfo.card_list()) {
+            Server_Card *card = wakeUpCard(pool, cardInfo.info(), zone);
+            if (cardInfo.has_stashed_card())
+                card->setStashedCard(wakeUpCard(pool, cardInfo.stashed_card(), nullptr));
+            // appended in order where there are no coordinates
+            zone->insertCard(card, zone->hasCoords() ? card->getX() : -1, card->getY());
+        }
+        // after the cards, inserting them resets it
+        zone->setCardsBeingLookedAt(zoneInfo.cards_being_looked_at());
+        for (const int writer : zoneInfo.players_with_write_permission())
+            zone->addWritePermission(writer);
+    }
+    for (const ServerInfo_Counter &counterInfo : info.counter_list())
+        addCounter(new (pool) Server_Counter(counterInfo.id(), QString::fromStdString(counterInfo.name()),
+                                             counterInfo.counter_color(), counterInfo.radius(), counterInfo.count()));
+    for (const int cardId : info.last_draw_list())
+        lastDrawList.append(cardId);
+    nextCardId = info.next_card_id();
+    nextCounterId = info.next_counter_id();
+    nextArrowId = info.next_arrow_id();
+}
+
+void Server_Player::wakeUpAttachmentsAndArrows(const GameHibernation_Player &info)
+{
+    // cards and players that left since the game went to sleep are skipped
+    for (const GameHibernation_Zone &zoneInfo : info.zone_list()) {
+        for (const GameHibernation_Card &cardInfo : zoneInfo.card_list()) {
+            const ServerInfo_Card &card = cardInfo.info();
+            if (card.attach_card_id() == -1)
+                continue;
+            Server_Card *parentCard =
+                findCard(game, card.attach_player_id(), card.attach_zone(), card.attach_card_id());
+            Server_Card *attachedCard = findCard(game, playerId, zoneInfo.info().name(), card.id());
+            if (parentCard && attachedCard)
+                attachedCard->setParentCard(parentCard);
+        }
+    }
+
+    for (const ServerInfo_Arrow &arrowInfo : info.arrow_list()) {
+        Server_Card *startCard =
+            findCard(game, arrowInfo.start_player_id(), arrowInfo.start_zone(), arrowInfo.start_card_id());
+        Server_ArrowTarget *targetItem;
+        if (arrowInfo.has_target_zone())
+            targetItem =
+                findCard(game, arrowInfo.target_player_id(), arrowInfo.target_zone(), arrowInfo.target_card_id());
+        else
+            targetItem = game->getPlayers().value(arrowInfo.target_player_id());
+        if (startCard && targetItem)
+            addArrow(new (game->getObjectPool())
+                         Server_Arrow(arrowInfo.id(), startCard, targetItem, arrowInfo.arrow_color()));
+    }
+    nextArrowId = qMax(nextArrowId, info.next_arrow_id());
+}
+
+void Server_Player::getMigrationInfo(IslGameMigration_Player &info) const
+{
+    ServerInfo_PlayerProperties *properties = info.mutable_properties();
+    properties->set_player_id(playerId);
+    properties->mutable_user_info()->CopyFrom(*userInfo);
+    // the users connected here have no server id of their own
+    if (!userInfo->has_server_id())
+        properties->mutable_user_info()->set_server_id(game->getRoom()->getServer()->getServerID());
+    properties->set_spectator(spectator);
+    properties->set_judge(judge);
+    properties->set_conceded(conceded);
+    properties->set_ready_start(readyStart);
+    properties->set_sideboard_locked(sideboardLocked);
+    properties->set_ping_seconds(pingTime);
+    if (deck)
+        info.set_deck_list(deck->writeToString_Native().toStdString());
+}
+
+void Server_Player::restoreMigrationInfo(const IslGameMigration_Player &info)
+{
+    const ServerInfo_PlayerProperties &properties = info.properties();
+    conceded = properties.conceded();
+    readyStart = properties.ready_start();
+    sideboardLocked = properties.sideboard_locked();
+    pingTime = userInterface ? properties.ping_seconds() : -1;
+    if (info.has_deck_list())
+        deck = game->getRoom()->getServer()->getDeckListCache().load(QString::fromStdString(info.deck_list()));
+}
+
+void Server_Player::getHandoffInfo(HandoffGame_Player &info) const
+{
+    QMutexLocker locker(&playerMutex);
+    info.set_player_id(playerId);
+    cardNames.getSentNames(*info.mutable_card_names());
+    info.set_resume_sequence(resumeLog.getLastSequence());
+}
+
+void Server_Player::restoreHandoffInfo(const HandoffGame_Player &info)
+{
+    QMutexLocker locker(&playerMutex);
+    cardNames.restoreSentNames(info.card_names());
+    resumeLog.restart(info.resume_sequence());
+}
+
+void Server_Player::handOver()
+{
+    QMutexLocker locker(&playerMutex);
+    if (userInterface) {
+        userInterface->playerAddedToGame(game->getGameId(), game->getRoom()->getId(), playerId);
+        userInterface = nullptr;
+    }
+}
@@ -1,8 +1,10 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+#include "card_name_dictionary.h"
 #include "pb/card_attributes.pb.h"
 #include "pb/response.pb.h"
+#include "resume_log.h"
 #include "server_arrowtarget.h"
 #include "serverinfo_user_container.h"
 
@@ -10,6 +12,8 @@
 #include <QMap>
 #include <QMutex>
 #include <QString>
+#include <array>
+#include <string>
 
 class DeckList;
 class Server_Game;
@@ -25,6 +29,9 @@ class CommandContainer;
 class CardToMove;
 class GameEventContainer;
 class GameEventStorage;
+class GameHibernation_Player;
+class HandoffGame_Player;
+class IslGameMigration_Player;
 class ResponseContainer;
 class GameCommand;
 
@@ -58,6 +65,7 @@ class Command_DumpZone;
 class Command_RevealCards;
 class Command_ReverseTurn;
 class Command_MoveCard;
+class Command_MoveTopCardsUntil;
 class Command_SetSideboardPlan;
 class Command_DeckSelect;
 class Command_SetSideboardLock;
@@ -66,12 +74,31 @@ class Command_ChangeZoneProperties;
 class Server_Player : public Server_ArrowTarget, public ServerInfo_User_Container
 {
     Q_OBJECT
+public:
+    enum StandardZone
+    {
+        DeckZone,
+        SideboardZone,
+        TableZone,
+        HandZone,
+        StackZone,
+        GraveZone,
+        ExileZone,
+        NoStandardZone
+    };
+    /**
+     * The standard zone of that name, compared as it comes in the protocol, or NoStandardZone for any other name.
+     */
+    static StandardZone standardZone(const std::string &zoneName);
+
 private:
     class MoveCardCompareFunctor;
     Server_Game *game;
     Server_AbstractUserInterface *userInterface;
     DeckList *deck;
     QMap<QString, Server_CardZone *> zones;
+    // the zones setupZones creates, so that commands find them without a string lookup
+    std::array<Server_CardZone *, NoStandardZone> standardZones;
     QMap<int, Server_Counter *> counters;
     QMap<int, Server_Arrow *> arrows;
     QList<int> lastDrawList;
@@ -80,9 +107,19 @@ private:
     bool spectator;
     bool judge;
     int nextCardId;
+    int nextCounterId;
+    int nextArrowId;
     bool readyStart;
     bool conceded;
     bool sideboardLocked;
+    // of the client with the "card_name_dictionary" feature, under playerMutex
+    bool cardNamesEnabled;
+    CardNameDictionary cardNames;
+    // of the players that keep their seat while disconnected, under playerMutex
+    ResumeLog resumeLog;
+    void sendNewCardNames(int gameId);
+    void deliverGameEvent(const GameEventContainer &cont, QByteArray serializedEvent);
+    void announceConnectionState(bool connected);
     void revealTopCardIfNeeded(Server_CardZone *zone, GameEventStorage &ges);
     void sendCreateTokenEvents(Server_CardZone *zone, Server_Card *card, int xCoord, int yCoord, GameEventStorage &ges);
 
@@ -96,11 +133,23 @@ public:
                   Server_AbstractUserInterface *_handler);
     ~Server_Player() override;
     void prepareDestroy();
+    // any thread, without playerMutex
+    qint64 getResumeLogBytes() const
+    {
+        return resumeLog.getBytes();
+    }
     Server_AbstractUserInterface *getUserInterface() const
     {
         return userInterface;
     }
     void setUserInterface(Server_AbstractUserInterface *_userInterface);
+    /**
+     * Hands the game back to a reconnected client that already got the containers up to lastSequence, and sends it
+     * those it missed. False if they are no longer all kept, then the client has to join the game again.
+     */
+    bool resumeUserInterface(Server_AbstractUserInterface *_userInterface, quint64 lastSequence);
+    // hands the game to a session carried over by a hot restart, which got everything sent so far
+    bool takeOverUserInterface(Server_AbstractUserInterface *_userInterface);
     void disconnectClient();
 
     bool getReadyStart() const
@@ -140,6 +189,14 @@ public:
     {
         return zones;
     }
+    Server_CardZone *getZone(StandardZone zone) const
+    {
+        return standardZones[zone];
+    }
+    /**
+     * The zone of a name from the protocol, only other names than the standard ones are looked up in zones.
+     */
+    Server_CardZone *getZone(const std::string &zoneName) const;
     const QMap<int, Server_Counter *> &getCounters() const
     {
         return counters;
@@ -160,8 +217,8 @@ public:
     void getProperties(ServerInfo_PlayerProperties &result, bool withUserInfo);
 
     int newCardId();
-    int newCounterId() const;
-    int newArrowId() const;
+    int newCounterId();
+    int newArrowId();
 
     void addZone(Server_CardZone *zone);
     void addArrow(Server_Arrow *arrow);
@@ -210,6 +267,8 @@ public:
     Response::ResponseCode cmdDrawCards(const Command_DrawCards &cmd, ResponseContainer &rc, GameEventStorage &ges);
     Response::ResponseCode cmdUndoDraw(const Command_UndoDraw &cmd, ResponseContainer &rc, GameEventStorage &ges);
     Response::ResponseCode cmdMoveCard(const Command_MoveCard &cmd, ResponseContainer &rc, GameEventStorage &ges);
+    Response::ResponseCode
+    cmdMoveTopCardsUntil(const Command_MoveTopCardsUntil &cmd, ResponseContainer &rc, GameEventStorage &ges);
     Response::ResponseCode cmdFlipCard(const Command_FlipCard &cmd, ResponseContainer &rc, GameEventStorage &ges);
     Response::ResponseCode cmdAttachCard(const Command_AttachCard &cmd, ResponseContainer &rc, GameEventStorage &ges);
     Response::ResponseCode cmdCreateToken(const Command_CreateToken &cmd, ResponseContainer &rc, GameEventStorage &ges);
@@ -237,8 +296,45 @@ public:
 
     Response::ResponseCode processGameCommand(const GameCommand &command, ResponseContainer &rc, GameEventStorage &ges);
     void sendGameEvent(const GameEventContainer &event);
+    void sendGameEvent(const GameEventContainer &event, const QByteArray &serializedEvent);
+    bool clientSupportsFeature(const QString &featureName);
+    /**
+     * Replaces the card names of the container by references into the dictionary of the client, if it has the
+     * "card_name_dictionary" feature. Returns the container defining the names the client doesn't know yet, to be
+     * sent ahead, or nullptr.
+     */
+    GameEventContainer *encodeCardNames(GameEventContainer &cont);
 
     void getInfo(ServerInfo_Player *info, Server_Player *playerWhosAsking, bool omniscient, bool withUserInfo);
+
+    /**
+     * Writes the zones, counters and arrows of the player to info, see Server_Game::hibernate().
+     */
+    void getHibernationInfo(GameHibernation_Player &info) const;
+    /**
+     * Recreates what hibernate() wrote, in two steps: the cards first, then the attachments and arrows once the
+     * cards of all players are back.
+     */
+    void wakeUp(const GameHibernation_Player &info);
+    void wakeUpAttachmentsAndArrows(const GameHibernation_Player &info);
+
+    /**
+     * Writes what the server taking over the game needs of a player that didn't start playing yet, see
+     * Server_Game::migrate(), and restores it there.
+     */
+    void getMigrationInfo(IslGameMigration_Player &info) const;
+    void restoreMigrationInfo(const IslGameMigration_Player &info);
+    /**
+     * Lets the user send the commands for the game to its new server and lets go of the user, without telling the
+     * other players.
+     */
+    void handOver();
+    /**
+     * Writes what the client of the player was sent of the card name dictionary and the resume log, for the process
+     * replacing the server on a hot restart, see Server_Game::getHandoffInfo(), and restores it there.
+     */
+    void getHandoffInfo(HandoffGame_Player &info) const;
+    void restoreHandoffInfo(const HandoffGame_Player &info);
 };
 
 #endif
@@ -0,0 +1,141 @@
+#include "server_presence.h"
+
+#include "pb/event_user_joined.pb.h"
+#include "pb/event_user_left.pb.h"
+#include "pb/server_message.pb.h"
+#include "pb/session_event.pb.h"
+#include "server.h"
+#include "server_protocolhandler.h"
+
+#include <QMetaObject>
+#include <QReadLocker>
+#include <utility>
+
+ServerPresence::ServerPresence(Server *_server) : QObject(_server), server(_server), flushQueued(false)
+{
+}
+
+void ServerPresence::addListener(Server_ProtocolHandler *listener)
+{
+    QMutexLocker locker(&mutex);
+    listeners.insert(listener);
+}
+
+void ServerPresence::removeClient(Server_ProtocolHandler *client)
+{
+    QMutexLocker locker(&mutex);
+    listeners.remove(client);
+    for (const QString &buddy : buddiesByClient.take(client)) {
+        auto entry = clientsByBuddy.find(buddy);
+        if (entry == clientsByBuddy.end())
+            continue;
+        entry->remove(client);
+        if (entry->isEmpty())
+            clientsByBuddy.erase(entry);
+    }
+}
+
+void ServerPresence::setBuddies(Server_ProtocolHandler *client, const QStringList &buddies)
+{
+    QMutexLocker locker(&mutex);
+    QSet<QString> &clientBuddies = buddiesByClient[client];
+    for (const QString &buddy : buddies) {
+        clientBuddies.insert(buddy);
+        clientsByBuddy[buddy].insert(client);
+    }
+}
+
+QStringList ServerPresence::getBuddies(Server_ProtocolHandler *client) const
+{
+    QMutexLocker locker(&mutex);
+    return buddiesByClient.value(client).values();
+}
+
+void ServerPresence::buddyAdded(Server_ProtocolHandler *client, const QString &buddy)
+{
+    QMutexLocker locker(&mutex);
+    buddiesByClient[client].insert(buddy);
+    clientsByBuddy[buddy].insert(client);
+}
+
+void ServerPresence::buddyRemoved(Server_ProtocolHandler *client, const QString &buddy)
+{
+    QMutexLocker locker(&mutex);
+    auto clientBuddies = buddiesByClient.find(client);
+    if (clientBuddies != buddiesByClient.end())
+        clientBuddies->remove(buddy);
+    auto entry = clientsByBuddy.find(buddy);
+    if (entry != clientsByBuddy.end()) {
+        entry->remove(client);
+        if (entry->isEmpty())
+            clientsByBuddy.erase(entry);
+    }
+}
+
+void ServerPresence::userJoined(const ServerInfo_User &userInfo)
+{
+    Event_UserJoined event;
+    event.mutable_user_info()->CopyFrom(userInfo);
+    queueChange(QString::fromStdString(userInfo.name()), event);
+}
+
+void ServerPresence::userLeft(const QString &userName)
+{
+    Event_UserLeft event;
+    event.set_name(userName.toStdString());
+    queueChange(userName, event);
+}
+
+int ServerPresence::getListenerCount() const
+{
+    QMutexLocker locker(&mutex);
+    return listeners.size();
+}
+
+void ServerPresence::queueChange(const QString &userName, const ::google::protobuf::Message &event)
+{
+    SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
+    ServerMessage message;
+    message.set_message_type(ServerMessage::SESSION_EVENT);
+    message.mutable_session_event()->CopyFrom(*se);
+    delete se;
+    const QByteArray serializedMessage = Server_AbstractUserInterface::serializeServerMessage(message);
+
+    QMutexLocker locker(&mutex);
+    pendingChanges.append({userName, serializedMessage});
+    if (!flushQueued) {
+        flushQueued = true;
+        // every change queued until the server's thread gets to it is delivered along
+        QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+    }
+}
+
+void ServerPresence::flush()
+{
+    // a client is only removed with clientsLock locked for writing, so the recipients stay alive while sent to
+    QReadLocker clientsLocker(&server->clientsLock);
+
+    mutex.lock();
+    flushQueued = false;
+    const QList<Change> changes = std::exchange(pendingChanges, {});
+    QList<QList<Server_ProtocolHandler *>> recipients;
+    recipients.reserve(changes.size());
+    if (server->getBuddyOnlyPresenceEnabled()) {
+        for (const Change &change : changes) {
+            QList<Server_ProtocolHandler *> buddyListeners;
+            for (Server_ProtocolHandler *client : clientsByBuddy.value(change.userName))
+                if (listeners.contains(client))
+                    buddyListeners.append(client);
+            recipients.append(buddyListeners);
+        }
+    } else {
+        const QList<Server_ProtocolHandler *> allListeners = listeners.values();
+        for (int i = 0; i < changes.size(); ++i)
+            recipients.append(allListeners);
+    }
+    mutex.unlock();
+
+    for (int i = 0; i < changes.size(); ++i)
+        for (Server_ProtocolHandler *client : recipients.at(i))
+            client->sendSerializedServerMessage(changes.at(i).serializedMessage);
+}
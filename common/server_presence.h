@@ -0,0 +1,81 @@
+#ifndef SERVER_PRESENCE_H
+#define SERVER_PRESENCE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+namespace google
+{
+namespace protobuf
+{
+class Message;
+}
+} // namespace google
+
+class Server;
+class Server_ProtocolHandler;
+class ServerInfo_User;
+
+/**
+ * Tells the clients listening to the user list, those that sent Command_ListUsers, about the users joining and
+ * leaving the server.
+ *
+ * Logins and disconnects only queue their Event_UserJoined or Event_UserLeft. The queue is delivered from the
+ * server's thread, with every event serialized once and clientsLock only held for reading, so a burst of logins
+ * costs one walk over the listeners instead of one per login under the write lock.
+ *
+ * When Server::getBuddyOnlyPresenceEnabled() is set, a listener only hears about the users in its buddy list; the
+ * users it shares a room with already come and go through the events of the room.
+ *
+ * Locking order: clientsLock before the lock of the presence.
+ */
+class ServerPresence : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ServerPresence(Server *_server);
+
+    void addListener(Server_ProtocolHandler *listener);
+    // drops everything known about the client, call this with clientsLock locked for writing
+    void removeClient(Server_ProtocolHandler *client);
+
+    void setBuddies(Server_ProtocolHandler *client, const QStringList &buddies);
+    QStringList getBuddies(Server_ProtocolHandler *client) const;
+    void buddyAdded(Server_ProtocolHandler *client, const QString &buddy);
+    void buddyRemoved(Server_ProtocolHandler *client, const QString &buddy);
+
+    void userJoined(const ServerInfo_User &userInfo);
+    void userLeft(const QString &userName);
+
+    int getListenerCount() const;
+
+private slots:
+    void flush();
+
+private:
+    struct Change
+    {
+        QString userName;
+        // the whole ServerMessage, see Server_AbstractUserInterface::sendSerializedServerMessage()
+        QByteArray serializedMessage;
+    };
+
+    Server *server;
+    mutable QMutex mutex;
+    QSet<Server_ProtocolHandler *> listeners;
+    // who has a user in their buddy list, and the other way round to forget a client
+    QHash<QString, QSet<Server_ProtocolHandler *>> clientsByBuddy;
+    QHash<Server_ProtocolHandler *, QSet<QString>> buddiesByClient;
+    QList<Change> pendingChanges;
+    bool flushQueued;
+
+    void queueChange(const QString &userName, const ::google::protobuf::Message &event);
+};
+
+#endif
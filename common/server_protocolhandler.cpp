@@ -1,7 +1,9 @@
 #include "server_protocolhandler.h"
 
-#include "debug_pb_message.h"
+#include "avatar_hash.h"
+#include "command_trace.h"
 #include "featureset.h"
+#include "game_executor.h"
 #include "get_pb_extension.h"
 #include "pb/commands.pb.h"
 #include "pb/event_game_joined.pb.h"
@@ -11,32 +13,53 @@
 #include "pb/event_server_message.pb.h"
 #include "pb/event_user_message.pb.h"
 #include "pb/response.pb.h"
+#include "pb/response_filtered_games.pb.h"
+#include "pb/response_get_avatar.pb.h"
 #include "pb/response_get_games_of_user.pb.h"
 #include "pb/response_get_user_info.pb.h"
 #include "pb/response_join_room.pb.h"
 #include "pb/response_list_users.pb.h"
 #include "pb/response_login.pb.h"
+#include "pb/response_room_interests.pb.h"
+#include "pb/server_handoff.pb.h"
 #include "pb/serverinfo_user.pb.h"
+#include "serialized_message.h"
 #include "server_database_interface.h"
 #include "server_game.h"
 #include "server_player.h"
+#include "server_presence.h"
 #include "server_room.h"
+#include "timeline_trace.h"
 #include "trice_limits.h"
 
 #include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QTimer>
 #include <QtMath>
+#include <algorithm>
+#include <bitset>
+#include <climits>
+#include <optional>
 #include <google/protobuf/descriptor.h>
 
+// the game commands that can be white listed from the flood protection, from the first game command on
+static const int antifloodWhiteListSize = 128;
+
 Server_ProtocolHandler::Server_ProtocolHandler(Server *_server,
                                                Server_DatabaseInterface *_databaseInterface,
                                                QObject *parent)
     : QObject(parent), Server_AbstractUserInterface(_server), deleted(false), databaseInterface(_databaseInterface),
       authState(NotLoggedIn), usingRealPassword(false), acceptsUserListChanges(false), acceptsRoomListChanges(false),
-      idleClientWarningSent(false), timeRunning(0), lastDataReceived(0), lastActionReceived(0)
-
+      idleClientWarningSent(false), lastDataReceived(_server->getPingClockTicks()),
+      lastActionReceived(lastDataReceived), rateWindowTick(lastDataReceived)
 {
-    connect(server, &Server::pingClockTimeout, this, &Server_ProtocolHandler::pingClockTimeout);
+    // Instead of checking every client on each ping clock tick, each client sleeps until its earliest
+    // deadline. The first one is armed once the handler has been moved to its thread.
+    deadlineTimer = new QTimer(this);
+    deadlineTimer->setSingleShot(true);
+    connect(deadlineTimer, &QTimer::timeout, this, &Server_ProtocolHandler::checkDeadlines);
+    QMetaObject::invokeMethod(this, "scheduleNextDeadline", Qt::QueuedConnection);
 }
 
 Server_ProtocolHandler::~Server_ProtocolHandler()
@@ -92,6 +115,81 @@ void Server_ProtocolHandler::prepareDestroy()
     deleteLater();
 }
 
+void Server_ProtocolHandler::getHandoffInfo(HandoffSession &result)
+{
+    copyUserInfo(*result.mutable_user_info(), true, true, true);
+    result.set_auth_state(authState);
+    result.set_using_real_password(usingRealPassword);
+    for (const QString &feature : clientFeatures.keys())
+        result.add_client_features(feature.toStdString());
+    result.set_accepts_user_list_changes(acceptsUserListChanges);
+    result.set_accepts_room_list_changes(acceptsRoomListChanges);
+    for (const QString &buddy : server->getPresence()->getBuddies(this))
+        result.add_buddy_list(buddy.toStdString());
+
+    const QString name = QString::fromStdString(getUserInfo()->name());
+    for (Server_Room *room : rooms) {
+        HandoffSession_Room *roomInfo = result.add_room_list();
+        roomInfo->set_room_id(room->getId());
+        roomInfo->set_interests(room->getInterests(name));
+    }
+
+    QMapIterator<int, QPair<int, int>> gameIterator(getGames());
+    while (gameIterator.hasNext()) {
+        gameIterator.next();
+        HandoffSession_Game *gameInfo = result.add_game_list();
+        gameInfo->set_game_id(gameIterator.key());
+        gameInfo->set_room_id(gameIterator.value().first);
+        gameInfo->set_player_id(gameIterator.value().second);
+    }
+}
+
+void Server_ProtocolHandler::restoreHandoff(const HandoffSession &handoff)
+{
+    authState = static_cast<AuthenticationResult>(handoff.auth_state());
+    usingRealPassword = handoff.using_real_password();
+    clientFeatures.clear();
+    for (const std::string &feature : handoff.client_features())
+        clientFeatures.insert(QString::fromStdString(feature), false);
+    server->adoptSession(this, handoff.user_info());
+
+    QStringList buddies;
+    for (const std::string &buddy : handoff.buddy_list())
+        buddies.append(QString::fromStdString(buddy));
+    server->getPresence()->setBuddies(this, buddies);
+    acceptsUserListChanges = handoff.accepts_user_list_changes();
+    if (acceptsUserListChanges)
+        server->getPresence()->addListener(this);
+    acceptsRoomListChanges = handoff.accepts_room_list_changes();
+
+    QReadLocker roomsLocker(&server->roomsLock);
+    for (const HandoffSession_Room &roomInfo : handoff.room_list()) {
+        Server_Room *room = server->getRooms().value(roomInfo.room_id());
+        if (!room)
+            continue;
+        room->adoptClient(this, roomInfo.interests());
+        rooms.insert(room->getId(), room);
+    }
+
+    for (const HandoffSession_Game &gameInfo : handoff.game_list()) {
+        Server_Room *room = server->getRooms().value(gameInfo.room_id());
+        if (!room)
+            continue;
+        QReadLocker gamesLocker(&room->gamesLock);
+        Server_Game *game = room->getGames().value(gameInfo.game_id());
+        if (!game)
+            continue;
+        QMutexLocker gameLocker(&game->gameMutex);
+        Server_Player *player = game->getPlayers().value(gameInfo.player_id());
+        if (!player || !player->takeOverUserInterface(this))
+            continue;
+        playerAddedToGame(game->getGameId(), room->getId(), player->getPlayerId(), game->getHandle());
+    }
+    roomsLocker.unlock();
+
+    resetIdleTimer();
+}
+
 void Server_ProtocolHandler::sendProtocolItem(const Response &item)
 {
     ServerMessage msg;
@@ -129,7 +227,8 @@ void Server_ProtocolHandler::sendProtocolItem(const RoomEvent &item)
 }
 
 Response::ResponseCode Server_ProtocolHandler::processSessionCommandContainer(const CommandContainer &cont,
-                                                                              ResponseContainer &rc)
+                                                                              ResponseContainer &rc,
+                                                                              CommandTrace &trace)
 {
     Response::ResponseCode finalResponseCode = Response::RespOk;
     for (int i = cont.session_command_size() - 1; i >= 0; --i) {
@@ -137,8 +236,9 @@ Response::ResponseCode Server_ProtocolHandler::processSessionCommandContainer(co
         const SessionCommand &sc = cont.session_command(i);
         const int num = getPbExtension(sc);
         if (num != SessionCommand::PING) { // don't log ping commands
-            logDebugMessage(getSafeDebugString(sc));
+            logDebugCommand(QString(), sc);
         }
+        const qint64 commandStart = trace.now();
         switch ((SessionCommand::SessionCommandType)num) {
             case SessionCommand::PING:
                 resp = cmdPing(sc.GetExtension(Command_Ping::ext), rc);
@@ -155,6 +255,9 @@ Response::ResponseCode Server_ProtocolHandler::processSessionCommandContainer(co
             case SessionCommand::GET_USER_INFO:
                 resp = cmdGetUserInfo(sc.GetExtension(Command_GetUserInfo::ext), rc);
                 break;
+            case SessionCommand::GET_AVATAR:
+                resp = cmdGetAvatar(sc.GetExtension(Command_GetAvatar::ext), rc);
+                break;
             case SessionCommand::LIST_ROOMS:
                 resp = cmdListRooms(sc.GetExtension(Command_ListRooms::ext), rc);
                 break;
@@ -167,6 +270,8 @@ Response::ResponseCode Server_ProtocolHandler::processSessionCommandContainer(co
             default:
                 resp = processExtendedSessionCommand(num, sc, rc);
         }
+        trace.addSpan(CommandTrace::Execute, "execute", commandStart,
+                      CommandTrace::commandKey(CommandTrace::SessionCommandKind, num));
         if (resp != Response::RespOk)
             finalResponseCode = resp;
     }
@@ -174,12 +279,15 @@ Response::ResponseCode Server_ProtocolHandler::processSessionCommandContainer(co
 }
 
 Response::ResponseCode Server_ProtocolHandler::processRoomCommandContainer(const CommandContainer &cont,
-                                                                           ResponseContainer &rc)
+                                                                           ResponseContainer &rc,
+                                                                           CommandTrace &trace)
 {
     if (authState == NotLoggedIn)
         return Response::RespLoginNeeded;
 
+    const qint64 lockStart = trace.now();
     QReadLocker locker(&server->roomsLock);
+    trace.addSpan(CommandTrace::LockWait, "roomsLock", lockStart);
     Server_Room *room = rooms.value(cont.room_id(), 0);
     if (!room)
         return Response::RespNotInRoom;
@@ -191,7 +299,8 @@ Response::ResponseCode Server_ProtocolHandler::processRoomCommandContainer(const
         Response::ResponseCode resp = Response::RespInvalidCommand;
         const RoomCommand &sc = cont.room_command(i);
         const int num = getPbExtension(sc);
-        logDebugMessage(getSafeDebugString(sc));
+        logDebugCommand(QString(), sc);
+        const qint64 commandStart = trace.now();
         switch ((RoomCommand::RoomCommandType)num) {
             case RoomCommand::LEAVE_ROOM:
                 resp = cmdLeaveRoom(sc.GetExtension(Command_LeaveRoom::ext), room, rc);
@@ -205,102 +314,220 @@ Response::ResponseCode Server_ProtocolHandler::processRoomCommandContainer(const
             case RoomCommand::JOIN_GAME:
                 resp = cmdJoinGame(sc.GetExtension(Command_JoinGame::ext), room, rc);
                 break;
+            case RoomCommand::SET_GAME_FILTER:
+                resp = cmdSetGameFilter(sc.GetExtension(Command_SetGameFilter::ext), room, rc);
+                break;
+            case RoomCommand::SET_ROOM_INTERESTS:
+                resp = cmdSetRoomInterests(sc.GetExtension(Command_SetRoomInterests::ext), room, rc);
+                break;
         }
+        trace.addSpan(CommandTrace::Execute, "execute", commandStart,
+                      CommandTrace::commandKey(CommandTrace::RoomCommandKind, num));
         if (resp != Response::RespOk)
             finalResponseCode = resp;
     }
     return finalResponseCode;
 }
 
-Response::ResponseCode Server_ProtocolHandler::processGameCommandContainer(const CommandContainer &cont,
-                                                                           ResponseContainer &rc)
-{
-    static QList<GameCommand::GameCommandType> antifloodCommandsWhiteList =
-        QList<GameCommand::GameCommandType>()
-        // draw/undo card draw (example: drawing 10 cards one by one from the deck)
-        << GameCommand::DRAW_CARDS
-        << GameCommand::UNDO_DRAW
-        // create, delete arrows (example: targeting with 10 cards during an attack)
-        << GameCommand::CREATE_ARROW
-        << GameCommand::DELETE_ARROW
-        // set card attributes (example: tapping 10 cards at once)
-        << GameCommand::SET_CARD_ATTR
-        // increment / decrement counter (example: -10 life points one by one)
-        << GameCommand::INC_COUNTER
-        // mulling lots of hands in a row
-        << GameCommand::MULLIGAN
-        // allows a user to sideboard without receiving flooding message
-        << GameCommand::MOVE_CARD;
-
-    if (authState == NotLoggedIn)
-        return Response::RespLoginNeeded;
-
-    QMap<int, QPair<int, int>> gameMap = getGames();
-    if (!gameMap.contains(cont.game_id()))
-        return Response::RespNotInRoom;
-    const QPair<int, int> roomIdAndPlayerId = gameMap.value(cont.game_id());
-
-    QReadLocker roomsLocker(&server->roomsLock);
-    Server_Room *room = server->getRooms().value(roomIdAndPlayerId.first);
-    if (!room)
-        return Response::RespNotInRoom;
-
-    QReadLocker roomGamesLocker(&room->gamesLock);
-    Server_Game *game = room->getGames().value(cont.game_id());
-    if (!game) {
-        if (room->getExternalGames().contains(cont.game_id())) {
-            server->sendIsl_GameCommand(cont, room->getExternalGames().value(cont.game_id()).server_id(),
-                                        userInfo->session_id(), roomIdAndPlayerId.first, roomIdAndPlayerId.second);
-            return Response::RespNothing;
-        }
-        return Response::RespNotInRoom;
-    }
-
-    QMutexLocker gameLocker(&game->gameMutex);
-    Server_Player *player = game->getPlayers().value(roomIdAndPlayerId.second);
-    if (!player)
-        return Response::RespNotInRoom;
-
-    resetIdleTimer();
+int Server_ProtocolHandler::countGameCommands(const CommandContainer &cont,
+                                              int playerId,
+                                              Response::ResponseCode &finalResponseCode)
+{
+    // indexed by the command type, counted from the first game command
+    static const std::bitset<antifloodWhiteListSize> antifloodCommandsWhiteList = [] {
+        std::bitset<antifloodWhiteListSize> whiteList;
+        for (GameCommand::GameCommandType type : {
+                 // draw/undo card draw (example: drawing 10 cards one by one from the deck)
+                 GameCommand::DRAW_CARDS, GameCommand::UNDO_DRAW,
+                 // create, delete arrows (example: targeting with 10 cards during an attack)
+                 GameCommand::CREATE_ARROW, GameCommand::DELETE_ARROW,
+                 // set card attributes (example: tapping 10 cards at once)
+                 GameCommand::SET_CARD_ATTR,
+                 // increment / decrement counter (example: -10 life points one by one)
+                 GameCommand::INC_COUNTER,
+                 // mulling lots of hands in a row
+                 GameCommand::MULLIGAN,
+                 // allows a user to sideboard without receiving flooding message
+                 GameCommand::MOVE_CARD})
+            whiteList.set(type - GameCommand::KICK_FROM_GAME);
+        return whiteList;
+    }();
 
     int commandCountingInterval = server->getCommandCountingInterval();
     int maxCommandCountPerInterval = server->getMaxCommandCountPerInterval();
-    GameEventStorage ges;
-    Response::ResponseCode finalResponseCode = Response::RespOk;
     for (int i = cont.game_command_size() - 1; i >= 0; --i) {
         const GameCommand &sc = cont.game_command(i);
-        logDebugMessage(QString("game %1 player %2: ").arg(cont.game_id()).arg(roomIdAndPlayerId.second) +
-                        getSafeDebugString(sc));
+        const int num = getPbExtension(sc);
+        logDebugCommand(QString("game %1 player %2: ").arg(cont.game_id()).arg(playerId), sc);
 
         if (commandCountingInterval > 0) {
-            int totalCount = 0;
-            if (commandCountOverTime.isEmpty())
-                commandCountOverTime.prepend(0);
-
-            if (!antifloodCommandsWhiteList.contains((GameCommand::GameCommandType)getPbExtension(sc)))
-                ++commandCountOverTime[0];
-
-            for (int count : commandCountOverTime) {
-                totalCount += count;
-            }
+            advanceRateWindows();
+            const int index = num - GameCommand::KICK_FROM_GAME;
+            const bool whiteListed = index >= 0 && index < antifloodWhiteListSize && antifloodCommandsWhiteList[index];
+            const int totalCount = commandCountOverTime.add(whiteListed ? 0 : 1);
 
+            // the commands before it in the container did happen, the other players are still told about them
             if (maxCommandCountPerInterval > 0 && totalCount > maxCommandCountPerInterval) {
-                return Response::RespChatFlood;
+                finalResponseCode = Response::RespChatFlood;
+                return i + 1;
             }
         }
+    }
+    return 0;
+}
 
+// Chat doesn't touch the board. Containers with nothing but chat messages only need the players to stay where
+// they are, and don't have to wait for the board commands of other players.
+static bool isChatOnly(const CommandContainer &cont)
+{
+    for (const GameCommand &sc : cont.game_command()) {
+        if (getPbExtension(sc) != GameCommand::GAME_SAY)
+            return false;
+    }
+    return cont.game_command_size() > 0;
+}
+
+static int principalCommandKey(const CommandContainer &cont);
+
+// runs the commands from the last one down to firstCommand, see countGameCommands()
+static Response::ResponseCode executeGameCommands(const CommandContainer &cont,
+                                                  int firstCommand,
+                                                  Response::ResponseCode finalResponseCode,
+                                                  Server_Game *game,
+                                                  Server_Player *player,
+                                                  ResponseContainer &rc,
+                                                  CommandTrace &trace)
+{
+    QElapsedTimer handlerTimer;
+    handlerTimer.start();
+    GameEventStorage ges;
+    for (int i = cont.game_command_size() - 1; i >= firstCommand; --i) {
+        const GameCommand &sc = cont.game_command(i);
+        const qint64 commandStart = trace.now();
         Response::ResponseCode resp = player->processGameCommand(sc, rc, ges);
+        trace.addSpan(CommandTrace::Execute, "execute", commandStart,
+                      CommandTrace::commandKey(CommandTrace::GameCommandKind, getPbExtension(sc)));
 
         if (resp != Response::RespOk)
             finalResponseCode = resp;
     }
+    const qint64 sendStart = trace.now();
     ges.sendToGame(game);
+    trace.addSpan(CommandTrace::Respond, "sendToGame", sendStart);
 
+    game->getActivity().record(game->getRoom()->getServer()->getPingClockTicks(),
+                               cont.game_command_size() - firstCommand, handlerTimer.nsecsElapsed(), 0);
     return finalResponseCode;
 }
 
+Response::ResponseCode Server_ProtocolHandler::processGameCommandContainer(const CommandContainer &cont,
+                                                                           ResponseContainer &rc,
+                                                                           CommandTrace &trace)
+{
+    if (authState == NotLoggedIn)
+        return Response::RespLoginNeeded;
+
+    QPair<int, int> roomIdAndPlayerId;
+    std::shared_ptr<Server_GameHandle> gameHandle;
+    if (!findGame(cont.game_id(), roomIdAndPlayerId, gameHandle))
+        return Response::RespNotInRoom;
+
+    GameExecutor *gameExecutor = gameHandle ? server->getGameExecutor() : nullptr;
+    if (gameExecutor) {
+        // The executor of the game runs the commands and sends the response, this thread only does the part that
+        // belongs to the connection. The response goes to the user as long as they are still the same player.
+        resetIdleTimer();
+        Response::ResponseCode floodResponseCode = Response::RespOk;
+        const int playerId = roomIdAndPlayerId.second;
+        const int firstCommand = countGameCommands(cont, playerId, floodResponseCode);
+        const auto postedCont = std::make_shared<const CommandContainer>(cont);
+        Server_AbstractUserInterface *sender = this;
+        gameExecutor->post(cont.game_id(), [postedCont, gameHandle, sender, playerId, firstCommand,
+                                            floodResponseCode](qint64 mailboxMicroseconds) {
+            QReadLocker gameHandleLocker(&gameHandle->lock);
+            Server_Game *game = gameHandle->game;
+            if (!game)
+                return;
+            game->recordMailboxLatency(mailboxMicroseconds);
+
+            const bool chatOnly = isChatOnly(*postedCont);
+            QMutexLocker gameLocker(chatOnly ? nullptr : &game->gameMutex);
+            QReadLocker playersLocker(chatOnly ? &game->playersLock : nullptr);
+            Server_Player *player = game->getPlayers().value(playerId);
+            if (!player)
+                return;
+
+            ResponseContainer executorRc(postedCont->has_cmd_id() ? postedCont->cmd_id() : -1);
+            // only traced for the timeline, the connection sampled the container for the histograms
+            CommandTrace executorTrace;
+            executorTrace.start(0, TimelineTrace::isRunning() ? principalCommandKey(*postedCont) : -1, 0);
+            QElapsedTimer handlerTimer;
+            handlerTimer.start();
+            const Response::ResponseCode responseCode = executeGameCommands(
+                *postedCont, firstCommand, floodResponseCode, game, player, executorRc, executorTrace);
+            // disconnecting takes the user interface of the player away under the locks held here
+            if (player->getUserInterface() == sender) {
+                // the connection only counted its own part of the commands
+                sender->getActivity().record(game->getRoom()->getServer()->getPingClockTicks(), 0,
+                                             handlerTimer.nsecsElapsed(), 0);
+                sender->sendResponseContainer(executorRc, responseCode);
+            }
+            executorTrace.finish(0);
+        });
+        return Response::RespNothing;
+    }
+
+    // the games hosted here are reached through their handle, the room is only needed for the others
+    qint64 lockStart = trace.now();
+    QReadLocker gameHandleLocker(gameHandle ? &gameHandle->lock : nullptr);
+    trace.addSpan(CommandTrace::LockWait, "gameHandle", lockStart);
+    Server_Game *game = gameHandle ? gameHandle->game : nullptr;
+    if (gameHandle && !game)
+        return Response::RespNotInRoom;
+
+    std::optional<QReadLocker> roomsLocker, roomGamesLocker;
+    if (!game) {
+        lockStart = trace.now();
+        roomsLocker.emplace(&server->roomsLock);
+        trace.addSpan(CommandTrace::LockWait, "roomsLock", lockStart);
+        Server_Room *room = server->getRooms().value(roomIdAndPlayerId.first);
+        if (!room)
+            return Response::RespNotInRoom;
+
+        lockStart = trace.now();
+        roomGamesLocker.emplace(&room->gamesLock);
+        trace.addSpan(CommandTrace::LockWait, "gamesLock", lockStart);
+        game = room->getGames().value(cont.game_id());
+        if (!game) {
+            if (room->getExternalGames().contains(cont.game_id())) {
+                server->sendIsl_GameCommand(cont, room->getExternalGames().value(cont.game_id()).server_id(),
+                                            userInfo->session_id(), roomIdAndPlayerId.first,
+                                            roomIdAndPlayerId.second);
+                return Response::RespNothing;
+            }
+            return Response::RespNotInRoom;
+        }
+    }
+
+    const bool chatOnly = isChatOnly(cont);
+    lockStart = trace.now();
+    QMutexLocker gameLocker(chatOnly ? nullptr : &game->gameMutex);
+    QReadLocker playersLocker(chatOnly ? &game->playersLock : nullptr);
+    trace.addSpan(CommandTrace::LockWait, chatOnly ? "playersLock" : "gameMutex", lockStart);
+    Server_Player *player = game->getPlayers().value(roomIdAndPlayerId.second);
+    if (!player)
+        return Response::RespNotInRoom;
+
+    resetIdleTimer();
+
+    Response::ResponseCode finalResponseCode = Response::RespOk;
+    const int firstCommand = countGameCommands(cont, roomIdAndPlayerId.second, finalResponseCode);
+    return executeGameCommands(cont, firstCommand, finalResponseCode, game, player, rc, trace);
+}
+
 Response::ResponseCode Server_ProtocolHandler::processModeratorCommandContainer(const CommandContainer &cont,
-                                                                                ResponseContainer &rc)
+                                                                                ResponseContainer &rc,
+                                                                                CommandTrace &trace)
 {
     if (!userInfo)
         return Response::RespLoginNeeded;
@@ -314,9 +541,12 @@ Response::ResponseCode Server_ProtocolHandler::processModeratorCommandContainer(
         Response::ResponseCode resp = Response::RespInvalidCommand;
         const ModeratorCommand &sc = cont.moderator_command(i);
         const int num = getPbExtension(sc);
-        logDebugMessage(getSafeDebugString(sc));
+        logDebugCommand(QString(), sc);
 
+        const qint64 commandStart = trace.now();
         resp = processExtendedModeratorCommand(num, sc, rc);
+        trace.addSpan(CommandTrace::Execute, "execute", commandStart,
+                      CommandTrace::commandKey(CommandTrace::ModeratorCommandKind, num));
         if (resp != Response::RespOk)
             finalResponseCode = resp;
     }
@@ -324,7 +554,8 @@ Response::ResponseCode Server_ProtocolHandler::processModeratorCommandContainer(
 }
 
 Response::ResponseCode Server_ProtocolHandler::processAdminCommandContainer(const CommandContainer &cont,
-                                                                            ResponseContainer &rc)
+                                                                            ResponseContainer &rc,
+                                                                            CommandTrace &trace)
 {
     if (!userInfo)
         return Response::RespLoginNeeded;
@@ -338,87 +569,162 @@ Response::ResponseCode Server_ProtocolHandler::processAdminCommandContainer(cons
         Response::ResponseCode resp = Response::RespInvalidCommand;
         const AdminCommand &sc = cont.admin_command(i);
         const int num = getPbExtension(sc);
-        logDebugMessage(getSafeDebugString(sc));
+        logDebugCommand(QString(), sc);
 
+        const qint64 commandStart = trace.now();
         resp = processExtendedAdminCommand(num, sc, rc);
+        trace.addSpan(CommandTrace::Execute, "execute", commandStart,
+                      CommandTrace::commandKey(CommandTrace::AdminCommandKind, num));
         if (resp != Response::RespOk)
             finalResponseCode = resp;
     }
     return finalResponseCode;
 }
 
-void Server_ProtocolHandler::processCommandContainer(const CommandContainer &cont)
+// The command a trace of the container is filed under: the first one that is processed. Hardly any client sends
+// more than one command per container.
+static int principalCommandKey(const CommandContainer &cont)
+{
+    if (cont.game_command_size())
+        return CommandTrace::commandKey(CommandTrace::GameCommandKind,
+                                        getPbExtension(cont.game_command(cont.game_command_size() - 1)));
+    if (cont.room_command_size())
+        return CommandTrace::commandKey(CommandTrace::RoomCommandKind,
+                                        getPbExtension(cont.room_command(cont.room_command_size() - 1)));
+    if (cont.session_command_size())
+        return CommandTrace::commandKey(CommandTrace::SessionCommandKind,
+                                        getPbExtension(cont.session_command(cont.session_command_size() - 1)));
+    if (cont.moderator_command_size())
+        return CommandTrace::commandKey(CommandTrace::ModeratorCommandKind,
+                                        getPbExtension(cont.moderator_command(cont.moderator_command_size() - 1)));
+    if (cont.admin_command_size())
+        return CommandTrace::commandKey(CommandTrace::AdminCommandKind,
+                                        getPbExtension(cont.admin_command(cont.admin_command_size() - 1)));
+    return -1;
+}
+
+void Server_ProtocolHandler::processCommandContainer(const CommandContainer &cont, qint64 parseTime)
 {
     // Command processing must be disabled after prepareDestroy() has been called.
     if (deleted)
         return;
 
-    lastDataReceived = timeRunning;
+    lastDataReceived = server->getPingClockTicks();
+    QElapsedTimer handlerTimer;
+    handlerTimer.start();
+
+    CommandTrace trace;
+    const int sampleRate = server->getCommandTraceSampleRate();
+    const int commandKey = sampleRate > 0 || TimelineTrace::isRunning() ? principalCommandKey(cont) : -1;
+    trace.start(sampleRate, commandKey, parseTime);
 
     ResponseContainer responseContainer(cont.has_cmd_id() ? cont.cmd_id() : -1);
     Response::ResponseCode finalResponseCode;
 
     if (cont.game_command_size())
-        finalResponseCode = processGameCommandContainer(cont, responseContainer);
+        finalResponseCode = processGameCommandContainer(cont, responseContainer, trace);
     else if (cont.room_command_size())
-        finalResponseCode = processRoomCommandContainer(cont, responseContainer);
+        finalResponseCode = processRoomCommandContainer(cont, responseContainer, trace);
     else if (cont.session_command_size())
-        finalResponseCode = processSessionCommandContainer(cont, responseContainer);
+        finalResponseCode = processSessionCommandContainer(cont, responseContainer, trace);
     else if (cont.moderator_command_size())
-        finalResponseCode = processModeratorCommandContainer(cont, responseContainer);
+        finalResponseCode = processModeratorCommandContainer(cont, responseContainer, trace);
     else if (cont.admin_command_size())
-        finalResponseCode = processAdminCommandContainer(cont, responseContainer);
+        finalResponseCode = processAdminCommandContainer(cont, responseContainer, trace);
     else
         finalResponseCode = Response::RespInvalidCommand;
 
-    if ((finalResponseCode != Response::RespNothing))
+    if ((finalResponseCode != Response::RespNothing)) {
+        const qint64 respondStart = trace.now();
         sendResponseContainer(responseContainer, finalResponseCode);
+        trace.addSpan(CommandTrace::Respond, "sendResponse", respondStart);
+    }
+
+    if (trace.isEnabled()) {
+        const QString slowTrace = trace.finish(server->getSlowCommandThreshold(commandKey));
+        if (!slowTrace.isEmpty())
+            logDebugMessage(slowTrace);
+    }
+
+    const int commandCount = cont.game_command_size() + cont.room_command_size() + cont.session_command_size() +
+                             cont.moderator_command_size() + cont.admin_command_size();
+    activity.record(lastDataReceived, commandCount, handlerTimer.nsecsElapsed(), 0);
 }
 
-void Server_ProtocolHandler::pingClockTimeout()
+void Server_ProtocolHandler::advanceRateWindows()
 {
+    // Move the flood protection windows on by the number of ping clock ticks that passed since the last
+    // time; this only has to happen when they are about to be used.
+    const int now = server->getPingClockTicks();
+    const int ticks = now - rateWindowTick;
+    rateWindowTick = now;
 
-    int cmdcountinterval = server->getCommandCountingInterval();
-    int msgcountinterval = server->getMessageCountingInterval();
     int pingclockinterval = server->getClientKeepAlive();
+    if (pingclockinterval <= 0)
+        return;
 
-    int interval = server->getMessageCountingInterval();
-    if (interval > 0) {
-        if (pingclockinterval > 0) {
-            messageSizeOverTime.prepend(0);
-            if (messageSizeOverTime.size() > (msgcountinterval / pingclockinterval))
-                messageSizeOverTime.removeLast();
-            messageCountOverTime.prepend(0);
-            if (messageCountOverTime.size() > (msgcountinterval / pingclockinterval))
-                messageCountOverTime.removeLast();
-        }
+    int msgcountinterval = server->getMessageCountingInterval();
+    if (msgcountinterval > 0) {
+        messageSizeOverTime.setLength(msgcountinterval / pingclockinterval);
+        messageCountOverTime.setLength(msgcountinterval / pingclockinterval);
+        messageSizeOverTime.advance(ticks);
+        messageCountOverTime.advance(ticks);
     }
 
-    interval = server->getCommandCountingInterval();
-    if (interval > 0) {
-        if (pingclockinterval > 0) {
-            commandCountOverTime.prepend(0);
-            if (commandCountOverTime.size() > (cmdcountinterval / pingclockinterval))
-                commandCountOverTime.removeLast();
-        }
+    int cmdcountinterval = server->getCommandCountingInterval();
+    if (cmdcountinterval > 0) {
+        commandCountOverTime.setLength(cmdcountinterval / pingclockinterval);
+        commandCountOverTime.advance(ticks);
     }
+}
 
-    if (timeRunning - lastDataReceived > server->getMaxPlayerInactivityTime())
-        prepareDestroy();
-
+bool Server_ProtocolHandler::isExemptFromIdleTimeout() const
+{
     // PrivLevel users, Moderators, and Admins are not subject to the server idle timeout policy
     const bool hasPrivLevel = userInfo && QString::fromStdString(userInfo->privlevel()).toLower() != "none";
     const bool isModOrAdmin =
         userInfo && (userInfo->user_level() & (ServerInfo_User::IsModerator | ServerInfo_User::IsAdmin));
-    if (!hasPrivLevel && !isModOrAdmin) {
-        if ((server->getIdleClientTimeout() > 0) && (idleClientWarningSent)) {
-            if (timeRunning - lastActionReceived > server->getIdleClientTimeout()) {
-                prepareDestroy();
-            }
+    return hasPrivLevel || isModOrAdmin;
+}
+
+void Server_ProtocolHandler::scheduleNextDeadline()
+{
+    if (deleted || server->getPingClockInterval() <= 0)
+        return;
+
+    // Activity only ever moves these deadlines further away, so it is enough to look at them again
+    // once the earliest one computed here has passed.
+    int deadline = lastDataReceived + server->getMaxPlayerInactivityTime() + 1;
+    const int idleClientTimeout = server->getIdleClientTimeout();
+    if (idleClientTimeout > 0 && !isExemptFromIdleTimeout()) {
+        if (idleClientWarningSent)
+            deadline = qMin(deadline, lastActionReceived + idleClientTimeout + 1);
+        else
+            deadline = qMin(deadline, lastActionReceived + qCeil(idleClientTimeout * .9));
+    }
+
+    deadlineTimer->start(static_cast<int>(qMin<qint64>(server->msecsUntilPingClockTick(deadline), INT_MAX)));
+}
+
+void Server_ProtocolHandler::checkDeadlines()
+{
+    if (deleted)
+        return;
+
+    const int timeRunning = server->getPingClockTicks();
+    if (timeRunning - lastDataReceived > server->getMaxPlayerInactivityTime()) {
+        prepareDestroy();
+        return;
+    }
+
+    const int idleClientTimeout = server->getIdleClientTimeout();
+    if (idleClientTimeout > 0 && !isExemptFromIdleTimeout()) {
+        if (idleClientWarningSent && (timeRunning - lastActionReceived > idleClientTimeout)) {
+            prepareDestroy();
+            return;
         }
 
-        if (((timeRunning - lastActionReceived) >= qCeil(server->getIdleClientTimeout() * .9)) &&
-            (!idleClientWarningSent) && (server->getIdleClientTimeout() > 0)) {
+        if (!idleClientWarningSent && ((timeRunning - lastActionReceived) >= qCeil(idleClientTimeout * .9))) {
             Event_NotifyUser event;
             event.set_type(Event_NotifyUser::IDLEWARNING);
             SessionEvent *se = prepareSessionEvent(event);
@@ -428,7 +734,7 @@ void Server_ProtocolHandler::pingClockTimeout()
         }
     }
 
-    ++timeRunning;
+    scheduleNextDeadline();
 }
 
 Response::ResponseCode Server_ProtocolHandler::cmdPing(const Command_Ping & /*cmd*/, ResponseContainer & /*rc*/)
@@ -517,6 +823,7 @@ Response::ResponseCode Server_ProtocolHandler::cmdLogin(const Command_Login &cmd
         default:
             authState = res;
             usingRealPassword = needsHash;
+            clientFeatures = receivedClientFeatures;
     }
 
     // limit the number of non-privileged users that can connect to the server based on configuration settings
@@ -535,14 +842,20 @@ Response::ResponseCode Server_ProtocolHandler::cmdLogin(const Command_Login &cmd
     rc.enqueuePostResponseItem(ServerMessage::SESSION_EVENT, prepareSessionEvent(event));
 
     Response_Login *re = new Response_Login;
-    re->mutable_user_info()->CopyFrom(copyUserInfo(true));
+    copyUserInfo(*re->mutable_user_info(), true);
+    if (clientSupportsFeature(AvatarHash::featureName))
+        AvatarHash::stripAvatar(*re->mutable_user_info());
 
     if (authState == PasswordRight) {
-        QMapIterator<QString, ServerInfo_User> buddyIterator(databaseInterface->getBuddyList(userName));
+        QMap<QString, ServerInfo_User> buddyList, ignoreList;
+        databaseInterface->getBuddyAndIgnoreLists(userName, buddyList, ignoreList);
+
+        QMapIterator<QString, ServerInfo_User> buddyIterator(buddyList);
         while (buddyIterator.hasNext())
             re->add_buddy_list()->CopyFrom(buddyIterator.next().value());
+        server->getPresence()->setBuddies(this, buddyList.keys());
 
-        QMapIterator<QString, ServerInfo_User> ignoreIterator(databaseInterface->getIgnoreList(userName));
+        QMapIterator<QString, ServerInfo_User> ignoreIterator(ignoreList);
         while (ignoreIterator.hasNext())
             re->add_ignore_list()->CopyFrom(ignoreIterator.next().value());
     }
@@ -554,7 +867,10 @@ Response::ResponseCode Server_ProtocolHandler::cmdLogin(const Command_Login &cmd
             re->add_missing_features(i.key().toStdString().c_str());
     }
 
-    joinPersistentGames(rc);
+    QMap<int, quint64> resumePoints;
+    for (int i = 0; i < qMin(cmd.resume_game_ids_size(), cmd.resume_sequences_size()); ++i)
+        resumePoints.insert(cmd.resume_game_ids(i), cmd.resume_sequences(i));
+    joinPersistentGames(rc, resumePoints);
     databaseInterface->removeForgotPassword(userName);
     rc.setResponseExtension(re);
     return Response::RespOk;
@@ -565,7 +881,9 @@ Response::ResponseCode Server_ProtocolHandler::cmdMessage(const Command_Message
     if (authState == NotLoggedIn)
         return Response::RespLoginNeeded;
 
+    const qint64 lockStart = TimelineTrace::now();
     QReadLocker locker(&server->clientsLock);
+    TimelineTrace::record(TimelineTrace::LockWait, "clientsLock", lockStart);
 
     QString receiver = nameFromStdString(cmd.user_name());
     Server_AbstractUserInterface *userInterface = server->findUser(receiver);
@@ -605,6 +923,10 @@ Response::ResponseCode Server_ProtocolHandler::cmdGetGamesOfUser(const Command_G
     // We don't need to check whether the user is logged in; persistent games should also work.
     // The client needs to deal with an empty result list.
 
+    // (room id, game id), only the games the user is in are visited
+    const QList<QPair<int, int>> userGames =
+        server->getUserGameIndex().getGamesOfUser(nameFromStdString(cmd.user_name()));
+
     Response_GetGamesOfUser *re = new Response_GetGamesOfUser;
     server->roomsLock.lockForRead();
     QMapIterator<int, Server_Room *> roomIterator(server->getRooms());
@@ -612,9 +934,14 @@ Response::ResponseCode Server_ProtocolHandler::cmdGetGamesOfUser(const Command_G
         Server_Room *room = roomIterator.next().value();
         room->gamesLock.lockForRead();
         room->getInfo(*re->add_room_list(), false, true);
-        QListIterator<ServerInfo_Game> gameIterator(room->getGamesOfUser(nameFromStdString(cmd.user_name())));
-        while (gameIterator.hasNext())
-            re->add_game_list()->CopyFrom(gameIterator.next());
+        for (const auto &userGame : userGames) {
+            if (userGame.first != room->getId())
+                continue;
+            // the game may have closed since the index was read
+            Server_Game *game = room->getGames().value(userGame.second);
+            if (game)
+                game->getInfo(*re->add_game_list());
+        }
         room->gamesLock.unlock();
     }
     server->roomsLock.unlock();
@@ -634,7 +961,9 @@ Response::ResponseCode Server_ProtocolHandler::cmdGetUserInfo(const Command_GetU
         re->mutable_user_info()->CopyFrom(*userInfo);
     else {
 
+        const qint64 lockStart = TimelineTrace::now();
         QReadLocker locker(&server->clientsLock);
+        TimelineTrace::record(TimelineTrace::LockWait, "clientsLock", lockStart);
 
         ServerInfo_User_Container *infoSource = server->findUser(userName);
         if (!infoSource) {
@@ -644,7 +973,40 @@ Response::ResponseCode Server_ProtocolHandler::cmdGetUserInfo(const Command_GetU
                 infoSource->copyUserInfo(true, false, userInfo->user_level() & ServerInfo_User::IsModerator));
         }
     }
+    if (clientSupportsFeature(AvatarHash::featureName))
+        AvatarHash::stripAvatar(*re->mutable_user_info());
+
+    rc.setResponseExtension(re);
+    return Response::RespOk;
+}
+
+Response::ResponseCode Server_ProtocolHandler::cmdGetAvatar(const Command_GetAvatar &cmd, ResponseContainer &rc)
+{
+    if (authState == NotLoggedIn)
+        return Response::RespLoginNeeded;
+
+    const QString userName = nameFromStdString(cmd.user_name());
+    ServerInfo_User user;
+    if (userName.isEmpty()) {
+        user.CopyFrom(*userInfo);
+    } else {
+        const qint64 lockStart = TimelineTrace::now();
+        QReadLocker locker(&server->clientsLock);
+        TimelineTrace::record(TimelineTrace::LockWait, "clientsLock", lockStart);
+        ServerInfo_User_Container *infoSource = server->findUser(userName);
+        if (infoSource)
+            infoSource->copyUserInfo(user, true);
+    }
+    // users that are offline, or known from servers of the network that don't pass avatars on
+    if (user.avatar_bmp().empty() && !userName.isEmpty())
+        user = databaseInterface->getUserData(userName);
+    if (user.avatar_bmp().empty())
+        return Response::RespNameNotFound;
 
+    const QByteArray hash = AvatarHash::hashOf(QByteArray::fromStdString(user.avatar_bmp()));
+    Response_GetAvatar *re = new Response_GetAvatar;
+    re->set_avatar_bmp(user.avatar_bmp());
+    re->set_avatar_hash(hash.constData(), static_cast<size_t>(hash.size()));
     rc.setResponseExtension(re);
     return Response::RespOk;
 }
@@ -684,47 +1046,69 @@ Response::ResponseCode Server_ProtocolHandler::cmdJoinRoom(const Command_JoinRoo
     room->addClient(this);
     rooms.insert(room->getId(), room);
 
-    QReadLocker chatHistoryLocker(&room->historyLock);
-    QList<ServerInfo_ChatMessage> chatHistory = room->getChatHistory();
-    ServerInfo_ChatMessage chatMessage;
-    for (int i = 0; i < chatHistory.size(); ++i) {
-        chatMessage = chatHistory.at(i);
-        Event_RoomSay roomChatHistory;
-        roomChatHistory.set_message(chatMessage.sender_name() + ": " + chatMessage.message());
-        roomChatHistory.set_message_type(Event_RoomSay::ChatHistory);
-        roomChatHistory.set_time_of(
-            QDateTime::fromString(QString::fromStdString(chatMessage.time())).toMSecsSinceEpoch());
-        rc.enqueuePostResponseItem(ServerMessage::ROOM_EVENT, room->prepareRoomEvent(roomChatHistory));
-    }
-
-    Event_RoomSay joinMessageEvent;
-    joinMessageEvent.set_message(room->getJoinMessage().toStdString());
-    joinMessageEvent.set_message_type(Event_RoomSay::Welcome);
-    rc.enqueuePostResponseItem(ServerMessage::ROOM_EVENT, room->prepareRoomEvent(joinMessageEvent));
-
-    Response_JoinRoom *re = new Response_JoinRoom;
-    room->getInfo(*re->mutable_room_info(), true);
+    // the chat history and the welcome message are kept serialized by the room
+    for (const QByteArray &chatHistoryEvent : room->getSerializedChatHistory())
+        rc.enqueuePostResponseSerializedItem(chatHistoryEvent);
+    rc.enqueuePostResponseSerializedItem(room->getSerializedJoinMessage());
 
-    rc.setResponseExtension(re);
+    // the room info can be several hundred KB, it is sent as the room keeps it serialized
+    QByteArray joinRoomResponse;
+    SerializedMessage::appendField(joinRoomResponse, Response_JoinRoom::kRoomInfoFieldNumber,
+                                   room->getSerializedInfo());
+    rc.setSerializedResponseExtension(Response_JoinRoom::kExtFieldNumber, joinRoomResponse);
     return Response::RespOk;
 }
 
-Response::ResponseCode Server_ProtocolHandler::cmdListUsers(const Command_ListUsers & /*cmd*/, ResponseContainer &rc)
+Response::ResponseCode Server_ProtocolHandler::cmdListUsers(const Command_ListUsers &cmd, ResponseContainer &rc)
 {
     if (authState == NotLoggedIn)
         return Response::RespLoginNeeded;
 
+    // with thousands online, pages keep the response small and only the users on it are copied
+    static const quint32 maxUsersPerPage = 1000;
+
     Response_ListUsers *re = new Response_ListUsers;
-    server->clientsLock.lockForRead();
-    QMapIterator<QString, Server_ProtocolHandler *> userIterator = server->getUsers();
-    while (userIterator.hasNext())
-        re->add_user_list()->CopyFrom(userIterator.next().value()->copyUserInfo(false));
-    QMapIterator<QString, Server_AbstractUserInterface *> extIterator = server->getExternalUsers();
-    while (extIterator.hasNext())
-        re->add_user_list()->CopyFrom(extIterator.next().value()->copyUserInfo(false));
+    const qint64 lockStart = TimelineTrace::now();
+    QReadLocker locker(&server->clientsLock);
+    TimelineTrace::record(TimelineTrace::LockWait, "clientsLock", lockStart);
+    if (cmd.max_users() == 0) {
+        for (Server_ProtocolHandler *user : server->getUserList())
+            user->copyUserInfo(*re->add_user_list(), false);
+        QMapIterator<QString, Server_AbstractUserInterface *> extIterator = server->getExternalUsers();
+        while (extIterator.hasNext())
+            extIterator.next().value()->copyUserInfo(*re->add_user_list(), false);
+    } else {
+        QList<QPair<QString, const ServerInfo_User_Container *>> users;
+        for (Server_ProtocolHandler *user : server->getUserList())
+            users.append({QString::fromStdString(user->getUserInfo()->name()), user});
+        QMapIterator<QString, Server_AbstractUserInterface *> extIterator = server->getExternalUsers();
+        while (extIterator.hasNext()) {
+            extIterator.next();
+            users.append({extIterator.key(), extIterator.value()});
+        }
+        const auto byName = [](const QPair<QString, const ServerInfo_User_Container *> &lhs,
+                               const QPair<QString, const ServerInfo_User_Container *> &rhs) {
+            return lhs.first < rhs.first;
+        };
+        std::sort(users.begin(), users.end(), byName);
+
+        const QPair<QString, const ServerInfo_User_Container *> cursor(nameFromStdString(cmd.after_name()), nullptr);
+        auto user = users.begin();
+        if (cmd.has_after_name())
+            user = std::upper_bound(users.begin(), users.end(), cursor, byName);
+        const quint32 pageSize = qMin(cmd.max_users(), maxUsersPerPage);
+        for (quint32 count = 0; user != users.end() && count < pageSize; ++user, ++count)
+            user->second->copyUserInfo(*re->add_user_list(), false);
+        re->set_total_users(static_cast<quint32>(users.size()));
+        if (user != users.end())
+            re->set_next_after_name(re->user_list(re->user_list_size() - 1).name());
+    }
 
-    acceptsUserListChanges = true;
-    server->clientsLock.unlock();
+    if (cmd.subscribe()) {
+        acceptsUserListChanges = true;
+        server->getPresence()->addListener(this);
+    }
+    locker.unlock();
 
     rc.setResponseExtension(re);
     return Response::RespOk;
@@ -744,24 +1128,9 @@ bool Server_ProtocolHandler::addSaidMessageSize(int size)
         return true;
     }
 
-    int totalSize = 0, totalCount = 0;
-    if (messageSizeOverTime.isEmpty()) {
-        messageSizeOverTime.prepend(0);
-    }
-
-    messageSizeOverTime[0] += size;
-    for (int messageSize : messageSizeOverTime) {
-        totalSize += messageSize;
-    }
-
-    if (messageCountOverTime.isEmpty()) {
-        messageCountOverTime.prepend(0);
-    }
-
-    messageCountOverTime[0] += 1;
-    for (int messageCount : messageCountOverTime) {
-        totalCount += messageCount;
-    }
+    advanceRateWindows();
+    const int totalSize = messageSizeOverTime.add(size);
+    const int totalCount = messageCountOverTime.add(1);
 
     return totalSize <= server->getMaxMessageSizePerInterval() && totalCount <= server->getMaxMessageCountPerInterval();
 }
@@ -772,14 +1141,13 @@ Server_ProtocolHandler::cmdRoomSay(const Command_RoomSay &cmd, Server_Room *room
     if (!addSaidMessageSize(static_cast<int>(cmd.message().size()))) {
         return Response::RespChatFlood;
     }
-    QString msg = QString::fromStdString(cmd.message());
+    std::string msg = cmd.message();
+    std::replace(msg.begin(), msg.end(), '\n', ' ');
 
-    msg.replace(QChar('\n'), QChar(' '));
-
-    room->say(QString::fromStdString(userInfo->name()), msg);
+    room->say(userInfo->name(), msg);
 
     databaseInterface->logMessage(userInfo->id(), QString::fromStdString(userInfo->name()),
-                                  QString::fromStdString(userInfo->address()), msg,
+                                  QString::fromStdString(userInfo->address()), QString::fromStdString(msg),
                                   Server_DatabaseInterface::MessageTargetRoom, room->getId(), room->getName());
 
     return Response::RespOk;
@@ -845,8 +1213,35 @@ Server_ProtocolHandler::cmdJoinGame(const Command_JoinGame &cmd, Server_Room *ro
     return room->processJoinGameCommand(cmd, rc, this);
 }
 
+Response::ResponseCode
+Server_ProtocolHandler::cmdSetGameFilter(const Command_SetGameFilter &cmd, Server_Room *room, ResponseContainer &rc)
+{
+    if (authState == NotLoggedIn)
+        return Response::RespLoginNeeded;
+
+    auto *re = new Response_FilteredGames;
+    const bool userIsRegistered = userInfo->user_level() & ServerInfo_User::IsRegistered;
+    room->setGameFilter(QString::fromStdString(userInfo->name()), userIsRegistered, cmd, *re);
+    rc.setResponseExtension(re);
+    return Response::RespOk;
+}
+
+Response::ResponseCode Server_ProtocolHandler::cmdSetRoomInterests(const Command_SetRoomInterests &cmd,
+                                                                   Server_Room *room,
+                                                                   ResponseContainer &rc)
+{
+    if (authState == NotLoggedIn)
+        return Response::RespLoginNeeded;
+
+    QByteArray interestsResponse;
+    SerializedMessage::appendField(interestsResponse, Response_RoomInterests::kRoomInfoFieldNumber,
+                                   room->setInterests(this, cmd.interests()));
+    rc.setSerializedResponseExtension(Response_RoomInterests::kExtFieldNumber, interestsResponse);
+    return Response::RespOk;
+}
+
 void Server_ProtocolHandler::resetIdleTimer()
 {
-    lastActionReceived = timeRunning;
+    lastActionReceived = server->getPingClockTicks();
     idleClientWarningSent = false;
 }
@@ -3,12 +3,14 @@
 
 #include "pb/response.pb.h"
 #include "pb/server_message.pb.h"
+#include "rate_window.h"
 #include "server.h"
 #include "server_abstractuserinterface.h"
 
 #include <QObject>
 #include <QPair>
 
+class CommandTrace;
 class Features;
 class Server_DatabaseInterface;
 class Server_Player;
@@ -16,6 +18,7 @@ class ServerInfo_User;
 class Server_Room;
 class QTimer;
 class FeatureSet;
+class HandoffSession;
 
 class ServerMessage;
 class Response;
@@ -36,12 +39,15 @@ class Command_Message;
 class Command_ListUsers;
 class Command_GetGamesOfUser;
 class Command_GetUserInfo;
+class Command_GetAvatar;
 class Command_ListRooms;
 class Command_JoinRoom;
 class Command_LeaveRoom;
 class Command_RoomSay;
 class Command_CreateGame;
 class Command_JoinGame;
+class Command_SetGameFilter;
+class Command_SetRoomInterests;
 
 class Server_ProtocolHandler : public QObject, public Server_AbstractUserInterface
 {
@@ -56,13 +62,24 @@ protected:
     bool acceptsUserListChanges;
     bool acceptsRoomListChanges;
     bool idleClientWarningSent;
+    // features advertised by the client on login
+    QMap<QString, bool> clientFeatures;
     virtual void logDebugMessage(const QString & /* message */)
     {
     }
+    /**
+     * Logs a command that was received. It's only turned into text if the logger keeps it, since that costs a lot more
+     * than handling most commands.
+     */
+    virtual void logDebugCommand(const QString & /* prefix */, const ::google::protobuf::Message & /* command */)
+    {
+    }
 
 private:
-    QList<int> messageSizeOverTime, messageCountOverTime, commandCountOverTime;
-    int timeRunning, lastDataReceived, lastActionReceived;
+    RateWindow messageSizeOverTime, messageCountOverTime, commandCountOverTime;
+    // all times are ping clock ticks, see Server::getPingClockTicks()
+    int lastDataReceived, lastActionReceived, rateWindowTick;
+    QTimer *deadlineTimer;
 
     virtual void transmitProtocolItem(const ServerMessage &item) = 0;
 
@@ -71,6 +88,7 @@ private:
     Response::ResponseCode cmdMessage(const Command_Message &cmd, ResponseContainer &rc);
     Response::ResponseCode cmdGetGamesOfUser(const Command_GetGamesOfUser &cmd, ResponseContainer &rc);
     Response::ResponseCode cmdGetUserInfo(const Command_GetUserInfo &cmd, ResponseContainer &rc);
+    Response::ResponseCode cmdGetAvatar(const Command_GetAvatar &cmd, ResponseContainer &rc);
     Response::ResponseCode cmdListRooms(const Command_ListRooms &cmd, ResponseContainer &rc);
     Response::ResponseCode cmdJoinRoom(const Command_JoinRoom &cmd, ResponseContainer &rc);
     Response::ResponseCode cmdListUsers(const Command_ListUsers &cmd, ResponseContainer &rc);
@@ -78,22 +96,36 @@ private:
     Response::ResponseCode cmdRoomSay(const Command_RoomSay &cmd, Server_Room *room, ResponseContainer &rc);
     Response::ResponseCode cmdCreateGame(const Command_CreateGame &cmd, Server_Room *room, ResponseContainer &rc);
     Response::ResponseCode cmdJoinGame(const Command_JoinGame &cmd, Server_Room *room, ResponseContainer &rc);
+    Response::ResponseCode
+    cmdSetGameFilter(const Command_SetGameFilter &cmd, Server_Room *room, ResponseContainer &rc);
+    Response::ResponseCode
+    cmdSetRoomInterests(const Command_SetRoomInterests &cmd, Server_Room *room, ResponseContainer &rc);
 
-    Response::ResponseCode processSessionCommandContainer(const CommandContainer &cont, ResponseContainer &rc);
+    Response::ResponseCode
+    processSessionCommandContainer(const CommandContainer &cont, ResponseContainer &rc, CommandTrace &trace);
     virtual Response::ResponseCode
     processExtendedSessionCommand(int /* cmdType */, const SessionCommand & /* cmd */, ResponseContainer & /* rc */)
     {
         return Response::RespFunctionNotAllowed;
     }
-    Response::ResponseCode processRoomCommandContainer(const CommandContainer &cont, ResponseContainer &rc);
-    Response::ResponseCode processGameCommandContainer(const CommandContainer &cont, ResponseContainer &rc);
-    Response::ResponseCode processModeratorCommandContainer(const CommandContainer &cont, ResponseContainer &rc);
+    Response::ResponseCode
+    processRoomCommandContainer(const CommandContainer &cont, ResponseContainer &rc, CommandTrace &trace);
+    Response::ResponseCode
+    processGameCommandContainer(const CommandContainer &cont, ResponseContainer &rc, CommandTrace &trace);
+    /**
+     * Counts the game commands of the container for the flood protection. The commands are run from the last one
+     * down to the index returned; finalResponseCode is set if the user flooded.
+     */
+    int countGameCommands(const CommandContainer &cont, int playerId, Response::ResponseCode &finalResponseCode);
+    Response::ResponseCode
+    processModeratorCommandContainer(const CommandContainer &cont, ResponseContainer &rc, CommandTrace &trace);
     virtual Response::ResponseCode
     processExtendedModeratorCommand(int /* cmdType */, const ModeratorCommand & /* cmd */, ResponseContainer & /* rc */)
     {
         return Response::RespFunctionNotAllowed;
     }
-    Response::ResponseCode processAdminCommandContainer(const CommandContainer &cont, ResponseContainer &rc);
+    Response::ResponseCode
+    processAdminCommandContainer(const CommandContainer &cont, ResponseContainer &rc, CommandTrace &trace);
     virtual Response::ResponseCode
     processExtendedAdminCommand(int /* cmdType */, const AdminCommand & /* cmd */, ResponseContainer & /* rc */)
     {
@@ -101,8 +133,11 @@ private:
     }
 
     void resetIdleTimer();
+    void advanceRateWindows();
+    bool isExemptFromIdleTimeout() const;
 private slots:
-    void pingClockTimeout();
+    void checkDeadlines();
+    void scheduleNextDeadline();
 public slots:
     void prepareDestroy();
 
@@ -124,13 +159,26 @@ public:
     {
         return databaseInterface;
     }
+    bool clientSupportsFeature(const QString &featureName) const override
+    {
+        return clientFeatures.contains(featureName);
+    }
 
     int getLastCommandTime() const
     {
-        return timeRunning - lastDataReceived;
+        return server->getPingClockTicks() - lastDataReceived;
     }
     bool addSaidMessageSize(int size);
-    void processCommandContainer(const CommandContainer &cont);
+    // parseTime is how many nanoseconds it took to parse the container, for the command trace
+    void processCommandContainer(const CommandContainer &cont, qint64 parseTime = 0);
+
+    /**
+     * Hot restart: describes the session for the process taking over, see HandoffSession, and picks it up again on
+     * the other side. The games of the user must have been adopted before, the session goes on in all of them with
+     * nothing to catch up on.
+     */
+    void getHandoffInfo(HandoffSession &result);
+    void restoreHandoff(const HandoffSession &handoff);
 
     void sendProtocolItem(const Response &item);
     void sendProtocolItem(const SessionEvent &item);
@@ -3,8 +3,11 @@
 
 #include "pb/server_message.pb.h"
 
+#include <QByteArray>
 #include <QList>
 #include <QPair>
+#include <QVector>
+#include <google/protobuf/arena.h>
 
 namespace google
 {
@@ -14,6 +17,7 @@ class Message;
 }
 } // namespace google
 class Server_Game;
+class GameEventContainer;
 
 class GameEventStorageItem
 {
@@ -25,12 +29,17 @@ public:
     };
     Q_DECLARE_FLAGS(EventRecipients, EventRecipient)
 private:
-    GameEvent *event;
+    GameEvent *event; // owned by the arena passed to the constructor
     EventRecipients recipients;
 
 public:
-    GameEventStorageItem(const ::google::protobuf::Message &_event, int _playerId, EventRecipients _recipients);
-    ~GameEventStorageItem();
+    GameEventStorageItem() : event(nullptr)
+    {
+    }
+    GameEventStorageItem(::google::protobuf::Arena *arena,
+                         const ::google::protobuf::Message &_event,
+                         int _playerId,
+                         EventRecipients _recipients);
 
     const GameEvent &getGameEvent() const
     {
@@ -43,25 +52,34 @@ public:
 };
 Q_DECLARE_OPERATORS_FOR_FLAGS(GameEventStorageItem::EventRecipients)
 
+/**
+ * Collects the events caused by one command and sends them to the game.
+ *
+ * All protobuf messages built here, including the containers handed to the game, are allocated on an arena
+ * that lives as long as the storage. A command that fans out into many events costs a few arena blocks
+ * instead of a malloc/free pair for every message and sub-message.
+ */
 class GameEventStorage
 {
 private:
+    ::google::protobuf::Arena arena;
     ::google::protobuf::Message *gameEventContext;
-    QList<GameEventStorageItem *> gameEventList;
+    QVector<GameEventStorageItem> gameEventList;
     int privatePlayerId;
     int forcedByJudge = -1;
     bool overwriteOwnership = false;
 
 public:
     GameEventStorage();
-    ~GameEventStorage();
+    GameEventStorage(const GameEventStorage &) = delete;
+    GameEventStorage &operator=(const GameEventStorage &) = delete;
 
     void setGameEventContext(const ::google::protobuf::Message &_gameEventContext);
     ::google::protobuf::Message *getGameEventContext() const
     {
         return gameEventContext;
     }
-    const QList<GameEventStorageItem *> &getGameEventList() const
+    const QVector<GameEventStorageItem> &getGameEventList() const
     {
         return gameEventList;
     }
@@ -83,6 +101,8 @@ public:
                           GameEventStorageItem::EventRecipients recipients = GameEventStorageItem::SendToPrivate |
                                                                              GameEventStorageItem::SendToOthers,
                           int _privatePlayerId = -1);
+    // Builds the arena owned container holding the events meant for the given recipient.
+    GameEventContainer *createGameEventContainer(GameEventStorageItem::EventRecipient recipient);
     void sendToGame(Server_Game *game);
 };
 
@@ -91,7 +111,10 @@ class ResponseContainer
 private:
     int cmdId;
     ::google::protobuf::Message *responseExtension;
+    int serializedExtensionNumber;
+    QByteArray serializedResponseExtension;
     QList<QPair<ServerMessage::MessageType, ::google::protobuf::Message *>> preResponseQueue, postResponseQueue;
+    QList<QByteArray> serializedPostResponseQueue;
 
 public:
     ResponseContainer(int _cmdId);
@@ -109,6 +132,21 @@ public:
     {
         return responseExtension;
     }
+    // Sends an already serialized extension of the given extension number instead of a responseExtension, so that a
+    // large response kept serialized doesn't have to be parsed or copied.
+    void setSerializedResponseExtension(int extensionNumber, const QByteArray &serializedExtension)
+    {
+        serializedExtensionNumber = extensionNumber;
+        serializedResponseExtension = serializedExtension;
+    }
+    int getSerializedExtensionNumber() const
+    {
+        return serializedExtensionNumber;
+    }
+    const QByteArray &getSerializedResponseExtension() const
+    {
+        return serializedResponseExtension;
+    }
     void enqueuePreResponseItem(ServerMessage::MessageType type, ::google::protobuf::Message *item)
     {
         preResponseQueue.append(qMakePair(type, item));
@@ -125,6 +163,15 @@ public:
     {
         return postResponseQueue;
     }
+    // Serialized ServerMessages, sent after the other post response items.
+    void enqueuePostResponseSerializedItem(const QByteArray &serializedMessage)
+    {
+        serializedPostResponseQueue.append(serializedMessage);
+    }
+    const QList<QByteArray> &getSerializedPostResponseQueue() const
+    {
+        return serializedPostResponseQueue;
+    }
 };
 
 #endif
@@ -1,20 +1,24 @@
 #include "server_room.h"
 
+#include "get_pb_extension.h"
 #include "pb/commands.pb.h"
 #include "pb/event_join_room.pb.h"
 #include "pb/event_leave_room.pb.h"
 #include "pb/event_list_games.pb.h"
 #include "pb/event_remove_messages.pb.h"
 #include "pb/event_room_say.pb.h"
+#include "pb/response_filtered_games.pb.h"
 #include "pb/room_commands.pb.h"
 #include "pb/serverinfo_chat_message.pb.h"
-#include "pb/serverinfo_room.pb.h"
+#include "serialized_message.h"
+#include "server.h"
 #include "server_game.h"
 #include "server_protocolhandler.h"
 #include "trice_limits.h"
 
 #include <QDateTime>
 #include <QDebug>
+#include <QTimer>
 #include <google/protobuf/descriptor.h>
 
 Server_Room::Server_Room(int _id,
@@ -27,10 +31,35 @@ Server_Room::Server_Room(int _id,
                          const QString &_joinMessage,
                          const QStringList &_gameTypes,
                          Server *parent)
-    : QObject(parent), id(_id), chatHistorySize(_chatHistorySize), name(_name), description(_description),
-      permissionLevel(_permissionLevel), privilegeLevel(_privilegeLevel), autoJoin(_autoJoin),
-      joinMessage(_joinMessage), gameTypes(_gameTypes), gamesLock(QReadWriteLock::Recursive)
+    : QObject(parent), id(_id), name(_name), description(_description), permissionLevel(_permissionLevel),
+      privilegeLevel(_privilegeLevel), autoJoin(_autoJoin), joinMessage(_joinMessage), gameTypes(_gameTypes),
+      chatHistory(_id, _chatHistorySize), gamesLock(QReadWriteLock::Recursive), snapshotVersion(1),
+      cachedSnapshotVersion(0)
 {
+    properties.set_room_id(id);
+    properties.set_name(name.toStdString());
+    properties.set_description(description.toStdString());
+    properties.set_auto_join(autoJoin);
+    properties.set_permissionlevel(permissionLevel.toStdString());
+    properties.set_privilegelevel(privilegeLevel.toStdString());
+    for (int i = 0; i < gameTypes.size(); ++i) {
+        ServerInfo_GameType *gameTypeInfo = properties.add_gametype_list();
+        gameTypeInfo->set_game_type_id(i);
+        gameTypeInfo->set_description(gameTypes[i].toStdString());
+    }
+    serializedProperties = SerializedMessage::serialize(properties);
+
+    Event_RoomSay joinMessageEvent;
+    joinMessageEvent.set_message(joinMessage.toStdString());
+    joinMessageEvent.set_message_type(Event_RoomSay::Welcome);
+    RoomEvent *joinMessageRoomEvent = prepareRoomEvent(joinMessageEvent);
+    serializedJoinMessage = Server_AbstractUserInterface::serializeRoomEvent(*joinMessageRoomEvent);
+    delete joinMessageRoomEvent;
+
+    gameListUpdateTimer = new QTimer(this);
+    gameListUpdateTimer->setSingleShot(true);
+    connect(gameListUpdateTimer, &QTimer::timeout, this, &Server_Room::flushGameListUpdates);
+
     connect(
         this, &Server_Room::gameListChanged, this, [this](auto gameInfo) { broadcastGameListUpdate(gameInfo); },
         Qt::QueuedConnection);
@@ -49,6 +78,9 @@ Server_Room::~Server_Room()
 
     usersLock.lockForWrite();
     users.clear();
+    chatRecipients.clear();
+    gameListRecipients.clear();
+    userListRecipients.clear();
     usersLock.unlock();
 }
 
@@ -82,15 +114,20 @@ const ServerInfo_Room &
 Server_Room::getInfo(ServerInfo_Room &result, bool complete, bool showGameTypes, bool includeExternalData) const
 {
     result.set_room_id(id);
-    result.set_name(name.toStdString());
-    result.set_description(description.toStdString());
+    result.set_name(properties.name());
+    result.set_description(properties.description());
     result.set_auto_join(autoJoin);
-    result.set_permissionlevel(permissionLevel.toStdString());
-    result.set_privilegelevel(privilegeLevel.toStdString());
-
-    gamesLock.lockForRead();
-    result.set_game_count(games.size() + externalGames.size());
-    if (complete) {
+    result.set_permissionlevel(properties.permissionlevel());
+    result.set_privilegelevel(properties.privilegelevel());
+
+    if (!complete) {
+        // the snapshot has the counts as well, without waiting for the games or users
+        QMutexLocker locker(&snapshotMutex);
+        result.set_game_count(serializedGames.size() + serializedExternalGames.size());
+        result.set_player_count(serializedUsers.size() + serializedExternalUsers.size());
+    } else {
+        gamesLock.lockForRead();
+        result.set_game_count(games.size() + externalGames.size());
         QMapIterator<int, Server_Game *> gameIterator(games);
         while (gameIterator.hasNext())
             gameIterator.next().value()->getInfo(*result.add_game_list());
@@ -99,55 +136,124 @@ Server_Room::getInfo(ServerInfo_Room &result, bool complete, bool showGameTypes,
             while (externalGameIterator.hasNext())
                 result.add_game_list()->CopyFrom(externalGameIterator.next().value());
         }
-    }
-    gamesLock.unlock();
+        gamesLock.unlock();
 
-    usersLock.lockForRead();
-    result.set_player_count(users.size() + externalUsers.size());
-    if (complete) {
+        usersLock.lockForRead();
+        result.set_player_count(users.size() + externalUsers.size());
         QMapIterator<QString, Server_ProtocolHandler *> userIterator(users);
         while (userIterator.hasNext())
-            result.add_user_list()->CopyFrom(userIterator.next().value()->copyUserInfo(false));
+            userIterator.next().value()->copyUserInfo(*result.add_user_list(), false);
         if (includeExternalData) {
             QMapIterator<QString, ServerInfo_User_Container> externalUserIterator(externalUsers);
             while (externalUserIterator.hasNext())
-                result.add_user_list()->CopyFrom(externalUserIterator.next().value().copyUserInfo(false));
+                externalUserIterator.next().value().copyUserInfo(*result.add_user_list(), false);
         }
+        usersLock.unlock();
     }
-    usersLock.unlock();
 
     if (complete || showGameTypes)
-        for (int i = 0; i < gameTypes.size(); ++i) {
-            ServerInfo_GameType *gameTypeInfo = result.add_gametype_list();
-            gameTypeInfo->set_game_type_id(i);
-            gameTypeInfo->set_description(gameTypes[i].toStdString());
-        }
+        result.mutable_gametype_list()->MergeFrom(properties.gametype_list());
 
     return result;
 }
 
+QByteArray Server_Room::getSerializedInfo() const
+{
+    QMutexLocker locker(&snapshotMutex);
+    if (cachedSnapshotVersion == snapshotVersion)
+        return cachedSnapshot;
+
+    ServerInfo_Room counts;
+    counts.set_game_count(serializedGames.size() + serializedExternalGames.size());
+    counts.set_player_count(serializedUsers.size() + serializedExternalUsers.size());
+
+    QByteArray snapshot = serializedProperties + SerializedMessage::serialize(counts);
+    appendSerializedLists(snapshot, true, true);
+
+    cachedSnapshot = snapshot;
+    cachedSnapshotVersion = snapshotVersion;
+    return cachedSnapshot;
+}
+
+void Server_Room::appendSerializedLists(QByteArray &roomInfo, bool withGames, bool withUsers) const
+{
+    // leave room for the tag and length of every entry
+    int size = roomInfo.size();
+    if (withGames) {
+        for (const QByteArray &part : serializedGames)
+            size += part.size() + 6;
+        for (const QByteArray &part : serializedExternalGames)
+            size += part.size() + 6;
+    }
+    if (withUsers) {
+        for (const QByteArray &part : serializedUsers)
+            size += part.size() + 6;
+        for (const QByteArray &part : serializedExternalUsers)
+            size += part.size() + 6;
+    }
+    roomInfo.reserve(size);
+
+    if (withGames) {
+        for (const QByteArray &part : serializedGames)
+            SerializedMessage::appendField(roomInfo, ServerInfo_Room::kGameListFieldNumber, part);
+        for (const QByteArray &part : serializedExternalGames)
+            SerializedMessage::appendField(roomInfo, ServerInfo_Room::kGameListFieldNumber, part);
+    }
+    if (withUsers) {
+        for (const QByteArray &part : serializedUsers)
+            SerializedMessage::appendField(roomInfo, ServerInfo_Room::kUserListFieldNumber, part);
+        for (const QByteArray &part : serializedExternalUsers)
+            SerializedMessage::appendField(roomInfo, ServerInfo_Room::kUserListFieldNumber, part);
+    }
+}
+
+QList<QByteArray> Server_Room::getSerializedChatHistory() const
+{
+    QReadLocker locker(&historyLock);
+    return chatHistory.getSerializedEvents();
+}
+
+qint64 Server_Room::getChatHistoryBytes() const
+{
+    QReadLocker locker(&historyLock);
+    return chatHistory.getMemoryBytes();
+}
+
 RoomEvent *Server_Room::prepareRoomEvent(const ::google::protobuf::Message &roomEvent)
 {
     RoomEvent *event = new RoomEvent;
     event->set_room_id(id);
-    event->GetReflection()
-        ->MutableMessage(event, roomEvent.GetDescriptor()->FindExtensionByName("ext"))
-        ->CopyFrom(roomEvent);
+    setPbExtension(event, roomEvent);
     return event;
 }
 
 void Server_Room::addClient(Server_ProtocolHandler *client)
 {
     Event_JoinRoom event;
-    event.mutable_user_info()->CopyFrom(client->copyUserInfo(false));
-    sendRoomEvent(prepareRoomEvent(event));
+    client->copyUserInfo(*event.mutable_user_info(), false);
+    const QByteArray serializedUser = SerializedMessage::serialize(event.user_info());
 
     ServerInfo_Room roomInfo;
     roomInfo.set_room_id(id);
 
+    // The user is in the snapshot before the event is sent, so a user adding the user list to their interests in
+    // between gets the new user twice rather than not at all. The new user receives events once it was announced.
     usersLock.lockForWrite();
-    users.insert(QString::fromStdString(client->getUserInfo()->name()), client);
+    const QString userName = QString::fromStdString(client->getUserInfo()->name());
+    users.insert(userName, client);
     roomInfo.set_player_count(users.size() + externalUsers.size());
+    snapshotMutex.lock();
+    serializedUsers.insert(userName, serializedUser);
+    ++snapshotVersion;
+    snapshotMutex.unlock();
+    usersLock.unlock();
+
+    sendRoomEvent(prepareRoomEvent(event));
+
+    usersLock.lockForWrite();
+    chatRecipients.insert(userName, client);
+    gameListRecipients.insert(userName, client);
+    userListRecipients.insert(userName, client);
     usersLock.unlock();
 
     // XXX This can be removed during the next client update.
@@ -162,11 +268,22 @@ void Server_Room::addClient(Server_ProtocolHandler *client)
 void Server_Room::removeClient(Server_ProtocolHandler *client)
 {
     usersLock.lockForWrite();
-    users.remove(QString::fromStdString(client->getUserInfo()->name()));
+    const QString userName = QString::fromStdString(client->getUserInfo()->name());
+    users.remove(userName);
+    chatRecipients.remove(userName);
+    gameListRecipients.remove(userName);
+    userListRecipients.remove(userName);
 
     ServerInfo_Room roomInfo;
     roomInfo.set_room_id(id);
     roomInfo.set_player_count(users.size() + externalUsers.size());
+    snapshotMutex.lock();
+    serializedUsers.remove(userName);
+    ++snapshotVersion;
+    snapshotMutex.unlock();
+    gameFiltersMutex.lock();
+    gameFilters.remove(userName);
+    gameFiltersMutex.unlock();
     usersLock.unlock();
 
     Event_LeaveRoom event;
@@ -182,13 +299,56 @@ void Server_Room::removeClient(Server_ProtocolHandler *client)
     emit roomInfoChanged(roomInfo);
 }
 
+void Server_Room::adoptClient(Server_ProtocolHandler *client, quint32 interests)
+{
+    const QString userName = QString::fromStdString(client->getUserInfo()->name());
+    const QByteArray serializedUser = SerializedMessage::serialize(client->copyUserInfo(false));
+
+    ServerInfo_Room roomInfo;
+    roomInfo.set_room_id(id);
+
+    usersLock.lockForWrite();
+    users.insert(userName, client);
+    if (interests & Command_SetRoomInterests::CHAT)
+        chatRecipients.insert(userName, client);
+    if (interests & Command_SetRoomInterests::GAME_LIST)
+        gameListRecipients.insert(userName, client);
+    if (interests & Command_SetRoomInterests::USER_LIST)
+        userListRecipients.insert(userName, client);
+    roomInfo.set_player_count(users.size() + externalUsers.size());
+    snapshotMutex.lock();
+    serializedUsers.insert(userName, serializedUser);
+    ++snapshotVersion;
+    snapshotMutex.unlock();
+    usersLock.unlock();
+
+    gamesLock.lockForRead();
+    roomInfo.set_game_count(games.size() + externalGames.size());
+    gamesLock.unlock();
+
+    emit roomInfoChanged(roomInfo);
+}
+
+quint32 Server_Room::getInterests(const QString &userName) const
+{
+    QReadLocker locker(&usersLock);
+    quint32 interests = 0;
+    if (chatRecipients.contains(userName))
+        interests |= Command_SetRoomInterests::CHAT;
+    if (gameListRecipients.contains(userName))
+        interests |= Command_SetRoomInterests::GAME_LIST;
+    if (userListRecipients.contains(userName))
+        interests |= Command_SetRoomInterests::USER_LIST;
+    return interests;
+}
+
 void Server_Room::addExternalUser(const ServerInfo_User &userInfo)
 {
     // This function is always called from the Server thread with server->roomsMutex locked.
     ServerInfo_User_Container userInfoContainer(userInfo);
     Event_JoinRoom event;
-    event.mutable_user_info()->CopyFrom(userInfoContainer.copyUserInfo(false));
-    sendRoomEvent(prepareRoomEvent(event), false);
+    userInfoContainer.copyUserInfo(*event.mutable_user_info(), false);
+    const QByteArray serializedUser = SerializedMessage::serialize(event.user_info());
 
     ServerInfo_Room roomInfo;
     roomInfo.set_room_id(id);
@@ -196,8 +356,15 @@ void Server_Room::addExternalUser(const ServerInfo_User &userInfo)
     usersLock.lockForWrite();
     externalUsers.insert(QString::fromStdString(userInfo.name()), userInfoContainer);
     roomInfo.set_player_count(users.size() + externalUsers.size());
+    snapshotMutex.lock();
+    serializedExternalUsers.insert(QString::fromStdString(userInfo.name()), serializedUser);
+    ++snapshotVersion;
+    snapshotMutex.unlock();
     usersLock.unlock();
 
+    // after the snapshot, like in addClient()
+    sendRoomEvent(prepareRoomEvent(event), false);
+
     emit roomInfoChanged(roomInfo);
 }
 
@@ -211,6 +378,10 @@ void Server_Room::removeExternalUser(const QString &_name)
     if (externalUsers.contains(_name))
         externalUsers.remove(_name);
     roomInfo.set_player_count(users.size() + externalUsers.size());
+    snapshotMutex.lock();
+    serializedExternalUsers.remove(_name);
+    ++snapshotVersion;
+    snapshotMutex.unlock();
     usersLock.unlock();
 
     Event_LeaveRoom event;
@@ -226,11 +397,26 @@ void Server_Room::updateExternalGameList(const ServerInfo_Game &gameInfo)
     ServerInfo_Room roomInfo;
     roomInfo.set_room_id(id);
 
+    const QByteArray serializedGame = SerializedMessage::serialize(gameInfo);
+
     gamesLock.lockForWrite();
-    if (!gameInfo.has_player_count() && externalGames.contains(gameInfo.game_id()))
+    // a game that moved here from the server sending this, see Server_Game::migrate()
+    if (games.contains(gameInfo.game_id())) {
+        gamesLock.unlock();
+        return;
+    }
+    snapshotMutex.lock();
+    if (!gameInfo.has_player_count() && externalGames.contains(gameInfo.game_id())) {
         externalGames.remove(gameInfo.game_id());
-    else
+        serializedExternalGames.remove(gameInfo.game_id());
+        listedGames.remove(gameInfo.game_id());
+    } else {
         externalGames.insert(gameInfo.game_id(), gameInfo);
+        serializedExternalGames.insert(gameInfo.game_id(), serializedGame);
+        listedGames.insert(gameInfo.game_id(), gameInfo);
+    }
+    ++snapshotVersion;
+    snapshotMutex.unlock();
     roomInfo.set_game_count(games.size() + externalGames.size());
     gamesLock.unlock();
 
@@ -254,9 +440,7 @@ Response::ResponseCode Server_Room::processJoinGameCommand(const Command_JoinGam
             CommandContainer cont;
             cont.set_cmd_id(rc.getCmdId());
             RoomCommand *roomCommand = cont.add_room_command();
-            roomCommand->GetReflection()
-                ->MutableMessage(roomCommand, cmd.GetDescriptor()->FindExtensionByName("ext"))
-                ->CopyFrom(cmd);
+            setPbExtension(roomCommand, cmd);
             getServer()->sendIsl_RoomCommand(cont, externalGames.value(cmd.game_id()).server_id(),
                                              userInterface->getUserInfo()->session_id(), id);
 
@@ -278,26 +462,27 @@ Response::ResponseCode Server_Room::processJoinGameCommand(const Command_JoinGam
 }
 
 void Server_Room::say(const QString &userName, const QString &userMessage, bool sendToIsl)
+{
+    say(userName.toStdString(), userMessage.toStdString(), sendToIsl);
+}
+
+void Server_Room::say(const std::string &userName, const std::string &userMessage, bool sendToIsl)
 {
     Event_RoomSay event;
-    event.set_name(userName.toStdString());
-    event.set_message(userMessage.toStdString());
+    event.set_name(userName);
+    event.set_message(userMessage);
     sendRoomEvent(prepareRoomEvent(event), sendToIsl);
 
-    if (chatHistorySize != 0) {
+    if (chatHistory.isEnabled()) {
         ServerInfo_ChatMessage chatMessage;
         QDateTime dateTime = dateTime.currentDateTimeUtc();
         QString dateTimeString = dateTime.toString();
         chatMessage.set_time(dateTimeString.toStdString());
-        chatMessage.set_sender_name(userName.toStdString());
-        chatMessage.set_message(userMessage.simplified().toStdString());
+        chatMessage.set_sender_name(userName);
+        chatMessage.set_message(QString::fromStdString(userMessage).simplified().toStdString());
 
         historyLock.lockForWrite();
-        if (chatHistory.size() >= chatHistorySize) {
-            chatHistory.removeAt(0);
-        }
-
-        chatHistory.push_back(std::move(chatMessage));
+        chatHistory.append(chatMessage);
         historyLock.unlock();
     }
 }
@@ -305,32 +490,45 @@ void Server_Room::say(const QString &userName, const QString &userMessage, bool
 void Server_Room::removeSaidMessages(const QString &userName, int amount, bool sendToIsl)
 {
     Event_RemoveMessages event;
-    auto stdStringUserName = userName.toStdString();
-    event.set_name(stdStringUserName);
+    event.set_name(userName.toStdString());
     event.set_amount(amount);
     sendRoomEvent(prepareRoomEvent(event), sendToIsl);
 
-    if (chatHistorySize != 0) {
-        int removed = 0;
-        historyLock.lockForWrite();
+    if (chatHistory.isEnabled()) {
         // redact [amount] of the most recent messages from this user from history
-        for (auto message = chatHistory.rbegin(); message != chatHistory.rend() && removed != amount; ++message) {
-            if (message->sender_name() == stdStringUserName) {
-                message->clear_message();
-                ++removed;
-            }
-        }
+        historyLock.lockForWrite();
+        chatHistory.redact(userName, amount);
         historyLock.unlock();
     }
 }
 
+const QMap<QString, Server_ProtocolHandler *> &Server_Room::getRecipients(const RoomEvent &event) const
+{
+    switch (static_cast<RoomEvent::RoomEventType>(getPbExtension(event))) {
+        case RoomEvent::ROOM_SAY:
+        case RoomEvent::REMOVE_MESSAGES:
+            return chatRecipients;
+        case RoomEvent::JOIN_ROOM:
+        case RoomEvent::LEAVE_ROOM:
+            return userListRecipients;
+        case RoomEvent::LIST_GAMES:
+            return gameListRecipients;
+        default:
+            return users;
+    }
+}
+
 void Server_Room::sendRoomEvent(RoomEvent *event, bool sendToIsl)
 {
     usersLock.lockForRead();
-    {
-        QMapIterator<QString, Server_ProtocolHandler *> userIterator(users);
-        while (userIterator.hasNext())
-            userIterator.next().value()->sendProtocolItem(*event);
+    const QMap<QString, Server_ProtocolHandler *> &recipients = getRecipients(*event);
+    if (!recipients.isEmpty()) {
+        // serialized once, all recipients enqueue the same buffer
+        const QByteArray serializedEvent = getServer()->getSendsSerializedMessages()
+                                               ? Server_AbstractUserInterface::serializeRoomEvent(*event)
+                                               : QByteArray();
+        for (Server_ProtocolHandler *user : recipients)
+            user->sendSerializedProtocolItem(*event, serializedEvent);
     }
     usersLock.unlock();
 
@@ -342,9 +540,196 @@ void Server_Room::sendRoomEvent(RoomEvent *event, bool sendToIsl)
 
 void Server_Room::broadcastGameListUpdate(const ServerInfo_Game &gameInfo, bool sendToIsl)
 {
+    // games of other servers are updated by updateExternalGameList()
+    if (sendToIsl) {
+        const QByteArray serializedGame = SerializedMessage::serialize(gameInfo);
+        // the update can arrive after the game was removed, it must not be added back then
+        QMutexLocker locker(&snapshotMutex);
+        auto entry = serializedGames.find(gameInfo.game_id());
+        if (entry != serializedGames.end()) {
+            *entry = serializedGame;
+            listedGames.insert(gameInfo.game_id(), gameInfo);
+            ++snapshotVersion;
+        }
+    }
+
     Event_ListGames event;
     event.add_game_list()->CopyFrom(gameInfo);
-    sendRoomEvent(prepareRoomEvent(event), sendToIsl);
+
+    const int updateInterval = getServer()->getGameListUpdateInterval();
+    if (updateInterval <= 0) {
+        sendGameListEvent(event, sendToIsl);
+        return;
+    }
+
+    // The creator of the game sees the change right away, everyone else gets the changes of all games within the
+    // interval merged into one event.
+    if (gameInfo.has_creator_info()) {
+        usersLock.lockForRead();
+        Server_ProtocolHandler *creator =
+            gameListRecipients.value(QString::fromStdString(gameInfo.creator_info().name()));
+        if (creator) {
+            RoomEvent *roomEvent = prepareRoomEvent(event);
+            creator->sendProtocolItem(*roomEvent);
+            delete roomEvent;
+        }
+        usersLock.unlock();
+    }
+
+    if (sendToIsl)
+        pendingGameListUpdates.insert(gameInfo.game_id(), gameInfo);
+    else
+        pendingExternalGameListUpdates.insert(gameInfo.game_id(), gameInfo);
+    if (!gameListUpdateTimer->isActive())
+        gameListUpdateTimer->start(updateInterval);
+}
+
+void Server_Room::flushGameListUpdates()
+{
+    if (!pendingGameListUpdates.isEmpty()) {
+        Event_ListGames event;
+        for (const ServerInfo_Game &gameInfo : pendingGameListUpdates)
+            event.add_game_list()->CopyFrom(gameInfo);
+        pendingGameListUpdates.clear();
+        sendGameListEvent(event, true);
+    }
+
+    // games of other servers are only sent to the local users
+    if (!pendingExternalGameListUpdates.isEmpty()) {
+        Event_ListGames event;
+        for (const ServerInfo_Game &gameInfo : pendingExternalGameListUpdates)
+            event.add_game_list()->CopyFrom(gameInfo);
+        pendingExternalGameListUpdates.clear();
+        sendGameListEvent(event, false);
+    }
+}
+
+void Server_Room::sendGameListEvent(const Event_ListGames &event, bool sendToIsl)
+{
+    RoomEvent *unfiltered = prepareRoomEvent(event);
+    QByteArray serializedUnfiltered;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    usersLock.lockForRead();
+    gameFiltersMutex.lock();
+    QMapIterator<QString, Server_ProtocolHandler *> userIterator(gameListRecipients);
+    while (userIterator.hasNext()) {
+        userIterator.next();
+        auto registered = gameFilters.find(userIterator.key());
+        if (registered == gameFilters.end()) {
+            if (serializedUnfiltered.isEmpty() && getServer()->getSendsSerializedMessages())
+                serializedUnfiltered = Server_AbstractUserInterface::serializeRoomEvent(*unfiltered);
+            userIterator.value()->sendSerializedProtocolItem(*unfiltered, serializedUnfiltered);
+            continue;
+        }
+
+        Event_ListGames filtered;
+        for (const ServerInfo_Game &gameInfo : event.game_list()) {
+            if (registered->filter.accepts(gameInfo, now)) {
+                registered->shownGames.insert(gameInfo.game_id());
+                filtered.add_game_list()->CopyFrom(gameInfo);
+            } else if (registered->shownGames.remove(gameInfo.game_id())) {
+                // the client drops closed games from its list
+                ServerInfo_Game *removedGame = filtered.add_game_list();
+                removedGame->set_room_id(gameInfo.room_id());
+                removedGame->set_game_id(gameInfo.game_id());
+                removedGame->set_closed(true);
+            }
+        }
+        if (filtered.game_list_size() > 0) {
+            RoomEvent *filteredEvent = prepareRoomEvent(filtered);
+            userIterator.value()->sendProtocolItem(*filteredEvent);
+            delete filteredEvent;
+        }
+    }
+    gameFiltersMutex.unlock();
+    usersLock.unlock();
+
+    if (sendToIsl)
+        getServer()->sendIsl_RoomEvent(*unfiltered);
+    delete unfiltered;
+}
+
+void Server_Room::setGameFilter(const QString &userName,
+                                bool userIsRegistered,
+                                const Command_SetGameFilter &cmd,
+                                Response_FilteredGames &result)
+{
+    const GameFilter filter(cmd.filter(), userIsRegistered);
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const int firstGame = static_cast<int>(cmd.first_game());
+    const int maxGames = static_cast<int>(cmd.max_games());
+
+    // updates sent while this runs either are in the page or are filtered already
+    QMutexLocker filtersLocker(&gameFiltersMutex);
+
+    QSet<int> shownGames;
+    int matchingGames = 0;
+    snapshotMutex.lock();
+    // game ids increase, so the newest games are at the end
+    for (auto it = listedGames.constEnd(); it != listedGames.constBegin();) {
+        --it;
+        if (cmd.has_filter() ? !filter.accepts(it.value(), now) : it.value().closed())
+            continue;
+        if (matchingGames >= firstGame && (maxGames == 0 || result.game_list_size() < maxGames)) {
+            result.add_game_list()->CopyFrom(it.value());
+            shownGames.insert(it.key());
+        }
+        ++matchingGames;
+    }
+    snapshotMutex.unlock();
+    result.set_total_games(matchingGames);
+
+    if (cmd.has_filter())
+        gameFilters.insert(userName, {filter, shownGames});
+    else
+        gameFilters.remove(userName);
+}
+
+QByteArray Server_Room::setInterests(Server_ProtocolHandler *client, quint32 interests)
+{
+    const QString userName = QString::fromStdString(client->getUserInfo()->name());
+    bool addedGameList = false, addedUserList = false;
+
+    ServerInfo_Room header;
+    header.set_room_id(id);
+    QByteArray result = SerializedMessage::serialize(header);
+
+    // The lists are taken while no event can be sent, an update is either in them or is sent afterwards.
+    QWriteLocker locker(&usersLock);
+    if (!users.contains(userName))
+        return result;
+
+    if (interests & Command_SetRoomInterests::CHAT)
+        chatRecipients.insert(userName, client);
+    else
+        chatRecipients.remove(userName);
+
+    if (interests & Command_SetRoomInterests::GAME_LIST) {
+        addedGameList = !gameListRecipients.contains(userName);
+        gameListRecipients.insert(userName, client);
+    } else {
+        gameListRecipients.remove(userName);
+    }
+
+    if (interests & Command_SetRoomInterests::USER_LIST) {
+        addedUserList = !userListRecipients.contains(userName);
+        userListRecipients.insert(userName, client);
+    } else {
+        userListRecipients.remove(userName);
+    }
+
+    if (addedGameList) {
+        // the client gets all games again, it has to set its filter anew
+        QMutexLocker filtersLocker(&gameFiltersMutex);
+        gameFilters.remove(userName);
+    }
+
+    if (addedGameList || addedUserList) {
+        QMutexLocker snapshotLocker(&snapshotMutex);
+        appendSerializedLists(result, addedGameList, addedUserList);
+    }
+    return result;
 }
 
 void Server_Room::addGame(Server_Game *game)
@@ -357,10 +742,18 @@ void Server_Room::addGame(Server_Game *game)
 
     game->gameMutex.lock();
     games.insert(game->getGameId(), game);
+    // a game that moved here was listed as one of the server it came from
+    externalGames.remove(game->getGameId());
     ServerInfo_Game gameInfo;
     game->getInfo(gameInfo);
     roomInfo.set_game_count(games.size() + externalGames.size());
     game->gameMutex.unlock();
+    snapshotMutex.lock();
+    serializedExternalGames.remove(gameInfo.game_id());
+    serializedGames.insert(gameInfo.game_id(), SerializedMessage::serialize(gameInfo));
+    listedGames.insert(gameInfo.game_id(), gameInfo);
+    ++snapshotVersion;
+    snapshotMutex.unlock();
     gamesLock.unlock();
 
     // XXX This can be removed during the next client update.
@@ -385,6 +778,11 @@ void Server_Room::removeGame(Server_Game *game)
     emit gameListChanged(gameInfo);
 
     games.remove(game->getGameId());
+    snapshotMutex.lock();
+    serializedGames.remove(game->getGameId());
+    listedGames.remove(game->getGameId());
+    ++snapshotVersion;
+    snapshotMutex.unlock();
 
     ServerInfo_Room roomInfo;
     roomInfo.set_room_id(id);
@@ -399,31 +797,27 @@ void Server_Room::removeGame(Server_Game *game)
     emit roomInfoChanged(roomInfo);
 }
 
-int Server_Room::getGamesCreatedByUser(const QString &userName) const
+void Server_Room::handOverGame(Server_Game *game, const ServerInfo_Game &gameInfo)
 {
-    QReadLocker locker(&gamesLock);
+    // Like removeGame(), only called with gamesLock and the game mutex locked.
 
-    QMapIterator<int, Server_Game *> gamesIterator(games);
-    int result = 0;
-    while (gamesIterator.hasNext())
-        if (gamesIterator.next().value()->getCreatorInfo()->name() == userName.toStdString())
-            ++result;
-    return result;
+    disconnect(game, 0, this, 0);
+
+    games.remove(game->getGameId());
+    externalGames.insert(gameInfo.game_id(), gameInfo);
+    snapshotMutex.lock();
+    serializedGames.remove(gameInfo.game_id());
+    serializedExternalGames.insert(gameInfo.game_id(), SerializedMessage::serialize(gameInfo));
+    listedGames.insert(gameInfo.game_id(), gameInfo);
+    ++snapshotVersion;
+    snapshotMutex.unlock();
+
+    // the other servers learn about the game from its new host
+    QMetaObject::invokeMethod(this, "broadcastGameListUpdate", Qt::QueuedConnection, Q_ARG(ServerInfo_Game, gameInfo),
+                              Q_ARG(bool, false));
 }
 
-QList<ServerInfo_Game> Server_Room::getGamesOfUser(const QString &userName) const
+int Server_Room::getGamesCreatedByUser(const QString &userName) const
 {
-    QReadLocker locker(&gamesLock);
-
-    QList<ServerInfo_Game> result;
-    QMapIterator<int, Server_Game *> gamesIterator(games);
-    while (gamesIterator.hasNext()) {
-        Server_Game *game = gamesIterator.next().value();
-        if (game->containsUser(userName)) {
-            ServerInfo_Game gameInfo;
-            game->getInfo(gameInfo);
-            result.append(gameInfo);
-        }
-    }
-    return result;
+    return getServer()->getUserGameIndex().getGamesCreatedByUser(id, userName);
 }
@@ -1,17 +1,24 @@
 #ifndef SERVER_ROOM_H
 #define SERVER_ROOM_H
 
+#include "game_filter.h"
 #include "pb/response.pb.h"
 #include "pb/serverinfo_chat_message.pb.h"
+#include "pb/serverinfo_game.pb.h"
+#include "pb/serverinfo_room.pb.h"
+#include "room_chat_history.h"
 #include "serverinfo_user_container.h"
 
+#include <QByteArray>
 #include <QList>
 #include <QMap>
 #include <QMutex>
 #include <QObject>
 #include <QReadWriteLock>
+#include <QSet>
 #include <QStringList>
 
+class QTimer;
 class Server_DatabaseInterface;
 class Server_ProtocolHandler;
 class RoomEvent;
@@ -22,6 +29,9 @@ class Server_Game;
 class Server;
 
 class Command_JoinGame;
+class Command_SetGameFilter;
+class Event_ListGames;
+class Response_FilteredGames;
 class ResponseContainer;
 class Server_AbstractUserInterface;
 
@@ -34,7 +44,6 @@ signals:
 
 private:
     int id;
-    int chatHistorySize;
     QString name;
     QString description;
     QString permissionLevel;
@@ -45,10 +54,50 @@ private:
     QMap<int, Server_Game *> games;
     QMap<int, ServerInfo_Game> externalGames;
     QMap<QString, Server_ProtocolHandler *> users;
+    // the users receiving the events of each interest, see setInterests()
+    QMap<QString, Server_ProtocolHandler *> chatRecipients, gameListRecipients, userListRecipients;
     QMap<QString, ServerInfo_User_Container> externalUsers;
-    QList<ServerInfo_ChatMessage> chatHistory;
+    RoomChatHistory chatHistory;
+    QByteArray serializedJoinMessage;
+    // the fixed fields and the game types of getInfo(), converted to UTF-8 once
+    ServerInfo_Room properties;
+
+    // The complete room info sent to joining clients, kept serialized in parts that are updated along with the games
+    // and users above. Guarded by snapshotMutex, which is locked after any other lock of the room.
+    mutable QMutex snapshotMutex;
+    QByteArray serializedProperties;
+    QMap<int, QByteArray> serializedGames, serializedExternalGames;
+    QMap<QString, QByteArray> serializedUsers, serializedExternalUsers;
+    // the local and external games by game id, for filtering them
+    QMap<int, ServerInfo_Game> listedGames;
+    // bumped on every change of the parts, the assembled snapshot is rebuilt when it is out of date
+    quint64 snapshotVersion;
+    mutable quint64 cachedSnapshotVersion;
+    mutable QByteArray cachedSnapshot;
+
+    // Game list changes waiting to be sent as one event, the latest state of every changed game by game id. Only
+    // touched by the thread of the room.
+    QMap<int, ServerInfo_Game> pendingGameListUpdates, pendingExternalGameListUpdates;
+    QTimer *gameListUpdateTimer;
+
+    struct RegisteredGameFilter
+    {
+        GameFilter filter;
+        // the games the user was sent and didn't see closing yet
+        QSet<int> shownGames;
+    };
+    // by user name, locked after usersLock
+    mutable QMutex gameFiltersMutex;
+    QMap<QString, RegisteredGameFilter> gameFilters;
+
+    // with usersLock locked
+    const QMap<QString, Server_ProtocolHandler *> &getRecipients(const RoomEvent &event) const;
+    // with snapshotMutex locked
+    void appendSerializedLists(QByteArray &roomInfo, bool withGames, bool withUsers) const;
+    void sendGameListEvent(const Event_ListGames &event, bool sendToIsl);
 private slots:
     void broadcastGameListUpdate(const ServerInfo_Game &gameInfo, bool sendToIsl = true);
+    void flushGameListUpdates();
 
 public:
     mutable QReadWriteLock usersLock;
@@ -109,15 +158,44 @@ public:
     Server *getServer() const;
     const ServerInfo_Room &
     getInfo(ServerInfo_Room &result, bool complete, bool showGameTypes = false, bool includeExternalData = true) const;
+    // The same as a complete getInfo() including external data, serialized. Doesn't lock the games or users.
+    QByteArray getSerializedInfo() const;
     int getGamesCreatedByUser(const QString &name) const;
-    QList<ServerInfo_Game> getGamesOfUser(const QString &name) const;
-    QList<ServerInfo_ChatMessage> &getChatHistory()
+    // the serialized ServerMessages of the chat history for joining users, oldest first
+    QList<QByteArray> getSerializedChatHistory() const;
+    qint64 getChatHistoryBytes() const;
+    // the serialized ServerMessage of the welcome message
+    const QByteArray &getSerializedJoinMessage() const
     {
-        return chatHistory;
+        return serializedJoinMessage;
     }
 
+    /**
+     * Fills result with a page of the games passing the filter of cmd and registers the filter for the user, or
+     * removes their filter if cmd has none.
+     */
+    void setGameFilter(const QString &userName,
+                       bool userIsRegistered,
+                       const Command_SetGameFilter &cmd,
+                       Response_FilteredGames &result);
+
+    /**
+     * Sets which events of the room are sent to the client, a combination of Command_SetRoomInterests::Interest
+     * values. Returns a serialized ServerInfo_Room holding the current game and user lists of the interests that were
+     * added. Adding the game list removes the game filter of the user.
+     */
+    QByteArray setInterests(Server_ProtocolHandler *client, quint32 interests);
+
+    // the Command_SetRoomInterests::Interest values of the events the user receives, see setInterests()
+    quint32 getInterests(const QString &userName) const;
+
     void addClient(Server_ProtocolHandler *client);
     void removeClient(Server_ProtocolHandler *client);
+    /**
+     * Puts back a client carried over by a hot restart with the interests it had, without announcing it to the
+     * others, who never saw it leave. Its game filter is not carried over.
+     */
+    void adoptClient(Server_ProtocolHandler *client, quint32 interests);
 
     void addExternalUser(const ServerInfo_User &userInfo);
     void removeExternalUser(const QString &_name);
@@ -132,10 +210,16 @@ public:
                                                   Server_AbstractUserInterface *userInterface);
 
     void say(const QString &userName, const QString &s, bool sendToIsl = true);
+    // the same for the UTF-8 strings of the protocol, which go into the events without being converted
+    void say(const std::string &userName, const std::string &s, bool sendToIsl = true);
     void removeSaidMessages(const QString &userName, int amount, bool sendToIsl = true);
 
     void addGame(Server_Game *game);
     void removeGame(Server_Game *game);
+    /**
+     * Lists a game that moved to another server as one of that server's games, gameInfo names the server.
+     */
+    void handOverGame(Server_Game *game, const ServerInfo_Game &gameInfo);
 
     void sendRoomEvent(RoomEvent *event, bool sendToIsl = true);
     RoomEvent *prepareRoomEvent(const ::google::protobuf::Message &roomEvent);
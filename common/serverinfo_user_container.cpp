@@ -2,6 +2,8 @@
 
 #include "pb/serverinfo_user.pb.h"
 
+#include <QMutexLocker>
+
 ServerInfo_User_Container::ServerInfo_User_Container(ServerInfo_User *_userInfo) : userInfo(_userInfo)
 {
 }
@@ -17,6 +19,26 @@ ServerInfo_User_Container::ServerInfo_User_Container(const ServerInfo_User_Conta
         userInfo = new ServerInfo_User(*other.userInfo);
     else
         userInfo = nullptr;
+    // the copy holds the same user info, so it can share the public one
+    QMutexLocker locker(&other.publicUserInfoMutex);
+    publicUserInfo = other.publicUserInfo;
+}
+
+ServerInfo_User_Container &ServerInfo_User_Container::operator=(const ServerInfo_User_Container &other)
+{
+    if (this == &other)
+        return *this;
+
+    delete userInfo;
+    userInfo = other.userInfo ? new ServerInfo_User(*other.userInfo) : nullptr;
+    std::shared_ptr<const ServerInfo_User> otherPublicUserInfo;
+    {
+        QMutexLocker locker(&other.publicUserInfoMutex);
+        otherPublicUserInfo = other.publicUserInfo;
+    }
+    QMutexLocker locker(&publicUserInfoMutex);
+    publicUserInfo = std::move(otherPublicUserInfo);
+    return *this;
 }
 
 ServerInfo_User_Container::~ServerInfo_User_Container()
@@ -26,7 +48,31 @@ ServerInfo_User_Container::~ServerInfo_User_Container()
 
 void ServerInfo_User_Container::setUserInfo(const ServerInfo_User &_userInfo)
 {
+    delete userInfo;
     userInfo = new ServerInfo_User(_userInfo);
+    userInfoChanged();
+}
+
+void ServerInfo_User_Container::userInfoChanged()
+{
+    QMutexLocker locker(&publicUserInfoMutex);
+    publicUserInfo.reset();
+}
+
+std::shared_ptr<const ServerInfo_User> ServerInfo_User_Container::getPublicUserInfo() const
+{
+    QMutexLocker locker(&publicUserInfoMutex);
+    if (!publicUserInfo && userInfo) {
+        auto info = std::make_shared<ServerInfo_User>(*userInfo);
+        info->clear_session_id();
+        info->clear_address();
+        info->clear_clientid();
+        info->clear_id();
+        info->clear_email();
+        info->clear_avatar_bmp();
+        publicUserInfo = std::move(info);
+    }
+    return publicUserInfo;
 }
 
 ServerInfo_User &ServerInfo_User_Container::copyUserInfo(ServerInfo_User &result,
@@ -34,6 +80,12 @@ ServerInfo_User &ServerInfo_User_Container::copyUserInfo(ServerInfo_User &result
                                                          bool internalInfo,
                                                          bool sessionInfo) const
 {
+    if (!complete && !internalInfo && !sessionInfo) {
+        if (const std::shared_ptr<const ServerInfo_User> info = getPublicUserInfo())
+            result.CopyFrom(*info);
+        return result;
+    }
+
     if (userInfo) {
         result.CopyFrom(*userInfo);
         if (!sessionInfo) {
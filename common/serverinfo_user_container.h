@@ -1,6 +1,9 @@
 #ifndef SERVERINFO_USER_CONTAINER
 #define SERVERINFO_USER_CONTAINER
 
+#include <QMutex>
+#include <memory>
+
 class ServerInfo_User;
 
 class ServerInfo_User_Container
@@ -8,17 +11,31 @@ class ServerInfo_User_Container
 protected:
     ServerInfo_User *userInfo;
 
+    // changes made to userInfo in place have to be followed by this, so the shared public info is built again
+    void userInfoChanged();
+
+private:
+    // what copyUserInfo(false) returns, built once and shared by all lists and events the user appears in until the
+    // user info changes
+    mutable QMutex publicUserInfoMutex;
+    mutable std::shared_ptr<const ServerInfo_User> publicUserInfo;
+
 public:
     explicit ServerInfo_User_Container(ServerInfo_User *_userInfo = nullptr);
     explicit ServerInfo_User_Container(const ServerInfo_User &_userInfo);
     ServerInfo_User_Container(const ServerInfo_User_Container &other);
-    ServerInfo_User_Container &operator=(const ServerInfo_User_Container &other) = default;
+    ServerInfo_User_Container &operator=(const ServerInfo_User_Container &other);
     virtual ~ServerInfo_User_Container();
     ServerInfo_User *getUserInfo() const
     {
         return userInfo;
     }
     void setUserInfo(const ServerInfo_User &_userInfo);
+    /**
+     * The user info without the avatar, the session and the internal fields, as everybody may see it. The record is
+     * immutable and stays valid after the user info changes, it just isn't returned anymore then.
+     */
+    std::shared_ptr<const ServerInfo_User> getPublicUserInfo() const;
     ServerInfo_User &
     copyUserInfo(ServerInfo_User &result, bool complete, bool internalInfo = false, bool sessionInfo = false) const;
     ServerInfo_User copyUserInfo(bool complete, bool internalInfo = false, bool sessionInfo = false) const;
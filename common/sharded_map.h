@@ -0,0 +1,127 @@
+#ifndef SHARDED_MAP_H
+#define SHARDED_MAP_H
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QReadWriteLock>
+#include <atomic>
+
+/**
+ * A map split into a fixed number of independently locked shards, selected by the hash of the key.
+ *
+ * Every operation takes the lock of exactly one shard for the duration of the map access only, so
+ * inserting or removing an entry never blocks lookups of keys living in other shards. The shard locks
+ * are leaf locks: no other lock is ever acquired while one of them is held, which means they can be
+ * taken in any lock context.
+ *
+ * The map only stores the values; it does not manage the lifetime of whatever they point to.
+ */
+template <typename Key, typename T, int ShardCount = 16> class ShardedMap
+{
+public:
+    ShardedMap() : count(0)
+    {
+    }
+
+    void insert(const Key &key, const T &value)
+    {
+        Shard &shard = shardFor(key);
+        QWriteLocker locker(&shard.lock);
+        if (!shard.map.contains(key))
+            ++count;
+        shard.map.insert(key, value);
+    }
+
+    /**
+     * Removes the entry for key, but only if it still maps to expected. This keeps a stale owner
+     * from removing an entry that has been taken over in the meantime.
+     */
+    bool remove(const Key &key, const T &expected)
+    {
+        Shard &shard = shardFor(key);
+        QWriteLocker locker(&shard.lock);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end() || it.value() != expected)
+            return false;
+        shard.map.erase(it);
+        --count;
+        return true;
+    }
+
+    T value(const Key &key, const T &defaultValue = T()) const
+    {
+        const Shard &shard = shardFor(key);
+        QReadLocker locker(&shard.lock);
+        return shard.map.value(key, defaultValue);
+    }
+
+    bool contains(const Key &key) const
+    {
+        const Shard &shard = shardFor(key);
+        QReadLocker locker(&shard.lock);
+        return shard.map.contains(key);
+    }
+
+    int size() const
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns a snapshot of all values. Shards are visited one after the other, so the result is
+     * not an atomic view of the whole map and is only ordered by key within each shard.
+     */
+    QList<T> values() const
+    {
+        QList<T> result;
+        result.reserve(size());
+        for (const Shard &shard : shards) {
+            QReadLocker locker(&shard.lock);
+            result.append(shard.map.values());
+        }
+        return result;
+    }
+
+    /**
+     * Returns the values of up to count entries, in key order, whose keys come after the given one. Like values()
+     * this is not an atomic view, but calling it repeatedly with the last key returned visits every entry that
+     * stays in the map the whole time exactly once.
+     */
+    QList<T> valuesAfter(const Key &key, int count) const
+    {
+        QMap<Key, T> candidates;
+        for (const Shard &shard : shards) {
+            QReadLocker locker(&shard.lock);
+            auto it = shard.map.upperBound(key);
+            for (int i = 0; i < count && it != shard.map.constEnd(); ++i, ++it)
+                candidates.insert(it.key(), it.value());
+        }
+
+        QList<T> result;
+        for (auto it = candidates.constBegin(); it != candidates.constEnd() && result.size() < count; ++it)
+            result.append(it.value());
+        return result;
+    }
+
+private:
+    struct Shard
+    {
+        mutable QReadWriteLock lock;
+        QMap<Key, T> map;
+    };
+
+    Shard shards[ShardCount];
+    std::atomic<int> count;
+
+    Shard &shardFor(const Key &key)
+    {
+        return shards[qHash(key) % ShardCount];
+    }
+    const Shard &shardFor(const Key &key) const
+    {
+        return shards[qHash(key) % ShardCount];
+    }
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "spectator_stream.h"
+
+SpectatorStream::SpectatorStream(qint64 _delay, const Item &initialSnapshot)
+    : delay(_delay), firstPosition(0), released(0)
+{
+    snapshots.append(qMakePair(qint64(0), initialSnapshot));
+}
+
+void SpectatorStream::append(const Item &item)
+{
+    items.append(item);
+}
+
+void SpectatorStream::addSnapshot(qint64 position, const Item &snapshot)
+{
+    if (snapshots.last().first == position)
+        snapshots.last().second = snapshot;
+    else
+        snapshots.append(qMakePair(position, snapshot));
+}
+
+QList<SpectatorStream::Item> SpectatorStream::release(qint64 now, bool all)
+{
+    QList<Item> result;
+    const qint64 head = getHead();
+    while (released < head) {
+        const Item &item = items.at(static_cast<int>(released - firstPosition));
+        if (!all && item.appendedAt > now - delay)
+            break;
+        result.append(item);
+        ++released;
+    }
+    dropUnneeded();
+    return result;
+}
+
+void SpectatorStream::getJoinPoint(Item &snapshot, QList<Item> &catchUp) const
+{
+    const int snapshotIndex = newestReleasedSnapshot();
+    const qint64 position = snapshots.at(snapshotIndex).first;
+    snapshot = snapshots.at(snapshotIndex).second;
+    catchUp = items.mid(static_cast<int>(position - firstPosition), static_cast<int>(released - position));
+}
+
+int SpectatorStream::newestReleasedSnapshot() const
+{
+    // the first one is released, everything before it was dropped
+    int i = snapshots.size() - 1;
+    while (i > 0 && snapshots.at(i).first > released)
+        --i;
+    return i;
+}
+
+void SpectatorStream::dropUnneeded()
+{
+    // joining spectators start at the newest released snapshot, the ones before it and their items aren't needed
+    const int snapshotIndex = newestReleasedSnapshot();
+    snapshots.erase(snapshots.begin(), snapshots.begin() + snapshotIndex);
+    const auto dropped = static_cast<int>(snapshots.first().first - firstPosition);
+    items.erase(items.begin(), items.begin() + dropped);
+    firstPosition += dropped;
+}
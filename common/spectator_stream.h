@@ -0,0 +1,90 @@
+#ifndef SPECTATOR_STREAM_H
+#define SPECTATOR_STREAM_H
+
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <memory>
+
+class GameEventContainer;
+
+/**
+ * The game events the spectators of a game get, kept once for all of them instead of being sent to every spectator
+ * as they happen.
+ *
+ * Events are appended at the head of the stream and released to the spectators in batches once they are older than
+ * the delay. Snapshots of the game state, as the spectators see it, are taken at positions of the stream. A spectator
+ * joining gets the newest snapshot that was released already and the events released after it, and then follows the
+ * stream like everybody else. What no joining spectator can need any more is dropped.
+ */
+class SpectatorStream
+{
+public:
+    struct Item
+    {
+        std::shared_ptr<const GameEventContainer> container;
+        // the ServerMessage holding the container; empty if the server doesn't send serialized messages
+        QByteArray serializedMessage;
+        // spectators whose client supports this feature don't get the item
+        QString skippedClientFeature;
+        // [ms]
+        qint64 appendedAt = 0;
+    };
+
+    // delay [ms], the stream starts with the snapshot of the game at position 0
+    SpectatorStream(qint64 _delay, const Item &initialSnapshot);
+
+    qint64 getDelay() const
+    {
+        return delay;
+    }
+    // the position of the next item appended
+    qint64 getHead() const
+    {
+        return firstPosition + items.size();
+    }
+    // the items before this position were released
+    qint64 getReleased() const
+    {
+        return released;
+    }
+    qint64 getNewestSnapshotPosition() const
+    {
+        return snapshots.last().first;
+    }
+    qint64 getNewestSnapshotTime() const
+    {
+        return snapshots.last().second.appendedAt;
+    }
+
+    void append(const Item &item);
+    /**
+     * Adds a snapshot of the game state with all items before position applied; position is at most the head and
+     * not before the newest snapshot.
+     */
+    void addSnapshot(qint64 position, const Item &snapshot);
+    /**
+     * Releases the items that are older than the delay at now [ms], or all of them, and returns them.
+     */
+    QList<Item> release(qint64 now, bool all = false);
+    /**
+     * What a spectator joining now has to be sent before following the stream.
+     */
+    void getJoinPoint(Item &snapshot, QList<Item> &catchUp) const;
+
+private:
+    qint64 delay;
+    QList<Item> items;
+    // the position of the first item in items
+    qint64 firstPosition;
+    qint64 released;
+    // by position
+    QList<QPair<qint64, Item>> snapshots;
+
+    // the index in snapshots of the newest released snapshot, there always is one
+    int newestReleasedSnapshot() const;
+    void dropUnneeded();
+};
+
+#endif
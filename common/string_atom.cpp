@@ -0,0 +1,138 @@
+#include "string_atom.h"
+
+#include <QAtomicInt>
+#include <QReadWriteLock>
+
+struct StringAtom::Data
+{
+    const QString string;
+    const std::string utf8;
+    QAtomicInt ref;
+
+    explicit Data(const QString &_string) : string(_string), utf8(_string.toStdString()), ref(1)
+    {
+    }
+};
+
+class StringAtomTable
+{
+public:
+    static StringAtomTable &instance()
+    {
+        // never destroyed, atoms held by other static objects may still be released during shutdown
+        static auto *table = new StringAtomTable;
+        return *table;
+    }
+
+    StringAtom::Data *intern(const QString &string)
+    {
+        {
+            QReadLocker locker(&lock);
+            StringAtom::Data *d = entries.value(string);
+            if (d) {
+                // the last reference can only be dropped while holding the write lock, so d stays alive
+                d->ref.ref();
+                return d;
+            }
+        }
+
+        QWriteLocker locker(&lock);
+        StringAtom::Data *&d = entries[string];
+        if (d)
+            d->ref.ref();
+        else
+            d = new StringAtom::Data(string);
+        return d;
+    }
+
+    StringAtom::Data *find(const QString &string)
+    {
+        QReadLocker locker(&lock);
+        StringAtom::Data *d = entries.value(string);
+        if (d)
+            d->ref.ref();
+        return d;
+    }
+
+    void release(StringAtom::Data *d)
+    {
+        // Dropping a reference other than the last one needs no lock. Going from one to zero is done
+        // under the write lock so that a concurrent intern() can't pick up an entry that is being freed.
+        for (;;) {
+            const int ref = d->ref.loadAcquire();
+            if (ref == 1)
+                break;
+            if (d->ref.testAndSetOrdered(ref, ref - 1))
+                return;
+        }
+
+        QWriteLocker locker(&lock);
+        if (!d->ref.deref()) {
+            entries.remove(d->string);
+            delete d;
+        }
+    }
+
+    int size() const
+    {
+        QReadLocker locker(&lock);
+        return entries.size();
+    }
+
+private:
+    mutable QReadWriteLock lock;
+    QHash<QString, StringAtom::Data *> entries;
+};
+
+StringAtom::StringAtom(const QString &string)
+    : d(string.isEmpty() ? nullptr : StringAtomTable::instance().intern(string))
+{
+}
+
+StringAtom::StringAtom(const StringAtom &other) : d(other.d)
+{
+    if (d)
+        d->ref.ref();
+}
+
+StringAtom &StringAtom::operator=(const StringAtom &other)
+{
+    if (d == other.d)
+        return *this;
+    if (other.d)
+        other.d->ref.ref();
+    if (d)
+        StringAtomTable::instance().release(d);
+    d = other.d;
+    return *this;
+}
+
+StringAtom::~StringAtom()
+{
+    if (d)
+        StringAtomTable::instance().release(d);
+}
+
+StringAtom StringAtom::find(const QString &string)
+{
+    if (string.isEmpty())
+        return StringAtom();
+    return StringAtom(StringAtomTable::instance().find(string));
+}
+
+int StringAtom::tableSize()
+{
+    return StringAtomTable::instance().size();
+}
+
+const QString &StringAtom::toString() const
+{
+    static const QString empty;
+    return d ? d->string : empty;
+}
+
+const std::string &StringAtom::toStdString() const
+{
+    static const std::string empty;
+    return d ? d->utf8 : empty;
+}
@@ -0,0 +1,69 @@
+#ifndef STRING_ATOM_H
+#define STRING_ATOM_H
+
+#include <QString>
+#include <string>
+
+/**
+ * A reference to one entry of the process wide, thread safe string table.
+ *
+ * Equal strings are interned into the same entry, so two atoms compare equal exactly when they point to
+ * the same entry and every holder shares a single copy of the string data. Entries are reference counted
+ * and removed from the table once the last atom referring to them is gone, which keeps strings made up by
+ * clients (token names, for instance) from piling up for the lifetime of the process.
+ *
+ * The empty string is represented by the null atom and never enters the table.
+ *
+ * Each entry keeps the UTF-8 form of the string as well, so that atoms are written to protobuf messages without
+ * converting them every time.
+ */
+class StringAtom
+{
+public:
+    StringAtom() : d(nullptr)
+    {
+    }
+    explicit StringAtom(const QString &string);
+    StringAtom(const StringAtom &other);
+    StringAtom &operator=(const StringAtom &other);
+    ~StringAtom();
+
+    /**
+     * Returns the atom for string if it is interned already, or the null atom otherwise. Unlike the
+     * constructor this never adds an entry, which makes it the right choice for lookups with untrusted
+     * input.
+     */
+    static StringAtom find(const QString &string);
+    /**
+     * Number of distinct strings currently interned.
+     */
+    static int tableSize();
+
+    bool isNull() const
+    {
+        return d == nullptr;
+    }
+    const QString &toString() const;
+    const std::string &toStdString() const;
+
+    bool operator==(const StringAtom &other) const
+    {
+        return d == other.d;
+    }
+    bool operator!=(const StringAtom &other) const
+    {
+        return d != other.d;
+    }
+
+private:
+    struct Data;
+    friend class StringAtomTable;
+
+    Data *d;
+
+    explicit StringAtom(Data *_d) : d(_d)
+    {
+    }
+};
+
+#endif
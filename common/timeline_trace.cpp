@@ -0,0 +1,171 @@
+#include "timeline_trace.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+
+namespace
+{
+
+struct Event
+{
+    const char *label;
+    TimelineTrace::Category category;
+    qint64 startTime, endTime;
+    QString detail;
+};
+
+class ThreadTimeline
+{
+public:
+    QMutex mutex;
+    // a ring, next is where the oldest event is once it is full
+    QVector<Event> events;
+    int next = 0;
+    bool full = false;
+    // the start() the events belong to
+    int generation = -1;
+    int threadId;
+    QString threadName;
+};
+
+class TimelineRegistry
+{
+public:
+    static TimelineRegistry &instance()
+    {
+        // never destroyed, like the registry of CommandTrace
+        static auto *registry = new TimelineRegistry;
+        return *registry;
+    }
+
+    TimelineRegistry()
+    {
+        clock.start();
+    }
+
+    ThreadTimeline *timelineOfThisThread()
+    {
+        static thread_local ThreadTimeline *timeline = nullptr;
+        if (!timeline) {
+            timeline = new ThreadTimeline;
+            const QString name = QThread::currentThread() ? QThread::currentThread()->objectName() : QString();
+            QMutexLocker locker(&mutex);
+            timeline->threadId = threads.size() + 1;
+            timeline->threadName = name.isEmpty() ? QString("thread %1").arg(timeline->threadId) : name;
+            threads.append(timeline);
+        }
+        return timeline;
+    }
+
+    QElapsedTimer clock;
+    std::atomic<int> generation{0};
+    std::atomic<int> eventsPerThread{0};
+    QMutex mutex;
+    QList<ThreadTimeline *> threads;
+};
+
+const char *const categoryNames[] = {"lock", "command", "database", "flush"};
+
+} // namespace
+
+void TimelineTrace::start(int eventsPerThread)
+{
+    TimelineRegistry &registry = TimelineRegistry::instance();
+    registry.eventsPerThread = qMax(eventsPerThread, 1);
+    // the buffers of the threads start over with their next event
+    ++registry.generation;
+    running = true;
+}
+
+void TimelineTrace::stop()
+{
+    running = false;
+}
+
+qint64 TimelineTrace::now()
+{
+    return isRunning() ? TimelineRegistry::instance().clock.nsecsElapsed() : 0;
+}
+
+void TimelineTrace::record(Category category, const char *label, qint64 startTime, const QString &detail)
+{
+    if (isRunning())
+        record(category, label, startTime, now(), detail);
+}
+
+void TimelineTrace::record(Category category,
+                           const char *label,
+                           qint64 startTime,
+                           qint64 endTime,
+                           const QString &detail)
+{
+    // started before the timeline was
+    if (!isRunning() || startTime == 0)
+        return;
+
+    TimelineRegistry &registry = TimelineRegistry::instance();
+    ThreadTimeline *timeline = registry.timelineOfThisThread();
+    const int generation = registry.generation;
+    QMutexLocker locker(&timeline->mutex);
+    if (timeline->generation != generation) {
+        timeline->events.clear();
+        timeline->events.resize(registry.eventsPerThread);
+        timeline->next = 0;
+        timeline->full = false;
+        timeline->generation = generation;
+    }
+    timeline->events[timeline->next] = {label, category, startTime, endTime, detail};
+    if (++timeline->next == timeline->events.size()) {
+        timeline->next = 0;
+        timeline->full = true;
+    }
+}
+
+QByteArray TimelineTrace::toChromeTrace()
+{
+    TimelineRegistry &registry = TimelineRegistry::instance();
+    // the JSON numbers are doubles anyway
+    const double pid = static_cast<double>(QCoreApplication::applicationPid());
+    const int generation = registry.generation;
+
+    QJsonArray traceEvents;
+    QMutexLocker locker(&registry.mutex);
+    for (ThreadTimeline *timeline : registry.threads) {
+        QMutexLocker timelineLocker(&timeline->mutex);
+        if (timeline->generation != generation)
+            continue;
+
+        traceEvents.append(QJsonObject{{"name", "thread_name"},
+                                       {"ph", "M"},
+                                       {"pid", pid},
+                                       {"tid", timeline->threadId},
+                                       {"args", QJsonObject{{"name", timeline->threadName}}}});
+
+        const int count = timeline->full ? timeline->events.size() : timeline->next;
+        const int first = timeline->full ? timeline->next : 0;
+        for (int i = 0; i < count; ++i) {
+            const Event &event = timeline->events.at((first + i) % timeline->events.size());
+            // complete events, in microseconds
+            QJsonObject object{{"name", event.label},
+                               {"cat", categoryNames[event.category]},
+                               {"ph", "X"},
+                               {"ts", event.startTime / 1000.0},
+                               {"dur", (event.endTime - event.startTime) / 1000.0},
+                               {"pid", pid},
+                               {"tid", timeline->threadId}};
+            if (!event.detail.isEmpty())
+                object.insert("args", QJsonObject{{"detail", event.detail}});
+            traceEvents.append(object);
+        }
+    }
+
+    return QJsonDocument(QJsonObject{{"traceEvents", traceEvents}, {"displayTimeUnit", "ms"}})
+        .toJson(QJsonDocument::Compact);
+}
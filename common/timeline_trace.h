@@ -0,0 +1,50 @@
+#ifndef TIMELINE_TRACE_H
+#define TIMELINE_TRACE_H
+
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+
+/**
+ * An on demand timeline of what the threads of the server spend their time on: lock waits, command handling,
+ * database queries and socket flushes. Where the percentiles of CommandTrace say that commands wait for locks,
+ * the timeline shows which threads held them meanwhile.
+ *
+ * Every thread records into a ring buffer of its own, so the last eventsPerThread events of each thread are kept.
+ * While the timeline isn't running, now() and record() cost a single atomic load. toChromeTrace() writes the buffers
+ * as the JSON of chrome://tracing, which the Perfetto UI opens as well.
+ */
+class TimelineTrace
+{
+public:
+    enum Category
+    {
+        LockWait,
+        Command,
+        Database,
+        Flush
+    };
+
+    // starts over, the events recorded before are dropped
+    static void start(int eventsPerThread);
+    static void stop();
+    static bool isRunning()
+    {
+        return running.load(std::memory_order_relaxed);
+    }
+    // nanoseconds on the clock of the timeline, 0 while it isn't running
+    static qint64 now();
+    /**
+     * Records an event from startTime, as returned by now(), until now. label has to be a string literal; detail is
+     * shown along with it, e.g. the name of the command or statement.
+     */
+    static void record(Category category, const char *label, qint64 startTime, const QString &detail = QString());
+    static void record(Category category, const char *label, qint64 startTime, qint64 endTime, const QString &detail);
+    // the events recorded since the last start(), also while the timeline is still running
+    static QByteArray toChromeTrace();
+
+private:
+    static inline std::atomic<bool> running{false};
+};
+
+#endif
@@ -0,0 +1,61 @@
+#include "user_game_index.h"
+
+static void removeFromIndex(QHash<QString, QSet<int>> &index, const QString &userName, int gameId)
+{
+    auto entry = index.find(userName);
+    if (entry == index.end())
+        return;
+    entry->remove(gameId);
+    if (entry->isEmpty())
+        index.erase(entry);
+}
+
+void UserGameIndex::setMembers(int roomId, int gameId, const QString &creatorName, const QSet<QString> &memberNames)
+{
+    QMutexLocker locker(&mutex);
+    auto game = games.find(gameId);
+    if (game == games.end()) {
+        game = games.insert(gameId, {roomId, creatorName, {}});
+        gamesByCreator[creatorName].insert(gameId);
+    }
+
+    for (const QString &userName : game->memberNames)
+        if (!memberNames.contains(userName))
+            removeFromIndex(gamesByMember, userName, gameId);
+    for (const QString &userName : memberNames)
+        if (!game->memberNames.contains(userName))
+            gamesByMember[userName].insert(gameId);
+    game->memberNames = memberNames;
+}
+
+void UserGameIndex::removeGame(int gameId)
+{
+    QMutexLocker locker(&mutex);
+    const auto game = games.constFind(gameId);
+    if (game == games.constEnd())
+        return;
+
+    for (const QString &userName : game->memberNames)
+        removeFromIndex(gamesByMember, userName, gameId);
+    removeFromIndex(gamesByCreator, game->creatorName, gameId);
+    games.erase(game);
+}
+
+QList<QPair<int, int>> UserGameIndex::getGamesOfUser(const QString &userName) const
+{
+    QMutexLocker locker(&mutex);
+    QList<QPair<int, int>> result;
+    for (int gameId : gamesByMember.value(userName))
+        result.append({games.value(gameId).roomId, gameId});
+    return result;
+}
+
+int UserGameIndex::getGamesCreatedByUser(int roomId, const QString &userName) const
+{
+    QMutexLocker locker(&mutex);
+    int result = 0;
+    for (int gameId : gamesByCreator.value(userName))
+        if (games.value(gameId).roomId == roomId)
+            ++result;
+    return result;
+}
@@ -0,0 +1,43 @@
+#ifndef USER_GAME_INDEX_H
+#define USER_GAME_INDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QString>
+
+/**
+ * The games hosted by this server by the names of their members and creators, so that the games of one user are
+ * found without going through every game of every room.
+ *
+ * A game registers its members whenever it publishes its info and is forgotten once it is closed down. Thread safe,
+ * the games update it from their executor threads.
+ */
+class UserGameIndex
+{
+public:
+    // registers the game with its creator on first use
+    void setMembers(int roomId, int gameId, const QString &creatorName, const QSet<QString> &memberNames);
+    void removeGame(int gameId);
+
+    // (room id, game id) of each game the user is a player or spectator of
+    QList<QPair<int, int>> getGamesOfUser(const QString &userName) const;
+    int getGamesCreatedByUser(int roomId, const QString &userName) const;
+
+private:
+    struct Game
+    {
+        int roomId;
+        QString creatorName;
+        QSet<QString> memberNames;
+    };
+
+    mutable QMutex mutex;
+    QHash<int, Game> games;
+    QHash<QString, QSet<int>> gamesByMember;
+    QHash<QString, QSet<int>> gamesByCreator;
+};
+
+#endif
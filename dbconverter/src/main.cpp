@@ -25,9 +25,52 @@
 #include <QCommandLineParser>
 #include <QCoreApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFileInfo>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
 #include <QtGlobal>
 
+struct Conversion
+{
+    QString oldDbPath;
+    QString newDbPath;
+    bool toBinary;
+    bool succeeded;
+};
+
+static void convert(Conversion &conversion)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    CardDatabaseConverter db;
+    const LoadStatus loadStatus = db.loadCardDatabase(conversion.oldDbPath);
+    const qint64 loadMsecs = timer.restart();
+    if (loadStatus != Ok) {
+        qCritical() << "Could not load cards from" << conversion.oldDbPath << "(status" << loadStatus << ")";
+        conversion.succeeded = false;
+        return;
+    }
+
+    if (conversion.toBinary) {
+        conversion.succeeded = db.saveCardCache(conversion.newDbPath, conversion.oldDbPath);
+    } else {
+        conversion.succeeded = db.saveCardDatabase(conversion.newDbPath);
+    }
+    if (!conversion.succeeded) {
+        qCritical() << "Could not save cards to" << conversion.newDbPath;
+        return;
+    }
+
+    qInfo().noquote() << QString("Converted %1 to %2: %3 cards, loaded in %4 ms, saved in %5 ms")
+                             .arg(conversion.oldDbPath, conversion.newDbPath)
+                             .arg(db.getCardList().size())
+                             .arg(loadMsecs)
+                             .arg(timer.elapsed());
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
@@ -38,30 +81,54 @@ int main(int argc, char *argv[])
     QCommandLineParser parser;
     parser.addPositionalArgument("olddb", "Read existing card database from <file>");
     parser.addPositionalArgument("newdb", "Write new card database to <file>");
+    parser.addPositionalArgument("[olddb newdb...]", "Convert more card databases, in parallel",
+                                 "[<olddb> <newdb>...]");
+    QCommandLineOption toBinaryOption("to-binary", "Write the binary card database cache format instead of xml");
+    parser.addOption(toBinaryOption);
+    QCommandLineOption jobsOption(QStringList() << "j"
+                                                << "jobs",
+                                  "Convert up to <count> card databases at once", "count",
+                                  QString::number(QThread::idealThreadCount()));
+    parser.addOption(jobsOption);
     parser.addHelpOption();
     parser.addVersionOption();
     parser.process(app);
 
-    QString oldDbPath;
-    QString newDbPath;
+    QList<Conversion> conversions;
     QStringList args = parser.positionalArguments();
-    if (args.count() == 2) {
-        oldDbPath = QFileInfo(args.at(0)).absoluteFilePath();
-        newDbPath = QFileInfo(args.at(1)).absoluteFilePath();
+    if (!args.isEmpty() && args.count() % 2 == 0) {
+        for (int i = 0; i < args.count(); i += 2) {
+            conversions.append({QFileInfo(args.at(i)).absoluteFilePath(), QFileInfo(args.at(i + 1)).absoluteFilePath(),
+                                parser.isSet(toBinaryOption), false});
+        }
     } else {
-        qCritical() << "Usage: dbconverter <olddb> <newdb>";
+        qCritical() << "Usage: dbconverter [--to-binary] [--jobs <count>] <olddb> <newdb> [<olddb> <newdb>...]";
         parser.showHelp(1);
         exit(0);
     }
 
+    const int jobs = parser.value(jobsOption).toInt();
+    if (jobs > 0) {
+        QThreadPool::globalInstance()->setMaxThreadCount(jobs);
+    }
+
     settingsCache = new SettingsCache;
-    CardDatabaseConverter *db = new CardDatabaseConverter;
 
+    QElapsedTimer timer;
+    timer.start();
+    // every database is loaded and saved on its own, a failure doesn't stop the others
+    QtConcurrent::blockingMap(conversions, convert);
+
+    int failures = 0;
+    for (const Conversion &conversion : conversions) {
+        if (!conversion.succeeded) {
+            ++failures;
+        }
+    }
     qInfo() << "---------------------------------------------";
-    qInfo() << "Loading cards from" << oldDbPath;
-    db->loadCardDatabase(oldDbPath);
-    qInfo() << "---------------------------------------------";
-    qInfo() << "Saving cards to" << newDbPath;
-    db->saveCardDatabase(newDbPath);
-    qInfo() << "---------------------------------------------";
+    qInfo().noquote() << QString("Converted %1 of %2 card databases in %3 ms")
+                             .arg(conversions.size() - failures)
+                             .arg(conversions.size())
+                             .arg(timer.elapsed());
+    return failures == 0 ? 0 : 1;
 }
@@ -2,6 +2,7 @@
 #define MAIN_H
 
 #include "../../cockatrice/src/game/cards/card_database.h"
+#include "../../cockatrice/src/game/cards/card_database_cache.h"
 #include "../../cockatrice/src/game/cards/card_database_parser/cockatrice_xml_4.h"
 
 class CardDatabaseConverter : public CardDatabase
@@ -17,6 +18,14 @@ public:
         CockatriceXml4Parser parser;
         return parser.saveToFile(sets, cards, fileName);
     }
+
+    /**
+     * Writes the cards in the binary format of the card database cache, valid for the database they were loaded from.
+     */
+    bool saveCardCache(const QString &fileName, const QString &sourcePath)
+    {
+        return CardDatabaseCache(fileName).save(CardDatabaseCache::sourceKey({sourcePath}), sets, cards);
+    }
 };
 
 #endif
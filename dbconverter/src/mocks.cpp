@@ -35,6 +35,10 @@ QString SettingsCache::getSettingsPath()
 {
     return "";
 }
+QString SettingsCache::getCachePath() const
+{
+    return "";
+}
 void SettingsCache::translateLegacySettings()
 {
 }
@@ -286,6 +290,9 @@ void SettingsCache::setHorizontalHand(QT_STATE_CHANGED_T /* _horizontalHand */)
 void SettingsCache::setInvertVerticalCoordinate(QT_STATE_CHANGED_T /* _invertVerticalCoordinate */)
 {
 }
+void SettingsCache::setOpenGLGameView(QT_STATE_CHANGED_T /* _openGLGameView */)
+{
+}
 void SettingsCache::setMinPlayersForMultiColumnLayout(int /* _minPlayersForMultiColumnLayout */)
 {
 }
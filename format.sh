@@ -22,8 +22,7 @@ exclude=("servatrice/src/smtp" \
 "common/sfmt" \
 "common/lib" \
 "oracle/src/zip" \
-"oracle/src/lzma" \
-"oracle/src/qt-json")
+"oracle/src/lzma")
 exts=("cpp" "h" "proto")
 cf_cmd="clang-format"
 branch="origin/master"
@@ -0,0 +1,412 @@
+#include "load_client.h"
+
+#include "command_trace.h"
+#include "featureset.h"
+#include "load_statistics.h"
+#include "message_compression.h"
+#include "pb/command_deck_select.pb.h"
+#include "pb/command_draw_cards.pb.h"
+#include "pb/command_leave_game.pb.h"
+#include "pb/command_move_card.pb.h"
+#include "pb/command_ready_start.pb.h"
+#include "pb/command_shuffle.pb.h"
+#include "pb/commands.pb.h"
+#include "pb/event_draw_cards.pb.h"
+#include "pb/event_game_joined.pb.h"
+#include "pb/event_game_state_changed.pb.h"
+#include "pb/event_server_identification.pb.h"
+#include "pb/game_event_container.pb.h"
+#include "pb/response.pb.h"
+#include "pb/room_commands.pb.h"
+#include "pb/server_message.pb.h"
+#include "pb/session_commands.pb.h"
+#include "pb/session_event.pb.h"
+
+#include <QTcpSocket>
+#include <QTimer>
+
+static const int reconnectDelay = 5000;
+static const int startingHandSize = 7;
+static const char *const loadTestDeck = "<?xml version=\"1.0\"?><cockatrice_deck version=\"1\"><deckname>Load test"
+                                        "</deckname><zone name=\"main\"><card number=\"60\" name=\"Island\"/></zone>"
+                                        "</cockatrice_deck>";
+
+static int sessionCommandKey(SessionCommand::SessionCommandType type)
+{
+    return CommandTrace::commandKey(CommandTrace::SessionCommandKind, type);
+}
+
+static int roomCommandKey(RoomCommand::RoomCommandType type)
+{
+    return CommandTrace::commandKey(CommandTrace::RoomCommandKind, type);
+}
+
+static int gameCommandKey(GameCommand::GameCommandType type)
+{
+    return CommandTrace::commandKey(CommandTrace::GameCommandKind, type);
+}
+
+LoadClient::LoadClient(int _index, const LoadScenario &_scenario, LoadStatistics *_statistics, QObject *parent)
+    : QObject(parent), index(_index), scenario(_scenario), statistics(_statistics), random(_index),
+      socket(new QTcpSocket(this)), actionTimer(new QTimer(this)), handshakeDone(false), messageInProgress(false),
+      messageCompressed(false), messageLength(0), state(Disconnected), nextCmdId(0), gameId(-1), playerId(-1),
+      actionsInGame(0)
+{
+    playsGames = roll(scenario.playerPercentage);
+
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    connect(socket, &QTcpSocket::connected, this, &LoadClient::socketConnected);
+    connect(socket, &QTcpSocket::disconnected, this, &LoadClient::socketDisconnected);
+    connect(socket, &QTcpSocket::readyRead, this, &LoadClient::readSocket);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    connect(socket, &QTcpSocket::errorOccurred, this, &LoadClient::socketError);
+#else
+    connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::error), this, &LoadClient::socketError);
+#endif
+
+    actionTimer->setSingleShot(true);
+    connect(actionTimer, &QTimer::timeout, this, &LoadClient::performAction);
+
+    clock.start();
+}
+
+LoadClient::~LoadClient()
+{
+    setState(Disconnected);
+}
+
+void LoadClient::start()
+{
+    if (state != Disconnected)
+        return;
+
+    handshakeDone = messageInProgress = messageCompressed = false;
+    inputBuffer.clear();
+    setState(Connecting);
+    socket->connectToHost(scenario.host, scenario.port);
+}
+
+void LoadClient::setState(State newState)
+{
+    // the connection counters of the statistics follow the state
+    const bool wasConnected = state != Disconnected && state != Connecting;
+    const bool isConnected = newState != Disconnected && newState != Connecting;
+    const bool wasLoggedIn = state >= InRoom;
+    const bool isLoggedIn = newState >= InRoom;
+    const bool wasPlaying = state == Playing;
+    const bool isPlaying = newState == Playing;
+    statistics->connectedClients += int(isConnected) - int(wasConnected);
+    statistics->loggedInClients += int(isLoggedIn) - int(wasLoggedIn);
+    statistics->playingClients += int(isPlaying) - int(wasPlaying);
+    state = newState;
+}
+
+bool LoadClient::roll(int percentage)
+{
+    return std::uniform_int_distribution<int>(0, 99)(random) < percentage;
+}
+
+void LoadClient::scheduleAction()
+{
+    const int interval = scenario.actionInterval;
+    actionTimer->start(interval + std::uniform_int_distribution<int>(0, interval / 2)(random));
+}
+
+void LoadClient::socketConnected()
+{
+    setState(LoggingIn);
+
+    // the empty container starts the session, see TcpServerSocketInterface::readClient()
+    writeCommandContainer(CommandContainer());
+}
+
+void LoadClient::socketDisconnected()
+{
+    if (state == Disconnected)
+        return;
+
+    actionTimer->stop();
+    pendingCommands.clear();
+    hand.clear();
+    gameId = playerId = -1;
+    setState(Disconnected);
+    QTimer::singleShot(reconnectDelay, this, &LoadClient::start);
+}
+
+void LoadClient::socketError(QAbstractSocket::SocketError /* error */)
+{
+    ++statistics->connectionErrors;
+    if (socket->state() != QAbstractSocket::UnconnectedState)
+        socket->abort();
+    else
+        socketDisconnected();
+}
+
+void LoadClient::readSocket()
+{
+    inputBuffer.append(socket->readAll());
+
+    if (!handshakeDone) {
+        // the server greets tcp clients with the stream header of protocol version 13 first
+        if (inputBuffer.size() < 60)
+            return;
+        if (inputBuffer.startsWith("<?xm"))
+            inputBuffer.skip(60);
+        handshakeDone = true;
+    }
+
+    while (true) {
+        if (!messageInProgress) {
+            int frameLength;
+            if (!inputBuffer.takeLength(frameLength))
+                return;
+            messageCompressed = MessageCompression::isCompressedFrame(frameLength);
+            messageLength = MessageCompression::payloadLength(frameLength);
+            messageInProgress = true;
+        }
+        if (inputBuffer.size() < messageLength)
+            return;
+
+        ServerMessage message;
+        bool valid;
+        if (messageCompressed) {
+            QByteArray uncompressed;
+            valid = MessageCompression::uncompress(inputBuffer.data(), messageLength, uncompressed) &&
+                    message.ParseFromArray(uncompressed.constData(), uncompressed.size());
+        } else {
+            valid = message.ParseFromArray(inputBuffer.data(), messageLength);
+        }
+        inputBuffer.skip(messageLength);
+        messageInProgress = false;
+
+        if (valid)
+            processServerMessage(message);
+        if (state == Disconnected)
+            return;
+    }
+}
+
+void LoadClient::sendCommandContainer(CommandContainer &cont, int commandKey)
+{
+    cont.set_cmd_id(++nextCmdId);
+    pendingCommands.insert(nextCmdId, {commandKey, clock.nsecsElapsed()});
+    writeCommandContainer(cont);
+}
+
+void LoadClient::writeCommandContainer(const CommandContainer &cont)
+{
+    const QByteArray data = QByteArray::fromStdString(cont.SerializeAsString());
+    const quint32 size = static_cast<quint32>(data.size());
+    QByteArray frame;
+    frame.reserve(4 + data.size());
+    frame.append(static_cast<char>(size >> 24));
+    frame.append(static_cast<char>(size >> 16));
+    frame.append(static_cast<char>(size >> 8));
+    frame.append(static_cast<char>(size));
+    frame.append(data);
+    socket->write(frame);
+}
+
+void LoadClient::processServerMessage(const ServerMessage &message)
+{
+    switch (message.message_type()) {
+        case ServerMessage::RESPONSE:
+            processResponse(message.response());
+            break;
+        case ServerMessage::SESSION_EVENT:
+            processSessionEvent(message.session_event());
+            break;
+        case ServerMessage::GAME_EVENT_CONTAINER:
+            processGameEventContainer(message.game_event_container());
+            break;
+        default:
+            // room events only cost the server the sending
+            break;
+    }
+}
+
+void LoadClient::processResponse(const Response &response)
+{
+    auto pending = pendingCommands.find(response.cmd_id());
+    if (pending == pendingCommands.end())
+        return;
+    const PendingCommand command = *pending;
+    pendingCommands.erase(pending);
+
+    const bool ok = response.response_code() == Response::RespOk;
+    statistics->recordResponse(command.commandKey, (clock.nsecsElapsed() - command.sentAt) / 1000, ok);
+
+    if (command.commandKey == sessionCommandKey(SessionCommand::LOGIN)) {
+        if (!ok) {
+            socket->abort();
+            return;
+        }
+        setState(JoiningRoom);
+        Command_JoinRoom cmd;
+        cmd.set_room_id(scenario.roomId);
+        CommandContainer cont;
+        cont.add_session_command()->MutableExtension(Command_JoinRoom::ext)->CopyFrom(cmd);
+        sendCommandContainer(cont, sessionCommandKey(SessionCommand::JOIN_ROOM));
+    } else if (command.commandKey == sessionCommandKey(SessionCommand::JOIN_ROOM)) {
+        if (!ok) {
+            socket->abort();
+            return;
+        }
+        setState(InRoom);
+        scheduleAction();
+    } else if (command.commandKey == roomCommandKey(RoomCommand::CREATE_GAME)) {
+        // on success, Event_GameJoined continues
+        if (!ok)
+            setState(InRoom);
+    } else if (command.commandKey == gameCommandKey(GameCommand::DECK_SELECT)) {
+        if (!ok) {
+            leaveGame();
+            return;
+        }
+        Command_ReadyStart cmd;
+        cmd.set_ready(true);
+        CommandContainer cont;
+        cont.set_game_id(gameId);
+        cont.add_game_command()->MutableExtension(Command_ReadyStart::ext)->CopyFrom(cmd);
+        sendCommandContainer(cont, gameCommandKey(GameCommand::READY_START));
+    } else if (command.commandKey == gameCommandKey(GameCommand::READY_START)) {
+        // on success, Event_GameStateChanged continues
+        if (!ok)
+            leaveGame();
+    } else if (command.commandKey == gameCommandKey(GameCommand::LEAVE_GAME)) {
+        hand.clear();
+        gameId = playerId = -1;
+        setState(InRoom);
+    }
+}
+
+void LoadClient::processSessionEvent(const SessionEvent &event)
+{
+    if (event.HasExtension(Event_ServerIdentification::ext)) {
+        Command_Login cmd;
+        cmd.set_user_name(QString("%1%2").arg(scenario.userNamePrefix).arg(index).toStdString());
+        if (!scenario.password.isEmpty())
+            cmd.set_password(scenario.password.toStdString());
+        cmd.set_clientid("loadgen");
+        cmd.set_clientver("loadgen");
+        // the features of the desktop client, so that the server does the same work for the simulated clients
+        const QMap<QString, bool> features = FeatureSet().getDefaultFeatureList();
+        for (auto it = features.constBegin(); it != features.constEnd(); ++it)
+            cmd.add_clientfeatures(it.key().toStdString());
+        CommandContainer cont;
+        cont.add_session_command()->MutableExtension(Command_Login::ext)->CopyFrom(cmd);
+        sendCommandContainer(cont, sessionCommandKey(SessionCommand::LOGIN));
+    } else if (event.HasExtension(Event_GameJoined::ext)) {
+        const Event_GameJoined &joined = event.GetExtension(Event_GameJoined::ext);
+        gameId = joined.game_info().game_id();
+        playerId = joined.player_id();
+        actionsInGame = 0;
+        setState(StartingGame);
+
+        Command_DeckSelect cmd;
+        cmd.set_deck(loadTestDeck);
+        CommandContainer cont;
+        cont.set_game_id(gameId);
+        cont.add_game_command()->MutableExtension(Command_DeckSelect::ext)->CopyFrom(cmd);
+        sendCommandContainer(cont, gameCommandKey(GameCommand::DECK_SELECT));
+    }
+}
+
+void LoadClient::processGameEventContainer(const GameEventContainer &cont)
+{
+    if (static_cast<int>(cont.game_id()) != gameId)
+        return;
+
+    for (const GameEvent &event : cont.event_list()) {
+        if (event.HasExtension(Event_GameStateChanged::ext)) {
+            if (state == StartingGame && event.GetExtension(Event_GameStateChanged::ext).game_started()) {
+                setState(Playing);
+
+                CommandContainer draw;
+                draw.set_game_id(gameId);
+                draw.add_game_command()->MutableExtension(Command_DrawCards::ext)->set_number(startingHandSize);
+                sendCommandContainer(draw, gameCommandKey(GameCommand::DRAW_CARDS));
+            }
+        } else if (event.HasExtension(Event_DrawCards::ext) && event.player_id() == playerId) {
+            for (const ServerInfo_Card &card : event.GetExtension(Event_DrawCards::ext).cards())
+                hand.append(card.id());
+        }
+    }
+}
+
+void LoadClient::performAction()
+{
+    if (state < InRoom)
+        return;
+
+    if (state != Playing || roll(scenario.chatPercentage)) {
+        if (state == InRoom && playsGames) {
+            setState(CreatingGame);
+            Command_CreateGame cmd;
+            cmd.set_description("Load test");
+            cmd.set_max_players(1);
+            CommandContainer cont;
+            cont.set_room_id(scenario.roomId);
+            cont.add_room_command()->MutableExtension(Command_CreateGame::ext)->CopyFrom(cmd);
+            sendCommandContainer(cont, roomCommandKey(RoomCommand::CREATE_GAME));
+        } else if (state == InRoom || state == Playing) {
+            sendRoomSay();
+        }
+    } else {
+        sendGameAction();
+    }
+
+    scheduleAction();
+}
+
+void LoadClient::sendRoomSay()
+{
+    Command_RoomSay cmd;
+    cmd.set_message(QString("Load test message %1 from client %2").arg(nextCmdId).arg(index).toStdString());
+    CommandContainer cont;
+    cont.set_room_id(scenario.roomId);
+    cont.add_room_command()->MutableExtension(Command_RoomSay::ext)->CopyFrom(cmd);
+    sendCommandContainer(cont, roomCommandKey(RoomCommand::ROOM_SAY));
+}
+
+void LoadClient::leaveGame()
+{
+    setState(LeavingGame);
+    CommandContainer cont;
+    cont.set_game_id(gameId);
+    cont.add_game_command()->MutableExtension(Command_LeaveGame::ext);
+    sendCommandContainer(cont, gameCommandKey(GameCommand::LEAVE_GAME));
+}
+
+void LoadClient::sendGameAction()
+{
+    if (++actionsInGame > scenario.actionsPerGame) {
+        leaveGame();
+        return;
+    }
+
+    CommandContainer cont;
+    cont.set_game_id(gameId);
+    GameCommand *command = cont.add_game_command();
+    GameCommand::GameCommandType type;
+    if (hand.isEmpty() || roll(20)) {
+        command->MutableExtension(Command_DrawCards::ext)->set_number(1);
+        type = GameCommand::DRAW_CARDS;
+    } else if (roll(15)) {
+        command->MutableExtension(Command_Shuffle::ext)->set_zone_name("deck");
+        type = GameCommand::SHUFFLE;
+    } else {
+        const int cardId = hand.takeAt(std::uniform_int_distribution<int>(0, hand.size() - 1)(random));
+        Command_MoveCard *cmd = command->MutableExtension(Command_MoveCard::ext);
+        cmd->set_start_player_id(playerId);
+        cmd->set_start_zone("hand");
+        cmd->mutable_cards_to_move()->add_card()->set_card_id(cardId);
+        cmd->set_target_player_id(playerId);
+        cmd->set_target_zone("table");
+        cmd->set_x(std::uniform_int_distribution<int>(0, 20)(random));
+        cmd->set_y(std::uniform_int_distribution<int>(0, 2)(random));
+        type = GameCommand::MOVE_CARD;
+    }
+
+    sendCommandContainer(cont, gameCommandKey(type));
+}
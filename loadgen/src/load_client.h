@@ -0,0 +1,121 @@
+#ifndef LOAD_CLIENT_H
+#define LOAD_CLIENT_H
+
+#include "framed_input_buffer.h"
+
+#include <QAbstractSocket>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <random>
+
+class CommandContainer;
+class GameEventContainer;
+class LoadStatistics;
+class QTcpSocket;
+class QTimer;
+class Response;
+class ServerMessage;
+class SessionEvent;
+
+// what every simulated client does, set from the command line
+struct LoadScenario
+{
+    QString host;
+    quint16 port;
+    QString userNamePrefix;
+    QString password;
+    int roomId;
+    // milliseconds between two actions of a client, every interval is randomly stretched by up to half of it
+    int actionInterval;
+    // percentage of the actions that are room chat messages
+    int chatPercentage;
+    // percentage of the clients that play games
+    int playerPercentage;
+    // game actions after which a player leaves the game to create a new one
+    int actionsPerGame;
+};
+
+/**
+ * One simulated client, talking the tcp protocol of the desktop client.
+ *
+ * It logs in, joins the room and then acts every actionInterval milliseconds: it chats, or, if it is one of the
+ * players, creates a single player game, selects a deck, starts the game and then keeps drawing, moving and shuffling
+ * cards until it leaves the game and creates the next one. The response time of every command is recorded into the
+ * statistics of the thread the client lives in.
+ */
+class LoadClient : public QObject
+{
+    Q_OBJECT
+public:
+    LoadClient(int _index, const LoadScenario &_scenario, LoadStatistics *_statistics, QObject *parent = nullptr);
+    ~LoadClient() override;
+
+public slots:
+    void start();
+
+private slots:
+    void socketConnected();
+    void socketDisconnected();
+    void socketError(QAbstractSocket::SocketError error);
+    void readSocket();
+    void performAction();
+
+private:
+    enum State
+    {
+        Disconnected,
+        Connecting,
+        LoggingIn,
+        JoiningRoom,
+        InRoom,
+        CreatingGame,
+        StartingGame,
+        Playing,
+        LeavingGame
+    };
+
+    struct PendingCommand
+    {
+        int commandKey;
+        qint64 sentAt;
+    };
+
+    int index;
+    const LoadScenario scenario;
+    LoadStatistics *statistics;
+    std::mt19937 random;
+    bool playsGames;
+
+    QTcpSocket *socket;
+    QTimer *actionTimer;
+    QElapsedTimer clock;
+    FramedInputBuffer inputBuffer;
+    bool handshakeDone, messageInProgress, messageCompressed;
+    int messageLength;
+
+    State state;
+    quint64 nextCmdId;
+    QHash<quint64, PendingCommand> pendingCommands;
+    int gameId, playerId, actionsInGame;
+    QList<int> hand;
+
+    void setState(State newState);
+    bool roll(int percentage);
+    void scheduleAction();
+    // sends a command and records its response time
+    void sendCommandContainer(CommandContainer &cont, int commandKey);
+    void writeCommandContainer(const CommandContainer &cont);
+    void sendRoomSay();
+    void sendGameAction();
+    void leaveGame();
+
+    void processServerMessage(const ServerMessage &message);
+    void processResponse(const Response &response);
+    void processSessionEvent(const SessionEvent &event);
+    void processGameEventContainer(const GameEventContainer &cont);
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "load_report.h"
+
+#include <QStringList>
+
+LoadReport::LoadReport(const QList<LoadStatistics *> &_statistics) : statistics(_statistics)
+{
+    sinceStart.start();
+    sinceInterval.start();
+}
+
+QMap<int, LoadStatistics::CommandSnapshot> LoadReport::merged() const
+{
+    QMap<int, LoadStatistics::CommandSnapshot> result;
+    for (const LoadStatistics *threadStatistics : statistics) {
+        const QMap<int, LoadStatistics::CommandSnapshot> commands = threadStatistics->snapshot();
+        for (auto it = commands.constBegin(); it != commands.constEnd(); ++it) {
+            LoadStatistics::CommandSnapshot &command = result[it.key()];
+            if (command.latencies.isEmpty())
+                command.latencies = it.value().latencies;
+            else
+                for (int i = 0; i < command.latencies.size(); ++i)
+                    command.latencies[i] += it.value().latencies[i];
+            command.errors += it.value().errors;
+        }
+    }
+    return result;
+}
+
+QString LoadReport::takeInterval()
+{
+    const QMap<int, LoadStatistics::CommandSnapshot> current = merged();
+    QMap<int, LoadStatistics::CommandSnapshot> delta = current;
+    for (auto it = delta.begin(); it != delta.end(); ++it) {
+        const LoadStatistics::CommandSnapshot last = previous.value(it.key());
+        if (!last.latencies.isEmpty())
+            for (int i = 0; i < it->latencies.size(); ++i)
+                it->latencies[i] -= last.latencies[i];
+        it->errors -= last.errors;
+    }
+    previous = current;
+
+    const qint64 msecs = sinceInterval.restart();
+    return format(delta, msecs);
+}
+
+QString LoadReport::total() const
+{
+    return format(merged(), sinceStart.elapsed());
+}
+
+QString LoadReport::format(const QMap<int, LoadStatistics::CommandSnapshot> &commands, qint64 msecs) const
+{
+    int connected = 0, loggedIn = 0, playing = 0;
+    quint64 connectionErrors = 0;
+    for (const LoadStatistics *threadStatistics : statistics) {
+        connected += threadStatistics->connectedClients;
+        loggedIn += threadStatistics->loggedInClients;
+        playing += threadStatistics->playingClients;
+        connectionErrors += threadStatistics->connectionErrors;
+    }
+
+    QStringList lines;
+    lines.append(QString("%1 s: %2 clients connected, %3 logged in, %4 playing, %5 connection errors")
+                     .arg(msecs / 1000.0, 0, 'f', 1)
+                     .arg(connected)
+                     .arg(loggedIn)
+                     .arg(playing)
+                     .arg(connectionErrors));
+    lines.append(QString("%1 %2 %3 %4 %5 %6 %7")
+                     .arg("command", -24)
+                     .arg("responses", 10)
+                     .arg("per s", 10)
+                     .arg("errors", 8)
+                     .arg("p50 ms", 10)
+                     .arg("p99 ms", 10)
+                     .arg("p99.9 ms", 10));
+    for (auto it = commands.constBegin(); it != commands.constEnd(); ++it) {
+        quint64 count = 0;
+        for (quint64 bucket : it->latencies)
+            count += bucket;
+        if (count == 0)
+            continue;
+
+        lines.append(QString("%1 %2 %3 %4 %5 %6 %7")
+                         .arg(CommandTrace::commandName(it.key()), -24)
+                         .arg(count, 10)
+                         .arg(msecs > 0 ? count * 1000.0 / msecs : 0.0, 10, 'f', 1)
+                         .arg(it->errors, 8)
+                         .arg(LatencyHistogram::valueAtPercentile(it->latencies, 50) / 1000.0, 10, 'f', 3)
+                         .arg(LatencyHistogram::valueAtPercentile(it->latencies, 99) / 1000.0, 10, 'f', 3)
+                         .arg(LatencyHistogram::valueAtPercentile(it->latencies, 99.9) / 1000.0, 10, 'f', 3));
+    }
+    return lines.join('\n');
+}
@@ -0,0 +1,34 @@
+#ifndef LOAD_REPORT_H
+#define LOAD_REPORT_H
+
+#include "load_statistics.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+/**
+ * Formats what the simulated clients of all threads measured: per command type the number of responses, the
+ * responses per second, the error responses and the p50, p99 and p99.9 response times.
+ */
+class LoadReport
+{
+public:
+    explicit LoadReport(const QList<LoadStatistics *> &_statistics);
+
+    // what happened since the previous call
+    QString takeInterval();
+    // what happened since the start
+    QString total() const;
+
+private:
+    QList<LoadStatistics *> statistics;
+    QElapsedTimer sinceStart, sinceInterval;
+    QMap<int, LoadStatistics::CommandSnapshot> previous;
+
+    QMap<int, LoadStatistics::CommandSnapshot> merged() const;
+    QString format(const QMap<int, LoadStatistics::CommandSnapshot> &commands, qint64 msecs) const;
+};
+
+#endif
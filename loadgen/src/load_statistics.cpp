@@ -0,0 +1,38 @@
+#include "load_statistics.h"
+
+LoadStatistics::LoadStatistics() : connectedClients(0), loggedInClients(0), playingClients(0), connectionErrors(0)
+{
+}
+
+LoadStatistics::~LoadStatistics()
+{
+    qDeleteAll(commands);
+}
+
+void LoadStatistics::recordResponse(int commandKey, qint64 microseconds, bool ok)
+{
+    // the owning thread is the only one to insert, so it can look up without the lock
+    CommandStatistics *command = commands.value(commandKey);
+    if (!command) {
+        command = new CommandStatistics;
+        QMutexLocker locker(&mutex);
+        commands.insert(commandKey, command);
+    }
+
+    command->latency.record(microseconds);
+    if (!ok)
+        command->errors.store(command->errors.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+QMap<int, LoadStatistics::CommandSnapshot> LoadStatistics::snapshot() const
+{
+    QMutexLocker locker(&mutex);
+
+    QMap<int, CommandSnapshot> result;
+    for (auto it = commands.constBegin(); it != commands.constEnd(); ++it) {
+        CommandSnapshot &command = result[it.key()];
+        command.latencies = it.value()->latency.snapshot();
+        command.errors = it.value()->errors.load(std::memory_order_relaxed);
+    }
+    return result;
+}
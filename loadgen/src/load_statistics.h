@@ -0,0 +1,52 @@
+#ifndef LOAD_STATISTICS_H
+#define LOAD_STATISTICS_H
+
+#include "command_trace.h"
+
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QVector>
+#include <atomic>
+
+/**
+ * What the simulated clients of one thread measured: the response latency of every command, per command type (see
+ * CommandTrace::commandKey()), and the state of their connections.
+ *
+ * Only the thread owning the clients records, so recording takes no locks once a command type was seen; the report
+ * takes snapshots from the main thread at any time.
+ */
+class LoadStatistics
+{
+public:
+    struct CommandSnapshot
+    {
+        QVector<quint64> latencies;
+        quint64 errors = 0;
+    };
+
+    LoadStatistics();
+    ~LoadStatistics();
+    LoadStatistics(const LoadStatistics &) = delete;
+    LoadStatistics &operator=(const LoadStatistics &) = delete;
+
+    // owning thread only; ok is false for responses other than RespOk
+    void recordResponse(int commandKey, qint64 microseconds, bool ok);
+
+    QMap<int, CommandSnapshot> snapshot() const;
+
+    std::atomic<int> connectedClients, loggedInClients, playingClients;
+    std::atomic<quint64> connectionErrors;
+
+private:
+    struct CommandStatistics
+    {
+        LatencyHistogram latency;
+        std::atomic<quint64> errors{0};
+    };
+
+    mutable QMutex mutex;
+    QHash<int, CommandStatistics *> commands;
+};
+
+#endif
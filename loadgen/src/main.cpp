@@ -0,0 +1,113 @@
+#include "load_client.h"
+#include "load_report.h"
+#include "load_statistics.h"
+#include "version_string.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QList>
+#include <QThread>
+#include <QTimer>
+
+static int intOption(const QCommandLineParser &parser, const QString &name, int minimum)
+{
+    bool ok = false;
+    const int value = parser.value(name).toInt(&ok);
+    if (!ok || value < minimum) {
+        qCritical().noquote() << "Invalid value for --" + name + ":" << parser.value(name);
+        exit(1);
+    }
+    return value;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("Cockatrice");
+    app.setApplicationName("Loadgen");
+    app.setApplicationVersion(VERSION_STRING);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Simulates many desktop clients against a servatrice server and reports throughput and latency per command "
+        "type.\nThe server's flood protection (max_message_count_per_interval, max_command_count_per_interval, "
+        "max_games_per_user, max_users_per_address) has to be raised to fit the simulated load.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOptions({
+        {"host", "Server to connect to.", "host", "localhost"},
+        {"port", "TCP port of the server.", "port", "4747"},
+        {"clients", "Number of simulated clients.", "count", "100"},
+        {"threads", "Number of threads the clients are spread over.", "count",
+         QString::number(QThread::idealThreadCount())},
+        {"duration", "Seconds to run before the final report.", "seconds", "60"},
+        {"ramp-up", "Seconds over which the clients connect.", "seconds", "10"},
+        {"room", "Id of the room the clients join.", "id", "1"},
+        {"user-prefix", "Prefix of the user names, followed by the client number.", "prefix", "loadgen"},
+        {"password", "Password of the simulated users.", "password", ""},
+        {"action-interval", "Milliseconds between two actions of a client.", "msecs", "1000"},
+        {"chat", "Percentage of the actions that are room chat messages.", "percent", "20"},
+        {"players", "Percentage of the clients that play games.", "percent", "50"},
+        {"actions-per-game", "Game actions after which a player starts a new game.", "count", "50"},
+        {"report-interval", "Seconds between two reports.", "seconds", "5"},
+    });
+    parser.process(app);
+
+    LoadScenario scenario;
+    scenario.host = parser.value("host");
+    scenario.port = static_cast<quint16>(intOption(parser, "port", 1));
+    scenario.userNamePrefix = parser.value("user-prefix");
+    scenario.password = parser.value("password");
+    scenario.roomId = intOption(parser, "room", 0);
+    scenario.actionInterval = intOption(parser, "action-interval", 1);
+    scenario.chatPercentage = qMin(intOption(parser, "chat", 0), 100);
+    scenario.playerPercentage = qMin(intOption(parser, "players", 0), 100);
+    scenario.actionsPerGame = intOption(parser, "actions-per-game", 1);
+
+    const int clientCount = intOption(parser, "clients", 1);
+    const int threadCount = qMin(intOption(parser, "threads", 1), clientCount);
+    const int durationMsecs = intOption(parser, "duration", 1) * 1000;
+    const int rampUpMsecs = intOption(parser, "ramp-up", 0) * 1000;
+    const int reportMsecs = intOption(parser, "report-interval", 1) * 1000;
+
+    QList<QThread *> threads;
+    QList<LoadStatistics *> statistics;
+    for (int i = 0; i < threadCount; ++i) {
+        threads.append(new QThread);
+        statistics.append(new LoadStatistics);
+    }
+
+    // every client is created here and handed to its thread before it is started from there
+    for (int i = 0; i < clientCount; ++i) {
+        const int threadIndex = i % threadCount;
+        auto *client = new LoadClient(i, scenario, statistics[threadIndex]);
+        client->moveToThread(threads[threadIndex]);
+        QObject::connect(threads[threadIndex], &QThread::finished, client, &QObject::deleteLater);
+        QTimer::singleShot(static_cast<int>(qint64(i) * rampUpMsecs / clientCount), client, &LoadClient::start);
+    }
+    for (QThread *thread : threads)
+        thread->start();
+
+    LoadReport report(statistics);
+
+    QTimer reportTimer;
+    QObject::connect(&reportTimer, &QTimer::timeout, &app, [&]() { qInfo().noquote() << report.takeInterval(); });
+    reportTimer.start(reportMsecs);
+
+    QTimer::singleShot(durationMsecs, &app, [&]() {
+        reportTimer.stop();
+        qInfo().noquote() << "Total" << report.total();
+        app.quit();
+    });
+
+    const int result = app.exec();
+
+    for (QThread *thread : threads) {
+        thread->quit();
+        thread->wait();
+    }
+    qDeleteAll(threads);
+    qDeleteAll(statistics);
+    return result;
+}
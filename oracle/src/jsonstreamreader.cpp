@@ -0,0 +1,267 @@
+#include "jsonstreamreader.h"
+
+#include <QVariantList>
+#include <QVariantMap>
+#include <cstring>
+
+JsonStreamReader::JsonStreamReader(const QByteArray &_data)
+    : data(_data.constData()), size(static_cast<int>(_data.size())), index(0), error(false)
+{
+}
+
+void JsonStreamReader::eatWhitespace()
+{
+    while (index < size && (data[index] == ' ' || data[index] == '\n' || data[index] == '\r' || data[index] == '\t'))
+        ++index;
+}
+
+bool JsonStreamReader::expect(char c)
+{
+    eatWhitespace();
+    if (error || index >= size || data[index] != c)
+        return fail();
+    ++index;
+    return true;
+}
+
+bool JsonStreamReader::fail()
+{
+    error = true;
+    return false;
+}
+
+int JsonStreamReader::position()
+{
+    eatWhitespace();
+    return index;
+}
+
+bool JsonStreamReader::beginObject()
+{
+    return expect('{');
+}
+
+bool JsonStreamReader::nextMember(QString &key)
+{
+    eatWhitespace();
+    if (error || index >= size)
+        return fail();
+    if (data[index] == ',') {
+        ++index;
+        eatWhitespace();
+    }
+    if (index < size && data[index] == '}') {
+        ++index;
+        return false;
+    }
+    return readString(key) && expect(':');
+}
+
+bool JsonStreamReader::beginArray()
+{
+    return expect('[');
+}
+
+bool JsonStreamReader::nextElement()
+{
+    eatWhitespace();
+    if (error || index >= size)
+        return fail();
+    if (data[index] == ',') {
+        ++index;
+        eatWhitespace();
+    }
+    if (index < size && data[index] == ']') {
+        ++index;
+        return false;
+    }
+    return index < size || fail();
+}
+
+QVariant JsonStreamReader::readValue()
+{
+    eatWhitespace();
+    if (error || index >= size) {
+        fail();
+        return QVariant();
+    }
+
+    switch (data[index]) {
+        case '{': {
+            ++index;
+            QVariantMap map;
+            QString key;
+            while (nextMember(key)) {
+                const QVariant value = readValue();
+                if (error)
+                    return QVariant();
+                map.insert(key, value);
+            }
+            return error ? QVariant() : QVariant(map);
+        }
+        case '[': {
+            ++index;
+            QVariantList list;
+            while (nextElement()) {
+                const QVariant value = readValue();
+                if (error)
+                    return QVariant();
+                list.append(value);
+            }
+            return error ? QVariant() : QVariant(list);
+        }
+        case '"': {
+            QString string;
+            return readString(string) ? QVariant(string) : QVariant();
+        }
+        case 't':
+            return readLiteral("true", true);
+        case 'f':
+            return readLiteral("false", false);
+        case 'n':
+            return readLiteral("null", QVariant());
+        default:
+            return readNumber();
+    }
+}
+
+bool JsonStreamReader::skipValue()
+{
+    eatWhitespace();
+    if (error || index >= size)
+        return fail();
+
+    if (data[index] == '"')
+        return skipString();
+    if (data[index] != '{' && data[index] != '[') {
+        readValue();
+        return !error;
+    }
+
+    // nested objects and arrays are only counted, their contents aren't looked at
+    int depth = 0;
+    while (index < size) {
+        const char c = data[index];
+        if (c == '"') {
+            if (!skipString())
+                return false;
+            continue;
+        }
+        ++index;
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if ((c == '}' || c == ']') && --depth == 0) {
+            return true;
+        }
+    }
+    return fail();
+}
+
+bool JsonStreamReader::readString(QString &string)
+{
+    if (!expect('"'))
+        return false;
+
+    string.clear();
+    while (index < size) {
+        // the runs between escapes are decoded in one go
+        int runEnd = index;
+        while (runEnd < size && data[runEnd] != '"' && data[runEnd] != '\\')
+            ++runEnd;
+        if (runEnd > index)
+            string.append(QString::fromUtf8(data + index, runEnd - index));
+        index = runEnd;
+        if (index >= size)
+            break;
+
+        if (data[index++] == '"')
+            return true;
+        if (index >= size)
+            break;
+
+        const char escaped = data[index++];
+        switch (escaped) {
+            case '"':
+            case '\\':
+            case '/':
+                string.append(QLatin1Char(escaped));
+                break;
+            case 'b':
+                string.append(QLatin1Char('\b'));
+                break;
+            case 'f':
+                string.append(QLatin1Char('\f'));
+                break;
+            case 'n':
+                string.append(QLatin1Char('\n'));
+                break;
+            case 'r':
+                string.append(QLatin1Char('\r'));
+                break;
+            case 't':
+                string.append(QLatin1Char('\t'));
+                break;
+            case 'u': {
+                if (size - index < 4)
+                    return fail();
+                bool ok;
+                // surrogate pairs come as two escapes, each half is appended on its own
+                const ushort symbol = QByteArray::fromRawData(data + index, 4).toUShort(&ok, 16);
+                if (!ok)
+                    return fail();
+                string.append(QChar(symbol));
+                index += 4;
+                break;
+            }
+            default:
+                // unknown escapes are dropped
+                break;
+        }
+    }
+    return fail();
+}
+
+bool JsonStreamReader::skipString()
+{
+    if (!expect('"'))
+        return false;
+
+    while (index < size) {
+        const char c = data[index++];
+        if (c == '"')
+            return true;
+        if (c == '\\')
+            ++index;
+    }
+    return fail();
+}
+
+QVariant JsonStreamReader::readNumber()
+{
+    static const char numericCharacters[] = "0123456789+-.eE";
+    const int begin = index;
+    while (index < size && data[index] != '\0' && std::strchr(numericCharacters, data[index]))
+        ++index;
+    if (index == begin) {
+        fail();
+        return QVariant();
+    }
+
+    const QByteArray number = QByteArray::fromRawData(data + begin, index - begin);
+    if (number.contains('.'))
+        return QVariant(number.toDouble());
+    if (number.startsWith('-'))
+        return QVariant(number.toLongLong());
+    return QVariant(number.toULongLong());
+}
+
+QVariant JsonStreamReader::readLiteral(const char *literal, const QVariant &value)
+{
+    const int length = static_cast<int>(std::strlen(literal));
+    if (size - index < length || std::memcmp(data + index, literal, length) != 0) {
+        fail();
+        return QVariant();
+    }
+    index += length;
+    return value;
+}
@@ -0,0 +1,62 @@
+#ifndef JSONSTREAMREADER_H
+#define JSONSTREAMREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+
+/**
+ * Reads a JSON document straight from its UTF-8 bytes, one value at a time.
+ *
+ * Objects and arrays are walked with beginObject()/nextMember() and beginArray()/nextElement(). Every value can be
+ * read into a QVariant, numbers as doubles or 64 bit integers, or skipped without building anything. This keeps
+ * a file like AllPrintings from being converted to a QString and to a tree of QVariants as a whole.
+ *
+ * The data isn't copied, it has to outlive the reader.
+ * Errors are sticky: after the first malformed token every call fails and hasError() returns true.
+ */
+class JsonStreamReader
+{
+public:
+    explicit JsonStreamReader(const QByteArray &data);
+
+    bool beginObject();
+    /**
+     * Reads the key of the next member of the current object, the value is read or skipped next.
+     * Returns false once the object is closed.
+     */
+    bool nextMember(QString &key);
+    bool beginArray();
+    /**
+     * Moves to the next element of the current array. Returns false once the array is closed.
+     */
+    bool nextElement();
+
+    QVariant readValue();
+    bool skipValue();
+
+    /**
+     * The offset of the next token in the data.
+     */
+    int position();
+    bool hasError() const
+    {
+        return error;
+    }
+
+private:
+    const char *data;
+    int size;
+    int index;
+    bool error;
+
+    void eatWhitespace();
+    bool expect(char c);
+    bool fail();
+    bool readString(QString &string);
+    bool skipString();
+    QVariant readNumber();
+    QVariant readLiteral(const char *literal, const QVariant &value);
+};
+
+#endif
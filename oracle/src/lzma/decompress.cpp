@@ -16,11 +16,70 @@
 #include "decompress.h"
 
 XzDecompressor::XzDecompressor(QObject *parent)
-    : QObject(parent)
+    : QObject(parent), stream(LZMA_STREAM_INIT), streaming(false)
 {
 
 }
 
+XzDecompressor::~XzDecompressor()
+{
+	lzma_end(&stream);
+}
+
+bool XzDecompressor::beginStream()
+{
+	lzma_end(&stream);
+	stream = LZMA_STREAM_INIT;
+	streaming = init_decoder(&stream);
+	return streaming;
+}
+
+bool XzDecompressor::decompressChunk(const QByteArray &in, QByteArray &out)
+{
+	return code_stream(in, out, LZMA_RUN);
+}
+
+bool XzDecompressor::endStream(QByteArray &out)
+{
+	bool success = code_stream(QByteArray(), out, LZMA_FINISH);
+	lzma_end(&stream);
+	stream = LZMA_STREAM_INIT;
+	streaming = false;
+	return success;
+}
+
+bool XzDecompressor::code_stream(const QByteArray &in, QByteArray &out, lzma_action action)
+{
+	if (!streaming)
+		return false;
+	// without input lzma_code() can't make progress and would
+	// report an error the second time
+	if (action == LZMA_RUN && in.isEmpty())
+		return true;
+
+	uint8_t outbuf[BUFSIZ];
+	stream.next_in = (const uint8_t *) in.constData();
+	stream.avail_in = in.size();
+	while (true) {
+		stream.next_out = outbuf;
+		stream.avail_out = sizeof(outbuf);
+		lzma_ret ret = lzma_code(&stream, action);
+		out.append((const char *) outbuf, sizeof(outbuf) - stream.avail_out);
+
+		if (ret == LZMA_STREAM_END)
+			return true;
+		if (ret != LZMA_OK) {
+			qDebug() << "Decoder error (error code " << ret << ")";
+			streaming = false;
+			return false;
+		}
+		// everything that was given has been decoded, wait
+		// for the next chunk; the end only comes with LZMA_FINISH
+		if (action == LZMA_RUN && stream.avail_in == 0 && stream.avail_out != 0)
+			return true;
+	}
+}
+
 bool XzDecompressor::decompress(QBuffer *in, QBuffer *out)
 {
 	lzma_stream strm = LZMA_STREAM_INIT;
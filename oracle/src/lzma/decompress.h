@@ -9,11 +9,20 @@ class XzDecompressor : public QObject
     Q_OBJECT
 public:
     XzDecompressor(QObject *parent = 0);
-    ~XzDecompressor() { };
+    ~XzDecompressor();
     bool decompress(QBuffer *in, QBuffer *out);
+
+    // decodes a file as its chunks arrive, the decoded bytes are appended to out
+    bool beginStream();
+    bool decompressChunk(const QByteArray &in, QByteArray &out);
+    bool endStream(QByteArray &out);
 private:
+    lzma_stream stream;
+    bool streaming;
+
     bool init_decoder(lzma_stream *strm);
     bool internal_decompress(lzma_stream *strm, QBuffer *in, QBuffer *out);
+    bool code_stream(const QByteArray &in, QByteArray &out, lzma_action action);
 };
 
 #endif
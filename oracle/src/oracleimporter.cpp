@@ -1,11 +1,13 @@
 #include "oracleimporter.h"
 
 #include "game/cards/card_database_parser/cockatrice_xml_4.h"
+#include "jsonstreamreader.h"
 #include "parsehelpers.h"
-#include "qt-json/json.h"
 
 #include <QDebug>
 #include <QRegularExpression>
+#include <QThread>
+#include <QtConcurrent>
 #include <algorithm>
 #include <climits>
 
@@ -35,45 +37,97 @@ static CardSet::Priority getSetPriority(const QString &setType, const QString &s
     return priority;
 }
 
-bool OracleImporter::readSetsFromByteArray(const QByteArray &data)
+QList<QVariant> SetToDownload::readCards() const
 {
-    QList<SetToDownload> newSetList;
+    JsonStreamReader reader(cardsJson);
+    const QList<QVariant> cardsList = reader.readValue().toList();
+    if (reader.hasError()) {
+        qDebug() << "error: could not parse the cards of set" << shortName;
+    }
+    return cardsList;
+}
 
-    bool ok;
-    auto setsMap = QtJson::Json::parse(QString(data), ok).toMap().value("data").toMap();
-    if (!ok) {
-        qDebug() << "error: QtJson::Json::parse()";
+/**
+ * Reads the set object the reader is at, the cards of the set are skipped and only their bytes in data are kept.
+ */
+static bool readSet(JsonStreamReader &reader, const QByteArray &data, QList<SetToDownload> &sets)
+{
+    if (!reader.beginObject()) {
         return false;
     }
 
-    QListIterator it(setsMap.values());
-
-    while (it.hasNext()) {
-        QVariantMap map = it.next().toMap();
-        QString shortName = map.value("code").toString().toUpper();
-        QString longName = map.value("name").toString();
-        QList<QVariant> setCards = map.value("cards").toList();
-        QString setType = map.value("type").toString();
-        QDate releaseDate = map.value("releaseDate").toDate();
-        CardSet::Priority priority = getSetPriority(setType, shortName);
-        // capitalize set type
-        if (setType.length() > 0) {
-            // basic grammar for words that aren't capitalized, like in "From the Vault"
-            const QStringList noCapitalize = {"the", "a", "an", "on", "to", "for", "of", "in", "and", "with", "or"};
-            QStringList words = setType.split("_");
-            setType.clear();
-            bool first = false;
-            for (auto &item : words) {
-                if (first && noCapitalize.contains(item)) {
-                    setType += item + QString(" ");
-                } else {
-                    setType += item[0].toUpper() + item.mid(1, -1) + QString(" ");
-                    first = true;
-                }
+    QString key, shortName, longName, setType;
+    QByteArray setCards;
+    QDate releaseDate;
+    while (reader.nextMember(key)) {
+        if (key == "code") {
+            shortName = reader.readValue().toString().toUpper();
+        } else if (key == "name") {
+            longName = reader.readValue().toString();
+        } else if (key == "cards") {
+            const int begin = reader.position();
+            if (reader.skipValue()) {
+                setCards = QByteArray::fromRawData(data.constData() + begin, reader.position() - begin);
+            }
+        } else if (key == "type") {
+            setType = reader.readValue().toString();
+        } else if (key == "releaseDate") {
+            releaseDate = reader.readValue().toDate();
+        } else {
+            reader.skipValue();
+        }
+    }
+    if (reader.hasError()) {
+        return false;
+    }
+
+    CardSet::Priority priority = getSetPriority(setType, shortName);
+    // capitalize set type
+    if (setType.length() > 0) {
+        // basic grammar for words that aren't capitalized, like in "From the Vault"
+        const QStringList noCapitalize = {"the", "a", "an", "on", "to", "for", "of", "in", "and", "with", "or"};
+        QStringList words = setType.split("_");
+        setType.clear();
+        bool first = false;
+        for (auto &item : words) {
+            if (first && noCapitalize.contains(item)) {
+                setType += item + QString(" ");
+            } else {
+                setType += item[0].toUpper() + item.mid(1, -1) + QString(" ");
+                first = true;
+            }
+        }
+        setType = setType.trimmed();
+    }
+    sets.append(SetToDownload(shortName, longName, setCards, priority, setType, releaseDate));
+    return true;
+}
+
+bool OracleImporter::readSetsFromByteArray(const QByteArray &data)
+{
+    QList<SetToDownload> newSetList;
+
+    // the file is walked without building a tree of it, the cards of the sets are parsed when they are imported
+    JsonStreamReader reader(data);
+    QString key;
+    bool foundData = false;
+    if (reader.beginObject()) {
+        while (!foundData && reader.nextMember(key)) {
+            if (key != "data") {
+                reader.skipValue();
+                continue;
+            }
+
+            foundData = reader.beginObject();
+            QString setCode;
+            while (foundData && reader.nextMember(setCode)) {
+                foundData = readSet(reader, data, newSetList);
             }
-            setType = setType.trimmed();
         }
-        newSetList.append(SetToDownload(shortName, longName, setCards, priority, setType, releaseDate));
+    }
+    if (reader.hasError() || !foundData) {
+        qDebug() << "error: could not parse the sets at offset" << reader.position();
+        return false;
     }
 
     std::sort(newSetList.begin(), newSetList.end());
@@ -82,6 +136,7 @@ bool OracleImporter::readSetsFromByteArray(const QByteArray &data)
         return false;
     }
     allSets = newSetList;
+    setsData = data;
     return true;
 }
 
@@ -218,7 +273,7 @@ static QString getStringPropertyFromMap(const QVariantMap &card, const QString &
     return card.contains(propertyName) ? card.value(propertyName).toString() : QString("");
 }
 
-int OracleImporter::importCardsFromSet(const CardSetPtr &currentSet, const QList<QVariant> &cardsList)
+QList<StagedCard> OracleImporter::readCardsFromSet(const CardSetPtr &currentSet, const QList<QVariant> &cardsList)
 {
     // mtgjson name => xml name
     static const QMap<QString, QString> cardProperties{
@@ -234,16 +289,15 @@ int OracleImporter::importCardsFromSet(const CardSetPtr &currentSet, const QList
     // mtgjson name => xml name
     static const QMap<QString, QString> identifierProperties{{"multiverseId", "muid"}, {"scryfallId", "uuid"}};
 
-    int numCards = 0;
+    QList<StagedCard> stagedCards;
     QMap<QString, QPair<QList<SplitCardPart>, QString>> splitCards;
     QString ptSeparator("/");
     QVariantMap card;
     QString layout, name, text, colors, colorIdentity, faceName;
-    static constexpr bool isToken = false;
     static const QList<QString> setsWithCardsWithSameNameButDifferentText = {"UST"};
     QVariantHash properties;
     PrintingInfo printingInfo;
-    QList<CardRelation *> relatedCards;
+    QStringList transformsInto, conjures;
     QList<QString> allNameProps;
 
     for (const QVariant &cardVar : cardsList) {
@@ -364,7 +418,8 @@ int OracleImporter::importCardsFromSet(const CardSetPtr &currentSet, const QList
             }
         } else {
             // relations
-            relatedCards.clear();
+            transformsInto.clear();
+            conjures.clear();
 
             // add other face for split cards as card relation
             if (!getStringPropertyFromMap(card, "side").isEmpty()) {
@@ -379,12 +434,12 @@ int OracleImporter::importCardsFromSet(const CardSetPtr &currentSet, const QList
                     static const QRegularExpression meldNameRegex{"then meld them into ([^\\.]*)"};
                     QString additionalName = meldNameRegex.match(text).captured(1);
                     if (!additionalName.isNull()) {
-                        relatedCards.append(new CardRelation(additionalName, CardRelation::TransformInto));
+                        transformsInto.append(additionalName);
                     }
                 } else {
                     for (const QString &additionalName : name.split(" // ")) {
                         if (additionalName != faceName) {
-                            relatedCards.append(new CardRelation(additionalName, CardRelation::TransformInto));
+                            transformsInto.append(additionalName);
                         }
                     }
                 }
@@ -396,16 +451,11 @@ int OracleImporter::importCardsFromSet(const CardSetPtr &currentSet, const QList
                 QVariantMap givenRelated = card.value("relatedCards").toMap();
                 // conjured cards from a spellbook
                 if (givenRelated.contains("spellbook")) {
-                    auto spbk = givenRelated.value("spellbook").toStringList();
-                    for (const QString &spbkName : spbk) {
-                        relatedCards.append(
-                            new CardRelation(spbkName, CardRelation::DoesNotAttach, false, false, 1, true));
-                    }
+                    conjures = givenRelated.value("spellbook").toStringList();
                 }
             }
 
-            CardInfoPtr newCard = addCard(name + numComponent, text, isToken, properties, relatedCards, printingInfo);
-            numCards++;
+            stagedCards.append({name + numComponent, text, properties, transformsInto, conjures, printingInfo});
         }
     }
 
@@ -419,7 +469,6 @@ int OracleImporter::importCardsFromSet(const CardSetPtr &currentSet, const QList
 
         text.clear();
         properties.clear();
-        relatedCards.clear();
 
         for (const SplitCardPart &tmp : splitCardParts) {
             QString splitName = tmp.getName();
@@ -451,11 +500,33 @@ int OracleImporter::importCardsFromSet(const CardSetPtr &currentSet, const QList
                 }
             }
         }
-        CardInfoPtr newCard = addCard(name, text, isToken, properties, relatedCards, printingInfo);
-        numCards++;
+        stagedCards.append({name, text, properties, {}, {}, printingInfo});
+    }
+
+    return stagedCards;
+}
+
+int OracleImporter::mergeCards(const QList<StagedCard> &stagedCards)
+{
+    static constexpr bool isToken = false;
+    for (const StagedCard &stagedCard : stagedCards) {
+        // the relations are QObjects, they are created on the thread the cards are used from
+        QList<CardRelation *> relatedCards;
+        for (const QString &additionalName : stagedCard.transformsInto) {
+            relatedCards.append(new CardRelation(additionalName, CardRelation::TransformInto));
+        }
+        for (const QString &spbkName : stagedCard.conjures) {
+            relatedCards.append(new CardRelation(spbkName, CardRelation::DoesNotAttach, false, false, 1, true));
+        }
+        addCard(stagedCard.name, stagedCard.text, isToken, stagedCard.properties, relatedCards,
+                stagedCard.printingInfo);
     }
+    return static_cast<int>(stagedCards.size());
+}
 
-    return numCards;
+int OracleImporter::importCardsFromSet(const CardSetPtr &currentSet, const QList<QVariant> &cardsList)
+{
+    return mergeCards(readCardsFromSet(currentSet, cardsList));
 }
 
 int OracleImporter::startImport()
@@ -465,18 +536,36 @@ int OracleImporter::startImport()
     CardSetPtr tokenSet = CardSet::newInstance(CardSet::TOKENS_SETNAME, tr("Dummy set containing tokens"), "Tokens");
     sets.insert(CardSet::TOKENS_SETNAME, tokenSet);
 
+    QList<CardSetPtr> newSets;
     for (const SetToDownload &curSetToParse : allSets) {
         CardSetPtr newSet =
             CardSet::newInstance(curSetToParse.getShortName(), curSetToParse.getLongName(), curSetToParse.getSetType(),
                                  curSetToParse.getReleaseDate(), curSetToParse.getPriority());
         if (!sets.contains(newSet->getShortName()))
             sets.insert(newSet->getShortName(), newSet);
+        newSets.append(newSet);
+    }
+
+    // the cards of the sets are read on the thread pool, a few sets ahead of the one being merged; they are merged
+    // in the order of the sets, so the printings and legalities of the cards don't depend on the threads
+    const int setsAhead = qMax(1, QThread::idealThreadCount()) * 2;
+    QList<QFuture<QList<StagedCard>>> pendingSets;
+    int nextSet = 0;
+    while (setIndex < allSets.size()) {
+        while (nextSet < allSets.size() && pendingSets.size() < setsAhead) {
+            const SetToDownload &setToRead = allSets.at(nextSet);
+            const CardSetPtr newSet = newSets.at(nextSet);
+            pendingSets.append(QtConcurrent::run([setToRead, newSet]() {
+                return readCardsFromSet(newSet, setToRead.readCards());
+            }));
+            ++nextSet;
+        }
 
-        int numCardsInSet = importCardsFromSet(newSet, curSetToParse.getCards());
+        int numCardsInSet = mergeCards(pendingSets.takeFirst().result());
 
         ++setIndex;
 
-        emit setIndexChanged(numCardsInSet, setIndex, curSetToParse.getLongName());
+        emit setIndexChanged(numCardsInSet, setIndex, allSets.at(setIndex - 1).getLongName());
     }
 
     emit setIndexChanged(setCards, setIndex, QString());
@@ -488,6 +577,7 @@ int OracleImporter::startImport()
 bool OracleImporter::saveToFile(const QString &fileName, const QString &sourceUrl, const QString &sourceVersion)
 {
     CockatriceXml4Parser parser;
+    parser.setCompactOutput(true);
     return parser.saveToFile(sets, cards, fileName, sourceUrl, sourceVersion);
 }
 
@@ -496,4 +586,5 @@ void OracleImporter::clear()
     sets.clear();
     cards.clear();
     allSets.clear();
+    setsData.clear();
 }
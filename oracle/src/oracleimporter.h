@@ -43,7 +43,8 @@ class SetToDownload
 {
 private:
     QString shortName, longName;
-    QList<QVariant> cards;
+    // the "cards" array of the set in the downloaded file, it's only parsed when the set is imported
+    QByteArray cardsJson;
     QDate releaseDate;
     QString setType;
     CardSet::Priority priority;
@@ -57,10 +58,7 @@ public:
     {
         return longName;
     }
-    const QList<QVariant> &getCards() const
-    {
-        return cards;
-    }
+    QList<QVariant> readCards() const;
     const QString &getSetType() const
     {
         return setType;
@@ -75,11 +73,11 @@ public:
     }
     SetToDownload(QString _shortName,
                   QString _longName,
-                  QList<QVariant> _cards,
+                  QByteArray _cardsJson,
                   CardSet::Priority _priority,
                   QString _setType = QString(),
                   const QDate &_releaseDate = QDate())
-        : shortName(std::move(_shortName)), longName(std::move(_longName)), cards(std::move(_cards)),
+        : shortName(std::move(_shortName)), longName(std::move(_longName)), cardsJson(std::move(_cardsJson)),
           releaseDate(_releaseDate), setType(std::move(_setType)), priority(_priority)
     {
     }
@@ -120,6 +118,20 @@ private:
     PrintingInfo printingInfo;
 };
 
+/**
+ * A card read from the json of a set, with what's needed to add it to the cards of the importer.
+ */
+struct StagedCard
+{
+    QString name;
+    QString text;
+    QVariantHash properties;
+    // the cards it transforms or melds into, and the cards it conjures from its spellbook
+    QStringList transformsInto;
+    QStringList conjures;
+    PrintingInfo printingInfo;
+};
+
 class OracleImporter : public QObject
 {
     Q_OBJECT
@@ -137,6 +149,8 @@ private:
     SetNameMap sets;
 
     QList<SetToDownload> allSets;
+    // the file the sets were read from, the sets refer to their cards in it
+    QByteArray setsData;
 
     CardInfoPtr addCard(QString name,
                         const QString &text,
@@ -144,6 +158,11 @@ private:
                         QVariantHash properties,
                         const QList<CardRelation *> &relatedCards,
                         const PrintingInfo &printingInfo);
+    /**
+     * Reads the cards of a set without touching the importer, so the sets can be read on several threads.
+     */
+    static QList<StagedCard> readCardsFromSet(const CardSetPtr &currentSet, const QList<QVariant> &cardsList);
+    int mergeCards(const QList<StagedCard> &stagedCards);
 signals:
     void setIndexChanged(int cardsImported, int setIndex, const QString &setName);
     void dataReadProgress(int bytesRead, int totalBytes);
@@ -235,8 +235,13 @@ void OutroPage::initializePage()
     }
 }
 
-LoadSetsPage::LoadSetsPage(QWidget *parent) : OracleWizardPage(parent)
+LoadSetsPage::LoadSetsPage(QWidget *parent)
+    : OracleWizardPage(parent), xzStream(nullptr), decodingXzStream(false), xzStreamFailed(false)
 {
+#ifdef HAS_LZMA
+    xzStream = new XzDecompressor(this);
+#endif
+
     urlRadioButton = new QRadioButton(this);
     fileRadioButton = new QRadioButton(this);
 
@@ -329,7 +334,7 @@ void LoadSetsPage::actLoadSetsFile()
 bool LoadSetsPage::validatePage()
 {
     // once the import is finished, we call next(); skip validation
-    if (wizard()->downloadedPlainXml || wizard()->importer->getSets().count() > 0) {
+    if (wizard()->downloadedPlainXml || wizard()->setsUpToDate || wizard()->importer->getSets().count() > 0) {
         return true;
     }
 
@@ -386,12 +391,14 @@ bool LoadSetsPage::validatePage()
 void LoadSetsPage::downloadSetsFile(const QUrl &url)
 {
     wizard()->setCardSourceVersion("unknown");
+    wizard()->setsUpToDate = false;
 
     const auto urlString = url.toString();
     if (urlString == ALLSETS_URL || urlString == ALLSETS_URL_FALLBACK) {
+        // the version is checked first, an unchanged database isn't downloaded and imported again
         const auto versionUrl = QUrl::fromUserInput(MTGJSON_VERSION_URL);
         auto *versionReply = wizard()->nam->get(QNetworkRequest(versionUrl));
-        connect(versionReply, &QNetworkReply::finished, [this, versionReply]() {
+        connect(versionReply, &QNetworkReply::finished, this, [this, versionReply, url]() {
             if (versionReply->error() == QNetworkReply::NoError) {
                 auto jsonData = versionReply->readAll();
                 QJsonParseError jsonError{};
@@ -409,13 +416,47 @@ void LoadSetsPage::downloadSetsFile(const QUrl &url)
             }
 
             versionReply->deleteLater();
+
+            const QString &version = wizard()->getCardSourceVersion();
+            bool importAgain = !isImportedVersion(version);
+            if (!importAgain && !wizard()->backgroundMode) {
+                importAgain = QMessageBox::question(
+                                  this, tr("Card database up to date"),
+                                  tr("The card database already contains MTGJSON version %1.").arg(version) + "<br>" +
+                                      tr("Do you want to download and import it again?"),
+                                  QMessageBox::Yes | QMessageBox::No, QMessageBox::No) == QMessageBox::Yes;
+            }
+            if (!importAgain) {
+                wizard()->setsUpToDate = true;
+                wizard()->enableButtons();
+                setEnabled(true);
+                progressLabel->hide();
+                progressBar->hide();
+                wizard()->next();
+                return;
+            }
+            downloadSetsFileData(url);
         });
+        return;
     }
 
+    downloadSetsFileData(url);
+}
+
+bool LoadSetsPage::isImportedVersion(const QString &version)
+{
+    return version != "unknown" && version == wizard()->settings->value("allsetsversion").toString() &&
+           QFile::exists(SettingsCache::instance().getCardDatabasePath());
+}
+
+void LoadSetsPage::downloadSetsFileData(const QUrl &url)
+{
     wizard()->setCardSourceUrl(url.toString());
 
+    resetDownload();
     auto *reply = wizard()->nam->get(QNetworkRequest(url));
 
+    connect(reply, &QNetworkReply::readyRead, this, &LoadSetsPage::actDownloadReadyReadSetsFile);
     connect(reply, &QNetworkReply::finished, this, &LoadSetsPage::actDownloadFinishedSetsFile);
     connect(reply, &QNetworkReply::downloadProgress, this, &LoadSetsPage::actDownloadProgressSetsFile);
 }
@@ -429,6 +470,40 @@ void LoadSetsPage::actDownloadProgressSetsFile(qint64 received, qint64 total)
     progressLabel->setText(tr("Downloading (%1MB)").arg((int)received / (1024 * 1024)));
 }
 
+void LoadSetsPage::actDownloadReadyReadSetsFile()
+{
+    auto *reply = dynamic_cast<QNetworkReply *>(sender());
+    readDownloadedChunk(reply->readAll());
+}
+
+void LoadSetsPage::readDownloadedChunk(const QByteArray &chunk)
+{
+    if (xzStreamFailed) {
+        return;
+    }
+    downloadedData += chunk;
+
+#ifdef HAS_LZMA
+    // the decoding overlaps with the download, and the compressed bytes don't pile up
+    if (!decodingXzStream && downloadedData.startsWith(XZ_SIGNATURE)) {
+        decodingXzStream = xzStream->beginStream();
+    }
+    if (decodingXzStream) {
+        decodingXzStream = xzStream->decompressChunk(downloadedData, decodedData);
+        xzStreamFailed = !decodingXzStream;
+        downloadedData.clear();
+    }
+#endif
+}
+
+void LoadSetsPage::resetDownload()
+{
+    downloadedData.clear();
+    decodedData.clear();
+    decodingXzStream = false;
+    xzStreamFailed = false;
+}
+
 void LoadSetsPage::actDownloadFinishedSetsFile()
 {
     // check for a reply
@@ -440,6 +515,7 @@ void LoadSetsPage::actDownloadFinishedSetsFile()
         wizard()->enableButtons();
         setEnabled(true);
 
+        resetDownload();
         reply->deleteLater();
         return;
     }
@@ -448,7 +524,7 @@ void LoadSetsPage::actDownloadFinishedSetsFile()
     if (statusCode == 301 || statusCode == 302) {
         const auto redirectUrl = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
         qDebug() << "following redirect url:" << redirectUrl.toString();
-        downloadSetsFile(redirectUrl);
+        downloadSetsFileData(redirectUrl);
         reply->deleteLater();
         return;
     }
@@ -463,8 +539,20 @@ void LoadSetsPage::actDownloadFinishedSetsFile()
         wizard()->settings->remove("allsetsurl");
     }
 
-    readSetsFromByteArray(reply->readAll());
+    readDownloadedChunk(reply->readAll());
     reply->deleteLater();
+
+#ifdef HAS_LZMA
+    if (xzStreamFailed || (decodingXzStream && !xzStream->endStream(decodedData))) {
+        resetDownload();
+        zipDownloadFailed(tr("Xz extraction failed."));
+        return;
+    }
+#endif
+
+    QByteArray setsData = decodingXzStream ? std::move(decodedData) : std::move(downloadedData);
+    resetDownload();
+    readSetsFromByteArray(std::move(setsData));
 }
 
 void LoadSetsPage::readSetsFromByteArray(QByteArray _data)
@@ -478,6 +566,7 @@ void LoadSetsPage::readSetsFromByteArray(QByteArray _data)
     progressBar->show();
 
     wizard()->downloadedPlainXml = false;
+    wizard()->setsUpToDate = false;
     wizard()->xmlData.clear();
     readSetsFromByteArrayRef(_data);
 }
@@ -635,6 +724,13 @@ void SaveSetsPage::initializePage()
     messageLog->clear();
 
     retranslateUi();
+    if (wizard()->setsUpToDate) {
+        messageLog->hide();
+        if (wizard()->backgroundMode) {
+            emit readyToContinue();
+        }
+        return;
+    }
     if (wizard()->downloadedPlainXml) {
         messageLog->hide();
         return;
@@ -654,7 +750,10 @@ void SaveSetsPage::initializePage()
 void SaveSetsPage::retranslateUi()
 {
     setTitle(tr("Sets imported"));
-    if (wizard()->downloadedPlainXml) {
+    if (wizard()->setsUpToDate) {
+        setSubTitle(tr("The card database is already up to date with MTGJSON version %1.")
+                        .arg(wizard()->getCardSourceVersion()));
+    } else if (wizard()->downloadedPlainXml) {
         setSubTitle(tr("A cockatrice database file of %1 MB has been downloaded.")
                         .arg(qRound(wizard()->xmlData.size() / 1000000.0)));
     } else {
@@ -683,6 +782,10 @@ void SaveSetsPage::updateTotalProgress(int cardsImported, int /* setIndex */, co
 
 bool SaveSetsPage::validatePage()
 {
+    if (wizard()->setsUpToDate) {
+        return true;
+    }
+
     QString defaultPath = SettingsCache::instance().getCardDatabasePath();
     QString windowName = tr("Save card database");
     QString fileType = tr("XML; card database (*.xml)");
@@ -721,6 +824,13 @@ bool SaveSetsPage::validatePage()
         return false;
     }
 
+    // remember which version the database holds, so the next update can skip it if nothing changed
+    if (fileName == defaultPath && !wizard()->downloadedPlainXml && wizard()->getCardSourceVersion() != "unknown") {
+        wizard()->settings->setValue("allsetsversion", wizard()->getCardSourceVersion());
+    } else {
+        wizard()->settings->remove("allsetsversion");
+    }
+
     return true;
 }
 
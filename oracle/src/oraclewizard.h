@@ -19,6 +19,7 @@ class QTextEdit;
 class QVBoxLayout;
 class OracleImporter;
 class QSettings;
+class XzDecompressor;
 
 #include "pagetemplates.h"
 
@@ -69,6 +70,8 @@ public:
     QSettings *settings;
     QNetworkAccessManager *nam;
     bool downloadedPlainXml = false;
+    // the saved card database was imported from the same MTGJSON version that is online
+    bool setsUpToDate = false;
     QByteArray xmlData;
     bool backgroundMode = false;
 
@@ -132,6 +135,8 @@ protected:
     void readSetsFromByteArray(QByteArray _data);
     void readSetsFromByteArrayRef(QByteArray &_data);
     void downloadSetsFile(const QUrl &url);
+    void downloadSetsFileData(const QUrl &url);
+    bool isImportedVersion(const QString &version);
 
 private:
     QRadioButton *urlRadioButton;
@@ -147,10 +152,21 @@ private:
     QFuture<bool> future;
     QByteArray jsonData;
 
+    // the sets file being downloaded; an xz file is decoded while it arrives, and only the decoded bytes are kept
+    QByteArray downloadedData;
+    QByteArray decodedData;
+    XzDecompressor *xzStream;
+    bool decodingXzStream;
+    bool xzStreamFailed;
+
+    void readDownloadedChunk(const QByteArray &chunk);
+    void resetDownload();
+
 private slots:
     void actLoadSetsFile();
     void actRestoreDefaultUrl();
     void actDownloadProgressSetsFile(qint64 received, qint64 total);
+    void actDownloadReadyReadSetsFile();
     void actDownloadFinishedSetsFile();
     void importFinished();
     void zipDownloadFailed(const QString &message);
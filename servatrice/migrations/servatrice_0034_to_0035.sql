@@ -0,0 +1,12 @@
+-- Servatrice db migration from version 34 to version 35
+
+CREATE TABLE IF NOT EXISTS `cockatrice_id_sequences` (
+  `name` varchar(32) NOT NULL,
+  `next_id` int(7) unsigned NOT NULL,
+  PRIMARY KEY (`name`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 DEFAULT COLLATE utf8mb4_unicode_ci;
+
+INSERT INTO cockatrice_id_sequences SELECT 'games', IFNULL(MAX(id), 0) + 1 FROM cockatrice_games;
+INSERT INTO cockatrice_id_sequences SELECT 'replays', IFNULL(MAX(id), 0) + 1 FROM cockatrice_replays;
+
+UPDATE cockatrice_schema_version SET version=35 WHERE version=34;
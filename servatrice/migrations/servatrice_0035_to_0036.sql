@@ -0,0 +1,7 @@
+-- Servatrice db migration from version 35 to version 36
+
+-- the replay list is read a page at a time, newest first
+ALTER TABLE cockatrice_replays_access ADD INDEX `idx_player_game` (`id_player`, `id_game`);
+ALTER TABLE cockatrice_games ADD INDEX `idx_time_started` (`time_started`, `id`);
+
+UPDATE cockatrice_schema_version SET version=36 WHERE version=35;
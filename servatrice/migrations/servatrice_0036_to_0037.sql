@@ -0,0 +1,6 @@
+-- Servatrice db migration from version 36 to version 37
+
+-- session ids are handed out from blocks like the game and replay ids, the rows are written behind
+INSERT INTO cockatrice_id_sequences SELECT 'sessions', IFNULL(MAX(id), 0) + 1 FROM cockatrice_sessions;
+
+UPDATE cockatrice_schema_version SET version=37 WHERE version=36;
@@ -20,7 +20,7 @@ CREATE TABLE IF NOT EXISTS `cockatrice_schema_version` (
   PRIMARY KEY  (`version`)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 DEFAULT COLLATE utf8mb4_unicode_ci;
 
-INSERT INTO cockatrice_schema_version VALUES(34);
+INSERT INTO cockatrice_schema_version VALUES(37);
 
 -- users and user data tables
 CREATE TABLE IF NOT EXISTS `cockatrice_users` (
@@ -124,7 +124,8 @@ CREATE TABLE IF NOT EXISTS `cockatrice_games` (
   `player_count` tinyint(3) NOT NULL,
   `time_started` datetime default NULL,
   `time_finished` datetime default NULL,
-  PRIMARY KEY  (`id`)
+  PRIMARY KEY  (`id`),
+  KEY `idx_time_started` (`time_started`, `id`)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 DEFAULT COLLATE utf8mb4_unicode_ci;
 
 CREATE TABLE IF NOT EXISTS `cockatrice_games_players` (
@@ -133,8 +134,8 @@ CREATE TABLE IF NOT EXISTS `cockatrice_games_players` (
   FOREIGN KEY(`id_game`) REFERENCES `cockatrice_games`(`id`) ON DELETE CASCADE ON UPDATE CASCADE
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 DEFAULT COLLATE utf8mb4_unicode_ci;
 
--- Note: an empty row with id_game = NULL is created when the game is created,
--- and then updated when the game ends with the full replay data.
+-- Note: the rows of a game and its replays are only written once the game ends,
+-- their ids are handed out from the blocks reserved in cockatrice_id_sequences.
 CREATE TABLE IF NOT EXISTS `cockatrice_replays` (
   `id` int(7) NOT NULL AUTO_INCREMENT,
   `id_game` int(7) unsigned NULL,
@@ -150,10 +151,20 @@ CREATE TABLE IF NOT EXISTS `cockatrice_replays_access` (
   `replay_name` varchar(255) NOT NULL,
   `do_not_hide` tinyint(1) NOT NULL,
   KEY `id_player` (`id_player`),
+  KEY `idx_player_game` (`id_player`, `id_game`),
   FOREIGN KEY(`id_game`) REFERENCES `cockatrice_games`(`id`) ON DELETE CASCADE ON UPDATE CASCADE,
   FOREIGN KEY(`id_player`) REFERENCES `cockatrice_users`(`id`)  ON DELETE CASCADE ON UPDATE CASCADE
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 DEFAULT COLLATE utf8mb4_unicode_ci;
 
+-- next free id of the games and of the replays, each server reserves a block of ids at a time
+CREATE TABLE IF NOT EXISTS `cockatrice_id_sequences` (
+  `name` varchar(32) NOT NULL,
+  `next_id` int(7) unsigned NOT NULL,
+  PRIMARY KEY (`name`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 DEFAULT COLLATE utf8mb4_unicode_ci;
+
+INSERT INTO cockatrice_id_sequences VALUES('games', 1), ('replays', 1), ('sessions', 1);
+
 -- server administration
 
 -- Note: unused table
@@ -187,6 +198,8 @@ CREATE TABLE IF NOT EXISTS `cockatrice_servermessages` (
   PRIMARY KEY  (`timest`)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 DEFAULT COLLATE utf8mb4_unicode_ci;
 
+-- Note: the session rows are written behind the logins, their ids are handed out from the blocks reserved in
+-- cockatrice_id_sequences.
 CREATE TABLE IF NOT EXISTS `cockatrice_sessions` (
   `id` int(9) NOT NULL AUTO_INCREMENT,
   `user_name` varchar(35) NOT NULL,
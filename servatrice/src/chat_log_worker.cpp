@@ -0,0 +1,96 @@
+#include "chat_log_worker.h"
+
+#include <QDebug>
+#include <QThread>
+#include <QTimer>
+
+ChatLogWorker::ChatLogWorker(Servatrice_DatabaseInterface *_databaseInterface,
+                             int _maxQueueSize,
+                             int _maxBatchSize,
+                             int _flushInterval)
+    : databaseInterface(_databaseInterface), maxQueueSize(qMax(1, _maxQueueSize)), maxBatchSize(qMax(1, _maxBatchSize)),
+      peakQueueDepth(0), peakDelay(0), processingScheduled(false), storedMessages(0), failedMessages(0),
+      rejectedMessages(0)
+{
+    flushTimer = new QTimer(this);
+    flushTimer->setInterval(qMax(1, _flushInterval));
+    connect(flushTimer, &QTimer::timeout, this, &ChatLogWorker::processQueue);
+}
+
+ChatLogWorker::~ChatLogWorker()
+{
+    processQueue();
+    delete databaseInterface;
+    thread()->quit();
+}
+
+void ChatLogWorker::start()
+{
+    flushTimer->start();
+}
+
+bool ChatLogWorker::enqueue(const LoggedMessage &message)
+{
+    QMutexLocker locker(&queueMutex);
+    if (queue.size() >= maxQueueSize) {
+        ++rejectedMessages;
+        return false;
+    }
+
+    queue.append(message);
+    peakQueueDepth = qMax(peakQueueDepth, queue.size());
+    // smaller batches wait for the flush timer
+    if (queue.size() >= maxBatchSize && !processingScheduled) {
+        processingScheduled = true;
+        QMetaObject::invokeMethod(this, "processQueue", Qt::QueuedConnection);
+    }
+    return true;
+}
+
+int ChatLogWorker::getQueueDepth() const
+{
+    QMutexLocker locker(&queueMutex);
+    return queue.size();
+}
+
+int ChatLogWorker::takePeakQueueDepth()
+{
+    QMutexLocker locker(&queueMutex);
+    const int result = peakQueueDepth;
+    peakQueueDepth = queue.size();
+    return result;
+}
+
+qint64 ChatLogWorker::takePeakDelay()
+{
+    QMutexLocker locker(&queueMutex);
+    const qint64 result = peakDelay;
+    peakDelay = 0;
+    return result;
+}
+
+void ChatLogWorker::processQueue()
+{
+    for (;;) {
+        QList<LoggedMessage> batch;
+        {
+            QMutexLocker locker(&queueMutex);
+            if (queue.isEmpty()) {
+                processingScheduled = false;
+                return;
+            }
+            const int batchSize = qMin(maxBatchSize, queue.size());
+            batch = queue.mid(0, batchSize);
+            queue.erase(queue.begin(), queue.begin() + batchSize);
+            // the oldest message of the batch waited the longest
+            peakDelay = qMax(peakDelay, batch.first().time.msecsTo(QDateTime::currentDateTime()));
+        }
+
+        if (databaseInterface->checkSql() && databaseInterface->storeLoggedMessages(batch)) {
+            storedMessages += batch.size();
+        } else {
+            failedMessages += batch.size();
+            qCritical() << "ChatLogWorker: could not store" << batch.size() << "logged messages";
+        }
+    }
+}
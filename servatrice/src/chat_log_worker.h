@@ -0,0 +1,73 @@
+#ifndef CHAT_LOG_WORKER_H
+#define CHAT_LOG_WORKER_H
+
+#include "servatrice_database_interface.h"
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <atomic>
+
+class QTimer;
+
+/**
+ * Writes logged user messages to the database from a thread of its own.
+ *
+ * The threads handling the chat commands only queue the messages; the worker inserts them with multi-row
+ * statements whenever maxBatchSize messages are waiting, and at least every flushInterval milliseconds. The
+ * queue is bounded: enqueue() refuses messages once it is full, and the caller is expected to log them itself.
+ *
+ * The worker lives in its own thread and owns its database interface; deleting it writes whatever is still
+ * queued and quits the thread.
+ */
+class ChatLogWorker : public QObject
+{
+    Q_OBJECT
+public:
+    ChatLogWorker(Servatrice_DatabaseInterface *_databaseInterface,
+                  int _maxQueueSize,
+                  int _maxBatchSize,
+                  int _flushInterval);
+    ~ChatLogWorker() override;
+
+    // thread safe
+    bool enqueue(const LoggedMessage &message);
+
+    int getQueueDepth() const;
+    // returns the largest queue depth since the last call
+    int takePeakQueueDepth();
+    // returns the longest time in milliseconds a message waited to be written since the last call
+    qint64 takePeakDelay();
+    quint64 getStoredMessageCount() const
+    {
+        return storedMessages.load(std::memory_order_relaxed);
+    }
+    quint64 getFailedMessageCount() const
+    {
+        return failedMessages.load(std::memory_order_relaxed);
+    }
+    quint64 getRejectedMessageCount() const
+    {
+        return rejectedMessages.load(std::memory_order_relaxed);
+    }
+
+private slots:
+    void start();
+    void processQueue();
+
+private:
+    Servatrice_DatabaseInterface *databaseInterface;
+    const int maxQueueSize;
+    const int maxBatchSize;
+    QTimer *flushTimer;
+
+    mutable QMutex queueMutex;
+    QList<LoggedMessage> queue;
+    int peakQueueDepth;
+    qint64 peakDelay;
+    bool processingScheduled;
+
+    std::atomic<quint64> storedMessages, failedMessages, rejectedMessages;
+};
+
+#endif
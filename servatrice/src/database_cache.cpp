@@ -0,0 +1,78 @@
+#include "database_cache.h"
+
+// the database compares names case insensitively, the keys have to as well
+static QString userKey(const QString &userName)
+{
+    return userName.toCaseFolded();
+}
+
+static QString listEntryKey(const QString &list, const QString &whoseList, const QString &who)
+{
+    return list + '\n' + whoseList.toCaseFolded() + '\n' + who.toCaseFolded();
+}
+
+static QString banStateKey(const QString &address, const QString &userName, const QString &clientId)
+{
+    return address + '\n' + userName.toCaseFolded() + '\n' + clientId;
+}
+
+DatabaseCache::DatabaseCache(int maxUserIds, int maxListEntries, int maxBanStates, int timeToLive)
+    : userIds(maxUserIds, timeToLive * 1000), listEntries(maxListEntries, timeToLive * 1000),
+      banStates(maxBanStates, timeToLive * 1000)
+{
+}
+
+bool DatabaseCache::findUserId(const QString &userName, int &userId)
+{
+    return userIds.find(userKey(userName), userId);
+}
+
+void DatabaseCache::insertUserId(const QString &userName, int userId)
+{
+    userIds.insert(userKey(userName), userId);
+}
+
+void DatabaseCache::removeUser(const QString &userName)
+{
+    userIds.remove(userKey(userName));
+}
+
+bool DatabaseCache::findListEntry(const QString &list, const QString &whoseList, const QString &who, bool &isListed)
+{
+    return listEntries.find(listEntryKey(list, whoseList, who), isListed);
+}
+
+void DatabaseCache::insertListEntry(const QString &list, const QString &whoseList, const QString &who, bool isListed)
+{
+    listEntries.insert(listEntryKey(list, whoseList, who), isListed);
+}
+
+void DatabaseCache::removeListEntry(const QString &list, const QString &whoseList, const QString &who)
+{
+    listEntries.remove(listEntryKey(list, whoseList, who));
+}
+
+bool DatabaseCache::findBanState(const QString &address,
+                                 const QString &userName,
+                                 const QString &clientId,
+                                 BanState &state)
+{
+    if (!banStates.find(banStateKey(address, userName, clientId), state))
+        return false;
+
+    // once the cached ban ran out another one may still apply, the database has to be asked again
+    return !state.banned || !state.bannedUntil.isValid() || state.bannedUntil > QDateTime::currentDateTimeUtc();
+}
+
+void DatabaseCache::insertBanState(const QString &address,
+                                   const QString &userName,
+                                   const QString &clientId,
+                                   const BanState &state)
+{
+    banStates.insert(banStateKey(address, userName, clientId), state);
+}
+
+void DatabaseCache::clearBanStates()
+{
+    banStates.clear();
+}
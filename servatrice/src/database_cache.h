@@ -0,0 +1,129 @@
+#ifndef DATABASE_CACHE_H
+#define DATABASE_CACHE_H
+
+#include <QCache>
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+
+/**
+ * Caches the results of the lookups that run on every private message, game join and login: user ids, single
+ * buddy and ignore list entries, and ban checks.
+ *
+ * One cache is shared by all database interfaces, so invalidating an entry takes effect for every pool at once.
+ * Each kind of entry lives in its own LRU bounded cache with its own lock. Entries expire after a configurable
+ * time, which bounds how long changes made behind the server's back (e.g. by the web interface) go unnoticed;
+ * changes made through the server invalidate the affected entries right away, also on the other servers of the
+ * network.
+ */
+class DatabaseCache
+{
+public:
+    struct BanState
+    {
+        bool banned;
+        QString reason;
+        // invalid for permanent bans
+        QDateTime bannedUntil;
+    };
+
+    struct Counters
+    {
+        quint64 hits, misses;
+    };
+
+    DatabaseCache(int maxUserIds, int maxListEntries, int maxBanStates, int timeToLive);
+
+    bool findUserId(const QString &userName, int &userId);
+    void insertUserId(const QString &userName, int userId);
+    void removeUser(const QString &userName);
+
+    /**
+     * list is "buddy" or "ignore", as in Command_AddToList.
+     */
+    bool findListEntry(const QString &list, const QString &whoseList, const QString &who, bool &isListed);
+    void insertListEntry(const QString &list, const QString &whoseList, const QString &who, bool isListed);
+    void removeListEntry(const QString &list, const QString &whoseList, const QString &who);
+
+    bool findBanState(const QString &address, const QString &userName, const QString &clientId, BanState &state);
+    void insertBanState(const QString &address, const QString &userName, const QString &clientId, const BanState &state);
+    void clearBanStates();
+
+    Counters getUserIdCounters() const
+    {
+        return userIds.getCounters();
+    }
+    Counters getListEntryCounters() const
+    {
+        return listEntries.getCounters();
+    }
+    Counters getBanStateCounters() const
+    {
+        return banStates.getCounters();
+    }
+
+private:
+    template <typename T> class Shard
+    {
+    public:
+        Shard(int maxSize, int _timeToLive) : timeToLive(_timeToLive), cache(maxSize), hits(0), misses(0)
+        {
+        }
+
+        bool find(const QString &key, T &value)
+        {
+            QMutexLocker locker(&mutex);
+            Entry *entry = cache.object(key);
+            if (entry && entry->expiry.hasExpired()) {
+                cache.remove(key);
+                entry = nullptr;
+            }
+            if (!entry) {
+                misses.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            hits.fetch_add(1, std::memory_order_relaxed);
+            value = entry->value;
+            return true;
+        }
+        void insert(const QString &key, const T &value)
+        {
+            QMutexLocker locker(&mutex);
+            cache.insert(key, new Entry{value, QDeadlineTimer(timeToLive)});
+        }
+        void remove(const QString &key)
+        {
+            QMutexLocker locker(&mutex);
+            cache.remove(key);
+        }
+        void clear()
+        {
+            QMutexLocker locker(&mutex);
+            cache.clear();
+        }
+        Counters getCounters() const
+        {
+            return {hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed)};
+        }
+
+    private:
+        struct Entry
+        {
+            T value;
+            QDeadlineTimer expiry;
+        };
+
+        const qint64 timeToLive;
+        QMutex mutex;
+        QCache<QString, Entry> cache;
+        std::atomic<quint64> hits, misses;
+    };
+
+    Shard<int> userIds;
+    Shard<bool> listEntries;
+    Shard<BanState> banStates;
+};
+
+#endif
@@ -0,0 +1,212 @@
+#include "database_statements.h"
+
+namespace
+{
+
+struct StatementInfo
+{
+    const char *name;
+    const char *text;
+};
+
+// in the order of DatabaseStatement
+const StatementInfo statements[] = {
+    {"schema_version", "select version from {prefix}_schema_version limit 1"},
+    {"register_user",
+     "insert into {prefix}_users "
+     "(name, realname, password_sha512, email, country, registrationDate, active, token, "
+     "admin, avatar_bmp, clientid, privlevel, privlevelStartDate, privlevelEndDate) "
+     "values "
+     "(:userName, :realName, :password_sha512, :email, :country, UTC_TIMESTAMP(), :active, "
+     ":token, 0, '', '', 'NONE', UTC_TIMESTAMP(), UTC_TIMESTAMP())"},
+    {"select_inactive_user_with_token",
+     "select name from {prefix}_users where active=0 and name=:username and token=:token"},
+    {"activate_user", "update {prefix}_users set active=1 where name = :userName"},
+    {"select_password_and_active", "select password_sha512, active from {prefix}_users where name = :name"},
+    {"select_latest_bans",
+     "select 0, timestampdiff(second, now(), date_add(b.time_from, interval b.minutes minute)), b.minutes <=> 0, "
+     "b.visible_reason from {prefix}_bans b where b.time_from = (select max(c.time_from) from {prefix}_bans c "
+     "where c.ip_address = :address) and b.ip_address = :address2 "
+     "union all "
+     "select 1, timestampdiff(second, now(), date_add(b.time_from, interval b.minutes minute)), b.minutes <=> 0, "
+     "b.visible_reason from {prefix}_bans b where b.time_from = (select max(c.time_from) from {prefix}_bans c "
+     "where c.user_name = :name) and b.user_name = :name2 "
+     "union all "
+     "select 2, timestampdiff(second, now(), date_add(b.time_from, interval b.minutes minute)), b.minutes <=> 0, "
+     "b.visible_reason from {prefix}_bans b where :id <> '' and b.time_from = (select max(c.time_from) from "
+     "{prefix}_bans c where c.clientid = :id2) and b.clientid = :id3 "
+     "order by 1"},
+    {"active_user_exists", "select 1 from {prefix}_users where name = :name and active = 1"},
+    {"user_exists", "select 1 from {prefix}_users where name = :name"},
+    {"select_user_salt", "SELECT SUBSTRING(password_sha512, 1, 16) FROM {prefix}_users WHERE name = :name"},
+    {"select_active_user_id", "select id from {prefix}_users where name = :name and active = 1"},
+    {"select_user_data",
+     "select id, name, admin, country, privlevel, leftPawnColorOverride, "
+     "rightPawnColorOverride, realname, avatar_bmp, registrationDate, "
+     "email, clientid from {prefix}_users where "
+     "name = :name and active = 1"},
+    {"end_server_sessions",
+     "update {prefix}_sessions set end_time=now() where end_time is null and id_server = :id_server"},
+    {"end_session", "update {prefix}_sessions set end_time = :end_time where id = :id_session"},
+    {"select_buddy_list",
+     "select a.id, a.name, a.admin, a.country, a.privlevel, "
+     "a.leftPawnColorOverride, a.rightPawnColorOverride from {prefix}_users a "
+     "left join {prefix}_buddylist b on a.id = b.id_user2 left join {prefix}_users "
+     "c on b.id_user1 = c.id where c.name = :name"},
+    {"select_ignore_list",
+     "select a.id, a.name, a.admin, a.country, a.privlevel, "
+     "a.leftPawnColorOverride, a.rightPawnColorOverride from {prefix}_users a "
+     "left join {prefix}_ignorelist b on a.id = b.id_user2 left join {prefix}_users "
+     "c on b.id_user1 = c.id where c.name = :name"},
+    {"select_buddy_and_ignore_lists",
+     "select a.id, a.name, a.admin, a.country, a.privlevel, "
+     "a.leftPawnColorOverride, a.rightPawnColorOverride, 0 from {prefix}_users a "
+     "left join {prefix}_buddylist b on a.id = b.id_user2 left join {prefix}_users "
+     "c on b.id_user1 = c.id where c.name = :name "
+     "union all "
+     "select a.id, a.name, a.admin, a.country, a.privlevel, "
+     "a.leftPawnColorOverride, a.rightPawnColorOverride, 1 from {prefix}_users a "
+     "left join {prefix}_ignorelist b on a.id = b.id_user2 left join {prefix}_users "
+     "c on b.id_user1 = c.id where c.name = :name2"},
+    {"reserve_id_block",
+     "update {prefix}_id_sequences set next_id = last_insert_id(next_id + :block_size) where name = :name"},
+    {"insert_finished_game",
+     "insert into {prefix}_games (id, room_name, descr, creator_name, password, game_types, player_count, "
+     "time_started, time_finished) values (:id_game, :room_name, :descr, :creator_name, :password, :game_types, "
+     ":player_count, :time_started, now())"},
+    {"insert_recovered_game",
+     "insert ignore into {prefix}_games (id, room_name, descr, creator_name, password, game_types, player_count, "
+     "time_started) values (:id_game, '', :descr, :creator_name, :password, '', :player_count, :time_started)"},
+    {"insert_replay",
+     "insert into {prefix}_replays (id, id_game, duration, replay) values (:id_replay, :id_game, :duration, :replay)"},
+    {"select_deck_content", "select content from {prefix}_decklist_files where id = :id and id_user = :id_user"},
+    {"update_password",
+     "update {prefix}_users set password_sha512=:password, "
+     "passwordLastChangedDate = NOW() where name = :name"},
+    {"select_password", "select password_sha512 from {prefix}_users where name = :name"},
+    {"update_client_id", "update {prefix}_users set clientid = :clientid where name = :username"},
+    {"update_last_login_data",
+     "insert into {prefix}_user_analytics (id, client_ver, last_login) "
+     "select id, :client_ver, NOW() from {prefix}_users where name = :user_name "
+     "on duplicate key update last_login = NOW(), client_ver = :client_ver2"},
+    {"select_ban_history",
+     "SELECT A.id_admin, A.time_from, A.minutes, A.reason, A.visible_reason, B.name AS name_admin FROM "
+     "{prefix}_bans A LEFT JOIN {prefix}_users B ON A.id_admin=B.id WHERE A.user_name = :user_name"},
+    {"insert_warning",
+     "insert into {prefix}_warnings (user_id,user_name,mod_name,reason,time_of,clientid) values "
+     "(:user_id,:user_name,:mod_name,:warn_reason,NOW(),:client_id)"},
+    {"select_warn_history",
+     "SELECT user_name, mod_name, reason, time_of FROM {prefix}_warnings WHERE user_id = :user_id"},
+    {"count_accounts_with_email", "SELECT count(email) FROM {prefix}_users WHERE email = :user_email"},
+    {"insert_forgot_password", "insert into {prefix}_forgot_password (name,requestDate) values (:username,NOW())"},
+    {"delete_forgot_password", "delete from {prefix}_forgot_password where name = :username"},
+    {"count_recent_forgot_passwords",
+     "select count(name) from {prefix}_forgot_password where name = :user_name AND "
+     "requestDate > (now() - interval :minutes minute)"},
+    {"update_token", "update {prefix}_users set token = :token where name = :user_name"},
+    {"insert_audit_record",
+     "insert into {prefix}_audit "
+     "(id_server,name,ip_address,clientid,incidentDate,action,results,details) values "
+     "(:idserver,:username,:ipaddress,:clientid,NOW(),:action,:results,:details)"},
+    {"select_rooms",
+     "select id, name, descr, permissionlevel, privlevel, auto_join, join_message, chat_history_size from "
+     "{prefix}_rooms where id_server = :id_server order by id asc"},
+    {"select_room_game_types",
+     "select name from {prefix}_rooms_gametypes where id_room = :id_room AND id_server = :id_server"},
+    {"select_servers",
+     "select id, ssl_cert, hostname, address, game_port, control_port from {prefix}_servers order by id asc"},
+    {"select_login_message",
+     "select message from {prefix}_servermessages where id_server = :id_server order by timest desc limit 1"},
+    {"insert_uptime",
+     "insert into {prefix}_uptime (id_server, timest, uptime, users_count, mods_count, mods_list, games_count, "
+     "tx_bytes, rx_bytes) values(:id, NOW(), :uptime, :users_count, :mods_count, :mods_list, :games_count, :tx, "
+     ":rx)"},
+    {"select_activation_emails",
+     "select a.name, b.email, b.token from "
+     "{prefix}_activation_emails a left join "
+     "{prefix}_users b on a.name = b.name"},
+    {"delete_activation_email", "delete from {prefix}_activation_emails where name = :name"},
+    {"select_unsent_forgot_passwords",
+     "select a.name, b.email, b.token from {prefix}_forgot_password a left join {prefix}_users b on a.name "
+     "= b.name where a.emailed = 0"},
+    {"mark_forgot_password_emailed", "update {prefix}_forgot_password set emailed = 1 where name = :name"},
+    {"select_deck_folder_id",
+     "select id from {prefix}_decklist_folders where id_parent = "
+     ":id_parent and name = :name and id_user = :id_user"},
+    {"select_deck_folders", "select id, id_parent, name from {prefix}_decklist_folders where id_user = :id_user"},
+    {"select_deck_files",
+     "select id, id_folder, name, upload_time from {prefix}_decklist_files where id_user = :id_user"},
+    {"insert_deck_folder",
+     "insert into {prefix}_decklist_folders (id_parent, id_user, name) values(:id_parent, :id_user, :name)"},
+    {"select_deck_subfolders", "select id from {prefix}_decklist_folders where id_parent = :id_parent"},
+    {"delete_deck_files_in_folder", "delete from {prefix}_decklist_files where id_folder = :id_folder"},
+    {"delete_deck_folder", "delete from {prefix}_decklist_folders where id = :id"},
+    {"select_deck_file_id", "select id from {prefix}_decklist_files where id = :id and id_user = :id_user"},
+    {"delete_deck_file", "delete from {prefix}_decklist_files where id = :id"},
+    {"insert_deck_file",
+     "insert into {prefix}_decklist_files (id_folder, id_user, name, upload_time, "
+     "content) values(:id_folder, :id_user, :name, NOW(), :content)"},
+    {"update_deck_file",
+     "update {prefix}_decklist_files set name=:name, upload_time=NOW(), "
+     "content=:content where id = :id_deck and id_user = :id_user"},
+    {"select_replay_access",
+     "select a.id_game, a.replay_name, b.room_name, b.time_started, b.time_finished, b.descr, a.do_not_hide from "
+     "{prefix}_replays_access a left join {prefix}_games b on b.id = a.id_game where a.id_player = :id_player and "
+     "(a.do_not_hide = 1 or date_add(b.time_started, interval 7 day) > now())"},
+    // the newest first, one more than a page to tell whether there is another one
+    {"select_replay_access_page",
+     "select a.id_game, a.replay_name, b.room_name, b.time_started, b.time_finished, b.descr, a.do_not_hide from "
+     "{prefix}_replays_access a left join {prefix}_games b on b.id = a.id_game where a.id_player = :id_player and "
+     "(a.do_not_hide = 1 or date_add(b.time_started, interval 7 day) > now()) "
+     "order by b.time_started desc, a.id_game desc limit :limit"},
+    {"select_replay_access_page_before",
+     "select a.id_game, a.replay_name, b.room_name, b.time_started, b.time_finished, b.descr, a.do_not_hide from "
+     "{prefix}_replays_access a left join {prefix}_games b on b.id = a.id_game where a.id_player = :id_player and "
+     "(a.do_not_hide = 1 or date_add(b.time_started, interval 7 day) > now()) and "
+     "(b.time_started, a.id_game) < (:before_time, :before_game_id) "
+     "order by b.time_started desc, a.id_game desc limit :limit"},
+    {"select_game_players", "select player_name from {prefix}_games_players where id_game = :id_game"},
+    {"select_game_replays", "select id, duration from {prefix}_replays where id_game = :id_game"},
+    {"replay_access_exists",
+     "select 1 from {prefix}_replays_access a left join {prefix}_replays b on "
+     "a.id_game = b.id_game where b.id = :id_replay and a.id_player = :id_player"},
+    {"select_replay_chunk",
+     "select substring(replay, :start, :length), length(replay), left(replay, 1) from "
+     "{prefix}_replays where id = :id_replay"},
+    {"select_replay_data", "select replay from {prefix}_replays where id = :id_replay"},
+    {"update_replay_do_not_hide",
+     "update {prefix}_replays_access set do_not_hide=:do_not_hide where "
+     "id_player = :id_player and id_game = :id_game"},
+    {"delete_replay_access", "delete from {prefix}_replays_access where id_player = :id_player and id_game = :id_game"},
+    {"insert_ban",
+     "insert into {prefix}_bans (user_name, ip_address, id_admin, time_from, minutes, reason, visible_reason, "
+     "clientid) values(:user_name, :ip_address, :id_admin, NOW(), :minutes, :reason, :visible_reason, :client_id)"},
+    {"select_users_with_client_id", "select name from {prefix}_users where clientid = :client_id"},
+    {"insert_activation_email", "insert into {prefix}_activation_emails (name) values(:name)"},
+    {"update_avatar", "update {prefix}_users set avatar_bmp=:image where id=:id"},
+    {"add_admin_flag", "update {prefix}_users set admin = (admin | :adminlevel) where name = :username"},
+    {"remove_admin_flag", "update {prefix}_users set admin = (admin & ~ :adminlevel) where name = :username"},
+    {"count_replay_access", "select count(*) from {prefix}_replays_access where id_game = :idgame"},
+    {"select_user_id", "select id from {prefix}_users WHERE name = :name"},
+    {"insert_replay_access",
+     "insert into {prefix}_replays_access (id_game, id_player, replay_name, do_not_hide) "
+     "values(:idgame, :idplayer, :replayname, 0)"},
+    {"select_token", "select token from {prefix}_users WHERE name = :name"},
+    {"select_admin_notes", "select adminnotes from {prefix}_users WHERE name = :name"},
+    {"update_admin_notes", "update {prefix}_users set adminnotes = :adminnotes where name = :name"},
+};
+
+static_assert(sizeof(statements) / sizeof(statements[0]) == static_cast<int>(DatabaseStatement::Count),
+              "every statement needs an entry");
+
+} // namespace
+
+const char *databaseStatementName(DatabaseStatement statement)
+{
+    return statements[static_cast<int>(statement)].name;
+}
+
+const char *databaseStatementText(DatabaseStatement statement)
+{
+    return statements[static_cast<int>(statement)].text;
+}
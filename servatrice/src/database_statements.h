@@ -0,0 +1,96 @@
+#ifndef DATABASE_STATEMENTS_H
+#define DATABASE_STATEMENTS_H
+
+/**
+ * The fixed statements of the database interface. A connection keeps them prepared in slots indexed by these ids, so
+ * looking one up doesn't hash its text, and they are prepared again whenever the connection is reopened.
+ *
+ * Statements whose text is put together at run time still go through the text based prepareQuery().
+ */
+enum class DatabaseStatement
+{
+    SchemaVersion,
+    RegisterUser,
+    SelectInactiveUserWithToken,
+    ActivateUser,
+    SelectPasswordAndActive,
+    SelectLatestBans,
+    ActiveUserExists,
+    UserExists,
+    SelectUserSalt,
+    SelectActiveUserId,
+    SelectUserData,
+    EndServerSessions,
+    EndSession,
+    SelectBuddyList,
+    SelectIgnoreList,
+    SelectBuddyAndIgnoreLists,
+    ReserveIdBlock,
+    InsertFinishedGame,
+    InsertRecoveredGame,
+    InsertReplay,
+    SelectDeckContent,
+    UpdatePassword,
+    SelectPassword,
+    UpdateClientId,
+    UpdateLastLoginData,
+    SelectBanHistory,
+    InsertWarning,
+    SelectWarnHistory,
+    CountAccountsWithEmail,
+    InsertForgotPassword,
+    DeleteForgotPassword,
+    CountRecentForgotPasswords,
+    UpdateToken,
+    InsertAuditRecord,
+    SelectRooms,
+    SelectRoomGameTypes,
+    SelectServers,
+    SelectLoginMessage,
+    InsertUptime,
+    SelectActivationEmails,
+    DeleteActivationEmail,
+    SelectUnsentForgotPasswords,
+    MarkForgotPasswordEmailed,
+    SelectDeckFolderId,
+    SelectDeckFolders,
+    SelectDeckFiles,
+    InsertDeckFolder,
+    SelectDeckSubfolders,
+    DeleteDeckFilesInFolder,
+    DeleteDeckFolder,
+    SelectDeckFileId,
+    DeleteDeckFile,
+    InsertDeckFile,
+    UpdateDeckFile,
+    SelectReplayAccess,
+    SelectReplayAccessPage,
+    SelectReplayAccessPageBefore,
+    SelectGamePlayers,
+    SelectGameReplays,
+    ReplayAccessExists,
+    SelectReplayChunk,
+    SelectReplayData,
+    UpdateReplayDoNotHide,
+    DeleteReplayAccess,
+    InsertBan,
+    SelectUsersWithClientId,
+    InsertActivationEmail,
+    UpdateAvatar,
+    AddAdminFlag,
+    RemoveAdminFlag,
+    CountReplayAccess,
+    SelectUserId,
+    InsertReplayAccess,
+    SelectToken,
+    SelectAdminNotes,
+    UpdateAdminNotes,
+    Count
+};
+
+// the label of the statement in the metrics
+const char *databaseStatementName(DatabaseStatement statement);
+// the text of the statement, with {prefix} in place of the table prefix
+const char *databaseStatementText(DatabaseStatement statement);
+
+#endif
@@ -0,0 +1,220 @@
+#include "handoff_channel.h"
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+#include <cerrno>
+#include <cstring>
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace HandoffChannel
+{
+
+#if defined(Q_OS_LINUX)
+// the socket may be non-blocking, in which case this waits until it is ready; false on timeout
+static bool waitFor(int channel, short events, int timeoutMs)
+{
+    pollfd entry = {channel, events, 0};
+    int result;
+    do {
+        result = ::poll(&entry, 1, timeoutMs);
+    } while (result < 0 && errno == EINTR);
+    return result > 0;
+}
+
+// reads size bytes, appending the descriptors that come along
+static bool readFully(int channel, char *data, int size, QList<int> &descriptors, const QElapsedTimer &timer,
+                      int timeoutMs)
+{
+    union {
+        char buffer[CMSG_SPACE(sizeof(int) * maxDescriptors)];
+        cmsghdr align;
+    } control;
+
+    while (size > 0) {
+        iovec iov = {data, static_cast<size_t>(size)};
+        msghdr header = {};
+        header.msg_iov = &iov;
+        header.msg_iovlen = 1;
+        header.msg_control = control.buffer;
+        header.msg_controllen = sizeof(control.buffer);
+
+        const ssize_t received = ::recvmsg(channel, &header, MSG_CMSG_CLOEXEC);
+        if (received < 0) {
+            if (errno == EINTR)
+                continue;
+            const int remaining = timeoutMs - static_cast<int>(timer.elapsed());
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && remaining > 0 && waitFor(channel, POLLIN, remaining))
+                continue;
+            return false;
+        }
+        if (received == 0)
+            return false;
+
+        for (cmsghdr *entry = CMSG_FIRSTHDR(&header); entry; entry = CMSG_NXTHDR(&header, entry)) {
+            if (entry->cmsg_level != SOL_SOCKET || entry->cmsg_type != SCM_RIGHTS)
+                continue;
+            const int count = static_cast<int>((entry->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+            for (int i = 0; i < count; ++i) {
+                int descriptor;
+                memcpy(&descriptor, CMSG_DATA(entry) + i * sizeof(int), sizeof(int));
+                descriptors.append(descriptor);
+            }
+        }
+        data += received;
+        size -= static_cast<int>(received);
+    }
+    return true;
+}
+#endif
+
+bool isSupported()
+{
+#if defined(Q_OS_LINUX)
+    return true;
+#else
+    return false;
+#endif
+}
+
+int duplicateDescriptor(int descriptor)
+{
+#if defined(Q_OS_LINUX)
+    return ::fcntl(descriptor, F_DUPFD_CLOEXEC, 0);
+#else
+    Q_UNUSED(descriptor);
+    return -1;
+#endif
+}
+
+void closeDescriptor(int descriptor)
+{
+#if defined(Q_OS_LINUX)
+    if (descriptor >= 0)
+        ::close(descriptor);
+#else
+    Q_UNUSED(descriptor);
+#endif
+}
+
+int connectTo(const QString &path)
+{
+#if defined(Q_OS_LINUX)
+    const QByteArray encodedPath = path.toLocal8Bit();
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (encodedPath.isEmpty() || encodedPath.size() >= static_cast<int>(sizeof(address.sun_path)))
+        return -1;
+    memcpy(address.sun_path, encodedPath.constData(), encodedPath.size());
+
+    const int channel = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (channel < 0)
+        return -1;
+    if (::connect(channel, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        ::close(channel);
+        return -1;
+    }
+    return channel;
+#else
+    Q_UNUSED(path);
+    return -1;
+#endif
+}
+
+bool send(int channel, const QByteArray &message, const QList<int> &descriptors)
+{
+#if defined(Q_OS_LINUX)
+    if (message.size() > maxMessageSize || descriptors.size() > maxDescriptors)
+        return false;
+
+    QByteArray data(4, '\0');
+    const quint32 size = static_cast<quint32>(message.size());
+    data[0] = static_cast<char>(size >> 24);
+    data[1] = static_cast<char>(size >> 16);
+    data[2] = static_cast<char>(size >> 8);
+    data[3] = static_cast<char>(size);
+    data.append(message);
+
+    union {
+        char buffer[CMSG_SPACE(sizeof(int) * maxDescriptors)];
+        cmsghdr align;
+    } control;
+    memset(control.buffer, 0, sizeof(control.buffer));
+
+    const char *pos = data.constData();
+    int left = data.size();
+    bool descriptorsSent = descriptors.isEmpty();
+    while (left > 0) {
+        iovec iov = {const_cast<char *>(pos), static_cast<size_t>(left)};
+        msghdr header = {};
+        header.msg_iov = &iov;
+        header.msg_iovlen = 1;
+        if (!descriptorsSent) {
+            header.msg_control = control.buffer;
+            header.msg_controllen = CMSG_SPACE(sizeof(int) * descriptors.size());
+            cmsghdr *entry = CMSG_FIRSTHDR(&header);
+            entry->cmsg_level = SOL_SOCKET;
+            entry->cmsg_type = SCM_RIGHTS;
+            entry->cmsg_len = CMSG_LEN(sizeof(int) * descriptors.size());
+            for (int i = 0; i < descriptors.size(); ++i) {
+                const int descriptor = descriptors.at(i);
+                memcpy(CMSG_DATA(entry) + i * sizeof(int), &descriptor, sizeof(int));
+            }
+        }
+
+        const ssize_t written = ::sendmsg(channel, &header, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            // the other side takes its time to adopt a game or session now and then, but not forever
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && waitFor(channel, POLLOUT, 30000))
+                continue;
+            return false;
+        }
+        descriptorsSent = true;
+        pos += written;
+        left -= static_cast<int>(written);
+    }
+    return true;
+#else
+    Q_UNUSED(channel);
+    Q_UNUSED(message);
+    Q_UNUSED(descriptors);
+    return false;
+#endif
+}
+
+bool receive(int channel, QByteArray &message, QList<int> &descriptors, int timeoutMs)
+{
+#if defined(Q_OS_LINUX)
+    QElapsedTimer timer;
+    timer.start();
+    if (!waitFor(channel, POLLIN, timeoutMs))
+        return false;
+
+    unsigned char prefix[4];
+    if (!readFully(channel, reinterpret_cast<char *>(prefix), 4, descriptors, timer, timeoutMs))
+        return false;
+    const quint32 size = (quint32(prefix[0]) << 24) | (quint32(prefix[1]) << 16) | (quint32(prefix[2]) << 8) |
+                         quint32(prefix[3]);
+    if (size > static_cast<quint32>(maxMessageSize))
+        return false;
+
+    message.resize(static_cast<int>(size));
+    return readFully(channel, message.data(), message.size(), descriptors, timer, timeoutMs);
+#else
+    Q_UNUSED(channel);
+    Q_UNUSED(message);
+    Q_UNUSED(descriptors);
+    Q_UNUSED(timeoutMs);
+    return false;
+#endif
+}
+
+} // namespace HandoffChannel
@@ -0,0 +1,36 @@
+#ifndef HANDOFF_CHANNEL_H
+#define HANDOFF_CHANNEL_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+/**
+ * The unix domain socket a running server hands its state over to the process replacing it, see ServerHandoff.
+ *
+ * Every message is a serialized ServerHandoff prefixed with its length as 4 byte big endian, the file descriptors
+ * sent along travel with its first byte as SCM_RIGHTS. The calls block, the handoff runs on its own while nothing
+ * else happens in either process. Only available on Linux, like the per pool listeners; elsewhere every call fails.
+ */
+namespace HandoffChannel
+{
+// larger messages are taken for garbage
+inline constexpr int maxMessageSize = 64 * 1024 * 1024;
+// the most file descriptors a single message carries
+inline constexpr int maxDescriptors = 64;
+
+bool isSupported();
+// wrappers around dup() and close(), for the descriptors taken out of Qt's hands; -1 where unsupported
+int duplicateDescriptor(int descriptor);
+void closeDescriptor(int descriptor);
+// the connected socket, or -1
+int connectTo(const QString &path);
+bool send(int channel, const QByteArray &message, const QList<int> &descriptors = {});
+/**
+ * Waits up to timeoutMs for the next message. The descriptors that came with it are appended to descriptors and
+ * belong to the caller.
+ */
+bool receive(int channel, QByteArray &message, QList<int> &descriptors, int timeoutMs);
+} // namespace HandoffChannel
+
+#endif
@@ -0,0 +1,21 @@
+#include "id_block_allocator.h"
+
+#include <QMutexLocker>
+
+IdBlockAllocator::IdBlockAllocator(int _blockSize) : blockSize(qMax(1, _blockSize)), nextId(0), endId(0)
+{
+}
+
+qint64 IdBlockAllocator::next(const ReserveBlock &reserveBlock)
+{
+    QMutexLocker locker(&mutex);
+    if (nextId >= endId) {
+        // the other threads wait for the reservation rather than reserving blocks of their own
+        const qint64 firstId = reserveBlock(blockSize);
+        if (firstId < 0)
+            return -1;
+        nextId = firstId;
+        endId = firstId + blockSize;
+    }
+    return nextId++;
+}
@@ -0,0 +1,38 @@
+#ifndef ID_BLOCK_ALLOCATOR_H
+#define ID_BLOCK_ALLOCATOR_H
+
+#include <QMutex>
+#include <functional>
+
+/**
+ * Hands out ids from blocks reserved in the database, so that creating a game or a replay doesn't need a round trip
+ * of its own.
+ *
+ * A block is reserved through the function given to next() once the previous one is used up. It gets the size of the
+ * block and returns the first id of it, or -1 when the reservation failed. The ids left in the block of a server that
+ * stops are never used, which only leaves a gap.
+ *
+ * One allocator is shared by all database interfaces of the server.
+ */
+class IdBlockAllocator
+{
+public:
+    using ReserveBlock = std::function<qint64(int blockSize)>;
+
+    explicit IdBlockAllocator(int _blockSize);
+
+    // -1 when a new block was needed and couldn't be reserved
+    qint64 next(const ReserveBlock &reserveBlock);
+
+    int getBlockSize() const
+    {
+        return blockSize;
+    }
+
+private:
+    QMutex mutex;
+    const int blockSize;
+    qint64 nextId, endId;
+};
+
+#endif
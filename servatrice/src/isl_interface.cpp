@@ -3,6 +3,8 @@
 #include "debug_pb_message.h"
 #include "get_pb_extension.h"
 #include "main.h"
+#include "message_compression.h"
+#include "metrics.h"
 #include "pb/event_game_joined.pb.h"
 #include "pb/event_join_room.pb.h"
 #include "pb/event_leave_room.pb.h"
@@ -17,8 +19,10 @@
 #include "server_logger.h"
 #include "server_protocolhandler.h"
 #include "server_room.h"
+#include "settingscache.h"
 
 #include <QSslSocket>
+#include <QTimer>
 #include <google/protobuf/descriptor.h>
 
 void IslInterface::sharedCtor(const QSslCertificate &cert, const QSslKey &privateKey)
@@ -30,14 +34,26 @@ void IslInterface::sharedCtor(const QSslCertificate &cert, const QSslKey &privat
     connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()), Qt::QueuedConnection);
     connect(socket, SIGNAL(error(QAbstractSocket::SocketError)), this,
             SLOT(catchSocketError(QAbstractSocket::SocketError)));
-    connect(this, SIGNAL(outputBufferChanged()), this, SLOT(flushOutputBuffer()), Qt::QueuedConnection);
+    connect(this, SIGNAL(outputBufferChanged()), this, SLOT(scheduleFlush()), Qt::QueuedConnection);
+
+    flushDelay = settingsCache->value("servernetwork/flush_delay", 2).toInt();
+    flushBytes = settingsCache->value("servernetwork/flush_bytes", 65536).toInt();
+    compressionThreshold = settingsCache->value("servernetwork/compression_threshold", 0).toInt();
+    bufferedMessages = 0;
+    peakBufferedMessages = 0;
+    peakFlushLatency = 0;
+    outputDelay = nullptr;
+
+    flushTimer = new QTimer(this);
+    flushTimer->setSingleShot(true);
+    connect(flushTimer, &QTimer::timeout, this, &IslInterface::flushOutputBuffer);
 }
 
 IslInterface::IslInterface(int _socketDescriptor,
                            const QSslCertificate &cert,
                            const QSslKey &privateKey,
                            Servatrice *_server)
-    : QObject(), socketDescriptor(_socketDescriptor), server(_server), messageInProgress(false)
+    : QObject(), socketDescriptor(_socketDescriptor), server(_server), inputBufferBytes(0), messageInProgress(false)
 {
     sharedCtor(cert, privateKey);
 }
@@ -51,7 +67,7 @@ IslInterface::IslInterface(int _serverId,
                            const QSslKey &privateKey,
                            Servatrice *_server)
     : QObject(), serverId(_serverId), peerHostName(_peerHostName), peerAddress(_peerAddress), peerPort(_peerPort),
-      peerCert(_peerCert), server(_server), messageInProgress(false)
+      peerCert(_peerCert), server(_server), inputBufferBytes(0), messageInProgress(false)
 {
     sharedCtor(cert, privateKey);
 }
@@ -134,48 +150,80 @@ void IslInterface::initServer()
     }
     serverId = serverList[listIndex].id;
 
-    Event_ServerCompleteList event;
-    event.set_server_id(server->getServerID());
-
-    server->clientsLock.lockForRead();
-    QMapIterator<QString, Server_ProtocolHandler *> userIterator(server->getUsers());
-    while (userIterator.hasNext())
-        event.add_user_list()->CopyFrom(userIterator.next().value()->copyUserInfo(true, true));
-    server->clientsLock.unlock();
-
-    server->roomsLock.lockForRead();
-    QMapIterator<int, Server_Room *> roomIterator(server->getRooms());
-    while (roomIterator.hasNext()) {
-        Server_Room *room = roomIterator.next().value();
-        room->usersLock.lockForRead();
-        room->gamesLock.lockForRead();
-        room->getInfo(*event.add_room_list(), true, true, false);
-    }
-
-    IslMessage message;
-    message.set_message_type(IslMessage::SESSION_EVENT);
-    SessionEvent *sessionEvent = message.mutable_session_event();
-    sessionEvent->GetReflection()
-        ->MutableMessage(sessionEvent, event.GetDescriptor()->FindExtensionByName("ext"))
-        ->CopyFrom(event);
-
     server->islLock.lockForWrite();
     if (server->islConnectionExists(serverId)) {
         qDebug() << "[ISL] Duplicate connection to #" << serverId << "terminating connection";
+        server->islLock.unlock();
         deleteLater();
-    } else {
-        transmitMessage(message);
-        server->addIslInterface(serverId, this);
+        return;
     }
+    outputDelay = server->getMetrics()->histogram("servatrice_isl_output_delay_seconds",
+                                                  "How long messages to another server of the network wait before "
+                                                  "they are written.",
+                                                  Metrics::label("server_id", QString::number(serverId)));
+    server->addIslInterface(serverId, this);
     server->islLock.unlock();
 
-    roomIterator.toFront();
-    while (roomIterator.hasNext()) {
-        roomIterator.next();
-        roomIterator.value()->gamesLock.unlock();
-        roomIterator.value()->usersLock.unlock();
+    sendCompleteList();
+}
+
+void IslInterface::transmitCompleteList(const Event_ServerCompleteList &event)
+{
+    IslMessage message;
+    message.set_message_type(IslMessage::SESSION_EVENT);
+    SessionEvent *sessionEvent = message.mutable_session_event();
+    setPbExtension(sessionEvent, event);
+    transmitMessage(message);
+}
+
+void IslInterface::sendCompleteList()
+{
+    // This interface is registered already, so every change from now on reaches the peer as an event of its own, in
+    // order. The current state can therefore be sent in slices, each one taking the locks only for a short time.
+    // The peer adds up the lists it receives; a slice may repeat what an event told it already, which is harmless.
+    static const int usersPerSlice = 200;
+
+    QString lastUserName;
+    bool moreUsers = true;
+    while (moreUsers) {
+        Event_ServerCompleteList event;
+        event.set_server_id(server->getServerID());
+
+        server->clientsLock.lockForRead();
+        const QList<Server_ProtocolHandler *> users = server->getUsersAfter(lastUserName, usersPerSlice);
+        for (Server_ProtocolHandler *user : users)
+            user->copyUserInfo(*event.add_user_list(), true, true);
+        server->clientsLock.unlock();
+
+        moreUsers = users.size() == usersPerSlice;
+        if (!users.isEmpty())
+            lastUserName = QString::fromStdString(event.user_list(event.user_list_size() - 1).name());
+        if (event.user_list_size() > 0 || lastUserName.isEmpty())
+            transmitCompleteList(event);
     }
+
+    server->roomsLock.lockForRead();
+    const QList<int> roomIds = server->getRooms().keys();
     server->roomsLock.unlock();
+
+    for (int roomId : roomIds) {
+        Event_ServerCompleteList event;
+        event.set_server_id(server->getServerID());
+
+        server->roomsLock.lockForRead();
+        Server_Room *room = server->getRooms().value(roomId);
+        if (room) {
+            room->usersLock.lockForRead();
+            room->gamesLock.lockForRead();
+            room->getInfo(*event.add_room_list(), true, true, false);
+            room->gamesLock.unlock();
+            room->usersLock.unlock();
+        }
+        server->roomsLock.unlock();
+
+        if (room)
+            transmitCompleteList(event);
+    }
 }
 
 void IslInterface::initClient()
@@ -213,21 +261,60 @@ void IslInterface::initClient()
         return;
     }
 
+    outputDelay = server->getMetrics()->histogram("servatrice_isl_output_delay_seconds",
+                                                  "How long messages to another server of the network wait before "
+                                                  "they are written.",
+                                                  Metrics::label("server_id", QString::number(serverId)));
     server->addIslInterface(serverId, this);
     server->islLock.unlock();
 }
 
+void IslInterface::scheduleFlush()
+{
+    outputBufferMutex.lock();
+    const bool flushNow = flushDelay <= 0 || outputBuffer.size() >= flushBytes;
+    outputBufferMutex.unlock();
+
+    if (flushNow)
+        flushOutputBuffer();
+    else if (!flushTimer->isActive())
+        flushTimer->start(flushDelay);
+}
+
 void IslInterface::flushOutputBuffer()
 {
+    flushTimer->stop();
+
     QMutexLocker locker(&outputBufferMutex);
     if (outputBuffer.isEmpty())
         return;
+    peakBufferedMessages = qMax(peakBufferedMessages, bufferedMessages);
+    peakFlushLatency = qMax(peakFlushLatency, oldestBufferedMessage.elapsed());
+    if (outputDelay)
+        outputDelay->observe(oldestBufferedMessage.nsecsElapsed() / 1000);
+    bufferedMessages = 0;
+
     server->incTxBytes(outputBuffer.size());
     socket->write(outputBuffer);
     socket->flush();
     outputBuffer.clear();
 }
 
+void IslInterface::takeStatistics(int &peakMessages, qint64 &peakLatency)
+{
+    QMutexLocker locker(&outputBufferMutex);
+    peakMessages = qMax(peakBufferedMessages, bufferedMessages);
+    peakLatency = peakFlushLatency;
+    peakBufferedMessages = 0;
+    peakFlushLatency = 0;
+}
+
+qint64 IslInterface::getBufferedBytes()
+{
+    QMutexLocker locker(&outputBufferMutex);
+    return outputBuffer.size() + inputBufferBytes.load(std::memory_order_relaxed);
+}
+
 void IslInterface::readClient()
 {
     QByteArray data = socket->readAll();
@@ -236,26 +323,31 @@ void IslInterface::readClient()
 
     do {
         if (!messageInProgress) {
-            if (inputBuffer.size() >= 4) {
-                messageLength = (((quint32)(unsigned char)inputBuffer[0]) << 24) +
-                                (((quint32)(unsigned char)inputBuffer[1]) << 16) +
-                                (((quint32)(unsigned char)inputBuffer[2]) << 8) +
-                                ((quint32)(unsigned char)inputBuffer[3]);
-                inputBuffer.remove(0, 4);
+            if (inputBuffer.takeLength(messageLength)) {
                 messageInProgress = true;
             } else
-                return;
+                break;
         }
-        if (inputBuffer.size() < messageLength)
-            return;
+        const int payloadLength = MessageCompression::payloadLength(messageLength);
+        if (inputBuffer.size() < payloadLength)
+            break;
 
         IslMessage newMessage;
-        newMessage.ParseFromArray(inputBuffer.data(), messageLength);
-        inputBuffer.remove(0, messageLength);
+        if (MessageCompression::isCompressedFrame(messageLength)) {
+            QByteArray payload;
+            if (MessageCompression::uncompress(inputBuffer.data(), payloadLength, payload))
+                newMessage.ParseFromArray(payload.constData(), payload.size());
+            else
+                qDebug() << "[ISL] Could not uncompress message from #" << serverId;
+        } else {
+            newMessage.ParseFromArray(inputBuffer.data(), payloadLength);
+        }
+        inputBuffer.skip(payloadLength);
         messageInProgress = false;
 
         processMessage(newMessage);
     } while (!inputBuffer.isEmpty());
+    inputBufferBytes.store(inputBuffer.size(), std::memory_order_relaxed);
 }
 
 void IslInterface::catchSocketError(QAbstractSocket::SocketError socketError)
@@ -271,23 +363,42 @@ void IslInterface::catchSocketError(QAbstractSocket::SocketError socketError)
 
 void IslInterface::transmitMessage(const IslMessage &item)
 {
-    QByteArray buf;
+    QByteArray payload;
 #if GOOGLE_PROTOBUF_VERSION > 3001000
-    unsigned int size = static_cast<unsigned int>(item.ByteSizeLong());
+    payload.resize(static_cast<int>(item.ByteSizeLong()));
 #else
-    unsigned int size = static_cast<unsigned int>(item.ByteSize());
+    payload.resize(item.ByteSize());
 #endif
-    buf.resize(size + 4);
-    item.SerializeToArray(buf.data() + 4, size);
+    item.SerializeToArray(payload.data(), payload.size());
+
+    unsigned int size = static_cast<unsigned int>(payload.size());
+    QByteArray compressed;
+    if (compressionThreshold > 0 && payload.size() >= compressionThreshold &&
+        MessageCompression::compress(payload, compressed)) {
+        payload = compressed;
+        size = static_cast<unsigned int>(payload.size()) | MessageCompression::compressedFrameFlag;
+    }
+
+    QByteArray buf;
+    buf.resize(4);
     buf.data()[3] = (unsigned char)size;
     buf.data()[2] = (unsigned char)(size >> 8);
     buf.data()[1] = (unsigned char)(size >> 16);
     buf.data()[0] = (unsigned char)(size >> 24);
+    buf.append(payload);
 
     outputBufferMutex.lock();
+    const int previousSize = outputBuffer.size();
+    if (previousSize == 0)
+        oldestBufferedMessage.start();
     outputBuffer.append(buf);
+    ++bufferedMessages;
+    const bool reachedFlushBytes = previousSize < flushBytes && outputBuffer.size() >= flushBytes;
     outputBufferMutex.unlock();
-    emit outputBufferChanged();
+
+    // a flush is scheduled by the first message, and brought forward once enough bytes are waiting
+    if (previousSize == 0 || reachedFlushBytes)
+        emit outputBufferChanged();
 }
 
 void IslInterface::sessionEvent_ServerCompleteList(const Event_ServerCompleteList &event)
@@ -374,7 +485,7 @@ void IslInterface::processSessionEvent(const SessionEvent &event, qint64 session
             break;
         case SessionEvent::GAME_JOINED: {
             QReadLocker clientsLocker(&server->clientsLock);
-            Server_AbstractUserInterface *client = server->getUsersBySessionId().value(sessionId);
+            Server_AbstractUserInterface *client = server->findUserBySessionId(sessionId);
             if (!client) {
                 qDebug() << "IslInterface::processSessionEvent: session id" << sessionId << "not found";
                 break;
@@ -388,7 +499,7 @@ void IslInterface::processSessionEvent(const SessionEvent &event, qint64 session
         case SessionEvent::USER_MESSAGE:
         case SessionEvent::REPLAY_ADDED: {
             QReadLocker clientsLocker(&server->clientsLock);
-            Server_AbstractUserInterface *client = server->getUsersBySessionId().value(sessionId);
+            Server_AbstractUserInterface *client = server->findUserBySessionId(sessionId);
             if (!client) {
                 qDebug() << "IslInterface::processSessionEvent: session id" << sessionId << "not found";
                 break;
@@ -465,6 +576,14 @@ void IslInterface::processMessage(const IslMessage &item)
             processRoomEvent(item.room_event());
             break;
         }
+        case IslMessage::CACHE_INVALIDATION: {
+            server->processCacheInvalidation(item.cache_invalidation());
+            break;
+        }
+        case IslMessage::GAME_MIGRATION: {
+            emit gameMigrationReceived(item.game_migration(), serverId);
+            break;
+        }
         default:;
     }
 }
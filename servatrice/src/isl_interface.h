@@ -1,18 +1,23 @@
 #ifndef ISL_INTERFACE_H
 #define ISL_INTERFACE_H
 
+#include "framed_input_buffer.h"
 #include "pb/serverinfo_game.pb.h"
 #include "pb/serverinfo_room.pb.h"
 #include "pb/serverinfo_user.pb.h"
 #include "servatrice.h"
 
+#include <QElapsedTimer>
 #include <QSslCertificate>
 #include <QWaitCondition>
+#include <atomic>
 
 class Servatrice;
 class QSslSocket;
+class QTimer;
 class QSslKey;
 class IslMessage;
+class MetricsHistogram;
 
 class Event_ServerCompleteList;
 class Event_UserMessage;
@@ -31,6 +36,7 @@ class IslInterface : public QObject
 private slots:
     void readClient();
     void catchSocketError(QAbstractSocket::SocketError socketError);
+    void scheduleFlush();
     void flushOutputBuffer();
 signals:
     void outputBufferChanged();
@@ -44,6 +50,7 @@ signals:
     void externalRoomRemoveMessages(int roomId, QString userName, int amount);
     void joinGameCommandReceived(const Command_JoinGame &cmd, int cmdId, int roomId, int serverId, qint64 sessionId);
     void gameCommandContainerReceived(const CommandContainer &cont, int playerId, int serverId, qint64 sessionId);
+    void gameMigrationReceived(const IslGameMigration &migration, int serverId);
     void responseReceived(const Response &resp, qint64 sessionId);
     void gameEventContainerReceived(const GameEventContainer &cont, qint64 sessionId);
 
@@ -58,10 +65,26 @@ private:
     Servatrice *server;
     QSslSocket *socket;
 
-    QByteArray inputBuffer, outputBuffer;
+    FramedInputBuffer inputBuffer;
+    // the size of inputBuffer after the last read, for the other threads
+    std::atomic<qint64> inputBufferBytes;
+    QByteArray outputBuffer;
     bool messageInProgress;
     int messageLength;
 
+    // Messages are collected for up to flushDelay milliseconds, or until flushBytes are buffered, and written in one
+    // go. The statistics are guarded by outputBufferMutex as well.
+    QTimer *flushTimer;
+    int flushDelay;
+    int flushBytes;
+    int compressionThreshold;
+    QElapsedTimer oldestBufferedMessage;
+    int bufferedMessages;
+    int peakBufferedMessages;
+    qint64 peakFlushLatency;
+    // known once the peer is, i.e. from registration on
+    MetricsHistogram *outputDelay;
+
     void sessionEvent_ServerCompleteList(const Event_ServerCompleteList &event);
     void sessionEvent_UserJoined(const Event_UserJoined &event);
     void sessionEvent_UserLeft(const Event_UserLeft &event);
@@ -79,6 +102,8 @@ private:
     void processRoomCommand(const CommandContainer &cont, qint64 sessionId);
 
     void processMessage(const IslMessage &item);
+    void transmitCompleteList(const Event_ServerCompleteList &event);
+    void sendCompleteList();
     void sharedCtor(const QSslCertificate &cert, const QSslKey &privateKey);
 public slots:
     void initServer();
@@ -97,6 +122,14 @@ public:
     ~IslInterface();
 
     void transmitMessage(const IslMessage &item);
+    int getServerId() const
+    {
+        return serverId;
+    }
+    // returns the most messages waiting for one write and the longest wait in ms since the last call
+    void takeStatistics(int &peakMessages, qint64 &peakLatency);
+    // any thread; the input not parsed yet and the output not written yet
+    qint64 getBufferedBytes();
 };
 
 #endif
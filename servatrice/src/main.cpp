@@ -130,11 +130,17 @@ int main(int argc, char *argv[])
     QCommandLineOption configPathOpt("config", "Read server configuration from <file>", "file", "");
     parser.addOption(configPathOpt);
 
+    QCommandLineOption takeOverOpt("take-over",
+                                   "Take the listeners, games and sessions over from the server running with the same "
+                                   "configuration, see server/handoff_socket");
+    parser.addOption(takeOverOpt);
+
     parser.process(app);
 
     bool testRandom = parser.isSet(testRandomOpt);
     bool testHashFunction = parser.isSet(testHashFunctionOpt);
     bool logToConsole = parser.isSet(logToConsoleOpt);
+    bool takeOver = parser.isSet(takeOverOpt);
     QString configPath = parser.value(configPathOpt);
 
     qRegisterMetaType<QList<int>>("QList<int>");
@@ -183,8 +189,9 @@ int main(int argc, char *argv[])
 
     auto *server = new Servatrice();
     QObject::connect(server, SIGNAL(destroyed()), &app, SLOT(quit()), Qt::QueuedConnection);
+    QObject::connect(signalhandler, SIGNAL(timelineTraceToggleRequested()), server, SLOT(toggleTimelineTrace()));
     int retval = 0;
-    if (server->initServer()) {
+    if (server->initServer(takeOver)) {
         std::cerr << "-------------------------" << std::endl;
         std::cerr << "Server initialized." << std::endl;
 
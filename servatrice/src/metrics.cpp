@@ -0,0 +1,155 @@
+#include "metrics.h"
+
+const qint64 MetricsHistogram::bucketBounds[MetricsHistogram::bucketCount] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000};
+
+MetricsHistogram::MetricsHistogram() : sum(0)
+{
+    for (auto &bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+void MetricsHistogram::observe(qint64 microseconds)
+{
+    microseconds = qMax(microseconds, qint64(0));
+    int index = 0;
+    while (index < bucketCount && microseconds > bucketBounds[index])
+        ++index;
+    buckets[index].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(static_cast<quint64>(microseconds), std::memory_order_relaxed);
+}
+
+QList<quint64> MetricsHistogram::getBuckets() const
+{
+    QList<quint64> result;
+    for (const auto &bucket : buckets)
+        result.append(bucket.load(std::memory_order_relaxed));
+    return result;
+}
+
+Metrics::~Metrics()
+{
+    for (const Family &entry : families) {
+        qDeleteAll(entry.counters);
+        qDeleteAll(entry.histograms);
+    }
+}
+
+Metrics::Family &Metrics::family(const QString &name, FamilyType type, const QString &help)
+{
+    auto it = families.find(name);
+    if (it == families.end()) {
+        Family newFamily;
+        newFamily.type = type;
+        newFamily.help = help;
+        it = families.insert(name, newFamily);
+    }
+    Q_ASSERT(it->type == type);
+    return *it;
+}
+
+MetricsCounter *Metrics::counter(const QString &name, const QString &help, const QString &labels)
+{
+    {
+        QReadLocker locker(&lock);
+        auto it = families.constFind(name);
+        if (it != families.constEnd() && it->counters.contains(labels))
+            return it->counters.value(labels);
+    }
+
+    QWriteLocker locker(&lock);
+    Family &entry = family(name, CounterFamily, help);
+    MetricsCounter *&series = entry.counters[labels];
+    if (!series)
+        series = new MetricsCounter;
+    return series;
+}
+
+MetricsHistogram *Metrics::histogram(const QString &name, const QString &help, const QString &labels)
+{
+    {
+        QReadLocker locker(&lock);
+        auto it = families.constFind(name);
+        if (it != families.constEnd() && it->histograms.contains(labels))
+            return it->histograms.value(labels);
+    }
+
+    QWriteLocker locker(&lock);
+    Family &entry = family(name, HistogramFamily, help);
+    MetricsHistogram *&series = entry.histograms[labels];
+    if (!series)
+        series = new MetricsHistogram;
+    return series;
+}
+
+void Metrics::addGauge(const QString &name, const QString &help, const GaugeCallback &callback)
+{
+    QWriteLocker locker(&lock);
+    family(name, GaugeFamily, help).gauge = callback;
+}
+
+QString Metrics::label(const QString &name, const QString &value)
+{
+    QString escaped = value;
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return name + "=\"" + escaped + '"';
+}
+
+static QString seriesName(const QString &name, const QString &labels, const QString &extraLabel = QString())
+{
+    QString labelSet = labels;
+    if (!extraLabel.isEmpty())
+        labelSet += (labelSet.isEmpty() ? "" : ",") + extraLabel;
+    return labelSet.isEmpty() ? name : name + '{' + labelSet + '}';
+}
+
+QByteArray Metrics::render() const
+{
+    // the series never go away, so the copy stays valid after the lock is released
+    QMap<QString, Family> snapshot;
+    {
+        QReadLocker locker(&lock);
+        snapshot = families;
+    }
+
+    QString result;
+    for (auto it = snapshot.constBegin(); it != snapshot.constEnd(); ++it) {
+        const QString &name = it.key();
+        const Family &entry = it.value();
+        result += "# HELP " + name + ' ' + entry.help + '\n';
+
+        switch (entry.type) {
+            case CounterFamily:
+                result += "# TYPE " + name + " counter\n";
+                for (auto series = entry.counters.constBegin(); series != entry.counters.constEnd(); ++series)
+                    result += seriesName(name, series.key()) + ' ' + QString::number(series.value()->get()) + '\n';
+                break;
+            case HistogramFamily:
+                result += "# TYPE " + name + " histogram\n";
+                for (auto series = entry.histograms.constBegin(); series != entry.histograms.constEnd(); ++series) {
+                    const QList<quint64> buckets = series.value()->getBuckets();
+                    quint64 count = 0;
+                    for (int i = 0; i < MetricsHistogram::bucketCount; ++i) {
+                        count += buckets[i];
+                        const QString bound = QString::number(MetricsHistogram::bucketBounds[i] / 1e6, 'g', 10);
+                        result += seriesName(name + "_bucket", series.key(), label("le", bound)) + ' ' +
+                                  QString::number(count) + '\n';
+                    }
+                    count += buckets[MetricsHistogram::bucketCount];
+                    result += seriesName(name + "_bucket", series.key(), label("le", "+Inf")) + ' ' +
+                              QString::number(count) + '\n';
+                    result += seriesName(name + "_sum", series.key()) + ' ' +
+                              QString::number(series.value()->getSum() / 1e6, 'f', 6) + '\n';
+                    result += seriesName(name + "_count", series.key()) + ' ' + QString::number(count) + '\n';
+                }
+                break;
+            case GaugeFamily:
+                result += "# TYPE " + name + " gauge\n";
+                if (entry.gauge)
+                    for (const auto &series : entry.gauge())
+                        result += seriesName(name, series.first) + ' ' + QString::number(series.second, 'g', 15) + '\n';
+                break;
+        }
+    }
+    return result.toUtf8();
+}
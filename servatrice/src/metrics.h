@@ -0,0 +1,107 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QReadWriteLock>
+#include <QString>
+#include <atomic>
+#include <functional>
+
+class MetricsCounter
+{
+public:
+    MetricsCounter() : value(0)
+    {
+    }
+    void add(quint64 amount = 1)
+    {
+        value.fetch_add(amount, std::memory_order_relaxed);
+    }
+    quint64 get() const
+    {
+        return value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<quint64> value;
+};
+
+/**
+ * A latency histogram with fixed buckets from 100 microseconds to 10 seconds.
+ */
+class MetricsHistogram
+{
+public:
+    static const int bucketCount = 16;
+    // upper bounds in microseconds
+    static const qint64 bucketBounds[bucketCount];
+
+    MetricsHistogram();
+    void observe(qint64 microseconds);
+    // the number of observations in each bucket, not cumulative; the last one counts those above all bounds
+    QList<quint64> getBuckets() const;
+    quint64 getSum() const
+    {
+        return sum.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<quint64> buckets[bucketCount + 1];
+    std::atomic<quint64> sum;
+};
+
+/**
+ * The registry behind the metrics endpoint, rendered in the Prometheus text format.
+ *
+ * Series are created on first use and live as long as the registry, so callers look them up once and keep the
+ * pointer; updating a counter or histogram afterwards takes no lock. Gauges are callbacks that are evaluated when
+ * the metrics are rendered; they run without the registry lock held, so they are free to take the server's locks.
+ */
+class Metrics
+{
+public:
+    // label set (as returned by label()) and value of every series of a gauge
+    typedef QList<QPair<QString, double>> GaugeValues;
+    typedef std::function<GaugeValues()> GaugeCallback;
+
+    Metrics() = default;
+    ~Metrics();
+    Metrics(const Metrics &) = delete;
+    Metrics &operator=(const Metrics &) = delete;
+
+    // thread safe; the help text of the first call for a name is used
+    MetricsCounter *counter(const QString &name, const QString &help, const QString &labels = QString());
+    MetricsHistogram *histogram(const QString &name, const QString &help, const QString &labels = QString());
+    void addGauge(const QString &name, const QString &help, const GaugeCallback &callback);
+
+    QByteArray render() const;
+
+    // formats a label set of a single label, escaping the value
+    static QString label(const QString &name, const QString &value);
+
+private:
+    enum FamilyType
+    {
+        CounterFamily,
+        HistogramFamily,
+        GaugeFamily
+    };
+    struct Family
+    {
+        FamilyType type;
+        QString help;
+        QMap<QString, MetricsCounter *> counters;
+        QMap<QString, MetricsHistogram *> histograms;
+        GaugeCallback gauge;
+    };
+
+    mutable QReadWriteLock lock;
+    QMap<QString, Family> families;
+
+    Family &family(const QString &name, FamilyType type, const QString &help);
+};
+
+#endif
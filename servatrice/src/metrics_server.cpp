@@ -0,0 +1,55 @@
+#include "metrics_server.h"
+
+#include "metrics.h"
+
+#include <QTcpSocket>
+#include <QTimer>
+
+// nobody sends more than a request line and a few headers
+static const int maxRequestSize = 8192;
+static const int requestTimeout = 5000;
+
+MetricsServer::MetricsServer(Metrics *_metrics, QObject *parent) : QTcpServer(parent), metrics(_metrics)
+{
+    connect(this, &QTcpServer::newConnection, this, &MetricsServer::newClient);
+}
+
+void MetricsServer::newClient()
+{
+    while (QTcpSocket *socket = nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() { readRequest(socket); });
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        QTimer::singleShot(requestTimeout, socket, &QObject::deleteLater);
+    }
+}
+
+void MetricsServer::readRequest(QTcpSocket *socket)
+{
+    if (socket->bytesAvailable() > maxRequestSize) {
+        socket->abort();
+        return;
+    }
+    // the request is answered once all of its headers arrived
+    const QByteArray request = socket->peek(maxRequestSize);
+    if (!request.contains("\r\n\r\n"))
+        return;
+    socket->readAll();
+
+    const QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+    if (requestLine.size() != 3 || requestLine[0] != "GET")
+        sendResponse(socket, "405 Method Not Allowed", "text/plain", "Method not allowed\n");
+    else if (requestLine[1] != "/metrics")
+        sendResponse(socket, "404 Not Found", "text/plain", "Not found\n");
+    else
+        sendResponse(socket, "200 OK", "text/plain; version=0.0.4; charset=utf-8", metrics->render());
+}
+
+void MetricsServer::sendResponse(QTcpSocket *socket,
+                                 const QByteArray &status,
+                                 const QByteArray &contentType,
+                                 const QByteArray &body)
+{
+    socket->write("HTTP/1.1 " + status + "\r\nContent-Type: " + contentType +
+                  "\r\nContent-Length: " + QByteArray::number(body.size()) + "\r\nConnection: close\r\n\r\n" + body);
+    socket->disconnectFromHost();
+}
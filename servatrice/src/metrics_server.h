@@ -0,0 +1,29 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <QTcpServer>
+
+class Metrics;
+class QTcpSocket;
+
+/**
+ * Answers "GET /metrics" with the metrics in the Prometheus text format. Every request gets its own connection,
+ * which is closed after the response; this is all a metrics scraper needs.
+ */
+class MetricsServer : public QTcpServer
+{
+    Q_OBJECT
+private:
+    Metrics *metrics;
+
+    void readRequest(QTcpSocket *socket);
+    void
+    sendResponse(QTcpSocket *socket, const QByteArray &status, const QByteArray &contentType, const QByteArray &body);
+private slots:
+    void newClient();
+
+public:
+    explicit MetricsServer(Metrics *_metrics, QObject *parent = nullptr);
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "output_pruning.h"
+
+#include "pb/context_ping_changed.pb.h"
+#include "pb/event_list_games.pb.h"
+#include "pb/event_player_pings.pb.h"
+#include "pb/event_player_properties_changed.pb.h"
+#include "pb/event_room_say.pb.h"
+#include "pb/game_event_container.pb.h"
+#include "pb/room_event.pb.h"
+#include "pb/server_message.pb.h"
+#include "pb/serverinfo_game.pb.h"
+#include "serialized_message.h"
+
+#include <QHash>
+#include <QMap>
+#include <QVector>
+
+namespace
+{
+
+bool isPingUpdate(const GameEventContainer &cont)
+{
+    if (!cont.context().HasExtension(Context_PingChanged::ext))
+        return false;
+    for (const GameEvent &event : cont.event_list())
+        if (!event.HasExtension(Event_PlayerPropertiesChanged::ext) && !event.HasExtension(Event_PlayerPings::ext))
+            return false;
+    return true;
+}
+
+// all game list updates of one room, or all ping updates of one game
+struct Group
+{
+    QList<int> members;
+    QList<ServerMessage> messages;
+};
+
+ServerMessage mergeGameLists(const Group &group)
+{
+    QMap<int, ServerInfo_Game> latest;
+    QList<int> order;
+    for (const ServerMessage &message : group.messages) {
+        for (const ServerInfo_Game &game : message.room_event().GetExtension(Event_ListGames::ext).game_list()) {
+            auto entry = latest.find(game.game_id());
+            if (entry == latest.end()) {
+                order.append(game.game_id());
+                latest.insert(game.game_id(), game);
+            } else if (game.closed()) {
+                *entry = game;
+            } else {
+                // the client merges the updates into what it has, so merging them here first is the same
+                entry->MergeFrom(game);
+            }
+        }
+    }
+
+    ServerMessage merged = group.messages.last();
+    Event_ListGames *event = merged.mutable_room_event()->MutableExtension(Event_ListGames::ext);
+    event->clear_game_list();
+    for (int gameId : order)
+        event->add_game_list()->CopyFrom(latest.value(gameId));
+    return merged;
+}
+
+ServerMessage mergePingUpdates(const Group &group)
+{
+    QMap<int, GameEvent> latestProperties;
+    QMap<int, int> latestPings;
+    for (const ServerMessage &message : group.messages) {
+        for (const GameEvent &event : message.game_event_container().event_list()) {
+            if (event.HasExtension(Event_PlayerPings::ext)) {
+                const Event_PlayerPings &pings = event.GetExtension(Event_PlayerPings::ext);
+                for (int i = 0; i < pings.player_id_size() && i < pings.ping_seconds_size(); ++i)
+                    latestPings.insert(pings.player_id(i), pings.ping_seconds(i));
+            } else {
+                latestProperties.insert(event.player_id(), event);
+            }
+        }
+    }
+
+    ServerMessage merged = group.messages.last();
+    GameEventContainer *cont = merged.mutable_game_event_container();
+    cont->clear_event_list();
+    for (const GameEvent &event : latestProperties)
+        cont->add_event_list()->CopyFrom(event);
+    if (!latestPings.isEmpty()) {
+        GameEvent *event = cont->add_event_list();
+        Event_PlayerPings *pings = event->MutableExtension(Event_PlayerPings::ext);
+        for (auto it = latestPings.constBegin(); it != latestPings.constEnd(); ++it) {
+            pings->add_player_id(it.key());
+            pings->add_ping_seconds(it.value());
+        }
+    }
+    return merged;
+}
+
+} // namespace
+
+namespace OutputPruning
+{
+
+QList<QByteArray> prune(const QList<QByteArray> &messages, const std::string &ownUserName)
+{
+    QVector<bool> dropped(messages.size(), false);
+    QHash<int, Group> gameLists, pingUpdates;
+    for (int i = 0; i < messages.size(); ++i) {
+        ServerMessage message;
+        if (!message.ParseFromArray(messages[i].constData(), messages[i].size()))
+            continue;
+
+        if (message.message_type() == ServerMessage::ROOM_EVENT) {
+            const RoomEvent &roomEvent = message.room_event();
+            if (roomEvent.HasExtension(Event_RoomSay::ext)) {
+                const Event_RoomSay &say = roomEvent.GetExtension(Event_RoomSay::ext);
+                if (say.message_type() == Event_RoomSay::UserMessage && say.name() != ownUserName)
+                    dropped[i] = true;
+            } else if (roomEvent.HasExtension(Event_ListGames::ext)) {
+                Group &group = gameLists[roomEvent.room_id()];
+                group.members.append(i);
+                group.messages.append(message);
+            }
+        } else if (message.message_type() == ServerMessage::GAME_EVENT_CONTAINER &&
+                   isPingUpdate(message.game_event_container())) {
+            Group &group = pingUpdates[message.game_event_container().game_id()];
+            group.members.append(i);
+            group.messages.append(message);
+        }
+    }
+
+    QHash<int, QByteArray> replacements;
+    for (const Group &group : gameLists) {
+        if (group.members.size() < 2)
+            continue;
+        for (int i = 0; i < group.members.size() - 1; ++i)
+            dropped[group.members[i]] = true;
+        replacements.insert(group.members.last(), SerializedMessage::serialize(mergeGameLists(group)));
+    }
+    for (const Group &group : pingUpdates) {
+        if (group.members.size() < 2)
+            continue;
+        for (int i = 0; i < group.members.size() - 1; ++i)
+            dropped[group.members[i]] = true;
+        replacements.insert(group.members.last(), SerializedMessage::serialize(mergePingUpdates(group)));
+    }
+
+    QList<QByteArray> result;
+    for (int i = 0; i < messages.size(); ++i) {
+        if (dropped[i])
+            continue;
+        auto replacement = replacements.find(i);
+        result.append(replacement == replacements.end() ? messages[i] : *replacement);
+    }
+    return result;
+}
+
+} // namespace OutputPruning
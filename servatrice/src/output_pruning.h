@@ -0,0 +1,22 @@
+#ifndef OUTPUT_PRUNING_H
+#define OUTPUT_PRUNING_H
+
+#include <QByteArray>
+#include <QList>
+#include <string>
+
+/**
+ * Thins out the output held back for a client that doesn't keep up with reading it.
+ *
+ * Only messages the client can do without are touched: room chat of other users is dropped, game list updates of a
+ * room are collapsed into one update with the latest state of every game, and ping updates of a game are collapsed
+ * into one with the latest ping of every player. A collapsed message takes the place of the last message it replaces;
+ * everything else keeps its bytes and its order.
+ */
+namespace OutputPruning
+{
+// messages are serialized ServerMessages; ownUserName is the name of the user the messages are sent to
+QList<QByteArray> prune(const QList<QByteArray> &messages, const std::string &ownUserName);
+} // namespace OutputPruning
+
+#endif
@@ -0,0 +1,45 @@
+#include "output_queue.h"
+
+OutputQueue::OutputQueue() : head(new Node), flushPending(false), queuedBytes(0)
+{
+    tail = head.load();
+}
+
+OutputQueue::~OutputQueue()
+{
+    while (tail) {
+        Node *next = tail->next.load(std::memory_order_acquire);
+        delete tail;
+        tail = next;
+    }
+}
+
+bool OutputQueue::push(const QByteArray &item)
+{
+    auto *node = new Node(item);
+    queuedBytes.fetch_add(item.size(), std::memory_order_relaxed);
+    Node *previous = head.exchange(node, std::memory_order_acq_rel);
+    // the consumer stops at previous until this store is visible, which keeps the ordering intact
+    previous->next.store(node, std::memory_order_release);
+
+    return !flushPending.exchange(true, std::memory_order_acq_rel);
+}
+
+QList<QByteArray> OutputQueue::takeAll()
+{
+    // Clear the flag before taking anything: a push that isn't seen by the loop below will schedule a new flush.
+    flushPending.store(false, std::memory_order_release);
+
+    QList<QByteArray> result;
+    qint64 takenBytes = 0;
+    Node *next = tail->next.load(std::memory_order_acquire);
+    while (next) {
+        takenBytes += next->data.size();
+        result.append(std::move(next->data));
+        delete tail;
+        tail = next;
+        next = tail->next.load(std::memory_order_acquire);
+    }
+    queuedBytes.fetch_sub(takenBytes, std::memory_order_relaxed);
+    return result;
+}
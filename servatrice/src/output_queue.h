@@ -0,0 +1,52 @@
+#ifndef OUTPUT_QUEUE_H
+#define OUTPUT_QUEUE_H
+
+#include <QByteArray>
+#include <QList>
+#include <atomic>
+
+/**
+ * Lock-free multi producer / single consumer queue of serialized messages.
+ *
+ * Any thread may push (game threads, room broadcasts, ISL), only the thread owning the connection may take items.
+ * Items are taken in the order the pushes completed. push() reports whether the consumer has to be woken up, which is
+ * only the case for the first push after the consumer started its last takeAll(), so a burst of messages only
+ * schedules one flush.
+ */
+class OutputQueue
+{
+public:
+    OutputQueue();
+    ~OutputQueue();
+    OutputQueue(const OutputQueue &) = delete;
+    OutputQueue &operator=(const OutputQueue &) = delete;
+
+    // returns true if a flush needs to be scheduled
+    bool push(const QByteArray &item);
+    // consumer thread only
+    QList<QByteArray> takeAll();
+    // any thread; the size of the items pushed and not taken yet
+    qint64 getQueuedBytes() const
+    {
+        return queuedBytes.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node *> next;
+        QByteArray data;
+
+        explicit Node(const QByteArray &_data = QByteArray()) : next(nullptr), data(_data)
+        {
+        }
+    };
+
+    // producers append at head, the consumer removes at tail, which always points to an already consumed node
+    std::atomic<Node *> head;
+    Node *tail;
+    std::atomic<bool> flushPending;
+    std::atomic<qint64> queuedBytes;
+};
+
+#endif
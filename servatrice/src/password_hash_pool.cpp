@@ -0,0 +1,57 @@
+#include "password_hash_pool.h"
+
+#include "passwordhasher.h"
+
+PasswordHashPool::PasswordHashPool(int threadCount, int _maxQueueSize)
+    : maxQueueSize(qMax(1, _maxQueueSize)), queueDepth(0), peakQueueDepth(0), hashed(0), rejected(0)
+{
+    threadPool.setMaxThreadCount(qMax(1, threadCount));
+}
+
+PasswordHashPool::~PasswordHashPool()
+{
+    threadPool.waitForDone();
+}
+
+bool PasswordHashPool::enqueue(const QString &password,
+                               const QString &salt,
+                               QObject *context,
+                               const std::function<void(const QString &hash)> &onHashed)
+{
+    const int depth = queueDepth.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (depth > maxQueueSize) {
+        queueDepth.fetch_sub(1, std::memory_order_relaxed);
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    int peak = peakQueueDepth.load(std::memory_order_relaxed);
+    while (peak < depth && !peakQueueDepth.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {
+    }
+
+    auto *job = new PasswordHashJob(this, password, salt);
+    QObject::connect(job, &PasswordHashJob::finished, context, onHashed, Qt::QueuedConnection);
+    threadPool.start(job);
+    return true;
+}
+
+int PasswordHashPool::takePeakQueueDepth()
+{
+    return peakQueueDepth.exchange(queueDepth.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+PasswordHashJob::PasswordHashJob(PasswordHashPool *_pool, const QString &_password, const QString &_salt)
+    : pool(_pool), password(_password), salt(_salt)
+{
+    // deleted by deleteLater() in the thread that enqueued it, after the hash was delivered there
+    setAutoDelete(false);
+}
+
+void PasswordHashJob::run()
+{
+    const QString hash = PasswordHasher::computeHash(password, salt);
+    pool->queueDepth.fetch_sub(1, std::memory_order_relaxed);
+    pool->hashed.fetch_add(1, std::memory_order_relaxed);
+    emit finished(hash);
+    deleteLater();
+}
@@ -0,0 +1,74 @@
+#ifndef PASSWORD_HASH_POOL_H
+#define PASSWORD_HASH_POOL_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+
+class PasswordHashJob;
+
+/**
+ * Hashes the passwords of logins on threads of its own, so that a burst of logins doesn't keep the connection
+ * pool threads from serving the users that are already connected.
+ *
+ * The number of logins waiting to be hashed is bounded: enqueue() refuses a hash once the queue is full, and the
+ * caller is expected to compute it itself.
+ */
+class PasswordHashPool
+{
+public:
+    PasswordHashPool(int threadCount, int _maxQueueSize);
+    ~PasswordHashPool();
+
+    /**
+     * Calls onHashed in the thread of context once the hash is ready, unless context is gone by then. Returns false
+     * if the queue is full.
+     */
+    bool enqueue(const QString &password,
+                 const QString &salt,
+                 QObject *context,
+                 const std::function<void(const QString &hash)> &onHashed);
+
+    int getQueueDepth() const
+    {
+        return queueDepth.load(std::memory_order_relaxed);
+    }
+    // returns the largest queue depth since the last call
+    int takePeakQueueDepth();
+    quint64 getHashedCount() const
+    {
+        return hashed.load(std::memory_order_relaxed);
+    }
+    quint64 getRejectedCount() const
+    {
+        return rejected.load(std::memory_order_relaxed);
+    }
+
+private:
+    friend class PasswordHashJob;
+
+    QThreadPool threadPool;
+    const int maxQueueSize;
+    std::atomic<int> queueDepth, peakQueueDepth;
+    std::atomic<quint64> hashed, rejected;
+};
+
+class PasswordHashJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    PasswordHashJob(PasswordHashPool *_pool, const QString &_password, const QString &_salt);
+    void run() override;
+
+signals:
+    void finished(const QString &hash);
+
+private:
+    PasswordHashPool *pool;
+    QString password, salt;
+};
+
+#endif
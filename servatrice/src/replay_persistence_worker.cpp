@@ -0,0 +1,74 @@
+#include "replay_persistence_worker.h"
+
+#include <QDebug>
+#include <QThread>
+
+ReplayPersistenceWorker::ReplayPersistenceWorker(Servatrice_DatabaseInterface *_databaseInterface,
+                                                 int _maxQueueSize,
+                                                 int _maxBatchSize)
+    : databaseInterface(_databaseInterface), maxQueueSize(qMax(1, _maxQueueSize)), maxBatchSize(qMax(1, _maxBatchSize)),
+      peakQueueDepth(0), processingScheduled(false), storedGames(0), failedGames(0), rejectedGames(0)
+{
+}
+
+ReplayPersistenceWorker::~ReplayPersistenceWorker()
+{
+    processQueue();
+    delete databaseInterface;
+    thread()->quit();
+}
+
+bool ReplayPersistenceWorker::enqueue(const FinishedGame &game)
+{
+    QMutexLocker locker(&queueMutex);
+    if (queue.size() >= maxQueueSize) {
+        ++rejectedGames;
+        return false;
+    }
+
+    queue.append(game);
+    peakQueueDepth = qMax(peakQueueDepth, queue.size());
+    if (!processingScheduled) {
+        processingScheduled = true;
+        QMetaObject::invokeMethod(this, "processQueue", Qt::QueuedConnection);
+    }
+    return true;
+}
+
+int ReplayPersistenceWorker::getQueueDepth() const
+{
+    QMutexLocker locker(&queueMutex);
+    return queue.size();
+}
+
+int ReplayPersistenceWorker::takePeakQueueDepth()
+{
+    QMutexLocker locker(&queueMutex);
+    const int result = peakQueueDepth;
+    peakQueueDepth = queue.size();
+    return result;
+}
+
+void ReplayPersistenceWorker::processQueue()
+{
+    for (;;) {
+        QList<FinishedGame> batch;
+        {
+            QMutexLocker locker(&queueMutex);
+            if (queue.isEmpty()) {
+                processingScheduled = false;
+                return;
+            }
+            const int batchSize = qMin(maxBatchSize, queue.size());
+            batch = queue.mid(0, batchSize);
+            queue.erase(queue.begin(), queue.begin() + batchSize);
+        }
+
+        if (databaseInterface->checkSql() && databaseInterface->storeFinishedGames(batch)) {
+            storedGames += batch.size();
+        } else {
+            failedGames += batch.size();
+            qCritical() << "ReplayPersistenceWorker: could not store" << batch.size() << "finished games";
+        }
+    }
+}
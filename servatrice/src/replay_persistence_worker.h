@@ -0,0 +1,63 @@
+#ifndef REPLAY_PERSISTENCE_WORKER_H
+#define REPLAY_PERSISTENCE_WORKER_H
+
+#include "servatrice_database_interface.h"
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <atomic>
+
+/**
+ * Stores finished games and their replays in the database from a thread of its own.
+ *
+ * Games are queued by the pool thread that ends them and written in batches on a dedicated database
+ * connection, so a whole tournament round ending at once doesn't stall the pools. The queue is bounded:
+ * enqueue() refuses games once it is full, and the caller is expected to store them itself.
+ *
+ * The worker lives in its own thread and owns its database interface; deleting it stores whatever is still
+ * queued and quits the thread.
+ */
+class ReplayPersistenceWorker : public QObject
+{
+    Q_OBJECT
+public:
+    ReplayPersistenceWorker(Servatrice_DatabaseInterface *_databaseInterface, int _maxQueueSize, int _maxBatchSize);
+    ~ReplayPersistenceWorker() override;
+
+    // thread safe
+    bool enqueue(const FinishedGame &game);
+
+    int getQueueDepth() const;
+    // returns the largest queue depth since the last call
+    int takePeakQueueDepth();
+    quint64 getStoredGameCount() const
+    {
+        return storedGames.load(std::memory_order_relaxed);
+    }
+    quint64 getFailedGameCount() const
+    {
+        return failedGames.load(std::memory_order_relaxed);
+    }
+    quint64 getRejectedGameCount() const
+    {
+        return rejectedGames.load(std::memory_order_relaxed);
+    }
+
+private slots:
+    void processQueue();
+
+private:
+    Servatrice_DatabaseInterface *databaseInterface;
+    const int maxQueueSize;
+    const int maxBatchSize;
+
+    mutable QMutex queueMutex;
+    QList<FinishedGame> queue;
+    int peakQueueDepth;
+    bool processingScheduled;
+
+    std::atomic<quint64> storedGames, failedGames, rejectedGames;
+};
+
+#endif
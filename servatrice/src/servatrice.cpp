@@ -19,46 +19,83 @@
  ***************************************************************************/
 #include "servatrice.h"
 
+#include "chat_log_worker.h"
+#include "command_trace.h"
+#include "database_cache.h"
 #include "decklist.h"
 #include "email_parser.h"
 #include "featureset.h"
+#include "game_executor.h"
+#include "game_replay_writer.h"
+#include "handoff_channel.h"
+#include "id_block_allocator.h"
 #include "isl_interface.h"
 #include "main.h"
+#include "metrics.h"
+#include "metrics_server.h"
+#include "password_hash_pool.h"
 #include "pb/event_connection_closed.pb.h"
 #include "pb/event_server_message.pb.h"
 #include "pb/event_server_shutdown.pb.h"
+#include "pb/game_replay.pb.h"
+#include "pb/isl_message.pb.h"
+#include "pb/moderator_commands.pb.h"
+#include "pb/response_activity_top.pb.h"
+#include "pb/response_memory_usage.pb.h"
+#include "pb/server_handoff.pb.h"
+#include "replay_persistence_worker.h"
 #include "servatrice_connection_pool.h"
 #include "servatrice_database_interface.h"
+#include "server_game.h"
 #include "server_logger.h"
 #include "server_room.h"
 #include "serversocketinterface.h"
+#include "session_log_worker.h"
 #include "settingscache.h"
 #include "smtpclient.h"
+#include "smtpclient.h"
+#include "timeline_trace.h"
 
+#include <QCoreApplication>
 #include <QDateTime>
 #include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QLocalServer>
+#include <QLocalSocket>
 #include <QProcessEnvironment>
 #include <QSqlQuery>
 #include <QString>
 #include <QStringList>
+#include <QThread>
 #include <QTimer>
 #include <QUrl>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
+#if defined(Q_OS_LINUX)
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
 Servatrice_GameServer::Servatrice_GameServer(Servatrice *_server,
                                              int _numberPools,
                                              const QSqlDatabase &_sqlDatabase,
                                              QObject *parent)
-    : QTcpServer(parent), server(_server)
+    : QTcpServer(parent), server(_server), imbalancedChecks(0)
 {
     for (int i = 0; i < _numberPools; ++i) {
         auto newDatabaseInterface = new Servatrice_DatabaseInterface(i, server);
-        auto newPool = new Servatrice_ConnectionPool(newDatabaseInterface);
+        auto newPool = new Servatrice_ConnectionPool(newDatabaseInterface, server->getPoolEventDelayHistogram(i));
 
         auto newThread = new QThread;
         newThread->setObjectName("pool_" + QString::number(i));
         newPool->moveToThread(newThread);
+        connect(newThread, &QThread::started, newPool, &Servatrice_ConnectionPool::startEventDelayProbe);
         newDatabaseInterface->moveToThread(newThread);
         server->addDatabaseInterface(newThread, newDatabaseInterface);
 
@@ -68,10 +105,21 @@ Servatrice_GameServer::Servatrice_GameServer(Servatrice *_server,
 
         connectionPools.append(newPool);
     }
+
+    rebalanceTimer = new QTimer(this);
+    connect(rebalanceTimer, &QTimer::timeout, this, &Servatrice_GameServer::rebalancePools);
+    const int rebalanceInterval = server->getPoolRebalanceInterval();
+    if (rebalanceInterval > 0 && connectionPools.size() > 1)
+        rebalanceTimer->start(rebalanceInterval * 1000);
 }
 
 Servatrice_GameServer::~Servatrice_GameServer()
 {
+    // the listeners live in the pool threads, they are deleted there before their pool
+    for (auto *listener : poolListeners) {
+        listener->deleteLater();
+    }
+
     for (int i = 0; i < connectionPools.size(); ++i) {
         logger->logMessage(QString("Closing pool %1...").arg(i));
         QThread *poolThread = connectionPools[i]->thread();
@@ -86,29 +134,213 @@ void Servatrice_GameServer::incomingConnection(qintptr socketDescriptor)
     Servatrice_ConnectionPool *pool = findLeastUsedConnectionPool();
 
     auto ssi = new TcpServerSocketInterface(server, pool->getDatabaseInterface());
-    connect(ssi, SIGNAL(incTxBytes(qint64)), this, SLOT(incTxBytes(qint64)));
     ssi->moveToThread(pool->thread());
-    pool->addClient();
-    connect(ssi, SIGNAL(destroyed()), pool, SLOT(removeClient()));
+    ssi->setConnectionPool(pool);
 
     QMetaObject::invokeMethod(ssi, "initConnection", Qt::QueuedConnection, Q_ARG(int, socketDescriptor));
 }
 
-Servatrice_ConnectionPool *Servatrice_GameServer::findLeastUsedConnectionPool()
+#if defined(Q_OS_LINUX) && defined(SO_REUSEPORT)
+static int createReusePortSocket(const QHostAddress &address, quint16 port)
 {
-    int minClientCount = -1;
-    int poolIndex = -1;
-    QStringList debugStr;
-    for (int i = 0; i < connectionPools.size(); ++i) {
-        const int clientCount = connectionPools[i]->getClientCount();
-        if ((poolIndex == -1) || (clientCount < minClientCount)) {
-            minClientCount = clientCount;
-            poolIndex = i;
+    const bool ipv4 = address.protocol() == QAbstractSocket::IPv4Protocol;
+    int fd = ::socket(ipv4 ? AF_INET : AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    int result;
+    if (ipv4) {
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(address.toIPv4Address());
+        result = ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    } else {
+        // QHostAddress::Any is dual stack, accept ipv4 connections on the ipv6 socket as well
+        int v6only = address == QHostAddress::AnyIPv6 ? 1 : 0;
+        setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only));
+
+        sockaddr_in6 addr = {};
+        addr.sin6_family = AF_INET6;
+        addr.sin6_port = htons(port);
+        if (address == QHostAddress::Any || address == QHostAddress::AnyIPv6) {
+            addr.sin6_addr = in6addr_any;
+        } else {
+            Q_IPV6ADDR ipv6 = address.toIPv6Address();
+            memcpy(&addr.sin6_addr, &ipv6, sizeof(addr.sin6_addr));
+        }
+        result = ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    }
+
+    if (result < 0 || ::listen(fd, 1000) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+#endif
+
+bool Servatrice_GameServer::perPoolListenersSupported()
+{
+#if defined(Q_OS_LINUX) && defined(SO_REUSEPORT)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Servatrice_GameServer::listenPerPool(const QHostAddress &address, quint16 port)
+{
+#if defined(Q_OS_LINUX) && defined(SO_REUSEPORT)
+    for (auto *pool : connectionPools) {
+        int fd = createReusePortSocket(address, port);
+        if (fd < 0) {
+            qDebug() << "Could not create listening socket for pool" << pool->thread()->objectName();
+            return false;
         }
-        debugStr.append(QString::number(clientCount));
+        if (!addPoolListener(pool, fd))
+            return false;
+    }
+    return true;
+#else
+    Q_UNUSED(address);
+    Q_UNUSED(port);
+    return false;
+#endif
+}
+
+bool Servatrice_GameServer::addPoolListener(Servatrice_ConnectionPool *pool, int socketDescriptor)
+{
+    auto listener = new Servatrice_PoolListener(server, pool);
+    listener->setMaxPendingConnections(maxPendingConnections());
+    listener->moveToThread(pool->thread());
+    poolListeners.append(listener);
+
+    // the socket notifier has to be created in the pool thread
+    bool success = false;
+    QMetaObject::invokeMethod(listener, "listenOnDescriptor", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(bool, success), Q_ARG(int, socketDescriptor));
+    if (!success) {
+        qDebug() << "Pool listener error:" << listener->errorString();
+        return false;
+    }
+    return true;
+}
+
+QList<int> Servatrice_GameServer::getListenerDescriptors() const
+{
+    QList<int> descriptors;
+    if (isListening())
+        descriptors.append(static_cast<int>(socketDescriptor()));
+    for (const Servatrice_PoolListener *listener : poolListeners)
+        descriptors.append(static_cast<int>(listener->socketDescriptor()));
+    return descriptors;
+}
+
+void Servatrice_GameServer::closeListeners()
+{
+    close();
+    for (auto *listener : poolListeners)
+        QMetaObject::invokeMethod(listener, "stopListening", Qt::BlockingQueuedConnection);
+}
+
+bool Servatrice_GameServer::adoptListeners(QList<int> descriptors, bool perPool)
+{
+    if (descriptors.isEmpty())
+        return false;
+    if (!perPool) {
+        if (!setSocketDescriptor(descriptors.takeFirst()))
+            return false;
+    } else {
+        // the pools the old server didn't have share a listener with another one
+        const int adopted = descriptors.size();
+        for (int i = adopted; i < connectionPools.size(); ++i)
+            descriptors.append(HandoffChannel::duplicateDescriptor(descriptors.at(i % adopted)));
     }
+    // the sockets of the per pool listeners stay open, closing one would drop the connections waiting on it
+    for (int i = 0; i < descriptors.size(); ++i)
+        if (!addPoolListener(connectionPools.at(i % connectionPools.size()), descriptors.at(i)))
+            return false;
+    return true;
+}
+
+void Servatrice_GameServer::adoptSession(int socketDescriptor, const QByteArray &serializedSession)
+{
+    // without the utilisation log of findLeastUsedConnectionPool(), this runs for every session
+    Servatrice_ConnectionPool *pool = Servatrice_ConnectionPool::findLeastLoaded(connectionPools);
+
+    auto ssi = new TcpServerSocketInterface(server, pool->getDatabaseInterface());
+    ssi->moveToThread(pool->thread());
+    ssi->setConnectionPool(pool);
+
+    QMetaObject::invokeMethod(ssi, "adoptHandoff", Qt::QueuedConnection, Q_ARG(int, socketDescriptor),
+                              Q_ARG(QByteArray, serializedSession));
+}
+
+bool Servatrice_PoolListener::listenOnDescriptor(int socketDescriptor)
+{
+    return setSocketDescriptor(socketDescriptor);
+}
+
+void Servatrice_PoolListener::incomingConnection(qintptr socketDescriptor)
+{
+    // we already are in the pool thread, no need to move the interface
+    auto ssi = new TcpServerSocketInterface(server, pool->getDatabaseInterface());
+    ssi->setConnectionPool(pool);
+
+    QMetaObject::invokeMethod(ssi, "initConnection", Qt::QueuedConnection, Q_ARG(int, socketDescriptor));
+}
+
+// logs the load of every pool with the choice
+static Servatrice_ConnectionPool *leastLoadedPool(const QList<Servatrice_ConnectionPool *> &pools)
+{
+    QStringList debugStr;
+    for (const Servatrice_ConnectionPool *pool : pools)
+        debugStr.append(QString("%1 (%2% busy)").arg(pool->getClientCount()).arg(pool->getUtilization() / 10));
     qDebug().noquote() << "Pool utilisation:" << debugStr.join(", ");
-    return connectionPools[poolIndex];
+    return Servatrice_ConnectionPool::findLeastLoaded(pools);
+}
+
+Servatrice_ConnectionPool *Servatrice_GameServer::findLeastUsedConnectionPool()
+{
+    return leastLoadedPool(connectionPools);
+}
+
+void Servatrice_GameServer::rebalancePools()
+{
+    // how much busier (per mille) the busiest pool has to be than the idlest, on how many checks in a row
+    static const int imbalanceThreshold = 250;
+    static const int imbalancedChecksNeeded = 3;
+    static const int maxMigrationsPerCheck = 50;
+
+    Servatrice_ConnectionPool *busiest = nullptr, *idlest = nullptr;
+    for (Servatrice_ConnectionPool *pool : connectionPools) {
+        if (!busiest || pool->getUtilization() > busiest->getUtilization())
+            busiest = pool;
+        if (!idlest || pool->getUtilization() < idlest->getUtilization())
+            idlest = pool;
+    }
+    if (busiest->getUtilization() - idlest->getUtilization() < imbalanceThreshold) {
+        imbalancedChecks = 0;
+        return;
+    }
+    if (++imbalancedChecks < imbalancedChecksNeeded)
+        return;
+    imbalancedChecks = 0;
+
+    // only connections outside of games move, so a tenth of the busiest pool is asked to
+    const int count = qBound(1, busiest->getClientCount() / 10, maxMigrationsPerCheck);
+    qDebug().noquote() << "Moving up to" << count << "idle connections from" << busiest->thread()->objectName()
+                       << "to" << idlest->thread()->objectName();
+    QMetaObject::invokeMethod(busiest, "migrateIdleClients", Qt::QueuedConnection, Q_ARG(QObject *, idlest),
+                              Q_ARG(int, count));
 }
 
 #define WEBSOCKET_POOL_NUMBER 999
@@ -122,11 +354,13 @@ Servatrice_WebsocketGameServer::Servatrice_WebsocketGameServer(Servatrice *_serv
     for (int i = 0; i < _numberPools; ++i) {
         int poolNumber = WEBSOCKET_POOL_NUMBER + i;
         auto newDatabaseInterface = new Servatrice_DatabaseInterface(poolNumber, server);
-        auto newPool = new Servatrice_ConnectionPool(newDatabaseInterface);
+        auto newPool =
+            new Servatrice_ConnectionPool(newDatabaseInterface, server->getPoolEventDelayHistogram(poolNumber));
 
         auto newThread = new QThread;
         newThread->setObjectName("pool_" + QString::number(poolNumber));
         newPool->moveToThread(newThread);
+        connect(newThread, &QThread::started, newPool, &Servatrice_ConnectionPool::startEventDelayProbe);
         newDatabaseInterface->moveToThread(newThread);
         server->addDatabaseInterface(newThread, newDatabaseInterface);
 
@@ -156,7 +390,6 @@ void Servatrice_WebsocketGameServer::onNewConnection()
     Servatrice_ConnectionPool *pool = findLeastUsedConnectionPool();
 
     auto ssi = new WebsocketServerSocketInterface(server, pool->getDatabaseInterface());
-    connect(ssi, SIGNAL(incTxBytes(quint64)), this, SLOT(incTxBytes(quint64)));
     /*
      * Due to a Qt limitation, websockets can't be moved to another thread.
      * This will hopefully change in Qt6 if QtWebSocket will be integrated in QtNetwork
@@ -170,19 +403,7 @@ void Servatrice_WebsocketGameServer::onNewConnection()
 
 Servatrice_ConnectionPool *Servatrice_WebsocketGameServer::findLeastUsedConnectionPool()
 {
-    int minClientCount = -1;
-    int poolIndex = -1;
-    QStringList debugStr;
-    for (int i = 0; i < connectionPools.size(); ++i) {
-        const int clientCount = connectionPools[i]->getClientCount();
-        if ((poolIndex == -1) || (clientCount < minClientCount)) {
-            minClientCount = clientCount;
-            poolIndex = i;
-        }
-        debugStr.append(QString::number(clientCount));
-    }
-    qDebug().noquote() << "Pool utilisation:" << debugStr.join(", ");
-    return connectionPools[poolIndex];
+    return leastLoadedPool(connectionPools);
 }
 
 void Servatrice_IslServer::incomingConnection(qintptr socketDescriptor)
@@ -199,15 +420,31 @@ void Servatrice_IslServer::incomingConnection(qintptr socketDescriptor)
 }
 
 Servatrice::Servatrice(QObject *parent)
-    : Server(parent), authenticationMethod(AuthenticationNone), uptime(0), txBytes(0), rxBytes(0),
-      shutdownTimer(nullptr)
+    : Server(parent), authenticationMethod(AuthenticationNone), gameServer(nullptr), websocketGameServer(nullptr),
+      islServer(nullptr), handoffServer(nullptr), replayPersistenceWorker(nullptr), chatLogWorker(nullptr),
+      sessionLogWorker(nullptr), databaseCache(nullptr), gameIdAllocator(nullptr), replayIdAllocator(nullptr),
+      sessionIdAllocator(nullptr), passwordHashPool(nullptr), gameExecutor(nullptr), metrics(new Metrics),
+      metricsServer(nullptr), uptime(0), reportedTxBytes(0), reportedRxBytes(0), shutdownTimer(nullptr)
 {
     qRegisterMetaType<QSqlDatabase>("QSqlDatabase");
+
+    txBytes = metrics->counter("servatrice_transmitted_bytes_total", "Bytes sent to clients and other servers.");
+    rxBytes = metrics->counter("servatrice_received_bytes_total", "Bytes received from clients and other servers.");
+    for (const QString &type : {"session", "game", "room", "moderator", "admin", "invalid"})
+        commandDurations.insert(type, metrics->histogram("servatrice_command_duration_seconds",
+                                                         "Time spent processing a command container, by the kind "
+                                                         "of commands it holds.",
+                                                         Metrics::label("type", type)));
 }
 
 Servatrice::~Servatrice()
 {
-    gameServer->close();
+    // the gauges look at the pools, which go away below
+    delete metricsServer;
+    metricsServer = nullptr;
+
+    if (gameServer)
+        gameServer->close();
 
     // we are destroying the clients outside their thread!
     for (auto *client : clients) {
@@ -218,11 +455,55 @@ Servatrice::~Servatrice()
         shutdownTimer->deleteLater();
     }
 
+    // no game commands may run while the games go away
+    delete gameExecutor;
+    gameExecutor = nullptr;
+
     servatriceDatabaseInterface->deleteLater();
     prepareDestroy();
+    // the pools use the cache and the metrics, they have to be gone before those
+    delete gameServer;
+    gameServer = nullptr;
+    delete websocketGameServer;
+    websocketGameServer = nullptr;
+    delete passwordHashPool;
+
+    // only after all games are gone
+    stopBackgroundWorkers();
+    delete databaseCache;
+    delete gameIdAllocator;
+    delete replayIdAllocator;
+    delete sessionIdAllocator;
+    delete metrics;
+}
+
+void Servatrice::stopBackgroundWorkers()
+{
+    // the worker stores what is still queued before its thread quits
+    if (replayPersistenceWorker) {
+        QThread *workerThread = replayPersistenceWorker->thread();
+        replayPersistenceWorker->deleteLater();
+        replayPersistenceWorker = nullptr;
+        workerThread->wait();
+        workerThread->deleteLater();
+    }
+    if (chatLogWorker) {
+        QThread *workerThread = chatLogWorker->thread();
+        chatLogWorker->deleteLater();
+        chatLogWorker = nullptr;
+        workerThread->wait();
+        workerThread->deleteLater();
+    }
+    if (sessionLogWorker) {
+        QThread *workerThread = sessionLogWorker->thread();
+        sessionLogWorker->deleteLater();
+        sessionLogWorker = nullptr;
+        workerThread->wait();
+        workerThread->deleteLater();
+    }
 }
 
-bool Servatrice::initServer()
+bool Servatrice::initServer(bool takeOver)
 {
 
     serverId = getServerID();
@@ -283,17 +564,53 @@ bool Servatrice::initServer()
         qDebug() << "Reset password challenge on:" << getEnableForgotPasswordChallenge();
     }
 
+    // the rows of the mails stay until the mail is sent or given up on, so the mails waiting survive a restart
+    connect(smtpClient, &SmtpClient::mailFinished, this,
+            [this](SmtpClient::MailKind kind, const QString &userName, bool /* delivered */) {
+                QSqlQuery *query = servatriceDatabaseInterface->prepareQuery(
+                    kind == SmtpClient::ActivationTokenMail ? DatabaseStatement::DeleteActivationEmail
+                                                            : DatabaseStatement::MarkForgotPasswordEmailed);
+                query->bindValue(":name", userName);
+                servatriceDatabaseInterface->execSqlQuery(query);
+            });
+
     qDebug() << "Auditing enabled:" << getEnableAudit();
     if (getEnableAudit()) {
         qDebug() << "Audit registration attempts enabled:" << getEnableRegistrationAudit();
         qDebug() << "Audit reset password attepts enabled:" << getEnableForgotPasswordAudit();
     }
 
+    if (authenticationMethod == AuthenticationSql) {
+        const int hashThreads = settingsCache->value("authentication/hash_threads", 2).toInt();
+        if (hashThreads > 0) {
+            qDebug() << "Password hash threads:" << hashThreads;
+            passwordHashPool =
+                new PasswordHashPool(hashThreads, settingsCache->value("authentication/hash_queue_size", 500).toInt());
+        }
+    }
+
     if (getDBTypeString() == "mysql") {
         databaseType = DatabaseMySql;
     } else {
         databaseType = DatabaseNone;
     }
+    const int cacheTimeToLive = settingsCache->value("database/cache_time_to_live", 300).toInt();
+    if (databaseType != DatabaseNone && cacheTimeToLive > 0) {
+        qDebug() << "Caching database lookups for" << cacheTimeToLive << "seconds";
+        databaseCache = new DatabaseCache(settingsCache->value("database/cache_user_ids", 10000).toInt(),
+                                          settingsCache->value("database/cache_list_entries", 50000).toInt(),
+                                          settingsCache->value("database/cache_ban_checks", 10000).toInt(),
+                                          cacheTimeToLive);
+    }
+    if (databaseType != DatabaseNone) {
+        const int idBlockSize = settingsCache->value("database/id_block_size", 1000).toInt();
+        gameIdAllocator = new IdBlockAllocator(idBlockSize);
+        replayIdAllocator = new IdBlockAllocator(idBlockSize);
+        sessionIdAllocator = new IdBlockAllocator(idBlockSize);
+    }
+
+    getDeckListCache().setMaxDecks(settingsCache->value("game/cache_decks", 1000).toInt());
+
     servatriceDatabaseInterface = new Servatrice_DatabaseInterface(-1, this);
     setDatabaseInterface(servatriceDatabaseInterface);
 
@@ -306,19 +623,27 @@ bool Servatrice::initServer()
             return false;
         }
         updateServerList();
-        qDebug() << "Clearing previous sessions...";
-        servatriceDatabaseInterface->clearSessionTables();
+        // the sessions of the running server go on in this process
+        if (!takeOver) {
+            qDebug() << "Clearing previous sessions...";
+            servatriceDatabaseInterface->clearSessionTables();
+        }
     }
 
+    // so do its replays and hibernated games
+    if (!takeOver)
+        recoverSpooledReplays();
+    startReplayPersistenceWorker();
+    startChatLogWorker();
+    startSessionLogWorker();
+    startGameExecutor();
+
     if (getRoomsMethodString() == "sql") {
-        QSqlQuery *query = servatriceDatabaseInterface->prepareQuery(
-            "select id, name, descr, permissionlevel, privlevel, auto_join, join_message, chat_history_size from "
-            "{prefix}_rooms where id_server = :id_server order by id asc");
+        QSqlQuery *query = servatriceDatabaseInterface->prepareQuery(DatabaseStatement::SelectRooms);
         query->bindValue(":id_server", serverId);
         servatriceDatabaseInterface->execSqlQuery(query);
         while (query->next()) {
-            QSqlQuery *query2 = servatriceDatabaseInterface->prepareQuery(
-                "select name from {prefix}_rooms_gametypes where id_room = :id_room AND id_server = :id_server");
+            QSqlQuery *query2 = servatriceDatabaseInterface->prepareQuery(DatabaseStatement::SelectRoomGameTypes);
             query2->bindValue(":id_server", serverId);
             query2->bindValue(":id_room", query->value(0).toInt());
             servatriceDatabaseInterface->execSqlQuery(query2);
@@ -404,11 +729,9 @@ bool Servatrice::initServer()
                 QMetaObject::invokeMethod(interface, "initClient", Qt::BlockingQueuedConnection);
             }
 
-            qDebug() << "Starting ISL server on port" << getISLNetworkPort();
             islServer = new Servatrice_IslServer(this, cert, key, this);
-            if (islServer->listen(QHostAddress::Any, static_cast<quint16>(getISLNetworkPort())))
-                qDebug() << "ISL server listening.";
-            else
+            // on a take over, the port is free once the running server handed over
+            if (!takeOver && !listenIslServer())
                 throw QString("islServer->listen()");
         }
     } catch (QString &error) {
@@ -416,9 +739,7 @@ bool Servatrice::initServer()
         return false;
     }
 
-    pingClock = new QTimer(this);
-    connect(pingClock, SIGNAL(timeout()), this, SIGNAL(pingClockTimeout()));
-    pingClock->start(getClientKeepAlive() * 1000);
+    startPingClock(getClientKeepAlive() * 1000);
 
     statusUpdateClock = new QTimer(this);
     connect(statusUpdateClock, SIGNAL(timeout()), this, SLOT(statusUpdate()));
@@ -432,14 +753,6 @@ bool Servatrice::initServer()
         gameServer =
             new Servatrice_GameServer(this, getNumberOfTCPPools(), servatriceDatabaseInterface->getDatabase(), this);
         gameServer->setMaxPendingConnections(1000);
-        QHostAddress tcpHost = getServerTCPHost();
-        qDebug() << "Starting server on host" << tcpHost.toString() << "port" << getServerTCPPort();
-        if (gameServer->listen(tcpHost, static_cast<quint16>(getServerTCPPort())))
-            qDebug() << "Server listening.";
-        else {
-            qDebug() << "gameServer->listen(): Error:" << gameServer->errorString();
-            return false;
-        }
     }
 
     // WEBSOCKET SERVER
@@ -447,15 +760,23 @@ bool Servatrice::initServer()
         websocketGameServer = new Servatrice_WebsocketGameServer(this, getNumberOfWebSocketPools(),
                                                                  servatriceDatabaseInterface->getDatabase(), this);
         websocketGameServer->setMaxPendingConnections(1000);
-        QHostAddress webSocketHost = getServerWebSocketHost();
-        qDebug() << "Starting websocket server on host" << webSocketHost.toString() << "port"
-                 << getServerWebSocketPort();
-        if (websocketGameServer->listen(webSocketHost, static_cast<quint16>(getServerWebSocketPort())))
-            qDebug() << "Websocket server listening.";
-        else {
-            qDebug() << "websocketGameServer->listen(): Error:" << websocketGameServer->errorString();
+    }
+
+    if (takeOver) {
+        if (!takeOverRunningServer())
+            return false;
+        // a listener the running server didn't have is opened only now that its ports are free
+        if (gameServer && !gameServer->hasListeners() && !listenGameServer())
+            return false;
+        if (websocketGameServer && !websocketGameServer->isListening() && !listenWebsocketGameServer())
+            return false;
+        if (islServer && !listenIslServer())
+            return false;
+    } else {
+        if (gameServer && !listenGameServer())
+            return false;
+        if (websocketGameServer && !listenWebsocketGameServer())
             return false;
-        }
     }
 
     if (getIdleClientTimeout() > 0) {
@@ -467,10 +788,482 @@ bool Servatrice::initServer()
                         "client and short time out values will remove these players.";
     }
 
+    if (!startMetricsServer())
+        return false;
+    startHandoffServer();
+
     setRequiredFeatures(getRequiredFeatures());
     return true;
 }
 
+bool Servatrice::listenGameServer()
+{
+    QHostAddress tcpHost = getServerTCPHost();
+    qDebug() << "Starting server on host" << tcpHost.toString() << "port" << getServerTCPPort();
+    if (getPerPoolListenersEnabled() && Servatrice_GameServer::perPoolListenersSupported()) {
+        if (gameServer->listenPerPool(tcpHost, static_cast<quint16>(getServerTCPPort())))
+            qDebug() << "Server listening, one listener per pool.";
+        else {
+            qDebug() << "gameServer->listenPerPool(): Error";
+            return false;
+        }
+    } else {
+        if (getPerPoolListenersEnabled())
+            qDebug() << "Per pool listeners are not supported on this platform, using a single listener.";
+        if (gameServer->listen(tcpHost, static_cast<quint16>(getServerTCPPort())))
+            qDebug() << "Server listening.";
+        else {
+            qDebug() << "gameServer->listen(): Error:" << gameServer->errorString();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Servatrice::listenWebsocketGameServer()
+{
+    QHostAddress webSocketHost = getServerWebSocketHost();
+    qDebug() << "Starting websocket server on host" << webSocketHost.toString() << "port" << getServerWebSocketPort();
+    if (websocketGameServer->listen(webSocketHost, static_cast<quint16>(getServerWebSocketPort())))
+        qDebug() << "Websocket server listening.";
+    else {
+        qDebug() << "websocketGameServer->listen(): Error:" << websocketGameServer->errorString();
+        return false;
+    }
+    return true;
+}
+
+bool Servatrice::listenIslServer()
+{
+    qDebug() << "Starting ISL server on port" << getISLNetworkPort();
+    if (!islServer->listen(QHostAddress::Any, static_cast<quint16>(getISLNetworkPort())))
+        return false;
+    qDebug() << "ISL server listening.";
+    return true;
+}
+
+void Servatrice::startHandoffServer()
+{
+    const QString path = getHandoffSocketPath();
+    if (path.isEmpty())
+        return;
+    if (!HandoffChannel::isSupported()) {
+        qDebug() << "Hot restarts are not supported on this platform.";
+        return;
+    }
+
+    // the socket file of the process this one took over from is still around
+    QLocalServer::removeServer(path);
+    handoffServer = new QLocalServer(this);
+    handoffServer->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(handoffServer, &QLocalServer::newConnection, this, &Servatrice::handoffRequested);
+    if (handoffServer->listen(path))
+        qDebug() << "Waiting for hot restarts on" << path;
+    else
+        qDebug() << "handoffServer->listen(): Error:" << handoffServer->errorString();
+}
+
+void Servatrice::handoffRequested()
+{
+    QLocalSocket *connection = handoffServer->nextPendingConnection();
+    if (!connection)
+        return;
+    // the handoff talks to the socket itself and blocks, Qt must not read from it in between
+    const int channel = HandoffChannel::duplicateDescriptor(static_cast<int>(connection->socketDescriptor()));
+    connection->abort();
+    connection->deleteLater();
+    if (channel < 0)
+        return;
+
+    handOver(channel);
+    HandoffChannel::closeDescriptor(channel);
+}
+
+bool Servatrice::sendHandoff(int channel, const ServerHandoff &message, const QList<int> &descriptors)
+{
+    return HandoffChannel::send(channel, QByteArray::fromStdString(message.SerializeAsString()), descriptors);
+}
+
+void Servatrice::handOver(int channel)
+{
+    qDebug() << "Handing over to a new process...";
+
+    ServerHandoff listeners;
+    listeners.set_kind(ServerHandoff::LISTENERS);
+    QList<int> descriptors;
+    if (gameServer) {
+        for (int descriptor : gameServer->getListenerDescriptors()) {
+            listeners.add_listener_list(ServerHandoff::TCP);
+            descriptors.append(descriptor);
+        }
+    }
+    if (websocketGameServer && websocketGameServer->isListening()) {
+        listeners.add_listener_list(ServerHandoff::WEBSOCKET);
+        descriptors.append(static_cast<int>(websocketGameServer->socketDescriptor()));
+    }
+    if (!sendHandoff(channel, listeners, descriptors)) {
+        qDebug() << "Handoff failed, the new process didn't take the listeners.";
+        return;
+    }
+
+    // the new process accepts the connections from now on, the ones waiting included
+    if (gameServer)
+        gameServer->closeListeners();
+    if (websocketGameServer)
+        websocketGameServer->close();
+    if (islServer)
+        islServer->close();
+    delete metricsServer;
+    metricsServer = nullptr;
+    statusUpdateClock->stop();
+
+    if (!handOverGamesAndSessions(channel)) {
+        // the listeners are gone, all that is left is to go down the usual way
+        qDebug() << "Handoff failed, shutting down.";
+        scheduleShutdown(QString(), 0);
+        return;
+    }
+
+    // The replays of the games that ended are stored before leaving. Nothing else is torn down: the sessions, games
+    // and spooled replays go on in the new process.
+    qDebug() << "Handoff done, quitting.";
+    stopBackgroundWorkers();
+    QMetaObject::invokeMethod(logger, "flushBuffer", Qt::BlockingQueuedConnection);
+    std::_Exit(0);
+}
+
+void Servatrice::waitForGameCommands()
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 2000 && ((gameExecutor && gameExecutor->getQueueDepth() > 0) ||
+                                      (passwordHashPool && passwordHashPool->getQueueDepth() > 0))) {
+        QCoreApplication::processEvents();
+        QThread::msleep(5);
+    }
+    QCoreApplication::processEvents();
+}
+
+bool Servatrice::handOverGamesAndSessions(int channel)
+{
+    const QList<Servatrice_ConnectionPool *> pools =
+        gameServer ? gameServer->getConnectionPools() : QList<Servatrice_ConnectionPool *>();
+
+    // nothing new comes in, what is under way finishes
+    for (Servatrice_ConnectionPool *pool : pools)
+        QMetaObject::invokeMethod(pool, "pauseClientInput", Qt::BlockingQueuedConnection);
+    waitForGameCommands();
+
+    // The sessions that can't be carried over end the usual way, while the others still hear about it. Websocket
+    // connections can't be passed on, they live in this thread.
+    QList<Server_ProtocolHandler *> websocketClients;
+    clientsLock.lockForRead();
+    for (Server_ProtocolHandler *client : clients)
+        if (client->getConnectionType() == "websocket")
+            websocketClients.append(client);
+    clientsLock.unlock();
+    for (Server_ProtocolHandler *client : websocketClients)
+        client->prepareDestroy();
+    for (Servatrice_ConnectionPool *pool : pools)
+        QMetaObject::invokeMethod(pool, "dropUnmovableClients", Qt::BlockingQueuedConnection);
+    roomsLock.lockForRead();
+    for (Server_Room *room : rooms) {
+        QReadLocker gamesLocker(&room->gamesLock);
+        for (Server_Game *game : room->getGames()) {
+            QMutexLocker gameLocker(&game->gameMutex);
+            game->prepareHandoff();
+        }
+    }
+    roomsLock.unlock();
+    waitForGameCommands();
+
+    QList<QPair<int, QByteArray>> sessions;
+    for (Servatrice_ConnectionPool *pool : pools)
+        QMetaObject::invokeMethod(pool, "handOffClients", Qt::BlockingQueuedConnection,
+                                  Q_ARG(void *, &sessions));
+    // the new process may end these sessions right away, their rows have to be there by then
+    if (sessionLogWorker)
+        QMetaObject::invokeMethod(sessionLogWorker, "processQueue", Qt::BlockingQueuedConnection);
+
+    // only now, the sessions have been sent everything that happened in the games
+    QList<QByteArray> games;
+    roomsLock.lockForRead();
+    for (Server_Room *room : rooms) {
+        QReadLocker gamesLocker(&room->gamesLock);
+        for (Server_Game *game : room->getGames()) {
+            ServerHandoff message;
+            message.set_kind(ServerHandoff::GAME);
+            QMutexLocker gameLocker(&game->gameMutex);
+            game->getHandoffInfo(*message.mutable_game());
+            games.append(QByteArray::fromStdString(message.SerializeAsString()));
+        }
+    }
+    roomsLock.unlock();
+
+    bool success = true;
+    for (const QByteArray &game : games)
+        success = success && HandoffChannel::send(channel, game);
+    for (const auto &session : sessions) {
+        ServerHandoff message;
+        message.set_kind(ServerHandoff::SESSION);
+        message.mutable_session()->ParseFromArray(session.second.constData(), session.second.size());
+        success = success && sendHandoff(channel, message, {session.first});
+        HandoffChannel::closeDescriptor(session.first);
+    }
+    qDebug() << "Handed over" << games.size() << "games and" << sessions.size() << "sessions";
+
+    ServerHandoff done;
+    done.set_kind(ServerHandoff::DONE);
+    if (!success || !sendHandoff(channel, done))
+        return false;
+
+    // the new process answers once it adopted everything
+    QByteArray answer;
+    QList<int> unexpectedDescriptors;
+    ServerHandoff answerMessage;
+    const bool answered = HandoffChannel::receive(channel, answer, unexpectedDescriptors, 60000) &&
+                          answerMessage.ParseFromArray(answer.constData(), answer.size()) &&
+                          answerMessage.kind() == ServerHandoff::DONE;
+    for (int descriptor : unexpectedDescriptors)
+        HandoffChannel::closeDescriptor(descriptor);
+    return answered;
+}
+
+bool Servatrice::takeOverRunningServer()
+{
+    const QString path = getHandoffSocketPath();
+    const int channel = HandoffChannel::connectTo(path);
+    if (channel < 0) {
+        qDebug() << "Could not connect to the running server on" << path;
+        return false;
+    }
+    qDebug() << "Taking over from the running server...";
+
+    int gameCount = 0, sessionCount = 0;
+    bool success = true, done = false;
+    while (success && !done) {
+        QByteArray data;
+        QList<int> descriptors;
+        ServerHandoff message;
+        // the running server waits for its game commands to finish in between
+        success = HandoffChannel::receive(channel, data, descriptors, 60000) &&
+                  message.ParseFromArray(data.constData(), data.size());
+        if (success) {
+            switch (message.kind()) {
+                case ServerHandoff::LISTENERS:
+                    success = adoptListeners(message, descriptors);
+                    break;
+                case ServerHandoff::GAME:
+                    if (adoptHandoffGame(message.game()))
+                        ++gameCount;
+                    break;
+                case ServerHandoff::SESSION:
+                    if (gameServer && !descriptors.isEmpty()) {
+                        gameServer->adoptSession(descriptors.takeFirst(),
+                                                 QByteArray::fromStdString(message.session().SerializeAsString()));
+                        ++sessionCount;
+                    }
+                    break;
+                case ServerHandoff::DONE:
+                    done = true;
+                    break;
+            }
+        }
+        for (int descriptor : descriptors)
+            HandoffChannel::closeDescriptor(descriptor);
+    }
+
+    if (success) {
+        ServerHandoff answer;
+        answer.set_kind(ServerHandoff::DONE);
+        success = sendHandoff(channel, answer);
+    }
+    HandoffChannel::closeDescriptor(channel);
+    if (!success) {
+        qDebug() << "Taking over failed.";
+        return false;
+    }
+    qDebug() << "Took over" << gameCount << "games and" << sessionCount << "sessions";
+    return true;
+}
+
+// takes the descriptors it uses out of descriptors
+bool Servatrice::adoptListeners(const ServerHandoff &message, QList<int> &descriptors)
+{
+    QList<int> tcpDescriptors;
+    for (int i = 0; i < message.listener_list_size() && i < descriptors.size(); ++i) {
+        const int descriptor = descriptors.at(i);
+        if (message.listener_list(i) == ServerHandoff::TCP && gameServer) {
+            tcpDescriptors.append(descriptor);
+        } else if (message.listener_list(i) == ServerHandoff::WEBSOCKET && websocketGameServer) {
+            if (!websocketGameServer->setSocketDescriptor(descriptor))
+                return false;
+            qDebug() << "Websocket server listening, taken over.";
+        } else {
+            HandoffChannel::closeDescriptor(descriptor);
+        }
+    }
+    descriptors = descriptors.mid(message.listener_list_size());
+
+    if (tcpDescriptors.isEmpty())
+        return true;
+    const bool perPool = getPerPoolListenersEnabled() && Servatrice_GameServer::perPoolListenersSupported();
+    if (!gameServer->adoptListeners(tcpDescriptors, perPool))
+        return false;
+    qDebug() << "Server listening, taken over.";
+    return true;
+}
+
+void Servatrice::recoverSpooledReplays()
+{
+    // Games hibernated when the server went down are gone with it, only the replays they spooled are recovered.
+    const QString hibernationDirectory = getGameHibernationDirectory();
+    if (!hibernationDirectory.isEmpty()) {
+        QDir dir(hibernationDirectory);
+        for (const QString &fileName : dir.entryList({"game_*.hibernated"}, QDir::Files))
+            dir.remove(fileName);
+        recoverSpooledReplays(dir);
+    }
+
+    const QString spoolDirectory = getReplaySpoolDirectory();
+    if (spoolDirectory.isEmpty())
+        return;
+
+    QDir dir(spoolDirectory);
+    if (!dir.mkpath(".")) {
+        qWarning() << "Could not create replay spool directory" << spoolDirectory << "- replays are kept in memory";
+        return;
+    }
+    if (dir != QDir(hibernationDirectory))
+        recoverSpooledReplays(dir);
+}
+
+void Servatrice::recoverSpooledReplays(const QDir &dir)
+{
+    if (databaseType == DatabaseNone || !getStoreReplaysEnabled())
+        return;
+
+    // Spool files still around at startup belong to games that were running when the server went down. Store
+    // what has been recorded, the games themselves are never finished and nobody is given access to the replays.
+    for (const QString &fileName : dir.entryList(QDir::Files)) {
+        const qint64 replayId = GameReplayWriter::replayIdFromSpoolFileName(fileName);
+        if (replayId < 0)
+            continue;
+
+        QFile file(dir.filePath(fileName));
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+        const QByteArray data = file.readAll();
+        file.close();
+
+        GameReplay replay;
+        if (!replay.ParseFromArray(data.data(), data.size())) {
+            qWarning() << "Skipping unreadable replay spool file" << file.fileName();
+            continue;
+        }
+        const int eventCount = replay.event_list_size();
+        const int durationSeconds = eventCount > 0 ? replay.event_list(eventCount - 1).seconds_elapsed() : 0;
+        replay.set_duration_seconds(durationSeconds);
+
+        if (servatriceDatabaseInterface->storeRecoveredReplay(replayId, replay.game_info(), durationSeconds,
+                                                              QByteArray::fromStdString(replay.SerializeAsString()))) {
+            qDebug() << "Recovered replay" << replayId << "of game" << replay.game_info().game_id();
+            file.remove();
+        }
+    }
+}
+
+void Servatrice::startReplayPersistenceWorker()
+{
+    if (databaseType == DatabaseNone || !getStoreReplaysEnabled())
+        return;
+
+    auto *databaseInterface =
+        new Servatrice_DatabaseInterface(Servatrice_DatabaseInterface::ReplayWorkerInstanceId, this);
+    replayPersistenceWorker =
+        new ReplayPersistenceWorker(databaseInterface, getReplayQueueSize(), getReplayBatchSize());
+
+    auto *thread = new QThread;
+    thread->setObjectName("replays");
+    replayPersistenceWorker->moveToThread(thread);
+    databaseInterface->moveToThread(thread);
+
+    thread->start();
+    QMetaObject::invokeMethod(databaseInterface, "initDatabase", Qt::BlockingQueuedConnection,
+                              Q_ARG(QSqlDatabase, servatriceDatabaseInterface->getDatabase()));
+}
+
+void Servatrice::startChatLogWorker()
+{
+    if (databaseType == DatabaseNone)
+        return;
+    // messages that only get logged after a settings reload are inserted right away
+    const ServatriceConfig &config = settingsCache->config();
+    if (!config.logUserMessagesInRooms && !config.logUserMessagesInGames && !config.logUserMessagesInChats &&
+        !config.logUserMessagesFromIsl)
+        return;
+
+    auto *databaseInterface =
+        new Servatrice_DatabaseInterface(Servatrice_DatabaseInterface::ChatLogWorkerInstanceId, this);
+    chatLogWorker = new ChatLogWorker(databaseInterface, settingsCache->value("logging/log_queue_size", 10000).toInt(),
+                                      settingsCache->value("logging/log_batch_size", 100).toInt(),
+                                      settingsCache->value("logging/log_flush_interval", 1000).toInt());
+
+    auto *thread = new QThread;
+    thread->setObjectName("chat log");
+    chatLogWorker->moveToThread(thread);
+    databaseInterface->moveToThread(thread);
+
+    thread->start();
+    QMetaObject::invokeMethod(databaseInterface, "initDatabase", Qt::BlockingQueuedConnection,
+                              Q_ARG(QSqlDatabase, servatriceDatabaseInterface->getDatabase()));
+    QMetaObject::invokeMethod(chatLogWorker, "start", Qt::QueuedConnection);
+}
+
+void Servatrice::startSessionLogWorker()
+{
+    if (databaseType == DatabaseNone || authenticationMethod == AuthenticationNone)
+        return;
+
+    auto *databaseInterface =
+        new Servatrice_DatabaseInterface(Servatrice_DatabaseInterface::SessionLogWorkerInstanceId, this);
+    sessionLogWorker =
+        new SessionLogWorker(databaseInterface, settingsCache->value("database/session_queue_size", 10000).toInt(),
+                             settingsCache->value("database/session_batch_size", 100).toInt(),
+                             settingsCache->value("database/session_flush_interval", 1000).toInt());
+
+    auto *thread = new QThread;
+    thread->setObjectName("session log");
+    sessionLogWorker->moveToThread(thread);
+    databaseInterface->moveToThread(thread);
+
+    thread->start();
+    QMetaObject::invokeMethod(databaseInterface, "initDatabase", Qt::BlockingQueuedConnection,
+                              Q_ARG(QSqlDatabase, servatriceDatabaseInterface->getDatabase()));
+    QMetaObject::invokeMethod(sessionLogWorker, "start", Qt::QueuedConnection);
+}
+
+void Servatrice::startGameExecutor()
+{
+    const int threadCount = settingsCache->value("game/executor_threads", 0).toInt();
+    if (threadCount <= 0)
+        return;
+
+    qDebug() << "Game executor threads:" << threadCount;
+    gameExecutor = new GameExecutor(threadCount);
+    // the games run their commands on these threads, so they need a database connection each like the pools
+    for (int i = 0; i < threadCount; ++i) {
+        QThread *thread = gameExecutor->getThread(i);
+        auto *databaseInterface =
+            new Servatrice_DatabaseInterface(Servatrice_DatabaseInterface::GameExecutorInstanceIdBase - i, this);
+        databaseInterface->moveToThread(thread);
+        connect(thread, &QThread::finished, databaseInterface, &QObject::deleteLater);
+        addDatabaseInterface(thread, databaseInterface);
+        QMetaObject::invokeMethod(databaseInterface, "initDatabase", Qt::BlockingQueuedConnection,
+                                  Q_ARG(QSqlDatabase, servatriceDatabaseInterface->getDatabase()));
+    }
+}
+
 void Servatrice::addDatabaseInterface(QThread *thread, Servatrice_DatabaseInterface *databaseInterface)
 {
     databaseInterfaces.insert(thread, databaseInterface);
@@ -483,8 +1276,7 @@ void Servatrice::updateServerList()
     serverListMutex.lock();
     serverList.clear();
 
-    QSqlQuery *query = servatriceDatabaseInterface->prepareQuery(
-        "select id, ssl_cert, hostname, address, game_port, control_port from {prefix}_servers order by id asc");
+    QSqlQuery *query = servatriceDatabaseInterface->prepareQuery(DatabaseStatement::SelectServers);
     servatriceDatabaseInterface->execSqlQuery(query);
     while (query->next()) {
         ServerProperties prop(query->value(0).toInt(), QSslCertificate(query->value(1).toString().toUtf8()),
@@ -538,8 +1330,7 @@ void Servatrice::updateLoginMessage()
     if (!servatriceDatabaseInterface->checkSql())
         return;
 
-    QSqlQuery *query = servatriceDatabaseInterface->prepareQuery(
-        "select message from {prefix}_servermessages where id_server = :id_server order by timest desc limit 1");
+    QSqlQuery *query = servatriceDatabaseInterface->prepareQuery(DatabaseStatement::SelectLoginMessage);
     query->bindValue(":id_server", serverId);
     if (servatriceDatabaseInterface->execSqlQuery(query))
         if (query->next()) {
@@ -552,9 +1343,10 @@ void Servatrice::updateLoginMessage()
             Event_ServerMessage event;
             event.set_message(newLoginMessage.toStdString());
             SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
-            QMapIterator<QString, Server_ProtocolHandler *> usersIterator(users);
-            while (usersIterator.hasNext())
-                usersIterator.next().value()->sendProtocolItem(*se);
+            clientsLock.lockForRead();
+            for (Server_ProtocolHandler *user : users.values())
+                user->sendProtocolItem(*se);
+            clientsLock.unlock();
             delete se;
         }
 }
@@ -592,19 +1384,14 @@ void Servatrice::statusUpdate()
 
     uptime += statusUpdateClock->interval() / 1000;
 
-    txBytesMutex.lock();
-    quint64 tx = txBytes;
-    txBytes = 0;
-    txBytesMutex.unlock();
-    rxBytesMutex.lock();
-    quint64 rx = rxBytes;
-    rxBytes = 0;
-    rxBytesMutex.unlock();
-
-    QSqlQuery *query = servatriceDatabaseInterface->prepareQuery(
-        "insert into {prefix}_uptime (id_server, timest, uptime, users_count, mods_count, mods_list, games_count, "
-        "tx_bytes, rx_bytes) values(:id, NOW(), :uptime, :users_count, :mods_count, :mods_list, :games_count, :tx, "
-        ":rx)");
+    const quint64 totalTx = txBytes->get();
+    const quint64 tx = totalTx - reportedTxBytes;
+    reportedTxBytes = totalTx;
+    const quint64 totalRx = rxBytes->get();
+    const quint64 rx = totalRx - reportedRxBytes;
+    reportedRxBytes = totalRx;
+
+    QSqlQuery *query = servatriceDatabaseInterface->prepareQuery(DatabaseStatement::InsertUptime);
     query->bindValue(":id", serverId);
     query->bindValue(":uptime", uptime);
     query->bindValue(":users_count", uc);
@@ -615,48 +1402,111 @@ void Servatrice::statusUpdate()
     query->bindValue(":rx", rx);
     servatriceDatabaseInterface->execSqlQuery(query);
 
+    if (replayPersistenceWorker) {
+        const int peakQueueDepth = replayPersistenceWorker->takePeakQueueDepth();
+        if (peakQueueDepth > 0)
+            qDebug() << "Replay queue: depth" << replayPersistenceWorker->getQueueDepth() << "peak" << peakQueueDepth
+                     << "stored" << replayPersistenceWorker->getStoredGameCount() << "failed"
+                     << replayPersistenceWorker->getFailedGameCount() << "stored synchronously"
+                     << replayPersistenceWorker->getRejectedGameCount();
+    }
+
+    if (chatLogWorker) {
+        const int peakQueueDepth = chatLogWorker->takePeakQueueDepth();
+        if (peakQueueDepth > 0)
+            qDebug() << "Chat log queue: depth" << chatLogWorker->getQueueDepth() << "peak" << peakQueueDepth
+                     << "longest wait" << chatLogWorker->takePeakDelay() << "ms stored"
+                     << chatLogWorker->getStoredMessageCount() << "dropped" << chatLogWorker->getFailedMessageCount()
+                     << "stored synchronously" << chatLogWorker->getRejectedMessageCount();
+    }
+
+    if (sessionLogWorker) {
+        const int peakQueueDepth = sessionLogWorker->takePeakQueueDepth();
+        if (peakQueueDepth > 0)
+            qDebug() << "Session log queue: depth" << sessionLogWorker->getQueueDepth() << "peak" << peakQueueDepth
+                     << "stored" << sessionLogWorker->getStoredChangeCount() << "dropped"
+                     << sessionLogWorker->getFailedChangeCount() << "stored synchronously"
+                     << sessionLogWorker->getRejectedChangeCount();
+    }
+
+    if (smtpClient && smtpClient->getQueueDepth() > 0)
+        qDebug() << "Mail queue: depth" << smtpClient->getQueueDepth() << "sent" << smtpClient->getSentCount()
+                 << "retried" << smtpClient->getRetriedCount() << "given up" << smtpClient->getFailedCount();
+
+    if (passwordHashPool) {
+        const int peakQueueDepth = passwordHashPool->takePeakQueueDepth();
+        if (peakQueueDepth > 0)
+            qDebug() << "Password hash queue: depth" << passwordHashPool->getQueueDepth() << "peak" << peakQueueDepth
+                     << "hashed" << passwordHashPool->getHashedCount() << "hashed synchronously"
+                     << passwordHashPool->getRejectedCount();
+    }
+
+    islLock.lockForRead();
+    for (IslInterface *interface : islInterfaces) {
+        int peakMessages;
+        qint64 peakLatency;
+        interface->takeStatistics(peakMessages, peakLatency);
+        if (peakMessages > 0)
+            qDebug() << "[ISL] Output to #" << interface->getServerId() << ": peak messages per write"
+                     << peakMessages << "longest wait" << peakLatency << "ms";
+    }
+    islLock.unlock();
+
+    for (const CommandTrace::Summary &summary : CommandTrace::takeSummaries())
+        qDebug().noquote() << QString("Command %1: %2 traced, total/lock wait/execute/respond in us: median "
+                                      "%3/%4/%5/%6 p99 %7/%8/%9/%10 max %11")
+                                  .arg(CommandTrace::commandName(summary.commandKey))
+                                  .arg(summary.count)
+                                  .arg(summary.median[CommandTrace::Total])
+                                  .arg(summary.median[CommandTrace::LockWait])
+                                  .arg(summary.median[CommandTrace::Execute])
+                                  .arg(summary.median[CommandTrace::Respond])
+                                  .arg(summary.p99[CommandTrace::Total])
+                                  .arg(summary.p99[CommandTrace::LockWait])
+                                  .arg(summary.p99[CommandTrace::Execute])
+                                  .arg(summary.p99[CommandTrace::Respond])
+                                  .arg(summary.max[CommandTrace::Total]);
+
+    if (databaseCache) {
+        const DatabaseCache::Counters userIds = databaseCache->getUserIdCounters();
+        const DatabaseCache::Counters listEntries = databaseCache->getListEntryCounters();
+        const DatabaseCache::Counters banChecks = databaseCache->getBanStateCounters();
+        qDebug() << "Database cache hits/misses: user ids" << userIds.hits << "/" << userIds.misses << "list entries"
+                 << listEntries.hits << "/" << listEntries.misses << "ban checks" << banChecks.hits << "/"
+                 << banChecks.misses;
+    }
+    const DeckListCache::Counters decks = getDeckListCache().getCounters();
+    qDebug() << "Deck cache hits/misses:" << decks.hits << "/" << decks.misses;
+
     if (getRegistrationEnabled() && getEnableInternalSMTPClient()) {
         if (getRequireEmailActivationEnabled()) {
-            auto servDbSelQuery = servatriceDatabaseInterface->prepareQuery("select a.name, b.email, b.token from "
-                                                                            "{prefix}_activation_emails a left join "
-                                                                            "{prefix}_users b on a.name = b.name");
+            auto servDbSelQuery = servatriceDatabaseInterface->prepareQuery(DatabaseStatement::SelectActivationEmails);
             if (!servatriceDatabaseInterface->execSqlQuery(servDbSelQuery))
                 return;
 
-            auto *queryDelete =
-                servatriceDatabaseInterface->prepareQuery("delete from {prefix}_activation_emails where name = :name");
-
             while (servDbSelQuery->next()) {
                 const QString userName = servDbSelQuery->value(0).toString();
                 const auto emailAddress = EmailParser::getParsedEmailAddress(servDbSelQuery->value(1).toString());
                 const QString token = servDbSelQuery->value(2).toString();
 
-                if (smtpClient->enqueueActivationTokenMail(userName, emailAddress, token)) {
-                    queryDelete->bindValue(":name", userName);
-                    servatriceDatabaseInterface->execSqlQuery(queryDelete);
-                }
+                // the row goes once the mail is sent; a mail that is still queued, or finds the queue full, is
+                // picked up again next time
+                smtpClient->enqueueActivationTokenMail(userName, emailAddress, token);
             }
         }
 
         if (getEnableForgotPassword()) {
-            auto *forgotPwQuery = servatriceDatabaseInterface->prepareQuery(
-                "select a.name, b.email, b.token from {prefix}_forgot_password a left join {prefix}_users b on a.name "
-                "= b.name where a.emailed = 0");
+            auto *forgotPwQuery =
+                servatriceDatabaseInterface->prepareQuery(DatabaseStatement::SelectUnsentForgotPasswords);
             if (!servatriceDatabaseInterface->execSqlQuery(forgotPwQuery))
                 return;
 
-            QSqlQuery *queryDelete = servatriceDatabaseInterface->prepareQuery(
-                "update {prefix}_forgot_password set emailed = 1 where name = :name");
-
             while (forgotPwQuery->next()) {
                 const QString userName = forgotPwQuery->value(0).toString();
                 const auto emailAddress = EmailParser::getParsedEmailAddress(forgotPwQuery->value(1).toString());
                 const QString token = forgotPwQuery->value(2).toString();
 
-                if (smtpClient->enqueueForgotPasswordTokenMail(userName, emailAddress, token)) {
-                    queryDelete->bindValue(":name", userName);
-                    servatriceDatabaseInterface->execSqlQuery(queryDelete);
-                }
+                smtpClient->enqueueForgotPasswordTokenMail(userName, emailAddress, token);
             }
         }
 
@@ -677,18 +1527,295 @@ void Servatrice::scheduleShutdown(const QString &reason, int minutes)
     shutdownTimeout();
 }
 
+void Servatrice::setTimelineTraceRunning(bool running)
+{
+    if (running) {
+        const int eventsPerThread = settingsCache->value("server/timeline_trace_events", 100000).toInt();
+        TimelineTrace::start(eventsPerThread);
+        logger->logMessage(QString("Timeline trace started, keeping %1 events per thread").arg(eventsPerThread));
+        return;
+    }
+    if (!TimelineTrace::isRunning())
+        return;
+
+    TimelineTrace::stop();
+    const QDir dir(settingsCache->value("server/timeline_trace_directory", ".").toString());
+    const QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss");
+    const QString fileName = dir.absoluteFilePath(QString("servatrice-timeline-%1.json").arg(timestamp));
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(TimelineTrace::toChromeTrace()) < 0) {
+        logger->logMessage(QString("Could not write the timeline trace to %1: %2").arg(fileName, file.errorString()));
+        return;
+    }
+    logger->logMessage(QString("Timeline trace written to %1").arg(fileName));
+}
+
+void Servatrice::toggleTimelineTrace()
+{
+    setTimelineTraceRunning(!TimelineTrace::isRunning());
+}
+
 void Servatrice::incTxBytes(quint64 num)
 {
-    txBytesMutex.lock();
-    txBytes += num;
-    txBytesMutex.unlock();
+    txBytes->add(num);
 }
 
 void Servatrice::incRxBytes(quint64 num)
 {
-    rxBytesMutex.lock();
-    rxBytes += num;
-    rxBytesMutex.unlock();
+    rxBytes->add(num);
+}
+
+MetricsHistogram *Servatrice::getPoolEventDelayHistogram(int poolNumber) const
+{
+    return metrics->histogram("servatrice_pool_event_delay_seconds",
+                              "How long events wait in the queue of a connection pool thread before they are "
+                              "processed.",
+                              Metrics::label("pool", "pool_" + QString::number(poolNumber)));
+}
+
+void Servatrice::getMemoryUsage(Response_MemoryUsage &result, int topCount)
+{
+    enum
+    {
+        Games,
+        Replays,
+        ResumeLogs,
+        OutputQueues,
+        ChatHistory,
+        IslBuffers,
+        SubsystemCount
+    };
+    static const char *const subsystemNames[SubsystemCount] = {"games",         "replays",      "resume_logs",
+                                                               "output_queues", "chat_history", "isl_buffers"};
+    qint64 bytes[SubsystemCount] = {};
+    int counts[SubsystemCount] = {};
+    struct Consumer
+    {
+        int subsystem;
+        QString name;
+        qint64 bytes;
+    };
+    QList<Consumer> consumers;
+    auto add = [&](int subsystem, const QString &name, qint64 size) {
+        bytes[subsystem] += size;
+        ++counts[subsystem];
+        if (topCount > 0 && size > 0)
+            consumers.append({subsystem, name, size});
+    };
+
+    {
+        QReadLocker roomsLocker(&roomsLock);
+        for (Server_Room *room : getRooms()) {
+            add(ChatHistory, room->getName(), room->getChatHistoryBytes());
+            QReadLocker gamesLocker(&room->gamesLock);
+            for (Server_Game *game : room->getGames()) {
+                const Server_Game::MemoryUsage usage = game->getMemoryUsage();
+                const QString name = QString::number(game->getGameId());
+                add(Games, name, usage.board);
+                add(Replays, name, usage.replays);
+                add(ResumeLogs, name, usage.resumeLogs);
+            }
+        }
+    }
+
+    {
+        QReadLocker clientsLocker(&clientsLock);
+        for (Server_ProtocolHandler *client : clients) {
+            auto *socketInterface = static_cast<AbstractServerSocketInterface *>(client);
+            const ServerInfo_User *userInfo = socketInterface->getUserInfo();
+            add(OutputQueues,
+                userInfo ? QString::fromStdString(userInfo->name()) : socketInterface->getAddress(),
+                socketInterface->getOutputBytes());
+        }
+    }
+
+    {
+        QReadLocker islLocker(&islLock);
+        for (auto it = islInterfaces.constBegin(); it != islInterfaces.constEnd(); ++it)
+            add(IslBuffers, QString::number(it.key()), it.value()->getBufferedBytes());
+    }
+
+    for (int i = 0; i < SubsystemCount; ++i) {
+        Response_MemoryUsage::Subsystem *subsystem = result.add_subsystem_list();
+        subsystem->set_name(subsystemNames[i]);
+        subsystem->set_bytes(static_cast<quint64>(bytes[i]));
+        subsystem->set_count(static_cast<quint32>(counts[i]));
+    }
+
+    const int listed = qMin(topCount, consumers.size());
+    std::partial_sort(consumers.begin(), consumers.begin() + listed, consumers.end(),
+                      [](const Consumer &a, const Consumer &b) { return a.bytes > b.bytes; });
+    for (int i = 0; i < listed; ++i) {
+        Response_MemoryUsage::Consumer *consumer = result.add_top_list();
+        consumer->set_subsystem(subsystemNames[consumers.at(i).subsystem]);
+        consumer->set_name(consumers.at(i).name.toStdString());
+        consumer->set_bytes(static_cast<quint64>(consumers.at(i).bytes));
+    }
+}
+
+void Servatrice::getActivityTop(Response_ActivityTop &result, int topCount, int sortBy)
+{
+    const int tick = getPingClockTicks();
+    const int tickMsecs = getPingClockInterval();
+    auto fill = [tickMsecs](Response_ActivityTop::Entry &entry, const ActivityMeter::Sample &sample) {
+        entry.set_window_msecs(static_cast<quint32>(sample.ticks * tickMsecs));
+        entry.set_commands(static_cast<quint64>(sample.commands));
+        entry.set_handler_microseconds(static_cast<quint64>(sample.handlerMicroseconds));
+        entry.set_sent_bytes(static_cast<quint64>(sample.sentBytes));
+    };
+    // the entries are compared by their rates, the windows of those that started recently are shorter
+    auto sortKey = [sortBy](const Response_ActivityTop::Entry &entry) -> double {
+        const double windowMsecs = qMax(entry.window_msecs(), 1u);
+        switch (sortBy) {
+            case Command_GetActivityTop::HANDLER_TIME:
+                return entry.handler_microseconds() / windowMsecs;
+            case Command_GetActivityTop::SENT_BYTES:
+                return entry.sent_bytes() / windowMsecs;
+            case Command_GetActivityTop::OUTPUT_QUEUE:
+                if (entry.has_output_queue_bytes())
+                    return entry.output_queue_bytes();
+                break;
+            case Command_GetActivityTop::REPLAY_SIZE:
+                if (entry.has_replay_bytes())
+                    return entry.replay_bytes();
+                break;
+            default:
+                break;
+        }
+        return entry.commands() / windowMsecs;
+    };
+    auto keepTop = [topCount, &sortKey](QList<Response_ActivityTop::Entry> &entries) {
+        const int kept = qMin(topCount, entries.size());
+        std::partial_sort(entries.begin(), entries.begin() + kept, entries.end(),
+                          [&sortKey](const Response_ActivityTop::Entry &a, const Response_ActivityTop::Entry &b) {
+                              return sortKey(a) > sortKey(b);
+                          });
+        return entries.mid(0, kept);
+    };
+
+    QList<Response_ActivityTop::Entry> games;
+    {
+        QReadLocker roomsLocker(&roomsLock);
+        for (Server_Room *room : getRooms()) {
+            QReadLocker gamesLocker(&room->gamesLock);
+            for (Server_Game *game : room->getGames()) {
+                Response_ActivityTop::Entry entry;
+                entry.set_id(game->getGameId());
+                entry.set_name(game->getDescription().toStdString());
+                fill(entry, game->getActivity().sample(tick));
+                entry.set_replay_bytes(static_cast<quint64>(game->getMemoryUsage().replays));
+                games.append(entry);
+            }
+        }
+    }
+    for (const Response_ActivityTop::Entry &entry : keepTop(games))
+        result.add_game_list()->CopyFrom(entry);
+
+    QList<Response_ActivityTop::Entry> sessions;
+    {
+        QReadLocker clientsLocker(&clientsLock);
+        for (Server_ProtocolHandler *client : clients) {
+            auto *socketInterface = static_cast<AbstractServerSocketInterface *>(client);
+            const ServerInfo_User *userInfo = socketInterface->getUserInfo();
+            Response_ActivityTop::Entry entry;
+            entry.set_id(userInfo ? userInfo->session_id() : -1);
+            entry.set_name(userInfo ? userInfo->name() : socketInterface->getAddress().toStdString());
+            fill(entry, socketInterface->getActivity().sample(tick));
+            entry.set_output_queue_bytes(static_cast<quint64>(socketInterface->getOutputBytes()));
+            sessions.append(entry);
+        }
+    }
+    for (const Response_ActivityTop::Entry &entry : keepTop(sessions))
+        result.add_session_list()->CopyFrom(entry);
+}
+
+void Servatrice::registerMetricsGauges()
+{
+    metrics->addGauge("servatrice_users", "Users logged in to this server.", [this]() {
+        return Metrics::GaugeValues{{QString(), getUsersCount()}};
+    });
+
+    metrics->addGauge("servatrice_pool_clients", "Connections handled by a connection pool.", [this]() {
+        Metrics::GaugeValues values;
+        QList<Servatrice_ConnectionPool *> pools;
+        if (gameServer)
+            pools += gameServer->getConnectionPools();
+        if (websocketGameServer)
+            pools += websocketGameServer->getConnectionPools();
+        for (Servatrice_ConnectionPool *pool : pools)
+            values.append({Metrics::label("pool", pool->thread()->objectName()), pool->getClientCount()});
+        return values;
+    });
+
+    metrics->addGauge("servatrice_queue_depth", "Items waiting in the queues of the background workers.", [this]() {
+        Metrics::GaugeValues values;
+        if (replayPersistenceWorker)
+            values.append({Metrics::label("queue", "replays"), replayPersistenceWorker->getQueueDepth()});
+        if (chatLogWorker)
+            values.append({Metrics::label("queue", "chat_log"), chatLogWorker->getQueueDepth()});
+        if (sessionLogWorker)
+            values.append({Metrics::label("queue", "session_log"), sessionLogWorker->getQueueDepth()});
+        if (passwordHashPool)
+            values.append({Metrics::label("queue", "password_hashes"), passwordHashPool->getQueueDepth()});
+        if (gameExecutor)
+            values.append({Metrics::label("queue", "game_commands"), gameExecutor->getQueueDepth()});
+        if (smtpClient)
+            values.append({Metrics::label("queue", "mails"), smtpClient->getQueueDepth()});
+        return values;
+    });
+
+    metrics->addGauge("servatrice_memory_bytes", "Estimated memory held by the games, connections and rooms.",
+                      [this]() {
+                          Response_MemoryUsage usage;
+                          getMemoryUsage(usage, 0);
+                          Metrics::GaugeValues values;
+                          for (const auto &subsystem : usage.subsystem_list())
+                              values.append({Metrics::label("subsystem", QString::fromStdString(subsystem.name())),
+                                             static_cast<double>(subsystem.bytes())});
+                          return values;
+                      });
+
+    metrics->addGauge("servatrice_room_games", "Games hosted by this server, by room.", [this]() {
+        Metrics::GaugeValues values;
+        QReadLocker roomsLocker(&roomsLock);
+        for (Server_Room *room : getRooms()) {
+            QReadLocker gamesLocker(&room->gamesLock);
+            values.append({Metrics::label("room", room->getName()), room->getGames().size()});
+        }
+        return values;
+    });
+
+    metrics->addGauge("servatrice_game_mailbox_latency_seconds",
+                      "How long the last commands of a game waited for its game executor thread, by game.", [this]() {
+                          Metrics::GaugeValues values;
+                          if (!gameExecutor)
+                              return values;
+                          QReadLocker roomsLocker(&roomsLock);
+                          for (Server_Room *room : getRooms()) {
+                              QReadLocker gamesLocker(&room->gamesLock);
+                              for (Server_Game *game : room->getGames())
+                                  values.append({Metrics::label("game", QString::number(game->getGameId())),
+                                                 game->getLastMailboxLatency() / 1000000.0});
+                          }
+                          return values;
+                      });
+}
+
+bool Servatrice::startMetricsServer()
+{
+    registerMetricsGauges();
+
+    const int port = getMetricsPort();
+    if (port <= 0)
+        return true;
+
+    metricsServer = new MetricsServer(metrics, this);
+    qDebug() << "Starting metrics server on host" << getMetricsHost().toString() << "port" << port;
+    if (!metricsServer->listen(getMetricsHost(), static_cast<quint16>(port))) {
+        qDebug() << "metricsServer->listen(): Error:" << metricsServer->errorString();
+        return false;
+    }
+    return true;
 }
 
 void Servatrice::shutdownTimeout()
@@ -729,6 +1856,12 @@ bool Servatrice::islConnectionExists(int _serverId) const
     return islInterfaces.contains(_serverId);
 }
 
+bool Servatrice::isIslPeerConnected(int _serverId)
+{
+    QReadLocker locker(&islLock);
+    return islConnectionExists(_serverId);
+}
+
 void Servatrice::addIslInterface(int _serverId, IslInterface *interface)
 {
     // Only call with islLock locked for writing
@@ -748,6 +1881,8 @@ void Servatrice::addIslInterface(int _serverId, IslInterface *interface)
             SLOT(externalJoinGameCommandReceived(Command_JoinGame, int, int, int, qint64)));
     connect(interface, SIGNAL(gameCommandContainerReceived(CommandContainer, int, int, qint64)), this,
             SLOT(externalGameCommandContainerReceived(CommandContainer, int, int, qint64)));
+    connect(interface, SIGNAL(gameMigrationReceived(IslGameMigration, int)), this,
+            SLOT(externalGameMigrationReceived(IslGameMigration, int)));
     connect(interface, SIGNAL(responseReceived(Response, qint64)), this,
             SLOT(externalResponseReceived(Response, qint64)));
     connect(interface, SIGNAL(gameEventContainerReceived(GameEventContainer, qint64)), this,
@@ -777,16 +1912,58 @@ void Servatrice::doSendIslMessage(const IslMessage &msg, int _serverId)
     }
 }
 
+void Servatrice::invalidateCachedListEntry(const QString &list, const QString &whoseList, const QString &who)
+{
+    if (!databaseCache)
+        return;
+
+    databaseCache->removeListEntry(list, whoseList, who);
+
+    IslMessage msg;
+    msg.set_message_type(IslMessage::CACHE_INVALIDATION);
+    IslCacheInvalidation *invalidation = msg.mutable_cache_invalidation();
+    invalidation->set_list(list.toStdString());
+    invalidation->set_whose_list(whoseList.toStdString());
+    invalidation->set_user_name(who.toStdString());
+    emit sigSendIslMessage(msg, -1);
+}
+
+void Servatrice::invalidateCachedBans()
+{
+    if (!databaseCache)
+        return;
+
+    databaseCache->clearBanStates();
+
+    IslMessage msg;
+    msg.set_message_type(IslMessage::CACHE_INVALIDATION);
+    msg.mutable_cache_invalidation()->set_clear_bans(true);
+    emit sigSendIslMessage(msg, -1);
+}
+
+void Servatrice::processCacheInvalidation(const IslCacheInvalidation &invalidation)
+{
+    if (!databaseCache)
+        return;
+
+    if (invalidation.has_list())
+        databaseCache->removeListEntry(QString::fromStdString(invalidation.list()),
+                                       QString::fromStdString(invalidation.whose_list()),
+                                       QString::fromStdString(invalidation.user_name()));
+    if (invalidation.clear_bans())
+        databaseCache->clearBanStates();
+}
+
 // start helper functions
 
 int Servatrice::getMaxUserTotal() const
 {
-    return settingsCache->value("security/max_users_total", 500).toInt();
+    return settingsCache->config().maxUsersTotal;
 }
 
 bool Servatrice::getMaxUserLimitEnabled() const
 {
-    return settingsCache->value("security/enable_max_user_limit", false).toBool();
+    return settingsCache->config().enableMaxUserLimit;
 }
 
 QString Servatrice::getServerName() const
@@ -819,7 +1996,32 @@ QString Servatrice::getAuthenticationMethodString() const
 
 bool Servatrice::getStoreReplaysEnabled() const
 {
-    return settingsCache->value("game/store_replays", true).toBool();
+    return settingsCache->config().storeReplays;
+}
+
+QString Servatrice::getReplaySpoolDirectory() const
+{
+    return settingsCache->value("game/replay_spool_directory", "").toString();
+}
+
+QString Servatrice::getGameHibernationDirectory() const
+{
+    return settingsCache->value("game/hibernation_directory", "").toString();
+}
+
+int Servatrice::getGameHibernationTime() const
+{
+    return settingsCache->config().gameHibernationTime;
+}
+
+int Servatrice::getReplayQueueSize() const
+{
+    return settingsCache->value("game/replay_queue_size", 256).toInt();
+}
+
+int Servatrice::getReplayBatchSize() const
+{
+    return settingsCache->value("game/replay_batch_size", 32).toInt();
 }
 
 int Servatrice::getMaxTcpUserLimit() const
@@ -901,6 +2103,21 @@ QString Servatrice::getDBPasswordString() const
     return settingsCache->value("database/password").toString();
 }
 
+QString Servatrice::getDBReplicaHostNameString() const
+{
+    return settingsCache->value("database/replica_hostname").toString();
+}
+
+QString Servatrice::getDBReplicaUserNameString() const
+{
+    return settingsCache->value("database/replica_user", getDBUserNameString()).toString();
+}
+
+QString Servatrice::getDBReplicaPasswordString() const
+{
+    return settingsCache->value("database/replica_password", getDBPasswordString()).toString();
+}
+
 QString Servatrice::getRoomsMethodString() const
 {
     if (QProcessEnvironment::systemEnvironment().contains("DATABASE_URL")) {
@@ -911,52 +2128,123 @@ QString Servatrice::getRoomsMethodString() const
 
 int Servatrice::getMaxGameInactivityTime() const
 {
-    return settingsCache->value("game/max_game_inactivity_time", 120).toInt();
+    return settingsCache->config().maxGameInactivityTime;
+}
+
+int Servatrice::getPingVectorInterval() const
+{
+    return settingsCache->config().pingVectorInterval;
+}
+
+int Servatrice::getSpectatorStreamInterval() const
+{
+    return settingsCache->config().spectatorStreamInterval;
+}
+
+int Servatrice::getSpectatorStreamDelay() const
+{
+    return settingsCache->config().spectatorStreamDelay;
+}
+
+int Servatrice::getResumeLogLength() const
+{
+    return settingsCache->config().resumeLogLength;
+}
+
+int Servatrice::getGameListUpdateInterval() const
+{
+    return settingsCache->config().gameListUpdateInterval;
 }
 
 int Servatrice::getMaxPlayerInactivityTime() const
 {
-    return settingsCache->value("server/max_player_inactivity_time", 15).toInt();
+    return settingsCache->config().maxPlayerInactivityTime;
 }
 
 int Servatrice::getClientKeepAlive() const
 {
-    return settingsCache->value("server/clientkeepalive", 1).toInt();
+    return settingsCache->config().clientKeepAlive;
 }
 
 int Servatrice::getMaxUsersPerAddress() const
 {
-    return settingsCache->value("security/max_users_per_address", 4).toInt();
+    return settingsCache->config().maxUsersPerAddress;
+}
+
+int Servatrice::getCompressionThreshold() const
+{
+    return settingsCache->config().compressionThreshold;
+}
+
+qint64 Servatrice::getOutputQueueHighWatermark() const
+{
+    return settingsCache->config().outputQueueHighWatermark;
+}
+
+qint64 Servatrice::getOutputQueueLowWatermark() const
+{
+    return settingsCache->config().outputQueueLowWatermark;
+}
+
+qint64 Servatrice::getOutputQueueHardLimit() const
+{
+    return settingsCache->config().outputQueueHardLimit;
+}
+
+int Servatrice::getWebsocketMaxBatchSize() const
+{
+    return settingsCache->config().websocketMaxBatchSize;
+}
+
+int Servatrice::getTcpMaxBatchSize() const
+{
+    return settingsCache->config().tcpMaxBatchSize;
 }
 
 int Servatrice::getMessageCountingInterval() const
 {
-    return settingsCache->value("security/message_counting_interval", 10).toInt();
+    return settingsCache->config().messageCountingInterval;
 }
 
 int Servatrice::getMaxMessageCountPerInterval() const
 {
-    return settingsCache->value("security/max_message_count_per_interval", 15).toInt();
+    return settingsCache->config().maxMessageCountPerInterval;
 }
 
 int Servatrice::getMaxMessageSizePerInterval() const
 {
-    return settingsCache->value("security/max_message_size_per_interval", 1000).toInt();
+    return settingsCache->config().maxMessageSizePerInterval;
 }
 
 int Servatrice::getMaxGamesPerUser() const
 {
-    return settingsCache->value("security/max_games_per_user", 5).toInt();
+    return settingsCache->config().maxGamesPerUser;
 }
 
 int Servatrice::getCommandCountingInterval() const
 {
-    return settingsCache->value("security/command_counting_interval", 10).toInt();
+    return settingsCache->config().commandCountingInterval;
 }
 
 int Servatrice::getMaxCommandCountPerInterval() const
 {
-    return settingsCache->value("security/max_command_count_per_interval", 20).toInt();
+    return settingsCache->config().maxCommandCountPerInterval;
+}
+
+int Servatrice::getCommandTraceSampleRate() const
+{
+    return settingsCache->config().commandTraceSampleRate;
+}
+
+bool Servatrice::getBuddyOnlyPresenceEnabled() const
+{
+    return settingsCache->config().buddyOnlyPresence;
+}
+
+int Servatrice::getSlowCommandThreshold(int commandKey) const
+{
+    const ServatriceConfig &config = settingsCache->config();
+    return config.slowCommandThresholds.value(commandKey, config.slowCommandThreshold);
 }
 
 int Servatrice::getServerStatusUpdateTime() const
@@ -969,11 +2257,36 @@ int Servatrice::getNumberOfTCPPools() const
     return settingsCache->value("server/number_pools", 1).toInt();
 }
 
+bool Servatrice::getPerPoolListenersEnabled() const
+{
+    return settingsCache->value("server/per_pool_listeners", false).toBool();
+}
+
+int Servatrice::getPoolRebalanceInterval() const
+{
+    return settingsCache->value("server/pool_rebalance_interval", 30).toInt();
+}
+
 bool Servatrice::permitCreateGameAsJudge() const
 {
     return settingsCache->value("game/allow_create_as_judge", false).toBool();
 }
 
+int Servatrice::getMetricsPort() const
+{
+    return settingsCache->value("server/metrics_port", 0).toInt();
+}
+
+QHostAddress Servatrice::getMetricsHost() const
+{
+    return QHostAddress(settingsCache->value("server/metrics_host", "127.0.0.1").toString());
+}
+
+QString Servatrice::getHandoffSocketPath() const
+{
+    return settingsCache->value("server/handoff_socket", "").toString();
+}
+
 QHostAddress Servatrice::getServerTCPHost() const
 {
     QString host = settingsCache->value("server/host", "any").toString();
@@ -1030,9 +2343,14 @@ int Servatrice::getISLNetworkPort() const
     return settingsCache->value("servernetwork/port", 14747).toInt();
 }
 
+bool Servatrice::getGameMigrationEnabled() const
+{
+    return settingsCache->value("servernetwork/migrate_games", false).toBool();
+}
+
 int Servatrice::getIdleClientTimeout() const
 {
-    return settingsCache->value("server/idleclienttimeout", 3600).toInt();
+    return settingsCache->config().idleClientTimeout;
 }
 
 bool Servatrice::getEnableLogQuery() const
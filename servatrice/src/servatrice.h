@@ -22,6 +22,7 @@
 
 #include "server.h"
 
+#include <QHash>
 #include <QHostAddress>
 #include <QMetaType>
 #include <QMutex>
@@ -35,6 +36,8 @@
 
 Q_DECLARE_METATYPE(QSqlDatabase)
 
+class QDir;
+class QLocalServer;
 class QSqlQuery;
 class QTimer;
 
@@ -42,16 +45,65 @@ class GameReplay;
 class Servatrice;
 class Servatrice_ConnectionPool;
 class Servatrice_DatabaseInterface;
+class ChatLogWorker;
+class DatabaseCache;
+class IdBlockAllocator;
+class IslCacheInvalidation;
+class Metrics;
+class MetricsCounter;
+class MetricsHistogram;
+class GameExecutor;
+class MetricsServer;
+class PasswordHashPool;
+class ReplayPersistenceWorker;
+class Response_ActivityTop;
+class Response_MemoryUsage;
+class ServerHandoff;
+class SessionLogWorker;
 class AbstractServerSocketInterface;
 class IslInterface;
 class FeatureSet;
 
+/**
+ * Listening socket owned by a single connection pool thread. Used when per pool listeners are enabled: every pool
+ * binds its own socket to the server port with SO_REUSEPORT, the kernel distributes incoming connections between them
+ * and each pool accepts its connections without going through the main thread.
+ */
+class Servatrice_PoolListener : public QTcpServer
+{
+    Q_OBJECT
+private:
+    Servatrice *server;
+    Servatrice_ConnectionPool *pool;
+
+public:
+    Servatrice_PoolListener(Servatrice *_server, Servatrice_ConnectionPool *_pool)
+        : QTcpServer(), server(_server), pool(_pool)
+    {
+    }
+    Q_INVOKABLE bool listenOnDescriptor(int socketDescriptor);
+    Q_INVOKABLE void stopListening()
+    {
+        close();
+    }
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+};
+
 class Servatrice_GameServer : public QTcpServer
 {
     Q_OBJECT
 private:
     Servatrice *server;
     QList<Servatrice_ConnectionPool *> connectionPools;
+    QList<Servatrice_PoolListener *> poolListeners;
+    QTimer *rebalanceTimer;
+    // checks in a row that found the pools out of balance
+    int imbalancedChecks;
+
+private slots:
+    void rebalancePools();
 
 public:
     Servatrice_GameServer(Servatrice *_server,
@@ -59,10 +111,30 @@ public:
                           const QSqlDatabase &_sqlDatabase,
                           QObject *parent = nullptr);
     ~Servatrice_GameServer() override;
+    const QList<Servatrice_ConnectionPool *> &getConnectionPools() const
+    {
+        return connectionPools;
+    }
+    static bool perPoolListenersSupported();
+    bool listenPerPool(const QHostAddress &address, quint16 port);
+    bool hasListeners() const
+    {
+        return isListening() || !poolListeners.isEmpty();
+    }
+
+    // the hot restart, see Servatrice::handOver(): the listening sockets the new process takes along, ...
+    QList<int> getListenerDescriptors() const;
+    void closeListeners();
+    // ... and the other side; the listeners of a server that had one per pool are shared out between the pools
+    bool adoptListeners(QList<int> descriptors, bool perPool);
+    void adoptSession(int socketDescriptor, const QByteArray &serializedSession);
 
 protected:
     void incomingConnection(qintptr socketDescriptor) override;
     Servatrice_ConnectionPool *findLeastUsedConnectionPool();
+
+private:
+    bool addPoolListener(Servatrice_ConnectionPool *pool, int socketDescriptor);
 };
 
 class Servatrice_WebsocketGameServer : public QWebSocketServer
@@ -78,6 +150,10 @@ public:
                                    const QSqlDatabase &_sqlDatabase,
                                    QObject *parent = nullptr);
     ~Servatrice_WebsocketGameServer() override;
+    const QList<Servatrice_ConnectionPool *> &getConnectionPools() const
+    {
+        return connectionPools;
+    }
 
 protected:
     Servatrice_ConnectionPool *findLeastUsedConnectionPool();
@@ -141,6 +217,7 @@ public:
 private slots:
     void statusUpdate();
     void shutdownTimeout();
+    void handoffRequested();
 
 protected:
     void doSendIslMessage(const IslMessage &msg, int _serverId) override;
@@ -153,20 +230,33 @@ private:
     };
     AuthenticationMethod authenticationMethod;
     DatabaseType databaseType;
-    QTimer *pingClock, *statusUpdateClock;
+    QTimer *statusUpdateClock;
     Servatrice_GameServer *gameServer;
     Servatrice_WebsocketGameServer *websocketGameServer;
     Servatrice_IslServer *islServer;
+    // where a new process asks for the hot restart, see handOver()
+    QLocalServer *handoffServer;
     mutable QMutex loginMessageMutex;
     QString loginMessage;
     QString dbPrefix;
     QMap<QString, bool> serverRequiredFeatureList;
     QString officialWarnings;
     Servatrice_DatabaseInterface *servatriceDatabaseInterface;
+    ReplayPersistenceWorker *replayPersistenceWorker;
+    ChatLogWorker *chatLogWorker;
+    SessionLogWorker *sessionLogWorker;
+    DatabaseCache *databaseCache;
+    IdBlockAllocator *gameIdAllocator, *replayIdAllocator, *sessionIdAllocator;
+    PasswordHashPool *passwordHashPool;
+    GameExecutor *gameExecutor;
+    Metrics *metrics;
+    MetricsServer *metricsServer;
+    QHash<QString, MetricsHistogram *> commandDurations;
     int serverId;
     int uptime;
-    QMutex txBytesMutex, rxBytesMutex;
-    quint64 txBytes, rxBytes;
+    MetricsCounter *txBytes, *rxBytes;
+    // what the last status update reported, the uptime table wants the bytes per interval
+    quint64 reportedTxBytes, reportedRxBytes;
 
     QString shutdownReason;
     int shutdownMinutes;
@@ -179,34 +269,74 @@ private:
 
     QMap<int, IslInterface *> islInterfaces;
 
+    bool listenGameServer();
+    bool listenWebsocketGameServer();
+    bool listenIslServer();
+    void startHandoffServer();
+    /**
+     * The hot restart. The running server hands its listening sockets, games and sessions over to the new process
+     * on the handoff socket and quits without ending anything that goes on in the new process; see ServerHandoff.
+     */
+    void handOver(int channel);
+    bool handOverGamesAndSessions(int channel);
+    void waitForGameCommands();
+    bool takeOverRunningServer();
+    bool adoptListeners(const ServerHandoff &message, QList<int> &descriptors);
+    bool sendHandoff(int channel, const ServerHandoff &message, const QList<int> &descriptors = {});
+    void stopBackgroundWorkers();
+
+    void recoverSpooledReplays();
+    void recoverSpooledReplays(const QDir &dir);
+    void startReplayPersistenceWorker();
+    int getReplayQueueSize() const;
+    int getReplayBatchSize() const;
+    void startChatLogWorker();
+    void startSessionLogWorker();
+    void startGameExecutor();
+    void registerMetricsGauges();
+    bool startMetricsServer();
+
     QString getDBPrefixString() const;
     QString getDBHostNameString() const;
     QString getDBDatabaseNameString() const;
     QString getDBUserNameString() const;
     QString getDBPasswordString() const;
+    QString getDBReplicaHostNameString() const;
+    QString getDBReplicaUserNameString() const;
+    QString getDBReplicaPasswordString() const;
     QString getRoomsMethodString() const;
     QString getISLNetworkSSLCertFile() const;
     QString getISLNetworkSSLKeyFile() const;
     int getServerStatusUpdateTime() const;
     int getNumberOfTCPPools() const;
+    bool getPerPoolListenersEnabled() const;
+    int getPoolRebalanceInterval() const;
     int getServerTCPPort() const;
     int getNumberOfWebSocketPools() const;
     int getServerWebSocketPort() const;
     int getISLNetworkPort() const;
     bool getISLNetworkEnabled() const;
+    bool getGameMigrationEnabled() const override;
     bool getEnableInternalSMTPClient() const;
     QHostAddress getServerTCPHost() const;
     QHostAddress getServerWebSocketHost() const;
+    int getMetricsPort() const;
+    QHostAddress getMetricsHost() const;
+    QString getHandoffSocketPath() const;
 
 public slots:
     void scheduleShutdown(const QString &reason, int minutes);
+    // starts the timeline of the server threads, or stops it and writes it to a file, see TimelineTrace
+    void setTimelineTraceRunning(bool running);
+    void toggleTimelineTrace();
     void updateLoginMessage();
     void setRequiredFeatures(const QString &featureList);
 
 public:
     explicit Servatrice(QObject *parent = nullptr);
     ~Servatrice() override;
-    bool initServer();
+    // with takeOver, the server starts with the listeners, games and sessions of the one running, see handOver()
+    bool initServer(bool takeOver = false);
     QMap<QString, bool> getServerRequiredFeatureList() const override
     {
         return serverRequiredFeatureList;
@@ -224,6 +354,57 @@ public:
     {
         return dbPrefix;
     }
+    ReplayPersistenceWorker *getReplayPersistenceWorker() const
+    {
+        return replayPersistenceWorker;
+    }
+    ChatLogWorker *getChatLogWorker() const
+    {
+        return chatLogWorker;
+    }
+    SessionLogWorker *getSessionLogWorker() const
+    {
+        return sessionLogWorker;
+    }
+    DatabaseCache *getDatabaseCache() const
+    {
+        return databaseCache;
+    }
+    IdBlockAllocator *getGameIdAllocator() const
+    {
+        return gameIdAllocator;
+    }
+    IdBlockAllocator *getReplayIdAllocator() const
+    {
+        return replayIdAllocator;
+    }
+    IdBlockAllocator *getSessionIdAllocator() const
+    {
+        return sessionIdAllocator;
+    }
+    PasswordHashPool *getPasswordHashPool() const
+    {
+        return passwordHashPool;
+    }
+    GameExecutor *getGameExecutor() const override
+    {
+        return gameExecutor;
+    }
+    Metrics *getMetrics() const
+    {
+        return metrics;
+    }
+    // type is the kind of commands in the container as Server_ProtocolHandler::processCommandContainer tells them
+    // apart: "session", "game", "room", "moderator", "admin" or "invalid"
+    MetricsHistogram *getCommandDurationHistogram(const QString &type) const
+    {
+        return commandDurations.value(type);
+    }
+    MetricsHistogram *getPoolEventDelayHistogram(int poolNumber) const;
+    // drop the cached entries on this server and the other servers of the network
+    void invalidateCachedListEntry(const QString &list, const QString &whoseList, const QString &who);
+    void invalidateCachedBans();
+    void processCacheInvalidation(const IslCacheInvalidation &invalidation);
     QString getEmailBlackList() const;
     QString getEmailWhiteList() const;
     AuthenticationMethod getAuthenticationMethod() const
@@ -242,6 +423,9 @@ public:
     bool getRegOnlyServerEnabled() const override;
     bool getMaxUserLimitEnabled() const override;
     bool getStoreReplaysEnabled() const override;
+    QString getReplaySpoolDirectory() const override;
+    QString getGameHibernationDirectory() const override;
+    int getGameHibernationTime() const override;
     bool getRegistrationEnabled() const;
     bool getRequireEmailForRegistrationEnabled() const;
     bool getRequireEmailActivationEnabled() const;
@@ -255,15 +439,29 @@ public:
     int getIdleClientTimeout() const override;
     int getServerID() const override;
     int getMaxGameInactivityTime() const override;
+    int getPingVectorInterval() const override;
+    int getSpectatorStreamInterval() const override;
+    int getSpectatorStreamDelay() const override;
+    int getResumeLogLength() const override;
+    int getGameListUpdateInterval() const override;
     int getMaxPlayerInactivityTime() const override;
     int getClientKeepAlive() const override;
     int getMaxUsersPerAddress() const;
+    int getCompressionThreshold() const;
+    qint64 getOutputQueueHighWatermark() const;
+    qint64 getOutputQueueLowWatermark() const;
+    qint64 getOutputQueueHardLimit() const;
+    int getWebsocketMaxBatchSize() const;
+    int getTcpMaxBatchSize() const;
     int getMessageCountingInterval() const override;
     int getMaxMessageCountPerInterval() const override;
     int getMaxMessageSizePerInterval() const override;
     int getMaxGamesPerUser() const override;
     int getCommandCountingInterval() const override;
     int getMaxCommandCountPerInterval() const override;
+    int getCommandTraceSampleRate() const override;
+    bool getBuddyOnlyPresenceEnabled() const override;
+    int getSlowCommandThreshold(int commandKey) const override;
     int getMaxUserTotal() const override;
     bool permitCreateGameAsJudge() const override;
     int getMaxTcpUserLimit() const;
@@ -272,11 +470,19 @@ public:
     int getMaxAccountsPerEmail() const;
     int getForgotPasswordTokenLife() const;
     QList<AbstractServerSocketInterface *> getUsersWithAddressAsList(const QHostAddress &address) const;
+    /**
+     * Estimates the memory held by the games, connections, rooms and ISL peers from the sizes they keep track of,
+     * with the topCount largest of them. Doesn't need any lock, the metrics thread calls it as well.
+     */
+    void getMemoryUsage(Response_MemoryUsage &result, int topCount);
+    // the topCount busiest games and sessions by sortBy, a Command_GetActivityTop::SortKey
+    void getActivityTop(Response_ActivityTop &result, int topCount, int sortBy);
     void incTxBytes(quint64 num);
     void incRxBytes(quint64 num);
     void addDatabaseInterface(QThread *thread, Servatrice_DatabaseInterface *databaseInterface);
 
     bool islConnectionExists(int _serverId) const;
+    bool isIslPeerConnected(int _serverId) override;
     void addIslInterface(int _serverId, IslInterface *interface);
     void removeIslInterface(int _serverId);
     QReadWriteLock islLock;
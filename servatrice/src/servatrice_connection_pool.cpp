@@ -1,11 +1,22 @@
 #include "servatrice_connection_pool.h"
 
+#include "metrics.h"
 #include "servatrice_database_interface.h"
 
+#include <QAbstractEventDispatcher>
 #include <QThread>
+#include <QTimer>
 
-Servatrice_ConnectionPool::Servatrice_ConnectionPool(Servatrice_DatabaseInterface *_databaseInterface)
-    : databaseInterface(_databaseInterface), threaded(false), clientCount(0)
+static const int eventDelayProbeInterval = 1000;
+// pools this close in utilization (per mille) count as equally loaded
+static const int utilizationMargin = 50;
+// a pool whose events wait longer than this (microseconds) only gets new connections if all pools are that slow
+static const qint64 eventDelayLimit = 50000;
+
+Servatrice_ConnectionPool::Servatrice_ConnectionPool(Servatrice_DatabaseInterface *_databaseInterface,
+                                                     MetricsHistogram *_eventDelay)
+    : databaseInterface(_databaseInterface), threaded(false), clientCount(0), eventDelay(_eventDelay),
+      eventDelayProbe(nullptr), utilization(0), lastEventDelay(0), busyTime(0), busy(false), migrationQuota(0)
 {
 }
 
@@ -14,3 +25,103 @@ Servatrice_ConnectionPool::~Servatrice_ConnectionPool()
     delete databaseInterface;
     thread()->quit();
 }
+
+void Servatrice_ConnectionPool::startEventDelayProbe()
+{
+    eventDelayProbe = new QTimer(this);
+    eventDelayProbe->setTimerType(Qt::PreciseTimer);
+    connect(eventDelayProbe, &QTimer::timeout, this, &Servatrice_ConnectionPool::probeEventDelay);
+    eventDelayProbe->start(eventDelayProbeInterval);
+    sinceLastProbe.start();
+
+    // the event loop of the thread is busy from waking up until it is about to block again
+    QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance(thread());
+    connect(dispatcher, &QAbstractEventDispatcher::awake, this, &Servatrice_ConnectionPool::eventLoopAwake);
+    connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, this,
+            &Servatrice_ConnectionPool::eventLoopAboutToBlock);
+    busy = true;
+    busySince.start();
+}
+
+void Servatrice_ConnectionPool::eventLoopAwake()
+{
+    if (busy)
+        return;
+    busy = true;
+    busySince.start();
+}
+
+void Servatrice_ConnectionPool::eventLoopAboutToBlock()
+{
+    if (!busy)
+        return;
+    busy = false;
+    busyTime += busySince.nsecsElapsed();
+}
+
+void Servatrice_ConnectionPool::probeEventDelay()
+{
+    const qint64 elapsed = sinceLastProbe.nsecsElapsed();
+    sinceLastProbe.start();
+    const qint64 delay = elapsed / 1000 - eventDelayProbeInterval * 1000;
+    eventDelay->observe(delay);
+    lastEventDelay.store(delay, std::memory_order_relaxed);
+
+    // the probe itself runs while the event loop is busy
+    if (busy) {
+        busyTime += busySince.nsecsElapsed();
+        busySince.start();
+    }
+    const int sample = elapsed > 0 ? static_cast<int>(qMin<qint64>(busyTime * 1000 / elapsed, 1000)) : 0;
+    busyTime = 0;
+    utilization.store((utilization.load(std::memory_order_relaxed) * 3 + sample) / 4, std::memory_order_relaxed);
+}
+
+static bool lessLoaded(const Servatrice_ConnectionPool *pool, const Servatrice_ConnectionPool *other)
+{
+    const bool poolSlow = pool->getEventDelay() > eventDelayLimit;
+    if (poolSlow != (other->getEventDelay() > eventDelayLimit))
+        return !poolSlow;
+    if (qAbs(pool->getUtilization() - other->getUtilization()) > utilizationMargin)
+        return pool->getUtilization() < other->getUtilization();
+    return pool->getClientCount() < other->getClientCount();
+}
+
+Servatrice_ConnectionPool *Servatrice_ConnectionPool::findLeastLoaded(const QList<Servatrice_ConnectionPool *> &pools)
+{
+    Servatrice_ConnectionPool *leastLoaded = nullptr;
+    for (Servatrice_ConnectionPool *pool : pools)
+        if (!leastLoaded || lessLoaded(pool, leastLoaded))
+            leastLoaded = pool;
+    return leastLoaded;
+}
+
+void Servatrice_ConnectionPool::migrateIdleClients(QObject *target, int count)
+{
+    migrationQuota = count;
+    emit idleClientsWanted(static_cast<Servatrice_ConnectionPool *>(target));
+    migrationQuota = 0;
+}
+
+void Servatrice_ConnectionPool::pauseClientInput()
+{
+    emit clientInputPauseWanted();
+}
+
+void Servatrice_ConnectionPool::dropUnmovableClients()
+{
+    emit unmovableClientsDropWanted();
+}
+
+void Servatrice_ConnectionPool::handOffClients(void *sessions)
+{
+    emit clientHandoffWanted(sessions);
+}
+
+bool Servatrice_ConnectionPool::takeMigrationSlot()
+{
+    if (migrationQuota <= 0)
+        return false;
+    --migrationQuota;
+    return true;
+}
@@ -1,23 +1,59 @@
 #ifndef SERVATRICE_CONNECTION_POOL_H
 #define SERVATRICE_CONNECTION_POOL_H
 
-#include <QMutex>
-#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QList>
 #include <QObject>
+#include <atomic>
 
+class MetricsHistogram;
+class QTimer;
 class Servatrice_DatabaseInterface;
 
+/**
+ * One thread serving connections. Besides counting them, the pool measures how loaded its thread is: the share of
+ * time its event loop spends handling events instead of waiting (the utilization) and how late a timer fires (the
+ * event delay). New connections go to the least loaded pool, and the idle connections of a pool that stays much
+ * busier than another are moved over, see Servatrice_GameServer::rebalancePools().
+ */
 class Servatrice_ConnectionPool : public QObject
 {
     Q_OBJECT
 private:
     Servatrice_DatabaseInterface *databaseInterface;
     bool threaded;
-    mutable QMutex clientCountMutex;
-    int clientCount;
+    std::atomic<int> clientCount;
+
+    // how late a timer in the pool thread fires tells how long events wait in the queue of the pool
+    MetricsHistogram *eventDelay;
+    QTimer *eventDelayProbe;
+    QElapsedTimer sinceLastProbe;
+    // in per mille, smoothed over the last few probes
+    std::atomic<int> utilization;
+    // of the last probe, in microseconds
+    std::atomic<qint64> lastEventDelay;
+    // time spent handling events since the last probe, in nanoseconds
+    qint64 busyTime;
+    QElapsedTimer busySince;
+    bool busy;
+    // how many more connections may move during migrateIdleClients()
+    int migrationQuota;
+
+private slots:
+    void probeEventDelay();
+    void eventLoopAwake();
+    void eventLoopAboutToBlock();
+
+signals:
+    // emitted in the pool thread, the connections of the pool that are idle move to target while there is quota left
+    void idleClientsWanted(Servatrice_ConnectionPool *target);
+    // emitted in the pool thread during a hot restart, in this order, see Servatrice::handOver()
+    void clientInputPauseWanted();
+    void unmovableClientsDropWanted();
+    void clientHandoffWanted(void *sessions);
 
 public:
-    explicit Servatrice_ConnectionPool(Servatrice_DatabaseInterface *_databaseInterface);
+    Servatrice_ConnectionPool(Servatrice_DatabaseInterface *_databaseInterface, MetricsHistogram *_eventDelay);
     ~Servatrice_ConnectionPool() override;
 
     Servatrice_DatabaseInterface *getDatabaseInterface() const
@@ -27,20 +63,44 @@ public:
 
     int getClientCount() const
     {
-        QMutexLocker locker(&clientCountMutex);
-        return clientCount;
+        return clientCount.load(std::memory_order_relaxed);
+    }
+    int getUtilization() const
+    {
+        return utilization.load(std::memory_order_relaxed);
+    }
+    qint64 getEventDelay() const
+    {
+        return lastEventDelay.load(std::memory_order_relaxed);
     }
+    /**
+     * The pool for a new connection. Pools whose events wait too long are avoided, then the least utilized pool is
+     * picked, with the connection count deciding between pools of about the same utilization.
+     */
+    static Servatrice_ConnectionPool *findLeastLoaded(const QList<Servatrice_ConnectionPool *> &pools);
+    // called by a connection answering idleClientsWanted(), true if it may move
+    bool takeMigrationSlot();
     void addClient()
     {
-        QMutexLocker locker(&clientCountMutex);
-        ++clientCount;
+        clientCount.fetch_add(1, std::memory_order_relaxed);
     }
 public slots:
     void removeClient()
     {
-        QMutexLocker locker(&clientCountMutex);
-        --clientCount;
+        clientCount.fetch_sub(1, std::memory_order_relaxed);
     }
+    // has to run in the pool thread
+    void startEventDelayProbe();
+    // asks up to count idle connections to move to target, which has to be a Servatrice_ConnectionPool
+    void migrateIdleClients(QObject *target, int count);
+    /**
+     * The steps of a hot restart, each has to run in the pool thread: the connections stop reading, those that can't
+     * be carried over to the new process are closed, then the others describe themselves to sessions, a
+     * QList<QPair<int, QByteArray>> of socket descriptors and serialized HandoffSessions.
+     */
+    void pauseClientInput();
+    void dropUnmovableClients();
+    void handOffClients(void *sessions);
 };
 
 #endif
@@ -1,29 +1,41 @@
 #include "servatrice_database_interface.h"
 
+#include "avatar_hash.h"
+#include "chat_log_worker.h"
+#include "database_cache.h"
 #include "decklist.h"
+#include "game_replay_writer.h"
+#include "id_block_allocator.h"
+#include "metrics.h"
 #include "passwordhasher.h"
-#include "pb/game_replay.pb.h"
+#include "replay_compression.h"
+#include "replay_persistence_worker.h"
 #include "servatrice.h"
 #include "serversocketinterface.h"
+#include "session_log_worker.h"
 #include "settingscache.h"
+#include "timeline_trace.h"
 
 #include <QChar>
 #include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QSqlError>
 #include <QSqlQuery>
 
+// how long the primary is used instead after the replica failed, in milliseconds
+static const int replicaRetryInterval = 60000;
+
 Servatrice_DatabaseInterface::Servatrice_DatabaseInterface(int _instanceId, Servatrice *_server)
-    : instanceId(_instanceId), sqlDatabase(QSqlDatabase()), server(_server)
+    : instanceId(_instanceId), sqlDatabase(QSqlDatabase()), statements(), replicaStatements(), server(_server)
 {
 }
 
 Servatrice_DatabaseInterface::~Servatrice_DatabaseInterface()
 {
-    // reset all prepared statements
-    qDeleteAll(preparedStatements);
-    preparedStatements.clear();
+    qDeleteAll(statementStates.keys());
 
+    replicaDatabase.close();
     sqlDatabase.close();
 }
 
@@ -32,6 +44,14 @@ void Servatrice_DatabaseInterface::initDatabase(const QSqlDatabase &_sqlDatabase
     if (_sqlDatabase.isValid()) {
         sqlDatabase = QSqlDatabase::cloneDatabase(_sqlDatabase, "pool_" + QString::number(instanceId));
         openDatabase();
+
+        const QString replicaHostName = server->getDBReplicaHostNameString();
+        if (!replicaHostName.isEmpty()) {
+            replicaDatabase = QSqlDatabase::cloneDatabase(_sqlDatabase, "replica_" + QString::number(instanceId));
+            replicaDatabase.setHostName(replicaHostName);
+            replicaDatabase.setUserName(server->getDBReplicaUserNameString());
+            replicaDatabase.setPassword(server->getDBReplicaPasswordString());
+        }
     }
 }
 
@@ -50,28 +70,45 @@ bool Servatrice_DatabaseInterface::initDatabase(const QString &type,
     return openDatabase();
 }
 
+QString Servatrice_DatabaseInterface::getConnectionLabel() const
+{
+    if (instanceId == -1)
+        return "main";
+    if (instanceId == ReplayWorkerInstanceId)
+        return "replays";
+    if (instanceId == ChatLogWorkerInstanceId)
+        return "chat log";
+    if (instanceId == SessionLogWorkerInstanceId)
+        return "session log";
+    if (instanceId <= GameExecutorInstanceIdBase)
+        return QString("game executor %1").arg(GameExecutorInstanceIdBase - instanceId);
+    return QString("pool %1").arg(instanceId);
+}
+
 bool Servatrice_DatabaseInterface::openDatabase()
 {
     if (sqlDatabase.isOpen())
         sqlDatabase.close();
 
-    const QString poolStr = instanceId == -1 ? QString("main") : QString("pool %1").arg(instanceId);
+    const QString poolStr = getConnectionLabel();
     qDebug().noquote() << QString("[%1] Opening database...").arg(poolStr);
     if (!sqlDatabase.open()) {
         qCritical() << QString("[%1] Error opening database: %2").arg(poolStr).arg(sqlDatabase.lastError().text());
         return false;
     }
 
-    QSqlQuery *versionQuery = prepareQuery("select version from {prefix}_schema_version limit 1");
-    if (!execSqlQuery(versionQuery)) {
+    // not a prepared statement, a failing execSqlQuery() would reopen the connection from in here
+    QSqlQuery versionQuery(sqlDatabase);
+    if (!versionQuery.exec(QString(databaseStatementText(DatabaseStatement::SchemaVersion))
+                               .replace("{prefix}", server->getDbPrefix()))) {
         qCritical() << QString("[%1] Error opening database: unable to load database schema version (hint: ensure the "
                                "cockatrice_schema_version exists)")
                            .arg(poolStr);
         return false;
     }
 
-    if (versionQuery->next()) {
-        const int dbversion = versionQuery->value(0).toInt();
+    if (versionQuery.next()) {
+        const int dbversion = versionQuery.value(0).toInt();
         const int expectedversion = DATABASE_SCHEMA_VERSION;
         if (dbversion < expectedversion) {
             qCritical() << QString("[%1] Error opening database: the database schema version is too old, you need to "
@@ -95,12 +132,60 @@ bool Servatrice_DatabaseInterface::openDatabase()
         return false;
     }
 
-    // reset all prepared statements
-    qDeleteAll(preparedStatements);
-    preparedStatements.clear();
+    prepareStatementsAgain();
+    return true;
+}
+
+void Servatrice_DatabaseInterface::prepareStatementsAgain(bool onReplica)
+{
+    // the statements were prepared on the connection that is gone
+    int prepared = 0, failed = 0;
+    for (auto it = statementStates.constBegin(); it != statementStates.constEnd(); ++it) {
+        if (it->onReplica != onReplica)
+            continue;
+        *it.key() = QSqlQuery(onReplica ? replicaDatabase : sqlDatabase);
+        ++prepared;
+        if (!it.key()->prepare(it->text))
+            ++failed;
+    }
+    if (prepared == 0)
+        return;
+    qDebug().noquote() << QString("[%1] Prepared %2 statements again%3, %4 failed")
+                              .arg(getConnectionLabel())
+                              .arg(prepared)
+                              .arg(onReplica ? " on the replica" : "")
+                              .arg(failed);
+}
+
+bool Servatrice_DatabaseInterface::replicaAvailable()
+{
+    if (!replicaDatabase.isValid())
+        return false;
+    if (replicaDatabase.isOpen())
+        return true;
+    if (replicaFailedSince.isValid() && !replicaFailedSince.hasExpired(replicaRetryInterval))
+        return false;
+
+    qDebug().noquote() << QString("[%1] Opening replica database...").arg(getConnectionLabel());
+    if (!replicaDatabase.open()) {
+        replicaFailed(replicaDatabase.lastError().text());
+        return false;
+    }
+    replicaFailedSince.invalidate();
+    prepareStatementsAgain(true);
     return true;
 }
 
+void Servatrice_DatabaseInterface::replicaFailed(const QString &error)
+{
+    qCritical() << QString("[%1] Error on the replica database: %2, using the primary for %3 seconds")
+                       .arg(getConnectionLabel())
+                       .arg(error)
+                       .arg(replicaRetryInterval / 1000);
+    replicaDatabase.close();
+    replicaFailedSince.start();
+}
+
 bool Servatrice_DatabaseInterface::checkSql()
 {
     if (!sqlDatabase.isValid()) {
@@ -113,7 +198,7 @@ bool Servatrice_DatabaseInterface::checkSql()
     }
 
     if (query.lastError().isValid()) {
-        const auto &poolStr = instanceId == -1 ? QString("main") : QString("pool %1").arg(instanceId);
+        const auto &poolStr = getConnectionLabel();
         qCritical() << QString("[%1] Error executing query: %2, resetting connection")
                            .arg(poolStr)
                            .arg(query.lastError().text());
@@ -125,26 +210,85 @@ bool Servatrice_DatabaseInterface::checkSql()
     return true;
 }
 
+QSqlQuery *Servatrice_DatabaseInterface::prepareQuery(DatabaseStatement statement)
+{
+    QSqlQuery *&query = statements[static_cast<int>(statement)];
+    if (!query)
+        query = newStatement(databaseStatementText(statement), databaseStatementName(statement));
+    return query;
+}
+
 QSqlQuery *Servatrice_DatabaseInterface::prepareQuery(const QString &queryText)
 {
-    if (preparedStatements.contains(queryText)) {
-        return preparedStatements.value(queryText);
-    }
+    QSqlQuery *&query = preparedStatements[queryText];
+    if (!query)
+        query = newStatement(queryText, queryText.simplified());
+    return query;
+}
 
+QSqlQuery *Servatrice_DatabaseInterface::prepareReplicaQuery(DatabaseStatement statement)
+{
+    if (!replicaAvailable())
+        return prepareQuery(statement);
+
+    QSqlQuery *&query = replicaStatements[static_cast<int>(statement)];
+    if (!query)
+        query = newStatement(databaseStatementText(statement), databaseStatementName(statement), true);
+    return query;
+}
+
+QSqlQuery *Servatrice_DatabaseInterface::prepareReplicaQuery(const QString &queryText)
+{
+    if (!replicaAvailable())
+        return prepareQuery(queryText);
+
+    QSqlQuery *&query = preparedReplicaStatements[queryText];
+    if (!query)
+        query = newStatement(queryText, queryText.simplified(), true);
+    return query;
+}
+
+QSqlQuery *Servatrice_DatabaseInterface::newStatement(const QString &queryText, const QString &label, bool onReplica)
+{
     QString prefixedQueryText = queryText;
     prefixedQueryText.replace("{prefix}", server->getDbPrefix());
-    auto *query = new QSqlQuery(sqlDatabase);
+    auto *query = new QSqlQuery(onReplica ? replicaDatabase : sqlDatabase);
     query->prepare(prefixedQueryText);
 
-    preparedStatements.insert(queryText, query);
+    Metrics *metrics = server->getMetrics();
+    QString labels = Metrics::label("statement", label);
+    if (onReplica)
+        labels += "," + Metrics::label("database", "replica");
+    statementStates.insert(query, {prefixedQueryText, label,
+                                   metrics->histogram("servatrice_database_query_duration_seconds",
+                                                      "Time spent executing a prepared statement.", labels),
+                                   metrics->counter("servatrice_database_query_failures_total",
+                                                    "Executions of a prepared statement that failed.", labels),
+                                   onReplica});
     return query;
 }
 
 bool Servatrice_DatabaseInterface::execSqlQuery(QSqlQuery *query)
 {
-    if (query->exec())
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 timelineStart = TimelineTrace::now();
+    const bool success = query->exec();
+    const auto state = statementStates.constFind(query);
+    TimelineTrace::record(TimelineTrace::Database, "query", timelineStart,
+                          state != statementStates.constEnd() ? state->label : QString());
+    if (state != statementStates.constEnd())
+        state->duration->observe(timer.nsecsElapsed() / 1000);
+    if (success)
         return true;
-    const QString poolStr = instanceId == -1 ? QString("main") : QString("pool %1").arg(instanceId);
+    if (state != statementStates.constEnd())
+        state->failures->add();
+    // the primary is fine, the next queries go there until the replica is tried again
+    if (state != statementStates.constEnd() && state->onReplica) {
+        replicaFailed(query->lastError().text());
+        return false;
+    }
+    const QString poolStr = getConnectionLabel();
     qCritical() << QString("[%1] Error executing query: %2").arg(poolStr).arg(query->lastError().text());
     sqlDatabase.close();
     openDatabase();
@@ -240,13 +384,7 @@ bool Servatrice_DatabaseInterface::registerUser(const QString &userName,
     }
     QString token = active ? QString() : PasswordHasher::generateActivationToken();
 
-    QSqlQuery *query =
-        prepareQuery("insert into {prefix}_users "
-                     "(name, realname, password_sha512, email, country, registrationDate, active, token, "
-                     "admin, avatar_bmp, clientid, privlevel, privlevelStartDate, privlevelEndDate) "
-                     "values "
-                     "(:userName, :realName, :password_sha512, :email, :country, UTC_TIMESTAMP(), :active, "
-                     ":token, 0, '', '', 'NONE', UTC_TIMESTAMP(), UTC_TIMESTAMP())");
+    QSqlQuery *query = prepareQuery(DatabaseStatement::RegisterUser);
     query->bindValue(":userName", userName);
     query->bindValue(":realName", realName);
     query->bindValue(":password_sha512", passwordSha512);
@@ -268,8 +406,7 @@ bool Servatrice_DatabaseInterface::activateUser(const QString &userName, const Q
     if (!checkSql())
         return false;
 
-    QSqlQuery *activateQuery =
-        prepareQuery("select name from {prefix}_users where active=0 and name=:username and token=:token");
+    QSqlQuery *activateQuery = prepareQuery(DatabaseStatement::SelectInactiveUserWithToken);
 
     activateQuery->bindValue(":username", userName);
     activateQuery->bindValue(":token", token);
@@ -284,7 +421,7 @@ bool Servatrice_DatabaseInterface::activateUser(const QString &userName, const Q
         // redundant check
         if (name == userName) {
 
-            QSqlQuery *query = prepareQuery("update {prefix}_users set active=1 where name = :userName");
+            QSqlQuery *query = prepareQuery(DatabaseStatement::ActivateUser);
             query->bindValue(":userName", userName);
 
             if (!execSqlQuery(query)) {
@@ -326,8 +463,7 @@ AuthenticationResult Servatrice_DatabaseInterface::checkUserPassword(Server_Prot
             if (checkUserIsBanned(handler->getAddress(), user, clientId, reasonStr, banSecondsLeft))
                 return UserIsBanned;
 
-            QSqlQuery *passwordQuery =
-                prepareQuery("select password_sha512, active from {prefix}_users where name = :name");
+            QSqlQuery *passwordQuery = prepareQuery(DatabaseStatement::SelectPasswordAndActive);
             passwordQuery->bindValue(":name", user);
             if (!execSqlQuery(passwordQuery)) {
                 qDebug("Login denied: SQL error");
@@ -343,7 +479,12 @@ AuthenticationResult Servatrice_DatabaseInterface::checkUserPassword(Server_Prot
                 }
                 QString hashedPassword;
                 if (passwordNeedsHash) {
-                    hashedPassword = PasswordHasher::computeHash(password, correctPasswordSha512.left(16));
+                    const QString salt = correctPasswordSha512.left(16);
+                    auto *socketInterface = qobject_cast<AbstractServerSocketInterface *>(handler);
+                    if (socketInterface)
+                        hashedPassword = socketInterface->takePrecomputedPasswordHash(password, salt);
+                    if (hashedPassword.isEmpty())
+                        hashedPassword = PasswordHasher::computeHash(password, salt);
                 } else {
                     hashedPassword = password;
                 }
@@ -377,111 +518,63 @@ bool Servatrice_DatabaseInterface::checkUserIsBanned(const QString &ipAddress,
         return false;
     }
 
-    return checkUserIsIpBanned(ipAddress, banReason, banSecondsRemaining) ||
-           checkUserIsNameBanned(userName, banReason, banSecondsRemaining) ||
-           checkUserIsIdBanned(clientId, banReason, banSecondsRemaining);
-}
-
-bool Servatrice_DatabaseInterface::checkUserIsIdBanned(const QString &clientId,
-                                                       QString &banReason,
-                                                       int &banSecondsRemaining)
-{
-    if (clientId.isEmpty())
-        return false;
-
-    QSqlQuery *idBanQuery =
-        prepareQuery("select"
-                     " timestampdiff(second, now(), date_add(b.time_from, interval b.minutes minute)),"
-                     " b.minutes <=> 0,"
-                     " b.visible_reason"
-                     " from {prefix}_bans b"
-                     " where"
-                     " b.time_from = (select max(c.time_from)"
-                     " from {prefix}_bans c"
-                     " where c.clientid = :id)"
-                     " and b.clientid = :id2");
-
-    idBanQuery->bindValue(":id", clientId);
-    idBanQuery->bindValue(":id2", clientId);
-    if (!execSqlQuery(idBanQuery)) {
-        qDebug() << "Id ban check failed: SQL error." << idBanQuery->lastError();
-        return false;
-    }
-
-    if (idBanQuery->next()) {
-        const int secondsLeft = idBanQuery->value(0).toInt();
-        const bool permanentBan = idBanQuery->value(1).toInt();
-        if ((secondsLeft > 0) || permanentBan) {
-            banReason = idBanQuery->value(2).toString();
-            banSecondsRemaining = permanentBan ? 0 : secondsLeft;
-            qDebug() << "User is banned by client id" << clientId;
-            return true;
-        }
-    }
-    return false;
-}
-
-bool Servatrice_DatabaseInterface::checkUserIsNameBanned(const QString &userName,
-                                                         QString &banReason,
-                                                         int &banSecondsRemaining)
-{
-    QSqlQuery *nameBanQuery =
-        prepareQuery("select timestampdiff(second, now(), date_add(b.time_from, interval b.minutes minute)), b.minutes "
-                     "<=> 0, b.visible_reason from {prefix}_bans b where b.time_from = (select max(c.time_from) from "
-                     "{prefix}_bans c where c.user_name = :name2) and b.user_name = :name1");
-    nameBanQuery->bindValue(":name1", userName);
-    nameBanQuery->bindValue(":name2", userName);
-    if (!execSqlQuery(nameBanQuery)) {
-        qDebug() << "Name ban check failed: SQL error" << nameBanQuery->lastError();
-        return false;
-    }
-
-    if (nameBanQuery->next()) {
-        const int secondsLeft = nameBanQuery->value(0).toInt();
-        const bool permanentBan = nameBanQuery->value(1).toInt();
-        if ((secondsLeft > 0) || permanentBan) {
-            banReason = nameBanQuery->value(2).toString();
-            banSecondsRemaining = permanentBan ? 0 : secondsLeft;
-            qDebug() << "Username" << userName << "is banned by name";
-            return true;
-        }
+    DatabaseCache *cache = server->getDatabaseCache();
+    DatabaseCache::BanState banState;
+    if (cache && cache->findBanState(ipAddress, userName, clientId, banState)) {
+        if (!banState.banned)
+            return false;
+        banReason = banState.reason;
+        banSecondsRemaining = banState.bannedUntil.isValid()
+                                  ? static_cast<int>(QDateTime::currentDateTimeUtc().secsTo(banState.bannedUntil))
+                                  : 0;
+        return true;
     }
-    return false;
-}
 
-bool Servatrice_DatabaseInterface::checkUserIsIpBanned(const QString &ipAddress,
-                                                       QString &banReason,
-                                                       int &banSecondsRemaining)
-{
-    QSqlQuery *ipBanQuery =
-        prepareQuery("select"
-                     " timestampdiff(second, now(), date_add(b.time_from, interval b.minutes minute)),"
-                     " b.minutes <=> 0,"
-                     " b.visible_reason"
-                     " from {prefix}_bans b"
-                     " where"
-                     " b.time_from = (select max(c.time_from)"
-                     " from {prefix}_bans c"
-                     " where c.ip_address = :address)"
-                     " and b.ip_address = :address2");
-
-    ipBanQuery->bindValue(":address", ipAddress);
-    ipBanQuery->bindValue(":address2", ipAddress);
-    if (!execSqlQuery(ipBanQuery)) {
-        qDebug() << "IP ban check failed: SQL error." << ipBanQuery->lastError();
+    // The latest ban on the address, the name and the client id are looked up in one round trip. They are
+    // checked in that order, the first one still in effect decides the ban reason and duration.
+    QSqlQuery *banQuery = prepareQuery(DatabaseStatement::SelectLatestBans);
+    banQuery->bindValue(":address", ipAddress);
+    banQuery->bindValue(":address2", ipAddress);
+    banQuery->bindValue(":name", userName);
+    banQuery->bindValue(":name2", userName);
+    banQuery->bindValue(":id", clientId);
+    banQuery->bindValue(":id2", clientId);
+    banQuery->bindValue(":id3", clientId);
+    if (!execSqlQuery(banQuery)) {
+        qDebug() << "Ban check failed: SQL error." << banQuery->lastError();
         return false;
     }
 
-    if (ipBanQuery->next()) {
-        const int secondsLeft = ipBanQuery->value(0).toInt();
-        const bool permanentBan = ipBanQuery->value(1).toInt();
+    banState.banned = false;
+    while (banQuery->next()) {
+        const int secondsLeft = banQuery->value(1).toInt();
+        const bool permanentBan = banQuery->value(2).toInt();
         if ((secondsLeft > 0) || permanentBan) {
-            banReason = ipBanQuery->value(2).toString();
+            banReason = banQuery->value(3).toString();
             banSecondsRemaining = permanentBan ? 0 : secondsLeft;
-            qDebug() << "User is banned by address" << ipAddress;
+            if (cache) {
+                banState.banned = true;
+                banState.reason = banReason;
+                if (!permanentBan)
+                    banState.bannedUntil = QDateTime::currentDateTimeUtc().addSecs(secondsLeft);
+                cache->insertBanState(ipAddress, userName, clientId, banState);
+            }
+            switch (banQuery->value(0).toInt()) {
+                case 0:
+                    qDebug() << "User is banned by address" << ipAddress;
+                    break;
+                case 1:
+                    qDebug() << "Username" << userName << "is banned by name";
+                    break;
+                default:
+                    qDebug() << "User is banned by client id" << clientId;
+                    break;
+            }
             return true;
         }
     }
+    if (cache)
+        cache->insertBanState(ipAddress, userName, clientId, banState);
     return false;
 }
 
@@ -490,7 +583,7 @@ bool Servatrice_DatabaseInterface::activeUserExists(const QString &user)
     if (server->getAuthenticationMethod() == Servatrice::AuthenticationSql) {
         checkSql();
 
-        QSqlQuery *query = prepareQuery("select 1 from {prefix}_users where name = :name and active = 1");
+        QSqlQuery *query = prepareQuery(DatabaseStatement::ActiveUserExists);
         query->bindValue(":name", user);
         if (!execSqlQuery(query))
             return false;
@@ -504,7 +597,13 @@ bool Servatrice_DatabaseInterface::userExists(const QString &user)
     if (server->getAuthenticationMethod() == Servatrice::AuthenticationSql) {
         checkSql();
 
-        QSqlQuery *query = prepareQuery("select 1 from {prefix}_users where name = :name");
+        // a cached id means the user is known, whether it's active or not is irrelevant here
+        int userId;
+        DatabaseCache *cache = server->getDatabaseCache();
+        if (cache && cache->findUserId(user, userId))
+            return true;
+
+        QSqlQuery *query = prepareQuery(DatabaseStatement::UserExists);
         query->bindValue(":name", user);
         if (!execSqlQuery(query))
             return false;
@@ -518,8 +617,7 @@ QString Servatrice_DatabaseInterface::getUserSalt(const QString &user)
     if (server->getAuthenticationMethod() == Servatrice::AuthenticationSql) {
         checkSql();
 
-        QSqlQuery *query =
-            prepareQuery("SELECT SUBSTRING(password_sha512, 1, 16) FROM {prefix}_users WHERE name = :name");
+        QSqlQuery *query = prepareQuery(DatabaseStatement::SelectUserSalt);
 
         query->bindValue(":name", user);
         if (!execSqlQuery(query)) {
@@ -538,18 +636,27 @@ QString Servatrice_DatabaseInterface::getUserSalt(const QString &user)
 int Servatrice_DatabaseInterface::getUserIdInDB(const QString &name)
 {
     if (server->getAuthenticationMethod() == Servatrice::AuthenticationSql) {
-        QSqlQuery *query = prepareQuery("select id from {prefix}_users where name = :name and active = 1");
+        // only ids of existing users are cached, a name that is unknown now may be registered any time
+        DatabaseCache *cache = server->getDatabaseCache();
+        int userId;
+        if (cache && cache->findUserId(name, userId))
+            return userId;
+
+        QSqlQuery *query = prepareQuery(DatabaseStatement::SelectActiveUserId);
         query->bindValue(":name", name);
         if (!execSqlQuery(query))
             return -1;
         if (!query->next())
             return -1;
-        return query->value(0).toInt();
+        userId = query->value(0).toInt();
+        if (cache)
+            cache->insertUserId(name, userId);
+        return userId;
     }
     return -1;
 }
 
-bool Servatrice_DatabaseInterface::isInBuddyList(const QString &whoseList, const QString &who)
+bool Servatrice_DatabaseInterface::isInList(const QString &list, const QString &whoseList, const QString &who)
 {
     if (server->getAuthenticationMethod() == Servatrice::AuthenticationNone)
         return false;
@@ -557,36 +664,34 @@ bool Servatrice_DatabaseInterface::isInBuddyList(const QString &whoseList, const
     if (!checkSql())
         return false;
 
+    DatabaseCache *cache = server->getDatabaseCache();
+    bool isListed;
+    if (cache && cache->findListEntry(list, whoseList, who, isListed))
+        return isListed;
+
     int id1 = getUserIdInDB(whoseList);
     int id2 = getUserIdInDB(who);
 
     QSqlQuery *query =
-        prepareQuery("select 1 from {prefix}_buddylist where id_user1 = :id_user1 and id_user2 = :id_user2");
+        prepareQuery("select 1 from {prefix}_" + list + "list where id_user1 = :id_user1 and id_user2 = :id_user2");
     query->bindValue(":id_user1", id1);
     query->bindValue(":id_user2", id2);
     if (!execSqlQuery(query))
         return false;
-    return query->next();
+    isListed = query->next();
+    if (cache)
+        cache->insertListEntry(list, whoseList, who, isListed);
+    return isListed;
 }
 
-bool Servatrice_DatabaseInterface::isInIgnoreList(const QString &whoseList, const QString &who)
+bool Servatrice_DatabaseInterface::isInBuddyList(const QString &whoseList, const QString &who)
 {
-    if (server->getAuthenticationMethod() == Servatrice::AuthenticationNone)
-        return false;
-
-    if (!checkSql())
-        return false;
-
-    int id1 = getUserIdInDB(whoseList);
-    int id2 = getUserIdInDB(who);
+    return isInList("buddy", whoseList, who);
+}
 
-    QSqlQuery *query =
-        prepareQuery("select 1 from {prefix}_ignorelist where id_user1 = :id_user1 and id_user2 = :id_user2");
-    query->bindValue(":id_user1", id1);
-    query->bindValue(":id_user2", id2);
-    if (!execSqlQuery(query))
-        return false;
-    return query->next();
+bool Servatrice_DatabaseInterface::isInIgnoreList(const QString &whoseList, const QString &who)
+{
+    return isInList("ignore", whoseList, who);
 }
 
 ServerInfo_User Servatrice_DatabaseInterface::evalUserQueryResult(const QSqlQuery *query, bool complete, bool withId)
@@ -632,8 +737,10 @@ ServerInfo_User Servatrice_DatabaseInterface::evalUserQueryResult(const QSqlQuer
             result.set_real_name(realName.toStdString());
 
         const QByteArray avatarBmp = query->value(8).toByteArray();
-        if (avatarBmp.size())
+        if (avatarBmp.size()) {
             result.set_avatar_bmp(avatarBmp.data(), avatarBmp.size());
+            AvatarHash::updateHash(result);
+        }
 
         const QDateTime regDate = query->value(9).toDateTime();
         if (!regDate.toString(Qt::ISODate).isEmpty()) {
@@ -663,10 +770,7 @@ ServerInfo_User Servatrice_DatabaseInterface::getUserData(const QString &name, b
         if (!checkSql())
             return result;
 
-        QSqlQuery *query = prepareQuery("select id, name, admin, country, privlevel, leftPawnColorOverride, "
-                                        "rightPawnColorOverride, realname, avatar_bmp, registrationDate, "
-                                        "email, clientid from {prefix}_users where "
-                                        "name = :name and active = 1");
+        QSqlQuery *query = prepareQuery(DatabaseStatement::SelectUserData);
         query->bindValue(":name", name);
         if (!execSqlQuery(query))
             return result;
@@ -681,38 +785,9 @@ ServerInfo_User Servatrice_DatabaseInterface::getUserData(const QString &name, b
 
 void Servatrice_DatabaseInterface::clearSessionTables()
 {
-    lockSessionTables();
-    QSqlQuery *query =
-        prepareQuery("update {prefix}_sessions set end_time=now() where end_time is null and id_server = :id_server");
+    QSqlQuery *query = prepareQuery(DatabaseStatement::EndServerSessions);
     query->bindValue(":id_server", server->getServerID());
     execSqlQuery(query);
-    unlockSessionTables();
-}
-
-void Servatrice_DatabaseInterface::lockSessionTables()
-{
-    QSqlQuery *query = prepareQuery("lock tables {prefix}_sessions write, {prefix}_users read");
-    execSqlQuery(query);
-}
-
-void Servatrice_DatabaseInterface::unlockSessionTables()
-{
-    QSqlQuery *query = prepareQuery("unlock tables");
-    execSqlQuery(query);
-}
-
-bool Servatrice_DatabaseInterface::userSessionExists(const QString &userName)
-{
-    // Call only after lockSessionTables().
-
-    QSqlQuery *query = prepareQuery(
-        "select 1 from {prefix}_sessions where user_name = :user_name and id_server = :id_server and end_time is null");
-    query->bindValue(":id_server", server->getServerID());
-    query->bindValue(":user_name", userName);
-    if (!execSqlQuery(query)) {
-        return false;
-    };
-    return query->next();
 }
 
 qint64 Servatrice_DatabaseInterface::startSession(const QString &userName,
@@ -723,33 +798,92 @@ qint64 Servatrice_DatabaseInterface::startSession(const QString &userName,
     if (server->getAuthenticationMethod() == Servatrice::AuthenticationNone)
         return -1;
 
-    if (!checkSql())
+    if (!sqlDatabase.isValid() || !server->getSessionIdAllocator())
         return -1;
 
-    QSqlQuery *query = prepareQuery("insert into {prefix}_sessions (user_name, id_server, ip_address, start_time, "
-                                    "clientid, connection_type) values(:user_name, :id_server, :ip_address, NOW(), "
-                                    ":client_id, :connection_type)");
-    query->bindValue(":user_name", userName);
-    query->bindValue(":id_server", server->getServerID());
-    query->bindValue(":ip_address", address);
-    query->bindValue(":client_id", clientId);
-    query->bindValue(":connection_type", connectionType);
-    if (execSqlQuery(query))
-        return query->lastInsertId().toInt();
-    return -1;
+    LoggedSession session;
+    session.id = server->getSessionIdAllocator()->next(
+        [this](int blockSize) { return reserveIdBlock("sessions", blockSize); });
+    if (session.id < 0)
+        return -1;
+    session.userName = userName;
+    session.address = address;
+    session.clientId = clientId;
+    session.connectionType = connectionType;
+    session.startTime = QDateTime::currentDateTime();
+
+    // the users of the server tell who is logged in, the row is only written behind
+    SessionLogWorker *worker = server->getSessionLogWorker();
+    if (!(worker && worker->enqueue(session)) && checkSql())
+        storeLoggedSessions({session});
+    return session.id;
 }
 
 void Servatrice_DatabaseInterface::endSession(qint64 sessionId)
 {
-    if (server->getAuthenticationMethod() == Servatrice::AuthenticationNone)
+    if (server->getAuthenticationMethod() == Servatrice::AuthenticationNone || sessionId < 1)
         return;
 
-    if (!checkSql())
+    LoggedSession session;
+    session.id = sessionId;
+    session.endTime = QDateTime::currentDateTime();
+
+    SessionLogWorker *worker = server->getSessionLogWorker();
+    if (worker && worker->enqueue(session))
         return;
 
-    auto *query = prepareQuery("update {prefix}_sessions set end_time=NOW() where id = :id_session");
-    query->bindValue(":id_session", sessionId);
-    execSqlQuery(query);
+    if (checkSql())
+        storeLoggedSessions({session});
+}
+
+bool Servatrice_DatabaseInterface::storeLoggedSessions(const QList<LoggedSession> &sessions)
+{
+    // the sessions that end in the same batch they start in are inserted as ended
+    QList<LoggedSession> starts;
+    QHash<qint64, int> startIndexes;
+    QVariantList endIds, endTimes;
+    for (const LoggedSession &session : sessions) {
+        if (session.startTime.isValid()) {
+            startIndexes.insert(session.id, starts.size());
+            starts.append(session);
+        } else if (startIndexes.contains(session.id)) {
+            starts[startIndexes.value(session.id)].endTime = session.endTime;
+        } else {
+            endIds.append(session.id);
+            endTimes.append(session.endTime);
+        }
+    }
+
+    QVariantList rows;
+    rows.reserve(starts.size() * 8);
+    const int serverId = server->getServerID();
+    for (const LoggedSession &session : starts) {
+        rows << session.id << session.userName << serverId << session.address << session.startTime
+             << (session.endTime.isValid() ? QVariant(session.endTime) : QVariant()) << session.clientId
+             << session.connectionType;
+    }
+
+    sqlDatabase.transaction();
+    if (!rows.isEmpty() &&
+        !execMultiRowInsert("insert into {prefix}_sessions (id, user_name, id_server, ip_address, start_time, "
+                            "end_time, clientid, connection_type)",
+                            8, rows)) {
+        sqlDatabase.rollback();
+        return false;
+    }
+    if (!endIds.isEmpty()) {
+        QSqlQuery *query = prepareQuery(DatabaseStatement::EndSession);
+        query->bindValue(":end_time", endTimes);
+        query->bindValue(":id_session", endIds);
+        if (!query->execBatch()) {
+            qCritical() << QString("[%1] Error storing session ends: %2")
+                               .arg(getConnectionLabel())
+                               .arg(query->lastError().text());
+            sqlDatabase.rollback();
+            return false;
+        }
+    }
+    return sqlDatabase.commit();
 }
 
 QMap<QString, ServerInfo_User> Servatrice_DatabaseInterface::getBuddyList(const QString &name)
@@ -759,10 +893,7 @@ QMap<QString, ServerInfo_User> Servatrice_DatabaseInterface::getBuddyList(const
     if (server->getAuthenticationMethod() == Servatrice::AuthenticationSql) {
         checkSql();
 
-        QSqlQuery *query = prepareQuery("select a.id, a.name, a.admin, a.country, a.privlevel, "
-                                        "a.leftPawnColorOverride, a.rightPawnColorOverride from {prefix}_users a "
-                                        "left join {prefix}_buddylist b on a.id = b.id_user2 left join {prefix}_users "
-                                        "c on b.id_user1 = c.id where c.name = :name");
+        QSqlQuery *query = prepareQuery(DatabaseStatement::SelectBuddyList);
         query->bindValue(":name", name);
         if (!execSqlQuery(query))
             return result;
@@ -782,10 +913,7 @@ QMap<QString, ServerInfo_User> Servatrice_DatabaseInterface::getIgnoreList(const
     if (server->getAuthenticationMethod() == Servatrice::AuthenticationSql) {
         checkSql();
 
-        QSqlQuery *query = prepareQuery("select a.id, a.name, a.admin, a.country, a.privlevel, "
-                                        "a.leftPawnColorOverride, a.rightPawnColorOverride from {prefix}_users a "
-                                        "left join {prefix}_ignorelist b on a.id = b.id_user2 left join {prefix}_users "
-                                        "c on b.id_user1 = c.id where c.name = :name");
+        QSqlQuery *query = prepareQuery(DatabaseStatement::SelectIgnoreList);
         query->bindValue(":name", name);
         if (!execSqlQuery(query))
             return result;
@@ -798,35 +926,64 @@ QMap<QString, ServerInfo_User> Servatrice_DatabaseInterface::getIgnoreList(const
     return result;
 }
 
+void Servatrice_DatabaseInterface::getBuddyAndIgnoreLists(const QString &name,
+                                                         QMap<QString, ServerInfo_User> &buddyList,
+                                                         QMap<QString, ServerInfo_User> &ignoreList)
+{
+    if (server->getAuthenticationMethod() != Servatrice::AuthenticationSql)
+        return;
+
+    checkSql();
+
+    QSqlQuery *query = prepareQuery(DatabaseStatement::SelectBuddyAndIgnoreLists);
+    query->bindValue(":name", name);
+    query->bindValue(":name2", name);
+    if (!execSqlQuery(query))
+        return;
+
+    while (query->next()) {
+        const ServerInfo_User &temp = evalUserQueryResult(query, false);
+        QMap<QString, ServerInfo_User> &list = query->value(7).toInt() == 0 ? buddyList : ignoreList;
+        list.insert(QString::fromStdString(temp.name()), temp);
+    }
+}
+
 int Servatrice_DatabaseInterface::getNextGameId()
 {
     if (!sqlDatabase.isValid())
         return server->getNextLocalGameId();
 
-    if (!checkSql())
-        return -1;
-
-    QSqlQuery *query = prepareQuery("insert into {prefix}_games (time_started) values (now())");
+    return (int)server->getGameIdAllocator()->next(
+        [this](int blockSize) { return reserveIdBlock("games", blockSize); });
+}
 
-    if (!execSqlQuery(query)) {
+int Servatrice_DatabaseInterface::getNextReplayId()
+{
+    if (!sqlDatabase.isValid())
         return -1;
-    }
 
-    return query->lastInsertId().toInt();
+    return (int)server->getReplayIdAllocator()->next(
+        [this](int blockSize) { return reserveIdBlock("replays", blockSize); });
 }
 
-int Servatrice_DatabaseInterface::getNextReplayId()
+qint64 Servatrice_DatabaseInterface::reserveIdBlock(const QString &sequence, int blockSize)
 {
     if (!checkSql())
         return -1;
 
-    QSqlQuery *query = prepareQuery("insert into {prefix}_replays (id_game) values (NULL)");
-
-    if (!execSqlQuery(query)) {
+    // last_insert_id(expr) hands the new value back to this connection only, so the one update both moves the
+    // sequence past the block and tells where the block ends, also with other servers reserving at the same time
+    QSqlQuery *query = prepareQuery(DatabaseStatement::ReserveIdBlock);
+    query->bindValue(":block_size", blockSize);
+    query->bindValue(":name", sequence);
+    if (!execSqlQuery(query))
+        return -1;
+    if (query->numRowsAffected() != 1) {
+        qCritical() << QString("[%1] The id sequence %2 is missing").arg(getConnectionLabel(), sequence);
         return -1;
     }
 
-    return query->lastInsertId().toInt();
+    return query->lastInsertId().toLongLong() - blockSize;
 }
 
 void Servatrice_DatabaseInterface::storeGameInformation(const QString &roomName,
@@ -834,105 +991,223 @@ void Servatrice_DatabaseInterface::storeGameInformation(const QString &roomName,
                                                         const ServerInfo_Game &gameInfo,
                                                         const QSet<QString> &allPlayersEver,
                                                         const QSet<QString> &allSpectatorsEver,
-                                                        const QList<GameReplay *> &replayList)
+                                                        const QList<GameReplayWriter *> &replayList)
 {
-    if (!checkSql())
+    if (!sqlDatabase.isValid())
         return;
 
-    if (!settingsCache->value("game/store_replays", 1).toBool())
+    if (!settingsCache->config().storeReplays)
         return;
 
-    QVariantList gameIds1, playerNames, gameIds2, userIds, replayNames;
-    QSetIterator<QString> playerIterator(allPlayersEver);
-    while (playerIterator.hasNext()) {
-        gameIds1.append(gameInfo.game_id());
-        const QString &playerName = playerIterator.next();
-        playerNames.append(playerName);
-    }
-    QSet<QString> allUsersInGame = allPlayersEver + allSpectatorsEver;
-    QSetIterator<QString> allUsersIterator(allUsersInGame);
-    while (allUsersIterator.hasNext()) {
-        int id = getUserIdInDB(allUsersIterator.next());
-        if (id == -1)
-            continue;
-        gameIds2.append(gameInfo.game_id());
-        userIds.append(id);
-        replayNames.append(QString::fromStdString(gameInfo.description()));
+    FinishedGame game;
+    game.roomName = roomName;
+    game.roomGameTypes = roomGameTypes;
+    game.gameInfo = gameInfo;
+    game.allPlayersEver = allPlayersEver;
+    game.allSpectatorsEver = allSpectatorsEver;
+    for (GameReplayWriter *replay : replayList)
+        game.replays.append({replay->getReplayId(), replay->getDurationSeconds(), replay->serialize()});
+
+    ReplayPersistenceWorker *worker = server->getReplayPersistenceWorker();
+    if (worker && worker->enqueue(game))
+        return;
+
+    // Without a worker, or with its queue full, the game is stored right away on this connection rather than
+    // dropped or queued without bound.
+    if (!checkSql())
+        return;
+    storeFinishedGames({game});
+}
+
+QHash<QString, int> Servatrice_DatabaseInterface::getUserIdsInDB(const QSet<QString> &names)
+{
+    // keyed by the lower case name, the comparison in the database ignores case
+    QHash<QString, int> result;
+    if (server->getAuthenticationMethod() != Servatrice::AuthenticationSql || names.isEmpty())
+        return result;
+
+    const QStringList nameList = names.values();
+    const int maxNamesPerQuery = 500;
+    for (int first = 0; first < nameList.size(); first += maxNamesPerQuery) {
+        const int count = qMin(maxNamesPerQuery, nameList.size() - first);
+        QStringList placeholders;
+        for (int i = 0; i < count; ++i)
+            placeholders.append("?");
+
+        // not a cached prepared statement, the text depends on the number of names
+        QSqlQuery query(sqlDatabase);
+        query.prepare(QString("select id, name from %1_users where active = 1 and name in (%2)")
+                          .arg(server->getDbPrefix(), placeholders.join(", ")));
+        for (int i = first; i < first + count; ++i)
+            query.addBindValue(nameList[i]);
+        if (!execSqlQuery(&query))
+            return result;
+        while (query.next())
+            result.insert(query.value(1).toString().toLower(), query.value(0).toInt());
+    }
+    return result;
+}
+
+bool Servatrice_DatabaseInterface::execMultiRowInsert(const QString &insertText,
+                                                      int columnCount,
+                                                      const QVariantList &values)
+{
+    QStringList columnPlaceholders;
+    for (int i = 0; i < columnCount; ++i)
+        columnPlaceholders.append("?");
+    const QString rowPlaceholder = "(" + columnPlaceholders.join(", ") + ")";
+
+    // stay well below the limit on the number of placeholders in one statement
+    const int maxRowsPerStatement = 1000;
+    const int rowCount = values.size() / columnCount;
+    for (int firstRow = 0; firstRow < rowCount; firstRow += maxRowsPerStatement) {
+        const int rows = qMin(maxRowsPerStatement, rowCount - firstRow);
+        QStringList rowPlaceholders;
+        for (int i = 0; i < rows; ++i)
+            rowPlaceholders.append(rowPlaceholder);
+
+        QSqlQuery query(sqlDatabase);
+        query.prepare(QString(insertText).replace("{prefix}", server->getDbPrefix()) + " values " +
+                      rowPlaceholders.join(", "));
+        for (int i = firstRow * columnCount; i < (firstRow + rows) * columnCount; ++i)
+            query.addBindValue(values[i]);
+        if (!execSqlQuery(&query))
+            return false;
     }
+    return true;
+}
+
+bool Servatrice_DatabaseInterface::storeFinishedGames(const QList<FinishedGame> &games)
+{
+    QSet<QString> allUsers;
+    for (const FinishedGame &game : games)
+        allUsers += game.allPlayersEver + game.allSpectatorsEver;
+    const QHash<QString, int> userIds = getUserIdsInDB(allUsers);
 
+    QVariantList gameIds, roomNames, descriptions, creatorNames, passwords, gameTypes, playerCounts, timesStarted;
+    QVariantList playerRows, accessRows;
     QVariantList replayIds, replayGameIds, replayDurations, replayBlobs;
-    for (int i = 0; i < replayList.size(); ++i) {
-        QByteArray blob;
-#if GOOGLE_PROTOBUF_VERSION > 3001000
-        const unsigned int size = static_cast<unsigned int>(replayList[i]->ByteSizeLong());
-#else
-        const unsigned int size = static_cast<unsigned int>(replayList[i]->ByteSize());
-#endif
-        blob.resize(size);
-        replayList[i]->SerializeToArray(blob.data(), size);
+    const bool compressReplays = settingsCache->config().compressReplays;
+    for (const FinishedGame &game : games) {
+        const ServerInfo_Game &gameInfo = game.gameInfo;
+        const QString description = QString::fromStdString(gameInfo.description());
+
+        gameIds.append(gameInfo.game_id());
+        roomNames.append(game.roomName);
+        descriptions.append(description);
+        creatorNames.append(QString::fromStdString(gameInfo.creator_info().name()));
+        passwords.append(gameInfo.with_password() ? 1 : 0);
+        gameTypes.append(game.roomGameTypes.isEmpty() ? QString("") : game.roomGameTypes.join(", "));
+        playerCounts.append(gameInfo.max_players());
+        timesStarted.append(QDateTime::fromSecsSinceEpoch(gameInfo.start_time()));
+
+        for (const QString &playerName : game.allPlayersEver)
+            playerRows << gameInfo.game_id() << playerName;
+
+        for (const QString &userName : game.allPlayersEver + game.allSpectatorsEver) {
+            const int id = userIds.value(userName.toLower(), -1);
+            if (id == -1)
+                continue;
+            accessRows << gameInfo.game_id() << id << description;
+        }
 
-        replayIds.append(QVariant((qulonglong)replayList[i]->replay_id()));
-        replayGameIds.append(gameInfo.game_id());
-        replayDurations.append(replayList[i]->duration_seconds());
-        replayBlobs.append(blob);
+        for (const FinishedGame::Replay &replay : game.replays) {
+            replayIds.append(QVariant((qulonglong)replay.replayId));
+            replayGameIds.append(gameInfo.game_id());
+            replayDurations.append(replay.durationSeconds);
+            replayBlobs.append(compressReplays ? ReplayCompression::compress(replay.data) : replay.data);
+        }
     }
 
+    sqlDatabase.transaction();
     {
-        QSqlQuery *query = prepareQuery("update {prefix}_games set room_name=:room_name, descr=:descr, "
-                                        "creator_name=:creator_name, password=:password, game_types=:game_types, "
-                                        "player_count=:player_count, time_finished=now() where id=:id_game");
-        query->bindValue(":room_name", roomName);
-        query->bindValue(":id_game", gameInfo.game_id());
-        query->bindValue(":descr", QString::fromStdString(gameInfo.description()));
-        query->bindValue(":creator_name", QString::fromStdString(gameInfo.creator_info().name()));
-        query->bindValue(":password", gameInfo.with_password() ? 1 : 0);
-        query->bindValue(":game_types", roomGameTypes.isEmpty() ? QString("") : roomGameTypes.join(", "));
-        query->bindValue(":player_count", gameInfo.max_players());
-        if (!execSqlQuery(query))
-            return;
+        QSqlQuery *query = prepareQuery(DatabaseStatement::InsertFinishedGame);
+        query->bindValue(":room_name", roomNames);
+        query->bindValue(":id_game", gameIds);
+        query->bindValue(":descr", descriptions);
+        query->bindValue(":creator_name", creatorNames);
+        query->bindValue(":password", passwords);
+        query->bindValue(":game_types", gameTypes);
+        query->bindValue(":player_count", playerCounts);
+        query->bindValue(":time_started", timesStarted);
+        if (!query->execBatch()) {
+            qCritical() << QString("[%1] Error storing games: %2")
+                               .arg(getConnectionLabel())
+                               .arg(query->lastError().text());
+            sqlDatabase.rollback();
+            return false;
+        }
     }
-    {
-        QSqlQuery *query =
-            prepareQuery("insert into {prefix}_games_players (id_game, player_name) values (:id_game, :player_name)");
-        query->bindValue(":id_game", gameIds1);
-        query->bindValue(":player_name", playerNames);
-        query->execBatch();
+    if (!execMultiRowInsert("insert into {prefix}_games_players (id_game, player_name)", 2, playerRows)) {
+        sqlDatabase.rollback();
+        return false;
     }
-    {
-        QSqlQuery *query = prepareQuery(
-            "update {prefix}_replays set id_game=:id_game, duration=:duration, replay=:replay where id=:id_replay");
+    if (!replayIds.isEmpty()) {
+        QSqlQuery *query = prepareQuery(DatabaseStatement::InsertReplay);
         query->bindValue(":id_replay", replayIds);
         query->bindValue(":id_game", replayGameIds);
         query->bindValue(":duration", replayDurations);
         query->bindValue(":replay", replayBlobs);
-        query->execBatch();
+        if (!query->execBatch()) {
+            qCritical() << QString("[%1] Error storing replays: %2")
+                               .arg(getConnectionLabel())
+                               .arg(query->lastError().text());
+            sqlDatabase.rollback();
+            return false;
+        }
     }
-    {
-        QSqlQuery *query = prepareQuery("insert into {prefix}_replays_access (id_game, id_player, replay_name) values "
-                                        "(:id_game, :id_player, :replay_name)");
-        query->bindValue(":id_game", gameIds2);
-        query->bindValue(":id_player", userIds);
-        query->bindValue(":replay_name", replayNames);
-        query->execBatch();
+    if (!execMultiRowInsert("insert into {prefix}_replays_access (id_game, id_player, replay_name)", 3, accessRows)) {
+        sqlDatabase.rollback();
+        return false;
+    }
+    return sqlDatabase.commit();
+}
+
+bool Servatrice_DatabaseInterface::storeRecoveredReplay(qint64 replayId,
+                                                        const ServerInfo_Game &gameInfo,
+                                                        int durationSeconds,
+                                                        const QByteArray &replay)
+{
+    if (!checkSql())
+        return false;
+
+    sqlDatabase.transaction();
+    QSqlQuery *query = prepareQuery(DatabaseStatement::InsertRecoveredGame);
+    query->bindValue(":id_game", gameInfo.game_id());
+    query->bindValue(":descr", QString::fromStdString(gameInfo.description()));
+    query->bindValue(":creator_name", QString::fromStdString(gameInfo.creator_info().name()));
+    query->bindValue(":password", gameInfo.with_password() ? 1 : 0);
+    query->bindValue(":player_count", gameInfo.max_players());
+    query->bindValue(":time_started", QDateTime::fromSecsSinceEpoch(gameInfo.start_time()));
+    if (!execSqlQuery(query)) {
+        sqlDatabase.rollback();
+        return false;
+    }
+
+    query = prepareQuery(DatabaseStatement::InsertReplay);
+    query->bindValue(":id_replay", QVariant((qulonglong)replayId));
+    query->bindValue(":id_game", gameInfo.game_id());
+    query->bindValue(":duration", durationSeconds);
+    query->bindValue(":replay", settingsCache->config().compressReplays ? ReplayCompression::compress(replay) : replay);
+    if (!execSqlQuery(query)) {
+        sqlDatabase.rollback();
+        return false;
     }
+    return sqlDatabase.commit();
 }
 
 DeckList *Servatrice_DatabaseInterface::getDeckFromDatabase(int deckId, int userId)
 {
     checkSql();
 
-    QSqlQuery *query =
-        prepareQuery("select content from {prefix}_decklist_files where id = :id and id_user = :id_user");
+    QSqlQuery *query = prepareQuery(DatabaseStatement::SelectDeckContent);
     query->bindValue(":id", deckId);
     query->bindValue(":id_user", userId);
     execSqlQuery(query);
     if (!query->next())
         throw Response::RespNameNotFound;
 
-    DeckList *deck = new DeckList;
-    deck->loadFromString_Native(query->value(0).toString());
-
-    return deck;
+    return server->getDeckListCache().load(query->value(0).toString());
 }
 
 void Servatrice_DatabaseInterface::logMessage(const int senderId,
@@ -943,25 +1218,26 @@ void Servatrice_DatabaseInterface::logMessage(const int senderId,
                                               const int targetId,
                                               const QString &targetName)
 {
+    const ServatriceConfig &config = settingsCache->config();
     QString targetTypeString;
     switch (targetType) {
         case MessageTargetRoom:
-            if (!settingsCache->value("logging/log_user_msg_room", 0).toBool())
+            if (!config.logUserMessagesInRooms)
                 return;
             targetTypeString = "room";
             break;
         case MessageTargetGame:
-            if (!settingsCache->value("logging/log_user_msg_game", 0).toBool())
+            if (!config.logUserMessagesInGames)
                 return;
             targetTypeString = "game";
             break;
         case MessageTargetChat:
-            if (!settingsCache->value("logging/log_user_msg_chat", 0).toBool())
+            if (!config.logUserMessagesInChats)
                 return;
             targetTypeString = "chat";
             break;
         case MessageTargetIslRoom:
-            if (!settingsCache->value("logging/log_user_msg_isl", 0).toBool())
+            if (!config.logUserMessagesFromIsl)
                 return;
             targetTypeString = "room";
             break;
@@ -969,17 +1245,35 @@ void Servatrice_DatabaseInterface::logMessage(const int senderId,
             return;
     }
 
-    QSqlQuery *query = prepareQuery("insert into {prefix}_log (log_time, sender_id, sender_name, sender_ip, "
-                                    "log_message, target_type, target_id, target_name) values (now(), :sender_id, "
-                                    ":sender_name, :sender_ip, :log_message, :target_type, :target_id, :target_name)");
-    query->bindValue(":sender_id", senderId < 1 ? QVariant() : senderId);
-    query->bindValue(":sender_name", senderName);
-    query->bindValue(":sender_ip", senderIp);
-    query->bindValue(":log_message", logMessage);
-    query->bindValue(":target_type", targetTypeString);
-    query->bindValue(":target_id", (targetType == MessageTargetChat && targetId < 1) ? QVariant() : targetId);
-    query->bindValue(":target_name", targetName);
-    execSqlQuery(query);
+    LoggedMessage message;
+    message.time = QDateTime::currentDateTime();
+    message.senderId = senderId < 1 ? QVariant() : senderId;
+    message.senderName = senderName;
+    message.senderIp = senderIp;
+    message.message = logMessage;
+    message.targetType = targetTypeString;
+    message.targetId = (targetType == MessageTargetChat && targetId < 1) ? QVariant() : targetId;
+    message.targetName = targetName;
+
+    // written behind by the chat log worker, unless there is none or its queue is full
+    ChatLogWorker *worker = server->getChatLogWorker();
+    if (worker && worker->enqueue(message))
+        return;
+
+    storeLoggedMessages({message});
+}
+
+bool Servatrice_DatabaseInterface::storeLoggedMessages(const QList<LoggedMessage> &messages)
+{
+    QVariantList rows;
+    rows.reserve(messages.size() * 8);
+    for (const LoggedMessage &message : messages) {
+        rows << message.time << message.senderId << message.senderName << message.senderIp << message.message
+             << message.targetType << message.targetId << message.targetName;
+    }
+    return execMultiRowInsert("insert into {prefix}_log (log_time, sender_id, sender_name, sender_ip, log_message, "
+                              "target_type, target_id, target_name)",
+                              8, rows);
 }
 
 bool Servatrice_DatabaseInterface::changeUserPassword(const QString &user,
@@ -991,8 +1285,7 @@ bool Servatrice_DatabaseInterface::changeUserPassword(const QString &user,
         passwordSha512 = PasswordHasher::computeHash(password, PasswordHasher::generateRandomSalt());
     }
 
-    QSqlQuery *passwordQuery = prepareQuery("update {prefix}_users set password_sha512=:password, "
-                                            "passwordLastChangedDate = NOW() where name = :name");
+    QSqlQuery *passwordQuery = prepareQuery(DatabaseStatement::UpdatePassword);
     passwordQuery->bindValue(":password", passwordSha512);
     passwordQuery->bindValue(":name", user);
     if (execSqlQuery(passwordQuery))
@@ -1017,7 +1310,7 @@ bool Servatrice_DatabaseInterface::changeUserPassword(const QString &user,
     if (!usernameIsValid(user, error))
         return false;
 
-    QSqlQuery *passwordQuery = prepareQuery("select password_sha512 from {prefix}_users where name = :name");
+    QSqlQuery *passwordQuery = prepareQuery(DatabaseStatement::SelectPassword);
     passwordQuery->bindValue(":name", user);
 
     if (!execSqlQuery(passwordQuery)) {
@@ -1071,7 +1364,7 @@ void Servatrice_DatabaseInterface::updateUsersClientID(const QString &userName,
     if (!checkSql())
         return;
 
-    QSqlQuery *query = prepareQuery("update {prefix}_users set clientid = :clientid where name = :username");
+    QSqlQuery *query = prepareQuery(DatabaseStatement::UpdateClientId);
     query->bindValue(":clientid", userClientID);
     query->bindValue(":username", userName);
     execSqlQuery(query);
@@ -1083,44 +1376,13 @@ void Servatrice_DatabaseInterface::updateUsersLastLoginData(const QString &userN
     if (!checkSql())
         return;
 
-    int usersID = 0;
-
-    QSqlQuery *query = prepareQuery("select id from {prefix}_users where name = :user_name");
+    // looks up the user id and inserts or updates the analytics row in a single statement
+    QSqlQuery *query = prepareQuery(DatabaseStatement::UpdateLastLoginData);
+    query->bindValue(":client_ver", clientVersion);
     query->bindValue(":user_name", userName);
-    if (!execSqlQuery(query)) {
-        qDebug("Failed to locate user id when updating users last login data: SQL Error");
-        return;
-    }
-
-    if (query->next()) {
-        usersID = query->value(0).toInt();
-    }
-
-    if (usersID) {
-        int userCount = 0;
-        query = prepareQuery("select count(id) from {prefix}_user_analytics where id = :user_id");
-        query->bindValue(":user_id", usersID);
-        if (!execSqlQuery(query))
-            return;
-
-        if (query->next()) {
-            userCount = query->value(0).toInt();
-        }
-
-        if (!userCount) {
-            query = prepareQuery(
-                "insert into {prefix}_user_analytics (id,client_ver,last_login) values (:user_id,:client_ver,NOW())");
-            query->bindValue(":user_id", usersID);
-            query->bindValue(":client_ver", clientVersion);
-            execSqlQuery(query);
-        } else {
-            query = prepareQuery(
-                "update {prefix}_user_analytics set last_login = NOW(), client_ver = :client_ver where id = :user_id");
-            query->bindValue(":client_ver", clientVersion);
-            query->bindValue(":user_id", usersID);
-            execSqlQuery(query);
-        }
-    }
+    query->bindValue(":client_ver2", clientVersion);
+    if (!execSqlQuery(query))
+        qDebug("Failed to update users last login data: SQL Error");
 }
 
 QList<ServerInfo_Ban> Servatrice_DatabaseInterface::getUserBanHistory(const QString userName)
@@ -1131,9 +1393,7 @@ QList<ServerInfo_Ban> Servatrice_DatabaseInterface::getUserBanHistory(const QStr
     if (!checkSql())
         return results;
 
-    QSqlQuery *query =
-        prepareQuery("SELECT A.id_admin, A.time_from, A.minutes, A.reason, A.visible_reason, B.name AS name_admin FROM "
-                     "{prefix}_bans A LEFT JOIN {prefix}_users B ON A.id_admin=B.id WHERE A.user_name = :user_name");
+    QSqlQuery *query = prepareReplicaQuery(DatabaseStatement::SelectBanHistory);
     query->bindValue(":user_name", userName);
 
     if (!execSqlQuery(query)) {
@@ -1163,9 +1423,7 @@ bool Servatrice_DatabaseInterface::addWarning(const QString userName,
         return false;
 
     int userID = getUserIdInDB(userName);
-    QSqlQuery *query =
-        prepareQuery("insert into {prefix}_warnings (user_id,user_name,mod_name,reason,time_of,clientid) values "
-                     "(:user_id,:user_name,:mod_name,:warn_reason,NOW(),:client_id)");
+    QSqlQuery *query = prepareQuery(DatabaseStatement::InsertWarning);
     query->bindValue(":user_id", userID);
     query->bindValue(":user_name", userName);
     query->bindValue(":mod_name", adminName);
@@ -1188,8 +1446,7 @@ QList<ServerInfo_Warning> Servatrice_DatabaseInterface::getUserWarnHistory(const
         return results;
 
     int userID = getUserIdInDB(userName);
-    QSqlQuery *query =
-        prepareQuery("SELECT user_name, mod_name, reason, time_of FROM {prefix}_warnings WHERE user_id = :user_id");
+    QSqlQuery *query = prepareReplicaQuery(DatabaseStatement::SelectWarnHistory);
     query->bindValue(":user_id", userID);
 
     if (!execSqlQuery(query)) {
@@ -1276,7 +1533,7 @@ QList<ServerInfo_ChatMessage> Servatrice_DatabaseInterface::getMessageLogHistory
     if (maxresults)
         queryString.append(" LIMIT :limit_size");
 
-    QSqlQuery *query = prepareQuery(queryString);
+    QSqlQuery *query = prepareReplicaQuery(queryString);
     if (!user.isEmpty()) {
         query->bindValue(":user_name", user);
     }
@@ -1324,7 +1581,7 @@ int Servatrice_DatabaseInterface::checkNumberOfUserAccounts(const QString &email
     if (!checkSql())
         return 0;
 
-    QSqlQuery *query = prepareQuery("SELECT count(email) FROM {prefix}_users WHERE email = :user_email");
+    QSqlQuery *query = prepareQuery(DatabaseStatement::CountAccountsWithEmail);
     query->bindValue(":user_email", email);
 
     if (!execSqlQuery(query)) {
@@ -1346,7 +1603,7 @@ bool Servatrice_DatabaseInterface::addForgotPassword(const QString &user)
     if (!updateUserToken(PasswordHasher::generateActivationToken(), user))
         return false;
 
-    QSqlQuery *query = prepareQuery("insert into {prefix}_forgot_password (name,requestDate) values (:username,NOW())");
+    QSqlQuery *query = prepareQuery(DatabaseStatement::InsertForgotPassword);
     query->bindValue(":username", user);
     if (execSqlQuery(query))
         return true;
@@ -1359,7 +1616,7 @@ bool Servatrice_DatabaseInterface::removeForgotPassword(const QString &user)
     if (!checkSql())
         return false;
 
-    QSqlQuery *query = prepareQuery("delete from {prefix}_forgot_password where name = :username");
+    QSqlQuery *query = prepareQuery(DatabaseStatement::DeleteForgotPassword);
     query->bindValue(":username", user);
     if (execSqlQuery(query))
         return true;
@@ -1372,8 +1629,7 @@ bool Servatrice_DatabaseInterface::doesForgotPasswordExist(const QString &user)
     if (!checkSql())
         return false;
 
-    QSqlQuery *query = prepareQuery("select count(name) from {prefix}_forgot_password where name = :user_name AND "
-                                    "requestDate > (now() - interval :minutes minute)");
+    QSqlQuery *query = prepareQuery(DatabaseStatement::CountRecentForgotPasswords);
     query->bindValue(":user_name", user);
     query->bindValue(":minutes", QString::number(server->getForgotPasswordTokenLife()));
 
@@ -1395,7 +1651,7 @@ bool Servatrice_DatabaseInterface::updateUserToken(const QString &token, const Q
     if (token.isEmpty() || user.isEmpty())
         return false;
 
-    QSqlQuery *query = prepareQuery("update {prefix}_users set token = :token where name = :user_name");
+    QSqlQuery *query = prepareQuery(DatabaseStatement::UpdateToken);
     query->bindValue(":user_name", user);
     query->bindValue(":token", token);
 
@@ -1446,9 +1702,7 @@ void Servatrice_DatabaseInterface::addAuditRecord(const QString &user,
     if (user.isEmpty() || ipaddress.isEmpty() || clientid.isEmpty() || action.isEmpty())
         return;
 
-    QSqlQuery *query = prepareQuery("insert into {prefix}_audit "
-                                    "(id_server,name,ip_address,clientid,incidentDate,action,results,details) values "
-                                    "(:idserver,:username,:ipaddress,:clientid,NOW(),:action,:results,:details)");
+    QSqlQuery *query = prepareQuery(DatabaseStatement::InsertAuditRecord);
     query->bindValue(":idserver", server->getServerID());
     query->bindValue(":username", user);
     query->bindValue(":ipaddress", ipaddress);
@@ -1,33 +1,117 @@
 #ifndef SERVATRICE_DATABASE_INTERFACE_H
 #define SERVATRICE_DATABASE_INTERFACE_H
 
+#include "database_statements.h"
+#include "pb/serverinfo_game.pb.h"
 #include "server.h"
 #include "server_database_interface.h"
 
 #include <QChar>
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QObject>
 #include <QSqlDatabase>
+#include <QVariantList>
 
-#define DATABASE_SCHEMA_VERSION 34
+#define DATABASE_SCHEMA_VERSION 37
 
+class MetricsCounter;
+class MetricsHistogram;
 class Servatrice;
 
+/**
+ * Everything about a finished game that goes into the database, with its replays already serialized.
+ */
+struct FinishedGame
+{
+    struct Replay
+    {
+        qint64 replayId;
+        int durationSeconds;
+        QByteArray data;
+    };
+
+    QString roomName;
+    QStringList roomGameTypes;
+    ServerInfo_Game gameInfo;
+    QSet<QString> allPlayersEver;
+    QSet<QString> allSpectatorsEver;
+    QList<Replay> replays;
+};
+
+/**
+ * A user message that goes into the log table. The ids are null QVariants where the column stays empty.
+ */
+struct LoggedMessage
+{
+    QDateTime time;
+    QVariant senderId;
+    QString senderName;
+    QString senderIp;
+    QString message;
+    QString targetType;
+    QVariant targetId;
+    QString targetName;
+};
+
+/**
+ * A session that starts or ends, as written to the sessions table. The end of a session carries only its id and
+ * end time.
+ */
+struct LoggedSession
+{
+    qint64 id;
+    QString userName;
+    QString address;
+    QString clientId;
+    QString connectionType;
+    // null for an end
+    QDateTime startTime;
+    // null for a start
+    QDateTime endTime;
+};
+
 class Servatrice_DatabaseInterface : public Server_DatabaseInterface
 {
     Q_OBJECT
 private:
     int instanceId;
     QSqlDatabase sqlDatabase;
-    QHash<QString, QSqlQuery *> preparedStatements;
+    // the optional read-only copy of the database, opened on first use, see prepareReplicaQuery()
+    QSqlDatabase replicaDatabase;
+    // runs from the last time the replica could not be used, until then the primary is used
+    QElapsedTimer replicaFailedSince;
+    struct StatementState
+    {
+        // with the table prefix filled in
+        QString text;
+        // the name of the statement in the metrics and the timeline
+        QString label;
+        MetricsHistogram *duration;
+        MetricsCounter *failures;
+        bool onReplica;
+    };
+    // the fixed statements by id, null until first used
+    QSqlQuery *statements[static_cast<int>(DatabaseStatement::Count)];
+    QSqlQuery *replicaStatements[static_cast<int>(DatabaseStatement::Count)];
+    // the statements put together at run time, by their text
+    QHash<QString, QSqlQuery *> preparedStatements, preparedReplicaStatements;
+    // every prepared statement of either kind; the callers hold on to the queries, so they are prepared again in
+    // place when the connection is reopened
+    QHash<QSqlQuery *, StatementState> statementStates;
     Servatrice *server;
     ServerInfo_User evalUserQueryResult(const QSqlQuery *query, bool complete, bool withId = false);
-    /** Must be called after checkSql and server is known to be in auth mode. */
-    bool checkUserIsIdBanned(const QString &clientId, QString &banReason, int &banSecondsRemaining);
-    /** Must be called after checkSql and server is known to be in auth mode. */
-    bool checkUserIsIpBanned(const QString &ipAddress, QString &banReason, int &banSecondsRemaining);
-    /** Must be called after checkSql and server is known to be in auth mode. */
-    bool checkUserIsNameBanned(QString const &userName, QString &banReason, int &banSecondsRemaining);
+    bool isInList(const QString &list, const QString &whoseList, const QString &who);
+    QString getConnectionLabel() const;
+    QHash<QString, int> getUserIdsInDB(const QSet<QString> &names);
+    bool execMultiRowInsert(const QString &insertText, int columnCount, const QVariantList &values);
+    // the first id of a block of blockSize ids reserved from the sequence, -1 on failure
+    qint64 reserveIdBlock(const QString &sequence, int blockSize);
+    QSqlQuery *newStatement(const QString &queryText, const QString &label, bool onReplica = false);
+    void prepareStatementsAgain(bool onReplica = false);
+    bool replicaAvailable();
+    void replicaFailed(const QString &error);
 
 protected:
     AuthenticationResult checkUserPassword(Server_ProtocolHandler *handler,
@@ -42,6 +126,13 @@ public slots:
     void initDatabase(const QSqlDatabase &_sqlDatabase);
 
 public:
+    // instance ids -1 and up are used by the main thread and the connection pools
+    static const int ReplayWorkerInstanceId = -2;
+    static const int ChatLogWorkerInstanceId = -3;
+    static const int SessionLogWorkerInstanceId = -4;
+    // the game executor threads count down from here
+    static const int GameExecutorInstanceIdBase = -100;
+
     explicit Servatrice_DatabaseInterface(int _instanceId, Servatrice *_server);
     ~Servatrice_DatabaseInterface() override;
     bool initDatabase(const QString &type,
@@ -51,7 +142,14 @@ public:
                       const QString &password);
     bool openDatabase();
     bool checkSql();
+    QSqlQuery *prepareQuery(DatabaseStatement statement);
     QSqlQuery *prepareQuery(const QString &queryText);
+    /**
+     * The same statement on the replica, for the queries that only read history and lists. Falls back to the
+     * primary database while no replica is configured or for a while after it failed.
+     */
+    QSqlQuery *prepareReplicaQuery(DatabaseStatement statement);
+    QSqlQuery *prepareReplicaQuery(const QString &queryText);
     bool execSqlQuery(QSqlQuery *query);
     const QSqlDatabase &getDatabase()
     {
@@ -64,6 +162,9 @@ public:
     int getUserIdInDB(const QString &name);
     QMap<QString, ServerInfo_User> getBuddyList(const QString &name) override;
     QMap<QString, ServerInfo_User> getIgnoreList(const QString &name) override;
+    void getBuddyAndIgnoreLists(const QString &name,
+                                QMap<QString, ServerInfo_User> &buddyList,
+                                QMap<QString, ServerInfo_User> &ignoreList) override;
     bool isInBuddyList(const QString &whoseList, const QString &who) override;
     bool isInIgnoreList(const QString &whoseList, const QString &who) override;
     ServerInfo_User getUserData(const QString &name, bool withId = false) override;
@@ -72,7 +173,23 @@ public:
                               const ServerInfo_Game &gameInfo,
                               const QSet<QString> &allPlayersEver,
                               const QSet<QString> &allSpectatorsEver,
-                              const QList<GameReplay *> &replayList) override;
+                              const QList<GameReplayWriter *> &replayList) override;
+    /**
+     * Stores a batch of finished games in one transaction, resolving the user ids of all participants with a
+     * single query and writing the rows of all games with multi-row statements.
+     */
+    bool storeFinishedGames(const QList<FinishedGame> &games);
+    /**
+     * The game of a recovered replay never ended, its row is only written when no other replay of it was stored
+     * before.
+     */
+    bool storeRecoveredReplay(qint64 replayId,
+                              const ServerInfo_Game &gameInfo,
+                              int durationSeconds,
+                              const QByteArray &replay);
+    bool storeLoggedMessages(const QList<LoggedMessage> &messages);
+    // the starts and ends in the order they happened
+    bool storeLoggedSessions(const QList<LoggedSession> &sessions);
     DeckList *getDeckFromDatabase(int deckId, int userId) override;
 
     int getNextGameId() override;
@@ -85,9 +202,6 @@ public:
                         const QString &connectionType) override;
     void endSession(qint64 sessionId) override;
     void clearSessionTables() override;
-    void lockSessionTables() override;
-    void unlockSessionTables() override;
-    bool userSessionExists(const QString &userName) override;
     bool usernameIsValid(const QString &user, QString &error) override;
     bool checkUserIsBanned(const QString &ipAddress,
                            const QString &userName,
@@ -1,16 +1,18 @@
 #include "server_logger.h"
 
+#include "debug_pb_message.h"
 #include "settingscache.h"
 
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
-#include <QTextStream>
+#include <google/protobuf/message.h>
 #include <iostream>
 
 ServerLogger::ServerLogger(bool _logToConsole, QObject *parent)
-    : QObject(parent), logToConsole(_logToConsole), flushRunning(false)
+    : QObject(parent), logToConsole(_logToConsole), maxLogFileSize(0), logFileRotations(0), flushRunning(false),
+      commandCount(0)
 {
 }
 
@@ -21,8 +23,12 @@ ServerLogger::~ServerLogger()
     thread()->quit();
 }
 
-void ServerLogger::startLog(const QString &logFileName)
+void ServerLogger::startLog(const QString &_logFileName)
 {
+    logFileName = _logFileName;
+    maxLogFileSize = settingsCache->value("server/logfile_max_size", 0).toLongLong() * 1024 * 1024;
+    logFileRotations = qMax(1, settingsCache->value("server/logfile_rotations", 5).toInt());
+
     if (!logFileName.isEmpty()) {
         QFileInfo fi(logFileName);
         QDir fileDir(fi.path());
@@ -45,45 +51,57 @@ void ServerLogger::startLog(const QString &logFileName)
     connect(this, SIGNAL(sigFlushBuffer()), this, SLOT(flushBuffer()), Qt::QueuedConnection);
 }
 
+bool ServerLogger::acceptsMessages() const
+{
+    return logFile && settingsCache->config().writeLog;
+}
+
+// filter out all log entries based on values in configuration file
+bool ServerLogger::isFilteredOut(const QString &message)
+{
+    const QStringList &logFilters = settingsCache->config().logFilters;
+    if (logFilters.isEmpty())
+        return false;
+
+    for (const QString &logFilter : logFilters) {
+        if (message.contains(logFilter, Qt::CaseInsensitive))
+            return false;
+    }
+    return true;
+}
+
 void ServerLogger::logMessage(const QString &message, void *caller)
 {
-    if (!logFile)
+    if (!acceptsMessages() || isFilteredOut(message))
         return;
 
-    QString callerString;
-    if (caller)
-        callerString = QString::number((qulonglong)caller, 16) + " ";
-
-    // filter out all log entries based on values in configuration file
-    bool shouldWeWriteLog = settingsCache->value("server/writelog", 1).toBool();
-    QString logFilters = settingsCache->value("server/logfilters").toString();
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
-    QStringList listlogFilters = logFilters.split(",", Qt::SkipEmptyParts);
-#else
-    QStringList listlogFilters = logFilters.split(",", QString::SkipEmptyParts);
-#endif
-    bool shouldWeSkipLine = false;
-
-    if (!shouldWeWriteLog)
-        return;
+    appendEntry({QDateTime::currentMSecsSinceEpoch(), reinterpret_cast<quintptr>(caller), message, nullptr});
+}
 
-    if (!logFilters.trimmed().isEmpty()) {
-        shouldWeSkipLine = true;
-        for (const QString &logFilter : listlogFilters) {
-            if (message.contains(logFilter, Qt::CaseInsensitive)) {
-                shouldWeSkipLine = false;
-                break;
-            }
-        }
-    }
+void ServerLogger::logCommand(const QString &prefix, const ::google::protobuf::Message &command, void *caller)
+{
+    if (!acceptsMessages())
+        return;
 
-    if (shouldWeSkipLine)
+    const int sampleRate = settingsCache->config().logCommandSampleRate;
+    if (sampleRate > 1 && commandCount++ % sampleRate != 0)
         return;
 
+    std::shared_ptr<::google::protobuf::Message> copy(command.New());
+    copy->CopyFrom(command);
+    appendEntry({QDateTime::currentMSecsSinceEpoch(), reinterpret_cast<quintptr>(caller), prefix, std::move(copy)});
+}
+
+void ServerLogger::appendEntry(const Entry &entry)
+{
     bufferMutex.lock();
-    buffer.append(QDateTime::currentDateTime().toString() + " " + callerString + message);
+    const bool wasEmpty = buffer.isEmpty();
+    buffer.append(entry);
     bufferMutex.unlock();
-    emit sigFlushBuffer();
+
+    // one flush takes everything that is buffered by then, it only has to be scheduled for the first entry
+    if (wasEmpty)
+        emit sigFlushBuffer();
 }
 
 void ServerLogger::flushBuffer()
@@ -92,26 +110,57 @@ void ServerLogger::flushBuffer()
         return;
 
     flushRunning = true;
-    QTextStream stream(logFile);
     forever
     {
+        QList<Entry> entries;
         bufferMutex.lock();
-        if (buffer.isEmpty()) {
-            bufferMutex.unlock();
+        entries.swap(buffer);
+        bufferMutex.unlock();
+        if (entries.isEmpty()) {
             flushRunning = false;
             return;
         }
-        QString message = buffer.takeFirst();
-        bufferMutex.unlock();
 
-        stream << message << "\n";
-        stream.flush();
+        QString lines;
+        for (const Entry &entry : entries) {
+            QString message = entry.message;
+            if (entry.command) {
+                message += getSafeDebugString(*entry.command);
+                if (isFilteredOut(message))
+                    continue;
+            }
+
+            QString line = QDateTime::fromMSecsSinceEpoch(entry.time).toString() + " ";
+            if (entry.caller)
+                line += QString::number(static_cast<qulonglong>(entry.caller), 16) + " ";
+            line += message;
 
-        if (logToConsole)
-            std::cout << message.toStdString() << std::endl;
+            if (logToConsole)
+                std::cout << line.toStdString() << std::endl;
+            lines += line + "\n";
+        }
+
+        logFile->write(lines.toUtf8());
+        logFile->flush();
+        rotateBySize();
     }
 }
 
+void ServerLogger::rotateBySize()
+{
+    if (maxLogFileSize <= 0 || logFile->size() < maxLogFileSize)
+        return;
+
+    // server.log becomes server.log.1, server.log.1 becomes server.log.2 and so on; the oldest one is dropped
+    logFile->close();
+    QFile::remove(logFileName + "." + QString::number(logFileRotations));
+    for (int i = logFileRotations - 1; i >= 1; --i)
+        QFile::rename(logFileName + "." + QString::number(i), logFileName + "." + QString::number(i + 1));
+    QFile::rename(logFileName, logFileName + ".1");
+    if (!logFile->open(QIODevice::Append))
+        std::cerr << "ERROR: can't open() logfile after rotating it." << std::endl;
+}
+
 void ServerLogger::rotateLogs()
 {
     if (!logFile)
@@ -1,14 +1,24 @@
 #ifndef SERVER_LOGGER_H
 #define SERVER_LOGGER_H
 
+#include <QList>
 #include <QMutex>
 #include <QObject>
 #include <QStringList>
 #include <QThread>
 #include <QWaitCondition>
+#include <atomic>
+#include <memory>
 
 class QFile;
 class Server_ProtocolHandler;
+namespace google
+{
+namespace protobuf
+{
+class Message;
+}
+} // namespace google
 
 class ServerLogger : public QObject
 {
@@ -19,6 +29,12 @@ public:
 public slots:
     void startLog(const QString &logFileName);
     void logMessage(const QString &message, void *caller = 0);
+    /**
+     * Logs prefix followed by the text of command. Only a copy of the command is taken here, the logger thread turns
+     * it into text and checks it against the log filters. With a log_command_sample_rate above 1, the commands that
+     * aren't sampled are dropped right away.
+     */
+    void logCommand(const QString &prefix, const ::google::protobuf::Message &command, void *caller = 0);
     void rotateLogs();
 private slots:
     void flushBuffer();
@@ -26,11 +42,30 @@ signals:
     void sigFlushBuffer();
 
 private:
+    // formatted by the logger thread, so that logging costs the calling thread as little as possible
+    struct Entry
+    {
+        qint64 time;
+        quintptr caller;
+        QString message;
+        // for logCommand(), rendered after the prefix held by message
+        std::shared_ptr<const ::google::protobuf::Message> command;
+    };
+
     bool logToConsole;
     static QFile *logFile;
+    QString logFileName;
+    qint64 maxLogFileSize;
+    int logFileRotations;
     bool flushRunning;
-    QStringList buffer;
+    QList<Entry> buffer;
     QMutex bufferMutex;
+    std::atomic<quint64> commandCount;
+
+    bool acceptsMessages() const;
+    static bool isFilteredOut(const QString &message);
+    void appendEntry(const Entry &entry);
+    void rotateBySize();
 };
 
 #endif
@@ -20,9 +20,17 @@
 
 #include "serversocketinterface.h"
 
+#include "avatar_hash.h"
 #include "decklist.h"
 #include "email_parser.h"
+#include "get_pb_extension.h"
+#include "handoff_channel.h"
 #include "main.h"
+#include "message_batching.h"
+#include "message_compression.h"
+#include "message_framing.h"
+#include "metrics.h"
+#include "output_pruning.h"
 #include "pb/command_deck_del.pb.h"
 #include "pb/command_deck_del_dir.pb.h"
 #include "pb/command_deck_download.pb.h"
@@ -41,12 +49,14 @@
 #include "pb/event_server_identification.pb.h"
 #include "pb/event_server_message.pb.h"
 #include "pb/event_user_message.pb.h"
+#include "pb/response_activity_top.pb.h"
 #include "pb/response_ban_history.pb.h"
 #include "pb/response_deck_download.pb.h"
 #include "pb/response_deck_list.pb.h"
 #include "pb/response_deck_upload.pb.h"
 #include "pb/response_forgotpasswordrequest.pb.h"
 #include "pb/response_get_admin_notes.pb.h"
+#include "pb/response_memory_usage.pb.h"
 #include "pb/response_password_salt.pb.h"
 #include "pb/response_register.pb.h"
 #include "pb/response_replay_download.pb.h"
@@ -58,39 +68,67 @@
 #include "pb/serverinfo_chat_message.pb.h"
 #include "pb/serverinfo_deckstorage.pb.h"
 #include "pb/serverinfo_replay.pb.h"
+#include "pb/server_handoff.pb.h"
 #include "pb/serverinfo_user.pb.h"
+#include "pb/session_commands.pb.h"
+#include "password_hash_pool.h"
+#include "replay_compression.h"
 #include "servatrice.h"
+#include "servatrice_connection_pool.h"
 #include "servatrice_database_interface.h"
 #include "server_logger.h"
 #include "server_player.h"
+#include "server_presence.h"
 #include "server_response_containers.h"
 #include "server_room.h"
 #include "settingscache.h"
+#include "timeline_trace.h"
 #include "trice_limits.h"
 #include "version_string.h"
 
 #include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QHostAddress>
+#include <QMap>
 #include <QRegularExpression>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QString>
+#include <cstring>
 #include <iostream>
 #include <string>
 
 static const int protocolVersion = 14;
+static const int maxCommandsWaitingForLogin = 16;
+// the largest part of a replay or deck sent at once when downloading them in chunks
+static const quint32 maxDownloadChunkSize = 1024 * 1024;
 
 AbstractServerSocketInterface::AbstractServerSocketInterface(Servatrice *_server,
                                                              Servatrice_DatabaseInterface *_databaseInterface,
                                                              QObject *parent)
-    : Server_ProtocolHandler(_server, _databaseInterface, parent), servatrice(_server),
-      sqlInterface(reinterpret_cast<Servatrice_DatabaseInterface *>(databaseInterface))
+    : Server_ProtocolHandler(_server, _databaseInterface, parent), servatrice(_server), flushCount(0),
+      flushedMessages(0), flushedBytes(0), socketWrites(0),
+      sqlInterface(reinterpret_cast<Servatrice_DatabaseInterface *>(databaseInterface)), passwordHashPending(false),
+      deckStorageTreeValid(false), heldBackBytes(0), heldBackBytesAtLastPrune(0), aboveHighWatermark(false)
 {
     // Never call flushOutputQueue directly from outputQueueChanged. In case of a socket error,
     // it could lead to this object being destroyed while another function is still on the call stack. -> mutex
     // deadlocks etc.
     connect(this, SIGNAL(outputQueueChanged()), this, SLOT(flushOutputQueue()), Qt::QueuedConnection);
+
+    Metrics *metrics = servatrice->getMetrics();
+    highWatermarkCrossings =
+        metrics->counter("servatrice_output_queue_high_watermark_total",
+                         "How often the output backlog of a client grew above the high watermark.");
+    lowWatermarkCrossings = metrics->counter(
+        "servatrice_output_queue_low_watermark_total",
+        "How often the output backlog of a client shrank to the low watermark after being above the high watermark.");
+    prunedMessages = metrics->counter("servatrice_output_messages_pruned_total",
+                                      "Messages to slow clients that were dropped or collapsed into others.");
+    slowClientDisconnects = metrics->counter("servatrice_output_queue_disconnects_total",
+                                             "Clients disconnected because their output backlog hit the hard limit.");
 }
 
 bool AbstractServerSocketInterface::initSession()
@@ -138,11 +176,146 @@ void AbstractServerSocketInterface::catchSocketDisconnected()
 
 void AbstractServerSocketInterface::transmitProtocolItem(const ServerMessage &item)
 {
-    outputQueueMutex.lock();
-    outputQueue.append(item);
-    outputQueueMutex.unlock();
+    transmitSerializedItem(serializeServerMessage(item));
+}
+
+void AbstractServerSocketInterface::sendSerializedProtocolItem(const GameEventContainer & /* item */,
+                                                               const QByteArray &serializedMessage)
+{
+    // the buffer is implicitly shared, all recipients of a game event enqueue the same data
+    transmitSerializedItem(serializedMessage);
+}
+
+void AbstractServerSocketInterface::sendSerializedProtocolItem(const RoomEvent & /* item */,
+                                                               const QByteArray &serializedMessage)
+{
+    transmitSerializedItem(serializedMessage);
+}
+
+void AbstractServerSocketInterface::sendSerializedResponse(const QByteArray &serializedMessage)
+{
+    transmitSerializedItem(serializedMessage);
+}
+
+void AbstractServerSocketInterface::sendSerializedServerMessage(const QByteArray &serializedMessage)
+{
+    transmitSerializedItem(serializedMessage);
+}
+
+void AbstractServerSocketInterface::transmitSerializedItem(const QByteArray &serializedMessage)
+{
+    activity.record(server->getPingClockTicks(), 0, 0, serializedMessage.size());
+    if (outputQueue.push(serializedMessage))
+        emit outputQueueChanged();
+}
+
+QList<QByteArray> AbstractServerSocketInterface::takeOutputQueue()
+{
+    const QList<QByteArray> newItems = outputQueue.takeAll();
+    const qint64 socketBytes = getSocketBytesToWrite();
+    const qint64 lowWatermark = servatrice->getOutputQueueLowWatermark();
+    // the common case, the client keeps up
+    if (heldBackItems.isEmpty() && !aboveHighWatermark && socketBytes <= lowWatermark)
+        return newItems;
+
+    for (const QByteArray &item : newItems)
+        heldBackBytes += item.size();
+    heldBackItems.append(newItems);
+
+    QList<QByteArray> result;
+    if (deleted) {
+        // the connection is closing, whatever is left can't hurt anymore
+        heldBackBytes = heldBackBytesAtLastPrune = 0;
+        result.swap(heldBackItems);
+        return result;
+    }
+
+    if (socketBytes + heldBackBytes > servatrice->getOutputQueueHighWatermark()) {
+        if (!aboveHighWatermark) {
+            aboveHighWatermark = true;
+            highWatermarkCrossings->add();
+            logDebugMessage(
+                QString("Output backlog above the high watermark: %1 bytes").arg(socketBytes + heldBackBytes));
+        }
+
+        // Parsing the held back messages isn't cheap, it is only worth it again once enough has been added.
+        if (heldBackBytes > 2 * heldBackBytesAtLastPrune) {
+            const int itemCount = heldBackItems.size();
+            heldBackItems = OutputPruning::prune(heldBackItems, userInfo ? userInfo->name() : std::string());
+            prunedMessages->add(itemCount - heldBackItems.size());
+            heldBackBytes = 0;
+            for (const QByteArray &item : heldBackItems)
+                heldBackBytes += item.size();
+            heldBackBytesAtLastPrune = heldBackBytes;
+        }
 
-    emit outputQueueChanged();
+        const qint64 hardLimit = servatrice->getOutputQueueHardLimit();
+        if (hardLimit > 0 && socketBytes + heldBackBytes > hardLimit) {
+            slowClientDisconnects->add();
+            logDebugMessage(
+                QString("Disconnecting slow client, %1 bytes of output are pending").arg(socketBytes + heldBackBytes));
+            heldBackItems.clear();
+            heldBackBytes = heldBackBytesAtLastPrune = 0;
+            prepareDestroy();
+            return result;
+        }
+    } else if (aboveHighWatermark && socketBytes + heldBackBytes <= lowWatermark) {
+        aboveHighWatermark = false;
+        lowWatermarkCrossings->add();
+    }
+
+    // while the client is behind, the socket gets more only once it has sent most of what it has
+    if (socketBytes > lowWatermark)
+        return result;
+
+    heldBackBytes = heldBackBytesAtLastPrune = 0;
+    result.swap(heldBackItems);
+    return result;
+}
+
+void AbstractServerSocketInterface::socketBytesWritten()
+{
+    if (!heldBackItems.isEmpty() || aboveHighWatermark)
+        flushOutputQueue();
+}
+
+void AbstractServerSocketInterface::addFlushStatistics(int messages, qint64 bytes, int writes)
+{
+    ++flushCount;
+    flushedMessages += messages;
+    flushedBytes += bytes;
+    socketWrites += writes;
+}
+
+QString AbstractServerSocketInterface::getFlushStatistics() const
+{
+    if (flushCount == 0 || socketWrites == 0)
+        return QString("no output flushed");
+
+    return QString("%1 flushes, %2 messages per flush, %3 bytes per write")
+        .arg(flushCount)
+        .arg((double)flushedMessages / flushCount, 0, 'f', 2)
+        .arg(flushedBytes / socketWrites);
+}
+
+// Returns the size from which outgoing messages are compressed, or 0 if this connection doesn't use compression.
+int AbstractServerSocketInterface::getCompressionThreshold() const
+{
+    if (!clientSupportsFeature(MessageCompression::featureName))
+        return 0;
+
+    return servatrice->getCompressionThreshold();
+}
+
+void AbstractServerSocketInterface::setDatabaseInterface(Servatrice_DatabaseInterface *_databaseInterface)
+{
+    databaseInterface = _databaseInterface;
+    sqlInterface = _databaseInterface;
+}
+
+bool AbstractServerSocketInterface::hasPendingWork() const
+{
+    return passwordHashPending || !heldBackItems.isEmpty();
 }
 
 void AbstractServerSocketInterface::logDebugMessage(const QString &message)
@@ -150,6 +323,11 @@ void AbstractServerSocketInterface::logDebugMessage(const QString &message)
     logger->logMessage(message, this);
 }
 
+void AbstractServerSocketInterface::logDebugCommand(const QString &prefix, const google::protobuf::Message &command)
+{
+    logger->logCommand(prefix, command, this);
+}
+
 Response::ResponseCode AbstractServerSocketInterface::processExtendedSessionCommand(int cmdType,
                                                                                     const SessionCommand &cmd,
                                                                                     ResponseContainer &rc)
@@ -233,6 +411,8 @@ Response::ResponseCode AbstractServerSocketInterface::processExtendedModeratorCo
             return cmdGetAdminNotes(cmd.GetExtension(Command_GetAdminNotes::ext), rc);
         case ModeratorCommand::UPDATE_ADMIN_NOTES:
             return cmdUpdateAdminNotes(cmd.GetExtension(Command_UpdateAdminNotes::ext), rc);
+        case ModeratorCommand::GET_ACTIVITY_TOP:
+            return cmdGetActivityTop(cmd.GetExtension(Command_GetActivityTop::ext), rc);
         default:
             return Response::RespFunctionNotAllowed;
     }
@@ -250,6 +430,10 @@ AbstractServerSocketInterface::processExtendedAdminCommand(int cmdType, const Ad
             return cmdReloadConfig(cmd.GetExtension(Command_ReloadConfig::ext), rc);
         case AdminCommand::ADJUST_MOD:
             return cmdAdjustMod(cmd.GetExtension(Command_AdjustMod::ext), rc);
+        case AdminCommand::GET_MEMORY_USAGE:
+            return cmdGetMemoryUsage(cmd.GetExtension(Command_GetMemoryUsage::ext), rc);
+        case AdminCommand::TIMELINE_TRACE:
+            return cmdTimelineTrace(cmd.GetExtension(Command_TimelineTrace::ext), rc);
         default:
             return Response::RespFunctionNotAllowed;
     }
@@ -286,6 +470,9 @@ Response::ResponseCode AbstractServerSocketInterface::cmdAddToList(const Command
     query->bindValue(":id2", id2);
     if (!sqlInterface->execSqlQuery(query))
         return Response::RespInternalError;
+    servatrice->invalidateCachedListEntry(list, QString::fromStdString(userInfo->name()), user);
+    if (list == "buddy")
+        servatrice->getPresence()->buddyAdded(this, user);
 
     Event_AddToList event;
     event.set_list_name(cmd.list());
@@ -325,6 +512,9 @@ Response::ResponseCode AbstractServerSocketInterface::cmdRemoveFromList(const Co
     query->bindValue(":id2", id2);
     if (!sqlInterface->execSqlQuery(query))
         return Response::RespInternalError;
+    servatrice->invalidateCachedListEntry(list, QString::fromStdString(userInfo->name()), user);
+    if (list == "buddy")
+        servatrice->getPresence()->buddyRemoved(this, user);
 
     Event_RemoveFromList event;
     event.set_list_name(cmd.list());
@@ -341,8 +531,7 @@ int AbstractServerSocketInterface::getDeckPathId(int basePathId, QStringList pat
     if (path[0].isEmpty())
         return 0;
 
-    QSqlQuery *query = sqlInterface->prepareQuery("select id from {prefix}_decklist_folders where id_parent = "
-                                                  ":id_parent and name = :name and id_user = :id_user");
+    QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::SelectDeckFolderId);
     query->bindValue(":id_parent", basePathId);
     query->bindValue(":name", path.takeFirst());
     query->bindValue(":id_user", userInfo->id());
@@ -362,47 +551,114 @@ int AbstractServerSocketInterface::getDeckPathId(const QString &path)
     return getDeckPathId(0, path.split("/"));
 }
 
-bool AbstractServerSocketInterface::deckListHelper(int folderId, ServerInfo_DeckStorage_Folder *folder)
+// Adds the subfolders of folderId to folder, ordered by id, followed by its files.
+static void addDeckStorageItems(int folderId,
+                                ServerInfo_DeckStorage_Folder *folder,
+                                const QHash<int, QMap<int, QString>> &subfolders,
+                                const QHash<int, QList<ServerInfo_DeckStorage_TreeItem>> &files)
 {
-    QSqlQuery *query = sqlInterface->prepareQuery(
-        "select id, name from {prefix}_decklist_folders where id_parent = :id_parent and id_user = :id_user");
-    query->bindValue(":id_parent", folderId);
+    const QMap<int, QString> folderSubfolders = subfolders.value(folderId);
+    for (auto it = folderSubfolders.constBegin(); it != folderSubfolders.constEnd(); ++it) {
+        ServerInfo_DeckStorage_TreeItem *newItem = folder->add_items();
+        newItem->set_id(it.key());
+        newItem->set_name(it.value().toStdString());
+        addDeckStorageItems(it.key(), newItem->mutable_folder(), subfolders, files);
+    }
+
+    for (const ServerInfo_DeckStorage_TreeItem &file : files.value(folderId))
+        folder->add_items()->CopyFrom(file);
+}
+
+bool AbstractServerSocketInterface::loadDeckStorageTree(ServerInfo_DeckStorage_Folder *root)
+{
+    // all folders and files of the user in two queries, the tree is put together here
+    QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::SelectDeckFolders);
     query->bindValue(":id_user", userInfo->id());
     if (!sqlInterface->execSqlQuery(query))
         return false;
 
-    QMap<int, QString> results;
+    // by parent folder
+    QHash<int, QMap<int, QString>> subfolders;
     while (query->next())
-        results[query->value(0).toInt()] = query->value(1).toString();
-
-    for (int key : results.keys()) {
-        ServerInfo_DeckStorage_TreeItem *newItem = folder->add_items();
-        newItem->set_id(key);
-        newItem->set_name(results.value(key).toStdString());
-
-        if (!deckListHelper(newItem->id(), newItem->mutable_folder()))
-            return false;
-    }
+        subfolders[query->value(1).toInt()].insert(query->value(0).toInt(), query->value(2).toString());
 
-    query = sqlInterface->prepareQuery("select id, name, upload_time from {prefix}_decklist_files where id_folder = "
-                                       ":id_folder and id_user = :id_user");
-    query->bindValue(":id_folder", folderId);
+    query = sqlInterface->prepareQuery(DatabaseStatement::SelectDeckFiles);
     query->bindValue(":id_user", userInfo->id());
     if (!sqlInterface->execSqlQuery(query))
         return false;
 
+    // by folder
+    QHash<int, QList<ServerInfo_DeckStorage_TreeItem>> files;
     while (query->next()) {
-        ServerInfo_DeckStorage_TreeItem *newItem = folder->add_items();
-        newItem->set_id(query->value(0).toInt());
-        newItem->set_name(query->value(1).toString().toStdString());
+        ServerInfo_DeckStorage_TreeItem newItem;
+        newItem.set_id(query->value(0).toInt());
+        newItem.set_name(query->value(2).toString().toStdString());
 
-        ServerInfo_DeckStorage_File *newFile = newItem->mutable_file();
-        newFile->set_creation_time(query->value(2).toDateTime().toSecsSinceEpoch());
+        ServerInfo_DeckStorage_File *newFile = newItem.mutable_file();
+        newFile->set_creation_time(query->value(3).toDateTime().toSecsSinceEpoch());
+        files[query->value(1).toInt()].append(newItem);
     }
 
+    // folders that aren't reachable from the root aren't listed, as before
+    addDeckStorageItems(0, root, subfolders, files);
     return true;
 }
 
+// Finds a folder or a file of a deck storage tree by its id, folders and files are numbered separately.
+static ServerInfo_DeckStorage_TreeItem *findDeckStorageItem(ServerInfo_DeckStorage_Folder *folder,
+                                                            int id,
+                                                            bool isFolder,
+                                                            ServerInfo_DeckStorage_Folder **parent,
+                                                            int *row)
+{
+    for (int i = 0; i < folder->items_size(); ++i) {
+        ServerInfo_DeckStorage_TreeItem *item = folder->mutable_items(i);
+        if (item->has_folder() == isFolder && item->id() == id) {
+            if (parent)
+                *parent = folder;
+            if (row)
+                *row = i;
+            return item;
+        }
+        if (item->has_folder()) {
+            ServerInfo_DeckStorage_TreeItem *found =
+                findDeckStorageItem(item->mutable_folder(), id, isFolder, parent, row);
+            if (found)
+                return found;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * The deck commands keep the cached deck storage tree up to date instead of having it loaded again for the next
+ * Command_DeckList. Returns nullptr if there's no cached tree; if the item isn't in it, the tree is dropped, since
+ * it no longer matches the database.
+ */
+ServerInfo_DeckStorage_TreeItem *AbstractServerSocketInterface::findCachedDeckStorageItem(
+    int id,
+    bool isFolder,
+    ServerInfo_DeckStorage_Folder **parent,
+    int *row)
+{
+    if (!deckStorageTreeValid)
+        return nullptr;
+
+    ServerInfo_DeckStorage_TreeItem *item = findDeckStorageItem(&deckStorageTree, id, isFolder, parent, row);
+    if (!item)
+        deckStorageTreeValid = false;
+    return item;
+}
+
+ServerInfo_DeckStorage_Folder *AbstractServerSocketInterface::findCachedDeckStorageFolder(int folderId)
+{
+    if (folderId == 0)
+        return deckStorageTreeValid ? &deckStorageTree : nullptr;
+
+    ServerInfo_DeckStorage_TreeItem *item = findCachedDeckStorageItem(folderId, true);
+    return item ? item->mutable_folder() : nullptr;
+}
+
 // CHECK AUTHENTICATION!
 // Also check for every function that data belonging to other users cannot be accessed.
 
@@ -414,12 +670,15 @@ Response::ResponseCode AbstractServerSocketInterface::cmdDeckList(const Command_
 
     sqlInterface->checkSql();
 
-    Response_DeckList *re = new Response_DeckList;
-    ServerInfo_DeckStorage_Folder *root = re->mutable_root();
-
-    if (!deckListHelper(0, root))
-        return Response::RespContextError;
+    if (!deckStorageTreeValid) {
+        deckStorageTree.Clear();
+        if (!loadDeckStorageTree(&deckStorageTree))
+            return Response::RespContextError;
+        deckStorageTreeValid = true;
+    }
 
+    Response_DeckList *re = new Response_DeckList;
+    re->mutable_root()->CopyFrom(deckStorageTree);
     rc.setResponseExtension(re);
     return Response::RespOk;
 }
@@ -441,31 +700,38 @@ Response::ResponseCode AbstractServerSocketInterface::cmdDeckNewDir(const Comman
     if (path.length() + name.length() + 1 > MAX_NAME_LENGTH)
         return Response::RespContextError; // do not allow creation of paths that would be too long to delete
 
-    QSqlQuery *query = sqlInterface->prepareQuery(
-        "insert into {prefix}_decklist_folders (id_parent, id_user, name) values(:id_parent, :id_user, :name)");
+    QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::InsertDeckFolder);
     query->bindValue(":id_parent", folderId);
     query->bindValue(":id_user", userInfo->id());
     query->bindValue(":name", name);
-    if (!sqlInterface->execSqlQuery(query))
+    if (!sqlInterface->execSqlQuery(query)) {
+        deckStorageTreeValid = false;
         return Response::RespContextError;
+    }
+
+    if (ServerInfo_DeckStorage_Folder *parent = findCachedDeckStorageFolder(folderId)) {
+        ServerInfo_DeckStorage_TreeItem *newItem = parent->add_items();
+        newItem->set_id(query->lastInsertId().toInt());
+        newItem->set_name(name.toStdString());
+        newItem->mutable_folder();
+    }
     return Response::RespOk;
 }
 
 void AbstractServerSocketInterface::deckDelDirHelper(int basePathId)
 {
     sqlInterface->checkSql();
-    QSqlQuery *query =
-        sqlInterface->prepareQuery("select id from {prefix}_decklist_folders where id_parent = :id_parent");
+    QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::SelectDeckSubfolders);
     query->bindValue(":id_parent", basePathId);
     sqlInterface->execSqlQuery(query);
     while (query->next())
         deckDelDirHelper(query->value(0).toInt());
 
-    query = sqlInterface->prepareQuery("delete from {prefix}_decklist_files where id_folder = :id_folder");
+    query = sqlInterface->prepareQuery(DatabaseStatement::DeleteDeckFilesInFolder);
     query->bindValue(":id_folder", basePathId);
     sqlInterface->execSqlQuery(query);
 
-    query = sqlInterface->prepareQuery("delete from {prefix}_decklist_folders where id = :id");
+    query = sqlInterface->prepareQuery(DatabaseStatement::DeleteDeckFolder);
     query->bindValue(":id", basePathId);
     sqlInterface->execSqlQuery(query);
 }
@@ -473,7 +739,7 @@ void AbstractServerSocketInterface::deckDelDirHelper(int basePathId)
 void AbstractServerSocketInterface::sendServerMessage(const QString userName, const QString message)
 {
     AbstractServerSocketInterface *user =
-        static_cast<AbstractServerSocketInterface *>(server->getUsers().value(userName));
+        static_cast<AbstractServerSocketInterface *>(server->findLocalUser(userName));
     if (!user)
         return;
 
@@ -498,6 +764,11 @@ Response::ResponseCode AbstractServerSocketInterface::cmdDeckDelDir(const Comman
     if ((basePathId == -1) || (basePathId == 0))
         return Response::RespNameNotFound;
     deckDelDirHelper(basePathId);
+
+    ServerInfo_DeckStorage_Folder *parent;
+    int row;
+    if (findCachedDeckStorageItem(basePathId, true, &parent, &row))
+        parent->mutable_items()->DeleteSubrange(row, 1);
     return Response::RespOk;
 }
 
@@ -507,18 +778,21 @@ Response::ResponseCode AbstractServerSocketInterface::cmdDeckDel(const Command_D
         return Response::RespFunctionNotAllowed;
 
     sqlInterface->checkSql();
-    QSqlQuery *query =
-        sqlInterface->prepareQuery("select id from {prefix}_decklist_files where id = :id and id_user = :id_user");
+    QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::SelectDeckFileId);
     query->bindValue(":id", cmd.deck_id());
     query->bindValue(":id_user", userInfo->id());
     sqlInterface->execSqlQuery(query);
     if (!query->next())
         return Response::RespNameNotFound;
 
-    query = sqlInterface->prepareQuery("delete from {prefix}_decklist_files where id = :id");
+    query = sqlInterface->prepareQuery(DatabaseStatement::DeleteDeckFile);
     query->bindValue(":id", cmd.deck_id());
     sqlInterface->execSqlQuery(query);
 
+    ServerInfo_DeckStorage_Folder *parent;
+    int row;
+    if (findCachedDeckStorageItem(cmd.deck_id(), false, &parent, &row))
+        parent->mutable_items()->DeleteSubrange(row, 1);
     return Response::RespOk;
 }
 
@@ -547,14 +821,13 @@ Response::ResponseCode AbstractServerSocketInterface::cmdDeckUpload(const Comman
         if (folderId == -1)
             return Response::RespNameNotFound;
 
-        QSqlQuery *query =
-            sqlInterface->prepareQuery("insert into {prefix}_decklist_files (id_folder, id_user, name, upload_time, "
-                                       "content) values(:id_folder, :id_user, :name, NOW(), :content)");
+        QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::InsertDeckFile);
         query->bindValue(":id_folder", folderId);
         query->bindValue(":id_user", userInfo->id());
         query->bindValue(":name", deckName);
         query->bindValue(":content", deckStr);
-        sqlInterface->execSqlQuery(query);
+        if (!sqlInterface->execSqlQuery(query))
+            deckStorageTreeValid = false;
 
         Response_DeckUpload *re = new Response_DeckUpload;
         ServerInfo_DeckStorage_TreeItem *fileInfo = re->mutable_new_file();
@@ -562,10 +835,11 @@ Response::ResponseCode AbstractServerSocketInterface::cmdDeckUpload(const Comman
         fileInfo->set_name(deckName.toStdString());
         fileInfo->mutable_file()->set_creation_time(QDateTime::currentDateTime().toSecsSinceEpoch());
         rc.setResponseExtension(re);
+
+        if (ServerInfo_DeckStorage_Folder *parent = findCachedDeckStorageFolder(folderId))
+            parent->add_items()->CopyFrom(*fileInfo);
     } else if (cmd.has_deck_id()) {
-        QSqlQuery *query =
-            sqlInterface->prepareQuery("update {prefix}_decklist_files set name=:name, upload_time=NOW(), "
-                                       "content=:content where id = :id_deck and id_user = :id_user");
+        QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::UpdateDeckFile);
         query->bindValue(":id_deck", cmd.deck_id());
         query->bindValue(":id_user", userInfo->id());
         query->bindValue(":name", deckName);
@@ -581,6 +855,9 @@ Response::ResponseCode AbstractServerSocketInterface::cmdDeckUpload(const Comman
         fileInfo->set_name(deckName.toStdString());
         fileInfo->mutable_file()->set_creation_time(QDateTime::currentDateTime().toSecsSinceEpoch());
         rc.setResponseExtension(re);
+
+        if (ServerInfo_DeckStorage_TreeItem *item = findCachedDeckStorageItem(cmd.deck_id(), false))
+            item->CopyFrom(*fileInfo);
     } else
         return Response::RespInvalidData;
 
@@ -601,28 +878,53 @@ Response::ResponseCode AbstractServerSocketInterface::cmdDeckDownload(const Comm
     }
 
     Response_DeckDownload *re = new Response_DeckDownload;
-    re->set_deck(deck->writeToString_Native().toStdString());
+    if (cmd.max_length() > 0) {
+        const QByteArray deckData = deck->writeToString_Native().toUtf8();
+        const int offset = static_cast<int>(qMin(cmd.offset(), static_cast<quint32>(deckData.size())));
+        const QByteArray chunk = deckData.mid(offset, static_cast<int>(qMin(cmd.max_length(), maxDownloadChunkSize)));
+        re->set_deck_data(chunk.constData(), chunk.size());
+        re->set_total_size(deckData.size());
+    } else {
+        re->set_deck(deck->writeToString_Native().toStdString());
+    }
     rc.setResponseExtension(re);
     delete deck;
 
     return Response::RespOk;
 }
 
-Response::ResponseCode AbstractServerSocketInterface::cmdReplayList(const Command_ReplayList & /*cmd*/,
+Response::ResponseCode AbstractServerSocketInterface::cmdReplayList(const Command_ReplayList &cmd,
                                                                     ResponseContainer &rc)
 {
     if (authState != PasswordRight)
         return Response::RespFunctionNotAllowed;
 
+    static const quint32 maxMatchesPerPage = 500;
+
     Response_ReplayList *re = new Response_ReplayList;
 
-    QSqlQuery *query1 = sqlInterface->prepareQuery(
-        "select a.id_game, a.replay_name, b.room_name, b.time_started, b.time_finished, b.descr, a.do_not_hide from "
-        "{prefix}_replays_access a left join {prefix}_games b on b.id = a.id_game where a.id_player = :id_player and "
-        "(a.do_not_hide = 1 or date_add(b.time_started, interval 7 day) > now())");
+    QSqlQuery *query1;
+    const int pageSize = static_cast<int>(qMin(cmd.max_matches(), maxMatchesPerPage));
+    if (pageSize == 0) {
+        query1 = sqlInterface->prepareReplicaQuery(DatabaseStatement::SelectReplayAccess);
+    } else if (!cmd.has_before_game_id()) {
+        query1 = sqlInterface->prepareReplicaQuery(DatabaseStatement::SelectReplayAccessPage);
+        query1->bindValue(":limit", pageSize + 1);
+    } else {
+        query1 = sqlInterface->prepareReplicaQuery(DatabaseStatement::SelectReplayAccessPageBefore);
+        query1->bindValue(":before_time", QDateTime::fromSecsSinceEpoch(cmd.before_time()));
+        query1->bindValue(":before_game_id", cmd.before_game_id());
+        query1->bindValue(":limit", pageSize + 1);
+    }
     query1->bindValue(":id_player", userInfo->id());
     sqlInterface->execSqlQuery(query1);
     while (query1->next()) {
+        if (pageSize != 0 && re->match_list_size() == pageSize) {
+            const ServerInfo_ReplayMatch &lastMatch = re->match_list(pageSize - 1);
+            re->set_next_before_time(static_cast<quint32>(lastMatch.time_started()));
+            re->set_next_before_game_id(static_cast<quint32>(lastMatch.game_id()));
+            break;
+        }
         ServerInfo_ReplayMatch *matchInfo = re->add_match_list();
 
         const int gameId = query1->value(0).toInt();
@@ -637,16 +939,14 @@ Response::ResponseCode AbstractServerSocketInterface::cmdReplayList(const Comman
         matchInfo->set_do_not_hide(query1->value(6).toBool());
 
         {
-            QSqlQuery *query2 =
-                sqlInterface->prepareQuery("select player_name from {prefix}_games_players where id_game = :id_game");
+            QSqlQuery *query2 = sqlInterface->prepareReplicaQuery(DatabaseStatement::SelectGamePlayers);
             query2->bindValue(":id_game", gameId);
             sqlInterface->execSqlQuery(query2);
             while (query2->next())
                 matchInfo->add_player_names(query2->value(0).toString().toStdString());
         }
         {
-            QSqlQuery *query3 =
-                sqlInterface->prepareQuery("select id, duration from {prefix}_replays where id_game = :id_game");
+            QSqlQuery *query3 = sqlInterface->prepareReplicaQuery(DatabaseStatement::SelectGameReplays);
             query3->bindValue(":id_game", gameId);
             sqlInterface->execSqlQuery(query3);
             while (query3->next()) {
@@ -669,9 +969,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdReplayDownload(const Co
         return Response::RespFunctionNotAllowed;
 
     {
-        QSqlQuery *query =
-            sqlInterface->prepareQuery("select 1 from {prefix}_replays_access a left join {prefix}_replays b on "
-                                       "a.id_game = b.id_game where b.id = :id_replay and a.id_player = :id_player");
+        QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::ReplayAccessExists);
         query->bindValue(":id_replay", cmd.replay_id());
         query->bindValue(":id_player", userInfo->id());
         if (!sqlInterface->execSqlQuery(query))
@@ -680,7 +978,16 @@ Response::ResponseCode AbstractServerSocketInterface::cmdReplayDownload(const Co
             return Response::RespAccessDenied;
     }
 
-    QSqlQuery *query = sqlInterface->prepareQuery("select replay from {prefix}_replays where id = :id_replay");
+    const bool chunked = cmd.max_length() > 0;
+    QSqlQuery *query;
+    if (chunked) {
+        // only the requested part is read from the database
+        query = sqlInterface->prepareQuery(DatabaseStatement::SelectReplayChunk);
+        query->bindValue(":start", static_cast<qulonglong>(cmd.offset()) + 1);
+        query->bindValue(":length", qMin(cmd.max_length(), maxDownloadChunkSize));
+    } else {
+        query = sqlInterface->prepareQuery(DatabaseStatement::SelectReplayData);
+    }
     query->bindValue(":id_replay", cmd.replay_id());
     if (!sqlInterface->execSqlQuery(query))
         return Response::RespInternalError;
@@ -688,9 +995,32 @@ Response::ResponseCode AbstractServerSocketInterface::cmdReplayDownload(const Co
         return Response::RespNameNotFound;
 
     QByteArray data = query->value(0).toByteArray();
+    quint32 totalSize = chunked ? query->value(1).toUInt() : static_cast<quint32>(data.size());
+
+    const bool compressed = ReplayCompression::isCompressed(chunked ? query->value(2).toByteArray() : data);
+    if (compressed && !clientSupportsFeature(ReplayCompression::featureName)) {
+        // the parts older clients ask for are parts of the uncompressed replay, which has to be read as a whole
+        if (chunked) {
+            query = sqlInterface->prepareQuery(DatabaseStatement::SelectReplayData);
+            query->bindValue(":id_replay", cmd.replay_id());
+            if (!sqlInterface->execSqlQuery(query))
+                return Response::RespInternalError;
+            if (!query->next())
+                return Response::RespNameNotFound;
+        }
+        QByteArray replay;
+        if (!ReplayCompression::uncompress(query->value(0).toByteArray(), replay))
+            return Response::RespInternalError;
+        totalSize = static_cast<quint32>(replay.size());
+        data = chunked ? replay.mid(static_cast<int>(cmd.offset()),
+                                    static_cast<int>(qMin(cmd.max_length(), maxDownloadChunkSize)))
+                       : replay;
+    }
 
     Response_ReplayDownload *re = new Response_ReplayDownload;
     re->set_replay_data(data.data(), data.size());
+    if (chunked)
+        re->set_total_size(totalSize);
     rc.setResponseExtension(re);
 
     return Response::RespOk;
@@ -705,8 +1035,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdReplayModifyMatch(const
     if (!sqlInterface->checkSql())
         return Response::RespInternalError;
 
-    QSqlQuery *query = sqlInterface->prepareQuery("update {prefix}_replays_access set do_not_hide=:do_not_hide where "
-                                                  "id_player = :id_player and id_game = :id_game");
+    QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::UpdateReplayDoNotHide);
     query->bindValue(":id_player", userInfo->id());
     query->bindValue(":id_game", cmd.game_id());
     query->bindValue(":do_not_hide", cmd.do_not_hide());
@@ -725,8 +1054,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdReplayDeleteMatch(const
     if (!sqlInterface->checkSql())
         return Response::RespInternalError;
 
-    QSqlQuery *query = sqlInterface->prepareQuery(
-        "delete from {prefix}_replays_access where id_player = :id_player and id_game = :id_game");
+    QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::DeleteReplayAccess);
     query->bindValue(":id_player", userInfo->id());
     query->bindValue(":id_game", cmd.game_id());
 
@@ -889,7 +1217,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdWarnUser(const Command_
     if (sqlInterface->addWarning(userName, sendingModerator, warningReason, clientId)) {
         servatrice->clientsLock.lockForRead();
         AbstractServerSocketInterface *user =
-            static_cast<AbstractServerSocketInterface *>(server->getUsers().value(userName));
+            static_cast<AbstractServerSocketInterface *>(server->findLocalUser(userName));
         QList<QString> moderatorList = server->getOnlineModeratorList();
         servatrice->clientsLock.unlock();
 
@@ -938,9 +1266,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdBanFromServer(const Com
     if (trustedSources.contains(address, Qt::CaseInsensitive))
         address = "";
 
-    QSqlQuery *query = sqlInterface->prepareQuery(
-        "insert into {prefix}_bans (user_name, ip_address, id_admin, time_from, minutes, reason, visible_reason, "
-        "clientid) values(:user_name, :ip_address, :id_admin, NOW(), :minutes, :reason, :visible_reason, :client_id)");
+    QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::InsertBan);
     query->bindValue(":user_name", userName);
     query->bindValue(":ip_address", address);
     query->bindValue(":id_admin", userInfo->id());
@@ -949,6 +1275,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdBanFromServer(const Com
     query->bindValue(":visible_reason", visibleReason);
     query->bindValue(":client_id", nameFromStdString(cmd.clientid()));
     sqlInterface->execSqlQuery(query);
+    servatrice->invalidateCachedBans();
 
     servatrice->clientsLock.lockForRead();
     QList<QString> moderatorList = server->getOnlineModeratorList();
@@ -956,14 +1283,13 @@ Response::ResponseCode AbstractServerSocketInterface::cmdBanFromServer(const Com
 
     if (!userName.isEmpty()) {
         AbstractServerSocketInterface *user =
-            static_cast<AbstractServerSocketInterface *>(server->getUsers().value(userName));
+            static_cast<AbstractServerSocketInterface *>(server->findLocalUser(userName));
         if (user && !userList.contains(user))
             userList.append(user);
     }
 
     if (userName.isEmpty() && address.isEmpty() && (!clientId.isEmpty())) {
-        QSqlQuery *clientIdQuery =
-            sqlInterface->prepareQuery("select name from {prefix}_users where clientid = :client_id");
+        QSqlQuery *clientIdQuery = sqlInterface->prepareQuery(DatabaseStatement::SelectUsersWithClientId);
         clientIdQuery->bindValue(":client_id", nameFromStdString(cmd.clientid()));
         sqlInterface->execSqlQuery(clientIdQuery);
         if (!sqlInterface->execSqlQuery(clientIdQuery)) {
@@ -972,7 +1298,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdBanFromServer(const Com
             while (clientIdQuery->next()) {
                 userName = clientIdQuery->value(0).toString();
                 AbstractServerSocketInterface *user =
-                    static_cast<AbstractServerSocketInterface *>(server->getUsers().value(userName));
+                    static_cast<AbstractServerSocketInterface *>(server->findLocalUser(userName));
                 if (user && !userList.contains(user))
                     userList.append(user);
             }
@@ -1163,8 +1489,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdRegisterAccount(const C
     if (regSucceeded) {
         qDebug() << "Accepted register command for user:" << userName;
         if (requireEmailActivation) {
-            QSqlQuery *query =
-                sqlInterface->prepareQuery("insert into {prefix}_activation_emails (name) values(:name)");
+            QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::InsertActivationEmail);
             query->bindValue(":name", userName);
             if (!sqlInterface->execSqlQuery(query))
                 return Response::RespRegistrationFailed;
@@ -1304,6 +1629,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdAccountEdit(const Comma
     if (cmd.has_country()) {
         userInfo->set_country(country.toStdString());
     }
+    userInfoChanged();
 
     return Response::RespOk;
 }
@@ -1318,13 +1644,15 @@ Response::ResponseCode AbstractServerSocketInterface::cmdAccountImage(const Comm
     QByteArray image(cmd.image().c_str(), length);
     int id = userInfo->id();
 
-    QSqlQuery *query = sqlInterface->prepareQuery("update {prefix}_users set avatar_bmp=:image where id=:id");
+    QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::UpdateAvatar);
     query->bindValue(":image", image);
     query->bindValue(":id", id);
     if (!sqlInterface->execSqlQuery(query))
         return Response::RespInternalError;
 
     userInfo->set_avatar_bmp(cmd.image().c_str(), length);
+    AvatarHash::updateHash(*userInfo);
+    userInfoChanged();
     return Response::RespOk;
 }
 
@@ -1575,15 +1903,40 @@ Response::ResponseCode AbstractServerSocketInterface::cmdReloadConfig(const Comm
                                                                       ResponseContainer & /*rc*/)
 {
     logDebugMessage("Received admin command: reloading configuration");
-    settingsCache->sync();
+    settingsCache->reload();
     QMetaObject::invokeMethod(server, "setRequiredFeatures", Q_ARG(QString, server->getRequiredFeatures()));
     return Response::RespOk;
 }
 
+Response::ResponseCode AbstractServerSocketInterface::cmdGetActivityTop(const Command_GetActivityTop &cmd,
+                                                                        ResponseContainer &rc)
+{
+    auto *re = new Response_ActivityTop;
+    servatrice->getActivityTop(*re, static_cast<int>(qMin(cmd.top_count(), 200u)), cmd.sort_by());
+    rc.setResponseExtension(re);
+    return Response::RespOk;
+}
+
+Response::ResponseCode AbstractServerSocketInterface::cmdTimelineTrace(const Command_TimelineTrace &cmd,
+                                                                       ResponseContainer & /*rc*/)
+{
+    logDebugMessage(QString("Received admin command: %1 the timeline trace").arg(cmd.enabled() ? "start" : "stop"));
+    QMetaObject::invokeMethod(server, "setTimelineTraceRunning", Q_ARG(bool, cmd.enabled()));
+    return Response::RespOk;
+}
+
+Response::ResponseCode AbstractServerSocketInterface::cmdGetMemoryUsage(const Command_GetMemoryUsage &cmd,
+                                                                        ResponseContainer &rc)
+{
+    auto *re = new Response_MemoryUsage;
+    servatrice->getMemoryUsage(*re, static_cast<int>(qMin(cmd.top_count(), 1000u)));
+    rc.setResponseExtension(re);
+    return Response::RespOk;
+}
+
 bool AbstractServerSocketInterface::addAdminFlagToUser(const QString &userName, int flag)
 {
-    QSqlQuery *query =
-        sqlInterface->prepareQuery("update {prefix}_users set admin = (admin | :adminlevel) where name = :username");
+    QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::AddAdminFlag);
     query->bindValue(":adminlevel", flag);
     query->bindValue(":username", userName);
     if (!sqlInterface->execSqlQuery(query)) {
@@ -1592,7 +1945,7 @@ bool AbstractServerSocketInterface::addAdminFlagToUser(const QString &userName,
     }
 
     AbstractServerSocketInterface *user =
-        static_cast<AbstractServerSocketInterface *>(server->getUsers().value(userName));
+        static_cast<AbstractServerSocketInterface *>(server->findLocalUser(userName));
     if (user) {
         Event_NotifyUser event;
         event.set_type(Event_NotifyUser::PROMOTED);
@@ -1606,8 +1959,7 @@ bool AbstractServerSocketInterface::addAdminFlagToUser(const QString &userName,
 
 bool AbstractServerSocketInterface::removeAdminFlagFromUser(const QString &userName, int flag)
 {
-    QSqlQuery *query =
-        sqlInterface->prepareQuery("update {prefix}_users set admin = (admin & ~ :adminlevel) where name = :username");
+    QSqlQuery *query = sqlInterface->prepareQuery(DatabaseStatement::RemoveAdminFlag);
     query->bindValue(":adminlevel", flag);
     query->bindValue(":username", userName);
     if (!sqlInterface->execSqlQuery(query)) {
@@ -1616,7 +1968,7 @@ bool AbstractServerSocketInterface::removeAdminFlagFromUser(const QString &userN
     }
 
     AbstractServerSocketInterface *user =
-        static_cast<AbstractServerSocketInterface *>(server->getUsers().value(userName));
+        static_cast<AbstractServerSocketInterface *>(server->findLocalUser(userName));
     if (user) {
         Event_ConnectionClosed event;
         event.set_reason(Event_ConnectionClosed::DEMOTED);
@@ -1669,8 +2021,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdGrantReplayAccess(const
                                                                            ResponseContainer & /*rc*/)
 {
     // Determine if the replay actually exists already
-    auto *replayExistsQuery =
-        sqlInterface->prepareQuery("select count(*) from {prefix}_replays_access where id_game = :idgame");
+    auto *replayExistsQuery = sqlInterface->prepareQuery(DatabaseStatement::CountReplayAccess);
     replayExistsQuery->bindValue(":idgame", cmd.replay_id());
     if (!sqlInterface->execSqlQuery(replayExistsQuery)) {
         return Response::RespInternalError;
@@ -1685,7 +2036,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdGrantReplayAccess(const
     }
 
     // Determine the Moderator's User ID (As it's not apart of client, only username is)
-    auto *getModeratorUserIdQuery = sqlInterface->prepareQuery("select id from {prefix}_users WHERE name = :name");
+    auto *getModeratorUserIdQuery = sqlInterface->prepareQuery(DatabaseStatement::SelectUserId);
     getModeratorUserIdQuery->bindValue(":name", QString::fromStdString(cmd.moderator_name()));
     if (!sqlInterface->execSqlQuery(getModeratorUserIdQuery)) {
         return Response::RespInternalError;
@@ -1697,9 +2048,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdGrantReplayAccess(const
     const auto &moderator_id = getModeratorUserIdQuery->value(0).toString();
 
     // Grant the Moderator access to the replay
-    auto *grantReplayAccessQuery =
-        sqlInterface->prepareQuery("insert into {prefix}_replays_access (id_game, id_player, replay_name, do_not_hide) "
-                                   "values(:idgame, :idplayer, :replayname, 0)");
+    auto *grantReplayAccessQuery = sqlInterface->prepareQuery(DatabaseStatement::InsertReplayAccess);
     grantReplayAccessQuery->bindValue(":idgame", cmd.replay_id());
     grantReplayAccessQuery->bindValue(":idplayer", moderator_id);
     grantReplayAccessQuery->bindValue(":replayname", "Moderator Access Replay Grant");
@@ -1715,7 +2064,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdForceActivateUser(const
                                                                            ResponseContainer &rc)
 {
     // Determine if user exists
-    auto *getUserTokenQuery = sqlInterface->prepareQuery("select token from {prefix}_users WHERE name = :name");
+    auto *getUserTokenQuery = sqlInterface->prepareQuery(DatabaseStatement::SelectToken);
     getUserTokenQuery->bindValue(":name", QString::fromStdString(cmd.username_to_activate()));
     if (!sqlInterface->execSqlQuery(getUserTokenQuery)) {
         // Internal server error
@@ -1744,7 +2093,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdForceActivateUser(const
 Response::ResponseCode AbstractServerSocketInterface::cmdGetAdminNotes(const Command_GetAdminNotes &cmd,
                                                                        ResponseContainer &rc)
 {
-    auto *getAdminNotesQuery = sqlInterface->prepareQuery("select adminnotes from {prefix}_users WHERE name = :name");
+    auto *getAdminNotesQuery = sqlInterface->prepareReplicaQuery(DatabaseStatement::SelectAdminNotes);
     getAdminNotesQuery->bindValue(":name", QString::fromStdString(cmd.user_name()));
     if (!sqlInterface->execSqlQuery(getAdminNotesQuery)) {
         // Internal server error
@@ -1767,8 +2116,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdGetAdminNotes(const Com
 Response::ResponseCode AbstractServerSocketInterface::cmdUpdateAdminNotes(const Command_UpdateAdminNotes &cmd,
                                                                           ResponseContainer & /*rc*/)
 {
-    auto *updateAdminNotesQuery =
-        sqlInterface->prepareQuery("update {prefix}_users set adminnotes = :adminnotes where name = :name");
+    auto *updateAdminNotesQuery = sqlInterface->prepareQuery(DatabaseStatement::UpdateAdminNotes);
     updateAdminNotesQuery->bindValue(":adminnotes", QString::fromStdString(cmd.notes()));
     updateAdminNotesQuery->bindValue(":name", QString::fromStdString(cmd.user_name()));
 
@@ -1786,12 +2134,13 @@ Response::ResponseCode AbstractServerSocketInterface::cmdUpdateAdminNotes(const
 TcpServerSocketInterface::TcpServerSocketInterface(Servatrice *_server,
                                                    Servatrice_DatabaseInterface *_databaseInterface,
                                                    QObject *parent)
-    : AbstractServerSocketInterface(_server, _databaseInterface, parent), messageInProgress(false),
-      handshakeStarted(false)
+    : AbstractServerSocketInterface(_server, _databaseInterface, parent), pool(nullptr), messageInProgress(false),
+      handshakeStarted(false), messageLength(0), handedOff(false)
 {
     socket = new QTcpSocket(this);
     socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
     connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
+    connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(socketBytesWritten()));
     connect(socket, SIGNAL(disconnected()), this, SLOT(catchSocketDisconnected()));
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
     connect(socket, SIGNAL(errorOccurred(QAbstractSocket::SocketError)), this,
@@ -1804,9 +2153,113 @@ TcpServerSocketInterface::TcpServerSocketInterface(Servatrice *_server,
 
 TcpServerSocketInterface::~TcpServerSocketInterface()
 {
-    logger->logMessage("TcpServerSocketInterface destructor", this);
+    flushOutputQueue();
+
+    logger->logMessage(QString("TcpServerSocketInterface destructor, %1").arg(getFlushStatistics()), this);
+}
+
+void TcpServerSocketInterface::setConnectionPool(Servatrice_ConnectionPool *_pool)
+{
+    if (pool) {
+        disconnect(this, SIGNAL(destroyed()), pool, SLOT(removeClient()));
+        disconnect(pool, &Servatrice_ConnectionPool::idleClientsWanted, this, &TcpServerSocketInterface::migrateIfIdle);
+        disconnect(pool, &Servatrice_ConnectionPool::clientInputPauseWanted, this,
+                   &TcpServerSocketInterface::pauseInput);
+        disconnect(pool, &Servatrice_ConnectionPool::unmovableClientsDropWanted, this,
+                   &TcpServerSocketInterface::dropIfUnmovable);
+        disconnect(pool, &Servatrice_ConnectionPool::clientHandoffWanted, this, &TcpServerSocketInterface::handOff);
+        pool->removeClient();
+    }
+    pool = _pool;
+    setDatabaseInterface(pool->getDatabaseInterface());
+    pool->addClient();
+    connect(this, SIGNAL(destroyed()), pool, SLOT(removeClient()));
+    connect(pool, &Servatrice_ConnectionPool::idleClientsWanted, this, &TcpServerSocketInterface::migrateIfIdle);
+    connect(pool, &Servatrice_ConnectionPool::clientInputPauseWanted, this, &TcpServerSocketInterface::pauseInput);
+    connect(pool, &Servatrice_ConnectionPool::unmovableClientsDropWanted, this,
+            &TcpServerSocketInterface::dropIfUnmovable);
+    connect(pool, &Servatrice_ConnectionPool::clientHandoffWanted, this, &TcpServerSocketInterface::handOff);
+}
+
+void TcpServerSocketInterface::migrateIfIdle(Servatrice_ConnectionPool *target)
+{
+    // the games talk to their players from the game threads, those connections stay where they are
+    if (target == pool || !getGames().isEmpty() || hasPendingWork() || !pool->takeMigrationSlot())
+        return;
+
+    setConnectionPool(target);
+    // the socket is a child and moves along, so do the events posted to the connection
+    moveToThread(target->thread());
+}
+
+bool TcpServerSocketInterface::canBeHandedOff() const
+{
+    return !deleted && authState != NotLoggedIn && !hasPendingWork();
+}
+
+void TcpServerSocketInterface::pauseInput()
+{
+    // what arrives from now on waits in the socket for the process taking over
+    disconnect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
+}
+
+void TcpServerSocketInterface::dropIfUnmovable()
+{
+    if (!canBeHandedOff())
+        prepareDestroy();
+}
+
+void TcpServerSocketInterface::handOff(void *sessions)
+{
+    if (!canBeHandedOff()) {
+        prepareDestroy();
+        return;
+    }
 
+    // everything sent so far has to reach the client, the new process knows nothing about it
     flushOutputQueue();
+    while (socket->bytesToWrite() > 0 && socket->waitForBytesWritten(2000))
+        ;
+    const int socketDescriptor = HandoffChannel::duplicateDescriptor(static_cast<int>(socket->socketDescriptor()));
+    if (socket->bytesToWrite() > 0 || socketDescriptor < 0) {
+        HandoffChannel::closeDescriptor(socketDescriptor);
+        prepareDestroy();
+        return;
+    }
+    inputBuffer.append(socket->readAll());
+
+    HandoffSession session;
+    getHandoffInfo(session);
+    session.set_unread_input(inputBuffer.data(), inputBuffer.size());
+    session.set_handshake_started(handshakeStarted);
+    session.set_message_length(messageInProgress ? messageLength : -1);
+
+    // Closing our descriptor leaves the connection to the duplicate, the client doesn't notice. The signals go first,
+    // the session must not end here.
+    handedOff = true;
+    socket->disconnect(this);
+    socket->abort();
+    static_cast<QList<QPair<int, QByteArray>> *>(sessions)->append(
+        {socketDescriptor, QByteArray::fromStdString(session.SerializeAsString())});
+}
+
+void TcpServerSocketInterface::adoptHandoff(int socketDescriptor, const QByteArray &serializedSession)
+{
+    server->addClient(this);
+
+    socket->setSocketDescriptor(socketDescriptor);
+    logger->logMessage(QString("Connection carried over: %1").arg(socket->peerAddress().toString()), this);
+
+    HandoffSession session;
+    session.ParseFromArray(serializedSession.constData(), serializedSession.size());
+    handshakeStarted = session.handshake_started();
+    messageInProgress = session.message_length() >= 0;
+    messageLength = messageInProgress ? session.message_length() : 0;
+    inputBuffer.append(QByteArray::fromStdString(session.unread_input()));
+    restoreHandoff(session);
+
+    // handles what the client sent while the servers changed hands
+    readClient();
 }
 
 void TcpServerSocketInterface::initConnection(int socketDescriptor)
@@ -1832,37 +2285,97 @@ void TcpServerSocketInterface::initSessionDeprecated()
 
 void TcpServerSocketInterface::flushOutputQueue()
 {
-    QMutexLocker locker(&outputQueueMutex);
-    if (outputQueue.isEmpty())
+    if (handedOff)
         return;
 
-    int totalBytes = 0;
-    while (!outputQueue.isEmpty()) {
-        ServerMessage item = outputQueue.takeFirst();
-        locker.unlock();
+    // take all pending messages at once, producers can keep appending to the queue while we write
+    QList<QByteArray> items = takeOutputQueue();
+    if (items.isEmpty())
+        return;
 
-        QByteArray buf;
-#if GOOGLE_PROTOBUF_VERSION > 3001000
-        unsigned int size = static_cast<unsigned int>(item.ByteSizeLong());
+    if (clientSupportsFeature(MessageFraming::featureName)) {
+        writeBuffer.clear();
+        MessageFraming::pack(items, servatrice->getTcpMaxBatchSize(), getCompressionThreshold(), writeBuffer);
+    } else {
+        writeLegacyFrames(items);
+    }
+    const int totalBytes = writeBuffer.size();
+
+    const qint64 flushStart = TimelineTrace::now();
+    // In case socket->write() calls catchSocketError(), no lock must be held during this call.
+    writeToSocket(writeBuffer);
+    addFlushStatistics(items.size(), totalBytes, 1);
+
+    servatrice->incTxBytes(totalBytes);
+    // see above wrt locking
+    flushSocket();
+    TimelineTrace::record(TimelineTrace::Flush, "flushOutputQueue", flushStart);
+}
+
+// Frames every message with its length as 4 byte big endian prefix, for the clients that don't know MessageFraming.
+void TcpServerSocketInterface::writeLegacyFrames(QList<QByteArray> &items)
+{
+    QList<bool> compressed;
+    const int compressionThreshold = getCompressionThreshold();
+    for (QByteArray &frame : items) {
+        QByteArray compressedFrame;
+        if (compressionThreshold > 0 && frame.size() >= compressionThreshold &&
+            MessageCompression::compress(frame, compressedFrame)) {
+            frame = compressedFrame;
+            compressed.append(true);
+        } else {
+            compressed.append(false);
+        }
+    }
+
+    int totalBytes = 0;
+    for (const QByteArray &frame : items)
+        totalBytes += frame.size() + 4;
+
+    writeBuffer.resize(totalBytes);
+    char *pos = writeBuffer.data();
+    for (int i = 0; i < items.size(); ++i) {
+        const QByteArray &item = items[i];
+        unsigned int size = static_cast<unsigned int>(item.size());
+        if (compressed[i])
+            size |= MessageCompression::compressedFrameFlag;
+        pos[3] = (unsigned char)size;
+        pos[2] = (unsigned char)(size >> 8);
+        pos[1] = (unsigned char)(size >> 16);
+        pos[0] = (unsigned char)(size >> 24);
+        memcpy(pos + 4, item.constData(), item.size());
+        pos += item.size() + 4;
+    }
+}
+
+// Returns the time it took to parse the command container, in nanoseconds.
+qint64 TcpServerSocketInterface::parseCommandContainer(CommandContainer &cont, const char *data, int size)
+{
+    QElapsedTimer parseTimer;
+    parseTimer.start();
+    try {
+        cont.ParseFromArray(data, size);
+    } catch (std::exception &e) {
+        qDebug() << "Caught std::exception in" << __FILE__ << __LINE__ <<
+#ifdef _MSC_VER // Visual Studio
+            __FUNCTION__;
 #else
-        unsigned int size = static_cast<unsigned int>(item.ByteSize());
+            __PRETTY_FUNCTION__;
 #endif
-        buf.resize(size + 4);
-        item.SerializeToArray(buf.data() + 4, size);
-        buf.data()[3] = (unsigned char)size;
-        buf.data()[2] = (unsigned char)(size >> 8);
-        buf.data()[1] = (unsigned char)(size >> 16);
-        buf.data()[0] = (unsigned char)(size >> 24);
-        // In case socket->write() calls catchSocketError(), the mutex must not be locked during this call.
-        writeToSocket(buf);
-
-        totalBytes += size + 4;
-        locker.relock();
-    }
-    locker.unlock();
-    emit incTxBytes(totalBytes);
-    // see above wrt mutex
-    flushSocket();
+        qDebug() << "Exception:" << e.what();
+        qDebug() << "Message coming from:" << getAddress();
+        qDebug() << "Message length:" << size;
+        qDebug() << "Message content:" << QByteArray(data, size).toHex();
+    } catch (...) {
+        qDebug() << "Unhandled exception in" << __FILE__ << __LINE__ <<
+#ifdef _MSC_VER // Visual Studio
+            __FUNCTION__;
+#else
+            __PRETTY_FUNCTION__;
+#endif
+        qDebug() << "Message coming from:" << getAddress();
+    }
+    return parseTimer.nsecsElapsed();
 }
 
 void TcpServerSocketInterface::readClient()
@@ -1873,12 +2386,14 @@ void TcpServerSocketInterface::readClient()
 
     do {
         if (!messageInProgress) {
-            if (inputBuffer.size() >= 4) {
-                messageLength = (((quint32)(unsigned char)inputBuffer[0]) << 24) +
-                                (((quint32)(unsigned char)inputBuffer[1]) << 16) +
-                                (((quint32)(unsigned char)inputBuffer[2]) << 8) +
-                                ((quint32)(unsigned char)inputBuffer[3]);
-                inputBuffer.remove(0, 4);
+            // only clients that received a frame of the new framing switch to it, see MessageFraming
+            if (handshakeStarted && !inputBuffer.isEmpty() && *inputBuffer.data() == MessageFraming::frameMarker) {
+                if (!readFrame())
+                    return;
+                continue;
+            }
+
+            if (inputBuffer.takeLength(messageLength)) {
                 messageInProgress = true;
             } else
                 return;
@@ -1887,35 +2402,13 @@ void TcpServerSocketInterface::readClient()
             return;
 
         CommandContainer newCommandContainer;
-        try {
-            newCommandContainer.ParseFromArray(inputBuffer.data(), messageLength);
-        } catch (std::exception &e) {
-            qDebug() << "Caught std::exception in" << __FILE__ << __LINE__ <<
-#ifdef _MSC_VER // Visual Studio
-                __FUNCTION__;
-#else
-                __PRETTY_FUNCTION__;
-#endif
-            qDebug() << "Exception:" << e.what();
-            qDebug() << "Message coming from:" << getAddress();
-            qDebug() << "Message length:" << messageLength;
-            qDebug() << "Message content:" << inputBuffer.toHex();
-        } catch (...) {
-            qDebug() << "Unhandled exception in" << __FILE__ << __LINE__ <<
-#ifdef _MSC_VER // Visual Studio
-                __FUNCTION__;
-#else
-                __PRETTY_FUNCTION__;
-#endif
-            qDebug() << "Message coming from:" << getAddress();
-        }
-
-        inputBuffer.remove(0, messageLength);
+        const qint64 parseTime = parseCommandContainer(newCommandContainer, inputBuffer.data(), messageLength);
+        inputBuffer.skip(messageLength);
         messageInProgress = false;
 
         // dirty hack to make v13 client display the correct error message
         if (handshakeStarted)
-            processCommandContainer(newCommandContainer);
+            receiveCommandContainer(newCommandContainer, parseTime);
         else if (!newCommandContainer.has_cmd_id()) {
             handshakeStarted = true;
             if (!initTcpSession())
@@ -1925,6 +2418,30 @@ void TcpServerSocketInterface::readClient()
     } while (!inputBuffer.isEmpty());
 }
 
+// Handles the frame at the start of the input buffer; returns false if it isn't complete yet, or is malformed.
+bool TcpServerSocketInterface::readFrame()
+{
+    QList<QByteArray> messages;
+    const int frameSize = MessageFraming::unpack(inputBuffer.data(), inputBuffer.size(), messages);
+    if (frameSize == 0)
+        return false;
+    if (frameSize < 0) {
+        // there is no telling where the next frame starts
+        logger->logMessage(QString("Malformed frame, dropping connection"), this);
+        inputBuffer.clear();
+        prepareDestroy();
+        return false;
+    }
+
+    inputBuffer.skip(frameSize);
+    for (const QByteArray &message : messages) {
+        CommandContainer newCommandContainer;
+        const qint64 parseTime = parseCommandContainer(newCommandContainer, message.constData(), message.size());
+        receiveCommandContainer(newCommandContainer, parseTime);
+    }
+    return true;
+}
+
 bool TcpServerSocketInterface::initTcpSession()
 {
     if (!initSession())
@@ -1954,15 +2471,15 @@ bool TcpServerSocketInterface::initTcpSession()
 WebsocketServerSocketInterface::WebsocketServerSocketInterface(Servatrice *_server,
                                                                Servatrice_DatabaseInterface *_databaseInterface,
                                                                QObject *parent)
-    : AbstractServerSocketInterface(_server, _databaseInterface, parent), socket(nullptr)
+    : AbstractServerSocketInterface(_server, _databaseInterface, parent), socket(nullptr), unsentBytes(0)
 {
 }
 
 WebsocketServerSocketInterface::~WebsocketServerSocketInterface()
 {
-    logger->logMessage("WebsocketServerSocketInterface destructor", this);
-
     flushOutputQueue();
+
+    logger->logMessage(QString("WebsocketServerSocketInterface destructor, %1").arg(getFlushStatistics()), this);
 }
 
 void WebsocketServerSocketInterface::initConnection(void *_socket)
@@ -1990,6 +2507,7 @@ void WebsocketServerSocketInterface::initConnection(void *_socket)
 
     connect(socket, SIGNAL(binaryMessageReceived(const QByteArray &)), this,
             SLOT(binaryMessageReceived(const QByteArray &)));
+    connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(websocketBytesWritten(qint64)));
     connect(socket, SIGNAL(error(QAbstractSocket::SocketError)), this,
             SLOT(catchSocketError(QAbstractSocket::SocketError)));
     connect(socket, SIGNAL(disconnected()), this, SLOT(catchSocketDisconnected()));
@@ -2035,33 +2553,36 @@ bool WebsocketServerSocketInterface::initWebsocketSession()
 
 void WebsocketServerSocketInterface::flushOutputQueue()
 {
-    QMutexLocker locker(&outputQueueMutex);
-    if (outputQueue.isEmpty())
+    const QList<QByteArray> items = takeOutputQueue();
+    if (items.isEmpty())
         return;
 
-    qint64 totalBytes = 0;
-    while (!outputQueue.isEmpty()) {
-        ServerMessage item = outputQueue.takeFirst();
-        locker.unlock();
+    // websocket messages are framed by the websocket protocol, without batching every item needs its own message
+    const int maxBatchSize =
+        clientSupportsFeature(MessageBatching::featureName) ? servatrice->getWebsocketMaxBatchSize() : 0;
+    QList<QByteArray> websocketMessages = MessageBatching::pack(items, maxBatchSize, getCompressionThreshold());
 
-        QByteArray buf;
-#if GOOGLE_PROTOBUF_VERSION > 3001000
-        unsigned int size = static_cast<unsigned int>(item.ByteSizeLong());
-#else
-        unsigned int size = static_cast<unsigned int>(item.ByteSize());
-#endif
-        buf.resize(size);
-        item.SerializeToArray(buf.data(), size);
-        // In case socket->write() calls catchSocketError(), the mutex must not be locked during this call.
-        writeToSocket(buf);
+    const qint64 flushStart = TimelineTrace::now();
+    qint64 totalBytes = 0;
+    for (QByteArray &websocketMessage : websocketMessages) {
+        // In case socket->write() calls catchSocketError(), no lock must be held during this call.
+        writeToSocket(websocketMessage);
 
-        totalBytes += size;
-        locker.relock();
+        totalBytes += websocketMessage.size();
     }
-    locker.unlock();
-    emit incTxBytes(totalBytes);
-    // see above wrt mutex
+    addFlushStatistics(items.size(), totalBytes, websocketMessages.size());
+
+    servatrice->incTxBytes(totalBytes);
+    // see above wrt locking
     flushSocket();
+    TimelineTrace::record(TimelineTrace::Flush, "flushOutputQueue", flushStart);
+}
+
+void WebsocketServerSocketInterface::websocketBytesWritten(qint64 bytes)
+{
+    // bytes also counts the frame headers, so unsentBytes runs a little low
+    unsentBytes = qMax(qint64(0), unsentBytes - bytes);
+    socketBytesWritten();
 }
 
 void WebsocketServerSocketInterface::binaryMessageReceived(const QByteArray &message)
@@ -2069,6 +2590,8 @@ void WebsocketServerSocketInterface::binaryMessageReceived(const QByteArray &mes
     servatrice->incRxBytes(message.size());
 
     CommandContainer newCommandContainer;
+    QElapsedTimer parseTimer;
+    parseTimer.start();
     try {
         newCommandContainer.ParseFromArray(message.data(), message.size());
     } catch (std::exception &e) {
@@ -2092,7 +2615,100 @@ void WebsocketServerSocketInterface::binaryMessageReceived(const QByteArray &mes
         qDebug() << "Message coming from:" << getAddress();
     }
 
-    processCommandContainer(newCommandContainer);
+    receiveCommandContainer(newCommandContainer, parseTimer.nsecsElapsed());
+}
+
+void AbstractServerSocketInterface::receiveCommandContainer(const CommandContainer &cont, qint64 parseTime)
+{
+    if (passwordHashPending) {
+        // a client waiting for its login has no reason to send much else
+        if (pendingCommandContainers.size() >= maxCommandsWaitingForLogin) {
+            qDebug() << "Too many commands while waiting for the login, closing connection to" << getAddress();
+            prepareDestroy();
+            return;
+        }
+        pendingCommandContainers.append(cont);
+        return;
+    }
+
+    if (!hashLoginPassword(cont))
+        processTimedCommandContainer(cont, parseTime);
+}
+
+// the order in which Server_ProtocolHandler::processCommandContainer looks at them
+static QString commandContainerType(const CommandContainer &cont)
+{
+    if (cont.game_command_size())
+        return "game";
+    if (cont.room_command_size())
+        return "room";
+    if (cont.session_command_size())
+        return "session";
+    if (cont.moderator_command_size())
+        return "moderator";
+    if (cont.admin_command_size())
+        return "admin";
+    return "invalid";
+}
+
+void AbstractServerSocketInterface::processTimedCommandContainer(const CommandContainer &cont, qint64 parseTime)
+{
+    QElapsedTimer timer;
+    timer.start();
+    processCommandContainer(cont, parseTime);
+    servatrice->getCommandDurationHistogram(commandContainerType(cont))->observe(timer.nsecsElapsed() / 1000);
+}
+
+bool AbstractServerSocketInterface::hashLoginPassword(const CommandContainer &cont)
+{
+    PasswordHashPool *hashPool = servatrice->getPasswordHashPool();
+    if (!hashPool || userInfo || cont.session_command_size() != 1)
+        return false;
+
+    const SessionCommand &sc = cont.session_command(0);
+    if (getPbExtension(sc) != SessionCommand::LOGIN)
+        return false;
+    const Command_Login &cmd = sc.GetExtension(Command_Login::ext);
+    // cmdLogin turns these down right away
+    if (!cmd.has_password() || cmd.password().length() > MAX_NAME_LENGTH)
+        return false;
+
+    // Server::loginUser shortens the name the same way
+    const QString userName = nameFromStdString(cmd.user_name()).simplified().left(35);
+    const QString salt = sqlInterface->getUserSalt(userName);
+    if (salt.isEmpty())
+        return false;
+
+    const QString password = QString::fromStdString(cmd.password());
+    if (!hashPool->enqueue(password, salt, this, [this, password, salt](const QString &hash) {
+            hashedPassword = password;
+            hashedPasswordSalt = salt;
+            passwordHash = hash;
+            passwordHashPending = false;
+
+            QList<CommandContainer> pending;
+            pending.swap(pendingCommandContainers);
+            processTimedCommandContainer(pending.takeFirst());
+            passwordHash.clear();
+            for (const CommandContainer &next : pending)
+                receiveCommandContainer(next);
+        }))
+        return false;
+
+    passwordHashPending = true;
+    pendingCommandContainers.append(cont);
+    return true;
+}
+
+QString AbstractServerSocketInterface::takePrecomputedPasswordHash(const QString &password, const QString &salt)
+{
+    if (passwordHash.isEmpty() || password != hashedPassword || salt != hashedPasswordSalt)
+        return QString();
+
+    QString result;
+    result.swap(passwordHash);
+    hashedPassword.clear();
+    return result;
 }
 
 bool AbstractServerSocketInterface::isPasswordLongEnough(const int passwordLength)
@@ -20,6 +20,10 @@
 #ifndef SERVERSOCKETINTERFACE_H
 #define SERVERSOCKETINTERFACE_H
 
+#include "framed_input_buffer.h"
+#include "output_queue.h"
+#include "pb/commands.pb.h"
+#include "pb/serverinfo_deckstorage.pb.h"
 #include "server_protocolhandler.h"
 
 #include <QHostAddress>
@@ -28,8 +32,10 @@
 #include <QWebSocket>
 
 class Servatrice;
+class Servatrice_ConnectionPool;
 class Servatrice_DatabaseInterface;
 class DeckList;
+class MetricsCounter;
 class ServerInfo_DeckStorage_Folder;
 
 class Command_AddToList;
@@ -49,6 +55,9 @@ class Command_BanFromServer;
 class Command_UpdateServerMessage;
 class Command_ShutdownServer;
 class Command_ReloadConfig;
+class Command_GetMemoryUsage;
+class Command_TimelineTrace;
+class Command_GetActivityTop;
 
 class Command_AccountEdit;
 class Command_AccountImage;
@@ -61,29 +70,75 @@ protected slots:
     void catchSocketError(QAbstractSocket::SocketError socketError);
     void catchSocketDisconnected();
     virtual void flushOutputQueue() = 0;
+    // resumes output that was held back while the client was reading slowly
+    void socketBytesWritten();
 signals:
     void outputQueueChanged();
-    void incTxBytes(qint64 amount);
 
 protected:
     void logDebugMessage(const QString &message);
+    void logDebugCommand(const QString &prefix, const ::google::protobuf::Message &command) override;
     bool tooManyRegistrationAttempts(const QString &ipAddress);
 
     virtual void writeToSocket(QByteArray &data) = 0;
     virtual void flushSocket() = 0;
+    // what was written to the socket but hasn't been sent to the client yet
+    virtual qint64 getSocketBytesToWrite() const = 0;
+
+    void transmitSerializedItem(const QByteArray &serializedMessage);
+    QList<QByteArray> takeOutputQueue();
+    // Processes a command container received from the client. A login's password may be hashed on the password hash
+    // pool first, until then the following commands wait. parseTime is in nanoseconds, for the command trace.
+    void receiveCommandContainer(const CommandContainer &cont, qint64 parseTime = 0);
+    void addFlushStatistics(int messages, qint64 bytes, int writes);
+    QString getFlushStatistics() const;
+    int getCompressionThreshold() const;
+    // for a connection moving to another pool
+    void setDatabaseInterface(Servatrice_DatabaseInterface *_databaseInterface);
+    // a login waiting for its hash or output held back for a slow client, either keeps the connection in its pool
+    bool hasPendingWork() const;
 
     Servatrice *servatrice;
-    QList<ServerMessage> outputQueue;
-    QMutex outputQueueMutex;
+    // serialized ServerMessages, without any transport framing
+    OutputQueue outputQueue;
+
+    // per connection counters used to tune output batching
+    qint64 flushCount, flushedMessages, flushedBytes, socketWrites;
+
+    // Output taken from outputQueue that isn't written to the socket yet, because the client doesn't keep up with
+    // reading. Once the backlog exceeds the high watermark, the held back messages are pruned; see OutputPruning.
+    QList<QByteArray> heldBackItems;
+    // heldBackBytes is read by the metrics thread as well, see getOutputBytes()
+    std::atomic<qint64> heldBackBytes;
+    qint64 heldBackBytesAtLastPrune;
+    bool aboveHighWatermark;
+    MetricsCounter *highWatermarkCrossings, *lowWatermarkCrossings, *prunedMessages, *slowClientDisconnects;
 
 private:
     Servatrice_DatabaseInterface *sqlInterface;
 
+    // the login waiting for its password hash comes first
+    QList<CommandContainer> pendingCommandContainers;
+    bool passwordHashPending;
+    QString hashedPassword, hashedPasswordSalt, passwordHash;
+    bool hashLoginPassword(const CommandContainer &cont);
+
+    // the deck storage of the user as it was last listed, until one of the deck commands changes it
+    ServerInfo_DeckStorage_Folder deckStorageTree;
+    bool deckStorageTreeValid;
+    // processCommandContainer(), recording how long it took
+    void processTimedCommandContainer(const CommandContainer &cont, qint64 parseTime = 0);
+
     Response::ResponseCode cmdAddToList(const Command_AddToList &cmd, ResponseContainer &rc);
     Response::ResponseCode cmdRemoveFromList(const Command_RemoveFromList &cmd, ResponseContainer &rc);
     int getDeckPathId(int basePathId, QStringList path);
     int getDeckPathId(const QString &path);
-    bool deckListHelper(int folderId, ServerInfo_DeckStorage_Folder *folder);
+    bool loadDeckStorageTree(ServerInfo_DeckStorage_Folder *root);
+    ServerInfo_DeckStorage_TreeItem *findCachedDeckStorageItem(int id,
+                                                               bool isFolder,
+                                                               ServerInfo_DeckStorage_Folder **parent = nullptr,
+                                                               int *row = nullptr);
+    ServerInfo_DeckStorage_Folder *findCachedDeckStorageFolder(int folderId);
     Response::ResponseCode cmdDeckList(const Command_DeckList &cmd, ResponseContainer &rc);
     Response::ResponseCode cmdDeckNewDir(const Command_DeckNewDir &cmd, ResponseContainer &rc);
     void deckDelDirHelper(int basePathId);
@@ -109,6 +164,8 @@ private:
     Response::ResponseCode cmdActivateAccount(const Command_Activate &cmd, ResponseContainer & /* rc */);
     Response::ResponseCode cmdReloadConfig(const Command_ReloadConfig & /* cmd */, ResponseContainer & /*rc*/);
     Response::ResponseCode cmdAdjustMod(const Command_AdjustMod &cmd, ResponseContainer & /*rc*/);
+    Response::ResponseCode cmdGetMemoryUsage(const Command_GetMemoryUsage &cmd, ResponseContainer &rc);
+    Response::ResponseCode cmdTimelineTrace(const Command_TimelineTrace &cmd, ResponseContainer & /*rc*/);
     Response::ResponseCode cmdForgotPasswordRequest(const Command_ForgotPasswordRequest &cmd, ResponseContainer &rc);
     Response::ResponseCode continuePasswordRequest(const QString &userName,
                                                    const QString &clientId,
@@ -131,6 +188,7 @@ private:
 
     Response::ResponseCode cmdGetAdminNotes(const Command_GetAdminNotes &cmd, ResponseContainer &rc);
     Response::ResponseCode cmdUpdateAdminNotes(const Command_UpdateAdminNotes &cmd, ResponseContainer &rc);
+    Response::ResponseCode cmdGetActivityTop(const Command_GetActivityTop &cmd, ResponseContainer &rc);
 
     bool addAdminFlagToUser(const QString &user, int flag);
     bool removeAdminFlagFromUser(const QString &user, int flag);
@@ -147,8 +205,22 @@ public:
 
     virtual QHostAddress getPeerAddress() const = 0;
     virtual QString getAddress() const = 0;
+    // any thread; the output queued or held back, not counting what the socket itself buffers
+    qint64 getOutputBytes() const
+    {
+        return outputQueue.getQueuedBytes() + heldBackBytes.load(std::memory_order_relaxed);
+    }
 
     void transmitProtocolItem(const ServerMessage &item);
+    void sendSerializedProtocolItem(const GameEventContainer &item, const QByteArray &serializedMessage);
+    void sendSerializedProtocolItem(const RoomEvent &item, const QByteArray &serializedMessage);
+    void sendSerializedResponse(const QByteArray &serializedMessage);
+    void sendSerializedServerMessage(const QByteArray &serializedMessage);
+    /**
+     * Returns the hash computed by the password hash pool for this login, or an empty string if there is none for
+     * this password and salt.
+     */
+    QString takePrecomputedPasswordHash(const QString &password, const QString &salt);
 };
 
 class TcpServerSocketInterface : public AbstractServerSocketInterface
@@ -172,13 +244,22 @@ public:
     {
         return "tcp";
     };
+    // counts the connection in pool, which may later ask it to move to another one, see migrateIfIdle()
+    void setConnectionPool(Servatrice_ConnectionPool *_pool);
 
 private:
+    Servatrice_ConnectionPool *pool;
     QTcpSocket *socket;
-    QByteArray inputBuffer;
+    FramedInputBuffer inputBuffer;
+    // reused between flushes so that the framed output doesn't need a new allocation every time
+    QByteArray writeBuffer;
     bool messageInProgress;
     bool handshakeStarted;
     int messageLength;
+    // the socket belongs to the process that took over, nothing may be written to it anymore
+    bool handedOff;
+    // logged in without anything in flight, see handOff()
+    bool canBeHandedOff() const;
 
 protected:
     void writeToSocket(QByteArray &data)
@@ -189,13 +270,28 @@ protected:
     {
         socket->flush();
     };
+    qint64 getSocketBytesToWrite() const
+    {
+        return socket->bytesToWrite();
+    }
     void initSessionDeprecated();
     bool initTcpSession();
+    void writeLegacyFrames(QList<QByteArray> &items);
+    qint64 parseCommandContainer(CommandContainer &cont, const char *data, int size);
+    bool readFrame();
 protected slots:
     void readClient();
     void flushOutputQueue();
+    // moves the connection and its socket to the thread of target, unless it is in a game
+    void migrateIfIdle(Servatrice_ConnectionPool *target);
+    // the hot restart, see Servatrice_ConnectionPool::handOffClients()
+    void pauseInput();
+    void dropIfUnmovable();
+    void handOff(void *sessions);
 public slots:
     void initConnection(int socketDescriptor);
+    // goes on with a session carried over from the process that ran before, with the games it is in adopted
+    void adoptHandoff(int socketDescriptor, const QByteArray &serializedSession);
 };
 
 class WebsocketServerSocketInterface : public AbstractServerSocketInterface
@@ -223,19 +319,26 @@ public:
 private:
     QWebSocket *socket;
     QHostAddress address;
+    // QWebSocket doesn't tell how much it still has to send, this counts the bytes written but not sent yet
+    qint64 unsentBytes;
 
 protected:
     void writeToSocket(QByteArray &data)
     {
-        socket->sendBinaryMessage(data);
+        unsentBytes += socket->sendBinaryMessage(data);
     };
     void flushSocket()
     {
         socket->flush();
     };
+    qint64 getSocketBytesToWrite() const
+    {
+        return unsentBytes;
+    }
     bool initWebsocketSession();
 protected slots:
     void binaryMessageReceived(const QByteArray &message);
+    void websocketBytesWritten(qint64 bytes);
     void flushOutputQueue();
 public slots:
     void initConnection(void *_socket);
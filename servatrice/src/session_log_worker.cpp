@@ -0,0 +1,86 @@
+#include "session_log_worker.h"
+
+#include <QDebug>
+#include <QThread>
+#include <QTimer>
+
+SessionLogWorker::SessionLogWorker(Servatrice_DatabaseInterface *_databaseInterface,
+                                   int _maxQueueSize,
+                                   int _maxBatchSize,
+                                   int _flushInterval)
+    : databaseInterface(_databaseInterface), maxQueueSize(qMax(1, _maxQueueSize)), maxBatchSize(qMax(1, _maxBatchSize)),
+      peakQueueDepth(0), processingScheduled(false), storedChanges(0), failedChanges(0), rejectedChanges(0)
+{
+    flushTimer = new QTimer(this);
+    flushTimer->setInterval(qMax(1, _flushInterval));
+    connect(flushTimer, &QTimer::timeout, this, &SessionLogWorker::processQueue);
+}
+
+SessionLogWorker::~SessionLogWorker()
+{
+    processQueue();
+    delete databaseInterface;
+    thread()->quit();
+}
+
+void SessionLogWorker::start()
+{
+    flushTimer->start();
+}
+
+bool SessionLogWorker::enqueue(const LoggedSession &session)
+{
+    QMutexLocker locker(&queueMutex);
+    if (queue.size() >= maxQueueSize) {
+        ++rejectedChanges;
+        return false;
+    }
+
+    queue.append(session);
+    peakQueueDepth = qMax(peakQueueDepth, queue.size());
+    // smaller batches wait for the flush timer
+    if (queue.size() >= maxBatchSize && !processingScheduled) {
+        processingScheduled = true;
+        QMetaObject::invokeMethod(this, "processQueue", Qt::QueuedConnection);
+    }
+    return true;
+}
+
+int SessionLogWorker::getQueueDepth() const
+{
+    QMutexLocker locker(&queueMutex);
+    return queue.size();
+}
+
+int SessionLogWorker::takePeakQueueDepth()
+{
+    QMutexLocker locker(&queueMutex);
+    const int result = peakQueueDepth;
+    peakQueueDepth = queue.size();
+    return result;
+}
+
+void SessionLogWorker::processQueue()
+{
+    for (;;) {
+        QList<LoggedSession> batch;
+        {
+            QMutexLocker locker(&queueMutex);
+            if (queue.isEmpty()) {
+                processingScheduled = false;
+                return;
+            }
+            const int batchSize = qMin(maxBatchSize, queue.size());
+            batch = queue.mid(0, batchSize);
+            queue.erase(queue.begin(), queue.begin() + batchSize);
+        }
+
+        // the batches go in the order they were queued, so an end never comes before the start of its session
+        if (databaseInterface->checkSql() && databaseInterface->storeLoggedSessions(batch)) {
+            storedChanges += batch.size();
+        } else {
+            failedChanges += batch.size();
+            qCritical() << "SessionLogWorker: could not store" << batch.size() << "session changes";
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef SESSION_LOG_WORKER_H
+#define SESSION_LOG_WORKER_H
+
+#include "servatrice_database_interface.h"
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <atomic>
+
+class QTimer;
+
+/**
+ * Writes the starts and ends of the sessions to the sessions table from a thread of its own.
+ *
+ * Logging in and out only queues the change; which sessions are active is known from the users of the server, the
+ * table is a record for the server operators. The worker writes the changes in batches of up to maxBatchSize, and at
+ * least every flushInterval milliseconds. Once maxQueueSize changes are waiting enqueue() refuses them, and the caller
+ * is expected to write them itself.
+ *
+ * The worker lives in its own thread and owns its database interface; deleting it writes whatever is still queued
+ * and quits the thread.
+ */
+class SessionLogWorker : public QObject
+{
+    Q_OBJECT
+public:
+    SessionLogWorker(Servatrice_DatabaseInterface *_databaseInterface,
+                     int _maxQueueSize,
+                     int _maxBatchSize,
+                     int _flushInterval);
+    ~SessionLogWorker() override;
+
+    // thread safe
+    bool enqueue(const LoggedSession &session);
+
+    int getQueueDepth() const;
+    // returns the largest queue depth since the last call
+    int takePeakQueueDepth();
+    quint64 getStoredChangeCount() const
+    {
+        return storedChanges.load(std::memory_order_relaxed);
+    }
+    quint64 getFailedChangeCount() const
+    {
+        return failedChanges.load(std::memory_order_relaxed);
+    }
+    quint64 getRejectedChangeCount() const
+    {
+        return rejectedChanges.load(std::memory_order_relaxed);
+    }
+
+public slots:
+    // writes everything queued so far, also called from other threads with a blocking queued connection
+    void processQueue();
+
+private slots:
+    void start();
+
+private:
+    Servatrice_DatabaseInterface *databaseInterface;
+    const int maxQueueSize;
+    const int maxBatchSize;
+    QTimer *flushTimer;
+
+    mutable QMutex queueMutex;
+    QList<LoggedSession> queue;
+    int peakQueueDepth;
+    bool processingScheduled;
+
+    std::atomic<quint64> storedChanges, failedChanges, rejectedChanges;
+};
+
+#endif
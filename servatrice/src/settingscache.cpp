@@ -1,13 +1,82 @@
 #include "settingscache.h"
 
+#include "command_trace.h"
+
 #include <QCoreApplication>
 #include <QDebug>
 #include <QFile>
 #include <QStandardPaths>
 
+ServatriceConfig::ServatriceConfig(const QSettings &settings)
+{
+    writeLog = settings.value("server/writelog", 1).toBool();
+    const QString logFilterString = settings.value("server/logfilters").toString();
+    if (!logFilterString.trimmed().isEmpty()) {
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+        logFilters = logFilterString.split(",", Qt::SkipEmptyParts);
+#else
+        logFilters = logFilterString.split(",", QString::SkipEmptyParts);
+#endif
+    }
+    logCommandSampleRate = qMax(1, settings.value("server/log_command_sample_rate", 1).toInt());
+    maxPlayerInactivityTime = settings.value("server/max_player_inactivity_time", 15).toInt();
+    clientKeepAlive = settings.value("server/clientkeepalive", 1).toInt();
+    compressionThreshold = settings.value("server/compression_threshold", 1024).toInt();
+    outputQueueHighWatermark = settings.value("server/output_queue_high_watermark", 4 * 1024 * 1024).toLongLong();
+    outputQueueLowWatermark =
+        qMin(settings.value("server/output_queue_low_watermark", 1024 * 1024).toLongLong(), outputQueueHighWatermark);
+    outputQueueHardLimit = settings.value("server/output_queue_hard_limit", 32 * 1024 * 1024).toLongLong();
+    websocketMaxBatchSize = settings.value("server/websocket_max_batch_size", 64 * 1024).toInt();
+    tcpMaxBatchSize = settings.value("server/tcp_max_batch_size", 64 * 1024).toInt();
+    idleClientTimeout = settings.value("server/idleclienttimeout", 3600).toInt();
+    commandTraceSampleRate = settings.value("server/trace_commands", 0).toInt();
+    slowCommandThreshold = settings.value("server/trace_slow_commands", 0).toInt();
+    buddyOnlyPresence = settings.value("server/presence_buddies_only", false).toBool();
+    const QString thresholdString = settings.value("server/trace_slow_command_thresholds").toString();
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+    const QStringList thresholdEntries = thresholdString.split(",", Qt::SkipEmptyParts);
+#else
+    const QStringList thresholdEntries = thresholdString.split(",", QString::SkipEmptyParts);
+#endif
+    for (const QString &entry : thresholdEntries) {
+        const int commandKey = CommandTrace::commandKeyFromName(entry.section('=', 0, 0).trimmed());
+        if (commandKey == -1)
+            qWarning() << "Unknown command in server/trace_slow_command_thresholds:" << entry;
+        else
+            slowCommandThresholds.insert(commandKey, entry.section('=', 1).toInt());
+    }
+
+    enableMaxUserLimit = settings.value("security/enable_max_user_limit", false).toBool();
+    maxUsersTotal = settings.value("security/max_users_total", 500).toInt();
+    maxUsersPerAddress = settings.value("security/max_users_per_address", 4).toInt();
+    messageCountingInterval = settings.value("security/message_counting_interval", 10).toInt();
+    maxMessageCountPerInterval = settings.value("security/max_message_count_per_interval", 15).toInt();
+    maxMessageSizePerInterval = settings.value("security/max_message_size_per_interval", 1000).toInt();
+    maxGamesPerUser = settings.value("security/max_games_per_user", 5).toInt();
+    commandCountingInterval = settings.value("security/command_counting_interval", 10).toInt();
+    maxCommandCountPerInterval = settings.value("security/max_command_count_per_interval", 20).toInt();
+
+    storeReplays = settings.value("game/store_replays", true).toBool();
+    compressReplays = settings.value("game/compress_replays", true).toBool();
+    maxGameInactivityTime = settings.value("game/max_game_inactivity_time", 120).toInt();
+    gameHibernationTime = settings.value("game/hibernation_time", 0).toInt();
+    pingVectorInterval = settings.value("game/ping_vector_interval", 5).toInt();
+    spectatorStreamInterval = settings.value("game/spectator_stream_interval", 0).toInt();
+    spectatorStreamDelay = settings.value("game/spectator_delay", 0).toInt();
+    resumeLogLength = settings.value("game/resume_log_length", 256).toInt();
+    gameListUpdateInterval = settings.value("game/game_list_update_interval", 250).toInt();
+
+    logUserMessagesInRooms = settings.value("logging/log_user_msg_room", 0).toBool();
+    logUserMessagesInGames = settings.value("logging/log_user_msg_game", 0).toBool();
+    logUserMessagesInChats = settings.value("logging/log_user_msg_chat", 0).toBool();
+    logUserMessagesFromIsl = settings.value("logging/log_user_msg_isl", 0).toBool();
+}
+
 SettingsCache::SettingsCache(const QString &fileName, QSettings::Format format, QObject *parent)
-    : QSettings(fileName, format, parent)
+    : QSettings(fileName, format, parent), currentConfig(nullptr)
 {
+    currentConfig.store(new ServatriceConfig(*this), std::memory_order_release);
+
     // first, figure out if we are running in portable mode
     isPortableBuild = QFile::exists(qApp->applicationDirPath() + "/portable.dat");
 
@@ -23,6 +92,19 @@ SettingsCache::SettingsCache(const QString &fileName, QSettings::Format format,
     }
 }
 
+SettingsCache::~SettingsCache()
+{
+    delete currentConfig.load();
+    qDeleteAll(retiredConfigs);
+}
+
+void SettingsCache::reload()
+{
+    QMutexLocker locker(&reloadMutex);
+    sync();
+    retiredConfigs.append(currentConfig.exchange(new ServatriceConfig(*this), std::memory_order_acq_rel));
+}
+
 QString SettingsCache::guessConfigurationPath()
 {
     const QString fileName = "servatrice.ini";
@@ -1,10 +1,70 @@
 #ifndef SERVATRICE_SETTINGSCACHE_H
 #define SERVATRICE_SETTINGSCACHE_H
 
+#include <QHash>
 #include <QList>
+#include <QMutex>
 #include <QRegularExpression>
 #include <QSettings>
 #include <QString>
+#include <QStringList>
+#include <atomic>
+
+/**
+ * The settings read by hot paths, converted from the settings file once instead of on every call.
+ */
+struct ServatriceConfig
+{
+    explicit ServatriceConfig(const QSettings &settings);
+
+    // [server]
+    bool writeLog;
+    QStringList logFilters;
+    int logCommandSampleRate;
+    int maxPlayerInactivityTime;
+    int clientKeepAlive;
+    int compressionThreshold;
+    // output held back for a slow client, in bytes
+    qint64 outputQueueHighWatermark;
+    qint64 outputQueueLowWatermark;
+    qint64 outputQueueHardLimit;
+    int websocketMaxBatchSize;
+    int tcpMaxBatchSize;
+    int idleClientTimeout;
+    int commandTraceSampleRate;
+    int slowCommandThreshold;
+    bool buddyOnlyPresence;
+    // by CommandTrace::commandKey(), overriding slowCommandThreshold
+    QHash<int, int> slowCommandThresholds;
+
+    // [security]
+    bool enableMaxUserLimit;
+    int maxUsersTotal;
+    int maxUsersPerAddress;
+    int messageCountingInterval;
+    int maxMessageCountPerInterval;
+    int maxMessageSizePerInterval;
+    int maxGamesPerUser;
+    int commandCountingInterval;
+    int maxCommandCountPerInterval;
+
+    // [game]
+    bool storeReplays;
+    bool compressReplays;
+    int maxGameInactivityTime;
+    int gameHibernationTime;
+    int pingVectorInterval;
+    int spectatorStreamInterval;
+    int spectatorStreamDelay;
+    int resumeLogLength;
+    int gameListUpdateInterval;
+
+    // [logging]
+    bool logUserMessagesInRooms;
+    bool logUserMessagesInGames;
+    bool logUserMessagesInChats;
+    bool logUserMessagesFromIsl;
+};
 
 class SettingsCache : public QSettings
 {
@@ -12,16 +72,35 @@ class SettingsCache : public QSettings
 private:
     bool isPortableBuild;
 
+    QMutex reloadMutex;
+    std::atomic<const ServatriceConfig *> currentConfig;
+    // replaced snapshots, kept alive because other threads might still be reading them
+    QList<const ServatriceConfig *> retiredConfigs;
+
 public:
     SettingsCache(const QString &fileName = "servatrice.ini",
                   QSettings::Format format = QSettings::IniFormat,
                   QObject *parent = 0);
+    ~SettingsCache() override;
     static QString guessConfigurationPath();
     QList<QRegularExpression> disallowedRegExp;
     bool getIsPortableBuild() const
     {
         return isPortableBuild;
     }
+
+    /**
+     * Returns the current snapshot of the hot settings without locking. The reference stays valid, but a
+     * reload() only affects later calls.
+     */
+    const ServatriceConfig &config() const
+    {
+        return *currentConfig.load(std::memory_order_acquire);
+    }
+    /**
+     * Rereads the settings file and publishes a new config snapshot.
+     */
+    void reload();
 };
 
 extern SettingsCache *settingsCache;
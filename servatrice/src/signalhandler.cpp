@@ -19,8 +19,9 @@
 #define SIGSEGV_TRACE_LINES 40
 
 int SignalHandler::sigHupFD[2];
+int SignalHandler::sigUsr2FD[2];
 
-SignalHandler::SignalHandler(QObject *parent) : QObject(parent), snHup(nullptr)
+SignalHandler::SignalHandler(QObject *parent) : QObject(parent), snHup(nullptr), snUsr2(nullptr)
 {
 #ifdef Q_OS_UNIX
     ::socketpair(AF_UNIX, SOCK_STREAM, 0, sigHupFD);
@@ -35,6 +36,18 @@ SignalHandler::SignalHandler(QObject *parent) : QObject(parent), snHup(nullptr)
     hup.sa_flags |= SA_RESTART;
     sigaction(SIGHUP, &hup, 0);
 
+    ::socketpair(AF_UNIX, SOCK_STREAM, 0, sigUsr2FD);
+
+    snUsr2 = new QSocketNotifier(sigUsr2FD[1], QSocketNotifier::Read, this);
+    connect(snUsr2, SIGNAL(activated(int)), this, SLOT(internalSigUsr2Handler()));
+
+    struct sigaction usr2;
+    usr2.sa_handler = SignalHandler::sigUsr2Handler;
+    sigemptyset(&usr2.sa_mask);
+    usr2.sa_flags = 0;
+    usr2.sa_flags |= SA_RESTART;
+    sigaction(SIGUSR2, &usr2, 0);
+
     struct sigaction segv;
     segv.sa_handler = SignalHandler::sigSegvHandler;
     segv.sa_flags = SA_RESETHAND;
@@ -68,11 +81,34 @@ void SignalHandler::internalSigHupHandler()
     logger->logMessage("Received SIGHUP, rotating logs and reloading configuration", this);
     logger->rotateLogs();
 
-    settingsCache->sync();
+    settingsCache->reload();
 
     snHup->setEnabled(true);
 }
 
+void SignalHandler::sigUsr2Handler(int /* sig */)
+{
+#ifdef Q_OS_UNIX
+    char a = 1;
+    ssize_t writeValue = ::write(sigUsr2FD[0], &a, sizeof(a));
+    Q_UNUSED(writeValue);
+#endif
+}
+
+void SignalHandler::internalSigUsr2Handler()
+{
+    snUsr2->setEnabled(false);
+#ifdef Q_OS_UNIX
+    char tmp;
+    ssize_t readValue = ::read(sigUsr2FD[1], &tmp, sizeof(tmp));
+    Q_UNUSED(readValue);
+#endif
+    logger->logMessage("Received SIGUSR2, starting or stopping the timeline trace", this);
+    emit timelineTraceToggleRequested();
+
+    snUsr2->setEnabled(true);
+}
+
 #ifdef Q_OS_UNIX
 void SignalHandler::sigSegvHandler(int sig)
 {
@@ -12,13 +12,20 @@ public:
     SignalHandler(QObject *parent = 0);
     ~SignalHandler(){};
     static void sigHupHandler(int /* sig */);
+    static void sigUsr2Handler(int /* sig */);
     static void sigSegvHandler(int sig);
 
+signals:
+    // SIGUSR2 starts or stops the timeline trace
+    void timelineTraceToggleRequested();
+
 private:
     static int sigHupFD[2];
-    QSocketNotifier *snHup;
+    static int sigUsr2FD[2];
+    QSocketNotifier *snHup, *snUsr2;
 private slots:
     void internalSigHupHandler();
+    void internalSigUsr2Handler();
 };
 
 #endif
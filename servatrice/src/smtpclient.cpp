@@ -5,43 +5,114 @@
 
 #include <QSslSocket>
 #include <QTcpSocket>
+#include <QTimer>
 
-SmtpClient::SmtpClient(QObject *parent) : QObject(parent)
-{
-    smtp = new QxtSmtp(this);
+// how long a connection waits for the server to answer before it is dropped
+static const int responseTimeout = 60000;
 
-    connect(smtp, SIGNAL(authenticated()), this, SLOT(authenticated()));
-    connect(smtp, SIGNAL(authenticationFailed(const QByteArray &)), this,
-            SLOT(authenticationFailed(const QByteArray &)));
-    connect(smtp, SIGNAL(connected()), this, SLOT(connected()));
-    connect(smtp, SIGNAL(connectionFailed(const QByteArray &)), this, SLOT(connectionFailed(const QByteArray &)));
-    connect(smtp, SIGNAL(disconnected()), this, SLOT(disconnected()));
-    connect(smtp, SIGNAL(encrypted()), this, SLOT(encrypted()));
-    connect(smtp, SIGNAL(encryptionFailed(const QByteArray &)), this, SLOT(encryptionFailed(const QByteArray &)));
-    connect(smtp, SIGNAL(finished()), this, SLOT(finished()));
-    connect(smtp, SIGNAL(mailFailed(int, int, const QByteArray &)), this,
-            SLOT(mailFailed(int, int, const QByteArray &)));
-    connect(smtp, SIGNAL(mailSent(int)), this, SLOT(mailSent(int)));
-    connect(smtp, SIGNAL(recipientRejected(int, const QString &, const QByteArray &)), this,
-            SLOT(recipientRejected(int, const QString &, const QByteArray &)));
-    connect(smtp, SIGNAL(senderRejected(int, const QString &, const QByteArray &)), this,
-            SLOT(senderRejected(int, const QString &, const QByteArray &)));
+SmtpClient::SmtpClient(QObject *parent)
+    : QObject(parent), maxQueueSize(qMax(1, settingsCache->value("smtp/queue_size", 1000).toInt())),
+      maxAttempts(qMax(1, settingsCache->value("smtp/max_attempts", 5).toInt())),
+      retryDelay(qMax(1, settingsCache->value("smtp/retry_delay", 10000).toInt())),
+      idleTimeout(qMax(1, settingsCache->value("smtp/idle_timeout", 30000).toInt())), queueDepth(0), sentMails(0),
+      failedMails(0), retriedMails(0)
+{
+    clock.start();
+    retryTimer = new QTimer(this);
+    retryTimer->setInterval(1000);
+    connect(retryTimer, &QTimer::timeout, this, &SmtpClient::dispatch);
+
+    const int connectionCount = qMax(1, settingsCache->value("smtp/connections", 2).toInt());
+    for (int i = 0; i < connectionCount; ++i) {
+        auto *connection = new Connection;
+        connection->state = Connection::Disconnected;
+        connection->mailId = 0;
+        connection->failedConnects = 0;
+        connection->nextConnect = 0;
+        connection->smtp = createSmtp(connection);
+        connection->timer = new QTimer(this);
+        connection->timer->setSingleShot(true);
+        connect(connection->timer, &QTimer::timeout, this, [this, connection]() {
+            if (connection->state == Connection::Ready)
+                connection->smtp->disconnectFromHost();
+            else
+                connectionLost(connection, "no answer from the server");
+        });
+        connections.append(connection);
+    }
 }
 
 SmtpClient::~SmtpClient()
 {
-    if (smtp) {
-        delete smtp;
-        smtp = 0;
+    for (Connection *connection : connections) {
+        connection->smtp->disconnect(this);
+        delete connection->smtp;
+        delete connection;
     }
 }
 
+QxtSmtp *SmtpClient::createSmtp(Connection *connection)
+{
+    auto *smtp = new QxtSmtp(this);
+    connect(smtp, &QxtSmtp::connected, this, []() { qDebug() << "[MAIL] connected"; });
+    connect(smtp, &QxtSmtp::encrypted, this, []() { qDebug() << "[MAIL] encrypted"; });
+    connect(smtp, &QxtSmtp::authenticated, this, []() { qDebug() << "[MAIL] authenticated"; });
+    connect(smtp, qOverload<const QByteArray &>(&QxtSmtp::connectionFailed), this,
+            [this, connection](const QByteArray &msg) {
+                connectionLost(connection, "connectionFailed " + QString(msg));
+            });
+    connect(smtp, qOverload<const QByteArray &>(&QxtSmtp::authenticationFailed), this,
+            [this, connection](const QByteArray &msg) {
+                connectionLost(connection, "authenticationFailed " + QString(msg));
+            });
+    connect(smtp, qOverload<const QByteArray &>(&QxtSmtp::encryptionFailed), this,
+            [this, connection](const QByteArray &msg) {
+                qDebug() << "[MAIL] Try enabling the \"acceptallcerts\" option in servatrice.ini";
+                connectionLost(connection, "encryptionFailed " + QString(msg));
+            });
+    connect(smtp, qOverload<int, const QString &, const QByteArray &>(&QxtSmtp::senderRejected), this,
+            [](int mailID, const QString &address, const QByteArray &msg) {
+                qDebug() << "[MAIL] senderRejected id=" << mailID << " address=" << address << "msg=" << QString(msg);
+            });
+    connect(smtp, qOverload<int, const QString &, const QByteArray &>(&QxtSmtp::recipientRejected), this,
+            [](int mailID, const QString &address, const QByteArray &msg) {
+                qDebug() << "[MAIL] recipientRejected id=" << mailID << " address=" << address
+                         << "msg=" << QString(msg);
+            });
+    connect(smtp, qOverload<int, int, const QByteArray &>(&QxtSmtp::mailFailed), this,
+            [this, connection](int mailID, int errorCode, const QByteArray &msg) {
+                mailDone(connection, mailID, false, errorCode, msg);
+            });
+    connect(smtp, &QxtSmtp::mailSent, this,
+            [this, connection](int mailID) { mailDone(connection, mailID, true, 0, QByteArray()); });
+    connect(smtp, &QxtSmtp::finished, this, [this, connection]() { connectionReady(connection); });
+    connect(smtp, &QxtSmtp::disconnected, this,
+            [this, connection]() { connectionLost(connection, "disconnected"); });
+    return smtp;
+}
+
 bool SmtpClient::enqueueActivationTokenMail(const QString &nickname, const QString &recipient, const QString &token)
+{
+    return enqueueMail(ActivationTokenMail, nickname, recipient, settingsCache->value("smtp/subject", "").toString(),
+                       settingsCache->value("smtp/body", "").toString(), token);
+}
+
+bool SmtpClient::enqueueForgotPasswordTokenMail(const QString &nickname, const QString &recipient, const QString &token)
+{
+    return enqueueMail(ForgotPasswordTokenMail, nickname, recipient,
+                       settingsCache->value("forgotpassword/subject", "").toString(),
+                       settingsCache->value("forgotpassword/body", "").toString(), token);
+}
+
+bool SmtpClient::enqueueMail(MailKind kind,
+                             const QString &nickname,
+                             const QString &recipient,
+                             const QString &subject,
+                             const QString &body,
+                             const QString &token)
 {
     QString email = settingsCache->value("smtp/email", "").toString();
     QString name = settingsCache->value("smtp/name", "").toString();
-    QString subject = settingsCache->value("smtp/subject", "").toString();
-    QString body = settingsCache->value("smtp/body", "").toString();
 
     if (email.isEmpty()) {
         qDebug() << "[MAIL] Missing sender email in configuration";
@@ -68,69 +139,78 @@ bool SmtpClient::enqueueActivationTokenMail(const QString &nickname, const QStri
         return false;
     }
 
-    QxtMailMessage message;
-    message.setSender(name + " <" + email + ">");
-    message.addRecipient(recipient);
-    message.setSubject(subject);
-    message.setBody(body.replace("%username", nickname).replace("%token", token));
+    // the mail is picked up again on a later round
+    const QPair<int, QString> key(kind, nickname);
+    if (queuedMails.contains(key) || queuedMails.size() >= maxQueueSize)
+        return false;
 
-    int id = smtp->send(message);
-    qDebug() << "[MAIL] Enqueued mail to" << recipient << "as" << id;
+    Mail mail;
+    mail.kind = kind;
+    mail.userName = nickname;
+    mail.message.setSender(name + " <" + email + ">");
+    mail.message.addRecipient(recipient);
+    mail.message.setSubject(subject);
+    mail.message.setBody(QString(body).replace("%username", nickname).replace("%token", token));
+    mail.attempts = 0;
+    mail.notBefore = 0;
+    queue.append(mail);
+    queuedMails.insert(key);
+    updateQueueDepth();
+
+    qDebug() << "[MAIL] Enqueued mail to" << recipient;
     return true;
 }
 
-bool SmtpClient::enqueueForgotPasswordTokenMail(const QString &nickname, const QString &recipient, const QString &token)
+void SmtpClient::sendAllEmails()
 {
-    QString email = settingsCache->value("smtp/email", "").toString();
-    QString name = settingsCache->value("smtp/name", "").toString();
-    QString subject = settingsCache->value("forgotpassword/subject", "").toString();
-    QString body = settingsCache->value("forgotpassword/body", "").toString();
-
-    if (email.isEmpty()) {
-        qDebug() << "[MAIL] Missing sender email in configuration";
-        return false;
-    }
-
-    if (subject.isEmpty()) {
-        qDebug() << "[MAIL] Missing subject field in configuration";
-        return false;
-    }
-
-    if (body.isEmpty()) {
-        qDebug() << "[MAIL] Missing body field in configuration";
-        return false;
-    }
+    dispatch();
+}
 
-    if (recipient.isEmpty()) {
-        qDebug() << "[MAIL] Missing recipient field for user " << nickname;
-        return false;
+void SmtpClient::dispatch()
+{
+    const qint64 now = clock.elapsed();
+    int dueMails = 0;
+    for (const Mail &mail : queue)
+        if (mail.notBefore <= now)
+            ++dueMails;
+
+    for (Connection *connection : connections) {
+        if (dueMails == 0)
+            break;
+        if (connection->state != Connection::Ready)
+            continue;
+        for (int i = 0; i < queue.size(); ++i) {
+            if (queue.at(i).notBefore <= now) {
+                connection->mail = queue.takeAt(i);
+                break;
+            }
+        }
+        --dueMails;
+        connection->state = Connection::Sending;
+        connection->timer->start(responseTimeout);
+        connection->mailId = connection->smtp->send(connection->mail.message);
     }
 
-    if (token.isEmpty()) {
-        qDebug() << "[MAIL] Missing token field for user " << nickname;
-        return false;
+    // a connection that is being opened takes the next mail once it is ready
+    for (Connection *connection : connections) {
+        if (dueMails == 0)
+            break;
+        if (connection->state == Connection::Connecting) {
+            --dueMails;
+        } else if (connection->state == Connection::Disconnected && connection->nextConnect <= now) {
+            connectToHost(connection);
+            --dueMails;
+        }
     }
 
-    QxtMailMessage message;
-    message.setSender(name + " <" + email + ">");
-    message.addRecipient(recipient);
-    message.setSubject(subject);
-    message.setBody(body.replace("%username", nickname).replace("%token", token));
-
-    int id = smtp->send(message);
-    qDebug() << "[MAIL] Enqueued mail to" << recipient << "as" << id;
-    return true;
+    if (queue.isEmpty())
+        retryTimer->stop();
+    else if (!retryTimer->isActive())
+        retryTimer->start();
 }
 
-void SmtpClient::sendAllEmails()
+void SmtpClient::connectToHost(Connection *connection)
 {
-    // still connected from the previous round
-    if (smtp->socket()->state() == QAbstractSocket::ConnectedState)
-        return;
-
-    if (smtp->pendingMessages() == 0)
-        return;
-
     QString connectionType = settingsCache->value("smtp/connection", "tcp").toString();
     QString host = settingsCache->value("smtp/host", "localhost").toString();
     int port = settingsCache->value("smtp/port", 25).toInt();
@@ -138,10 +218,12 @@ void SmtpClient::sendAllEmails()
     QByteArray password = settingsCache->value("smtp/password", "").toByteArray();
     bool acceptAllCerts = settingsCache->value("smtp/acceptallcerts", false).toBool();
 
+    QxtSmtp *smtp = connection->smtp;
     smtp->setUsername(username);
     smtp->setPassword(password);
 
-    // Connect
+    connection->state = Connection::Connecting;
+    connection->timer->start(responseTimeout);
     if (connectionType == "ssl") {
         if (acceptAllCerts)
             smtp->sslSocket()->setPeerVerifyMode(QSslSocket::QueryPeer);
@@ -151,64 +233,93 @@ void SmtpClient::sendAllEmails()
     }
 }
 
-void SmtpClient::authenticated()
-{
-    qDebug() << "[MAIL] authenticated";
-}
-
-void SmtpClient::authenticationFailed(const QByteArray &msg)
-{
-    qDebug() << "[MAIL] authenticationFailed" << QString(msg);
-}
-
-void SmtpClient::connected()
-{
-    qDebug() << "[MAIL] connected";
-}
-
-void SmtpClient::connectionFailed(const QByteArray &msg)
+void SmtpClient::connectionReady(Connection *connection)
 {
-    qDebug() << "[MAIL] connectionFailed" << QString(msg);
+    // also after every mail, smtp has nothing left to send then
+    if (connection->state != Connection::Connecting && connection->state != Connection::Sending)
+        return;
+    connection->state = Connection::Ready;
+    connection->failedConnects = 0;
+    connection->timer->start(idleTimeout);
+    dispatch();
 }
 
-void SmtpClient::disconnected()
+void SmtpClient::connectionLost(Connection *connection, const QString &reason)
 {
-    qDebug() << "[MAIL] disconnected";
+    if (connection->state == Connection::Disconnected)
+        return;
+    qDebug() << "[MAIL]" << reason;
+
+    const bool wasConnecting = connection->state == Connection::Connecting;
+    const bool wasSending = connection->state == Connection::Sending && connection->mailId != 0;
+    connection->state = Connection::Disconnected;
+    connection->mailId = 0;
+    connection->timer->stop();
+
+    // smtp would send what it still holds on its next connection, so it is replaced by an empty one
+    QxtSmtp *smtp = connection->smtp;
+    smtp->disconnect(this);
+    smtp->socket()->abort();
+    smtp->deleteLater();
+    connection->smtp = createSmtp(connection);
+
+    if (wasConnecting) {
+        ++connection->failedConnects;
+        connection->nextConnect = clock.elapsed() + backoff(connection->failedConnects);
+    }
+    if (wasSending)
+        retryMail(connection->mail, false);
+    dispatch();
 }
 
-void SmtpClient::encrypted()
+void SmtpClient::mailDone(Connection *connection, int mailId, bool delivered, int errorCode, const QByteArray &reply)
 {
-    qDebug() << "[MAIL] encrypted";
-}
+    // smtp can report a mail more than once, the first report counts
+    if (connection->state != Connection::Sending || mailId != connection->mailId)
+        return;
+    connection->mailId = 0;
 
-void SmtpClient::encryptionFailed(const QByteArray &msg)
-{
-    qDebug() << "[MAIL] encryptionFailed" << QString(msg);
-    qDebug() << "[MAIL] Try enabling the \"acceptallcerts\" option in servatrice.ini";
+    if (delivered) {
+        qDebug() << "[MAIL] mailSent to" << connection->mail.message.recipients().join(", ");
+        ++sentMails;
+        finishMail(connection->mail, true);
+    } else {
+        qDebug() << "[MAIL] mailFailed errorCode=" << errorCode << "msg=" << QString(reply);
+        // only the 4xx replies are worth another try
+        retryMail(connection->mail, errorCode < 400 || errorCode >= 500);
+    }
 }
 
-void SmtpClient::finished()
+void SmtpClient::retryMail(Mail mail, bool permanentFailure)
 {
-    qDebug() << "[MAIL] finished";
-    smtp->disconnectFromHost();
-}
+    ++mail.attempts;
+    if (permanentFailure || mail.attempts >= maxAttempts) {
+        qWarning() << "[MAIL] Giving up on the mail to" << mail.message.recipients().join(", ") << "after"
+                   << mail.attempts << "attempts";
+        ++failedMails;
+        finishMail(mail, false);
+        return;
+    }
 
-void SmtpClient::mailFailed(int mailID, int errorCode, const QByteArray &msg)
-{
-    qDebug() << "[MAIL] mailFailed id=" << mailID << " errorCode=" << errorCode << "msg=" << QString(msg);
+    ++retriedMails;
+    mail.notBefore = clock.elapsed() + backoff(mail.attempts);
+    queue.append(mail);
 }
 
-void SmtpClient::mailSent(int mailID)
+void SmtpClient::finishMail(const Mail &mail, bool delivered)
 {
-    qDebug() << "[MAIL] mailSent" << mailID;
+    queuedMails.remove(QPair<int, QString>(mail.kind, mail.userName));
+    updateQueueDepth();
+    emit mailFinished(mail.kind, mail.userName, delivered);
 }
 
-void SmtpClient::recipientRejected(int mailID, const QString &address, const QByteArray &msg)
+qint64 SmtpClient::backoff(int failures) const
 {
-    qDebug() << "[MAIL] recipientRejected id=" << mailID << " address=" << address << "msg=" << QString(msg);
+    // doubles with every failure, up to an hour
+    return qMin(static_cast<qint64>(retryDelay) << qMin(failures - 1, 20), static_cast<qint64>(3600000));
 }
 
-void SmtpClient::senderRejected(int mailID, const QString &address, const QByteArray &msg)
+void SmtpClient::updateQueueDepth()
 {
-    qDebug() << "[MAIL] senderRejected id=" << mailID << " address=" << address << "msg=" << QString(msg);
+    queueDepth.store(queuedMails.size(), std::memory_order_relaxed);
 }
@@ -1,37 +1,131 @@
 #ifndef SMTPCLIENT_H
 #define SMTPCLIENT_H
 
+#include "smtp/qxtmailmessage.h"
+
+#include <QElapsedTimer>
+#include <QList>
 #include <QObject>
+#include <QPair>
+#include <QSet>
+#include <atomic>
 
+class QTimer;
 class QxtSmtp;
-class QxtMailMessage;
 
+/**
+ * Sends the activation and password reset mails through a small pool of SMTP connections.
+ *
+ * The mails wait in a bounded queue; enqueueing one refuses it when the queue is full or the same mail is already
+ * waiting, and the caller tries again later. A connection is opened when there is something to send and kept open
+ * for smtp/idle_timeout milliseconds after its last mail. Mails that fail with a temporary error, or whose connection
+ * drops, are retried with a growing delay; mailFinished() tells about every mail once it was delivered or given up.
+ *
+ * Lives in the main thread, like the servatrice instance that feeds it.
+ */
 class SmtpClient : public QObject
 {
     Q_OBJECT
 public:
-    SmtpClient(QObject *parent = 0);
-    ~SmtpClient();
+    enum MailKind
+    {
+        ActivationTokenMail,
+        ForgotPasswordTokenMail
+    };
+
+    explicit SmtpClient(QObject *parent = nullptr);
+    ~SmtpClient() override;
+
+    // thread safe; the mails waiting and those being sent
+    int getQueueDepth() const
+    {
+        return queueDepth.load(std::memory_order_relaxed);
+    }
+    quint64 getSentCount() const
+    {
+        return sentMails.load(std::memory_order_relaxed);
+    }
+    quint64 getFailedCount() const
+    {
+        return failedMails.load(std::memory_order_relaxed);
+    }
+    quint64 getRetriedCount() const
+    {
+        return retriedMails.load(std::memory_order_relaxed);
+    }
+
+signals:
+    void mailFinished(SmtpClient::MailKind kind, const QString &userName, bool delivered);
 
-protected:
-    QxtSmtp *smtp;
 public slots:
     bool enqueueActivationTokenMail(const QString &nickname, const QString &recipient, const QString &token);
     bool enqueueForgotPasswordTokenMail(const QString &nickname, const QString &recipient, const QString &token);
     void sendAllEmails();
-protected slots:
-    void authenticated();
-    void authenticationFailed(const QByteArray &msg);
-    void connected();
-    void connectionFailed(const QByteArray &msg);
-    void disconnected();
-    void encrypted();
-    void encryptionFailed(const QByteArray &msg);
-    void finished();
-    void mailFailed(int mailID, int errorCode, const QByteArray &msg);
-    void mailSent(int mailID);
-    void recipientRejected(int mailID, const QString &address, const QByteArray &msg);
-    void senderRejected(int mailID, const QString &address, const QByteArray &msg);
+
+private:
+    struct Mail
+    {
+        MailKind kind;
+        QString userName;
+        QxtMailMessage message;
+        int attempts;
+        // on the clock of the client, in milliseconds
+        qint64 notBefore;
+    };
+    struct Connection
+    {
+        enum State
+        {
+            Disconnected,
+            Connecting,
+            Ready,
+            Sending
+        };
+
+        QxtSmtp *smtp;
+        // closes the connection once it is idle for too long, or gives up on an answer that doesn't come
+        QTimer *timer;
+        State state;
+        Mail mail;
+        // the id given to the mail being sent by smtp, 0 once it is done
+        int mailId;
+        int failedConnects;
+        qint64 nextConnect;
+    };
+
+    const int maxQueueSize;
+    const int maxAttempts;
+    const int retryDelay;
+    const int idleTimeout;
+    QList<Connection *> connections;
+    QList<Mail> queue;
+    QSet<QPair<int, QString>> queuedMails;
+    QElapsedTimer clock;
+    QTimer *retryTimer;
+
+    std::atomic<int> queueDepth;
+    std::atomic<quint64> sentMails, failedMails, retriedMails;
+
+    bool enqueueMail(MailKind kind,
+                     const QString &nickname,
+                     const QString &recipient,
+                     const QString &subject,
+                     const QString &body,
+                     const QString &token);
+    QxtSmtp *createSmtp(Connection *connection);
+    void connectToHost(Connection *connection);
+    void connectionReady(Connection *connection);
+    void connectionLost(Connection *connection, const QString &reason);
+    void mailDone(Connection *connection, int mailId, bool delivered, int errorCode, const QByteArray &reply);
+    void retryMail(Mail mail, bool permanentFailure);
+    void finishMail(const Mail &mail, bool delivered);
+    // the delay before the next attempt after that many failed ones
+    qint64 backoff(int failures) const;
+    void updateQueueDepth();
+
+private slots:
+    // hands the mails that are due to the connections that are ready, and opens more connections if needed
+    void dispatch();
 };
 
-#endif
\ No newline at end of file
+#endif
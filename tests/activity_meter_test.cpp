@@ -0,0 +1,48 @@
+#include "../common/activity_meter.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+TEST(ActivityMeterTest, SumsTheActivityOfTheWindow)
+{
+    ActivityMeter meter;
+    meter.record(100, 2, 3000, 50);
+    meter.record(101, 1, 1000, 0);
+
+    const ActivityMeter::Sample sample = meter.sample(101);
+    ASSERT_EQ(sample.ticks, 2);
+    ASSERT_EQ(sample.commands, 3);
+    ASSERT_EQ(sample.handlerMicroseconds, 4);
+    ASSERT_EQ(sample.sentBytes, 50);
+}
+
+TEST(ActivityMeterTest, OldTicksDropOut)
+{
+    ActivityMeter meter;
+    meter.record(0, 5, 0, 0);
+    meter.record(ActivityMeter::windowTicks - 1, 1, 0, 0);
+    ASSERT_EQ(meter.sample(ActivityMeter::windowTicks - 1).commands, 6);
+
+    const ActivityMeter::Sample sample = meter.sample(ActivityMeter::windowTicks);
+    ASSERT_EQ(sample.ticks, ActivityMeter::windowTicks);
+    ASSERT_EQ(sample.commands, 1);
+    ASSERT_EQ(meter.sample(100).commands, 0);
+}
+
+TEST(ActivityMeterTest, LateTicksCountForTheNewestOne)
+{
+    ActivityMeter meter;
+    meter.record(10, 1, 0, 0);
+    meter.record(9, 1, 0, 0);
+    ASSERT_EQ(meter.sample(10).commands, 2);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
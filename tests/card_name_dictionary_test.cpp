@@ -0,0 +1,127 @@
+#include "../common/card_name_dictionary.h"
+#include "pb/event_card_names.pb.h"
+#include "pb/event_move_card.pb.h"
+#include "pb/event_reveal_cards.pb.h"
+#include "pb/game_event_container.pb.h"
+#include "pb/serverinfo_zone.pb.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+GameEventContainer revealEvent(const std::vector<std::string> &names)
+{
+    GameEventContainer cont;
+    Event_RevealCards *reveal = cont.add_event_list()->MutableExtension(Event_RevealCards::ext);
+    for (const std::string &name : names) {
+        ServerInfo_Card *card = reveal->add_cards();
+        card->set_name(name);
+        card->set_provider_id("provider");
+    }
+    return cont;
+}
+
+TEST(CardNameDictionaryTest, RepeatedNamesAreSentOnce)
+{
+    CardNameDictionary server;
+    GameEventContainer cont = revealEvent({"Forest", "Island", "Forest", "Forest"});
+    server.encode(cont);
+
+    const Event_RevealCards &reveal = cont.event_list(0).GetExtension(Event_RevealCards::ext);
+    ASSERT_FALSE(reveal.cards(0).has_name());
+    ASSERT_EQ(reveal.cards(0).name_ref(), reveal.cards(2).name_ref());
+    ASSERT_NE(reveal.cards(0).name_ref(), reveal.cards(1).name_ref());
+
+    Event_CardNames names;
+    ASSERT_TRUE(server.takeNewNames(names));
+    ASSERT_EQ(names.first_id(), 0u);
+    ASSERT_EQ(names.names_size(), 3);
+    ASSERT_FALSE(server.takeNewNames(names));
+
+    // known names are referred to without being sent again
+    GameEventContainer second = revealEvent({"Island", "Swamp"});
+    server.encode(second);
+    Event_CardNames newNames;
+    ASSERT_TRUE(server.takeNewNames(newNames));
+    ASSERT_EQ(newNames.first_id(), 3u);
+    ASSERT_EQ(newNames.names_size(), 1);
+    ASSERT_EQ(newNames.names(0), "Swamp");
+}
+
+TEST(CardNameDictionaryTest, ClientDecodesWhatTheServerEncoded)
+{
+    CardNameDictionary server;
+    CardNameDictionary client;
+
+    GameEventContainer cont = revealEvent({"Forest", "", "Island"});
+    Event_MoveCard *move = cont.add_event_list()->MutableExtension(Event_MoveCard::ext);
+    move->set_card_name("Island");
+    move->set_new_card_provider_id("provider");
+    server.encode(cont);
+
+    GameEventContainer sent;
+    server.takeNewNames(*sent.add_event_list()->MutableExtension(Event_CardNames::ext));
+    sent.MergeFrom(cont);
+    ASSERT_TRUE(CardNameDictionary::carriesCardNames(sent));
+    client.decode(sent);
+
+    const Event_RevealCards &reveal = sent.event_list(1).GetExtension(Event_RevealCards::ext);
+    ASSERT_EQ(reveal.cards(0).name(), "Forest");
+    ASSERT_FALSE(reveal.cards(0).has_name_ref());
+    ASSERT_EQ(reveal.cards(1).name(), "");
+    ASSERT_EQ(reveal.cards(2).name(), "Island");
+    ASSERT_EQ(reveal.cards(2).provider_id(), "provider");
+    const Event_MoveCard &decodedMove = sent.event_list(2).GetExtension(Event_MoveCard::ext);
+    ASSERT_EQ(decodedMove.card_name(), "Island");
+    ASSERT_EQ(decodedMove.new_card_provider_id(), "provider");
+}
+
+TEST(CardNameDictionaryTest, ZonesUseTheirOwnList)
+{
+    CardNameDictionary responseNames;
+    ServerInfo_Zone zone;
+    for (const char *name : {"Forest", "Forest", "Island"})
+        zone.add_card_list()->set_name(name);
+    responseNames.encode(zone);
+    Event_CardNames names;
+    ASSERT_TRUE(responseNames.takeNewNames(names));
+
+    CardNameDictionary client;
+    client.addNames(0, names.names());
+    client.decode(zone);
+    ASSERT_EQ(zone.card_list(1).name(), "Forest");
+    ASSERT_EQ(zone.card_list(2).name(), "Island");
+}
+
+TEST(CardNameDictionaryTest, RestoredDictionaryKeepsTheIds)
+{
+    CardNameDictionary server;
+    GameEventContainer cont = revealEvent({"Forest", "Island"});
+    server.encode(cont);
+    Event_CardNames names;
+    server.takeNewNames(names);
+
+    google::protobuf::RepeatedPtrField<std::string> sentNames;
+    server.getSentNames(sentNames);
+    CardNameDictionary restored;
+    restored.restoreSentNames(sentNames);
+    ASSERT_FALSE(restored.takeNewNames(names));
+
+    GameEventContainer second = revealEvent({"Island", "Swamp"});
+    restored.encode(second);
+    const Event_RevealCards &reveal = second.event_list(0).GetExtension(Event_RevealCards::ext);
+    ASSERT_EQ(reveal.cards(0).name_ref(), cont.event_list(0).GetExtension(Event_RevealCards::ext).cards(1).name_ref());
+    Event_CardNames newNames;
+    ASSERT_TRUE(restored.takeNewNames(newNames));
+    ASSERT_EQ(newNames.first_id(), 3u);
+    ASSERT_EQ(newNames.names(0), "Swamp");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
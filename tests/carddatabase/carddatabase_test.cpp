@@ -1,6 +1,15 @@
+#include "../../cockatrice/src/game/cards/card_database_cache.h"
+#include "../../cockatrice/src/game/cards/card_database_parser/cockatrice_xml_4.h"
+#include "../../cockatrice/src/game/cards/card_relation_index.h"
+#include "../../cockatrice/src/game/cards/card_search_index.h"
 #include "mocks.h"
 
 #include "gtest/gtest.h"
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <iostream>
 
 namespace
 {
@@ -30,6 +39,184 @@ TEST(CardDatabaseTest, LoadXml)
     ASSERT_EQ(0, db->getAllMainCardTypes().size()) << "Types not empty after clear";
     ASSERT_EQ(NotLoaded, db->getLoadStatus()) << "Incorrect status after clear";
 }
+
+TEST(CardDatabaseTest, BinaryCacheRoundTrip)
+{
+    settingsCache = new SettingsCache;
+    CardDatabase *db = new CardDatabase;
+    db->loadCardDatabases();
+    ASSERT_EQ(Ok, db->getLoadStatus()) << "Wrong status after load";
+
+    SetNameMap sets;
+    for (const CardSetPtr &set : db->getSetList())
+        sets.insert(set->getShortName(), set);
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString fileName = dir.filePath("carddatabase.cache");
+    const QByteArray key = CardDatabaseCache::sourceKey({settingsCache->getCardDatabasePath()});
+    ASSERT_TRUE(CardDatabaseCache(fileName).save(key, sets, db->getCardList())) << "Cache not written";
+
+    QList<CardSetPtr> cachedSets;
+    QList<CardInfoPtr> cachedCards;
+    ASSERT_TRUE(CardDatabaseCache(fileName).load(key, cachedSets, cachedCards)) << "Cache not loaded";
+    ASSERT_EQ(db->getSetList().size(), cachedSets.size()) << "Wrong sets count from cache";
+    ASSERT_EQ(db->getCardList().size(), cachedCards.size()) << "Wrong card count from cache";
+
+    for (const CardInfoPtr &cachedCard : cachedCards) {
+        const CardInfoPtr card = db->getCardInfo(cachedCard->getName());
+        ASSERT_FALSE(card.isNull()) << "Unknown card from cache";
+        ASSERT_EQ(card->getText(), cachedCard->getText());
+        ASSERT_EQ(card->getIsToken(), cachedCard->getIsToken());
+        ASSERT_EQ(card->getTableRow(), cachedCard->getTableRow());
+        for (const QString &propertyName : card->getProperties())
+            ASSERT_EQ(card->getProperty(propertyName), cachedCard->getProperty(propertyName));
+        ASSERT_EQ(card->getSets().keys(), cachedCard->getSets().keys());
+        for (const QString &setName : card->getSets().keys()) {
+            const QList<PrintingInfo> printings = card->getSets().value(setName);
+            const QList<PrintingInfo> cachedPrintings = cachedCard->getSets().value(setName);
+            ASSERT_EQ(printings.size(), cachedPrintings.size());
+            for (int i = 0; i < printings.size(); ++i)
+                ASSERT_EQ(printings[i].getUuid(), cachedPrintings[i].getUuid());
+        }
+        ASSERT_EQ(card->getRelatedCards().size(), cachedCard->getRelatedCards().size());
+        ASSERT_EQ(card->getReverseRelatedCards().size(), cachedCard->getReverseRelatedCards().size());
+    }
+
+    // a cache written for other files, or cut short, loads nothing
+    cachedSets.clear();
+    cachedCards.clear();
+    const QByteArray otherKey = CardDatabaseCache::sourceKey({settingsCache->getTokenDatabasePath()});
+    ASSERT_FALSE(CardDatabaseCache(fileName).load(otherKey, cachedSets, cachedCards)) << "Stale cache loaded";
+
+    QFile file(fileName);
+    ASSERT_TRUE(file.resize(file.size() - 8));
+    ASSERT_FALSE(CardDatabaseCache(fileName).load(key, cachedSets, cachedCards)) << "Damaged cache loaded";
+    ASSERT_TRUE(cachedCards.isEmpty());
+}
+
+TEST(CardDatabaseTest, ReverseRelationsFollowAddedAndRemovedCards)
+{
+    auto makeCard = [](const QString &name, const QList<CardRelation *> &reverseRelated) {
+        return CardInfo::newInstance(name, QString(), false, QVariantHash(), {}, reverseRelated, SetToPrintingsMap(),
+                                     false, false, 0, false);
+    };
+    CardInfoPtr token = makeCard("Token", {});
+    CardInfoPtr maker = makeCard("Maker", {new CardRelation("Token", CardRelation::DoesNotAttach, false, false, 2)});
+
+    CardRelationIndex index;
+    index.cardAdded(maker);
+    ASSERT_TRUE(token->getReverseRelatedCards2Me().isEmpty()) << "Relation to a card not added yet";
+    index.cardAdded(token);
+    ASSERT_EQ(1, token->getReverseRelatedCards2Me().size()) << "Relation not linked when the target is added";
+    ASSERT_EQ("Maker", token->getReverseRelatedCards2Me().first()->getName());
+    ASSERT_EQ(2, token->getReverseRelatedCards2Me().first()->getDefaultCount());
+
+    index.cardRemoved(maker);
+    ASSERT_TRUE(token->getReverseRelatedCards2Me().isEmpty()) << "Relation kept after the source was removed";
+    index.cardAdded(maker);
+    ASSERT_EQ(1, token->getReverseRelatedCards2Me().size()) << "Relation not linked when the source is added again";
+
+    index.cardRemoved(token);
+    ASSERT_TRUE(token->getReverseRelatedCards2Me().isEmpty()) << "Relations kept on a removed card";
+    index.cardAdded(token);
+    ASSERT_EQ(1, token->getReverseRelatedCards2Me().size()) << "Relation not linked when the target is added again";
+}
+
+TEST(CardDatabaseTest, PropertiesShareInternedStrings)
+{
+    auto makeCard = [](const QString &name) {
+        QVariantHash properties;
+        properties.insert(QString("type").append(""), QString("Creature - Goblin").append(""));
+        return CardInfo::newInstance(name, QString(), false, properties, {}, {}, SetToPrintingsMap(), false, false, 0,
+                                     false);
+    };
+    CardInfoPtr first = makeCard("First");
+    CardInfoPtr second = makeCard("Second");
+
+    ASSERT_EQ("Creature - Goblin", second->getProperty("type"));
+    ASSERT_EQ(first->getProperty("type").constData(), second->getProperty("type").constData())
+        << "Equal property values not shared";
+    ASSERT_EQ(first->getProperties().first().constData(), second->getProperties().first().constData())
+        << "Equal property names not shared";
+}
+
+TEST(CardDatabaseTest, SearchIndexFindsNameCandidates)
+{
+    CardSearchIndex index;
+    index.reset({CardInfo::newInstance("Goblin Guide"), CardInfo::newInstance("Lightning Bolt"),
+                 CardInfo::newInstance("Goblin Bombardment")});
+
+    QBitArray rows = index.rowsMatchingName("GOBLIN");
+    ASSERT_EQ(3, rows.size());
+    ASSERT_TRUE(rows.testBit(0) && rows.testBit(2)) << "Case insensitive name match not found";
+    ASSERT_FALSE(rows.testBit(1)) << "Unrelated name kept as a candidate";
+
+    ASSERT_EQ(0, index.rowsMatchingName("bolt guide").count(true));
+    ASSERT_EQ(3, index.rowsMatchingName("bo").count(true)) << "Short searches have to keep every row";
+
+    index.cardAppended(CardInfo::newInstance("Bolt Bend"));
+    ASSERT_TRUE(index.rowsMatchingName("bolt").testBit(3)) << "Appended card not indexed";
+}
+
+TEST(CardDatabaseTest, SearchIndexCompletesNamePrefix)
+{
+    CardSearchIndex index;
+    index.reset({CardInfo::newInstance("Goblin Guide"), CardInfo::newInstance("Lightning Bolt"),
+                 CardInfo::newInstance("Goblin Bombardment")});
+
+    ASSERT_EQ(QVector<int>({2, 0}), index.rowsWithNamePrefix("gOBLIN ")) << "Prefix matches not in name order";
+    ASSERT_TRUE(index.rowsWithNamePrefix("bolt").isEmpty()) << "Name matched in the middle";
+    ASSERT_EQ(3, index.rowsWithNamePrefix("").size());
+
+    index.cardAppended(CardInfo::newInstance("Goblin Arsonist"));
+    ASSERT_EQ(QVector<int>({3, 2, 0}), index.rowsWithNamePrefix("goblin")) << "Appended card not completed";
+}
+
+TEST(CardDatabaseTest, Xml4ParseThroughput)
+{
+    settingsCache = new SettingsCache;
+
+    // about the size of a full card database
+    const int cardCount = 30000;
+    QByteArray data("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<cockatrice_carddatabase version=\"4\">\n"
+                    "<sets><set><name>CAT</name><longname>Cats</longname><settype>Custom</settype>"
+                    "<releasedate>2020-01-01</releasedate></set></sets>\n<cards>\n");
+    for (int i = 0; i < cardCount; ++i) {
+        data += QString("<card><name>Card %1</name><text>Flying</text><prop><colors>G</colors><manacost>2G</manacost>"
+                        "<cmc>3</cmc><type>Creature</type><maintype>Creature</maintype><pt>3/3</pt></prop>"
+                        "<set uuid=\"%1\" picURL=\"https://example.com/%1.jpg\" rarity=\"common\">CAT</set>"
+                        "<related count=\"x=2\">Token %1</related><tablerow>2</tablerow></card>\n")
+                    .arg(i)
+                    .toUtf8();
+    }
+    data += "</cards>\n</cockatrice_carddatabase>\n";
+
+    CockatriceXml4Parser parser;
+    QList<CardInfoPtr> cards;
+    QObject::connect(&parser, &ICardDatabaseParser::addCard, [&cards](const CardInfoPtr &card) { cards << card; });
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    QElapsedTimer timer;
+    timer.start();
+    parser.parseFile(buffer);
+    const qint64 msecs = timer.elapsed();
+
+    ASSERT_EQ(cardCount, cards.size()) << "Wrong card count after parse";
+    const CardInfoPtr card = cards.last();
+    ASSERT_EQ(QString("Card %1").arg(cardCount - 1), card->getName());
+    ASSERT_EQ("3/3", card->getPowTough());
+    ASSERT_EQ(2, card->getTableRow());
+    ASSERT_EQ(1, card->getRelatedCards().size());
+    ASSERT_EQ(2, card->getRelatedCards().first()->getDefaultCount());
+    ASSERT_TRUE(card->getRelatedCards().first()->getIsVariable());
+    const QList<PrintingInfo> printings = card->getSets().value("CAT");
+    ASSERT_EQ(1, printings.size());
+    ASSERT_EQ(QString("https://example.com/%1.jpg").arg(cardCount - 1), printings.first().getProperty("picurl"));
+
+    std::cout << cardCount << " cards parsed in " << msecs << " ms" << std::endl;
+}
 } // namespace
 
 int main(int argc, char **argv)
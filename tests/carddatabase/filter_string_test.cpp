@@ -1,5 +1,6 @@
 #include "../../cockatrice/src/game/cards/card_database_manager.h"
 #include "../../cockatrice/src/game/filters/filter_string.h"
+#include "../../cockatrice/src/game/filters/filter_tree.h"
 #include "mocks.h"
 
 #include "gtest/gtest.h"
@@ -60,6 +61,63 @@ QUERY(Color2, cat, "c:gw", true)
 QUERY(Color3, cat, "c!g", true)
 QUERY(Color4, cat, "c!gw", false)
 
+TEST_F(CardQuery, RepeatedQueriesKeepTheirResult)
+{
+    FilterString first("t:creature cmc=2");
+    FilterString again("t:creature  cmc=2");
+    ASSERT_TRUE(again.valid());
+    ASSERT_EQ(first.check(cat), again.check(cat));
+    ASSERT_TRUE(again.check(cat));
+
+    FilterString invalid("\"");
+    FilterString invalidAgain("\"");
+    ASSERT_FALSE(invalidAgain.valid()) << "Parse error lost for a repeated query";
+    ASSERT_EQ(invalid.error(), invalidAgain.error());
+}
+
+TEST_F(CardQuery, FilterTreeFollowsChanges)
+{
+    FilterTree tree;
+    ASSERT_TRUE(tree.acceptsCard(cat));
+
+    tree.termNode(CardFilter::AttrCmc, CardFilter::TypeAnd, "<=2");
+    tree.termNode(CardFilter::AttrColor, CardFilter::TypeAnd, "green");
+    ASSERT_TRUE(tree.acceptsCard(cat));
+
+    FilterTreeNode *power = tree.termNode(CardFilter::AttrPow, CardFilter::TypeAnd, ">3");
+    ASSERT_FALSE(tree.acceptsCard(cat));
+    power->disable();
+    ASSERT_TRUE(tree.acceptsCard(cat)) << "Disabled term still applied";
+
+    tree.termNode(CardFilter::AttrType, CardFilter::TypeAndNot, "creature");
+    ASSERT_FALSE(tree.acceptsCard(cat));
+    tree.clear();
+    ASSERT_TRUE(tree.acceptsCard(cat)) << "Cleared terms still applied";
+}
+
+TEST_F(CardQuery, FilterTreeBatchSendsOneChange)
+{
+    FilterTree tree;
+    int changes = 0;
+    QObject::connect(&tree, &FilterTree::changed, [&changes]() { ++changes; });
+
+    tree.beginBatch();
+    tree.termNode(CardFilter::AttrCmc, CardFilter::TypeAnd, "<=2");
+    tree.beginBatch();
+    tree.termNode(CardFilter::AttrType, CardFilter::TypeAndNot, "creature");
+    tree.endBatch();
+    ASSERT_FALSE(tree.acceptsCard(cat)) << "Terms added in a batch not applied";
+    tree.removeFiltersByAttr(CardFilter::AttrType);
+    ASSERT_EQ(changes, 0);
+    tree.endBatch();
+    ASSERT_EQ(changes, 1);
+    ASSERT_TRUE(tree.acceptsCard(cat));
+
+    tree.beginBatch();
+    tree.endBatch();
+    ASSERT_EQ(changes, 1) << "Empty batch sent a change";
+}
+
 } // namespace
 
 int main(int argc, char **argv)
@@ -35,6 +35,10 @@ QString SettingsCache::getSettingsPath()
 {
     return "";
 }
+QString SettingsCache::getCachePath() const
+{
+    return "";
+}
 void SettingsCache::translateLegacySettings()
 {
 }
@@ -50,6 +54,7 @@ SettingsCache::SettingsCache()
     : settings{new QSettings("global.ini", QSettings::IniFormat, this)}, shortcutsSettings{nullptr},
       cardDatabaseSettings{new CardDatabaseSettings("", this)}, serversSettings{nullptr}, messageSettings{nullptr},
       gameFiltersSettings{nullptr}, layoutsSettings{nullptr}, downloadSettings{nullptr},
+      picsPath{QString("%1/pics").arg(CARDDB_DATADIR)}, customPicsPath{QString("%1/pics/CUSTOM/").arg(CARDDB_DATADIR)},
       cardDatabasePath{QString("%1/cards.xml").arg(CARDDB_DATADIR)},
       customCardDatabasePath{QString("%1/customsets/").arg(CARDDB_DATADIR)},
       spoilerDatabasePath{QString("%1/spoiler.xml").arg(CARDDB_DATADIR)},
@@ -290,6 +295,9 @@ void SettingsCache::setHorizontalHand(QT_STATE_CHANGED_T /* _horizontalHand */)
 void SettingsCache::setInvertVerticalCoordinate(QT_STATE_CHANGED_T /* _invertVerticalCoordinate */)
 {
 }
+void SettingsCache::setOpenGLGameView(QT_STATE_CHANGED_T /* _openGLGameView */)
+{
+}
 void SettingsCache::setMinPlayersForMultiColumnLayout(int /* _minPlayersForMultiColumnLayout */)
 {
 }
@@ -0,0 +1,103 @@
+#include "../common/command_trace.h"
+
+#include "gtest/gtest.h"
+#include <QThread>
+
+namespace
+{
+
+TEST(LatencyHistogramTest, BucketsCoverTheirValues)
+{
+    for (qint64 value : {0, 1, 31, 32, 33, 100, 1000, 5000, 123456, 99999999}) {
+        const int index = LatencyHistogram::bucketIndex(value);
+        ASSERT_GE(LatencyHistogram::bucketValue(index), value);
+        if (index > 0)
+            ASSERT_LT(LatencyHistogram::bucketValue(index - 1), value);
+        // 16 buckets per power of two
+        ASSERT_LE(LatencyHistogram::bucketValue(index) - value, value / 16);
+    }
+    ASSERT_EQ(LatencyHistogram::bucketIndex(-5), 0);
+    ASSERT_EQ(LatencyHistogram::bucketIndex(Q_INT64_C(1) << 40), LatencyHistogram::bucketCount - 1);
+}
+
+TEST(LatencyHistogramTest, Percentiles)
+{
+    LatencyHistogram histogram;
+    ASSERT_EQ(LatencyHistogram::valueAtPercentile(histogram.snapshot(), 50), 0);
+
+    for (int value = 1; value <= 100; ++value)
+        histogram.record(value);
+    const QVector<quint64> counts = histogram.snapshot();
+    ASSERT_EQ(LatencyHistogram::valueAtPercentile(counts, 10), 10);
+    const qint64 median = LatencyHistogram::valueAtPercentile(counts, 50);
+    ASSERT_GE(median, 50);
+    ASSERT_LE(median, 53);
+    const qint64 highest = LatencyHistogram::valueAtPercentile(counts, 100);
+    ASSERT_GE(highest, 100);
+    ASSERT_LE(highest, 106);
+}
+
+TEST(CommandTraceTest, CommandNames)
+{
+    const int dumpZone = CommandTrace::commandKeyFromName("game.dump_zone");
+    ASSERT_NE(dumpZone, -1);
+    ASSERT_EQ(CommandTrace::commandName(dumpZone), "game.DUMP_ZONE");
+    ASSERT_EQ(CommandTrace::commandName(CommandTrace::commandKeyFromName("session.login")), "session.LOGIN");
+    ASSERT_EQ(CommandTrace::commandKeyFromName("game.no_such_command"), -1);
+    ASSERT_EQ(CommandTrace::commandKeyFromName("dump_zone"), -1);
+}
+
+TEST(CommandTraceTest, SlowCommandsAreDescribed)
+{
+    const int dumpZone = CommandTrace::commandKeyFromName("game.dump_zone");
+    CommandTrace::takeSummaries();
+
+    CommandTrace fast;
+    ASSERT_TRUE(fast.start(1, dumpZone, 2000));
+    ASSERT_TRUE(fast.finish(5).isEmpty());
+
+    CommandTrace slow;
+    ASSERT_TRUE(slow.start(1, dumpZone, 0));
+    const qint64 lockStart = slow.now();
+    QThread::msleep(6);
+    slow.addSpan(CommandTrace::LockWait, "gameMutex", lockStart);
+    const QString description = slow.finish(5);
+    ASSERT_TRUE(description.startsWith("Slow command game.DUMP_ZONE"));
+    ASSERT_TRUE(description.contains("gameMutex"));
+
+    const QList<CommandTrace::Summary> summaries = CommandTrace::takeSummaries();
+    ASSERT_EQ(summaries.size(), 1);
+    ASSERT_EQ(summaries[0].commandKey, dumpZone);
+    ASSERT_EQ(summaries[0].count, 2u);
+    ASSERT_GE(summaries[0].max[CommandTrace::LockWait], 6000);
+    ASSERT_GE(summaries[0].max[CommandTrace::Parse], 2);
+    ASSERT_TRUE(CommandTrace::takeSummaries().isEmpty());
+}
+
+TEST(CommandTraceTest, Sampling)
+{
+    CommandTrace disabled;
+    ASSERT_FALSE(disabled.start(0, -1, 0));
+    ASSERT_TRUE(disabled.finish(1).isEmpty());
+
+    CommandTrace first;
+    ASSERT_TRUE(first.start(1, -1, 0));
+    first.finish(0);
+
+    int traced = 0;
+    for (int i = 0; i < 9; ++i) {
+        CommandTrace trace;
+        if (trace.start(3, -1, 0))
+            ++traced;
+        trace.finish(0);
+    }
+    ASSERT_EQ(traced, 3);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
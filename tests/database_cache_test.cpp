@@ -0,0 +1,89 @@
+#include "../servatrice/src/database_cache.h"
+
+#include "gtest/gtest.h"
+#include <QThread>
+
+namespace
+{
+
+TEST(DatabaseCacheTest, UserIdsIgnoreCase)
+{
+    DatabaseCache cache(10, 10, 10, 60);
+    int userId = 0;
+    ASSERT_FALSE(cache.findUserId("Alice", userId));
+
+    cache.insertUserId("Alice", 42);
+    ASSERT_TRUE(cache.findUserId("alice", userId));
+    ASSERT_EQ(userId, 42);
+
+    cache.removeUser("ALICE");
+    ASSERT_FALSE(cache.findUserId("Alice", userId));
+
+    const DatabaseCache::Counters counters = cache.getUserIdCounters();
+    ASSERT_EQ(counters.hits, 1u);
+    ASSERT_EQ(counters.misses, 2u);
+}
+
+TEST(DatabaseCacheTest, ListEntriesAreInvalidatedOneByOne)
+{
+    DatabaseCache cache(10, 10, 10, 60);
+    cache.insertListEntry("ignore", "Alice", "Bob", true);
+    cache.insertListEntry("buddy", "Alice", "Bob", false);
+    cache.insertListEntry("ignore", "Bob", "Alice", false);
+
+    cache.removeListEntry("ignore", "Alice", "bob");
+
+    bool isListed;
+    ASSERT_FALSE(cache.findListEntry("ignore", "Alice", "Bob", isListed));
+    ASSERT_TRUE(cache.findListEntry("buddy", "Alice", "Bob", isListed));
+    ASSERT_FALSE(isListed);
+    ASSERT_TRUE(cache.findListEntry("ignore", "Bob", "Alice", isListed));
+}
+
+TEST(DatabaseCacheTest, CacheIsBounded)
+{
+    DatabaseCache cache(2, 2, 2, 60);
+    cache.insertUserId("a", 1);
+    cache.insertUserId("b", 2);
+    cache.insertUserId("c", 3);
+
+    int userId;
+    int found = 0;
+    for (const QString &name : {"a", "b", "c"})
+        found += cache.findUserId(name, userId) ? 1 : 0;
+    ASSERT_EQ(found, 2);
+}
+
+TEST(DatabaseCacheTest, EntriesExpire)
+{
+    DatabaseCache cache(10, 10, 10, 1);
+    cache.insertUserId("Alice", 42);
+    QThread::msleep(1100);
+
+    int userId;
+    ASSERT_FALSE(cache.findUserId("Alice", userId));
+}
+
+TEST(DatabaseCacheTest, BansThatRanOutAreLookedUpAgain)
+{
+    DatabaseCache cache(10, 10, 10, 60);
+    DatabaseCache::BanState state{true, "spam", QDateTime::currentDateTimeUtc().addSecs(-1)};
+    cache.insertBanState("127.0.0.1", "Alice", "", state);
+    ASSERT_FALSE(cache.findBanState("127.0.0.1", "Alice", "", state));
+
+    state = {true, "spam", QDateTime()};
+    cache.insertBanState("127.0.0.1", "Alice", "", state);
+    ASSERT_TRUE(cache.findBanState("127.0.0.1", "alice", "", state));
+    ASSERT_TRUE(state.banned);
+
+    cache.clearBanStates();
+    ASSERT_FALSE(cache.findBanState("127.0.0.1", "Alice", "", state));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
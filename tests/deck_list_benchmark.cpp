@@ -0,0 +1,142 @@
+#include "../common/decklist.h"
+
+#include "gtest/gtest.h"
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <iostream>
+
+namespace
+{
+
+const int decksPerFormat = 2000;
+
+// a few decks the way they are pasted from deck building sites
+const QStringList plainDecks = {
+    "Mono Red Aggro\n"
+    "\n"
+    "4 Monastery Swiftspear (KTK) 118\n"
+    "4 Soul-Scar Mage\n"
+    "4 Kumano Faces Kakkazan\n"
+    "4 Play with Fire\n"
+    "4 Lightning Strike\n"
+    "3 Bonecrusher Giant // Stomp\n"
+    "2 Fable of the Mirror-Breaker (NEO) 141\n"
+    "4 Reckless Charge\n"
+    "20 Mountain\n"
+    "\n"
+    "Sideboard\n"
+    "2 Abrade\n"
+    "3 Smash to Smithereens\n"
+    "2 Roiling Vortex *F*\n",
+
+    "Deck\n"
+    "1x Llanowar Elves\n"
+    "3x Elvish Mystic [M14]\n"
+    "4 Sylvan Caryatid\n"
+    "2 Delver of Secrets (Transform) Insectile Aberration\n"
+    "4 Growth Spiral\n"
+    "2 Uro, Titan of Nature’s Wrath\n"
+    "4 Hydroid Krasis\n"
+    "2 Fire | Ice\n"
+    "10 Forest\n"
+    "8 Island\n"
+    "SB: 2 Negate\n"
+    "SB: 3 Aether Gust (M20) 42\n",
+};
+
+int countCards(DeckList &deckList)
+{
+    int count = 0;
+    deckList.forEachCard([&count](InnerDecklistNode *, DecklistCardNode *card) { count += card->getNumber(); });
+    return count;
+}
+
+QStringList nativeDecks()
+{
+    QStringList decks;
+    for (const QString &plainDeck : plainDecks) {
+        QString deck(plainDeck);
+        QTextStream stream(&deck);
+        DeckList deckList;
+        deckList.loadFromStream_Plain(stream, false);
+        decks.append(deckList.writeToString_Native());
+    }
+    return decks;
+}
+
+TEST(DeckListBenchmark, NativeRoundTripKeepsTheCards)
+{
+    for (const QString &plainDeck : plainDecks) {
+        QString deck(plainDeck);
+        QTextStream stream(&deck);
+        DeckList plainDeckList;
+        ASSERT_TRUE(plainDeckList.loadFromStream_Plain(stream, false));
+
+        DeckList nativeDeckList;
+        ASSERT_TRUE(nativeDeckList.loadFromString_Native(plainDeckList.writeToString_Native()));
+        ASSERT_EQ(nativeDeckList.getCardRefList().size(), plainDeckList.getCardRefList().size());
+        ASSERT_EQ(countCards(nativeDeckList), countCards(plainDeckList));
+        ASSERT_EQ(nativeDeckList.getDeckHash(), plainDeckList.getDeckHash());
+    }
+}
+
+TEST(DeckListBenchmark, ParseCorpus)
+{
+    const QStringList native = nativeDecks();
+    int cards = 0;
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int i = 0; i < decksPerFormat; ++i) {
+        QString deck(plainDecks.at(i % plainDecks.size()));
+        QTextStream stream(&deck);
+        DeckList deckList;
+        deckList.loadFromStream_Plain(stream, false);
+        cards += countCards(deckList);
+    }
+    const qint64 plainMsecs = timer.elapsed();
+
+    timer.restart();
+    for (int i = 0; i < decksPerFormat; ++i) {
+        DeckList deckList;
+        deckList.loadFromString_Native(native.at(i % native.size()));
+        cards -= countCards(deckList);
+    }
+    const qint64 nativeMsecs = timer.elapsed();
+
+    ASSERT_EQ(cards, 0);
+    std::cout << decksPerFormat << " decks of each format: plain " << plainMsecs << " ms, native " << nativeMsecs
+              << " ms" << std::endl;
+}
+
+TEST(DeckListBenchmark, ParseCube)
+{
+    // the size of a cube list, with the punctuation the names are normalized for
+    const int cubeSize = 540;
+    QString cube("Cube\n\n");
+    for (int i = 0; i < cubeSize; ++i) {
+        cube += QString("1 Card’s Name %1 | Æther %1\n").arg(i);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < decksPerFormat / 100; ++i) {
+        QString deck(cube);
+        QTextStream stream(&deck);
+        DeckList deckList;
+        ASSERT_TRUE(deckList.loadFromStream_Plain(stream, false));
+        ASSERT_EQ(countCards(deckList), cubeSize);
+        ASSERT_TRUE(deckList.getCardList().contains("Card's Name 0 // Aether 0"));
+    }
+    std::cout << decksPerFormat / 100 << " cubes of " << cubeSize << " cards: " << timer.elapsed() << " ms"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
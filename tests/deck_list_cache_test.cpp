@@ -0,0 +1,79 @@
+#include "../common/deck_list_cache.h"
+#include "../common/decklist.h"
+
+#include "gtest/gtest.h"
+#include <memory>
+
+namespace
+{
+
+QString nativeDeck(const QString &name)
+{
+    DeckList deck;
+    deck.setName(name);
+    deck.addCard("Lightning Bolt", DECK_ZONE_MAIN, -1, "M10", "146");
+    deck.addCard("Mountain", DECK_ZONE_MAIN, -1);
+    deck.addCard("Smash to Smithereens", DECK_ZONE_SIDE, -1);
+    return deck.writeToString_Native();
+}
+
+TEST(DeckListCacheTest, SelectingADeckAgainCopiesIt)
+{
+    DeckListCache cache(10);
+    const QString text = nativeDeck("Burn");
+
+    std::unique_ptr<DeckList> first(cache.load(text));
+    std::unique_ptr<DeckList> second(cache.load(text));
+    ASSERT_NE(first.get(), second.get());
+    ASSERT_EQ(second->getName(), "Burn");
+    ASSERT_EQ(second->getDeckHash(), first->getDeckHash());
+    ASSERT_EQ(second->writeToString_Native(), first->writeToString_Native());
+
+    const DeckListCache::Counters counters = cache.getCounters();
+    ASSERT_EQ(counters.hits, 1u);
+    ASSERT_EQ(counters.misses, 1u);
+}
+
+TEST(DeckListCacheTest, DecksWithTheSameCardsKeepTheirNames)
+{
+    DeckListCache cache(10);
+    std::unique_ptr<DeckList> burn(cache.load(nativeDeck("Burn")));
+    std::unique_ptr<DeckList> red(cache.load(nativeDeck("Red")));
+
+    ASSERT_EQ(burn->getDeckHash(), red->getDeckHash());
+    ASSERT_EQ(burn->getName(), "Burn");
+    ASSERT_EQ(red->getName(), "Red");
+    ASSERT_EQ(cache.getCounters().misses, 2u);
+}
+
+TEST(DeckListCacheTest, CopiesAreIndependent)
+{
+    DeckListCache cache(10);
+    const QString text = nativeDeck("Burn");
+    std::unique_ptr<DeckList> first(cache.load(text));
+    first->setName("Changed");
+    first.reset();
+
+    std::unique_ptr<DeckList> second(cache.load(text));
+    ASSERT_EQ(second->getName(), "Burn");
+}
+
+TEST(DeckListCacheTest, SizeZeroParsesEveryDeck)
+{
+    DeckListCache cache(0);
+    const QString text = nativeDeck("Burn");
+    std::unique_ptr<DeckList> first(cache.load(text));
+    std::unique_ptr<DeckList> second(cache.load(text));
+
+    ASSERT_EQ(second->getName(), "Burn");
+    ASSERT_EQ(cache.getCounters().hits, 0u);
+    ASSERT_EQ(cache.getCounters().misses, 2u);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,70 @@
+#include "../common/framed_input_buffer.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+QByteArray frame(const QByteArray &payload)
+{
+    QByteArray result(4, 0);
+    const auto size = static_cast<unsigned int>(payload.size());
+    result[0] = (char)(size >> 24);
+    result[1] = (char)(size >> 16);
+    result[2] = (char)(size >> 8);
+    result[3] = (char)size;
+    return result + payload;
+}
+
+TEST(FramedInputBufferTest, ReadsPipelinedMessages)
+{
+    FramedInputBuffer buffer;
+    buffer.append(frame("first") + frame("second"));
+
+    int length = 0;
+    ASSERT_TRUE(buffer.takeLength(length));
+    ASSERT_EQ(length, 5);
+    ASSERT_EQ(QByteArray(buffer.data(), length), QByteArray("first"));
+    buffer.skip(length);
+
+    ASSERT_TRUE(buffer.takeLength(length));
+    ASSERT_EQ(length, 6);
+    ASSERT_EQ(QByteArray(buffer.data(), length), QByteArray("second"));
+    buffer.skip(length);
+
+    ASSERT_TRUE(buffer.isEmpty());
+}
+
+TEST(FramedInputBufferTest, KeepsPartialMessageAcrossAppends)
+{
+    FramedInputBuffer buffer;
+    const QByteArray data = frame("a") + frame("payload");
+    buffer.append(data.left(7));
+
+    int length = 0;
+    ASSERT_TRUE(buffer.takeLength(length));
+    buffer.skip(length);
+    ASSERT_FALSE(buffer.takeLength(length));
+    ASSERT_EQ(buffer.size(), 2);
+
+    buffer.append(data.mid(7));
+    ASSERT_TRUE(buffer.takeLength(length));
+    ASSERT_EQ(QByteArray(buffer.data(), length), QByteArray("payload"));
+}
+
+TEST(FramedInputBufferTest, StartsWith)
+{
+    FramedInputBuffer buffer;
+    buffer.append("<?xml version");
+    ASSERT_TRUE(buffer.startsWith("<?xm"));
+    buffer.skip(2);
+    ASSERT_FALSE(buffer.startsWith("<?xm"));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,1094 @@
+#include "../common/color.h"
+#include "../common/decklist.h"
+#include "../common/game_replay_writer.h"
+#include "../common/get_pb_extension.h"
+#include "../common/rng_abstract.h"
+#include "../common/server.h"
+#include "../common/server_abstractuserinterface.h"
+#include "../common/server_card.h"
+#include "../common/server_cardzone.h"
+#include "../common/server_database_interface.h"
+#include "../common/server_game.h"
+#include "../common/server_player.h"
+#include "../common/server_response_containers.h"
+#include "../common/server_room.h"
+#include "pb/command_attach_card.pb.h"
+#include "pb/command_create_arrow.pb.h"
+#include "pb/command_create_counter.pb.h"
+#include "pb/command_create_token.pb.h"
+#include "pb/command_deck_select.pb.h"
+#include "pb/command_delete_arrow.pb.h"
+#include "pb/command_draw_cards.pb.h"
+#include "pb/command_flip_card.pb.h"
+#include "pb/command_game_say.pb.h"
+#include "pb/command_inc_counter.pb.h"
+#include "pb/command_move_card.pb.h"
+#include "pb/command_next_turn.pb.h"
+#include "pb/command_ready_start.pb.h"
+#include "pb/command_roll_die.pb.h"
+#include "pb/command_set_active_phase.pb.h"
+#include "pb/command_set_card_attr.pb.h"
+#include "pb/command_set_card_counter.pb.h"
+#include "pb/command_set_counter.pb.h"
+#include "pb/command_shuffle.pb.h"
+#include "pb/event_attach_card.pb.h"
+#include "pb/event_create_arrow.pb.h"
+#include "pb/event_create_counter.pb.h"
+#include "pb/event_create_token.pb.h"
+#include "pb/event_delete_arrow.pb.h"
+#include "pb/event_draw_cards.pb.h"
+#include "pb/event_flip_card.pb.h"
+#include "pb/event_game_say.pb.h"
+#include "pb/event_game_state_changed.pb.h"
+#include "pb/event_move_card.pb.h"
+#include "pb/event_roll_die.pb.h"
+#include "pb/event_set_active_phase.pb.h"
+#include "pb/event_set_active_player.pb.h"
+#include "pb/event_set_card_attr.pb.h"
+#include "pb/event_set_card_counter.pb.h"
+#include "pb/event_set_counter.pb.h"
+#include "pb/event_shuffle.pb.h"
+#include "pb/game_commands.pb.h"
+#include "pb/game_event_container.pb.h"
+#include "pb/game_hibernation.pb.h"
+#include "pb/game_replay.pb.h"
+#include "pb/response.pb.h"
+
+#include "gtest/gtest.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSet>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+
+RNG_Abstract *rng;
+
+std::atomic<long long> allocationCount{0};
+
+// Qt containers allocate with malloc, not with operator new, so the allocations are counted below it where
+// the C library allows that.
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *pointer, std::size_t size);
+
+void *malloc(std::size_t size) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, std::size_t size) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+}
+#else
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+#endif
+
+namespace
+{
+
+const unsigned int sessionSeed = 4711;
+const int sessionTurns = 60;
+const int benchmarkRounds = 20;
+
+// the same shuffles and dice rolls on every run, so that a trace finds the cards it names
+class SeededRng : public RNG_Abstract
+{
+public:
+    void seed(unsigned int value)
+    {
+        engine.seed(value);
+    }
+    unsigned int rand(int min, int max) override
+    {
+        return std::uniform_int_distribution<int>(min, max)(engine);
+    }
+
+private:
+    std::mt19937 engine;
+};
+
+class BenchmarkDatabaseInterface : public Server_DatabaseInterface
+{
+public:
+    // the replay of the game, stored when the game ends
+    GameReplay storedReplay;
+
+    AuthenticationResult checkUserPassword(Server_ProtocolHandler * /* handler */,
+                                           const QString & /* user */,
+                                           const QString & /* password */,
+                                           const QString & /* clientId */,
+                                           QString & /* reasonStr */,
+                                           int & /* secondsLeft */,
+                                           bool /* passwordNeedsHash */) override
+    {
+        return UnknownUser;
+    }
+    ServerInfo_User getUserData(const QString &name, bool /* withId */) override
+    {
+        ServerInfo_User result;
+        result.set_name(name.toStdString());
+        return result;
+    }
+    void storeGameInformation(const QString & /* roomName */,
+                              const QStringList & /* roomGameTypes */,
+                              const ServerInfo_Game & /* gameInfo */,
+                              const QSet<QString> & /* allPlayersEver */,
+                              const QSet<QString> & /* allSpectatorsEver */,
+                              const QList<GameReplayWriter *> &replayList) override
+    {
+        // the benchmark games are started once, their replay is the first one
+        const QByteArray replay = replayList.first()->serialize();
+        storedReplay.ParseFromArray(replay.constData(), replay.size());
+    }
+    int getNextGameId() override
+    {
+        return 1;
+    }
+    int getNextReplayId() override
+    {
+        return ++lastReplayId;
+    }
+    int getActiveUserCount(QString /* connectionType */) override
+    {
+        return 0;
+    }
+
+private:
+    int lastReplayId = 0;
+};
+
+class BenchmarkServer : public Server
+{
+public:
+    explicit BenchmarkServer(Server_DatabaseInterface *databaseInterface)
+    {
+        setDatabaseInterface(databaseInterface);
+        room = new Server_Room(0, 0, "Benchmark", QString(), QString(), QString(), false, QString(), QStringList(),
+                               this);
+        addRoom(room);
+    }
+    ~BenchmarkServer() override
+    {
+        prepareDestroy();
+    }
+    Server_Room *getRoom() const
+    {
+        return room;
+    }
+
+private:
+    Server_Room *room;
+};
+
+// a connection that only counts what it would have sent
+class BenchmarkUser : public Server_AbstractUserInterface
+{
+public:
+    qint64 eventBytes = 0;
+
+    BenchmarkUser(Server *_server, const ServerInfo_User &userInfo)
+        : Server_AbstractUserInterface(_server, ServerInfo_User_Container(userInfo))
+    {
+    }
+    int getLastCommandTime() const override
+    {
+        return 0;
+    }
+    bool addSaidMessageSize(int /* size */) override
+    {
+        return true;
+    }
+    void sendProtocolItem(const Response & /* item */) override
+    {
+    }
+    void sendProtocolItem(const SessionEvent & /* item */) override
+    {
+    }
+    void sendProtocolItem(const GameEventContainer &item) override
+    {
+        eventBytes += static_cast<qint64>(item.ByteSizeLong());
+    }
+    void sendProtocolItem(const RoomEvent & /* item */) override
+    {
+    }
+    using Server_AbstractUserInterface::sendSerializedProtocolItem;
+    void sendSerializedProtocolItem(const GameEventContainer &item, const QByteArray &serializedMessage) override
+    {
+        if (serializedMessage.isEmpty())
+            sendProtocolItem(item);
+        else
+            eventBytes += serializedMessage.size();
+    }
+};
+
+template <class T> GameCommand makeGameCommand(const T &command)
+{
+    GameCommand result;
+    result.MutableExtension(T::ext)->CopyFrom(command);
+    return result;
+}
+
+GameCommand drawCards(int number)
+{
+    Command_DrawCards command;
+    command.set_number(number);
+    return makeGameCommand(command);
+}
+
+GameCommand moveCard(int startPlayerId,
+                     const std::string &startZone,
+                     int cardId,
+                     int targetPlayerId,
+                     const std::string &targetZone,
+                     int x,
+                     int y,
+                     bool faceDown = false)
+{
+    Command_MoveCard command;
+    command.set_start_player_id(startPlayerId);
+    command.set_start_zone(startZone);
+    CardToMove *card = command.mutable_cards_to_move()->add_card();
+    card->set_card_id(cardId);
+    card->set_face_down(faceDown);
+    command.set_target_player_id(targetPlayerId);
+    command.set_target_zone(targetZone);
+    command.set_x(x);
+    command.set_y(y);
+    return makeGameCommand(command);
+}
+
+GameCommand setCardAttr(const std::string &zone, int cardId, CardAttribute attribute, const std::string &value)
+{
+    Command_SetCardAttr command;
+    command.set_zone(zone);
+    command.set_card_id(cardId);
+    command.set_attribute(attribute);
+    command.set_attr_value(value);
+    return makeGameCommand(command);
+}
+
+GameCommand setCardCounter(const std::string &zone, int cardId, int counterId, int value)
+{
+    Command_SetCardCounter command;
+    command.set_zone(zone);
+    command.set_card_id(cardId);
+    command.set_counter_id(counterId);
+    command.set_counter_value(value);
+    return makeGameCommand(command);
+}
+
+GameCommand createToken(const std::string &zone, const std::string &name, const std::string &pt, int x, int y)
+{
+    Command_CreateToken command;
+    command.set_zone(zone);
+    command.set_card_name(name);
+    command.set_pt(pt);
+    command.set_destroy_on_zone_change(true);
+    command.set_x(x);
+    command.set_y(y);
+    return makeGameCommand(command);
+}
+
+GameCommand createArrow(int startPlayerId,
+                        const std::string &startZone,
+                        int startCardId,
+                        int targetPlayerId,
+                        const std::string &targetZone,
+                        int targetCardId,
+                        const color &arrowColor)
+{
+    Command_CreateArrow command;
+    command.set_start_player_id(startPlayerId);
+    command.set_start_zone(startZone);
+    command.set_start_card_id(startCardId);
+    command.set_target_player_id(targetPlayerId);
+    // arrows without a target zone point at the player
+    if (!targetZone.empty()) {
+        command.set_target_zone(targetZone);
+        command.set_target_card_id(targetCardId);
+    }
+    command.mutable_arrow_color()->CopyFrom(arrowColor);
+    return makeGameCommand(command);
+}
+
+GameCommand deleteArrow(int arrowId)
+{
+    Command_DeleteArrow command;
+    command.set_arrow_id(arrowId);
+    return makeGameCommand(command);
+}
+
+GameCommand gameSay(const std::string &message)
+{
+    Command_GameSay command;
+    command.set_message(message);
+    return makeGameCommand(command);
+}
+
+GameCommand incCounter(int counterId, int delta)
+{
+    Command_IncCounter command;
+    command.set_counter_id(counterId);
+    command.set_delta(delta);
+    return makeGameCommand(command);
+}
+
+GameCommand setCounter(int counterId, int value)
+{
+    Command_SetCounter command;
+    command.set_counter_id(counterId);
+    command.set_value(value);
+    return makeGameCommand(command);
+}
+
+GameCommand rollDie(int sides, int count)
+{
+    Command_RollDie command;
+    command.set_sides(sides);
+    command.set_count(count);
+    return makeGameCommand(command);
+}
+
+GameCommand flipCard(const std::string &zone, int cardId, bool faceDown)
+{
+    Command_FlipCard command;
+    command.set_zone(zone);
+    command.set_card_id(cardId);
+    command.set_face_down(faceDown);
+    return makeGameCommand(command);
+}
+
+GameCommand attachCard(const std::string &startZone,
+                       int cardId,
+                       int targetPlayerId,
+                       const std::string &targetZone,
+                       int targetCardId)
+{
+    Command_AttachCard command;
+    command.set_start_zone(startZone);
+    command.set_card_id(cardId);
+    // without a target the card is unattached
+    if (targetPlayerId != -1) {
+        command.set_target_player_id(targetPlayerId);
+        command.set_target_zone(targetZone);
+        command.set_target_card_id(targetCardId);
+    }
+    return makeGameCommand(command);
+}
+
+GameCommand shuffle(const std::string &zone)
+{
+    Command_Shuffle command;
+    command.set_zone_name(zone);
+    return makeGameCommand(command);
+}
+
+GameCommand setActivePhase(int phase)
+{
+    Command_SetActivePhase command;
+    command.set_phase(phase);
+    return makeGameCommand(command);
+}
+
+QString benchmarkDeck()
+{
+    DeckList deck;
+    const QList<QPair<QString, int>> cards = {{"Forest", 20},         {"Mountain", 4},      {"Llanowar Elves", 4},
+                                              {"Grizzly Bears", 8},   {"Craw Wurm", 8},     {"Giant Growth", 8},
+                                              {"Rancor", 4},          {"Lightning Bolt", 4}};
+    for (const auto &card : cards)
+        deck.addCard(card.first, DECK_ZONE_MAIN, -1)->setNumber(card.second);
+    return deck.writeToString_Native();
+}
+
+/**
+ * A game on its own server, with a player or spectator for every seat, the players' decks selected and the game
+ * started. Commands are run the way Server_ProtocolHandler runs them, without the protocol around them.
+ */
+class BenchmarkGame
+{
+public:
+    // seats[i] tells whether player i is a spectator
+    explicit BenchmarkGame(const QVector<bool> &seats) : server(&database)
+    {
+        static_cast<SeededRng *>(rng)->seed(sessionSeed);
+
+        game = new Server_Game(userInfo(0), database.getNextGameId(), "Benchmark", QString(), seats.count(false),
+                               QList<int>(), false, false, seats.contains(true), false, true, false, 20,
+                               server.getRoom());
+        server.getRoom()->addGame(game);
+        for (int i = 0; i < seats.size(); ++i) {
+            auto *user = new BenchmarkUser(&server, userInfo(i));
+            users.append(user);
+            ResponseContainer rc(-1);
+            game->addPlayer(user, rc, seats[i], false);
+        }
+
+        Command_DeckSelect deckSelect;
+        deckSelect.set_deck(benchmarkDeck().toStdString());
+        Command_ReadyStart readyStart;
+        readyStart.set_ready(true);
+        for (int i = 0; i < seats.size(); ++i) {
+            if (!seats[i]) {
+                execute(i, makeGameCommand(deckSelect));
+                execute(i, makeGameCommand(readyStart));
+            }
+        }
+        // the game starts through a queued call
+        QCoreApplication::processEvents();
+    }
+    ~BenchmarkGame()
+    {
+        finish();
+        qDeleteAll(users);
+    }
+    BenchmarkGame(const BenchmarkGame &) = delete;
+    BenchmarkGame &operator=(const BenchmarkGame &) = delete;
+
+    Server_Game *getGame() const
+    {
+        return game;
+    }
+    Server_Player *getPlayer(int playerId) const
+    {
+        return game->getPlayers().value(playerId);
+    }
+    qint64 getEventBytes() const
+    {
+        qint64 result = 0;
+        for (const BenchmarkUser *user : users)
+            result += user->eventBytes;
+        return result;
+    }
+
+    Response::ResponseCode execute(int playerId, const GameCommand &command)
+    {
+        QMutexLocker locker(&game->gameMutex);
+        Server_Player *player = getPlayer(playerId);
+        if (!player)
+            return Response::RespNameNotFound;
+        ResponseContainer rc(-1);
+        GameEventStorage ges;
+        const Response::ResponseCode response = player->processGameCommand(command, rc, ges);
+        ges.sendToGame(game);
+        return response;
+    }
+
+    /**
+     * Replaces the boards the players were dealt by the ones of another game, see boardFromReplay().
+     */
+    void loadBoard(const QList<GameHibernation_Player> &board)
+    {
+        QMutexLocker locker(&game->gameMutex);
+        for (const GameHibernation_Player &info : board) {
+            if (Server_Player *player = getPlayer(info.player_id())) {
+                player->clearZones();
+                player->wakeUp(info);
+            }
+        }
+        for (const GameHibernation_Player &info : board) {
+            if (Server_Player *player = getPlayer(info.player_id()))
+                player->wakeUpAttachmentsAndArrows(info);
+        }
+    }
+
+    // ends the game and returns its replay
+    GameReplay finish()
+    {
+        if (game) {
+            delete game;
+            game = nullptr;
+            // the players and their cards
+            QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        }
+        return database.storedReplay;
+    }
+
+private:
+    BenchmarkDatabaseInterface database;
+    BenchmarkServer server;
+    Server_Game *game;
+    QList<BenchmarkUser *> users;
+
+    static ServerInfo_User userInfo(int seat)
+    {
+        ServerInfo_User result;
+        result.set_name("player" + std::to_string(seat));
+        return result;
+    }
+};
+
+QList<Server_Card *> cardsIn(Server_Player *player, Server_Player::StandardZone zone)
+{
+    return player->getZone(zone)->getCards();
+}
+
+/**
+ * Plays a game of two players putting lands and creatures on the table, attacking, chatting and keeping their
+ * life totals, the way the part of a real game that runs on the server goes. Returns how many commands were
+ * rejected, the replay of the game only has the ones that weren't.
+ */
+int playSession(BenchmarkGame &game, int turns)
+{
+    int rejected = 0;
+    auto execute = [&game, &rejected](int playerId, const GameCommand &command) {
+        if (game.execute(playerId, command) != Response::RespOk)
+            ++rejected;
+    };
+
+    for (int playerId = 0; playerId < 2; ++playerId)
+        execute(playerId, drawCards(7));
+
+    for (int turn = 0; turn < turns; ++turn) {
+        const int active = game.getGame()->getActivePlayer();
+        const int opponent = 1 - active;
+        Server_Player *player = game.getPlayer(active);
+        Server_Player *other = game.getPlayer(opponent);
+
+        execute(active, setCardAttr("table", -1, AttrTapped, "0"));
+        execute(active, setActivePhase(2));
+        execute(active, drawCards(1));
+        execute(active, setActivePhase(3));
+
+        const QList<Server_Card *> hand = cardsIn(player, Server_Player::HandZone);
+        if (!hand.isEmpty())
+            execute(active, moveCard(active, "hand", hand.first()->getId(), active, "table", turn, turn % 3));
+        if (turn % 3 == 0)
+            execute(active, createToken("table", "Saproling", "1/1", turn, 2));
+
+        QList<Server_Card *> table = cardsIn(player, Server_Player::TableZone);
+        if (!table.isEmpty())
+            execute(active, setCardCounter("table", table.first()->getId(), 1, turn % 5));
+        if (turn % 7 == 3 && table.size() >= 3)
+            execute(active, attachCard("table", table.last()->getId(), active, "table", table.first()->getId()));
+        if (turn % 8 == 6 && !table.isEmpty())
+            execute(active, flipCard("table", table.first()->getId(), !table.first()->getFaceDown()));
+
+        execute(active, setActivePhase(4));
+        table = cardsIn(player, Server_Player::TableZone);
+        if (!table.isEmpty()) {
+            Server_Card *attacker = table.at(turn % table.size());
+            execute(active, setCardAttr("table", attacker->getId(), AttrTapped, "1"));
+            const QList<Server_Card *> blockers = cardsIn(other, Server_Player::TableZone);
+            if (blockers.isEmpty())
+                execute(active, createArrow(active, "table", attacker->getId(), opponent, std::string(), -1,
+                                            makeColor(255, 0, 0)));
+            else
+                execute(active, createArrow(active, "table", attacker->getId(), opponent, "table",
+                                            blockers.first()->getId(), makeColor(255, 0, 0)));
+            if (turn % 4 == 1 && !player->getArrows().isEmpty())
+                execute(active, deleteArrow(player->getArrows().lastKey()));
+        }
+        execute(opponent, incCounter(0, -2));
+        execute(opponent, gameSay("turn " + std::to_string(turn)));
+        if (turn % 4 == 2)
+            execute(active, rollDie(20, 1));
+        if (turn % 10 == 9)
+            execute(active, setCounter(1, turn % 3));
+
+        table = cardsIn(player, Server_Player::TableZone);
+        if (turn % 5 == 4 && table.size() > 1)
+            execute(active, moveCard(active, "table", table.first()->getId(), active, "grave", 0, 0));
+        if (turn % 6 == 5)
+            execute(active, shuffle("deck"));
+
+        execute(active, setActivePhase(9));
+        execute(active, makeGameCommand(Command_NextTurn()));
+    }
+    return rejected;
+}
+
+struct TraceCommand
+{
+    int playerId;
+    GameCommand command;
+};
+using Trace = QVector<TraceCommand>;
+
+// the position of the event the game begins with, the state of the board when it was dealt
+int findGameStart(const GameReplay &replay)
+{
+    for (int i = 0; i < replay.event_list_size(); ++i) {
+        for (const GameEvent &event : replay.event_list(i).event_list()) {
+            if (getPbExtension(event) == GameEvent::GAME_STATE_CHANGED &&
+                event.GetExtension(Event_GameStateChanged::ext).game_started())
+                return i;
+        }
+    }
+    return -1;
+}
+
+const Event_GameStateChanged &gameStartState(const GameReplay &replay, int start)
+{
+    for (const GameEvent &event : replay.event_list(start).event_list()) {
+        if (getPbExtension(event) == GameEvent::GAME_STATE_CHANGED)
+            return event.GetExtension(Event_GameStateChanged::ext);
+    }
+    return Event_GameStateChanged::default_instance();
+}
+
+// the arrows a change of the phase takes off the board are deleted one by one, right before the new phase is
+// announced
+bool deletedByPhaseChange(const GameReplay &replay, int index)
+{
+    for (int i = index; i < replay.event_list_size(); ++i) {
+        const GameEventContainer &cont = replay.event_list(i);
+        if (cont.event_list_size() == 0)
+            continue;
+        if (cont.event_list_size() > 1 || getPbExtension(cont.event_list(0)) != GameEvent::DELETE_ARROW)
+            return getPbExtension(cont.event_list(0)) == GameEvent::SET_ACTIVE_PHASE;
+    }
+    return false;
+}
+
+// the command that caused event, false for events nothing in the trace can cause
+bool commandFromEvent(const GameEvent &event, GameCommand &command)
+{
+    switch (getPbExtension(event)) {
+        case GameEvent::DRAW_CARDS:
+            command = drawCards(event.GetExtension(Event_DrawCards::ext).number());
+            return true;
+        case GameEvent::SET_CARD_ATTR: {
+            const Event_SetCardAttr &info = event.GetExtension(Event_SetCardAttr::ext);
+            // without a card id the attribute was set on all cards of the zone
+            command = setCardAttr(info.zone_name(), info.has_card_id() ? info.card_id() : -1, info.attribute(),
+                                  info.attr_value());
+            return true;
+        }
+        case GameEvent::SET_CARD_COUNTER: {
+            const Event_SetCardCounter &info = event.GetExtension(Event_SetCardCounter::ext);
+            command = setCardCounter(info.zone_name(), info.card_id(), info.counter_id(), info.counter_value());
+            return true;
+        }
+        case GameEvent::CREATE_TOKEN: {
+            const Event_CreateToken &info = event.GetExtension(Event_CreateToken::ext);
+            Command_CreateToken token;
+            token.set_zone(info.zone_name());
+            token.set_card_name(info.card_name());
+            token.set_color(info.color());
+            token.set_pt(info.pt());
+            token.set_annotation(info.annotation());
+            token.set_destroy_on_zone_change(info.destroy_on_zone_change());
+            token.set_x(info.x());
+            token.set_y(info.y());
+            token.set_card_provider_id(info.card_provider_id());
+            command = makeGameCommand(token);
+            return true;
+        }
+        case GameEvent::CREATE_ARROW: {
+            const ServerInfo_Arrow &info = event.GetExtension(Event_CreateArrow::ext).arrow_info();
+            command = createArrow(info.start_player_id(), info.start_zone(), info.start_card_id(),
+                                  info.target_player_id(), info.target_zone(), info.target_card_id(),
+                                  info.arrow_color());
+            return true;
+        }
+        case GameEvent::DELETE_ARROW:
+            command = deleteArrow(event.GetExtension(Event_DeleteArrow::ext).arrow_id());
+            return true;
+        case GameEvent::CREATE_COUNTER: {
+            const ServerInfo_Counter &info = event.GetExtension(Event_CreateCounter::ext).counter_info();
+            Command_CreateCounter counter;
+            counter.set_counter_name(info.name());
+            counter.mutable_counter_color()->CopyFrom(info.counter_color());
+            counter.set_radius(info.radius());
+            counter.set_value(info.count());
+            command = makeGameCommand(counter);
+            return true;
+        }
+        case GameEvent::SET_COUNTER: {
+            // increments are recorded with the value they led to
+            const Event_SetCounter &info = event.GetExtension(Event_SetCounter::ext);
+            command = setCounter(info.counter_id(), info.value());
+            return true;
+        }
+        case GameEvent::GAME_SAY:
+            command = gameSay(event.GetExtension(Event_GameSay::ext).message());
+            return true;
+        case GameEvent::ROLL_DIE: {
+            const Event_RollDie &info = event.GetExtension(Event_RollDie::ext);
+            command = rollDie(static_cast<int>(info.sides()), std::max(info.values_size(), 1));
+            return true;
+        }
+        case GameEvent::FLIP_CARD: {
+            const Event_FlipCard &info = event.GetExtension(Event_FlipCard::ext);
+            command = flipCard(info.zone_name(), info.card_id(), info.face_down());
+            return true;
+        }
+        case GameEvent::ATTACH_CARD: {
+            const Event_AttachCard &info = event.GetExtension(Event_AttachCard::ext);
+            const int targetPlayerId = info.has_target_zone() ? info.target_player_id() : -1;
+            command = attachCard(info.start_zone(), info.card_id(), targetPlayerId, info.target_zone(),
+                                 info.target_card_id());
+            return true;
+        }
+        case GameEvent::SHUFFLE: {
+            const Event_Shuffle &info = event.GetExtension(Event_Shuffle::ext);
+            Command_Shuffle zoneShuffle;
+            zoneShuffle.set_zone_name(info.zone_name());
+            zoneShuffle.set_start(info.start());
+            zoneShuffle.set_end(info.end());
+            command = makeGameCommand(zoneShuffle);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+// the event of a card being attached to another one
+const GameEvent *findAttachment(const GameEventContainer &cont)
+{
+    for (const GameEvent &event : cont.event_list()) {
+        if (getPbExtension(event) == GameEvent::ATTACH_CARD &&
+            event.GetExtension(Event_AttachCard::ext).has_target_zone())
+            return &event;
+    }
+    return nullptr;
+}
+
+/**
+ * The commands that led to the events of a replay, from the start of the game on. Replays have the containers
+ * the acting players were sent, one for every command or command container: a container is turned into commands
+ * of the kind of its first event, the other events in it are what those commands caused. Moved cards sent in one
+ * container are moved by one command.
+ */
+Trace traceFromReplay(const GameReplay &replay)
+{
+    Trace trace;
+    const int start = findGameStart(replay);
+    if (start == -1)
+        return trace;
+
+    // the game begins with the turn of the first player, that isn't a command
+    int activePlayer = -1;
+    bool turnStarting = false;
+    for (int i = start + 1; i < replay.event_list_size(); ++i) {
+        const GameEventContainer &cont = replay.event_list(i);
+        if (cont.event_list_size() == 0)
+            continue;
+        // the arrows of the cards a command takes off the board or attaches are deleted first
+        int firstIndex = 0;
+        while (firstIndex < cont.event_list_size() - 1 &&
+               getPbExtension(cont.event_list(firstIndex)) == GameEvent::DELETE_ARROW)
+            ++firstIndex;
+        const GameEvent &first = cont.event_list(firstIndex);
+        const int type = getPbExtension(first);
+        const GameEvent *attachment = findAttachment(cont);
+
+        if (attachment && type == GameEvent::MOVE_CARD) {
+            // attaching a card can move the card it is attached to first
+            GameCommand command;
+            commandFromEvent(*attachment, command);
+            trace.append({attachment->player_id(), command});
+        } else if (type == GameEvent::SET_ACTIVE_PLAYER) {
+            if (activePlayer != -1)
+                trace.append({activePlayer, makeGameCommand(Command_NextTurn())});
+            activePlayer = first.GetExtension(Event_SetActivePlayer::ext).active_player_id();
+            turnStarting = true;
+        } else if (type == GameEvent::SET_ACTIVE_PHASE) {
+            // a new turn starts with its first phase
+            if (!turnStarting)
+                trace.append({activePlayer, setActivePhase(first.GetExtension(Event_SetActivePhase::ext).phase())});
+            turnStarting = false;
+        } else if (type == GameEvent::DELETE_ARROW && deletedByPhaseChange(replay, i)) {
+            continue;
+        } else if (type == GameEvent::MOVE_CARD) {
+            const Event_MoveCard &info = first.GetExtension(Event_MoveCard::ext);
+            GameCommand command = moveCard(info.start_player_id(), info.start_zone(), info.card_id(),
+                                           info.target_player_id(), info.target_zone(), info.x(), info.y(),
+                                           info.face_down());
+            ListOfCardsToMove *cards = command.MutableExtension(Command_MoveCard::ext)->mutable_cards_to_move();
+            for (int j = firstIndex + 1; j < cont.event_list_size(); ++j) {
+                const GameEvent &event = cont.event_list(j);
+                if (getPbExtension(event) != GameEvent::MOVE_CARD)
+                    continue;
+                const Event_MoveCard &other = event.GetExtension(Event_MoveCard::ext);
+                if (other.start_zone() == info.start_zone() && other.target_zone() == info.target_zone()) {
+                    CardToMove *card = cards->add_card();
+                    card->set_card_id(other.card_id());
+                    card->set_face_down(other.face_down());
+                }
+            }
+            // the cards nobody saw can't be told apart
+            if (info.card_id() != -1)
+                trace.append({first.player_id(), command});
+        } else {
+            for (const GameEvent &event : cont.event_list()) {
+                GameCommand command;
+                if (getPbExtension(event) == type && commandFromEvent(event, command))
+                    trace.append({event.player_id(), command});
+            }
+        }
+    }
+    return trace;
+}
+
+// seats[i] tells whether player i of the replay was a spectator, the ids nobody has are spectators
+QVector<bool> seatsFromReplay(const GameReplay &replay)
+{
+    const int start = findGameStart(replay);
+    if (start == -1)
+        return {false, false};
+    const Event_GameStateChanged &state = gameStartState(replay, start);
+    int seatCount = 0;
+    for (const ServerInfo_Player &player : state.player_list())
+        seatCount = std::max(seatCount, player.properties().player_id() + 1);
+    QVector<bool> seats(seatCount, true);
+    for (const ServerInfo_Player &player : state.player_list())
+        seats[player.properties().player_id()] = player.properties().spectator();
+    return seats;
+}
+
+/**
+ * The boards a replay started with, in the form hibernated players are woken up from. Nobody sees the decks, so
+ * every deck is rebuilt from the cards that left it, in the order they did until it was shuffled or had cards put
+ * back; the rest of it are nameless cards.
+ */
+QList<GameHibernation_Player> boardFromReplay(const GameReplay &replay)
+{
+    QList<GameHibernation_Player> board;
+    const int start = findGameStart(replay);
+    if (start == -1)
+        return board;
+
+    QMap<int, QList<ServerInfo_Card>> deckOrders;
+    QSet<int> reordered;
+    for (int i = start + 1; i < replay.event_list_size(); ++i) {
+        for (const GameEvent &event : replay.event_list(i).event_list()) {
+            const int type = getPbExtension(event);
+            if (type == GameEvent::DRAW_CARDS && !reordered.contains(event.player_id())) {
+                for (const ServerInfo_Card &card : event.GetExtension(Event_DrawCards::ext).cards())
+                    deckOrders[event.player_id()].append(card);
+            } else if (type == GameEvent::SHUFFLE &&
+                       event.GetExtension(Event_Shuffle::ext).zone_name() == "deck") {
+                reordered.insert(event.player_id());
+            } else if (type == GameEvent::MOVE_CARD) {
+                const Event_MoveCard &move = event.GetExtension(Event_MoveCard::ext);
+                if (move.target_zone() == "deck") {
+                    reordered.insert(move.target_player_id());
+                } else if (move.start_zone() == "deck" && !reordered.contains(move.start_player_id())) {
+                    ServerInfo_Card card;
+                    card.set_id(move.card_id());
+                    card.set_name(move.card_name());
+                    deckOrders[move.start_player_id()].append(card);
+                    // a card of unknown position, the order of the rest is unknown too
+                    if (move.card_id() == -1)
+                        reordered.insert(move.start_player_id());
+                }
+            }
+        }
+    }
+
+    for (const ServerInfo_Player &player : gameStartState(replay, start).player_list()) {
+        GameHibernation_Player info;
+        const int playerId = player.properties().player_id();
+        info.set_player_id(playerId);
+
+        QSet<int> usedIds;
+        for (const ServerInfo_Zone &zone : player.zone_list())
+            for (const ServerInfo_Card &card : zone.card_list())
+                usedIds.insert(card.id());
+        QList<ServerInfo_Card> deckOrder;
+        for (const ServerInfo_Card &card : deckOrders.value(playerId)) {
+            if (card.id() == -1 || usedIds.contains(card.id()))
+                break;
+            usedIds.insert(card.id());
+            deckOrder.append(card);
+        }
+
+        int nextCardId = 0;
+        for (const ServerInfo_Zone &zone : player.zone_list()) {
+            GameHibernation_Zone *zoneInfo = info.add_zone_list();
+            zoneInfo->mutable_info()->CopyFrom(zone);
+            zoneInfo->mutable_info()->clear_card_list();
+            for (const ServerInfo_Card &card : zone.card_list())
+                zoneInfo->add_card_list()->mutable_info()->CopyFrom(card);
+            if (zone.name() == "deck") {
+                for (int j = 0; j < zone.card_count(); ++j) {
+                    ServerInfo_Card *card = zoneInfo->add_card_list()->mutable_info();
+                    if (j < deckOrder.size()) {
+                        card->CopyFrom(deckOrder.at(j));
+                        continue;
+                    }
+                    while (usedIds.contains(nextCardId))
+                        ++nextCardId;
+                    card->set_id(nextCardId);
+                    usedIds.insert(nextCardId);
+                }
+            }
+        }
+        for (const int id : usedIds)
+            nextCardId = std::max(nextCardId, id + 1);
+        info.set_next_card_id(nextCardId);
+
+        int nextCounterId = 0;
+        for (const ServerInfo_Counter &counter : player.counter_list()) {
+            info.add_counter_list()->CopyFrom(counter);
+            nextCounterId = std::max(nextCounterId, counter.id() + 1);
+        }
+        info.set_next_counter_id(nextCounterId);
+        int nextArrowId = 1;
+        for (const ServerInfo_Arrow &arrow : player.arrow_list()) {
+            info.add_arrow_list()->CopyFrom(arrow);
+            nextArrowId = std::max(nextArrowId, arrow.id() + 1);
+        }
+        info.set_next_arrow_id(nextArrowId);
+        board.append(info);
+    }
+    return board;
+}
+
+// what the players were sent from the start of the game on, one serialized container after the other
+std::string eventsSinceStart(const GameReplay &replay)
+{
+    std::string result;
+    const int start = findGameStart(replay);
+    for (int i = std::max(start, 0); i < replay.event_list_size(); ++i)
+        result += replay.event_list(i).SerializeAsString();
+    return result;
+}
+
+struct ReplayResult
+{
+    int commands = 0;
+    int rejected = 0;
+    qint64 nanoseconds = 0;
+    long long allocations = 0;
+    qint64 eventBytes = 0;
+
+    void add(const ReplayResult &other)
+    {
+        commands += other.commands;
+        rejected += other.rejected;
+        nanoseconds += other.nanoseconds;
+        allocations += other.allocations;
+        eventBytes += other.eventBytes;
+    }
+};
+
+ReplayResult replayTrace(BenchmarkGame &game, const Trace &trace)
+{
+    ReplayResult result;
+    result.commands = trace.size();
+    const qint64 eventBytesBefore = game.getEventBytes();
+    const long long allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    QElapsedTimer timer;
+    timer.start();
+    for (const TraceCommand &command : trace) {
+        if (game.execute(command.playerId, command.command) != Response::RespOk)
+            ++result.rejected;
+    }
+    result.nanoseconds = timer.nsecsElapsed();
+    result.allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+    result.eventBytes = game.getEventBytes() - eventBytesBefore;
+    return result;
+}
+
+void report(const std::string &name, const ReplayResult &result)
+{
+    const double commands = std::max(result.commands, 1);
+    std::cout << name << ": " << result.commands << " commands, "
+              << static_cast<qint64>(commands * 1e9 / std::max<qint64>(result.nanoseconds, 1)) << " commands/s, "
+              << result.allocations / commands << " allocations/command, " << result.eventBytes / commands
+              << " event bytes/command, " << result.rejected << " rejected" << std::endl;
+}
+
+GameReplay recordSession()
+{
+    BenchmarkGame game({false, false});
+    const int rejected = playSession(game, sessionTurns);
+    std::cout << "recorded " << sessionTurns << " turns, " << rejected << " commands rejected" << std::endl;
+    return game.finish();
+}
+
+TEST(GameEngineBenchmark, TraceReplaysTheRecordedGame)
+{
+    const GameReplay recorded = recordSession();
+    const Trace trace = traceFromReplay(recorded);
+    ASSERT_GT(trace.size(), sessionTurns * 10);
+
+    BenchmarkGame game(seatsFromReplay(recorded));
+    const ReplayResult result = replayTrace(game, trace);
+    ASSERT_EQ(result.rejected, 0);
+    // the trace has to do exactly what the players did, or the benchmark measures another game
+    ASSERT_EQ(eventsSinceStart(game.finish()), eventsSinceStart(recorded));
+}
+
+TEST(GameEngineBenchmark, RecordedGame)
+{
+    const GameReplay recorded = recordSession();
+    const Trace trace = traceFromReplay(recorded);
+
+    ReplayResult total;
+    for (int round = 0; round < benchmarkRounds; ++round) {
+        BenchmarkGame game(seatsFromReplay(recorded));
+        total.add(replayTrace(game, trace));
+    }
+    report("recorded game", total);
+    ASSERT_EQ(total.rejected, 0);
+}
+
+// GAME_ENGINE_BENCHMARK_REPLAY=<replay file> benchmarks a game that was played on a server
+TEST(GameEngineBenchmark, ReplayFile)
+{
+    const QString fileName = QString::fromLocal8Bit(qgetenv("GAME_ENGINE_BENCHMARK_REPLAY"));
+    if (fileName.isEmpty())
+        GTEST_SKIP() << "GAME_ENGINE_BENCHMARK_REPLAY isn't set";
+
+    QFile file(fileName);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    const QByteArray data = file.readAll();
+    GameReplay replay;
+    ASSERT_TRUE(replay.ParseFromArray(data.constData(), data.size()));
+    const Trace trace = traceFromReplay(replay);
+    const QList<GameHibernation_Player> board = boardFromReplay(replay);
+
+    // the rejected commands are the ones that touched cards whose place in the deck nobody saw
+    ReplayResult total;
+    for (int round = 0; round < benchmarkRounds; ++round) {
+        BenchmarkGame game(seatsFromReplay(replay));
+        game.loadBoard(board);
+        total.add(replayTrace(game, trace));
+    }
+    report(fileName.toStdString(), total);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    SeededRng seededRng;
+    rng = &seededRng;
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
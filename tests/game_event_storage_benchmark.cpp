@@ -0,0 +1,108 @@
+#include "../common/rng_abstract.h"
+#include "../common/server_response_containers.h"
+#include "pb/event_move_card.pb.h"
+#include "pb/game_event_container.pb.h"
+
+#include "gtest/gtest.h"
+#include <QElapsedTimer>
+#include <iostream>
+#include <string>
+
+RNG_Abstract *rng;
+
+namespace
+{
+
+const int eventsPerCommand = 24;
+const int commandCount = 20000;
+
+Event_MoveCard moveCardEvent(int i)
+{
+    Event_MoveCard event;
+    event.set_card_id(i);
+    event.set_card_name("Llanowar Elves");
+    event.set_start_player_id(1);
+    event.set_start_zone("hand");
+    event.set_position(i);
+    event.set_target_player_id(1);
+    event.set_target_zone("table");
+    event.set_x(i * 2);
+    event.set_y(1);
+    return event;
+}
+
+// What GameEventStorage used to do: every item, container and event copy on the heap.
+std::string serializeWithHeapAllocations(const QList<Event_MoveCard> &events)
+{
+    QList<GameEvent *> items;
+    for (int i = 0; i < events.size(); ++i) {
+        auto *event = new GameEvent;
+        event->MutableExtension(Event_MoveCard::ext)->CopyFrom(events[i]);
+        event->set_player_id(1);
+        items.append(event);
+    }
+
+    auto *contPrivate = new GameEventContainer;
+    auto *contOthers = new GameEventContainer;
+    for (GameEvent *event : items) {
+        contPrivate->add_event_list()->CopyFrom(*event);
+        contOthers->add_event_list()->CopyFrom(*event);
+    }
+
+    std::string result = contPrivate->SerializeAsString() + contOthers->SerializeAsString();
+    delete contPrivate;
+    delete contOthers;
+    qDeleteAll(items);
+    return result;
+}
+
+std::string serializeWithGameEventStorage(const QList<Event_MoveCard> &events)
+{
+    GameEventStorage ges;
+    for (const Event_MoveCard &event : events)
+        ges.enqueueGameEvent(event, 1);
+
+    return ges.createGameEventContainer(GameEventStorageItem::SendToPrivate)->SerializeAsString() +
+           ges.createGameEventContainer(GameEventStorageItem::SendToOthers)->SerializeAsString();
+}
+
+TEST(GameEventStorageBenchmark, ArenaContainersMatchHeapContainers)
+{
+    QList<Event_MoveCard> events;
+    for (int i = 0; i < eventsPerCommand; ++i)
+        events.append(moveCardEvent(i));
+
+    ASSERT_EQ(serializeWithGameEventStorage(events), serializeWithHeapAllocations(events));
+}
+
+TEST(GameEventStorageBenchmark, CommandFanOut)
+{
+    QList<Event_MoveCard> events;
+    for (int i = 0; i < eventsPerCommand; ++i)
+        events.append(moveCardEvent(i));
+
+    size_t bytes = 0;
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int i = 0; i < commandCount; ++i)
+        bytes += serializeWithHeapAllocations(events).size();
+    const qint64 heapMsecs = timer.elapsed();
+
+    timer.restart();
+    for (int i = 0; i < commandCount; ++i)
+        bytes -= serializeWithGameEventStorage(events).size();
+    const qint64 arenaMsecs = timer.elapsed();
+
+    ASSERT_EQ(bytes, 0u);
+    std::cout << commandCount << " commands with " << eventsPerCommand << " events each: heap " << heapMsecs
+              << " ms, arena " << arenaMsecs << " ms" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
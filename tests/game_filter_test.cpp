@@ -0,0 +1,88 @@
+#include "../common/game_filter.h"
+#include "../common/pb/serverinfo_game.pb.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const qint64 now = 1700000000;
+
+ServerInfo_Game openGame()
+{
+    ServerInfo_Game game;
+    game.set_game_id(1);
+    game.set_description("Commander night");
+    game.set_max_players(4);
+    game.set_player_count(2);
+    game.add_game_types(3);
+    game.mutable_creator_info()->set_name("Alice");
+    game.set_start_time(now - 60);
+    return game;
+}
+
+TEST(GameFilterTest, EmptyFilterAcceptsOpenGames)
+{
+    GameFilter filter(ServerInfo_GameFilter(), true);
+    ASSERT_TRUE(filter.accepts(openGame(), now));
+
+    ServerInfo_Game closed;
+    closed.set_game_id(1);
+    closed.set_closed(true);
+    ASSERT_FALSE(filter.accepts(closed, now));
+}
+
+TEST(GameFilterTest, OnlyRegisteredGames)
+{
+    ServerInfo_Game game = openGame();
+    game.set_only_registered(true);
+    ASSERT_TRUE(GameFilter(ServerInfo_GameFilter(), true).accepts(game, now));
+    ASSERT_FALSE(GameFilter(ServerInfo_GameFilter(), false).accepts(game, now));
+}
+
+TEST(GameFilterTest, NamesAndTypes)
+{
+    ServerInfo_GameFilter settings;
+    settings.set_game_name_filter("COMMANDER");
+    settings.set_creator_name_filter("ali");
+    settings.add_game_type_ids(2);
+    settings.add_game_type_ids(3);
+    ASSERT_TRUE(GameFilter(settings, true).accepts(openGame(), now));
+
+    settings.set_creator_name_filter("bob");
+    ASSERT_FALSE(GameFilter(settings, true).accepts(openGame(), now));
+
+    settings.clear_creator_name_filter();
+    settings.clear_game_type_ids();
+    settings.add_game_type_ids(5);
+    ASSERT_FALSE(GameFilter(settings, true).accepts(openGame(), now));
+}
+
+TEST(GameFilterTest, PlayersAndAge)
+{
+    ServerInfo_GameFilter settings;
+    settings.set_hide_full_games(true);
+    settings.set_max_players_min(2);
+    settings.set_max_players_max(4);
+    settings.set_max_game_age(120);
+    ASSERT_TRUE(GameFilter(settings, true).accepts(openGame(), now));
+
+    ServerInfo_Game full = openGame();
+    full.set_player_count(4);
+    ASSERT_FALSE(GameFilter(settings, true).accepts(full, now));
+
+    ServerInfo_Game old = openGame();
+    old.set_start_time(now - 600);
+    ASSERT_FALSE(GameFilter(settings, true).accepts(old, now));
+
+    settings.set_max_players_max(3);
+    ASSERT_FALSE(GameFilter(settings, true).accepts(openGame(), now));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
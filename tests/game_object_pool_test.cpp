@@ -0,0 +1,80 @@
+#include "../common/game_object_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+struct Token : public PooledGameObject
+{
+    explicit Token(int _id) : id(_id)
+    {
+    }
+    virtual ~Token() = default;
+    int id;
+    double padding[3] = {};
+};
+
+struct Marker : public PooledGameObject
+{
+    char kind = 'x';
+};
+
+TEST(GameObjectPoolTest, ReusesTheBlocksOfDeletedObjects)
+{
+    auto *pool = new GameObjectPool;
+    auto *first = new (pool) Token(1);
+    delete first;
+    auto *second = new (pool) Token(2);
+    ASSERT_EQ(static_cast<void *>(first), static_cast<void *>(second));
+    ASSERT_EQ(second->id, 2);
+
+    auto *marker = new (pool) Marker;
+    ASSERT_EQ(pool->getLiveObjectCount(), 2);
+    delete marker;
+    delete second;
+    ASSERT_EQ(pool->getLiveObjectCount(), 0);
+    pool->release();
+}
+
+TEST(GameObjectPoolTest, KeepsObjectsAlignedAndApart)
+{
+    auto *pool = new GameObjectPool;
+    QList<Token *> tokens;
+    for (int i = 0; i < 200; ++i) {
+        tokens.append(new (pool) Token(i));
+        ASSERT_EQ(reinterpret_cast<quintptr>(tokens.last()) % alignof(std::max_align_t), 0u);
+    }
+    for (int i = 0; i < tokens.size(); ++i)
+        ASSERT_EQ(tokens.at(i)->id, i);
+    for (Token *token : tokens)
+        delete token;
+    pool->release();
+}
+
+TEST(GameObjectPoolTest, OutlivesItsReleaseUntilTheLastObjectIsGone)
+{
+    auto *pool = new GameObjectPool;
+    auto *token = new (pool) Token(1);
+    pool->release();
+    ASSERT_EQ(token->id, 1);
+    // frees the pool as well, the sanitizers would notice otherwise
+    delete token;
+}
+
+TEST(GameObjectPoolTest, ObjectsCanBeCreatedWithoutAPool)
+{
+    auto *token = new Token(1);
+    auto *other = new (static_cast<GameObjectPool *>(nullptr)) Token(2);
+    ASSERT_EQ(token->id + other->id, 3);
+    delete token;
+    delete other;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,81 @@
+#include "../servatrice/src/handoff_channel.h"
+
+#include "gtest/gtest.h"
+
+#if defined(Q_OS_LINUX)
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+#if defined(Q_OS_LINUX)
+class HandoffChannelTest : public ::testing::Test
+{
+protected:
+    int channels[2] = {-1, -1};
+
+    void SetUp() override
+    {
+        ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, channels), 0);
+    }
+    void TearDown() override
+    {
+        ::close(channels[0]);
+        ::close(channels[1]);
+    }
+};
+
+TEST_F(HandoffChannelTest, MessagesArriveOneByOne)
+{
+    ASSERT_TRUE(HandoffChannel::send(channels[0], "first"));
+    ASSERT_TRUE(HandoffChannel::send(channels[0], QByteArray()));
+    ASSERT_TRUE(HandoffChannel::send(channels[0], QByteArray(100000, 'x')));
+
+    QByteArray message;
+    QList<int> descriptors;
+    ASSERT_TRUE(HandoffChannel::receive(channels[1], message, descriptors, 1000));
+    ASSERT_EQ(message, QByteArray("first"));
+    ASSERT_TRUE(HandoffChannel::receive(channels[1], message, descriptors, 1000));
+    ASSERT_TRUE(message.isEmpty());
+    ASSERT_TRUE(HandoffChannel::receive(channels[1], message, descriptors, 1000));
+    ASSERT_EQ(message, QByteArray(100000, 'x'));
+    ASSERT_TRUE(descriptors.isEmpty());
+}
+
+TEST_F(HandoffChannelTest, DescriptorsComeWithTheirMessage)
+{
+    int pipe[2];
+    ASSERT_EQ(::pipe(pipe), 0);
+    ASSERT_TRUE(HandoffChannel::send(channels[0], "listeners", {pipe[1]}));
+    ::close(pipe[1]);
+
+    QByteArray message;
+    QList<int> descriptors;
+    ASSERT_TRUE(HandoffChannel::receive(channels[1], message, descriptors, 1000));
+    ASSERT_EQ(message, QByteArray("listeners"));
+    ASSERT_EQ(descriptors.size(), 1);
+
+    // the descriptor received is the write end of the same pipe
+    ASSERT_EQ(::write(descriptors.first(), "!", 1), 1);
+    char byte = 0;
+    ASSERT_EQ(::read(pipe[0], &byte, 1), 1);
+    ASSERT_EQ(byte, '!');
+    ::close(descriptors.first());
+    ::close(pipe[0]);
+}
+
+TEST_F(HandoffChannelTest, ReceiveGivesUpAfterTheTimeout)
+{
+    QByteArray message;
+    QList<int> descriptors;
+    ASSERT_FALSE(HandoffChannel::receive(channels[1], message, descriptors, 10));
+
+    ::close(channels[0]);
+    channels[0] = -1;
+    ASSERT_FALSE(HandoffChannel::receive(channels[1], message, descriptors, 1000));
+}
+#endif
+
+} // namespace
@@ -0,0 +1,44 @@
+#include "../servatrice/src/id_block_allocator.h"
+
+#include "gtest/gtest.h"
+#include <QList>
+
+namespace
+{
+
+TEST(IdBlockAllocatorTest, ReservesOneBlockPerBlockSizeIds)
+{
+    IdBlockAllocator allocator(3);
+    QList<int> requestedSizes;
+    qint64 sequence = 100;
+    const IdBlockAllocator::ReserveBlock reserve = [&](int blockSize) {
+        requestedSizes.append(blockSize);
+        const qint64 firstId = sequence;
+        sequence += blockSize;
+        return firstId;
+    };
+
+    for (qint64 expected = 100; expected < 107; ++expected)
+        ASSERT_EQ(allocator.next(reserve), expected);
+    ASSERT_EQ(requestedSizes, QList<int>({3, 3, 3}));
+}
+
+TEST(IdBlockAllocatorTest, FailedReservationIsRetried)
+{
+    IdBlockAllocator allocator(2);
+    bool databaseUp = false;
+    const IdBlockAllocator::ReserveBlock reserve = [&](int) { return databaseUp ? qint64(10) : qint64(-1); };
+
+    ASSERT_EQ(allocator.next(reserve), -1);
+    databaseUp = true;
+    ASSERT_EQ(allocator.next(reserve), 10);
+    ASSERT_EQ(allocator.next(reserve), 11);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
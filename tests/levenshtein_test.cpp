@@ -0,0 +1,51 @@
+#include "../cockatrice/src/utility/levenshtein.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+TEST(Levenshtein, MatrixDistance)
+{
+    ASSERT_EQ(0, levenshteinDistance("", ""));
+    ASSERT_EQ(3, levenshteinDistance("kitten", "sitting"));
+    ASSERT_EQ(5, levenshteinDistance("", "bolts"));
+}
+
+TEST(Levenshtein, MatcherAgreesWithMatrix)
+{
+    const QStringList words = {"", "a", "bolt", "Lightning Bolt", "lightning helix", "Goblin Guide", "tolb"};
+    for (const QString &pattern : words) {
+        const LevenshteinMatcher matcher(pattern);
+        for (const QString &text : words) {
+            ASSERT_EQ(levenshteinDistance(pattern.toLower(), text.toLower()), matcher.distance(text))
+                << pattern.toStdString() << " / " << text.toStdString();
+        }
+    }
+}
+
+TEST(Levenshtein, MatcherIgnoresCase)
+{
+    ASSERT_EQ(0, LevenshteinMatcher("LIGHTNING bolt").distance("Lightning Bolt"));
+}
+
+TEST(Levenshtein, MatcherStopsAboveMaximum)
+{
+    const LevenshteinMatcher matcher("bolt");
+    ASSERT_GT(matcher.distance("Goblin Bombardment", 2), 2);
+    ASSERT_EQ(1, matcher.distance("bolts", 2));
+}
+
+TEST(Levenshtein, MatcherHandlesLongPatterns)
+{
+    const QString pattern(80, 'a');
+    ASSERT_EQ(1, LevenshteinMatcher(pattern).distance(QString(79, 'a')));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,167 @@
+#include "../common/message_batching.h"
+#include "../common/message_compression.h"
+#include "../common/pb/event_move_card.pb.h"
+#include "../common/pb/event_room_say.pb.h"
+#include "../common/pb/game_event_container.pb.h"
+#include "../common/pb/room_event.pb.h"
+#include "../common/pb/server_message.pb.h"
+#include "../common/serialized_message.h"
+
+#include "gtest/gtest.h"
+#include <QElapsedTimer>
+#include <iostream>
+
+namespace
+{
+
+const int compressionThreshold = 1024;
+const int maxBatchSize = 64 * 1024;
+const int flushCount = 2000;
+const int messagesPerFlush = 20;
+
+QByteArray moveCardMessage(int i)
+{
+    ServerMessage message;
+    message.set_message_type(ServerMessage::GAME_EVENT_CONTAINER);
+    GameEventContainer *cont = message.mutable_game_event_container();
+    cont->set_game_id(i % 7);
+    GameEvent *gameEvent = cont->add_event_list();
+    gameEvent->set_player_id(i % 4);
+    Event_MoveCard *event = gameEvent->MutableExtension(Event_MoveCard::ext);
+    event->set_card_id(i);
+    event->set_card_name("Llanowar Elves");
+    event->set_start_zone("hand");
+    event->set_target_zone("table");
+    event->set_x(i % 12);
+    return SerializedMessage::serialize(message);
+}
+
+QByteArray roomSayMessage(int i)
+{
+    ServerMessage message;
+    message.set_message_type(ServerMessage::ROOM_EVENT);
+    message.mutable_room_event()->set_room_id(1);
+    Event_RoomSay *event = message.mutable_room_event()->MutableExtension(Event_RoomSay::ext);
+    event->set_name("user" + std::to_string(i % 50));
+    event->set_message(std::string(20 + i % 100, 'x'));
+    return SerializedMessage::serialize(message);
+}
+
+// what a busy client gets within one flush: mostly game events, some room chat, now and then a game state dump
+QList<QByteArray> syntheticFlush(int flush)
+{
+    QList<QByteArray> result;
+    for (int i = 0; i < messagesPerFlush; ++i) {
+        const int n = flush * messagesPerFlush + i;
+        if (n % 97 == 0)
+            result.append(QByteArray(8000, 'd'));
+        else if (n % 5 == 0)
+            result.append(roomSayMessage(n));
+        else
+            result.append(moveCardMessage(n));
+    }
+    return result;
+}
+
+// the header of an unmasked websocket frame from the server
+int websocketFrameHeader(int payloadSize)
+{
+    return payloadSize < 126 ? 2 : (payloadSize < 65536 ? 4 : 10);
+}
+
+TEST(MessageBatchingTest, SingleMessagesAreNotBatched)
+{
+    const QByteArray message = roomSayMessage(1);
+    ASSERT_EQ(MessageBatching::pack({message}, maxBatchSize, 0), QList<QByteArray>({message}));
+    ASSERT_EQ(MessageBatching::pack({message, message}, 0, 0), QList<QByteArray>({message, message}));
+}
+
+TEST(MessageBatchingTest, BatchesRoundTrip)
+{
+    QList<QByteArray> messages;
+    for (int flush = 0; flush < 10; ++flush)
+        messages.append(syntheticFlush(flush));
+
+    for (int threshold : {0, compressionThreshold}) {
+        const QList<QByteArray> websocketMessages = MessageBatching::pack(messages, 4096, threshold);
+        ASSERT_LT(websocketMessages.size(), messages.size());
+
+        QList<QByteArray> unpacked;
+        for (const QByteArray &websocketMessage : websocketMessages) {
+            // only the game state dumps are larger than a batch
+            if (threshold == 0)
+                ASSERT_LE(websocketMessage.size(), 8000);
+            ASSERT_TRUE(MessageBatching::unpack(websocketMessage, unpacked));
+        }
+        ASSERT_EQ(unpacked, messages);
+    }
+}
+
+TEST(MessageBatchingTest, MalformedBatchesAreRejected)
+{
+    const QByteArray batch = MessageBatching::pack({roomSayMessage(1), roomSayMessage(2)}, maxBatchSize, 0)[0];
+    ASSERT_EQ(batch[0], MessageBatching::batchMarker);
+
+    QList<QByteArray> unpacked;
+    ASSERT_FALSE(MessageBatching::unpack(batch.left(batch.size() - 1), unpacked));
+    ASSERT_FALSE(MessageBatching::unpack(batch.left(3), unpacked));
+    ASSERT_FALSE(MessageBatching::unpack(QByteArray(1, MessageCompression::compressedMessageMarker) + "garbage",
+                                         unpacked));
+}
+
+// Compares what the tcp framing, websocket messages per server message and batched websocket messages cost for the
+// same synthetic load.
+TEST(MessageBatchingTest, SyntheticLoad)
+{
+    QList<QList<QByteArray>> flushes;
+    for (int flush = 0; flush < flushCount; ++flush)
+        flushes.append(syntheticFlush(flush));
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 tcpBytes = 0;
+    for (const QList<QByteArray> &items : flushes) {
+        for (const QByteArray &item : items) {
+            QByteArray compressed;
+            if (item.size() >= compressionThreshold && MessageCompression::compress(item, compressed))
+                tcpBytes += 4 + compressed.size();
+            else
+                tcpBytes += 4 + item.size();
+        }
+    }
+    const qint64 tcpMsecs = timer.restart();
+
+    qint64 unbatchedBytes = 0, unbatchedMessages = 0;
+    for (const QList<QByteArray> &items : flushes) {
+        for (const QByteArray &websocketMessage : MessageBatching::pack(items, 0, compressionThreshold)) {
+            unbatchedBytes += websocketFrameHeader(websocketMessage.size()) + websocketMessage.size();
+            ++unbatchedMessages;
+        }
+    }
+    const qint64 unbatchedMsecs = timer.restart();
+
+    qint64 batchedBytes = 0, batchedMessages = 0;
+    for (const QList<QByteArray> &items : flushes) {
+        for (const QByteArray &websocketMessage : MessageBatching::pack(items, maxBatchSize, compressionThreshold)) {
+            batchedBytes += websocketFrameHeader(websocketMessage.size()) + websocketMessage.size();
+            ++batchedMessages;
+        }
+    }
+    const qint64 batchedMsecs = timer.elapsed();
+
+    ASSERT_EQ(unbatchedMessages, flushCount * messagesPerFlush);
+    ASSERT_EQ(batchedMessages, flushCount);
+    ASSERT_LT(batchedBytes, unbatchedBytes);
+    std::cout << flushCount << " flushes of " << messagesPerFlush << " messages: tcp " << tcpBytes << " bytes in "
+              << tcpMsecs << " ms, websocket " << unbatchedBytes << " bytes in " << unbatchedMessages
+              << " messages in " << unbatchedMsecs << " ms, batched websocket " << batchedBytes << " bytes in "
+              << batchedMessages << " messages in " << batchedMsecs << " ms" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,93 @@
+#include "../common/message_framing.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+QList<QByteArray> someMessages()
+{
+    QList<QByteArray> messages;
+    for (int i = 0; i < 50; ++i)
+        messages.append(QByteArray(1 + (i * 37) % 300, static_cast<char>('a' + i % 26)));
+    // larger than a frame, and larger than what fits into a varint of two bytes
+    messages.append(QByteArray(20000, 'z'));
+    return messages;
+}
+
+QList<QByteArray> unpackAll(const QByteArray &stream, int &frames)
+{
+    QList<QByteArray> messages;
+    frames = 0;
+    int pos = 0;
+    while (pos < stream.size()) {
+        const int frameSize = MessageFraming::unpack(stream.constData() + pos, stream.size() - pos, messages);
+        EXPECT_GT(frameSize, 0);
+        if (frameSize <= 0)
+            break;
+        pos += frameSize;
+        ++frames;
+    }
+    return messages;
+}
+
+TEST(MessageFramingTest, FramesRoundTrip)
+{
+    const QList<QByteArray> messages = someMessages();
+    for (int threshold : {0, 1024}) {
+        for (int maxFrameSize : {0, 4096}) {
+            QByteArray stream;
+            MessageFraming::pack(messages, maxFrameSize, threshold, stream);
+            ASSERT_EQ(stream[0], MessageFraming::frameMarker);
+
+            int frames = 0;
+            ASSERT_EQ(unpackAll(stream, frames), messages);
+            if (maxFrameSize == 0)
+                ASSERT_EQ(frames, messages.size());
+            else
+                ASSERT_LT(frames, messages.size() / 4);
+        }
+    }
+}
+
+TEST(MessageFramingTest, IncompleteFramesWait)
+{
+    QByteArray stream;
+    MessageFraming::pack({QByteArray(1000, 'x'), QByteArray(10, 'y')}, 4096, 0, stream);
+
+    QList<QByteArray> messages;
+    for (int size = 0; size < stream.size(); ++size)
+        ASSERT_EQ(MessageFraming::unpack(stream.constData(), size, messages), 0);
+    ASSERT_TRUE(messages.isEmpty());
+    ASSERT_EQ(MessageFraming::unpack(stream.constData(), stream.size(), messages), stream.size());
+    ASSERT_EQ(messages.size(), 2);
+}
+
+TEST(MessageFramingTest, MalformedFramesAreRejected)
+{
+    QList<QByteArray> messages;
+    // the length prefix of the original framing
+    const QByteArray legacy("\x00\x00\x00\x05hello", 9);
+    ASSERT_EQ(MessageFraming::unpack(legacy.constData(), legacy.size(), messages), -1);
+
+    // a message that doesn't fit into its frame
+    const QByteArray overlong("\xfd\x00\x03\x07xy", 6);
+    ASSERT_EQ(MessageFraming::unpack(overlong.constData(), overlong.size(), messages), -1);
+
+    // compressed, but not in qCompress format
+    const QByteArray garbage("\xfd\x01\x04junk", 7);
+    ASSERT_EQ(MessageFraming::unpack(garbage.constData(), garbage.size(), messages), -1);
+
+    // a varint that doesn't end
+    const QByteArray endless("\xfd\x00\xff\xff\xff\xff\xff\xff", 8);
+    ASSERT_EQ(MessageFraming::unpack(endless.constData(), endless.size(), messages), -1);
+    ASSERT_TRUE(messages.isEmpty());
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,70 @@
+#include "../servatrice/src/metrics.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+QString rendered(const Metrics &metrics)
+{
+    return QString::fromUtf8(metrics.render());
+}
+
+TEST(MetricsTest, SeriesAreCreatedOnce)
+{
+    Metrics metrics;
+    MetricsCounter *counter = metrics.counter("test_total", "help", Metrics::label("kind", "a"));
+    ASSERT_EQ(metrics.counter("test_total", "other help", Metrics::label("kind", "a")), counter);
+    ASSERT_NE(metrics.counter("test_total", "help", Metrics::label("kind", "b")), counter);
+}
+
+TEST(MetricsTest, CountersAreRendered)
+{
+    Metrics metrics;
+    metrics.counter("test_bytes_total", "Bytes.")->add(5);
+    metrics.counter("test_bytes_total", "Bytes.")->add(2);
+    metrics.counter("test_commands_total", "Commands.", Metrics::label("type", "game"))->add();
+
+    const QString text = rendered(metrics);
+    ASSERT_TRUE(text.contains("# HELP test_bytes_total Bytes.\n# TYPE test_bytes_total counter\n"));
+    ASSERT_TRUE(text.contains("\ntest_bytes_total 7\n"));
+    ASSERT_TRUE(text.contains("\ntest_commands_total{type=\"game\"} 1\n"));
+}
+
+TEST(MetricsTest, HistogramBucketsAreCumulative)
+{
+    Metrics metrics;
+    MetricsHistogram *histogram = metrics.histogram("test_seconds", "Latency.", Metrics::label("pool", "pool_0"));
+    histogram->observe(50);
+    histogram->observe(100);
+    histogram->observe(200);
+    histogram->observe(20000000);
+
+    const QString text = rendered(metrics);
+    ASSERT_TRUE(text.contains("\ntest_seconds_bucket{pool=\"pool_0\",le=\"0.0001\"} 2\n"));
+    ASSERT_TRUE(text.contains("\ntest_seconds_bucket{pool=\"pool_0\",le=\"0.00025\"} 3\n"));
+    ASSERT_TRUE(text.contains("\ntest_seconds_bucket{pool=\"pool_0\",le=\"10\"} 3\n"));
+    ASSERT_TRUE(text.contains("\ntest_seconds_bucket{pool=\"pool_0\",le=\"+Inf\"} 4\n"));
+    ASSERT_TRUE(text.contains("\ntest_seconds_sum{pool=\"pool_0\"} 20.000350\n"));
+    ASSERT_TRUE(text.contains("\ntest_seconds_count{pool=\"pool_0\"} 4\n"));
+}
+
+TEST(MetricsTest, GaugesAreEvaluatedWhenRendering)
+{
+    Metrics metrics;
+    int games = 1;
+    metrics.addGauge("test_games", "Games.", [&games]() {
+        return Metrics::GaugeValues{{Metrics::label("room", "General \"room\""), games}};
+    });
+    games = 3;
+
+    ASSERT_TRUE(rendered(metrics).contains("# TYPE test_games gauge\ntest_games{room=\"General \\\"room\\\"\"} 3\n"));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,80 @@
+#include "../common/mpsc_queue.h"
+
+#include "gtest/gtest.h"
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+TEST(MpscQueueTest, PopsInPushOrder)
+{
+    MpscQueue<int> queue;
+    ASSERT_TRUE(queue.isEmpty());
+    for (int i = 0; i < 5; ++i)
+        queue.push(i);
+    ASSERT_FALSE(queue.isEmpty());
+
+    int value = -1;
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(queue.pop(value));
+        ASSERT_EQ(value, i);
+    }
+    ASSERT_FALSE(queue.pop(value));
+    ASSERT_TRUE(queue.isEmpty());
+}
+
+TEST(MpscQueueTest, ReleasesTheItemsLeftBehind)
+{
+    auto item = std::make_shared<int>(1);
+    {
+        MpscQueue<std::shared_ptr<int>> queue;
+        queue.push(item);
+        queue.push(item);
+        std::shared_ptr<int> popped;
+        ASSERT_TRUE(queue.pop(popped));
+        popped.reset();
+        ASSERT_EQ(item.use_count(), 2);
+    }
+    ASSERT_EQ(item.use_count(), 1);
+}
+
+TEST(MpscQueueTest, KeepsTheOrderOfEveryProducer)
+{
+    const int producerCount = 4;
+    const int itemsPerProducer = 20000;
+    MpscQueue<int> queue;
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < producerCount; ++producer)
+        producers.emplace_back([&queue, producer] {
+            for (int i = 0; i < itemsPerProducer; ++i)
+                queue.push(producer * itemsPerProducer + i);
+        });
+
+    std::vector<int> next(producerCount, 0);
+    bool inOrder = true;
+    int popped = 0;
+    int value;
+    while (popped < producerCount * itemsPerProducer) {
+        if (!queue.pop(value))
+            continue;
+        const int producer = value / itemsPerProducer;
+        inOrder = inOrder && value % itemsPerProducer == next[producer];
+        ++next[producer];
+        ++popped;
+    }
+    for (std::thread &thread : producers)
+        thread.join();
+    ASSERT_TRUE(inOrder);
+    ASSERT_TRUE(queue.isEmpty());
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,60 @@
+#include "../../oracle/src/jsonstreamreader.h"
+
+#include "gtest/gtest.h"
+
+TEST(JsonStreamReaderTest, readsValues)
+{
+    const QByteArray data = R"({"name": "Fire \/ Iceæ", "number": 12, "negative": -3, "power": 1.5,
+        "colors": ["U", "R"], "isToken": false, "side": null})";
+    JsonStreamReader reader(data);
+    const QVariantMap card = reader.readValue().toMap();
+
+    ASSERT_FALSE(reader.hasError());
+    ASSERT_EQ(card.value("name").toString(), QString::fromUtf8("Fire / Iceæ"));
+    ASSERT_EQ(card.value("number").toInt(), 12);
+    ASSERT_EQ(card.value("negative").toInt(), -3);
+    ASSERT_EQ(card.value("power").toDouble(), 1.5);
+    ASSERT_EQ(card.value("colors").toStringList(), QStringList({"U", "R"}));
+    ASSERT_FALSE(card.value("isToken").toBool());
+    ASSERT_TRUE(card.contains("side"));
+}
+
+TEST(JsonStreamReaderTest, walksMembersAndSkipsValues)
+{
+    const QByteArray data = R"({"meta": {"version": "5.2", "nested": [{"a": "]}"}]}, "data": {"ABC": {"cards": []}}})";
+    JsonStreamReader reader(data);
+    QString key;
+    QStringList keys;
+
+    ASSERT_TRUE(reader.beginObject());
+    while (reader.nextMember(key)) {
+        keys.append(key);
+        const int begin = reader.position();
+        ASSERT_TRUE(reader.skipValue());
+        if (key == "data") {
+            ASSERT_EQ(data.mid(begin, reader.position() - begin), QByteArray(R"({"ABC": {"cards": []}})"));
+        }
+    }
+
+    ASSERT_FALSE(reader.hasError());
+    ASSERT_EQ(keys, QStringList({"meta", "data"}));
+}
+
+TEST(JsonStreamReaderTest, failsOnTruncatedData)
+{
+    const QByteArray data = R"({"data": {"ABC": {"cards": [)";
+    JsonStreamReader reader(data);
+    QString key;
+
+    ASSERT_TRUE(reader.beginObject());
+    ASSERT_TRUE(reader.nextMember(key));
+    ASSERT_FALSE(reader.skipValue());
+    ASSERT_TRUE(reader.hasError());
+    ASSERT_FALSE(reader.nextMember(key));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
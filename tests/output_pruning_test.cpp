@@ -0,0 +1,110 @@
+#include "../servatrice/src/output_pruning.h"
+#include "../common/pb/context_ping_changed.pb.h"
+#include "../common/pb/event_list_games.pb.h"
+#include "../common/pb/event_player_properties_changed.pb.h"
+#include "../common/pb/event_room_say.pb.h"
+#include "../common/pb/game_event_container.pb.h"
+#include "../common/pb/room_event.pb.h"
+#include "../common/pb/server_message.pb.h"
+#include "../common/serialized_message.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+QByteArray roomSay(const std::string &name, Event_RoomSay::RoomMessageType type = Event_RoomSay::UserMessage)
+{
+    ServerMessage message;
+    message.set_message_type(ServerMessage::ROOM_EVENT);
+    message.mutable_room_event()->set_room_id(1);
+    Event_RoomSay *event = message.mutable_room_event()->MutableExtension(Event_RoomSay::ext);
+    event->set_name(name);
+    event->set_message("hello");
+    event->set_message_type(type);
+    return SerializedMessage::serialize(message);
+}
+
+QByteArray gameListUpdate(int roomId, int gameId, int playerCount)
+{
+    ServerMessage message;
+    message.set_message_type(ServerMessage::ROOM_EVENT);
+    message.mutable_room_event()->set_room_id(roomId);
+    ServerInfo_Game *game = message.mutable_room_event()->MutableExtension(Event_ListGames::ext)->add_game_list();
+    game->set_game_id(gameId);
+    game->set_player_count(playerCount);
+    return SerializedMessage::serialize(message);
+}
+
+QByteArray pingUpdate(int gameId, int playerId, int ping)
+{
+    ServerMessage message;
+    message.set_message_type(ServerMessage::GAME_EVENT_CONTAINER);
+    GameEventContainer *cont = message.mutable_game_event_container();
+    cont->set_game_id(gameId);
+    cont->mutable_context()->MutableExtension(Context_PingChanged::ext);
+    GameEvent *event = cont->add_event_list();
+    event->set_player_id(playerId);
+    event->MutableExtension(Event_PlayerPropertiesChanged::ext)->mutable_player_properties()->set_ping_seconds(ping);
+    return SerializedMessage::serialize(message);
+}
+
+ServerMessage parsed(const QByteArray &data)
+{
+    ServerMessage message;
+    message.ParseFromArray(data.constData(), data.size());
+    return message;
+}
+
+TEST(OutputPruningTest, ChatOfOthersIsDropped)
+{
+    const QByteArray history = roomSay("alice", Event_RoomSay::ChatHistory);
+    const QList<QByteArray> result =
+        OutputPruning::prune({roomSay("alice"), roomSay("bob"), history, roomSay("carol")}, "bob");
+    ASSERT_EQ(result, QList<QByteArray>({roomSay("bob"), history}));
+}
+
+TEST(OutputPruningTest, GameListUpdatesAreCollapsedPerRoom)
+{
+    const QByteArray say = roomSay("bob");
+    const QList<QByteArray> result = OutputPruning::prune(
+        {gameListUpdate(1, 10, 1), gameListUpdate(2, 30, 1), say, gameListUpdate(1, 20, 1), gameListUpdate(1, 10, 2)},
+        "bob");
+    ASSERT_EQ(result.size(), 3);
+    ASSERT_EQ(result[0], gameListUpdate(2, 30, 1));
+    ASSERT_EQ(result[1], say);
+
+    const ServerMessage merged = parsed(result[2]);
+    const Event_ListGames &games = merged.room_event().GetExtension(Event_ListGames::ext);
+    ASSERT_EQ(merged.room_event().room_id(), 1);
+    ASSERT_EQ(games.game_list_size(), 2);
+    ASSERT_EQ(games.game_list(0).game_id(), 10);
+    ASSERT_EQ(games.game_list(0).player_count(), 2u);
+    ASSERT_EQ(games.game_list(1).game_id(), 20);
+}
+
+TEST(OutputPruningTest, PingUpdatesAreCollapsedPerGame)
+{
+    const QList<QByteArray> result =
+        OutputPruning::prune({pingUpdate(5, 0, 1), pingUpdate(5, 1, 3), pingUpdate(6, 0, 1), pingUpdate(5, 0, 4)}, "");
+    ASSERT_EQ(result.size(), 2);
+    ASSERT_EQ(result[0], pingUpdate(6, 0, 1));
+
+    const ServerMessage merged = parsed(result[1]);
+    const GameEventContainer &cont = merged.game_event_container();
+    ASSERT_EQ(cont.game_id(), 5u);
+    ASSERT_TRUE(cont.context().HasExtension(Context_PingChanged::ext));
+    ASSERT_EQ(cont.event_list_size(), 2);
+    ASSERT_EQ(cont.event_list(0).player_id(), 0);
+    ASSERT_EQ(cont.event_list(0).GetExtension(Event_PlayerPropertiesChanged::ext).player_properties().ping_seconds(),
+              4);
+    ASSERT_EQ(cont.event_list(1).player_id(), 1);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,66 @@
+#include "../common/rate_window.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+TEST(RateWindowTest, OldBucketsDropOut)
+{
+    RateWindow window;
+    window.setLength(3);
+    ASSERT_EQ(window.add(5), 5);
+    window.advance(1);
+    ASSERT_EQ(window.add(2), 7);
+    window.advance(1);
+    ASSERT_EQ(window.add(1), 8);
+
+    // the first bucket leaves the window of three
+    window.advance(1);
+    ASSERT_EQ(window.total(), 3);
+    window.advance(2);
+    ASSERT_EQ(window.total(), 0);
+}
+
+TEST(RateWindowTest, LongPausesClearTheWindow)
+{
+    RateWindow window;
+    window.setLength(4);
+    for (int i = 0; i < 4; ++i) {
+        window.add(10);
+        window.advance(1);
+    }
+    ASSERT_EQ(window.total(), 30);
+    window.advance(1000);
+    ASSERT_EQ(window.total(), 0);
+    ASSERT_EQ(window.add(1), 1);
+}
+
+TEST(RateWindowTest, ZeroLengthKeepsTheNewestBucket)
+{
+    RateWindow window;
+    window.setLength(0);
+    window.add(3);
+    ASSERT_EQ(window.add(4), 7);
+    window.advance(1);
+    ASSERT_EQ(window.total(), 0);
+}
+
+TEST(RateWindowTest, ChangingTheLengthStartsOver)
+{
+    RateWindow window;
+    window.setLength(2);
+    window.add(6);
+    window.setLength(2);
+    ASSERT_EQ(window.total(), 6);
+    window.setLength(5);
+    ASSERT_EQ(window.total(), 0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
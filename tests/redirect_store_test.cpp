@@ -0,0 +1,64 @@
+#include "../cockatrice/src/client/ui/picture_loader/picture_loader_redirect_store.h"
+
+#include "gtest/gtest.h"
+#include <QTemporaryDir>
+
+namespace
+{
+
+TEST(RedirectStoreTest, RedirectsSurviveReopening)
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("redirects.dat");
+    const QUrl original("https://api.scryfall.com/cards/multiverse/1?format=image");
+    const QUrl redirect("https://cards.scryfall.io/large/front/1.jpg");
+    {
+        PictureLoaderRedirectStore store(fileName, 30);
+        ASSERT_TRUE(store.find(original).isEmpty());
+        store.insert(original, QUrl("https://cards.scryfall.io/large/front/old.jpg"));
+        store.insert(original, redirect);
+        ASSERT_EQ(store.find(original), redirect);
+    }
+
+    PictureLoaderRedirectStore store(fileName, 30);
+    ASSERT_EQ(store.size(), 1);
+    ASSERT_EQ(store.find(original), redirect);
+
+    store.clear();
+    ASSERT_TRUE(store.find(original).isEmpty());
+}
+
+TEST(RedirectStoreTest, ExpiredRedirectsAreIgnored)
+{
+    QTemporaryDir dir;
+    PictureLoaderRedirectStore store(dir.filePath("redirects.dat"), 30);
+    const QUrl original("https://gatherer.wizards.com/Handlers/Image.ashx?multiverseid=1&type=card");
+    store.insert(original, QUrl("https://gatherer.wizards.com/1.jpg"), QDateTime::currentDateTimeUtc().addDays(-31));
+    ASSERT_TRUE(store.find(original).isEmpty());
+}
+
+TEST(RedirectStoreTest, ReplacedRecordsAreCompacted)
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("redirects.dat");
+    const QUrl original("https://api.scryfall.com/cards/multiverse/1?format=image");
+    {
+        PictureLoaderRedirectStore store(fileName, 30);
+        for (int i = 0; i < 2000; ++i) {
+            store.insert(original, QUrl("https://cards.scryfall.io/large/front/" + QString::number(i) + ".jpg"));
+        }
+        ASSERT_LT(store.fileSize(), 64 * 1024);
+    }
+
+    PictureLoaderRedirectStore store(fileName, 30);
+    ASSERT_EQ(store.size(), 1);
+    ASSERT_EQ(store.find(original), QUrl("https://cards.scryfall.io/large/front/1999.jpg"));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,57 @@
+#include "../common/replay_compression.h"
+#include "pb/game_replay.pb.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+QByteArray serializedReplay()
+{
+    GameReplay replay;
+    replay.set_replay_id(42);
+    replay.mutable_game_info()->set_game_id(7);
+    replay.mutable_game_info()->set_description("replay");
+    for (int i = 0; i < 100; ++i)
+        replay.add_event_list()->set_seconds_elapsed(static_cast<uint32_t>(i));
+    return QByteArray::fromStdString(replay.SerializeAsString());
+}
+
+TEST(ReplayCompressionTest, RoundTrip)
+{
+    const QByteArray plain = serializedReplay();
+    const QByteArray compressed = ReplayCompression::compress(plain);
+    ASSERT_TRUE(ReplayCompression::isCompressed(compressed));
+    ASSERT_LT(compressed.size(), plain.size());
+
+    QByteArray result;
+    ASSERT_TRUE(ReplayCompression::uncompress(compressed, result));
+    ASSERT_EQ(result, plain);
+}
+
+TEST(ReplayCompressionTest, PlainReplaysAreTakenAsTheyAre)
+{
+    const QByteArray plain = serializedReplay();
+    ASSERT_FALSE(ReplayCompression::isCompressed(plain));
+
+    QByteArray result;
+    ASSERT_TRUE(ReplayCompression::uncompress(plain, result));
+    ASSERT_EQ(result, plain);
+}
+
+TEST(ReplayCompressionTest, LaterVersionsAreRejected)
+{
+    QByteArray compressed = ReplayCompression::compress(serializedReplay());
+    compressed[1] = ReplayCompression::formatVersion + 1;
+
+    QByteArray result;
+    ASSERT_FALSE(ReplayCompression::uncompress(compressed, result));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
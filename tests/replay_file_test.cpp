@@ -0,0 +1,112 @@
+#include "../common/replay_file.h"
+#include "pb/event_set_active_phase.pb.h"
+#include "pb/game_event.pb.h"
+#include "pb/game_event_container.pb.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+GameReplay makeReplay(int eventCount)
+{
+    GameReplay replay;
+    replay.set_replay_id(42);
+    replay.mutable_game_info()->set_game_id(7);
+    replay.mutable_game_info()->set_description("replay");
+    replay.set_duration_seconds(static_cast<uint32_t>(eventCount / 3));
+    for (int i = 0; i < eventCount; ++i) {
+        GameEventContainer *cont = replay.add_event_list();
+        // three events every second
+        cont->set_seconds_elapsed(static_cast<uint32_t>(i / 3));
+        Event_SetActivePhase phase;
+        phase.set_phase(i);
+        cont->add_event_list()->MutableExtension(Event_SetActivePhase::ext)->CopyFrom(phase);
+    }
+    return replay;
+}
+
+int phaseOf(const GameEventContainer &cont)
+{
+    return cont.event_list(0).GetExtension(Event_SetActivePhase::ext).phase();
+}
+
+TEST(ReplayFileTest, LegacyReplaysAreRead)
+{
+    const GameReplay replay = makeReplay(10);
+    const QByteArray data = QByteArray::fromStdString(replay.SerializeAsString());
+    ASSERT_FALSE(ReplayFile::isIndexed(data));
+
+    ReplayFile *replayFile = ReplayFile::fromData(data);
+    ASSERT_NE(replayFile, nullptr);
+    ASSERT_EQ(replayFile->getEventCount(), 10);
+    ASSERT_EQ(replayFile->getHeader().game_info().game_id(), 7);
+    ASSERT_EQ(phaseOf(replayFile->getEvent(9)), 9);
+    delete replayFile;
+}
+
+TEST(ReplayFileTest, IndexedReplaysMatchTheLegacyOnes)
+{
+    const GameReplay replay = makeReplay(1000);
+    ReplayFile *legacy = ReplayFile::fromData(QByteArray::fromStdString(replay.SerializeAsString()));
+    const QByteArray data = ReplayFile::toIndexed(replay, 64);
+    ASSERT_TRUE(ReplayFile::isIndexed(data));
+
+    ReplayFile *indexed = ReplayFile::fromData(data);
+    ASSERT_NE(indexed, nullptr);
+    ASSERT_EQ(indexed->getEventCount(), legacy->getEventCount());
+    ASSERT_EQ(indexed->getHeader().replay_id(), 42u);
+    ASSERT_EQ(indexed->getHeader().game_info().description(), "replay");
+    ASSERT_EQ(indexed->getHeader().duration_seconds(), replay.duration_seconds());
+    ASSERT_EQ(indexed->getHeader().event_list_size(), 0);
+    ASSERT_EQ(indexed->getTimeline(), legacy->getTimeline());
+    ASSERT_EQ(indexed->getTimeline().at(4), 1333);
+
+    // in order, then across the chunks the way a rewind does
+    for (int i = 0; i < indexed->getEventCount(); ++i) {
+        ASSERT_EQ(phaseOf(indexed->getEvent(i)), i);
+    }
+    ASSERT_EQ(phaseOf(indexed->getEvent(3)), 3);
+    ASSERT_EQ(phaseOf(indexed->getEvent(999)), 999);
+
+    delete indexed;
+    delete legacy;
+}
+
+TEST(ReplayFileTest, EmptyReplaysCanBeIndexed)
+{
+    ReplayFile *indexed = ReplayFile::fromData(ReplayFile::toIndexed(makeReplay(0)));
+    ASSERT_NE(indexed, nullptr);
+    ASSERT_EQ(indexed->getEventCount(), 0);
+    ASSERT_TRUE(indexed->getTimeline().isEmpty());
+    delete indexed;
+}
+
+TEST(ReplayFileTest, BrokenIndexesAreRejected)
+{
+    const QByteArray data = ReplayFile::toIndexed(makeReplay(100), 16);
+    ASSERT_EQ(ReplayFile::fromData(data.left(10)), nullptr);
+    ASSERT_EQ(ReplayFile::fromData(data.left(data.size() - 1)), nullptr);
+}
+
+TEST(ReplayFileTest, BrokenChunksGiveEmptyEvents)
+{
+    QByteArray data = ReplayFile::toIndexed(makeReplay(100), 16);
+    // the end of the last chunk
+    data[data.size() - 1] = static_cast<char>(~data.at(data.size() - 1));
+    data[data.size() - 2] = static_cast<char>(~data.at(data.size() - 2));
+
+    ReplayFile *indexed = ReplayFile::fromData(data);
+    ASSERT_NE(indexed, nullptr);
+    ASSERT_EQ(phaseOf(indexed->getEvent(0)), 0);
+    ASSERT_EQ(indexed->getEvent(99).event_list_size(), 0);
+    delete indexed;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,124 @@
+#include "../common/resume_log.h"
+#include "../common/serialized_message.h"
+#include "pb/server_message.pb.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+QByteArray gameEventMessage(int gameId)
+{
+    ServerMessage message;
+    message.set_message_type(ServerMessage::GAME_EVENT_CONTAINER);
+    message.mutable_game_event_container()->set_game_id(gameId);
+    return SerializedMessage::serialize(message);
+}
+
+ServerMessage parse(const QByteArray &serializedMessage)
+{
+    ServerMessage message;
+    message.ParseFromArray(serializedMessage.constData(), serializedMessage.size());
+    return message;
+}
+
+TEST(ResumeLogTest, MessagesAreNumbered)
+{
+    ResumeLog log;
+    log.setCapacity(10);
+    ASSERT_EQ(log.getLastSequence(), 0u);
+
+    const ServerMessage first = parse(log.append(gameEventMessage(7)));
+    ASSERT_EQ(first.game_event_container().game_id(), 7u);
+    ASSERT_EQ(first.game_event_container().resume_sequence(), 1u);
+    ASSERT_EQ(parse(log.append(gameEventMessage(7))).game_event_container().resume_sequence(), 2u);
+    ASSERT_EQ(log.getLastSequence(), 2u);
+}
+
+TEST(ResumeLogTest, OnlyTheMissedMessagesAreReturned)
+{
+    ResumeLog log;
+    log.setCapacity(10);
+    for (int i = 0; i < 5; ++i)
+        log.append(gameEventMessage(7));
+
+    QList<QByteArray> missed;
+    ASSERT_TRUE(log.getMessagesAfter(3, missed));
+    ASSERT_EQ(missed.size(), 2);
+    ASSERT_EQ(parse(missed.at(0)).game_event_container().resume_sequence(), 4u);
+    ASSERT_EQ(parse(missed.at(1)).game_event_container().resume_sequence(), 5u);
+
+    missed.clear();
+    ASSERT_TRUE(log.getMessagesAfter(5, missed));
+    ASSERT_TRUE(missed.isEmpty());
+    // the client can't have got more than was sent
+    ASSERT_FALSE(log.getMessagesAfter(6, missed));
+}
+
+TEST(ResumeLogTest, DroppedMessagesCantBeResumedFrom)
+{
+    ResumeLog log;
+    log.setCapacity(3);
+    for (int i = 0; i < 6; ++i)
+        log.append(gameEventMessage(7));
+
+    QList<QByteArray> missed;
+    ASSERT_FALSE(log.getMessagesAfter(1, missed));
+    ASSERT_FALSE(log.getMessagesAfter(2, missed));
+    ASSERT_TRUE(log.getMessagesAfter(3, missed));
+    ASSERT_EQ(missed.size(), 3);
+}
+
+TEST(ResumeLogTest, DisabledLogStillNumbers)
+{
+    ResumeLog log;
+    ASSERT_FALSE(log.isEnabled());
+    log.append(gameEventMessage(7));
+    QList<QByteArray> missed;
+    ASSERT_TRUE(log.getMessagesAfter(1, missed));
+    ASSERT_FALSE(log.getMessagesAfter(0, missed));
+}
+
+TEST(ResumeLogTest, RestartedLogGoesOnWithTheNumbers)
+{
+    ResumeLog log;
+    log.setCapacity(10);
+    log.restart(41);
+    ASSERT_EQ(log.getLastSequence(), 41u);
+
+    // the client is up to date, but what it got before can't be sent again
+    QList<QByteArray> missed;
+    ASSERT_TRUE(log.getMessagesAfter(41, missed));
+    ASSERT_TRUE(missed.isEmpty());
+    ASSERT_FALSE(log.getMessagesAfter(40, missed));
+
+    ASSERT_EQ(parse(log.append(gameEventMessage(7))).game_event_container().resume_sequence(), 42u);
+    ASSERT_TRUE(log.getMessagesAfter(41, missed));
+    ASSERT_EQ(missed.size(), 1);
+}
+
+TEST(ResumeLogTest, BytesFollowTheMessagesKept)
+{
+    ResumeLog log;
+    log.setCapacity(2);
+    ASSERT_EQ(log.getBytes(), 0);
+
+    const qint64 size = log.append(gameEventMessage(7)).size();
+    ASSERT_EQ(log.getBytes(), size);
+    log.append(gameEventMessage(7));
+    log.append(gameEventMessage(7));
+    ASSERT_EQ(log.getBytes(), 2 * size);
+
+    log.setCapacity(1);
+    ASSERT_EQ(log.getBytes(), size);
+    log.restart(10);
+    ASSERT_EQ(log.getBytes(), 0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,84 @@
+#include "../common/room_chat_history.h"
+#include "../common/pb/event_room_say.pb.h"
+#include "../common/pb/room_event.pb.h"
+#include "../common/pb/server_message.pb.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+ServerInfo_ChatMessage chatMessage(const std::string &sender, const std::string &message)
+{
+    ServerInfo_ChatMessage result;
+    result.set_sender_name(sender);
+    result.set_message(message);
+    return result;
+}
+
+// the texts of the history events, oldest first
+std::vector<std::string> texts(const RoomChatHistory &history)
+{
+    std::vector<std::string> result;
+    for (const QByteArray &serializedEvent : history.getSerializedEvents()) {
+        ServerMessage message;
+        EXPECT_TRUE(message.ParseFromArray(serializedEvent.constData(), serializedEvent.size()));
+        EXPECT_EQ(message.message_type(), ServerMessage::ROOM_EVENT);
+        EXPECT_EQ(message.room_event().room_id(), 3);
+        const Event_RoomSay &event = message.room_event().GetExtension(Event_RoomSay::ext);
+        EXPECT_EQ(event.message_type(), Event_RoomSay::ChatHistory);
+        result.push_back(event.message());
+    }
+    return result;
+}
+
+TEST(RoomChatHistoryTest, KeepsTheLastMessages)
+{
+    RoomChatHistory history(3, 3);
+    history.append(chatMessage("a", "1"));
+    history.append(chatMessage("b", "2"));
+    ASSERT_EQ(texts(history), std::vector<std::string>({"a: 1", "b: 2"}));
+
+    history.append(chatMessage("a", "3"));
+    history.append(chatMessage("c", "4"));
+    history.append(chatMessage("b", "5"));
+    ASSERT_EQ(history.size(), 3);
+    ASSERT_EQ(texts(history), std::vector<std::string>({"a: 3", "c: 4", "b: 5"}));
+}
+
+TEST(RoomChatHistoryTest, RedactsTheLastMessagesOfTheSender)
+{
+    RoomChatHistory history(3, 4);
+    for (const char *text : {"1", "2", "3", "4", "5"})
+        history.append(chatMessage(std::string(text) == "3" ? "b" : "a", text));
+
+    history.redact("a", 2);
+    ASSERT_EQ(texts(history), std::vector<std::string>({"a: 2", "b: 3", "a: ", "a: "}));
+
+    // more than there are left, including messages that fell out of the history
+    history.redact("a", 10);
+    history.redact("nobody", 1);
+    ASSERT_EQ(texts(history), std::vector<std::string>({"a: ", "b: 3", "a: ", "a: "}));
+
+    history.append(chatMessage("a", "6"));
+    history.append(chatMessage("a", "7"));
+    history.redact("b", 1);
+    ASSERT_EQ(texts(history), std::vector<std::string>({"a: ", "a: ", "a: 6", "a: 7"}));
+}
+
+TEST(RoomChatHistoryTest, Disabled)
+{
+    RoomChatHistory history(3, 0);
+    ASSERT_FALSE(history.isEnabled());
+    history.append(chatMessage("a", "1"));
+    history.redact("a", 1);
+    ASSERT_TRUE(history.getSerializedEvents().isEmpty());
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,69 @@
+#include "../common/pb/response_join_room.pb.h"
+#include "../common/pb/serverinfo_room.pb.h"
+#include "../common/serialized_message.h"
+#include "../common/server_abstractuserinterface.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+TEST(SerializedMessageTest, AppendedFieldsAreParsed)
+{
+    ServerInfo_Room properties;
+    properties.set_room_id(3);
+    properties.set_name("General");
+    QByteArray room = SerializedMessage::serialize(properties);
+
+    ServerInfo_Game game;
+    game.set_game_id(7);
+    // long enough for a length of more than one byte
+    game.set_description(std::string(300, 'x'));
+    SerializedMessage::appendField(room, ServerInfo_Room::kGameListFieldNumber, SerializedMessage::serialize(game));
+    ServerInfo_User user;
+    user.set_name("player");
+    SerializedMessage::appendField(room, ServerInfo_Room::kUserListFieldNumber, SerializedMessage::serialize(user));
+
+    ServerInfo_Room parsed;
+    ASSERT_TRUE(parsed.ParseFromArray(room.constData(), room.size()));
+    ASSERT_EQ(parsed.room_id(), 3);
+    ASSERT_EQ(parsed.name(), "General");
+    ASSERT_EQ(parsed.game_list_size(), 1);
+    ASSERT_EQ(parsed.game_list(0).game_id(), 7);
+    ASSERT_EQ(parsed.game_list(0).description().size(), 300u);
+    ASSERT_EQ(parsed.user_list_size(), 1);
+    ASSERT_EQ(parsed.user_list(0).name(), "player");
+}
+
+TEST(SerializedMessageTest, ResponsesWithSerializedExtensions)
+{
+    ServerInfo_Room roomInfo;
+    roomInfo.set_room_id(5);
+    roomInfo.set_player_count(2);
+    QByteArray extension;
+    SerializedMessage::appendField(extension, Response_JoinRoom::kRoomInfoFieldNumber,
+                                   SerializedMessage::serialize(roomInfo));
+
+    Response response;
+    response.set_cmd_id(12);
+    response.set_response_code(Response::RespOk);
+    const QByteArray message =
+        Server_AbstractUserInterface::serializeResponse(response, Response_JoinRoom::kExtFieldNumber, extension);
+
+    ServerMessage parsed;
+    ASSERT_TRUE(parsed.ParseFromArray(message.constData(), message.size()));
+    ASSERT_EQ(parsed.message_type(), ServerMessage::RESPONSE);
+    ASSERT_EQ(parsed.response().cmd_id(), 12u);
+    ASSERT_EQ(parsed.response().response_code(), Response::RespOk);
+    const Response_JoinRoom &joinRoom = parsed.response().GetExtension(Response_JoinRoom::ext);
+    ASSERT_EQ(joinRoom.room_info().room_id(), 5);
+    ASSERT_EQ(joinRoom.room_info().player_count(), 2u);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,98 @@
+#include "../common/rng_abstract.h"
+#include "../common/server_card.h"
+#include "../common/server_cardzone.h"
+
+#include "gtest/gtest.h"
+
+RNG_Abstract *rng;
+
+namespace
+{
+
+// what Server_CardZone::getInfo() reported before zones cached their info
+std::string uncachedZoneInfo(Server_CardZone &zone)
+{
+    ServerInfo_Zone info;
+    info.set_name(zone.getName().toStdString());
+    info.set_type(zone.getType());
+    info.set_with_coords(zone.hasCoords());
+    info.set_card_count(static_cast<int>(zone.getCards().size()));
+    info.set_always_reveal_top_card(zone.getAlwaysRevealTopCard());
+    info.set_always_look_at_top_card(zone.getAlwaysLookAtTopCard());
+    for (Server_Card *card : zone.getCards())
+        card->getInfo(info.add_card_list());
+    return info.SerializeAsString();
+}
+
+std::string cachedZoneInfo(Server_CardZone &zone)
+{
+    ServerInfo_Zone info;
+    zone.getInfo(&info, nullptr, true);
+    return info.SerializeAsString();
+}
+
+class ZoneSnapshotTest : public ::testing::Test
+{
+protected:
+    Server_CardZone table{nullptr, "table", true, ServerInfo_Zone::PublicZone};
+    Server_CardZone grave{nullptr, "grave", false, ServerInfo_Zone::PublicZone};
+
+    void SetUp() override
+    {
+        table.insertCard(new Server_Card({"Forest"}, 1, 0, 0), 0, 0);
+        table.insertCard(new Server_Card({"Forest"}, 2, 0, 0), 1, 0);
+        table.insertCard(new Server_Card({"Llanowar Elves"}, 3, 0, 0), 3, 1);
+        // fill the cache
+        cachedZoneInfo(table);
+        cachedZoneInfo(grave);
+    }
+};
+
+TEST_F(ZoneSnapshotTest, CardChangesInvalidateTheZone)
+{
+    Server_Card *elves = table.getCard(3);
+    elves->setTapped(true);
+    ASSERT_EQ(cachedZoneInfo(table), uncachedZoneInfo(table));
+
+    elves->setCounter(1, 2);
+    ASSERT_EQ(cachedZoneInfo(table), uncachedZoneInfo(table));
+
+    elves->setAnnotation("summoning sick");
+    elves->setPT("2/2");
+    ASSERT_EQ(cachedZoneInfo(table), uncachedZoneInfo(table));
+
+    elves->resetState();
+    ASSERT_EQ(cachedZoneInfo(table), uncachedZoneInfo(table));
+
+    elves->setId(7);
+    ASSERT_EQ(cachedZoneInfo(table), uncachedZoneInfo(table));
+}
+
+TEST_F(ZoneSnapshotTest, MovingCardsInvalidatesBothZones)
+{
+    Server_Card *forest = table.getCard(2, nullptr, true);
+    grave.insertCard(forest, -1, 0);
+    ASSERT_EQ(cachedZoneInfo(table), uncachedZoneInfo(table));
+    ASSERT_EQ(cachedZoneInfo(grave), uncachedZoneInfo(grave));
+
+    Server_Card *otherForest = table.getCard(1);
+    table.removeCard(otherForest);
+    delete otherForest;
+    grave.insertCard(new Server_Card({"Forest"}, 1, 0, 0), 0, 0);
+    ASSERT_EQ(cachedZoneInfo(table), uncachedZoneInfo(table));
+    ASSERT_EQ(cachedZoneInfo(grave), uncachedZoneInfo(grave));
+}
+
+TEST_F(ZoneSnapshotTest, ZonePropertiesInvalidateTheZone)
+{
+    grave.setAlwaysRevealTopCard(true);
+    ASSERT_EQ(cachedZoneInfo(grave), uncachedZoneInfo(grave));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
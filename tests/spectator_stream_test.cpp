@@ -0,0 +1,95 @@
+#include "../common/spectator_stream.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+SpectatorStream::Item makeItem(const char *name, qint64 appendedAt)
+{
+    SpectatorStream::Item item;
+    item.serializedMessage = name;
+    item.appendedAt = appendedAt;
+    return item;
+}
+
+QByteArray names(const QList<SpectatorStream::Item> &items)
+{
+    QByteArray result;
+    for (const SpectatorStream::Item &item : items)
+        result += item.serializedMessage;
+    return result;
+}
+
+TEST(SpectatorStreamTest, ReleasesWhatIsOlderThanTheDelay)
+{
+    SpectatorStream stream(1000, makeItem("S", 0));
+    stream.append(makeItem("a", 0));
+    stream.append(makeItem("b", 500));
+    stream.append(makeItem("c", 1500));
+
+    ASSERT_EQ(names(stream.release(999)), "");
+    ASSERT_EQ(names(stream.release(1500)), "ab");
+    ASSERT_EQ(stream.getReleased(), 2);
+    ASSERT_EQ(names(stream.release(1600, true)), "c");
+    ASSERT_EQ(names(stream.release(5000)), "");
+}
+
+TEST(SpectatorStreamTest, JoinersStartAtTheNewestReleasedSnapshot)
+{
+    SpectatorStream stream(1000, makeItem("S", 0));
+    stream.append(makeItem("a", 0));
+    stream.append(makeItem("b", 100));
+    stream.addSnapshot(stream.getHead(), makeItem("T", 200));
+    stream.append(makeItem("c", 300));
+
+    SpectatorStream::Item snapshot;
+    QList<SpectatorStream::Item> catchUp;
+    stream.getJoinPoint(snapshot, catchUp);
+    ASSERT_EQ(snapshot.serializedMessage, "S");
+    ASSERT_TRUE(catchUp.isEmpty());
+
+    // the second snapshot isn't released yet, the spectator doesn't get to see it before the others
+    stream.release(1000);
+    stream.getJoinPoint(snapshot, catchUp);
+    ASSERT_EQ(snapshot.serializedMessage, "S");
+    ASSERT_EQ(names(catchUp), "a");
+
+    stream.release(1300);
+    stream.getJoinPoint(snapshot, catchUp);
+    ASSERT_EQ(snapshot.serializedMessage, "T");
+    ASSERT_EQ(names(catchUp), "c");
+}
+
+TEST(SpectatorStreamTest, DropsWhatJoinersDontNeed)
+{
+    SpectatorStream stream(0, makeItem("S", 0));
+    for (int i = 0; i < 100; ++i)
+        stream.append(makeItem("x", i));
+    stream.addSnapshot(stream.getHead(), makeItem("T", 100));
+    stream.append(makeItem("y", 100));
+    stream.release(100);
+
+    SpectatorStream::Item snapshot;
+    QList<SpectatorStream::Item> catchUp;
+    stream.getJoinPoint(snapshot, catchUp);
+    ASSERT_EQ(snapshot.serializedMessage, "T");
+    ASSERT_EQ(names(catchUp), "y");
+    ASSERT_EQ(stream.getHead(), 101);
+
+    // a snapshot at the same position replaces the one there
+    stream.addSnapshot(stream.getHead(), makeItem("U", 200));
+    stream.addSnapshot(stream.getHead(), makeItem("V", 300));
+    stream.release(300);
+    stream.getJoinPoint(snapshot, catchUp);
+    ASSERT_EQ(snapshot.serializedMessage, "V");
+    ASSERT_TRUE(catchUp.isEmpty());
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
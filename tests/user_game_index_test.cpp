@@ -0,0 +1,60 @@
+#include "../common/user_game_index.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+TEST(UserGameIndexTest, FollowsTheMembers)
+{
+    UserGameIndex index;
+    index.setMembers(1, 10, "alice", {"alice", "bob"});
+    index.setMembers(2, 20, "carol", {"bob"});
+
+    const QList<QPair<int, int>> bobsGames = index.getGamesOfUser("bob");
+    ASSERT_EQ(bobsGames.size(), 2);
+    ASSERT_TRUE(bobsGames.contains(qMakePair(1, 10)));
+    ASSERT_TRUE(bobsGames.contains(qMakePair(2, 20)));
+
+    // bob leaves the first game, the creator is still known
+    index.setMembers(1, 10, "alice", {"alice"});
+    ASSERT_EQ(index.getGamesOfUser("bob"), QList<QPair<int, int>>({qMakePair(2, 20)}));
+    ASSERT_EQ(index.getGamesOfUser("alice"), QList<QPair<int, int>>({qMakePair(1, 10)}));
+    ASSERT_TRUE(index.getGamesOfUser("dave").isEmpty());
+}
+
+TEST(UserGameIndexTest, CountsCreatedGamesPerRoom)
+{
+    UserGameIndex index;
+    index.setMembers(1, 10, "alice", {"alice"});
+    index.setMembers(1, 11, "alice", {});
+    index.setMembers(2, 12, "alice", {"bob"});
+
+    ASSERT_EQ(index.getGamesCreatedByUser(1, "alice"), 2);
+    ASSERT_EQ(index.getGamesCreatedByUser(2, "alice"), 1);
+    ASSERT_EQ(index.getGamesCreatedByUser(1, "bob"), 0);
+
+    index.removeGame(10);
+    ASSERT_EQ(index.getGamesCreatedByUser(1, "alice"), 1);
+    ASSERT_TRUE(index.getGamesOfUser("alice").isEmpty());
+}
+
+TEST(UserGameIndexTest, RemovedGamesAreForgotten)
+{
+    UserGameIndex index;
+    index.setMembers(1, 10, "alice", {"alice", "bob"});
+    index.removeGame(10);
+    index.removeGame(10);
+
+    ASSERT_TRUE(index.getGamesOfUser("alice").isEmpty());
+    ASSERT_TRUE(index.getGamesOfUser("bob").isEmpty());
+    ASSERT_EQ(index.getGamesCreatedByUser(1, "alice"), 0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -19,6 +19,7 @@ export class WebClient {
       'feature_set',
       'room_chat_history',
       'client_warnings',
+      'batched_messages',
       /* unimplemented features */
       'forgot_password',
       'idle_client',
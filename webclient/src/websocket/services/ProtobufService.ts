@@ -12,6 +12,8 @@ export interface ProtobufEvents {
 
 export class ProtobufService {
   static PB_FILE_DIR = `${process.env.PUBLIC_URL}/pb`;
+  // first byte of a websocket message holding several server messages, see common/message_batching.h
+  static BATCH_MARKER = 0xfe;
 
   public controller;
   private cmdId = 0;
@@ -79,8 +81,29 @@ export class ProtobufService {
   }
 
   public handleMessageEvent({ data }: MessageEvent): void {
+    const uint8msg = new Uint8Array(data);
+    if (uint8msg[0] !== ProtobufService.BATCH_MARKER) {
+      this.handleServerMessage(uint8msg);
+      return;
+    }
+
+    // a batch of messages, each prefixed with its length as 32 bit big endian integer
+    const view = new DataView(uint8msg.buffer, uint8msg.byteOffset, uint8msg.byteLength);
+    let pos = 1;
+    while (pos + 4 <= uint8msg.length) {
+      const length = view.getUint32(pos);
+      pos += 4;
+      if (pos + length > uint8msg.length) {
+        console.error('Dropping truncated message batch');
+        return;
+      }
+      this.handleServerMessage(uint8msg.subarray(pos, pos + length));
+      pos += length;
+    }
+  }
+
+  private handleServerMessage(uint8msg: Uint8Array): void {
     try {
-      const uint8msg = new Uint8Array(data);
       const msg = this.controller.ServerMessage.decode(uint8msg);
 
       if (msg) {